@@ -0,0 +1,217 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#include <csrc/exceptions.h>
+#include <executor.h>
+#include <fusion.h>
+#include <fusion_profiler.h>
+#include <kernel_cache.h>
+#include <ops/all_ops.h>
+#include <scheduler/all_schedulers.h>
+
+#include <benchmark/benchmark.h>
+
+#include <cuda_runtime.h>
+
+#include <benchmarks/cpp/utils.h>
+#include <tests/cpp/utils.h>
+
+using namespace nvfuser;
+
+// Bandwidth of a pointwise kernel, out = in * 2 (+ bias), over a matrix of
+// dtypes, layouts, vectorization widths and inner sizes, including primes
+// and sizes that are not multiples of 8. Each benchmark reports the achieved
+// bandwidth, along with the "io_bytes" moved per iteration and the
+// "peak_gbs" bandwidth of the GPU.
+//
+// A vectorization width of 0 lets FusionExecutorCache pick the heuristics.
+// Other widths, in bytes, force the vectorization factor of the pointwise
+// heuristics to width / sizeof(dtype), and are skipped when the factor is
+// not a whole number or the kernel cannot be vectorized by it, e.g. because
+// the inner size is not divisible by it. Comparing the two shows where the
+// heuristics leave bandwidth unused.
+//
+// tools/bandwidth_heatmap.py prints a heatmap of the fractions of the peak
+// bandwidth per dtype and layout, e.g.
+//   bin/nvfuser_bench --benchmark_filter=NvFuserScheduler_BandwidthSweep \
+//     --benchmark_out=sweep.json
+//   python tools/bandwidth_heatmap.py sweep.json
+
+namespace {
+
+enum class Layout {
+  // Contiguous input and output
+  Contiguous,
+  // A bias of the inner size broadcast to every row
+  RowBroadcast,
+  // A bias of the outer size broadcast to every column
+  ColumnBroadcast,
+  // An input stored transposed, i.e. [inner, outer]
+  Transposed
+};
+
+// Elements of the output, so that all sizes move about the same bytes
+constexpr int64_t kNumel = 1 << 24;
+
+std::unique_ptr<Fusion> makeFusion(DataType dtype, Layout layout) {
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+
+  TensorView* in = makeContigTensor(2, dtype);
+  fusion->addInput(in);
+  TensorView* x =
+      layout == Layout::Transposed ? transpose(in, 0, 1) : set(in);
+  x = mul(castOp(DataType::Float, x), IrBuilder::create<Val>(2.0));
+  if (layout == Layout::RowBroadcast || layout == Layout::ColumnBroadcast) {
+    TensorView* bias = makeContigTensor(1, dtype);
+    fusion->addInput(bias);
+    x = add(
+        x,
+        broadcast(
+            castOp(DataType::Float, bias),
+            {layout == Layout::RowBroadcast,
+             layout == Layout::ColumnBroadcast}));
+  }
+  fusion->addOutput(castOp(dtype, x));
+  return fusion;
+}
+
+std::vector<c10::IValue> makeInputs(
+    DataType dtype,
+    Layout layout,
+    int64_t outer,
+    int64_t inner) {
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  const at::ScalarType aten_dtype = data_type_to_aten(dtype);
+  // at::randn does not support fp8
+  auto make = [&](std::vector<int64_t> shape) {
+    return at::randn(shape, options).to(aten_dtype);
+  };
+  std::vector<c10::IValue> inputs = {
+      layout == Layout::Transposed ? make({inner, outer})
+                                   : make({outer, inner})};
+  if (layout == Layout::RowBroadcast) {
+    inputs.emplace_back(make({inner}));
+  } else if (layout == Layout::ColumnBroadcast) {
+    inputs.emplace_back(make({outer}));
+  }
+  return inputs;
+}
+
+void setBandwidthCounters(
+    benchmark::State& benchmark_state,
+    int64_t io_bytes) {
+  benchmark_state.SetBytesProcessed(benchmark_state.iterations() * io_bytes);
+  int device = 0;
+  NVFUSER_CUDA_RT_SAFE_CALL(cudaGetDevice(&device));
+  DeviceDescriptor device_desc;
+  DeviceDescriptor::generate(device_desc, device);
+  benchmark_state.counters["io_bytes"] = (double)io_bytes;
+  benchmark_state.counters["peak_gbs"] = device_desc.peak_bandwidth_gbs;
+}
+
+} // namespace
+
+static void NvFuserScheduler_BandwidthSweep(
+    benchmark::State& benchmark_state,
+    DataType dtype,
+    Layout layout) {
+  const int64_t vec_bytes = benchmark_state.range(0);
+  const int64_t inner = benchmark_state.range(1);
+  const int64_t outer = std::max<int64_t>(kNumel / inner, 1);
+  const int64_t dtype_size = (int64_t)dataTypeSize(dtype);
+  if (dtype == DataType::Float8_e4m3fn && !deviceMajorMinorCheck(8, 9)) {
+    benchmark_state.SkipWithError("fp8 requires Ada or newer");
+    return;
+  }
+
+  std::unique_ptr<Fusion> fusion = makeFusion(dtype, layout);
+  std::vector<c10::IValue> inputs = makeInputs(dtype, layout, outer, inner);
+
+  if (vec_bytes == 0) {
+    FusionExecutorCache fec(std::move(fusion));
+    setBandwidthCounters(
+        benchmark_state, runBenchmarkIterations(benchmark_state, &fec, inputs));
+    return;
+  }
+
+  if (vec_bytes % dtype_size != 0) {
+    benchmark_state.SkipWithError("The width is not a multiple of the dtype");
+    return;
+  }
+  std::shared_ptr<PointwiseParams> params =
+      getPointwiseHeuristics(fusion.get(), inputs);
+  NVF_ERROR(params != nullptr, "Could not schedule the pointwise fusion");
+  params->unroll_factor = vec_bytes / dtype_size;
+  params->vectorize = params->unroll_factor > 1;
+  // TMA stores are only used with the factor of the heuristics
+  params->use_tma_store = false;
+
+  FusionExecutor executor;
+  try {
+    schedulePointwise(fusion.get(), *params);
+    executor.compileFusion(fusion.get(), inputs, params->lparams);
+    executor.runFusion(inputs, params->lparams);
+  } catch (const std::exception& e) {
+    benchmark_state.SkipWithError(e.what());
+    return;
+  }
+  setBandwidthCounters(
+      benchmark_state,
+      runBenchmarkIterations(
+          benchmark_state, &executor, inputs, params->lparams));
+  benchmark_state.SetLabel(toString(*params));
+}
+
+// Inner sizes: powers of 2, primes and other sizes that are not multiples of
+// 8, from a partial wave to large rows
+#define BANDWIDTH_SWEEP(name, dtype, layout)                              \
+  BENCHMARK_CAPTURE(NvFuserScheduler_BandwidthSweep, name, dtype, layout) \
+      ->ArgNames({"vec_bytes", "inner"})                                  \
+      ->ArgsProduct(                                                      \
+          {{0, 1, 2, 4, 8, 16},                                           \
+           {127, 1000, 1021, 4093, 4096, 10007, 16384, 65521}})           \
+      ->Unit(benchmark::kMicrosecond)                                     \
+      ->UseManualTime()
+
+BANDWIDTH_SWEEP(fp32_contiguous, DataType::Float, Layout::Contiguous);
+BANDWIDTH_SWEEP(fp32_row_broadcast, DataType::Float, Layout::RowBroadcast);
+BANDWIDTH_SWEEP(
+    fp32_column_broadcast,
+    DataType::Float,
+    Layout::ColumnBroadcast);
+BANDWIDTH_SWEEP(fp32_transposed, DataType::Float, Layout::Transposed);
+
+BANDWIDTH_SWEEP(bf16_contiguous, DataType::BFloat16, Layout::Contiguous);
+BANDWIDTH_SWEEP(
+    bf16_row_broadcast,
+    DataType::BFloat16,
+    Layout::RowBroadcast);
+BANDWIDTH_SWEEP(
+    bf16_column_broadcast,
+    DataType::BFloat16,
+    Layout::ColumnBroadcast);
+BANDWIDTH_SWEEP(bf16_transposed, DataType::BFloat16, Layout::Transposed);
+
+BANDWIDTH_SWEEP(fp16_contiguous, DataType::Half, Layout::Contiguous);
+BANDWIDTH_SWEEP(fp16_row_broadcast, DataType::Half, Layout::RowBroadcast);
+BANDWIDTH_SWEEP(
+    fp16_column_broadcast,
+    DataType::Half,
+    Layout::ColumnBroadcast);
+BANDWIDTH_SWEEP(fp16_transposed, DataType::Half, Layout::Transposed);
+
+BANDWIDTH_SWEEP(fp8_contiguous, DataType::Float8_e4m3fn, Layout::Contiguous);
+BANDWIDTH_SWEEP(
+    fp8_row_broadcast,
+    DataType::Float8_e4m3fn,
+    Layout::RowBroadcast);
+BANDWIDTH_SWEEP(
+    fp8_column_broadcast,
+    DataType::Float8_e4m3fn,
+    Layout::ColumnBroadcast);
+BANDWIDTH_SWEEP(fp8_transposed, DataType::Float8_e4m3fn, Layout::Transposed);
@@ -0,0 +1,355 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#include <csrc/exceptions.h>
+#include <fusion.h>
+#include <instrumentation.h>
+#include <kernel_cache.h>
+#include <ops/all_ops.h>
+#include <options.h>
+
+#include <benchmark/benchmark.h>
+
+#include <cuda_runtime.h>
+
+#include <benchmarks/cpp/utils.h>
+#include <tests/cpp/utils.h>
+
+using namespace nvfuser;
+
+// Time to first result of a new fusion, i.e. everything FusionExecutorCache
+// does on the host before the kernels of a new shape can run. Each iteration
+// runs a new FusionExecutorCache once. Besides the wall time, the host time
+// spent in each stage of the compile pipeline is reported in ms per
+// iteration, using the FUSER_PERF_SCOPE markers of these stages, along with
+// the number of segments and of IR nodes of the lowered kernels. With
+// NVFUSER_ENABLE=host_memory_trace, the growth of the host heap in each stage
+// and its peak are reported in MB as well.
+//
+// The fusions are chains of `copies` repetitions of a representative pattern,
+// each consuming the output of the previous one, so that compile time can be
+// tracked as a function of the fusion size. The wide siblings fusions are
+// instead `copies` independent branches reading the same inputs, which is the
+// worst case of the expression sorting of the lowering. Segments are compiled serially so
+// that the stage times add up to the wall time.
+
+namespace {
+
+// Scopes reported as counters. Times are inclusive, e.g. lowerPasses contains
+// the simplifyExpr calls of the lowering passes.
+const std::vector<std::pair<const char*, const char*>> kStages = {
+    {"PreSegmenter::runPass", "presegPasses"},
+    {"SegmentCandidateFinder::segment", "segmentation"},
+    {"FusionKernelRuntime::getMaybeHeuristicsFor", "heuristics"},
+    {"FusionKernelRuntime::compileKernel::schedule", "scheduling"},
+    {"GpuLower::lower", "lowerAnalysis"},
+    {"GpuLower::run", "lowerPasses"},
+    {"GpuLower::Lower::reorderExprsForComputeAt", "exprSort"},
+    {"generateCudaKernel", "codegen"},
+    {"executor_utils::Nvrtc::CompileProgram", "nvrtc"},
+    {"executor_utils::Nvrtc::LoadPTX", "moduleLoad"},
+};
+
+constexpr int64_t kRows = 1024;
+constexpr int64_t kHidden = 1024;
+
+enum class Pattern {
+  Bert,
+  LayerNormBackward,
+  MatmulEpilogue,
+  SoftmaxDropout,
+  WideSiblings
+};
+
+// The inputs of a fusion made of copies of a pattern, and the fusion itself
+struct PipelineFusion {
+  std::unique_ptr<Fusion> fusion = std::make_unique<Fusion>();
+  std::vector<c10::IValue> inputs;
+};
+
+// Bias, dropout, residual and layer norm, as in the output of a BERT layer
+PipelineFusion makeBert(int64_t copies) {
+  PipelineFusion result;
+  FusionGuard fg(result.fusion.get());
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+
+  auto x = makeContigTensor(2);
+  auto bias = makeContigTensor(1);
+  auto weight = makeContigTensor(1);
+  auto ln_bias = makeContigTensor(1);
+  for (auto tv : {x, bias, weight, ln_bias}) {
+    result.fusion->addInput(tv);
+  }
+  result.inputs = {
+      at::randn({kRows, kHidden}, options),
+      at::randn({kHidden}, options),
+      at::randn({kHidden}, options),
+      at::randn({kHidden}, options)};
+
+  auto prob = IrBuilder::create<Val>(0.9);
+  auto eps = IrBuilder::create<Val>(1e-5);
+  for (int64_t i = 0; i < copies; ++i) {
+    auto biased = add(x, broadcast(bias, {true, false}));
+    auto dropped = dropout(biased, prob).output;
+    x = layer_norm(add(dropped, x), {kHidden}, weight, ln_bias, eps).output;
+  }
+  result.fusion->addOutput(x);
+  return result;
+}
+
+// Backward of a layer norm, whose input gradient is the output gradient of
+// the next copy
+PipelineFusion makeLayerNormBackward(int64_t copies) {
+  PipelineFusion result;
+  FusionGuard fg(result.fusion.get());
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+
+  auto grad = makeContigTensor(2);
+  auto x = makeContigTensor(2);
+  auto weight = makeContigTensor(1);
+  auto bias = makeContigTensor(1);
+  for (auto tv : {grad, x, weight, bias}) {
+    result.fusion->addInput(tv);
+  }
+  result.inputs = {
+      at::randn({kRows, kHidden}, options),
+      at::randn({kRows, kHidden}, options),
+      at::randn({kHidden}, options),
+      at::randn({kHidden}, options)};
+
+  auto eps = IrBuilder::create<Val>(1e-5);
+  auto forward = layer_norm(x, {kHidden}, weight, bias, eps);
+  for (int64_t i = 0; i < copies; ++i) {
+    auto backward = layer_norm_backward(
+        grad,
+        x,
+        {kHidden},
+        forward.mean,
+        forward.invstd,
+        weight,
+        bias,
+        {true, true, true});
+    grad = backward.grad_input;
+    result.fusion->addOutput(backward.grad_weight);
+    result.fusion->addOutput(backward.grad_bias);
+  }
+  result.fusion->addOutput(grad);
+  return result;
+}
+
+// Half precision matmul followed by a bias and a relu
+PipelineFusion makeMatmulEpilogue(int64_t copies) {
+  PipelineFusion result;
+  FusionGuard fg(result.fusion.get());
+  auto options = at::TensorOptions().dtype(at::kHalf).device(at::kCUDA, 0);
+
+  auto x = makeContigTensor(2, DataType::Half);
+  auto w = makeContigTensor(2, DataType::Half);
+  auto bias = makeContigTensor(1);
+  for (auto tv : {x, w, bias}) {
+    result.fusion->addInput(tv);
+  }
+  result.inputs = {
+      at::randn({kRows, kHidden}, options),
+      at::randn({kHidden, kHidden}, options),
+      at::randn({kHidden}, options.dtype(at::kFloat))};
+
+  for (int64_t i = 0; i < copies; ++i) {
+    auto out = castOp(DataType::Float, matmul(x, w));
+    out = relu(add(out, broadcast(bias, {true, false})));
+    x = castOp(DataType::Half, out);
+  }
+  result.fusion->addOutput(x);
+  return result;
+}
+
+// Softmax over the inner dimension followed by a dropout
+PipelineFusion makeSoftmaxDropout(int64_t copies) {
+  PipelineFusion result;
+  FusionGuard fg(result.fusion.get());
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+
+  auto x = makeContigTensor(2);
+  result.fusion->addInput(x);
+  result.inputs = {at::randn({kRows, kHidden}, options)};
+
+  auto prob = IrBuilder::create<Val>(0.9);
+  for (int64_t i = 0; i < copies; ++i) {
+    x = dropout(softmax(x, 1), prob).output;
+  }
+  result.fusion->addOutput(x);
+  return result;
+}
+
+// Sibling branches of pointwise ops on the same inputs, each with its own
+// output, which are all scheduled in one pointwise kernel. The number of
+// copies is bounded by the size of the kernel parameters.
+PipelineFusion makeWideSiblings(int64_t copies) {
+  PipelineFusion result;
+  FusionGuard fg(result.fusion.get());
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+
+  auto x = makeContigTensor(2);
+  auto bias = makeContigTensor(1);
+  result.fusion->addInput(x);
+  result.fusion->addInput(bias);
+  result.inputs = {
+      at::randn({kRows, kHidden}, options), at::randn({kHidden}, options)};
+
+  auto biased = add(x, broadcast(bias, {true, false}));
+  for (int64_t i = 0; i < copies; ++i) {
+    auto scale = IrBuilder::create<Val>(1.0 + (double)i / (double)copies);
+    result.fusion->addOutput(sin(mul(biased, scale)));
+  }
+  return result;
+}
+
+PipelineFusion makePipelineFusion(Pattern pattern, int64_t copies) {
+  switch (pattern) {
+    case Pattern::Bert:
+      return makeBert(copies);
+    case Pattern::LayerNormBackward:
+      return makeLayerNormBackward(copies);
+    case Pattern::MatmulEpilogue:
+      return makeMatmulEpilogue(copies);
+    case Pattern::SoftmaxDropout:
+      return makeSoftmaxDropout(copies);
+    case Pattern::WideSiblings:
+      return makeWideSiblings(copies);
+  }
+  NVF_ERROR(false, "Unknown pattern");
+}
+
+// Number of Vals and Exprs of the lowered kernels of a runtime
+int64_t numLoweredNodes(FusionKernelRuntime* runtime) {
+  int64_t num_nodes = 0;
+  for (const auto& executor : runtime->executors()) {
+    if (!executor.hasCompiledKernel()) {
+      continue;
+    }
+    kir::Kernel* kernel = executor.kernel();
+    num_nodes +=
+        (int64_t)(kernel->vals().size() + kernel->unordered_exprs().size());
+  }
+  return num_nodes;
+}
+
+} // namespace
+
+static void NvFuserScheduler_CompilePipeline(
+    benchmark::State& benchmark_state,
+    Pattern pattern) {
+  const int64_t copies = benchmark_state.range(0);
+
+  DisableOptionsGuard opt_guard;
+  DisableOptionsGuard::getCurOptions().set(DisableOption::ParallelCompile);
+
+  auto trace = inst::Trace::instance();
+  trace->resetScopeTimes();
+  trace->resetScopeMemory();
+  int64_t num_segments = 0;
+  int64_t num_nodes = 0;
+  for (auto _ : benchmark_state) {
+    benchmark_state.PauseTiming();
+    PipelineFusion pipeline_fusion = makePipelineFusion(pattern, copies);
+    FusionExecutorCache fec(std::move(pipeline_fusion.fusion));
+    benchmark_state.ResumeTiming();
+
+    trace->enableScopeTimes(true);
+    fec.runFusionWithInputs(pipeline_fusion.inputs);
+    trace->enableScopeTimes(false);
+
+    benchmark_state.PauseTiming();
+    cudaDeviceSynchronize();
+    FusionKernelRuntime* runtime = fec.getMostRecentKernelRuntime();
+    num_segments = (int64_t)runtime->executors().size();
+    num_nodes = numLoweredNodes(runtime);
+    benchmark_state.ResumeTiming();
+  }
+
+  const auto scope_times = trace->scopeTimes();
+  const auto iterations = (double)benchmark_state.iterations();
+  for (const auto& [scope, counter] : kStages) {
+    auto it = scope_times.find(scope);
+    const int64_t total_ns =
+        it == scope_times.end() ? 0 : it->second.total_ns;
+    benchmark_state.counters[counter] = (double)total_ns / iterations / 1e6;
+  }
+  if (trace->recordingHostMemory()) {
+    const auto scope_memory = trace->scopeMemory();
+    for (const auto& [scope, counter] : kStages) {
+      auto it = scope_memory.find(scope);
+      if (it == scope_memory.end()) {
+        continue;
+      }
+      const std::string name = counter;
+      benchmark_state.counters[name + "HeapGrowthMB"] =
+          (double)it->second.heap_growth_bytes / iterations / 1e6;
+      benchmark_state.counters[name + "PeakHeapMB"] =
+          (double)it->second.peak_heap_bytes / 1e6;
+    }
+  }
+  benchmark_state.counters["segments"] = (double)num_segments;
+  benchmark_state.counters["loweredNodes"] = (double)num_nodes;
+}
+
+BENCHMARK_CAPTURE(NvFuserScheduler_CompilePipeline, bert, Pattern::Bert)
+    ->ArgName("copies")
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(8)
+    ->Iterations(3)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_CAPTURE(
+    NvFuserScheduler_CompilePipeline,
+    layer_norm_backward,
+    Pattern::LayerNormBackward)
+    ->ArgName("copies")
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(8)
+    ->Iterations(3)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_CAPTURE(
+    NvFuserScheduler_CompilePipeline,
+    matmul_epilogue,
+    Pattern::MatmulEpilogue)
+    ->ArgName("copies")
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(8)
+    ->Iterations(3)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_CAPTURE(
+    NvFuserScheduler_CompilePipeline,
+    softmax_dropout,
+    Pattern::SoftmaxDropout)
+    ->ArgName("copies")
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(8)
+    ->Iterations(3)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_CAPTURE(
+    NvFuserScheduler_CompilePipeline,
+    wide_siblings,
+    Pattern::WideSiblings)
+    ->ArgName("copies")
+    ->Arg(8)
+    ->Arg(16)
+    ->Arg(32)
+    ->Arg(64)
+    ->Iterations(3)
+    ->Unit(benchmark::kMillisecond);
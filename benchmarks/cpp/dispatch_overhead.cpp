@@ -0,0 +1,131 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#include <csrc/exceptions.h>
+#include <fusion.h>
+#include <instrumentation.h>
+#include <kernel_cache.h>
+#include <ops/all_ops.h>
+
+#include <benchmark/benchmark.h>
+
+#include <cuda_runtime.h>
+
+#include <benchmarks/cpp/utils.h>
+#include <tests/cpp/utils.h>
+
+using namespace nvfuser;
+
+// Host overhead of the full dispatch path of FusionExecutorCache, i.e. input
+// id lookup, runtime selection, argument packing, output allocation and the
+// launch of each segment. The tensors are tiny so that the kernels themselves
+// are negligible. Besides the wall time, the host time spent in each stage is
+// reported in ns per iteration, using the FUSER_PERF_SCOPE markers of the
+// dispatch path.
+
+namespace {
+
+// Scopes reported as counters. Times are inclusive, e.g. runWithInputs
+// contains the runFusion of every segment.
+const std::vector<std::pair<const char*, const char*>> kStages = {
+    {"FusionExecutorCache::prepareInputs", "prepareInputs"},
+    {"FusionExecutorCache::getKernelRuntimeFor", "getKernelRuntimeFor"},
+    {"FusionKernelRuntime::runWithInputs", "runWithInputs"},
+    {"FusionExecutor::runFusion", "runFusion"},
+    {"FusionExecutor::computeArgs", "computeArgs"},
+    {"FusionExecutor::recomputeArgs", "recomputeArgs"},
+    {"executor.cpp::allocateOutputs", "allocateOutputs"},
+    {"ExecutorRunFusion::cuLaunchKernel", "cuLaunchKernel"},
+};
+
+// Sum of num_inputs inputs followed by a chain of num_ops unary ops, split in
+// num_segments segments with segment_set
+std::unique_ptr<Fusion> makeDispatchFusion(
+    int64_t num_ops,
+    int64_t num_segments,
+    int64_t num_inputs) {
+  auto fusion_ptr = std::make_unique<Fusion>();
+  FusionGuard fg(fusion_ptr.get());
+
+  TensorView* tv = nullptr;
+  for (int64_t i = 0; i < num_inputs; ++i) {
+    auto input = makeContigTensor(2);
+    fusion_ptr->addInput(input);
+    tv = tv == nullptr ? input : add(tv, input);
+  }
+
+  const int64_t ops_per_segment = std::max<int64_t>(num_ops / num_segments, 1);
+  for (int64_t i = 0; i < num_ops; ++i) {
+    if (i > 0 && i % ops_per_segment == 0 &&
+        i / ops_per_segment < num_segments) {
+      tv = segment_set(tv);
+    }
+    tv = i % 2 == 0 ? sin(tv) : cos(tv);
+  }
+  fusion_ptr->addOutput(tv);
+  return fusion_ptr;
+}
+
+} // namespace
+
+static void NvFuserScheduler_DispatchOverhead(
+    benchmark::State& benchmark_state) {
+  const int64_t num_ops = benchmark_state.range(0);
+  const int64_t num_segments = benchmark_state.range(1);
+  const int64_t num_inputs = benchmark_state.range(2);
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  std::vector<c10::IValue> aten_inputs;
+  for (int64_t i = 0; i < num_inputs; ++i) {
+    aten_inputs.emplace_back(at::randn({4, 32}, options));
+  }
+
+  FusionExecutorCache fec(
+      makeDispatchFusion(num_ops, num_segments, num_inputs));
+  fec.runFusionWithInputs(aten_inputs);
+  NVF_CHECK(
+      (int64_t)fec.getMostRecentKernelRuntime()->executors().size() ==
+          num_segments,
+      "Unexpected number of segments");
+  cudaDeviceSynchronize();
+
+  auto trace = inst::Trace::instance();
+  trace->resetScopeTimes();
+  trace->enableScopeTimes(true);
+  for (auto _ : benchmark_state) {
+    fec.runFusionWithInputs(aten_inputs);
+  }
+  trace->enableScopeTimes(false);
+  cudaDeviceSynchronize();
+
+  const auto scope_times = trace->scopeTimes();
+  const auto iterations = (double)benchmark_state.iterations();
+  for (const auto& [scope, counter] : kStages) {
+    auto it = scope_times.find(scope);
+    const int64_t total_ns =
+        it == scope_times.end() ? 0 : it->second.total_ns;
+    benchmark_state.counters[counter] = (double)total_ns / iterations;
+  }
+}
+
+// Fusion size
+BENCHMARK(NvFuserScheduler_DispatchOverhead)
+    ->ArgNames({"ops", "segments", "inputs"})
+    ->ArgsProduct({{1, 8, 64, 256}, {1}, {2}})
+    ->Unit(benchmark::kMicrosecond);
+
+// Number of segments
+BENCHMARK(NvFuserScheduler_DispatchOverhead)
+    ->ArgNames({"ops", "segments", "inputs"})
+    ->ArgsProduct({{16}, {2, 4, 8, 16}, {2}})
+    ->Unit(benchmark::kMicrosecond);
+
+// Input count
+BENCHMARK(NvFuserScheduler_DispatchOverhead)
+    ->ArgNames({"ops", "segments", "inputs"})
+    ->ArgsProduct({{1}, {1}, {1, 8, 32, 128}})
+    ->Unit(benchmark::kMicrosecond);
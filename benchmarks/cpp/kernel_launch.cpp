@@ -0,0 +1,74 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#include <csrc/exceptions.h>
+#include <executor.h>
+#include <fusion.h>
+#include <kernel_cache.h>
+#include <ops/all_ops.h>
+
+#include <benchmark/benchmark.h>
+
+#include <cuda_runtime.h>
+
+#include <benchmarks/cpp/utils.h>
+#include <tests/cpp/utils.h>
+
+using namespace nvfuser;
+
+// Measures the host overhead of launching an already compiled pointwise
+// kernel. The tensors are tiny so that the time per iteration is dominated by
+// FusionExecutorCache::runFusionWithInputs rather than by the kernel itself.
+static void KernelLaunch_Pointwise_Base(
+    benchmark::State& benchmark_state,
+    bool disable_kernel_arg_patching) {
+  constexpr int64_t kNumInputs = 8;
+
+  auto fusion_ptr = std::make_unique<Fusion>();
+  FusionGuard fg(fusion_ptr.get());
+
+  TensorView* sum = nullptr;
+  for (int64_t i = 0; i < kNumInputs; ++i) {
+    auto tv = makeContigTensor(2);
+    fusion_ptr->addInput(tv);
+    sum = sum == nullptr ? tv : add(sum, tv);
+  }
+  fusion_ptr->addOutput(sum);
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  std::vector<c10::IValue> aten_inputs;
+  for (int64_t i = 0; i < kNumInputs; ++i) {
+    aten_inputs.emplace_back(at::randn({4, 32}, options));
+  }
+
+  FusionExecutorCache fec(std::move(fusion_ptr));
+  fec.runFusionWithInputs(aten_inputs);
+  if (disable_kernel_arg_patching) {
+    fec.disableKernelArgPatching();
+  }
+
+  for (auto _ : benchmark_state) {
+    fec.runFusionWithInputs(aten_inputs);
+  }
+  cudaDeviceSynchronize();
+}
+
+static void NvFuserScheduler_KernelLaunch_Pointwise(
+    benchmark::State& benchmark_state) {
+  KernelLaunch_Pointwise_Base(benchmark_state, false);
+}
+
+static void NvFuserScheduler_KernelLaunch_Pointwise_FullArgRepack(
+    benchmark::State& benchmark_state) {
+  KernelLaunch_Pointwise_Base(benchmark_state, true);
+}
+
+BENCHMARK(NvFuserScheduler_KernelLaunch_Pointwise)
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK(NvFuserScheduler_KernelLaunch_Pointwise_FullArgRepack)
+    ->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,254 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#include <fusion.h>
+#include <fusion_profiler.h>
+#include <kernel_cache.h>
+#include <ops/all_ops.h>
+#include <options.h>
+#include <scheduler/matmul_heuristic_plugin.h>
+#include <scheduler/mma_utils.h>
+#include <utils.h>
+
+#include <benchmark/benchmark.h>
+
+#include <cuda_runtime.h>
+
+#include <benchmarks/cpp/utils.h>
+#include <tests/cpp/utils.h>
+
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace nvfuser;
+
+// Runs the GEMMs of benchmarks/python/matmul_problems.csv through the matmul
+// scheduler and compares them with at::matmul, i.e., cuBLAS or cuBLASLt, to
+// show where the heuristic of the matmul scheduler loses to the library and
+// fusions are better left to ExprEvalScheduler. Each problem is run
+//  - with the default heuristic of getMatmulHeuristics, ignoring any loaded
+//    plugin, and
+//  - with the plugin of NVFUSER_MATMUL_HEURISTIC_PLUGIN, if any.
+// The benchmarks time at::matmul on the same inputs between nvFuser's
+// iterations and report the ratio of their times as `vs_cublas`, so a value
+// above 1 means nvFuser is slower. The `Summary` benchmark of each heuristic
+// and layout, run after the problems, reports the geometric mean of the
+// ratios and the number of problems where nvFuser is slower. Another catalog
+// can be given with NVFUSER_MATMUL_PROBLEMS=/path/to/problems.csv.
+//
+// The catalog has thousands of problems, so a subset is usually selected,
+// e.g., --benchmark_filter='MatmulCatalog.*/default_NT'.
+
+namespace {
+
+struct MatmulProblem {
+  int64_t m;
+  int64_t n;
+  int64_t k;
+  MmaLayout layout;
+};
+
+std::string catalogPath() {
+  if (const char* path = getNvFuserEnv("MATMUL_PROBLEMS")) {
+    return path;
+  }
+  return (std::filesystem::path(__FILE__).parent_path().parent_path() /
+          "python" / "matmul_problems.csv")
+      .string();
+}
+
+// The problems of the catalog, which has a "M,N,K,layout" header. A missing
+// catalog registers no problem rather than failing every other benchmark.
+const std::vector<MatmulProblem>& getMatmulProblems() {
+  static const std::vector<MatmulProblem> problems = []() {
+    const std::map<std::string, MmaLayout> layouts = {
+        {"NT", MmaLayout::NT},
+        {"TT", MmaLayout::TT},
+        {"TN", MmaLayout::TN},
+        {"NN", MmaLayout::NN}};
+    std::vector<MatmulProblem> problems;
+    std::ifstream file(catalogPath());
+    std::string line;
+    std::getline(file, line);
+    while (std::getline(file, line)) {
+      std::stringstream ss(line);
+      std::string m, n, k, layout;
+      if (!std::getline(ss, m, ',') || !std::getline(ss, n, ',') ||
+          !std::getline(ss, k, ',') || !std::getline(ss, layout)) {
+        continue;
+      }
+      auto it = layouts.find(layout);
+      if (it == layouts.end()) {
+        continue;
+      }
+      problems.push_back(
+          {std::stoll(m), std::stoll(n), std::stoll(k), it->second});
+    }
+    return problems;
+  }();
+  return problems;
+}
+
+// nvFuser / cuBLAS time ratios of the problems run so far, by heuristic and
+// layout
+std::map<std::string, std::vector<double>>& getRatios() {
+  static std::map<std::string, std::vector<double>> ratios;
+  return ratios;
+}
+
+std::string ratioKey(bool use_plugin, MmaLayout layout) {
+  return (use_plugin ? "plugin_" : "default_") + toString(layout);
+}
+
+// An HSH matmul, which is what at::matmul performs
+std::unique_ptr<Fusion> makeMatmulFusion(MmaLayout layout) {
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+
+  auto a = makeContigTensor(2, DataType::Half);
+  auto b = makeContigTensor(2, DataType::Half);
+  fusion->addInput(a);
+  fusion->addInput(b);
+
+  a = canonicalizeInputToBMNK(a, layout, MmaOperand::A);
+  b = canonicalizeInputToBMNK(b, layout, MmaOperand::B);
+  auto c = fusedMultiplySum(a, b, {-1});
+  fusion->addOutput(castOp(DataType::Half, c));
+  return fusion;
+}
+
+void MatmulCatalog(
+    benchmark::State& benchmark_state,
+    MmaLayout layout,
+    bool use_plugin) {
+  if (cudaArchGuardShouldSkip(8, 0)) {
+    benchmark_state.SkipWithError("Unsupported arch");
+    return;
+  }
+  DisableOptionsGuard og;
+  if (!use_plugin) {
+    DisableOptionsGuard::getCurOptions().set(
+        DisableOption::MatmulHeuristicPlugin);
+  } else if (!matmul_heuristic_plugin::hasPlugin()) {
+    benchmark_state.SkipWithError(
+        "No plugin given with NVFUSER_MATMUL_HEURISTIC_PLUGIN");
+    return;
+  }
+
+  const int64_t m = benchmark_state.range(0);
+  const int64_t n = benchmark_state.range(1);
+  const int64_t k = benchmark_state.range(2);
+
+  at::manual_seed(0);
+  auto inputs = matmulAtInput2D(m, n, k, layout);
+  std::vector<c10::IValue> aten_inputs({inputs.first, inputs.second});
+
+  // Disable reduced-precision reduction for a fair comparison since nvFuser
+  // does not use it
+  at::globalContext().setAllowFP16ReductionCuBLAS(false);
+
+  FusionExecutorCache executor_cache(makeMatmulFusion(layout));
+  executor_cache.profile(true);
+  auto outputs = executor_cache.runFusionWithInputs(aten_inputs);
+  atMatmul(inputs.first, inputs.second, layout);
+  benchmark_state.SetLabel(
+      toString(executor_cache.getMostRecentExecutorInfo().params));
+  executor_cache.profile(false);
+
+  NVFUSER_CUDA_RT_SAFE_CALL(cudaDeviceSynchronize());
+  ProfilerOptionsGuard pog;
+  ProfilerOptionsGuard::getCurOptions().set(ProfilerOption::Enable);
+
+  double nvfuser_ms = 0.0;
+  double cublas_ms = 0.0;
+  for (auto _ : benchmark_state) {
+    clearL2Cache();
+    {
+      CudaKernelTimer timer;
+      atMatmul(inputs.first, inputs.second, layout);
+      cublas_ms += timer.elapsed();
+    }
+    clearL2Cache();
+    outputs = executor_cache.runFusionWithInputs(aten_inputs);
+    const double iteration_ms = FusionProfiler::profile().kernel_time_ms;
+    nvfuser_ms += iteration_ms;
+    benchmark_state.SetIterationTime(iteration_ms / 1000.0);
+  }
+  NVFUSER_CUDA_RT_SAFE_CALL(cudaDeviceSynchronize());
+
+  const double ratio = nvfuser_ms / cublas_ms;
+  benchmark_state.counters["cublas_us"] = benchmark::Counter(
+      cublas_ms * 1000.0, benchmark::Counter::kAvgIterations);
+  benchmark_state.counters["vs_cublas"] = ratio;
+  benchmark_state.SetItemsProcessed(
+      2 * m * n * k * (int64_t)benchmark_state.iterations());
+  getRatios()[ratioKey(use_plugin, layout)].push_back(ratio);
+}
+
+void MatmulCatalogSummary(
+    benchmark::State& benchmark_state,
+    MmaLayout layout,
+    bool use_plugin) {
+  for (auto _ : benchmark_state) {
+  }
+  const std::vector<double>& ratios = getRatios()[ratioKey(use_plugin, layout)];
+  double log_sum = 0.0;
+  int64_t num_slower = 0;
+  for (double ratio : ratios) {
+    log_sum += std::log(ratio);
+    num_slower += ratio > 1.0 ? 1 : 0;
+  }
+  benchmark_state.counters["problems"] = (double)ratios.size();
+  benchmark_state.counters["slower_than_cublas"] = (double)num_slower;
+  benchmark_state.counters["geomean_vs_cublas"] =
+      ratios.empty() ? 0.0 : std::exp(log_sum / (double)ratios.size());
+}
+
+void MatmulCatalogProblems(
+    benchmark::internal::Benchmark* b,
+    MmaLayout layout) {
+  b->ArgNames({"M", "N", "K"});
+  for (const MatmulProblem& problem : getMatmulProblems()) {
+    if (problem.layout == layout) {
+      b->Args({problem.m, problem.n, problem.k});
+    }
+  }
+}
+
+} // namespace
+
+#define MatmulCatalogBenchmark(heuristic, use_plugin, layout)      \
+  BENCHMARK_CAPTURE(                                               \
+      MatmulCatalog,                                               \
+      heuristic##_##layout,                                        \
+      MmaLayout::layout,                                           \
+      use_plugin)                                                  \
+      ->Unit(benchmark::kMicrosecond)                              \
+      ->UseManualTime()                                            \
+      ->Apply([](benchmark::internal::Benchmark* b) {              \
+        MatmulCatalogProblems(b, MmaLayout::layout);               \
+      });                                                          \
+  BENCHMARK_CAPTURE(                                               \
+      MatmulCatalogSummary,                                        \
+      heuristic##_##layout,                                        \
+      MmaLayout::layout,                                           \
+      use_plugin)                                                  \
+      ->Iterations(1);
+
+#define ForAllCatalogLayouts(heuristic, use_plugin)  \
+  MatmulCatalogBenchmark(heuristic, use_plugin, NT); \
+  MatmulCatalogBenchmark(heuristic, use_plugin, TT); \
+  MatmulCatalogBenchmark(heuristic, use_plugin, TN); \
+  MatmulCatalogBenchmark(heuristic, use_plugin, NN);
+
+ForAllCatalogLayouts(default, false);
+ForAllCatalogLayouts(plugin, true);
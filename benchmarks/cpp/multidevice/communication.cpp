@@ -0,0 +1,213 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#include <benchmarks/cpp/multidevice/utils.h>
+
+#include <fusion.h>
+#include <host_ir/container.h>
+#include <ir/builder.h>
+#include <multidevice/communication.h>
+#include <ops/arith.h>
+#include <ops/utils.h>
+#include <options.h>
+#include <tests/cpp/utils.h>
+
+#include <algorithm>
+#include <sstream>
+
+// Time of each communication type posted alone with postSingleCommunication,
+// for messages of 4KiB to 64MiB per device and for each backend. The bytes
+// per second are the size of the message of a device divided by the time.
+// SendRecv sends from device 1 to device 0, and the other collectives span
+// all the devices, rooted at device 0 when they have a root.
+
+namespace nvfuser {
+
+namespace {
+
+constexpr DeviceIdxType kRoot = 0;
+constexpr DeviceIdxType kSender = 1;
+constexpr int64_t kIterations = 20;
+
+Communication* makeCommunication(
+    CommunicationType type,
+    const DeviceMesh& mesh) {
+  const Team team = mesh.vector();
+  TensorView* in = makeContigTensor(
+      type == CommunicationType::ReduceScatter ||
+              type == CommunicationType::AllToAll
+          ? 3
+          : 2);
+  in->setDeviceMesh(mesh);
+  auto* out = ops::newValLike(in, in->dtype())->as<TensorView>();
+  switch (type) {
+    case CommunicationType::Gather:
+    case CommunicationType::Scatter:
+    case CommunicationType::Broadcast:
+      return IrBuilder::create<Communication>(type, out, in, team, kRoot);
+    case CommunicationType::Allgather:
+      return IrBuilder::create<Communication>(type, out, in, team);
+    case CommunicationType::Reduce:
+    case CommunicationType::Allreduce:
+      return IrBuilder::create<Communication>(
+          type,
+          newForReduction(in, {0}),
+          in,
+          team,
+          type == CommunicationType::Reduce ? kRoot : -1,
+          c10d::ReduceOp::RedOpType::SUM);
+    case CommunicationType::ReduceScatter:
+      return IrBuilder::create<Communication>(
+          type,
+          newForReduction(in, {0}),
+          in,
+          team,
+          /*root=*/-1,
+          c10d::ReduceOp::RedOpType::SUM,
+          /*scattered_axis=*/1);
+    case CommunicationType::SendRecv:
+      return IrBuilder::create<Communication>(
+          type, out, in, Team({kSender, kRoot}), kSender);
+    case CommunicationType::AllToAll:
+      return IrBuilder::create<Communication>(
+          type,
+          out,
+          in,
+          team,
+          /*root=*/-1,
+          c10d::ReduceOp::RedOpType::UNUSED,
+          /*scattered_axis=*/1,
+          /*gathered_axis=*/0);
+  }
+  NVF_ERROR(false, "Unknown communication type: ", type);
+}
+
+// The input and output buffers of this device, following the layouts of
+// test_multidevice_communications.cpp, with `size` elements per device
+std::pair<at::Tensor, at::Tensor> makeBuffers(
+    CommunicationType type,
+    Communicator* communicator,
+    int64_t size) {
+  const auto options =
+      at::TensorOptions().dtype(at::kFloat).device(communicator->device());
+  const int64_t num_devices = communicator->size();
+  const bool is_root = communicator->deviceId() == kRoot;
+  switch (type) {
+    case CommunicationType::Gather:
+    case CommunicationType::Allgather:
+      return {
+          at::randn({1, size}, options),
+          at::empty({num_devices, size}, options)};
+    case CommunicationType::Scatter:
+      return {
+          is_root ? at::randn({num_devices, size}, options) : at::Tensor(),
+          at::empty({1, size}, options)};
+    case CommunicationType::Broadcast:
+      return {
+          is_root ? at::randn({size}, options) : at::Tensor(),
+          at::empty({size}, options)};
+    case CommunicationType::Reduce:
+    case CommunicationType::Allreduce:
+      return {at::randn({1, size}, options), at::empty({size}, options)};
+    case CommunicationType::ReduceScatter:
+      return {
+          at::randn({1, num_devices, size}, options),
+          at::empty({1, size}, options)};
+    case CommunicationType::SendRecv:
+      return {
+          communicator->deviceId() == kSender ? at::randn({size}, options)
+                                              : at::Tensor(),
+          is_root ? at::empty({size}, options) : at::Tensor()};
+    case CommunicationType::AllToAll:
+      return {
+          at::randn({1, num_devices, size}, options),
+          at::empty({num_devices, 1, size}, options)};
+  }
+  NVF_ERROR(false, "Unknown communication type: ", type);
+}
+
+void BenchmarkCommunication(
+    benchmark::State& benchmark_state,
+    CommunicationType type,
+    CommunicatorBackend backend) {
+  Communicator* communicator = &Communicator::getInstance();
+  if (skipIfUnavailable(benchmark_state, communicator, backend)) {
+    return;
+  }
+  if (type == CommunicationType::SendRecv && communicator->size() < 2) {
+    benchmark_state.SkipWithError("SendRecv needs at least 2 devices");
+    return;
+  }
+  // Makes sure communications go through the backend under test.
+  DisableOptionsGuard opt_guard;
+  DisableOptionsGuard::getCurOptions().set(DisableOption::P2pCommunication);
+
+  const int64_t size = benchmark_state.range(0);
+  hir::HostIrContainer container;
+  FusionGuard fg(&container);
+  const auto mesh = DeviceMesh::createForNumDevices(communicator->size());
+  Communication* communication = makeCommunication(type, mesh);
+  auto [input, output] = makeBuffers(type, communicator, size);
+
+  const Team& team = communication->team();
+  const bool is_in_team =
+      std::find(team.begin(), team.end(), communicator->deviceId()) !=
+      team.end();
+  c10d::Backend* c10d_backend = is_in_team
+      ? communicator->getBackendForTeam(team, backend)
+      : nullptr;
+
+  auto post = [&]() {
+    if (!is_in_team) {
+      return;
+    }
+    auto work = postSingleCommunication(
+        communication, communicator->deviceId(), c10d_backend, input, output);
+    if (work != nullptr) {
+      work->wait();
+    }
+  };
+
+  // The first communication of a team sets up the backend.
+  timeOnAllDevices(communicator, post);
+
+  for (auto _ : benchmark_state) {
+    benchmark_state.SetIterationTime(timeOnAllDevices(communicator, post));
+  }
+  benchmark_state.SetBytesProcessed(
+      benchmark_state.iterations() * size * (int64_t)sizeof(float));
+}
+
+} // namespace
+
+void registerCommunicationBenchmarks() {
+  for (auto type :
+       {CommunicationType::Gather,
+        CommunicationType::Allgather,
+        CommunicationType::Scatter,
+        CommunicationType::Reduce,
+        CommunicationType::Allreduce,
+        CommunicationType::ReduceScatter,
+        CommunicationType::Broadcast,
+        CommunicationType::SendRecv,
+        CommunicationType::AllToAll}) {
+    for (auto backend : {CommunicatorBackend::nccl, CommunicatorBackend::ucc}) {
+      std::stringstream name;
+      name << "Communication/" << type << "/" << backend;
+      benchmark::RegisterBenchmark(
+          name.str().c_str(), BenchmarkCommunication, type, backend)
+          ->ArgName("size")
+          ->RangeMultiplier(16)
+          ->Range(1 << 10, 1 << 24)
+          ->Iterations(kIterations)
+          ->UseManualTime()
+          ->Unit(benchmark::kMicrosecond);
+    }
+  }
+}
+
+} // namespace nvfuser
@@ -0,0 +1,78 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#include <benchmarks/cpp/multidevice/utils.h>
+
+#include <cuda_utils.h>
+
+#include <benchmark/benchmark.h>
+#include <cuda_runtime.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Run with one process per device, e.g.
+//   mpirun -np 8 bin/nvfuser_multidevice_bench --benchmark_out=out.json
+// All the processes must be given the same arguments.
+
+namespace {
+
+// Drops the results of all the processes but the first one.
+class NullReporter : public benchmark::BenchmarkReporter {
+ public:
+  bool ReportContext(const Context&) override {
+    return true;
+  }
+  void ReportRuns(const std::vector<Run>&) override {}
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+  nvfuser::Communicator& communicator = nvfuser::Communicator::getInstance();
+  const bool is_first_process =
+      !communicator.is_available() || communicator.deviceId() == 0;
+
+  // Only the first process writes the output file.
+  std::vector<char*> args;
+  for (int i = 0; i < argc; i++) {
+    if (is_first_process ||
+        std::strncmp(argv[i], "--benchmark_out", 15) != 0) {
+      args.push_back(argv[i]);
+    }
+  }
+  int num_args = (int)args.size();
+  args.push_back(nullptr);
+
+  ::benchmark::Initialize(&num_args, args.data());
+  if (::benchmark::ReportUnrecognizedArguments(num_args, args.data())) {
+    return 1;
+  }
+
+  cudaDeviceProp prop;
+  NVFUSER_CUDA_RT_SAFE_CALL(
+      cudaGetDeviceProperties(&prop, communicator.device().index()));
+  ::benchmark::AddCustomContext("gpu_name", prop.name);
+  ::benchmark::AddCustomContext(
+      "num_devices", std::to_string(communicator.size()));
+  ::benchmark::AddCustomContext(
+      "num_devices_per_node", std::to_string(communicator.local_size()));
+
+  nvfuser::registerCommunicationBenchmarks();
+
+  if (is_first_process) {
+    ::benchmark::RunSpecifiedBenchmarks();
+  } else {
+    NullReporter reporter;
+    ::benchmark::RunSpecifiedBenchmarks(&reporter);
+  }
+
+  ::benchmark::Shutdown();
+  communicator.cleanup();
+  return 0;
+}
@@ -0,0 +1,143 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#include <benchmarks/cpp/multidevice/utils.h>
+
+#include <c10/cuda/CUDAStream.h>
+#include <c10/util/irange.h>
+#include <torch/torch.h>
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+// Overlap of computations and communications in the reduce-scatter based
+// pipelining of a GEMM+ReduceScatter, as in
+// OverlapTest.ReduceScatterBasedPipeliningATenImplementation: the rows of the
+// GEMM are split into `tiles` slices, each of which is computed and then
+// reduce-scattered on one of `streams` streams, in a round-robin fashion.
+//
+// Each iteration times the computations alone, the communications alone and
+// the pipelined program, which is reported as the time of the benchmark. The
+// overlap efficiency is the fraction of the shorter of the computations and
+// the communications that is hidden by the pipelining, i.e.
+//   (compute + communication - pipelined) / min(compute, communication)
+// which is 0 when nothing overlaps and 1 when the shorter of the two is fully
+// hidden.
+
+namespace nvfuser {
+
+namespace {
+
+constexpr int64_t kM = 1 << 14;
+constexpr int64_t kK = 1 << 12;
+constexpr int64_t kN = 1 << 12;
+constexpr int64_t kIterations = 10;
+
+void BenchmarkReduceScatterPipelining(
+    benchmark::State& benchmark_state,
+    CommunicatorBackend backend) {
+  Communicator* communicator = &Communicator::getInstance();
+  if (skipIfUnavailable(benchmark_state, communicator, backend)) {
+    return;
+  }
+  const int64_t num_tiles = benchmark_state.range(0);
+  const int64_t num_streams = benchmark_state.range(1);
+  const int64_t num_devices = communicator->size();
+  if (kM % (num_tiles * num_devices) != 0 || kK % num_devices != 0) {
+    benchmark_state.SkipWithError(
+        "The number of tiles and devices must divide the GEMM sizes");
+    return;
+  }
+
+  std::vector<int64_t> team(num_devices);
+  std::iota(team.begin(), team.end(), 0);
+  c10d::Backend* world = communicator->getBackendForTeam(team, backend);
+
+  const auto options =
+      at::TensorOptions().dtype(at::kFloat).device(communicator->device());
+  at::Tensor ta =
+      at::randn({num_tiles, kM / num_tiles, kK / num_devices}, options);
+  at::Tensor tb = at::randn({kK / num_devices, kN}, options);
+  at::Tensor tc_locally_reduced = at::empty(
+      {std::min(num_tiles, num_streams), kM / num_tiles, kN}, options);
+  at::Tensor tc =
+      at::empty({num_tiles, kM / (num_tiles * num_devices), kN}, options);
+
+  std::vector<c10::cuda::CUDAStream> streams;
+  for ([[maybe_unused]] auto i : c10::irange(num_streams)) {
+    streams.push_back(c10::cuda::getStreamFromPool(
+        /*isHighPriority=*/false, communicator->device().index()));
+  }
+  const c10::cuda::CUDAStream original_stream =
+      c10::cuda::getCurrentCUDAStream();
+
+  auto run = [&](bool compute, bool communicate) {
+    for (auto j : c10::irange(num_tiles)) {
+      const int64_t stream_index = j % num_streams;
+      c10::cuda::setCurrentCUDAStream(streams.at(stream_index));
+      at::Tensor tc_locally_reduced_j =
+          tc_locally_reduced.select(0, stream_index);
+      if (compute) {
+        torch::matmul_out(tc_locally_reduced_j, ta.select(0, j), tb);
+      }
+      if (communicate) {
+        world->_reduce_scatter_base(tc.select(0, j), tc_locally_reduced_j)
+            ->wait();
+      }
+    }
+    c10::cuda::setCurrentCUDAStream(original_stream);
+  };
+
+  // The first communication of a team sets up the backend.
+  timeOnAllDevices(communicator, [&]() { run(true, true); });
+
+  double compute_time = 0.0;
+  double communication_time = 0.0;
+  double pipelined_time = 0.0;
+  for (auto _ : benchmark_state) {
+    compute_time += timeOnAllDevices(communicator, [&]() { run(true, false); });
+    communication_time +=
+        timeOnAllDevices(communicator, [&]() { run(false, true); });
+    const double time =
+        timeOnAllDevices(communicator, [&]() { run(true, true); });
+    pipelined_time += time;
+    benchmark_state.SetIterationTime(time);
+  }
+
+  const auto iterations = (double)benchmark_state.iterations();
+  benchmark_state.counters["compute_us"] = compute_time / iterations * 1e6;
+  benchmark_state.counters["communication_us"] =
+      communication_time / iterations * 1e6;
+  benchmark_state.counters["overlap_efficiency"] =
+      (compute_time + communication_time - pipelined_time) /
+      std::min(compute_time, communication_time);
+}
+
+} // namespace
+
+BENCHMARK_CAPTURE(
+    BenchmarkReduceScatterPipelining,
+    nccl,
+    CommunicatorBackend::nccl)
+    ->ArgNames({"tiles", "streams"})
+    ->ArgsProduct({{1, 2, 4, 8, 16}, {1, 2, 4}})
+    ->Iterations(kIterations)
+    ->UseManualTime()
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_CAPTURE(
+    BenchmarkReduceScatterPipelining,
+    ucc,
+    CommunicatorBackend::ucc)
+    ->ArgNames({"tiles", "streams"})
+    ->ArgsProduct({{1, 2, 4, 8, 16}, {1, 2, 4}})
+    ->Iterations(kIterations)
+    ->UseManualTime()
+    ->Unit(benchmark::kMicrosecond);
+
+} // namespace nvfuser
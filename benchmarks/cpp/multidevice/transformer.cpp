@@ -0,0 +1,198 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#include <benchmarks/cpp/multidevice/utils.h>
+
+#include <fusion.h>
+#include <multidevice/executor.h>
+#include <tests/cpp/multidevice_transformer.h>
+#include <tests/cpp/utils.h>
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+// End-to-end MultiDeviceExecutor runs of the forward of the tensor parallel
+// transformer layer of test_multidevice_transformer.cpp. Each iteration times
+//   - the layer with the default parameters of MultiDeviceExecutor, in which
+//     compute segments and communications run one after the other,
+//   - the layer with HostIrExecutorParams::overlap_compute_and_communication,
+//     which is reported as the time of the benchmark, and
+//   - the communications of the layer alone, i.e. an allreduce of the
+//     [B * S, E] activations after MHA and after MLP.
+// As in overlap.cpp, the overlap efficiency is the fraction of the shorter of
+// the computations and the communications that the overlap hides, where the
+// time of the computations is the serial time minus the time of the
+// communications:
+//   (serial - overlapped) / min(communication, serial - communication)
+
+namespace nvfuser {
+
+namespace {
+
+constexpr int64_t kIterations = 10;
+
+std::unique_ptr<Fusion> makeTransformerForward(
+    int64_t num_devices,
+    DataType dtype) {
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+  const auto mesh = DeviceMesh::createForNumDevices(num_devices);
+  const int64_t D = num_devices;
+
+  TensorView* x = makeContigConcreteTensor({B * S, E}, DataType::Float);
+  TensorView* mha_w0 = makeContigConcreteTensor({D, E, 3 * E / D}, dtype);
+  TensorView* mha_b0 = makeContigConcreteTensor({D, 3 * E / D}, dtype);
+  TensorView* mha_w1 = makeContigConcreteTensor({D, E / D, E}, dtype);
+  TensorView* mha_b1 = makeContigConcreteTensor({E}, dtype);
+  TensorView* mlp_w0 = makeContigTensor(3, dtype);
+  TensorView* mlp_b0 = makeContigTensor(2, dtype);
+  TensorView* mlp_w1 = makeContigTensor(3, dtype);
+  TensorView* mlp_b1 = makeContigTensor(1, dtype);
+  for (auto tv :
+       {x, mha_w0, mha_b0, mha_w1, mha_b1, mlp_w0, mlp_b0, mlp_w1, mlp_b1}) {
+    fusion->addInput(tv);
+  }
+
+  for (TensorView* tv : transformerForward(
+           x,
+           mha_w0,
+           mha_b0,
+           mha_w1,
+           mha_b1,
+           mlp_w0,
+           mlp_b0,
+           mlp_w1,
+           mlp_b1,
+           mesh,
+           dtype)) {
+    fusion->addOutput(tv);
+  }
+  return fusion;
+}
+
+std::vector<c10::IValue> makeTransformerInputs(
+    Communicator* communicator,
+    DataType dtype) {
+  const int64_t D = communicator->size();
+  const auto mesh = DeviceMesh::createForNumDevices(D);
+  const auto options = at::TensorOptions()
+                           .dtype(data_type_to_aten(dtype))
+                           .device(communicator->device());
+  auto mha_w0 = at::randn({E, 3 * E}, options) * kParamScale;
+  auto mha_b0 = at::randn({3 * E}, options) * kParamScale;
+  return {
+      at::randn({B * S, E}, options).to(at::kFloat),
+      shardTensor(communicator, mha_w0.view({E, 3, E}), 2, mesh)
+          .view({1, E, 3 * E / D}),
+      shardTensor(communicator, mha_b0.view({3, E}), 1, mesh)
+          .view({1, 3 * E / D}),
+      shardTensor(
+          communicator, at::randn({E, E}, options) * kParamScale, 0, mesh),
+      at::randn({E}, options) * kParamScale,
+      shardTensor(
+          communicator, at::randn({E, 4 * E}, options) * kParamScale, 1, mesh),
+      shardTensor(
+          communicator, at::randn({4 * E}, options) * kParamScale, 0, mesh),
+      shardTensor(
+          communicator, at::randn({4 * E, E}, options) * kParamScale, 0, mesh),
+      at::randn({E}, options) * kParamScale};
+}
+
+void BenchmarkTransformerForward(
+    benchmark::State& benchmark_state,
+    DataType dtype) {
+  Communicator* communicator = &Communicator::getInstance();
+  if (skipIfUnavailable(
+          benchmark_state, communicator, CommunicatorBackend::nccl)) {
+    return;
+  }
+  const int64_t num_devices = communicator->size();
+  if (H % num_devices != 0) {
+    benchmark_state.SkipWithError(
+        "The number of devices must divide the number of heads");
+    return;
+  }
+  if (!deviceMajorMinorCheck(8)) {
+    benchmark_state.SkipWithError("Requires Ampere or newer");
+    return;
+  }
+
+  hir::HostIrExecutorParams serial_params{
+      .use_fusion_executor_cache = true,
+      .skip_auto_scheduling = false,
+      .cache_fusion_executor = true};
+  hir::HostIrExecutorParams overlap_params = serial_params;
+  overlap_params.overlap_compute_and_communication = true;
+  MultiDeviceExecutor serial_runtime(
+      makeTransformerForward(num_devices, dtype), *communicator, serial_params);
+  MultiDeviceExecutor overlap_runtime(
+      makeTransformerForward(num_devices, dtype),
+      *communicator,
+      overlap_params);
+  const std::vector<c10::IValue> inputs =
+      makeTransformerInputs(communicator, dtype);
+
+  std::vector<int64_t> team(num_devices);
+  std::iota(team.begin(), team.end(), 0);
+  c10d::Backend* world =
+      communicator->getBackendForTeam(team, CommunicatorBackend::nccl);
+  std::vector<at::Tensor> activations = {at::randn(
+      {B * S, E},
+      at::TensorOptions()
+          .dtype(data_type_to_aten(dtype))
+          .device(communicator->device()))};
+
+  auto run_serial = [&]() { serial_runtime.runWithInput(inputs); };
+  auto run_overlap = [&]() { overlap_runtime.runWithInput(inputs); };
+  auto run_communications = [&]() {
+    // After MHA and after MLP
+    for ([[maybe_unused]] auto i : {0, 1}) {
+      world->allreduce(activations)->wait();
+    }
+  };
+
+  // Compiles the kernels and sets up the backends.
+  timeOnAllDevices(communicator, run_serial);
+  timeOnAllDevices(communicator, run_overlap);
+  timeOnAllDevices(communicator, run_communications);
+
+  double serial_time = 0.0;
+  double overlap_time = 0.0;
+  double communication_time = 0.0;
+  for (auto _ : benchmark_state) {
+    serial_time += timeOnAllDevices(communicator, run_serial);
+    communication_time += timeOnAllDevices(communicator, run_communications);
+    const double time = timeOnAllDevices(communicator, run_overlap);
+    overlap_time += time;
+    benchmark_state.SetIterationTime(time);
+  }
+
+  const auto iterations = (double)benchmark_state.iterations();
+  benchmark_state.counters["serial_us"] = serial_time / iterations * 1e6;
+  benchmark_state.counters["communication_us"] =
+      communication_time / iterations * 1e6;
+  benchmark_state.counters["overlap_efficiency"] =
+      (serial_time - overlap_time) /
+      std::min(communication_time, serial_time - communication_time);
+  // Tokens per second
+  benchmark_state.SetItemsProcessed(benchmark_state.iterations() * B * S);
+}
+
+} // namespace
+
+BENCHMARK_CAPTURE(BenchmarkTransformerForward, half, DataType::Half)
+    ->Iterations(kIterations)
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_CAPTURE(BenchmarkTransformerForward, bfloat16, DataType::BFloat16)
+    ->Iterations(kIterations)
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond);
+
+} // namespace nvfuser
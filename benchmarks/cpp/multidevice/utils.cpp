@@ -0,0 +1,73 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#include <benchmarks/cpp/multidevice/utils.h>
+
+#include <cuda_utils.h>
+#include <exceptions.h>
+
+#include <cuda_runtime.h>
+
+#include <chrono>
+#include <sstream>
+
+namespace nvfuser {
+
+bool skipIfUnavailable(
+    benchmark::State& benchmark_state,
+    Communicator* communicator,
+    CommunicatorBackend backend) {
+  if (!communicator->is_available()) {
+    benchmark_state.SkipWithError("The communicator is not available");
+    return true;
+  }
+  if (!communicator->isBackendAvailable(backend)) {
+    std::stringstream ss;
+    ss << "Backend not available: " << backend;
+    benchmark_state.SkipWithError(ss.str().c_str());
+    return true;
+  }
+  return false;
+}
+
+double timeOnAllDevices(
+    Communicator* communicator,
+    const std::function<void()>& fn) {
+  NVFUSER_CUDA_RT_SAFE_CALL(cudaDeviceSynchronize());
+  communicator->barrier();
+  NVFUSER_CUDA_RT_SAFE_CALL(cudaDeviceSynchronize());
+
+  const auto start = std::chrono::steady_clock::now();
+  fn();
+  NVFUSER_CUDA_RT_SAFE_CALL(cudaDeviceSynchronize());
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+at::Tensor shardTensor(
+    Communicator* communicator,
+    at::Tensor tensor,
+    int64_t axis,
+    const DeviceMesh& mesh) {
+  const int64_t index = mesh.idxOf(communicator->deviceId());
+  NVF_ERROR(index >= 0, "The device is not in the mesh");
+  const int64_t extent = tensor.size(axis);
+  NVF_ERROR(
+      extent % mesh.size() == 0,
+      "Sharded axis must be evenly divisible by the mesh");
+  const int64_t stride = extent / mesh.size();
+  at::Tensor slice =
+      tensor.slice(axis, index * stride, (index + 1) * stride).contiguous();
+  // As MultiDeviceTest::shardTensor, until
+  // https://github.com/NVIDIA/Fuser/issues/2563
+  if (stride > 1) {
+    slice = slice.unsqueeze(0);
+  }
+  return slice;
+}
+
+} // namespace nvfuser
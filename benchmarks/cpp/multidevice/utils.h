@@ -0,0 +1,54 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#pragma once
+
+#include <multidevice/communicator.h>
+#include <multidevice/device_mesh.h>
+
+#include <benchmark/benchmark.h>
+
+#include <ATen/ATen.h>
+
+#include <functional>
+
+// Helpers of the multidevice benchmarks. These run with one process per
+// device, each of which runs every benchmark. The collectives require all the
+// processes to run the same benchmarks in the same order with the same number
+// of iterations, so the benchmarks are registered with a fixed number of
+// iterations, and the conditions to skip a benchmark must be the same on all
+// the processes. Only the first process reports the results.
+
+namespace nvfuser {
+
+// Skips the benchmark and returns true if the communicator or the given
+// backend isn't available.
+bool skipIfUnavailable(
+    benchmark::State& benchmark_state,
+    Communicator* communicator,
+    CommunicatorBackend backend);
+
+// Runs `fn` once all the processes are ready and returns the time, in
+// seconds, until the device finished the work posted by `fn`. The time
+// includes waiting for the other processes in the collectives.
+double timeOnAllDevices(
+    Communicator* communicator,
+    const std::function<void()>& fn);
+
+// The shard of `tensor` of this device along `axis`, with a leading device
+// axis, as MultiDeviceTest::shardTensor.
+at::Tensor shardTensor(
+    Communicator* communicator,
+    at::Tensor tensor,
+    int64_t axis,
+    const DeviceMesh& mesh);
+
+// Defined in communication.cpp. This registers a benchmark per communication
+// type and backend, which can't easily be done with BENCHMARK_CAPTURE.
+void registerCommunicationBenchmarks();
+
+} // namespace nvfuser
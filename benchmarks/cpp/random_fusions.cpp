@@ -0,0 +1,249 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#include <csrc/exceptions.h>
+#include <fusion.h>
+#include <fusion_profiler.h>
+#include <fusion_segmenter.h>
+#include <kernel_cache.h>
+#include <ops/all_ops.h>
+
+#include <benchmark/benchmark.h>
+
+#include <cuda_runtime.h>
+
+#include <benchmarks/cpp/utils.h>
+#include <tests/cpp/utils.h>
+
+#include <random>
+
+using namespace nvfuser;
+
+// Performance fuzzing of the schedulers. Each seed generates a random fusion
+// mixing pointwise ops, broadcasts, reductions, reshapes, transposes and cats
+// over random shapes, which runs through FusionExecutorCache like the other
+// benchmarks. Besides the kernel time and the heuristics in the label, the
+// "roofline_us" counter gives the time to read the inputs and write the
+// outputs of the fusion at the peak bandwidth of the GPU, i.e., a lower bound
+// of the time of any schedule, and "segments" gives the number of segments.
+//
+// tools/roofline_offenders.py ranks the seeds by their fraction of the
+// roofline. A fusion is reproduced by running its seed alone, e.g.
+//   NVFUSER_DUMP=fusion_ir_original bin/nvfuser_bench \
+//     --benchmark_filter='NvFuserScheduler_RandomFusion/seed:17/'
+
+namespace {
+
+// Extents of the generated tensors, which include multiples of the vector
+// and warp sizes as well as odd ones.
+const std::vector<int64_t> kExtents = {
+    1, 3, 7, 32, 64, 127, 128, 320, 768, 1000, 1024, 2048, 4096, 5120, 10240};
+constexpr int64_t kMaxNumel = 1 << 24;
+
+class RandomFusionGenerator {
+ public:
+  explicit RandomFusionGenerator(int64_t seed) : rng_(seed) {}
+
+  // Defines a random fusion in `fusion`. Returns its inputs.
+  std::vector<c10::IValue> generate(Fusion* fusion) {
+    FusionGuard fg(fusion);
+    fusion_ = fusion;
+    dtype_ = pick(2) == 0 ? DataType::Float : DataType::Half;
+    const int64_t rank = 2 + pick(2);
+    do {
+      shape_.clear();
+      for (int64_t i = 0; i < rank; i++) {
+        shape_.push_back(kExtents.at(pick(kExtents.size())));
+      }
+    } while (numel() > kMaxNumel || numel() < 1024);
+
+    live_.push_back(makeInput());
+    const int64_t num_ops = 3 + pick(8);
+    for (int64_t i = 0; i < num_ops; i++) {
+      addRandomOp();
+    }
+    addOutput(live_.back());
+    return std::move(inputs_);
+  }
+
+ private:
+  int64_t pick(size_t n) {
+    return static_cast<int64_t>(rng_() % n);
+  }
+
+  int64_t numel() const {
+    int64_t n = 1;
+    for (auto extent : shape_) {
+      n *= extent;
+    }
+    return n;
+  }
+
+  at::TensorOptions options() const {
+    return at::TensorOptions()
+        .dtype(data_type_to_aten(dtype_))
+        .device(at::kCUDA, 0);
+  }
+
+  // An input of the full shape, sometimes transposed in memory
+  TensorView* makeInput() {
+    const int64_t rank = static_cast<int64_t>(shape_.size());
+    std::vector<int64_t> shape = shape_;
+    const bool transposed = pick(4) == 0;
+    const int64_t dim0 = pick(rank);
+    const int64_t dim1 = (dim0 + 1 + pick(rank - 1)) % rank;
+    if (transposed) {
+      std::swap(shape[dim0], shape[dim1]);
+    }
+    TensorView* tv = makeContigConcreteTensor(shape, dtype_);
+    fusion_->addInput(tv);
+    inputs_.emplace_back(at::randn(shape, options()));
+    if (transposed) {
+      tv = transpose(tv, dim0, dim1);
+    }
+    return castOp(DataType::Float, tv);
+  }
+
+  // An input of one extent of the full shape, broadcast to the full shape
+  TensorView* makeBroadcastInput() {
+    const int64_t rank = static_cast<int64_t>(shape_.size());
+    const int64_t dim = pick(rank);
+    TensorView* tv = makeContigConcreteTensor({shape_.at(dim)}, dtype_);
+    fusion_->addInput(tv);
+    inputs_.emplace_back(at::randn({shape_.at(dim)}, options()));
+    std::vector<bool> is_broadcast(rank, true);
+    is_broadcast.at(dim) = false;
+    return broadcast(castOp(DataType::Float, tv), is_broadcast);
+  }
+
+  TensorView* pickLive() {
+    return live_.at(pick(live_.size()));
+  }
+
+  TensorView* unaryOp(TensorView* tv) {
+    switch (pick(5)) {
+      case 0:
+        return exp(tv);
+      case 1:
+        return tanh(tv);
+      case 2:
+        return relu(tv);
+      case 3:
+        return sigmoid(tv);
+      default:
+        return neg(tv);
+    }
+  }
+
+  TensorView* binaryOp(TensorView* a, TensorView* b) {
+    switch (pick(3)) {
+      case 0:
+        return add(a, b);
+      case 1:
+        return mul(a, b);
+      default:
+        return sub(a, b);
+    }
+  }
+
+  void addOutput(TensorView* tv) {
+    fusion_->addOutput(castOp(dtype_, tv));
+  }
+
+  void addRandomOp() {
+    const int64_t rank = static_cast<int64_t>(shape_.size());
+    TensorView* tv = pickLive();
+    TensorView* result = nullptr;
+    switch (pick(7)) {
+      case 0:
+        result = unaryOp(tv);
+        break;
+      case 1:
+        result = binaryOp(tv, pickLive());
+        break;
+      case 2:
+        result =
+            binaryOp(tv, pick(2) == 0 ? makeInput() : makeBroadcastInput());
+        break;
+      case 3: {
+        // Normalization-like reduction, whose result is broadcast back
+        const int64_t dim = pick(rank);
+        TensorView* reduced = pick(2) == 0 ? sum(tv, {dim}) : max(tv, {dim});
+        if (pick(3) == 0) {
+          addOutput(reduced);
+        }
+        std::vector<bool> is_broadcast(rank, false);
+        is_broadcast.at(dim) = true;
+        result = sub(tv, broadcast(reduced, is_broadcast));
+        break;
+      }
+      case 4: {
+        // Splits an extent, applies a pointwise op and merges it back
+        const int64_t dim = pick(rank);
+        const int64_t factor = int64_t(2) << pick(3);
+        if (shape_.at(dim) % factor != 0 || shape_.at(dim) == factor) {
+          result = unaryOp(tv);
+          break;
+        }
+        std::vector<int64_t> split_shape = shape_;
+        split_shape.at(dim) = shape_.at(dim) / factor;
+        split_shape.insert(split_shape.begin() + dim, factor);
+        result = reshape(
+            unaryOp(reshape(tv, shape_, split_shape)), split_shape, shape_);
+        break;
+      }
+      case 5:
+        // Cats change the shape so their results are only outputs.
+        addOutput(cat({tv, pickLive()}, pick(rank)));
+        return;
+      default:
+        addOutput(tv);
+        result = unaryOp(tv);
+        break;
+    }
+    live_.push_back(result);
+  }
+
+  std::mt19937_64 rng_;
+  Fusion* fusion_ = nullptr;
+  DataType dtype_ = DataType::Float;
+  std::vector<int64_t> shape_;
+  // Tensors of the full shape that later ops can use
+  std::vector<TensorView*> live_;
+  std::vector<c10::IValue> inputs_;
+};
+
+} // namespace
+
+static void NvFuserScheduler_RandomFusion(benchmark::State& benchmark_state) {
+  auto fusion = std::make_unique<Fusion>();
+  RandomFusionGenerator generator(benchmark_state.range(0));
+  std::vector<c10::IValue> inputs = generator.generate(fusion.get());
+  FusionExecutorCache fec(std::move(fusion));
+
+  const int64_t io_bytes =
+      runBenchmarkIterations(benchmark_state, &fec, inputs);
+  benchmark_state.SetBytesProcessed(benchmark_state.iterations() * io_bytes);
+
+  int device = 0;
+  NVFUSER_CUDA_RT_SAFE_CALL(cudaGetDevice(&device));
+  DeviceDescriptor device_desc;
+  DeviceDescriptor::generate(device_desc, device);
+  benchmark_state.counters["roofline_us"] =
+      (double)io_bytes / (device_desc.peak_bandwidth_gbs * 1e9) * 1e6;
+
+  FusionKernelRuntime* runtime = fec.getMostRecentKernelRuntime();
+  benchmark_state.counters["segments"] = runtime->isSegmented()
+      ? (double)runtime->fusionSegments()->groups().size()
+      : 1.0;
+}
+
+BENCHMARK(NvFuserScheduler_RandomFusion)
+    ->ArgName("seed")
+    ->DenseRange(0, 63)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseManualTime();
@@ -59,9 +59,13 @@ static void NvFuserScheduler_Reduction(
   at::manual_seed(0);
   auto options =
       at::TensorOptions().dtype(data_type_to_aten(dtype)).device(at::kCUDA, 0);
-  at::Tensor aten_input =
-      (reduction_dim ? at::randn({iter_size, reduction_size}, options)
-                     : at::randn({reduction_size, iter_size}, options));
+  const std::vector<int64_t> shape = reduction_dim
+      ? std::vector<int64_t>{iter_size, reduction_size}
+      : std::vector<int64_t>{reduction_size, iter_size};
+  // Integer sums use shared memory atomics for their block reductions
+  at::Tensor aten_input = isIntegralType(dtype)
+      ? at::randint(-100, 100, shape, options)
+      : at::randn(shape, options);
 
   std::vector<c10::IValue> aten_inputs({aten_input});
 
@@ -135,6 +139,12 @@ NVFUSER_BENCHMARK_DEFINE(
     NvFuserScheduler_Reduction,
     DataType::Half,
     0);
+NVFUSER_BENCHMARK_DEFINE(
+    NvFuserScheduler_Reduction_Outer_int32,
+    setupReduction,
+    NvFuserScheduler_Reduction,
+    DataType::Int32,
+    0);
 NVFUSER_BENCHMARK_DEFINE(
     NvFuserScheduler_Reduction_Inner_fp32,
     setupReduction,
@@ -220,6 +230,12 @@ NVFUSER_BENCHMARK_RUN(NvFuserScheduler_Reduction_Outer_fp16)
     ->Unit(benchmark::kMicrosecond)
     ->UseManualTime();
 
+NVFUSER_BENCHMARK_RUN(NvFuserScheduler_Reduction_Outer_int32)
+    ->RangeMultiplier(4)
+    ->Ranges({{128, 1024 * 1024}, {128, 1024}})
+    ->Unit(benchmark::kMicrosecond)
+    ->UseManualTime();
+
 NVFUSER_BENCHMARK_RUN(NvFuserScheduler_Reduction_Inner_fp32)
     // ->RangeMultiplier(2)
     ->Ranges({{1, 1024 * 1024}, {160, 320}})
@@ -0,0 +1,94 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#include <executor.h>
+#include <fusion.h>
+#include <ir/all_nodes.h>
+#include <ops/all_ops.h>
+#include <scheduler/all_schedulers.h>
+
+#include <benchmark/benchmark.h>
+
+#include <cuda_runtime.h>
+
+#include <benchmarks/cpp/utils.h>
+#include <tests/cpp/utils.h>
+
+using namespace nvfuser;
+
+// The rotate_half of rotary embeddings, cat([-x2, x1]) with x1 and x2 the
+// halves of the inner dimension of x, compared with a plain copy of x. Both
+// read and write each element once, so they should reach the same bandwidth.
+
+static void setupRotateHalf(Fusion* fusion, DataType dtype) {
+  FusionGuard fg(fusion);
+
+  TensorView* tv0 = makeContigTensor(2, dtype);
+  fusion->addInput(tv0);
+
+  Val* half = div(tv0->axis(1)->extent(), IrBuilder::create<Val>(2L));
+  TensorView* x1 = slice(tv0, {Slice(), {nullptr, half}});
+  TensorView* x2 = slice(tv0, {Slice(), {half, nullptr}});
+  TensorView* out =
+      cat({castOp(dtype, neg(castOp(DataType::Float, x2))), x1}, 1);
+
+  fusion->addOutput(out);
+}
+
+static void setupCopy(Fusion* fusion, DataType dtype) {
+  FusionGuard fg(fusion);
+
+  TensorView* tv0 = makeContigTensor(2, dtype);
+  fusion->addInput(tv0);
+  fusion->addOutput(set(tv0));
+}
+
+static void NvFuserScheduler_RotateHalfOrCopy(
+    benchmark::State& benchmark_state,
+    FusionExecutorCache* fusion_executor_cache,
+    DataType dtype) {
+  auto rows = benchmark_state.range(0);
+  auto cols = benchmark_state.range(1);
+
+  at::manual_seed(0);
+  auto options =
+      at::TensorOptions().dtype(data_type_to_aten(dtype)).device(at::kCUDA, 0);
+  at::Tensor t0 = at::randn({rows, cols}, options);
+
+  std::vector<c10::IValue> aten_inputs({t0});
+
+  runBenchmarkIterations(benchmark_state, fusion_executor_cache, aten_inputs);
+
+  benchmark_state.SetBytesProcessed(
+      int64_t(benchmark_state.iterations()) * rows * cols * 2 *
+      int64_t(dataTypeSize(dtype)));
+}
+
+//------------------------------------------------------------------------------
+
+NVFUSER_BENCHMARK_DEFINE(
+    NvFuserScheduler_RotateHalf_fp16,
+    setupRotateHalf,
+    NvFuserScheduler_RotateHalfOrCopy,
+    DataType::Half);
+
+NVFUSER_BENCHMARK_DEFINE(
+    NvFuserScheduler_Copy_fp16,
+    setupCopy,
+    NvFuserScheduler_RotateHalfOrCopy,
+    DataType::Half);
+
+// Rows of [batch * seq * heads] and the head sizes of common models
+NVFUSER_BENCHMARK_RUN(NvFuserScheduler_RotateHalf_fp16)
+    ->Ranges({{8 * 1024, 256 * 1024}, {64, 128}})
+    ->Unit(benchmark::kMicrosecond)
+    ->UseManualTime();
+
+NVFUSER_BENCHMARK_RUN(NvFuserScheduler_Copy_fp16)
+    ->Ranges({{8 * 1024, 256 * 1024}, {64, 128}})
+    ->Unit(benchmark::kMicrosecond)
+    ->UseManualTime();
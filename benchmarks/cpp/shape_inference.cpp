@@ -7,6 +7,7 @@
 // clang-format on
 #include <csrc/exceptions.h>
 #include <device_lower/lower2device.h>
+#include <evaluator_common.h>
 #include <executor.h>
 #include <fusion.h>
 #include <ir/all_nodes.h>
@@ -213,6 +214,33 @@ static void NvFuserScheduler_LayerNormForward_ShapeInference(
   LayerNormForward_ShapeInferenceBase(benchmark_state, true);
 }
 
+// Evaluates the extents of a loop domain transformed many times, which are
+// chains of int64 ceilDiv and mul instructions in NaiveValueMachine
+static void NvFuserScheduler_NaiveValueMachine_IndexArithmetic(
+    benchmark::State& benchmark_state) {
+  Fusion fusion;
+  FusionGuard fg(&fusion);
+  TensorView* tv0 = makeSymbolicTensor(4);
+  TensorView* tv1 = set(tv0);
+  fusion.addInput(tv0);
+  fusion.addOutput(tv1);
+  for (auto i : c10::irange(32)) {
+    tv1->split(-1, 2 + i % 7);
+    tv1->merge(0);
+  }
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  std::vector<c10::IValue> aten_inputs = {at::randn({64, 32, 16, 8}, options)};
+  KernelArgumentHolder args =
+      KernelArgumentHolder::createKernelArgumentHolder(aten_inputs);
+  PrecomputedValues precomputed_values(&fusion);
+
+  for (auto _ : benchmark_state) {
+    precomputed_values.bindInputs(args);
+    precomputed_values.evaluate();
+  }
+}
+
 BENCHMARK(NvFuserScheduler_LayerNormBackward_ShapeInference)
     ->Unit(benchmark::kMicrosecond);
 BENCHMARK(NvFuserScheduler_LayerNormForward_ShapeInference)
@@ -221,3 +249,5 @@ BENCHMARK(NvFuserScheduler_LayerNormBackward_NoShapeInferenceCachedBaseline)
     ->Unit(benchmark::kMicrosecond);
 BENCHMARK(NvFuserScheduler_LayerNormForward_NoShapeInferenceCachedBaseline)
     ->Unit(benchmark::kMicrosecond);
+BENCHMARK(NvFuserScheduler_NaiveValueMachine_IndexArithmetic)
+    ->Unit(benchmark::kMicrosecond);
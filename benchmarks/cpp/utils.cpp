@@ -10,6 +10,7 @@
 #include <cuda_utils.h>
 
 #include <fusion_profiler.h>
+#include <fusion_segmenter.h>
 #include <scheduler/all_schedulers.h>
 #include <tests/cpp/utils.h>
 
@@ -163,6 +164,19 @@ int64_t getSizeOfOutputs(const std::vector<at::Tensor>& outputs) {
   }
   return bytes;
 }
+
+// The heuristic parameters of a segment. Only the name of the scheduler is
+// given for the parameters that toString doesn't know about.
+std::string toString(const SchedulerEntry& scheduler_entry) {
+  const auto& params = scheduler_entry.params();
+  if (params->isA<ReductionParams>() || params->isA<PointwiseParams>() ||
+      params->isA<TransposeParams>()) {
+    return toString(params);
+  }
+  std::stringstream ss;
+  ss << scheduler_entry.heuristic();
+  return ss.str();
+}
 } // namespace
 
 int64_t runBenchmarkIterations(
@@ -187,14 +201,25 @@ int64_t runBenchmarkIterations(
               ->groups()
               .size() > 1;
 
-  auto compile_log = fusion_executor_cache->getMostRecentExecutorInfo();
-  auto params = toString(compile_log.params);
-  auto lparams = toString(compile_log.fusion_executor->lastLaunchParams());
-  // Only set if not segmented. In the case of segmented fusions,
-  // this could be confusing as the log would refect only the last
-  // segment. Revisit if necessary.
+  // The label records the heuristics of the fusion, so that
+  // tools/benchmark_regression.py can tell heuristic changes from performance
+  // changes. Segmented fusions list the heuristics of each segment.
   if (!segmented) {
+    auto compile_log = fusion_executor_cache->getMostRecentExecutorInfo();
+    auto params = toString(compile_log.params);
+    auto lparams = toString(compile_log.fusion_executor->lastLaunchParams());
     benchmark_state.SetLabel(params + lparams);
+  } else {
+    FusionKernelRuntime* runtime =
+        fusion_executor_cache->getMostRecentKernelRuntime();
+    const auto& heuristics = runtime->schedulerHeuristics()->heuristicsList();
+    std::stringstream label;
+    for (size_t i = 0; i < heuristics.size(); ++i) {
+      label << (i == 0 ? "" : " | ") << "Segment " << i << ": "
+            << toString(*heuristics.at(i))
+            << toString(runtime->executors().at(i).lastLaunchParams());
+    }
+    benchmark_state.SetLabel(label.str());
   }
 
   fusion_executor_cache->profile(false);
@@ -203,12 +228,19 @@ int64_t runBenchmarkIterations(
   NVFUSER_CUDA_RT_SAFE_CALL(cudaDeviceSynchronize());
   ProfilerOptionsGuard::getCurOptions().set(ProfilerOption::Enable);
 
+  double bandwidth_gbs = 0.0;
   for (auto _ : benchmark_state) {
     clearL2Cache();
     auto cg_outputs = fusion_executor_cache->runFusionWithInputs(aten_inputs);
     benchmark_state.SetIterationTime(
         FusionProfiler::profile().kernel_time_ms / 1000.0);
+    bandwidth_gbs += FusionProfiler::profile().effective_bandwidth_gbs;
   }
+  // Achieved bandwidth of the kernels, from the bytes that the executors
+  // report to the profiler, as opposed to the bytes of the fusion inputs and
+  // outputs that benchmarks usually give to SetBytesProcessed.
+  benchmark_state.counters["effective_bandwidth_gbs"] =
+      benchmark::Counter(bandwidth_gbs, benchmark::Counter::kAvgIterations);
 
   ProfilerOptionsGuard::getCurOptions().unset(ProfilerOption::Enable);
   // Sync everything up before we're finished, don't want to run ahead on the
@@ -0,0 +1,120 @@
+# SPDX-FileCopyrightText: Copyright (c) 2024-present NVIDIA CORPORATION & AFFILIATES.
+# All rights reserved.
+# SPDX-License-Identifier: BSD-3-Clause
+import pytest
+from nvfuser import FusionCache, FusionDefinition, DataType
+from .core import BENCHMARK_CONFIG, clear_cuda_cache
+import torch
+from functools import partial
+
+# Host overhead of the python frontend per call, on tensors small enough for
+# the kernel time to be negligible. Unlike the other benchmarks, these use
+# the wall-clock timer of pytest-benchmark rather than the kernel time, and
+# break the time of FusionDefinition.execute down into the layers timed by
+# FusionCache.host_times.
+
+# Calls per round, since a single call is too short to time reliably.
+ITERATIONS = 100
+
+
+def overhead_fusion(fd: FusionDefinition, num_inputs: int, num_ops: int):
+    inputs = [
+        fd.define_tensor(
+            shape=[-1], contiguity=[True], dtype=DataType.Float, is_cpu=False
+        )
+        for _ in range(num_inputs)
+    ]
+    a = inputs[0]
+    for x in inputs[1:]:
+        a = fd.ops.add(a, x)
+    for _ in range(num_ops):
+        a = fd.ops.neg(a)
+    fd.add_output(a)
+
+
+def set_host_times(benchmark) -> None:
+    """
+    Stores the average host time of each layer of the frontend per call, in
+    us, as extra information.
+    """
+    host_times = FusionCache.get().host_times(reset=True)
+    if host_times["definitions"] > 0:
+        benchmark.extra_info["finalize_definition (us)"] = (
+            host_times["finalize_definition_time_ns"]
+            / host_times["definitions"]
+            / 1e3
+        )
+    if host_times["executions"] > 0:
+        for layer in ["input_conversion", "execute", "output_wrapping"]:
+            benchmark.extra_info[f"{layer} (us)"] = (
+                host_times[f"{layer}_time_ns"] / host_times["executions"] / 1e3
+            )
+
+
+def define_fusion(num_inputs: int, num_ops: int) -> FusionDefinition:
+    with FusionDefinition() as fd:
+        overhead_fusion(fd, num_inputs, num_ops)
+    return fd
+
+
+@pytest.mark.parametrize("num_ops", [1, 16, 64])
+@pytest.mark.parametrize("num_inputs", [1, 4, 16])
+def test_definition_lookup_benchmark(
+    benchmark,
+    num_inputs: int,
+    num_ops: int,
+    disable_benchmarking: bool,
+):
+    """
+    Records a definition already in the FusionCache and looks it up.
+    """
+    FusionCache.reset()
+    define_fusion(num_inputs, num_ops)
+
+    if not disable_benchmarking:
+        FusionCache.get().host_times(reset=True)
+        benchmark.pedantic(
+            partial(define_fusion, num_inputs, num_ops),
+            rounds=BENCHMARK_CONFIG["rounds"],
+            iterations=ITERATIONS,
+            warmup_rounds=BENCHMARK_CONFIG["warmup_rounds"],
+        )
+        set_host_times(benchmark)
+
+
+@pytest.mark.parametrize("num_ops", [1, 16, 64])
+@pytest.mark.parametrize("num_inputs", [1, 4, 16])
+def test_execute_benchmark(
+    benchmark,
+    num_inputs: int,
+    num_ops: int,
+    disable_validation: bool,
+    disable_benchmarking: bool,
+):
+    """
+    Executes a compiled fusion, without synchronizing with the kernels.
+    """
+    clear_cuda_cache()
+    FusionCache.reset()
+    inputs = [torch.randn(4, device="cuda") for _ in range(num_inputs)]
+    fd = define_fusion(num_inputs, num_ops)
+
+    if not disable_validation:
+        eager_output = sum(inputs)
+        if num_ops % 2 == 1:
+            eager_output = -eager_output
+        fd.validate(inputs, [eager_output])
+
+    if not disable_benchmarking:
+        # Compiles the kernel.
+        fd.execute(inputs)
+        FusionCache.get().host_times(reset=True)
+        benchmark.pedantic(
+            fd.execute,
+            args=(inputs,),
+            rounds=BENCHMARK_CONFIG["rounds"],
+            iterations=ITERATIONS,
+            warmup_rounds=BENCHMARK_CONFIG["warmup_rounds"],
+        )
+        torch.cuda.synchronize()
+        set_host_times(benchmark)
@@ -0,0 +1,76 @@
+# SPDX-FileCopyrightText: Copyright (c) 2024-present NVIDIA CORPORATION & AFFILIATES.
+# All rights reserved.
+# SPDX-License-Identifier: BSD-3-Clause
+import json
+import subprocess
+import sys
+
+# Cold start of nvFuser: the wall-clock time from loading the library to the
+# first kernel launch of a trivial fusion, as paid by every new process, e.g.,
+# autoscaled inference servers. Each round runs in a fresh interpreter, so
+# nothing is cached in the process. torch is imported and CUDA initialized
+# before the timer starts, so that only nvFuser is measured. See
+# [ Note -- Lazy initialization ] in csrc/options.cpp.
+
+STARTUP_SCRIPT = """
+import json
+import time
+import torch
+
+torch.cuda.init()
+t = torch.ones(4, device="cuda")
+torch.cuda.synchronize()
+
+start = time.perf_counter()
+from nvfuser import FusionDefinition, DataType
+
+loaded = time.perf_counter()
+with FusionDefinition() as fd:
+    t0 = fd.define_tensor(
+        shape=[-1], contiguity=[True], dtype=DataType.Float, is_cpu=False
+    )
+    fd.add_output(fd.ops.neg(t0))
+defined = time.perf_counter()
+fd.execute([t])
+torch.cuda.synchronize()
+launched = time.perf_counter()
+
+print(
+    json.dumps(
+        {
+            "import": loaded - start,
+            "definition": defined - loaded,
+            "first_execution": launched - defined,
+            "total": launched - start,
+        }
+    )
+)
+"""
+
+
+def run_startup() -> dict:
+    result = subprocess.run(
+        [sys.executable, "-c", STARTUP_SCRIPT],
+        check=True,
+        capture_output=True,
+        text=True,
+    )
+    return json.loads(result.stdout.strip().splitlines()[-1])
+
+
+def test_startup_benchmark(benchmark, disable_benchmarking: bool):
+    """
+    Times a fresh process from `import nvfuser` to the first kernel launch.
+    """
+    times = run_startup()
+    assert times["total"] > 0
+
+    if not disable_benchmarking:
+        rounds = []
+        benchmark.pedantic(
+            lambda: rounds.append(run_startup()), rounds=5, iterations=1
+        )
+        for phase in ["import", "definition", "first_execution", "total"]:
+            benchmark.extra_info[f"{phase} (ms)"] = (
+                sum(r[phase] for r in rounds) / len(rounds) * 1e3
+            )
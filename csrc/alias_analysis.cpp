@@ -36,6 +36,7 @@ class AliasFinder : public OptOutConstDispatch {
   void handle(const ViewOp*) override;
   void handle(const LoadStoreOp*) override;
   void handle(const SliceOp*) override;
+  void handle(const PadOp*) override;
   void handle(const BroadcastOp*) override;
   void handle(const SqueezeOp*) override;
   void handle(const ExpandOp*) override;
@@ -56,6 +57,14 @@ class AliasFinder : public OptOutConstDispatch {
       TensorView* in,
       TensorView* out);
 
+  // Computes the preferred layout of `out`, a slice of `in` whose logical
+  // domain is produced from its root by Resizes. Used by SliceOp and by
+  // PadOp with non-positive pad widths.
+  static std::optional<Layout> computeSliceLayout(
+      const Layout& preferred_in_layout,
+      TensorView* in,
+      TensorView* out);
+
   AliasAnalysisResult& analysis_;
 };
 
@@ -273,16 +282,14 @@ void AliasFinder::handle(const LoadStoreOp* set) {
   analysis_.add(out, in, std::move(*out_root_layout));
 }
 
-// For future improvement, a PadOp with negative padding amount can also be
-// treated as a slice.
-void AliasFinder::handle(const SliceOp* slice) {
-  TensorView* in = slice->in();
-  TensorView* out = slice->out();
-
+/*static*/ std::optional<Layout> AliasFinder::computeSliceLayout(
+    const Layout& preferred_in_layout,
+    TensorView* in,
+    TensorView* out) {
   std::optional<Layout> out_layout =
-      mapInLayoutToOutRoot(analysis_.preferredLayout(in), in, out);
+      mapInLayoutToOutRoot(preferred_in_layout, in, out);
   if (!out_layout.has_value()) {
-    return;
+    return std::nullopt;
   }
 
   const std::vector<IterDomain*>& out_root = out->getRootDomain();
@@ -334,6 +341,44 @@ void AliasFinder::handle(const SliceOp* slice) {
     }
   }
 
+  return out_layout;
+}
+
+void AliasFinder::handle(const SliceOp* slice) {
+  TensorView* in = slice->in();
+  TensorView* out = slice->out();
+
+  std::optional<Layout> out_layout =
+      computeSliceLayout(analysis_.preferredLayout(in), in, out);
+  if (!out_layout.has_value()) {
+    return;
+  }
+
+  analysis_.add(out, in, std::move(*out_layout));
+}
+
+// A PadOp whose pad widths are all non-positive removes elements from the
+// borders of its input without adding any, so it's a slice.
+void AliasFinder::handle(const PadOp* pad) {
+  auto* in = dynamic_cast<TensorView*>(pad->in());
+  if (in == nullptr) {
+    return;
+  }
+  auto* out = pad->out()->as<TensorView>();
+
+  const std::vector<Val*> pad_widths = pad->getPadWidths();
+  if (!std::all_of(pad_widths.begin(), pad_widths.end(), [](Val* width) {
+        return width->isConstInt() && width->evaluate().as<int64_t>() <= 0;
+      })) {
+    return;
+  }
+
+  std::optional<Layout> out_layout =
+      computeSliceLayout(analysis_.preferredLayout(in), in, out);
+  if (!out_layout.has_value()) {
+    return;
+  }
+
   analysis_.add(out, in, std::move(*out_layout));
 }
 
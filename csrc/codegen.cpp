@@ -48,6 +48,25 @@ bool isTmaType(const DataType& dtype) {
       dtype.type);
 }
 
+//! Type of a kernel parameter as declared in the kernel signature
+std::string parameterType(Val* param) {
+  std::stringstream ss;
+  if (const auto tv = dynamic_cast<TensorView*>(param)) {
+    if (tv->isCpuScalar()) {
+      ss << "CpuScalarTensor<" << param->dtype() << ">";
+    } else {
+      ss << "Tensor<" << param->dtype() << ", "
+         << TensorDomain::noReductions(tv->getLogicalDomain()).size() << ", "
+         << TensorDomain::noReductions(tv->getMaybeAllocationDomain()).size()
+         << ">";
+    }
+  } else {
+    NVF_ERROR(param->isScalar()); // NOLINT (LLVM bug 48525)
+    ss << param->dtype();
+  }
+  return ss.str();
+}
+
 //! Utility class to build an argument list
 class ArgumentBuilder {
  public:
@@ -158,9 +177,11 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
  public:
   static std::string generateKernelDefinition(
       const kir::Kernel* kernel,
-      const std::string& kernel_name) {
-    CudaKernelGenerator codegen(kernel);
-    codegen.genDeclaration(kernel_name);
+      const std::string& kernel_name,
+      const std::unordered_map<const Val*, int64_t>& constant_values,
+      bool as_phase = false) {
+    CudaKernelGenerator codegen(kernel, constant_values);
+    codegen.genDeclaration(kernel_name, as_phase);
     codegen.startBlock();
     codegen.genPrologue();
     codegen.genBody();
@@ -170,13 +191,17 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
   }
 
  private:
-  explicit CudaKernelGenerator(const kir::Kernel* kernel) : kernel_(kernel) {
+  CudaKernelGenerator(
+      const kir::Kernel* kernel,
+      const std::unordered_map<const Val*, int64_t>& constant_values)
+      : kernel_(kernel), constant_values_(constant_values) {
     initStringStreamFormat(code_);
   }
 
   // aligned array of registers used in the kernel
   std::unordered_set<Val*> aligned_array_of_regs_;
 
+  using kir::ConstIrVisitor::dispatch;
   using kir::ConstIrVisitor::handle;
 
   void initStringStreamFormat(std::stringstream& ss) {
@@ -267,9 +292,19 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
     }
   }
 
-  // Generates the kernel function declaration
-  void genDeclaration(const std::string& kernel_name) {
-    code_ << "__global__ void " << kernel_name << "(";
+  // Generates the kernel function declaration. A phase is a device function
+  // taking the block index and grid size to use in place of blockIdx and
+  // gridDim, which the parameters shadow.
+  void genDeclaration(const std::string& kernel_name, bool as_phase) {
+    if (as_phase) {
+      code_ << "__device__ void " << kernel_name
+            << "(const dim3 blockIdx, const dim3 gridDim";
+      if (!kernel_->parameters().empty()) {
+        code_ << ", ";
+      }
+    } else {
+      code_ << "__global__ void " << kernel_name << "(";
+    }
 
     std::unordered_set<Val*> unique_args;
 
@@ -295,27 +330,11 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
         var_name_ss << "_duplicate_" << duplicate_counter++;
       }
 
-      if (const auto tv = dynamic_cast<TensorView*>(param)) {
-        if (tv->isCpuScalar()) {
-          code_ << " CpuScalarTensor<" << param->dtype() << "> "
-                << var_name_ss.str();
-        } else {
-          code_ << "Tensor<" << param->dtype() << ", "
-                << TensorDomain::noReductions(tv->getLogicalDomain()).size()
-                << ", "
-                << TensorDomain::noReductions(tv->getMaybeAllocationDomain())
-                       .size()
-                << "> " << var_name_ss.str();
-        }
-      } else {
-        NVF_ERROR(param->isScalar()); // NOLINT (LLVM bug 48525)
-        if (isTmaType(param->dtype())) {
-          code_ << "const __grid_constant__ " << param->dtype() << " "
-                << var_name_ss.str();
-        } else {
-          code_ << param->dtype() << " " << var_name_ss.str();
-        }
+      if (isTmaType(param->dtype())) {
+        NVF_ERROR(!as_phase, "TMA descriptors cannot be passed to a phase");
+        code_ << "const __grid_constant__ ";
       }
+      code_ << parameterType(param) << " " << var_name_ss.str();
 
       if (i + 1 != kernel_->parameters().size()) {
         code_ << ", ";
@@ -329,19 +348,24 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
   void genPrologue() {
     const auto& kernel_summary = kernel_->summary();
 
-    if (kernel_summary.has_philox_op) {
-      indent() << "uint4 rng_result;\n";
-      indent() << "nvfuser_index_t rng_subseq = -1;\n";
-      indent() << "nvfuser_index_t rng_offset = -1;\n";
+    // Each RNGOp keeps its own Philox result so that RNGOps interleaved in
+    // the same loop do not evict each other's results
+    for (auto rop : kernel_summary.rng_ops) {
+      indent() << "uint4 rng_result" << rop->name() << ";\n";
+      indent() << "nvfuser_index_t rng_cached_subseq" << rop->name()
+               << " = -1;\n";
+      indent() << "nvfuser_index_t rng_cached_offset" << rop->name()
+               << " = -1;\n";
     }
 
     // Do we have any dynamic shared memory buffers?
     const bool has_dynamic_smem =
         !kernel_summary.dynamic_smem_allocations.empty();
 
-    // Do we have any reductions?
+    // Do we have any reductions? Scans and sorts use the same workspace.
     const bool has_reductions = kernel_summary.has_block_reductions ||
-        kernel_summary.has_grid_reductions;
+        kernel_summary.has_grid_reductions || kernel_summary.has_block_scans ||
+        kernel_summary.has_block_sorts;
     const bool has_parallel_welford =
         kernel_summary.has_block_welford || kernel_summary.has_grid_welford;
 
@@ -359,6 +383,8 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
                            << kernel_summary.largest_smem_data_type << ")";
           if (has_parallel_welford) {
             smem_buf_size_ss << " * 3";
+          } else if (kernel_summary.has_block_sorts) {
+            smem_buf_size_ss << " * 2";
           }
           std::string smem_buf_size = smem_buf_size_ss.str();
           if (kernel_summary.has_outer_grouped_grid_welford) {
@@ -408,7 +434,23 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
   }
 
   void genBody() {
-    handle(kernel_->topLevelExprs());
+    const std::vector<Expr*>& exprs = kernel_->topLevelExprs();
+    if (!kernel_->summary().programmatic_launch) {
+      handle(exprs);
+      return;
+    }
+    // Only the allocations, which do not access global memory, run before
+    // the previous grid completes. See Note [Programmatic dependent launch]
+    // in executor.cpp
+    auto first_access = std::find_if(exprs.begin(), exprs.end(), [](Expr* e) {
+      return !e->isA<kir::Allocate>();
+    });
+    handle(std::vector<Expr*>(exprs.begin(), first_access));
+    code_ << "#if __CUDA_ARCH__ >= 900\n";
+    indent() << "asm volatile(\"griddepcontrol.wait;\" : : : \"memory\");\n";
+    indent() << "asm volatile(\"griddepcontrol.launch_dependents;\");\n";
+    code_ << "#endif\n";
+    handle(std::vector<Expr*>(first_access, exprs.end()));
   }
 
   void startBlock(bool continuation = false) {
@@ -553,6 +595,12 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
     }
     const auto def = s->definition();
     const bool has_alloc = alloc_set_.find(s) != alloc_set_.end();
+    // Allocated vals are assigned the constant by their definition instead
+    auto constant_it = constant_values_.find(s);
+    if (constant_it != constant_values_.end() && !has_alloc) {
+      stringify(constant_it->second, s->dtype());
+      return;
+    }
     const bool is_param = kernel_params_.find(s) != kernel_params_.end();
     if (def != nullptr && !has_alloc && !is_param) {
       if (def->isOneOf<GetAttr, GetItem, GetMetaData>() ||
@@ -715,9 +763,164 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
     }
   }
 
+  //! Prints a cast and its partner recorded by packCasts as one packed
+  //! conversion. See [ Note -- Packed casts ] in packed_cast.cpp
+  bool genPackedCast(const UnaryOp* uop) {
+    if (print_inline_) {
+      return false;
+    }
+    if (packed_cast_partners_.erase(uop) > 0) {
+      return true;
+    }
+    const auto& packed_casts = kernel_->summary().packed_casts;
+    auto it = packed_casts.find(uop);
+    if (it == packed_casts.end()) {
+      return false;
+    }
+    auto partner = it->second->as<UnaryOp>();
+    const auto cast_str =
+        cast_func_str({uop->in()->dtype(), uop->out()->dtype()});
+    NVF_ERROR(cast_str.has_value());
+    indent() << cast_str.value() << "x2(" << gen(uop->in()) << ", "
+             << gen(partner->in()) << ", " << gen(uop->out()) << ", "
+             << gen(partner->out()) << ");\n";
+    packed_cast_partners_.insert(partner);
+    return true;
+  }
+
+  //! Prints the body of a loop stepped by two by packArithmetic, keeping each
+  //! float intermediate as a pair of half or bfloat values. Returns false if
+  //! the loop is not packed. See [ Note -- Packed arithmetic ] in
+  //! packed_arithmetic.cpp
+  bool genPackedArithmeticBody(const ForLoop* loop) {
+    const auto& packed_casts = kernel_->summary().packed_arithmetic_casts;
+    std::unordered_set<const Expr*> partners;
+    std::optional<DataType> dtype;
+    std::vector<const TensorView*> registers;
+    for (const Expr* expr : loop->body().exprs()) {
+      auto it = packed_casts.find(expr);
+      if (it == packed_casts.end()) {
+        continue;
+      }
+      partners.insert(it->second);
+      auto uop = expr->as<UnaryOp>();
+      const bool is_unpack = uop->out()->dtype() == DataType::Float;
+      dtype = is_unpack ? uop->in()->dtype() : uop->out()->dtype();
+    }
+    if (!dtype.has_value()) {
+      return false;
+    }
+    const std::string packed_type =
+        dtype == DataType::Half ? "__halfx2" : "__bfloatx2";
+
+    auto is_register = [](const Val* val) {
+      auto ti = dynamic_cast<const kir::TensorIndex*>(val);
+      return ti != nullptr && ti->dtype() == DataType::Float &&
+          ti->view()->getMemoryType() == MemoryType::Local;
+    };
+    auto reg = [&](const Val* val) {
+      return genVariableName(val->as<kir::TensorIndex>()->view()) + "x2";
+    };
+    auto operand = [&](const Val* val) {
+      if (is_register(val)) {
+        return reg(val);
+      }
+      return packed_type + "_broadcast((float)" + genInline(val) + ")";
+    };
+
+    for (const Expr* expr : loop->body().exprs()) {
+      if (partners.count(expr) > 0) {
+        continue;
+      }
+      // The float intermediates are only declared as pairs
+      if (auto alloc = dynamic_cast<const kir::Allocate*>(expr);
+          alloc != nullptr && alloc->buffer()->isA<TensorView>() &&
+          alloc->buffer()->dtype() == DataType::Float &&
+          alloc->memoryType() == MemoryType::Local) {
+        continue;
+      }
+      if (auto uop = dynamic_cast<const UnaryOp*>(expr)) {
+        if (uop->getUnaryOpType() == UnaryOpType::Cast) {
+          auto partner = packed_casts.at(uop)->as<UnaryOp>();
+          if (is_register(uop->out())) {
+            indent() << packed_type << " " << reg(uop->out()) << " = __packx2("
+                     << gen(uop->in()) << ", " << gen(partner->in())
+                     << ");\n";
+          } else {
+            indent() << "__unpackx2(" << reg(uop->in()) << ", "
+                     << gen(uop->out()) << ", " << gen(partner->out())
+                     << ");\n";
+          }
+          continue;
+        }
+        const auto op_str = uop->getUnaryOpType() == UnaryOpType::Neg
+            ? "__negx2("
+            : "__relux2(";
+        indent() << packed_type << " " << reg(uop->out()) << " = " << op_str
+                 << operand(uop->in()) << ");\n";
+        continue;
+      }
+      if (auto bop = dynamic_cast<const BinaryOp*>(expr)) {
+        const auto op_str = bop->getBinaryOpType() == BinaryOpType::Add
+            ? "__addx2("
+            : (bop->getBinaryOpType() == BinaryOpType::Sub ? "__subx2("
+                                                           : "__mulx2(");
+        indent() << packed_type << " " << reg(bop->out()) << " = " << op_str
+                 << operand(bop->lhs()) << ", " << operand(bop->rhs())
+                 << ");\n";
+        continue;
+      }
+      // Scalars hoisted into the loop by later passes
+      dispatch(expr);
+    }
+    return true;
+  }
+
+  // Note [Fast math]
+  // With NVFUSER_ENABLE=fast_math, float unary ops with a fast_ variant in
+  // helpers.cu call it instead of the CUDA math library. The variants use
+  // the approximate PTX instructions, which trade accuracy for throughput:
+  //  - exp2 and log2 use ex2.approx and lg2.approx, with a maximum relative
+  //    error of about 2 ulp. exp and log scale their argument or result by a
+  //    rounded constant, so the relative error of exp grows with |x| by up
+  //    to about 6e-8 * |x|.
+  //  - tanh uses tanh.approx on sm75 and newer, with a maximum relative
+  //    error of 2^-11 over the whole range.
+  //  - erf uses the polynomial of Abramowitz and Stegun 7.1.26, with a
+  //    maximum absolute error of 1.5e-7 plus the error of fast_exp.
+  //  - sigmoid and silu are computed with fast_exp and an approximate
+  //    division.
+  // Denormal inputs and outputs are flushed to zero. Double and reduced
+  // precision ops are not affected, but since half and bfloat16 are computed
+  // in float, their ops use the fast variants as well.
+  static bool useFastMath(const UnaryOp* uop) {
+    if (!isOptionEnabled(EnableOption::FastMath) ||
+        uop->in()->dtype() != DataType::Float ||
+        uop->out()->dtype() != DataType::Float) {
+      return false;
+    }
+    switch (uop->getUnaryOpType()) {
+      case UnaryOpType::Exp:
+      case UnaryOpType::Exp2:
+      case UnaryOpType::Log:
+      case UnaryOpType::Log2:
+      case UnaryOpType::Tanh:
+      case UnaryOpType::Erf:
+      case UnaryOpType::Sigmoid:
+      case UnaryOpType::Silu:
+        return true;
+      default:
+        return false;
+    }
+  }
+
   void handle(const UnaryOp* uop) final {
     const auto op_type = uop->getUnaryOpType();
 
+    if (op_type == UnaryOpType::Cast && genPackedCast(uop)) {
+      return;
+    }
+
     if (!print_inline_) {
       indent() << gen(uop->out());
       if (!uop->out()->isScalar() && !uop->in()->isScalar()) {
@@ -744,6 +947,8 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
         code_ << "std::bit_cast<" << uop->out()->dtype() << ">";
       } else if (op_type == UnaryOpType::RefCast) {
         code_ << "(*reinterpret_cast<" << uop->out()->dtype() << "*>(&";
+      } else if (useFastMath(uop)) {
+        code_ << "fast_" << op_type;
       } else {
         code_ << op_type;
         if (needFloatSuffix(op_type) &&
@@ -776,13 +981,19 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
              << " = linear_index" << rop->name() << " % " << multiple << ";\n";
     indent() << "nvfuser_index_t rng_offset" << rop->name() << " = "
              << genInline(rop->getRNGOffsetVal()) << ";\n";
-    indent() << "if (rng_subseq != rng_subseq" << rop->name()
-             << " || rng_offset != rng_offset" << rop->name() << ") {\n";
-    indent() << "  rng_result = philox(" << genInline(rop->getRNGSeedVal())
-             << ", rng_subseq" << rop->name() << ", "
+    indent() << "if (rng_cached_subseq" << rop->name() << " != rng_subseq"
+             << rop->name() << " || rng_cached_offset" << rop->name()
+             << " != rng_offset" << rop->name() << ") {\n";
+    indent() << "  rng_result" << rop->name() << " = "
+             << (isOptionEnabled(EnableOption::FastRng) ? "fast_philox("
+                                                         : "philox(")
+             << genInline(rop->getRNGSeedVal()) << ", rng_subseq"
+             << rop->name() << ", "
              << "rng_offset" << rop->name() << ");\n";
-    indent() << "  rng_subseq = rng_subseq" << rop->name() << ";\n";
-    indent() << "  rng_offset = rng_offset" << rop->name() << ";\n";
+    indent() << "  rng_cached_subseq" << rop->name() << " = rng_subseq"
+             << rop->name() << ";\n";
+    indent() << "  rng_cached_offset" << rop->name() << " = rng_offset"
+             << rop->name() << ";\n";
     indent() << "}\n";
     auto op_type = rop->getRNGOpType();
     indent() << gen(rop->output(0)) << " = " << op_type;
@@ -796,7 +1007,7 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
       }
       // Generate other datatypes in double
     }
-    code_ << "(rng_result, rng_component" << rop->name();
+    code_ << "(rng_result" << rop->name() << ", rng_component" << rop->name();
     switch (op_type) {
       case RNGOpType::UniformRange:
       case RNGOpType::NormalGeneral: {
@@ -932,12 +1143,42 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
     return true;
   }
 
+  // Div and mod by a divisor with a precomputed multiplier. See
+  // [ Note -- Fast div and mod ] in fast_divmod.cpp
+  bool genFastDivMod(const BinaryOp* bop) {
+    const auto& magic_map = kernel_->summary().fast_div_mod_magic;
+    auto magic_it = magic_map.find(bop);
+    if (magic_it == magic_map.end()) {
+      return false;
+    }
+
+    std::stringstream fast_op;
+    if (bop->getBinaryOpType() == BinaryOpType::Div) {
+      fast_op << "fastDiv(" << gen(bop->lhs()) << ", "
+              << gen(magic_it->second) << ")";
+    } else {
+      fast_op << "fastMod(" << gen(bop->lhs()) << ", " << gen(bop->rhs())
+              << ", " << gen(magic_it->second) << ")";
+    }
+
+    if (print_inline_) {
+      code_ << fast_op.str();
+    } else {
+      indent() << gen(bop->out()) << " = " << fast_op.str() << ";\n";
+    }
+    return true;
+  }
+
   void handle(const BinaryOp* bop) final {
     // Try replacing pow with mul
     if (genPowerWithMul(bop)) {
       return;
     }
 
+    if (genFastDivMod(bop)) {
+      return;
+    }
+
     const auto op_type = bop->getBinaryOpType();
     if (print_inline_) {
       // Inline expression: `lhs op rhs`
@@ -1055,7 +1296,12 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
       indent() << gen(gop->out()) << " = ";
     }
 
-    code_ << gen(gop->array()) << "[" << gen(gop->index()) << "]";
+    auto constant_it = constant_values_.find(gop->out());
+    if (constant_it != constant_values_.end()) {
+      stringify(constant_it->second, gop->out()->dtype());
+    } else {
+      code_ << gen(gop->array()) << "[" << gen(gop->index()) << "]";
+    }
 
     if (!print_inline_) {
       code_ << ";\n";
@@ -1063,6 +1309,29 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
   }
 
   void handle(const IndexSelectOp* sop) final {
+    // A vectorized index_select loads a vector of a gathered row of the
+    // lookup tensor, which is always in global memory
+    if (auto out_ti = dynamic_cast<kir::TensorIndex*>(sop->output(0))) {
+      auto out_tv = out_ti->view();
+      int64_t vector_word_size = ir_utils::getVectorizeSize(out_tv);
+      if (vectorize_scope_ && vector_word_size != 1) {
+        if (out_tv->getMemoryType() == MemoryType::Global) {
+          indent() << "loadGlobalToGlobal<" << sop->output(0)->dtype()
+                   << ", /*vec_size=*/" << vector_word_size
+                   << ", /*is_volatile_to=*/false, /*is_volatile_from=*/false>("
+                   << "&" << gen(sop->output(0)) << ", &"
+                   << gen(sop->input(0)) << ");\n";
+        } else {
+          indent() << "loadGlobalToLocal<" << sop->output(0)->dtype()
+                   << ", /*vec_size=*/" << vector_word_size
+                   << ", /*is_volatile=*/false, CacheOp::AllLevels>(&"
+                   << gen(sop->output(0)) << ", &" << gen(sop->input(0))
+                   << ");\n";
+        }
+        return;
+      }
+    }
+
     // generate code
     if (!print_inline_) {
       indent() << gen(sop->output(0));
@@ -1087,6 +1356,84 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
     }
   }
 
+  //! Arguments shared by the block and grid scans before their work buffers
+  void genScanArgs(const ScanOp* sop, ArgumentBuilder& func_args) {
+    NVF_ERROR(sop->out()->isA<kir::TensorIndex>());
+    NVF_ERROR(sop->in()->isA<kir::TensorIndex>());
+    func_args.arg(gen(sop->out()));
+    func_args.arg(gen(sop->in()));
+    func_args.arg(genReductionOp(sop->getScanOpType(), sop->out()->dtype()));
+  }
+
+  //! Predicate and initial value arguments of the block and grid scans. The
+  //! inline predicate is used for both reading and writing.
+  void genScanPredAndInitArgs(const ScanOp* sop, ArgumentBuilder& func_args) {
+    const auto data_type = sop->out()->dtype();
+    func_args.arg(genStaticCast(genPtrType(data_type), "shared_mem"));
+    const std::string pred =
+        sop->predicate() == nullptr ? "true" : genInline(sop->predicate());
+    func_args.arg(pred).arg(pred);
+    func_args.arg(genCall(data_type, genInline(sop->init())));
+  }
+
+  // Serial scans are lowered to BinaryOps, so ScanOps are always block scans
+  void handle(const ScanOp* sop) final {
+    ArgumentBuilder template_args;
+    template_args.arg(isAligned());
+
+    ArgumentBuilder func_args;
+    genScanArgs(sop, func_args);
+    genScanPredAndInitArgs(sop, func_args);
+
+    indent() << genCall("scan::blockInclusiveScan", template_args, func_args)
+             << ";\n";
+  }
+
+  void handle(const kir::GridScan* gscan) final {
+    ArgumentBuilder template_args;
+    template_args.arg(isAligned());
+
+    ArgumentBuilder func_args;
+    genScanArgs(gscan, func_args);
+    for (auto alloc :
+         {gscan->aggregate_buffer(),
+          gscan->prefix_buffer(),
+          gscan->flag_buffer()}) {
+      NVF_ERROR(alloc->buffer()->isA<TensorView>());
+      func_args.arg("&")
+          .append(genVariableName(alloc->buffer()->as<TensorView>()))
+          .append("[0]");
+    }
+    genScanPredAndInitArgs(gscan, func_args);
+    func_args.arg(genInline(gscan->entrance_index()));
+    func_args.arg(genInline(gscan->entrances()));
+
+    indent() << genCall("scan::gridInclusiveScan", template_args, func_args)
+             << ";\n";
+  }
+
+  // Sorts are only lowered when the sorted ID is parallelized by TIDx
+  void handle(const SortOp* sop) final {
+    NVF_ERROR(sop->outValues()->isA<kir::TensorIndex>());
+    NVF_ERROR(sop->outIndices()->isA<kir::TensorIndex>());
+    NVF_ERROR(sop->in()->isA<kir::TensorIndex>());
+
+    ArgumentBuilder template_args;
+    template_args.arg(isAligned());
+    template_args.arg(sop->isDescending());
+
+    ArgumentBuilder func_args;
+    func_args.arg(gen(sop->outValues()));
+    func_args.arg(gen(sop->outIndices()));
+    func_args.arg(gen(sop->in()));
+    func_args.arg("shared_mem");
+    const std::string pred =
+        sop->predicate() == nullptr ? "true" : genInline(sop->predicate());
+    func_args.arg(pred).arg(pred);
+
+    indent() << genCall("sort::blockSort", template_args, func_args) << ";\n";
+  }
+
   std::string genReductionOp(BinaryOpType op_type, DataType data_type) {
     std::stringstream lambda;
     lambda << "[](" << data_type << " &a, " << data_type << " b) "
@@ -1165,13 +1512,62 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
              << ";\n";
   }
 
+  //! Reduce segments of lanes consecutive threads with warp shuffles. See
+  //! getMaybeSubWarpReductionLanes
+  void genSubWarpReduction(
+      const kir::TensorIndex* output,
+      const kir::TensorIndex* input,
+      const Val* init,
+      BinaryOpType reduction_op_type,
+      kir::Predicate* read_pred,
+      int64_t lanes) {
+    std::optional<std::string> redux_op;
+    if (output->dtype() == DataType::Int32) {
+      switch (reduction_op_type) {
+        case BinaryOpType::Add:
+          redux_op = "warp::ReduxOp::Add";
+          break;
+        case BinaryOpType::Min:
+          redux_op = "warp::ReduxOp::Min";
+          break;
+        case BinaryOpType::Max:
+          redux_op = "warp::ReduxOp::Max";
+          break;
+        default:
+          break;
+      }
+    }
+
+    ArgumentBuilder template_args;
+    template_args.arg(lanes);
+    if (redux_op.has_value()) {
+      template_args.arg(*redux_op);
+    }
+
+    ArgumentBuilder func_args;
+    func_args.arg(gen(output));
+    func_args.arg(gen(input));
+    func_args.arg(genReductionOp(reduction_op_type, output->dtype()));
+    NVF_ERROR(read_pred != nullptr && read_pred->hasValue());
+    func_args.arg(genInline(read_pred));
+    func_args.arg(genStaticCast(output->dtype(), genInline(init)));
+
+    indent() << genCall(
+                    redux_op.has_value() ? "warp::subWarpReduxTIDX"
+                                         : "warp::subWarpReduceTIDX",
+                    template_args,
+                    func_args)
+             << ";\n";
+  }
+
   void genBlockReduction(
       const kir::TensorIndex* output,
       const kir::TensorIndex* input,
       const Val* init,
       BinaryOpType reduction_op_type,
       kir::Predicate* read_pred,
-      kir::Predicate* write_pred) {
+      kir::Predicate* write_pred,
+      bool smem_atomic_add = false) {
     const auto par_domains = ir_utils::getParallelDomains(output);
     // Get parallel reduction domains
     const bool tidx =
@@ -1193,7 +1589,9 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
     ArgumentBuilder func_args;
     func_args.arg(gen(output));
     func_args.arg(gen(input));
-    func_args.arg(genReductionOp(reduction_op_type, output->dtype()));
+    if (!smem_atomic_add) {
+      func_args.arg(genReductionOp(reduction_op_type, output->dtype()));
+    }
     func_args.arg(genStaticCast(genPtrType(data_type), "shared_mem"));
     NVF_ERROR(read_pred != nullptr && read_pred->hasValue());
     func_args.arg(genInline(read_pred));
@@ -1207,7 +1605,23 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
     }
     func_args.arg(genCall(data_type, genInline(init)));
 
-    indent() << genCall("blockReduce", template_args, func_args) << ";\n";
+    indent() << genCall(
+                    smem_atomic_add ? "blockReduceAtomicAdd" : "blockReduce",
+                    template_args,
+                    func_args)
+             << ";\n";
+  }
+
+  //! Whether the block reduction of rop can use shared memory atomics, see
+  //! ReductionOp::requestSmemAtomicBlockReduction
+  static bool useSmemAtomicBlockReduction(const ReductionOp* rop) {
+    if (!rop->smemAtomicBlockReductionRequested() ||
+        rop->getReductionOpType() != BinaryOpType::Add) {
+      return false;
+    }
+    const auto dtype = rop->out()->dtype();
+    return dtype == DataType::Int32 || dtype == DataType::Int ||
+        dtype == DataType::Float || dtype == DataType::Double;
   }
 
   void handle(const ReductionOp* rop) final {
@@ -1226,8 +1640,13 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
         "ReductionOp does not support block parallelization. GridReductionOp must be used. ",
         rop->toString());
 
+    const auto& sub_warp_lanes = kernel_->summary().sub_warp_reduction_lanes;
+
     if (!has_block_reduce) {
       genSerialReduction(output, input, op_type);
+    } else if (auto it = sub_warp_lanes.find(rop); it != sub_warp_lanes.end()) {
+      genSubWarpReduction(
+          output, input, rop->init(), op_type, rop->predicate(), it->second);
     } else if (
         auto reduction_id = ir_utils::getMaybeWarpReductionDim(output, input)) {
       genWarpReduction(output, input, rop->init(), op_type, rop->predicate());
@@ -1238,7 +1657,8 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
           rop->init(),
           op_type,
           rop->predicate(),
-          rop->writePredicate());
+          rop->writePredicate(),
+          useSmemAtomicBlockReduction(rop));
     }
   }
 
@@ -1394,6 +1814,43 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
     }
   }
 
+  //! The inputs of a WelfordOp merging the partial results of a Fast
+  //! WelfordOp hold sums and sums of squares. See Note [Welford modes].
+  void genWelfordSumsToMoments(const WelfordOp* wop) {
+    if (wop->mode() != WelfordMode::Fast || wop->singleValue()) {
+      return;
+    }
+    ArgumentBuilder func_args;
+    func_args.arg(gen(wop->inAvg()));
+    func_args.arg(gen(wop->inVar()));
+    func_args.arg(gen(wop->inN()));
+    indent() << genCall("welfordSumsToMoments", func_args) << ";\n";
+  }
+
+  //! Welford of segments of lanes consecutive threads with warp shuffles. See
+  //! getMaybeSubWarpReductionLanes
+  void genSubWarpWelford(const WelfordOp* wop, int64_t lanes) {
+    const auto data_type = wop->outAvg()->dtype();
+    const auto index_type = wop->outN()->dtype();
+
+    ArgumentBuilder template_args;
+    template_args.arg(lanes);
+
+    ArgumentBuilder func_args;
+    func_args.arg(gen(wop->outAvg()));
+    func_args.arg(gen(wop->outVar()));
+    func_args.arg(gen(wop->outN()));
+    func_args.arg(gen(wop->inAvg()));
+    func_args.arg(genStaticCast(data_type, gen(wop->inVar())));
+    func_args.arg(genStaticCast(index_type, gen(wop->inN())));
+    NVF_ERROR(wop->predicate() != nullptr && wop->predicate()->hasValue());
+    func_args.arg(genInline(wop->predicate()));
+    func_args.arg(genStaticCast(data_type, 0));
+
+    indent() << genCall("warp::subWarpWelfordTIDX", template_args, func_args)
+             << ";\n";
+  }
+
   void genBlockWelford(const WelfordOp* wop) {
     NVF_ERROR(
         ir_utils::getTvOutput(wop)->domain()->hasBlockReduction(),
@@ -1495,16 +1952,38 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
     const bool has_block_reduce = domain->hasBlockReduction();
     const bool has_grid_reduce = domain->hasGridReduction();
 
-    if (!has_block_reduce && !has_grid_reduce) {
-      indent() << "welfordCombine ("
+    genWelfordSumsToMoments(wop);
+
+    if (wop->mode() == WelfordMode::Fast && wop->singleValue() &&
+        !has_block_reduce && !has_grid_reduce) {
+      ArgumentBuilder func_args;
+      func_args.arg(gen(out_avg));
+      func_args.arg(gen(out_var));
+      func_args.arg(gen(out_N));
+      func_args.arg(gen(in_avg));
+      indent() << genCall("welfordAccumulateSums", func_args) << ";\n";
+    } else if (!has_block_reduce && !has_grid_reduce) {
+      const bool compensated = welford_compensations_.count(
+                                   out_avg->as<kir::TensorIndex>()->view()) &&
+          welford_compensations_.count(out_var->as<kir::TensorIndex>()->view());
+      indent() << (compensated ? "welfordCombineCompensated ("
+                               : "welfordCombine (")
                << "\n";
       indent() << kTab << gen(out_avg) << ",\n";
       indent() << kTab << gen(out_var) << ",\n";
       indent() << kTab << gen(out_N) << ",\n";
+      if (compensated) {
+        indent() << kTab << genWelfordCompensation(out_avg) << ",\n";
+        indent() << kTab << genWelfordCompensation(out_var) << ",\n";
+      }
       indent() << kTab << gen(in_avg) << ",\n";
       indent() << kTab << "(" << out_avg->dtype() << ")" << gen(in_var)
                << ",\n";
       indent() << kTab << "(" << out_N->dtype() << ")" << gen(in_N) << ");\n";
+    } else if (auto it =
+                   kernel_->summary().sub_warp_reduction_lanes.find(wop);
+               it != kernel_->summary().sub_warp_reduction_lanes.end()) {
+      genSubWarpWelford(wop, it->second);
     } else if (has_block_reduce) {
       genBlockWelford(wop);
     }
@@ -1615,6 +2094,30 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
     }
   }
 
+  // See Note [Profiled kernel regions] in device_lower/pass/instrument.cpp
+  void dispatch(const Expr* expr) final {
+    if (!kernel_->profile().isProfiledRegion(expr)) {
+      kir::ConstIrVisitor::dispatch(expr);
+      return;
+    }
+    const auto& profile = kernel_->profile();
+    const auto& regions = profile.regions();
+    auto region_it =
+        std::find_if(regions.begin(), regions.end(), [&](const auto& region) {
+          return region.expr == expr;
+        });
+    NVF_ERROR(region_it != regions.end());
+    const auto indices = profile.getIndicesInProfileBuffer(*region_it);
+    const std::string buffer = genVariableName(profile.getBuffer());
+    const std::string start =
+        "profile_region_start_" + std::to_string(region_it->index);
+    indent() << "int64_t " << start << " = kernel_profile::startRegion();\n";
+    kir::ConstIrVisitor::dispatch(expr);
+    indent() << "kernel_profile::endRegion(" << buffer << "[" << indices[0]
+             << "], " << buffer << "[" << indices[1] << "], " << start
+             << ");\n";
+  }
+
   void handle(const kir::GridReduction* grop) final {
     NVF_ERROR(grop->out()->isA<kir::TensorIndex>());
 
@@ -1630,6 +2133,16 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
       return;
     }
 
+    if (grop->isCluster()) {
+      generateClusterReduction(grop);
+      return;
+    }
+
+    if (grop->isAtomic()) {
+      generateAtomicGridReduction(grop);
+      return;
+    }
+
     NVF_ERROR(grop->reduction_buffer()->buffer()->isA<TensorView>());
     NVF_ERROR(grop->sync_buffer()->buffer()->isA<TensorView>());
     const auto work_buffer =
@@ -1750,6 +2263,91 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
     indent() << kTab << func_args << ");\n";
   }
 
+  void generateClusterReduction(const kir::GridReduction* grop) {
+    NVF_ERROR(grop->isCluster());
+
+    const auto out = grop->out()->as<kir::TensorIndex>();
+
+    const auto data_type = grop->out()->dtype();
+    const auto op_type = grop->getReductionOpType();
+
+    // Same flags as gridReduce. The result is held by all blocks of the
+    // cluster, so allreduce does not need anything else.
+    const auto par_domains =
+        ir_utils::getParallelDomains(ir_utils::getTvOutput(grop));
+    ArgumentBuilder template_args;
+    for (const ParallelType pt : kParallelTypeThreads) {
+      const bool parallel_reduction =
+          par_domains.find(pt) != par_domains.end() &&
+          par_domains.at(pt)->isReduction();
+      NVF_ERROR(
+          !(parallel_reduction && grop->threadPredicate().get(pt)),
+          "Cannot reduce predicated axis: ",
+          pt);
+      template_args.arg(parallel_reduction);
+    }
+    template_args.arg(isAligned());
+
+    ArgumentBuilder func_args(block_nest_level_ + 1, kTab);
+    func_args.arg(gen(grop->out()));
+    func_args.arg(gen(grop->in()));
+    func_args.arg(genReductionOp(op_type, out->dtype()));
+    func_args.arg(genCall("static_cast", ptrType(data_type), "shared_mem"));
+    // read and write predicates
+    NVF_ERROR(grop->predicate() != nullptr && grop->predicate()->hasValue());
+    const auto read_pred = genInline(grop->predicate());
+    func_args.arg(read_pred);
+    if (grop->writePredicate() != nullptr) {
+      NVF_ERROR(grop->writePredicate()->hasValue());
+      func_args.arg(genInline(grop->writePredicate()));
+    } else {
+      func_args.arg(read_pred);
+    }
+    // Init val
+    func_args.arg(genCall(data_type, genInline(grop->init())));
+
+    indent() << "cluster::clusterReduce<" << template_args << ">(\n";
+    indent() << kTab << func_args << ");\n";
+  }
+
+  void generateAtomicGridReduction(const kir::GridReduction* grop) {
+    NVF_ERROR(grop->isAtomic());
+
+    const auto data_type = grop->out()->dtype();
+
+    // Only the block reduction is explicit. Blocks are reduced by the atomics
+    const auto par_domains =
+        ir_utils::getParallelDomains(ir_utils::getTvOutput(grop));
+    ArgumentBuilder template_args;
+    for (const ParallelType pt : kParallelTypeTIDs) {
+      template_args.arg(
+          par_domains.find(pt) != par_domains.end() &&
+          par_domains.at(pt)->isReduction());
+    }
+    template_args.arg(isAligned());
+    template_args.arg(useSmemAtomicBlockReduction(grop));
+
+    ArgumentBuilder func_args(block_nest_level_ + 1, kTab);
+    func_args.arg(gen(grop->out()));
+    func_args.arg(gen(grop->in()));
+    func_args.arg(genCall("static_cast", ptrType(data_type), "shared_mem"));
+    // read and write predicates
+    NVF_ERROR(grop->predicate() != nullptr && grop->predicate()->hasValue());
+    const auto read_pred = genInline(grop->predicate());
+    func_args.arg(read_pred);
+    if (grop->writePredicate() != nullptr) {
+      NVF_ERROR(grop->writePredicate()->hasValue());
+      func_args.arg(genInline(grop->writePredicate()));
+    } else {
+      func_args.arg(read_pred);
+    }
+    // Init val
+    func_args.arg(genCall(data_type, genInline(grop->init())));
+
+    indent() << "reduction::gridReduceAtomicAdd<" << template_args << ">(\n";
+    indent() << kTab << func_args << ");\n";
+  }
+
   void generateGridAllreduce(const kir::GridReduction* grop) {
     NVF_ERROR(grop->isAllreduce());
 
@@ -2499,6 +3097,11 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
     const auto n_buffer = gwop->N_buffer()->buffer()->as<TensorView>();
     const auto sync_buffer = gwop->sync_buffer()->buffer()->as<TensorView>();
 
+    // Otherwise, the inputs are converted by the separate block reduction
+    if (!domain->hasBlockReduction() || wop->isAllreduce()) {
+      genWelfordSumsToMoments(wop);
+    }
+
     if (wop->isAllreduce()) {
       generateGridAllreduce(gwop);
       return;
@@ -2818,6 +3421,8 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
           grouped_rop->writePredicate());
     }
 
+    const auto& sub_warp_lanes = kernel_->summary().sub_warp_reduction_lanes;
+
     for (const auto i : c10::irange(num_grouped_exprs)) {
       NVF_ERROR(grouped_rop->output(i)->isA<kir::TensorIndex>());
 
@@ -2836,6 +3441,15 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
 
       if (!has_block_reduce) {
         genSerialReduction(output, input, op_type);
+      } else if (auto it = sub_warp_lanes.find(grouped_rop);
+                 it != sub_warp_lanes.end()) {
+        genSubWarpReduction(
+            output,
+            input,
+            grouped_rop->initVal(i),
+            op_type,
+            grouped_rop->predicate(),
+            it->second);
       } else if (
           auto reduction_id =
               ir_utils::getMaybeWarpReductionDim(output, input)) {
@@ -2900,7 +3514,9 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
              << "; " << gen_index << " < " << gen_stop << "; "
              << step_code.str() << ") ";
     startBlock(true);
-    kir::ConstIrVisitor::handle(loop);
+    if (!genPackedArithmeticBody(loop)) {
+      kir::ConstIrVisitor::handle(loop);
+    }
     endBlock();
   }
 
@@ -3009,6 +3625,26 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
           NVF_ERROR(false, "Unexpected memory type");
       }
     }
+
+    if (alloc->memoryType() == MemoryType::Local &&
+        isCompensatedWelfordOutput(tv)) {
+      indent() << buffer_dtype << " " << genVariableName(tv) << "_comp["
+               << genInline(size) << "] = {};\n";
+      welford_compensations_.insert(tv);
+    }
+  }
+
+  //! Check if tv is the avg or var output of a Compensated WelfordOp
+  static bool isCompensatedWelfordOutput(const TensorView* tv) {
+    auto wop = dynamic_cast<WelfordOp*>(tv->definition());
+    return wop != nullptr && wop->mode() == WelfordMode::Compensated &&
+        (wop->outAvg() == tv || wop->outVar() == tv);
+  }
+
+  std::string genWelfordCompensation(const Val* out) {
+    const auto ti = out->as<kir::TensorIndex>();
+    return genVariableName(ti->view()) + "_comp[" + genInline(ti->index()) +
+        "]";
   }
 
   void handle(const kir::Asm* asm_) final {
@@ -3153,7 +3789,9 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
 
   void handle(const kir::BlockSync* sync) final {
     // Use a custom synchronization method if enabled
-    if (getNvFuserEnv("USE_BLOCK_SYNC_ATOMIC")) {
+    if (sync->isWarpSync() && isAligned()) {
+      indent() << "__syncwarp();\n";
+    } else if (getNvFuserEnv("USE_BLOCK_SYNC_ATOMIC")) {
       indent() << "block_sync::sync();\n";
     } else if (isAligned()) {
       indent() << "__syncthreads();\n";
@@ -3363,13 +4001,22 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
 
   // Mark when we are inside of a vectorized for-loop
   bool vectorize_scope_ = false;
+
+  // Casts already printed as part of a packed conversion
+  std::unordered_set<const Expr*> packed_cast_partners_;
+
   //! Keep track of Allocate node for Val. Used to determine if Val
   //! should be inlined.
   std::unordered_set<const Val*> alloc_set_;
+  //! Local outputs of Compensated WelfordOps, for which a compensation
+  //! array named with a _comp suffix is allocated
+  std::unordered_set<const TensorView*> welford_compensations_;
   //! Keep track of grouped loops
   std::deque<const ForLoop*> grouped_loops_;
   //! Used to replace symbolic indices with concrete values
   std::unordered_map<const Val*, int64_t> index_replacement_map_;
+  //! Vals the kernel is specialized on, printed as constants
+  const std::unordered_map<const Val*, int64_t>& constant_values_;
   //! Keep track of thread alignment property
   std::vector<bool> aligned_scope_exprs_;
   //! Keep track of the Val* and its generated variable name
@@ -3382,9 +4029,28 @@ class CudaKernelGenerator : private kir::ConstIrVisitor {
 
 std::string generateCudaKernel(
     const kir::Kernel* kernel,
-    const std::string& kernel_name) {
+    const std::string& kernel_name,
+    const std::unordered_map<const Val*, int64_t>& constant_values) {
   FUSER_PERF_SCOPE("generateCudaKernel");
-  return CudaKernelGenerator::generateKernelDefinition(kernel, kernel_name);
+  return CudaKernelGenerator::generateKernelDefinition(
+      kernel, kernel_name, constant_values);
+}
+
+std::string generateCudaPhase(
+    const kir::Kernel* kernel,
+    const std::string& phase_name) {
+  FUSER_PERF_SCOPE("generateCudaPhase");
+  return CudaKernelGenerator::generateKernelDefinition(
+      kernel, phase_name, {}, /*as_phase=*/true);
+}
+
+std::vector<std::string> generateParameterTypes(const kir::Kernel* kernel) {
+  std::vector<std::string> types;
+  types.reserve(kernel->parameters().size());
+  for (Val* param : kernel->parameters()) {
+    types.push_back(parameterType(param));
+  }
+  return types;
 }
 
 } // namespace codegen
@@ -12,14 +12,32 @@
 #include <visibility.h>
 
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace nvfuser {
 namespace codegen {
 
-//! Generates a CUDA kernel definition for the given kernel
+//! Generates a CUDA kernel definition for the given kernel. Vals in
+//! constant_values are printed as the given constants instead of being
+//! computed, e.g. to specialize a kernel on the extents of its inputs.
 NVF_API std::string generateCudaKernel(
     const kir::Kernel* kernel,
-    const std::string& kernel_name = "CUDAGeneratedKernel");
+    const std::string& kernel_name = "CUDAGeneratedKernel",
+    const std::unordered_map<const Val*, int64_t>& constant_values = {});
+
+//! Generates the body of the given kernel as a device function named
+//! phase_name, to be called from a kernel running several phases. The
+//! function takes the block index and the grid size the kernel would have
+//! been launched with, followed by the parameters of the kernel.
+NVF_API std::string generateCudaPhase(
+    const kir::Kernel* kernel,
+    const std::string& phase_name);
+
+//! Types of the parameters of the kernel as they are declared by
+//! generateCudaKernel, e.g. "Tensor<float, 2, 2>"
+NVF_API std::vector<std::string> generateParameterTypes(
+    const kir::Kernel* kernel);
 
 } // namespace codegen
 } // namespace nvfuser
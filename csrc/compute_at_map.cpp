@@ -705,9 +705,10 @@ void IterDomainGraph::build(Fusion* fusion) {
     }
   }
 
-  innermost_nodes_ = permissive_resize_nodes_;
-  // Build almost exact map by forwarding through broadcast axes
-  almost_exact_nodes_ = exact_nodes_;
+  // Build almost exact map by forwarding through broadcast axes. Both maps
+  // are built with many merges and no query, so they use union-find.
+  UnionFind<IterDomain*> innermost_nodes(permissive_resize_nodes_);
+  UnionFind<IterDomain*> almost_exact_nodes(exact_nodes_);
   std::unordered_set<Expr*> visited;
   auto all_elements = exact_nodes_.getAllElements();
   for (auto entry : all_elements.vector()) {
@@ -720,33 +721,35 @@ void IterDomainGraph::build(Fusion* fusion) {
     }
     if (auto merge = dynamic_cast<Merge*>(def)) {
       if (merge->inner()->extent()->isOneInt()) {
-        almost_exact_nodes_.mapEntries(merge->outer(), merge->out());
-        innermost_nodes_.mapEntries(merge->outer(), merge->out());
+        almost_exact_nodes.mapEntries(merge->outer(), merge->out());
+        innermost_nodes.mapEntries(merge->outer(), merge->out());
       } else {
         // maps to inner dimension, even though it's not an identical mapping.
         // This is used for transpose scheduler to map inner loop dimensions
-        innermost_nodes_.mapEntries(merge->inner(), merge->out());
+        innermost_nodes.mapEntries(merge->inner(), merge->out());
       }
       if (merge->outer()->extent()->isOneInt()) {
-        almost_exact_nodes_.mapEntries(merge->inner(), merge->out());
+        almost_exact_nodes.mapEntries(merge->inner(), merge->out());
       }
     } else if (auto split = dynamic_cast<Split*>(def)) {
       if (split->factor()->isOneInt()) {
         if (split->innerSplit()) {
-          almost_exact_nodes_.mapEntries(split->in(), split->outer());
+          almost_exact_nodes.mapEntries(split->in(), split->outer());
         } else {
-          almost_exact_nodes_.mapEntries(split->in(), split->inner());
+          almost_exact_nodes.mapEntries(split->in(), split->inner());
         }
       }
       if (split->factor()->isOneInt() && split->innerSplit()) {
-        innermost_nodes_.mapEntries(split->in(), split->outer());
+        innermost_nodes.mapEntries(split->in(), split->outer());
       } else {
         // maps to inner dimension, even though it's not an identical mapping.
         // This is used for transpose scheduler to map inner loop dimensions
-        innermost_nodes_.mapEntries(split->in(), split->inner());
+        innermost_nodes.mapEntries(split->in(), split->inner());
       }
     }
   }
+  innermost_nodes_ = innermost_nodes.toDisjointSets();
+  almost_exact_nodes_ = almost_exact_nodes.toDisjointSets();
 
   self_mapping_info_ = findFirstSelfMapping(fusion, *this);
 }
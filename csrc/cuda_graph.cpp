@@ -0,0 +1,204 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#include <cuda_graph.h>
+
+#include <cuda_utils.h>
+#include <debug.h>
+#include <executor.h>
+#include <instrumentation.h>
+#include <options.h>
+
+#include <c10/cuda/CUDACachingAllocator.h>
+#include <c10/util/irange.h>
+
+#include <algorithm>
+#include <cstring>
+#include <variant>
+
+namespace nvfuser {
+
+CudaGraph::~CudaGraph() {
+  if (graph_exec_ != nullptr) {
+    NVFUSER_CUDA_RT_SAFE_CALL(cudaGraphExecDestroy(graph_exec_));
+  }
+  if (graph_ != nullptr) {
+    NVFUSER_CUDA_RT_SAFE_CALL(cudaGraphDestroy(graph_));
+  }
+}
+
+void CudaGraph::beginCapture(cudaStream_t stream) {
+  NVF_ERROR(graph_ == nullptr, "CUDA graph has already been captured");
+  NVFUSER_CUDA_RT_SAFE_CALL(
+      cudaStreamBeginCapture(stream, cudaStreamCaptureModeRelaxed));
+}
+
+void CudaGraph::abortCapture(cudaStream_t stream) {
+  cudaGraph_t partial_graph = nullptr;
+  // The capture may already have been invalidated by the failure, in which
+  // case ending it reports an error we are not interested in.
+  if (cudaStreamEndCapture(stream, &partial_graph) == cudaSuccess &&
+      partial_graph != nullptr) {
+    NVFUSER_CUDA_RT_SAFE_CALL(cudaGraphDestroy(partial_graph));
+  }
+  // Clear the sticky capture error, if any
+  (void)cudaGetLastError();
+  retained_buffers_.clear();
+}
+
+void CudaGraph::endCapture(
+    cudaStream_t stream,
+    const std::vector<FusionExecutor>& executors,
+    size_t cache_id,
+    const std::unordered_set<void*>& input_ptrs) {
+  FUSER_PERF_SCOPE("CudaGraph::endCapture");
+  NVFUSER_CUDA_RT_SAFE_CALL(cudaStreamEndCapture(stream, &graph_));
+  NVFUSER_CUDA_RT_SAFE_CALL(
+      cudaGraphInstantiateWithFlags(&graph_exec_, graph_, 0));
+
+#if (CUDA_VERSION >= 12000)
+  size_t num_nodes = 0;
+  NVFUSER_CUDA_RT_SAFE_CALL(cudaGraphGetNodes(graph_, nullptr, &num_nodes));
+  std::vector<cudaGraphNode_t> nodes(num_nodes);
+  NVFUSER_CUDA_RT_SAFE_CALL(
+      cudaGraphGetNodes(graph_, nodes.data(), &num_nodes));
+
+  for (cudaGraphNode_t node : nodes) {
+    cudaGraphNodeType type;
+    NVFUSER_CUDA_RT_SAFE_CALL(cudaGraphNodeGetType(node, &type));
+    if (type != cudaGraphNodeTypeKernel) {
+      continue;
+    }
+    KernelNode kernel_node;
+    kernel_node.node = node;
+    NVFUSER_CUDA_SAFE_CALL(
+        cuGraphKernelNodeGetParams(node, &kernel_node.params));
+
+    // Kernels not launched by nvFuser, e.g. the fill kernels of zero- or
+    // NaN-initialized buffers, only touch retained buffers and never need to
+    // be patched.
+    auto executor_it = std::find_if(
+        executors.begin(), executors.end(), [&](const FusionExecutor& fe) {
+          return fe.hasCompiledKernel() &&
+              fe.compiledKernel().function == kernel_node.params.func;
+        });
+    if (executor_it == executors.end()) {
+      continue;
+    }
+    kernel_node.executor = &*executor_it;
+
+    const FusionExecutor::ExecutorEntry* entry =
+        executor_it->getExecutorEntry(cache_id);
+    if (entry == nullptr) {
+      kernel_node.patchable = false;
+      kernel_nodes_.push_back(std::move(kernel_node));
+      continue;
+    }
+
+    kernel_node.args = entry->args;
+    kernel_node.arg_ptrs.reserve(kernel_node.args.size());
+    const std::vector<Val*>& params = executor_it->kernel()->parameters();
+    for (auto i : c10::irange(kernel_node.args.size())) {
+      auto& arg = kernel_node.args.at(i);
+      kernel_node.arg_ptrs.push_back(arg.data());
+      if (std::holds_alternative<OpaqueType>(params.at(i)->dtype().type)) {
+        kernel_node.patchable = false;
+      }
+      if (!params.at(i)->isA<TensorView>() || arg.size() < sizeof(void*)) {
+        continue;
+      }
+      void* ptr = nullptr;
+      std::memcpy(&ptr, arg.data(), sizeof(void*));
+      if (input_ptrs.count(ptr)) {
+        kernel_node.input_args.push_back(i);
+      }
+    }
+    kernel_node.params.kernelParams = kernel_node.arg_ptrs.data();
+    kernel_nodes_.push_back(std::move(kernel_node));
+  }
+#else
+  (void)executors;
+  (void)cache_id;
+  (void)input_ptrs;
+#endif
+
+  if (isDebugDumpEnabled(DebugDumpOption::CudaGraph)) {
+    debug() << "[cuda graph] Captured " << kernel_nodes_.size()
+            << " nvFuser kernel node(s) and " << retained_buffers_.size()
+            << " buffer(s) for input id " << cache_id << std::endl;
+  }
+}
+
+void CudaGraph::retain(const at::Tensor& tensor) {
+  if (!tensor.defined() || !tensor.is_cuda()) {
+    return;
+  }
+  retained_buffers_.push_back(tensor);
+}
+
+bool CudaGraph::isValid() const {
+  return std::all_of(
+      kernel_nodes_.begin(), kernel_nodes_.end(), [](const KernelNode& kn) {
+        if (!kn.executor->hasCompiledKernel()) {
+          return false;
+        }
+        const auto* specialized = kn.executor->shapeSpecializedKernel();
+        return kn.executor->compiledKernel().function == kn.params.func ||
+            (specialized != nullptr && specialized->function == kn.params.func);
+      });
+}
+
+bool CudaGraph::updateInputPointers(
+    const std::unordered_map<void*, void*>& remap) {
+  FUSER_PERF_SCOPE("CudaGraph::updateInputPointers");
+#if (CUDA_VERSION >= 12000)
+  if (!remap.empty() &&
+      std::any_of(
+          kernel_nodes_.begin(),
+          kernel_nodes_.end(),
+          [](const KernelNode& kn) { return !kn.patchable; })) {
+    return false;
+  }
+  for (auto& kernel_node : kernel_nodes_) {
+    bool updated = false;
+    for (auto i : kernel_node.input_args) {
+      std::byte* slot = kernel_node.args.at(i).data();
+      void* ptr = nullptr;
+      std::memcpy(&ptr, slot, sizeof(void*));
+      auto it = remap.find(ptr);
+      if (it == remap.end()) {
+        continue;
+      }
+      std::memcpy(slot, &it->second, sizeof(void*));
+      updated = true;
+    }
+    if (updated) {
+      NVFUSER_CUDA_SAFE_CALL(cuGraphExecKernelNodeSetParams(
+          graph_exec_, kernel_node.node, &kernel_node.params));
+    }
+  }
+  return true;
+#else
+  return remap.empty();
+#endif
+}
+
+void CudaGraph::launch(const c10::cuda::CUDAStream& stream) {
+  FUSER_PERF_SCOPE("CudaGraph::launch");
+  NVF_ERROR(graph_exec_ != nullptr, "CUDA graph has not been instantiated");
+  if (std::find(launch_streams_.begin(), launch_streams_.end(), stream) ==
+      launch_streams_.end()) {
+    for (const auto& tensor : retained_buffers_) {
+      c10::cuda::CUDACachingAllocator::recordStream(
+          tensor.storage().data_ptr(), stream);
+    }
+    launch_streams_.push_back(stream);
+  }
+  NVFUSER_CUDA_RT_SAFE_CALL(cudaGraphLaunch(graph_exec_, stream.stream()));
+}
+
+} // namespace nvfuser
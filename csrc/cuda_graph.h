@@ -0,0 +1,99 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#pragma once
+
+#include <ATen/ATen.h>
+#include <c10/cuda/CUDAStream.h>
+#include <cuda.h>
+#include <cuda_runtime.h>
+
+#include <exceptions.h>
+#include <utils.h>
+
+#include <cstddef>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace nvfuser {
+
+class FusionExecutor;
+
+//! A CUDA graph captured from the kernel launches of a FusionKernelRuntime for
+//! a single input id. See [ Note -- CUDA graph mode ] in kernel_cache.cpp.
+//!
+//! Besides owning the graph and its executable instance, this class keeps a
+//! copy of the parameters of each nvFuser kernel node so that the data
+//! pointers of fusion inputs can be patched in place with
+//! cuGraphExecKernelNodeSetParams instead of re-capturing the graph.
+class CudaGraph : public NonCopyable {
+ public:
+  CudaGraph() = default;
+  ~CudaGraph();
+
+  //! Start capturing the work issued to `stream`. Relaxed capture mode is used
+  //! so that allocations made by the caching allocator while the segments run
+  //! are permitted.
+  void beginCapture(cudaStream_t stream);
+
+  //! Terminate a capture that failed. The partial graph is discarded.
+  void abortCapture(cudaStream_t stream);
+
+  //! End the capture and instantiate the graph. For every kernel node launched
+  //! by one of `executors`, the launch arguments cached for `cache_id` are
+  //! recorded, along with the positions of the arguments pointing to one of
+  //! `input_ptrs`.
+  void endCapture(
+      cudaStream_t stream,
+      const std::vector<FusionExecutor>& executors,
+      size_t cache_id,
+      const std::unordered_set<void*>& input_ptrs);
+
+  //! Keep a buffer referenced by the captured kernels alive for the lifetime
+  //! of this graph
+  void retain(const at::Tensor& tensor);
+
+  //! Whether all captured kernels are still those loaded by their executors.
+  //! An executor may recompile its kernel, e.g. when the block size grows,
+  //! which unloads the module the graph was captured with.
+  bool isValid() const;
+
+  //! Replace the fusion input data pointers found in kernel arguments using
+  //! `remap`. Returns false if a kernel holds an argument that cannot be
+  //! patched, e.g. a TMA descriptor embedding an input address, in which case
+  //! the graph needs to be captured again.
+  bool updateInputPointers(const std::unordered_map<void*, void*>& remap);
+
+  //! Launch the instantiated graph on `stream`. The first launch on a stream
+  //! tells the allocator that the retained buffers are used by it, so their
+  //! memory is not recycled while a replay might still be in flight.
+  void launch(const c10::cuda::CUDAStream& stream);
+
+ private:
+  struct KernelNode {
+    CUgraphNode node = nullptr;
+    CUDA_KERNEL_NODE_PARAMS params = {};
+    const FusionExecutor* executor = nullptr;
+    //! Copy of the argument buffers the node was captured with
+    std::vector<std::vector<std::byte>> args;
+    std::vector<void*> arg_ptrs;
+    //! Indices of `args` whose leading pointer refers to a fusion input
+    std::vector<size_t> input_args;
+    //! False if the kernel takes opaque arguments such as TMA descriptors
+    bool patchable = true;
+  };
+
+  cudaGraph_t graph_ = nullptr;
+  cudaGraphExec_t graph_exec_ = nullptr;
+  std::vector<KernelNode> kernel_nodes_;
+  std::vector<at::Tensor> retained_buffers_;
+  //! Streams the graph has been launched on
+  std::vector<c10::cuda::CUDAStream> launch_streams_;
+};
+
+} // namespace nvfuser
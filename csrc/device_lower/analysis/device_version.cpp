@@ -54,6 +54,14 @@ void MinimumDeviceVersion::handle(LoadStoreOp* ls_op) {
   }
 }
 
+void MinimumDeviceVersion::handle(ReductionOp* rop) {
+  if (rop->clusterReductionRequested()) {
+    ensureVersion(
+        {9, 0},
+        "Cluster reductions require thread block clusters, which were introduced in Hopper (9.0)");
+  }
+}
+
 void MinimumDeviceVersion::ensureVersion(
     std::pair<int, int> version,
     std::string reason) {
@@ -268,11 +268,16 @@ class FusionTransformer {
         auto init = reduction->init();
         auto out = reduction->out();
         auto in = reduction->in();
+        const bool cluster_reduction = reduction->clusterReductionRequested();
+        const bool smem_atomic = reduction->smemAtomicBlockReductionRequested();
 
         fusion_->removeExpr(reduction);
 
-        fused_expr =
+        auto fused_reduction =
             IrBuilder::create<ReductionOp>(red_op_type, init, out, in, true);
+        fused_reduction->requestClusterReduction(cluster_reduction);
+        fused_reduction->requestSmemAtomicBlockReduction(smem_atomic);
+        fused_expr = fused_reduction;
       } else if (auto welford = dynamic_cast<WelfordOp*>(expr)) {
         NVF_ERROR(!welford->isAllreduce());
 
@@ -285,6 +290,7 @@ class FusionTransformer {
         auto in_avg = welford->inAvg();
         auto in_var = welford->inVar();
         auto in_n = welford->inN();
+        auto mode = welford->mode();
 
         fusion_->removeExpr(welford);
 
@@ -292,7 +298,8 @@ class FusionTransformer {
             WelfordTriplet{out_avg, out_var, out_n},
             WelfordTriplet{in_avg, in_var, in_n},
             WelfordTriplet{init_avg, init_var, init_n},
-            true);
+            true,
+            mode);
       } else if (auto grouped_rop = dynamic_cast<GroupedReductionOp*>(expr)) {
         NVF_ERROR(!grouped_rop->isAllreduce());
 
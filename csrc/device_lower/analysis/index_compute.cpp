@@ -303,11 +303,12 @@ IndexingParameters getPredicateInitialIndexParameters(
     }
   }
 
+  // Serial loops are unswitched as a whole with
+  // NVFUSER_ENABLE=tile_unswitch. See Note [Tile-level unswitch] in
+  // unroll.cpp
   bool unswitch_pred = unswitch_or_vec_loop != nullptr &&
-      (unswitch_or_vec_loop->iter_domain()->getParallelType() ==
-           ParallelType::Unswitch ||
-       unswitch_or_vec_loop->iter_domain()->getParallelType() ==
-           ParallelType::Unroll);
+      unswitch_or_vec_loop->iter_domain()->getParallelType() !=
+          ParallelType::Vectorize;
 
   // Vectorized predicates are different from unswitch. Unswitch predicates
   // all loops within the unswitch (the outer most unswitch) are generated
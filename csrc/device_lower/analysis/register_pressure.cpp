@@ -0,0 +1,107 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#include <device_lower/analysis/register_pressure.h>
+
+#include <kernel_ir.h>
+#include <scheduler/utils.h>
+#include <type.h>
+#include <utils.h>
+
+#include <algorithm>
+
+namespace nvfuser {
+
+// [ Note -- Register pressure ]
+//
+// Register spills are otherwise only known once ptxas has compiled a kernel.
+// The lowered kernel already has all Local buffers allocated with their final
+// sizes, which include the unrolled, vectorized and persistent extents, and
+// the buffers that reuse the storage of others are marked as aliases. A
+// buffer is live from its allocation to the end of its scope, so the
+// registers live in a scope are those of the buffers allocated before it in
+// the enclosing scopes. Buffers of dynamic sizes are not counted, as they
+// are placed in local memory anyway.
+//
+// The estimate adds scheduler_utils::register_overhead, the same allowance
+// for indices, predicates and addresses the heuristics use, so it can be
+// compared with the register counts the heuristics pick. With
+// NVFUSER_ENABLE=register_pressure, FusionExecutor raises the register cap
+// of a kernel whose estimate exceeds it instead of letting ptxas spill.
+
+namespace {
+
+//! Registers of a Local allocation, 0 if unknown
+int64_t allocationRegisters(const kir::Allocate* alloc, DataType index_type) {
+  if (alloc->memoryType() != MemoryType::Local || alloc->alias() != nullptr) {
+    return 0;
+  }
+  if (!alloc->size()->isConstInt()) {
+    return 0;
+  }
+  const int64_t bytes = alloc->size()->evaluate().as<int64_t>() *
+      dataTypeSize(alloc->buffer()->dtype(), index_type);
+  return ceilDiv(bytes, scheduler_utils::bytes_per_register);
+}
+
+class RegisterPressureEstimator {
+ public:
+  explicit RegisterPressureEstimator(const kir::Kernel* kernel)
+      : index_type_(kernel->indexType()) {
+    traverse(kernel->topLevelExprs(), 0);
+  }
+
+  const std::unordered_map<const ForLoop*, int64_t>& loopRegisters() const {
+    return loop_registers_;
+  }
+
+  int64_t maxRegisters() const {
+    return max_registers_ + scheduler_utils::register_overhead;
+  }
+
+ private:
+  //! Returns the maximum number of registers live in `exprs`, given that
+  //! `live` registers are allocated by the enclosing scopes
+  int64_t traverse(const std::vector<Expr*>& exprs, int64_t live) {
+    int64_t max_live = live;
+    for (Expr* expr : exprs) {
+      if (auto alloc = dynamic_cast<kir::Allocate*>(expr)) {
+        live += allocationRegisters(alloc, index_type_);
+        max_live = std::max(max_live, live);
+      } else if (auto fl = dynamic_cast<ForLoop*>(expr)) {
+        const int64_t loop_live = traverse(fl->body().exprs(), live);
+        loop_registers_[fl] = loop_live + scheduler_utils::register_overhead;
+        max_live = std::max(max_live, loop_live);
+      } else if (auto ite = dynamic_cast<kir::IfThenElse*>(expr)) {
+        max_live = std::max(
+            {max_live,
+             traverse(ite->thenBody().exprs(), live),
+             traverse(ite->elseBody().exprs(), live)});
+      }
+    }
+    max_registers_ = std::max(max_registers_, max_live);
+    return max_live;
+  }
+
+ private:
+  const DataType index_type_;
+  int64_t max_registers_ = 0;
+  std::unordered_map<const ForLoop*, int64_t> loop_registers_;
+};
+
+} // namespace
+
+std::unordered_map<const ForLoop*, int64_t> getRegisterPressureInfo(
+    const kir::Kernel* kernel) {
+  return RegisterPressureEstimator(kernel).loopRegisters();
+}
+
+int64_t estimateRegistersPerThread(const kir::Kernel* kernel) {
+  return RegisterPressureEstimator(kernel).maxRegisters();
+}
+
+} // namespace nvfuser
@@ -0,0 +1,32 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#pragma once
+
+#include <exceptions.h>
+#include <ir/base_nodes.h>
+#include <kernel.h>
+#include <visibility.h>
+
+#include <unordered_map>
+
+namespace nvfuser {
+
+// The estimate is a lower bound of what ptxas needs, as it only counts the
+// Local buffers and a fixed overhead for indices and addresses. Temporaries
+// of unrolled expressions and values kept alive across loops by ptxas are not
+// accounted for. See [ Note -- Register pressure ] in register_pressure.cpp.
+
+//! Estimated number of 32-bit registers per thread live in the body of each
+//! loop of the kernel, including the buffers of the enclosing scopes
+NVF_API std::unordered_map<const ForLoop*, int64_t> getRegisterPressureInfo(
+    const kir::Kernel* kernel);
+
+//! Estimated maximum number of 32-bit registers per thread of the kernel
+NVF_API int64_t estimateRegistersPerThread(const kir::Kernel* kernel);
+
+} // namespace nvfuser
@@ -15,16 +15,20 @@
 #include <device_lower/pass/allocation.h>
 #include <device_lower/pass/circular_buffer.h>
 #include <device_lower/pass/expr_sort.h>
+#include <device_lower/pass/fast_divmod.h>
 #include <device_lower/pass/fusion_simplifier.h>
 #include <device_lower/pass/grid_serialization.h>
 #include <device_lower/pass/index.h>
 #include <device_lower/pass/inline_ptx.h>
 #include <device_lower/pass/insert_syncs.h>
 #include <device_lower/pass/instrument.h>
+#include <device_lower/pass/loop_peeling.h>
 #include <device_lower/pass/loop_rotation.h>
 #include <device_lower/pass/loops.h>
 #include <device_lower/pass/magic_zero.h>
 #include <device_lower/pass/misaligned_vectorization.h>
+#include <device_lower/pass/packed_arithmetic.h>
+#include <device_lower/pass/packed_cast.h>
 #include <device_lower/pass/predicate.h>
 #include <device_lower/pass/replace_size.h>
 #include <device_lower/pass/unroll.h>
@@ -39,6 +43,7 @@
 #include <ir/iostream.h>
 #include <ir/utils.h>
 
+#include <iomanip>
 #include <list>
 #include <unordered_map>
 #include <unordered_set>
@@ -236,20 +241,20 @@ void assignRNGOffset(Fusion* fusion) {
 }
 
 // Dump expr string if enable lower_verbose
+bool isLowerVerboseEnabled(const std::string& pass_name) {
+  if (!isDebugDumpEnabled(DebugDumpOption::LowerVerbose)) {
+    return false;
+  }
+  const auto& args = getDebugDumpArguments(DebugDumpOption::LowerVerbose);
+  return args.empty() ||
+      std::find(args.begin(), args.end(), pass_name) != args.end();
+}
+
 void dumpExprsIfEnabled(
     const std::vector<Expr*>& exprs,
     std::string pass_name,
     bool force_enable = false) {
-  auto enabled_by_env = [&pass_name]() {
-    if (!isDebugDumpEnabled(DebugDumpOption::LowerVerbose)) {
-      return false;
-    }
-    const auto& args = getDebugDumpArguments(DebugDumpOption::LowerVerbose);
-    return (
-        args.empty() ||
-        std::find(args.begin(), args.end(), pass_name) != args.end());
-  };
-  if (force_enable || enabled_by_env()) {
+  if (force_enable || isLowerVerboseEnabled(pass_name)) {
     debug() << "After " << pass_name << ":" << std::endl;
     for (auto exp : exprs) {
       // `Expr::toString()` already ends with a new line.
@@ -274,14 +279,19 @@ GpuLower::GpuLower(Fusion* fusion, const CompileParams& cparams)
            {"CircularBufferPass", CircularBufferPass::run},
            {"rotateLoops", rotateLoops},
            {"UnrollPass", UnrollPass::runPass},
+           {"elideRedundantSyncs", elideRedundantSyncs},
            {"processMisalignedVectorization", processMisalignedVectorization},
            {"IndexLowering", IndexLowering::getIndexedExprs},
            {"fuseWarpReduce", fuseWarpReduce},
            {"generateConditionalFromPredicate",
             generateConditionalFromPredicate},
            {"vectorizeWelford", vectorizeWelford},
+           {"peelUnswitchedLoops", peelUnswitchedLoops},
+           {"packArithmetic", packArithmetic},
+           {"packCasts", packCasts},
            {"allocateCommonScalars", allocateCommonScalars},
            {"insertMagicZero", insertMagicZero},
+           {"strengthReduceDivMod", strengthReduceDivMod},
            {"KIRCleaner", KIRCleaner::cleanUp},
            {"instrumentKernel", instrumentKernel},
            {"lowerToInlinePtx", lowerToInlinePtx}}),
@@ -302,12 +312,16 @@ struct LowerGuard {
 } // namespace
 
 kir::Kernel* GpuLower::run() {
+  FUSER_PERF_SCOPE("GpuLower::run");
   FusionGuard fg(fusion_);
   LowerGuard lower_guard(this);
+  // See Note [Memoization of simplifyExpr]
+  ExprSimplifierCache simplifier_cache;
+  startPass();
   // Reorder expressions for loop-nest generation respecting computeAt
   // relationships
   auto exprs_lowered = reorderExprsForComputeAt();
-  dumpExprsIfEnabled(exprs_lowered, "reorderExprsForComputeAt");
+  finishPass(exprs_lowered, "reorderExprsForComputeAt");
 
   commonScalarMap().initialize(exprs_lowered);
 
@@ -320,17 +334,89 @@ kir::Kernel* GpuLower::run() {
 
   for (auto [name, pass] : passes()) {
     exprs_lowered = pass(exprs_lowered);
-    dumpExprsIfEnabled(exprs_lowered, name);
+    finishPass(exprs_lowered, name);
   }
 
   // We now have the lowered expressions, finalize the kernel IR. This function
   // will also copy over some relevant information for code generation from
   // GpuLower.
   kernel_->finalize(exprs_lowered);
+  recordPass("finalize");
+
+  if (isDebugDumpEnabled(DebugDumpOption::LowerPassTimes)) {
+    double total_ms = 0.0;
+    debug() << "Lowering passes:" << std::endl;
+    for (const auto& pass : pass_profiles_) {
+      debug() << "  " << std::left << std::setw(40) << pass.name << std::right
+              << std::fixed << std::setprecision(3) << std::setw(10)
+              << pass.time_ms << " ms " << std::showpos << std::setw(8)
+              << pass.node_delta << std::noshowpos << " nodes" << std::endl;
+      total_ms += pass.time_ms;
+    }
+    debug() << "  " << std::left << std::setw(40) << "total" << std::right
+            << std::setw(10) << total_ms << " ms" << std::defaultfloat
+            << std::endl;
+  }
 
   return kernel_.get();
 }
 
+// [ Note -- Lowering pass profile ]
+//
+// GpuLower records the wall time and the change in the number of Vals and
+// Exprs of the kernel for every step of lowering, i.e. the analyses run when
+// constructing it and the passes run by GpuLower::run. The steps are
+// delimited by the points where NVFUSER_DUMP=lower_verbose can print the
+// exprs, plus the builds of ComputeAtMap and IdModel, which are often the
+// most expensive analyses. The node count is that of the IR container, so
+// passes that only transform the vector of lowered exprs without creating
+// nodes report no change. The profiles are printed with
+// NVFUSER_DUMP=lower_pass_times and reported in
+// KernelProfile::lowering_passes by FusionProfiler.
+
+void GpuLower::startPass() {
+  pass_start_time_ = std::chrono::steady_clock::now();
+  pass_start_nodes_ = numNodes();
+}
+
+void GpuLower::recordPass(const std::string& name) {
+  const auto now = std::chrono::steady_clock::now();
+  const int64_t nodes = numNodes();
+  pass_profiles_.push_back(
+      {name,
+       std::chrono::duration<double, std::milli>(now - pass_start_time_)
+           .count(),
+       nodes - pass_start_nodes_});
+  pass_start_time_ = now;
+  pass_start_nodes_ = nodes;
+}
+
+void GpuLower::finishPass(
+    const std::vector<Expr*>& exprs,
+    const std::string& name) {
+  recordPass(name);
+  dumpExprsIfEnabled(exprs, name);
+  // Not counting the dump in the next step
+  startPass();
+}
+
+void GpuLower::finishAnalysisPass(const std::string& name) {
+  recordPass(name);
+  // Sorting the exprs of a large fusion is not free, and the analyses don't
+  // produce them, so only sort them when they are dumped.
+  if (isLowerVerboseEnabled(name)) {
+    dumpExprsIfEnabled(fusion_->exprs(), name);
+  }
+  startPass();
+}
+
+int64_t GpuLower::numNodes() const {
+  if (kernel_ == nullptr) {
+    return 0;
+  }
+  return (int64_t)(kernel_->vals().size() + kernel_->unordered_exprs().size());
+}
+
 bool requiresIdModel(Fusion* fusion) {
   // TMA requires IdModel
   for (auto expr : fusion->exprs()) {
@@ -353,6 +439,22 @@ bool requiresIdModel(Fusion* fusion) {
   return false;
 }
 
+// Note [Order of the lowering analyses]
+// Once the ComputeAtMap and the IdModel are built, many of the analyses below
+// only depend on a few of the others, e.g.:
+//   getAllDivisibleSplits: ComputeAtMap
+//   ParallelDimensionMap: ConcretizedBroadcastDomains
+//   ThreadPredicateMap: ParallelDimensionMap
+//   fuseReductionsAndBroadcasts: ThreadPredicateMap
+//   SyncMap: ThreadPredicateMap
+//   PredicateElimination: NonDivisibleSplitInfo
+// They still run one after the other on the lowering thread. Most of them
+// create IR nodes in the kernel, e.g. through simplifyExpr or the
+// ComputeAtMap, and registering a node also updates the uses of its inputs,
+// which are shared by all analyses. Neither IrContainer nor Val is safe to
+// mutate concurrently, so running the analyses on the thread pool would
+// require locking every IrBuilder call, which would also make the names of the
+// Vals, and therefore the generated code, depend on thread scheduling.
 void GpuLower::analysis(Fusion* fusion) {
   FUSER_PERF_SCOPE("GpuLower::lower");
   NVF_ERROR(fusion != nullptr);
@@ -360,6 +462,8 @@ void GpuLower::analysis(Fusion* fusion) {
       active_gpu_lower == nullptr, "Nested lowering passes are not supported");
 
   LowerGuard lower_guard(this);
+  ExprSimplifierCache simplifier_cache;
+  startPass();
 
   // Use int64 by default as the kernel index type
   if (!cparams_.index_type.has_value()) {
@@ -370,12 +474,13 @@ void GpuLower::analysis(Fusion* fusion) {
   kernel_ = std::make_unique<kir::Kernel>(fusion, indexType());
   // Alias the fusion kernel caries around as a view of itself.
   fusion_ = kernel_.get();
+  kernel_->setScalarInterning(isOptionEnabled(EnableOption::InternScalars));
 
-  dumpExprsIfEnabled(fusion_->exprs(), "initialize lowering");
+  finishAnalysisPass("initialize lowering");
 
   segmenterHintCleanup(fusion_);
   FusionGuard fg(fusion_);
-  dumpExprsIfEnabled(fusion_->exprs(), "segmenterHintCleanup");
+  finishAnalysisPass("segmenterHintCleanup");
 
   this->requiresIdModel() = nvfuser::requiresIdModel(fusion_);
 
@@ -385,31 +490,32 @@ void GpuLower::analysis(Fusion* fusion) {
   // change their use of fusion_->exprs() to only include exprs that are not
   // between inputs and allKnownVals()?
   allKnownVals() = kernel_->inputs();
-  dumpExprsIfEnabled(fusion_->exprs(), "set allKnownVals");
+  finishAnalysisPass("set allKnownVals");
 
   // prepare for lowering
   validateIr(fusion_);
-  dumpExprsIfEnabled(fusion_->exprs(), "validateIr");
+  finishAnalysisPass("validateIr");
 
   // Determines minimum device version necessary to compile and run this fusion.
   std::tie(min_device_version_, min_device_version_reason_) =
       MinimumDeviceVersion::compute(fusion_);
-  dumpExprsIfEnabled(fusion_->exprs(), "MinimumDeviceVersion");
+  finishAnalysisPass("MinimumDeviceVersion");
 
   // Checks if any TIDx dim is marked as padded to a warp. Also checks if we can
   // determine the padding is explicitly a single warp.
   collectPaddedParallelDims();
-  dumpExprsIfEnabled(fusion_->exprs(), "collectPaddedParallelDims");
+  finishAnalysisPass("collectPaddedParallelDims");
 
   // Replaces integers that are tensor sizes by named scalars as "T0.size[0]"
   replaceSymbolicSizes(fusion_);
-  dumpExprsIfEnabled(fusion_->exprs(), "replaceSymbolicSizes");
+  finishAnalysisPass("replaceSymbolicSizes");
 
   // Build what's refered to as the compute at map. This map contains the
   // mappings of all iteration domains across the fusion. There are three types
   // of mappings Permissive, Exact, and Loop, see compute_at_map.h/cpp for more
   // information.
   compute_at_map_ = std::make_shared<ComputeAtMap>(fusion_);
+  recordPass("build ComputeAtMap");
 
   // Transitory testing of IdModel if enabled. No existing
   // functionality should be affected. New IterDomains may be created,
@@ -434,75 +540,76 @@ void GpuLower::analysis(Fusion* fusion) {
 #endif
     id_model_->validateAndPropagatePType();
   }
+  recordPass("build IdModel");
 
   resolveComputeWith(fusion_);
-  dumpExprsIfEnabled(fusion_->exprs(), "resolveComputeWith");
+  finishAnalysisPass("resolveComputeWith");
 
   if (isDebugDumpEnabled(DebugDumpOption::ComputeAtMap)) {
     debug() << compute_at_map_->toString() << std::endl;
   }
   compute_at_map_->validateAndPropagatePType();
-  dumpExprsIfEnabled(fusion_->exprs(), "validateAndPropagatePType");
+  finishAnalysisPass("validateAndPropagatePType");
 
   // Uses compute_at_map, find all splits that are enforced to be divisible
   divisible_splits_ = getAllDivisibleSplits(fusion_, compute_at_map_.get());
-  dumpExprsIfEnabled(fusion_->exprs(), "getAllDivisibleSplits");
+  finishAnalysisPass("getAllDivisibleSplits");
 
   // Used in parallel dimension map
   concretized_broadcast_domains_ =
       std::make_shared<const ConcretizedBroadcastDomains>(fusion_);
-  dumpExprsIfEnabled(fusion_->exprs(), "build ConcretizedBroadcastDomains");
+  finishAnalysisPass("build ConcretizedBroadcastDomains");
 
   parallelDimensionMap().build(fusion_);
   if (isDebugDumpEnabled(DebugDumpOption::ParallelDimensions)) {
     debug() << "Parallel dimension map:" << std::endl;
     debug() << parallel_dimension_map_.toString() << std::endl;
   }
-  dumpExprsIfEnabled(fusion_->exprs(), "build parallelDimensionMap");
+  finishAnalysisPass("build parallelDimensionMap");
 
   // Validate mma data format and compatibility if any on the fusion.
   validateMma(fusion_);
-  dumpExprsIfEnabled(fusion_->exprs(), "validateMma");
+  finishAnalysisPass("validateMma");
 
   // Validate swizzle usage on the fusion schedule.
   validateSwizzle(fusion_);
-  dumpExprsIfEnabled(fusion_->exprs(), "validateSwizzle");
+  finishAnalysisPass("validateSwizzle");
 
   validateResize(fusion_);
-  dumpExprsIfEnabled(fusion_->exprs(), "validateResize");
+  finishAnalysisPass("validateResize");
 
   validateReductions(fusion_);
-  dumpExprsIfEnabled(fusion_->exprs(), "validateReductions");
+  finishAnalysisPass("validateReductions");
 
   // Compute thread predicates. Depends on parallel_dimension_map_
   thread_pred_map_.build(fusion_);
-  dumpExprsIfEnabled(fusion_->exprs(), "build thread_pred_map_");
+  finishAnalysisPass("build thread_pred_map_");
 
   // Fuse cetain patterns of reductions, such as a grid reduction
   // followed by a grid broadcast. Only depends on parallelization and
   // thread predicate map.
   fuseReductionsAndBroadcasts(fusion_);
-  dumpExprsIfEnabled(fusion_->exprs(), "fuseReductionsAndBroadcasts");
+  finishAnalysisPass("fuseReductionsAndBroadcasts");
 
   // Want to run this after parallel map is
   // created. vectorized_accesses_ and vectorized_set_info_ are
   // filled.
   validateAndCollectVectorizeInfo(fusion_);
-  dumpExprsIfEnabled(fusion_->exprs(), "validateAndCollectVectorizeInfo");
+  finishAnalysisPass("validateAndCollectVectorizeInfo");
 
   // Depends on ComputeAtMap
   validateAndConvertIterDomainGrouping(fusion_);
-  dumpExprsIfEnabled(fusion_->exprs(), "validateAndConvertIterDomainGrouping");
+  finishAnalysisPass("validateAndConvertIterDomainGrouping");
 
   // Assumes all grouped reductions are convered to
   // GroupedReductionOp, which is done by
   // validateAndConvertIterDomainGrouping
   validateGroupedReductions(fusion_);
-  dumpExprsIfEnabled(fusion_->exprs(), "validateGroupedReductions");
+  finishAnalysisPass("validateGroupedReductions");
 
   // all of the lookup TVs are fusion inputs
   validateLookupTV(fusion_);
-  dumpExprsIfEnabled(fusion_->exprs(), "validateLookupTV");
+  finishAnalysisPass("validateLookupTV");
 
   // Depends on thread_pred_map_, validates parallelization collects which
   // tensor views need WAR or RAW syncs
@@ -510,28 +617,28 @@ void GpuLower::analysis(Fusion* fusion) {
   if (isDebugDumpEnabled(DebugDumpOption::SyncMap)) {
     debug() << sync_map_->toString() << std::endl;
   }
-  dumpExprsIfEnabled(fusion_->exprs(), "SyncMap");
+  finishAnalysisPass("SyncMap");
 
   nonDivisibleSplitInfo().build(fusion_);
-  dumpExprsIfEnabled(fusion_->exprs(), "build nonDivisibleSplitInfo");
+  finishAnalysisPass("build nonDivisibleSplitInfo");
 
   // Detects all exprssions that don't need predicates. Depends on
   // nonDivisibleSplitInfo.
   pred_elimination_ = std::make_unique<PredicateElimination>(fusion_);
-  dumpExprsIfEnabled(fusion_->exprs(), "build predicateElimination");
+  finishAnalysisPass("build predicateElimination");
 
   circularBufferInfo().build(fusion_);
-  dumpExprsIfEnabled(fusion_->exprs(), "build circularBufferInfo");
+  finishAnalysisPass("build circularBufferInfo");
 
   compute_at_map_->allocateIndexVariables();
-  dumpExprsIfEnabled(fusion_->exprs(), "allocateIndexVariables");
+  finishAnalysisPass("allocateIndexVariables");
 
   if (this->requiresIdModel() || isOptionEnabled(EnableOption::IdModel)) {
     tensor_indexer_ = std::make_unique<TensorIndexer>(*id_model_);
   }
 
   consumerToTMAInfo() = getConsumerToTMAInfoMap(fusion_);
-  dumpExprsIfEnabled(fusion_->exprs(), "getConsumerToTMAInfoMap");
+  finishAnalysisPass("getConsumerToTMAInfoMap");
 }
 
 kir::Kernel* GpuLower::kernel() const {
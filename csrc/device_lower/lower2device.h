@@ -25,6 +25,7 @@
 #include <exceptions.h>
 #include <executor_params.h>
 #include <expr_simplifier.h>
+#include <fusion_profiler.h>
 #include <id_model/id_model.h>
 #include <id_model/indexing.h>
 #include <ir/all_nodes.h>
@@ -37,6 +38,7 @@
 #include <vectorization_info.h>
 #include <visibility.h>
 
+#include <chrono>
 #include <functional>
 #include <memory>
 #include <ostream>
@@ -198,6 +200,30 @@ class GpuLower : public NonCopyable {
     return vectorized_set_info_;
   }
 
+  const auto& fastDivModMagic() const {
+    return fast_div_mod_magic_;
+  }
+
+  auto& fastDivModMagic() {
+    return fast_div_mod_magic_;
+  }
+
+  const auto& packedCasts() const {
+    return packed_casts_;
+  }
+
+  auto& packedCasts() {
+    return packed_casts_;
+  }
+
+  const auto& packedArithmeticCasts() const {
+    return packed_arithmetic_casts_;
+  }
+
+  auto& packedArithmeticCasts() {
+    return packed_arithmetic_casts_;
+  }
+
   bool requiresIdModel() const {
     return requires_id_model_;
   }
@@ -262,6 +288,12 @@ class GpuLower : public NonCopyable {
     return passes_;
   }
 
+  //! Wall time and change in IR node count of the analysis steps and passes
+  //! run so far, in order. See [ Note -- Lowering pass profile ]
+  const std::vector<LoweringPassProfile>& passProfiles() const {
+    return pass_profiles_;
+  }
+
   std::unordered_map<TensorView*, const TMAInfo>& consumerToTMAInfo() {
     return consumer_to_tma_info_;
   }
@@ -306,6 +338,22 @@ class GpuLower : public NonCopyable {
 
   bool resolveComputeWith(Fusion* fusion);
 
+  //! Starts profiling the next step
+  void startPass();
+
+  //! Records the profile of the step that ended and starts the next one
+  void recordPass(const std::string& name);
+
+  //! recordPass, then dumps exprs with NVFUSER_DUMP=lower_verbose
+  void finishPass(const std::vector<Expr*>& exprs, const std::string& name);
+
+  //! Same as finishPass for the analyses of the whole fusion, which only sorts
+  //! its exprs when they are dumped
+  void finishAnalysisPass(const std::string& name);
+
+  //! Number of Vals and Exprs of the kernel
+  int64_t numNodes() const;
+
  private:
   // Lowered Kernel IR
   std::unique_ptr<kir::Kernel> kernel_;
@@ -313,6 +361,11 @@ class GpuLower : public NonCopyable {
   // Passes to lower kernel, in order
   std::vector<Pass> passes_;
 
+  // Profiles of the finished steps and start of the running one
+  std::vector<LoweringPassProfile> pass_profiles_;
+  std::chrono::steady_clock::time_point pass_start_time_;
+  int64_t pass_start_nodes_ = 0;
+
   // Some stateful information during lowering
   // TODO: A lot of this information uses a define class then call build. It
   // would be safer to wrap all of these in unique pointers and remove the build
@@ -347,6 +400,17 @@ class GpuLower : public NonCopyable {
   // Info on each vectorized set op
   std::vector<VectorizedSetInfo> vectorized_set_info_;
 
+  // Multiplier of the divisor of each div and mod op strength reduced by
+  // strengthReduceDivMod
+  std::unordered_map<const Expr*, Val*> fast_div_mod_magic_;
+
+  // Second cast of each pair of casts converted together by packCasts
+  std::unordered_map<const Expr*, const Expr*> packed_casts_;
+
+  // Second element of each cast of the loops computed with packed arithmetic
+  // by packArithmetic
+  std::unordered_map<const Expr*, const Expr*> packed_arithmetic_casts_;
+
   // All vals that are known to the kernel, including fusion inputs and
   // precomputed values
   std::vector<Val*> all_known_vals_;
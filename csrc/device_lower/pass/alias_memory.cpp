@@ -19,6 +19,9 @@
 #include <ops/arith.h>
 #include <options.h>
 
+#include <algorithm>
+#include <limits>
+#include <optional>
 #include <sstream>
 #include <unordered_map>
 #include <unordered_set>
@@ -1648,7 +1651,9 @@ class StackBasedSharedMemAllocator : kir::IrVisitor {
   StackBasedSharedMemAllocator(const AllocationInfoMap& allocation_info_map)
       : allocation_info_map_(allocation_info_map) {}
 
-  void allocate(const std::vector<Expr*>& exprs) {
+  //! Returns the address of every unaliased shared memory allocation
+  std::unordered_map<kir::Allocate*, Val*> allocate(
+      const std::vector<Expr*>& exprs) {
     recordEvents();
 
     // Traverse expressions: reclaim memory when we pass a blockSync, append to
@@ -1658,6 +1663,8 @@ class StackBasedSharedMemAllocator : kir::IrVisitor {
     // This is done whenever we pass a syncing op, but we need to do it again in
     // case there are some allocations waiting around to be allocated.
     sortPushAndAssignWaiting();
+
+    return std::move(addresses_);
   }
 
  private:
@@ -1730,18 +1737,18 @@ class StackBasedSharedMemAllocator : kir::IrVisitor {
   void assignNextAddress(AllocationInfo* alloc_info) {
     auto alloc = alloc_info->alloc_expr;
     if (alloc_stack_.empty()) {
-      alloc->setAddress(FusionGuard::getCurFusion()->zeroVal());
+      addresses_[alloc] = FusionGuard::getCurFusion()->zeroVal();
     } else {
       auto top_alloc = alloc_stack_.back()->alloc_expr;
       auto top_size = allocSizeBytes(top_alloc);
       auto unaligned_address =
-          SimplifyingIrBuilder::addExpr(top_alloc->address(), top_size);
+          SimplifyingIrBuilder::addExpr(addresses_.at(top_alloc), top_size);
       auto aligned_address = alignExpr(unaligned_address);
       // TODO: hoisting of addresses using for_loops_ recorded at first write
-      alloc->setAddress(aligned_address);
+      addresses_[alloc] = aligned_address;
     }
     if (isDebugDumpEnabled(DebugDumpOption::BufferReuseInfo)) {
-      debug() << "Assigned address " << alloc->address()->toInlineString()
+      debug() << "Assigned address " << addresses_.at(alloc)->toInlineString()
               << " for T" << alloc->buffer()->name() << " with size "
               << alloc->size()->toInlineString() << " * "
               << dataTypeSize(alloc->buffer()->dtype()) << " bytes"
@@ -1807,7 +1814,7 @@ class StackBasedSharedMemAllocator : kir::IrVisitor {
           auto alloc = alloc_stack_.back()->alloc_expr;
           debug() << "Popping allocation for T" << alloc->buffer()->name()
                   << " which has assigned address "
-                  << alloc->address()->toInlineString() << std::endl;
+                  << addresses_.at(alloc)->toInlineString() << std::endl;
         }
         alloc_stack_.pop_back();
       } else {
@@ -1844,6 +1851,192 @@ class StackBasedSharedMemAllocator : kir::IrVisitor {
   // At the last moment, i.e. when one of them needs to be popped, we sort these
   // in descending order of their last read, and push them onto the stack.
   std::vector<AllocationInfo*> waiting_to_push_;
+
+  // Assigned addresses, set on the allocations once final
+  std::unordered_map<kir::Allocate*, Val*> addresses_;
+};
+
+//! [ Note -- Shared memory planner ]
+//!
+//! With EnableOption::SmemPlanner, shared memory allocations whose sizes are
+//! all known at compile time are also placed by IntervalSharedMemPlanner,
+//! and its addresses are used instead of those of
+//! StackBasedSharedMemAllocator when they need less memory.
+//!
+//! The planner uses the same safety rule as the stack: the memory of an
+//! allocation is released at the first block sync at or after its last
+//! (aliased) read, and an allocation may only overlap released memory if its
+//! first write comes after the release. This gives every allocation a closed
+//! interval [first write, release], and two allocations conflict when their
+//! intervals intersect. Unlike the stack, the planner sees all intervals at
+//! once, so memory released below a long-lived allocation can be reused.
+//!
+//! Offsets are assigned greedily by decreasing size. Every allocation goes to
+//! the smallest gap between the conflicting allocations placed so far that
+//! fits it, or above all of them. This best-fit packing is the usual
+//! heuristic for this NP-hard problem. A search over placement orders, or an
+//! ILP, could refine it by replacing place() and keeping the conflict graph.
+//!
+//! Addresses are aligned to 16 bytes like those of the stack. Allocations of
+//! at least 128 bytes, a full row of the 32 banks, are first planned aligned
+//! to 128 bytes, so that rows of different buffers start at the same bank.
+//! That plan is kept unless the 16 byte aligned one needs less memory. The
+//! peak of both allocators is printed with NVFUSER_DUMP=buffer_reuse_verbose.
+class IntervalSharedMemPlanner : kir::IrVisitor {
+ public:
+  //! Bytes of shared memory and address of every allocation of a plan
+  struct Plan {
+    int64_t peak = 0;
+    std::unordered_map<kir::Allocate*, int64_t> offsets;
+  };
+
+  IntervalSharedMemPlanner(const AllocationInfoMap& allocation_info_map)
+      : allocation_info_map_(allocation_info_map) {}
+
+  //! nullopt if the size of some allocation is not a constant
+  std::optional<Plan> plan(const std::vector<Expr*>& exprs) {
+    if (!collectBuffers()) {
+      return std::nullopt;
+    }
+    // Find block syncs
+    handle(exprs);
+    computeIntervals();
+
+    Plan bank_aligned = place(bank_row_bytes);
+    Plan aligned = place(min_alignment);
+    return aligned.peak < bank_aligned.peak ? aligned : bank_aligned;
+  }
+
+ private:
+  static constexpr int64_t min_alignment = 16;
+  static constexpr int64_t bank_row_bytes = 128;
+
+  struct Buffer {
+    kir::Allocate* alloc = nullptr;
+    int64_t size = 0;
+    int64_t first_write = -1;
+    int64_t last_read = -1;
+    //! Position of the block sync releasing the buffer
+    int64_t release = std::numeric_limits<int64_t>::max();
+
+    bool conflicts(const Buffer& other) const {
+      return first_write <= other.release && other.first_write <= release;
+    }
+  };
+
+  void dispatch(Expr* expr) final {
+    if (lower_utils::hasBlockSync(expr, GpuLower::current()->threadPredMap())) {
+      sync_positions_.push_back(
+          allocation_info_map_.getScopeMap().getExprPos(expr));
+    }
+    kir::IrVisitor::dispatch(expr);
+  }
+
+  //! Returns false if a buffer has a non-constant size
+  bool collectBuffers() {
+    std::unordered_map<const kir::Allocate*, size_t> buffer_index;
+    for (auto& alloc_info : allocation_info_map_.allAllocationInfos()) {
+      if (alloc_info->mem_type != MemoryType::Shared ||
+          alloc_info->alias_to) {
+        continue;
+      }
+      Val* size = allocSizeBytes(alloc_info->alloc_expr);
+      if (!size->isConstInt()) {
+        return false;
+      }
+      buffer_index[alloc_info->alloc_expr] = buffers_.size();
+      buffers_.push_back(
+          {alloc_info->alloc_expr,
+           size->evaluate().as<int64_t>(),
+           alloc_info->outer_live_interval->firstWrite(),
+           alloc_info->outer_live_interval->lastRead()});
+    }
+    // Aliases extend the live interval of the buffer they alias
+    for (auto& alloc_info : allocation_info_map_.allAllocationInfos()) {
+      if (alloc_info->mem_type != MemoryType::Shared ||
+          !alloc_info->alias_to) {
+        continue;
+      }
+      auto alias_info =
+          allocation_info_map_.getAllocationInfo(alloc_info->alias_to);
+      NVF_CHECK(alias_info);
+      Buffer& buffer = buffers_.at(buffer_index.at(alias_info->alloc_expr));
+      buffer.last_read = std::max(
+          buffer.last_read, alloc_info->outer_live_interval->lastRead());
+    }
+    return true;
+  }
+
+  void computeIntervals() {
+    std::sort(sync_positions_.begin(), sync_positions_.end());
+    for (Buffer& buffer : buffers_) {
+      auto it = std::lower_bound(
+          sync_positions_.begin(), sync_positions_.end(), buffer.last_read);
+      if (it != sync_positions_.end()) {
+        buffer.release = *it;
+      }
+    }
+    // Largest first, ties broken so that plans are deterministic
+    std::sort(
+        buffers_.begin(), buffers_.end(), [](const Buffer& a, const Buffer& b) {
+          if (a.size != b.size) {
+            return a.size > b.size;
+          }
+          return a.alloc->buffer()->name() < b.alloc->buffer()->name();
+        });
+  }
+
+  //! Best-fit placement, aligning buffers of at least `large_alignment`
+  //! bytes to it
+  Plan place(int64_t large_alignment) const {
+    Plan plan;
+    // Placed buffers with their offsets
+    std::vector<std::pair<int64_t, const Buffer*>> placed;
+    for (const Buffer& buffer : buffers_) {
+      const int64_t alignment =
+          buffer.size >= large_alignment ? large_alignment : min_alignment;
+      std::vector<std::pair<int64_t, const Buffer*>> conflicts;
+      for (const auto& [offset, other] : placed) {
+        if (buffer.conflicts(*other)) {
+          conflicts.emplace_back(offset, other);
+        }
+      }
+      std::sort(
+          conflicts.begin(), conflicts.end(), [](const auto& a, const auto& b) {
+            return a.first < b.first;
+          });
+
+      int64_t best_offset = -1;
+      int64_t best_gap = std::numeric_limits<int64_t>::max();
+      int64_t end = 0;
+      for (const auto& [offset, other] : conflicts) {
+        const int64_t candidate = alignUp(end, alignment);
+        const int64_t gap = offset - candidate;
+        if (gap >= buffer.size && gap < best_gap) {
+          best_gap = gap;
+          best_offset = candidate;
+        }
+        end = std::max(end, offset + other->size);
+      }
+      if (best_offset < 0) {
+        best_offset = alignUp(end, alignment);
+      }
+
+      placed.emplace_back(best_offset, &buffer);
+      plan.offsets[buffer.alloc] = best_offset;
+      plan.peak = std::max(plan.peak, best_offset + buffer.size);
+    }
+    return plan;
+  }
+
+  static int64_t alignUp(int64_t offset, int64_t alignment) {
+    return (offset + alignment - 1) / alignment * alignment;
+  }
+
+ private:
+  const AllocationInfoMap& allocation_info_map_;
+  std::vector<Buffer> buffers_;
+  std::vector<int64_t> sync_positions_;
 };
 
 } // namespace
@@ -2051,7 +2244,38 @@ std::pair<std::vector<Expr*>, bool> promoteReuseSyncs(
 void assignSharedMemoryAllocations(
     const std::vector<Expr*>& exprs,
     AllocationInfoMap& allocation_info_map) {
-  StackBasedSharedMemAllocator(allocation_info_map).allocate(exprs);
+  auto addresses =
+      StackBasedSharedMemAllocator(allocation_info_map).allocate(exprs);
+
+  // See [ Note -- Shared memory planner ]
+  if (isOptionEnabled(EnableOption::SmemPlanner)) {
+    if (auto plan = IntervalSharedMemPlanner(allocation_info_map).plan(exprs)) {
+      int64_t stack_peak = 0;
+      for (auto [alloc, address] : addresses) {
+        stack_peak = std::max(
+            stack_peak,
+            address->evaluate().as<int64_t>() +
+                allocSizeBytes(alloc)->evaluate().as<int64_t>());
+      }
+      const bool use_plan = plan->peak < stack_peak;
+      if (isDebugDumpEnabled(DebugDumpOption::BufferReuseInfo)) {
+        debug() << "Shared memory peak of the stack allocator: " << stack_peak
+                << " bytes, of the interval planner: " << plan->peak
+                << " bytes. Using the "
+                << (use_plan ? "interval planner" : "stack allocator")
+                << std::endl;
+      }
+      if (use_plan) {
+        for (auto [alloc, offset] : plan->offsets) {
+          addresses[alloc] = IrBuilder::create<Val>(offset, DataType::Index);
+        }
+      }
+    }
+  }
+
+  for (auto [alloc, address] : addresses) {
+    alloc->setAddress(address);
+  }
 
   // Verify that all smem allocations have a non-null address now
   for (auto& alloc_info : allocation_info_map.allAllocationInfos()) {
@@ -370,7 +370,11 @@ class AllocationInserter : public kir::ExprMutator {
         NVF_ERROR(
             default_val == nullptr,
             "Reduction should not have a default initialization value for predicate elimination.");
-        init = expr->as<ReductionOp>()->init();
+        // Atomic grid reductions add to the output, which the executor
+        // zero-fills before the launch
+        if (!expr->as<ReductionOp>()->atomicGridReductionRequested()) {
+          init = expr->as<ReductionOp>()->init();
+        }
       } else if (expr->isA<GroupedReductionOp>() && out_tv->hasReduction()) {
         NVF_ERROR(
             default_val == nullptr,
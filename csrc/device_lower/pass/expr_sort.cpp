@@ -10,6 +10,7 @@
 #include <device_lower/lower2device.h>
 #include <device_lower/pass/expr_sort.h>
 #include <device_lower/utils.h>
+#include <disjoint_set.h>
 #include <fusion.h>
 #include <instrumentation.h>
 #include <ir/all_nodes.h>
@@ -112,6 +113,11 @@ struct ExprSortPayload : public PolymorphicBase {
 
   // Marks if this group is already selected to merge with another group
   bool merged = false;
+
+  // Neighbors selected to merge in the current pass. Kept up to date by
+  // setToMerge so getMergeCandidates doesn't have to scan every neighbor of
+  // every neighbor, which is quadratic in the number of siblings of a group.
+  std::vector<ExprGroup*> merged_neighbors;
 };
 
 // Groups together expressions which create a expr group
@@ -427,14 +433,16 @@ std::string ExprGroup::toString() const {
 }
 
 std::vector<ExprGroup*> ExprGroup::getNeighbors() {
-  std::vector<ExprGroup*> neighbors;
+  // Merged groups are connected by one edge per val, so a neighbor can be
+  // reached through many edges. It only needs to be considered once.
+  VectorOfUniqueEntries<ExprGroup*> neighbors;
   for (auto inp : producerEdges()) {
-    neighbors.push_back(inp->from);
+    neighbors.pushBack(inp->from);
   }
   for (auto out : consumerEdges()) {
-    neighbors.push_back(out->to);
+    neighbors.pushBack(out->to);
   }
-  return neighbors;
+  return neighbors.vector();
 }
 
 std::vector<ExprGroup*> ExprGroup::getMergeCandidates(
@@ -455,12 +463,8 @@ std::vector<ExprGroup*> ExprGroup::getMergeCandidates(
   // so and merged neighbor is within 1 level or node merged with neighbor is
   // within 1 level, can't merge this node with anything else.
   bool can_merge_this = true;
-  bool neighbor_merged = false;
-  for (auto neighbor : neighbors) {
-    if (!neighbor->payload()->merged) {
-      continue;
-    }
-    neighbor_merged = true;
+  const bool neighbor_merged = !payload()->merged_neighbors.empty();
+  for (auto neighbor : payload()->merged_neighbors) {
     if (std::abs(neighbor->payload()->level - payload()->level) <= 1) {
       can_merge_this = false;
     }
@@ -512,60 +516,59 @@ std::vector<ExprGroup*> ExprGroup::getMergeCandidates(
       continue;
     }
 
-    for (auto neighbor_neighbor : neighbors.at(i)->getNeighbors()) {
+    for (auto neighbor_neighbor :
+         neighbors.at(i)->payload()->merged_neighbors) {
       // Don't check self
       if (neighbor_neighbor == neighbors.at(i)) {
         continue;
       }
-      if (neighbor_neighbor->payload()->merged) {
-        // check neighbor_neighbor level
-        if (std::abs(neighbor_neighbor->payload()->level - payload()->level) <=
-            1) {
-          if (isDebugDumpEnabled(DebugDumpOption::ExprSortVerbose)) {
-            debug() << "Can't merge with " << neighbors[i]->toString()
-                    << " as a neighbor of the neigbor, "
-                    << neighbor_neighbor->toString() << ", is too far"
-                    << std::endl;
-          }
-          can_merge.at(i) = false;
+      // check neighbor_neighbor level
+      if (std::abs(neighbor_neighbor->payload()->level - payload()->level) <=
+          1) {
+        if (isDebugDumpEnabled(DebugDumpOption::ExprSortVerbose)) {
+          debug() << "Can't merge with " << neighbors[i]->toString()
+                  << " as a neighbor of the neigbor, "
+                  << neighbor_neighbor->toString() << ", is too far"
+                  << std::endl;
         }
-        if (std::abs(
-                neighbor_neighbor->payload()->level -
-                neighbors.at(i)->payload()->level) <= 1) {
-          if (isDebugDumpEnabled(DebugDumpOption::ExprSortVerbose)) {
-            debug() << "Can't merge with " << neighbors[i]->toString()
-                    << " as a neighbor of the neigbor, "
-                    << neighbor_neighbor->toString()
-                    << ", is too far from the neighbor" << std::endl;
-          }
-          can_merge.at(i) = false;
+        can_merge.at(i) = false;
+      }
+      if (std::abs(
+              neighbor_neighbor->payload()->level -
+              neighbors.at(i)->payload()->level) <= 1) {
+        if (isDebugDumpEnabled(DebugDumpOption::ExprSortVerbose)) {
+          debug() << "Can't merge with " << neighbors[i]->toString()
+                  << " as a neighbor of the neigbor, "
+                  << neighbor_neighbor->toString()
+                  << ", is too far from the neighbor" << std::endl;
         }
+        can_merge.at(i) = false;
+      }
 
-        // check neighbor_neighber->merged->level
-        if (std::abs(
-                neighbor_neighbor->payload()->merge_with->payload()->level -
-                payload()->level) <= 1) {
-          if (isDebugDumpEnabled(DebugDumpOption::ExprSortVerbose)) {
-            debug() << "Can't merge with " << neighbors[i]->toString()
-                    << " as a neighbor of the neigbor, "
-                    << neighbor_neighbor->toString() << ", is merged with "
-                    << neighbor_neighbor->payload()->merge_with->toString()
-                    << ", which is too far" << std::endl;
-          }
-          can_merge.at(i) = false;
+      // check neighbor_neighber->merged->level
+      if (std::abs(
+              neighbor_neighbor->payload()->merge_with->payload()->level -
+              payload()->level) <= 1) {
+        if (isDebugDumpEnabled(DebugDumpOption::ExprSortVerbose)) {
+          debug() << "Can't merge with " << neighbors[i]->toString()
+                  << " as a neighbor of the neigbor, "
+                  << neighbor_neighbor->toString() << ", is merged with "
+                  << neighbor_neighbor->payload()->merge_with->toString()
+                  << ", which is too far" << std::endl;
         }
-        if (std::abs(
-                neighbor_neighbor->payload()->merge_with->payload()->level -
-                neighbors.at(i)->payload()->level) <= 1) {
-          if (isDebugDumpEnabled(DebugDumpOption::ExprSortVerbose)) {
-            debug() << "Can't merge with " << neighbors[i]->toString()
-                    << " as a neighbor of the neigbor, "
-                    << neighbor_neighbor->toString() << ", is merged with "
-                    << neighbor_neighbor->payload()->merge_with->toString()
-                    << ", which is too far from the neighbor" << std::endl;
-          }
-          can_merge.at(i) = false;
+        can_merge.at(i) = false;
+      }
+      if (std::abs(
+              neighbor_neighbor->payload()->merge_with->payload()->level -
+              neighbors.at(i)->payload()->level) <= 1) {
+        if (isDebugDumpEnabled(DebugDumpOption::ExprSortVerbose)) {
+          debug() << "Can't merge with " << neighbors[i]->toString()
+                  << " as a neighbor of the neigbor, "
+                  << neighbor_neighbor->toString() << ", is merged with "
+                  << neighbor_neighbor->payload()->merge_with->toString()
+                  << ", which is too far from the neighbor" << std::endl;
         }
+        can_merge.at(i) = false;
       }
     }
   }
@@ -592,6 +595,7 @@ void ExprGroup::clearTraversalInfo() {
   payload()->visited = false;
   payload()->merge_with = nullptr;
   payload()->merged = false;
+  payload()->merged_neighbors.clear();
 }
 
 void ExprSegmentationSorter::resetTraversal() {
@@ -606,48 +610,46 @@ void ExprSegmentationSorter::resetTraversal() {
 
 // Level is maximum distance from inputs. It's the metric used to select what
 // nodes can be merged while maintaining a DAG
+//
+// Groups are visited once all their producer edges are, by counting the
+// producer edges left to visit, so this is linear in the size of the graph.
+// Rechecking all the producers of a group each time one of them is visited
+// is quadratic in the number of producers of wide groups.
 void ExprSegmentationSorter::resetLevels() {
-  std::vector<ExprGroup*> next_to_visit;
+  std::unordered_map<ExprGroup*, size_t> num_unvisited_producer_edges;
+  num_unvisited_producer_edges.reserve(groups_.size());
+  for (auto& group : groups_) {
+    num_unvisited_producer_edges[group.get()] = group->producerEdges().size();
+  }
 
   while (!to_visit_.empty()) {
     auto visit = to_visit_.front();
     to_visit_.pop_front();
 
-    // All inputs processed?
-    bool ready = true;
-    if (!visit->producerEdges().empty()) {
-      ready = std::all_of(
-          visit->producerEdges().begin(),
-          visit->producerEdges().end(),
-          [&](ExprGroupConnections* dep) {
-            return dep->from->payload()->visited;
-          });
-    }
-
-    if (!ready) {
-      // In case traversal doesn't complete because there's an error in the
-      // DAG topology.
-      next_to_visit.push_back(visit);
-      continue;
-    }
-
     visit->payload()->visited = true;
 
-    to_visit_.insert(
-        to_visit_.end(), next_to_visit.begin(), next_to_visit.end());
-    next_to_visit.clear();
-
-    for (auto out : visit->consumerEdges()) {
-      to_visit_.push_back(out->to);
-    }
-
     visit->payload()->level = 0;
     for (auto inp : visit->producerEdges()) {
       visit->payload()->level =
           std::max(visit->payload()->level, inp->from->payload()->level + 1);
     }
+
+    for (auto out : visit->consumerEdges()) {
+      if (--num_unvisited_producer_edges.at(out->to) == 0) {
+        to_visit_.push_back(out->to);
+      }
+    }
   }
-  NVF_ERROR(next_to_visit.empty(), "Error in graph, is not a DAG.");
+
+  // Groups on a cycle are never ready to visit
+  NVF_ERROR(
+      std::all_of(
+          groups_.begin(),
+          groups_.end(),
+          [](const std::unique_ptr<ExprGroup>& group) {
+            return group->payload()->visited;
+          }),
+      "Error in graph, is not a DAG.");
 }
 
 ExprGroup* ExprSegmentationSorter::makeEmptyGroup(bool is_scalar_only) {
@@ -1447,19 +1449,32 @@ bool ExprSegmentationSorter::supportedMerge(ExprGroup* sg1, ExprGroup* sg2) {
 }
 
 bool ExprSegmentationSorter::testStillDag(ExprGroup* sg1, ExprGroup* sg2) {
+  // Levels strictly increase along edges, so a group at or above the levels
+  // of both sg1 and sg2 can't reach back to them and doesn't need to be
+  // traversed. Levels are up to date as groups are only merged after all the
+  // candidates of a pass have been selected.
+  const int max_level = std::max(sg1->payload()->level, sg2->payload()->level);
+
   std::deque<ExprGroup*> to_visit;
   std::unordered_set<ExprGroup*> visited;
+  auto maybe_visit = [&](ExprGroup* group) {
+    if (group == sg1 || group == sg2 ||
+        (group->payload()->level < max_level && visited.insert(group).second)) {
+      to_visit.emplace_back(group);
+    }
+  };
+
   // Add consumers of sg1 if not sg2
   for (auto sg1_consumer_edge : sg1->consumerEdges()) {
     if (sg1_consumer_edge->to != sg2) {
-      to_visit.emplace_back(sg1_consumer_edge->to);
+      maybe_visit(sg1_consumer_edge->to);
     }
   }
 
   // Add consumers of sg2 if not sg1
   for (auto sg2_consumer_edge : sg2->consumerEdges()) {
     if (sg2_consumer_edge->to != sg1) {
-      to_visit.emplace_back(sg2_consumer_edge->to);
+      maybe_visit(sg2_consumer_edge->to);
     }
   }
 
@@ -1477,12 +1492,8 @@ bool ExprSegmentationSorter::testStillDag(ExprGroup* sg1, ExprGroup* sg2) {
       return false;
     }
     to_visit.pop_front();
-    if (visited.find(group) != visited.end()) {
-      continue;
-    }
-    visited.emplace(group);
     for (auto consumer_edge : group->consumerEdges()) {
-      to_visit.emplace_back(consumer_edge->to);
+      maybe_visit(consumer_edge->to);
     }
   }
 
@@ -1498,6 +1509,12 @@ void ExprSegmentationSorter::setToMerge(ExprGroup* g1, ExprGroup* g2) {
 
   g2->payload()->merged = true;
   g2->payload()->merge_with = g1;
+
+  for (auto g : {g1, g2}) {
+    for (auto neighbor : g->getNeighbors()) {
+      neighbor->payload()->merged_neighbors.push_back(g);
+    }
+  }
 }
 
 void ExprSegmentationSorter::sort() {
@@ -1524,6 +1541,10 @@ void ExprSegmentationSorter::sort() {
     used_vals.insert(expr->inputs().begin(), expr->inputs().end());
   }
 
+  const std::unordered_set<Val*> known_vals(
+      GpuLower::current()->allKnownVals().begin(),
+      GpuLower::current()->allKnownVals().end());
+
   // Initialize DAG, convert each expr to a segment group
   for (auto expr : all_exprs) {
     bool is_terminating_expr = std::none_of(
@@ -1539,10 +1560,7 @@ void ExprSegmentationSorter::sort() {
     auto expr_group = expr2group.at(expr);
     auto out = expr->outputs()[0];
     for (auto inp : expr->inputs()) {
-      if (std::any_of(
-              GpuLower::current()->allKnownVals().begin(),
-              GpuLower::current()->allKnownVals().end(),
-              [&inp](Val* input) { return input == inp; })) {
+      if (known_vals.count(inp) > 0) {
         continue;
       }
 
@@ -1738,6 +1756,7 @@ std::vector<Expr*> ExprSegmentationSorter::getExprs() const {
 } // namespace
 
 std::vector<Expr*> reorderExprsForComputeAt() {
+  FUSER_PERF_SCOPE("GpuLower::Lower::reorderExprsForComputeAt");
   auto fusion = FusionGuard::getCurFusion();
   NVF_ERROR(fusion != nullptr);
 
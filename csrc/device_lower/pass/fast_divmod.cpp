@@ -0,0 +1,280 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#include <device_lower/pass/fast_divmod.h>
+
+#include <device_lower/lower2device.h>
+#include <ir/builder.h>
+#include <kernel_ir_dispatch.h>
+#include <options.h>
+
+#include <algorithm>
+#include <optional>
+
+namespace nvfuser {
+
+// [ Note -- Fast div and mod ]
+//
+// Indices of merged domains with symbolic extents are computed with div and
+// mod by extents. A 32-bit integer division by a runtime value takes about
+// twenty instructions on GPUs, and these indices are recomputed in every
+// iteration of the loop nests, while most of the divisors are loop invariant,
+// e.g. extents of kernel inputs or hoisted products of them.
+//
+// With NVFUSER_ENABLE=fast_divmod, strengthReduceDivMod computes the
+// multiplier
+//
+//   magic = UINT64_MAX / b + 1
+//
+// of each such divisor b once, right after b is available in the top level
+// scope of the kernel, and codegen prints a / b and a % b as
+// fastDiv(a, magic) and fastMod(a, b, magic) of runtime/helpers.cu, which only
+// need 64-bit multiplies. Divisors of the same value share their multiplier,
+// so sibling loops and predicates dividing by the same extent reuse it.
+//
+// The helpers are exact for all unsigned 32-bit operands, so the pass only
+// applies to kernels with 32-bit indices and to dividends that are provably
+// non-negative, i.e. built with add, mul, div and mod from non-negative
+// constants, thread and block indices and dimensions, tensor sizes and strides,
+// and indices of loops starting at non-negative values. Divisions by constants
+// are left alone, as nvrtc already strength reduces them.
+
+namespace {
+
+bool isInt32(const Val* val) {
+  return val->dtype() == DataType::Int32 ||
+      (val->dtype() == DataType::Index &&
+       GpuLower::current()->kernel()->indexType() == DataType::Int32);
+}
+
+class FastDivModInserter : public kir::ExprMutator {
+ public:
+  static std::vector<Expr*> run(const std::vector<Expr*>& exprs) {
+    FastDivModInserter inserter;
+    inserter.IrVisitor::handle(exprs);
+    if (inserter.top_level_exprs_.empty()) {
+      return exprs;
+    }
+    inserter.insertMultipliers();
+    return inserter.mutate();
+  }
+
+ private:
+  using kir::ExprMutator::handle;
+
+  void dispatch(Expr* expr) final {
+    if (scope_.empty()) {
+      top_level_pos_.emplace(expr, (int64_t)top_level_exprs_.size());
+      top_level_exprs_.push_back(expr);
+    }
+    statements_.insert(expr);
+    kir::ExprMutator::dispatch(expr);
+  }
+
+  void handle(ForLoop* fl) final {
+    loop_starts_.emplace(fl->index(), fl->start());
+    kir::ExprMutator::handle(fl);
+  }
+
+  //! Position of the last top level expr that `val` depends on, -1 if it only
+  //! depends on kernel parameters and builtins, and std::nullopt if it can not
+  //! be computed in the top level scope
+  std::optional<int64_t> availablePos(Val* val) {
+    auto it = available_pos_.find(val);
+    if (it != available_pos_.end()) {
+      return it->second;
+    }
+    auto pos = computeAvailablePos(val);
+    available_pos_.emplace(val, pos);
+    return pos;
+  }
+
+  std::optional<int64_t> computeAvailablePos(Val* val) {
+    if (val->isConst()) {
+      return -1;
+    }
+    if (auto ns = dynamic_cast<NamedScalar*>(val)) {
+      if (ns->getParallelDim().has_value() ||
+          ns->getParallelIndex().has_value()) {
+        return -1;
+      }
+      return std::nullopt;
+    }
+    Expr* def = val->definition();
+    if (def == nullptr) {
+      auto tv = dynamic_cast<TensorView*>(val);
+      if (val->isFusionInput() ||
+          (tv != nullptr && tv->getMemoryType() == MemoryType::Global)) {
+        return -1;
+      }
+      return std::nullopt;
+    }
+    if (auto it = top_level_pos_.find(def); it != top_level_pos_.end()) {
+      return it->second;
+    }
+    // Assigned in a nested scope
+    if (statements_.count(def) > 0) {
+      return std::nullopt;
+    }
+    int64_t pos = -1;
+    for (Val* inp : def->inputs()) {
+      auto inp_pos = availablePos(inp);
+      if (!inp_pos.has_value()) {
+        return std::nullopt;
+      }
+      pos = std::max(pos, *inp_pos);
+    }
+    return pos;
+  }
+
+  bool isNonNegative(Val* val) {
+    auto it = non_negative_.find(val);
+    if (it != non_negative_.end()) {
+      return it->second;
+    }
+    bool result = computeIsNonNegative(val);
+    non_negative_.emplace(val, result);
+    return result;
+  }
+
+  bool computeIsNonNegative(Val* val) {
+    if (val->isConst()) {
+      return val->value().is<int64_t>() && val->value().as<int64_t>() >= 0;
+    }
+    if (auto ns = dynamic_cast<NamedScalar*>(val)) {
+      return ns->getParallelDim().has_value() ||
+          ns->getParallelIndex().has_value();
+    }
+    if (auto it = loop_starts_.find(val); it != loop_starts_.end()) {
+      return isNonNegative(it->second);
+    }
+    Expr* def = val->definition();
+    if (def == nullptr) {
+      return false;
+    }
+    // Sizes and strides of tensors
+    if (def->isA<GetItem>()) {
+      return isIntegralType(val->dtype());
+    }
+    if (auto uop = dynamic_cast<UnaryOp*>(def)) {
+      return uop->getUnaryOpType() == UnaryOpType::Cast &&
+          isNonNegative(uop->in());
+    }
+    if (auto top = dynamic_cast<TernaryOp*>(def)) {
+      return top->getTernaryOpType() == TernaryOpType::Where &&
+          isNonNegative(top->in2()) && isNonNegative(top->in3());
+    }
+    auto bop = dynamic_cast<BinaryOp*>(def);
+    if (bop == nullptr) {
+      return false;
+    }
+    switch (bop->getBinaryOpType()) {
+      case BinaryOpType::Add:
+      case BinaryOpType::Mul:
+      case BinaryOpType::Div:
+      case BinaryOpType::Mod:
+      case BinaryOpType::CeilDiv:
+      case BinaryOpType::Min:
+        return isNonNegative(bop->lhs()) && isNonNegative(bop->rhs());
+      case BinaryOpType::Max:
+        return isNonNegative(bop->lhs()) || isNonNegative(bop->rhs());
+      default:
+        return false;
+    }
+  }
+
+  bool isCandidate(Expr* expr) {
+    auto bop = dynamic_cast<BinaryOp*>(expr);
+    if (bop == nullptr ||
+        (bop->getBinaryOpType() != BinaryOpType::Div &&
+         bop->getBinaryOpType() != BinaryOpType::Mod)) {
+      return false;
+    }
+    Val* out = bop->out();
+    if (out->isA<TensorView>() || out->isA<kir::TensorIndex>()) {
+      return false;
+    }
+    return isInt32(out) && isInt32(bop->lhs()) && isInt32(bop->rhs()) &&
+        !bop->rhs()->isConst() && availablePos(bop->rhs()).has_value() &&
+        isNonNegative(bop->lhs());
+  }
+
+  //! Allocates and computes the multiplier of `divisor` after the last top
+  //! level expr it depends on
+  Val* createMultiplier(Val* divisor) {
+    Val* quotient = IrBuilder::divExpr(
+        IrBuilder::create<Val>(-1L, DataType::UInt),
+        IrBuilder::maybeCastExpr(DataType::UInt, divisor));
+    Val* magic = IrBuilder::create<Val>(DataType::UInt);
+    auto def = IrBuilder::create<BinaryOp>(
+        BinaryOpType::Add,
+        magic,
+        quotient,
+        IrBuilder::create<Val>(1L, DataType::UInt));
+    auto alloc = IrBuilder::create<kir::Allocate>(
+        magic, MemoryType::Local, GpuLower::current()->kernel()->oneVal());
+
+    const int64_t pos = availablePos(divisor).value();
+    if (pos < 0) {
+      registerInsertBefore(top_level_exprs_.front(), alloc, nullptr);
+    } else {
+      registerInsertAfter(top_level_exprs_.at(pos), alloc, nullptr);
+    }
+    registerInsertAfter(alloc, def, nullptr);
+    return magic;
+  }
+
+  void insertMultipliers() {
+    // Candidates are also looked up in exprs only used for printing inline,
+    // e.g. indices and predicates, which are not statements
+    std::vector<BinaryOp*> candidates;
+    for (Expr* expr : GpuLower::current()->kernel()->unordered_exprs()) {
+      if (isCandidate(expr)) {
+        candidates.push_back(expr->as<BinaryOp>());
+      }
+    }
+    // Make the generated code deterministic
+    std::sort(
+        candidates.begin(), candidates.end(), [](BinaryOp* a, BinaryOp* b) {
+          return a->name() < b->name();
+        });
+
+    auto& fast_div_mod_magic = GpuLower::current()->fastDivModMagic();
+    std::vector<std::pair<Val*, Val*>> multipliers;
+    for (BinaryOp* bop : candidates) {
+      Val* divisor = bop->rhs();
+      auto it = std::find_if(
+          multipliers.begin(), multipliers.end(), [&](const auto& entry) {
+            return entry.first->sameAs(divisor);
+          });
+      if (it == multipliers.end()) {
+        multipliers.emplace_back(divisor, createMultiplier(divisor));
+        it = std::prev(multipliers.end());
+      }
+      fast_div_mod_magic.emplace(bop, it->second);
+    }
+  }
+
+  std::vector<Expr*> top_level_exprs_;
+  std::unordered_map<Expr*, int64_t> top_level_pos_;
+  std::unordered_set<Expr*> statements_;
+  //! Start of the loop of each loop index
+  std::unordered_map<Val*, Val*> loop_starts_;
+  std::unordered_map<Val*, std::optional<int64_t>> available_pos_;
+  std::unordered_map<Val*, bool> non_negative_;
+};
+
+} // namespace
+
+std::vector<Expr*> strengthReduceDivMod(const std::vector<Expr*>& exprs) {
+  if (!isOptionEnabled(EnableOption::FastDivMod)) {
+    return exprs;
+  }
+  return FastDivModInserter::run(exprs);
+}
+
+} // namespace nvfuser
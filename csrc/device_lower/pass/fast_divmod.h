@@ -0,0 +1,22 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#pragma once
+
+#include <ir/all_nodes.h>
+
+#include <vector>
+
+namespace nvfuser {
+
+//! Compute the multiplier of each non-constant 32-bit divisor that is
+//! available in the top level scope once, and have codegen print the div and
+//! mod ops by it with fastDiv and fastMod. See [ Note -- Fast div and mod ] in
+//! fast_divmod.cpp. Only enabled with NVFUSER_ENABLE=fast_divmod.
+std::vector<Expr*> strengthReduceDivMod(const std::vector<Expr*>& exprs);
+
+} // namespace nvfuser
@@ -158,6 +158,45 @@ void IndexLowering::handle(const ForLoop* for_loop) {
   active_scope_ = prev_scope;
 }
 
+namespace {
+
+// Numbers the elements of an RNGOp by thread first and then by the
+// iterations of the serial loops of the thread, so that consecutive
+// elements of a thread share Philox calls. See Note [Fast RNG] in rng.cpp.
+Val* getPerThreadPhiloxIndex(
+    const RNGOp* rop,
+    const std::vector<ForLoop*>& for_loops) {
+  Val* thread_index = GpuLower::current()->kernel()->zeroVal();
+  Val* local_index = GpuLower::current()->kernel()->zeroVal();
+  Val* local_count = GpuLower::current()->kernel()->oneVal();
+  for (auto fl : for_loops) {
+    IterDomain* id = fl->iter_domain();
+    // Threads of a parallelized broadcast ID compute the same elements
+    if (id->isBroadcast()) {
+      continue;
+    }
+    if (id->isThread()) {
+      thread_index = SimplifyingIrBuilder::addExpr(
+          SimplifyingIrBuilder::mulExpr(thread_index, id->extent()),
+          fl->index());
+    } else if (!fl->isTrivial()) {
+      local_index = SimplifyingIrBuilder::addExpr(
+          SimplifyingIrBuilder::mulExpr(local_index, id->extent()),
+          fl->index());
+      local_count = SimplifyingIrBuilder::mulExpr(local_count, id->extent());
+    }
+  }
+  // Start the elements of each thread at a new Philox call
+  Val* multiple = IrBuilder::create<Val>(
+      (int64_t)rop->getPhiloxMultiple(), DataType::Index);
+  Val* padded_count = SimplifyingIrBuilder::mulExpr(
+      SimplifyingIrBuilder::ceilDivExpr(local_count, multiple), multiple);
+  return SimplifyingIrBuilder::addExpr(
+      SimplifyingIrBuilder::mulExpr(thread_index, padded_count), local_index);
+}
+
+} // namespace
+
 void IndexLowering::handle(const RNGOp* rop) {
   // Write random tensor indices into the consumer
   //  tensor index if the output is a tensor.
@@ -166,7 +205,9 @@ void IndexLowering::handle(const RNGOp* rop) {
 
   // TensorIndex for philox subsequence and component.
   auto philox_index =
-      Index::getLinearLogicalIndex(out_tv, for_loops_, getRotatedLoop());
+      isOptionEnabled(EnableOption::FastRng) && getRotatedLoop().empty()
+      ? getPerThreadPhiloxIndex(rop, for_loops_)
+      : Index::getLinearLogicalIndex(out_tv, for_loops_, getRotatedLoop());
   philox_index = GpuLower::current()->commonScalarMap().hoistScalar(
       philox_index, for_loops_);
 
@@ -612,6 +653,8 @@ void IndexLowering::handleBlockReduction(
 
   ReductionOp* indexed_rop = IrBuilder::create<ReductionOp>(
       rop->getReductionOpType(), rop->init(), out, in, rop->isAllreduce());
+  indexed_rop->requestSmemAtomicBlockReduction(
+      rop->smemAtomicBlockReductionRequested());
   if (rop->predicate()) {
     indexed_rop =
         indexed_rop->withPredicate(rop->predicate())->as<ReductionOp>();
@@ -717,6 +760,121 @@ void IndexLowering::handleSerialGridReduction(
   GpuLower::current()->propagateExprInfo(rop, back());
 }
 
+void IndexLowering::handleClusterReduction(
+    const ReductionOp* rop,
+    Val* out,
+    Val* in) {
+  const auto out_tv = out->as<kir::TensorIndex>()->view();
+  const auto out_domain = out_tv->domain();
+
+  // The cluster spans gridDim.x, so only BIDx can be reduced across blocks
+  NVF_ERROR(
+      std::all_of(
+          out_domain->loop().begin(),
+          out_domain->loop().end(),
+          [](IterDomain* id) {
+            return !id->isReduction() ||
+                (id->isThread() &&
+                 (!id->isBlockDim() ||
+                  id->getParallelType() == ParallelType::BIDx)) ||
+                id->extent()->isOneInt();
+          }),
+      "Cluster reductions require all reduction axes to be parallelized, ",
+      "with BIDx as the only grid-parallelized one. ",
+      rop->toString());
+
+  const auto& thread_pred =
+      GpuLower::current()->threadPredMap().getPredicatedParallelTypes(out_tv);
+
+  // The partial results of the blocks are exchanged through the shared
+  // memory of the cluster, so there is no work or sync buffer
+  auto cluster_reduction = IrBuilder::create<kir::GridReduction>(
+      rop->getReductionOpType(),
+      rop->init(),
+      out,
+      in,
+      nullptr,
+      nullptr,
+      nullptr,
+      nullptr,
+      rop->isAllreduce());
+  cluster_reduction->requestClusterReduction();
+
+  cluster_reduction = cluster_reduction->withThreadPredicate(thread_pred);
+
+  if (rop->predicate()) {
+    cluster_reduction = cluster_reduction->withPredicate(rop->predicate())
+                            ->as<kir::GridReduction>();
+  }
+  if (rop->writePredicate()) {
+    cluster_reduction =
+        cluster_reduction->withWritePredicate(rop->writePredicate())
+            ->as<kir::GridReduction>();
+  }
+
+  pushBack(cluster_reduction);
+  GpuLower::current()->propagateExprInfo(rop, back());
+}
+
+void IndexLowering::handleAtomicGridReduction(
+    const ReductionOp* rop,
+    Val* out,
+    Val* in) {
+  const auto out_tv = out->as<kir::TensorIndex>()->view();
+
+  NVF_ERROR(
+      rop->getReductionOpType() == BinaryOpType::Add &&
+          (out_tv->dtype() == DataType::Int32 ||
+           out_tv->dtype() == DataType::Int ||
+           out_tv->dtype() == DataType::Float ||
+           out_tv->dtype() == DataType::Double),
+      "Atomic grid reductions require a sum of Int32, Int, Float or Double: ",
+      rop->toString());
+  NVF_ERROR(
+      out_tv->isFusionOutput() &&
+          out_tv->getMemoryType() == MemoryType::Global,
+      "Atomic grid reductions require the output to be a fusion output: ",
+      rop->toString());
+  NVF_ERROR(
+      !rop->isAllreduce(),
+      "Atomic grid reductions cannot be allreduces: ",
+      rop->toString());
+
+  const auto& thread_pred =
+      GpuLower::current()->threadPredMap().getPredicatedParallelTypes(out_tv);
+
+  // Each block adds its partial result to the zero-filled output, so there
+  // is no work or sync buffer
+  auto atomic_reduction = IrBuilder::create<kir::GridReduction>(
+      rop->getReductionOpType(),
+      rop->init(),
+      out,
+      in,
+      nullptr,
+      nullptr,
+      nullptr,
+      nullptr,
+      false);
+  atomic_reduction->requestAtomicGridReduction();
+  atomic_reduction->requestSmemAtomicBlockReduction(
+      rop->smemAtomicBlockReductionRequested());
+
+  atomic_reduction = atomic_reduction->withThreadPredicate(thread_pred);
+
+  if (rop->predicate()) {
+    atomic_reduction = atomic_reduction->withPredicate(rop->predicate())
+                           ->as<kir::GridReduction>();
+  }
+  if (rop->writePredicate()) {
+    atomic_reduction =
+        atomic_reduction->withWritePredicate(rop->writePredicate())
+            ->as<kir::GridReduction>();
+  }
+
+  pushBack(atomic_reduction);
+  GpuLower::current()->propagateExprInfo(rop, back());
+}
+
 void IndexLowering::handleGridReduction(
     const ReductionOp* rop,
     Val* out,
@@ -726,6 +884,16 @@ void IndexLowering::handleGridReduction(
     return;
   }
 
+  if (rop->clusterReductionRequested()) {
+    handleClusterReduction(rop, out, in);
+    return;
+  }
+
+  if (rop->atomicGridReductionRequested()) {
+    handleAtomicGridReduction(rop, out, in);
+    return;
+  }
+
   const auto out_tv = out->as<kir::TensorIndex>()->view();
   const auto out_domain = out_tv->domain();
 
@@ -813,6 +981,163 @@ void IndexLowering::handleGridReduction(
   }
 }
 
+void IndexLowering::handle(const ScanOp* sop) {
+  NVF_ERROR(ir_utils::isTvOp(sop));
+
+  const auto out = lowerDstIndex(sop->out());
+  const auto in = lowerSrcIndex(sop->in(), sop->out());
+
+  const auto scan_ids = lower_utils::getScanLoopIds(sop);
+  IterDomain* scan_id = sop->getScanID();
+
+  if (scan_ids.size() == 1 && scan_ids.at(0) == scan_id &&
+      !scan_id->isThread()) {
+    handleSerialScan(sop, out, in);
+    return;
+  }
+
+  if (scan_ids.size() == 1 && scan_ids.at(0) == scan_id &&
+      scan_id->getParallelType() == ParallelType::TIDx) {
+    ScanOp* indexed_sop = IrBuilder::create<ScanOp>(
+        sop->getScanOpType(), sop->init(), out, in, sop->dim());
+    if (sop->predicate()) {
+      indexed_sop = indexed_sop->withPredicate(sop->predicate())->as<ScanOp>();
+    }
+    pushBack(indexed_sop);
+    GpuLower::current()->propagateExprInfo(sop, back());
+    return;
+  }
+
+  auto split = scan_ids.size() == 2
+      ? dynamic_cast<Split*>(scan_ids.at(0)->definition())
+      : nullptr;
+  NVF_ERROR(
+      split != nullptr && split->in() == scan_id &&
+          split->outer() == scan_ids.at(0) &&
+          split->inner() == scan_ids.at(1) &&
+          split->outer()->getParallelType() == ParallelType::BIDx &&
+          split->inner()->getParallelType() == ParallelType::TIDx,
+      "Unsupported scheduling of scan. The scanned ID must be serial, ",
+      "parallelized by TIDx, or split into BIDx and TIDx: ",
+      sop->toString());
+  handleGridScan(sop, out, in);
+}
+
+void IndexLowering::handle(const SortOp* sop) {
+  NVF_ERROR(ir_utils::isTvOp(sop));
+
+  // Each thread holds one item, whose position along the sorted ID is
+  // threadIdx.x. Rows longer than a block are sorted by ExprEval segments.
+  const auto sort_ids = lower_utils::getSortLoopIds(sop);
+  IterDomain* sort_id = sop->getSortID();
+  NVF_ERROR(
+      sort_ids.size() == 1 && sort_ids.at(0) == sort_id &&
+          sort_id->getParallelType() == ParallelType::TIDx,
+      "Unsupported scheduling of sort. The sorted ID must be parallelized ",
+      "by TIDx: ",
+      sop->toString());
+
+  const auto out_values = lowerDstIndex(sop->outValues());
+  const auto out_indices = lowerDstIndex(sop->outIndices());
+  const auto in = lowerSrcIndex(sop->in(), sop->outValues());
+
+  SortOp* indexed_sop = IrBuilder::create<SortOp>(
+      out_values, out_indices, in, sop->dim(), sop->isDescending());
+  if (sop->predicate()) {
+    indexed_sop = indexed_sop->withPredicate(sop->predicate())->as<SortOp>();
+  }
+  pushBack(indexed_sop);
+  GpuLower::current()->propagateExprInfo(sop, back());
+}
+
+void IndexLowering::handleSerialScan(const ScanOp* sop, Val* out, Val* in) {
+  const auto out_tv = ir_utils::getTvOutput(sop);
+  IterDomain* scan_id = sop->getScanID();
+
+  auto loop_it =
+      std::find_if(for_loops_.begin(), for_loops_.end(), [&](ForLoop* fl) {
+        return GpuLower::current()->caMap()->areMapped(
+            fl->iter_domain(), scan_id, IdMappingMode::LOOP);
+      });
+
+  // Each iteration of the scan loop combines the input with the output of
+  // the previous iteration, so the output must be allocated outside of the
+  // loop unless the loop is trivial
+  Val* prev = sop->init();
+  if (loop_it != for_loops_.end() && !(*loop_it)->isTrivial()) {
+    ForLoop* fl = *loop_it;
+    const auto scan_pos = std::distance(
+        out_tv->getLoopDomain().begin(),
+        std::find(
+            out_tv->getLoopDomain().begin(),
+            out_tv->getLoopDomain().end(),
+            scan_id));
+    NVF_ERROR(
+        out_tv->getMemoryType() == MemoryType::Global ||
+            scan_pos >= out_tv->getComputeAtPosition(),
+        "The output of a serial scan must not be inlined into the scan loop: ",
+        out_tv->toString());
+    auto out_ti = out->as<kir::TensorIndex>();
+    Val* prev_index = IrBuilder::subExpr(fl->index(), fl->step());
+    auto prev_out = IrBuilder::create<kir::TensorIndex>(
+        out_ti->view(),
+        ir_utils::replaceValRecursively(
+            out_ti->index(), {{fl->index(), prev_index}}),
+        out_ti->dtype());
+    prev = IrBuilder::whereExpr(
+        IrBuilder::eqExpr(fl->index(), fl->start()), sop->init(), prev_out);
+  }
+
+  pushBack(IrBuilder::create<BinaryOp>(sop->getScanOpType(), out, prev, in));
+  GpuLower::current()->propagateExprInfo(sop, back());
+}
+
+void IndexLowering::handleGridScan(const ScanOp* sop, Val* out, Val* in) {
+  const auto out_tv = out->as<kir::TensorIndex>()->view();
+
+  // One tile per row of threads of each block for each entrance. Threads
+  // along TIDx scan the same row, and blocks along BIDx form a chain.
+  const auto n_entrances = getEntranceCountGridReduce(for_loops_);
+  Val* buffer_size = n_entrances;
+  for (auto pt :
+       {ParallelType::BIDx,
+        ParallelType::BIDy,
+        ParallelType::BIDz,
+        ParallelType::TIDy,
+        ParallelType::TIDz}) {
+    auto pt_dim = GpuLower::current()->parallelDimensionMap().get(pt);
+    if (pt_dim == nullptr || pt_dim->isOneInt()) {
+      continue;
+    }
+    buffer_size = SimplifyingIrBuilder::mulExpr(buffer_size, pt_dim);
+  }
+
+  auto aggregate_buffer = allocateUniqueBuffer(
+      buffer_size, out_tv->dtype(), false, out_tv, work_buffer_map_);
+  auto prefix_buffer = allocateUniqueBuffer(
+      buffer_size, out_tv->dtype(), false, out_tv, prefix_buffer_map_);
+  auto flag_buffer = allocateUniqueBuffer(
+      buffer_size, DataType::Int, true, out_tv, sync_buffer_map_);
+
+  kir::GridScan* grid_scan = IrBuilder::create<kir::GridScan>(
+      sop->getScanOpType(),
+      sop->init(),
+      out,
+      in,
+      sop->dim(),
+      aggregate_buffer,
+      prefix_buffer,
+      flag_buffer,
+      getEntranceLinIndGridReduce(for_loops_),
+      n_entrances);
+  if (sop->predicate()) {
+    grid_scan =
+        grid_scan->withPredicate(sop->predicate())->as<kir::GridScan>();
+  }
+  pushBack(grid_scan);
+  GpuLower::current()->propagateExprInfo(sop, back());
+}
+
 void IndexLowering::handle(const GroupedReductionOp* grouped_rop) {
   NVF_ERROR(ir_utils::isTvOp(grouped_rop));
 
@@ -1012,7 +1337,8 @@ void IndexLowering::handle(const WelfordOp* wop) {
       wop->initAvg(),
       wop->initVar(),
       wop->initN(),
-      wop->isAllreduce());
+      wop->isAllreduce(),
+      wop->mode());
 
   if (wop->predicate()) {
     indexed_wop = indexed_wop->withPredicate(wop->predicate())->as<WelfordOp>();
@@ -1466,16 +1792,16 @@ void IndexLowering::handleCpAsyncBulkStore(const LoadStoreOp* ldst) {
   pushBack(IrBuilder::create<kir::AsyncWait>(AsyncOpType::CpAsyncBulk, 0));
 }
 
-static DataType getMmaInputAType(MmaMacro macro) {
+static DataType getMmaInputAType(MmaMacro macro, DataType dtype) {
   int warp_group_size = isHopper(macro) ? 128 : 32;
   int size = getM(macro) * getK(macro) / warp_group_size /
-      2 /* halves per 32bit register */;
+      (4 / (int)dataTypeSize(dtype)) /* items per 32bit register */;
   return ArrayType{std::make_shared<DataType>(DataType::UInt32), (size_t)size};
 }
 
-static DataType getMmaInputBType(MmaMacro macro) {
+static DataType getMmaInputBType(MmaMacro macro, DataType dtype) {
   int size = getN(macro) * getK(macro) / 32 /* threads per warp */ /
-      2 /* halves per 32bit register */;
+      (4 / (int)dataTypeSize(dtype)) /* items per 32bit register */;
   return ArrayType{std::make_shared<DataType>(DataType::UInt32), (size_t)size};
 }
 
@@ -1486,7 +1812,7 @@ static inline DataType getMmaOutType(TensorView* mma_out) {
       size *= id->extent()->evaluate().as<int64_t>();
     }
   }
-  return ArrayType{std::make_shared<DataType>(DataType::Float), (size_t)size};
+  return ArrayType{std::make_shared<DataType>(mma_out->dtype()), (size_t)size};
 }
 
 void IndexLowering::handle(const LoadStoreOp* ldst) {
@@ -1503,10 +1829,11 @@ void IndexLowering::handle(const LoadStoreOp* ldst) {
   } else {
     DataType as_type = DataType::Null;
     if (ir_utils::isLdMatrixOp(ldst)) {
+      auto out_tv = ldst->out()->as<TensorView>();
       as_type = ArrayType{
           std::make_shared<DataType>(DataType::UInt32),
-          (size_t)ir_utils::getVectorizeSize(ldst->out()->as<TensorView>()) /
-              2};
+          (size_t)ir_utils::getVectorizeSize(out_tv) *
+              dataTypeSize(out_tv->dtype()) / 4};
     } else if (ir_utils::isStMatrixOp(ldst)) {
       as_type = ArrayType{
           std::make_shared<DataType>(DataType::UInt32),
@@ -1642,7 +1969,11 @@ void IndexLowering::handle(const MmaOp* mma) {
             matrix_desc, for_loops_));
   } else {
     a = lowerSrcIndex(
-        mma->inA(), mma->out(), {}, false, getMmaInputAType(mma->macro()));
+        mma->inA(),
+        mma->out(),
+        {},
+        false,
+        getMmaInputAType(mma->macro(), mma->inA()->dtype()));
   }
   if (mma->inB()->as<TensorView>()->getMemoryType() == MemoryType::Shared) {
     // TODO: This is a temporary solution and only supports a single tile in
@@ -1680,7 +2011,11 @@ void IndexLowering::handle(const MmaOp* mma) {
             matrix_desc, for_loops_));
   } else {
     b = lowerSrcIndex(
-        mma->inB(), mma->out(), {}, false, getMmaInputBType(mma->macro()));
+        mma->inB(),
+        mma->out(),
+        {},
+        false,
+        getMmaInputBType(mma->macro(), mma->inB()->dtype()));
   }
   const auto out = lowerDstIndex(
       mma->out(), {}, false, getMmaOutType(mma->out()->as<TensorView>()));
@@ -1855,7 +2190,44 @@ void IndexLowering::allocateUniqueFusedReduction(
   insertAtTopLevel(fused_reduction_alloc_reduction);
 }
 
+namespace {
+
+// Note [Pads of CatOp inputs]
+//
+// cat pads each of its inputs to the extent of the output along the
+// concatenated dimension and selects the input of each output position with a
+// CatOp, e.g., cat({t0, t1}) is
+//   t2 = pad(t0, {0, t1.size}); t3 = pad(t1, {t0.size, 0});
+//   t4 = cat(t2, t3)
+// When the pads are inlined into the CatOp, the generated code evaluates the
+// predicates of all pads for each output element, although CatOp only ever
+// reads a pad in its unpadded range. Such pads are not lowered, and CatOp
+// reads their inputs directly instead, so each output element is produced by
+// a single predicated load.
+bool isPadFusedIntoCat(const PadOp* pad) {
+  auto out_tv = pad->out()->as<TensorView>();
+  if (out_tv->uses().size() != 1 || out_tv->isFusionOutput() ||
+      out_tv->getMemoryType() != MemoryType::Local ||
+      out_tv->getComputeAtPosition() != (int64_t)out_tv->nDims()) {
+    return false;
+  }
+  auto cat = dynamic_cast<CatOp*>(out_tv->uses().at(0));
+  if (cat == nullptr) {
+    return false;
+  }
+  const auto padded_axes = pad->getPaddedAxes();
+  return padded_axes.size() == 1 &&
+      padded_axes.front() == cat->concatenatedDim();
+}
+
+} // namespace
+
 void IndexLowering::handle(const PadOp* pad) {
+  // See Note [Pads of CatOp inputs]
+  if (isPadFusedIntoCat(pad)) {
+    return;
+  }
+
   // Convert to a where op as:
   // consumer[consumer_idx] = (consumer_idx >= left_pad && consumer_idx <
   //                           consumer_extent - right_pad) ?
@@ -1926,8 +2298,14 @@ void IndexLowering::handle(const CatOp* cat) {
   Val* cur_extent = GpuLower::current()->kernel()->zeroVal();
 
   for (const auto i : c10::irange(cat->inputs().size())) {
-    const auto inp = lowerSrcIndex(cat->input(i), cat->output(0));
-    inputs.at(i) = inp;
+    // See Note [Pads of CatOp inputs]. The pad is inlined, so its input can be
+    // indexed in the loop nest of the CatOp.
+    auto pad = dynamic_cast<PadOp*>(cat->input(i)->definition());
+    if (pad != nullptr && isPadFusedIntoCat(pad)) {
+      inputs.at(i) = lowerSrcIndex(pad->in(), pad->out());
+    } else {
+      inputs.at(i) = lowerSrcIndex(cat->input(i), cat->output(0));
+    }
 
     // Note the original extent is the extent of the root domain not
     // logical domain
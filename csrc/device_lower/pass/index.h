@@ -55,6 +55,8 @@ class IndexLowering : private OptOutConstDispatch {
   void handle(const IndexSelectOp*) final;
   void handle(const TorchGatherOp*) final;
   void handle(const ScatterOp*) final;
+  void handle(const ScanOp*) final;
+  void handle(const SortOp*) final;
   void handle(const RNGOp*) final;
   void handle(const ReductionOp*) final;
   void handle(const GroupedReductionOp*) final;
@@ -119,6 +121,12 @@ class IndexLowering : private OptOutConstDispatch {
   //! Called by handleGridReduction, this returns true if rop is lowered as a
   //! serial grid reduction.
   void handleSerialGridReduction(const ReductionOp* rop, Val* out, Val* in);
+  //! Called by handleGridReduction when rop is lowered as a reduction across
+  //! the thread blocks of a cluster.
+  void handleClusterReduction(const ReductionOp* rop, Val* out, Val* in);
+  //! Called by handleGridReduction when rop is lowered as a sum of the
+  //! partial results of the blocks with global atomics.
+  void handleAtomicGridReduction(const ReductionOp* rop, Val* out, Val* in);
 
   void handleBlockReduction(
       const GroupedReductionOp* rop,
@@ -142,6 +150,9 @@ class IndexLowering : private OptOutConstDispatch {
       const std::vector<WelfordTriplet>& input_vals,
       const std::vector<WelfordTriplet>& init_vals);
 
+  void handleSerialScan(const ScanOp* sop, Val* out, Val* in);
+  void handleGridScan(const ScanOp* sop, Val* out, Val* in);
+
   // Allocate a unique buffer for grid reductions and broadcast. A
   // buffer is uniquely allocated for each output tensor of an
   // expression.
@@ -184,6 +195,9 @@ class IndexLowering : private OptOutConstDispatch {
   // allocated only once
   std::unordered_map<TensorView*, kir::Allocate*> sync_buffer_map_;
   std::unordered_map<TensorView*, kir::Allocate*> work_buffer_map_;
+  // Inclusive prefixes of grid scans. Their aggregates and flags use
+  // work_buffer_map_ and sync_buffer_map_.
+  std::unordered_map<TensorView*, kir::Allocate*> prefix_buffer_map_;
   std::unordered_map<TensorView*, kir::AllocateFusedReduction*>
       fused_reduction_map_;
 };
@@ -117,22 +117,38 @@ class LowerToInlinePtx : public kir::ExprMutator {
   void handleTuringOrAmpereMma(MmaOp* mma) {
     // Constants definitions based on MMA PTX instruction documentation:
     // https://docs.nvidia.com/cuda/parallel-thread-execution/index.html#multiply-and-accumulate-instruction-mma
+    // The operand types, either of which may be e4m3 or e5m2 for the fp8
+    // instructions. The 8-bit instructions, including the s8 ones that
+    // accumulate in s32, have a K of 32
+    auto operand_type = [](Val* operand) -> std::string {
+      switch (operand->as<kir::TensorIndex>()->view()->dtype()) {
+        case DataType::BFloat16:
+          return "bf16";
+        case DataType::Float8_e4m3fn:
+          return "e4m3";
+        case DataType::Float8_e5m2:
+          return "e5m2";
+        case DataType::Int8:
+          return "s8";
+        default:
+          return "f16";
+      }
+    };
+    const std::string a_dtype = operand_type(mma->inA());
+    const std::string b_dtype = operand_type(mma->inB());
+    const bool int8 = a_dtype == "s8";
+    const bool eight_bit = int8 || a_dtype[0] == 'e';
+    const std::string acc_dtype = int8 ? "s32" : "f32";
     const int m = 16;
     const int n = 8;
-    const int k = mma->isAmpere() ? 16 : 8;
+    const int k = eight_bit ? 32 : (mma->isAmpere() ? 16 : 8);
 
     std::string op;
     {
       std::stringstream op_ss;
-      op_ss << "mma.sync.aligned.m" << m << "n" << n << "k" << k
-            << ".row.col.f32";
-      if (mma->inA()->as<kir::TensorIndex>()->view()->getDataType().value() ==
-          DataType::BFloat16) {
-        op_ss << ".bf16.bf16";
-      } else {
-        op_ss << ".f16.f16";
-      }
-      op_ss << ".f32";
+      op_ss << "mma.sync.aligned.m" << m << "n" << n << "k" << k << ".row.col."
+            << acc_dtype << "." << a_dtype << "." << b_dtype << "."
+            << acc_dtype;
       op = op_ss.str();
     }
 
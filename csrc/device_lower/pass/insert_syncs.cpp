@@ -7,13 +7,16 @@
 // clang-format on
 #include <device_lower/lower2device.h>
 #include <device_lower/pass/insert_syncs.h>
+#include <debug.h>
 #include <device_lower/utils.h>
 #include <dispatch.h>
 #include <instrumentation.h>
 #include <ir/utils.h>
 #include <kernel_ir.h>
 #include <kernel_ir_dispatch.h>
+#include <options.h>
 
+#include <algorithm>
 #include <unordered_set>
 
 namespace nvfuser {
@@ -687,6 +690,165 @@ class ReadAfterWriteSyncs : public kir::ExprMutator {
   }
 };
 
+// [ Note -- Elision of redundant block syncs ]
+//
+// The RAW and WAR passes insert syncs for each hazard on their own, and the
+// circular buffering and loop rotation passes move and copy them, so a
+// kernel can end up with a block sync that follows another one with nothing
+// in between that touches shared or global memory, e.g. the WAR sync at the
+// end of a loop body followed by the RAW sync of the next expression. With
+// NVFUSER_ENABLE=elide_syncs, such syncs are removed after unrolling.
+//
+// The analysis is deliberately local. A sync is redundant if the previous
+// expressions in the same scope, up to a sync, only compute scalars, allocate
+// buffers or compute on Local tensors. Reductions, broadcasts and the like
+// are never considered harmless as their block and grid variants use shared
+// memory internally. Loops and conditionals are harmless when all their
+// expressions are, and otherwise end the synced region. A loop body starts
+// unsynced, as it follows the end of the previous iteration, while the
+// branches of a conditional start with the state before the conditional.
+//
+// When the block is statically known to be a single warp, the remaining
+// syncs are marked as warp syncs and printed as __syncwarp() when aligned.
+class RedundantSyncElider : public kir::ExprMutator {
+ public:
+  static std::vector<Expr*> run(const std::vector<Expr*>& exprs) {
+    RedundantSyncElider elider;
+    auto new_exprs = elider.traverseAndInsert(exprs);
+    if (isDebugDumpEnabled(DebugDumpOption::SyncMap)) {
+      debug() << "Elided " << elider.num_removed_ << " redundant block syncs"
+              << ", " << elider.num_warp_syncs_ << " syncs use __syncwarp"
+              << std::endl;
+    }
+    return new_exprs;
+  }
+
+ private:
+  RedundantSyncElider() : single_warp_(isSingleWarpBlock()) {}
+
+  using kir::ExprMutator::handle;
+
+  static bool isSingleWarpBlock() {
+    const auto& pdim_map = GpuLower::current()->parallelDimensionMap();
+    int64_t num_threads = 1;
+    for (auto pt : kParallelTypeTIDs) {
+      Val* dim = pdim_map.get(pt);
+      if (dim == nullptr) {
+        continue;
+      }
+      if (!dim->isConstInt()) {
+        return false;
+      }
+      num_threads *= dim->evaluate().as<int64_t>();
+    }
+    return num_threads == 32;
+  }
+
+  static bool isLocal(Val* val) {
+    if (auto ti = dynamic_cast<kir::TensorIndex*>(val)) {
+      val = ti->view();
+    }
+    auto tv = dynamic_cast<TensorView*>(val);
+    return tv == nullptr || tv->getMemoryType() == MemoryType::Local;
+  }
+
+  //! True if `expr` does not touch shared or global memory and contains no
+  //! syncs
+  static bool isHarmless(Expr* expr) {
+    if (auto fl = dynamic_cast<ForLoop*>(expr)) {
+      return std::all_of(
+          fl->body().exprs().begin(), fl->body().exprs().end(), isHarmless);
+    }
+    if (auto ite = dynamic_cast<kir::IfThenElse*>(expr)) {
+      return std::all_of(
+                 ite->thenBody().exprs().begin(),
+                 ite->thenBody().exprs().end(),
+                 isHarmless) &&
+          std::all_of(ite->elseBody().exprs().begin(),
+                      ite->elseBody().exprs().end(),
+                      isHarmless);
+    }
+    if (expr->isA<kir::Allocate>()) {
+      return true;
+    }
+    // Syncs, barriers and the like have no outputs
+    if (expr->outputs().empty()) {
+      return false;
+    }
+    const bool has_tensor = std::any_of(
+        expr->outputs().begin(), expr->outputs().end(), [](Val* out) {
+          return out->isA<TensorView>() || out->isA<kir::TensorIndex>();
+        });
+    // Reads the philox seed from global memory
+    if (expr->isA<kir::GetRNGSeedAndOffsetFromHost>()) {
+      return false;
+    }
+    if (has_tensor &&
+        !expr->isOneOf<UnaryOp, BinaryOp, TernaryOp, LoadStoreOp>()) {
+      return false;
+    }
+    return std::all_of(
+               expr->inputs().begin(), expr->inputs().end(), isLocal) &&
+        std::all_of(expr->outputs().begin(), expr->outputs().end(), isLocal);
+  }
+
+  void dispatch(Expr* expr) final {
+    if (expr->isOneOf<ForLoop, kir::IfThenElse>()) {
+      kir::ExprMutator::dispatch(expr);
+    } else if (auto sync = dynamic_cast<kir::BlockSync*>(expr)) {
+      handleSync(sync);
+    } else if (!isHarmless(expr)) {
+      synced_ = false;
+    }
+  }
+
+  void handleSync(kir::BlockSync* sync) {
+    if (synced_) {
+      registerRemove(sync);
+      ++num_removed_;
+      return;
+    }
+    synced_ = true;
+    if (single_warp_ && !sync->isWarpSync()) {
+      registerReplace(
+          sync,
+          IrBuilder::create<kir::BlockSync>(sync->isWarHazardSync(), true));
+      ++num_warp_syncs_;
+    }
+  }
+
+  void handle(ForLoop* fl) final {
+    const bool synced = synced_ && isHarmless(fl);
+    synced_ = false;
+    kir::ExprMutator::handle(fl);
+    synced_ = synced;
+  }
+
+  void handle(kir::IfThenElse* ite) final {
+    const bool synced = synced_;
+    const bool harmless = isHarmless(ite);
+    scope_exprs_.push_back(ite);
+    for (Scope* body : {&ite->thenBody(), &ite->elseBody()}) {
+      synced_ = synced;
+      scope_.push_back(body);
+      for (auto expr : std::vector<Expr*>(body->exprs())) {
+        dispatch(expr);
+      }
+      scope_.pop_back();
+    }
+    scope_exprs_.pop_back();
+    synced_ = synced && harmless;
+  }
+
+ private:
+  //! Only exprs that do not touch memory were visited since the last sync in
+  //! the current scope
+  bool synced_ = false;
+  const bool single_warp_;
+  int64_t num_removed_ = 0;
+  int64_t num_warp_syncs_ = 0;
+};
+
 } // namespace
 
 std::vector<Expr*> insertRawThreadSynchronization(
@@ -700,4 +862,13 @@ std::vector<Expr*> insertWarThreadSynchronization(
   FUSER_PERF_SCOPE("GpuLower::Lower::insertWarThreadSynchronization");
   return WarSyncInserter::insert(exprs);
 }
+
+std::vector<Expr*> elideRedundantSyncs(const std::vector<Expr*>& exprs) {
+  FUSER_PERF_SCOPE("GpuLower::Lower::elideRedundantSyncs");
+  if (!isOptionEnabled(EnableOption::ElideSyncs)) {
+    return exprs;
+  }
+  return RedundantSyncElider::run(exprs);
+}
+
 } // namespace nvfuser
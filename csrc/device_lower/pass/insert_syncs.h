@@ -29,4 +29,10 @@ std::vector<Expr*> insertWarThreadSynchronization(
 std::vector<Expr*> insertRawThreadSynchronization(
     const std::vector<Expr*>& exprs);
 
+//! Remove block syncs that only follow expressions not touching shared or
+//! global memory since the previous sync, and use warp syncs when the block
+//! is a single warp. Enabled with NVFUSER_ENABLE=elide_syncs. See
+//! [ Note -- Elision of redundant block syncs ] in insert_syncs.cpp.
+std::vector<Expr*> elideRedundantSyncs(const std::vector<Expr*>& exprs);
+
 } // namespace nvfuser
@@ -7,19 +7,83 @@
 // clang-format on
 #include <device_lower/lower2device.h>
 #include <device_lower/pass/magic_zero.h>
+#include <device_lower/utils.h>
 #include <iter_visitor.h>
 #include <kernel_ir_dispatch.h>
 
 #include <device_lower/pass/instrument.h>
 
+#include <algorithm>
+#include <optional>
+
 namespace nvfuser {
 
+// Note [Profiled kernel regions]
+//
+// By default, NVFUSER_ENABLE=kernel_profile only times the grid reductions,
+// from one thread of the last block. With kernel_profile(regions), the
+// kernel is instead broken down into regions:
+//   - every top-level loop nest, i.e. ForLoop or IfThenElse of the
+//     top-level expressions, classified as a load if the leaf exprs it
+//     contains are loads from global memory, besides allocations and syncs,
+//     and as compute otherwise,
+//   - every block sync, grid sync and grid reduction, nested in the
+//     top-level loop nest containing it, if any.
+// Codegen brackets each region with clock64 samples taken by the first lane
+// of each warp, which atomically adds the elapsed cycles and a hit to the
+// profile entry of the region. The count of an entry is thus the number of
+// warps times the number of executions, and the time per hit is the time a
+// warp spent in the region. Loads are asynchronous, so their latency is only
+// visible where the loaded values are used, typically in the next sync or
+// compute region.
+//
+// The regions nested in a loop nest are also part of its time. The
+// breakdown in FusionProfiler therefore subtracts them from the loop nest
+// they belong to, so that the shares of the kinds of regions add up to the
+// time of the top-level regions. This shows, e.g., how long the warps of a
+// persistent kernel wait in grid syncs compared to the time they compute.
+// The samples, the atomics and the clock64 dependencies slow the kernel
+// down, so the absolute times are only indicative.
+
 namespace {
 
+//! Kind of the region of a sync or grid reduction, or std::nullopt
+std::optional<kir::KernelPerformanceProfile::RegionKind> syncRegionKind(
+    const Expr* expr) {
+  using RegionKind = kir::KernelPerformanceProfile::RegionKind;
+  if (expr->isA<kir::BlockSync>()) {
+    return RegionKind::BlockSync;
+  }
+  if (expr->isA<kir::GridSync>()) {
+    return RegionKind::GridSync;
+  }
+  if (expr->isOneOf<
+          kir::GridReduction,
+          kir::GroupedGridReduction,
+          kir::GridWelford,
+          kir::GroupedGridWelford>()) {
+    return RegionKind::GridReduction;
+  }
+  return std::nullopt;
+}
+
+bool isGlobalLoad(const Expr* expr) {
+  auto ldst = dynamic_cast<const LoadStoreOp*>(expr);
+  if (ldst == nullptr) {
+    return false;
+  }
+  auto in = dynamic_cast<const kir::TensorIndex*>(ldst->in());
+  return in != nullptr && in->view()->getMemoryType() == MemoryType::Global;
+}
+
 class Instrumentor : private kir::IrVisitor {
  public:
   Instrumentor(const std::vector<Expr*>& exprs) {
-    IrVisitor::handle(exprs);
+    if (hasEnableOptionArgument(EnableOption::KernelProfile, "regions")) {
+      registerRegions(exprs);
+    } else {
+      IrVisitor::handle(exprs);
+    }
 
     if (profile_.getNumberOfProfileEntries() == 0) {
       exprs_ = exprs;
@@ -62,6 +126,37 @@ class Instrumentor : private kir::IrVisitor {
     profile_.registerExpr(expr);
   }
 
+  //! See Note [Profiled kernel regions]
+  void registerRegions(const std::vector<Expr*>& exprs) {
+    using RegionKind = kir::KernelPerformanceProfile::RegionKind;
+    for (Expr* expr : exprs) {
+      if (auto kind = syncRegionKind(expr)) {
+        profile_.registerRegion(expr, *kind, nullptr);
+        continue;
+      }
+      if (!expr->isOneOf<ForLoop, kir::IfThenElse>()) {
+        continue;
+      }
+      const std::vector<Expr*> leaves = ir_utils::flattenScopedExprs({expr});
+      const bool is_load = std::all_of(
+          leaves.begin(), leaves.end(), [](Expr* leaf) {
+            return leaf->isA<kir::Allocate>() ||
+                syncRegionKind(leaf).has_value() || isGlobalLoad(leaf);
+          });
+      const bool has_load =
+          std::any_of(leaves.begin(), leaves.end(), isGlobalLoad);
+      profile_.registerRegion(
+          expr,
+          is_load && has_load ? RegionKind::Load : RegionKind::Compute,
+          nullptr);
+      for (Expr* leaf : leaves) {
+        if (auto kind = syncRegionKind(leaf)) {
+          profile_.registerRegion(leaf, *kind, expr);
+        }
+      }
+    }
+  }
+
   void allocateBuffer() {
     const auto num_profile_entries =
         (int64_t)profile_.getNumberOfProfileEntries();
@@ -0,0 +1,437 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#include <device_lower/pass/loop_peeling.h>
+
+#include <device_lower/lower2device.h>
+#include <device_lower/utils.h>
+#include <ir/builder.h>
+#include <ir/utils.h>
+#include <kernel_ir.h>
+#include <kernel_ir_dispatch.h>
+#include <options.h>
+
+#include <unordered_map>
+
+namespace nvfuser {
+
+// [ Note -- Predicate peeling ]
+//
+// The serial loops of reduction and persistent kernels usually look like:
+//
+//   for (i = 0; i < n; ++i) {
+//     float T2[4];
+//     if (unswitch_pred(i)) {
+//       // unpredicated body(i)
+//     } else {
+//       // predicated body(i)
+//     }
+//   }
+//
+// The loop is the outer domain of a split by the number of elements a thread
+// processes per iteration, so when the split is not divisible only the last
+// iteration needs the predicated body. With NVFUSER_ENABLE=predicate_peeling,
+// peelUnswitchedLoops generates the leading full iterations as a separate loop
+// without any predicates:
+//
+//   nvfuser_index_t peeled = n > 1 && unswitch_pred(0) && unswitch_pred(n - 2)
+//       ? n - 1 : 0;
+//   for (i = 0; i < peeled; ++i) {
+//     float T2[4];
+//     // unpredicated body(i)
+//   }
+//   for (i = peeled; i < n; ++i) {
+//     // the original loop body
+//   }
+//
+// This is valid when unswitch_pred is a conjunction of conditions that are
+// each monotonic in i, e.g., comparisons of indices that are non-decreasing in
+// i with loop-invariant extents. Each such condition then holds for all of
+// [0, n - 1) if it holds for the first and the last of them. Threads that fail
+// the check, e.g. those mapped to out-of-bound rows, run all iterations in
+// the original loop.
+//
+// As the two loops may run different numbers of iterations in different
+// threads, loops whose body has block syncs, block or grid reductions and
+// broadcasts, or any other op that needs threads to be converged are not
+// peeled.
+
+namespace {
+
+//! How a value changes as the index of a loop increases
+enum class Trend { Invariant, NonDecreasing, NonIncreasing, Unknown };
+
+Trend flip(Trend trend) {
+  switch (trend) {
+    case Trend::NonDecreasing:
+      return Trend::NonIncreasing;
+    case Trend::NonIncreasing:
+      return Trend::NonDecreasing;
+    default:
+      return trend;
+  }
+}
+
+Trend combine(Trend a, Trend b) {
+  if (a == Trend::Invariant) {
+    return b;
+  }
+  if (b == Trend::Invariant || a == b) {
+    return a;
+  }
+  return Trend::Unknown;
+}
+
+bool isNonNegative(Val* val) {
+  if (val->isConst()) {
+    return val->value().is<int64_t>() && val->value().as<int64_t>() >= 0;
+  }
+  if (auto ns = dynamic_cast<NamedScalar*>(val)) {
+    return ns->getParallelDim().has_value() ||
+        ns->getParallelIndex().has_value();
+  }
+  Expr* def = val->definition();
+  if (def == nullptr) {
+    return false;
+  }
+  // Sizes and strides of tensors
+  if (def->isA<GetItem>()) {
+    return isIntegralType(val->dtype());
+  }
+  if (auto uop = dynamic_cast<UnaryOp*>(def)) {
+    return uop->getUnaryOpType() == UnaryOpType::Cast &&
+        isNonNegative(uop->in());
+  }
+  auto bop = dynamic_cast<BinaryOp*>(def);
+  if (bop == nullptr) {
+    return false;
+  }
+  switch (bop->getBinaryOpType()) {
+    case BinaryOpType::Add:
+    case BinaryOpType::Mul:
+    case BinaryOpType::Div:
+    case BinaryOpType::Mod:
+    case BinaryOpType::CeilDiv:
+    case BinaryOpType::Min:
+      return isNonNegative(bop->lhs()) && isNonNegative(bop->rhs());
+    case BinaryOpType::Max:
+      return isNonNegative(bop->lhs()) || isNonNegative(bop->rhs());
+    default:
+      return false;
+  }
+}
+
+//! Trends of the values a predicate is computed from in the index of a loop
+class TrendAnalysis {
+ public:
+  explicit TrendAnalysis(Val* index) : index_(index) {}
+
+  //! True if a predicate holds for a range of the index when it holds for the
+  //! beginning and the end of the range
+  bool holdsForRangeIfHoldsForEnds(Val* pred) {
+    if (auto bop = dynamic_cast<BinaryOp*>(pred->definition());
+        bop != nullptr && bop->getBinaryOpType() == BinaryOpType::LogicalAnd) {
+      return holdsForRangeIfHoldsForEnds(bop->lhs()) &&
+          holdsForRangeIfHoldsForEnds(bop->rhs());
+    }
+    return trend(pred) != Trend::Unknown;
+  }
+
+ private:
+  Trend trend(Val* val) {
+    auto it = trends_.find(val);
+    if (it != trends_.end()) {
+      return it->second;
+    }
+    auto result = computeTrend(val);
+    trends_.emplace(val, result);
+    return result;
+  }
+
+  Trend computeTrend(Val* val) {
+    if (val == index_) {
+      return Trend::NonDecreasing;
+    }
+    // Tensors may be read with the index
+    if (val->isA<kir::TensorIndex>()) {
+      return Trend::Unknown;
+    }
+    Expr* def = val->definition();
+    if (def == nullptr) {
+      return Trend::Invariant;
+    }
+
+    std::vector<Trend> input_trends;
+    input_trends.reserve(def->inputs().size());
+    bool invariant = true;
+    for (Val* inp : def->inputs()) {
+      input_trends.push_back(trend(inp));
+      invariant = invariant && input_trends.back() == Trend::Invariant;
+    }
+    if (invariant) {
+      return Trend::Invariant;
+    }
+
+    if (auto uop = dynamic_cast<UnaryOp*>(def)) {
+      switch (uop->getUnaryOpType()) {
+        case UnaryOpType::Cast:
+          return isIntegralType(uop->in()->dtype()) &&
+                  isIntegralType(uop->out()->dtype())
+              ? input_trends.at(0)
+              : Trend::Unknown;
+        case UnaryOpType::Neg:
+          return flip(input_trends.at(0));
+        default:
+          return Trend::Unknown;
+      }
+    }
+
+    if (auto top = dynamic_cast<TernaryOp*>(def)) {
+      return top->getTernaryOpType() == TernaryOpType::Where &&
+              input_trends.at(0) == Trend::Invariant
+          ? combine(input_trends.at(1), input_trends.at(2))
+          : Trend::Unknown;
+    }
+
+    auto bop = dynamic_cast<BinaryOp*>(def);
+    if (bop == nullptr) {
+      return Trend::Unknown;
+    }
+    const Trend lhs = input_trends.at(0);
+    const Trend rhs = input_trends.at(1);
+    switch (bop->getBinaryOpType()) {
+      case BinaryOpType::Add:
+      case BinaryOpType::Max:
+      case BinaryOpType::Min:
+      case BinaryOpType::LogicalAnd:
+      case BinaryOpType::LogicalOr:
+        return combine(lhs, rhs);
+      case BinaryOpType::Sub:
+        return combine(lhs, flip(rhs));
+      case BinaryOpType::Mul:
+        if (lhs == Trend::Invariant && isNonNegative(bop->lhs())) {
+          return rhs;
+        }
+        if (rhs == Trend::Invariant && isNonNegative(bop->rhs())) {
+          return lhs;
+        }
+        return Trend::Unknown;
+      case BinaryOpType::Div:
+      case BinaryOpType::CeilDiv:
+        return rhs == Trend::Invariant && isNonNegative(bop->rhs())
+            ? lhs
+            : Trend::Unknown;
+      case BinaryOpType::LT:
+      case BinaryOpType::LE:
+        return combine(flip(lhs), rhs);
+      case BinaryOpType::GT:
+      case BinaryOpType::GE:
+        return combine(lhs, flip(rhs));
+      default:
+        return Trend::Unknown;
+    }
+  }
+
+  Val* index_ = nullptr;
+  std::unordered_map<Val*, Trend> trends_;
+};
+
+//! True if the iterations of a loop with these exprs can be run by threads
+//! independently of each other
+bool isThreadIndependent(const std::vector<Expr*>& exprs) {
+  for (Expr* expr : exprs) {
+    if (auto fl = dynamic_cast<ForLoop*>(expr)) {
+      if (!isThreadIndependent(fl->body().exprs())) {
+        return false;
+      }
+    } else if (auto ite = dynamic_cast<kir::IfThenElse*>(expr)) {
+      if (!isThreadIndependent(ite->thenBody().exprs()) ||
+          !isThreadIndependent(ite->elseBody().exprs())) {
+        return false;
+      }
+    } else if (auto alloc = dynamic_cast<kir::Allocate*>(expr)) {
+      if (alloc->memoryType() != MemoryType::Local) {
+        return false;
+      }
+    } else if (auto ldst = dynamic_cast<LoadStoreOp*>(expr)) {
+      if (ldst->opType() != LoadStoreOpType::Set) {
+        return false;
+      }
+    } else if (expr->isOneOf<ReductionOp, GroupedReductionOp, WelfordOp>()) {
+      auto domain = ir_utils::getTvOutput(expr)->domain();
+      if (domain->hasBlockReduction() || domain->hasGridReduction()) {
+        return false;
+      }
+    } else if (auto bop = dynamic_cast<BroadcastOp*>(expr)) {
+      if (GpuLower::current()
+              ->threadPredMap()
+              .getParallelBroadcastDomains(ir_utils::getTvOutput(bop))
+              .any()) {
+        return false;
+      }
+    } else if (!expr->isOneOf<
+                   UnaryOp,
+                   BinaryOp,
+                   TernaryOp,
+                   kir::VectorizedWelfordOp>()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+Expr* recursivelyClone(Expr* expr) {
+  if (auto fl = dynamic_cast<ForLoop*>(expr)) {
+    auto new_loop = IrBuilder::create<ForLoop>(fl);
+    for (auto e : fl->body().exprs()) {
+      new_loop->body().push_back(recursivelyClone(e));
+    }
+    return new_loop;
+  } else if (auto ite = dynamic_cast<kir::IfThenElse*>(expr)) {
+    auto new_ite = IrBuilder::create<kir::IfThenElse>(ite->predicate());
+    for (auto e : ite->thenBody().exprs()) {
+      new_ite->thenBody().push_back(recursivelyClone(e));
+    }
+    for (auto e : ite->elseBody().exprs()) {
+      new_ite->elseBody().push_back(recursivelyClone(e));
+    }
+    return new_ite;
+  }
+  auto clone = expr->shallowCopy();
+  GpuLower::current()->propagateExprInfo(expr, clone);
+  return clone;
+}
+
+class LoopPeeler : public kir::ExprMutator {
+ public:
+  static std::vector<Expr*> run(const std::vector<Expr*>& exprs) {
+    LoopPeeler peeler;
+    return peeler.traverseAndInsert(exprs);
+  }
+
+ private:
+  using kir::ExprMutator::handle;
+
+  void handle(ForLoop* fl) final {
+    if (auto ite = getUnswitchedScope(fl)) {
+      peel(fl, ite);
+      return;
+    }
+    kir::ExprMutator::handle(fl);
+  }
+
+  //! Returns the unswitched IfThenElse if fl is a serial loop from zero
+  //! whose body is only the IfThenElse and local allocations
+  kir::IfThenElse* getUnswitchedScope(ForLoop* fl) const {
+    if (fl->isTrivial() || fl->isUnrolled() || fl->vectorize() ||
+        fl->iter_domain()->getParallelType() != ParallelType::Serial ||
+        fl->circularBufferLoopStage() !=
+            CircularBufferLoopStage::NotApplicable ||
+        !fl->start()->isZeroInt() || !fl->step()->isOneInt()) {
+      return nullptr;
+    }
+    kir::IfThenElse* unswitched = nullptr;
+    for (Expr* expr : fl->body().exprs()) {
+      if (auto alloc = dynamic_cast<kir::Allocate*>(expr);
+          alloc != nullptr && unswitched == nullptr &&
+          alloc->memoryType() == MemoryType::Local) {
+        continue;
+      }
+      auto ite = dynamic_cast<kir::IfThenElse*>(expr);
+      if (ite == nullptr || unswitched != nullptr ||
+          ite->predicate()->predicate_type() != PredicateType::Unswitch ||
+          !ite->predicate()->hasValue()) {
+        return nullptr;
+      }
+      unswitched = ite;
+    }
+    if (unswitched == nullptr ||
+        !isThreadIndependent(fl->body().exprs()) ||
+        !TrendAnalysis(fl->index())
+             .holdsForRangeIfHoldsForEnds(unswitched->predicate()->value())) {
+      return nullptr;
+    }
+    return unswitched;
+  }
+
+  void peel(ForLoop* fl, kir::IfThenElse* ite) {
+    auto kernel = GpuLower::current()->kernel();
+    Val* pred = ite->predicate()->value();
+    Val* stop = fl->stop();
+
+    Val* pred_first = ir_utils::replaceValRecursively(
+        pred, {{fl->index(), kernel->zeroVal()}});
+    Val* pred_last = ir_utils::replaceValRecursively(
+        pred,
+        {{fl->index(),
+          IrBuilder::subExpr(
+              stop, IrBuilder::create<Val>(2L, DataType::Index))}});
+    Val* all_full = IrBuilder::logicalAndExpr(
+        IrBuilder::gtExpr(stop, kernel->oneVal()),
+        IrBuilder::logicalAndExpr(pred_first, pred_last));
+
+    Val* peeled = IrBuilder::create<Val>(DataType::Index);
+    auto alloc = IrBuilder::create<kir::Allocate>(
+        peeled, MemoryType::Local, kernel->oneVal());
+    auto def = IrBuilder::create<TernaryOp>(
+        TernaryOpType::Where,
+        peeled,
+        all_full,
+        IrBuilder::subExpr(stop, kernel->oneVal()),
+        kernel->zeroVal());
+
+    auto full_loop = IrBuilder::create<ForLoop>(
+        fl->iter_domain(),
+        fl->index(),
+        fl->start(),
+        peeled,
+        fl->step(),
+        fl->vectorize(),
+        fl->vectorize_shift(),
+        fl->isUnrollRequired(),
+        fl->circularBufferLoopStage());
+    for (Expr* expr : fl->body().exprs()) {
+      if (expr == ite) {
+        for (Expr* then_expr : ite->thenBody().exprs()) {
+          full_loop->body().push_back(recursivelyClone(then_expr));
+        }
+      } else {
+        full_loop->body().push_back(recursivelyClone(expr));
+      }
+    }
+
+    auto remainder_loop = IrBuilder::create<ForLoop>(
+        fl->iter_domain(),
+        fl->index(),
+        peeled,
+        fl->stop(),
+        fl->step(),
+        fl->vectorize(),
+        fl->vectorize_shift(),
+        fl->isUnrollRequired(),
+        fl->circularBufferLoopStage());
+    for (Expr* expr : fl->body().exprs()) {
+      remainder_loop->body().push_back(expr);
+    }
+
+    registerInsertBefore(fl, alloc);
+    registerInsertBefore(fl, def);
+    registerInsertBefore(fl, full_loop);
+    registerReplace(fl, remainder_loop);
+  }
+};
+
+} // namespace
+
+std::vector<Expr*> peelUnswitchedLoops(const std::vector<Expr*>& exprs) {
+  if (!isOptionEnabled(EnableOption::PredicatePeeling)) {
+    return exprs;
+  }
+  return LoopPeeler::run(exprs);
+}
+
+} // namespace nvfuser
@@ -0,0 +1,23 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#pragma once
+
+#include <ir/all_nodes.h>
+
+#include <vector>
+
+namespace nvfuser {
+
+//! Peel the full iterations of serial loops whose body is an unswitched
+//! scope into a loop without predicates, leaving the remaining iterations,
+//! usually just the last one, to the original loop. See
+//! [ Note -- Predicate peeling ] in loop_peeling.cpp. Only enabled with
+//! NVFUSER_ENABLE=predicate_peeling.
+std::vector<Expr*> peelUnswitchedLoops(const std::vector<Expr*>& exprs);
+
+} // namespace nvfuser
@@ -0,0 +1,343 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#include <device_lower/pass/packed_arithmetic.h>
+
+#include <device_lower/lower2device.h>
+#include <ir/builder.h>
+#include <ir/utils.h>
+#include <kernel_ir.h>
+#include <kernel_ir_dispatch.h>
+#include <options.h>
+
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace nvfuser {
+
+// [ Note -- Packed arithmetic ]
+//
+// fp16 and bf16 pointwise ops are computed in float, so a scale-bias-relu of
+// half tensors, once unrolled, is
+//
+//   for (i = 0; i < 4; ++i) {
+//     T2[i] = __half2float(T0[i]);
+//     T3[i] = T2[i] * s;
+//     T4[i] = T3[i] + b;
+//     T5[i] = relu(T4[i]);
+//     T6[i] = __float2half(T5[i]);
+//   }
+//
+// i.e., one float instruction per element and op on top of the conversions,
+// even though sm53+ computes pairs of fp16 values with one add.f16x2,
+// mul.f16x2 or fma.rn.f16x2 instruction, and sm80+ pairs of bf16 values with
+// fma.rn.bf16x2. Compute bound chains like polynomial activations are then
+// limited by the float pipe.
+//
+// With NVFUSER_ENABLE=packed_arithmetic, packArithmetic steps such loops by
+// two and codegen keeps each float intermediate of the body as a pair of low
+// precision values:
+//
+//   for (i = 0; i < 4; i += 2) {
+//     __halfx2 T2x2 = __packx2(T0[i], T0[i + 1]);
+//     __halfx2 T3x2 = __mulx2(T2x2, __halfx2_broadcast((float)s));
+//     __halfx2 T4x2 = __addx2(T3x2, __halfx2_broadcast((float)b));
+//     __halfx2 T5x2 = __relux2(T4x2);
+//     __unpackx2(T5x2, T6[i], T6[i + 1]);
+//   }
+//
+// where the x2 helpers are defined in runtime/fp16_support.cu and
+// bf16_support.cu. The second element of each cast is recorded in
+// GpuLower::packedArithmeticCasts, and codegen prints a loop body as packed
+// arithmetic when it contains such a cast.
+//
+// This is a precision mode: each op rounds to the low precision type instead
+// of only the last one, i.e., a relative error of up to 2^-11 for fp16 and
+// 2^-8 for bf16 per op, and a product followed by a sum may be contracted to
+// one fma. To keep the accumulated error within the tolerances of the
+// validator, only chains of at most kMaxPackedOps adds, subs, muls, negs and
+// relus are packed. Any other op keeps the loop in float.
+//
+// A body is packed only if
+//  - all the casts convert between float and the same low precision type,
+//  - each float intermediate is a Local tensor written once before being
+//    read, at the same index, and not accessed outside of the loop, so it
+//    never needs to be stored as float, and
+//  - no low precision tensor is both read and written in the loop, so
+//    computing two iterations at once does not reorder any dependency.
+// As for packed casts, only loops from zero with a constant even extent are
+// transformed, so there is no predicate to split.
+
+namespace {
+
+// Number of rounded ops allowed in a packed chain
+constexpr int64_t kMaxPackedOps = 8;
+
+bool isLowPrecision(DataType dtype) {
+  return dtype == DataType::Half || dtype == DataType::BFloat16;
+}
+
+TensorView* getTensor(Val* val) {
+  if (auto ti = dynamic_cast<kir::TensorIndex*>(val)) {
+    return ti->view();
+  }
+  return dynamic_cast<TensorView*>(val);
+}
+
+// Float intermediates are Local float tensors
+bool isFloatRegister(Val* val) {
+  auto ti = dynamic_cast<kir::TensorIndex*>(val);
+  return ti != nullptr && ti->dtype() == DataType::Float &&
+      ti->view()->getMemoryType() == MemoryType::Local;
+}
+
+// Counts the exprs accessing each tensor in the kernel
+class TensorAccessCounter : public kir::IrVisitor {
+ public:
+  static std::unordered_map<TensorView*, int64_t> run(
+      const std::vector<Expr*>& exprs) {
+    TensorAccessCounter counter;
+    counter.handle(exprs);
+    return counter.counts_;
+  }
+
+ private:
+  using kir::IrVisitor::handle;
+
+  void dispatch(Expr* expr) final {
+    if (!expr->isOneOf<ForLoop, kir::IfThenElse, kir::Allocate>()) {
+      for (auto vals : {expr->inputs(), expr->outputs()}) {
+        for (auto val : vals) {
+          if (auto tv = getTensor(val)) {
+            ++counts_[tv];
+          }
+        }
+      }
+    }
+    kir::IrVisitor::dispatch(expr);
+  }
+
+ private:
+  std::unordered_map<TensorView*, int64_t> counts_;
+};
+
+class ArithmeticPacker : public kir::ExprMutator {
+ public:
+  static std::vector<Expr*> run(const std::vector<Expr*>& exprs) {
+    ArithmeticPacker packer(TensorAccessCounter::run(exprs));
+    return packer.traverseAndInsert(exprs);
+  }
+
+ private:
+  ArithmeticPacker(std::unordered_map<TensorView*, int64_t> access_counts)
+      : access_counts_(std::move(access_counts)) {}
+
+  using kir::ExprMutator::handle;
+
+  void handle(ForLoop* fl) final {
+    if (isPackable(fl)) {
+      pack(fl);
+      return;
+    }
+    kir::ExprMutator::handle(fl);
+  }
+
+  //! Returns true if fl has an even number of iterations and its body is a
+  //! chain of packable ops between low precision casts
+  bool isPackable(ForLoop* fl) const {
+    if (fl->isTrivial() || fl->isGroup() || fl->vectorize() ||
+        (fl->iter_domain()->getParallelType() != ParallelType::Serial &&
+         fl->iter_domain()->getParallelType() != ParallelType::Unroll) ||
+        fl->circularBufferLoopStage() !=
+            CircularBufferLoopStage::NotApplicable ||
+        !fl->start()->isZeroInt() || !fl->step()->isOneInt() ||
+        !fl->stop()->isConstInt()) {
+      return false;
+    }
+    const int64_t extent = fl->stop()->evaluate().as<int64_t>();
+    if (extent < 2 || extent % 2 != 0) {
+      return false;
+    }
+
+    std::optional<DataType> low_precision_type;
+    std::unordered_set<TensorView*> allocated;
+    std::unordered_set<TensorView*> written;
+    std::unordered_map<TensorView*, int64_t> accesses;
+    std::unordered_map<TensorView*, Val*> indices;
+    std::unordered_set<TensorView*> low_precision_reads;
+    std::unordered_set<TensorView*> low_precision_writes;
+    int64_t num_ops = 0;
+
+    // Records an access to a float intermediate, which must always be at the
+    // same index
+    auto access = [&](Val* val) {
+      auto ti = val->as<kir::TensorIndex>();
+      ++accesses[ti->view()];
+      auto [it, inserted] = indices.emplace(ti->view(), ti->index());
+      return inserted || it->second->sameAs(ti->index());
+    };
+    auto write = [&](Val* val) {
+      return written.insert(val->as<kir::TensorIndex>()->view()).second &&
+          access(val);
+    };
+    // Operands are either float intermediates or loop invariant scalars
+    auto read = [&](Val* val) {
+      if (isFloatRegister(val)) {
+        return written.count(val->as<kir::TensorIndex>()->view()) > 0 &&
+            access(val);
+      }
+      return val->isScalar() &&
+          (val->dtype() == DataType::Float ||
+           val->dtype() == DataType::Double) &&
+          (val->isConst() || val->definition() == nullptr);
+    };
+    auto cast_type = [&](DataType dtype) {
+      if (!low_precision_type.has_value()) {
+        low_precision_type = dtype;
+      }
+      return low_precision_type == dtype;
+    };
+
+    for (Expr* expr : fl->body().exprs()) {
+      if (auto alloc = dynamic_cast<kir::Allocate*>(expr)) {
+        auto tv = dynamic_cast<TensorView*>(alloc->buffer());
+        if (tv == nullptr || tv->dtype() != DataType::Float ||
+            tv->getMemoryType() != MemoryType::Local) {
+          return false;
+        }
+        allocated.insert(tv);
+        continue;
+      }
+
+      if (auto uop = dynamic_cast<UnaryOp*>(expr)) {
+        Val* in = uop->in();
+        Val* out = uop->out();
+        if (uop->getUnaryOpType() == UnaryOpType::Cast) {
+          if (in->isA<kir::TensorIndex>() && isLowPrecision(in->dtype()) &&
+              isFloatRegister(out)) {
+            if (!cast_type(in->dtype()) || !write(out)) {
+              return false;
+            }
+            low_precision_reads.insert(getTensor(in));
+          } else if (
+              isFloatRegister(in) && out->isA<kir::TensorIndex>() &&
+              isLowPrecision(out->dtype())) {
+            if (!cast_type(out->dtype()) || !read(in)) {
+              return false;
+            }
+            low_precision_writes.insert(getTensor(out));
+          } else {
+            return false;
+          }
+          continue;
+        }
+        if ((uop->getUnaryOpType() != UnaryOpType::Neg &&
+             uop->getUnaryOpType() != UnaryOpType::Relu) ||
+            !isFloatRegister(out) || !read(in) || !write(out)) {
+          return false;
+        }
+        ++num_ops;
+        continue;
+      }
+
+      if (auto bop = dynamic_cast<BinaryOp*>(expr)) {
+        if ((bop->getBinaryOpType() != BinaryOpType::Add &&
+             bop->getBinaryOpType() != BinaryOpType::Sub &&
+             bop->getBinaryOpType() != BinaryOpType::Mul) ||
+            !isFloatRegister(bop->out()) || !read(bop->lhs()) ||
+            !read(bop->rhs()) || !write(bop->out())) {
+          return false;
+        }
+        ++num_ops;
+        continue;
+      }
+
+      return false;
+    }
+
+    if (!low_precision_type.has_value() || num_ops == 0 ||
+        num_ops > kMaxPackedOps) {
+      return false;
+    }
+    for (auto tv : low_precision_reads) {
+      if (low_precision_writes.count(tv) > 0) {
+        return false;
+      }
+    }
+    for (auto tv : allocated) {
+      if (accesses.count(tv) == 0) {
+        return false;
+      }
+    }
+    // The float intermediates are never stored as float, so they must not be
+    // accessed anywhere else
+    for (const auto& [tv, count] : accesses) {
+      auto it = access_counts_.find(tv);
+      if (it == access_counts_.end() || it->second != count) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void pack(ForLoop* fl) {
+    Val* next_index = IrBuilder::addExpr(
+        fl->index(), GpuLower::current()->kernel()->oneVal());
+    auto next_element = [&](Val* val) {
+      auto ti = val->as<kir::TensorIndex>();
+      return IrBuilder::create<kir::TensorIndex>(
+          ti->view(),
+          ir_utils::replaceValRecursively(
+              ti->index(), {{fl->index(), next_index}}),
+          ti->dtype());
+    };
+
+    auto packed_loop = IrBuilder::create<ForLoop>(
+        fl->iter_domain(),
+        fl->index(),
+        fl->start(),
+        fl->stop(),
+        IrBuilder::create<Val>(2L, DataType::Index),
+        fl->vectorize(),
+        fl->vectorize_shift(),
+        fl->isUnrollRequired(),
+        fl->circularBufferLoopStage());
+    for (Expr* expr : fl->body().exprs()) {
+      packed_loop->body().push_back(expr);
+      auto uop = dynamic_cast<UnaryOp*>(expr);
+      if (uop == nullptr || uop->getUnaryOpType() != UnaryOpType::Cast) {
+        continue;
+      }
+      // Only the low precision side of a cast needs its second element
+      Val* out = uop->out();
+      Val* in = uop->in();
+      auto partner = IrBuilder::create<UnaryOp>(
+          UnaryOpType::Cast,
+          isFloatRegister(out) ? out : next_element(out),
+          isFloatRegister(in) ? in : next_element(in));
+      GpuLower::current()->propagateExprInfo(uop, partner);
+      packed_loop->body().push_back(partner);
+      GpuLower::current()->packedArithmeticCasts().emplace(uop, partner);
+    }
+    registerReplace(fl, packed_loop);
+  }
+
+ private:
+  const std::unordered_map<TensorView*, int64_t> access_counts_;
+};
+
+} // namespace
+
+std::vector<Expr*> packArithmetic(const std::vector<Expr*>& exprs) {
+  if (!isOptionEnabled(EnableOption::PackedArithmetic)) {
+    return exprs;
+  }
+  return ArithmeticPacker::run(exprs);
+}
+
+} // namespace nvfuser
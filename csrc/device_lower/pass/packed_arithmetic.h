@@ -0,0 +1,22 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#pragma once
+
+#include <ir/all_nodes.h>
+
+#include <vector>
+
+namespace nvfuser {
+
+//! Compute pairs of iterations of serial and unrolled fp16 and bf16
+//! pointwise loops with packed half2 and bfloat162 arithmetic. See
+//! [ Note -- Packed arithmetic ] in packed_arithmetic.cpp. Only enabled with
+//! NVFUSER_ENABLE=packed_arithmetic.
+std::vector<Expr*> packArithmetic(const std::vector<Expr*>& exprs);
+
+} // namespace nvfuser
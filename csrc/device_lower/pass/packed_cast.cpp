@@ -0,0 +1,152 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#include <device_lower/pass/packed_cast.h>
+
+#include <device_lower/lower2device.h>
+#include <ir/builder.h>
+#include <ir/utils.h>
+#include <kernel_ir.h>
+#include <kernel_ir_dispatch.h>
+#include <options.h>
+
+namespace nvfuser {
+
+// [ Note -- Packed casts ]
+//
+// Casts are never vectorized, so a cast of a vectorized load to fp8, e.g.
+//
+//   for (i = 0; i < 4; ++i) {
+//     T2[i] = __float2e4m3(T1[i]);
+//   }
+//
+// converts one element per instruction, even though the fp8 cvt instructions
+// of sm89 and the f16 and bf16 ones of sm80 convert two elements at once.
+// This makes fp8 quantization and dequantization epilogues instruction bound.
+//
+// With NVFUSER_ENABLE=packed_casts, packCasts steps such loops by two and
+// pairs the cast of each element with the cast of the next one:
+//
+//   for (i = 0; i < 4; i += 2) {
+//     __float2e4m3x2(T1[i], T1[i + 1], T2[i], T2[i + 1]);
+//   }
+//
+// where the x2 helpers of runtime/fp8_support.cu, fp16_support.cu and
+// bf16_support.cu issue a single packed cvt. The pairs are recorded in
+// GpuLower::packedCasts, and codegen prints the second cast of each pair as
+// part of the first one.
+//
+// Only loops from zero with a constant even extent whose body is just the
+// cast are transformed, so both elements of a pair are always converted by
+// the original loop as well and there is no predicate to split.
+
+namespace {
+
+bool hasPackedCast(DataType in, DataType out) {
+  const bool is_fp8_in =
+      in == DataType::Float8_e4m3fn || in == DataType::Float8_e5m2;
+  const bool is_fp8_out =
+      out == DataType::Float8_e4m3fn || out == DataType::Float8_e5m2;
+  if (is_fp8_out) {
+    return in == DataType::Float || in == DataType::Half;
+  }
+  if (is_fp8_in) {
+    return out == DataType::Float || out == DataType::Half;
+  }
+  return in == DataType::Float &&
+      (out == DataType::Half || out == DataType::BFloat16);
+}
+
+class CastPacker : public kir::ExprMutator {
+ public:
+  static std::vector<Expr*> run(const std::vector<Expr*>& exprs) {
+    CastPacker packer;
+    return packer.traverseAndInsert(exprs);
+  }
+
+ private:
+  using kir::ExprMutator::handle;
+
+  void handle(ForLoop* fl) final {
+    if (auto uop = getPackableCast(fl)) {
+      pack(fl, uop);
+      return;
+    }
+    kir::ExprMutator::handle(fl);
+  }
+
+  //! Returns the cast if the body of fl is only a packable cast and fl has
+  //! an even number of iterations
+  UnaryOp* getPackableCast(ForLoop* fl) const {
+    if (fl->isTrivial() || fl->isGroup() || fl->vectorize() ||
+        (fl->iter_domain()->getParallelType() != ParallelType::Serial &&
+         fl->iter_domain()->getParallelType() != ParallelType::Unroll) ||
+        fl->circularBufferLoopStage() !=
+            CircularBufferLoopStage::NotApplicable ||
+        !fl->start()->isZeroInt() || !fl->step()->isOneInt() ||
+        !fl->stop()->isConstInt() || fl->body().exprs().size() != 1) {
+      return nullptr;
+    }
+    const int64_t extent = fl->stop()->evaluate().as<int64_t>();
+    if (extent < 2 || extent % 2 != 0) {
+      return nullptr;
+    }
+    auto uop = dynamic_cast<UnaryOp*>(fl->body().exprs().front());
+    if (uop == nullptr || uop->getUnaryOpType() != UnaryOpType::Cast ||
+        !uop->in()->isA<kir::TensorIndex>() ||
+        !uop->out()->isA<kir::TensorIndex>() ||
+        uop->out()->as<kir::TensorIndex>()->view()->getMemoryType() !=
+            MemoryType::Local ||
+        !hasPackedCast(uop->in()->dtype(), uop->out()->dtype())) {
+      return nullptr;
+    }
+    return uop;
+  }
+
+  void pack(ForLoop* fl, UnaryOp* uop) {
+    Val* next_index = IrBuilder::addExpr(
+        fl->index(), GpuLower::current()->kernel()->oneVal());
+    auto next_element = [&](Val* val) {
+      auto ti = val->as<kir::TensorIndex>();
+      return IrBuilder::create<kir::TensorIndex>(
+          ti->view(),
+          ir_utils::replaceValRecursively(
+              ti->index(), {{fl->index(), next_index}}),
+          ti->dtype());
+    };
+    auto partner = IrBuilder::create<UnaryOp>(
+        UnaryOpType::Cast, next_element(uop->out()), next_element(uop->in()));
+    GpuLower::current()->propagateExprInfo(uop, partner);
+
+    auto packed_loop = IrBuilder::create<ForLoop>(
+        fl->iter_domain(),
+        fl->index(),
+        fl->start(),
+        fl->stop(),
+        IrBuilder::create<Val>(2L, DataType::Index),
+        fl->vectorize(),
+        fl->vectorize_shift(),
+        fl->isUnrollRequired(),
+        fl->circularBufferLoopStage());
+    packed_loop->body().push_back(uop);
+    packed_loop->body().push_back(partner);
+    registerReplace(fl, packed_loop);
+
+    GpuLower::current()->packedCasts().emplace(uop, partner);
+  }
+};
+
+} // namespace
+
+std::vector<Expr*> packCasts(const std::vector<Expr*>& exprs) {
+  if (!isOptionEnabled(EnableOption::PackedCasts)) {
+    return exprs;
+  }
+  return CastPacker::run(exprs);
+}
+
+} // namespace nvfuser
@@ -0,0 +1,22 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#pragma once
+
+#include <ir/all_nodes.h>
+
+#include <vector>
+
+namespace nvfuser {
+
+//! Convert pairs of elements of low precision casts in serial loops with one
+//! instruction each, e.g. cvt.rn.satfinite.e4m3x2.f32. See
+//! [ Note -- Packed casts ] in packed_cast.cpp. Only enabled with
+//! NVFUSER_ENABLE=packed_casts.
+std::vector<Expr*> packCasts(const std::vector<Expr*>& exprs);
+
+} // namespace nvfuser
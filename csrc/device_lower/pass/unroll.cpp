@@ -7,6 +7,7 @@
 // clang-format on
 #include <device_lower/pass/unroll.h>
 
+#include <debug.h>
 #include <device_lower/lower2device.h>
 #include <device_lower/pass/misaligned_vectorization.h>
 #include <device_lower/utils.h>
@@ -16,10 +17,36 @@
 #include <ir/iostream.h>
 #include <ir/utils.h>
 #include <ops/arith.h>
+#include <options.h>
 #include <predicate_compute.h>
 
 namespace nvfuser {
 
+// Note [Tile-level unswitch]
+//
+// Schedulers unswitch the loops of one iteration of a tile, e.g., the
+// unrolled elements a thread processes per iteration of a serial reduction
+// loop, so the unswitch predicate is evaluated in every iteration and the
+// non-divisible splits of the tile are still checked in the loop. With
+// NVFUSER_ENABLE=tile_unswitch, the outermost serial loop nest that contains
+// no op needing converged threads is unswitched as a whole:
+//
+//   if (unswitch_pred(the last iteration of the loop nest)) {
+//     for (i = 0; i < n; ++i) {
+//       // unpredicated body(i)
+//     }
+//   } else {
+//     for (i = 0; i < n; ++i) {
+//       // the original body(i) with its own unswitched scopes
+//     }
+//   }
+//
+// The unswitch predicate is generated as for any unswitched loop, i.e., with
+// the maximum index of all the loops in the nest for the stop predicates, so
+// a single check selects the fast path for the whole tile and only the
+// boundary tiles take the predicated path. The loops are reported with
+// NVFUSER_DUMP=predicate_elimination.
+
 namespace {
 
 // Provide a new for loop matching the one provided
@@ -34,6 +61,51 @@ ForLoop* cloneLoopNest(const ForLoop* for_loop) {
   return new_loop;
 }
 
+// Whether the loop nest of fl can be unswitched as a whole. See Note
+// [Tile-level unswitch]. Like the loops peeled by peelUnswitchedLoops, the
+// nest must not have any op that requires the threads to take the same path,
+// nor any conditional or shared memory allocation that the lowering has
+// already placed in it.
+bool isTileLoop(ForLoop* fl) {
+  if (fl->iter_domain()->getParallelType() != ParallelType::Serial ||
+      fl->isTrivial()) {
+    return false;
+  }
+
+  const auto& pred_map = GpuLower::current()->threadPredMap();
+
+  std::vector<ForLoop*> loops({fl});
+  while (!loops.empty()) {
+    auto loop = loops.back();
+    loops.pop_back();
+
+    if (loop->circularBufferLoopStage() !=
+            CircularBufferLoopStage::NotApplicable ||
+        containsAnyDirectChildMisalignedVectorize(loop)) {
+      return false;
+    }
+
+    for (auto expr : loop->body().exprs()) {
+      if (auto nested_loop = dynamic_cast<ForLoop*>(expr)) {
+        loops.push_back(nested_loop);
+        continue;
+      }
+      if (auto alloc = dynamic_cast<kir::Allocate*>(expr)) {
+        if (alloc->memoryType() != MemoryType::Local) {
+          return false;
+        }
+        continue;
+      }
+      if (!ir_utils::isTvOp(expr) || lower_utils::hasBlockSync(expr, pred_map) ||
+          ir_utils::isCpAsyncBulk(expr)) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
 } // namespace
 
 void UnrollPass::registerReplace(Expr* reference, Expr* new_expr) {
@@ -174,9 +246,13 @@ void UnrollPass::handle(ForLoop* fl) {
       fl->iter_domain()->getParallelType() == ParallelType::Unroll ||
       fl->iter_domain()->getParallelType() == ParallelType::Unswitch;
 
+  // Serial loop nest unswitched as a whole. See Note [Tile-level unswitch]
+  const bool is_tile =
+      !is_unroll && look_for_unroll_ && look_for_tile_ && isTileLoop(fl);
+
   // If we're not looking for an unroll loop, or didn't find one, process as
   // normal.
-  if (!is_unroll || !look_for_unroll_) {
+  if ((!is_unroll && !is_tile) || !look_for_unroll_) {
     for_loops_.push_back(fl);
     scope_.push_back(&fl->body());
     scope_exprs_.push_back(fl);
@@ -197,6 +273,16 @@ void UnrollPass::handle(ForLoop* fl) {
     return;
   }
 
+  if (is_tile) {
+    tile_loops_.push_back(fl);
+  }
+  const bool outer_look_for_tile = look_for_tile_;
+  look_for_tile_ = false;
+
+  // The inlined nest of a tile may have unswitched scopes, which reset the
+  // flag for their own inlined nests
+  const bool outer_non_trivial_pred_found = non_trivial_pred_found_;
+
   auto unroll_pred = IrBuilder::create<kir::Predicate>(fl);
 
   kir::IfThenElse* unroll_ite = IrBuilder::create<kir::IfThenElse>(unroll_pred);
@@ -220,13 +306,15 @@ void UnrollPass::handle(ForLoop* fl) {
   // Loop nest for inlined path
   ForLoop* inlined_loop = cloneLoopNest(fl);
 
-  // Add inline predicates for inlined loop nest
+  // Add inline predicates for inlined loop nest. The inlined nest of a tile
+  // keeps the unswitched scopes of its iterations.
   scope_.push_back(&unroll_ite->elseBody());
   scope_exprs_.push_back(unroll_ite);
-  look_for_unroll_ = false;
+  look_for_unroll_ = is_tile;
   non_trivial_pred_found_ = false;
   handle(inlined_loop);
   look_for_unroll_ = true;
+  look_for_tile_ = outer_look_for_tile;
   scope_.pop_back();
   scope_exprs_.pop_back();
   if (!non_trivial_pred_found_) {
@@ -237,6 +325,8 @@ void UnrollPass::handle(ForLoop* fl) {
     }
     kir::ExprMutator::registerReplace(fl, unroll_ite);
   }
+  non_trivial_pred_found_ =
+      non_trivial_pred_found_ || outer_non_trivial_pred_found;
 }
 
 bool UnrollPass::canOmitElseClause(ForLoop* fl) {
@@ -335,7 +425,8 @@ bool UnrollPass::canOmitElseClause(ForLoop* fl) {
   return true;
 }
 
-UnrollPass::UnrollPass(const std::vector<Expr*>& exprs) {
+UnrollPass::UnrollPass(const std::vector<Expr*>& exprs)
+    : look_for_tile_(isOptionEnabled(EnableOption::TileUnswitch)) {
   kir::ExprMutator::traverseAndInsert(exprs);
 }
 
@@ -343,6 +434,15 @@ std::vector<Expr*> UnrollPass::runPass(const std::vector<Expr*>& exprs) {
   FUSER_PERF_SCOPE("GpuLower::Lower::UnrollPass::runPass");
 
   UnrollPass unroll_pass(exprs);
+
+  if (isDebugDumpEnabled(DebugDumpOption::PredicateElimination) &&
+      !unroll_pass.tile_loops_.empty()) {
+    debug() << "Tile-level unswitched loops:";
+    for (auto fl : unroll_pass.tile_loops_) {
+      debug() << " " << fl->iter_domain()->toString();
+    }
+    debug() << std::endl;
+  }
   return unroll_pass.exprs_;
 }
 
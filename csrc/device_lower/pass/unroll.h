@@ -93,6 +93,14 @@ class UnrollPass : kir::ExprMutator {
   // As we generate inline predicates check if we actually generated a
   // non-trivial one.
   bool non_trivial_pred_found_ = false;
+
+  // Keep track if serial loop nests may be unswitched as a whole. See Note
+  // [Tile-level unswitch] in unroll.cpp
+  bool look_for_tile_ = false;
+
+  // Loops unswitched as a whole, reported with
+  // NVFUSER_DUMP=predicate_elimination
+  std::vector<ForLoop*> tile_loops_;
 };
 
 } // namespace nvfuser
@@ -87,6 +87,11 @@ class WelfordVectorizer : public kir::ExprMutator {
       return false;
     }
 
+    // The Fast and Compensated modes are generated by codegen
+    if (wop->mode() != WelfordMode::Default) {
+      return false;
+    }
+
     if (!GpuLower::current()->caMap()->areMapped(
             innermost_loop->iter_domain(),
             innermost_loop_id,
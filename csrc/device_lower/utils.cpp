@@ -16,6 +16,7 @@
 #include <iter_visitor.h>
 #include <kernel_ir_dispatch.h>
 #include <logical_domain_map.h>
+#include <options.h>
 #include <ops/arith.h>
 
 #include <expr_simplifier.h>
@@ -140,6 +141,8 @@ bool isTvOp(const Expr* expr) {
           IndexSelectOp,
           TorchGatherOp,
           ScatterOp,
+          ScanOp,
+          SortOp,
           RNGOp,
           FullOp,
           IotaOp,
@@ -164,6 +167,7 @@ bool isTvOp(const Expr* expr) {
           CatOp,
           kir::GridReduction,
           kir::GroupedGridReduction,
+          kir::GridScan,
           kir::GridBroadcast,
           kir::GridWelford,
           kir::GroupedGridWelford,
@@ -356,6 +360,60 @@ std::optional<IterDomain*> getMaybeWarpReductionDim(
   return std::nullopt;
 }
 
+std::optional<int64_t> getMaybeSubWarpReductionLanes(const Expr* expr) {
+  if (!isOptionEnabled(EnableOption::SubWarpReduce) ||
+      !expr->isOneOf<ReductionOp, GroupedReductionOp, WelfordOp>()) {
+    return std::nullopt;
+  }
+
+  // only support reducing to registers for now.
+  for (auto vals : {expr->inputs(), expr->outputs()}) {
+    for (auto val : vals) {
+      auto tv = getTv(val);
+      if (tv != nullptr && tv->getMemoryType() != MemoryType::Local) {
+        return std::nullopt;
+      }
+    }
+  }
+
+  IterDomain* reduction_on_xdim = nullptr;
+  for (auto id : getTvOutput(expr)->getLoopDomain()) {
+    // Iteration grouped reductions have their own runtime functions
+    if (id->getParallelType() == ParallelType::Group) {
+      return std::nullopt;
+    }
+    if (id->isReduction() && id->isThread()) {
+      if (id->getParallelType() != ParallelType::TIDx) {
+        return std::nullopt;
+      }
+      reduction_on_xdim = id;
+    }
+  }
+  if (reduction_on_xdim == nullptr ||
+      !reduction_on_xdim->start()->isZeroInt() ||
+      reduction_on_xdim->hasPaddingToMultipleOfWarp() ||
+      !reduction_on_xdim->extent()->isConstInt()) {
+    return std::nullopt;
+  }
+
+  const int64_t lanes =
+      reduction_on_xdim->extent()->evaluate().as<int64_t>();
+  if (lanes < 2 || lanes > at::cuda::warp_size() || (lanes & (lanes - 1))) {
+    return std::nullopt;
+  }
+
+  // Each reduction segment must be a group of consecutive lanes, which
+  //  holds when blockDim.x is the reduction size
+  Val* tidx_dim =
+      GpuLower::current()->parallelDimensionMap().get(ParallelType::TIDx);
+  if (tidx_dim == nullptr || !tidx_dim->isConstInt() ||
+      tidx_dim->evaluate().as<int64_t>() != lanes) {
+    return std::nullopt;
+  }
+
+  return lanes;
+}
+
 std::unordered_map<ParallelType, IterDomain*> getParallelDomains(
     const Val* val) {
   const TensorView* tv = nullptr;
@@ -551,6 +609,11 @@ class ReplaceExprInput : private kir::ExprMutator {
           node->out(),
           replaced_inputs->at(node->in()),
           node->isAllreduce());
+      replacement->requestClusterReduction(node->clusterReductionRequested());
+      replacement->requestSmemAtomicBlockReduction(
+          node->smemAtomicBlockReductionRequested());
+      replacement->requestAtomicGridReduction(
+          node->atomicGridReductionRequested());
       registerReplaceWithPredicate(node, replacement);
     }
   }
@@ -598,7 +661,9 @@ class ReplaceExprInput : private kir::ExprMutator {
           node->initN(),
           replaced_inputs->at(node->inAvg()),
           replaced_inputs->at(node->inVar()),
-          replaced_inputs->at(node->inN()));
+          replaced_inputs->at(node->inN()),
+          node->isAllreduce(),
+          node->mode());
       registerReplaceWithPredicate(node, replacement);
     }
   }
@@ -676,6 +741,19 @@ bool hasBlockSync(const Expr* expr, const ThreadPredicateMap& pred_map) {
     return false;
   }
 
+  // Scans parallelized by threads are block or grid scans
+  if (auto sop = dynamic_cast<const ScanOp*>(expr)) {
+    auto scan_ids = getScanLoopIds(sop);
+    return std::any_of(scan_ids.begin(), scan_ids.end(), [](IterDomain* id) {
+      return id->isThread();
+    });
+  }
+
+  // Sorts are always block sorts
+  if (expr->isA<SortOp>()) {
+    return true;
+  }
+
   if (!(ir_utils::isReductionOp(expr) || expr->isA<BroadcastOp>() ||
         expr->isA<kir::GridBroadcast>())) {
     return false;
@@ -696,6 +774,34 @@ bool hasBlockSync(const Expr* expr, const ThreadPredicateMap& pred_map) {
   return false;
 }
 
+namespace {
+
+// The loop IDs of the (first) output of `expr` derived from `id`
+std::vector<IterDomain*> getLoopIdsOf(const Expr* expr, IterDomain* id) {
+  auto tv = ir_utils::getTvOutput(expr);
+  const auto& loop_domain = tv->getLoopDomain();
+  auto dep_vals = DependencyCheck::getAllValsBetween(
+      {id}, {loop_domain.begin(), loop_domain.end()});
+  std::unordered_set<Val*> dep_set(dep_vals.begin(), dep_vals.end());
+  std::vector<IterDomain*> loop_ids;
+  std::copy_if(
+      loop_domain.begin(),
+      loop_domain.end(),
+      std::back_inserter(loop_ids),
+      [&](IterDomain* loop_id) { return dep_set.count(loop_id); });
+  return loop_ids;
+}
+
+} // namespace
+
+std::vector<IterDomain*> getScanLoopIds(const ScanOp* sop) {
+  return getLoopIdsOf(sop, sop->getScanID());
+}
+
+std::vector<IterDomain*> getSortLoopIds(const SortOp* sop) {
+  return getLoopIdsOf(sop, sop->getSortID());
+}
+
 kir::Allocate* allocGlobalBufferForGridComm(
     Val* buffer_size,
     DataType dtype,
@@ -109,6 +109,13 @@ std::optional<IterDomain*> getMaybeWarpReductionDim(
     const Val* output,
     const Val* input);
 
+//! Returns the number of lanes of each shuffle reduction segment when a block
+//!  ReductionOp, GroupedReductionOp or WelfordOp only reduces a TIDx domain
+//!  of a constant power-of-two extent of at most a warp that is also the
+//!  block size in x. Returns nullopt otherwise, and when sub_warp_reduce is
+//!  not enabled.
+std::optional<int64_t> getMaybeSubWarpReductionLanes(const Expr* expr);
+
 bool isScalarOp(const Expr*);
 
 bool isIterDomainOp(const Expr*);
@@ -254,6 +261,13 @@ namespace lower_utils {
 
 bool hasBlockSync(const Expr* expr, const ThreadPredicateMap& pred_map);
 
+//! Returns the loop IDs of the output of a ScanOp that are derived from the
+//! scanned ID, in the order of the loop domain
+std::vector<IterDomain*> getScanLoopIds(const ScanOp* sop);
+
+//! Same for the sorted ID of a SortOp
+std::vector<IterDomain*> getSortLoopIds(const SortOp* sop);
+
 // Allocate global buffer for a grid communication calls, i.e. grid reduce, grid
 // welford reduce, grid broadcast.
 kir::Allocate* allocGlobalBufferForGridComm(
@@ -605,10 +605,22 @@ void validateAndCollectVectorizeInfo(Fusion* fusion) {
       Expr* def = tv->definition();
       NVF_ERROR(
           def == nullptr || def->isA<LoadStoreOp>() || def->isA<SliceOp>() ||
+              def->isA<IndexSelectOp>() ||
               (def->isA<ReductionOp>() &&
                def->as<ReductionOp>()->serialGridReductionRequested()),
           "Vectorized accesses cannot be inline with computation: ",
           (def == nullptr ? tv->toString() : def->toString()));
+      // An index_select gathers whole vectors of the lookup tensor, so the
+      // indirectly accessed dimension can't be the vectorized one
+      if (auto index_select = dynamic_cast<IndexSelectOp*>(def)) {
+        auto lookup_alloc = TensorDomain::noReductions(
+            index_select->lookupTv()->getMaybeAllocationDomain());
+        NVF_ERROR(
+            lookup_alloc.back() != index_select->getIndexedID(),
+            "Cannot vectorize an index_select along the innermost dimension "
+            "of the lookup tensor: ",
+            def->toString());
+      }
     }
     // Validate the vectorized domain maps to the innermost domain of
     // tv. Note that we don't need to validate its producer tv as
@@ -9,10 +9,15 @@
 
 #include <exceptions.h>
 
+#include <c10/util/irange.h>
+
 #include <algorithm>
+#include <cstdint>
 #include <initializer_list>
+#include <memory>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 // For printing of the set when using a Statement as the type for the set
@@ -281,6 +286,9 @@ class VectorOfUniqueEntries {
   std::unordered_set<T, Hash> set_;
 };
 
+template <typename T, typename Hash>
+class UnionFind;
+
 //! Container class DisjointSet models equivalence relationships
 //!
 //! Each instance of this class keeps equivalence sets
@@ -492,6 +500,8 @@ class DisjointSets {
   }
 
  private:
+  friend class UnionFind<T, Hash>;
+
   // Disjoint sets
   DisjointSetMap disjoint_set_maps_;
 
@@ -537,4 +547,112 @@ DisjointSets<T, Hash>& DisjointSets<T, Hash>::operator=(
   return *this;
 }
 
+//! Builds DisjointSets with many mapEntries calls and no query in between.
+//! DisjointSets::mapEntries copies the two sets it merges into a new one,
+//! which makes building large sets quadratic. UnionFind tracks the sets as a
+//! forest of indices instead, merged by rank with path compression, and only
+//! materializes them in toDisjointSets. The materialized sets are ordered by
+//! their first element, and their elements by the order they were added.
+template <typename T, typename Hash = std::hash<T>>
+class UnionFind {
+ public:
+  UnionFind() = default;
+
+  //! Starts from the sets of `sets`, keeping their order
+  explicit UnionFind(const DisjointSets<T, Hash>& sets) {
+    for (const auto& set : sets.disjointSets()) {
+      int64_t first = -1;
+      for (const auto& entry : *set) {
+        const int64_t index = initializeSet(entry);
+        if (first == -1) {
+          first = index;
+        } else {
+          merge(first, index);
+        }
+      }
+    }
+  }
+
+  //! Adds a singleton set for `entry` if it is not in any set yet, and returns
+  //! the index of `entry`
+  int64_t initializeSet(T entry) {
+    auto [it, inserted] =
+        indices_.emplace(entry, static_cast<int64_t>(entries_.size()));
+    if (inserted) {
+      entries_.push_back(entry);
+      parents_.push_back(it->second);
+      ranks_.push_back(0);
+    }
+    return it->second;
+  }
+
+  //! Same as DisjointSets::mapEntries
+  void mapEntries(T entry0, T entry1) {
+    const int64_t index0 = initializeSet(entry0);
+    const int64_t index1 = initializeSet(entry1);
+    merge(index0, index1);
+  }
+
+  //! Returns false if either entry isn't in any set
+  bool permissiveAreMapped(T entry0, T entry1) {
+    auto it0 = indices_.find(entry0);
+    auto it1 = indices_.find(entry1);
+    if (it0 == indices_.end() || it1 == indices_.end()) {
+      return false;
+    }
+    return root(it0->second) == root(it1->second);
+  }
+
+  int64_t size() const {
+    return static_cast<int64_t>(entries_.size());
+  }
+
+  DisjointSets<T, Hash> toDisjointSets() {
+    DisjointSets<T, Hash> sets;
+    std::vector<int64_t> set_of_root(entries_.size(), -1);
+    for (auto i : c10::irange(size())) {
+      const int64_t r = root(i);
+      if (set_of_root[r] == -1) {
+        set_of_root[r] = static_cast<int64_t>(sets.disjoint_sets_.size());
+        sets.disjoint_sets_.push_back(
+            std::make_shared<VectorOfUniqueEntries<T, Hash>>());
+      }
+      const auto& set = sets.disjoint_sets_[set_of_root[r]];
+      set->pushBack(entries_[i]);
+      sets.disjoint_set_maps_.emplace(entries_[i], set);
+    }
+    return sets;
+  }
+
+ private:
+  int64_t root(int64_t index) {
+    while (parents_[index] != index) {
+      // Path halving
+      parents_[index] = parents_[parents_[index]];
+      index = parents_[index];
+    }
+    return index;
+  }
+
+  void merge(int64_t index0, int64_t index1) {
+    int64_t root0 = root(index0);
+    int64_t root1 = root(index1);
+    if (root0 == root1) {
+      return;
+    }
+    if (ranks_[root0] < ranks_[root1]) {
+      std::swap(root0, root1);
+    }
+    parents_[root1] = root0;
+    if (ranks_[root0] == ranks_[root1]) {
+      ranks_[root0]++;
+    }
+  }
+
+  std::unordered_map<T, int64_t, Hash> indices_;
+  std::vector<T> entries_;
+  std::vector<int64_t> parents_;
+  std::vector<int64_t> ranks_;
+};
+
 } // namespace nvfuser
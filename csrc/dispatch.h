@@ -86,6 +86,8 @@ class Val;
   f(IndexSelectOp);               \
   f(TorchGatherOp);               \
   f(ScatterOp);                   \
+  f(ScanOp);                      \
+  f(SortOp);                      \
   f(RNGOp);                       \
   f(ReductionOp);                 \
   f(GroupedReductionOp);          \
@@ -129,6 +131,7 @@ class Val;
   f(IfThenElse);                      \
   f(GridReduction);                   \
   f(GroupedGridReduction);            \
+  f(GridScan);                        \
   f(GridBroadcast);                   \
   f(GridWelford);                     \
   f(GroupedGridWelford);              \
@@ -142,6 +145,11 @@ class Val;
   f(HostUnit);                        \
   f(PostOnStream);                    \
   f(SetCurrentStream);                \
+  f(Synchronize);                     \
+  f(ShareWithPeers);                  \
+  f(ReleasePeers);                    \
+  f(OffloadToHost);                   \
+  f(PrefetchToDevice);                \
   f(Wait);
 
 // Forward declarations for all Val and Expr types
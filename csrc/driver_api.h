@@ -35,9 +35,18 @@ namespace nvfuser {
   fn(cuOccupancyMaxActiveBlocksPerMultiprocessor)
 
 #if (CUDA_VERSION >= 12000)
-#define ALL_DRIVER_API_WRAPPER(fn)   \
-  ALL_DRIVER_API_WRAPPER_CUDA11(fn); \
-  fn(cuTensorMapEncodeTiled)
+// cuda.h maps the graph kernel node and stream memory operation APIs to their
+// _v2 versions starting from CUDA 12, so the versioned names are listed here
+// to load the right symbols.
+#define ALL_DRIVER_API_WRAPPER(fn)         \
+  ALL_DRIVER_API_WRAPPER_CUDA11(fn);       \
+  fn(cuGraphExecKernelNodeSetParams_v2);   \
+  fn(cuGraphKernelNodeGetParams_v2);       \
+  fn(cuLaunchKernelEx);                    \
+  fn(cuStreamWaitValue32_v2);              \
+  fn(cuStreamWriteValue32_v2);             \
+  fn(cuTensorMapEncodeTiled);              \
+  fn(cuTensorMapReplaceAddress)
 #else
 #define ALL_DRIVER_API_WRAPPER ALL_DRIVER_API_WRAPPER_CUDA11
 #endif
@@ -45,6 +45,10 @@ DynamicTransformInitialInfo DynamicTransformInitialInfo::clone(
   for (const auto v : dynamic_factory_tvs_) {
     cloned_info.dynamic_factory_tvs_.push_back(ir_cloner.clone(v));
   }
+  cloned_info.dynamic_where_tvs_.reserve(dynamic_where_tvs_.size());
+  for (const auto tv : dynamic_where_tvs_) {
+    cloned_info.dynamic_where_tvs_.push_back(ir_cloner.clone(tv));
+  }
   cloned_info.maybe_zero_extents_set_.reserve(maybe_zero_extents_set_.size());
   for (const auto v : maybe_zero_extents_set_) {
     cloned_info.maybe_zero_extents_set_.insert(ir_cloner.clone(v));
@@ -79,6 +83,10 @@ std::string DynamicTransformInitialInfo::toString() const {
   for (const auto& tv : dynamic_factory_tvs_) {
     indent(ss, 2) << tv->toString() << "\n";
   }
+  indent(ss, 1) << "Dynamic where output TensorViews:\n";
+  for (const auto& tv : dynamic_where_tvs_) {
+    indent(ss, 2) << tv->toString() << "\n";
+  }
   indent(ss, 1) << "Dynamic extent Vals:\n";
   for (const auto& v : maybe_zero_extents_) {
     indent(ss, 2) << v->toInlineString() << "\n";
@@ -189,6 +197,31 @@ class DynamicTransformInitialInfoBuilder : public IterVisitor {
     }
   }
 
+  //! Find where ops selecting between tensors with a scalar predicate that is
+  //! computed from input scalars and extents, e.g. where(i0 > 1, t0, t1).
+  //! Such a predicate is uniform over the whole output, so concretization can
+  //! replace the op by the branch it selects.
+  void handle(TernaryOp* op) override {
+    if (op->getTernaryOpType() != TernaryOpType::Where ||
+        !op->out()->isA<TensorView>()) {
+      return;
+    }
+    Val* pred = op->in1();
+    if (pred->isA<TensorView>() || pred->isConstScalar()) {
+      return;
+    }
+    // Scalars like metadata are computed from tensors and can't be evaluated
+    // from the input sizes alone
+    const std::vector<Val*> pred_inputs = InputsOf::output(pred);
+    if (std::any_of(pred_inputs.begin(), pred_inputs.end(), [](Val* inp) {
+          return inp->isA<TensorView>();
+        })) {
+      return;
+    }
+    info_.dynamic_where_tvs_.push_back(op->out()->as<TensorView>());
+    loop_dynamic_vals_.push_back(pred);
+  }
+
   //! Detect possibly empty TensorViews and dynamic IterDomain transforms
   void handle(TensorView* tv) override {
     const auto& logical_dom = tv->getLogicalDomain();
@@ -273,6 +306,8 @@ DynamicTransformConcretizationInfo::DynamicTransformConcretizationInfo(
 
   analyzeFactoryOutputs(expr_eval);
 
+  analyzeWherePredicates(expr_eval);
+
   auto maybe_zero_extents = initial_info_->getMaybeZeroExtents();
   for (auto i : c10::irange((int64_t)maybe_zero_extents.size())) {
     auto ext = maybe_zero_extents.at(i);
@@ -501,6 +536,26 @@ void DynamicTransformConcretizationInfo::analyzeFactoryOutputs(
   }
 }
 
+void DynamicTransformConcretizationInfo::analyzeWherePredicates(
+    ExpressionEvaluator* expr_eval) {
+  const std::vector<TensorView*>& where_tvs =
+      initial_info_->getDynamicWhereOutputs();
+  where_predicate_values_.reserve(where_tvs.size());
+  for (TensorView* tv : where_tvs) {
+    Val* pred = tv->definition()->as<TernaryOp>()->in1();
+    PolymorphicValue pred_value = expr_eval->evaluate(pred);
+    NVF_CHECK(
+        pred_value.hasValue(),
+        "Could not evaluate dynamic where predicate ",
+        pred->toInlineString());
+    NVF_ERROR(
+        pred_value.is<bool>(),
+        "Expected boolean evaluated predicate but found ",
+        pred_value);
+    where_predicate_values_.push_back(pred_value.as<bool>());
+  }
+}
+
 bool DynamicTransformConcretizationInfo::operator==(
     const DynamicTransformConcretizationInfo& other) const {
   if (this == &other) {
@@ -535,6 +590,10 @@ bool DynamicTransformConcretizationInfo::operator==(
     return false;
   }
 
+  if (where_predicate_values_ != other.where_predicate_values_) {
+    return false;
+  }
+
   for (const auto i : c10::irange((int64_t)expand_axes_.size())) {
     const auto& expand_axes = expand_axes_.at(i);
     const auto& other_expand_axes = other.expand_axes_.at(i);
@@ -616,6 +675,16 @@ std::string DynamicTransformConcretizationInfo::toString() const {
                     << iter_type << std::endl;
     }
   }
+  indent(ss, 1) << "Where predicates:\n";
+  NVF_ERROR(
+      where_predicate_values_.size() ==
+      initial_info_->getDynamicWhereOutputs().size());
+  for (int64_t i : c10::irange((int64_t)where_predicate_values_.size())) {
+    TensorView* tv = initial_info_->getDynamicWhereOutputs().at(i);
+    indent(ss, 2) << tv->toString() << " (index=" << i << "), "
+                  << (where_predicate_values_.at(i) ? "true" : "false")
+                  << std::endl;
+  }
   return ss.str();
 }
 
@@ -665,6 +734,8 @@ class DynamicTransformConcretizer : public OptOutMutator {
 
   void concretizeFactoryOutputs();
 
+  void concretizeWherePredicates();
+
   //! Use this instead of calling registerMutation directly, since it will also
   //! check that the concretized value is a valid input to all of its uses.
   void registerConcretization(Val* old_val, Val* new_val) {
@@ -711,6 +782,9 @@ void DynamicTransformConcretizer::concretize() {
   // Concretize all dynamic reshape ops
   concretizeReshape();
 
+  // Replace where ops with uniform predicates by the selected branch
+  concretizeWherePredicates();
+
   // Set output IterTypes for dynamic resize ops
   concretizeResize();
 
@@ -1020,6 +1094,57 @@ void DynamicTransformConcretizer::concretizeFactoryOutputs() {
   }
 }
 
+void DynamicTransformConcretizer::concretizeWherePredicates() {
+  const std::vector<TensorView*>& where_tvs =
+      info_->initialInfo()->getDynamicWhereOutputs();
+  const std::vector<bool>& pred_values = info_->getWherePredicateValues();
+  NVF_ERROR(where_tvs.size() == pred_values.size());
+  for (const int64_t i : c10::irange((int64_t)where_tvs.size())) {
+    TensorView* out_tv = where_tvs[i];
+    auto top = out_tv->definition()->as<TernaryOp>();
+    Val* selected = pred_values[i] ? top->in2() : top->in3();
+
+    // The selected branch can replace the output only when it is a tensor
+    // that needs neither a cast nor a broadcast to produce it. Otherwise, we
+    // only replace the predicate with a constant.
+    auto selected_tv = dynamic_cast<TensorView*>(selected);
+    bool is_replaceable =
+        selected_tv != nullptr && selected_tv->dtype() == out_tv->dtype();
+    if (is_replaceable) {
+      const std::vector<IterDomain*> selected_logical =
+          TensorDomain::noReductions(selected_tv->getLogicalDomain());
+      const std::vector<IterDomain*>& out_logical = out_tv->getLogicalDomain();
+      is_replaceable = selected_logical.size() == out_logical.size() &&
+          std::equal(
+              selected_logical.begin(),
+              selected_logical.end(),
+              out_logical.begin(),
+              [](IterDomain* selected_id, IterDomain* out_id) {
+                return selected_id->getIterType() == out_id->getIterType() &&
+                    selected_id->hasExpandedExtent() ==
+                    out_id->hasExpandedExtent();
+              });
+    }
+
+    if (!is_replaceable) {
+      Val* pred_value = pred_values[i] ? info_->fusion()->trueVal()
+                                       : info_->fusion()->falseVal();
+      ir_utils::replaceValInExprInputs(top, top->in1(), pred_value);
+      continue;
+    }
+
+    // As for trivial expands, we use a set() so that the selected branch is
+    // never aliased by a fusion output. The other branch is left without uses
+    // and is not computed anymore unless something else consumes it.
+    TensorView* concretized_tv = set(selected_tv);
+
+    symbolic_to_concretized_map_.emplace(out_tv, concretized_tv);
+
+    ir_utils::replaceValInAllExprInputsAndFusionOutputs(
+        out_tv, concretized_tv);
+  }
+}
+
 void DynamicTransformConcretizer::checkConcretizedUses(
     Val* old_val,
     Val* new_val) const {
@@ -1511,6 +1636,9 @@ size_t DynamicTransformConcretizationInfo::hash() const {
       hashCombine(hash, (size_t)e);
     }
   }
+  for (bool pred_value : getWherePredicateValues()) {
+    hashCombine(hash, (size_t)pred_value);
+  }
   return hash;
 }
 
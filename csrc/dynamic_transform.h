@@ -42,7 +42,7 @@ class DynamicTransformInitialInfo {
   //! the structure of the Fusion.
   bool isDynamic() const {
     return hasPossibleEmptyTensor() || !dynamic_reshaped_tvs_.empty() ||
-        !dynamic_resized_ids_.empty();
+        !dynamic_resized_ids_.empty() || !dynamic_where_tvs_.empty();
   }
 
   //! Return whether there are any tensors with unknown extent in some
@@ -89,6 +89,12 @@ class DynamicTransformInitialInfo {
     return dynamic_factory_tvs_;
   }
 
+  //! Return a vector of outputs of where expressions whose predicate is a
+  //! non-constant scalar computed from input scalars and extents
+  const std::vector<TensorView*>& getDynamicWhereOutputs() const {
+    return dynamic_where_tvs_;
+  }
+
   std::string toString() const;
 
   DynamicTransformInitialInfo clone(IrCloner& ir_cloner) const;
@@ -124,6 +130,8 @@ class DynamicTransformInitialInfo {
 
   std::vector<TensorView*> dynamic_factory_tvs_;
 
+  std::vector<TensorView*> dynamic_where_tvs_;
+
   // This is a minimal set of scalars to check for empty tensors. If any are
   // zero, we should traverse to find empty tensors.
   std::unordered_set<Val*> maybe_zero_extents_set_;
@@ -196,6 +204,12 @@ class DynamicTransformConcretizationInfo {
     return factory_output_itertypes_;
   }
 
+  //! Return a vector holding the value of the predicate of each where
+  //! expression returned by initialInfo()->getDynamicWhereOutputs().
+  const std::vector<bool>& getWherePredicateValues() const {
+    return where_predicate_values_;
+  }
+
   //! Comparison operator for the purposes of determining cache hits. This does
   //! not guarantee equality of all members. Instead, it returns equal if the
   //! resulting concretizations would be structurally equivalent. Note that
@@ -225,6 +239,10 @@ class DynamicTransformConcretizationInfo {
   //! determine the IterTypes of factory function outputs.
   void analyzeFactoryOutputs(ExpressionEvaluator* expr_eval);
 
+  //! Given an ExpressionEvaluator which already has input scalars bound to it,
+  //! evaluate the predicates of dynamic where expressions.
+  void analyzeWherePredicates(ExpressionEvaluator* expr_eval);
+
   const DynamicTransformInitialInfo* initialInfo() const {
     return initial_info_;
   }
@@ -274,6 +292,10 @@ class DynamicTransformConcretizationInfo {
   std::vector<std::vector<std::pair<int64_t, IterType>>>
       factory_output_itertypes_;
 
+  //! Holds the value of the predicate of each where expression whose output is
+  //! returned by initial_info_->getDynamicWhereOutputs().
+  std::vector<bool> where_predicate_values_;
+
   friend class DynamicTransformInfoBuilder;
 };
 
@@ -15,6 +15,7 @@
 #include <ir/utils.h>
 #include <tensor_metadata.h>
 
+#include <algorithm>
 #include <optional>
 
 namespace nvfuser {
@@ -394,6 +395,97 @@ void PrecomputedValues::bindTensorMetaData(
   bindValue(metadata_val->evaluatorIndex(), metadata);
 }
 
+namespace {
+
+// Returns whether the operands and outputs of `expr` are integer or boolean
+// scalars. See NaiveValueMachine::int64_lane_
+bool isInt64Lane(Expr* expr) {
+  auto is_int64_like = [](Val* val) {
+    std::optional<DataType> dtype = val->getDataType();
+    return dtype.has_value() &&
+        (isIntegralType(dtype.value()) || dtype.value() == DataType::Bool);
+  };
+  const std::vector<Val*>& inputs = expr->inputs();
+  const std::vector<Val*>& outputs = expr->outputs();
+  return std::all_of(inputs.begin(), inputs.end(), is_int64_like) &&
+      std::all_of(outputs.begin(), outputs.end(), is_int64_like);
+}
+
+// Computes `op` on int64_t operands without going through the arithmetic of
+// PolymorphicValue, with the same semantics. Returns false if `op` has no
+// such fast path.
+bool runInt64UnaryOp(UnaryOpType op, int64_t src, PolymorphicValue& dest) {
+  switch (op) {
+    case UnaryOpType::Neg:
+      dest = PolymorphicValue(-src);
+      return true;
+    case UnaryOpType::Abs:
+      dest = PolymorphicValue(std::abs(src));
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool runInt64BinaryOp(
+    BinaryOpType op,
+    int64_t lhs,
+    int64_t rhs,
+    PolymorphicValue& dest) {
+  switch (op) {
+    case BinaryOpType::Add:
+      dest = PolymorphicValue(lhs + rhs);
+      return true;
+    case BinaryOpType::Sub:
+      dest = PolymorphicValue(lhs - rhs);
+      return true;
+    case BinaryOpType::Mul:
+      dest = PolymorphicValue(lhs * rhs);
+      return true;
+    case BinaryOpType::Div:
+      NVF_CHECK(rhs != 0);
+      dest = PolymorphicValue(lhs / rhs);
+      return true;
+    case BinaryOpType::Mod:
+      NVF_CHECK(rhs != 0);
+      dest = PolymorphicValue(lhs % rhs);
+      return true;
+    case BinaryOpType::CeilDiv:
+      NVF_CHECK(rhs != 0);
+      dest = PolymorphicValue(
+          rhs > 0 ? (lhs + rhs - 1) / rhs : (lhs + rhs + 1) / rhs);
+      return true;
+    case BinaryOpType::Max:
+      dest = PolymorphicValue(std::max(lhs, rhs));
+      return true;
+    case BinaryOpType::Min:
+      dest = PolymorphicValue(std::min(lhs, rhs));
+      return true;
+    case BinaryOpType::LT:
+      dest = PolymorphicValue(lhs < rhs);
+      return true;
+    case BinaryOpType::LE:
+      dest = PolymorphicValue(lhs <= rhs);
+      return true;
+    case BinaryOpType::Eq:
+      dest = PolymorphicValue(lhs == rhs);
+      return true;
+    case BinaryOpType::NE:
+      dest = PolymorphicValue(lhs != rhs);
+      return true;
+    case BinaryOpType::GE:
+      dest = PolymorphicValue(lhs >= rhs);
+      return true;
+    case BinaryOpType::GT:
+      dest = PolymorphicValue(lhs > rhs);
+      return true;
+    default:
+      return false;
+  }
+}
+
+} // namespace
+
 NaiveValueMachine::NaiveValueMachine(PrecomputedValues& precomputed_values)
     : precomputed_values_(precomputed_values), num_of_instructions_{0} {
   for (auto val : precomputed_values_.symbols_) {
@@ -432,14 +524,25 @@ void NaiveValueMachine::copyFrom(const NaiveValueMachine& other) {
   bop_type_.insert(
       bop_type_.end(), other.bop_type_.begin(), other.bop_type_.end());
 
+  top_type_.clear();
+  top_type_.insert(
+      top_type_.end(), other.top_type_.begin(), other.top_type_.end());
+
   src0_.clear();
   src0_.insert(src0_.end(), other.src0_.begin(), other.src0_.end());
 
   src1_.clear();
   src1_.insert(src1_.end(), other.src1_.begin(), other.src1_.end());
 
+  src2_.clear();
+  src2_.insert(src2_.end(), other.src2_.begin(), other.src2_.end());
+
   dest_.clear();
   dest_.insert(dest_.end(), other.dest_.begin(), other.dest_.end());
+
+  int64_lane_.clear();
+  int64_lane_.insert(
+      int64_lane_.end(), other.int64_lane_.begin(), other.int64_lane_.end());
 }
 
 void NaiveValueMachine::run() {
@@ -468,6 +571,7 @@ void NaiveValueMachine::makeUnaryOp(UnaryOp* uop) {
   }
   src0_[index] = in;
   dest_[index] = out;
+  int64_lane_[index] = isInt64Lane(uop);
 }
 
 void NaiveValueMachine::makeBinaryOp(BinaryOp* bop) {
@@ -485,6 +589,7 @@ void NaiveValueMachine::makeBinaryOp(BinaryOp* bop) {
   src0_[index] = in0;
   src1_[index] = in1;
   dest_[index] = out;
+  int64_lane_[index] = isInt64Lane(bop);
 }
 
 void NaiveValueMachine::makeTernaryOp(TernaryOp* top) {
@@ -518,6 +623,7 @@ int NaiveValueMachine::makeInstructionEntry() {
   src1_.emplace_back(-1);
   src2_.emplace_back(-1);
   dest_.emplace_back(-1);
+  int64_lane_.emplace_back(false);
   return index;
 }
 
@@ -553,6 +659,12 @@ void NaiveValueMachine::runUnaryOp(int index) {
   auto& src = precomputed_values_.values_[src_index];
   auto& dest = precomputed_values_.values_[dest_index];
 
+  if (int64_lane_[index] && src.is<int64_t>() &&
+      runInt64UnaryOp(uop_type_[index], src.as<int64_t>(), dest)) {
+    precomputed_values_.defined_[dest_index] = true;
+    return;
+  }
+
   switch (uop_type_[index]) {
     case UnaryOpType::Neg:
       dest = -src;
@@ -611,6 +723,13 @@ void NaiveValueMachine::runBinaryOp(int index) {
   auto& rhs = precomputed_values_.values_[src1_index];
   auto& dest = precomputed_values_.values_[dest_index];
 
+  if (int64_lane_[index] && lhs.is<int64_t>() && rhs.is<int64_t>() &&
+      runInt64BinaryOp(
+          bop_type_[index], lhs.as<int64_t>(), rhs.as<int64_t>(), dest)) {
+    precomputed_values_.defined_[dest_index] = true;
+    return;
+  }
+
   switch (bop_type_[index]) {
     case BinaryOpType::Add:
       dest = lhs + rhs;
@@ -129,6 +129,12 @@ class NaiveValueMachine {
 
   //! Destination of each instruction.
   std::vector<int> dest_;
+
+  //! Whether the operands and the destination of each instruction are
+  //!  integer or boolean scalars, so that the instruction can be computed
+  //!  directly on int64_t when the operands hold int64_t at runtime. Most
+  //!  instructions, e.g., extents and launch parameters, take this lane.
+  std::vector<bool> int64_lane_;
 };
 
 //! PrecomputedValues:
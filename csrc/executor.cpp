@@ -27,6 +27,7 @@
 #include <multidevice/utils.h>
 #include <options.h>
 #include <polymorphic_value.h>
+#include <scheduler/utils.h>
 #include <serde/utils.h>
 #include <tensor_metadata.h>
 #include <utils.h>
@@ -36,13 +37,18 @@
 #include <ATen/cuda/llvm_jit_strings.h>
 #include <ATen/native/cuda/jit_utils.h>
 #include <c10/core/DeviceGuard.h>
+#include <c10/cuda/CUDAGuard.h>
 #include <c10/cuda/CUDAFunctions.h>
 #include <c10/cuda/CUDAStream.h>
 #include <c10/util/irange.h>
 
+#include <bit>
+#include <chrono>
 #include <cmath>
 #include <cstring>
 #include <fstream>
+#include <mutex>
+#include <optional>
 
 namespace nvfuser {
 
@@ -165,9 +171,17 @@ std::string FusionExecutor::getStructuredCode(
   // generating cuda code;
   std::string code = "";
   code += includeStdComplex();
+  // See [ Note -- Lean preamble ] in executor_utils.cpp
+  const bool lean = isOptionEnabled(EnableOption::LeanPreamble) &&
+      executor_utils::fitsLeanPreamble(kernel_str);
+  // See [ Note -- Outlined runtime functions ] in executor_utils.cpp
+  const char* define_outlinable =
+      executor_utils::outlineRuntimeFunctions(kernel_str)
+      ? "#define NVFUSER_OUTLINABLE __noinline__\n"
+      : "";
   code += std::string("namespace {\n") + defineTypes() +
-      defineIndexType(index_type) + executor_utils::kernelPreamble() +
-      kernel_str + "}\n";
+      defineIndexType(index_type) + define_outlinable +
+      executor_utils::kernelPreamble(lean) + kernel_str + "}\n";
 
   if (isDebugDumpEnabled(DebugDumpOption::CudaKernel)) {
     debug() << "\n======= Codegen output for kernel: " << kernelName()
@@ -215,6 +229,7 @@ void FusionExecutor::compileFusion(
 
   if (isExpressionEvaluated(fusion)) {
     fusion_ = std::make_unique<Fusion>(*fusion);
+    matmul_epilogue_ = matchMatmulEpilogue(fusion_.get());
     return;
   }
 
@@ -294,7 +309,8 @@ void FusionExecutor::compileFusion(
   // Set the index type of compile params if not already set. If set,
   // make sure the compile param type is valid with the given kernel
   // arguments.
-  auto arg_index_type = args.getSmallestIndexTypeOfArguments();
+  auto arg_index_type =
+      args.getSmallestIndexTypeOfArguments(fusion->inputs());
   if (compile_params.index_type.has_value()) {
     // If the int32 compilation is requested, but the arguments demand
     // int64, that's an error
@@ -339,6 +355,9 @@ void FusionExecutor::compileFusion(
     hook(lowered_.get());
   }
   lowered_->run();
+  if (isProfilerEnabled()) {
+    FusionProfiler::segment(group_id).loweringPasses(lowered_->passProfiles());
+  }
 
   kir::Kernel* kernel = lowered_->kernel();
 
@@ -374,6 +393,7 @@ void FusionExecutor::compileFusion(
   }
 
   kernel_code_ = codegen::generateCudaKernel(kernel, kernelName());
+  programmatic_launch_ = kernel->summary().programmatic_launch;
 
   // If NVFUSER_EXTERNAL_SRC is set, utilize the external source code.
   // If the loaded external source code is empty, revert to the default codegen.
@@ -386,6 +406,8 @@ void FusionExecutor::compileFusion(
       getStructuredCodeFromExternalFiles(getGlobalFusionCount());
   if (structured_code.empty()) {
     structured_code = getStructuredCode();
+  } else {
+    programmatic_launch_ = false;
   }
 
   const kir::KernelSummary& kernel_summary = kernel->summary();
@@ -449,6 +471,28 @@ void FusionExecutor::compileFusion(
     NVF_ERROR(block_size > 0, "launch param inferred block size < 0");
   }
 
+  // See [ Note -- Register pressure ] in register_pressure.cpp
+  const int64_t estimated_registers =
+      kernel_summary.estimated_registers_per_thread;
+  const auto max_registers =
+      executor_utils::getMaxRegCount(block_size, compile_params.maxrregcount);
+  if (max_registers.has_value() && estimated_registers > *max_registers) {
+    if (isOptionEnabled(EnableOption::WarnRegisterSpill)) {
+      debug() << "WARNING: " << kernelName() << " is estimated to need "
+              << estimated_registers << " registers per thread but is "
+              << "limited to " << *max_registers << std::endl;
+    }
+    if (isOptionEnabled(EnableOption::RegisterPressure)) {
+      // Lower the occupancy rather than spill, as far as one block of
+      // block_size threads still fits on an SM
+      compile_params.maxrregcount = std::min(
+          roundUpToMultiple(estimated_registers, 8),
+          executor_utils::getMaxRegCount(
+              block_size, scheduler_utils::max_registers_per_thread)
+              .value_or(scheduler_utils::max_registers_per_thread));
+    }
+  }
+
   // TODO: high water mark should be computed via occupancy API after
   // compilation.
 
@@ -459,13 +503,43 @@ void FusionExecutor::compileFusion(
       (block_size.has_value() ? block_size.value() : 1),
       block_size_high_water_mark_);
   maxrregcount_high_water_mark_ = compile_params.maxrregcount;
-  compiled_kernel_ = executor_utils::getCompiledKernel(
-      kernel_code_,
-      structured_code,
-      kernelName(),
-      kernel_id_,
+  // See [ Note -- Tiered compilation ]
+  fast_compiled_ = isOptionEnabled(EnableOption::TieredCompile);
+  num_fast_launches_ = 0;
+  compile_params.fast_compile = fast_compiled_;
+
+  pending_compilation_ = PendingCompilation{
+      std::move(structured_code),
       compile_params,
-      block_size);
+      block_size,
+      dynamic_smem,
+      group_id};
+  if (!defer_kernel_compilation_) {
+    finishCompilation();
+  }
+}
+
+void FusionExecutor::finishCompilation(
+    std::unique_ptr<executor_utils::CompiledKernel> compiled_kernel) {
+  NVF_ERROR(
+      pending_compilation_.has_value(),
+      "No kernel compilation is pending for FusionExecutor.");
+  const PendingCompilation pending = std::move(pending_compilation_.value());
+  pending_compilation_.reset();
+  defer_kernel_compilation_ = false;
+
+  if (compiled_kernel != nullptr) {
+    compiled_kernel_ = std::move(compiled_kernel);
+  } else {
+    c10::DeviceGuard dg(options_.device);
+    compiled_kernel_ = executor_utils::getCompiledKernel(
+        kernel_code_,
+        pending.structured_code,
+        kernelName(),
+        kernel_id_,
+        pending.compile_params,
+        pending.block_size);
+  }
   NVF_ERROR(validKernelId(), "Invalid kernel id for FusionExecutor.");
 
   // These should be nullopt at this point, but reset just in case
@@ -473,15 +547,25 @@ void FusionExecutor::compileFusion(
 
   // If the dynamic shmem size is known, make sure the compiled kernel
   // has at least that size of dynamic shmem
-  if (dynamic_smem.has_value()) {
-    ensureAvailableDynamicSmemSize(dynamic_smem.value());
+  if (pending.dynamic_smem.has_value()) {
+    ensureAvailableDynamicSmemSize(pending.dynamic_smem.value());
   }
 
   if (isDebugDumpEnabled(DebugDumpOption::Sass)) {
-    debug() << disassembledKernelSASS() << std::endl;
+    const std::string sass = disassembledKernelSASS();
+    debug() << sass << std::endl;
+    // See [ Note -- Outlined runtime functions ] in executor_utils.cpp
+    debug() << "SASS instructions: "
+            << executor_utils::countSassInstructions(sass)
+            << ", runtime function calls: "
+            << executor_utils::countOutlinableCalls(kernel_code_)
+            << (executor_utils::outlineRuntimeFunctions(kernel_code_)
+                    ? " (outlined)"
+                    : " (inlined)")
+            << std::endl;
   }
   if (isProfilerEnabled()) {
-    FusionProfiler::segment(group_id).stopCompile();
+    FusionProfiler::segment(pending.group_id).stopCompile();
   }
 }
 
@@ -962,12 +1046,52 @@ std::pair<std::vector<int64_t>, std::vector<int64_t>> inferShapeOfOutput(
   return {meta_tensor.sizes().vec(), meta_tensor.strides().vec()};
 }
 
+// Checks that `preallocated` can be used as the allocation of `out_info`. The
+// strides of size-1 dimensions are never used for indexing, so they don't
+// have to match.
+void validatePreallocatedOutput(
+    const FusionExecutor::GlobalBufferInfo& out_info,
+    const at::Tensor& preallocated) {
+  NVF_CHECK(
+      preallocated.scalar_type() == out_info.type,
+      "The buffer given for ",
+      out_info.tv->toString(),
+      " has dtype ",
+      preallocated.scalar_type(),
+      " but ",
+      out_info.type,
+      " is expected");
+  NVF_CHECK(
+      preallocated.sizes() == c10::IntArrayRef(out_info.sizes),
+      "The buffer given for ",
+      out_info.tv->toString(),
+      " has sizes ",
+      preallocated.sizes(),
+      " but ",
+      c10::IntArrayRef(out_info.sizes),
+      " are expected");
+  for (auto i : c10::irange(out_info.sizes.size())) {
+    NVF_CHECK(
+        out_info.sizes.at(i) <= 1 ||
+            preallocated.stride((int64_t)i) == out_info.strides.at(i),
+        "The buffer given for ",
+        out_info.tv->toString(),
+        " has strides ",
+        preallocated.strides(),
+        " but ",
+        c10::IntArrayRef(out_info.strides),
+        " are expected");
+  }
+}
+
 // Allocate an `at::Tensor` for `out_info` or compute it as an alias.
+// A defined `preallocated` tensor is used instead of allocating a new one.
 at::Tensor allocateOutput(
     const FusionExecutor::GlobalBufferInfo& out_info,
     const AliasInfo& alias_info,
     const c10::Device& device,
-    ExpressionEvaluator& ee) {
+    ExpressionEvaluator& ee,
+    const at::Tensor& preallocated) {
   // Handle a fusion with duplicated outputs.
   TensorView* out_tv = out_info.tv;
   if (ee.isKnown(out_tv)) {
@@ -993,14 +1117,21 @@ at::Tensor allocateOutput(
 
   switch (alias_info.type) {
     case AllocationType::New: {
-      auto alloc_tensor = at::native::empty_strided_cuda(
-          out_info.sizes,
-          out_info.strides,
-          out_info.type,
-          c10::nullopt,
-          device,
-          c10::nullopt);
-      if (shouldFillAllocationWithNan()) {
+      if (preallocated.defined()) {
+        validatePreallocatedOutput(out_info, preallocated);
+      }
+      auto alloc_tensor = preallocated.defined()
+          ? preallocated
+          : at::native::empty_strided_cuda(
+                out_info.sizes,
+                out_info.strides,
+                out_info.type,
+                c10::nullopt,
+                device,
+                c10::nullopt);
+      if (out_info.zero_init) {
+        alloc_tensor.zero_();
+      } else if (shouldFillAllocationWithNan()) {
         fillTensorWithNan(alloc_tensor);
       }
       return alloc_tensor;
@@ -1031,12 +1162,14 @@ at::Tensor allocateOutput(
 }
 
 // Allocate output tensors for a given fusion. Outputs may alias inputs, in
-// that case output tensors are shallow copies of the aliased inputs
+// that case output tensors are shallow copies of the aliased inputs. Defined
+// tensors of `preallocated` are used for the corresponding new outputs.
 std::vector<at::Tensor> allocateOutputs(
     const Fusion* fusion,
     const std::vector<FusionExecutor::GlobalBufferInfo>& output_info,
     const c10::Device& device,
-    ExpressionEvaluator& ee) {
+    ExpressionEvaluator& ee,
+    const std::vector<at::Tensor>& preallocated = {}) {
   FUSER_PERF_SCOPE("executor.cpp::allocateOutputs");
 
   const auto num_outs = output_info.size();
@@ -1073,7 +1206,12 @@ std::vector<at::Tensor> allocateOutputs(
   std::vector<at::Tensor> out_tensors(num_outs);
   for (const auto& [out_index, out] : sorted_outs) {
     at::Tensor out_tensor = allocateOutput(
-        output_info[out_index], fusion->getOutputAlias(out), device, ee);
+        output_info[out_index],
+        fusion->getOutputAlias(out),
+        device,
+        ee,
+        out_index < (int64_t)preallocated.size() ? preallocated.at(out_index)
+                                                 : at::Tensor());
     // Bind `out_tensor` so
     // 1. duplicated outputs map to the same tensor,
     // 2. an output that aliases another output can be evaluated via
@@ -1245,8 +1383,9 @@ LaunchParams FusionExecutor::computeLaunchParams(
   // Add workspace for reduction and broadcast
   int64_t reduction_broadcast_workspace = 0;
   const bool has_workspace = kernel_summary.has_block_reductions ||
-      kernel_summary.has_grid_reductions ||
-      kernel_summary.has_block_broadcasts || kernel_summary.has_grid_broadcasts;
+      kernel_summary.has_grid_reductions || kernel_summary.has_block_scans ||
+      kernel_summary.has_block_sorts || kernel_summary.has_block_broadcasts ||
+      kernel_summary.has_grid_broadcasts;
   if (has_workspace &&
       kernel_summary.largest_smem_data_type != DataType::Null) {
     // Not using nThreads here since it does not handle uninitialized value
@@ -1257,6 +1396,9 @@ LaunchParams FusionExecutor::computeLaunchParams(
     const int welford_factor =
         kernel_summary.has_block_welford || kernel_summary.has_grid_welford ? 3
                                                                             : 1;
+    // Block sorts keep an Int position with each item, and the largest data
+    // type is at least as large as Int
+    const int sort_factor = kernel_summary.has_block_sorts ? 2 : 1;
     // in outer reduction, may group iteration domain, e.g. when vectorized.
     const int64_t grouped_iter_factor = kernel_summary.num_grouped_iterations;
 
@@ -1267,8 +1409,8 @@ LaunchParams FusionExecutor::computeLaunchParams(
     reduction_broadcast_workspace =
         (int64_t)dataTypeSize(
             kernel_summary.largest_smem_data_type, index_type) *
-        grouped_iter_factor * welford_factor * launch_params.bdimx() *
-        launch_params.bdimy() * launch_params.bdimz();
+        grouped_iter_factor * std::max(welford_factor, sort_factor) *
+        launch_params.bdimx() * launch_params.bdimy() * launch_params.bdimz();
 
     if (kernel_summary.has_outer_grouped_grid_welford) {
       reduction_broadcast_workspace = std::max(
@@ -1348,6 +1490,56 @@ std::vector<FusionExecutor::GlobalBufferInfo> FusionExecutor::
 
 namespace {
 
+//! Read the profiled regions of a kernel out of its profile buffer. See Note
+//! [Profiled kernel regions] in device_lower/pass/instrument.cpp
+std::vector<KernelRegionProfile> readRegionProfiles(
+    const kir::KernelPerformanceProfile& profile,
+    const at::Tensor& buffer) {
+  const auto& regions = profile.regions();
+  const at::Tensor host_buffer = buffer.cpu();
+  const double kilo_freq = at::cuda::getCurrentDeviceProperties()->clockRate;
+
+  // Cycles of each region, then excluding its nested regions
+  std::vector<double> cycles(regions.size(), 0.0);
+  std::vector<double> exclusive_cycles(regions.size(), 0.0);
+  for (const auto i : c10::irange(regions.size())) {
+    const auto indices = profile.getIndicesInProfileBuffer(regions[i]);
+    cycles[i] = (double)host_buffer.view(-1)[indices[0]].item<int64_t>();
+    exclusive_cycles[i] = cycles[i];
+  }
+  double total_cycles = 0.0;
+  for (const auto i : c10::irange(regions.size())) {
+    if (regions[i].parent >= 0) {
+      exclusive_cycles[regions[i].parent] -= cycles[i];
+    } else {
+      total_cycles += cycles[i];
+    }
+  }
+
+  std::vector<KernelRegionProfile> region_profiles;
+  region_profiles.reserve(regions.size());
+  for (const auto i : c10::irange(regions.size())) {
+    const auto& region = regions[i];
+    const auto indices = profile.getIndicesInProfileBuffer(region);
+    KernelRegionProfile region_profile;
+    region_profile.kind =
+        kir::KernelPerformanceProfile::kindName(region.kind);
+    region_profile.name = kir::KernelPerformanceProfile::regionName(region);
+    region_profile.nested = region.parent >= 0;
+    region_profile.hits = host_buffer.view(-1)[indices[1]].item<int64_t>();
+    if (region_profile.hits > 0) {
+      region_profile.us_per_hit =
+          cycles[i] / (double)region_profile.hits / kilo_freq * 1000.0;
+    }
+    if (total_cycles > 0.0) {
+      region_profile.percentage =
+          std::max(exclusive_cycles[i], 0.0) / total_cycles * 100.0;
+    }
+    region_profiles.push_back(region_profile);
+  }
+  return region_profiles;
+}
+
 //! Return information necessary for allocating output tensors. Input
 //! and output tensors are allowed to alias each other, which is
 //! specified by the list of int pairs of input and output indices
@@ -1373,6 +1565,12 @@ std::vector<FusionExecutor::GlobalBufferInfo> getOutputBufferInfo(
     auto dtype =
         (info.tv->dtype() == DataType::Index ? index_dtype : info.tv->dtype());
     info.type = data_type_to_aten(dtype);
+    // Atomic grid reductions add to their zero-filled outputs
+    if (fusion->isA<kir::Kernel>()) {
+      info.zero_init = fusion->as<kir::Kernel>()
+                           ->summary()
+                           .atomic_reduction_outputs.count(info.tv);
+    }
 
     outputs.emplace_back(info);
   }
@@ -1453,6 +1651,47 @@ void validateIndexType(
       compile_params.index_type.value());
 }
 
+// Encodes everything the ExecutorEntry of a launch depends on when no
+// cache id is given: the launch constraints, and the dtype, sizes, strides
+// and pointer alignment of the tensor arguments and the values of the
+// scalar ones. Returns std::nullopt for arguments that can't be encoded, in
+// which case the entry is not reused. See Note [Shape-keyed executor entries]
+std::optional<std::vector<int64_t>> encodeLaunchShape(
+    const KernelArgumentHolder& args,
+    const LaunchParams& launch_constraints) {
+  // Vectorized accesses are at most 16 bytes wide
+  constexpr int64_t kMaxAlignment = 16;
+
+  std::vector<int64_t> key;
+  key.push_back(args.getDeviceIndex());
+  for (auto pt : kParallelTypeThreads) {
+    key.push_back(launch_constraints.getRawVal(pt));
+  }
+  key.push_back(launch_constraints.smem());
+
+  for (auto i : c10::irange(args.size())) {
+    const PolymorphicValue& arg = *args[i];
+    if (arg.is<at::Tensor>()) {
+      const auto& tensor = arg.as<at::Tensor>();
+      key.push_back((int64_t)tensor.scalar_type());
+      key.push_back(tensor.is_cpu());
+      key.push_back(tensor.dim());
+      key.insert(key.end(), tensor.sizes().begin(), tensor.sizes().end());
+      key.insert(key.end(), tensor.strides().begin(), tensor.strides().end());
+      key.push_back((int64_t)((size_t)tensor.data_ptr() % kMaxAlignment));
+    } else if (arg.is<int64_t>()) {
+      key.push_back(arg.as<int64_t>());
+    } else if (arg.is<bool>()) {
+      key.push_back(arg.as<bool>());
+    } else if (arg.is<double>()) {
+      key.push_back(std::bit_cast<int64_t>(arg.as<double>()));
+    } else {
+      return std::nullopt;
+    }
+  }
+  return key;
+}
+
 void validateCooperativeLaunch(
     CUfunction kernel,
     const LaunchParams& launch_params,
@@ -1558,6 +1797,46 @@ FusionExecutor::GlobalBufferInfo getGlobalBufferAllocationInfo(
 
 } // namespace
 
+// Note [Shape-keyed executor entries]
+// The ExecutorEntry of a launch holds everything runFusion derives from the
+// shapes of the arguments by evaluating the kernel's expressions: the launch
+// parameters, the sizes and strides of the outputs and intermediates, and the
+// laid out kernel arguments. FusionExecutorCache gives each input set a cache
+// id, so this evaluation runs once per id. Other users of FusionExecutor,
+// like HostIrExecutor, launch without cache ids, and used to initialize a
+// temporary entry, i.e., to interpret the shape inference and launch
+// parameter computations again, on every launch even when the shapes don't
+// change. The entries of such launches are now kept in a table keyed by an
+// encoding of what initializeExecutorEntry depends on (see
+// encodeLaunchShape), so that a repeated shape only pays for the lookup and
+// for patching the data pointers of the kernel arguments. Launches with
+// preallocated outputs still use a temporary entry, since their output
+// information comes from the given tensors. The table is cleared, but for
+// the entries of launches in flight, when it grows past
+// kMaxShapeKeyedEntries, so a workload with ever-changing shapes costs what
+// it used to.
+FusionExecutor::ExecutorEntry* FusionExecutor::getShapeKeyedEntry(
+    const KernelArgumentHolder& args,
+    const LaunchParams& launch_constraints) {
+  std::optional<std::vector<int64_t>> key =
+      encodeLaunchShape(args, launch_constraints);
+  if (!key.has_value()) {
+    return nullptr;
+  }
+  auto it = shape_keyed_entries_.find(*key);
+  if (it != shape_keyed_entries_.end()) {
+    return &it->second;
+  }
+  if ((int64_t)shape_keyed_entries_.size() >= kMaxShapeKeyedEntries) {
+    for (auto entry_it = shape_keyed_entries_.begin();
+         entry_it != shape_keyed_entries_.end();) {
+      entry_it = entry_it->second.in_use ? std::next(entry_it)
+                                         : shape_keyed_entries_.erase(entry_it);
+    }
+  }
+  return &shape_keyed_entries_[std::move(*key)];
+}
+
 void FusionExecutor::initializeExecutorEntry(
     ExecutorEntry& executor_entry,
     const KernelArgumentHolder& args,
@@ -1567,9 +1846,31 @@ void FusionExecutor::initializeExecutorEntry(
     DataType index_type) {
   FUSER_PERF_SCOPE("FusionExecutor::initializeExecutorEntry");
 
+  // The offsets of the arguments are only checked once per input shape.
+  // FusionExecutorCache picks a kernel with 64-bit indexing for them instead.
+  NVF_CHECK(
+      index_type != DataType::Int32 ||
+          args.getSmallestIndexTypeOfArguments(kernel()->inputs()) ==
+              PrimDataType::Int32,
+      "The kernel is compiled with 32-bit indexing, but the arguments ",
+      "require 64-bit indexing");
+
+  // The cached precomputed values serve one launch at a time. Concurrent
+  // launches evaluate into their own.
+  std::unique_lock<std::mutex> precomputed_values_lock(
+      precomputed_values_mutex_, std::try_to_lock);
+  std::unique_ptr<PrecomputedValues> scratch_precomputed_values;
+  PrecomputedValues* precomputed_values = nullptr;
+  if (precomputed_values_lock.owns_lock()) {
+    precomputed_values = evaluatorPrecomputedValues().get();
+  } else {
+    scratch_precomputed_values =
+        std::make_unique<PrecomputedValues>(lowered_->kernel());
+    precomputed_values = scratch_precomputed_values.get();
+  }
   ExpressionEvaluator expr_eval;
-  evaluatorPrecomputedValues()->bindInputs(args);
-  expr_eval.precomputedValues() = evaluatorPrecomputedValues().get();
+  precomputed_values->bindInputs(args);
+  expr_eval.precomputedValues() = precomputed_values;
 
   auto launch_params = computeLaunchParams(
       launch_constraints, expr_eval, warp_size_, index_type);
@@ -1694,10 +1995,15 @@ void FusionExecutor::computeArgs(
   const std::vector<Val*>& params = kernel->parameters();
   entry.args.resize(params.size());
   entry.arg_ptrs.resize(params.size());
+  entry.tensor_args.resize(params.size());
   const PrimDataType idx_type = kernel->indexType();
   for (size_t p = 0; p < params.size(); ++p) {
     entry.args[p] = getKernelArgument(expr_eval, params[p], idx_type);
     entry.arg_ptrs[p] = entry.args[p].data();
+    // Matches the parameters that getKernelArgument passes as a `struct
+    // Tensor`, whose leading field is the data pointer
+    auto tv = dynamic_cast<TensorView*>(params[p]);
+    entry.tensor_args[p] = tv != nullptr && !tv->isCpuScalar();
   }
 }
 
@@ -1716,6 +2022,14 @@ void FusionExecutor::recomputeArgs(
   // assert(entry.arg_ptrs.size() == params.size());
   // assert(params.size() >= args.size());
   for (size_t p = 0; p < params.size(); ++p) {
+    if (!disable_kernel_arg_patching_ && entry.tensor_args.at(p)) {
+      // The shape and stride arrays laid out by computeArgs still hold, since
+      // the entry is specific to the input sizes and strides. Skip evaluating
+      // the tensor metadata and only patch the data pointer in place.
+      void* data = expr_eval.evaluate(params[p]).as<at::Tensor>().data_ptr();
+      memcpy(entry.args[p].data(), &data, sizeof(void*));
+      continue;
+    }
     PolymorphicValue pv = expr_eval.evaluate(params[p]);
     if (pv.is<at::Tensor>() && pv.as<at::Tensor>().is_cuda()) {
       // GPU tensors are not passed directly: instead we pass a Tensor<type,
@@ -1750,12 +2064,16 @@ void FusionExecutor::recompileKernel(
   block_size_high_water_mark_ = new_launch_params.nThreads();
   maxrregcount_high_water_mark_ = new_compile_params.maxrregcount;
 
+  // A kernel still in the fast tier is recompiled fast. A pending optimized
+  // kernel was built for the old block size and is dropped when it is ready.
+  CompileParams params = new_compile_params;
+  params.fast_compile = fast_compiled_;
   compiled_kernel_ = executor_utils::getCompiledKernel(
       kernel_code_,
       structured_code,
       kernelName(),
       kernel_id_,
-      new_compile_params,
+      params,
       block_size_high_water_mark_);
 
   resetCompiledKernelProperties();
@@ -1766,9 +2084,610 @@ void FusionExecutor::recompileKernel(
     // So we need to do it there before calling into the validation, to avoid
     // false positives
     ensureAvailableDynamicSmemSize(new_launch_params.smem());
-    validateCooperativeLaunch(
-        compiled_kernel_->function, new_launch_params, options_.device.index());
+    if (!useClusterGridSync(new_launch_params)) {
+      validateCooperativeLaunch(
+          compiled_kernel_->function,
+          new_launch_params,
+          options_.device.index());
+    }
+  }
+}
+
+// [ Note -- Tiered compilation ]
+//
+// With EnableOption::TieredCompile, the first compilation of a kernel lowers
+// the ptxas optimization level (CompileParams::fast_compile), which cuts the
+// time to the first launch of large kernels. Most kernels of a program only
+// run a handful of times, so they are never compiled again. Once a kernel has
+// been launched a number of times, a fully optimized compilation is started
+// on a background thread, and the next launch that finds it ready swaps it
+// in. Until then, launches keep using the fast kernel.
+//
+// The optimized kernel is compiled for the block size high water mark at the
+// time it is started. If recompileKernel raised the mark meanwhile, the
+// result is dropped and the recompilation started again. CUDA graphs
+// captured with the fast kernel are re-captured since CudaGraph::isValid
+// detects the new function.
+
+namespace {
+
+//! Number of launches after which a kernel is recompiled, given as the
+//! argument of `option` or 16 by default
+int64_t launchThreshold(EnableOption option, const std::string& what) {
+  int64_t threshold = 16;
+  const auto& args = getEnableOptionArguments(option);
+  if (!args.empty()) {
+    try {
+      threshold = std::stoll(args[0]);
+    } catch (const std::exception&) {
+      NVF_CHECK(false, "Invalid ", what, " threshold: ", args[0]);
+    }
+  }
+  NVF_CHECK(
+      threshold >= 0,
+      what,
+      " threshold must not be negative, but got ",
+      threshold);
+  return threshold;
+}
+
+} // namespace
+
+void FusionExecutor::updateTieredCompilation(
+    const LaunchParams& launch_params,
+    const CompileParams& compile_params) {
+  if (!fast_compiled_) {
+    return;
+  }
+
+  if (!optimized_kernel_.valid()) {
+    if (num_fast_launches_++ <
+        launchThreshold(EnableOption::TieredCompile, "Tiered compilation")) {
+      return;
+    }
+    CompileParams optimized_params = compile_params;
+    optimized_params.maxrregcount = maxrregcount_high_water_mark_;
+    optimized_params.fast_compile = false;
+    // Everything is captured by value, as the executor may be destroyed or
+    // recompiled while the background compilation runs
+    optimized_kernel_ = std::async(
+        std::launch::async,
+        [kernel_code = kernel_code_,
+         structured_code = getStructuredCode(),
+         kernel_name = kernelName(),
+         kernel_id = kernel_id_,
+         optimized_params,
+         block_size = block_size_high_water_mark_,
+         device = options_.device.index()]() {
+          c10::cuda::CUDAGuard dg(device);
+          return executor_utils::getCompiledKernel(
+              kernel_code,
+              structured_code,
+              kernel_name,
+              kernel_id,
+              optimized_params,
+              block_size);
+        });
+    return;
+  }
+
+  if (optimized_kernel_.wait_for(std::chrono::seconds(0)) !=
+      std::future_status::ready) {
+    return;
+  }
+  // Rethrows any compilation error, which we would have hit without tiering
+  auto optimized_kernel = optimized_kernel_.get();
+  if (optimized_kernel->block_size != block_size_high_water_mark_) {
+    return;
+  }
+
+  compiled_kernel_ = std::move(optimized_kernel);
+  fast_compiled_ = false;
+  resetCompiledKernelProperties();
+
+  if (kernel()->summary().has_cooperative_grid_reduction) {
+    ensureAvailableDynamicSmemSize(launch_params.smem());
+    if (!useClusterGridSync(launch_params)) {
+      validateCooperativeLaunch(
+          compiled_kernel_->function, launch_params, options_.device.index());
+    }
+  }
+}
+
+// [ Note -- Shape specialization ]
+//
+// Kernels read the extents and strides of their inputs from the Tensor
+// structs passed as arguments, so that one kernel serves all shapes accepted
+// by its heuristics. With EnableOption::ShapeSpecialization, once a kernel
+// has been launched a number of times in a row with the same input sizes and
+// strides, a variant is generated where every extent and stride of an input
+// is printed as a constant, and compiled on a background thread. nvrtc then
+// folds them into the indexing, predicates and loop bounds, which removes
+// most of the integer arithmetic of small or latency bound kernels.
+//
+// The constants are substituted by codegen rather than by lowering, since
+// lowering is the expensive part of a compilation and the kernel IR is
+// shared with the generic kernel. Launches whose input shapes exactly match
+// the specialized ones use the variant, all other launches keep using the
+// generic kernel. Only the first hot shapes are specialized. Like the
+// optimized kernel of tiered compilation, the variant is dropped if
+// recompileKernel raises the block size high water mark.
+
+namespace {
+
+//! Sizes and strides of the tensor inputs, which identify the launches a
+//! shape specialized kernel can serve
+std::vector<int64_t> inputShapes(const KernelArgumentHolder& args) {
+  std::vector<int64_t> shapes;
+  for (auto i : c10::irange(args.size())) {
+    if (!args[i]->is<at::Tensor>()) {
+      continue;
+    }
+    const auto& tensor = args[i]->as<at::Tensor>();
+    shapes.push_back(tensor.dim());
+    shapes.insert(shapes.end(), tensor.sizes().begin(), tensor.sizes().end());
+    shapes.insert(
+        shapes.end(), tensor.strides().begin(), tensor.strides().end());
   }
+  return shapes;
+}
+
+//! Values of the logical extents and allocation strides of the inputs of
+//! `kernel`, as read from their metadata
+std::unordered_map<const Val*, int64_t> inputShapeConstants(
+    kir::Kernel* kernel,
+    ExpressionEvaluator& expr_eval) {
+  std::unordered_map<const Val*, int64_t> constants;
+  for (Val* val : kernel->vals()) {
+    auto* item = dynamic_cast<GetItem*>(val->definition());
+    if (item == nullptr || !item->index()->isConst()) {
+      continue;
+    }
+    auto* attr = dynamic_cast<GetAttr*>(item->array()->definition());
+    if (attr == nullptr ||
+        (attr->attr() != "logical_size" && attr->attr() != "alloc_stride")) {
+      continue;
+    }
+    auto* metadata = dynamic_cast<GetMetaData*>(attr->struct_()->definition());
+    if (metadata == nullptr || !metadata->in()->isA<TensorView>() ||
+        !metadata->in()->isFusionInput()) {
+      continue;
+    }
+    auto value = expr_eval.evaluate(val);
+    if (value.hasValue() && value.is<int64_t>()) {
+      constants.emplace(val, value.as<int64_t>());
+    }
+  }
+  return constants;
+}
+
+} // namespace
+
+CUfunction FusionExecutor::updateShapeSpecialization(
+    const KernelArgumentHolder& args,
+    const LaunchParams& launch_params,
+    const CompileParams& compile_params) {
+  if (!isOptionEnabled(EnableOption::ShapeSpecialization)) {
+    return compiled_kernel_->function;
+  }
+  FUSER_PERF_SCOPE("FusionExecutor::updateShapeSpecialization");
+
+  std::vector<int64_t> shapes = inputShapes(args);
+
+  if (specialized_kernel_ == nullptr && !pending_specialized_kernel_.valid()) {
+    if (shapes != hot_shapes_) {
+      hot_shapes_ = std::move(shapes);
+      num_hot_shape_launches_ = 0;
+    }
+    if (num_hot_shape_launches_++ <
+        launchThreshold(
+            EnableOption::ShapeSpecialization, "Shape specialization")) {
+      return compiled_kernel_->function;
+    }
+    CompileParams specialized_params = compile_params;
+    specialized_params.maxrregcount = maxrregcount_high_water_mark_;
+    specialized_params.fast_compile = false;
+    ExpressionEvaluator expr_eval = executor_utils::bindInputs(args, kernel());
+    const std::string specialized_code = codegen::generateCudaKernel(
+        kernel(), kernelName(), inputShapeConstants(kernel(), expr_eval));
+    // Everything is captured by value, as the executor may be destroyed or
+    // recompiled while the background compilation runs
+    pending_specialized_kernel_ = std::async(
+        std::launch::async,
+        [kernel_code = specialized_code,
+         structured_code =
+             getStructuredCode(specialized_code, kernel()->indexType()),
+         kernel_name = kernelName(),
+         kernel_id = kernel_id_,
+         specialized_params,
+         block_size = block_size_high_water_mark_,
+         device = options_.device.index()]() {
+          c10::cuda::CUDAGuard dg(device);
+          return executor_utils::getCompiledKernel(
+              kernel_code,
+              structured_code,
+              kernel_name,
+              kernel_id,
+              specialized_params,
+              block_size);
+        });
+    return compiled_kernel_->function;
+  }
+
+  if (pending_specialized_kernel_.valid()) {
+    if (pending_specialized_kernel_.wait_for(std::chrono::seconds(0)) !=
+        std::future_status::ready) {
+      return compiled_kernel_->function;
+    }
+    // Rethrows any compilation error, which the generic kernel would have
+    // hit as well
+    specialized_kernel_ = pending_specialized_kernel_.get();
+    specialized_dynamic_smem_size_ = 0;
+    if (kernel()->summary().has_cooperative_grid_reduction) {
+      // The variant may use more registers, and so allow fewer blocks per SM
+      NVFUSER_CUDA_SAFE_CALL(cuFuncSetAttribute(
+          specialized_kernel_->function,
+          CU_FUNC_ATTRIBUTE_MAX_DYNAMIC_SHARED_SIZE_BYTES,
+          launch_params.smem()));
+      specialized_dynamic_smem_size_ = launch_params.smem();
+      if (!useClusterGridSync(launch_params)) {
+        validateCooperativeLaunch(
+            specialized_kernel_->function,
+            launch_params,
+            options_.device.index());
+      }
+    }
+  }
+
+  if (specialized_kernel_->block_size != block_size_high_water_mark_) {
+    // Start over with the new block size
+    specialized_kernel_.reset();
+    num_hot_shape_launches_ = 0;
+    return compiled_kernel_->function;
+  }
+
+  if (shapes != hot_shapes_) {
+    return compiled_kernel_->function;
+  }
+
+  if (launch_params.smem() > specialized_dynamic_smem_size_) {
+    NVFUSER_CUDA_SAFE_CALL(cuFuncSetAttribute(
+        specialized_kernel_->function,
+        CU_FUNC_ATTRIBUTE_MAX_DYNAMIC_SHARED_SIZE_BYTES,
+        launch_params.smem()));
+    specialized_dynamic_smem_size_ = launch_params.smem();
+  }
+  return specialized_kernel_->function;
+}
+
+// [ Note -- Cluster grid syncs ]
+//
+// Cooperative kernels synchronize their blocks with grid_sync::sync, which
+// spins on a global semaphore and requires the whole grid to be resident, so
+// they are launched with cuLaunchCooperativeKernel. On Hopper, when every
+// grid sync of a kernel is only along BIDx and gridDim.x fits in a portable
+// cluster, the kernel is instead launched with clusters spanning gridDim.x.
+// grid_sync::sync detects such launches and uses the cluster barrier, so
+// blocks do not spin, and only the blocks of a cluster need to be
+// co-scheduled, not the whole grid. Portable cluster sizes are always
+// schedulable when a single block fits on an SM, so the size is not extended
+// to the non-portable 16 blocks, which may fail to launch with large blocks.
+bool FusionExecutor::useClusterGridSync(
+    const LaunchParams& launch_params) const {
+#if (CUDA_VERSION >= 12000)
+  constexpr int64_t max_portable_cluster_size = 8;
+  const auto& summary = kernel()->summary();
+  if (!summary.has_cooperative_grid_reduction ||
+      launch_params.gdimx() > max_portable_cluster_size) {
+    return false;
+  }
+  ParallelTypeBitmap bidx;
+  bidx.set(ParallelType::BIDx);
+  if (summary.cooperative_sync_dims != bidx) {
+    return false;
+  }
+  return at::cuda::getDeviceProperties(options_.device.index())->major >= 9;
+#else
+  return false;
+#endif
+}
+
+void FusionExecutor::launchClusterKernel(
+    CUfunction function,
+    CUstream stream,
+    const LaunchParams& launch_params,
+    void** arg_ptrs) {
+  FUSER_PERF_SCOPE("ExecutorRunFusion::cuLaunchKernelEx");
+#if (CUDA_VERSION >= 12000)
+  // Portable cluster sizes are up to 8 blocks. Hopper allows up to 16 when
+  // the kernel opts in.
+  constexpr int64_t max_portable_cluster_size = 8;
+  constexpr int64_t max_cluster_size = 16;
+  const int64_t cluster_size = launch_params.gdimx();
+  NVF_CHECK(
+      cluster_size <= max_cluster_size,
+      "Cluster launches support up to ",
+      max_cluster_size,
+      " blocks in gridDim.x, but got ",
+      cluster_size);
+  if (cluster_size > max_portable_cluster_size) {
+    NVFUSER_CUDA_SAFE_CALL(cuFuncSetAttribute(
+        function,
+        CU_FUNC_ATTRIBUTE_NON_PORTABLE_CLUSTER_SIZE_ALLOWED,
+        1));
+  }
+
+  CUlaunchAttribute cluster_attr;
+  cluster_attr.id = CU_LAUNCH_ATTRIBUTE_CLUSTER_DIMENSION;
+  cluster_attr.value.clusterDim.x = (unsigned int)cluster_size;
+  cluster_attr.value.clusterDim.y = 1;
+  cluster_attr.value.clusterDim.z = 1;
+
+  CUlaunchConfig config = {};
+  config.gridDimX = launch_params.gdimx();
+  config.gridDimY = launch_params.gdimy();
+  config.gridDimZ = launch_params.gdimz();
+  config.blockDimX = launch_params.bdimx();
+  config.blockDimY = launch_params.bdimy();
+  config.blockDimZ = launch_params.bdimz();
+  config.sharedMemBytes = launch_params.smem();
+  config.hStream = stream;
+  config.attrs = &cluster_attr;
+  config.numAttrs = 1;
+
+  NVFUSER_CUDA_SAFE_CALL(
+      cuLaunchKernelEx(&config, function, arg_ptrs, nullptr));
+#else
+  NVF_ERROR(false, "Cluster launches require CUDA 12 or newer");
+#endif
+}
+
+// [Programmatic dependent launch]
+//
+// A kernel launched right after another in a stream normally starts once the
+// previous grid has completed and its memory operations are flushed, so the
+// launch latency and the block setup of each kernel add to the gap between
+// the segments of a FusionKernelRuntime. On Hopper, with
+// NVFUSER_ENABLE=programmatic_launch, kernels are instead launched with the
+// programmatic stream serialization attribute, which lets them start once
+// all blocks of the previous grid have run griddepcontrol.launch_dependents
+// or exited. The generated code runs its allocations, then griddepcontrol.wait,
+// which blocks until the previous grid has completed and its writes are
+// visible, and only then accesses global memory. It then triggers its own
+// dependents. Previous kernels that do not trigger them, e.g. ATen kernels,
+// simply let the next kernel start when they exit.
+//
+// Kernels whose code might not wait are launched normally: those compiled
+// without the option, deserialized ones and external sources. Cooperative
+// and cluster launches are not programmatic, nor are launches captured into
+// CUDA graphs.
+bool FusionExecutor::useProgrammaticLaunch(CUstream stream) const {
+#if (CUDA_VERSION >= 12000)
+  if (!programmatic_launch_ ||
+      at::cuda::getDeviceProperties(options_.device.index())->major < 9) {
+    return false;
+  }
+  cudaStreamCaptureStatus capture_status = cudaStreamCaptureStatusNone;
+  NVFUSER_CUDA_RT_SAFE_CALL(
+      cudaStreamIsCapturing((cudaStream_t)stream, &capture_status));
+  return capture_status == cudaStreamCaptureStatusNone;
+#else
+  return false;
+#endif
+}
+
+namespace {
+
+// Bytes spanned by the elements of `tensor`
+int64_t footprintBytes(const at::Tensor& tensor) {
+  if (tensor.numel() == 0) {
+    return 0;
+  }
+  int64_t elements = 1;
+  for (auto i : c10::irange(tensor.dim())) {
+    elements += (tensor.size(i) - 1) * tensor.stride(i);
+  }
+  return elements * (int64_t)tensor.element_size();
+}
+
+// Grows the persisting L2 carveout of `device` to `bytes`, up to
+// `max_bytes`, and returns it. The carveout is never shrunk, as other
+// kernels might still rely on it.
+int64_t reservePersistingL2(
+    c10::DeviceIndex device,
+    int64_t bytes,
+    int64_t max_bytes) {
+  static std::mutex mutex;
+  static std::unordered_map<c10::DeviceIndex, int64_t> carveouts;
+  std::lock_guard<std::mutex> guard(mutex);
+  int64_t& carveout = carveouts[device];
+  const int64_t wanted = std::min(bytes, max_bytes);
+  if (wanted > carveout) {
+    c10::cuda::CUDAGuard device_guard(device);
+    NVFUSER_CUDA_RT_SAFE_CALL(
+        cudaDeviceSetLimit(cudaLimitPersistingL2CacheSize, (size_t)wanted));
+    carveout = wanted;
+  }
+  return carveout;
+}
+
+} // namespace
+
+std::optional<CUaccessPolicyWindow> FusionExecutor::l2AccessPolicyWindow(
+    const std::optional<L2Window>& l2_window,
+    CUstream stream,
+    const KernelArgumentHolder& args,
+    const std::vector<at::Tensor>& outputs) const {
+#if (CUDA_VERSION >= 12000)
+  if (!l2_window.has_value()) {
+    return std::nullopt;
+  }
+  const size_t index = (size_t)l2_window->index;
+  const at::Tensor* tensor = nullptr;
+  if (l2_window->is_output) {
+    if (index < outputs.size()) {
+      tensor = &outputs.at(index);
+    }
+  } else if (index < args.size() && args[index]->is<at::Tensor>()) {
+    tensor = &args[index]->as<at::Tensor>();
+  }
+  if (tensor == nullptr || !tensor->defined() || !tensor->is_cuda()) {
+    return std::nullopt;
+  }
+  const int64_t bytes = footprintBytes(*tensor);
+  const auto prop = at::cuda::getDeviceProperties(options_.device.index());
+  if (bytes == 0 || bytes > prop->accessPolicyMaxWindowSize ||
+      prop->persistingL2CacheMaxSize == 0) {
+    return std::nullopt;
+  }
+  // The carveout is a device limit, which cannot be set while capturing
+  cudaStreamCaptureStatus capture_status = cudaStreamCaptureStatusNone;
+  NVFUSER_CUDA_RT_SAFE_CALL(
+      cudaStreamIsCapturing((cudaStream_t)stream, &capture_status));
+  if (capture_status != cudaStreamCaptureStatusNone) {
+    return std::nullopt;
+  }
+
+  CUaccessPolicyWindow window = {};
+  window.base_ptr = tensor->data_ptr();
+  window.num_bytes = (size_t)bytes;
+  if (l2_window->is_output) {
+    const int64_t carveout = reservePersistingL2(
+        options_.device.index(), bytes, prop->persistingL2CacheMaxSize);
+    // Only this fraction of the window persists, so that it does not thrash
+    // the carveout
+    window.hitRatio = std::min(1.0f, (float)carveout / (float)bytes);
+    window.hitProp = CU_ACCESS_PROPERTY_PERSISTING;
+  } else {
+    window.hitRatio = 1.0f;
+    window.hitProp = CU_ACCESS_PROPERTY_NORMAL;
+  }
+  window.missProp = CU_ACCESS_PROPERTY_STREAMING;
+  return window;
+#else
+  return std::nullopt;
+#endif
+}
+
+void FusionExecutor::launchKernelWithAttributes(
+    CUfunction function,
+    CUstream stream,
+    const LaunchParams& launch_params,
+    void** arg_ptrs,
+    bool programmatic,
+    const std::optional<CUaccessPolicyWindow>& access_policy_window) {
+  FUSER_PERF_SCOPE("ExecutorRunFusion::cuLaunchKernelEx");
+#if (CUDA_VERSION >= 12000)
+  std::array<CUlaunchAttribute, 2> attrs;
+  unsigned int num_attrs = 0;
+  if (programmatic) {
+    CUlaunchAttribute& attr = attrs.at(num_attrs++);
+    attr.id = CU_LAUNCH_ATTRIBUTE_PROGRAMMATIC_STREAM_SERIALIZATION;
+    attr.value.programmaticStreamSerializationAllowed = 1;
+  }
+  if (access_policy_window.has_value()) {
+    CUlaunchAttribute& attr = attrs.at(num_attrs++);
+    attr.id = CU_LAUNCH_ATTRIBUTE_ACCESS_POLICY_WINDOW;
+    attr.value.accessPolicyWindow = *access_policy_window;
+  }
+
+  CUlaunchConfig config = {};
+  config.gridDimX = launch_params.gdimx();
+  config.gridDimY = launch_params.gdimy();
+  config.gridDimZ = launch_params.gdimz();
+  config.blockDimX = launch_params.bdimx();
+  config.blockDimY = launch_params.bdimy();
+  config.blockDimZ = launch_params.bdimz();
+  config.sharedMemBytes = launch_params.smem();
+  config.hStream = stream;
+  config.attrs = attrs.data();
+  config.numAttrs = num_attrs;
+
+  NVFUSER_CUDA_SAFE_CALL(
+      cuLaunchKernelEx(&config, function, arg_ptrs, nullptr));
+#else
+  NVF_ERROR(false, "cuLaunchKernelEx requires CUDA 12 or newer");
+#endif
+}
+
+const inst::NvtxKernelLabel* FusionExecutor::nvtxKernelLabel() {
+  if (!inst::Trace::instance()->recordingNvtxRanges() || !validKernelId()) {
+    return nullptr;
+  }
+  if (!nvtx_kernel_label_.has_value()) {
+    std::stringstream message;
+    message << kernelName() << " fusion=" << fusion_id_
+            << " runtime=" << runtime_id_ << " group=" << group_id_
+            << " heuristic=" << heuristic_;
+    const uint64_t payload = ((uint64_t)fusion_id_ << 32) |
+        (((uint64_t)runtime_id_ & 0xffff) << 16) |
+        ((uint64_t)group_id_ & 0xffff);
+    // Category 0 is the default category of NVTX
+    nvtx_kernel_label_ = inst::Trace::instance()->makeNvtxKernelLabel(
+        message.str(),
+        (uint32_t)heuristic_ + 1,
+        toString(heuristic_).c_str(),
+        payload);
+  }
+  return &nvtx_kernel_label_.value();
+}
+
+std::string KernelResourceUsage::toString() const {
+  std::stringstream ss;
+  ss << kernel_name << ": registers_per_thread=" << registers_per_thread
+     << ", static_smem_bytes=" << static_smem_bytes
+     << ", dynamic_smem_bytes=" << dynamic_smem_bytes
+     << ", local_memory_bytes=" << local_memory_bytes
+     << ", max_threads_per_block=" << max_threads_per_block
+     << ", threads_per_block=" << threads_per_block
+     << ", max_active_blocks_per_sm=" << max_active_blocks_per_sm
+     << ", active_warps_per_sm=" << active_warps_per_sm << ", occupancy="
+     << std::fixed << std::setprecision(2) << theoretical_occupancy * 100.0
+     << "%";
+  return ss.str();
+}
+
+KernelResourceUsage FusionExecutor::resourceUsage(
+    std::optional<LaunchParams> launch_params) {
+  NVF_ERROR(
+      hasCompiledKernel(),
+      "Cannot get the resource usage unless the kernel is compiled");
+  const LaunchParams& lparams = launch_params.value_or(launch_params_);
+  CUfunction function = compiled_kernel_->function;
+  auto get_attribute = [function](CUfunction_attribute attribute) {
+    int value = 0;
+    NVFUSER_CUDA_SAFE_CALL(cuFuncGetAttribute(&value, attribute, function));
+    return (int64_t)value;
+  };
+
+  KernelResourceUsage usage;
+  usage.kernel_name = kernelName();
+  usage.registers_per_thread = get_attribute(CU_FUNC_ATTRIBUTE_NUM_REGS);
+  usage.static_smem_bytes = getStaticSmemSize();
+  usage.dynamic_smem_bytes = lparams.smem();
+  usage.local_memory_bytes =
+      get_attribute(CU_FUNC_ATTRIBUTE_LOCAL_SIZE_BYTES);
+  usage.max_threads_per_block =
+      get_attribute(CU_FUNC_ATTRIBUTE_MAX_THREADS_PER_BLOCK);
+  usage.threads_per_block = lparams.nThreads();
+
+  int blocks_per_sm = 0;
+  NVFUSER_CUDA_SAFE_CALL(cuOccupancyMaxActiveBlocksPerMultiprocessor(
+      &blocks_per_sm,
+      function,
+      (int)usage.threads_per_block,
+      (size_t)usage.dynamic_smem_bytes));
+  usage.max_active_blocks_per_sm = blocks_per_sm;
+
+  const auto prop =
+      at::cuda::getDeviceProperties((c10::DeviceIndex)options_.device.index());
+  usage.active_warps_per_sm =
+      ceilDiv(blocks_per_sm * usage.threads_per_block, prop->warpSize);
+  const int64_t hw_max_warps =
+      prop->maxThreadsPerMultiProcessor / prop->warpSize;
+  usage.theoretical_occupancy =
+      (double)usage.active_warps_per_sm / (double)hw_max_warps;
+  return usage;
 }
 
 int64_t FusionExecutor::getAvailableDynamicSmemSize() {
@@ -1804,11 +2723,14 @@ int64_t FusionExecutor::getStaticSmemSize() {
 
 void FusionExecutor::validateDynamicSmemSize(int64_t dynamic_smem_size) {
   // If specified, check that dynamic smem size matches what the scheduler
-  // expects
+  // expects. The shared memory planner may pack buffers tighter than the
+  // scheduler assumed, see [ Note -- Shared memory planner ]
   int64_t expected_dynamic_smem_size = fusion()->expectedDynamicSmemBytes();
   if (expected_dynamic_smem_size >= 0) {
     NVF_ERROR(
-        dynamic_smem_size == expected_dynamic_smem_size,
+        dynamic_smem_size == expected_dynamic_smem_size ||
+            (isOptionEnabled(EnableOption::SmemPlanner) &&
+             dynamic_smem_size < expected_dynamic_smem_size),
         "Actual dynamic smem allocation ",
         dynamic_smem_size,
         " does not match expected size ",
@@ -1843,9 +2765,76 @@ int64_t FusionExecutor::ensureAvailableDynamicSmemSize(
   return getAvailableDynamicSmemSize();
 }
 
+// [Shared memory carveout]
+//
+// Shared memory and L1 share the same on-chip storage of an SM, split by the
+// shared memory carveout of the resident kernel. By default the driver picks
+// the split from the shared memory of the launch, which tends to leave a
+// large carveout to kernels using little of it, e.g. pointwise kernels and
+// register persistent normalizations, that would rather have the L1.
+// Shared memory persistent normalizations, on the other hand, need the whole
+// carveout to keep several blocks resident.
+//
+// With NVFUSER_ENABLE=smem_carveout, the preferred carveout of each kernel is
+// set to the shared memory of the blocks an SM would run at the target
+// occupancy, i.e. the number of blocks allowed by the registers, the threads
+// and the block limit of the SM, but no more than the grid spreads over each
+// SM. A kernel without shared memory prefers the maximum L1 and one limited
+// by its shared memory gets the maximum carveout. The driver rounds the
+// preference up to a supported carveout, so it never limits occupancy.
+int64_t FusionExecutor::ensurePreferredSmemCarveout(
+    const LaunchParams& launch_params) {
+  NVF_ERROR(
+      hasCompiledKernel(),
+      "Cannot set the smem carveout unless kernel is compiled");
+  const auto prop = at::cuda::getDeviceProperties(options_.device.index());
+  if (!registers_per_thread_.has_value()) {
+    int registers = 0;
+    NVFUSER_CUDA_SAFE_CALL(cuFuncGetAttribute(
+        &registers, CU_FUNC_ATTRIBUTE_NUM_REGS, compiled_kernel_->function));
+    registers_per_thread_ = registers;
+  }
+
+  const int64_t smem_per_block = getStaticSmemSize() + launch_params.smem();
+  int64_t carveout = 0;
+  if (smem_per_block > 0) {
+    const int64_t threads = std::max<int64_t>(launch_params.nThreads(), 1);
+    const int64_t warps = ceilDiv(threads, prop->warpSize);
+    // Registers are allocated per warp in units of 256
+    const int64_t registers_per_warp =
+        roundUpToMultiple(registers_per_thread_.value() * prop->warpSize, 256);
+    int64_t blocks = std::min<int64_t>(
+        prop->maxBlocksPerMultiProcessor,
+        prop->maxThreadsPerMultiProcessor / threads);
+    if (registers_per_warp > 0) {
+      blocks = std::min<int64_t>(
+          blocks, prop->regsPerMultiprocessor / (registers_per_warp * warps));
+    }
+    blocks = std::min<int64_t>(
+        blocks, ceilDiv(launch_params.nBlocks(), prop->multiProcessorCount));
+    blocks = std::max<int64_t>(blocks, 1);
+    const int64_t smem_bytes =
+        blocks * (smem_per_block + (int64_t)prop->reservedSharedMemPerBlock);
+    carveout = std::min<int64_t>(
+        ceilDiv(smem_bytes * 100, (int64_t)prop->sharedMemPerMultiprocessor),
+        100);
+  }
+
+  if (preferred_smem_carveout_ != carveout) {
+    NVFUSER_CUDA_SAFE_CALL(cuFuncSetAttribute(
+        compiled_kernel_->function,
+        CU_FUNC_ATTRIBUTE_PREFERRED_SHARED_MEMORY_CARVEOUT,
+        (int)carveout));
+    preferred_smem_carveout_ = carveout;
+  }
+  return carveout;
+}
+
 void FusionExecutor::resetCompiledKernelProperties() {
   available_dynamic_smem_size_.reset();
   static_smem_size_.reset();
+  registers_per_thread_.reset();
+  preferred_smem_carveout_.reset();
 }
 
 std::vector<at::Tensor> FusionExecutor::evaluateFusionOutputs(
@@ -1854,6 +2843,9 @@ std::vector<at::Tensor> FusionExecutor::evaluateFusionOutputs(
     ExpressionEvaluator& expr_eval) {
   // TODO: Add relevant profiling code.
   if (outputs.empty()) {
+    if (matmul_epilogue_.has_value()) {
+      bindMatmulEpilogue(*matmul_epilogue_, expr_eval);
+    }
     for (const auto& out_val : fusion()->outputs()) {
       auto out_tensor =
           expr_eval.evaluate(out_val->as<TensorView>()).as<at::Tensor>();
@@ -1882,8 +2874,14 @@ std::vector<at::Tensor> FusionExecutor::runFusion(
     KernelArgumentHolder& args,
     const LaunchParams& launch_constraints,
     CompileParams compile_params,
-    std::vector<at::Tensor> outputs) {
+    std::vector<at::Tensor> outputs,
+    LaunchBuffers launch_buffers) {
   FUSER_PERF_SCOPE("FusionExecutor::runFusion");
+  inst::NvtxKernelScope nvtx_scope(nvtxKernelLabel());
+
+  const std::vector<at::Tensor>& arena_outputs = launch_buffers.outputs;
+  const std::vector<at::Tensor>& arena_intermediates =
+      launch_buffers.intermediates;
 
   if (isProfilerEnabled()) {
     NVF_CHECK(
@@ -1966,29 +2964,92 @@ std::vector<at::Tensor> FusionExecutor::runFusion(
   at::cuda::jit::initializeCudaContext();
   NVF_ERROR(lowered_);
 
-  // Placeholder for the case where parameter cache is not used
+  // Placeholder for the case where parameter cache is not used, or where the
+  // cached entry is used by a concurrent launch
   ExecutorEntry temporary_executor_entry;
 
-  ExecutorEntry* executor_entry =
-      args.getCacheId().has_value() && !disable_parameter_cache_
-      ? &executor_entry_lookup_[*args.getCacheId()]
-      : &temporary_executor_entry;
+  // The cached entry of this launch, or nullptr. Must be called with
+  // run_mutex_ held.
+  auto find_executor_entry = [&]() -> ExecutorEntry* {
+    if (disable_parameter_cache_) {
+      return nullptr;
+    }
+    if (args.getCacheId().has_value()) {
+      return &executor_entry_lookup_[*args.getCacheId()];
+    }
+    if (outputs.empty()) {
+      return getShapeKeyedEntry(args, launch_constraints);
+    }
+    return nullptr;
+  };
 
-  // Initialize the executor entry if not initlized
-  if (!executor_entry->init) {
+  // See [ Note -- Concurrent runs ] in kernel_cache.cpp
+  std::unique_lock<std::mutex> run_lock(run_mutex_);
+  ExecutorEntry* executor_entry = find_executor_entry();
+  if (executor_entry == nullptr || !executor_entry->init) {
+    // Initialized without the lock, as it evaluates the launch from scratch.
+    // The entry is looked up again, since it may have been evicted meanwhile.
+    run_lock.unlock();
     initializeExecutorEntry(
-        *executor_entry,
+        temporary_executor_entry,
         args,
         launch_constraints,
         compile_params,
         outputs,
         kernel()->indexType());
+    run_lock.lock();
+    executor_entry = find_executor_entry();
+    if (executor_entry != nullptr && !executor_entry->init) {
+      *executor_entry = temporary_executor_entry;
+    }
   }
+  if (executor_entry == nullptr || executor_entry->in_use) {
+    // A concurrent launch patches the arguments of the cached entry, so this
+    // one lays out its own
+    if (!temporary_executor_entry.init) {
+      temporary_executor_entry.init = true;
+      temporary_executor_entry.launch_params = executor_entry->launch_params;
+      temporary_executor_entry.outputs = executor_entry->outputs;
+      temporary_executor_entry.intermediates = executor_entry->intermediates;
+    }
+    executor_entry = &temporary_executor_entry;
+  } else {
+    executor_entry->in_use = true;
+  }
+  // Releases the cached entry even if the launch throws
+  struct EntryRelease {
+    std::unique_lock<std::mutex>& run_lock;
+    ExecutorEntry* entry;
+    ~EntryRelease() {
+      if (entry != nullptr) {
+        if (!run_lock.owns_lock()) {
+          run_lock.lock();
+        }
+        entry->in_use = false;
+      }
+    }
+  } entry_release{
+      run_lock,
+      executor_entry == &temporary_executor_entry ? nullptr : executor_entry};
 
   recompileKernel(executor_entry->launch_params, compile_params);
+  updateTieredCompilation(executor_entry->launch_params, compile_params);
+  CUfunction function = updateShapeSpecialization(
+      args, executor_entry->launch_params, compile_params);
+  // Keeps the module of `function` loaded if a concurrent launch recompiles
+  const std::shared_ptr<executor_utils::CompiledKernel> launched_kernels[] = {
+      compiled_kernel_, specialized_kernel_};
+  if (execute_kernel_ && !kernel()->topLevelExprs().empty()) {
+    ensureAvailableDynamicSmemSize(executor_entry->launch_params.smem());
+    if (isOptionEnabled(EnableOption::SmemCarveout)) {
+      ensurePreferredSmemCarveout(executor_entry->launch_params);
+    }
+  }
 
   // TODO: Why does this need to be stored in the class?
   launch_params_ = executor_entry->launch_params;
+  const LaunchParams launch_params = executor_entry->launch_params;
+  run_lock.unlock();
 
   // context manager to disable auto grad for `empty_cuda` calls later
   at::AutoDispatchBelowADInplaceOrView non_variable_type_mode;
@@ -1996,7 +3057,11 @@ std::vector<at::Tensor> FusionExecutor::runFusion(
   // only allocate outputs when not given
   if (outputs.empty()) {
     outputs = allocateOutputs(
-        fusion(), executor_entry->outputs, options_.device, expr_eval);
+        fusion(),
+        executor_entry->outputs,
+        options_.device,
+        expr_eval,
+        arena_outputs);
   }
   args.push(outputs);
 
@@ -2030,7 +3095,15 @@ std::vector<at::Tensor> FusionExecutor::runFusion(
         }
       }
       at::Tensor intermediate_buffer;
-      if (buf_info.zero_init) {
+      if (i < arena_intermediates.size() &&
+          arena_intermediates.at(i).defined()) {
+        intermediate_buffer = arena_intermediates.at(i);
+        if (buf_info.zero_init) {
+          intermediate_buffer.zero_();
+        } else if (shouldFillAllocationWithNan()) {
+          fillTensorWithNan(intermediate_buffer);
+        }
+      } else if (buf_info.zero_init) {
         if (isOptionEnabled(EnableOption::ReuseZeroedMemory) ||
             buf_info.resets_to_zero) {
           // Allow access to reusable zeroed memory if buffer is guaranteed
@@ -2038,7 +3111,13 @@ std::vector<at::Tensor> FusionExecutor::runFusion(
           // enabled the option (unsafe)
           intermediate_buffer = contigZeroedTensor(
               unexpanded_sizes, buf_info.type, options_.device);
+        } else if (!buf_info.is_profile_buffer) {
+          // The kernel leaves the buffer dirty, so it is zeroed again when
+          // released after the launch. See Note [Zeroed workspace pool]
+          intermediate_buffer = zeroedWorkspace(
+              unexpanded_sizes, buf_info.type, options_.device);
         } else {
+          // The profile buffer is read after the launch
           intermediate_buffer = at::zeros(
               unexpanded_sizes,
               at::TensorOptions().dtype(buf_info.type).device(options_.device));
@@ -2069,12 +3148,15 @@ std::vector<at::Tensor> FusionExecutor::runFusion(
     }
   }
 
-  if (executor_entry->args.empty()) {
+  // The arguments computed from scratch are already up to date for this
+  // launch
+  const bool args_computed = executor_entry->args.empty();
+  if (args_computed) {
     computeArgs(*executor_entry, expr_eval, kernel());
   }
 
   if (isDebugDumpEnabled(DebugDumpOption::LaunchParam)) {
-    launch_params_.print();
+    launch_params.print();
   }
 
   if (isDebugDumpEnabled(DebugDumpOption::KernelArgs)) {
@@ -2094,64 +3176,93 @@ std::vector<at::Tensor> FusionExecutor::runFusion(
   executor_utils::CudaKernelTimer timer(stream);
 
   if (execute_kernel_ && !kernel()->topLevelExprs().empty()) {
-    ensureAvailableDynamicSmemSize(executor_entry->launch_params.smem());
-
-    recomputeArgs(*executor_entry, expr_eval, kernel());
+    if (!args_computed || disable_kernel_arg_patching_) {
+      recomputeArgs(*executor_entry, expr_eval, kernel());
+    }
 
-    if (isDebugDumpEnabled(DebugDumpOption::Occupancy) ||
-        isDebugDumpEnabled(DebugDumpOption::PerfDebugVerbose)) {
-      int blocks_per_sm = -1;
-      NVFUSER_CUDA_SAFE_CALL(cuOccupancyMaxActiveBlocksPerMultiprocessor(
-          &blocks_per_sm,
-          compiled_kernel_->function,
-          launch_params_.nThreads(),
-          launch_params_.smem()));
-
-      const int64_t device_id =
-          static_cast<unsigned char>(options_.device.index());
-      const auto prop =
-          at::cuda::getDeviceProperties((c10::DeviceIndex)device_id);
-      const int64_t warps_per_sm =
-          ceilDiv(blocks_per_sm * launch_params_.nThreads(), prop->warpSize);
-
-      const int hw_max_warps =
-          prop->maxThreadsPerMultiProcessor / prop->warpSize;
-      const float occupancy = (float)warps_per_sm / (float)hw_max_warps * 100.f;
+    const bool dump_occupancy =
+        isDebugDumpEnabled(DebugDumpOption::Occupancy) ||
+        isDebugDumpEnabled(DebugDumpOption::PerfDebugVerbose);
+    if (dump_occupancy || isProfilerEnabled()) {
+      const KernelResourceUsage usage = resourceUsage(launch_params);
+      const float occupancy = (float)usage.theoretical_occupancy * 100.f;
       setKernelOccupancy(occupancy);
-      std::ostringstream oss;
-      oss << std::fixed << std::setprecision(2) << occupancy << "%";
-
-      debug() << "num_sms=" << prop->multiProcessorCount
-              << ", blocks_per_sm=" << blocks_per_sm
-              << ", warps_per_sm=" << warps_per_sm
-              << ", occupancy=" << oss.str() << std::endl;
+      if (isProfilerEnabled()) {
+        FusionProfiler::segment(group_id_).occupancy(occupancy);
+      }
+      if (dump_occupancy) {
+        std::ostringstream oss;
+        oss << std::fixed << std::setprecision(2) << occupancy << "%";
+
+        const auto prop = at::cuda::getDeviceProperties(
+            (c10::DeviceIndex)options_.device.index());
+        debug() << "num_sms=" << prop->multiProcessorCount
+                << ", blocks_per_sm=" << usage.max_active_blocks_per_sm
+                << ", warps_per_sm=" << usage.active_warps_per_sm
+                << ", occupancy=" << oss.str() << std::endl;
+      }
     }
 
-    if (!kernel()->summary().has_cooperative_grid_reduction) {
+    std::vector<RecordedLaunch>* recorded_launches = LaunchRecorder::active();
+    const bool programmatic =
+        recorded_launches == nullptr && useProgrammaticLaunch(stream);
+    const std::optional<CUaccessPolicyWindow> access_policy_window =
+        recorded_launches == nullptr
+        ? l2AccessPolicyWindow(launch_buffers.l2_window, stream, args, outputs)
+        : std::nullopt;
+    if (recorded_launches != nullptr) {
+      RecordedLaunch& launch = recorded_launches->emplace_back();
+      launch.executor = this;
+      launch.function = function;
+      launch.kernels.assign(
+          std::begin(launched_kernels), std::end(launched_kernels));
+      launch.launch_params = launch_params;
+      launch.args = executor_entry->args;
+      for (const auto& arg : args) {
+        if (arg->is<at::Tensor>()) {
+          launch.buffers.push_back(arg->as<at::Tensor>());
+        }
+      }
+    } else if (
+        kernel()->summary().has_cluster_reductions ||
+        useClusterGridSync(launch_params)) {
+      launchClusterKernel(
+          function, stream, launch_params, executor_entry->arg_ptrs.data());
+    } else if (
+        !kernel()->summary().has_cooperative_grid_reduction &&
+        (programmatic || access_policy_window.has_value())) {
+      launchKernelWithAttributes(
+          function,
+          stream,
+          launch_params,
+          executor_entry->arg_ptrs.data(),
+          programmatic,
+          access_policy_window);
+    } else if (!kernel()->summary().has_cooperative_grid_reduction) {
       FUSER_PERF_SCOPE("ExecutorRunFusion::cuLaunchKernel");
       NVFUSER_CUDA_SAFE_CALL(cuLaunchKernel(
-          compiled_kernel_->function,
-          launch_params_.gdimx(),
-          launch_params_.gdimy(),
-          launch_params_.gdimz(),
-          launch_params_.bdimx(),
-          launch_params_.bdimy(),
-          launch_params_.bdimz(),
-          launch_params_.smem(),
+          function,
+          launch_params.gdimx(),
+          launch_params.gdimy(),
+          launch_params.gdimz(),
+          launch_params.bdimx(),
+          launch_params.bdimy(),
+          launch_params.bdimz(),
+          launch_params.smem(),
           stream,
           executor_entry->arg_ptrs.data(),
           nullptr));
     } else {
       FUSER_PERF_SCOPE("ExecutorRunFusion::cuLaunchCooperativeKernel");
       NVFUSER_CUDA_SAFE_CALL(cuLaunchCooperativeKernel(
-          compiled_kernel_->function,
-          launch_params_.gdimx(),
-          launch_params_.gdimy(),
-          launch_params_.gdimz(),
-          launch_params_.bdimx(),
-          launch_params_.bdimy(),
-          launch_params_.bdimz(),
-          launch_params_.smem(),
+          function,
+          launch_params.gdimx(),
+          launch_params.gdimy(),
+          launch_params.gdimz(),
+          launch_params.bdimx(),
+          launch_params.bdimy(),
+          launch_params.bdimz(),
+          launch_params.smem(),
           stream,
           executor_entry->arg_ptrs.data()));
     }
@@ -2167,11 +3278,40 @@ std::vector<at::Tensor> FusionExecutor::runFusion(
     auto& sprof = FusionProfiler::segment(group_id_);
     sprof.stopKernel();
     sprof.outputBytesAccessed(outputBytesProcessed(outputs));
+    if (isOptionEnabled(EnableOption::KernelProfile) &&
+        !kernel()->profile().regions().empty() && profile_buffer.defined()) {
+      sprof.kernelRegions(
+          readRegionProfiles(kernel()->profile(), profile_buffer));
+    }
+    if (hasCompiledKernel()) {
+      sprof.registerSpills(compiled_kernel_->register_spills);
+    }
   }
 
   return outputs;
 }
 
+namespace {
+
+thread_local std::vector<FusionExecutor::RecordedLaunch>* active_recorder =
+    nullptr;
+
+} // namespace
+
+LaunchRecorder::LaunchRecorder(
+    std::vector<FusionExecutor::RecordedLaunch>* launches)
+    : previous_(active_recorder) {
+  active_recorder = launches;
+}
+
+LaunchRecorder::~LaunchRecorder() {
+  active_recorder = previous_;
+}
+
+std::vector<FusionExecutor::RecordedLaunch>* LaunchRecorder::active() {
+  return active_recorder;
+}
+
 int64_t FusionExecutor::inputBytesProcessed(const KernelArgumentHolder& args) {
   int64_t num_bytes = 0;
   // Figure how many bytes are inputs, outputs, and temporary buffers
@@ -2325,9 +3465,25 @@ flatbuffers::Offset<serde::FusionExecutor> FusionExecutor::serialize(
 flatbuffers::Offset<serde::CudaKernel> FusionExecutor::serialize(
     flatbuffers::FlatBufferBuilder& builder,
     const executor_utils::CompiledKernel* compiled_kernel) const {
+  // A kernel deserialized in place reads its binaries from the buffer
+  const serde::CudaKernel* in_place = compiled_kernel->serde_buffer;
+  const char* cubin = compiled_kernel->cubin.data();
+  size_t cubin_size = compiled_kernel->cubin.size();
+  const char* ptx = compiled_kernel->ptx.data();
+  size_t ptx_size = compiled_kernel->ptx.size();
+  if (in_place != nullptr) {
+    cubin_size = in_place->cubin() == nullptr ? 0 : in_place->cubin()->size();
+    cubin = cubin_size == 0
+        ? nullptr
+        : reinterpret_cast<const char*>(in_place->cubin()->data());
+    ptx_size = in_place->ptx() == nullptr ? 0 : in_place->ptx()->size();
+    ptx = ptx_size == 0
+        ? nullptr
+        : reinterpret_cast<const char*>(in_place->ptx()->data());
+  }
+
   NVF_ERROR(
-      compiled_kernel_ != nullptr &&
-          (!compiled_kernel->cubin.empty() || !compiled_kernel->ptx.empty()),
+      compiled_kernel_ != nullptr && (cubin_size > 0 || ptx_size > 0),
       "Expected compiled cuda kernel before serializing FusionExecutor.");
 
   auto fb_kernel_name = builder.CreateString(compiled_kernel->kernel_name);
@@ -2335,25 +3491,22 @@ flatbuffers::Offset<serde::CudaKernel> FusionExecutor::serialize(
 
   flatbuffers::Offset<flatbuffers::Vector<uint8_t>> fb_cubin = 0;
   flatbuffers::Offset<flatbuffers::String> fb_cubin_filename = 0;
-  if (!compiled_kernel->cubin.empty()) {
+  if (cubin_size > 0) {
+    // Align the cubin so that it can be loaded in place from a mapped buffer.
+    // See [ Note -- Shared workspace ] in python_frontend/fusion_cache.cpp.
+    builder.ForceVectorAlignment(cubin_size, sizeof(uint8_t), 16);
     uint8_t* cubin_ptr = nullptr;
-    fb_cubin = builder.CreateUninitializedVector(
-        compiled_kernel->cubin.size(), &cubin_ptr);
-    std::copy(
-        compiled_kernel->cubin.begin(),
-        compiled_kernel->cubin.end(),
-        cubin_ptr);
+    fb_cubin = builder.CreateUninitializedVector(cubin_size, &cubin_ptr);
+    std::copy(cubin, cubin + cubin_size, cubin_ptr);
     fb_cubin_filename = builder.CreateString(compiled_kernel->cubin_filename);
   }
 
   flatbuffers::Offset<flatbuffers::Vector<uint8_t>> fb_ptx = 0;
   flatbuffers::Offset<flatbuffers::String> fb_ptx_filename = 0;
-  if (!compiled_kernel->ptx.empty()) {
+  if (ptx_size > 0) {
     uint8_t* ptx_ptr = nullptr;
-    fb_ptx = builder.CreateUninitializedVector(
-        compiled_kernel->ptx.size(), &ptx_ptr);
-    std::copy(
-        compiled_kernel->ptx.begin(), compiled_kernel->ptx.end(), ptx_ptr);
+    fb_ptx = builder.CreateUninitializedVector(ptx_size, &ptx_ptr);
+    std::copy(ptx, ptx + ptx_size, ptx_ptr);
     fb_ptx_filename = builder.CreateString(compiled_kernel->ptx_filename);
   }
 
@@ -2447,7 +3600,8 @@ void FusionExecutor::deserialize(
     int64_t fusion_id,
     int64_t concrete_id,
     int64_t runtime_id,
-    int64_t group_id) {
+    int64_t group_id,
+    bool in_place) {
   // See table definition for FusionExecutor in serde/fusion_cache.fbs
 
   NVF_ERROR(buffer != nullptr, "serde::FusionExecutor is nullptr.");
@@ -2456,6 +3610,7 @@ void FusionExecutor::deserialize(
   // skip compilation?
   if (isExpressionEvaluated(fusion)) {
     fusion_ = std::make_unique<Fusion>(*fusion);
+    matmul_epilogue_ = matchMatmulEpilogue(fusion_.get());
     NVF_ERROR(!hasCompiledKernel(), "Failed to deserialize FusionExecutor");
     return;
   }
@@ -2515,8 +3670,15 @@ void FusionExecutor::deserialize(
         deserialize(buffer->executor_entry_lookup_values()->Get(idx)));
   }
 
+  // A first tier kernel of tiered compilation is restored as such, since its
+  // compile args are checked against the regenerated ones
+  const std::string compile_args =
+      buffer->compiled_kernel()->compile_args()->str();
+  compile_params.fast_compile =
+      compile_args.find("--ptxas-options -O1") != std::string::npos;
+  fast_compiled_ = compile_params.fast_compile;
   compiled_kernel_ = executor_utils::getCompiledKernel(
-      buffer->compiled_kernel(), compile_params);
+      buffer->compiled_kernel(), compile_params, in_place);
 
   NVF_ERROR(hasCompiledKernel(), "Failed to deserialize FusionExecutor");
 }
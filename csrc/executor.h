@@ -13,10 +13,12 @@
 #include <expr_evaluator.h>
 #include <fusion.h>
 #include <host_ir/container.h>
+#include <instrumentation.h>
 #include <ir/all_nodes.h>
 #include <ir/cloner.h>
 #include <ir/printer.h>
 #include <multidevice/communicator.h>
+#include <scheduler/expr_eval_sched.h>
 #include <scheduler/heuristic_types.h>
 #include <serde/fusion_cache_generated.h>
 #include <utils.h>
@@ -25,6 +27,10 @@
 #include <c10/core/DeviceType.h>
 
 #include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
 
 namespace nvfuser {
 
@@ -44,6 +50,30 @@ std::vector<at::Tensor> allocOutputSpace(
     Fusion* fusion,
     const c10::Device& device);
 
+//! Resources used by a compiled kernel, as reported by cuFuncGetAttribute,
+//! and the occupancy they allow for a set of launch parameters. See
+//! FusionExecutor::resourceUsage.
+struct KernelResourceUsage {
+  std::string kernel_name;
+  int64_t registers_per_thread = 0;
+  int64_t static_smem_bytes = 0;
+  //! Dynamic shared memory of the launch parameters
+  int64_t dynamic_smem_bytes = 0;
+  //! Local memory per thread, i.e. register spills and local arrays
+  int64_t local_memory_bytes = 0;
+  //! Largest block the kernel can be launched with given its resources
+  int64_t max_threads_per_block = 0;
+  //! Threads per block of the launch parameters
+  int64_t threads_per_block = 0;
+  //! From cuOccupancyMaxActiveBlocksPerMultiprocessor
+  int64_t max_active_blocks_per_sm = 0;
+  int64_t active_warps_per_sm = 0;
+  //! Active warps over the maximum warps of an SM, in [0, 1]
+  double theoretical_occupancy = 0.0;
+
+  NVF_API std::string toString() const;
+};
+
 class FusionExecutor : public NonCopyable {
  public:
   struct GlobalBufferInfo {
@@ -116,17 +146,86 @@ class FusionExecutor : public NonCopyable {
         concrete_id);
   }
 
+  //! What compileFusion leaves for the NVRTC compilation of a deferred kernel
+  struct PendingCompilation {
+    std::string structured_code;
+    CompileParams compile_params;
+    std::optional<int64_t> block_size;
+    std::optional<int64_t> dynamic_smem;
+    int64_t group_id = -1;
+  };
+
+  //! Make the next compileFusion stop before compiling the generated kernel,
+  //! so that it can be batched with the kernels of other executors. See
+  //! [ Note -- Batched compilation ] in kernel_cache.cpp
+  void deferKernelCompilation() {
+    defer_kernel_compilation_ = true;
+  }
+
+  //! The compilation deferred by compileFusion, if any
+  const std::optional<PendingCompilation>& pendingCompilation() const {
+    return pending_compilation_;
+  }
+
+  //! Load the kernel of a deferred compilation. If compiled_kernel is null,
+  //! the kernel is compiled on its own.
+  void finishCompilation(
+      std::unique_ptr<executor_utils::CompiledKernel> compiled_kernel =
+          nullptr);
+
   //! Computes fusion outputs through expression evaluator.
   std::vector<at::Tensor> evaluateFusionOutputs(
       KernelArgumentHolder& args,
       std::vector<at::Tensor> outputs,
       ExpressionEvaluator& expr_eval);
 
+  //! An input or output of the kernel given an L2 access policy window, see
+  //! [ Note -- L2 persistence of segment handoffs ] in kernel_cache.cpp
+  struct L2Window {
+    //! Position in the inputs or in the outputs of the kernel
+    int64_t index = -1;
+    //! An output is kept in the persisting L2 lines for the next kernel. An
+    //! input, kept by the previous kernel, is reset to normal lines.
+    bool is_output = true;
+  };
+
+  //! What FusionKernelRuntime hands to a single launch. They are given to
+  //! runFusion rather than stored in the executor, so that concurrent
+  //! launches don't see each other's. See [ Note -- Concurrent runs ] in
+  //! kernel_cache.cpp.
+  struct LaunchBuffers {
+    //! Used for the outputs and intermediates instead of allocating them.
+    //! They are indexed like the GlobalBufferInfo lists of the ExecutorEntry
+    //! of the launch, and undefined tensors are allocated as usual. Also used
+    //! to write fusion outputs to buffers given by the caller, which must
+    //! have the dtype, sizes and strides that would have been allocated. See
+    //! IntermediateArena.
+    std::vector<at::Tensor> outputs;
+    std::vector<at::Tensor> intermediates;
+    //! Tensor given an L2 access policy window, if any
+    std::optional<L2Window> l2_window = std::nullopt;
+  };
+
+  //! A launch runFusion recorded instead of issuing it, see LaunchRecorder
+  struct RecordedLaunch {
+    const FusionExecutor* executor = nullptr;
+    CUfunction function = nullptr;
+    //! Keep the module of `function` loaded until the launch
+    std::vector<std::shared_ptr<executor_utils::CompiledKernel>> kernels;
+    LaunchParams launch_params;
+    //! Copy of the kernel arguments, laid out like ExecutorEntry::args
+    std::vector<std::vector<std::byte>> args;
+    //! Inputs, outputs and intermediates the arguments point to. They are
+    //! kept alive so that their memory is not reused before the launch.
+    std::vector<at::Tensor> buffers;
+  };
+
   NVF_API std::vector<at::Tensor> runFusion(
       KernelArgumentHolder& args,
       const LaunchParams& launch_constraints = LaunchParams(),
       CompileParams compile_params = CompileParams(),
-      std::vector<at::Tensor> outputs = {});
+      std::vector<at::Tensor> outputs = {},
+      LaunchBuffers launch_buffers = {});
 
   std::vector<at::Tensor> runFusion(
       const at::ArrayRef<c10::IValue>& inputs,
@@ -184,6 +283,7 @@ class FusionExecutor : public NonCopyable {
   };
 
   void evictCache(size_t cache_id) {
+    std::lock_guard<std::mutex> guard(run_mutex_);
     executor_entry_lookup_.erase(cache_id);
   }
 
@@ -195,6 +295,8 @@ class FusionExecutor : public NonCopyable {
   //
   struct ExecutorEntry {
     bool init = false;
+    // Set while a launch patches `args`, guarded by run_mutex_
+    bool in_use = false;
     LaunchParams launch_params;
     std::vector<GlobalBufferInfo> outputs;
     // Temporary work buffers and intemediate global-memory tensors
@@ -210,8 +312,20 @@ class FusionExecutor : public NonCopyable {
     // This is just the data() pointers to the above `args`; cuLaunchKernel
     // requires an array of this form.
     std::vector<void*> arg_ptrs;
+    // Whether each element of `args` is a `struct Tensor`. The shapes and
+    // strides of these are fixed for a given entry, so after computeArgs has
+    // laid them out, recomputeArgs only patches their data pointers.
+    std::vector<bool> tensor_args;
   };
 
+  //! Returns the launch state cached for the given input id, or nullptr if
+  //! the executor has not been launched with it yet
+  const ExecutorEntry* getExecutorEntry(size_t cache_id) const {
+    std::lock_guard<std::mutex> guard(run_mutex_);
+    auto it = executor_entry_lookup_.find(cache_id);
+    return it == executor_entry_lookup_.end() ? nullptr : &it->second;
+  }
+
   using ExecutorCompileTimeInfoCache =
       executor_utils::caching::ExecutorCompileTimeInfoCache;
 
@@ -255,6 +369,12 @@ class FusionExecutor : public NonCopyable {
     kernel_occupancy_ = occupancy;
   }
 
+  //! Returns the resources used by the compiled kernel and the occupancy
+  //! they allow when launched with `launch_params`, by default the launch
+  //! parameters of the last run
+  NVF_API KernelResourceUsage
+  resourceUsage(std::optional<LaunchParams> launch_params = std::nullopt);
+
   //! get register spills (load + store) of the compiled kernel
   int getKernelRegisterSpills() const {
     return compiled_kernel_->register_spills;
@@ -289,17 +409,29 @@ class FusionExecutor : public NonCopyable {
     return *compiled_kernel_;
   }
 
+  //! Whether the loaded kernel is the low optimization first tier of
+  //! EnableOption::TieredCompile, still waiting to be replaced
+  bool isFastCompiled() const {
+    return fast_compiled_;
+  }
+
+  //! The variant of the kernel specialized on the input shapes of its hot
+  //! launches with EnableOption::ShapeSpecialization, or nullptr
+  const executor_utils::CompiledKernel* shapeSpecializedKernel() const {
+    return specialized_kernel_.get();
+  }
+
   //! Returns the disassembled latest compiled binary
   NVF_API std::string disassembledBinary(
       const std::string& nvdisasm_args = "") const {
     return executor_utils::disassembleBinary(
-        compiled_kernel_->cubin, nvdisasm_args);
+        compiled_kernel_->cubinCopy(), nvdisasm_args);
   }
 
   //! Returns the disassembled latest compiled binary
   NVF_API std::string disassembledKernelSASS() const {
     return executor_utils::disassembleBinary(
-        compiled_kernel_->cubin, "-fun 1 -c");
+        compiled_kernel_->cubinCopy(), "-fun 1 -c");
   }
 
   static void setGlobalFusionCount(int64_t new_fusion_count) {
@@ -382,11 +514,18 @@ class FusionExecutor : public NonCopyable {
     disable_parameter_cache_ = true;
   }
 
+  //! Internal knob used for profiling only. Rebuilds all kernel arguments on
+  //! every launch instead of patching the data pointers of tensors.
+  void disableKernelArgPatching() {
+    disable_kernel_arg_patching_ = true;
+  }
+
   //! Serialize Fusion Executor using flatbuffers
   flatbuffers::Offset<serde::FusionExecutor> serialize(
       flatbuffers::FlatBufferBuilder& builder) const;
 
-  //! Deserialize Fusion Executor using flatbuffers
+  //! Deserialize Fusion Executor using flatbuffers. If in_place, the kernel
+  //! binary is not copied out of the buffer, which must outlive the executor.
   void deserialize(
       const serde::FusionExecutor* buffer,
       Fusion* fusion,
@@ -396,7 +535,8 @@ class FusionExecutor : public NonCopyable {
       int64_t fusion_id,
       int64_t concrete_id,
       int64_t runtime_id,
-      int64_t group_id);
+      int64_t group_id,
+      bool in_place = false);
 
  private:
   LaunchParams computeLaunchParams(
@@ -428,6 +568,13 @@ class FusionExecutor : public NonCopyable {
     return &compile_time_info_cache_;
   }
 
+  //! Returns the entry kept for launches without a cache id that have the
+  //! same argument shapes and launch constraints, or nullptr if the arguments
+  //! can't be encoded. See Note [Shape-keyed executor entries]
+  ExecutorEntry* getShapeKeyedEntry(
+      const KernelArgumentHolder& args,
+      const LaunchParams& launch_constraints);
+
   //! TODO: Consider changing this to a constructor of ExecutorEntry
   void initializeExecutorEntry(
       ExecutorEntry& executor_entry,
@@ -444,12 +591,28 @@ class FusionExecutor : public NonCopyable {
   void recompileKernel(
       const LaunchParams& new_launch_params,
       const CompileParams& new_compile_params);
+
+  // Start the fully optimized recompilation of a fast compiled kernel once it
+  // has been launched often enough, and swap it in when it is ready
+  void updateTieredCompilation(
+      const LaunchParams& launch_params,
+      const CompileParams& compile_params);
+
+  // Start the compilation of a variant specialized on the input shapes once
+  // the same shapes have been launched often enough, and return the function
+  // to launch with the given inputs
+  CUfunction updateShapeSpecialization(
+      const KernelArgumentHolder& args,
+      const LaunchParams& launch_params,
+      const CompileParams& compile_params);
+
   // Creates the initial set of arguments to a kernel, based on the arguments
   // to we have now.
   void computeArgs(ExecutorEntry&, ExpressionEvaluator&, const kir::Kernel*)
       const;
   // Updates an existing set of arguments based on the current arguments. It is
-  // is an error to call this before `computeArgs` has been invoked.
+  // is an error to call this before `computeArgs` has been invoked. Only the
+  // data pointers of tensor arguments and the scalar arguments are rewritten.
   // recomputeArgs will fail if the arity of the function changes, or the rank
   // of any tensor changes (as these are compiled-in to the generated kernel
   // and therefore would require us to do a larger recompilation).
@@ -498,9 +661,60 @@ class FusionExecutor : public NonCopyable {
   //! the given size
   int64_t ensureAvailableDynamicSmemSize(int64_t dynamic_smem_size);
 
+  //! Set the preferred shared memory carveout of the compiled kernel for
+  //! `launch_params`. Returns the carveout in percent of the maximum shared
+  //! memory of an SM.
+  NVF_API int64_t ensurePreferredSmemCarveout(
+      const LaunchParams& launch_params);
+
   //! Clear the cached properties of the compiled kernel
   void resetCompiledKernelProperties();
 
+  //! Returns the label of the NVTX ranges of the launches of the kernel, or
+  //! null if NVTX ranges are not recorded. The message is the kernel name
+  //! followed by its ids and heuristic, the category is the heuristic and
+  //! the payload packs the ids as
+  //!   fusion_id << 32 | runtime_id << 16 | group_id
+  //! for tools filtering ranges by value.
+  const inst::NvtxKernelLabel* nvtxKernelLabel();
+
+  //! Whether the grid syncs of a cooperative kernel can use cluster barriers
+  //! with the given launch parameters, in which case the kernel is launched
+  //! with launchClusterKernel instead of cuLaunchCooperativeKernel
+  bool useClusterGridSync(const LaunchParams& launch_params) const;
+
+  //! Launch the compiled kernel with thread block clusters spanning
+  //! gridDim.x, as required by cluster reductions and cluster grid syncs
+  void launchClusterKernel(
+      CUfunction function,
+      CUstream stream,
+      const LaunchParams& launch_params,
+      void** arg_ptrs);
+
+  //! Whether the compiled kernel can be launched on `stream` with
+  //! programmatic dependent launch
+  bool useProgrammaticLaunch(CUstream stream) const;
+
+  //! The access policy window of the input or output of `l2_window`, if it
+  //! can be given one at this launch
+  std::optional<CUaccessPolicyWindow> l2AccessPolicyWindow(
+      const std::optional<L2Window>& l2_window,
+      CUstream stream,
+      const KernelArgumentHolder& args,
+      const std::vector<at::Tensor>& outputs) const;
+
+  //! Launch the compiled kernel with cuLaunchKernelEx. With `programmatic`,
+  //! it starts while the previous kernel of the stream finishes. With
+  //! `access_policy_window`, the L2 cache lines of the window are given its
+  //! access properties.
+  void launchKernelWithAttributes(
+      CUfunction function,
+      CUstream stream,
+      const LaunchParams& launch_params,
+      void** arg_ptrs,
+      bool programmatic,
+      const std::optional<CUaccessPolicyWindow>& access_policy_window);
+
  private:
   CompileOptions options_;
 
@@ -514,6 +728,13 @@ class FusionExecutor : public NonCopyable {
   //!  compiled kernel at the current shared memory/L1 configuration
   std::optional<int64_t> available_dynamic_smem_size_ = std::nullopt;
 
+  //! Registers per thread of the current compiled kernel
+  std::optional<int64_t> registers_per_thread_ = std::nullopt;
+
+  //! Preferred shared memory carveout last set on the current compiled
+  //! kernel, in percent
+  std::optional<int64_t> preferred_smem_carveout_ = std::nullopt;
+
   // Assuming sm70 or above:
   //  limit of statically allocated smem is 48 KB:
   // See:
@@ -522,7 +743,9 @@ class FusionExecutor : public NonCopyable {
   const int64_t max_static_smem_ = 48 << 10;
 
   int64_t warp_size_ = 0;
-  std::unique_ptr<executor_utils::CompiledKernel> compiled_kernel_;
+  // Shared with the launches in flight, which keep it loaded if a concurrent
+  // launch recompiles the kernel
+  std::shared_ptr<executor_utils::CompiledKernel> compiled_kernel_;
 
   // TensorViews actually used in the kernel.
   std::vector<TensorView*> used_tvs_;
@@ -548,11 +771,19 @@ class FusionExecutor : public NonCopyable {
   // Kernel name for fusion executor
   std::string kernel_id_;
 
+  // Label of the NVTX ranges of the launches, registered on the first launch
+  // when NVTX ranges are recorded. See nvtxKernelLabel.
+  std::optional<inst::NvtxKernelLabel> nvtx_kernel_label_;
+
   std::unique_ptr<GpuLower> lowered_;
 
   // Initialized for non-compiled fusions
   std::unique_ptr<Fusion> fusion_;
 
+  // Matmul and epilogue of a non-compiled fusion run as one ATen call, see
+  // Note [Matmul epilogues] in scheduler/expr_eval_sched.cpp
+  std::optional<MatmulEpilogue> matmul_epilogue_;
+
   std::unique_ptr<hir::HostIrContainer> host_ir_container_;
 
   // Track the block size this kernel was compiled with. If the block size
@@ -560,18 +791,28 @@ class FusionExecutor : public NonCopyable {
   int64_t block_size_high_water_mark_ = 1;
   int64_t maxrregcount_high_water_mark_ = 255;
 
+  // Guards the executor entries and the compiled kernels while runFusion picks
+  // them, see [ Note -- Concurrent runs ] in kernel_cache.cpp
+  mutable std::mutex run_mutex_;
+
   // lookup table to take short cut to retrieve recorded information in order to
   // launch kernels without re-inference parameters.
   std::unordered_map<size_t, ExecutorEntry> executor_entry_lookup_;
 
+  // Same as executor_entry_lookup_ for launches without a cache id, keyed by
+  // the shapes of the arguments. See Note [Shape-keyed executor entries]
+  static constexpr int64_t kMaxShapeKeyedEntries = 100;
+  std::map<std::vector<int64_t>, ExecutorEntry> shape_keyed_entries_;
+
   // Compile time information caching. This is used for shape inference
   //  support. The cache stores graph information that are available
   //  without shape information so that each shape inference call will
   //  not need to re-compute them.
   ExecutorCompileTimeInfoCache compile_time_info_cache_;
 
-  // Cached expr eval
+  // Cached expr eval, used by one initializeExecutorEntry at a time
   std::unique_ptr<PrecomputedValues> evaluator_precomputed_values_ = nullptr;
+  std::mutex precomputed_values_mutex_;
 
   // Profiling support: knob to control wheter we actually execute the
   // kernel on the GPU or not
@@ -590,6 +831,13 @@ class FusionExecutor : public NonCopyable {
   // https://github.com/csarofeen/pytorch/issues/2002
   bool disable_parameter_cache_ = false;
 
+  // Profiling support: rebuild kernel arguments from scratch on each launch
+  bool disable_kernel_arg_patching_ = false;
+
+  // Set by deferKernelCompilation
+  bool defer_kernel_compilation_ = false;
+  std::optional<PendingCompilation> pending_compilation_;
+
   // Profiling support: kept copy of the cuda kernel
   std::string kernel_code_;
 
@@ -603,6 +851,45 @@ class FusionExecutor : public NonCopyable {
   std::vector<std::function<void(kir::Kernel*)>> post_lowering_hooks_;
 
   Communicator* communicator_;
+
+  // Whether the code of the compiled kernel waits for the grid it depends on,
+  // see Note [Programmatic dependent launch] in executor.cpp. Deserialized
+  // kernels are launched without programmatic dependent launch, as their
+  // binaries might not wait.
+  bool programmatic_launch_ = false;
+
+  // Tiered compilation state, see [ Note -- Tiered compilation ]
+  bool fast_compiled_ = false;
+  int64_t num_fast_launches_ = 0;
+  // Shape specialization state, see [ Note -- Shape specialization ]
+  std::vector<int64_t> hot_shapes_;
+  int64_t num_hot_shape_launches_ = 0;
+  std::shared_ptr<executor_utils::CompiledKernel> specialized_kernel_;
+  int64_t specialized_dynamic_smem_size_ = 0;
+  // Declared last so that they are destroyed, and pending compilations
+  // waited for, before anything else
+  std::future<std::unique_ptr<executor_utils::CompiledKernel>>
+      optimized_kernel_;
+  std::future<std::unique_ptr<executor_utils::CompiledKernel>>
+      pending_specialized_kernel_;
+};
+
+//! While a LaunchRecorder is alive, FusionExecutor::runFusion allocates the
+//! outputs and intermediates of the kernels run on the same thread as usual,
+//! but appends their launches to `launches` instead of issuing them. Used to
+//! run the kernels of all segments of a fusion as one megakernel, see
+//! [ Note -- Megakernel ] in megakernel.cpp.
+class LaunchRecorder : public NonCopyable {
+ public:
+  explicit LaunchRecorder(
+      std::vector<FusionExecutor::RecordedLaunch>* launches);
+  ~LaunchRecorder();
+
+  //! Launches recorded by the innermost recorder of this thread, or nullptr
+  static std::vector<FusionExecutor::RecordedLaunch>* active();
+
+ private:
+  std::vector<FusionExecutor::RecordedLaunch>* previous_ = nullptr;
 };
 
 } // namespace nvfuser
@@ -59,6 +59,8 @@ PolymorphicValue IValueToPolymorphicValue(const c10::IValue& val) {
   }
 }
 
+} // namespace
+
 PrimDataType getSmallestIndexType(const at::Tensor& tensor) {
   KernelIndexTypeCompute index_type_helper;
   for (const auto dim_i : c10::irange(tensor.ndimension())) {
@@ -71,7 +73,9 @@ PrimDataType getSmallestIndexType(const at::Tensor& tensor) {
   return PrimDataType::Int32;
 }
 
-} // namespace
+bool isInputDataRead(const TensorView* tv) {
+  return !tv->uses().empty() || tv->isFusionOutput();
+}
 
 void KernelArgumentHolder::push(const c10::ArrayRef<c10::IValue>& args) {
   // Naive I/O setup, I'm ignoring all the potential transformation (i.e. I/O
@@ -115,6 +119,26 @@ PrimDataType KernelArgumentHolder::getSmallestIndexTypeOfArguments() const {
   return PrimDataType::Int32;
 }
 
+PrimDataType KernelArgumentHolder::getSmallestIndexTypeOfArguments(
+    const std::vector<Val*>& inputs) const {
+  for (const auto i : c10::irange(arguments_.size())) {
+    const auto& arg = arguments_[i];
+    if (!arg->is<at::Tensor>()) {
+      continue;
+    }
+    if (i < inputs.size()) {
+      auto tv = dynamic_cast<TensorView*>(inputs[i]);
+      if (tv != nullptr && !isInputDataRead(tv)) {
+        continue;
+      }
+    }
+    if (getSmallestIndexType(arg->as<at::Tensor>()) == PrimDataType::Int) {
+      return PrimDataType::Int;
+    }
+  }
+  return PrimDataType::Int32;
+}
+
 void KernelArgumentHolder::pushTensorProxy(
     const std::vector<int64_t>& sizes,
     const std::vector<int64_t>& strides,
@@ -130,6 +154,21 @@ void KernelArgumentHolder::pushTensorProxy(
   push(meta_tensor);
 }
 
+void KernelArgumentHolder::pushTensor(
+    void* data,
+    const std::vector<int64_t>& sizes,
+    const std::vector<int64_t>& strides,
+    at::ScalarType dtype) {
+  NVF_ERROR(strides.size() == sizes.size());
+  NVF_CHECK(data != nullptr, "The data of a tensor argument is null");
+  push(at::from_blob(
+      data,
+      sizes,
+      strides,
+      at::TensorOptions().dtype(dtype).device(
+          c10::Device(c10::DeviceType::CUDA, device_index_))));
+}
+
 flatbuffers::Offset<serde::KernelArgumentHolder> KernelArgumentHolder::
     serialize(flatbuffers::FlatBufferBuilder& builder) const {
   // See table definitions for KernelArgumentHolder and PolymorphicValue
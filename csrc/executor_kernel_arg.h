@@ -22,6 +22,13 @@
 
 namespace nvfuser {
 
+//! Smallest index type that can hold the offsets of all elements of `tensor`
+NVF_API PrimDataType getSmallestIndexType(const at::Tensor& tensor);
+
+//! Whether the data of the fusion input `tv` is read by the fusion. Inputs
+//! that only provide extents to other tensors are never indexed.
+NVF_API bool isInputDataRead(const TensorView* tv);
+
 //! KernelArgumentHolder copies meta information from kernel inputs, including
 //! tensor sizes/shapes/dtype/memory_ptr and copies scalar inputs. It is used
 //! for both compilation as well as kernel execution. The important thing is to
@@ -41,12 +48,26 @@ class KernelArgumentHolder {
   //! arguments. It does not consider any other tensors used in a kernel.
   NVF_API PrimDataType getSmallestIndexTypeOfArguments() const;
 
+  //! Same as above, but ignores the tensors whose data is never read by the
+  //! fusion with inputs `inputs`, which are bound to the arguments in order
+  NVF_API PrimDataType
+  getSmallestIndexTypeOfArguments(const std::vector<Val*>& inputs) const;
+
   // Push a tensor proxy to the arguments
   void pushTensorProxy(
       const std::vector<int64_t>& sizes,
       const std::vector<int64_t>& strides,
       at::ScalarType dtype);
 
+  //! Push a tensor viewing `data`, which is memory of the device of this
+  //! holder. The memory is not owned by the tensor, so it must outlive the
+  //! holder and the execution of the fusion.
+  NVF_API void pushTensor(
+      void* data,
+      const std::vector<int64_t>& sizes,
+      const std::vector<int64_t>& strides,
+      at::ScalarType dtype);
+
   NVF_API void push(const c10::ArrayRef<c10::IValue>& args);
 
   NVF_API void push(const std::vector<at::Tensor>& tensors);
@@ -22,7 +22,8 @@ std::string CompileParams::toString() const {
   }
   ss << "maxrregcount = " << maxrregcount << ", "
      << "enable_magic_zero = " << enable_magic_zero << ", "
-     << "enable_ptxas_verbose = " << enable_ptxas_verbose << "\n";
+     << "enable_ptxas_verbose = " << enable_ptxas_verbose << ", "
+     << "fast_compile = " << fast_compile << "\n";
   return ss.str();
 }
 
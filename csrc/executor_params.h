@@ -21,6 +21,10 @@ struct CompileParams {
   bool enable_magic_zero = true;
   // if true, save ptxas info to compile log and check for register spilling
   bool enable_ptxas_verbose = false;
+  // if true, lower the ptxas optimization level to cut compile time. Used by
+  // the first tier of EnableOption::TieredCompile. Like enable_ptxas_verbose,
+  // it does not change the semantics of the kernel and is not compared.
+  bool fast_compile = false;
 
   bool operator==(const CompileParams& other) const {
     // Disallow comparison if the index type is nullopt
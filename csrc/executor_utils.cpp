@@ -9,6 +9,7 @@
 #include <ATen/cuda/CUDAGeneratorImpl.h>
 #include <ATen/native/cuda/jit_utils.h>
 
+#include <c10/cuda/CUDAFunctions.h>
 #include <c10/util/irange.h>
 
 #include <contiguity.h>
@@ -19,6 +20,7 @@
 #include <ir/all_nodes.h>
 #include <ir/iostream.h>
 #include <ir/utils.h>
+#include <kernel_db/compile_server.h>
 #include <kernel_db/kernel_db.h>
 #include <options.h>
 #include <tensor_metadata.h>
@@ -35,6 +37,7 @@
 #include <nvfuser_resources/block_sync_default.h>
 #include <nvfuser_resources/block_welford_outer.h>
 #include <nvfuser_resources/broadcast.h>
+#include <nvfuser_resources/cluster.h>
 #include <nvfuser_resources/complex_number.h>
 #include <nvfuser_resources/fp16_support.h>
 #include <nvfuser_resources/fp8_support.h>
@@ -50,14 +53,23 @@
 #include <nvfuser_resources/mbarrier.h>
 #include <nvfuser_resources/memory.h>
 #include <nvfuser_resources/random_numbers.h>
+#include <nvfuser_resources/scan.h>
+#include <nvfuser_resources/sort.h>
 #include <nvfuser_resources/tensor.h>
 #include <nvfuser_resources/tuple.h>
 #include <nvfuser_resources/type_traits.h>
 #include <nvfuser_resources/warp.h>
 #include <nvfuser_resources/welford.h>
 
+#include <algorithm>
+#include <array>
+#include <cctype>
 #include <cstdlib>
+#include <cstring>
 #include <fstream>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
 #include <variant>
 
 #include <nvrtc.h>
@@ -65,7 +77,25 @@
 namespace nvfuser {
 namespace executor_utils {
 
-std::string kernelPreamble() {
+// [ Note -- Lean preamble ]
+//
+// NVRTC parses the whole preamble for every kernel, and most of it is the
+// runtime of block and grid communication: reductions, welfords, broadcasts,
+// scans, sorts and grid syncs, along with the tuples of fused reductions.
+// Pointwise kernels, and the other kernels whose threads do not communicate,
+// call none of it. With EnableOption::LeanPreamble, such kernels are compiled
+// with a preamble leaving it out, which cuts the code NVRTC parses for them
+// to about a third. A kernel fits the lean preamble when its code names none of the
+// namespaces and functions of the left-out files, so a kernel that would not
+// compile with it keeps the full preamble.
+//
+// Both preambles are recognized by kernelBegin, so the lean preamble gets its
+// own precompiled header with EnableOption::NvrtcPch, and batched kernels
+// are grouped by preamble.
+
+namespace {
+
+std::string buildKernelPreamble(bool lean, bool block_sync_atomic) {
   std::stringstream ss;
   ss << nvfuser_resources::basic_type_traits_cu;
   ss << nvfuser_resources::bit_cu;
@@ -82,21 +112,30 @@ std::string kernelPreamble() {
   ss << nvfuser_resources::random_numbers_cu;
   ss << nvfuser_resources::helpers_cu;
   ss << nvfuser_resources::index_utils_cu;
-  ss << nvfuser_resources::tuple_cu;
+  if (!lean) {
+    ss << nvfuser_resources::tuple_cu;
+  }
 
   // Synchronization classes
-  if (getNvFuserEnv("USE_BLOCK_SYNC_ATOMIC")) {
+  if (block_sync_atomic) {
     ss << nvfuser_resources::block_sync_atomic_cu;
   } else {
     ss << nvfuser_resources::block_sync_default_cu;
   }
+  if (lean) {
+    ss << nvfuser_resources::memory_cu;
+    return ss.str();
+  }
   ss << nvfuser_resources::grid_sync_cu;
   ss << nvfuser_resources::mbarrier_cu;
 
   // Communication classes
   ss << nvfuser_resources::block_reduction_cu;
+  ss << nvfuser_resources::cluster_cu;
   ss << nvfuser_resources::grid_reduction_cu;
   ss << nvfuser_resources::grid_broadcast_cu;
+  ss << nvfuser_resources::scan_cu;
+  ss << nvfuser_resources::sort_cu;
   ss << nvfuser_resources::broadcast_cu;
   ss << nvfuser_resources::welford_cu;
   ss << nvfuser_resources::warp_cu;
@@ -110,6 +149,136 @@ std::string kernelPreamble() {
   return ss.str();
 }
 
+} // namespace
+
+const std::string& kernelPreamble(bool lean) {
+  // The preamble is a few hundred KB of text needed by every kernel compiled
+  // and every kernelBegin, so it is concatenated once, on first use, for each
+  // combination of lean and NVFUSER_USE_BLOCK_SYNC_ATOMIC, which may be
+  // changed between kernels. See [ Note -- Lazy initialization ] in
+  // options.cpp
+  static std::mutex mutex;
+  static std::array<std::unique_ptr<const std::string>, 4> preambles;
+  const bool block_sync_atomic =
+      getNvFuserEnv("USE_BLOCK_SYNC_ATOMIC") != nullptr;
+  auto& preamble = preambles.at((size_t)lean * 2 + (size_t)block_sync_atomic);
+  std::lock_guard<std::mutex> lock(mutex);
+  if (preamble == nullptr) {
+    preamble = std::make_unique<const std::string>(
+        buildKernelPreamble(lean, block_sync_atomic));
+  }
+  return *preamble;
+}
+
+bool fitsLeanPreamble(const std::string& kernel_code) {
+  // Namespaces and functions defined by the files left out of the lean
+  // preamble. "reduction::" and "broadcast::" also match fused_reduction and
+  // grid_broadcast, and "elford" the welford functions.
+  static const char* left_out[] = {
+      "grid_sync::",
+      "mbarrier::",
+      "cluster::",
+      "reduction::",
+      "broadcast::",
+      "scan::",
+      "sort::",
+      "warp::",
+      "blockReduce",
+      "blockIterGroupedYdimReduce",
+      "atomicAddTo",
+      "elford",
+      "Tuple"};
+  return std::none_of(
+      std::begin(left_out), std::end(left_out), [&](const char* name) {
+        return kernel_code.find(name) != std::string::npos;
+      });
+}
+
+// [ Note -- Outlined runtime functions ]
+//
+// The block and grid communication functions of the runtime, i.e.,
+// blockReduce, gridReduce, their grouped and iter-grouped variants,
+// blockWelford, gridWelford and ParallelReduce, are templates inlined into
+// every call site. A kernel with many of them, e.g., grouped or serial
+// reductions of many tensors, then holds a copy of each per call, which blows
+// up its SASS, thrashes the instruction cache and makes ptxas slow. These
+// functions are declared NVFUSER_OUTLINABLE, which runtime/helpers.cu defines
+// as __inline__. With EnableOption::OutlineRuntime, a kernel with at least 8
+// calls to them, or the number given as argument, defines it as __noinline__
+// before the preamble, so each instantiation is compiled once and called from
+// every site. Outlined calls pass their arguments through local memory, which
+// is why kernels with few calls keep them inlined. The Sass dump reports the
+// number of instructions of each kernel and its number of calls, to compare
+// both choices.
+
+int64_t countOutlinableCalls(const std::string& kernel_code) {
+  static const char* outlinable[] = {
+      "blockReduce",
+      "blockIterGroupedYdimReduce",
+      "reduction::gridReduce",
+      "reduction::gridReduceGroup",
+      "reduction::iterGroupedGridReduce",
+      "blockWelford",
+      "welford::gridWelford",
+      ".reduce",
+      ".reduceGroup"};
+  int64_t count = 0;
+  for (const char* name : outlinable) {
+    const size_t length = strlen(name);
+    for (size_t pos = kernel_code.find(name); pos != std::string::npos;
+         pos = kernel_code.find(name, pos + length)) {
+      // Only the exact name, e.g., not blockReduceAtomicAdd
+      const size_t next = pos + length;
+      if (next < kernel_code.size() &&
+          (kernel_code[next] == '<' || kernel_code[next] == '(')) {
+        count++;
+      }
+    }
+  }
+  return count;
+}
+
+bool outlineRuntimeFunctions(const std::string& kernel_code) {
+  if (!isOptionEnabled(EnableOption::OutlineRuntime)) {
+    return false;
+  }
+  int64_t threshold = 8;
+  const auto& args = getEnableOptionArguments(EnableOption::OutlineRuntime);
+  if (!args.empty()) {
+    try {
+      threshold = std::stoll(args[0]);
+    } catch (const std::exception&) {
+      NVF_CHECK(false, "Invalid outline_runtime threshold: ", args[0]);
+    }
+  }
+  return countOutlinableCalls(kernel_code) >= threshold;
+}
+
+int64_t countSassInstructions(const std::string& sass) {
+  // Instructions are printed as "/*0010*/ MOV R1, c[0x0][0x28] ;"
+  int64_t count = 0;
+  std::istringstream lines(sass);
+  std::string line;
+  while (std::getline(lines, line)) {
+    const size_t begin = line.find("/*");
+    if (begin == std::string::npos) {
+      continue;
+    }
+    const size_t end = line.find("*/", begin);
+    if (end == std::string::npos || end == begin + 2 ||
+        line.find(';', end) == std::string::npos) {
+      continue;
+    }
+    if (std::all_of(
+            line.begin() + (int64_t)begin + 2,
+            line.begin() + (int64_t)end,
+            [](char c) { return std::isxdigit((unsigned char)c); })) {
+      count++;
+    }
+  }
+  return count;
+}
+
 // Query the target GPU version number NVRTC compiles CUDA kernels for
 void queryTargetGPUVersion(
     const cudaDeviceProp* const prop,
@@ -759,9 +928,8 @@ std::string dumpCompiledCodeToFile(
   return file_name.str();
 }
 
-// Get the max register count passed as -maxrregcount ptxas
-// option. The count is determined based on block sizes, an optional
-// heuristic and an environment variable.
+} // namespace
+
 std::optional<int64_t> getMaxRegCount(
     std::optional<int64_t> opt_block_size,
     const int64_t max_register_heuristic) {
@@ -807,6 +975,8 @@ std::optional<int64_t> getMaxRegCount(
   }
 }
 
+namespace {
+
 //! Utility class to invoke nvrtcCompileProgram. Mainly for setting up
 //! the c-str options.
 class NvrtcCompileDriver {
@@ -906,6 +1076,19 @@ class CuModuleLoadDataDriver {
     return log_;
   }
 
+  //! The integer options, which affect the loaded binary unlike the log
+  //! buffers, as a string
+  std::string optionsString() const {
+    std::stringstream ss;
+    for (const auto i : c10::irange(options_.size())) {
+      if (std::holds_alternative<int>(option_vals_.at(i))) {
+        ss << (int)options_.at(i) << "=" << std::get<int>(option_vals_.at(i))
+           << " ";
+      }
+    }
+    return ss.str();
+  }
+
  private:
   // Get options that can be passed to cuModuleLoadDataEx
   std::pair<std::vector<CUjit_option>, std::vector<void*>> getOptions() {
@@ -1010,7 +1193,7 @@ void fillCompileOptions(
   if (isDebugDumpEnabled(DebugDumpOption::PrintPtxasLog) ||
       isDebugDumpEnabled(DebugDumpOption::PerfDebugVerbose) ||
       isOptionEnabled(EnableOption::WarnRegisterSpill) ||
-      compile_params.enable_ptxas_verbose) {
+      compile_params.enable_ptxas_verbose || isProfilerEnabled()) {
     // show register usage in compilation log
     if (compile_to_sass) {
       nvrtc_compile_driver.setOption("--ptxas-options");
@@ -1043,6 +1226,14 @@ void fillCompileOptions(
           val,
           ", ignoring the option");
     }
+  } else if (compile_params.fast_compile) {
+    // See [ Note -- Tiered compilation ] in executor.cpp
+    if (compile_to_sass) {
+      nvrtc_compile_driver.setOption("--ptxas-options");
+      nvrtc_compile_driver.setOption("-O1");
+    } else {
+      module_load_driver.setOption(CU_JIT_OPTIMIZATION_LEVEL, 1);
+    }
   }
 
   const auto max_register =
@@ -1059,20 +1250,33 @@ void fillCompileOptions(
   }
 }
 
+// Parse the number preceding subStr in a verbose ptxas log
+int getRegisterSpillInfo(const std::string& log, const char* subStr) {
+  auto it_end =
+      std::search(log.begin(), log.end(), subStr, subStr + strlen(subStr)) - 1;
+  auto it_beg = it_end - 1;
+  while (!std::isspace(*(it_beg - 1))) {
+    it_beg--;
+  }
+  std::string str(it_beg, it_end);
+  return std::stoi(str);
+}
+
+// Bytes of spill stores and loads of a verbose ptxas log, -1 if the log does
+// not report them
+int countRegisterSpills(const std::string& compile_log) {
+  const char* str_store = "bytes spill stores";
+  const char* str_load = "bytes spill loads";
+  if (compile_log.find(str_store) == std::string::npos ||
+      compile_log.find(str_load) == std::string::npos) {
+    return -1;
+  }
+  return getRegisterSpillInfo(compile_log, str_store) +
+      getRegisterSpillInfo(compile_log, str_load);
+}
+
 // Dump ptxas output if register spill is detected
 int warnRegisterSpill(const std::string& compile_log) {
-  auto getRegisterSpillInfo = [](const std::string& log, const char* subStr) {
-    auto it_end =
-        std::search(log.begin(), log.end(), subStr, subStr + strlen(subStr)) -
-        1;
-    auto it_beg = it_end - 1;
-    while (!std::isspace(*(it_beg - 1))) {
-      it_beg--;
-    }
-    std::string str(it_beg, it_end);
-    return std::stoi(str);
-  };
-
   const char* str_stack = "bytes stack frame";
   const char* str_store = "bytes spill stores";
   const char* str_load = "bytes spill loads";
@@ -1101,22 +1305,94 @@ int warnRegisterSpill(const std::string& compile_log) {
 void createNvrtcProgram(
     nvrtcProgram& program,
     const std::string& id,
-    const std::string& full_src_code) {
+    const std::string& full_src_code,
+    const std::vector<std::pair<std::string, std::string>>& headers = {}) {
   std::stringstream ss;
   ss << "__tmp_kernel_" << id << ".cu";
   std::string name = ss.str();
+  std::vector<const char*> header_sources;
+  std::vector<const char*> header_names;
+  for (const auto& [header_name, header_source] : headers) {
+    header_names.push_back(header_name.c_str());
+    header_sources.push_back(header_source.c_str());
+  }
   FUSER_PERF_SCOPE("executor_utils::NvrtcCreateProgram");
   NVFUSER_NVRTC_SAFE_CALL(nvrtcCreateProgram(
-      &program, full_src_code.c_str(), name.c_str(), 0, nullptr, nullptr));
+      &program,
+      full_src_code.c_str(),
+      name.c_str(),
+      static_cast<int>(headers.size()),
+      header_sources.data(),
+      header_names.data()));
+}
+
+// [ Note -- Precompiled preamble ]
+//
+// The runtime preamble returned by kernelPreamble() is the same for every
+// kernel, and for small kernels parsing it is most of the NVRTC time. With
+// EnableOption::NvrtcPch, the code preceding the kernel, i.e., the preamble
+// along with the type definitions and the index type, is moved into an
+// in-memory header included by the program, and NVRTC is asked to
+// automatically create and use a precompiled header for it with -pch. The
+// PCH lives in a process-wide heap, so only the first kernel of each header
+// pays for parsing the preamble.
+//
+// The header closes the anonymous namespace the preamble is defined in and
+// the kernel reopens it, since a PCH can only stop at file scope. The header
+// is named after the hash of its contents, so that kernels with different
+// index types never share a PCH.
+//
+// The whole preamble is kept in the header rather than only the parts a
+// kernel uses, since with a PCH the unused parts cost next to nothing.
+
+#if CUDA_VERSION >= 12010
+// Split full_src_code into a program including the preamble and the preamble
+// header. Returns std::nullopt if the code does not contain the preamble,
+// e.g., when it is loaded from NVFUSER_EXTERNAL_SRC.
+std::optional<std::pair<std::string, std::pair<std::string, std::string>>>
+splitPreamble(const std::string& full_src_code) {
+  const std::optional<size_t> kernel_begin = kernelBegin(full_src_code);
+  if (!kernel_begin.has_value()) {
+    return std::nullopt;
+  }
+  std::string header = full_src_code.substr(0, *kernel_begin) + "}\n";
+  std::string header_name = "nvfuser_preamble_" +
+      std::to_string(std::hash<std::string>{}(header)) + ".h";
+  std::string program = "#include \"" + header_name + "\"\nnamespace {\n" +
+      full_src_code.substr(*kernel_begin);
+  return std::make_pair(
+      std::move(program),
+      std::make_pair(std::move(header_name), std::move(header)));
 }
 
-// Compile the given source code with the NVRTC compiler driver.
+// Grow the PCH heap if it was too small to hold the PCH of the preamble, so
+// that the following kernels can create it
+void checkPchCreateStatus(nvrtcProgram program) {
+  if (nvrtcGetPCHCreateStatus(program) !=
+      NVRTC_ERROR_PCH_CREATE_HEAP_EXHAUSTED) {
+    return;
+  }
+  size_t required_size = 0;
+  size_t heap_size = 0;
+  NVFUSER_NVRTC_SAFE_CALL(
+      nvrtcGetPCHHeapSizeRequired(program, &required_size));
+  NVFUSER_NVRTC_SAFE_CALL(nvrtcGetPCHHeapSize(&heap_size));
+  if (required_size > heap_size) {
+    NVFUSER_NVRTC_SAFE_CALL(nvrtcSetPCHHeapSize(required_size));
+  }
+}
+#endif
+
+// Compile the given source code with the NVRTC compiler driver. The returned
+// kernel is named after the first of func_names. If lowered_names is given,
+// it receives the lowered name of every function.
 std::unique_ptr<CompiledKernel> compileSource(
     const std::string& full_src_code,
-    const std::string& func_name,
+    const std::vector<std::string>& func_names,
     const std::string& id,
     const bool compile_to_sass,
-    NvrtcCompileDriver& nvrtc_compile) {
+    NvrtcCompileDriver& nvrtc_compile,
+    std::vector<std::string>* lowered_names = nullptr) {
   std::stringstream log;
 
   nvrtcProgram program; // NOLINT(cppcoreguidelines-init-variables)
@@ -1125,16 +1401,45 @@ std::unique_ptr<CompiledKernel> compileSource(
     NVFUSER_NVRTC_SAFE_CALL(nvrtcDestroyProgram(&program));
   });
 
-  createNvrtcProgram(program, id, full_src_code);
+  // See [ Note -- Precompiled preamble ]
+  std::optional<std::pair<std::string, std::pair<std::string, std::string>>>
+      split_src = std::nullopt;
+#if CUDA_VERSION >= 12010
+  if (isOptionEnabled(EnableOption::NvrtcPch)) {
+    split_src = splitPreamble(full_src_code);
+  }
+#endif
+  if (split_src.has_value()) {
+    nvrtc_compile.setOption("-pch");
+    createNvrtcProgram(
+        program, id, split_src->first, {std::move(split_src->second)});
+  } else {
+    createNvrtcProgram(program, id, full_src_code);
+  }
 
-  NVFUSER_NVRTC_SAFE_CALL(nvrtcAddNameExpression(program, func_name.c_str()));
+  for (const std::string& func_name : func_names) {
+    NVFUSER_NVRTC_SAFE_CALL(
+        nvrtcAddNameExpression(program, func_name.c_str()));
+  }
   log << nvrtc_compile.invoke(program, full_src_code) << std::endl;
+#if CUDA_VERSION >= 12010
+  if (split_src.has_value()) {
+    checkPchCreateStatus(program);
+  }
+#endif
 
   auto compiled_kernel = std::make_unique<CompiledKernel>();
-  const char* lowered_kernel_name = nullptr;
-  NVFUSER_NVRTC_SAFE_CALL(
-      nvrtcGetLoweredName(program, func_name.c_str(), &lowered_kernel_name));
-  compiled_kernel->kernel_name = lowered_kernel_name;
+  for (const std::string& func_name : func_names) {
+    const char* lowered_kernel_name = nullptr;
+    NVFUSER_NVRTC_SAFE_CALL(
+        nvrtcGetLoweredName(program, func_name.c_str(), &lowered_kernel_name));
+    if (compiled_kernel->kernel_name.empty()) {
+      compiled_kernel->kernel_name = lowered_kernel_name;
+    }
+    if (lowered_names != nullptr) {
+      lowered_names->emplace_back(lowered_kernel_name);
+    }
+  }
   compiled_kernel->compile_log = log.str();
 
   if (compile_to_sass) {
@@ -1145,7 +1450,10 @@ std::unique_ptr<CompiledKernel> compileSource(
     }
   }
 
-  if (!compile_to_sass || isDebugDumpEnabled(DebugDumpOption::Ptx)) {
+  // The PTX of a kernel compiled to SASS lets a serialized cache be loaded on
+  // newer architectures, see Note [Loading kernels of other architectures]
+  if (!compile_to_sass || isDebugDumpEnabled(DebugDumpOption::Ptx) ||
+      isOptionEnabled(EnableOption::PortableSerde)) {
     compiled_kernel->ptx = compileNvrtcProgramToPtx(program);
     if (isDebugDumpEnabled(DebugDumpOption::Ptx)) {
       compiled_kernel->ptx_filename =
@@ -1156,25 +1464,71 @@ std::unique_ptr<CompiledKernel> compileSource(
   return compiled_kernel;
 }
 
-} // namespace
-
-CompiledKernel::~CompiledKernel() {
-  if (module != nullptr) {
-    NVFUSER_CUDA_SAFE_CALL(cuModuleUnload(module));
-    module = (CUmodule)0x2a2a2a2a2a2a2a2a;
-  }
+// Compile a request of the compile server hosted by this process
+CompileResponse compileServerRequest(const CompileRequest& request) {
+  NvrtcCompileDriver nvrtc_compile;
+  for (const std::string& option : request.options) {
+    nvrtc_compile.setOption(option);
+  }
+  std::unique_ptr<CompiledKernel> compiled_kernel = compileSource(
+      request.code,
+      {request.func_name},
+      request.id,
+      request.compile_to_sass,
+      nvrtc_compile);
+  CompileResponse response;
+  response.kernel_name = std::move(compiled_kernel->kernel_name);
+  response.compile_log = std::move(compiled_kernel->compile_log);
+  response.ptx = std::move(compiled_kernel->ptx);
+  response.cubin = std::move(compiled_kernel->cubin);
+  return response;
 }
 
-// Compile the source if no existing compiled binary is found in KernelDB
-std::unique_ptr<CompiledKernel> getCompiledKernel(
-    std::optional<std::reference_wrapper<const std::string>> kernel_code,
+// Compile the source on the compile server of the node. Returns nullptr if
+// this process has to compile it. See [ Note -- Compile server ] in
+// kernel_db/compile_server.cpp
+std::unique_ptr<CompiledKernel> compileSourceOnServer(
     const std::string& full_src_code,
     const std::string& func_name,
     const std::string& id,
+    const bool compile_to_sass,
+    const NvrtcCompileDriver& nvrtc_compile) {
+  // The process compiling a kernel is the one dumping its binaries and log
+  if (isDebugDumpEnabled(DebugDumpOption::Ptx) ||
+      isDebugDumpEnabled(DebugDumpOption::Cubin) ||
+      isDebugDumpEnabled(DebugDumpOption::PrintPtxasLog)) {
+    return nullptr;
+  }
+  CompileRequest request;
+  request.code = full_src_code;
+  request.func_name = func_name;
+  request.id = id;
+  request.options = nvrtc_compile.options();
+  request.compile_to_sass = compile_to_sass;
+  std::optional<CompileResponse> response =
+      compileOnServer(request, compileServerRequest);
+  // The server may have been started without EnableOption::PortableSerde
+  const bool needs_ptx =
+      !compile_to_sass || isOptionEnabled(EnableOption::PortableSerde);
+  if (!response.has_value() || (compile_to_sass && response->cubin.empty()) ||
+      (needs_ptx && response->ptx.empty())) {
+    return nullptr;
+  }
+  auto compiled_kernel = std::make_unique<CompiledKernel>();
+  compiled_kernel->kernel_name = std::move(response->kernel_name);
+  compiled_kernel->compile_log = std::move(response->compile_log);
+  compiled_kernel->ptx = std::move(response->ptx);
+  compiled_kernel->cubin = std::move(response->cubin);
+  return compiled_kernel;
+}
+
+// Make sure a CUDA context exists on the current device, and fill the
+// compile options for it. Returns whether the kernel is compiled to SASS.
+bool prepareCompilation(
+    NvrtcCompileDriver& nvrtc_compile_driver,
+    CuModuleLoadDataDriver& module_load_driver,
     const CompileParams& compile_params,
     std::optional<int64_t> opt_block_size) {
-  FUSER_PERF_SCOPE("executor_utils::NVRTC");
-
   at::cuda::jit::initializeCudaContext();
 
   // The above initialization works in some cases. However, it seems to
@@ -1204,9 +1558,6 @@ std::unique_ptr<CompiledKernel> getCompiledKernel(
     compile_to_sass = false;
   }
 
-  NvrtcCompileDriver nvrtc_compile_driver;
-  CuModuleLoadDataDriver module_load_driver;
-
   fillCompileOptions(
       nvrtc_compile_driver,
       module_load_driver,
@@ -1215,6 +1566,193 @@ std::unique_ptr<CompiledKernel> getCompiledKernel(
       minor,
       compile_params,
       opt_block_size);
+  return compile_to_sass;
+}
+
+} // namespace
+
+std::optional<size_t> kernelBegin(const std::string& full_src_code) {
+  for (bool lean : {false, true}) {
+    const std::string& preamble = kernelPreamble(lean);
+    const auto pos = full_src_code.find(preamble);
+    if (pos != std::string::npos) {
+      return pos + preamble.size();
+    }
+  }
+  return std::nullopt;
+}
+
+CompiledKernel::~CompiledKernel() {
+  if (module != nullptr && shared_module == nullptr) {
+    NVFUSER_CUDA_SAFE_CALL(cuModuleUnload(module));
+    module = (CUmodule)0x2a2a2a2a2a2a2a2a;
+  }
+}
+
+// [ Note -- Kernel deduplication ]
+//
+// Identical fusions, e.g. those of the successive layers of a model, and
+// identical segments of different fusions generate the same code, only
+// their kernel names differ. Unless DisableOption::KernelDeduplication is
+// set, getCompiledKernel keeps the binary of every kernel it loaded while
+// its module is alive, keyed by the device, the compile and load options
+// and the code with the kernel name erased. A later kernel with the same key
+// skips NVRTC and shares the module, so the compilations and the modules
+// loaded on the GPU scale with the number of distinct kernels instead of the
+// number of executors. The module is unloaded with the last kernel using it.
+//
+// The shared function keeps the name of the first kernel, which is the name
+// profilers and serialized caches see. Its function attributes are shared as
+// well. The maximum dynamic shared memory is only ever raised, so it fits
+// every executor, while the preferred carveout of
+// EnableOption::SmemCarveout is the last one an executor set.
+
+namespace {
+
+struct DeduplicationKey {
+  c10::DeviceIndex device = 0;
+  std::string compile_args;
+  //! Options of cuModuleLoadDataEx, e.g. the JIT optimization level of PTX
+  std::string load_options;
+  size_t code_hash = 0;
+  size_t code_size = 0;
+
+  bool operator==(const DeduplicationKey& other) const {
+    return device == other.device && compile_args == other.compile_args &&
+        load_options == other.load_options && code_hash == other.code_hash &&
+        code_size == other.code_size;
+  }
+};
+
+struct DeduplicationKeyHash {
+  size_t operator()(const DeduplicationKey& key) const {
+    size_t hash = key.code_hash;
+    hashCombine(hash, std::hash<std::string>()(key.compile_args));
+    hashCombine(hash, std::hash<std::string>()(key.load_options));
+    hashCombine(hash, (size_t)key.device);
+    return hash;
+  }
+};
+
+// What a kernel loaded from the same binary copies from the first one
+struct DeduplicatedKernel {
+  std::weak_ptr<CUmod_st> module;
+  // The code with the kernel name erased, which guards against hash
+  // collisions
+  std::string code;
+  std::string kernel_name;
+  std::string compile_log;
+  std::vector<char> ptx;
+  std::string ptx_filename;
+  std::vector<char> cubin;
+  std::string cubin_filename;
+  int register_spills = -1;
+};
+
+class DeduplicatedKernels {
+ public:
+  static DeduplicatedKernels& get() {
+    static DeduplicatedKernels kernels;
+    return kernels;
+  }
+
+  // Returns a kernel sharing the module of the one loaded with `key` and
+  // `code`, or nullptr if none is alive
+  std::unique_ptr<CompiledKernel> find(
+      const DeduplicationKey& key,
+      const std::string& code) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto it = kernels_.find(key);
+    if (it == kernels_.end()) {
+      return nullptr;
+    }
+    const DeduplicatedKernel& entry = it->second;
+    std::shared_ptr<CUmod_st> module = entry.module.lock();
+    if (module == nullptr || entry.code != code) {
+      return nullptr;
+    }
+    auto compiled_kernel = std::make_unique<CompiledKernel>();
+    compiled_kernel->module = module.get();
+    compiled_kernel->shared_module = std::move(module);
+    NVFUSER_CUDA_SAFE_CALL(cuModuleGetFunction(
+        &(compiled_kernel->function),
+        compiled_kernel->module,
+        entry.kernel_name.c_str()));
+    compiled_kernel->kernel_name = entry.kernel_name;
+    compiled_kernel->compile_log = entry.compile_log;
+    compiled_kernel->compile_args = key.compile_args;
+    compiled_kernel->ptx = entry.ptx;
+    compiled_kernel->ptx_filename = entry.ptx_filename;
+    compiled_kernel->cubin = entry.cubin;
+    compiled_kernel->cubin_filename = entry.cubin_filename;
+    compiled_kernel->register_spills = entry.register_spills;
+    return compiled_kernel;
+  }
+
+  // Shares the module of `compiled_kernel` with later kernels of `key`
+  void insert(
+      const DeduplicationKey& key,
+      std::string code,
+      CompiledKernel& compiled_kernel) {
+    compiled_kernel.shared_module = std::shared_ptr<CUmod_st>(
+        compiled_kernel.module,
+        [](CUmodule m) { NVFUSER_CUDA_SAFE_CALL(cuModuleUnload(m)); });
+    std::lock_guard<std::mutex> guard(mutex_);
+    // Drop the kernels whose modules were unloaded
+    for (auto it = kernels_.begin(); it != kernels_.end();) {
+      it = it->second.module.expired() ? kernels_.erase(it) : std::next(it);
+    }
+    DeduplicatedKernel& entry = kernels_[key];
+    entry.module = compiled_kernel.shared_module;
+    entry.code = std::move(code);
+    entry.kernel_name = compiled_kernel.kernel_name;
+    entry.compile_log = compiled_kernel.compile_log;
+    entry.ptx = compiled_kernel.ptx;
+    entry.ptx_filename = compiled_kernel.ptx_filename;
+    entry.cubin = compiled_kernel.cubin;
+    entry.cubin_filename = compiled_kernel.cubin_filename;
+    entry.register_spills = compiled_kernel.register_spills;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::unordered_map<DeduplicationKey, DeduplicatedKernel, DeduplicationKeyHash>
+      kernels_;
+};
+
+// The code of `full_src_code` from `begin`, with every occurrence of
+// `func_name` erased
+std::string deduplicationCode(
+    const std::string& full_src_code,
+    size_t begin,
+    const std::string& func_name) {
+  std::string code = full_src_code.substr(begin);
+  for (size_t pos = code.find(func_name); pos != std::string::npos;
+       pos = code.find(func_name, pos)) {
+    code.erase(pos, func_name.size());
+  }
+  return code;
+}
+
+} // namespace
+
+// Compile the source if no existing compiled binary is found in KernelDB
+std::unique_ptr<CompiledKernel> getCompiledKernel(
+    std::optional<std::reference_wrapper<const std::string>> kernel_code,
+    const std::string& full_src_code,
+    const std::string& func_name,
+    const std::string& id,
+    const CompileParams& compile_params,
+    std::optional<int64_t> opt_block_size) {
+  FUSER_PERF_SCOPE("executor_utils::NVRTC");
+
+  NvrtcCompileDriver nvrtc_compile_driver;
+  CuModuleLoadDataDriver module_load_driver;
+  const bool compile_to_sass = prepareCompilation(
+      nvrtc_compile_driver,
+      module_load_driver,
+      compile_params,
+      opt_block_size);
 
   std::stringstream log;
 
@@ -1232,6 +1770,35 @@ std::unique_ptr<CompiledKernel> getCompiledKernel(
   const auto compile_args =
       toDelimitedString(nvrtc_compile_driver.options(), " ");
 
+  // See [ Note -- Kernel deduplication ]
+  const bool deduplicate =
+      !isOptionDisabled(DisableOption::KernelDeduplication) &&
+      !func_name.empty();
+  DeduplicationKey deduplication_key;
+  std::string deduplication_code;
+  if (deduplicate) {
+    // Only the kernel is kept to compare codes, the preamble is only hashed
+    const size_t begin = kernelBegin(full_src_code).value_or(0);
+    deduplication_code = deduplicationCode(full_src_code, begin, func_name);
+    deduplication_key.device = c10::cuda::current_device();
+    deduplication_key.compile_args = compile_args;
+    deduplication_key.load_options = module_load_driver.optionsString();
+    deduplication_key.code_hash = std::hash<std::string_view>()(
+        std::string_view(full_src_code).substr(0, begin));
+    hashCombine(
+        deduplication_key.code_hash,
+        std::hash<std::string>()(deduplication_code));
+    deduplication_key.code_size = begin + deduplication_code.size();
+    std::unique_ptr<CompiledKernel> duplicate =
+        DeduplicatedKernels::get().find(deduplication_key, deduplication_code);
+    if (duplicate != nullptr) {
+      if (opt_block_size.has_value()) {
+        duplicate->block_size = opt_block_size.value();
+      }
+      return duplicate;
+    }
+  }
+
   auto& kernel_db = KernelDb::get();
   const auto use_kernel_db = kernel_db.enabled() && kernel_code.has_value();
 
@@ -1243,8 +1810,16 @@ std::unique_ptr<CompiledKernel> getCompiledKernel(
             compiled_kernel->kernel_name,
             (compile_to_sass ? compiled_kernel->cubin
                              : compiled_kernel->ptx)))) {
-    compiled_kernel = compileSource(
+    compiled_kernel = compileSourceOnServer(
         full_src_code, func_name, id, compile_to_sass, nvrtc_compile_driver);
+    if (compiled_kernel == nullptr) {
+      compiled_kernel = compileSource(
+          full_src_code,
+          {func_name},
+          id,
+          compile_to_sass,
+          nvrtc_compile_driver);
+    }
     log << compiled_kernel->compile_log << std::endl;
     if (use_kernel_db) {
       auto result = kernel_db.write(
@@ -1272,6 +1847,9 @@ std::unique_ptr<CompiledKernel> getCompiledKernel(
       compile_params.enable_ptxas_verbose) {
     compiled_kernel->register_spills =
         warnRegisterSpill(compiled_kernel->compile_log);
+  } else if (isProfilerEnabled()) {
+    compiled_kernel->register_spills =
+        countRegisterSpills(compiled_kernel->compile_log);
   }
 
   NVFUSER_CUDA_SAFE_CALL(cuModuleGetFunction(
@@ -1284,12 +1862,160 @@ std::unique_ptr<CompiledKernel> getCompiledKernel(
     compiled_kernel->block_size = opt_block_size.value();
   }
 
+  if (deduplicate) {
+    DeduplicatedKernels::get().insert(
+        deduplication_key, std::move(deduplication_code), *compiled_kernel);
+  }
   return compiled_kernel;
 }
 
+std::vector<std::unique_ptr<CompiledKernel>> getCompiledKernels(
+    const std::vector<std::string>& full_src_codes,
+    const std::vector<std::string>& func_names,
+    const std::string& id,
+    const CompileParams& compile_params,
+    const std::vector<std::optional<int64_t>>& opt_block_sizes) {
+  FUSER_PERF_SCOPE("executor_utils::NVRTC");
+  NVF_ERROR(
+      !full_src_codes.empty() && full_src_codes.size() == func_names.size() &&
+          full_src_codes.size() == opt_block_sizes.size(),
+      "Expected one function name and block size per kernel code.");
+  // The block sizes only matter for the register count, so the compile
+  // options of the first kernel are those of all kernels
+  const std::optional<int64_t> opt_block_size = opt_block_sizes.front();
+  for (const auto& block_size : opt_block_sizes) {
+    NVF_ERROR(
+        getMaxRegCount(block_size, compile_params.maxrregcount) ==
+            getMaxRegCount(opt_block_size, compile_params.maxrregcount),
+        "Batched kernels must be compiled with the same register count.");
+  }
+
+  // Each code closes the anonymous namespace opened before the preamble after
+  // its kernel, so it is reopened before the next kernel. See
+  // [ Note -- Batched compilation ] in kernel_cache.cpp
+  const std::optional<size_t> shared_end = kernelBegin(full_src_codes.front());
+  NVF_ERROR(
+      shared_end.has_value(),
+      "Cannot batch the compilation of kernels without the preamble.");
+  std::string batch_src_code = full_src_codes.front();
+  for (const auto i : c10::irange(1, full_src_codes.size())) {
+    const std::string& full_src_code = full_src_codes.at(i);
+    NVF_ERROR(
+        kernelBegin(full_src_code) == shared_end &&
+            full_src_code.compare(
+                0, *shared_end, batch_src_code, 0, *shared_end) == 0,
+        "Batched kernels must share the code preceding them.");
+    batch_src_code += "namespace {\n";
+    batch_src_code.append(full_src_code, *shared_end);
+  }
+
+  NvrtcCompileDriver nvrtc_compile_driver;
+  CuModuleLoadDataDriver module_load_driver;
+  const bool compile_to_sass = prepareCompilation(
+      nvrtc_compile_driver,
+      module_load_driver,
+      compile_params,
+      opt_block_size);
+  const auto compile_args =
+      toDelimitedString(nvrtc_compile_driver.options(), " ");
+
+  std::vector<std::string> lowered_names;
+  auto batch = compileSource(
+      batch_src_code,
+      func_names,
+      id,
+      compile_to_sass,
+      nvrtc_compile_driver,
+      &lowered_names);
+
+  std::stringstream log;
+  log << batch->compile_log << std::endl;
+  CUmodule module = nullptr;
+  log << module_load_driver.invoke(
+             module,
+             (compile_to_sass ? batch->cubin.data() : batch->ptx.data()))
+      << std::endl;
+  std::shared_ptr<CUmod_st> shared_module(module, [](CUmodule m) {
+    NVFUSER_CUDA_SAFE_CALL(cuModuleUnload(m));
+  });
+
+  int register_spills = -1;
+  if (isOptionEnabled(EnableOption::WarnRegisterSpill) ||
+      compile_params.enable_ptxas_verbose) {
+    register_spills = warnRegisterSpill(log.str());
+  } else if (isProfilerEnabled()) {
+    register_spills = countRegisterSpills(log.str());
+  }
+
+  // Every kernel keeps a copy of the binary, so that it can be serialized and
+  // disassembled like the binary of a kernel compiled on its own
+  std::vector<std::unique_ptr<CompiledKernel>> compiled_kernels;
+  compiled_kernels.reserve(func_names.size());
+  for (const auto i : c10::irange(lowered_names.size())) {
+    const std::string& lowered_name = lowered_names.at(i);
+    auto compiled_kernel = std::make_unique<CompiledKernel>();
+    compiled_kernel->module = module;
+    compiled_kernel->shared_module = shared_module;
+    NVFUSER_CUDA_SAFE_CALL(cuModuleGetFunction(
+        &(compiled_kernel->function), module, lowered_name.c_str()));
+    compiled_kernel->kernel_name = lowered_name;
+    compiled_kernel->compile_log = log.str();
+    compiled_kernel->compile_args = compile_args;
+    compiled_kernel->ptx = batch->ptx;
+    compiled_kernel->ptx_filename = batch->ptx_filename;
+    compiled_kernel->cubin = batch->cubin;
+    compiled_kernel->cubin_filename = batch->cubin_filename;
+    compiled_kernel->register_spills = register_spills;
+    // Store block size used to generate compile arguments
+    if (opt_block_sizes.at(i).has_value()) {
+      compiled_kernel->block_size = opt_block_sizes.at(i).value();
+    }
+    compiled_kernels.push_back(std::move(compiled_kernel));
+  }
+  return compiled_kernels;
+}
+
+std::vector<char> CompiledKernel::cubinCopy() const {
+  if (serde_buffer == nullptr || serde_buffer->cubin() == nullptr) {
+    return cubin;
+  }
+  return std::vector<char>(
+      serde_buffer->cubin()->begin(), serde_buffer->cubin()->end());
+}
+
+namespace {
+
+// Removes the --gpu-architecture option from the delimited compile args
+std::string withoutGpuArchitecture(const std::string& compile_args) {
+  std::stringstream ss(compile_args);
+  std::vector<std::string> args;
+  std::string arg;
+  while (ss >> arg) {
+    if (arg.rfind("--gpu-architecture=", 0) != 0) {
+      args.push_back(arg);
+    }
+  }
+  return toDelimitedString(args, " ");
+}
+
+} // namespace
+
+// Note [Loading kernels of other architectures]
+// A serialized kernel is normally loaded from the cubin compiled for the
+// current device, and its compile args must match the ones nvFuser would use
+// now. With EnableOption::PortableSerde, kernels compiled to SASS also keep
+// their PTX, and a cache serialized on an older architecture is accepted, see
+// verifyFusionCache in python_frontend/fusion_cache.cpp. When the compile args
+// of a kernel only differ by --gpu-architecture, the driver JIT compiles its
+// PTX for the current device instead, which skips lowering, code generation
+// and NVRTC. The heuristics and launch parameters stay those picked for the
+// older device. PTX of arch-specific targets like sm_90a can't be JIT compiled
+// for other architectures, in which case loading the module fails.
+
 std::unique_ptr<CompiledKernel> getCompiledKernel(
     const serde::CudaKernel* buffer,
-    const CompileParams& compile_params) {
+    const CompileParams& compile_params,
+    bool in_place) {
   FUSER_PERF_SCOPE("executor_utils::serde_NVRTC");
 
   NVF_ERROR(buffer != nullptr, "serde::CudaKernel is nullptr.");
@@ -1299,22 +2025,29 @@ std::unique_ptr<CompiledKernel> getCompiledKernel(
   compiled_kernel->kernel_name = buffer->kernel_name()->str();
   compiled_kernel->compile_args = buffer->compile_args()->str();
   compiled_kernel->block_size = buffer->block_size();
+  if (in_place) {
+    compiled_kernel->serde_buffer = buffer;
+  }
 
   if (buffer->cubin() != nullptr) {
-    compiled_kernel->cubin.reserve(buffer->cubin()->size());
-    std::copy(
-        buffer->cubin()->begin(),
-        buffer->cubin()->end(),
-        std::back_inserter(compiled_kernel->cubin));
+    if (!in_place) {
+      compiled_kernel->cubin.reserve(buffer->cubin()->size());
+      std::copy(
+          buffer->cubin()->begin(),
+          buffer->cubin()->end(),
+          std::back_inserter(compiled_kernel->cubin));
+    }
     compiled_kernel->cubin_filename = buffer->cubin_filename()->str();
   }
 
   if (buffer->ptx() != nullptr) {
-    compiled_kernel->ptx.reserve(buffer->ptx()->size());
-    std::copy(
-        buffer->ptx()->begin(),
-        buffer->ptx()->end(),
-        std::back_inserter(compiled_kernel->ptx));
+    if (!in_place) {
+      compiled_kernel->ptx.reserve(buffer->ptx()->size());
+      std::copy(
+          buffer->ptx()->begin(),
+          buffer->ptx()->end(),
+          std::back_inserter(compiled_kernel->ptx));
+    }
     compiled_kernel->ptx_filename = buffer->ptx_filename()->str();
   }
 
@@ -1358,27 +2091,53 @@ std::unique_ptr<CompiledKernel> getCompiledKernel(
 
   const auto latest_compile_args =
       toDelimitedString(nvrtc_compile_driver.options(), " ");
+  // See Note [Loading kernels of other architectures]
+  const bool has_ptx = buffer->ptx() != nullptr && buffer->ptx()->size() > 0;
+  const bool jit_from_ptx = isOptionEnabled(EnableOption::PortableSerde) &&
+      has_ptx && latest_compile_args != compiled_kernel->compile_args &&
+      withoutGpuArchitecture(latest_compile_args) ==
+          withoutGpuArchitecture(compiled_kernel->compile_args);
   NVF_ERROR(
-      latest_compile_args == compiled_kernel->compile_args,
+      jit_from_ptx || latest_compile_args == compiled_kernel->compile_args,
       "The compile arguments for the serialized cuda kernel does not ",
       "match the latest generated compile args.\t",
       latest_compile_args,
       "\t",
       compiled_kernel->compile_args);
+  if (jit_from_ptx) {
+    // The module is loaded with the options of a PTX compilation
+    NvrtcCompileDriver unused_nvrtc_compile_driver;
+    module_load_driver = CuModuleLoadDataDriver();
+    fillCompileOptions(
+        unused_nvrtc_compile_driver,
+        module_load_driver,
+        /*compile_to_sass=*/false,
+        major,
+        minor,
+        compile_params,
+        opt_block_size);
+    compile_to_sass = false;
+  }
 
   NVF_ERROR(
-      !compile_to_sass || !compiled_kernel->cubin.empty(),
+      !compile_to_sass ||
+          (buffer->cubin() != nullptr && buffer->cubin()->size() > 0),
       "Expected compiled cubin after deserializing CompiledKernel.");
 
   NVF_ERROR(
-      compile_to_sass || !compiled_kernel->ptx.empty(),
+      compile_to_sass ||
+          (buffer->ptx() != nullptr && buffer->ptx()->size() > 0),
       "Expected compiled ptx after deserializing CompiledKernel.");
 
+  const void* image = nullptr;
+  if (in_place) {
+    image = compile_to_sass ? buffer->cubin()->data() : buffer->ptx()->data();
+  } else {
+    image = compile_to_sass ? compiled_kernel->cubin.data()
+                            : compiled_kernel->ptx.data();
+  }
   std::stringstream log;
-  log << module_load_driver.invoke(
-             compiled_kernel->module,
-             (compile_to_sass ? compiled_kernel->cubin.data()
-                              : compiled_kernel->ptx.data()))
+  log << module_load_driver.invoke(compiled_kernel->module, image)
       << std::endl;
   compiled_kernel->compile_log = log.str();
 
@@ -29,8 +29,25 @@
 namespace nvfuser {
 namespace executor_utils {
 
-// Include all the functions we might need in generated code
-std::string kernelPreamble();
+// Include all the functions we might need in generated code. The lean
+// preamble leaves out the runtime of block and grid communication, see
+// [ Note -- Lean preamble ] in executor_utils.cpp.
+const std::string& kernelPreamble(bool lean = false);
+
+//! Whether the kernel definition `kernel_code` can be compiled with the lean
+//! preamble, i.e., it calls none of the runtime functions it leaves out
+bool fitsLeanPreamble(const std::string& kernel_code);
+
+//! Number of calls of the kernel definition `kernel_code` to the runtime
+//! functions that can be outlined
+NVF_API int64_t countOutlinableCalls(const std::string& kernel_code);
+
+//! Whether the kernel definition `kernel_code` is compiled with its runtime
+//! functions outlined, see [ Note -- Outlined runtime functions ]
+bool outlineRuntimeFunctions(const std::string& kernel_code);
+
+//! Number of instructions of disassembled SASS
+int64_t countSassInstructions(const std::string& sass);
 
 //! Bind input values to runtime values
 NVF_API ExpressionEvaluator
@@ -56,6 +73,16 @@ struct CompiledKernel : public NonCopyable {
   std::string compile_args;
   long block_size = -1;
   int register_spills = -1;
+  //! Set when the module holds the kernels of several executors, see
+  //! getCompiledKernels. The module is then unloaded with its last kernel.
+  std::shared_ptr<CUmod_st> shared_module;
+  //! Set when the kernel was deserialized in place, in which case cubin and
+  //! ptx are left empty and read from this buffer, which outlives the kernel
+  const serde::CudaKernel* serde_buffer = nullptr;
+
+  //! The cubin, read from serde_buffer if the kernel was deserialized in
+  //! place
+  NVF_API std::vector<char> cubinCopy() const;
 };
 
 // Returns executable function and the ptxas log from compilation
@@ -67,10 +94,36 @@ std::unique_ptr<CompiledKernel> getCompiledKernel(
     const CompileParams& compile_params = CompileParams(),
     std::optional<int64_t> opt_block_size = std::nullopt);
 
-// Returns executable function using flatbuffer object
+//! Returns the position where the kernel begins in code generated by
+//! FusionExecutor::getStructuredCode, i.e., the end of the preamble, or
+//! std::nullopt if the code does not contain the preamble
+std::optional<size_t> kernelBegin(const std::string& full_src_code);
+
+//! Get the max register count passed as -maxrregcount ptxas
+//! option. The count is determined based on block sizes, an optional
+//! heuristic and an environment variable.
+std::optional<int64_t> getMaxRegCount(
+    std::optional<int64_t> opt_block_size,
+    const int64_t max_register_heuristic);
+
+//! Compile the kernels of several executors as a single NVRTC program loaded
+//! as one module, and return the kernel of each func_name. All codes must
+//! share the code preceding their kernel, which is only emitted once, and
+//! their block sizes must result in the same register count.
+std::vector<std::unique_ptr<CompiledKernel>> getCompiledKernels(
+    const std::vector<std::string>& full_src_codes,
+    const std::vector<std::string>& func_names,
+    const std::string& id,
+    const CompileParams& compile_params,
+    const std::vector<std::optional<int64_t>>& opt_block_sizes);
+
+// Returns executable function using flatbuffer object. If in_place, the
+// module is loaded from the binary in the buffer, which must then outlive the
+// kernel, instead of from a copy.
 std::unique_ptr<CompiledKernel> getCompiledKernel(
     const serde::CudaKernel* buffer,
-    const CompileParams& compile_params);
+    const CompileParams& compile_params,
+    bool in_place = false);
 
 namespace caching {
 // TODO: Could consider putting some of
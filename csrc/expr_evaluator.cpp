@@ -16,6 +16,7 @@
 #include <logical_domain_map.h>
 #include <polymorphic_value.h>
 
+#include <algorithm>
 #include <functional>
 #include <iostream>
 
@@ -127,8 +128,115 @@ void validateValWithConcreteValue(
   }
 }
 
+// Answers ir_utils::dependenciesSatisfied with the values known by an
+// ExpressionEvaluator, in its maps or in its slots
+struct KnownVals {
+  const ExpressionEvaluator& expr_eval;
+  size_t count(const Val* value) const {
+    return expr_eval.isKnown(value) ? 1 : 0;
+  }
+};
+
 } // namespace
 
+// Note [Slots of ExpressionEvaluator]
+// An ExpressionEvaluator keeps the values it knows in a hash map keyed by
+// Val. Evaluators that are filled again on every run, like the one of
+// HostIrExecutor or the one FusionExecutor uses for each launch, pay for
+// hashing on every bind and lookup, and a fresh evaluator also pays for
+// allocating the nodes of the map. assignSlots gives each Val of a container
+// a slot in a flat array instead. The Vals of a ValType are named
+// consecutively by their container, so the slot of a Val is the offset of
+// its ValType plus its name, and no per-Val state is needed. The array is
+// allocated once, and clear() only resets the slots filled since the
+// previous clear.
+//
+// Vals of other containers and Vals created after assignSlots, which are
+// past the end of their ValType's range, don't have slots and use the maps
+// as before. NamedScalars keep being looked up by name.
+
+void ExpressionEvaluator::assignSlots(const IrContainer* container) {
+  NVF_ERROR(container != nullptr);
+  constexpr auto num_val_types = (size_t)ValType::Others + 1;
+  std::vector<int64_t> num_names(num_val_types, 0);
+  for (Val* val : container->vals()) {
+    auto& n = num_names.at((size_t)val->vtype());
+    n = std::max(n, (int64_t)val->name() + 1);
+  }
+
+  NVF_ERROR(
+      known_values_.empty() && filled_slots_.empty(),
+      "Slots must be assigned before any value is bound");
+  slotted_container_ = container;
+  slot_offsets_.assign(num_val_types + 1, 0);
+  for (auto i : c10::irange(num_val_types)) {
+    slot_offsets_[i + 1] = slot_offsets_[i] + num_names[i];
+  }
+  const int64_t num_slots = slot_offsets_.back();
+  slot_vals_.assign(num_slots, nullptr);
+  for (Val* val : container->vals()) {
+    slot_vals_[slotOf(val)] = val;
+  }
+  slot_values_.assign(num_slots, PolymorphicValue());
+  is_filled_.assign(num_slots, false);
+  filled_slots_.clear();
+}
+
+int64_t ExpressionEvaluator::slotOf(const Val* value) const {
+  if (value->container() != slotted_container_) {
+    return -1;
+  }
+  const auto vtype = (size_t)value->vtype();
+  const int64_t slot = slot_offsets_[vtype] + (int64_t)value->name();
+  if (slot >= slot_offsets_[vtype + 1] || slot_vals_[slot] != value) {
+    return -1;
+  }
+  return slot;
+}
+
+void ExpressionEvaluator::setKnownValue(
+    const Val* value,
+    PolymorphicValue concrete_value,
+    std::unordered_map<const Val*, PolymorphicValue>& known_values) const {
+  if (&known_values == &known_values_) {
+    if (const int64_t slot = slotOf(value); slot >= 0) {
+      slot_values_[slot] = std::move(concrete_value);
+      if (!is_filled_[slot]) {
+        is_filled_[slot] = true;
+        filled_slots_.push_back(slot);
+      }
+      return;
+    }
+  }
+  known_values[value] = std::move(concrete_value);
+}
+
+bool ExpressionEvaluator::isKnown(const Val* value) const {
+  if (const int64_t slot = slotOf(value); slot >= 0) {
+    return slot_values_[slot].hasValue();
+  }
+  return known_values_.count(value) > 0;
+}
+
+void ExpressionEvaluator::invalidate(const Val* value) {
+  if (const int64_t slot = slotOf(value); slot >= 0) {
+    slot_values_[slot] = PolymorphicValue();
+    return;
+  }
+  known_values_.erase(value);
+}
+
+void ExpressionEvaluator::clear() {
+  for (int64_t slot : filled_slots_) {
+    slot_values_[slot] = PolymorphicValue();
+    is_filled_[slot] = false;
+  }
+  filled_slots_.clear();
+  known_values_.clear();
+  known_named_scalars_.clear();
+  precomputed_values_ = nullptr;
+}
+
 void ExpressionEvaluator::bind_(
     const Val* value,
     PolymorphicValue concrete_value,
@@ -146,7 +254,7 @@ void ExpressionEvaluator::bind_(
   }
   validateValWithConcreteValue(value, concrete_value);
   if (evaluate_validate &&
-      ir_utils::dependenciesSatisfied(value, known_values_)) {
+      ir_utils::dependenciesSatisfied(value, KnownVals{*this})) {
     auto evaluated_value = evaluate(value);
     using namespace PolymorphicValue_functions;
     auto same = isSame(evaluated_value, concrete_value);
@@ -236,7 +344,7 @@ void ExpressionEvaluator::bind_(
     known_named_scalars_[value->as<NamedScalar>()->name()] =
         std::move(concrete_value);
   } else {
-    known_values_[value] = std::move(concrete_value);
+    setKnownValue(value, std::move(concrete_value), known_values_);
   }
 }
 
@@ -293,7 +401,7 @@ const PolymorphicValue& ExpressionEvaluator::evaluate(
       FUSER_PERF_SCOPE("ExpressionEvaluator::evaluate");
       auto outputs = def->evaluate(*this, known_values);
       for (auto i : c10::irange(def->outputs().size())) {
-        known_values[def->output(i)] = std::move(outputs[i]);
+        setKnownValue(def->output(i), std::move(outputs[i]), known_values);
       }
       maybe_concrete_value = getValue(value, known_values);
     }
@@ -316,6 +424,11 @@ const PolymorphicValue& ExpressionEvaluator::getValue(
     }
   }
 
+  if (const int64_t slot = slotOf(value);
+      slot >= 0 && slot_values_[slot].hasValue()) {
+    return slot_values_[slot];
+  }
+
   auto it = known_values_.find(value);
   if (it != known_values_.end()) {
     return it->second;
@@ -341,6 +454,13 @@ void ExpressionEvaluator::print() const {
             << *kv.first->getValType() << "\n";
   }
 
+  for (int64_t slot : filled_slots_) {
+    if (slot_values_[slot].hasValue()) {
+      debug() << slot_vals_[slot] << " = " << toString(slot_values_[slot])
+              << " ; " << *slot_vals_[slot]->getValType() << "\n";
+    }
+  }
+
   for (const auto& kv : known_named_scalars_) {
     debug() << kv.first << " = " << toString(kv.second) << " ;\n";
   }
@@ -407,6 +527,12 @@ ExpressionEvaluator ExpressionEvaluator::clone(IrCloner& ir_cloner) const {
   for (const auto& kv : known_values_) {
     expr_eval.known_values_[ir_cloner.clone(kv.first)] = kv.second;
   }
+  for (int64_t slot : filled_slots_) {
+    if (slot_values_[slot].hasValue()) {
+      expr_eval.known_values_[ir_cloner.clone(slot_vals_[slot])] =
+          slot_values_[slot];
+    }
+  }
   expr_eval.known_named_scalars_.insert(
       known_named_scalars_.begin(), known_named_scalars_.end());
   return expr_eval;
@@ -18,6 +18,7 @@
 
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace nvfuser {
 
@@ -67,13 +68,21 @@ class ExpressionEvaluator {
       const Val* value,
       std::unordered_map<const Val*, PolymorphicValue>& known_values) const;
 
-  bool isKnown(const Val* value) const {
-    return known_values_.count(value) > 0;
-  }
+  NVF_API bool isKnown(const Val* value) const;
 
-  void invalidate(const Val* value) {
-    known_values_.erase(value);
-  }
+  NVF_API void invalidate(const Val* value);
+
+  //! Keep the values of the Vals that `container` holds now in a flat array,
+  //! indexed by a slot assigned to each of them, instead of in hash maps, so
+  //! that binding and looking them up are indexed accesses. Values of other
+  //! Vals are still kept in the maps. Intended for evaluators that are
+  //! refilled on every run. See Note [Slots of ExpressionEvaluator]
+  NVF_API void assignSlots(const IrContainer* container);
+
+  //! Forget all the known values and the bound PrecomputedValues, keeping the
+  //! slots. With slots, this only resets the slots that were filled since the
+  //! last clear.
+  NVF_API void clear();
 
   //! Debugging helper, prints all the currently known values
   void print() const;
@@ -103,6 +112,16 @@ class ExpressionEvaluator {
       const std::unordered_map<const Val*, PolymorphicValue>&
           additional_known_values) const;
 
+  //! Returns the slot of `value`, or -1 if it doesn't have one
+  int64_t slotOf(const Val* value) const;
+
+  //! Records the value of a Val that isn't a NamedScalar, in its slot if it
+  //! has one and `known_values` is known_values_
+  void setKnownValue(
+      const Val* value,
+      PolymorphicValue concrete_value,
+      std::unordered_map<const Val*, PolymorphicValue>& known_values) const;
+
  private:
   // TODO: Consider make this const. It can't be const as bind() of
   // this class calls
@@ -114,6 +133,19 @@ class ExpressionEvaluator {
   std::unordered_map<const Val*, PolymorphicValue> known_values_;
   std::unordered_map<std::string, PolymorphicValue> known_named_scalars_;
   PolymorphicValue null_ = std::monostate{};
+
+  // The container whose Vals have slots, if any. The Vals of a ValType have
+  // consecutive slots in the order of their names, starting at
+  // slot_offsets_[vtype].
+  const IrContainer* slotted_container_ = nullptr;
+  std::vector<int64_t> slot_offsets_;
+  std::vector<const Val*> slot_vals_;
+  // Like known_values_, these are written by the const evaluate when it is
+  // given known_values_, i.e., when the evaluator is not const.
+  mutable std::vector<PolymorphicValue> slot_values_;
+  // The slots filled since the last clear, and whether each slot is in it
+  mutable std::vector<int64_t> filled_slots_;
+  mutable std::vector<bool> is_filled_;
 };
 
 } // namespace nvfuser
@@ -17,14 +17,18 @@
 #include <options.h>
 #include <utils.h>
 
+#include <algorithm>
 #include <cmath>
 #include <functional>
+#include <limits>
 #include <list>
 #include <memory>
 #include <numeric>
 #include <regex>
 #include <sstream>
 #include <string>
+#include <typeinfo>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -2760,10 +2764,185 @@ Val* cancelTermsInPredicate(Val* value, const Context& context) {
 
 } // namespace rules
 
+// Note [Memoization of simplifyExpr]
+// Lowering simplifies many expressions that are structurally identical, for
+// example the same index math built once per tensor, or the same predicate
+// built once per loop nest. simplifyExpr runs all its passes to a fixed point
+// each time, so the results are memoized while an ExprSimplifierCache is
+// alive, as it is during GpuLower::run.
+//
+// The entries are bucketed by a structural hash of the arguments, which agrees
+// with Val::sameAs: constants are hashed by value, named scalars by name and
+// other free Vals by address. The arguments are then compared with sameAs,
+// except the variables whose order and identity matter. The number of axioms
+// of the fusion is also part of the key, because they are used as assumptions
+// too and new axioms can be added between two calls.
+//
+// The cache holds raw pointers to Vals of the fusion, which can be removed from
+// it, and whose memory can be reused by new Vals. So an entry is only used if
+// all its Vals are still in the container and have the same names, since names
+// are never reused.
+
+namespace {
+
+thread_local ExprSimplifierCache* current_simplifier_cache = nullptr;
+
+size_t structuralHash(Val* value, std::unordered_map<Val*, size_t>& memo) {
+  if (auto it = memo.find(value); it != memo.end()) {
+    return it->second;
+  }
+  size_t hash = static_cast<size_t>(value->vtype());
+  if (auto def = value->definition(); def != nullptr) {
+    hashCombine(hash, typeid(*def).hash_code());
+    hashCombine(hash, def->attributes().size());
+    for (auto input : def->inputs()) {
+      hashCombine(hash, structuralHash(input, memo));
+    }
+    if (def->outputs().size() > 1) {
+      auto it = std::find(def->outputs().begin(), def->outputs().end(), value);
+      hashCombine(
+          hash,
+          static_cast<size_t>(std::distance(def->outputs().begin(), it)));
+    }
+  } else if (value->value().is<int64_t>()) {
+    hashCombine(hash, std::hash<int64_t>()(value->value().as<int64_t>()));
+  } else if (value->value().is<bool>()) {
+    hashCombine(hash, std::hash<bool>()(value->value().as<bool>()));
+  } else if (value->value().is<double>()) {
+    hashCombine(hash, std::hash<double>()(value->value().as<double>()));
+  } else if (value->value().hasValue()) {
+    // Other constants only land in the same bucket
+  } else if (auto ns = dynamic_cast<NamedScalar*>(value)) {
+    hashCombine(hash, std::hash<std::string>()(ns->name()));
+  } else {
+    hashCombine(hash, std::hash<Val*>()(value));
+  }
+  memo.emplace(value, hash);
+  return hash;
+}
+
+// Returns the names of the Vals of `entry`, in the order the fields are
+// declared
+std::vector<StmtNameType> namesOf(const ExprSimplifierCache::Entry& entry) {
+  std::vector<StmtNameType> names;
+  names.reserve(entry.variables.size() + entry.assumptions.size() + 2);
+  names.push_back(entry.value->name());
+  for (const auto& [var, is_unrolled_loop_index] : entry.variables) {
+    names.push_back(var->name());
+  }
+  for (auto assumption : entry.assumptions) {
+    names.push_back(assumption->name());
+  }
+  names.push_back(entry.simplified->name());
+  return names;
+}
+
+bool isAlive(Fusion* fusion, const ExprSimplifierCache::Entry& entry) {
+  size_t i = 0;
+  auto alive = [&](Val* val) {
+    return fusion->inContainer(val) && val->name() == entry.names.at(i++);
+  };
+  if (!alive(entry.value)) {
+    return false;
+  }
+  for (const auto& [var, is_unrolled_loop_index] : entry.variables) {
+    if (!alive(var)) {
+      return false;
+    }
+  }
+  for (auto assumption : entry.assumptions) {
+    if (!alive(assumption)) {
+      return false;
+    }
+  }
+  return alive(entry.simplified);
+}
+
+// The maximum number of passes a call to simplifyExpr can apply, set by
+// NVFUSER_ENABLE=expr_simplify_budget(N). Each pass visits the whole
+// expression, so this bounds the time spent on large expressions, at the cost
+// of leaving them less simplified.
+int64_t passBudget() {
+  if (!isOptionEnabled(EnableOption::ExprSimplifyBudget)) {
+    return std::numeric_limits<int64_t>::max();
+  }
+  const auto& args = getEnableOptionArguments(EnableOption::ExprSimplifyBudget);
+  NVF_CHECK(
+      args.size() == 1, "expr_simplify_budget requires the number of passes");
+  int64_t budget = -1;
+  try {
+    budget = std::stoll(args[0]);
+  } catch (const std::exception&) {
+    NVF_CHECK(false, "Invalid expression simplifier budget: ", args[0]);
+  }
+  NVF_CHECK(
+      budget >= 0,
+      "The expression simplifier budget must not be negative, but got ",
+      budget);
+  return budget;
+}
+
+} // namespace
+
+ExprSimplifierCache::ExprSimplifierCache()
+    : previous_(current_simplifier_cache) {
+  current_simplifier_cache = this;
+}
+
+ExprSimplifierCache::~ExprSimplifierCache() {
+  current_simplifier_cache = previous_;
+}
+
+ExprSimplifierCache* ExprSimplifierCache::current() {
+  return current_simplifier_cache;
+}
+
+Val* ExprSimplifierCache::find(size_t hash, const Entry& key) {
+  auto it = entries_.find(hash);
+  if (it == entries_.end()) {
+    misses_++;
+    return nullptr;
+  }
+  Fusion* fusion = key.value->fusion();
+  auto& bucket = it->second;
+  for (auto entry_it = bucket.begin(); entry_it != bucket.end();) {
+    if (!isAlive(fusion, *entry_it)) {
+      entry_it = bucket.erase(entry_it);
+      continue;
+    }
+    const Entry& entry = *entry_it;
+    if (entry.preserve_error == key.preserve_error &&
+        entry.num_axioms == key.num_axioms &&
+        entry.variables == key.variables &&
+        entry.assumptions.size() == key.assumptions.size() &&
+        entry.value->sameAs(key.value) &&
+        std::equal(
+            entry.assumptions.begin(),
+            entry.assumptions.end(),
+            key.assumptions.begin(),
+            [](Val* a, Val* b) { return a->sameAs(b); })) {
+      hits_++;
+      return entry.simplified;
+    }
+    ++entry_it;
+  }
+  misses_++;
+  return nullptr;
+}
+
+void ExprSimplifierCache::insert(size_t hash, Entry entry) {
+  entry.names = namesOf(entry);
+  entries_[hash].push_back(std::move(entry));
+}
+
 #define RUN_PASS(pass_name)                                     \
   if (disabled_passes == nullptr ||                             \
       (!disabled_passes->empty() &&                             \
        disabled_passes->count(#pass_name) == 0)) {              \
+    if (budget == 0) {                                          \
+      break;                                                    \
+    }                                                           \
+    budget--;                                                   \
     simplified = recurseDown(simplified, [&context](Val* val) { \
       return rules::pass_name(val, context);                    \
     });                                                         \
@@ -2782,8 +2961,33 @@ Val* simplifyExpr(
     std::vector<Val*> assumptions,
     bool preserve_error) {
   FusionGuard fg(value->fusion());
+
+  ExprSimplifierCache* cache = ExprSimplifierCache::current();
+  ExprSimplifierCache::Entry entry;
+  size_t hash = 0;
+  if (cache != nullptr) {
+    entry.value = value;
+    entry.assumptions = assumptions;
+    entry.preserve_error = preserve_error;
+    entry.num_axioms = value->fusion()->axioms().size();
+    std::unordered_map<Val*, size_t> memo;
+    hash = structuralHash(value, memo);
+    for (const auto& info : variables) {
+      entry.variables.emplace_back(info.variable, info.is_unrolled_loop_index);
+      hashCombine(hash, std::hash<Val*>()(info.variable));
+    }
+    for (auto assumption : assumptions) {
+      hashCombine(hash, structuralHash(assumption, memo));
+    }
+    hashCombine(hash, preserve_error);
+    if (Val* simplified = cache->find(hash, entry)) {
+      return simplified;
+    }
+  }
+
   const Context context(variables, assumptions, preserve_error);
   auto logger = debug_print::createLogger(value);
+  int64_t budget = passBudget();
 
   // nullptr -> disable nothing
   // empty set -> disable everything
@@ -2835,6 +3039,11 @@ Val* simplifyExpr(
 
   auto unflattened = assoc_comm::unflatten(simplified, context);
   logger->record(debug_print::kUnflattenName, unflattened);
+
+  if (cache != nullptr) {
+    entry.simplified = unflattened;
+    cache->insert(hash, std::move(entry));
+  }
   return unflattened;
 }
 
@@ -11,6 +11,8 @@
 #include <ir/all_nodes.h>
 #include <visibility.h>
 
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 // Note: [The Mathematics of Integer Arithmetic]
@@ -154,6 +156,56 @@ NVF_API Val* simplifyExpr(
     std::vector<Val*> assumptions = {},
     bool preserve_error = false);
 
+// While an ExprSimplifierCache is alive, simplifyExpr memoizes its results on
+// the current thread: simplifying an expression that is structurally identical
+// (see Val::sameAs) to a previously simplified one, with the same variables,
+// assumptions and preserve_error, returns the previously simplified Val. Scopes
+// can be nested, in which case the innermost one is used. See Note
+// [Memoization of simplifyExpr] in the cpp file.
+class NVF_API ExprSimplifierCache {
+ public:
+  ExprSimplifierCache();
+  ~ExprSimplifierCache();
+
+  ExprSimplifierCache(const ExprSimplifierCache&) = delete;
+  ExprSimplifierCache& operator=(const ExprSimplifierCache&) = delete;
+
+  // The innermost cache of the current thread, or nullptr
+  static ExprSimplifierCache* current();
+
+  int64_t hits() const {
+    return hits_;
+  }
+
+  int64_t misses() const {
+    return misses_;
+  }
+
+  // The arguments and the result of a call to simplifyExpr
+  struct Entry {
+    Val* value = nullptr;
+    std::vector<std::pair<Val*, bool>> variables;
+    std::vector<Val*> assumptions;
+    bool preserve_error = false;
+    size_t num_axioms = 0;
+    Val* simplified = nullptr;
+    // Names of all the Vals above, used to detect the ones that have been
+    // removed from the fusion
+    std::vector<StmtNameType> names;
+  };
+
+  // Returns the simplified Val of an entry with the given hash and the same
+  // arguments as `key`, or nullptr
+  Val* find(size_t hash, const Entry& key);
+  void insert(size_t hash, Entry entry);
+
+ private:
+  std::unordered_map<size_t, std::vector<Entry>> entries_;
+  ExprSimplifierCache* const previous_;
+  int64_t hits_ = 0;
+  int64_t misses_ = 0;
+};
+
 class Context;
 namespace assoc_comm {
 // The expression type that represents the flattened ops. For example, if I have
@@ -25,6 +25,7 @@
 #include <ops/arith.h>
 
 #include <iterator>
+#include <sstream>
 
 namespace nvfuser {
 
@@ -127,6 +128,127 @@ IrCloner Fusion::copy(const Fusion* from, Fusion* to) {
   return ir_cloner;
 }
 
+namespace {
+
+//! IrCloner that records the vals it clones in the order they are cloned
+class SubgraphCloner : public IrCloner {
+ public:
+  using IrCloner::IrCloner;
+
+  bool isCloned(const Statement* stmt) const {
+    return clones_map_.count(stmt) > 0;
+  }
+
+  const std::vector<const Val*>& clonedVals() const {
+    return cloned_vals_;
+  }
+
+ protected:
+  Statement* handle(const Statement* s) override {
+    Statement* clone = IrCloner::handle(s);
+    if (s->isVal()) {
+      cloned_vals_.push_back(s->asVal());
+    }
+    return clone;
+  }
+
+ private:
+  std::vector<const Val*> cloned_vals_;
+};
+
+} // namespace
+
+IrCloner Fusion::copy(
+    const Fusion* from,
+    Fusion* to,
+    const std::vector<Expr*>& exprs) {
+  to->clear();
+  SubgraphCloner ir_cloner(to);
+
+  for (auto expr : exprs) {
+    ir_cloner.clone(expr);
+  }
+
+  for (const auto& i : from->managed_data_) {
+    if (i.first.has_value()) {
+      to->managed_data_.emplace_back(i.second(ir_cloner, i.first), i.second);
+    } else {
+      to->managed_data_.emplace_back(i.first, i.second);
+    }
+  }
+
+  for (auto [k, v] : from->managed_named_data_) {
+    if (v.first.has_value()) {
+      to->managed_named_data_.insert(std::make_pair(
+          k, std::make_pair(v.second(ir_cloner, v.first), v.second)));
+    }
+  }
+
+  if (from->axioms_ != nullptr) {
+    to->axioms_ = std::make_unique<std::vector<Val*>>();
+    for (auto pred : *from->axioms_) {
+      to->axioms_->emplace_back(ir_cloner.clone(pred));
+    }
+  }
+
+  // Tensors are only defined by the given exprs, while the other vals, e.g.
+  // IterDomains and extents, need their definitions to stay meaningful.
+  // Cloning definitions and metadata can clone more vals, so repeat until no
+  // new val is cloned.
+  const std::unordered_set<Expr*> expr_set(exprs.begin(), exprs.end());
+  size_t num_processed = 0;
+  while (num_processed < ir_cloner.clonedVals().size()) {
+    for (; num_processed < ir_cloner.clonedVals().size(); ++num_processed) {
+      const Val* val = ir_cloner.clonedVals().at(num_processed);
+      Expr* def = val->definition_;
+      if (def == nullptr) {
+        continue;
+      }
+      const bool defines_tensor = std::any_of(
+          def->outputs().begin(), def->outputs().end(), [](Val* out) {
+            return out->isA<TensorView>();
+          });
+      if (!defines_tensor || expr_set.count(def) > 0) {
+        ir_cloner.clone(val)->setDefinition(ir_cloner.clone(def));
+      }
+    }
+    for (const auto& [val, metadata] : from->metadata_) {
+      if (ir_cloner.isCloned(val) &&
+          to->metadata_.count(ir_cloner.clone(val)) == 0) {
+        to->metadata_.emplace(ir_cloner.clone(val), ir_cloner.clone(metadata));
+      }
+    }
+  }
+
+  for (auto val : ir_cloner.clonedVals()) {
+    std::vector<Expr*> uses;
+    for (auto use : val->uses_) {
+      if (ir_cloner.isCloned(use)) {
+        uses.push_back(ir_cloner.clone(use));
+      }
+    }
+    ir_cloner.clone(val)->setUses(uses);
+  }
+
+  for (const auto& [output, alias_info] : from->io_alias_) {
+    if (!ir_cloner.isCloned(output)) {
+      continue;
+    }
+    to->io_alias_[ir_cloner.clone(output)] = {
+        .type = alias_info.type,
+        .aliased_io = ir_cloner.clone(alias_info.aliased_io),
+        .hide_output = alias_info.hide_output};
+  }
+
+  to->val_type_name_map_ = from->val_type_name_map_;
+  to->expr_name_counter_ = from->expr_name_counter_;
+  to->all_tv_uses_valid_ = from->all_tv_uses_valid_;
+  to->is_during_update_uses_ = from->is_during_update_uses_;
+  to->expected_dynamic_smem_bytes_ = from->expected_dynamic_smem_bytes_;
+
+  return ir_cloner;
+}
+
 // Clang tidy complains when using default constructor for IrContainer instead
 // of copy constructor. Fusion::copy has a call to IrContainer::copy, so it's
 // redundant to use the IrContainer copy constructor, but it is harmless since
@@ -356,7 +478,11 @@ void Fusion::replaceOutput(Val* output, Val* replacement) {
 }
 
 std::vector<Expr*> Fusion::exprs() const {
-  return StmtSort::getExprs(this);
+  if (exprs_cache_epoch_ != mutationEpoch()) {
+    exprs_cache_ = StmtSort::getExprs(this);
+    exprs_cache_epoch_ = mutationEpoch();
+  }
+  return exprs_cache_;
 }
 
 bool Fusion::isNoOp() {
@@ -384,6 +510,170 @@ std::vector<Val*> Fusion::inputsOf(Val* val) {
   return InputsOf::output(val);
 }
 
+// Note [Canonical form of a fusion]
+//
+// The names of the values of a fusion depend on the order they were created
+// in, so the Fusions built from two definitions of the same computation, e.g.
+// those of the identical layers of a model, usually print differently.
+// canonicalForm prints a fusion with its values numbered in the order they
+// are first reached instead:
+//  - the inputs, in order,
+//  - then the exprs of exprs(), which is ordered by a traversal from the
+//    outputs, so it doesn't depend on the order the exprs were created in,
+//    and the scalar and IterDomain exprs the values of these exprs depend on,
+//  - and finally the outputs, in order, with their aliases.
+// A value is described where it is first reached, a tensor by its dtype,
+// memory type, contiguity and domains, and an IterDomain by its iter type,
+// parallel type and extents, so a number stands for the same value wherever
+// it appears. Constants and the data attributes of exprs are printed by
+// value. Two fusions with the same canonical form are therefore the same
+// graph up to the names of its values.
+namespace {
+
+class FusionCanonicalizer {
+ public:
+  static std::string run(const Fusion* fusion) {
+    FusionCanonicalizer canonicalizer;
+    return canonicalizer.canonicalize(fusion);
+  }
+
+ private:
+  std::string canonicalize(const Fusion* fusion) {
+    std::stringstream inputs;
+    inputs << "inputs:";
+    for (Val* in : fusion->inputs()) {
+      inputs << " " << ref(in);
+    }
+    ss_ << inputs.str() << "\n";
+
+    for (Expr* expr : fusion->exprs()) {
+      emit(expr);
+    }
+
+    std::stringstream outputs;
+    outputs << "outputs:";
+    for (Val* out : fusion->outputs()) {
+      outputs << " " << ref(out);
+      const AliasInfo& alias = fusion->getOutputAlias(out);
+      if (alias.type != AllocationType::New) {
+        outputs << "(alias " << (int)alias.type << " "
+                << (alias.aliased_io == nullptr ? "none"
+                                                : ref(alias.aliased_io))
+                << (alias.hide_output ? " hidden" : "") << ")";
+      }
+    }
+    ss_ << outputs.str() << "\n";
+    return ss_.str();
+  }
+
+  // Returns how val is referred to, describing it first if it wasn't reached
+  // yet
+  std::string ref(Val* val) {
+    if (auto it = ids_.find(val); it != ids_.end()) {
+      return "%" + std::to_string(it->second);
+    }
+    if (val->definition() == nullptr && val->value().hasValue()) {
+      std::stringstream ss;
+      ss << val->dtype() << "(" << val->toString() << ")";
+      return ss.str();
+    }
+    if (auto ns = dynamic_cast<NamedScalar*>(val)) {
+      return ns->name();
+    }
+    if (val->definition() != nullptr &&
+        emitted_.count(val->definition()) == 0) {
+      // Describes the outputs of the definition
+      emit(val->definition());
+      return "%" + std::to_string(ids_.at(val));
+    }
+    return "%" + std::to_string(describe(val));
+  }
+
+  std::string refs(const std::vector<IterDomain*>& ids) {
+    std::stringstream ss;
+    ss << "[";
+    for (auto id : ids) {
+      ss << " " << ref(id);
+    }
+    ss << " ]";
+    return ss.str();
+  }
+
+  int64_t describe(Val* val) {
+    const int64_t id = (int64_t)ids_.size();
+    ids_.emplace(val, id);
+
+    std::stringstream ss;
+    if (auto tv = dynamic_cast<TensorView*>(val)) {
+      ss << "tensor " << tv->dtype() << " " << tv->getMemoryType()
+         << (tv->isCpuScalar() ? " cpu" : "");
+      if (tv->hasRoot()) {
+        ss << " root" << refs(tv->getRootDomain());
+      }
+      ss << " logical" << refs(tv->getLogicalDomain());
+      if (tv->hasAllocation()) {
+        ss << " allocation" << refs(tv->getAllocationDomain());
+      }
+      if (tv->getLoopDomain() != tv->getLogicalDomain()) {
+        ss << " loop" << refs(tv->getLoopDomain());
+      }
+      ss << " contiguity [";
+      for (const std::optional<bool>& contiguity : tv->getContiguity()) {
+        ss << " " << (contiguity.has_value() ? (*contiguity ? "t" : "f") : "n");
+      }
+      ss << " ]";
+    } else if (auto iter_domain = dynamic_cast<IterDomain*>(val)) {
+      ss << "iter " << iter_domain->getIterType() << " "
+         << iter_domain->getParallelType() << " " << ref(iter_domain->start())
+         << " " << ref(iter_domain->extent()) << " "
+         << ref(iter_domain->stopOffset())
+         << (iter_domain->isRFactorProduct() ? " rfactor" : "");
+      if (iter_domain->hasExpandedExtent()) {
+        ss << " expanded " << ref(iter_domain->expandedExtent());
+      }
+    } else {
+      ss << "scalar " << val->dtype();
+    }
+    ss_ << "%" << id << " = " << ss.str() << "\n";
+    return id;
+  }
+
+  void emit(Expr* expr) {
+    if (!emitted_.insert(expr).second) {
+      return;
+    }
+    std::stringstream ss;
+    ss << expr->getOpString();
+    for (Statement* attr : expr->attributes()) {
+      if (auto val = dynamic_cast<Val*>(attr)) {
+        ss << " {" << ref(val) << "}";
+      } else {
+        ss << " {" << attr->toString() << "}";
+      }
+    }
+    for (Val* in : expr->inputs()) {
+      ss << " " << ref(in);
+    }
+    ss << " ->";
+    for (Val* out : expr->outputs()) {
+      ss << " " << ref(out);
+    }
+    ss_ << ss.str() << "\n";
+  }
+
+ private:
+  std::stringstream ss_;
+  std::unordered_map<Val*, int64_t> ids_;
+  std::unordered_set<Expr*> emitted_;
+};
+
+} // namespace
+
+std::string Fusion::canonicalForm() const {
+  FUSER_PERF_SCOPE("Fusion::canonicalForm");
+  return FusionCanonicalizer::run(this);
+}
+
 void Fusion::validateInputs() {
   std::unordered_set<Val*> all_inputs;
   for (Val* out : outputs()) {
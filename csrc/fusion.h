@@ -197,9 +197,16 @@ class NVF_API Fusion : public IrContainer {
   bankConflictInfo(const CompileParams& compile_params = CompileParams());
 
   //! Return a list of topologically sorted expressions. This only includes
-  //! exprs required to generate registered outputs.
+  //! exprs required to generate registered outputs. The order is cached until
+  //! the next mutation of the fusion, see mutationEpoch().
   std::vector<Expr*> exprs() const;
 
+  //! Returns the definition of the fusion with its values numbered in the
+  //! order they are reached from the inputs instead of named. Fusions with the
+  //! same canonical form compute the same outputs from the same inputs, see
+  //! Note [Canonical form of a fusion] in fusion.cpp.
+  std::string canonicalForm() const;
+
   //! Return a vector of fusion inputs that feed this Val
   std::vector<Val*> inputsOf(Val* val);
 
@@ -418,6 +425,17 @@ class NVF_API Fusion : public IrContainer {
 
   static IrCloner copy(const Fusion* from, Fusion* to);
 
+  //! Copy only `exprs` of `from` to `to`, along with the vals they use and
+  //! the definitions of the non-tensor vals among them, e.g. IterDomain
+  //! transforms and extent computations. Tensors produced outside of `exprs`
+  //! are copied without definitions. `to` is left without inputs and
+  //! outputs. Used to create the fusions of segments without copying the
+  //! complete fusion.
+  static IrCloner copy(
+      const Fusion* from,
+      Fusion* to,
+      const std::vector<Expr*>& exprs);
+
   //! During scheduling, this can be set to a non-negative value. If done, then
   //! during execution by FusionExecutor, we will check that this value matches
   //! the corresponding value in LaunchParams.
@@ -465,6 +483,9 @@ class NVF_API Fusion : public IrContainer {
   void invalidateTvsAndUses() {
     all_tv_uses_valid_ = false;
     all_tvs_ptr_.reset();
+    // Inputs and outputs changed, so anything cached against the current
+    // epoch is stale as well
+    ++mutation_epoch_;
   }
 
  private:
@@ -494,6 +515,10 @@ class NVF_API Fusion : public IrContainer {
   int64_t expected_dynamic_smem_bytes_ = -1LL;
 
   std::unique_ptr<std::vector<TensorView*>> all_tvs_ptr_ = nullptr;
+
+  // Topological order of exprs() and the mutation epoch it was computed at
+  mutable std::vector<Expr*> exprs_cache_;
+  mutable int64_t exprs_cache_epoch_ = -1;
 };
 
 // Returns true if all fusion outputs are expression evaluated.
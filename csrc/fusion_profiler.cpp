@@ -9,6 +9,8 @@
 #include <cupti.h>
 #include <fusion_profiler.h>
 #include <iomanip>
+#include <map>
+#include <sstream>
 
 namespace nvfuser {
 
@@ -221,6 +223,18 @@ void CudaEventTimer::stop() {
   state_ = ProfilerState::Finished;
 }
 
+bool CudaEventTimer::ready() const {
+  if (state_ != ProfilerState::Finished) {
+    return false;
+  }
+  const cudaError_t status = cudaEventQuery(stop_event_);
+  if (status == cudaErrorNotReady) {
+    return false;
+  }
+  NVFUSER_CUDA_RT_SAFE_CALL(status);
+  return true;
+}
+
 double CudaEventTimer::time() {
   if (state_ == ProfilerState::Finished) {
     float tmp{0.0};
@@ -315,6 +329,57 @@ void DeviceDescriptor::generate(DeviceDescriptor& desc, int device) {
   desc.peak_bandwidth_gbs = static_comp *
       static_cast<double>(desc.memory_clock) *
       static_cast<double>(desc.bus_width);
+
+  NVFUSER_CUDA_SAFE_CALL(cuDeviceGetAttribute(
+      &desc.sm_count, CU_DEVICE_ATTRIBUTE_MULTIPROCESSOR_COUNT, device));
+  NVFUSER_CUDA_SAFE_CALL(cuDeviceGetAttribute(
+      &desc.sm_clock, CU_DEVICE_ATTRIBUTE_CLOCK_RATE, device));
+  NVFUSER_CUDA_SAFE_CALL(cuDeviceGetAttribute(
+      &desc.major, CU_DEVICE_ATTRIBUTE_COMPUTE_CAPABILITY_MAJOR, device));
+  NVFUSER_CUDA_SAFE_CALL(cuDeviceGetAttribute(
+      &desc.minor, CU_DEVICE_ATTRIBUTE_COMPUTE_CAPABILITY_MINOR, device));
+
+  // Peak tensor core throughput calculation:
+  // Dense FP16 FLOPs per clock per SM with FP32 accumulation, as published
+  // for the data center parts of each architecture. Clock is given in kHz.
+  double flops_per_clock_per_sm = 0.0;
+  switch (desc.major * 10 + desc.minor) {
+    case 70:
+    case 72:
+    case 75:
+    case 86:
+    case 87:
+    case 89:
+      flops_per_clock_per_sm = 1024.0;
+      break;
+    case 80:
+      flops_per_clock_per_sm = 2048.0;
+      break;
+    case 90:
+      flops_per_clock_per_sm = 4096.0;
+      break;
+    default:
+      if (desc.major >= 10) {
+        flops_per_clock_per_sm = 8192.0;
+      }
+      break;
+  }
+  desc.peak_tflops = flops_per_clock_per_sm *
+      static_cast<double>(desc.sm_count) *
+      static_cast<double>(desc.sm_clock) * 1000.0 * /*kHz->Hz*/
+      (1.0 / 1.0e12); /*FLOP/s->TFLOP/s*/
+}
+
+std::ostream& operator<<(std::ostream& os, const KernelBound& bound) {
+  switch (bound) {
+    case KernelBound::Memory:
+      return os << "memory";
+    case KernelBound::Compute:
+      return os << "compute";
+    default:
+      NVF_ERROR(false, "Unexpected KernelBound enum value!");
+  }
+  return os;
 }
 
 SegmentProfiler::SegmentProfiler(uint32_t id, bool cupti_disabled)
@@ -607,6 +672,77 @@ std::ostream& operator<<(std::ostream& os, const FusionProfile& fp) {
   return os;
 }
 
+// [ Note -- Roofline report ]
+//
+// NVFUSER_PROF=print.roofline prints, for every kernel of a fusion, how close
+// it runs to the roofline of the device. The achieved bandwidth counts the
+// input and output bytes of the segment, as in the default profile. The
+// achieved FLOP/s only counts the matmul ops of the segment, i.e. MmaOp,
+// MatmulOp and LinearOp, with 2 FLOPs per multiply-add, and is compared to
+// the peak of the tensor cores, see DeviceDescriptor::peak_tflops.
+//
+// A kernel is classified as compute-bound if its arithmetic intensity, in
+// FLOPs per byte, is at least the ridge point of the device, i.e. the peak
+// FLOP/s divided by the peak bandwidth, and as memory-bound otherwise. The
+// efficiency to look at is then the percentage of peak FLOP/s or of peak
+// bandwidth respectively. Occupancy is computed with the CUDA occupancy API
+// from the launch parameters, and register spills are parsed from the ptxas
+// log, which is requested whenever the profiler is enabled. The shared
+// memory columns are the dynamic and static sizes reported by CUPTI.
+
+std::string FusionProfile::rooflineReport() const {
+  std::stringstream ss;
+  ss << std::left << std::setw(6) << "Seg#" << std::setw(10) << "KerTm(ms)"
+     << std::setw(12) << "EffBw(GB/s)" << std::setw(8) << "%PkBw"
+     << std::setw(11) << "TFLOP/s" << std::setw(8) << "%PkFlop"
+     << std::setw(8) << "Occ(%)" << std::setw(8) << "Spills" << std::setw(17)
+     << "Smem[Dyn,Stat]" << std::setw(8) << "Regs" << std::setw(9) << "Bound"
+     << "Sched" << std::endl;
+  for (const auto& kp : kernel_profiles) {
+    ss << std::fixed << std::setw(6) << kp.segment_id << std::setprecision(3)
+       << std::setw(10) << kp.time_ms << std::setw(12)
+       << kp.effective_bandwidth_gbs << std::setprecision(2) << std::setw(8)
+       << kp.percentage_peak_bandwidth << std::setprecision(3) << std::setw(11)
+       << kp.achieved_tflops << std::setprecision(2) << std::setw(8)
+       << kp.percentage_peak_flops << std::setw(8) << kp.occupancy
+       << std::setw(8)
+       << (kp.register_spills < 0 ? std::string("-")
+                                  : std::to_string(kp.register_spills))
+       << std::setw(17) << toString(kp.shared_mem) << std::setw(8)
+       << kp.registers << std::setw(9) << kp.bound << kp.scheduler
+       << std::endl;
+  }
+  return ss.str();
+}
+
+std::string FusionProfile::regionReport() const {
+  std::stringstream ss;
+  for (const auto& kp : kernel_profiles) {
+    if (kp.regions.empty()) {
+      continue;
+    }
+    ss << "Segment " << kp.segment_id << " " << kp.name << std::endl;
+    ss << std::left << std::setw(16) << "Kind" << std::setw(12) << "Us/hit"
+       << std::setw(12) << "Hits" << std::setw(8) << "%Time"
+       << "Region" << std::endl;
+    std::map<std::string, double> kind_percentages;
+    for (const auto& region : kp.regions) {
+      ss << std::fixed << std::setw(16)
+         << (region.nested ? "  " + region.kind : region.kind)
+         << std::setprecision(3) << std::setw(12) << region.us_per_hit
+         << std::setw(12) << region.hits << std::setprecision(2)
+         << std::setw(8) << region.percentage << region.name << std::endl;
+      kind_percentages[region.kind] += region.percentage;
+    }
+    ss << "Breakdown:";
+    for (const auto& [kind, percentage] : kind_percentages) {
+      ss << " " << kind << " " << std::setprecision(2) << percentage << "%";
+    }
+    ss << std::endl;
+  }
+  return ss.str();
+}
+
 FusionProfiler::FusionProfiler()
     : cupti_disabled_(false),
       cupti_buffer_(FusionProfiler::cupti_activity_buffer_size),
@@ -770,6 +906,28 @@ const DeviceDescriptor& FusionProfiler::deviceDescriptor(const int device_id) {
       kprof.percentage_peak_bandwidth =
           kprof.effective_bandwidth_gbs / kprof.peak_bandwidth_gbs * 100.0;
       kprof.compile_time_ms = segment(kp_idx).compileTime();
+      kprof.lowering_passes = segment(kp_idx).loweringPasses();
+      kprof.regions = segment(kp_idx).kernelRegions();
+
+      // See [ Note -- Roofline report ]
+      kprof.peak_tflops = device_desc.peak_tflops;
+      kprof.flops = segment(kp_idx).flops();
+      kprof.achieved_tflops =
+          (double)kprof.flops / kprof.time_ms * /*ms->s*/ 1.0e-9;
+      if (kprof.peak_tflops > 0.0) {
+        kprof.percentage_peak_flops =
+            kprof.achieved_tflops / kprof.peak_tflops * 100.0;
+      }
+      kprof.occupancy = segment(kp_idx).occupancy();
+      kprof.register_spills = segment(kp_idx).registerSpills();
+      const int64_t bytes = kprof.input_bytes + kprof.output_bytes;
+      const double ridge_flops_per_byte = kprof.peak_tflops * 1.0e3 /
+          kprof.peak_bandwidth_gbs; /*TFLOP/s / GB/s -> FLOP/B*/
+      kprof.bound = kprof.flops > 0 &&
+              (bytes == 0 ||
+               (double)kprof.flops / (double)bytes >= ridge_flops_per_byte)
+          ? KernelBound::Compute
+          : KernelBound::Memory;
 
       kprof.grid_str = toString(kprof.grid);
       kprof.block_str = toString(kprof.block);
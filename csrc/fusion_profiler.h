@@ -42,6 +42,9 @@ class CudaEventTimer {
   void start();
   void stop();
   double time();
+  //! Whether the timer is stopped and the work between its events is done,
+  //! i.e. whether time() would return without blocking
+  bool ready() const;
   ProfilerState state() const;
 
  private:
@@ -75,10 +78,11 @@ class HostTimer {
 
 //! \struct DeviceDescriptor
 //! \brief This struct captures the GPU information necessary to calculate the
-//! the Peak Bandwidth of the specific GPU queried.
+//! the Peak Bandwidth and the peak tensor core throughput of the specific GPU
+//! queried.
 struct DeviceDescriptor {
   //! Queries the GPU to populate the struct's data members and calculates the
-  //! peak bandwidth
+  //! peak bandwidth and throughput
   static void generate(DeviceDescriptor& desc, int device);
 
   //! Queried data members
@@ -86,9 +90,47 @@ struct DeviceDescriptor {
   std::string name{"NVIDIA Unknown GPU"};
   int bus_width{0};
   int memory_clock{0};
+  int sm_count{0};
+  int sm_clock{0};
+  int major{0};
+  int minor{0};
 
-  //! Calculated data member
+  //! Calculated data members
   double peak_bandwidth_gbs{0.0};
+  //! Approximate dense FP16/BF16 tensor core peak with FP32 accumulation.
+  //! Zero for architectures without a known value.
+  double peak_tflops{0.0};
+};
+
+//! Whether a kernel is limited by memory bandwidth or by math throughput,
+//! judged by its arithmetic intensity relative to the ridge point of the
+//! device roofline
+enum class KernelBound { Memory, Compute };
+
+NVF_API std::ostream& operator<<(std::ostream&, const KernelBound&);
+
+//! Wall time of a step of GpuLower and the number of IR nodes it added,
+//! negative if it removed nodes
+struct LoweringPassProfile {
+  std::string name{};
+  double time_ms{0.0};
+  int64_t node_delta{0};
+};
+
+//! Time spent by the warps of a kernel in one of the regions profiled with
+//! NVFUSER_ENABLE=kernel_profile(regions). See Note [Profiled kernel regions]
+//! in device_lower/pass/instrument.cpp
+struct KernelRegionProfile {
+  std::string kind{};
+  std::string name{};
+  //! Whether the region is nested in a top-level loop nest
+  bool nested{false};
+  //! Number of warps that ran the region times the number of runs
+  int64_t hits{0};
+  double us_per_hit{0.0};
+  //! Share of the cycles of all top-level regions, excluding the regions
+  //! nested in it from a loop nest
+  double percentage{0.0};
 };
 
 //! \struct KernelProfile
@@ -102,6 +144,10 @@ struct KernelProfile {
   uint32_t correlation_id{0};
 
   double compile_time_ms{0.0};
+  //! Steps of the lowering of the kernel, in order
+  std::vector<LoweringPassProfile> lowering_passes{};
+  //! Profiled regions of the kernel, in order, if any
+  std::vector<KernelRegionProfile> regions{};
   double time_ms{0.0};
   double effective_bandwidth_gbs{0.0};
   double percentage_peak_bandwidth{0.0};
@@ -116,8 +162,19 @@ struct KernelProfile {
   int64_t input_bytes{0};
   int64_t output_bytes{0};
 
+  //! Floating point operations of the matmul ops of the segment, 0 if none
+  int64_t flops{0};
+  double achieved_tflops{0.0};
+  double percentage_peak_flops{0.0};
+  //! Achieved occupancy in percent of the maximum warps per SM
+  float occupancy{0.0};
+  //! Bytes of register spill stores and loads, -1 if unknown
+  int register_spills{-1};
+  KernelBound bound{KernelBound::Memory};
+
   std::string device_name{};
   double peak_bandwidth_gbs{0.0};
+  double peak_tflops{0.0};
 
   // These strings are here to capture the conversion
   // in struct that can be reference when making a tuple
@@ -176,6 +233,15 @@ struct FusionProfile {
 
   //! Vector of of the KernelProfiles for each segment of a Fusion
   std::vector<KernelProfile> kernel_profiles{};
+
+  //! Roofline efficiency table of the kernels, printed with
+  //! NVFUSER_PROF=print.roofline. Requires CUPTI.
+  NVF_API std::string rooflineReport() const;
+
+  //! Per-region breakdown of the kernels profiled with
+  //! NVFUSER_ENABLE=kernel_profile(regions), and the share of each kind of
+  //! region. Requires CUPTI.
+  NVF_API std::string regionReport() const;
 };
 
 std::ostream& operator<<(std::ostream&, const FusionProfile&);
@@ -194,6 +260,21 @@ class SegmentProfiler {
 
   void inputBytesAccessed(int64_t bytes);
   void outputBytesAccessed(int64_t bytes);
+  void flopsProcessed(int64_t flops) {
+    flops_ = flops;
+  }
+  void occupancy(float occupancy) {
+    occupancy_ = occupancy;
+  }
+  void registerSpills(int spills) {
+    register_spills_ = spills;
+  }
+  void loweringPasses(std::vector<LoweringPassProfile> passes) {
+    lowering_passes_ = std::move(passes);
+  }
+  void kernelRegions(std::vector<KernelRegionProfile> regions) {
+    kernel_regions_ = std::move(regions);
+  }
 
   void scheduler(const std::string& name);
   const std::string& scheduler() const;
@@ -209,6 +290,21 @@ class SegmentProfiler {
   int64_t outputBytes() const {
     return output_bytes_;
   }
+  int64_t flops() const {
+    return flops_;
+  }
+  float occupancy() const {
+    return occupancy_;
+  }
+  int registerSpills() const {
+    return register_spills_;
+  }
+  const std::vector<LoweringPassProfile>& loweringPasses() const {
+    return lowering_passes_;
+  }
+  const std::vector<KernelRegionProfile>& kernelRegions() const {
+    return kernel_regions_;
+  }
   double compileTime() {
     return compile_timer_.time();
   }
@@ -225,6 +321,11 @@ class SegmentProfiler {
   HostTimer compile_timer_;
   int64_t input_bytes_;
   int64_t output_bytes_;
+  int64_t flops_ = 0;
+  float occupancy_ = 0.0;
+  int register_spills_ = -1;
+  std::vector<LoweringPassProfile> lowering_passes_;
+  std::vector<KernelRegionProfile> kernel_regions_;
   std::string scheduler_;
   ProfilerState kernel_profile_state_;
 };
@@ -19,6 +19,9 @@
 #include <options.h>
 #include <scheduler/debug_utils.h>
 #include <scheduler/normalization_utils.h>
+#include <scheduler/reduction.h>
+#include <scheduler/utils.h>
+#include <segmentation_cost_model.h>
 #include <algorithm>
 
 #include <sstream>
@@ -1935,24 +1938,13 @@ void eraseInputDistinctRootDomains(Fusion* fusion) {
 
 std::pair<IrCloner, std::unique_ptr<Fusion>> SegmentedFusion::makeFusion(
     SegmentedGroup* sg) {
-  // TODO Optimize cloning step by only copying values and expressions between
-  // the fusion segment's inputs and outputs.
+  // Only copy the exprs of the segment, so the cost of creating the fusions
+  // of all segments is linear in the size of the complete fusion. The
+  // segment fusion has no inputs or outputs yet.
   auto fusion_segment = std::make_unique<Fusion>();
 
   IrCloner complete_to_segment_map =
-      Fusion::copy(completeFusion(), fusion_segment.get());
-
-  std::vector<Val*> input_list(
-      fusion_segment->inputs().begin(), fusion_segment->inputs().end());
-  for (auto inp : input_list) {
-    fusion_segment->removeInput(inp);
-  }
-
-  std::vector<Val*> output_list(
-      fusion_segment->outputs().begin(), fusion_segment->outputs().end());
-  for (auto out : output_list) {
-    fusion_segment->removeOutput(out);
-  }
+      Fusion::copy(completeFusion(), fusion_segment.get(), sg->exprs());
 
   std::vector<TensorView*> view_tvs;
   for (auto inp : getAllInputs(sg)) {
@@ -1980,8 +1972,19 @@ std::pair<IrCloner, std::unique_ptr<Fusion>> SegmentedFusion::makeFusion(
 std::unique_ptr<SegmentedFusion> SegmentCandidateFinder::segment(
     std::unique_ptr<Fusion> fusion,
     const KernelArgumentHolder* inputs,
-    SchedulerRuntimeInfo& runtime_info) {
-  if (!hasSegmentHints(fusion.get())) {
+    SchedulerRuntimeInfo& runtime_info,
+    SegmentationCache* segmentation_cache) {
+  FUSER_PERF_SCOPE("SegmentCandidateFinder::segment");
+  // The partial and final reductions of split reductions are never scheduled
+  // as one kernel, and the cache can't record their new exprs
+  const bool split_reductions = !hasSegmentHints(fusion.get()) &&
+      isOptionEnabled(EnableOption::SplitReduction) &&
+      splitReductionsInFusion(fusion.get(), runtime_info);
+  if (split_reductions) {
+    scheduler_debug_utils::canScheduleMessage(
+        "***Runtime***: Split reductions, skip un-segmented scheduling.\n");
+    segmentation_cache = nullptr;
+  } else if (!hasSegmentHints(fusion.get())) {
     scheduler_debug_utils::canScheduleMessage(
         "***Runtime***: Try to schedule fusion un-segmented:\n");
     const auto maybe_complete_fusion_heuristic =
@@ -1995,9 +1998,21 @@ std::unique_ptr<SegmentedFusion> SegmentCandidateFinder::segment(
         "***Runtime***: Has segment hints, skip un-segmented scheduling.\n");
   }
   if (fusion) {
+    if (segmentation_cache != nullptr) {
+      std::unique_ptr<SegmentedFusion> segmented_fusion =
+          segmentation_cache->reuse(fusion.get(), *inputs);
+      if (segmented_fusion != nullptr) {
+        return segmented_fusion;
+      }
+    }
     scheduler_debug_utils::canScheduleMessage(
         "\n***Runtime***: Try to schedule fusion segmented:\n");
-    return SegmentCandidateFinder::segment(std::move(fusion), inputs);
+    std::unique_ptr<SegmentedFusion> segmented_fusion =
+        SegmentCandidateFinder::segment(std::move(fusion), inputs);
+    if (segmentation_cache != nullptr) {
+      segmentation_cache->insert(segmented_fusion.get());
+    }
+    return segmented_fusion;
   } else {
     NVF_ERROR(false, "unreachable!");
   }
@@ -2563,6 +2578,19 @@ std::optional<ScheduleHeuristic> tryMerge(
       segmented_fusion->completeFusion(), runtime_info);
 }
 
+//! Time of the merged group of a and b predicted by `model`
+double predictTimeUs(
+    SegmentationCostModel* model,
+    SegmentedFusion* segmented_fusion,
+    SchedulerRuntimeInfo& runtime_info,
+    ScheduleHeuristic heuristic,
+    SegmentedGroup* a,
+    SegmentedGroup* b = nullptr) {
+  FusionSegmentGuard fsg(segmented_fusion, a, b);
+  return model->predictTimeUs(
+      segmented_fusion->completeFusion(), heuristic, runtime_info);
+}
+
 std::optional<ScheduleHeuristic> tryMerge(
     SegmentedFusion* segmented_fusion,
     SchedulerRuntimeInfo& runtime_info,
@@ -2617,6 +2645,92 @@ void deDuplicateScalarExprs(std::vector<Expr*>& exprs) {
 
 } // namespace
 
+// [ Note -- Segmentation cache ]
+//
+// The runtimes a FusionExecutorCache creates for the same concretization of
+// its fusion all segment the same Fusion, and only differ by the extents of
+// their inputs. The segmentation search proposes a scheduler for many
+// candidate merges, which dominates the host time of creating a runtime,
+// while the resulting segmentation is often the same for every shape.
+//
+// With EnableOption::SegmentationCache, each segmentation found by the search
+// is serialized into the SegmentationCache of the concretization, reusing the
+// serde path. Before searching for a new runtime, the recorded segmentations
+// are rebuilt on a copy of the fusion, in the order they were found, and the
+// first one whose scheduler-acceptance signature is unchanged is used. The
+// signature is the scheduler proposed for each group, checked the same way
+// the search checks a merge. The complete fusion has already been checked
+// not to be schedulable as a single kernel at this point.
+//
+// The signature only covers the final groups, not the merges the search
+// rejected, so a new search might merge more groups for the new shapes. This
+// is why the cache is opt-in.
+std::unique_ptr<SegmentedFusion> SegmentationCache::reuse(
+    const Fusion* fusion,
+    const KernelArgumentHolder& inputs) {
+  FUSER_PERF_SCOPE("SegmentationCache::reuse");
+  for (const auto& entry : entries_) {
+    const auto* buffer =
+        flatbuffers::GetRoot<serde::SegmentedFusion>(entry.data());
+
+    // Same as deserializing a FusionKernelRuntime, Welford ops have to be
+    // translated again for the persistent schedulers
+    auto fusion_copy = std::make_unique<Fusion>(*fusion);
+    bool has_persistent_heuristic = std::any_of(
+        buffer->groups()->begin(),
+        buffer->groups()->end(),
+        [](const serde::SegmentedGroup* sg) {
+          auto heuristic = static_cast<ScheduleHeuristic>(sg->heuristic());
+          return heuristic == ScheduleHeuristic::InnerPersistent ||
+              heuristic == ScheduleHeuristic::OuterPersistent ||
+              heuristic == ScheduleHeuristic::InnerOuterPersistent;
+        });
+    if (has_persistent_heuristic &&
+        ir_utils::hasOpsOfType<WelfordOp>(fusion_copy.get())) {
+      SegmentCandidateFinder::translateWelfordInFusion(
+          fusion_copy.get(), inputs);
+    }
+
+    auto segmented_fusion =
+        std::make_unique<SegmentedFusion>(std::move(fusion_copy));
+    segmented_fusion->deserialize(buffer);
+
+    SchedulerRuntimeInfo runtime_info(
+        segmented_fusion->completeFusion(), inputs);
+    bool accepted = std::all_of(
+        segmented_fusion->groups().begin(),
+        segmented_fusion->groups().end(),
+        [&](SegmentedGroup* group) {
+          return group->exprs().empty() ||
+              tryMerge(segmented_fusion.get(), runtime_info, group) ==
+              group->heuristic();
+        });
+    if (accepted) {
+      num_hits_++;
+      return segmented_fusion;
+    }
+  }
+  num_misses_++;
+  return nullptr;
+}
+
+void SegmentationCache::insert(const SegmentedFusion* segmented_fusion) {
+  FUSER_PERF_SCOPE("SegmentationCache::insert");
+  flatbuffers::FlatBufferBuilder builder;
+  builder.Finish(segmented_fusion->serialize(builder));
+  if (!flatbuffers::GetRoot<serde::SegmentedFusion>(
+           builder.GetBufferPointer())
+           ->valid()) {
+    return;
+  }
+  std::vector<uint8_t> entry(
+      builder.GetBufferPointer(),
+      builder.GetBufferPointer() + builder.GetSize());
+  if (std::find(entries_.begin(), entries_.end(), entry) == entries_.end()) {
+    entries_.push_back(std::move(entry));
+  }
+}
+
 std::optional<std::unique_ptr<SchedulerEntry>> SegmentedGroup::
     getMaybeSchedulerEntry(SchedulerRuntimeInfo& runtime_info) {
   FUSER_PERF_SCOPE("SegmentedFusion::getMaybeSchedulerEntry");
@@ -3019,6 +3133,162 @@ bool SegmentCandidateFinder::translateWelfordInFusion(
   return TranslateApplicableWelford::run(fusion, runtime_inputs);
 }
 
+// Note [Split reductions]
+//
+// When blocks that each reduce whole outputs can't fill the device, the
+// reduction scheduler splits the reduction domain across the grid. Every
+// block then writes its partial results to a workspace, and the last block to
+// arrive at a semaphore reduces them. The semaphores are zero filled before
+// each launch, the final reduction of each output is left to a single block,
+// and persistent grid reductions also need all blocks to be co-resident.
+//
+// With NVFUSER_ENABLE=split_reduction, splitReductionPartials compares such a
+// grid reduction with a split reduction: a partial reduction segment reduces
+// each of N chunks of the reduction domain of every output, and a final
+// reduction segment reduces the N partial results. When the split is
+// predicted to be faster, each reduction tensor is rfactored before
+// segmentation:
+//
+//   T1[I, rR] = sum(T0[I, R])
+//
+// becomes
+//
+//   T2[I, N, rceilDiv(R, N)] = sum(T0[I, R])
+//   T1[I, rN] = sum(T2[I, N])
+//
+// The two reductions don't have the same reduction pattern, so the segmenter
+// keeps them apart, and T2 is the workspace of the split reduction, allocated
+// by the runtime like any other segment edge. N is a constant and the chunks
+// come from an outer split of R, so the segmented fusion remains valid for
+// other extents of R.
+//
+// split_reduction(N) splits every fusion the reduction scheduler accepts into
+// N partial results regardless of the cost model.
+
+namespace {
+
+//! Number of partial results forced with NVFUSER_ENABLE=split_reduction(N), or
+//! 0 to use the cost model
+int64_t forcedSplitReductionPartials() {
+  const auto& args = getEnableOptionArguments(EnableOption::SplitReduction);
+  if (args.empty()) {
+    return 0;
+  }
+  int64_t partials = 0;
+  try {
+    partials = std::stoll(args[0]);
+  } catch (const std::exception&) {
+    NVF_CHECK(false, "Invalid number of split_reduction partials: ", args[0]);
+  }
+  NVF_CHECK(
+      partials > 1,
+      "split_reduction needs at least 2 partial results, but got ",
+      partials);
+  return partials;
+}
+
+//! First and last position of the reduction dimensions of `tv`, or
+//! std::nullopt if they are not consecutive or `tv` has been transformed
+std::optional<std::pair<int64_t, int64_t>> consecutiveReductionAxes(
+    TensorView* tv) {
+  if (tv->domain()->hasRoot() ||
+      tv->getLoopDomain() != tv->getLogicalDomain()) {
+    return std::nullopt;
+  }
+  int64_t first = -1;
+  int64_t last = -1;
+  for (auto i : c10::irange(tv->nDims())) {
+    if (!tv->axis(i)->isReduction()) {
+      continue;
+    }
+    if (last >= 0 && last != i - 1) {
+      return std::nullopt;
+    }
+    if (first < 0) {
+      first = i;
+    }
+    last = i;
+  }
+  if (first < 0) {
+    return std::nullopt;
+  }
+  return std::make_pair(first, last);
+}
+
+} // namespace
+
+bool SegmentCandidateFinder::splitReductionsInFusion(
+    Fusion* fusion,
+    SchedulerRuntimeInfo& runtime_info) {
+  FUSER_PERF_SCOPE("SegmentCandidateFinder::splitReductionsInFusion");
+  FusionGuard fg(fusion);
+  std::vector<TensorView*> reduction_tvs =
+      scheduler_utils::getReductionTvs(fusion);
+  if (reduction_tvs.empty()) {
+    return false;
+  }
+  std::vector<std::pair<int64_t, int64_t>> reduction_axes;
+  int64_t partial_dtype_size = 0;
+  for (TensorView* tv : reduction_tvs) {
+    if (!tv->definition()->isStrictlyOneOf<ReductionOp>()) {
+      return false;
+    }
+    auto axes = consecutiveReductionAxes(tv);
+    if (!axes.has_value()) {
+      return false;
+    }
+    reduction_axes.push_back(axes.value());
+    partial_dtype_size += dataTypeSize(tv->getDataType().value());
+  }
+
+  // Only the grid reductions of the reduction scheduler are replaced
+  if (!SchedulerEntry::canSchedule(
+          ScheduleHeuristic::Reduction, fusion, runtime_info)) {
+    return false;
+  }
+
+  int64_t partials = forcedSplitReductionPartials();
+  if (partials == 0) {
+    std::shared_ptr<ReductionParams> rparams =
+        getReductionHeuristics(fusion, runtime_info);
+    auto properties = scheduler_utils::getReductionProperties(
+        fusion, runtime_info, reduction_tvs.front());
+    int64_t input_bytes = 0;
+    for (auto tv : ir_utils::filterByType<TensorView>(fusion->inputs())) {
+      int64_t numel = 1;
+      for (IterDomain* id :
+           TensorDomain::noReductions(tv->getLogicalDomain())) {
+        if (!id->isBroadcast()) {
+          numel *= runtime_info.expressionEvaluator()
+                       .evaluate(id->extent())
+                       .as<int64_t>();
+        }
+      }
+      input_bytes += numel * dataTypeSize(tv->getDataType().value());
+    }
+    partials = splitReductionPartials(
+        *rparams,
+        properties.total_iteration_numel,
+        properties.total_reduction_numel,
+        input_bytes,
+        partial_dtype_size);
+  }
+  if (partials <= 1) {
+    return false;
+  }
+
+  for (auto i : c10::irange(reduction_tvs.size())) {
+    TensorView* tv = reduction_tvs.at(i);
+    auto [first, last] = reduction_axes.at(i);
+    for (int64_t axis = first; axis < last; ++axis) {
+      tv->merge(first);
+    }
+    tv->split(first, partials, /*inner_split=*/false);
+    tv->rFactor({first + 1});
+  }
+  return true;
+}
+
 //! CombineReductions:
 //!  This pass works before the main merge node process
 //!    It identifies reduction operations that can be combined
@@ -3683,7 +3953,53 @@ bool SegmentCandidateFinder::codeGenSupportedMerge(
     return true;
   }
   auto h = tryMerge(segmented_fusion_.get(), runtimeInfo(), group1, group2);
-  return h.has_value();
+  if (!h.has_value()) {
+    return false;
+  }
+  return isMergeProfitable(group1, group2, h.value());
+}
+
+bool SegmentCandidateFinder::isMergeProfitable(
+    SegmentedGroup* group1,
+    SegmentedGroup* group2,
+    ScheduleHeuristic merged_heuristic) {
+  SegmentationCostModel* model = getSegmentationCostModel();
+  if (model == nullptr) {
+    return true;
+  }
+  FUSER_PERF_SCOPE("SegmentCandidateFinder::isMergeProfitable");
+
+  // See [ Note -- Segmentation cost model ]
+  double separate_time_us = 0.0;
+  for (auto group : {group1, group2}) {
+    std::optional<ScheduleHeuristic> h = group->heuristic();
+    if (h == ScheduleHeuristic::None) {
+      h = tryMerge(segmented_fusion_.get(), runtimeInfo(), group);
+    }
+    if (!h.has_value()) {
+      // The merge may be needed to schedule this group at all
+      return true;
+    }
+    separate_time_us += predictTimeUs(
+        model, segmented_fusion_.get(), runtimeInfo(), h.value(), group);
+  }
+  const double merged_time_us = predictTimeUs(
+      model,
+      segmented_fusion_.get(),
+      runtimeInfo(),
+      merged_heuristic,
+      group1,
+      group2);
+
+  const bool profitable = merged_time_us <= separate_time_us;
+  scheduler_debug_utils::canScheduleMessage(
+      "**Segmenter** Cost model predicts ",
+      merged_time_us,
+      "us merged and ",
+      separate_time_us,
+      "us separately, ",
+      profitable ? "merging" : "not merging");
+  return profitable;
 }
 
 // TODO: consider caching the heuristics value so tryMerge doesn't have to be
@@ -3944,6 +4260,11 @@ void SegmentCandidateFinder::findSegments() {
     finalMerge();
   }
 
+  if (!options_.only_segment_resharding_exprs &&
+      isOptionEnabled(EnableOption::HorizontalFusion)) {
+    horizontalMerge();
+  }
+
   segmented_fusion_->validateIfDebug();
 
   // Resolve all the input expressions needed in each group
@@ -3957,6 +4278,11 @@ void SegmentCandidateFinder::findSegments() {
   // Forwarded input groups are no longer used. Clean them up.
   cleanupForwardedInputs();
 
+  if (!options_.only_segment_resharding_exprs &&
+      isOptionEnabled(EnableOption::SegmentRecomputation)) {
+    recomputeCheapEdges();
+  }
+
   finalize();
 
   // Do sanity check on the final graph.
@@ -4148,6 +4474,206 @@ void SegmentCandidateFinder::finalMerge() {
   }
 }
 
+// [ Note -- Horizontal fusion ]
+//
+// Optimizer steps and other per-parameter computations leave many small
+// segments that do not depend on each other, and each of them pays for a
+// kernel launch. With NVFUSER_ENABLE=horizontal_fusion, the segmenter merges
+// such segments into one kernel after the other merge passes: a pair of
+// PointWise groups with no path between them is merged when the pointwise
+// scheduler accepts the resulting disconnected group. Without a path between
+// the groups, the merge cannot create a cycle in the segment graph. The
+// registry lets disconnected fusions through only for the
+// pointwise scheduler, and only with this option, so an unsegmented
+// disconnected pointwise fusion also becomes a single kernel.
+//
+// The pointwise scheduler finds a reference tensor for each connected
+// component and applies the 1D schedule to each of them. All components are
+// parallelized on BIDx and TIDx, so the grid is sized by the largest
+// component and the blocks past the end of a smaller component are predicated
+// out of it, rather than dispatching disjoint blockIdx ranges to each
+// component. Horizontal schedules are not vectorized, as the components are
+// expected to be latency bound.
+//
+// Reduction groups are not merged. Their schedule derives one set of
+// ReductionParams from a reference reduction, and grid reductions assume the
+// parallel extents of that reference.
+
+//! Maximum number of tensor inputs and outputs of a horizontally merged group,
+//! which bounds the size of the kernel parameters
+constexpr size_t max_horizontal_fusion_tensors = 64;
+
+void SegmentCandidateFinder::horizontalMerge() {
+  FUSER_PERF_SCOPE("SegmentCandidateFinder::horizontalMerge");
+  auto dependency_analysis = getGroupDependency();
+
+  bool merged_nodes = true;
+  while (merged_nodes) {
+    merged_nodes = false;
+    std::vector<SegmentedGroup*> pointwise_groups;
+    for (auto group : groups()) {
+      if (!group->isFusionInputGroup() &&
+          group->heuristic() == ScheduleHeuristic::PointWise) {
+        pointwise_groups.push_back(group);
+      }
+    }
+
+    for (auto i : c10::irange(pointwise_groups.size())) {
+      for (auto j : c10::irange(i + 1, pointwise_groups.size())) {
+        SegmentedGroup* first_group = pointwise_groups[i];
+        SegmentedGroup* second_group = pointwise_groups[j];
+        if (dependency_analysis->isProducerOf(first_group, second_group) ||
+            dependency_analysis->isConsumerOf(first_group, second_group)) {
+          continue;
+        }
+        if (getAllInputs(first_group, second_group).size() +
+                getAllOutputs(first_group, second_group).size() >
+            max_horizontal_fusion_tensors) {
+          continue;
+        }
+        auto h = tryMerge(
+            segmented_fusion_.get(), runtimeInfo(), first_group, second_group);
+        if (h != ScheduleHeuristic::PointWise ||
+            !isMergeProfitable(first_group, second_group, h.value())) {
+          continue;
+        }
+        auto joined_group = mergeAllGivenGroups({first_group, second_group});
+        dependency_analysis->mergeGroups(
+            first_group, second_group, joined_group);
+        merged_nodes = true;
+        break;
+      }
+      if (merged_nodes) {
+        break;
+      }
+    }
+  }
+}
+
+// [ Note -- Recomputing segment edges ]
+//
+// A tensor crossing a segment edge is written to global memory by its
+// producer group and read back by its consumer group. When that tensor is a
+// cheap pointwise function of fusion inputs, e.g., a scaled or cast input as
+// often found in layer norm backward graphs, the consumer can instead read
+// those inputs and recompute it. This generalizes forwardInputs, which only
+// forwards chains of single-use UnaryOps.
+//
+// With EnableOption::SegmentRecomputation, each edge whose tensor is computed
+// by at most kMaxRecomputedExprs UnaryOps, BinaryOps, TernaryOps and Sets
+// from fusion inputs is recomputed in its consumer when the bytes per element
+// of the inputs the consumer doesn't read yet don't exceed those of the edge.
+// The exprs are then shared by both groups, like resolved forwarded inputs.
+// As pointwise ops don't reduce, the inputs have at most as many elements as
+// the edge. The recomputation is reverted if the consumer can't be scheduled
+// with the same heuristic anymore. The producer keeps computing the tensor if
+// it has other uses, and an edge is not recomputed when its producer would be
+// left without outputs.
+
+namespace {
+
+constexpr int64_t kMaxRecomputedExprs = 16;
+
+// Returns the exprs computing `tv` from fusion inputs if they are cheap to
+// recompute, or nullopt
+std::optional<std::vector<Expr*>> cheapExprsTo(TensorView* tv) {
+  std::vector<Expr*> exprs = StmtSort::getExprsTo({tv});
+  if ((int64_t)exprs.size() > kMaxRecomputedExprs) {
+    return std::nullopt;
+  }
+  for (Expr* expr : exprs) {
+    const bool is_cheap = expr->isOneOf<UnaryOp, BinaryOp, TernaryOp>() ||
+        (expr->isA<LoadStoreOp>() &&
+         expr->as<LoadStoreOp>()->opType() == LoadStoreOpType::Set);
+    if (!is_cheap) {
+      return std::nullopt;
+    }
+  }
+  for (Val* leaf : IterVisitor::getInputsTo({tv})) {
+    if (!leaf->isFusionInput() && !leaf->isConstScalar()) {
+      return std::nullopt;
+    }
+  }
+  return exprs;
+}
+
+} // namespace
+
+void SegmentCandidateFinder::recomputeCheapEdges() {
+  FUSER_PERF_SCOPE("SegmentCandidateFinder::recomputeCheapEdges");
+  auto remove_edge = [](SegmentedEdge* edge,
+                        std::vector<SegmentedEdge*>& edges) {
+    edges.erase(std::remove(edges.begin(), edges.end(), edge), edges.end());
+  };
+
+  const std::vector<SegmentedEdge*> all_edges = edges();
+  for (SegmentedEdge* edge : all_edges) {
+    auto* tv = dynamic_cast<TensorView*>(edge->val);
+    if (tv == nullptr) {
+      continue;
+    }
+    SegmentedGroup* producer = edge->from;
+    SegmentedGroup* consumer = edge->to;
+    const bool producer_has_other_outputs = !producer->output_vals.empty() ||
+        std::any_of(producer->consumer_edges.begin(),
+                    producer->consumer_edges.end(),
+                    [tv](SegmentedEdge* e) { return e->val != tv; });
+    if (!producer_has_other_outputs) {
+      continue;
+    }
+    std::optional<std::vector<Expr*>> exprs = cheapExprsTo(tv);
+    if (!exprs.has_value()) {
+      continue;
+    }
+
+    std::vector<Val*> new_inputs;
+    for (Val* leaf : IterVisitor::getInputsTo({tv})) {
+      if (leaf->isFusionInput() &&
+          std::find(
+              consumer->input_vals.begin(), consumer->input_vals.end(), leaf) ==
+              consumer->input_vals.end()) {
+        new_inputs.push_back(leaf);
+      }
+    }
+    int64_t added_bytes = 0;
+    for (auto leaf : ir_utils::filterByType<TensorView>(new_inputs)) {
+      added_bytes += dataTypeSize(leaf->dtype());
+    }
+    if (added_bytes > dataTypeSize(tv->dtype())) {
+      continue;
+    }
+
+    // Recompute tv in the consumer, and revert if it can't be scheduled
+    const std::vector<Expr*> original_exprs = consumer->exprs_;
+    const std::vector<Val*> original_inputs = consumer->input_vals;
+    std::unordered_set<Expr*> consumer_exprs(
+        consumer->exprs_.begin(), consumer->exprs_.end());
+    std::vector<Expr*> recomputed_exprs;
+    std::copy_if(
+        exprs->begin(),
+        exprs->end(),
+        std::back_inserter(recomputed_exprs),
+        [&](Expr* expr) { return consumer_exprs.count(expr) == 0; });
+    consumer->exprs_.insert(
+        consumer->exprs_.begin(),
+        recomputed_exprs.begin(),
+        recomputed_exprs.end());
+    consumer->input_vals.insert(
+        consumer->input_vals.end(), new_inputs.begin(), new_inputs.end());
+    remove_edge(edge, consumer->producer_edges);
+
+    if (tryMerge(segmented_fusion_.get(), runtimeInfo(), consumer) !=
+        consumer->heuristic()) {
+      consumer->exprs_ = original_exprs;
+      consumer->input_vals = original_inputs;
+      consumer->producer_edges.push_back(edge);
+      continue;
+    }
+    remove_edge(edge, producer->consumer_edges);
+    remove_edge(edge, edges());
+  }
+}
+
 void SegmentCandidateFinder::resolveScalarsInGroup(SegmentedGroup* group) {
   std::vector<Val*> to_visit;
   std::unordered_set<Val*> visited;
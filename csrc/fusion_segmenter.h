@@ -534,6 +534,47 @@ std::ostream& operator<<(
     std::ostream& os,
     const SegmentedFusion* segmented_fusion);
 
+//! Segmentations found by SegmentCandidateFinder for fusions of the same
+//! concretized structure. FusionExecutorCache keeps one per concretization
+//! of its fusion, so that the runtimes it creates for new input shapes can
+//! skip the segmentation search. See [ Note -- Segmentation cache ] in
+//! fusion_segmenter.cpp.
+class SegmentationCache : public NonCopyable {
+ public:
+  //! Rebuild the segmentation of a copy of `fusion` from the first recorded
+  //! segmentation whose groups are still accepted by their schedulers for
+  //! `inputs`. Returns nullptr if no recorded segmentation applies.
+  std::unique_ptr<SegmentedFusion> reuse(
+      const Fusion* fusion,
+      const KernelArgumentHolder& inputs);
+
+  //! Record the segmentation of `segmented_fusion`. Segmentations referring
+  //! to statements created during the search cannot be rebuilt and are not
+  //! recorded.
+  void insert(const SegmentedFusion* segmented_fusion);
+
+  //! Number of recorded segmentations
+  size_t size() const {
+    return entries_.size();
+  }
+
+  //! Number of segmentations rebuilt from a recorded one
+  int64_t hits() const {
+    return num_hits_;
+  }
+
+  //! Number of times no recorded segmentation applied
+  int64_t misses() const {
+    return num_misses_;
+  }
+
+ private:
+  //! Flatbuffers of serde::SegmentedFusion
+  std::vector<std::vector<uint8_t>> entries_;
+  int64_t num_hits_ = 0;
+  int64_t num_misses_ = 0;
+};
+
 //! This is a base class for segmenter analysis
 //!  provides the minimal implementation on header so that
 //!  a unique_ptr can use this base class
@@ -604,10 +645,14 @@ class SegmentCandidateFinder {
     return std::move(scf.segmented_fusion_);
   }
 
+  //! Segment the fusion unless it can be scheduled as a single kernel. If
+  //! `segmentation_cache` is given, a recorded segmentation is reused when
+  //! possible, and new segmentations are recorded.
   static std::unique_ptr<SegmentedFusion> segment(
       std::unique_ptr<Fusion> fusion,
       const KernelArgumentHolder* inputs,
-      SchedulerRuntimeInfo& runtime_info);
+      SchedulerRuntimeInfo& runtime_info,
+      SegmentationCache* segmentation_cache = nullptr);
 
   static bool hasSegmentHints(Fusion* fusion);
 
@@ -615,6 +660,14 @@ class SegmentCandidateFinder {
       Fusion* fusion,
       const KernelArgumentHolder& runtime_inputs);
 
+  //! Replace the reductions of `fusion` with partial and final reductions if
+  //! they are predicted to be faster than its grid reduction. Returns true if
+  //! the fusion was modified. See Note [Split reductions] in
+  //! fusion_segmenter.cpp
+  NVF_API static bool splitReductionsInFusion(
+      Fusion* fusion,
+      SchedulerRuntimeInfo& runtime_info);
+
  private:
   // Perform segmentation on and take ownership of the given fusion
   NVF_API SegmentCandidateFinder(
@@ -630,6 +683,14 @@ class SegmentCandidateFinder {
 
   bool codeGenSupportedMerge(SegmentedGroup* group1, SegmentedGroup* group2);
 
+  //! Whether the segmentation cost model, if enabled, predicts the merged
+  //! group of group1 and group2 scheduled with merged_heuristic to be no
+  //! slower than the two groups
+  bool isMergeProfitable(
+      SegmentedGroup* group1,
+      SegmentedGroup* group2,
+      ScheduleHeuristic merged_heuristic);
+
   void buildInitialSegments();
 
   void findSegments();
@@ -687,6 +748,16 @@ class SegmentCandidateFinder {
   //!   produces the consumer.
   void finalMerge();
 
+  //! Merges pairs of independent PointWise groups into one kernel until no
+  //!  pair is accepted by the pointwise scheduler, see
+  //!  [ Note -- Horizontal fusion ]
+  void horizontalMerge();
+
+  //! Recomputes in consumer groups the segment edges that are cheap
+  //!  pointwise functions of fusion inputs, when that reads fewer bytes than
+  //!  the edge, see [ Note -- Recomputing segment edges ]
+  void recomputeCheapEdges();
+
   //! Duplicate and add all exprs producing the used
   //!  scalar values in group
   void resolveScalarsInGroup(SegmentedGroup* group);
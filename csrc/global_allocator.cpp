@@ -6,20 +6,73 @@
  */
 // clang-format on
 
+#include <cuda_utils.h>
 #include <debug.h>
 #include <global_allocator.h>
 #include <options.h>
 #include <type.h>
 
 #include <ATen/ATen.h>
+#include <c10/cuda/CUDAGraphsC10Utils.h>
+#include <c10/cuda/CUDAStream.h>
+#include <cuda_runtime.h>
+
+#include <map>
+#include <utility>
+#include <vector>
 
 namespace nvfuser {
 
+// Note [Zeroed workspace pool]
+// Kernels that leave their zero-initialized buffers dirty, e.g. grid reductions
+// whose work buffers do not reset to zero, can't use the arena below. Instead
+// of allocating and zeroing a new tensor at every launch, they take a workspace
+// from a pool owned by the current thread for the current device and stream.
+// Workspaces are grouped in power-of-two size classes, and each size class
+// keeps a free list of fully zeroed buffers. A freshly allocated buffer is
+// zeroed with cudaMemsetAsync on the stream of its pool.
+//
+// Reuse is ordered by streams: releaseZeroedMemory, called after each launch,
+// issues a cudaMemsetAsync of the bytes handed out to each workspace taken
+// since the previous release on the stream of its pool, i.e. after the kernel
+// that used it, and only then puts it back on the free list. The next kernel
+// taking it on that stream runs after the memset, so it sees zeros without any
+// host synchronization. Since pools are never shared between streams, a
+// workspace is only ever used by work ordered on a single stream, and
+// concurrent streams never race on it. Like the arena, pools keep their
+// buffers at the high-water mark until the thread terminates, and are
+// bypassed while capturing a CUDA graph.
+
 namespace {
 
-// For each device, we maintain an arena tensor which we will slice to provide
-// individual tensors. These tensors will grow in size and remain at the
-// high-water mark for their particular device until the thread terminates.
+// Zero `bytes` bytes of `buffer` with a memset issued to `stream`
+void memsetZeroAsync(
+    const at::Tensor& buffer,
+    int64_t bytes,
+    const c10::cuda::CUDAStream& stream) {
+  if (bytes == 0) {
+    return;
+  }
+  NVFUSER_CUDA_RT_SAFE_CALL(
+      cudaMemsetAsync(buffer.data_ptr(), 0, (size_t)bytes, stream.stream()));
+}
+
+// Number of bytes of a contiguous tensor
+int64_t tensorBytes(
+    const std::vector<int64_t>& sizes,
+    const c10::ScalarType& aten_dtype) {
+  int64_t bytes = dataTypeSize(aten_to_data_type(aten_dtype));
+  for (auto sz : sizes) {
+    bytes *= sz;
+  }
+  return bytes;
+}
+
+// For each device and stream, we maintain an arena tensor which we will slice
+// to provide individual tensors. These tensors will grow in size and remain at
+// the high-water mark for their particular device and stream until the thread
+// terminates. Kernels launched on different streams may run concurrently, so
+// they must not share the zeroed memory.
 class Arena {
  public:
   // Mark allocated_bytes_ as 0, allowing all available zeroed memory to be
@@ -37,10 +90,7 @@ class Arena {
       const c10::ScalarType& aten_dtype,
       const c10::Device& device) {
     // determine number of bytes needed for this tensor
-    int64_t new_bytes = dataTypeSize(aten_to_data_type(aten_dtype));
-    for (auto sz : sizes) {
-      new_bytes *= sz;
-    }
+    int64_t new_bytes = tensorBytes(sizes, aten_dtype);
 
     // align at 16 bytes regardless of requested dtype
     int64_t aligned_allocated_bytes = (allocated_bytes_ + 15) & (~15);
@@ -58,9 +108,13 @@ class Arena {
         debug() << "[global zeroed memory] Resizing arena to " << new_used_bytes
                 << " bytes" << std::endl;
       }
-      tensor_ = at::zeros(
+      tensor_ = at::empty(
           {new_used_bytes},
           at::TensorOptions().dtype(at::kByte).device(device));
+      memsetZeroAsync(
+          tensor_,
+          new_used_bytes,
+          c10::cuda::getCurrentCUDAStream(device.index()));
     }
 
     if (isDebugDumpEnabled(DebugDumpOption::GlobalZeroedMemory)) {
@@ -100,8 +154,71 @@ class Arena {
   int64_t allocated_bytes_ = 0LL;
 };
 
-// We hold one Arena for each device
-thread_local std::vector<Arena> arenas;
+// We hold one Arena for each device and stream
+thread_local std::map<std::pair<c10::DeviceIndex, c10::StreamId>, Arena>
+    arenas;
+
+// Pool of zeroed workspaces of one device and stream. See Note [Zeroed
+// workspace pool]
+class WorkspacePool {
+ public:
+  explicit WorkspacePool(const c10::cuda::CUDAStream& stream)
+      : stream_(stream) {}
+
+  at::Tensor getTensor(
+      const std::vector<int64_t>& sizes,
+      const c10::ScalarType& aten_dtype,
+      const c10::Device& device) {
+    const int64_t bytes = tensorBytes(sizes, aten_dtype);
+    // Minimum size class is 512B
+    int64_t size_class = 512;
+    while (size_class < bytes) {
+      size_class *= 2;
+    }
+
+    at::Tensor buffer;
+    std::vector<at::Tensor>& free_buffers = free_buffers_[size_class];
+    if (free_buffers.empty()) {
+      if (isDebugDumpEnabled(DebugDumpOption::GlobalZeroedMemory)) {
+        debug() << "[global zeroed memory] Allocating workspace of "
+                << size_class << " bytes" << std::endl;
+      }
+      buffer = at::empty(
+          {size_class}, at::TensorOptions().dtype(at::kByte).device(device));
+      memsetZeroAsync(buffer, size_class, stream_);
+    } else {
+      buffer = std::move(free_buffers.back());
+      free_buffers.pop_back();
+    }
+    in_use_.emplace_back(buffer, bytes);
+
+    return buffer.index({at::indexing::Slice(0, bytes, 1)})
+        .view(aten_dtype)
+        .view(sizes);
+  }
+
+  // Zero the bytes handed out from the workspaces in use and put them back on
+  // the free lists. Work issued to stream_ after this sees them zeroed.
+  void release() {
+    for (auto& [buffer, bytes] : in_use_) {
+      memsetZeroAsync(buffer, bytes, stream_);
+      free_buffers_[buffer.numel()].push_back(std::move(buffer));
+    }
+    in_use_.clear();
+  }
+
+ private:
+  c10::cuda::CUDAStream stream_;
+  // Zeroed buffers by size class
+  std::map<int64_t, std::vector<at::Tensor>> free_buffers_;
+  // Buffers handed out since the last release, with the number of bytes used
+  std::vector<std::pair<at::Tensor, int64_t>> in_use_;
+};
+
+// We hold one WorkspacePool for each device and stream
+thread_local std::
+    map<std::pair<c10::DeviceIndex, c10::StreamId>, WorkspacePool>
+        workspace_pools;
 
 } // namespace
 
@@ -110,25 +227,60 @@ at::Tensor contigZeroedTensor(
     const c10::ScalarType& aten_dtype,
     const c10::Device& device) {
   NVF_ERROR(device.is_cuda(), "contigZeroTensor requires CUDA device");
-  // Intermediate cast from int8_t to uint8_t for clarity:
-  // https://clang.llvm.org/extra/clang-tidy/checks/bugprone/signed-char-misuse.html
-  size_t device_num = (uint8_t)device.index();
 
-  // get arena from device number, resizing arenas if needed
-  if (device_num >= arenas.size()) {
-    arenas.resize(device_num + 1);
+  // A graph being captured would keep referring to the arena after it has been
+  // resized or reused by other kernels, so give it a buffer of its own. The
+  // memset zeroing it is captured along with the kernels using it.
+  if (c10::cuda::currentStreamCaptureStatusMayInitCtx() !=
+      c10::cuda::CaptureStatus::None) {
+    if (isDebugDumpEnabled(DebugDumpOption::GlobalZeroedMemory)) {
+      debug() << "[global zeroed memory] Allocating private buffer while "
+              << "capturing a CUDA graph" << std::endl;
+    }
+    return at::zeros(
+        sizes, at::TensorOptions().dtype(aten_dtype).device(device));
   }
 
+  // get arena from device and current stream, creating it if needed
+  const c10::cuda::CUDAStream stream =
+      c10::cuda::getCurrentCUDAStream(device.index());
+  Arena& arena = arenas[{device.index(), stream.id()}];
+
   // request tensor from arena
-  return arenas[device_num].getTensor(sizes, aten_dtype, device);
+  return arena.getTensor(sizes, aten_dtype, device);
+}
+
+at::Tensor zeroedWorkspace(
+    const std::vector<int64_t>& sizes,
+    const c10::ScalarType& aten_dtype,
+    const c10::Device& device) {
+  NVF_ERROR(device.is_cuda(), "zeroedWorkspace requires CUDA device");
+
+  // Graph replays would keep using the workspace after it has been handed out
+  // again, so a graph being captured gets a buffer of its own.
+  if (c10::cuda::currentStreamCaptureStatusMayInitCtx() !=
+      c10::cuda::CaptureStatus::None) {
+    return at::zeros(
+        sizes, at::TensorOptions().dtype(aten_dtype).device(device));
+  }
+
+  const c10::cuda::CUDAStream stream =
+      c10::cuda::getCurrentCUDAStream(device.index());
+  WorkspacePool& pool =
+      workspace_pools.try_emplace({device.index(), stream.id()}, stream)
+          .first->second;
+  return pool.getTensor(sizes, aten_dtype, device);
 }
 
 // Note that this does not free allocated zeroed memory, but rather it marks all
 // zeroed memory as available for re-use.
 void releaseZeroedMemory() {
-  for (Arena& a : arenas) {
+  for (auto& [key, a] : arenas) {
     a.reset();
   }
+  for (auto& [key, pool] : workspace_pools) {
+    pool.release();
+  }
 }
 
 } // namespace nvfuser
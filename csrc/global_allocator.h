@@ -19,9 +19,20 @@ at::Tensor contigZeroedTensor(
     const c10::ScalarType& aten_dtype,
     const c10::Device& device);
 
+//! This returns a zeroed buffer from a pool of the current device and stream,
+//! for kernels that do not reset the memory to zero, e.g. grid reduction work
+//! buffers. The buffer is zeroed again on that stream when it is released.
+//! See Note [Zeroed workspace pool] in the cpp file.
+at::Tensor zeroedWorkspace(
+    const std::vector<int64_t>& sizes,
+    const c10::ScalarType& aten_dtype,
+    const c10::Device& device);
+
 //! This should be called after each kernel launch to allow subsequent launches
 //! to re-use allocated memory. Note that it does not free allocated zeroed
-//! memory, but rather it marks all zeroed memory as available for re-use.
+//! memory, but rather it marks all zeroed memory as available for re-use. The
+//! workspaces of zeroedWorkspace are first zeroed with memsets issued to the
+//! streams they were taken on.
 void releaseZeroedMemory();
 
 } // namespace nvfuser
@@ -41,6 +41,14 @@ class HostIrContainer final : public Fusion {
     return top_level_exprs_.push_back(expr);
   }
 
+  //! Replaces the host program, e.g., after reordering it
+  void resetTopLevelExprs(std::vector<Expr*> exprs) {
+    for (Expr* expr : exprs) {
+      assertInContainer(expr, "Cannot add expr, ");
+    }
+    top_level_exprs_ = std::move(exprs);
+  }
+
   Stream* getDefaultStream();
 
  private:
@@ -9,11 +9,28 @@
 #include <dynamic_transform.h>
 #include <host_ir/executor.h>
 #include <ir/utils.h>
+#include <options.h>
+
+#include <ATen/cuda/CUDAEvent.h>
+#include <c10/cuda/CUDACachingAllocator.h>
+#include <c10/cuda/CUDAGuard.h>
 
 namespace nvfuser {
 
 namespace hir {
 
+std::ostream& operator<<(std::ostream& out, const PipelineSchedule& schedule) {
+  switch (schedule) {
+    case PipelineSchedule::GPipe:
+      out << "GPipe";
+      break;
+    case PipelineSchedule::OneForwardOneBackward:
+      out << "OneForwardOneBackward";
+      break;
+  }
+  return out;
+}
+
 namespace {
 
 at::Tensor getKnownTensorOrUndefined(
@@ -58,10 +75,88 @@ HostIrExecutor::HostIrExecutor(
       {container_->getDefaultStream(),
        c10::cuda::getDefaultCUDAStream(
            static_cast<c10::DeviceIndex>(device_index))});
+  // expr_evaluator_ is refilled with the values of the container on every
+  // run, so they are kept in slots rather than in maps
+  expr_evaluator_.assignSlots(container_.get());
+  NVF_CHECK(
+      !params_.use_cuda_graphs ||
+          ((params_.use_fusion_executor_cache ||
+            params_.cache_fusion_executor) &&
+           !params_.fuse_allgather_with_consumer),
+      "CUDA graphs require caching the FusionExecutors and can't be used ",
+      "with Allgathers fused with their consumer");
+  if (params_.release_dead_values) {
+    computeDeadValues();
+  }
+}
+
+// Note [Releasing dead values]
+// The expression evaluator holds a reference to every tensor bound during a
+// run until the next run rebinds it, so the intermediate tensors of a host
+// program are all alive at the end of the run. With
+// HostIrExecutorParams::release_dead_values, a value is invalidated right
+// after the last top-level expression using it, and the caching allocator can
+// hand its memory to the next PostOnStreams, like ArgumentManager does for the
+// segments run by FusionKernelRuntime. The outputs of the container are kept.
+// The tensors passed to a HostUnitRunner are recorded on the current stream,
+// so that the memory of a tensor consumed on another stream than the one it
+// was allocated on is not reused before the consumer is done. Programs with
+// top-level ForLoops are not analyzed, since the body of a loop reads values
+// that its inputs don't list.
+void HostIrExecutor::computeDeadValues() {
+  const std::vector<Expr*>& exprs = container_->topLevelExprs();
+  if (std::any_of(exprs.begin(), exprs.end(), [](Expr* expr) {
+        return expr->isA<ForLoop>();
+      })) {
+    return;
+  }
+  std::unordered_set<Val*> visited(
+      container_->outputs().begin(), container_->outputs().end());
+  dead_values_.resize(exprs.size());
+  for (int64_t i = (int64_t)exprs.size() - 1; i >= 0; i--) {
+    for (auto* tv : ir_utils::filterByType<TensorView>(exprs.at(i)->inputs())) {
+      if (visited.insert(tv).second) {
+        dead_values_.at(i).push_back(tv);
+      }
+    }
+  }
+}
+
+void HostIrExecutor::setHostUnitRunner(
+    HostUnit* host_unit,
+    HostUnitRunner runner) {
+  runners_[host_unit] = std::move(runner);
 }
 
 std::vector<at::Tensor> HostIrExecutor::runWithInput(
     std::unordered_map<Val*, c10::IValue> val_to_IValue) {
+  if (params_.use_cuda_graphs) {
+    return runWithCudaGraph(val_to_IValue);
+  }
+  return runEagerly(std::move(val_to_IValue));
+}
+
+std::vector<at::Tensor> HostIrExecutor::runWithArgs(
+    const KernelArgumentHolder& args) {
+  const std::vector<Val*>& inputs = container_->inputs();
+  NVF_ERROR(
+      args.size() == inputs.size(),
+      "Expected ",
+      inputs.size(),
+      " arguments but got ",
+      args.size());
+  // Values derived from the previous inputs must not be reused
+  expr_evaluator_.clear();
+  for (auto i : c10::irange(inputs.size())) {
+    expr_evaluator_.bind(inputs.at(i), *args[i]);
+  }
+  streams_.insert_or_assign(
+      container_->getDefaultStream(), c10::cuda::getCurrentCUDAStream());
+  return runEagerly({});
+}
+
+std::vector<at::Tensor> HostIrExecutor::runEagerly(
+    std::unordered_map<Val*, c10::IValue> val_to_IValue) {
   // process input values
   for (const auto& [val, ivalue] : val_to_IValue) {
     expr_evaluator_.bind(val, ivalue.toTensor());
@@ -69,16 +164,110 @@ std::vector<at::Tensor> HostIrExecutor::runWithInput(
 
   // Interpret each instruction in an "eager" way by iterate over the Host Ir
   // Container's top level expression list
-  for (auto expr : container_->topLevelExprs()) {
-    dispatch(expr);
+  const std::vector<Expr*>& exprs = container_->topLevelExprs();
+  for (auto i : c10::irange(exprs.size())) {
+    dispatch(exprs.at(i));
+    if (!dead_values_.empty()) {
+      for (Val* val : dead_values_.at(i)) {
+        expr_evaluator_.invalidate(val);
+      }
+    }
   }
 
   // Collect global outputs
   return getKnownTensorOrUndefined(container_->outputs(), expr_evaluator_);
 }
 
-void HostIrExecutor::handle(SetCurrentStream* set_current_stream) {
-  Stream* stream = set_current_stream->stream();
+// Note [Capturing host programs in CUDA graphs]
+// Interpreting the host program costs host time at each run: dispatching each
+// expression, looking up the executors and streams, and binding and
+// evaluating values. When HostIrExecutorParams::use_cuda_graphs is set, the
+// device work of a run is instead captured in a CUDA graph and replayed:
+//  - the first run with given input shapes runs eagerly, so that kernels get
+//    compiled and process groups created, which can't happen during a capture;
+//  - the second run is captured, on a side stream standing in for the default
+//    stream, and the graph is replayed once to produce its outputs;
+//  - the next runs copy their inputs into the tensors bound during the capture,
+//    replay the graph and return copies of its outputs, which the next replay
+//    overwrites. No host IR is interpreted.
+// Collectives are captured like any other stream work, which NCCL supports.
+// The P2P path is disabled in this mode because its flags are compared with
+// sequence numbers that would be frozen in the graph.
+std::vector<at::Tensor> HostIrExecutor::runWithCudaGraph(
+    const std::unordered_map<Val*, c10::IValue>& val_to_IValue) {
+  const std::vector<Val*>& inputs = container_->inputs();
+  auto is_input = [&](Val* val) {
+    return std::find(inputs.begin(), inputs.end(), val) != inputs.end();
+  };
+  std::vector<int64_t> key;
+  for (Val* input : inputs) {
+    auto it = val_to_IValue.find(input);
+    if (it == val_to_IValue.end()) {
+      continue;
+    }
+    const at::Tensor& tensor = it->second.toTensor();
+    key.push_back(static_cast<int64_t>(tensor.scalar_type()));
+    key.push_back(tensor.dim());
+    key.insert(key.end(), tensor.sizes().begin(), tensor.sizes().end());
+    key.insert(key.end(), tensor.strides().begin(), tensor.strides().end());
+  }
+
+  auto copy_outputs = [](const std::vector<at::Tensor>& outputs) {
+    std::vector<at::Tensor> copies;
+    copies.reserve(outputs.size());
+    for (const at::Tensor& output : outputs) {
+      copies.push_back(output.defined() ? output.clone() : output);
+    }
+    return copies;
+  };
+
+  if (auto it = captured_runs_.find(key); it != captured_runs_.end()) {
+    CapturedRun& run = it->second;
+    for (const auto& [val, ivalue] : val_to_IValue) {
+      if (is_input(val)) {
+        run.tensors.at(val).copy_(ivalue.toTensor(), /*non_blocking=*/true);
+      }
+    }
+    run.graph->replay();
+    return copy_outputs(run.outputs);
+  }
+
+  DisableOptionsGuard options_guard;
+  DisableOptionsGuard::getCurOptions().set(DisableOption::P2pCommunication);
+  if (warmed_up_runs_.insert(key).second) {
+    return runEagerly(val_to_IValue);
+  }
+
+  CapturedRun run;
+  run.graph = std::make_unique<at::cuda::CUDAGraph>();
+  std::unordered_map<Val*, c10::IValue> static_val_to_IValue;
+  for (const auto& [val, ivalue] : val_to_IValue) {
+    // Inputs are copied so that the replays don't read the caller's tensors.
+    at::Tensor tensor =
+        is_input(val) ? ivalue.toTensor().clone() : ivalue.toTensor();
+    run.tensors[val] = tensor;
+    static_val_to_IValue[val] = tensor;
+  }
+  {
+    const StreamKey default_key = container_->getDefaultStream();
+    const c10::cuda::CUDAStream default_stream = streams_.at(default_key);
+    const c10::cuda::CUDAStream capture_stream =
+        c10::cuda::getStreamFromPool(
+            /*isHighPriority=*/false, default_stream.device_index());
+    streams_.insert_or_assign(default_key, capture_stream);
+    c10::cuda::CUDAStreamGuard stream_guard(capture_stream);
+    run.graph->capture_begin();
+    run.outputs = runEagerly(std::move(static_val_to_IValue));
+    run.graph->capture_end();
+    streams_.insert_or_assign(default_key, default_stream);
+  }
+  run.graph->replay();
+  std::vector<at::Tensor> outputs = copy_outputs(run.outputs);
+  captured_runs_.emplace(std::move(key), std::move(run));
+  return outputs;
+}
+
+c10::cuda::CUDAStream HostIrExecutor::getCUDAStream(Stream* stream) {
   StreamKey stream_key = stream;
   // if stream points to an index, it represents the dynamic value of that index
   if (Val* index = stream->index(); index != nullptr) {
@@ -87,18 +276,57 @@ void HostIrExecutor::handle(SetCurrentStream* set_current_stream) {
     stream_key = value.as<int64_t>();
   }
   if (streams_.find(stream_key) == streams_.end()) {
-    auto i = (communicator_ != nullptr && communicator_->is_available())
-        ? communicator_->deviceId()
-        : 0;
+    // On the device of the default stream, which runWithArgs may have moved
+    const c10::DeviceIndex i =
+        streams_.at(container_->getDefaultStream()).device_index();
     streams_.insert(
         {stream_key,
-         c10::cuda::getStreamFromPool(
-             /*isHighPriority=*/false, static_cast<c10::DeviceIndex>(i))});
+         c10::cuda::getStreamFromPool(/*isHighPriority=*/false, i)});
   }
-  setCurrentCUDAStream(streams_.at(stream_key));
+  return streams_.at(stream_key);
+}
+
+void HostIrExecutor::handle(SetCurrentStream* set_current_stream) {
+  setCurrentCUDAStream(getCUDAStream(set_current_stream->stream()));
+}
+
+void HostIrExecutor::handle(Synchronize* synchronize) {
+  at::cuda::CUDAEvent event;
+  event.record(getCUDAStream(synchronize->stream()));
+  event.block(c10::cuda::getCurrentCUDAStream());
 }
 
 void HostIrExecutor::handle(PostOnStream* post_ir) {
+  NVF_ERROR(
+      post_ir->hostOpToPost()->isA<HostUnit>(),
+      "op must be a HostUnit: ",
+      post_ir->hostOpToPost());
+  auto hu = post_ir->hostOpToPost()->as<HostUnit>();
+
+  // placeholder for storing the outputs
+  std::vector<at::Tensor> outputs;
+
+  if (auto runner_it = runners_.find(hu); runner_it != runners_.end()) {
+    KernelArgumentHolder args;
+    for (Val* input : post_ir->inputs()) {
+      PolymorphicValue value = expr_evaluator_.evaluate(input);
+      // No-op when the tensor was allocated on the current stream
+      if (!dead_values_.empty() && value.is<at::Tensor>() &&
+          value.as<at::Tensor>().is_cuda()) {
+        c10::cuda::CUDACachingAllocator::recordStream(
+            value.as<at::Tensor>().storage().data_ptr(),
+            c10::cuda::getCurrentCUDAStream());
+      }
+      args.push(value);
+    }
+    outputs = runner_it->second(args);
+    for (auto output_idx : c10::irange(outputs.size())) {
+      expr_evaluator_.bind(
+          post_ir->outputs().at(output_idx), outputs.at(output_idx));
+    }
+    return;
+  }
+
   std::vector<c10::IValue> input_IValues;
   for (auto& input : post_ir->inputs()) {
     NVF_ERROR(
@@ -124,14 +352,6 @@ void HostIrExecutor::handle(PostOnStream* post_ir) {
     input_IValues.push_back(value);
   }
 
-  // placeholder for storing the outputs
-  std::vector<at::Tensor> outputs;
-
-  NVF_ERROR(
-      post_ir->hostOpToPost()->isA<HostUnit>(),
-      "op must be a HostUnit: ",
-      post_ir->hostOpToPost());
-  auto hu = post_ir->hostOpToPost()->as<HostUnit>();
   // Compile the fusion and execute it with FusionExecutor(Cache)
   // Check if the executor has been cached. If not, create and cache it
   if (params_.use_fusion_executor_cache) {
@@ -172,6 +392,16 @@ void HostIrExecutor::handle(Communication* communication) {
       getKnownTensorOrUndefined(communication->input(0), expr_evaluator_);
   at::Tensor output_tensor =
       getKnownTensorOrUndefined(communication->output(0), expr_evaluator_);
+  // The receive buffer of a SendRecv not bound by the caller, e.g., in a ring
+  // built by makeRingAttentionProgram, is allocated like the sent tensor.
+  const Team& team = communication->team();
+  if (communication->type() == CommunicationType::SendRecv &&
+      !output_tensor.defined() && input_tensor.defined() &&
+      std::find(team.begin(), team.end(), communicator_->deviceId()) !=
+          team.end()) {
+    output_tensor = at::empty_like(input_tensor);
+    expr_evaluator_.bind(communication->output(0), output_tensor);
+  }
 
   c10d::Backend* backend =
       communicator_->getBackendForTeam(communication->team(), std::nullopt);
@@ -183,6 +413,57 @@ void HostIrExecutor::handle(Communication* communication) {
       output_tensor);
 }
 
+void HostIrExecutor::handle(ShareWithPeers* share) {
+  NVF_ERROR(
+      communicator_ != nullptr && communicator_->is_available(),
+      "A valid communicator must be provided");
+  P2pChannel* channel = communicator_->getP2pChannelForTeam(share->team());
+  NVF_ERROR(channel != nullptr, "The team can't use a P2P channel");
+
+  at::Tensor input_tensor =
+      expr_evaluator_.evaluate(share->in()).as<at::Tensor>();
+  std::vector<at::Tensor> shards = channel->share(input_tensor);
+  NVF_ERROR(shards.size() == share->outputs().size());
+  for (auto i : c10::irange(shards.size())) {
+    expr_evaluator_.bind(share->output(i), shards.at(i));
+  }
+}
+
+void HostIrExecutor::handle(ReleasePeers* release) {
+  P2pChannel* channel =
+      communicator_->getP2pChannelForTeam(release->share()->team());
+  NVF_ERROR(channel != nullptr, "The team can't use a P2P channel");
+  channel->release();
+}
+
+void HostIrExecutor::handle(OffloadToHost* offload) {
+  at::Tensor device_tensor =
+      expr_evaluator_.evaluate(offload->in()).as<at::Tensor>();
+  at::Tensor host_tensor = at::empty_strided(
+      device_tensor.sizes(),
+      device_tensor.strides(),
+      device_tensor.options().device(at::kCPU).pinned_memory(true));
+  host_tensor.copy_(device_tensor, /*non_blocking=*/true);
+  // Keeps the device buffer from being reused before the copy completes
+  device_tensor.record_stream(c10::cuda::getCurrentCUDAStream());
+  expr_evaluator_.invalidate(offload->in());
+  expr_evaluator_.bind(offload->out(), host_tensor);
+}
+
+void HostIrExecutor::handle(PrefetchToDevice* prefetch) {
+  at::Tensor host_tensor =
+      expr_evaluator_.evaluate(prefetch->in()).as<at::Tensor>();
+  const c10::cuda::CUDAStream stream = c10::cuda::getCurrentCUDAStream();
+  at::Tensor device_tensor = at::empty_strided(
+      host_tensor.sizes(),
+      host_tensor.strides(),
+      host_tensor.options().device(at::kCUDA, stream.device_index()));
+  device_tensor.copy_(host_tensor, /*non_blocking=*/true);
+  // The consumers run on the default stream
+  device_tensor.record_stream(getCUDAStream(container_->getDefaultStream()));
+  expr_evaluator_.bind(prefetch->out(), device_tensor);
+}
+
 void HostIrExecutor::handle(Wait* wait) {
   Communication* communication = wait->communication();
   NVF_ERROR(works_.find(communication) != works_.end(), "no wait req");
@@ -275,6 +556,21 @@ void HostIrExecutor::handle(SelectOp* select_op) {
   return handleWithExpressionEvaluator(select_op, expr_evaluator_);
 }
 
+void HostIrExecutor::handle(SdpaFwdOp* sdpa) {
+  // Evaluated once for all its outputs, whereas
+  // handleWithExpressionEvaluator would evaluate it for each output
+  std::vector<PolymorphicValue> inputs;
+  inputs.reserve(sdpa->inputs().size());
+  for (Val* input : sdpa->inputs()) {
+    inputs.push_back(expr_evaluator_.evaluate(input));
+  }
+  std::vector<PolymorphicValue> outputs =
+      sdpa->evaluate(expr_evaluator_, inputs);
+  for (auto i : c10::irange(outputs.size())) {
+    expr_evaluator_.bind(sdpa->output(i), outputs.at(i));
+  }
+}
+
 } // namespace hir
 
 } // namespace nvfuser
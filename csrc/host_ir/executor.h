@@ -15,8 +15,14 @@
 #include <kernel_cache.h>
 #include <multidevice/communicator.h>
 
+#include <ATen/cuda/CUDAGraph.h>
 #include <c10/cuda/CUDAStream.h>
 
+#include <functional>
+#include <map>
+#include <memory>
+#include <set>
+
 namespace nvfuser {
 
 namespace hir {
@@ -33,6 +39,20 @@ Note: most of the implementation is copy pasted for MultiDeviceExecutor. This
 duplication will be resolved in the future.
 */
 
+// Orders in which MultiDeviceExecutor runs the microbatches of a pipeline.
+// See Note [Pipeline schedules]
+enum class PipelineSchedule {
+  // Each device runs a stage for all the microbatches before the next one
+  GPipe,
+  // Each device prefers the latest of its stages whose input is ready and
+  // bounds the number of microbatches in flight. This is the 1F1B schedule
+  // when a pipeline goes through the devices and back, and its interleaved
+  // variant when a device runs several stages on the way.
+  OneForwardOneBackward
+};
+
+std::ostream& operator<<(std::ostream& out, const PipelineSchedule& schedule);
+
 // Set of parameters that control the behavior of HostIrExecutor
 struct HostIrExecutorParams {
   // Experimental: whether to use FusionExecutorCache rather than
@@ -45,6 +65,53 @@ struct HostIrExecutorParams {
   // Experimental: whether to cache fusion executor. WAR: avoid recompilation
   // but implicitely assumes that the input shape don't change over iterations
   bool cache_fusion_executor = false;
+  // Experimental: used by MultiDeviceExecutor. Whether to decompose a compute
+  // segment and the ReduceScatter or Allreduce consuming its output into
+  // chunks posted on `number_of_streams` streams in a round-robin fashion, so
+  // that the communication of a chunk overlaps with the compute of the next
+  // ones. The number of chunks is the largest one that keeps each chunk's
+  // communication above `min_chunk_bytes`, up to `max_chunks`.
+  bool overlap_compute_and_communication = false;
+  int64_t number_of_streams = 3;
+  int64_t max_chunks = 8;
+  int64_t min_chunk_bytes = 1 << 20;
+  // Experimental: used by MultiDeviceExecutor. When positive, consecutive
+  // compatible Allreduces are coalesced into one Allreduce of a flat buffer
+  // of at most this many bytes per device. 0 disables bucketing.
+  int64_t communication_bucket_bytes = 0;
+  // Experimental: used by MultiDeviceExecutor. Whether to lower an Allgather
+  // among devices of the same node into its consumer segment, whose kernel
+  // then reads the remote shards through NVLink instead of a gathered copy.
+  // Only applies to small shards of static size, see P2pChannel.
+  bool fuse_allgather_with_consumer = false;
+  // Experimental: used by MultiDeviceExecutor. When larger than one, the
+  // inputs are split along their outermost axis into this many microbatches,
+  // which go through the pipeline stages in the order given by
+  // `pipeline_schedule`. This takes precedence over the options above.
+  int64_t number_of_microbatches = 1;
+  PipelineSchedule pipeline_schedule = PipelineSchedule::OneForwardOneBackward;
+  // Experimental: used by MultiDeviceExecutor. When positive, the compute
+  // segments are posted round-robin on this many streams. See assignStreams.
+  int64_t number_of_compute_streams = 0;
+  // Experimental: whether to capture the host program into a CUDA graph the
+  // second time it runs with given input shapes, and to replay the graph in
+  // the next runs. Requires caching the FusionExecutors and a graph-capturable
+  // backend, i.e., NCCL. See Note [Capturing host programs in CUDA graphs]
+  bool use_cuda_graphs = false;
+  // Experimental: used by MultiDeviceExecutor. Whether to offload the outputs
+  // of compute segments that are next used at least
+  // `offload_min_distance` compute segments later to pinned host memory, and
+  // to prefetch them back as early as `prefetch_budget_bytes` of prefetched
+  // tensors allows. Programs using this don't use number_of_compute_streams.
+  // See offloadActivations.
+  bool offload_activations = false;
+  int64_t offload_min_distance = 2;
+  int64_t prefetch_budget_bytes = int64_t(1) << 30;
+  // Experimental: used by FusionKernelRuntime. Whether to drop the values
+  // bound by the host program after their last use in the top-level
+  // expressions, so that the memory of intermediate tensors is reused within a
+  // run. See Note [Releasing dead values]
+  bool release_dead_values = false;
 };
 
 class HostIrExecutor final : public OptInDispatch {
@@ -56,6 +123,17 @@ class HostIrExecutor final : public OptInDispatch {
   std::vector<at::Tensor> runWithInput(
       std::unordered_map<Val*, c10::IValue> val_to_IValue);
 
+  // Runs the host program with `args` bound to the inputs of the container in
+  // order, on the current CUDA stream
+  std::vector<at::Tensor> runWithArgs(const KernelArgumentHolder& args);
+
+  // Runs the PostOnStreams of `host_unit` with `runner` instead of an executor
+  // compiled for its fusion, e.g., with the executor FusionKernelRuntime
+  // compiled for the corresponding segment
+  using HostUnitRunner =
+      std::function<std::vector<at::Tensor>(KernelArgumentHolder&)>;
+  void setHostUnitRunner(HostUnit* host_unit, HostUnitRunner runner);
+
   const std::vector<Val*>& inputs() {
     return container_->inputs();
   }
@@ -74,14 +152,30 @@ class HostIrExecutor final : public OptInDispatch {
 
  private:
   using OptInDispatch::handle;
+  // Runs the host program by dispatching its expressions one by one
+  std::vector<at::Tensor> runEagerly(
+      std::unordered_map<Val*, c10::IValue> val_to_IValue);
+  // Runs the host program by replaying a CUDA graph, capturing it if needed
+  std::vector<at::Tensor> runWithCudaGraph(
+      const std::unordered_map<Val*, c10::IValue>& val_to_IValue);
+  // Fills dead_values_, see Note [Releasing dead values]
+  void computeDeadValues();
+  // Returns the CUDA stream represented by `stream`, creating it if needed
+  c10::cuda::CUDAStream getCUDAStream(Stream* stream);
   void handle(SetCurrentStream* set_current_stream) override;
+  void handle(Synchronize* synchronize) override;
   void handle(PostOnStream* post_ir) override;
   void handle(Communication* communication) override;
+  void handle(ShareWithPeers* share) override;
+  void handle(ReleasePeers* release) override;
+  void handle(OffloadToHost* offload) override;
+  void handle(PrefetchToDevice* prefetch) override;
   void handle(Wait* wait) override;
   void handle(ForLoop* for_loop) override;
   void handle(SliceOp* slice_op) override;
   void handle(MatmulOp* matmul_op) override;
   void handle(SelectOp* select_op) override;
+  void handle(SdpaFwdOp* sdpa) override;
 
   std::unique_ptr<HostIrContainer> container_;
   Communicator* communicator_;
@@ -91,9 +185,24 @@ class HostIrExecutor final : public OptInDispatch {
   // Cache Fusions, FusionExecutors
   std::unordered_map<HostUnit*, FusionExecutor> fe_;
   std::unordered_map<HostUnit*, FusionExecutorCache> fec_;
+  std::unordered_map<HostUnit*, HostUnitRunner> runners_;
+  // The values released after each top-level expression when
+  // params_.release_dead_values is set
+  std::vector<std::vector<Val*>> dead_values_;
   using StreamKey = std::variant<int64_t, Stream*>;
   std::unordered_map<StreamKey, c10::cuda::CUDAStream> streams_;
   std::unordered_map<Communication*, c10::intrusive_ptr<c10d::Work>> works_;
+
+  // A run captured in a CUDA graph
+  struct CapturedRun {
+    std::unique_ptr<at::cuda::CUDAGraph> graph;
+    // The tensors bound during the capture, which the replays access
+    std::unordered_map<Val*, at::Tensor> tensors;
+    std::vector<at::Tensor> outputs;
+  };
+  // Indexed by the sizes, strides and dtypes of the inputs
+  std::map<std::vector<int64_t>, CapturedRun> captured_runs_;
+  std::set<std::vector<int64_t>> warmed_up_runs_;
 };
 
 } // namespace hir
@@ -174,6 +174,33 @@ bool SetCurrentStream::sameAs(const Statement* other) const {
   return false;
 }
 
+Synchronize::Synchronize(IrBuilderPasskey passkey, Stream* stream)
+    : Expr(passkey, {stream}, {}, {stream}) {
+  NVF_ERROR(
+      passkey.ir_container_->isA<hir::HostIrContainer>(), // NOLINT
+      this,
+      "must be registered in a HostIrContainer");
+}
+
+NVFUSER_DEFINE_CLONE_AND_CREATE(Synchronize)
+
+std::string Synchronize::toString(int indent_size) const {
+  std::stringstream ss;
+  indent(ss, indent_size) << "Synchronize " << stream()->toString()
+                          << std::endl;
+  return ss.str();
+}
+
+// TODO: implement better ?
+std::string Synchronize::toInlineString(int indent_size) const {
+  NVF_CHECK(false, "Cannot be printed inline");
+}
+
+// TODO: implement
+bool Synchronize::sameAs(const Statement* other) const {
+  return false;
+}
+
 Wait::Wait(IrBuilderPasskey passkey, Communication* communication)
     : Expr(passkey, {}, {}, {communication}) {
   NVF_ERROR(
@@ -201,6 +228,136 @@ bool Wait::sameAs(const Statement* other) const {
   return false;
 }
 
+ShareWithPeers::ShareWithPeers(
+    IrBuilderPasskey passkey,
+    std::vector<TensorView*> outs,
+    TensorView* in,
+    Team team)
+    : Expr(passkey) {
+  NVF_ERROR(
+      passkey.ir_container_->isA<hir::HostIrContainer>(), // NOLINT
+      this,
+      "must be registered in a HostIrContainer");
+  NVF_ERROR(
+      outs.size() == team.size(),
+      "ShareWithPeers must have one output per member of the team");
+  addInput(in);
+  for (TensorView* out : outs) {
+    addOutput(out);
+  }
+  addDataAttribute(std::move(team));
+}
+
+NVFUSER_DEFINE_CLONE_AND_CREATE(ShareWithPeers)
+
+std::string ShareWithPeers::toString(int indent_size) const {
+  std::stringstream ss;
+  indent(ss, indent_size) << "(";
+  for (auto output : outputs()) {
+    ss << output->toString() << (output == outputs().back() ? "" : ", ");
+  }
+  ss << ") = ShareWithPeers(" << in()->toString() << ", team=(" << team()
+     << "))" << std::endl;
+  return ss.str();
+}
+
+// TODO: implement better ?
+std::string ShareWithPeers::toInlineString(int indent_size) const {
+  NVF_CHECK(false, "Cannot be printed inline");
+}
+
+// TODO: implement
+bool ShareWithPeers::sameAs(const Statement* other) const {
+  return false;
+}
+
+ReleasePeers::ReleasePeers(IrBuilderPasskey passkey, ShareWithPeers* share)
+    : Expr(passkey, {}, {}, {share}) {
+  NVF_ERROR(
+      passkey.ir_container_->isA<hir::HostIrContainer>(), // NOLINT
+      this,
+      "must be registered in a HostIrContainer");
+}
+
+NVFUSER_DEFINE_CLONE_AND_CREATE(ReleasePeers)
+
+std::string ReleasePeers::toString(int indent_size) const {
+  std::stringstream ss;
+  indent(ss, indent_size) << "ReleasePeers " << share()->in()->toString()
+                          << std::endl;
+  return ss.str();
+}
+
+// TODO: implement better ?
+std::string ReleasePeers::toInlineString(int indent_size) const {
+  NVF_CHECK(false, "Cannot be printed inline");
+}
+
+// TODO: implement
+bool ReleasePeers::sameAs(const Statement* other) const {
+  return false;
+}
+
+OffloadToHost::OffloadToHost(
+    IrBuilderPasskey passkey,
+    TensorView* out,
+    TensorView* in)
+    : Expr(passkey, {in}, {out}, {}) {
+  NVF_ERROR(
+      passkey.ir_container_->isA<hir::HostIrContainer>(), // NOLINT
+      this,
+      "must be registered in a HostIrContainer");
+}
+
+NVFUSER_DEFINE_CLONE_AND_CREATE(OffloadToHost)
+
+std::string OffloadToHost::toString(int indent_size) const {
+  std::stringstream ss;
+  indent(ss, indent_size) << out()->toString() << " = OffloadToHost("
+                          << in()->toString() << ")" << std::endl;
+  return ss.str();
+}
+
+// TODO: implement better ?
+std::string OffloadToHost::toInlineString(int indent_size) const {
+  NVF_CHECK(false, "Cannot be printed inline");
+}
+
+// TODO: implement
+bool OffloadToHost::sameAs(const Statement* other) const {
+  return false;
+}
+
+PrefetchToDevice::PrefetchToDevice(
+    IrBuilderPasskey passkey,
+    TensorView* out,
+    TensorView* in)
+    : Expr(passkey, {in}, {out}, {}) {
+  NVF_ERROR(
+      passkey.ir_container_->isA<hir::HostIrContainer>(), // NOLINT
+      this,
+      "must be registered in a HostIrContainer");
+}
+
+NVFUSER_DEFINE_CLONE_AND_CREATE(PrefetchToDevice)
+
+std::string PrefetchToDevice::toString(int indent_size) const {
+  std::stringstream ss;
+  indent(ss, indent_size) << out()->toString() << " = PrefetchToDevice("
+                          << in()->toString() << ")" << std::endl;
+  return ss.str();
+}
+
+// TODO: implement better ?
+std::string PrefetchToDevice::toInlineString(int indent_size) const {
+  NVF_CHECK(false, "Cannot be printed inline");
+}
+
+// TODO: implement
+bool PrefetchToDevice::sameAs(const Statement* other) const {
+  return false;
+}
+
 } // namespace hir
 
 } // namespace nvfuser
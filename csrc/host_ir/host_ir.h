@@ -161,6 +161,35 @@ class SetCurrentStream : public Expr {
   }
 };
 
+/*
+  Synchronize makes the current stream wait for all the work posted so far on
+  the given stream. It does not block the host.
+*/
+class Synchronize : public Expr {
+ public:
+  using Expr::Expr;
+  Synchronize(IrBuilderPasskey passkey, Stream* stream);
+
+  Synchronize(const Synchronize& other) = delete;
+  Synchronize& operator=(const Synchronize& other) = delete;
+  Synchronize(Synchronize&& other) = delete;
+  Synchronize& operator=(Synchronize&& other) = delete;
+
+  NVFUSER_DECLARE_CLONE_AND_CREATE
+
+  std::string toString(int indent_size = 0) const override;
+  std::string toInlineString(int indent_size = 0) const override;
+  const char* getOpString() const override {
+    return "hir::Synchronize";
+  }
+
+  bool sameAs(const Statement* other) const override;
+
+  Stream* stream() const {
+    return attributes_.at(0)->as<Stream>();
+  }
+};
+
 class Wait : public Expr {
  public:
   using Expr::Expr;
@@ -186,6 +215,146 @@ class Wait : public Expr {
   }
 };
 
+/*
+  ShareWithPeers makes its input readable by the other members of the team
+  through their P2P channel, see P2pChannel::share. It has one output per
+  member of the team, in the team's order, which aliases that member's input
+  in its memory. The outputs can be read by the work posted on the current
+  stream until the matching ReleasePeers.
+*/
+class ShareWithPeers : public Expr {
+ public:
+  using Expr::Expr;
+  ShareWithPeers(
+      IrBuilderPasskey passkey,
+      std::vector<TensorView*> outs,
+      TensorView* in,
+      Team team);
+
+  ShareWithPeers(const ShareWithPeers& other) = delete;
+  ShareWithPeers& operator=(const ShareWithPeers& other) = delete;
+  ShareWithPeers(ShareWithPeers&& other) = delete;
+  ShareWithPeers& operator=(ShareWithPeers&& other) = delete;
+
+  NVFUSER_DECLARE_CLONE_AND_CREATE
+
+  std::string toString(int indent_size = 0) const override;
+  std::string toInlineString(int indent_size = 0) const override;
+  const char* getOpString() const override {
+    return "hir::ShareWithPeers";
+  }
+
+  bool sameAs(const Statement* other) const override;
+
+  TensorView* in() const {
+    return input(0)->as<TensorView>();
+  }
+
+  const Team& team() const {
+    return attribute<Team>(0);
+  }
+};
+
+/*
+  ReleasePeers signals the other members of the team that the outputs of the
+  given ShareWithPeers are not read anymore by the work posted so far on the
+  current stream.
+*/
+class ReleasePeers : public Expr {
+ public:
+  using Expr::Expr;
+  ReleasePeers(IrBuilderPasskey passkey, ShareWithPeers* share);
+
+  ReleasePeers(const ReleasePeers& other) = delete;
+  ReleasePeers& operator=(const ReleasePeers& other) = delete;
+  ReleasePeers(ReleasePeers&& other) = delete;
+  ReleasePeers& operator=(ReleasePeers&& other) = delete;
+
+  NVFUSER_DECLARE_CLONE_AND_CREATE
+
+  std::string toString(int indent_size = 0) const override;
+  std::string toInlineString(int indent_size = 0) const override;
+  const char* getOpString() const override {
+    return "hir::ReleasePeers";
+  }
+
+  bool sameAs(const Statement* other) const override;
+
+  ShareWithPeers* share() const {
+    return attributes_.at(0)->as<ShareWithPeers>();
+  }
+};
+
+/*
+  OffloadToHost copies its input to a new buffer in pinned host memory, its
+  output, on the current stream. It doesn't block the host. The device buffer
+  of the input is released once the copy completes, so the expressions that
+  follow must not use the input, but a PrefetchToDevice of the output.
+*/
+class OffloadToHost : public Expr {
+ public:
+  using Expr::Expr;
+  OffloadToHost(IrBuilderPasskey passkey, TensorView* out, TensorView* in);
+
+  OffloadToHost(const OffloadToHost& other) = delete;
+  OffloadToHost& operator=(const OffloadToHost& other) = delete;
+  OffloadToHost(OffloadToHost&& other) = delete;
+  OffloadToHost& operator=(OffloadToHost&& other) = delete;
+
+  NVFUSER_DECLARE_CLONE_AND_CREATE
+
+  std::string toString(int indent_size = 0) const override;
+  std::string toInlineString(int indent_size = 0) const override;
+  const char* getOpString() const override {
+    return "hir::OffloadToHost";
+  }
+
+  bool sameAs(const Statement* other) const override;
+
+  TensorView* in() const {
+    return input(0)->as<TensorView>();
+  }
+
+  TensorView* out() const {
+    return output(0)->as<TensorView>();
+  }
+};
+
+/*
+  PrefetchToDevice copies the output of an OffloadToHost back to a new device
+  buffer, its output, on the current stream. It doesn't block the host. The
+  output can be used by the work posted on the default stream after it
+  synchronizes with the current stream.
+*/
+class PrefetchToDevice : public Expr {
+ public:
+  using Expr::Expr;
+  PrefetchToDevice(IrBuilderPasskey passkey, TensorView* out, TensorView* in);
+
+  PrefetchToDevice(const PrefetchToDevice& other) = delete;
+  PrefetchToDevice& operator=(const PrefetchToDevice& other) = delete;
+  PrefetchToDevice(PrefetchToDevice&& other) = delete;
+  PrefetchToDevice& operator=(PrefetchToDevice&& other) = delete;
+
+  NVFUSER_DECLARE_CLONE_AND_CREATE
+
+  std::string toString(int indent_size = 0) const override;
+  std::string toInlineString(int indent_size = 0) const override;
+  const char* getOpString() const override {
+    return "hir::PrefetchToDevice";
+  }
+
+  bool sameAs(const Statement* other) const override;
+
+  TensorView* in() const {
+    return input(0)->as<TensorView>();
+  }
+
+  TensorView* out() const {
+    return output(0)->as<TensorView>();
+  }
+};
+
 } // namespace hir
 
 } // namespace nvfuser
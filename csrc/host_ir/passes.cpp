@@ -0,0 +1,408 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#include <host_ir/passes.h>
+
+#include <expr_evaluator.h>
+#include <ir/builder.h>
+#include <ir/internal_nodes.h>
+#include <ir/utils.h>
+#include <kernel_ir.h>
+#include <multidevice/communication.h>
+#include <ops/utils.h>
+
+#include <c10/util/irange.h>
+
+#include <algorithm>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace nvfuser {
+
+namespace hir {
+
+namespace {
+
+// Returns the buffer `val` is a slice of, or `val` itself
+Val* aliasedBuffer(Val* val) {
+  while (Expr* def = val->definition()) {
+    if (!def->isOneOf<SliceOp, SelectOp>()) {
+      break;
+    }
+    val = def->input(0);
+  }
+  return val;
+}
+
+// The buffers read and written by `expr`. Slicing a buffer accesses none.
+void collectAccesses(
+    Expr* expr,
+    std::unordered_set<Val*>& reads,
+    std::unordered_set<Val*>& writes) {
+  if (expr->isOneOf<SliceOp, SelectOp>()) {
+    return;
+  }
+  if (auto* for_loop = dynamic_cast<ForLoop*>(expr)) {
+    for (Expr* body_expr : for_loop->body().exprs()) {
+      collectAccesses(body_expr, reads, writes);
+    }
+    return;
+  }
+  for (Val* input : expr->inputs()) {
+    reads.insert(aliasedBuffer(input));
+  }
+  for (Val* output : expr->outputs()) {
+    writes.insert(aliasedBuffer(output));
+  }
+}
+
+} // namespace
+
+// Note [Deferring Waits]
+// Lowering emits each Wait right after its Communication, which serializes
+// the communications with the work that follows them. Waits only need to
+// precede the expressions that read or overwrite the communication's output,
+// or overwrite its input, so deferWaits moves them there. It never moves a
+// Wait earlier than where it was emitted. With NCCL, Work::wait makes the
+// current stream wait for the communication without blocking the host, so a
+// deferred Wait is stream-ordered; with UCC, it blocks the host, and deferring
+// it lets the host post more work meanwhile.
+void deferWaits(HostIrContainer* hic) {
+  std::vector<Expr*> exprs;
+  exprs.reserve(hic->topLevelExprs().size());
+  // The Waits not emitted yet, in program order
+  std::vector<Wait*> pending;
+  auto conflicts = [](Wait* wait,
+                      const std::unordered_set<Val*>& reads,
+                      const std::unordered_set<Val*>& writes) {
+    Communication* communication = wait->communication();
+    Val* in = aliasedBuffer(communication->in());
+    Val* out = aliasedBuffer(communication->out());
+    return reads.count(out) || writes.count(out) || writes.count(in);
+  };
+
+  for (Expr* expr : hic->topLevelExprs()) {
+    if (auto* wait = dynamic_cast<Wait*>(expr)) {
+      pending.push_back(wait);
+      continue;
+    }
+    std::unordered_set<Val*> reads;
+    std::unordered_set<Val*> writes;
+    collectAccesses(expr, reads, writes);
+    std::vector<Wait*> still_pending;
+    for (Wait* wait : pending) {
+      if (conflicts(wait, reads, writes)) {
+        exprs.push_back(wait);
+      } else {
+        still_pending.push_back(wait);
+      }
+    }
+    pending = std::move(still_pending);
+    exprs.push_back(expr);
+  }
+  exprs.insert(exprs.end(), pending.begin(), pending.end());
+  hic->resetTopLevelExprs(std::move(exprs));
+}
+
+// Note [Assigning streams]
+// assignStreams posts the i-th PostOnStream on the stream i % n, so that
+// independent compute segments can run concurrently on the GPU, and all the
+// other expressions, e.g., Communications and Waits, on the default stream.
+// The dependencies are enforced with Synchronize:
+//  - a PostOnStream first waits for the default stream, which orders it after
+//    the Waits and Communications posted before it, and for the streams that
+//    produced its inputs;
+//  - an expression on the default stream waits for the streams that produced
+//    its inputs; a ReleasePeers waits for all of them, because the kernels
+//    reading the shared buffers are not among its inputs;
+//  - the default stream eventually waits for all the streams, so the caller
+//    and the next run only need to synchronize with it.
+void assignStreams(HostIrContainer* hic, int64_t number_of_streams) {
+  NVF_CHECK(number_of_streams > 0, "Invalid number of streams");
+  const std::vector<Expr*>& top_level_exprs = hic->topLevelExprs();
+  if (std::any_of(
+          top_level_exprs.begin(), top_level_exprs.end(), [](Expr* expr) {
+            return expr->isOneOf<SetCurrentStream, Synchronize, ForLoop>();
+          })) {
+    return;
+  }
+
+  Stream* default_stream = hic->getDefaultStream();
+  std::vector<Stream*> streams;
+  streams.reserve(number_of_streams);
+  for ([[maybe_unused]] auto i : c10::irange(number_of_streams)) {
+    streams.push_back(IrBuilder::createInContainer<Stream>(hic));
+  }
+
+  std::vector<Expr*> exprs;
+  Stream* current_stream = default_stream;
+  // The stream that last wrote each buffer
+  std::unordered_map<Val*, Stream*> producing_streams;
+  std::unordered_set<Stream*> used_streams;
+  auto synchronize = [&](Stream* stream) {
+    exprs.push_back(IrBuilder::createInContainer<Synchronize>(hic, stream));
+  };
+  int64_t number_of_posts = 0;
+  for (Expr* expr : top_level_exprs) {
+    Stream* stream = expr->isA<PostOnStream>()
+        ? streams.at(number_of_posts++ % number_of_streams)
+        : default_stream;
+    if (stream != current_stream) {
+      exprs.push_back(
+          IrBuilder::createInContainer<SetCurrentStream>(hic, stream));
+      current_stream = stream;
+    }
+
+    std::unordered_set<Stream*> streams_to_wait_for;
+    if (stream != default_stream) {
+      synchronize(default_stream);
+      used_streams.insert(stream);
+    }
+    if (expr->isA<ReleasePeers>()) {
+      streams_to_wait_for = used_streams;
+    }
+    for (Val* input : expr->inputs()) {
+      auto it = producing_streams.find(aliasedBuffer(input));
+      if (it != producing_streams.end()) {
+        streams_to_wait_for.insert(it->second);
+      }
+    }
+    // In program order, so the pass is deterministic
+    for (Stream* other : streams) {
+      if (other != stream && streams_to_wait_for.count(other)) {
+        synchronize(other);
+      }
+    }
+
+    exprs.push_back(expr);
+    if (!expr->isOneOf<SliceOp, SelectOp>()) {
+      for (Val* output : expr->outputs()) {
+        producing_streams[aliasedBuffer(output)] = stream;
+      }
+    }
+  }
+
+  if (current_stream != default_stream) {
+    exprs.push_back(
+        IrBuilder::createInContainer<SetCurrentStream>(hic, default_stream));
+  }
+  for (Stream* stream : streams) {
+    if (used_streams.count(stream)) {
+      synchronize(stream);
+    }
+  }
+  hic->resetTopLevelExprs(std::move(exprs));
+}
+
+// Note [Offloading activations]
+// The activations saved by the forward segments of a training step for the
+// backward ones occupy device memory for most of the step. offloadActivations
+// bounds that: a tensor produced by a PostOnStream and next used at least
+// `min_distance` PostOnStreams later is
+//  - copied to pinned host memory by an OffloadToHost posted on an offload
+//    stream right after its producer, once the offload stream synchronized
+//    with the default stream. Its device buffer is released once copied;
+//  - copied back by a PrefetchToDevice posted on the offload stream before
+//    the PostOnStream that is d PostOnStreams ahead of its next use, which
+//    synchronizes the default stream with the offload stream first.
+// The prefetch distance d is the largest one keeping the prefetched tensors
+// that are resident at the same time, i.e., copied back and not used yet,
+// within `prefetch_budget_bytes`. The tensors are handled in the order of
+// their next use, and the ones whose size isn't known at compile time are
+// prefetched one PostOnStream ahead and not counted. The copies overlap with
+// the compute segments, and since both run on the offload stream in program
+// order, a prefetch follows the offload of the same tensor.
+//
+// Only the tensors all of whose later uses are PostOnStreams are offloaded,
+// since their inputs can be rewritten, and not the program's outputs.
+
+namespace {
+
+// Returns the size in bytes of `tv` if its extents are known at compile time
+std::optional<int64_t> staticSizeInBytes(TensorView* tv) {
+  ExpressionEvaluator expr_eval;
+  int64_t bytes = dataTypeSize(*tv->getDataType());
+  for (IterDomain* id : TensorDomain::noReductions(tv->getLogicalDomain())) {
+    PolymorphicValue extent = expr_eval.evaluate(id->getMaybeExpandedExtent());
+    if (!extent.hasValue()) {
+      return std::nullopt;
+    }
+    bytes *= extent.as<int64_t>();
+  }
+  return bytes;
+}
+
+// An activation to offload
+struct Offload {
+  TensorView* tv = nullptr;
+  // Positions in the top-level expressions of its producer and next use
+  int64_t producer = -1;
+  int64_t next_use = -1;
+};
+
+} // namespace
+
+void offloadActivations(
+    HostIrContainer* hic,
+    int64_t min_distance,
+    int64_t prefetch_budget_bytes) {
+  NVF_CHECK(min_distance > 0, "Invalid offload distance: ", min_distance);
+  const std::vector<Expr*> top_level_exprs = hic->topLevelExprs();
+  if (std::any_of(
+          top_level_exprs.begin(), top_level_exprs.end(), [](Expr* expr) {
+            return expr->isOneOf<SetCurrentStream, Synchronize, ForLoop>();
+          })) {
+    return;
+  }
+  const auto number_of_exprs = static_cast<int64_t>(top_level_exprs.size());
+  auto is_post = [&](int64_t position) {
+    return top_level_exprs.at(position)->isA<PostOnStream>();
+  };
+  auto uses = [&](int64_t position, Val* val) {
+    const std::vector<Val*>& inputs = top_level_exprs.at(position)->inputs();
+    return std::find(inputs.begin(), inputs.end(), val) != inputs.end();
+  };
+
+  std::vector<Offload> offloads;
+  const std::vector<Val*>& outputs = hic->outputs();
+  for (auto producer : c10::irange(number_of_exprs)) {
+    if (!is_post(producer)) {
+      continue;
+    }
+    for (auto* tv : ir_utils::filterByType<TensorView>(
+             top_level_exprs.at(producer)->outputs())) {
+      if (std::find(outputs.begin(), outputs.end(), tv) != outputs.end()) {
+        continue;
+      }
+      int64_t next_use = -1;
+      int64_t distance = 0;
+      bool only_used_by_posts = true;
+      for (auto position : c10::irange(producer + 1, number_of_exprs)) {
+        if (uses(position, tv)) {
+          next_use = next_use < 0 ? position : next_use;
+          only_used_by_posts &= is_post(position);
+        }
+        if (next_use < 0 && is_post(position)) {
+          distance++;
+        }
+      }
+      if (next_use >= 0 && only_used_by_posts && distance >= min_distance) {
+        offloads.push_back({tv, producer, next_use});
+      }
+    }
+  }
+  if (offloads.empty()) {
+    return;
+  }
+  std::stable_sort(
+      offloads.begin(), offloads.end(), [](const auto& a, const auto& b) {
+        return a.next_use < b.next_use;
+      });
+
+  FusionGuard fg(hic);
+  Stream* default_stream = hic->getDefaultStream();
+  Stream* offload_stream = IrBuilder::createInContainer<Stream>(hic);
+  // The expressions to insert before and after each top-level expression
+  std::vector<std::vector<Expr*>> before(number_of_exprs);
+  std::vector<std::vector<Expr*>> after(number_of_exprs);
+  // The bytes of prefetched tensors resident before each expression
+  std::vector<int64_t> resident_bytes(number_of_exprs, 0);
+  // The device tensor replacing each offloaded one from its next use on
+  std::unordered_map<Val*, Val*> replacements;
+  // Whether the default stream synchronizes with the offload stream before
+  // each expression. This comes before the prefetches posted there, which
+  // the expression doesn't wait for.
+  std::vector<bool> synchronizations(number_of_exprs, false);
+
+  for (const Offload& offload : offloads) {
+    auto* host_tv = ops::newValLike(offload.tv, *offload.tv->getDataType())
+                        ->as<TensorView>();
+    auto* device_tv = ops::newValLike(offload.tv, *offload.tv->getDataType())
+                          ->as<TensorView>();
+    std::vector<Expr*>& offload_exprs = after.at(offload.producer);
+    offload_exprs.push_back(
+        IrBuilder::createInContainer<SetCurrentStream>(hic, offload_stream));
+    offload_exprs.push_back(
+        IrBuilder::createInContainer<Synchronize>(hic, default_stream));
+    offload_exprs.push_back(IrBuilder::createInContainer<OffloadToHost>(
+        hic, host_tv, offload.tv));
+    offload_exprs.push_back(
+        IrBuilder::createInContainer<SetCurrentStream>(hic, default_stream));
+
+    // Moves the prefetch one PostOnStream earlier as long as the budget
+    // allows, and never before the first PostOnStream after the producer
+    const std::optional<int64_t> bytes = staticSizeInBytes(offload.tv);
+    int64_t prefetch = offload.next_use;
+    for (int64_t position = offload.next_use - 1; position > offload.producer;
+         position--) {
+      if (!is_post(position)) {
+        continue;
+      }
+      const bool fits = bytes.has_value() &&
+          std::all_of(resident_bytes.begin() + position,
+                      resident_bytes.begin() + offload.next_use,
+                      [&](int64_t resident) {
+                        return resident + bytes.value() <=
+                            prefetch_budget_bytes;
+                      });
+      if (prefetch != offload.next_use && !fits) {
+        break;
+      }
+      prefetch = position;
+    }
+    if (bytes.has_value()) {
+      for (auto position : c10::irange(prefetch, offload.next_use)) {
+        resident_bytes.at(position) += bytes.value();
+      }
+    }
+    before.at(prefetch).push_back(
+        IrBuilder::createInContainer<SetCurrentStream>(hic, offload_stream));
+    before.at(prefetch).push_back(
+        IrBuilder::createInContainer<PrefetchToDevice>(
+            hic, device_tv, host_tv));
+    before.at(prefetch).push_back(
+        IrBuilder::createInContainer<SetCurrentStream>(hic, default_stream));
+    synchronizations.at(offload.next_use) = true;
+    replacements[offload.tv] = device_tv;
+  }
+
+  std::vector<Expr*> exprs;
+  for (auto position : c10::irange(number_of_exprs)) {
+    if (synchronizations.at(position)) {
+      exprs.push_back(
+          IrBuilder::createInContainer<Synchronize>(hic, offload_stream));
+    }
+    exprs.insert(
+        exprs.end(), before.at(position).begin(), before.at(position).end());
+    Expr* expr = top_level_exprs.at(position);
+    if (auto* post = dynamic_cast<PostOnStream*>(expr)) {
+      // The offloaded tensors are only used after their offload
+      std::vector<Val*> inputs = post->inputs();
+      bool replaced = false;
+      for (Val*& input : inputs) {
+        if (auto it = replacements.find(input); it != replacements.end()) {
+          input = it->second;
+          replaced = true;
+        }
+      }
+      if (replaced) {
+        expr = IrBuilder::createInContainer<PostOnStream>(
+            hic, post->hostOpToPost(), inputs, post->outputs());
+      }
+    }
+    exprs.push_back(expr);
+    exprs.insert(
+        exprs.end(), after.at(position).begin(), after.at(position).end());
+  }
+  hic->resetTopLevelExprs(std::move(exprs));
+}
+
+} // namespace hir
+
+} // namespace nvfuser
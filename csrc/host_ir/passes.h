@@ -0,0 +1,50 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#pragma once
+
+#include <host_ir/container.h>
+
+#include <cstdint>
+
+namespace nvfuser {
+
+namespace hir {
+
+/*
+Passes rewriting the top-level expressions of a host program, which are meant
+to run on programs lowered automatically, e.g., by MultiDeviceExecutor. Both
+preserve the order in which Communications are posted, which must be the same
+on all the devices.
+*/
+
+// Moves each top-level Wait right before the first top-level expression that
+// accesses the output of its Communication, or writes its input, or to the end
+// of the program if there is none. Accesses through slices of the buffers are
+// taken into account. See Note [Deferring Waits]
+void deferWaits(HostIrContainer* hic);
+
+// Posts the top-level PostOnStream on `number_of_streams` streams round-robin,
+// and the other top-level expressions on the default stream, inserting the
+// Synchronize needed by their data dependencies. Programs that already manage
+// streams are left untouched. See Note [Assigning streams]
+void assignStreams(HostIrContainer* hic, int64_t number_of_streams);
+
+// Offloads each tensor produced by a top-level PostOnStream and next used at
+// least `min_distance` top-level PostOnStreams later, only by PostOnStreams,
+// to pinned host memory on a side stream, and prefetches it back before its
+// next use, as early as keeping at most `prefetch_budget_bytes` of prefetched
+// tensors resident allows. Programs that already manage streams are left
+// untouched. See Note [Offloading activations]
+void offloadActivations(
+    HostIrContainer* hic,
+    int64_t min_distance,
+    int64_t prefetch_budget_bytes);
+
+} // namespace hir
+
+} // namespace nvfuser
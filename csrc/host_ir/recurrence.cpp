@@ -0,0 +1,146 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#include <host_ir/recurrence.h>
+
+#include <host_ir/host_ir.h>
+#include <ir/builder.h>
+#include <ir/interface_nodes.h>
+#include <kernel_ir.h>
+#include <ops/indexing.h>
+
+#include <c10/util/irange.h>
+
+#include <algorithm>
+
+namespace nvfuser {
+
+namespace hir {
+
+// Note [Recurrent host programs]
+// A recurrent layer runs the same small cell at each step of a sequence, and
+// each step depends on the state produced by the previous one. Launching the
+// cell's kernel(s) once per step is dominated by the launch overhead, and the
+// weights, which are the same at each step, are read again by each launch.
+//
+// makeRecurrentProgram expresses the whole layer as one host program, i.e., a
+// ForLoop over the steps whose body selects the step's slice of the sequence
+// inputs and posts the cell. The state never leaves the buffers of the caller,
+// because the cell updates them in place, and the weights, being the same
+// tensors at each step, stay resident in L2 when they fit. Running the program
+// with HostIrExecutorParams::use_cuda_graphs and cached executors then
+// captures all the steps into a single CUDA graph, so that a replay launches
+// the sequence with one host call and no per-step host work. Keeping the
+// weights in shared memory across steps would instead require a persistent
+// kernel synchronizing its CTAs between steps, which is not supported.
+
+namespace {
+
+// A symbolic TensorView of the host program with the dtype of `tv` and
+// `extra_outer_dims` more dimensions
+TensorView* newHostTensor(TensorView* tv, int64_t extra_outer_dims) {
+  const auto ndims = static_cast<int64_t>(
+      TensorDomain::noReductions(tv->getLogicalDomain()).size());
+  return TensorViewBuilder()
+      .ndims(ndims + extra_outer_dims)
+      .dtype(tv->dtype())
+      .build();
+}
+
+} // namespace
+
+std::unique_ptr<HostIrContainer> makeRecurrentProgram(
+    std::unique_ptr<Fusion> cell,
+    const std::vector<int64_t>& sequence_inputs) {
+  NVF_CHECK(
+      !sequence_inputs.empty(),
+      "A recurrent program needs at least one sequence input");
+  const auto num_inputs = static_cast<int64_t>(cell->inputs().size());
+  for (int64_t i : sequence_inputs) {
+    NVF_CHECK(
+        i >= 0 && i < num_inputs,
+        "Invalid sequence input ",
+        i,
+        " of a cell with ",
+        num_inputs,
+        " inputs");
+  }
+
+  auto hic = std::make_unique<HostIrContainer>();
+  FusionGuard fg(hic.get());
+
+  auto is_sequence_input = [&](int64_t i) {
+    return std::find(sequence_inputs.begin(), sequence_inputs.end(), i) !=
+        sequence_inputs.end();
+  };
+
+  std::vector<TensorView*> program_inputs;
+  program_inputs.reserve(num_inputs);
+  for (auto i : c10::irange(num_inputs)) {
+    auto* tv = dynamic_cast<TensorView*>(cell->inputs().at(i));
+    NVF_CHECK(
+        tv != nullptr,
+        "The inputs of a recurrent cell must be TensorViews, but got ",
+        cell->inputs().at(i)->toString());
+    TensorView* program_input =
+        newHostTensor(tv, /*extra_outer_dims=*/is_sequence_input(i) ? 1 : 0);
+    hic->addInput(program_input);
+    program_inputs.push_back(program_input);
+  }
+
+  TensorView* first_sequence = program_inputs.at(sequence_inputs.front());
+  auto* index = IrBuilder::create<Val>(DataType::Index);
+  auto* for_loop = IrBuilder::create<ForLoop>(
+      first_sequence->axis(0),
+      index,
+      hic->zeroVal(DataType::Index),
+      first_sequence->axis(0)->extent(),
+      hic->oneVal(DataType::Index),
+      /*vectorize=*/false,
+      /*vectorize_shift=*/nullptr,
+      /*unroll_required=*/false,
+      CircularBufferLoopStage::NotApplicable);
+
+  std::vector<Val*> post_inputs;
+  post_inputs.reserve(num_inputs);
+  for (auto i : c10::irange(num_inputs)) {
+    TensorView* program_input = program_inputs.at(i);
+    if (!is_sequence_input(i)) {
+      post_inputs.push_back(program_input);
+      continue;
+    }
+    TensorView* step_input = select(program_input, 0, index);
+    for_loop->body().push_back(step_input->definition());
+    post_inputs.push_back(step_input);
+  }
+
+  std::vector<Val*> post_outputs;
+  post_outputs.reserve(cell->outputs().size());
+  for (Val* out : cell->outputs()) {
+    NVF_CHECK(
+        out->isA<TensorView>(),
+        "The outputs of a recurrent cell must be TensorViews, but got ",
+        out->toString());
+    post_outputs.push_back(
+        newHostTensor(out->as<TensorView>(), /*extra_outer_dims=*/0));
+  }
+
+  auto* host_unit = IrBuilder::create<HostUnit>(std::move(cell));
+  auto* post_on_stream =
+      IrBuilder::create<PostOnStream>(host_unit, post_inputs, post_outputs);
+  for_loop->body().push_back(post_on_stream);
+
+  hic->pushBackTopLevelExprs(for_loop);
+  for (Val* out : post_outputs) {
+    hic->addOutput(out);
+  }
+  return hic;
+}
+
+} // namespace hir
+
+} // namespace nvfuser
@@ -0,0 +1,43 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#pragma once
+
+#include <fusion.h>
+#include <host_ir/container.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace nvfuser {
+
+namespace hir {
+
+// Builds a host program running the recurrent cell `cell`, e.g., an LSTM or GRU
+// cell, for each step of a sequence:
+//   for t in range(sequence length):
+//     run cell with the slices [t] of the sequence inputs and the other inputs
+// The host program has one input per input of `cell`. The ones at the
+// positions `sequence_inputs` have an additional outermost dimension, of the
+// length of the sequence, and the cell reads their slice at the current step;
+// the others, e.g., the weights and the state, are given to the cell as is.
+// All the inputs must be TensorViews.
+//
+// The cell carries its state across steps, and writes its per-step outputs,
+// in place, by aliasing its outputs to its inputs with
+// AllocationType::ReuseBuffer: a state output aliases the state input, and a
+// per-step output aliases a sequence input used as the output buffer. The
+// outputs of the host program are the outputs of the cell at the last step.
+// See Note [Recurrent host programs]
+std::unique_ptr<HostIrContainer> makeRecurrentProgram(
+    std::unique_ptr<Fusion> cell,
+    const std::vector<int64_t>& sequence_inputs);
+
+} // namespace hir
+
+} // namespace nvfuser
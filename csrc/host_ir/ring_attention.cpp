@@ -0,0 +1,243 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#include <host_ir/ring_attention.h>
+
+#include <fusion.h>
+#include <host_ir/host_ir.h>
+#include <ir/builder.h>
+#include <ir/interface_nodes.h>
+#include <multidevice/communication.h>
+#include <ops/all_ops.h>
+
+#include <c10/util/irange.h>
+
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace nvfuser {
+
+namespace hir {
+
+// Note [Ring attention]
+// With context parallelism, each device holds a block of L positions of the
+// query, key and value, and the attention of its queries needs the keys and
+// values of all the blocks. Gathering them would need the memory of the whole
+// sequence on each device and expose the whole gather before the attention.
+// Instead, makeRingAttentionProgram passes the key/value blocks around the
+// ring of devices, one hop per step:
+//
+//   for step in [0, D):
+//     on the communication stream:
+//       wait for the block of this step to arrive
+//       SendRecv this block to the next device, and receive the block of the
+//         next step from the previous device
+//     on the default stream:
+//       wait for the communication stream
+//       (o_b, lse_b) = SdpaFwdOp(q, k_step, v_step)
+//       merge (o_b, lse_b) into (o, lse)
+//
+// so that the transfer of the next block overlaps with the attention of the
+// current one. With HostIrExecutorParams::release_dead_values, a block is
+// released after the step that forwards it, so each device holds the current
+// and the next blocks rather than the whole sequence. The partial results are
+// merged with the online softmax:
+//   lse = log(exp(lse_a) + exp(lse_b))
+//   o = o_a * exp(lse_a - lse) + o_b * exp(lse_b - lse)
+// computed around max(lse_a, lse_b) for stability, by a fusion posted with
+// PostOnStream. The running output is kept in float, and only the last merge
+// produces the dtype of the inputs. The SdpaFwdOps are run by ATen through
+// the expression evaluator.
+//
+// The ring is unrolled, since the number of devices is known when the program
+// is built, so each device's program computes exactly the blocks it needs:
+// with `is_causal`, the device of index i in the mesh attends to the blocks of
+// the devices 0..i, the diagonal one with a causal mask, and only forwards the
+// others. The Communications are the same and in the same order in all the
+// programs, as required by the backends. The receive buffers are allocated by
+// HostIrExecutor like the blocks they receive.
+//
+// The blocks being contiguous in the sequence, the devices of higher index do
+// more work with `is_causal`. Balancing it, e.g., by giving each device two
+// blocks from both ends of the sequence, is left to the caller's sharding.
+
+namespace {
+
+// A symbolic TensorView of the host program
+TensorView* newHostTensor(int64_t ndims, DataType dtype) {
+  return TensorViewBuilder().ndims(ndims).dtype(dtype).build();
+}
+
+// Merges the partial attention `o_b`, `lse_b` of a key/value block into the
+// running `o_a`, `lse_a`
+std::unique_ptr<Fusion> makeMergeFusion(
+    DataType o_a_dtype,
+    DataType o_b_dtype,
+    DataType out_dtype) {
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+
+  TensorView* o_a = newHostTensor(4, o_a_dtype);
+  TensorView* lse_a = newHostTensor(3, DataType::Float);
+  TensorView* o_b = newHostTensor(4, o_b_dtype);
+  TensorView* lse_b = newHostTensor(3, DataType::Float);
+  for (TensorView* tv : {o_a, lse_a, o_b, lse_b}) {
+    fusion->addInput(tv);
+  }
+
+  TensorView* lse_max = max(lse_a, lse_b);
+  TensorView* w_a = exp(sub(lse_a, lse_max));
+  TensorView* w_b = exp(sub(lse_b, lse_max));
+  TensorView* w_sum = add(w_a, w_b);
+  TensorView* lse = add(lse_max, log(w_sum));
+
+  const std::vector<bool> is_broadcast = {false, false, false, true};
+  TensorView* o = add(
+      mul(castOp(DataType::Float, o_a),
+          broadcast(div(w_a, w_sum), is_broadcast)),
+      mul(castOp(DataType::Float, o_b),
+          broadcast(div(w_b, w_sum), is_broadcast)));
+  fusion->addOutput(maybeCastOp(out_dtype, o));
+  fusion->addOutput(lse);
+  return fusion;
+}
+
+} // namespace
+
+std::unique_ptr<HostIrContainer> makeRingAttentionProgram(
+    const DeviceMesh& mesh,
+    DeviceIdxType my_device_index,
+    DataType dtype,
+    bool is_causal,
+    std::optional<double> scale) {
+  NVF_CHECK(
+      mesh.has(my_device_index),
+      "Device ",
+      my_device_index,
+      " is not in the mesh ",
+      mesh);
+  const int64_t num_devices = mesh.size();
+  const int64_t my_index = mesh.idxOf(my_device_index);
+  // The last step whose block is attended to
+  const int64_t last_step = is_causal ? my_index : num_devices - 1;
+
+  auto hic = std::make_unique<HostIrContainer>();
+  FusionGuard fg(hic.get());
+
+  TensorView* q = newHostTensor(4, dtype);
+  TensorView* k = newHostTensor(4, dtype);
+  TensorView* v = newHostTensor(4, dtype);
+  for (TensorView* tv : {q, k, v}) {
+    hic->addInput(tv);
+  }
+
+  Stream* compute_stream = hic->getDefaultStream();
+  auto* communication_stream = IrBuilder::create<Stream>();
+
+  // The merge fusions, by the dtypes of their running and merged outputs
+  std::map<std::pair<DataType, DataType>, HostUnit*> merge_units;
+  auto merge_unit = [&](DataType o_a_dtype, DataType out_dtype) {
+    HostUnit*& unit = merge_units[{o_a_dtype, out_dtype}];
+    if (unit == nullptr) {
+      unit = IrBuilder::create<HostUnit>(
+          makeMergeFusion(o_a_dtype, dtype, out_dtype));
+    }
+    return unit;
+  };
+
+  TensorView* k_step = k;
+  TensorView* v_step = v;
+  // The Communications bringing the block of the current step
+  std::vector<Communication*> arriving;
+  TensorView* o = nullptr;
+  TensorView* lse = nullptr;
+  for (auto step : c10::irange(num_devices)) {
+    hic->pushBackTopLevelExprs(
+        IrBuilder::create<SetCurrentStream>(communication_stream));
+    if (step == 0) {
+      // The inputs are produced on the default stream
+      hic->pushBackTopLevelExprs(
+          IrBuilder::create<Synchronize>(compute_stream));
+    }
+    for (Communication* communication : arriving) {
+      hic->pushBackTopLevelExprs(IrBuilder::create<Wait>(communication));
+    }
+
+    std::vector<Communication*> departing;
+    TensorView* k_next = nullptr;
+    TensorView* v_next = nullptr;
+    if (step + 1 < num_devices) {
+      k_next = newHostTensor(4, dtype);
+      v_next = newHostTensor(4, dtype);
+      for (TensorView* tv : {k_step, v_step, k_next, v_next}) {
+        tv->setDeviceMesh(mesh);
+      }
+      for (auto sender_index : c10::irange(num_devices)) {
+        const DeviceIdxType sender = mesh.at(sender_index);
+        const DeviceIdxType receiver =
+            mesh.at((sender_index + 1) % num_devices);
+        for (auto [in, out] : {std::make_pair(k_step, k_next),
+                               std::make_pair(v_step, v_next)}) {
+          auto* communication = IrBuilder::create<Communication>(
+              CommunicationType::SendRecv,
+              out,
+              in,
+              Team({sender, receiver}),
+              /*root=*/sender);
+          hic->pushBackTopLevelExprs(communication);
+          departing.push_back(communication);
+        }
+      }
+    }
+
+    hic->pushBackTopLevelExprs(
+        IrBuilder::create<SetCurrentStream>(compute_stream));
+    if (!arriving.empty()) {
+      hic->pushBackTopLevelExprs(
+          IrBuilder::create<Synchronize>(communication_stream));
+    }
+
+    if (step <= last_step) {
+      SdpfaFwdResult block = sdpfa_fwd(
+          q,
+          k_step,
+          v_step,
+          /*dropout_p=*/IrBuilder::create<Val>(0.0),
+          /*is_causal=*/IrBuilder::create<Val>(is_causal && step == 0),
+          scale.has_value() ? IrBuilder::create<Val>(*scale) : nullptr);
+      hic->pushBackTopLevelExprs(block.output->definition());
+      if (o == nullptr) {
+        o = block.output;
+        lse = block.log_sumexp;
+      } else {
+        const DataType out_dtype =
+            step == last_step ? dtype : DataType::Float;
+        TensorView* merged_o = newHostTensor(4, out_dtype);
+        TensorView* merged_lse = newHostTensor(3, DataType::Float);
+        hic->pushBackTopLevelExprs(IrBuilder::create<PostOnStream>(
+            merge_unit(*o->getDataType(), out_dtype),
+            std::vector<Val*>{o, lse, block.output, block.log_sumexp},
+            std::vector<Val*>{merged_o, merged_lse}));
+        o = merged_o;
+        lse = merged_lse;
+      }
+    }
+
+    arriving = std::move(departing);
+    k_step = k_next;
+    v_step = v_next;
+  }
+
+  hic->addOutput(o);
+  hic->addOutput(lse);
+  return hic;
+}
+
+} // namespace hir
+
+} // namespace nvfuser
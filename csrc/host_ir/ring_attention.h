@@ -0,0 +1,46 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#pragma once
+
+#include <host_ir/container.h>
+#include <multidevice/device_mesh.h>
+#include <multidevice/multidevice.h>
+#include <type.h>
+
+#include <memory>
+#include <optional>
+
+namespace nvfuser {
+
+namespace hir {
+
+// Builds the host program of `my_device_index` computing attention over a
+// sequence sharded across the devices of `mesh`, i.e., context parallelism.
+// The program has three inputs, the local shards of the query, key and value,
+// of shape [N, H, L, E] and dtype `dtype`, where the device of index i in
+// `mesh` holds the positions [i * L, (i + 1) * L) of the sequence. Its
+// outputs are the attention of the local queries over the whole sequence, of
+// shape [N, H, L, E] and dtype `dtype`, and its log-sum-exp, of shape
+// [N, H, L] and dtype float, like SdpaFwdOp's.
+//
+// The key/value blocks go around the ring of devices with SendRecvs on a
+// communication stream while the attention of the local queries with the
+// current block is computed on the default stream and merged into the running
+// result. With `is_causal`, the blocks of later positions are forwarded but
+// not computed. All the devices of `mesh` must run their program. See Note
+// [Ring attention]
+std::unique_ptr<HostIrContainer> makeRingAttentionProgram(
+    const DeviceMesh& mesh,
+    DeviceIdxType my_device_index,
+    DataType dtype,
+    bool is_causal,
+    std::optional<double> scale = std::nullopt);
+
+} // namespace hir
+
+} // namespace nvfuser
@@ -822,33 +822,119 @@ Expr* IdModel::addReplayAs(std::vector<IterDomain*> new_inputs, Expr* expr) {
 
   // Initialize output iter domains in the graphs
   for (auto mode : initialized_modes) {
-    auto& graph = idGraph(mode);
+    addExprToGraph(idGraph(mode), replay);
+  }
 
-    // Initialize output ids in map. The replay expr will be
-    // registered as a definition by registerExpr
-    for (auto out_id : ir_utils::filterByType<IterDomain>(replay->outputs())) {
-      graph.initializeVal(out_id, {}, {});
+  return replay;
+}
+
+void IdModel::addExprToGraph(ValGraph& graph, Expr* expr) {
+  // Initialize output ids in map. The expr will be registered as a
+  // definition by registerExpr
+  for (auto out_id : ir_utils::filterByType<IterDomain>(expr->outputs())) {
+    graph.initializeVal(out_id, {}, {});
+  }
+
+  graph.registerExpr(expr);
+
+  // Propagate through all the uses of the iter domain groups of the inputs
+  // with the new expression.
+  // Gather all use expressions from inputs
+  VectorOfUniqueEntries<Expr*> representative_uses;
+  for (auto inp : ir_utils::filterByType<IterDomain>(expr->inputs())) {
+    for (const ExprGroup& use_group : graph.getUses(graph.toGroup(inp))) {
+      NVF_ERROR(!use_group->empty());
+      representative_uses.pushBack(use_group->front());
     }
+  }
+
+  for (auto rep_use : representative_uses) {
+    graph.maybeMapThroughExprs(rep_use, expr, true);
+  }
+}
 
-    graph.registerExpr(replay);
+void IdModel::updateAfterTransforms() {
+  if (tvs_.empty()) {
+    return;
+  }
+  FusionGuard fg(fusion_);
 
-    // Propagate through all the uses of the iter domain groups of the inputs
-    // with the new expression.
-    // Gather all use expressions from inputs
-    VectorOfUniqueEntries<Expr*> representative_uses;
-    for (IterDomain* inp : new_inputs) {
-      for (const ExprGroup& use_group : graph.getUses(graph.toGroup(inp))) {
-        NVF_ERROR(!use_group->empty());
-        representative_uses.pushBack(use_group->front());
+  // Gather the definitions of the new IterDomains
+  VectorOfUniqueEntries<Expr*> new_exprs;
+  for (auto tv : tvs_) {
+    for (auto id : tv->domain()->allIDs()) {
+      if (id_definitions_.find(id) == id_definitions_.end() &&
+          id->definition() != nullptr) {
+        new_exprs.pushBack(id->definition());
       }
     }
+  }
 
-    for (auto rep_use : representative_uses) {
-      graph.maybeMapThroughExprs(rep_use, replay, true);
+  // Add them in topological order, i.e., once all their inputs are known
+  std::vector<Expr*> sorted_exprs;
+  sorted_exprs.reserve(new_exprs.size());
+  while (!new_exprs.empty()) {
+    auto ready_it =
+        std::find_if(new_exprs.begin(), new_exprs.end(), [&](Expr* expr) {
+          auto inputs = ir_utils::filterByType<IterDomain>(expr->inputs());
+          return std::all_of(
+              inputs.begin(), inputs.end(), [&](IterDomain* inp) {
+                return id_definitions_.find(inp) != id_definitions_.end();
+              });
+        });
+    NVF_ERROR(
+        ready_it != new_exprs.end(),
+        "Can't update the IdModel with ",
+        new_exprs.front()->toString(),
+        " as its inputs are not in the graphs. Build a new IdModel.");
+    Expr* expr = *ready_it;
+    new_exprs.erase(expr);
+
+    for (auto out_id : ir_utils::filterByType<IterDomain>(expr->outputs())) {
+      id_definitions_[out_id].pushBack(expr);
+      id_uses_.emplace(out_id, VectorOfUniqueEntries<Expr*>{});
+    }
+    for (auto inp_id : ir_utils::filterByType<IterDomain>(expr->inputs())) {
+      id_uses_[inp_id].pushBack(expr);
     }
+    sorted_exprs.push_back(expr);
   }
 
-  return replay;
+  for (auto mode : {IdMappingMode::EXACT, IdMappingMode::ALMOSTEXACT}) {
+    auto graph_it = id_graphs_.find(mode);
+    if (graph_it == id_graphs_.end()) {
+      continue;
+    }
+    auto& graph = graph_it->second;
+    for (auto expr : sorted_exprs) {
+      addExprToGraph(graph, expr);
+      // Same as buildAlmostExactGraph
+      if (mode == IdMappingMode::ALMOSTEXACT) {
+        for (const auto& mapped_ids : getTriviallyMappedIds(expr)) {
+          for (auto id : mapped_ids) {
+            graph.mapVals(mapped_ids.front(), id);
+          }
+        }
+      }
+    }
+    graph.validateConsistency();
+  }
+
+  if (!allow_self_mapping_ &&
+      id_graphs_.find(IdMappingMode::EXACT) != id_graphs_.end()) {
+    assertNoSelfMapping();
+  }
+
+  const bool had_permissive =
+      id_graphs_.erase(IdMappingMode::PERMISSIVE) > 0;
+  const bool had_loop = id_graphs_.erase(IdMappingMode::LOOP) > 0;
+  loop_promotion_map_.clear();
+  if (had_permissive) {
+    buildPermissiveGraph();
+  }
+  if (had_loop) {
+    buildLoopGraph();
+  }
 }
 
 void IdModel::validateLoopGraphHasNoSelfMappedLeafDomains() const {
@@ -210,6 +210,17 @@ class IdModel : public PolymorphicBase {
   // replayed expression and adding potential mappings through the expression.
   Expr* addReplayAs(std::vector<IterDomain*> new_inputs, Expr* expr);
 
+  // Updates the graphs after scheduling transforms of the tensors of this
+  // model, e.g., split, merge, reorder and inlining, instead of building a new
+  // IdModel. The IterDomain expressions added since the graphs were built are
+  // registered in the EXACT and ALMOSTEXACT graphs, which are mapped through
+  // them as they would be by a rebuild. The PERMISSIVE and LOOP graphs and the
+  // loop promotion map depend on broadcast forwarding and inlining, so they
+  // are rebuilt if they were built, starting from the updated EXACT graph.
+  // Adding or removing tensors is not supported; the new expressions must only
+  // use IterDomains that are already in the graphs.
+  void updateAfterTransforms();
+
   //! Run through disjoint sets in the LOOP graph, make sure there's only one
   //! non-serial parallel type in each disjoint set, set the parallel type of
   //! all IterDomains in the disjoint set to that PType.
@@ -229,6 +240,10 @@ class IdModel : public PolymorphicBase {
   std::unordered_map<ValGroup, IterDomain*> buildLoopPromotionMap(
       const StatefulInliningInfo& info);
 
+  // Adds `expr` to `graph` and maps its outputs through the uses of its input
+  // groups. The outputs of `expr` must be new to `graph`.
+  void addExprToGraph(ValGraph& graph, Expr* expr);
+
   // Errors if self mapping occurs
   void assertNoSelfMapping();
 
@@ -895,7 +895,7 @@ std::vector<Val*> TensorIndexer::getIndexFor(
     bool as_consumer,
     const ValGroups& index_groups,
     const std::vector<ForLoop*>& for_loops) const {
-  auto info = computeIndex(expr, index_groups, for_loops);
+  const auto& info = computeIndex(expr, index_groups, for_loops);
   const auto& replacement_map = getIndexReplacementMap(
       expr, as_consumer, info.loop_domains, for_loops, info.index_map);
 
@@ -969,15 +969,56 @@ std::vector<IterDomain*> TensorIndexer::getLoopDomains(const Expr* expr) const {
   return loop_domains;
 }
 
-IndexingInfo TensorIndexer::computeIndex(
+// Note [Indexing info cache]
+//
+// computeIndex is called for every producer and consumer of every
+// expr as well as for predicates, and most of these calls find the
+// same traversal path, e.g., all the tensors of a pointwise kernel
+// have the same loop domains and allocation domains mapped in the
+// AlmostExact graph. The traversal path only depends on the loop
+// groups, the index groups and the resize exprs of the consumer
+// tensor, so it is cached with these as the key. The consumer tensor
+// is part of the key only when it has a root domain, as otherwise it
+// has no resize.
+//
+// The whole IndexingInfo is also cached. The initial index map
+// only depends on the promoted loop domains, which are the same for
+// all tensors with the same loop groups, and on the for-loops for
+// circular buffering. Tensors with the same key thus share the index
+// Vals, which are further specialized for each tensor by the
+// replacement maps of getIndexReplacementMap and
+// getPredicateIndexReplacementMap. The traversal graph is not
+// modified during indexing, so the cached results stay valid.
+const IndexingInfo& TensorIndexer::computeIndex(
     const Expr* expr,
     const ValGroups& index_groups,
     const std::vector<ForLoop*>& for_loops) const {
   const auto loop_domains = getLoopDomains(expr);
 
+  const TensorView* consumer_tv = ir_utils::getTvOutput(expr);
+  const TensorView* resize_tv =
+      consumer_tv != nullptr && consumer_tv->hasRoot() ? consumer_tv : nullptr;
+
+  IndexingInfoKey info_key{
+      loop_domains, index_groups.vector(), for_loops, resize_tv};
+  if (auto it = indexing_info_cache_.find(info_key);
+      it != indexing_info_cache_.end()) {
+    return it->second;
+  }
+
   const ValGroups loop_groups = traversalGraph().toGroups(loop_domains);
-  const ExprPath<ExprGroup> traversal_path = IndexingTraversal::getExprsBetween(
-      expr, traversalGraph(), loop_groups, index_groups);
+  TraversalPathKey path_key{
+      loop_groups.vector(), index_groups.vector(), resize_tv};
+  auto path_it = traversal_path_cache_.find(path_key);
+  if (path_it == traversal_path_cache_.end()) {
+    path_it = traversal_path_cache_
+                  .emplace(
+                      std::move(path_key),
+                      IndexingTraversal::getExprsBetween(
+                          expr, traversalGraph(), loop_groups, index_groups))
+                  .first;
+  }
+  const ExprPath<ExprGroup>& traversal_path = path_it->second;
 
   const std::unordered_map<ValGroup, Val*> initial_index_map =
       getInitialIndexMap(loop_domains, for_loops);
@@ -1021,7 +1062,8 @@ IndexingInfo TensorIndexer::computeIndex(
       traversal_path,
       index_compute.indexMap(),
       loop_group_dependencies};
-  return info;
+  return indexing_info_cache_.emplace(std::move(info_key), std::move(info))
+      .first->second;
 }
 
 std::unordered_map<Val*, Val*> TensorIndexer::getIndexReplacementMap(
@@ -1287,7 +1329,7 @@ std::pair<std::vector<Val*>, std::vector<Val*>> TensorIndexer::
         const IndexingAllocationInfo& alloc_info,
         const std::vector<ForLoop*>& for_loops) const {
   const auto& index_groups = traversalGraph().toGroups(alloc_info.domains);
-  auto index_info = computeIndex(expr, index_groups, for_loops);
+  const auto& index_info = computeIndex(expr, index_groups, for_loops);
   const auto& index_map = index_info.index_map;
   const auto& replacement_map = getIndexReplacementMap(
       expr, as_consumer, index_info.loop_domains, for_loops, index_map);
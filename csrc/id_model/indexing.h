@@ -19,6 +19,8 @@
 // Just for PredicateInfo. Should be moved to its own header file
 #include <index_compute.h>
 
+#include <map>
+#include <tuple>
 #include <unordered_map>
 
 namespace nvfuser {
@@ -131,8 +133,8 @@ class TensorIndexer {
 
   // Returns the index map as well as its traversal path of given
   // index domains appearing in a given expr. Used by
-  // getIndexFor.
-  IndexingInfo computeIndex(
+  // getIndexFor. The result is cached, see Note [Indexing info cache].
+  const IndexingInfo& computeIndex(
       const Expr* expr,
       const ValGroups& index_groups,
       const std::vector<ForLoop*>& for_loops) const;
@@ -198,6 +200,23 @@ class TensorIndexer {
   // Allocation info for each tensor. Must be filled before computing
   // the index of each tensor
   std::unordered_map<TensorView*, IndexingAllocationInfo> alloc_info_;
+
+  // Traversal paths keyed by the loop groups, the index groups and the
+  // consumer tensor whose resize exprs restrict the traversal, if any
+  using TraversalPathKey = std::
+      tuple<std::vector<ValGroup>, std::vector<ValGroup>, const TensorView*>;
+  mutable std::map<TraversalPathKey, ExprPath<ExprGroup>>
+      traversal_path_cache_;
+
+  // Results of computeIndex keyed by the promoted loop domains, the
+  // index groups, the enclosing for-loops and the consumer tensor
+  // whose resize exprs restrict the traversal, if any
+  using IndexingInfoKey = std::tuple<
+      std::vector<IterDomain*>,
+      std::vector<ValGroup>,
+      std::vector<ForLoop*>,
+      const TensorView*>;
+  mutable std::map<IndexingInfoKey, IndexingInfo> indexing_info_cache_;
 };
 
 } // namespace nvfuser
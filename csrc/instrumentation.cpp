@@ -5,23 +5,79 @@
  * SPDX-License-Identifier: BSD-3-Clause
  */
 // clang-format on
+#include <fusion.h>
 #include <instrumentation.h>
 #include <options.h>
 #include <utils.h>
 
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
 #ifdef _WIN32
 #include <c10/util/win32-headers.h>
 #else
+#include <malloc.h>
 #include <pthread.h>
+#include <sys/resource.h>
 #include <unistd.h>
 #endif
 
 namespace nvfuser {
 namespace inst {
 
+namespace {
+
+//! Default capacity of the per-thread ring buffers of the binary trace
+constexpr size_t kDefaultTraceBufferCapacity = 1 << 16;
+
+//! Period of the background flushes of the binary trace
+constexpr auto kFlushInterval = std::chrono::milliseconds(100);
+
+unsigned int currentPid() {
+#ifdef _WIN32
+  return GetCurrentProcessId();
+#else
+  return getpid();
+#endif // _WIN32
+}
+
+} // namespace
+
 Trace::Trace() {
   const char* trace_filename = getNvFuserEnv("TRACE");
-  if (trace_filename != nullptr) {
+  if (trace_filename != nullptr &&
+      isOptionEnabled(EnableOption::BinaryTrace)) {
+    buffer_capacity_ = kDefaultTraceBufferCapacity;
+    const auto& args = getEnableOptionArguments(EnableOption::BinaryTrace);
+    if (!args.empty()) {
+      try {
+        buffer_capacity_ = std::stoull(args[0]);
+      } catch (const std::exception&) {
+        NVF_CHECK(false, "Invalid binary trace buffer capacity: ", args[0]);
+      }
+      NVF_CHECK(
+          buffer_capacity_ > 0,
+          "Binary trace buffer capacity must be positive");
+    }
+
+    log_file_ = fopen(trace_filename, "wb");
+    NVF_CHECK(log_file_ != nullptr, "Can't open trace file");
+    BinaryTraceHeader header;
+    header.pid = currentPid();
+    fwrite(&header, sizeof(header), 1, log_file_);
+    start_timestamp_ = Clock::now();
+    binary_ = true;
+
+    flusher_ = std::thread([this]() {
+      std::unique_lock<std::mutex> lock(flusher_mutex_);
+      while (!flusher_cv_.wait_for(
+          lock, kFlushInterval, [this]() { return stop_flusher_; })) {
+        flush();
+      }
+    });
+  } else if (trace_filename != nullptr) {
     log_file_ = fopen(trace_filename, "w");
     NVF_CHECK(log_file_ != nullptr, "Can't open trace file");
 
@@ -38,13 +94,29 @@ Trace::Trace() {
 
   // Note isOptionDisabled could throw an exception, so this
   // constructor should not be used from a destructor.
-  if (isOptionDisabled(DisableOption::Nvtx)) {
+  // NVTX calls are no-ops without an injected tool, but the registration of
+  // names and the labels of kernels are not free.
+  if (isOptionDisabled(DisableOption::Nvtx) ||
+      (getenv("NVTX_INJECTION64_PATH") == nullptr &&
+       getenv("NVTX_INJECTION32_PATH") == nullptr)) {
     record_nvtx_range_ = false;
+  } else {
+    nvtx_domain_ = nvtxDomainCreateA("nvFuser");
   }
+  record_host_memory_ = isOptionEnabled(EnableOption::HostMemoryTrace);
 }
 
 Trace::~Trace() {
-  if (log_file_ != nullptr) {
+  if (binary_) {
+    {
+      std::lock_guard<std::mutex> guard(flusher_mutex_);
+      stop_flusher_ = true;
+    }
+    flusher_cv_.notify_one();
+    flusher_.join();
+    flush();
+    fclose(log_file_);
+  } else if (log_file_ != nullptr) {
     // Print trace epilogue
     logEvent('I', "TRACE_END", ' ');
     fprintf(log_file_, "],\n\"displayTimeUnit\": \"ms\"\n}\n");
@@ -56,11 +128,10 @@ void Trace::logEvent(char ph, const char* name, char sep) {
   const std::chrono::duration<double> d = Clock::now() - start_timestamp_;
   const double elapsed = d.count() * 1e6;
 
+  const unsigned int pid = currentPid();
 #ifdef _WIN32
-  const unsigned int pid = GetCurrentProcessId();
   const unsigned int tid = GetCurrentThreadId();
 #else
-  const unsigned int pid = getpid();
   const unsigned int tid = std::hash<pthread_t>{}(pthread_self());
 #endif // _WIN32
 
@@ -75,5 +146,169 @@ void Trace::logEvent(char ph, const char* name, char sep) {
       sep);
 }
 
+NvtxKernelLabel Trace::makeNvtxKernelLabel(
+    const std::string& message,
+    uint32_t category,
+    const char* category_name,
+    uint64_t payload) {
+  NVF_ERROR(record_nvtx_range_, "NVTX ranges are not recorded");
+  NvtxKernelLabel label;
+  label.message = nvtxDomainRegisterStringA(nvtx_domain_, message.c_str());
+  label.category = category;
+  label.payload = payload;
+  nvtxDomainNameCategoryA(nvtx_domain_, category, category_name);
+  return label;
+}
+
+TraceBuffer* Trace::registerThread() {
+  std::lock_guard<std::mutex> guard(buffers_mutex_);
+  const auto tid = (uint32_t)buffers_.size() + 1;
+  buffers_.push_back(std::make_unique<TraceBuffer>(buffer_capacity_, tid));
+  return buffers_.back().get();
+}
+
+void Trace::writeRecord(const BinaryTraceRecord& record, const char* data) {
+  fwrite(&record, sizeof(record), 1, log_file_);
+  if (record.size > 0) {
+    constexpr char zeros[8] = {};
+    fwrite(data, 1, record.size, log_file_);
+    fwrite(zeros, 1, (8 - record.size % 8) % 8, log_file_);
+  }
+}
+
+void Trace::flush() {
+  if (!binary_) {
+    return;
+  }
+  std::lock_guard<std::mutex> flush_guard(flush_mutex_);
+
+  std::vector<TraceBuffer*> buffers;
+  {
+    std::lock_guard<std::mutex> guard(buffers_mutex_);
+    for (const auto& buffer : buffers_) {
+      buffers.push_back(buffer.get());
+    }
+  }
+
+  // Names are written once, before the first event referring to them
+  auto name_id = [this](const char* name) -> uint32_t {
+    auto it = name_ids_.find(name);
+    if (it != name_ids_.end()) {
+      return it->second;
+    }
+    const auto id = (uint32_t)name_ids_.size() + 1;
+    name_ids_.emplace(name, id);
+    BinaryTraceRecord record;
+    record.ph = 'N';
+    record.name_id = id;
+    record.size = name == nullptr ? 0 : (uint32_t)strlen(name);
+    writeRecord(record, name);
+    return id;
+  };
+
+  for (TraceBuffer* buffer : buffers) {
+    const uint64_t dropped =
+        buffer->drain([&](const TraceBuffer::Event& event) {
+          BinaryTraceRecord record;
+          record.ph = event.ph;
+          record.name_id = name_id(event.name);
+          record.tid = buffer->tid();
+          record.ts_ns = event.ts_ns;
+          writeRecord(record, nullptr);
+        });
+    if (dropped > 0) {
+      BinaryTraceRecord record;
+      record.ph = 'D';
+      record.tid = buffer->tid();
+      record.size = (uint32_t)std::min<uint64_t>(
+          dropped, std::numeric_limits<uint32_t>::max());
+      writeRecord(record, nullptr);
+    }
+  }
+  fflush(log_file_);
+}
+
+void Trace::addScopeTime(const char* name, Clock::duration duration) {
+  std::lock_guard<std::mutex> guard(scope_times_mutex_);
+  ScopeTime& time = scope_times_[name];
+  time.total_ns +=
+      std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+  ++time.count;
+}
+
+std::unordered_map<std::string, Trace::ScopeTime> Trace::scopeTimes() const {
+  std::lock_guard<std::mutex> guard(scope_times_mutex_);
+  return scope_times_;
+}
+
+void Trace::resetScopeTimes() {
+  std::lock_guard<std::mutex> guard(scope_times_mutex_);
+  scope_times_.clear();
+}
+
+Trace::HostMemory Trace::hostMemory() {
+  HostMemory memory;
+#if defined(__GLIBC__)
+#if __GLIBC_PREREQ(2, 33)
+  const struct mallinfo2 info = mallinfo2();
+  // Small chunks from the arenas and large chunks mapped separately
+  memory.heap_bytes = (int64_t)(info.uordblks + info.hblkhd);
+#endif
+#endif
+#ifndef _WIN32
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+    // In KiB on Linux
+    memory.peak_rss_bytes = (int64_t)usage.ru_maxrss * 1024;
+  }
+#endif
+  if (Fusion* fusion = FusionGuard::getCurFusion()) {
+    memory.ir_nodes =
+        (int64_t)(fusion->vals().size() + fusion->unordered_exprs().size());
+  }
+  return memory;
+}
+
+void Trace::addScopeMemory(const char* name, int64_t heap_bytes) {
+  const HostMemory memory = hostMemory();
+  {
+    std::lock_guard<std::mutex> guard(scope_memory_mutex_);
+    ScopeMemory& scope = scope_memory_[name];
+    ++scope.count;
+    scope.heap_growth_bytes += memory.heap_bytes - heap_bytes;
+    scope.peak_heap_bytes = std::max(scope.peak_heap_bytes, memory.heap_bytes);
+    scope.peak_rss_bytes =
+        std::max(scope.peak_rss_bytes, memory.peak_rss_bytes);
+    scope.peak_ir_nodes = std::max(scope.peak_ir_nodes, memory.ir_nodes);
+  }
+
+  // Counter events are only supported by the JSON trace
+  if (log_file_ == nullptr || binary_) {
+    return;
+  }
+  const std::chrono::duration<double> d = Clock::now() - start_timestamp_;
+  fprintf(
+      log_file_,
+      "{ \"name\": \"host_memory\", \"ph\": \"C\", \"pid\": %u, "
+      "\"ts\": %.0f, \"args\": { \"heap_mb\": %.3f, \"peak_rss_mb\": %.3f, "
+      "\"ir_nodes\": %lld } },\n",
+      currentPid(),
+      d.count() * 1e6,
+      (double)memory.heap_bytes / 1e6,
+      (double)memory.peak_rss_bytes / 1e6,
+      (long long)memory.ir_nodes);
+}
+
+std::unordered_map<std::string, Trace::ScopeMemory> Trace::scopeMemory()
+    const {
+  std::lock_guard<std::mutex> guard(scope_memory_mutex_);
+  return scope_memory_;
+}
+
+void Trace::resetScopeMemory() {
+  std::lock_guard<std::mutex> guard(scope_memory_mutex_);
+  scope_memory_.clear();
+}
+
 } // namespace inst
 } // namespace nvfuser
@@ -14,12 +14,102 @@
 
 // NOLINTNEXTLINE(modernize-deprecated-headers)
 #include <stdio.h>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 namespace nvfuser {
 namespace inst {
 
+//! Fixed-size record of the binary trace file. The file starts with a
+//! BinaryTraceHeader followed by these records. A name record (ph 'N') defines
+//! `name_id` and is followed by the `size` bytes of the name, padded to a
+//! multiple of 8 bytes. A drop record (ph 'D') tells that `size` events of
+//! thread `tid` were lost because its ring buffer was full. Other records are
+//! events, timestamped in ns since the start of the trace.
+struct BinaryTraceRecord {
+  char ph = 0;
+  char padding[3] = {};
+  uint32_t name_id = 0;
+  uint32_t tid = 0;
+  uint32_t size = 0;
+  int64_t ts_ns = 0;
+};
+static_assert(sizeof(BinaryTraceRecord) == 24);
+
+struct BinaryTraceHeader {
+  char magic[8] = {'N', 'V', 'F', 'T', 'R', 'A', 'C', 'E'};
+  uint32_t version = 1;
+  uint32_t pid = 0;
+};
+static_assert(sizeof(BinaryTraceHeader) == 16);
+
+//! Single producer, single consumer ring buffer of the events of one thread.
+//! The owning thread pushes events without locking, the flusher drains them.
+//! Events pushed while the buffer is full are dropped and counted.
+class TraceBuffer : public NonCopyable {
+ public:
+  struct Event {
+    const char* name = nullptr;
+    int64_t ts_ns = 0;
+    char ph = 0;
+  };
+
+  TraceBuffer(size_t capacity, uint32_t tid)
+      : events_(capacity), tid_(tid) {}
+
+  void push(char ph, const char* name, int64_t ts_ns) {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) == events_.size()) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    events_[tail % events_.size()] = {name, ts_ns, ph};
+    tail_.store(tail + 1, std::memory_order_release);
+  }
+
+  //! Consume all the events pushed so far. Returns the number of events
+  //! dropped since the last call.
+  template <typename F>
+  uint64_t drain(F&& consume) {
+    const size_t tail = tail_.load(std::memory_order_acquire);
+    size_t head = head_.load(std::memory_order_relaxed);
+    for (; head != tail; ++head) {
+      consume(events_[head % events_.size()]);
+    }
+    head_.store(head, std::memory_order_release);
+    return dropped_.exchange(0, std::memory_order_relaxed);
+  }
+
+  uint32_t tid() const {
+    return tid_;
+  }
+
+ private:
+  std::vector<Event> events_;
+  const uint32_t tid_;
+  std::atomic<size_t> head_ = 0;
+  std::atomic<size_t> tail_ = 0;
+  std::atomic<uint64_t> dropped_ = 0;
+};
+
+//! Message, category and payload of the NVTX ranges of the launches of a
+//! kernel, registered once in the nvFuser domain, see
+//! Trace::makeNvtxKernelLabel
+struct NvtxKernelLabel {
+  nvtxStringHandle_t message = nullptr;
+  uint32_t category = 0;
+  uint64_t payload = 0;
+};
+
 //! An optional record of selected timestamped operations, events and counters
 //!
 //! This class is not intended to be used directly. Instead, the operations
@@ -36,10 +126,67 @@ namespace inst {
 //! An easy way to view traces is to type `about://tracing` in Chrome or
 //! Chromium.
 //!
+//! With `NVFUSER_ENABLE=binary_trace`, events are instead pushed to a ring
+//! buffer per thread and written to the trace file as BinaryTraceRecords by a
+//! background thread, or when flush() is called. This keeps formatting and I/O
+//! off the traced threads. The capacity of the ring buffers, in events, is an
+//! optional argument, e.g. binary_trace(1048576). tools/trace_to_json.py
+//! converts the binary file to the Chrome Tracing format, which Perfetto
+//! reads as well. Event names must outlive the trace, e.g. string literals.
+//!
+//! Unless NVFUSER_DISABLE=nvtx, scopes are also pushed as NVTX ranges in the
+//! "nvFuser" domain, with messages registered once per name so that NVTX
+//! does not copy and hash them on every push. Kernel launches get ranges
+//! labeled with their kernel, fusion, runtime, segment and heuristic, see
+//! NvtxKernelScope. NVTX ranges are only pushed when a tool such as Nsight
+//! Systems is injected, which is detected once from NVTX_INJECTION64_PATH,
+//! so they cost a branch otherwise.
+//!
+//! Independently of the trace file, the host time spent in every scope can be
+//! accumulated in process with enableScopeTimes(), which benchmarks use to
+//! break the time of a call down into its stages. Times are inclusive, so a
+//! scope also counts the time of the scopes nested in it.
+//!
+//! With `NVFUSER_ENABLE=host_memory_trace`, the bytes in use in the host heap
+//! are sampled at the start and end of every scope, along with the peak RSS
+//! of the process and the number of IR nodes of the current Fusion. Their
+//! growth and peaks are accumulated per scope, see scopeMemory(), and the
+//! samples are written to the JSON trace as counter events, which Chrome
+//! Tracing and Perfetto plot over the scopes. Allocations are not
+//! intercepted, so a scope is charged the net growth of the heap, i.e. what
+//! it allocates and does not free before it ends.
+//!
 class Trace : public NonCopyable {
  public:
   using Clock = std::chrono::steady_clock;
 
+  //! Accumulated host time of a scope
+  struct ScopeTime {
+    int64_t total_ns = 0;
+    int64_t count = 0;
+  };
+
+  //! Host memory sampled at the end of a scope
+  struct HostMemory {
+    //! Bytes in use in the heap, as reported by mallinfo2
+    int64_t heap_bytes = 0;
+    //! Peak resident set size of the process so far
+    int64_t peak_rss_bytes = 0;
+    //! Vals and Exprs of the Fusion of the current FusionGuard, if any
+    int64_t ir_nodes = 0;
+  };
+
+  //! Accumulated host memory of a scope
+  struct ScopeMemory {
+    int64_t count = 0;
+    //! Sum of the growth of the heap over the calls of the scope
+    int64_t heap_growth_bytes = 0;
+    //! Maxima of the samples taken at the end of the calls of the scope
+    int64_t peak_heap_bytes = 0;
+    int64_t peak_rss_bytes = 0;
+    int64_t peak_ir_nodes = 0;
+  };
+
  public:
   NVF_API static Trace* instance() {
     static Trace trace;
@@ -47,33 +194,156 @@ class Trace : public NonCopyable {
   }
 
   void beginEvent(const char* name) {
-    if (log_file_ != nullptr) {
+    if (binary_) {
+      recordEvent('B', name);
+    } else if (log_file_ != nullptr) {
       logEvent('B', name);
     }
     if (record_nvtx_range_) {
-      nvtxRangePushA(name);
+      pushNvtxRange(name);
     }
   }
 
   void endEvent(const char* name) {
     if (record_nvtx_range_) {
-      nvtxRangePop();
+      nvtxDomainRangePop(nvtx_domain_);
     }
-    if (log_file_ != nullptr) {
+    if (binary_) {
+      recordEvent('E', name);
+    } else if (log_file_ != nullptr) {
       logEvent('E', name);
     }
   }
 
+  //! Write the events buffered so far to the binary trace file
+  NVF_API void flush();
+
+  //! Whether NVTX ranges are pushed, i.e. NVTX is enabled and a tool is
+  //! injected
+  bool recordingNvtxRanges() const {
+    return record_nvtx_range_;
+  }
+
+  //! Registers `message` in the nvFuser domain and names `category` after
+  //! `category_name`, which must be the same for all the labels of a
+  //! category. Only valid if recordingNvtxRanges().
+  NVF_API NvtxKernelLabel makeNvtxKernelLabel(
+      const std::string& message,
+      uint32_t category,
+      const char* category_name,
+      uint64_t payload);
+
+  void beginNvtxKernelRange(const NvtxKernelLabel& label) {
+    nvtxEventAttributes_t attributes = {};
+    attributes.version = NVTX_VERSION;
+    attributes.size = NVTX_EVENT_ATTRIB_STRUCT_SIZE;
+    attributes.messageType = NVTX_MESSAGE_TYPE_REGISTERED;
+    attributes.message.registered = label.message;
+    attributes.category = label.category;
+    attributes.payloadType = NVTX_PAYLOAD_TYPE_UNSIGNED_INT64;
+    attributes.payload.ullValue = label.payload;
+    nvtxDomainRangePushEx(nvtx_domain_, &attributes);
+  }
+
+  void endNvtxKernelRange() {
+    nvtxDomainRangePop(nvtx_domain_);
+  }
+
+  //! Start or stop accumulating the time spent in each scope
+  void enableScopeTimes(bool enable) {
+    record_scope_times_.store(enable, std::memory_order_relaxed);
+  }
+
+  bool recordingScopeTimes() const {
+    return record_scope_times_.load(std::memory_order_relaxed);
+  }
+
+  NVF_API void addScopeTime(const char* name, Clock::duration duration);
+
+  //! Copy of the times accumulated so far, keyed by scope name
+  NVF_API std::unordered_map<std::string, ScopeTime> scopeTimes() const;
+
+  NVF_API void resetScopeTimes();
+
+  bool recordingHostMemory() const {
+    return record_host_memory_;
+  }
+
+  //! Samples the host memory of the process and the current Fusion
+  NVF_API static HostMemory hostMemory();
+
+  //! Accumulates the memory of a scope that started with `heap_bytes` in use
+  //! in the heap, and writes a counter event to the JSON trace
+  NVF_API void addScopeMemory(const char* name, int64_t heap_bytes);
+
+  //! Copy of the memory accumulated so far, keyed by scope name
+  NVF_API std::unordered_map<std::string, ScopeMemory> scopeMemory() const;
+
+  NVF_API void resetScopeMemory();
+
  private:
   NVF_API Trace();
   NVF_API ~Trace();
 
   NVF_API void logEvent(char ph, const char* name, char sep = ',');
 
+  void recordEvent(char ph, const char* name) {
+    thread_local TraceBuffer* buffer = registerThread();
+    buffer->push(
+        ph,
+        name,
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            Clock::now() - start_timestamp_)
+            .count());
+  }
+
+  //! Create the ring buffer of the calling thread
+  NVF_API TraceBuffer* registerThread();
+
+  void pushNvtxRange(const char* name) {
+    // Names are string literals, so their addresses identify them
+    thread_local std::unordered_map<const char*, nvtxStringHandle_t> handles;
+    auto it = handles.find(name);
+    if (it == handles.end()) {
+      it = handles.emplace(name, nvtxDomainRegisterStringA(nvtx_domain_, name))
+               .first;
+    }
+    nvtxEventAttributes_t attributes = {};
+    attributes.version = NVTX_VERSION;
+    attributes.size = NVTX_EVENT_ATTRIB_STRUCT_SIZE;
+    attributes.messageType = NVTX_MESSAGE_TYPE_REGISTERED;
+    attributes.message.registered = it->second;
+    nvtxDomainRangePushEx(nvtx_domain_, &attributes);
+  }
+
+  void writeRecord(const BinaryTraceRecord& record, const char* data);
+
  private:
   FILE* log_file_ = nullptr;
   Clock::time_point start_timestamp_;
   bool record_nvtx_range_ = true;
+  nvtxDomainHandle_t nvtx_domain_ = nullptr;
+
+  //! Binary trace state, see flush()
+  bool binary_ = false;
+  size_t buffer_capacity_ = 0;
+  std::mutex buffers_mutex_;
+  std::vector<std::unique_ptr<TraceBuffer>> buffers_;
+  //! Serializes flushes. Guards the file and name_ids_.
+  std::mutex flush_mutex_;
+  std::unordered_map<const char*, uint32_t> name_ids_;
+  std::mutex flusher_mutex_;
+  std::condition_variable flusher_cv_;
+  bool stop_flusher_ = false;
+  std::thread flusher_;
+
+  std::atomic<bool> record_scope_times_ = false;
+  mutable std::mutex scope_times_mutex_;
+  std::unordered_map<std::string, ScopeTime> scope_times_;
+
+  bool record_host_memory_ = false;
+  mutable std::mutex scope_memory_mutex_;
+  std::unordered_map<std::string, ScopeMemory> scope_memory_;
 };
 
 //! \internal Automatic scope for a perf marker
@@ -82,14 +352,53 @@ class TraceScope : public NonCopyable {
  public:
   explicit TraceScope(const char* event_name) : event_name_(event_name) {
     Trace::instance()->beginEvent(event_name_);
+    if (Trace::instance()->recordingScopeTimes()) {
+      timed_ = true;
+      start_ = Trace::Clock::now();
+    }
+    if (Trace::instance()->recordingHostMemory()) {
+      heap_bytes_ = Trace::hostMemory().heap_bytes;
+    }
   }
 
   ~TraceScope() {
+    if (heap_bytes_ >= 0) {
+      Trace::instance()->addScopeMemory(event_name_, heap_bytes_);
+    }
+    if (timed_) {
+      Trace::instance()->addScopeTime(
+          event_name_, Trace::Clock::now() - start_);
+    }
     Trace::instance()->endEvent(event_name_);
   }
 
  private:
   const char* event_name_ = nullptr;
+  //! Whether the scope was entered while scope times were recorded
+  bool timed_ = false;
+  Trace::Clock::time_point start_;
+  //! Heap bytes in use when the scope was entered, -1 if not recorded
+  int64_t heap_bytes_ = -1;
+};
+
+//! NVTX range of a kernel launch, labeled with `label`. Does nothing if
+//! `label` is null, e.g. when no NVTX tool is injected.
+class NvtxKernelScope : public NonCopyable {
+ public:
+  explicit NvtxKernelScope(const NvtxKernelLabel* label) : label_(label) {
+    if (label_ != nullptr) {
+      Trace::instance()->beginNvtxKernelRange(*label_);
+    }
+  }
+
+  ~NvtxKernelScope() {
+    if (label_ != nullptr) {
+      Trace::instance()->endNvtxKernelRange();
+    }
+  }
+
+ private:
+  const NvtxKernelLabel* label_ = nullptr;
 };
 
 #define FUSER_MACRO_CONCAT2(a, b) a##b
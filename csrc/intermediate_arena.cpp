@@ -0,0 +1,111 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#include <intermediate_arena.h>
+
+#include <instrumentation.h>
+
+#include <c10/util/irange.h>
+
+#include <algorithm>
+
+namespace nvfuser {
+
+int64_t ArenaBuffer::bytes() const {
+  NVF_ERROR(sizes.size() == strides.size());
+  int64_t numel = 1;
+  for (const auto i : c10::irange(sizes.size())) {
+    if (sizes[i] == 0) {
+      return 0;
+    }
+    NVF_ERROR(strides[i] >= 0, "Negative strides are not supported");
+    numel += (sizes[i] - 1) * strides[i];
+  }
+  return numel * (int64_t)c10::elementSize(type);
+}
+
+int64_t IntermediateArena::plan(const std::vector<ArenaBuffer*>& buffers) {
+  FUSER_PERF_SCOPE("IntermediateArena::plan");
+  // Greedily place the largest buffers first, each at the lowest offset not
+  // overlapping an already placed buffer that is live at the same time.
+  std::vector<ArenaBuffer*> sorted = buffers;
+  std::stable_sort(
+      sorted.begin(), sorted.end(), [](ArenaBuffer* lhs, ArenaBuffer* rhs) {
+        return lhs->bytes() > rhs->bytes();
+      });
+
+  auto padded_bytes = [](const ArenaBuffer* buffer) {
+    return (buffer->bytes() + alignment - 1) / alignment * alignment;
+  };
+
+  int64_t size = 0;
+  std::vector<ArenaBuffer*> placed;
+  for (ArenaBuffer* buffer : sorted) {
+    std::vector<ArenaBuffer*> live;
+    for (ArenaBuffer* other : placed) {
+      if (other->first_use <= buffer->last_use &&
+          buffer->first_use <= other->last_use) {
+        live.push_back(other);
+      }
+    }
+    std::sort(live.begin(), live.end(), [](ArenaBuffer* lhs, ArenaBuffer* rhs) {
+      return lhs->offset < rhs->offset;
+    });
+
+    const int64_t bytes = padded_bytes(buffer);
+    int64_t offset = 0;
+    for (ArenaBuffer* other : live) {
+      if (offset + bytes <= other->offset) {
+        break;
+      }
+      offset = std::max(offset, other->offset + padded_bytes(other));
+    }
+    buffer->offset = offset;
+    size = std::max(size, offset + bytes);
+    placed.push_back(buffer);
+  }
+  return size;
+}
+
+bool IntermediateArena::acquire(
+    int64_t size,
+    const c10::cuda::CUDAStream& stream) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (in_use_) {
+    return false;
+  }
+  if (!slab_.defined() || slab_.numel() < size || stream_ != stream) {
+    // Drop the old slab first so that its memory can be recycled. The caching
+    // allocator only hands it out again to work on the stream it was used on.
+    slab_ = at::Tensor();
+    c10::cuda::CUDAStreamGuard stream_guard(stream);
+    slab_ = at::empty(
+        {size},
+        at::TensorOptions().dtype(at::kByte).device(stream.device()));
+    stream_ = stream;
+  }
+  in_use_ = true;
+  return true;
+}
+
+void IntermediateArena::release() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  in_use_ = false;
+}
+
+at::Tensor IntermediateArena::view(const ArenaBuffer& buffer) const {
+  NVF_ERROR(in_use_, "The arena must be acquired first");
+  NVF_ERROR(buffer.offset >= 0, "Buffer is not placed in the arena");
+  const int64_t padded_bytes =
+      (buffer.bytes() + alignment - 1) / alignment * alignment;
+  NVF_ERROR(buffer.offset + padded_bytes <= slab_.numel());
+  return slab_.narrow(0, buffer.offset, padded_bytes)
+      .view(buffer.type)
+      .as_strided(buffer.sizes, buffer.strides);
+}
+
+} // namespace nvfuser
@@ -0,0 +1,88 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#pragma once
+
+#include <ATen/ATen.h>
+#include <c10/cuda/CUDAStream.h>
+
+#include <exceptions.h>
+#include <utils.h>
+
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace nvfuser {
+
+//! A global buffer of a segmented fusion carved out of an IntermediateArena
+struct ArenaBuffer {
+  //! Run order ids of the segment producing the buffer and of the last
+  //! segment reading it
+  int64_t first_use = 0;
+  int64_t last_use = 0;
+  std::vector<int64_t> sizes;
+  std::vector<int64_t> strides;
+  at::ScalarType type = at::ScalarType::Undefined;
+  //! Byte offset of the buffer in the slab, or -1 if the buffer is allocated
+  //! individually
+  int64_t offset = -1;
+
+  //! Number of bytes spanned by the sizes and strides
+  int64_t bytes() const;
+};
+
+//! Placement of the intermediate buffers of a FusionKernelRuntime for one
+//! input id. See [ Note -- Intermediate arena ] in kernel_cache.cpp.
+struct ArenaPlan {
+  //! Size in bytes of the slab holding all buffers
+  int64_t size = 0;
+  //! Segment outputs and kernel intermediates, indexed by group id and then
+  //! by the position of the buffer in the GlobalBufferInfo list of the
+  //! executor of the group
+  std::vector<std::vector<ArenaBuffer>> outputs;
+  std::vector<std::vector<ArenaBuffer>> intermediates;
+};
+
+//! A single slab of device memory that the intermediate buffers of all
+//! segments are views of. Buffers whose lifetimes do not overlap share memory.
+//!
+//! The slab is only reused by work issued to the stream it was acquired on,
+//! so that reuse is ordered by the stream. Only one run may use the slab at a
+//! time since the buffers of two interleaved runs would overlap.
+class IntermediateArena : public NonCopyable {
+ public:
+  //! Slab alignment of each buffer
+  static constexpr int64_t alignment = 256;
+
+  //! Assign offsets to the buffers with offset 0 so that buffers with
+  //! overlapping lifetimes do not overlap in memory. Returns the size of the
+  //! slab needed.
+  static int64_t plan(const std::vector<ArenaBuffer*>& buffers);
+
+  //! Reserve the slab for a run issuing work to `stream`. The slab is
+  //! reallocated if it is smaller than `size` or was used on another stream.
+  //! Returns false if another run holds the slab, in which case buffers have
+  //! to be allocated individually.
+  bool acquire(int64_t size, const c10::cuda::CUDAStream& stream);
+
+  //! Return the slab reserved by acquire
+  void release();
+
+  //! View of the slab for an ArenaBuffer with a valid offset. Must be called
+  //! between acquire and release.
+  at::Tensor view(const ArenaBuffer& buffer) const;
+
+ private:
+  std::mutex mutex_;
+  at::Tensor slab_;
+  std::optional<c10::cuda::CUDAStream> stream_;
+  bool in_use_ = false;
+};
+
+} // namespace nvfuser
@@ -21,6 +21,31 @@
 
 namespace nvfuser {
 
+namespace {
+
+// Builds the expression `ExprT(op_type, output, inputs...)` with a new output
+// of `dtype` and returns the output, unless the current fusion interns scalar
+// expressions and already has such an expression. See Note [Scalar interning]
+// in ir/container.cpp
+template <typename ExprT, typename OpType, typename... Inputs>
+Val* newScalarExpr(OpType op_type, const DataType& dtype, Inputs*... inputs) {
+  auto make = [&]() -> Val* {
+    auto result = IrBuilder::create<Val>(dtype);
+    IrBuilder::create<ExprT>(op_type, result, inputs...);
+    return result;
+  };
+  Fusion* fusion = FusionGuard::getCurFusion();
+  if (fusion == nullptr || !fusion->isScalarInterningEnabled() ||
+      !(inputs->isScalar() && ...)) {
+    return make();
+  }
+  return fusion->internScalarExpr(
+      {typeid(ExprT), static_cast<int64_t>(op_type), dtype, {inputs...}},
+      make);
+}
+
+} // namespace
+
 Val* IrBuilder::newArithmeticExpr(BinaryOpType op_type, Val* lhs, Val* rhs) {
   NVF_CHECK(
       lhs != nullptr && rhs != nullptr,
@@ -45,20 +70,14 @@ Val* IrBuilder::newArithmeticExpr(BinaryOpType op_type, Val* lhs, Val* rhs) {
       NVF_ERROR(op_type == BinaryOpType::Add || op_type == BinaryOpType::Sub);
     }
   }
-  auto result = create<Val>(dtype);
-  IrBuilder::create<BinaryOp>(op_type, result, lhs, rhs);
-  // NOLINTNEXTLINE(clang-analyzer-cplusplus.NewDeleteLeaks)
-  return result;
+  return newScalarExpr<BinaryOp>(op_type, dtype, lhs, rhs);
 }
 
 Val* IrBuilder::newLogicExpr(BinaryOpType op_type, Val* lhs, Val* rhs) {
   NVF_CHECK(
       lhs != nullptr && rhs != nullptr,
       "Either lhs or rhs is a nullptr in newLogicExpr.");
-  auto result = create<Val>(DataType::Bool);
-  IrBuilder::create<BinaryOp>(op_type, result, lhs, rhs);
-  // NOLINTNEXTLINE(clang-analyzer-cplusplus.NewDeleteLeaks)
-  return result;
+  return newScalarExpr<BinaryOp>(op_type, DataType::Bool, lhs, rhs);
 }
 
 Val* IrBuilder::whereExpr(Val* pred, Val* lhs, Val* rhs) {
@@ -66,30 +85,23 @@ Val* IrBuilder::whereExpr(Val* pred, Val* lhs, Val* rhs) {
       pred != nullptr && lhs != nullptr && rhs != nullptr,
       "Either pred, lhs, or rhs is a nullptr in whereExpr.");
   NVF_CHECK(lhs->dtype() == rhs->dtype(), "Incompatible operand types");
-  auto result = create<Val>(lhs->dtype());
-  IrBuilder::create<TernaryOp>(TernaryOpType::Where, result, pred, lhs, rhs);
-  return result;
+  return newScalarExpr<TernaryOp>(
+      TernaryOpType::Where, lhs->dtype(), pred, lhs, rhs);
 }
 
 Val* IrBuilder::negExpr(Val* val) {
   NVF_CHECK(val != nullptr, "val is a nullptr in negExpr.");
-  auto result = create<Val>(val->dtype());
-  IrBuilder::create<UnaryOp>(UnaryOpType::Neg, result, val);
-  return result;
+  return newScalarExpr<UnaryOp>(UnaryOpType::Neg, val->dtype(), val);
 }
 
 Val* IrBuilder::logicalNotExpr(Val* val) {
   NVF_CHECK(val != nullptr, "val is a nullptr in logicalNotExpr.");
-  auto result = create<Val>(val->dtype());
-  IrBuilder::create<UnaryOp>(UnaryOpType::LogicalNot, result, val);
-  return result;
+  return newScalarExpr<UnaryOp>(UnaryOpType::LogicalNot, val->dtype(), val);
 }
 
 Val* IrBuilder::bitwiseNotExpr(Val* val) {
   NVF_CHECK(val != nullptr, "val is a nullptr in bitwiseNotExpr.");
-  auto result = create<Val>(val->dtype());
-  IrBuilder::create<UnaryOp>(UnaryOpType::BitwiseNot, result, val);
-  return result;
+  return newScalarExpr<UnaryOp>(UnaryOpType::BitwiseNot, val->dtype(), val);
 }
 
 Val* IrBuilder::derefExpr(Val* val) {
@@ -101,9 +113,7 @@ Val* IrBuilder::derefExpr(Val* val) {
 
 Val* IrBuilder::absExpr(Val* val) {
   NVF_CHECK(val != nullptr, "val is a nullptr in absExpr.");
-  auto result = create<Val>(val->dtype());
-  IrBuilder::create<UnaryOp>(UnaryOpType::Abs, result, val);
-  return result;
+  return newScalarExpr<UnaryOp>(UnaryOpType::Abs, val->dtype(), val);
 }
 
 Val* IrBuilder::setExpr(Val* val) {
@@ -118,9 +128,7 @@ Val* IrBuilder::maybeCastExpr(DataType dtype, Val* val) {
   if (val->dtype() == dtype) {
     return val;
   }
-  auto result = create<Val>(dtype);
-  IrBuilder::create<UnaryOp>(UnaryOpType::Cast, result, val);
-  return result;
+  return newScalarExpr<UnaryOp>(UnaryOpType::Cast, dtype, val);
 }
 
 Val* IrBuilder::maybeRefCastExpr(DataType dtype, Val* val) {
@@ -10,6 +10,12 @@
 #include <ir/cloner.h>
 #include <ir/container.h>
 
+#include <c10/util/irange.h>
+
+#include <algorithm>
+#include <string>
+#include <typeinfo>
+
 namespace nvfuser {
 
 void swap(IrContainer& a, IrContainer& b) noexcept {
@@ -31,6 +37,15 @@ void swap(IrContainer& a, IrContainer& b) noexcept {
 
   swap(a.metadata_, b.metadata_);
 
+  swap(a.scalar_interning_, b.scalar_interning_);
+  swap(a.interned_exprs_, b.interned_exprs_);
+  swap(a.interned_leaves_, b.interned_leaves_);
+  swap(a.interned_hashes_, b.interned_hashes_);
+
+  // Anything cached against either container no longer describes it
+  a.mutation_epoch_ = std::max(a.mutation_epoch_, b.mutation_epoch_) + 1;
+  b.mutation_epoch_ = a.mutation_epoch_;
+
   // Fixup the Statement::fusion_ links for a
   for (auto val : a.vals_) {
     val->ir_container_ = &a;
@@ -80,6 +95,10 @@ IrCloner IrContainer::copy(const IrContainer* from, IrContainer* to) {
 
   to->metadata_ = ir_cloner.clone(from->metadata_);
 
+  // The interning tables are not copied. The copies of the interned Vals are
+  // plain Vals of `to`.
+  to->scalar_interning_ = from->scalar_interning_;
+
   return ir_cloner;
 }
 
@@ -146,9 +165,16 @@ void IrContainer::removeExpr(Expr* expr) {
       expr_in_deque != exprs_up_.end(),
       "Wanted to remove an expression but its unique ptr is missing.");
 
+  // The outputs of `expr` no longer have the structure they were interned
+  // with
+  for (auto output : expr->outputs()) {
+    uninternVal(output);
+  }
+
   exprs_.erase(expr);
   exprs_up_.erase(expr_in_deque);
   raw_ptrs_.erase((void*)expr);
+  ++mutation_epoch_;
 }
 
 //! Completely remove val from the fusion, break all dependencies associated
@@ -173,9 +199,12 @@ void IrContainer::removeVal(Val* val) {
       val_in_deque != vals_up_.end(),
       "Wanted to remove a value but its unique ptr is missing.");
 
+  uninternVal(val);
+
   vals_.erase(val);
   vals_up_.erase(val_in_deque);
   raw_ptrs_.erase((void*)val);
+  ++mutation_epoch_;
 }
 
 //! Register the Val with this container
@@ -188,6 +217,7 @@ void IrContainer::registerVal(Val* val) {
   vals_.emplace(vals_up_.back().get());
   val->setName(IrContainerPasskey(), getValName(vals_up_.back()->vtype()));
   raw_ptrs_.emplace((void*)vals_up_.back().get());
+  ++mutation_epoch_;
 }
 
 //! Register expr with this container.
@@ -199,6 +229,7 @@ void IrContainer::registerExpr(Expr* expr) {
   exprs_.emplace(exprs_up_.back().get());
   expr->setName(IrContainerPasskey(), getExprName());
   raw_ptrs_.emplace((void*)exprs_up_.back().get());
+  ++mutation_epoch_;
 }
 
 void IrContainer::clear() noexcept {
@@ -212,6 +243,10 @@ void IrContainer::clear() noexcept {
   val_type_name_map_.clear();
   metadata_.clear();
   expr_name_counter_ = 0;
+  interned_exprs_.clear();
+  interned_leaves_.clear();
+  interned_hashes_.clear();
+  ++mutation_epoch_;
 }
 
 bool IrContainer::inContainer(const Statement* stmt) const {
@@ -356,4 +391,146 @@ void IrContainer::assumeNonNegative(Val* val) {
   axioms_->emplace_back(IrBuilder::geExpr(val, zeroVal()));
 }
 
+// Note [Scalar interning]
+// Indexing and predicate generation build the same scalar expressions over
+// and over, e.g. the same index math for each tensor of a loop nest, and every
+// copy is then simplified, hoisted and printed separately. When scalar
+// interning is enabled, the IrBuilder functions building pure scalar
+// expressions (arithmetic, comparisons, logical and bitwise ops, casts and
+// where) return the existing output of a structurally identical expression
+// instead of building a new one. Since the inputs are themselves interned,
+// this is hash-consing: structurally identical expression trees share their
+// nodes, and checking if two of them are the same is a pointer comparison.
+//
+// The leaves are interned too, so that equal constants and named scalars, which
+// are often built more than once, share the same key. The leaves and
+// expressions built otherwise, e.g. with IrBuilder::create, are not interned,
+// but they can be inputs of interned expressions.
+//
+// When an interned Val or its definition is removed from the container, it is
+// removed from the tables. An interned Val whose definition was replaced is
+// not reused, since its definition is checked against the key before reuse.
+//
+// Interning makes expressions that used to be distinct share one node, so it
+// is only correct for a consumer that doesn't attach anything to individual
+// scalar nodes, hence it is opt-in.
+
+namespace {
+
+bool isLeafToIntern(Val* val) {
+  if (val->definition() != nullptr) {
+    return false;
+  }
+  if (val->isA<NamedScalar>()) {
+    return true;
+  }
+  return val->value().is<int64_t>() || val->value().is<bool>() ||
+      val->value().is<double>();
+}
+
+size_t leafHash(Val* val) {
+  if (auto ns = dynamic_cast<NamedScalar*>(val)) {
+    return std::hash<std::string>()(ns->name());
+  }
+  const PolymorphicValue& value = val->value();
+  if (value.is<int64_t>()) {
+    return std::hash<int64_t>()(value.as<int64_t>());
+  }
+  if (value.is<bool>()) {
+    return std::hash<bool>()(value.as<bool>());
+  }
+  return std::hash<double>()(value.as<double>());
+}
+
+size_t keyHash(const IrContainer::InternKey& key) {
+  size_t hash = key.expr_type.hash_code();
+  hashCombine(hash, std::hash<int64_t>()(key.op_type));
+  for (auto input : key.inputs) {
+    hashCombine(hash, std::hash<Val*>()(input));
+  }
+  return hash;
+}
+
+} // namespace
+
+Val* IrContainer::canonicalLeaf(Val* val) {
+  if (!isLeafToIntern(val)) {
+    return val;
+  }
+  if (auto it = interned_hashes_.find(val); it != interned_hashes_.end()) {
+    return val;
+  }
+  const size_t hash = leafHash(val);
+  auto& bucket = interned_leaves_[hash];
+  for (auto leaf : bucket) {
+    if (leaf->sameAs(val)) {
+      return leaf;
+    }
+  }
+  bucket.push_back(val);
+  interned_hashes_[val] = hash;
+  return val;
+}
+
+Val* IrContainer::internScalarExpr(
+    InternKey key,
+    const std::function<Val*()>& make) {
+  for (auto& input : key.inputs) {
+    input = canonicalLeaf(input);
+  }
+  const size_t hash = keyHash(key);
+  auto& bucket = interned_exprs_[hash];
+  for (const auto& [interned_key, val] : bucket) {
+    if (interned_key.expr_type != key.expr_type ||
+        interned_key.op_type != key.op_type ||
+        interned_key.dtype != key.dtype ||
+        interned_key.inputs != key.inputs) {
+      continue;
+    }
+    Expr* def = val->definition();
+    if (def == nullptr || std::type_index(typeid(*def)) != key.expr_type ||
+        def->inputs().size() != key.inputs.size()) {
+      continue;
+    }
+    bool same_inputs = true;
+    for (auto i : c10::irange(key.inputs.size())) {
+      same_inputs = same_inputs &&
+          (def->input(i) == key.inputs[i] ||
+           canonicalLeaf(def->input(i)) == key.inputs[i]);
+    }
+    if (same_inputs) {
+      return val;
+    }
+  }
+  Val* val = make();
+  NVF_ERROR(val->container() == this);
+  bucket.emplace_back(std::move(key), val);
+  interned_hashes_[val] = hash;
+  return val;
+}
+
+void IrContainer::uninternVal(Val* val) {
+  auto it = interned_hashes_.find(val);
+  if (it == interned_hashes_.end()) {
+    return;
+  }
+  const size_t hash = it->second;
+  interned_hashes_.erase(it);
+  if (auto leaves_it = interned_leaves_.find(hash);
+      leaves_it != interned_leaves_.end()) {
+    auto& leaves = leaves_it->second;
+    leaves.erase(std::remove(leaves.begin(), leaves.end(), val), leaves.end());
+  }
+  if (auto exprs_it = interned_exprs_.find(hash);
+      exprs_it != interned_exprs_.end()) {
+    auto& exprs = exprs_it->second;
+    exprs.erase(
+        std::remove_if(
+            exprs.begin(),
+            exprs.end(),
+            [val](const auto& entry) { return entry.second == val; }),
+        exprs.end());
+  }
+}
+
 } // namespace nvfuser
@@ -14,8 +14,12 @@
 #include <utils.h>
 
 #include <deque>
+#include <functional>
+#include <typeindex>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 namespace nvfuser {
 
@@ -125,6 +129,13 @@ class IrContainer : public PolymorphicBase {
     return vals_;
   }
 
+  //! Counter bumped whenever a Statement is registered or removed, so
+  //! results derived from the IR can be cached and reused as long as the
+  //! epoch they were computed at is current
+  int64_t mutationEpoch() const noexcept {
+    return mutation_epoch_;
+  }
+
   // Shortcuts for frequently used vals
   NVF_API Val* zeroVal();
   NVF_API Val* oneVal();
@@ -144,6 +155,30 @@ class IrContainer : public PolymorphicBase {
   void assumePositive(Val* val);
   void assumeNonNegative(Val* val);
 
+  //! Structural interning of the pure scalar expressions built by IrBuilder.
+  //! Off by default. See Note [Scalar interning] in container.cpp
+  void setScalarInterning(bool enabled) {
+    scalar_interning_ = enabled;
+  }
+
+  bool isScalarInterningEnabled() const {
+    return scalar_interning_;
+  }
+
+  //! The structure of a scalar expression: the type and the op type of its
+  //! definition, its dtype and the inputs of its definition
+  struct InternKey {
+    std::type_index expr_type;
+    int64_t op_type = 0;
+    DataType dtype;
+    std::vector<Val*> inputs;
+  };
+
+  //! Returns the output of a previously interned expression with the same
+  //! structure as `key`, or interns the output of `make`, which must build
+  //! that expression
+  Val* internScalarExpr(InternKey key, const std::function<Val*()>& make);
+
  protected:
   static IrCloner copy(const IrContainer* from, IrContainer* to);
 
@@ -179,6 +214,13 @@ class IrContainer : public PolymorphicBase {
 
   void lazyInitAxioms();
 
+  //! Returns the first interned leaf that is the same as `val`, which is
+  //! interned if there is none. Non-leaf Vals are returned as is.
+  Val* canonicalLeaf(Val* val);
+
+  //! Removes `val` from the interning tables
+  void uninternVal(Val* val);
+
   // Deque of unique pointer is the memory owning data structure
   std::deque<std::unique_ptr<Val>> vals_up_;
 
@@ -206,6 +248,10 @@ class IrContainer : public PolymorphicBase {
   // Expression names counter
   StmtNameType expr_name_counter_ = 0;
 
+  // Bumped on every registration and removal. Never reset, so a cache tagged
+  // with an epoch can't be mistaken as valid after clear().
+  int64_t mutation_epoch_ = 0;
+
   // Manually store some persistent, frequently used nodes. It's very
   // challenging to do this anything but manually as detecting when a container
   // may or may not have one of these vals is tricky. Specifically because if
@@ -221,6 +267,14 @@ class IrContainer : public PolymorphicBase {
   std::unique_ptr<NamedScalar> magic_zero_val_;
   std::unique_ptr<std::vector<Val*>> axioms_;
   std::unordered_map<Val*, std::pair<Val*, Expr*>> metadata_;
+
+  bool scalar_interning_ = false;
+  // Interned expressions and leaves, bucketed by their structural hash, and
+  // the hash of each interned Val to remove it
+  std::unordered_map<size_t, std::vector<std::pair<InternKey, Val*>>>
+      interned_exprs_;
+  std::unordered_map<size_t, std::vector<Val*>> interned_leaves_;
+  std::unordered_map<Val*, size_t> interned_hashes_;
 };
 
 } // namespace nvfuser
@@ -226,6 +226,109 @@ class ScatterOp : public Expr {
   }
 };
 
+//! Inclusive scan. Element i of out along dim is
+//! scanOp(...scanOp(scanOp(init, in[0]), in[1])..., in[i]). The scanned
+//! dimension remains an iteration domain of out.
+class ScanOp : public Expr {
+ public:
+  using Expr::Expr;
+
+  ScanOp(
+      IrBuilderPasskey,
+      BinaryOpType scan_op_type,
+      Val* init,
+      Val* out,
+      Val* in,
+      int64_t dim);
+
+  NVFUSER_DECLARE_CLONE_AND_CREATE
+
+  const char* getOpString() const override {
+    return "ScanOp";
+  }
+
+  std::string toString(int indent_size = 0) const override;
+  std::string toInlineString(int indent_size = 0) const override;
+  std::vector<PolymorphicValue> evaluate(
+      const ExpressionEvaluator& ee,
+      const std::vector<PolymorphicValue>& inputs) const override;
+
+  Val* out() const {
+    return output(0);
+  }
+
+  Val* in() const {
+    return input(0);
+  }
+
+  Val* init() const {
+    return attributeVal(0);
+  }
+
+  BinaryOpType getScanOpType() const {
+    return attribute<BinaryOpType>(1);
+  }
+
+  //! Position of the scanned dimension in the logical domain of out
+  int64_t dim() const {
+    return attribute<int64_t>(2);
+  }
+
+  IterDomain* getScanID() const;
+};
+
+//! Stable sort along dim. out_values holds the items of in in ascending, or
+//! descending, order and out_indices their positions along dim in in. Like
+//! at::sort, NaNs are larger than any other value. The sorted dimension
+//! remains an iteration domain of both outputs.
+class SortOp : public Expr {
+ public:
+  using Expr::Expr;
+
+  SortOp(
+      IrBuilderPasskey,
+      Val* out_values,
+      Val* out_indices,
+      Val* in,
+      int64_t dim,
+      bool descending);
+
+  NVFUSER_DECLARE_CLONE_AND_CREATE
+
+  const char* getOpString() const override {
+    return "SortOp";
+  }
+
+  std::string toString(int indent_size = 0) const override;
+  std::string toInlineString(int indent_size = 0) const override;
+  std::vector<PolymorphicValue> evaluate(
+      const ExpressionEvaluator& ee,
+      const std::vector<PolymorphicValue>& inputs) const override;
+
+  Val* outValues() const {
+    return output(0);
+  }
+
+  Val* outIndices() const {
+    return output(1);
+  }
+
+  Val* in() const {
+    return input(0);
+  }
+
+  //! Position of the sorted dimension in the logical domain of the outputs
+  int64_t dim() const {
+    return attribute<int64_t>(0);
+  }
+
+  bool isDescending() const {
+    return attribute<bool>(1);
+  }
+
+  IterDomain* getSortID() const;
+};
+
 class IotaOp : public Expr {
  public:
   using Expr::Expr;
@@ -932,6 +1035,50 @@ class NVF_API ReductionOp : public Expr {
   bool serialGridReductionRequested() const {
     return attribute<bool>(3);
   }
+
+  //! Scheduling method to request that the grid reduction of this reduction be
+  //! performed across the thread blocks of a cluster through distributed
+  //! shared memory. The only grid-parallelized reduction axis must be BIDx,
+  //! and the kernel is launched with clusters spanning gridDim.x. Requires
+  //! Hopper (9.0) or newer.
+  void requestClusterReduction(bool value = true) {
+    attribute<bool>(4) = value;
+  }
+
+  bool clusterReductionRequested() const {
+    return attribute<bool>(4);
+  }
+
+  //! Scheduling method to request that the block reduction of this reduction
+  //! be performed with shared memory atomics instead of a tree reduction. It
+  //! only applies to sums of Int32, Int, Float and Double that are not warp
+  //! reductions, or grid reductions other than atomic grid reductions. The
+  //! order of the additions is unspecified, so float results are not
+  //! deterministic. See Note [Shared memory atomic block reductions] in
+  //! scheduler/reduction_utils.cpp
+  void requestSmemAtomicBlockReduction(bool value = true) {
+    attribute<bool>(5) = value;
+  }
+
+  bool smemAtomicBlockReductionRequested() const {
+    return attribute<bool>(5);
+  }
+
+  //! Scheduling method to request that the grid reduction of this reduction
+  //! be performed by adding the partial result of each block to the output
+  //! with a global atomic, in one pass without work or sync buffers. The
+  //! output must be a fusion output without other uses, which the executor
+  //! zero-fills before the launch, and the reduction must be a sum of Int32,
+  //! Int, Float or Double. The order of the additions is unspecified, so
+  //! floating-point results are not deterministic. See Note [Atomic grid
+  //! reductions] in scheduler/reduction_utils.cpp
+  void requestAtomicGridReduction(bool value = true) {
+    attribute<bool>(6) = value;
+  }
+
+  bool atomicGridReductionRequested() const {
+    return attribute<bool>(6);
+  }
 };
 
 //! Grouped reduction operation for horizontal fusions. It works like
@@ -1125,14 +1272,15 @@ class WelfordTriplet {
 class NVF_API WelfordOp : public Expr {
  public:
   using Expr::Expr;
-  static constexpr int kNumAttrs = 4;
+  static constexpr int kNumAttrs = 5;
 
   WelfordOp(
       IrBuilderPasskey,
       const WelfordTriplet& output,
       const WelfordTriplet& input,
       const WelfordTriplet& init,
-      bool is_fused = false);
+      bool is_fused = false,
+      WelfordMode mode = WelfordMode::Default);
 
   WelfordOp(
       IrBuilderPasskey,
@@ -1145,7 +1293,8 @@ class NVF_API WelfordOp : public Expr {
       Val* init_avg,
       Val* init_var,
       Val* init_N,
-      bool is_fused = false);
+      bool is_fused = false,
+      WelfordMode mode = WelfordMode::Default);
 
   NVFUSER_DECLARE_CLONE_AND_CREATE
 
@@ -1228,6 +1377,18 @@ class NVF_API WelfordOp : public Expr {
     return attribute<bool>(3);
   }
 
+  //! Scheduling method to select how the update is computed. With Fast, a
+  //! single-value WelfordOp accumulates the sum and the sum of squares into
+  //! its avg and var outputs, and a WelfordOp merging partial results
+  //! expects its inputs in that form. See Note [Welford modes].
+  void setMode(WelfordMode mode) {
+    attribute<WelfordMode>(4) = mode;
+  }
+
+  WelfordMode mode() const {
+    return attribute<WelfordMode>(4);
+  }
+
   std::vector<Val*> getInitVals() const;
 
   //! Return the init val for an output val
@@ -281,6 +281,131 @@ std::vector<PolymorphicValue> ScatterOp::evaluate(
 
 NVFUSER_DEFINE_CLONE_AND_CREATE(ScatterOp)
 
+ScanOp::ScanOp(
+    IrBuilderPasskey passkey,
+    BinaryOpType scan_op_type,
+    Val* init,
+    Val* out,
+    Val* in,
+    int64_t dim)
+    : Expr(passkey) {
+  NVF_ERROR(
+      (in->isA<TensorView>() && out->isA<TensorView>()) ||
+          (in->isA<kir::TensorIndex>() && out->isA<kir::TensorIndex>()),
+      "Scan operation was created that does not have tensor inputs and outputs.");
+  NVF_ERROR(
+      init->isConstScalar(),
+      "Tried to create a scan operation with an initial value that isn't a constant.");
+  addOutput(out);
+  addInput(in);
+  addAttribute(init);
+  addDataAttribute(scan_op_type);
+  addDataAttribute(dim);
+}
+
+std::string ScanOp::toString(int indent_size) const {
+  std::stringstream ss;
+  indent(ss, indent_size) << out() << "\n";
+  indent(ss, indent_size) << "   = scan( " << in()->toString()
+                          << ", op = " << getScanOpType()
+                          << ", initial value = " << init()->toString()
+                          << ", dim = " << dim() << " )\n";
+  return ss.str();
+}
+
+std::string ScanOp::toInlineString(int indent_size) const {
+  NVF_CHECK(false, "Tensor op can not be printed inline");
+}
+
+IterDomain* ScanOp::getScanID() const {
+  return TensorDomain::noReductions(
+             ir_utils::getTvOutput(this)->getLogicalDomain())
+      .at(dim());
+}
+
+std::vector<PolymorphicValue> ScanOp::evaluate(
+    const ExpressionEvaluator& ee,
+    const std::vector<PolymorphicValue>& inputs) const {
+  const auto& input = inputs.at(0).as<at::Tensor>();
+  switch (getScanOpType()) {
+    case BinaryOpType::Add:
+      return {at::cumsum(input, dim())};
+    case BinaryOpType::Mul:
+      return {at::cumprod(input, dim())};
+    case BinaryOpType::Max:
+      return {std::get<0>(at::cummax(input, dim()))};
+    case BinaryOpType::Min:
+      return {std::get<0>(at::cummin(input, dim()))};
+    default:
+      NVF_CHECK(
+          false,
+          "Unexpected operator type: ",
+          getScanOpType(),
+          " in ",
+          toString());
+  }
+}
+
+NVFUSER_DEFINE_CLONE_AND_CREATE(ScanOp)
+
+SortOp::SortOp(
+    IrBuilderPasskey passkey,
+    Val* out_values,
+    Val* out_indices,
+    Val* in,
+    int64_t dim,
+    bool descending)
+    : Expr(passkey) {
+  NVF_ERROR(
+      (in->isA<TensorView>() && out_values->isA<TensorView>() &&
+       out_indices->isA<TensorView>()) ||
+          (in->isA<kir::TensorIndex>() &&
+           out_values->isA<kir::TensorIndex>() &&
+           out_indices->isA<kir::TensorIndex>()),
+      "Sort operation was created that does not have tensor inputs and outputs.");
+  NVF_ERROR(
+      out_indices->dtype() == DataType::Int,
+      "The indices of a sort must be Int, but got ",
+      out_indices->dtype());
+  addOutput(out_values);
+  addOutput(out_indices);
+  addInput(in);
+  addDataAttribute(dim);
+  addDataAttribute(descending);
+}
+
+std::string SortOp::toString(int indent_size) const {
+  std::stringstream ss;
+  indent(ss, indent_size) << outValues() << ",\n";
+  indent(ss, indent_size) << outIndices() << "\n";
+  indent(ss, indent_size) << "   = sort( " << in()->toString()
+                          << ", dim = " << dim()
+                          << ", descending = " << std::boolalpha
+                          << isDescending() << " )\n";
+  return ss.str();
+}
+
+std::string SortOp::toInlineString(int indent_size) const {
+  NVF_CHECK(false, "Tensor op can not be printed inline");
+}
+
+IterDomain* SortOp::getSortID() const {
+  return TensorDomain::noReductions(
+             ir_utils::getTvOutput(this)->getLogicalDomain())
+      .at(dim());
+}
+
+std::vector<PolymorphicValue> SortOp::evaluate(
+    const ExpressionEvaluator& ee,
+    const std::vector<PolymorphicValue>& inputs) const {
+  const auto& input = inputs.at(0).as<at::Tensor>();
+  auto [values, indices] =
+      at::sort(input, /*stable=*/true, dim(), isDescending());
+  return {values, indices};
+}
+
+NVFUSER_DEFINE_CLONE_AND_CREATE(SortOp)
+
 IotaOp::IotaOp(
     IrBuilderPasskey passkey,
     Val* out,
@@ -1463,6 +1588,9 @@ ReductionOp::ReductionOp(
   addDataAttribute(reduction_op_type);
   addDataAttribute(is_allreduce);
   addDataAttribute(false); // serial reduction
+  addDataAttribute(false); // cluster reduction
+  addDataAttribute(false); // smem atomic block reduction
+  addDataAttribute(false); // atomic grid reduction
 }
 
 std::string ReductionOp::toString(int indent_size) const {
@@ -1649,7 +1777,8 @@ WelfordOp::WelfordOp(
     const WelfordTriplet& output,
     const WelfordTriplet& input,
     const WelfordTriplet& init,
-    bool is_fused)
+    bool is_fused,
+    WelfordMode mode)
     : Expr(passkey) {
   // Previously, nullptr was accepted and implicitly replaced by
   // default values. Looks like we always pass some non-null values,
@@ -1727,6 +1856,7 @@ WelfordOp::WelfordOp(
   addAttribute(init.var());
   addAttribute(init.N());
   addDataAttribute(is_fused);
+  addDataAttribute(mode);
 
   NVF_ERROR(attributes().size() == kNumAttrs);
 }
@@ -1742,13 +1872,15 @@ WelfordOp::WelfordOp(
     Val* init_avg,
     Val* init_var,
     Val* init_N,
-    bool is_fused)
+    bool is_fused,
+    WelfordMode mode)
     : WelfordOp(
           passkey,
           WelfordTriplet(out_avg, out_var, out_N),
           WelfordTriplet(in_avg, in_var, in_N),
           WelfordTriplet(init_avg, init_var, init_N),
-          is_fused) {}
+          is_fused,
+          mode) {}
 
 Val* WelfordOp::getInitValOfOutput(Val* output_val) const {
   auto val_name = outputTriplet().getNameOf(output_val);
@@ -1785,6 +1917,9 @@ std::string WelfordOp::toString(int indent_size) const {
        << initVar()->toString() << "(Var)\n  " << initN()->toString() << "(N)";
   }
   ss << "\n  allreduce = " << (isAllreduce() ? "true" : "false");
+  if (mode() != WelfordMode::Default) {
+    ss << "\n  mode = " << mode();
+  }
   ss << " )\n";
   return ss.str();
 }
@@ -4010,6 +4145,21 @@ std::vector<PolymorphicValue> PadOp::evaluate(
     pad_widths.push_back(right_pad);
   }
 
+  // Padding with non-positive widths only removes elements, so it's a slice
+  // and returns a view of the input. at::pad would copy it. Alias analysis
+  // relies on this to make such outputs aliases of the input.
+  if (std::all_of(pad_widths.begin(), pad_widths.end(), [](int64_t width) {
+        return width <= 0;
+      })) {
+    at::Tensor sliced = in;
+    for (const auto i : c10::irange(num_dims)) {
+      auto left_pad = (int64_t)inputs.at(pad_width_offset + 2 * i);
+      auto right_pad = (int64_t)inputs.at(pad_width_offset + 2 * i + 1);
+      sliced = sliced.slice(i, -left_pad, in.size(i) + right_pad);
+    }
+    return {sliced};
+  }
+
   if (isComplexType(*out()->getDataType())) {
     std::complex<double> value =
         static_cast<std::complex<double>>(inputs.at(1));
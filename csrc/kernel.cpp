@@ -6,12 +6,15 @@
  */
 // clang-format on
 #include <debug.h>
+#include <device_lower/analysis/register_pressure.h>
 #include <device_lower/lower2device.h>
+#include <device_lower/utils.h>
 #include <instrumentation.h>
 #include <ir/iostream.h>
 #include <ir/utils.h>
 #include <kernel.h>
 #include <kernel_ir_dispatch.h>
+#include <options.h>
 
 #include <ATen/cuda/CUDAContext.h>
 
@@ -54,6 +57,12 @@ class KernelIrScanner : private IrVisitor {
     return num_grouped_iterations;
   }
 
+  void recordSubWarpReduction(Expr* expr) {
+    if (auto lanes = ir_utils::getMaybeSubWarpReductionLanes(expr)) {
+      summary_.sub_warp_reduction_lanes.emplace(expr, *lanes);
+    }
+  }
+
   using IrVisitor::dispatch;
   using IrVisitor::handle;
   void dispatch(Expr* expr) final {
@@ -74,7 +83,7 @@ class KernelIrScanner : private IrVisitor {
   }
 
   void handle(GridSync* sync) final {
-    summary_.has_cooperative_grid_reduction = true;
+    addCooperativeSync(sync->syncDims());
   }
 
   void handle(Allocate* allocate) final {
@@ -98,6 +107,11 @@ class KernelIrScanner : private IrVisitor {
 
   void handle(RNGOp* rng_op) final {
     summary_.has_philox_op = true;
+    if (std::find(
+            summary_.rng_ops.begin(), summary_.rng_ops.end(), rng_op) ==
+        summary_.rng_ops.end()) {
+      summary_.rng_ops.push_back(rng_op);
+    }
   }
 
   void handle(TensorIndex* tensor_index) final {
@@ -110,16 +124,38 @@ class KernelIrScanner : private IrVisitor {
     // Update the largest smem data type
     if (domain->hasBlockReduction() || domain->hasGridReduction() ||
         tv->getMemoryType() == MemoryType::Shared) {
-      const auto data_type = tv->dtype();
-      const size_t type_size = dataTypeSize(data_type, index_type_);
-      if (type_size > max_smem_type_size_) {
-        max_smem_type_size_ = type_size;
-        summary_.largest_smem_data_type = data_type;
-      }
+      updateLargestSmemDataType(tv->dtype());
     }
   }
 
+  // Scans that are not lowered to serial loops remain ScanOps either as block
+  // scans or as GridScans
+  void handle(ScanOp* sop) final {
+    summary_.has_block_scans = true;
+    updateLargestSmemDataType(sop->out()->dtype());
+  }
+
+  // SortOps in kernels are always block sorts
+  void handle(SortOp* sop) final {
+    summary_.has_block_sorts = true;
+    updateLargestSmemDataType(sop->outValues()->dtype());
+    updateLargestSmemDataType(DataType::Int);
+  }
+
+  void handle(GridScan* grid_scan) final {
+    handle(grid_scan->as<ScanOp>());
+    // The look-back waits for the preceding blocks, which must be resident
+    ParallelTypeBitmap all_bids;
+    all_bids.setAllBID();
+    addCooperativeSync(all_bids);
+  }
+
+  void handle(ReductionOp* rop) final {
+    recordSubWarpReduction(rop);
+  }
+
   void handle(WelfordOp* welford_op) final {
+    recordSubWarpReduction(welford_op);
     summary_.has_welford = true;
     NVF_ERROR(welford_op->outAvg()->isA<TensorIndex>());
     auto out_dom = welford_op->outAvg()->as<TensorIndex>()->view()->domain();
@@ -131,6 +167,7 @@ class KernelIrScanner : private IrVisitor {
   // May extend to support both iteration and expr grouped block reductions.
   // Grouped grid reductions are handled by GroupedGridReduction.
   void handle(GroupedReductionOp* grouped_rop) final {
+    recordSubWarpReduction(grouped_rop);
     // skip expr grouped reduction
     if (grouped_rop->numHorizontallyGroupedExprs() > 1) {
       return;
@@ -147,7 +184,7 @@ class KernelIrScanner : private IrVisitor {
     summary_.has_grid_welford = true;
     summary_.has_grid_reductions = true;
     if (grid_welford->welford_op()->isAllreduce()) {
-      summary_.has_cooperative_grid_reduction = true;
+      addCooperativeSync(gridReductionDims(grid_welford->welford_op()->out()));
     }
   }
 
@@ -157,15 +194,26 @@ class KernelIrScanner : private IrVisitor {
     // workspace.
     summary_.has_grid_reductions =
         grid_reduction->serialReductionTensor() == nullptr;
+    // Cluster reductions synchronize with cluster barriers, so they do not
+    // need a cooperative launch even when they are allreduces
+    if (grid_reduction->isCluster()) {
+      summary_.has_cluster_reductions = true;
+      return;
+    }
+    if (grid_reduction->isAtomic()) {
+      summary_.atomic_reduction_outputs.insert(
+          ir_utils::getTv(grid_reduction->out()));
+      return;
+    }
     if (grid_reduction->isAllreduce()) {
-      summary_.has_cooperative_grid_reduction = true;
+      addCooperativeSync(gridReductionDims(grid_reduction->out()));
     }
   }
 
   void handle(GroupedGridReduction* grid_reduction) final {
     summary_.has_grid_reductions = true;
     if (grid_reduction->isAllreduce()) {
-      summary_.has_cooperative_grid_reduction = true;
+      addCooperativeSync(gridReductionDims(grid_reduction->output(0)));
     } else if (grid_reduction->numHorizontallyGroupedExprs() == 1) {
       // non-persistent iteration domain grouped reduction
       summary_.has_iter_grouped_reductions = true;
@@ -180,7 +228,7 @@ class KernelIrScanner : private IrVisitor {
     summary_.has_grid_welford = true;
     summary_.has_grid_reductions = true;
     if (grid_welford->isAllreduce()) {
-      summary_.has_cooperative_grid_reduction = true;
+      addCooperativeSync(gridReductionDims(grid_welford->output(0)));
     }
     if (grid_welford->useOuterOpt()) {
       summary_.has_outer_grouped_grid_welford = true;
@@ -204,8 +252,9 @@ class KernelIrScanner : private IrVisitor {
   }
 
   void handle(GridBroadcast* grid_broadcast) final {
-    summary_.has_cooperative_grid_reduction = true;
     handle(grid_broadcast->broadcast_op());
+    addCooperativeSync(
+        summary_.broadcast_parallel_types.at(grid_broadcast->broadcast_op()));
   }
 
   void handle(BroadcastOp* bop) final {
@@ -222,6 +271,32 @@ class KernelIrScanner : private IrVisitor {
   }
 
  private:
+  //! The kernel needs a cooperative launch, with blocks synchronizing along
+  //! the BID types of sync_dims
+  void addCooperativeSync(ParallelTypeBitmap sync_dims) {
+    summary_.has_cooperative_grid_reduction = true;
+    summary_.cooperative_sync_dims |= sync_dims.clearAllTID();
+  }
+
+  //! Grid dimensions reduced by the grid reduction producing out
+  static ParallelTypeBitmap gridReductionDims(Val* out) {
+    ParallelTypeBitmap dims;
+    for (auto id : ir_utils::getTv(out)->getLoopDomain()) {
+      if (id->isReduction() && isParallelTypeBlockDim(id->getParallelType())) {
+        dims.set(id->getParallelType());
+      }
+    }
+    return dims;
+  }
+
+  void updateLargestSmemDataType(DataType data_type) {
+    const size_t type_size = dataTypeSize(data_type, index_type_);
+    if (type_size > max_smem_type_size_) {
+      max_smem_type_size_ = type_size;
+      summary_.largest_smem_data_type = data_type;
+    }
+  }
+
   size_t max_smem_type_size_ = 0;
   KernelSummary summary_;
   DataType index_type_;
@@ -351,10 +426,17 @@ void Kernel::finalize(std::vector<Expr*> top_level_exprs) {
   summary_.validations = GpuLower::current()->validations();
   summary_.vectorized_accesses = GpuLower::current()->vectorizedAccesses();
   summary_.vectorized_set_info = GpuLower::current()->vectorizedSetInfo();
+  summary_.fast_div_mod_magic = GpuLower::current()->fastDivModMagic();
+  summary_.packed_casts = GpuLower::current()->packedCasts();
+  summary_.packed_arithmetic_casts =
+      GpuLower::current()->packedArithmeticCasts();
+  summary_.estimated_registers_per_thread = estimateRegistersPerThread(this);
   summary_.sync_map = GpuLower::current()->syncMap();
   summary_.parallel_dimension_map = GpuLower::current()->parallelDimensionMap();
   summary_.circular_buffer_info = GpuLower::current()->circularBufferInfo();
   summary_.min_device_version = GpuLower::current()->minDeviceVersion();
+  summary_.programmatic_launch =
+      isOptionEnabled(EnableOption::ProgrammaticLaunch);
   summary_.min_device_version_reason =
       GpuLower::current()->minDeviceVersionReason();
   parameters_ = GpuLower::current()->allKnownVals();
@@ -448,6 +530,39 @@ int64_t KernelPerformanceProfile::getNewIndex() {
   return num_profile_entries_++;
 }
 
+void KernelPerformanceProfile::registerRegion(
+    const Expr* expr,
+    RegionKind kind,
+    const Expr* parent) {
+  if (region_map_.find(expr) != region_map_.end()) {
+    return;
+  }
+
+  Region region;
+  region.expr = expr;
+  region.kind = kind;
+  region.index = getNewIndex();
+  if (parent != nullptr) {
+    auto parent_it = region_map_.find(parent);
+    NVF_ERROR(
+        parent_it != region_map_.end(),
+        "Parent region not registered: ",
+        parent->toString());
+    region.parent = parent_it->second;
+  }
+  region_map_.emplace(expr, (int64_t)regions_.size());
+  regions_.push_back(region);
+}
+
+bool KernelPerformanceProfile::isProfiledRegion(const Expr* expr) const {
+  return region_map_.find(expr) != region_map_.end();
+}
+
+std::array<int64_t, 2> KernelPerformanceProfile::getIndicesInProfileBuffer(
+    const Region& region) const {
+  return {region.index * 2, region.index * 2 + 1};
+}
+
 bool KernelPerformanceProfile::isProfiled(const Expr* expr) const {
   return expr_entry_map_.find(expr) != expr_entry_map_.end();
 }
@@ -472,6 +587,33 @@ std::array<int64_t, 2> KernelPerformanceProfile::getIndicesInProfileBuffer(
   return {cycle_index, count_index};
 }
 
+const char* KernelPerformanceProfile::kindName(RegionKind kind) {
+  switch (kind) {
+    case RegionKind::Load:
+      return "load";
+    case RegionKind::Compute:
+      return "compute";
+    case RegionKind::BlockSync:
+      return "block sync";
+    case RegionKind::GridSync:
+      return "grid sync";
+    case RegionKind::GridReduction:
+      return "grid reduction";
+  }
+  NVF_ERROR(false, "Unknown region kind");
+}
+
+std::string KernelPerformanceProfile::regionName(const Region& region) {
+  if (auto loop = dynamic_cast<const ForLoop*>(region.expr)) {
+    return "loop " + loop->iter_domain()->toString();
+  }
+  if (auto out_tv = ir_utils::getTvOutput(region.expr)) {
+    return std::string(region.expr->getOpString()) + " T" +
+        std::to_string(out_tv->name());
+  }
+  return region.expr->getOpString();
+}
+
 std::string KernelPerformanceProfile::toString(const at::Tensor& buffer) const {
   std::stringstream ss;
   ss << "Kernel performance profile:\n";
@@ -496,6 +638,19 @@ std::string KernelPerformanceProfile::toString(const at::Tensor& buffer) const {
        << " us, " << count << "\n";
   }
 
+  // Regions are sampled by one thread per warp, so the count is the number
+  // of warps that ran the region times the number of times they ran it
+  for (const auto& region : regions_) {
+    double cycles =
+        static_cast<double>(buffer[region.index][0].item<int64_t>());
+    auto count = buffer[region.index][1].item<int64_t>();
+    auto cycles_per_call = count == 0 ? 0.0 : cycles / (double)count;
+    auto us_per_call = cycles_per_call / kilo_freq * 1000.0;
+    ss << (region.parent < 0 ? "" : "  ") << kindName(region.kind) << ", "
+       << regionName(region) << ", " << us_per_call << " us, " << count
+       << "\n";
+  }
+
   return ss.str();
 }
 
@@ -22,6 +22,7 @@
 
 #include <memory>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -46,16 +47,46 @@ struct KernelSummary {
   //! Indicate the need to generate random numbers
   bool has_philox_op = false;
 
+  //! RNGOps of the kernel. Each of them caches its last Philox result
+  std::vector<const RNGOp*> rng_ops;
+
   //! Do we have any block reductions?
   bool has_block_reductions = false;
 
   //! Number of static grid reductions
   bool has_grid_reductions = false;
 
+  //! Do we have any block or grid scans? Both scan through the shared memory
+  //! workspace of block reductions.
+  bool has_block_scans = false;
+
+  //! Do we have any block sorts? They sort through the shared memory workspace
+  //! of block reductions, which then holds an Int position along with each
+  //! item.
+  bool has_block_sorts = false;
+
   //! Do we have any grid reduction in a loop, or grid reductions dependent on
   //! grid reductions
   bool has_cooperative_grid_reduction = false;
 
+  //! Grid dimensions along which the blocks of cooperative kernels
+  //! synchronize. When it is only BIDx, the blocks of each sync may form a
+  //! cluster, see FusionExecutor::useClusterGridSync
+  ParallelTypeBitmap cooperative_sync_dims;
+
+  //! Do we have any reduction across the thread blocks of a cluster? The
+  //! kernel is then launched with clusters spanning gridDim.x.
+  bool has_cluster_reductions = false;
+
+  //! Does the kernel wait for the grid it depends on before its first memory
+  //! access, so that it can be launched with programmatic dependent launch?
+  //! See Note [Programmatic dependent launch] in executor.cpp
+  bool programmatic_launch = false;
+
+  //! Fusion outputs that atomic grid reductions add to. The executor
+  //! zero-fills them before the launch.
+  std::unordered_set<const TensorView*> atomic_reduction_outputs;
+
   //! Do we have any block broadcasts?
   bool has_block_broadcasts = false;
 
@@ -93,6 +124,9 @@ struct KernelSummary {
   //! Only used for debugging.
   std::vector<const kir::Allocate*> dynamic_lmem_allocations;
 
+  //! Estimated number of registers per thread, see estimateRegistersPerThread
+  int64_t estimated_registers_per_thread = 0;
+
   //! Validations needed and information about them. For example, a pair of
   //! "extent mod split_factor == 0" and an error message for divisibility check
   //! for vectorization.
@@ -117,6 +151,23 @@ struct KernelSummary {
   //! Track information on vectorized set operations for runtime validation
   std::vector<VectorizedSetInfo> vectorized_set_info;
 
+  //! Multiplier of the divisor of each div and mod op printed with fastDiv or
+  //! fastMod. See [ Note -- Fast div and mod ] in fast_divmod.cpp
+  std::unordered_map<const Expr*, Val*> fast_div_mod_magic;
+
+  //! Second cast of each pair of casts printed as one packed conversion. See
+  //! [ Note -- Packed casts ] in packed_cast.cpp
+  std::unordered_map<const Expr*, const Expr*> packed_casts;
+
+  //! Second element of each cast of the loops printed with packed fp16 and
+  //! bf16 arithmetic. See [ Note -- Packed arithmetic ] in
+  //! packed_arithmetic.cpp
+  std::unordered_map<const Expr*, const Expr*> packed_arithmetic_casts;
+
+  //! Lanes of each shuffle reduction segment of block reductions and welfords
+  //! lowered to sub-warp reductions. See getMaybeSubWarpReductionLanes
+  std::unordered_map<const Expr*, int64_t> sub_warp_reduction_lanes;
+
   //! Minimum compute capability of device that can execute this kernel
   std::pair<int64_t, int64_t> min_device_version;
 
@@ -129,9 +180,44 @@ struct KernelSummary {
 
 class KernelPerformanceProfile {
  public:
+  //! What a profiled region of the kernel does. See Note [Profiled kernel
+  //! regions] in device_lower/pass/instrument.cpp
+  enum class RegionKind { Load, Compute, BlockSync, GridSync, GridReduction };
+
+  //! A region bracketed by cycle counter samples of one thread per warp
+  struct Region {
+    const Expr* expr = nullptr;
+    RegionKind kind = RegionKind::Compute;
+    //! Index of the profile entry of the region in the backing buffer
+    int64_t index = -1;
+    //! Position in regions() of the top-level region containing this one,
+    //! -1 for a top-level region
+    int64_t parent = -1;
+  };
+
   //! Register an expression to profile
   void registerExpr(const Expr* expr);
 
+  //! Register a region to profile, nested in the already registered region
+  //! `parent` if not nullptr
+  void registerRegion(const Expr* expr, RegionKind kind, const Expr* parent);
+
+  //! Query if an expression is profiled as a region
+  bool isProfiledRegion(const Expr* expr) const;
+
+  //! Get the regions in the order they were registered
+  const std::vector<Region>& regions() const {
+    return regions_;
+  }
+
+  //! Get the indices of the profile of a region in the backing buffer
+  std::array<int64_t, 2> getIndicesInProfileBuffer(const Region& region) const;
+
+  static const char* kindName(RegionKind kind);
+
+  //! Short description of a region, e.g. the iter domain of a loop
+  static std::string regionName(const Region& region);
+
   //! Query if an expression is profiled
   bool isProfiled(const Expr* expr) const;
 
@@ -173,9 +259,9 @@ class KernelPerformanceProfile {
   //! Map profiled expressions to profile entry offsets
   std::unordered_map<const Expr*, int64_t> expr_entry_map_;
 
-  // TODO: Allow profiling of ForLoops
-  //! Map profiled ForLoop to profile entry offsets
-  // std::unordered_map<const ForLoop*, int64_t> loop_entry_map_;
+  //! Profiled regions and their positions in regions_
+  std::vector<Region> regions_;
+  std::unordered_map<const Expr*, int64_t> region_map_;
 };
 
 class KernelInternalProxy;
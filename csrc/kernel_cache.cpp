@@ -13,6 +13,8 @@
 #include <executor_params.h>
 #include <executor_utils.h>
 #include <fusion_profiler.h>
+#include <host_ir/executor.h>
+#include <host_ir/passes.h>
 #include <instrumentation.h>
 #include <ir/utils.h>
 #include <logical_domain_map.h>
@@ -20,16 +22,32 @@
 #include <preseg_passes/pre_segmenter.h>
 #include <scheduler/debug_utils.h>
 #include <scheduler/registry.h>
+#include <scheduler/tuning_db.h>
+#include <segmentation_cost_model.h>
+#include <thread_pool.h>
 #include <torch/csrc/jit/jit_log.h>
 #include <torch/csrc/jit/runtime/graph_executor.h>
 #include <utils.h>
 
+#include <ATen/cuda/CUDAContext.h>
+#include <ATen/cuda/CUDAEvent.h>
+#include <c10/cuda/CUDACachingAllocator.h>
 #include <c10/cuda/CUDAGuard.h>
+#include <c10/cuda/CUDAStream.h>
+#include <c10/util/SmallVector.h>
 #include <c10/util/irange.h>
 #include <torch/csrc/jit/jit_log.h>
 
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <list>
+#include <map>
 #include <mutex>
 #include <sstream>
+#include <string_view>
+#include <thread>
+#include <unordered_set>
 
 namespace nvfuser {
 
@@ -62,17 +80,6 @@ KernelArgumentHolder copyMetadataArg(const KernelArgumentHolder& src) {
   return dst;
 }
 
-// Copy bytes of value to back of buffer. This is templated in order to avoid
-// implicit cast such as int64_t -> size_t that might lose information.
-template <typename T>
-void encodeBuffer(T value, std::string& buffer) {
-  const char* v = reinterpret_cast<char*>(&value);
-  for (const auto i : c10::irange(sizeof(T))) {
-    (void)i; // Suppress unused variable warning
-    buffer.push_back(*(v++));
-  }
-}
-
 // This ArgumentManager do two things
 // (1) add outputs from a segment to the global fusion args to pass it to next
 // segment (2) delete args no longer being used to save memory. For task (2), it
@@ -229,6 +236,154 @@ class ArgumentManager {
 
 } // namespace
 
+namespace {
+
+// Inputs are rarely more than a few dozen tensors, so their encoding nearly
+// always fits in the inline storage and lookups don't touch the heap.
+using InputsEncoding = c10::SmallVector<int64_t, 256>;
+
+// Tags leading the encoding of each input. They also hold the rank of a
+// tensor, which makes the encoding unambiguous without separators.
+constexpr int64_t tensor_tag = 't';
+constexpr int64_t scalar_tag = 's';
+
+// Append the bits of value to the encoding. This is templated in order to avoid
+// implicit cast such as double -> int64_t that might lose information.
+template <typename T>
+void encodeValue(T value, InputsEncoding& encoding) {
+  static_assert(sizeof(T) <= sizeof(int64_t));
+  int64_t word = 0;
+  std::memcpy(&word, &value, sizeof(T));
+  encoding.push_back(word);
+}
+
+uint64_t hashEncoding(const int64_t* encoding, size_t encoding_size) {
+  size_t hash = encoding_size;
+  for (const auto i : c10::irange(encoding_size)) {
+    hashCombine(hash, std::hash<int64_t>()(encoding[i]));
+  }
+  return hash;
+}
+
+} // namespace
+
+InputsIdLookup::InputsIdLookup(size_t max_cache_size)
+    : max_cache_size_(max_cache_size) {
+  // Keep the load factor of the table under 1/2 when it is full
+  size_t capacity = 16;
+  while (capacity < 2 * max_cache_size_) {
+    capacity *= 2;
+  }
+  table_owner_ = std::make_unique<Table>(capacity);
+  table_.store(table_owner_.get());
+}
+
+InputsIdLookup::~InputsIdLookup() = default;
+
+InputsIdLookup::EncodingEntry* InputsIdLookup::tombstone() {
+  static EncodingEntry entry;
+  return &entry;
+}
+
+InputsIdLookup::EncodingEntry* InputsIdLookup::find(
+    const Table* table,
+    uint64_t hash,
+    const int64_t* encoding,
+    size_t encoding_size) {
+  for (size_t slot = hash & table->mask;; slot = (slot + 1) & table->mask) {
+    EncodingEntry* entry = table->slots[slot].load();
+    if (entry == nullptr) {
+      return nullptr;
+    }
+    if (entry != tombstone() && entry->hash == hash &&
+        entry->encoding.size() == encoding_size &&
+        std::equal(
+            entry->encoding.begin(), entry->encoding.end(), encoding)) {
+      return entry;
+    }
+  }
+}
+
+void InputsIdLookup::insert(std::unique_ptr<EncodingEntry> entry) {
+  const Table* table = table_.load();
+  const size_t capacity = table->mask + 1;
+  if (4 * (entries_.size() + num_tombstones_ + 1) > 3 * capacity) {
+    // Too many tombstones, or a deserialized cache outgrowing the table. Move
+    // the live entries to a new table.
+    size_t new_capacity = capacity;
+    while (4 * (entries_.size() + 1) > new_capacity) {
+      new_capacity *= 2;
+    }
+    auto new_table = std::make_unique<Table>(new_capacity);
+    for (const auto& [ptr, owned] : entries_) {
+      size_t slot = ptr->hash & new_table->mask;
+      while (new_table->slots[slot].load() != nullptr) {
+        slot = (slot + 1) & new_table->mask;
+      }
+      new_table->slots[slot].store(ptr);
+    }
+    table_.store(new_table.get());
+    retired_tables_.push_back(std::move(table_owner_));
+    table_owner_ = std::move(new_table);
+    num_tombstones_ = 0;
+    table = table_owner_.get();
+  }
+
+  size_t slot = entry->hash & table->mask;
+  for (;; slot = (slot + 1) & table->mask) {
+    EncodingEntry* existing = table->slots[slot].load();
+    if (existing == nullptr) {
+      break;
+    }
+    if (existing == tombstone()) {
+      num_tombstones_--;
+      break;
+    }
+  }
+  EncodingEntry* ptr = entry.get();
+  entries_.emplace(ptr, std::move(entry));
+  num_entries_.store(entries_.size(), std::memory_order_relaxed);
+  // Publishing the entry last makes its fields visible to lookups finding it
+  table->slots[slot].store(ptr);
+}
+
+size_t InputsIdLookup::evictLeastRecentlyUsed() {
+  NVF_ERROR(!entries_.empty(), "No entry to evict");
+  auto lru = std::min_element(
+      entries_.begin(), entries_.end(), [](const auto& a, const auto& b) {
+        return a.first->last_used.load(std::memory_order_relaxed) <
+            b.first->last_used.load(std::memory_order_relaxed);
+      });
+  EncodingEntry* entry = lru->first;
+
+  const Table* table = table_.load();
+  for (size_t slot = entry->hash & table->mask;;
+       slot = (slot + 1) & table->mask) {
+    if (table->slots[slot].load() == entry) {
+      table->slots[slot].store(tombstone());
+      num_tombstones_++;
+      break;
+    }
+  }
+
+  const size_t evict_id = entry->id;
+  retired_entries_.push_back(std::move(lru->second));
+  entries_.erase(lru);
+  num_entries_.store(entries_.size(), std::memory_order_relaxed);
+  num_evictions_.fetch_add(1, std::memory_order_relaxed);
+  return evict_id;
+}
+
+void InputsIdLookup::reclaim() {
+  // The entries and tables were unlinked before this point. A lookup starting
+  // after this check can't observe them, and none is still reading them if
+  // the count is zero. Both sides use sequentially consistent operations.
+  if (num_readers_.load() == 0) {
+    retired_entries_.clear();
+    retired_tables_.clear();
+  }
+}
+
 flatbuffers::Offset<serde::InputsIdLookup> InputsIdLookup::serialize(
     flatbuffers::FlatBufferBuilder& builder) const {
   // See definitions in serde/fusion_cache.fbs for table
@@ -236,23 +391,35 @@ flatbuffers::Offset<serde::InputsIdLookup> InputsIdLookup::serialize(
 
   using fb_string = flatbuffers::Offset<flatbuffers::String>;
 
-  // For serialization, we require a consistent ordering for the
-  // encoding_lookup_ map.
-  std::unordered_map<std::string, size_t> str_key_ordering;
+  // Entries are stored as the bytes of their encoding, from the most recently
+  // used to the least recently used one.
+  std::vector<const EncodingEntry*> lru_entries;
+  lru_entries.reserve(entries_.size());
+  for (const auto& item : entries_) {
+    lru_entries.push_back(item.first);
+  }
+  std::sort(
+      lru_entries.begin(),
+      lru_entries.end(),
+      [](const EncodingEntry* a, const EncodingEntry* b) {
+        return a->last_used.load(std::memory_order_relaxed) >
+            b->last_used.load(std::memory_order_relaxed);
+      });
 
-  // 1. Serialize used_entry_ list
+  // 1. Serialize LRU list
   std::vector<fb_string> lru_cache_fb;
-  for (const auto& str : used_entry_) {
-    lru_cache_fb.push_back(builder.CreateString(str));
-    str_key_ordering.emplace(str, str_key_ordering.size());
+  for (const EncodingEntry* entry : lru_entries) {
+    lru_cache_fb.push_back(builder.CreateString(
+        reinterpret_cast<const char*>(entry->encoding.data()),
+        entry->encoding.size() * sizeof(int64_t)));
   }
 
-  // 2. Serialize encoding_lookup_ map
+  // 2. Serialize encoding lookup map
   std::vector<fb_string> encoding_lookup_keys_fb;
   std::vector<serde::EncodingEntry> encoding_lookup_values_fb;
-  for (auto&& [key, value] : encoding_lookup_) {
-    encoding_lookup_keys_fb.push_back(builder.CreateString(key));
-    encoding_lookup_values_fb.emplace_back(value.id, str_key_ordering.at(key));
+  for (const auto i : c10::irange(lru_entries.size())) {
+    encoding_lookup_keys_fb.push_back(lru_cache_fb.at(i));
+    encoding_lookup_values_fb.emplace_back(lru_entries.at(i)->id, i);
   }
 
   return serde::CreateInputsIdLookupDirect(
@@ -268,117 +435,360 @@ void InputsIdLookup::deserialize(const serde::InputsIdLookup* buffer) {
   // See definitions in serde/fusion_cache.fbs for tables
   // InputsIdLookup and EncodingEntry
   NVF_ERROR(buffer != nullptr, "serde::InputsIdLookup is nullptr.");
-  using list_iter = std::list<std::string>::iterator;
-  std::vector<list_iter> used_entry_iterators;
+  std::lock_guard<std::mutex> guard(mutex_);
 
   max_cache_size_ = buffer->max_cache_size();
   current_id_ = buffer->current_id();
-  for (auto fb_str : *buffer->lru_cache()) {
-    used_entry_.emplace_back(fb_str->str());
-    used_entry_iterators.emplace_back(std::prev(used_entry_.end()));
-  }
+  const auto num_entries = buffer->lru_cache()->size();
 
   for (auto idx : c10::irange(buffer->encoding_lookup_keys()->size())) {
     auto fb_encoding_lookup_str = buffer->encoding_lookup_keys()->Get(idx);
     auto fb_encoding_entry = buffer->encoding_lookup_values()->Get(idx);
 
-    EncodingEntry entry{
-        fb_encoding_entry->id(),
-        used_entry_iterators.at(fb_encoding_entry->lru_iter())};
-    encoding_lookup_.emplace(fb_encoding_lookup_str->str(), entry);
+    auto entry = std::make_unique<EncodingEntry>();
+    entry->id = fb_encoding_entry->id();
+    entry->encoding.resize(fb_encoding_lookup_str->size() / sizeof(int64_t));
+    std::memcpy(
+        entry->encoding.data(),
+        fb_encoding_lookup_str->data(),
+        entry->encoding.size() * sizeof(int64_t));
+    entry->hash =
+        hashEncoding(entry->encoding.data(), entry->encoding.size());
+    // The LRU list starts with the most recently used entry
+    entry->last_used.store(num_entries - fb_encoding_entry->lru_iter());
+    insert(std::move(entry));
+  }
+  // Count the deserialized entries as misses so that hits start at zero
+  num_lookups_.store(num_entries + 1);
+  num_misses_.store(num_entries + 1);
+}
+
+namespace {
+
+void encodeTensor(const at::Tensor& tensor, InputsEncoding& encoding) {
+  encoding.push_back(
+      tensor_tag | ((int64_t)tensor.scalar_type() << 8) |
+      (tensor.dim() << 16));
+  encoding.append(tensor.sizes().begin(), tensor.sizes().end());
+  encoding.append(tensor.strides().begin(), tensor.strides().end());
+  encoding.push_back((int64_t)SchedulerRuntimeInfo::computeAlignmentSize(
+      (size_t)tensor.data_ptr()));
+  // NOTE: device is set for the whole set of inputs first using device arg
+}
+
+// Although most commonly the recorded scalars will be Int or Bool scalars,
+// any DataType might appear via `cast` and `where`, so we handle all cases
+// here.
+void encodeScalar(const c10::IValue& input, InputsEncoding& encoding) {
+  if (input.isInt()) {
+    encoding.push_back(scalar_tag | (1 << 8));
+    encodeValue(input.toInt(), encoding);
+  } else if (input.isBool()) {
+    encoding.push_back(scalar_tag | (2 << 8));
+    encodeValue(input.toBool(), encoding);
+  } else if (input.isDouble()) {
+    encoding.push_back(scalar_tag | (3 << 8));
+    encodeValue(input.toDouble(), encoding);
+  } else if (input.isComplexDouble()) {
+    encoding.push_back(scalar_tag | (4 << 8));
+    encodeValue(input.toComplexDouble().real(), encoding);
+    encodeValue(input.toComplexDouble().imag(), encoding);
+  } else {
+    NVF_ERROR(
+        false,
+        "Unhandled input type when creating input ID. Cannot record ",
+        input);
+  }
+}
+
+// Same encoding as above, so that both overloads of lookupId agree
+void encodeScalar(const PolymorphicValue& input, InputsEncoding& encoding) {
+  if (input.is<int64_t>()) {
+    encoding.push_back(scalar_tag | (1 << 8));
+    encodeValue(input.as<int64_t>(), encoding);
+  } else if (input.is<bool>()) {
+    encoding.push_back(scalar_tag | (2 << 8));
+    encodeValue(input.as<bool>(), encoding);
+  } else if (input.is<double>()) {
+    encoding.push_back(scalar_tag | (3 << 8));
+    encodeValue(input.as<double>(), encoding);
+  } else if (input.is<std::complex<double>>()) {
+    encoding.push_back(scalar_tag | (4 << 8));
+    encodeValue(input.as<std::complex<double>>().real(), encoding);
+    encodeValue(input.as<std::complex<double>>().imag(), encoding);
+  } else {
+    NVF_ERROR(
+        false,
+        "Unhandled input type when creating input ID. Cannot record ",
+        input);
   }
 }
 
+} // namespace
+
 InputsIdLookup::IdLookupReturn InputsIdLookup::lookupId(
     const at::ArrayRef<c10::IValue>& inputs,
     const std::unordered_set<size_t>& scalar_inputs_to_record,
     int8_t device) {
-  IdLookupReturn ret;
-
-  // lock mutex_ because we are touching encoding_
-  std::lock_guard<std::mutex> guard(mutex_);
-  encoding_.clear();
-  encodeBuffer(device, encoding_);
+  InputsEncoding encoding;
+  encodeValue(device, encoding);
   for (const auto i : c10::irange(inputs.size())) {
-    auto input = inputs[i];
+    const auto& input = inputs[i];
     if (input.isTensor()) {
-      auto& input_tensor = input.toTensor();
-
-      for (auto size : input_tensor.sizes()) {
-        encodeBuffer(size, encoding_);
-        encoding_.push_back(' ');
-      }
-      encoding_.push_back('X');
-      encoding_.push_back(' ');
-      for (auto stride : input_tensor.strides()) {
-        encodeBuffer(stride, encoding_);
-        encoding_.push_back(' ');
-      }
-      encoding_.push_back('a');
-      encodeBuffer(
-          SchedulerRuntimeInfo::computeAlignmentSize(
-              (size_t)input_tensor.data_ptr()),
-          encoding_);
-      // NOTE: device is set for the whole set of inputs first using device arg
+      encodeTensor(input.toTensor(), encoding);
+    } else if (scalar_inputs_to_record.count(i)) {
+      // Add value of scalars here only if it is one of the scalars
+      // provided, as these are used in determining concretization.
+      encodeScalar(input, encoding);
+    } else {
+      encoding.push_back(scalar_tag);
+    }
+  }
+  return lookupEncoding(encoding.data(), encoding.size());
+}
+
+InputsIdLookup::IdLookupReturn InputsIdLookup::lookupId(
+    const KernelArgumentHolder& args,
+    const std::unordered_set<size_t>& scalar_inputs_to_record) {
+  InputsEncoding encoding;
+  encodeValue(args.getDeviceIndex(), encoding);
+  for (const auto i : c10::irange(args.size())) {
+    const PolymorphicValue& input = *args[i];
+    if (input.is<at::Tensor>()) {
+      encodeTensor(input.as<at::Tensor>(), encoding);
+    } else if (scalar_inputs_to_record.count(i)) {
+      encodeScalar(input, encoding);
     } else {
-      // encode s for scalar;
-      encoding_.push_back('s');
-      if (scalar_inputs_to_record.find(i) != scalar_inputs_to_record.end()) {
-        // Add value of scalars here only if it is one of the scalars
-        // provided, as these are used in determining concretization.
-        // Note that although most commonly these will be Int or Bool scalars,
-        // any DataType might appear via `cast` and `where`, so we handle all
-        // cases here.
-        if (input.isInt()) {
-          encodeBuffer(input.toInt(), encoding_);
-        } else if (input.isBool()) {
-          encodeBuffer(input.toBool(), encoding_);
-        } else if (input.isDouble()) {
-          encodeBuffer(input.toDouble(), encoding_);
-        } else if (input.isComplexDouble()) {
-          encodeBuffer(input.toComplexDouble(), encoding_);
-        } else {
-          NVF_ERROR(
-              false,
-              "Unhandled input type when creating input ID. Cannot record ",
-              input);
+      encoding.push_back(scalar_tag);
+    }
+  }
+  return lookupEncoding(encoding.data(), encoding.size());
+}
+
+InputsIdLookup::IdLookupReturn InputsIdLookup::lookupEncoding(
+    const int64_t* encoding,
+    size_t encoding_size) {
+  IdLookupReturn ret;
+  const uint64_t hash = hashEncoding(encoding, encoding_size);
+  const uint64_t now = num_lookups_.fetch_add(1, std::memory_order_relaxed);
+
+  // Fast path: look the encoding up without locking. Registering as a reader
+  // keeps the entries and the table alive until the lookup is done.
+  num_readers_.fetch_add(1);
+  if (EncodingEntry* entry =
+          find(table_.load(), hash, encoding, encoding_size)) {
+    entry->last_used.store(now, std::memory_order_relaxed);
+    ret.id = entry->id;
+  }
+  num_readers_.fetch_sub(1);
+  if (ret.id != 0) {
+    return ret;
+  }
+
+  std::lock_guard<std::mutex> guard(mutex_);
+  // Another thread might have inserted the same encoding in the meantime
+  if (EncodingEntry* entry =
+          find(table_.load(), hash, encoding, encoding_size)) {
+    entry->last_used.store(now, std::memory_order_relaxed);
+    ret.id = entry->id;
+    return ret;
+  }
+
+  num_misses_.fetch_add(1, std::memory_order_relaxed);
+  if (entries_.size() >= max_cache_size_) {
+    // pop least recently used cache;
+    ret.evict_id = evictLeastRecentlyUsed();
+    ret.eviction = true;
+  }
+
+  // no entry existed for given input set, set id for given entry
+  auto entry = std::make_unique<EncodingEntry>();
+  entry->hash = hash;
+  entry->id = current_id_++;
+  entry->encoding.assign(encoding, encoding + encoding_size);
+  entry->last_used.store(now, std::memory_order_relaxed);
+  ret.id = entry->id;
+  insert(std::move(entry));
+  reclaim();
+  return ret;
+}
+
+namespace {
+
+//! Upper bound of the streams independent segments are spread over
+constexpr int64_t max_concurrent_segment_streams = 8;
+
+//! Bytes of the tensors output by the groups, estimated from the extents of
+//! their logical domains evaluated with the inputs of the complete fusion.
+//! Returns std::nullopt if an extent can't be evaluated.
+std::optional<std::unordered_map<Val*, int64_t>> estimateSegmentOutputBytes(
+    SegmentedFusion* segmented_fusion,
+    const KernelArgumentHolder& args) {
+  Fusion* fusion = segmented_fusion->completeFusion();
+  ExpressionEvaluator expr_eval = executor_utils::bindInputs(args, fusion);
+  std::unordered_map<Val*, int64_t> bytes;
+  for (SegmentedGroup* group : segmented_fusion->groups()) {
+    for (Val* out : group->outputs()) {
+      auto tv = dynamic_cast<TensorView*>(out);
+      if (tv == nullptr) {
+        continue;
+      }
+      // Outputs aliasing an input are not allocated
+      if (tv->isFusionOutput() &&
+          fusion->getOutputAlias(tv).type != AllocationType::New) {
+        bytes[tv] = 0;
+        continue;
+      }
+      int64_t numel = 1;
+      for (IterDomain* id :
+           TensorDomain::noReductions(tv->getLogicalDomain())) {
+        // Expanded broadcasts are allocated with a stride of 0
+        if (id->isBroadcast()) {
+          continue;
+        }
+        PolymorphicValue extent = expr_eval.evaluate(id->extent());
+        if (!extent.is<int64_t>()) {
+          return std::nullopt;
         }
+        numel *= extent.as<int64_t>();
       }
+      bytes[tv] = numel * dataTypeSize(tv->dtype());
     }
-    encoding_.push_back(';');
   }
+  return bytes;
+}
 
-  auto& entry = encoding_lookup_[encoding_];
-
-  if (entry.id == 0) {
-    // no entry existed for given input set, set id for given entry
-    entry.id = current_id_++;
-    if (used_entry_.size() == max_cache_size_) {
-      // pop least recently used cache;
-      const auto& remove_iter = encoding_lookup_.find(used_entry_.back());
-      used_entry_.pop_back();
-      ret.evict_id = remove_iter->second.id;
-      ret.eviction = true;
-      encoding_lookup_.erase(remove_iter);
+//! Bytes live while each group of `run_order` runs, given the bytes of the
+//! outputs of the groups and of the global intermediates of each entry of
+//! `run_order`. See [ Note -- Memory plan ]
+std::vector<int64_t> liveBytes(
+    const std::vector<SegmentedGroup*>& run_order,
+    const std::unordered_map<Val*, int64_t>& output_bytes,
+    const std::vector<int64_t>& intermediate_bytes) {
+  const int64_t num_groups = (int64_t)run_order.size();
+  std::unordered_map<Val*, int64_t> last_use;
+  for (auto run_order_id : c10::irange(num_groups)) {
+    for (Val* input : run_order.at(run_order_id)->inputs()) {
+      last_use[input] = run_order_id;
     }
-  } else {
-    // short-cut to leave LRU entry as is
-    if (entry.lru_iter == used_entry_.begin()) {
-      ret.id = entry.id;
-      return ret;
+  }
+
+  // Bytes allocated and freed before each group runs
+  std::vector<int64_t> delta(num_groups + 1, 0);
+  for (auto run_order_id : c10::irange(num_groups)) {
+    for (Val* output : run_order.at(run_order_id)->outputs()) {
+      auto bytes_it = output_bytes.find(output);
+      if (bytes_it == output_bytes.end()) {
+        continue;
+      }
+      int64_t end = run_order_id + 1;
+      if (output->isFusionOutput()) {
+        end = num_groups;
+      } else if (auto it = last_use.find(output); it != last_use.end()) {
+        end = std::max(end, it->second + 1);
+      }
+      delta.at(run_order_id) += bytes_it->second;
+      delta.at(end) -= bytes_it->second;
     }
+  }
 
-    used_entry_.erase(entry.lru_iter);
+  std::vector<int64_t> live_bytes;
+  live_bytes.reserve(num_groups);
+  int64_t allocated = 0;
+  for (auto run_order_id : c10::irange(num_groups)) {
+    allocated += delta.at(run_order_id);
+    live_bytes.push_back(allocated + intermediate_bytes.at(run_order_id));
   }
+  return live_bytes;
+}
 
-  ret.id = entry.id;
-  entry.lru_iter = used_entry_.insert(used_entry_.begin(), encoding_);
-  return ret;
+//! Topological order of the groups of `run_order` that greedily runs the ready
+//! group that increases the live bytes the least, and then the one with the
+//! smallest outputs. See [ Note -- Memory plan ]
+std::vector<SegmentedGroup*> orderForMemory(
+    const std::vector<SegmentedGroup*>& run_order,
+    const std::unordered_map<Val*, int64_t>& output_bytes) {
+  const int64_t num_groups = (int64_t)run_order.size();
+  auto bytes_of = [&output_bytes](Val* val) {
+    auto it = output_bytes.find(val);
+    return it == output_bytes.end() ? 0 : it->second;
+  };
+
+  // Values that are produced by a group, and the number of groups reading
+  // each of them that have not run yet
+  std::unordered_set<Val*> produced;
+  std::unordered_map<Val*, int64_t> num_readers;
+  for (SegmentedGroup* group : run_order) {
+    produced.insert(group->outputs().begin(), group->outputs().end());
+    for (Val* input : group->inputs()) {
+      num_readers[input]++;
+    }
+  }
+
+  std::unordered_set<Val*> available;
+  std::vector<bool> ran(num_groups, false);
+  std::vector<SegmentedGroup*> order;
+  order.reserve(num_groups);
+  int64_t allocated = 0;
+  while ((int64_t)order.size() < num_groups) {
+    int64_t best = -1;
+    int64_t best_live = 0;
+    int64_t best_change = 0;
+    for (auto run_order_id : c10::irange(num_groups)) {
+      SegmentedGroup* group = run_order.at(run_order_id);
+      if (ran.at(run_order_id) ||
+          std::any_of(
+              group->inputs().begin(),
+              group->inputs().end(),
+              [&](Val* input) {
+                return produced.count(input) && !available.count(input);
+              })) {
+        continue;
+      }
+      int64_t outputs = 0;
+      int64_t freed = 0;
+      for (Val* output : group->outputs()) {
+        outputs += bytes_of(output);
+        if (!output->isFusionOutput() && !num_readers.count(output)) {
+          freed += bytes_of(output);
+        }
+      }
+      for (Val* input : group->inputs()) {
+        if (produced.count(input) && !input->isFusionOutput() &&
+            num_readers.at(input) == 1) {
+          freed += bytes_of(input);
+        }
+      }
+      const int64_t live = allocated + outputs;
+      const int64_t change = outputs - freed;
+      // run_order is already a valid order, which breaks ties
+      if (best == -1 || change < best_change ||
+          (change == best_change && live < best_live)) {
+        best = run_order_id;
+        best_live = live;
+        best_change = change;
+      }
+    }
+    NVF_ERROR(best != -1, "No group is ready to run");
+
+    SegmentedGroup* group = run_order.at(best);
+    ran.at(best) = true;
+    order.push_back(group);
+    allocated += best_change;
+    available.insert(group->outputs().begin(), group->outputs().end());
+    for (Val* input : group->inputs()) {
+      num_readers.at(input)--;
+    }
+  }
+  return order;
 }
 
+} // namespace
+
 void prepareRuntimeOrder(
     SegmentedFusion* segmented_fusion,
-    RuntimeWorkSpace& runtime_workspace) {
+    RuntimeWorkSpace& runtime_workspace,
+    const KernelArgumentHolder* args) {
   // Setup group run order:
   std::unordered_set<Val*> available_input;
 
@@ -434,6 +844,123 @@ void prepareRuntimeOrder(
         one_ran,
         "Couldn't run all groups, something must have gone wrong in segmentation.");
   }
+
+  // See [ Note -- Memory plan ]
+  if (args != nullptr && runtime_workspace.group_run_order.size() > 2 &&
+      isOptionEnabled(EnableOption::MemoryAwareSegmentOrder)) {
+    std::optional<std::unordered_map<Val*, int64_t>> output_bytes =
+        estimateSegmentOutputBytes(segmented_fusion, *args);
+    if (output_bytes.has_value()) {
+      std::vector<SegmentedGroup*>& run_order =
+          runtime_workspace.group_run_order;
+      const std::vector<int64_t> no_intermediates(run_order.size(), 0);
+      auto peak_bytes = [&](const std::vector<SegmentedGroup*>& order) {
+        std::vector<int64_t> live_bytes =
+            liveBytes(order, *output_bytes, no_intermediates);
+        return *std::max_element(live_bytes.begin(), live_bytes.end());
+      };
+      std::vector<SegmentedGroup*> memory_order =
+          orderForMemory(run_order, *output_bytes);
+      if (peak_bytes(memory_order) < peak_bytes(run_order)) {
+        run_order = std::move(memory_order);
+      }
+    }
+  }
+
+  // Segments at the same depth of the segment graph do not depend on each
+  // other, so they are given different streams. See
+  // [ Note -- Concurrent segments ]
+  const auto& run_order = runtime_workspace.group_run_order;
+  std::unordered_map<Val*, int64_t> producer_of;
+  std::vector<int64_t> depths;
+  std::unordered_map<int64_t, int64_t> groups_at_depth;
+  std::unordered_map<int64_t, std::vector<bool>> streams_taken_at_depth;
+  for (const auto run_order_id : c10::irange((int64_t)run_order.size())) {
+    std::vector<int64_t> producers;
+    int64_t depth = 0;
+    for (Val* input : run_order.at(run_order_id)->inputs()) {
+      auto it = producer_of.find(input);
+      if (it == producer_of.end() ||
+          std::find(producers.begin(), producers.end(), it->second) !=
+              producers.end()) {
+        continue;
+      }
+      producers.push_back(it->second);
+      depth = std::max(depth, depths.at(it->second) + 1);
+    }
+    for (Val* output : run_order.at(run_order_id)->outputs()) {
+      producer_of.emplace(output, run_order_id);
+    }
+    depths.push_back(depth);
+
+    // Continue on the stream of a producer right above, so that a chain of
+    // segments does not wait on events, unless another segment at the same
+    // depth already took it. Otherwise take the first stream free at this
+    // depth.
+    std::vector<bool>& streams_taken = streams_taken_at_depth[depth];
+    streams_taken.resize(max_concurrent_segment_streams, false);
+    int64_t stream_id = -1;
+    for (int64_t producer : producers) {
+      const int64_t producer_stream =
+          runtime_workspace.group_streams.at(producer);
+      if (depths.at(producer) + 1 == depth &&
+          !streams_taken.at(producer_stream)) {
+        stream_id = producer_stream;
+        break;
+      }
+    }
+    if (stream_id == -1) {
+      auto free_it =
+          std::find(streams_taken.begin(), streams_taken.end(), false);
+      stream_id = free_it != streams_taken.end()
+          ? std::distance(streams_taken.begin(), free_it)
+          : groups_at_depth[depth] % max_concurrent_segment_streams;
+    }
+    streams_taken.at(stream_id) = true;
+    groups_at_depth[depth]++;
+
+    runtime_workspace.group_producers.push_back(std::move(producers));
+    runtime_workspace.group_streams.push_back(stream_id);
+  }
+
+  // See [ Note -- L2 persistence of segment handoffs ]
+  const std::vector<Val*>& fusion_outputs = segmented_fusion->outputs();
+  for (const auto run_order_id : c10::irange((int64_t)run_order.size())) {
+    SegmentedGroup* group = run_order.at(run_order_id);
+    std::optional<FusionExecutor::L2Window> window;
+    if (run_order_id + 1 < (int64_t)run_order.size()) {
+      const std::vector<Val*>& next_inputs =
+          run_order.at(run_order_id + 1)->inputs();
+      const std::vector<Val*>& outputs = group->outputs();
+      for (const auto i : c10::irange((int64_t)outputs.size())) {
+        Val* output = outputs.at(i);
+        if (output->isA<TensorView>() &&
+            std::find(next_inputs.begin(), next_inputs.end(), output) !=
+                next_inputs.end() &&
+            std::find(fusion_outputs.begin(), fusion_outputs.end(), output) ==
+                fusion_outputs.end()) {
+          window = FusionExecutor::L2Window{i, /*is_output=*/true};
+          break;
+        }
+      }
+    }
+    // Otherwise release the handoff of the previous segment
+    if (!window.has_value() && run_order_id > 0) {
+      const std::optional<FusionExecutor::L2Window>& previous =
+          runtime_workspace.group_l2_windows.back();
+      if (previous.has_value() && previous->is_output) {
+        Val* handoff =
+            run_order.at(run_order_id - 1)->outputs().at(previous->index);
+        const std::vector<Val*>& inputs = group->inputs();
+        auto it = std::find(inputs.begin(), inputs.end(), handoff);
+        if (it != inputs.end()) {
+          window = FusionExecutor::L2Window{
+              std::distance(inputs.begin(), it), /*is_output=*/false};
+        }
+      }
+    }
+    runtime_workspace.group_l2_windows.push_back(window);
+  }
 }
 
 FusionExecutorCache::FusionExecutorCache(
@@ -445,13 +972,22 @@ FusionExecutorCache::FusionExecutorCache(
       fusion_id_{fusion_id},
       auto_schedule_(auto_schedule) {}
 
+FusionExecutorCache::~FusionExecutorCache() {
+  RuntimeCacheBudget::get().forget(this);
+}
+
 KernelArgumentHolder FusionExecutorCache::prepareInputs(
     const at::ArrayRef<c10::IValue>& inputs,
     std::optional<int8_t> selected_device) {
   FUSER_PERF_SCOPE("FusionExecutorCache::prepareInputs");
-
   KernelArgumentHolder args =
       KernelArgumentHolder::createKernelArgumentHolder(inputs, selected_device);
+  prepareArgs(args);
+  return args;
+}
+
+void FusionExecutorCache::prepareArgs(KernelArgumentHolder& args) {
+  ensureDeserialized();
 
   // TODO: move InputsIdLookup inside KernelArgumentHolder;
   // NOTE: We must ensure that the cache id is in fact unique. Dynamic fusions
@@ -462,15 +998,13 @@ KernelArgumentHolder FusionExecutorCache::prepareInputs(
   // short-circuiting here, resulting in avoidable rebuilds of concretization
   // info.
   auto id_lookup_ret = inputs_id_lookup_.lookupId(
-      inputs,
-      initialInfo().scalarInputsAffectingConcretization(),
-      args.getDeviceIndex());
+      args, initialInfo().scalarInputsAffectingConcretization());
   if (id_lookup_ret.eviction) {
+    std::unique_lock<std::shared_mutex> exclusive_run(runtimes_mutex_);
     evictCache(id_lookup_ret.evict_id);
   }
 
   args.setCacheId(id_lookup_ret.id);
-  return args;
 }
 
 bool FusionExecutorCache::isCompiled(
@@ -485,88 +1019,898 @@ bool FusionExecutorCache::isCompiled(
   return getKernelRuntimeFor(args)->isCompiled();
 }
 
-std::vector<at::Tensor> FusionExecutorCache::runFusionWithInputs(
+MemoryPlan FusionExecutorCache::planMemory(
     const at::ArrayRef<c10::IValue>& inputs,
-    std::optional<PrimDataType> forced_index_type,
-    std::optional<int8_t> selected_device) {
-  FUSER_PERF_SCOPE("FusionExecutorCache::runFusionWithInputs");
-  // NOTE: This should be the first code in the method to capture all host time
-  if (isProfilerEnabled()) {
-    FusionProfiler::start(!isProfilerEnabledWithCupti());
-  }
+    int8_t device) {
+  FUSER_PERF_SCOPE("FusionExecutorCache::planMemory");
+  ensureDeserialized();
 
-  KernelArgumentHolder args = prepareInputs(inputs, selected_device);
-  auto kernel_runtime = getKernelRuntimeFor(args, forced_index_type);
+  // Same as in warmup, the inputs may be meta tensors
+  KernelArgumentHolder args;
+  args.setDeviceIndex(device);
+  args.push(inputs);
+  prepareArgs(args);
 
-  if (isProfilerEnabled()) {
-    FusionProfiler::createSegments(kernel_runtime->executors().size());
+  return getKernelRuntimeFor(args)->planMemory(args);
+}
+
+void FusionExecutorCache::warmup(
+    const std::vector<std::vector<c10::IValue>>& input_sets,
+    int8_t device) {
+  FUSER_PERF_SCOPE("FusionExecutorCache::warmup");
+  ensureDeserialized();
+
+  // Creating a runtime updates the lookup tables of this cache, so the input
+  // sets are segmented and scheduled one at a time. Input sets sharing a
+  // runtime, e.g. through heuristics reuse, only compile it once.
+  std::vector<std::pair<FusionKernelRuntime*, KernelArgumentHolder>>
+      to_compile;
+  std::unordered_set<FusionKernelRuntime*> visited;
+  for (const auto& inputs : input_sets) {
+    // createKernelArgumentHolder would reject meta tensors, so the device is
+    // given explicitly instead of being inferred from the inputs.
+    KernelArgumentHolder args;
+    args.setDeviceIndex(device);
+    args.push(inputs);
+    prepareArgs(args);
+
+    FusionKernelRuntime* kernel_runtime = getKernelRuntimeFor(args);
+    waitForCompilation(kernel_runtime);
+    if (visited.insert(kernel_runtime).second &&
+        !kernel_runtime->isCompiled()) {
+      to_compile.emplace_back(kernel_runtime, std::move(args));
+    }
   }
 
-  if (!kernel_runtime->isCompiled()) {
-    kernel_runtime->compileFusionParallel(args);
+  // The runtimes are compiled on separate threads rather than on pool workers,
+  // which would stay blocked while their segments compile. Their segments are
+  // compiled as background tasks on the pool.
+  std::vector<std::future<void>> compilations;
+  compilations.reserve(to_compile.size());
+  for (auto& [kernel_runtime, args] : to_compile) {
+    compilations.push_back(std::async(
+        std::launch::async,
+        [kernel_runtime = kernel_runtime, &args = args]() {
+          kernel_runtime->compileFusionParallel(
+              args, TaskPriority::Background);
+        }));
+  }
+  for (auto& compiled : compilations) {
+    compiled.wait();
+  }
+  // Report the first failure only once every compilation has finished
+  for (auto& compiled : compilations) {
+    compiled.get();
   }
+}
 
-  most_recent_runtime_ = kernel_runtime;
+namespace {
 
-  auto fusion = kernel_runtime->fusionSegments()->completeFusion();
+// [ Note -- Runtime metrics ]
+//
+// With NVFUSER_ENABLE=runtime_metrics, each FusionExecutorCache maintains a
+// FusionExecutorCacheMetrics: counts of runs, kernel launches and hits at each
+// level of getKernelRuntimeFor, the time spent compiling, and the bytes
+// processed by the kernels. These are plain counters updated on the host,
+// unlike FusionProfiler, which is meant for offline analysis and relies on
+// CUPTI.
+//
+// Kernel durations would require waiting for the GPU. Instead, one run every
+// sample period, 100 by default, is bracketed with CUDA events, and the
+// elapsed time is only read by a later run once the events have completed.
+// Runs are not sampled while an earlier sample is still in flight. The
+// metrics can be read with FusionExecutorCache::metrics() or with
+// FusionDefinition.metrics() in Python.
+
+int64_t metricsSamplePeriod() {
+  int64_t period = 100;
+  const auto& args = getEnableOptionArguments(EnableOption::RuntimeMetrics);
+  if (!args.empty()) {
+    try {
+      period = std::stoll(args[0]);
+    } catch (const std::exception&) {
+      NVF_CHECK(false, "Invalid runtime metrics sample period: ", args[0]);
+    }
+  }
+  NVF_CHECK(
+      period >= 0,
+      "Runtime metrics sample period must not be negative, but got ",
+      period);
+  return period;
+}
 
-  // Make sure the forced index type is indeed used
-  if (forced_index_type.has_value()) {
-    NVF_ERROR(
-        kernel_runtime->getIndexType() == forced_index_type.value(),
-        "Enforcing index type of ",
-        forced_index_type.value(),
-        " failed");
+int64_t nanosecondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+} // namespace
+
+std::string FusionExecutorCacheMetrics::toString() const {
+  std::stringstream ss;
+  ss << "FusionExecutorCacheMetrics{runs=" << runs
+     << ", kernel_launches=" << kernel_launches
+     << ", input_id_hits=" << input_id_hits
+     << ", runtime_reuses=" << runtime_reuses
+     << ", shape_bucket_hits=" << shape_bucket_hits
+     << ", runtime_misses=" << runtime_misses
+     << ", compile_time_ns=" << compile_time_ns
+     << ", num_segments=" << num_segments
+     << ", input_bytes=" << input_bytes << ", output_bytes=" << output_bytes
+     << ", sampled_runs=" << sampled_runs
+     << ", sampled_kernel_time_ns=" << sampled_kernel_time_ns
+     << ", runtime_evictions=" << runtime_evictions
+     << ", batched_requests=" << batched_requests
+     << ", request_batches=" << request_batches << "}";
+  return ss.str();
+}
+
+// [ Note -- Runtime cache budget ]
+//
+// A FusionExecutorCache keeps every FusionKernelRuntime it creates, and
+// InputsIdLookup only bounds the number of input ids, so a long running
+// service seeing ever new shapes keeps growing in host memory and in modules
+// loaded on the GPU. With NVFUSER_ENABLE=runtime_cache_budget(<MiB>), 1024
+// MiB by default, the runtimes of all FusionExecutorCaches are tracked in a
+// single LRU list, each with its estimated host bytes, see
+// FusionKernelRuntime::hostBytes, and the bytes of its modules. After each
+// run, the runtime that ran moves to the front of the list, and the least
+// recently used runtimes are evicted until the total fits the budget. An
+// evicted runtime is destroyed, which unloads its modules, and the input ids
+// that used it are forgotten, so that the next inputs that would have used
+// it reuse another runtime or create it again.
+//
+// The runtime that just ran is never evicted, nor are the runtimes of a
+// FusionExecutorCache running on another thread, which holds its
+// runtimes_mutex_. A run sharing that mutex with other runs, see
+// [ Note -- Concurrent runs ], only evicts the runtimes of other caches. The
+// device of an evicted runtime is synchronized first, as its kernels might
+// still be running. Modules shared with other runtimes, see
+// [ Note -- Kernel deduplication ] in executor_utils.cpp, are counted by each
+// of them and only unloaded with the last one. Runtimes only enter the budget
+// once they ran, e.g. those created by warmup are not counted until then.
+// Evictions are counted by FusionExecutorCacheMetrics and by
+// runtimeCacheBudgetStats.
+
+class RuntimeCacheBudget {
+ public:
+  static RuntimeCacheBudget& get() {
+    static RuntimeCacheBudget budget;
+    return budget;
   }
 
-  int seq_id = 0;
-  // Record kernel input and output tensors so profiler can construct
-  // the data flow graph
-  RECORD_FUNCTION(
-      "run_fused_kernel",
-      std::vector<c10::IValue>(inputs.begin(), inputs.end()),
-      seq_id);
-  auto outputs = kernel_runtime->runWithInputs(args);
-  RECORD_OUTPUTS(outputs);
+  //! Move `kernel_runtime` of `owner`, which just ran, to the front of the
+  //! LRU list and evict the runtimes past the budget. The runtimes_mutex_ of
+  //! `owner` is held by the caller, exclusively if `owner_exclusive`.
+  void touch(
+      FusionExecutorCache* owner,
+      FusionKernelRuntime* kernel_runtime,
+      bool owner_exclusive) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    stats_.budget_bytes = budgetBytes();
+    auto position_it = positions_.find(kernel_runtime);
+    if (position_it == positions_.end()) {
+      lru_.push_front(Entry{owner, kernel_runtime});
+      position_it = positions_.emplace(kernel_runtime, lru_.begin()).first;
+    } else if (position_it->second != lru_.begin()) {
+      lru_.splice(lru_.begin(), lru_, position_it->second);
+    }
+    Entry& entry = lru_.front();
+    // The bytes are final once the kernels are compiled
+    if (!entry.compiled) {
+      stats_.host_bytes -= entry.host_bytes;
+      stats_.device_bytes -= entry.device_bytes;
+      entry.host_bytes = kernel_runtime->hostBytes();
+      entry.device_bytes = kernel_runtime->deviceModuleBytes();
+      entry.compiled = kernel_runtime->isCompiled();
+      stats_.host_bytes += entry.host_bytes;
+      stats_.device_bytes += entry.device_bytes;
+    }
 
-  // Kernel time measurement is off by default
-  kernel_runtime->disableKernelTimeMeasurement();
+    auto victim_it = std::prev(lru_.end());
+    while (stats_.host_bytes + stats_.device_bytes > stats_.budget_bytes &&
+           victim_it != lru_.begin()) {
+      auto next_it = std::prev(victim_it);
+      Entry victim = *victim_it;
+      std::unique_lock<std::shared_mutex> owner_lock;
+      if (victim.owner != owner) {
+        owner_lock = std::unique_lock<std::shared_mutex>(
+            victim.owner->runtimes_mutex_, std::try_to_lock);
+      }
+      if (victim.owner == owner ? owner_exclusive : owner_lock.owns_lock()) {
+        erase(victim_it);
+        stats_.evictions++;
+        stats_.evicted_bytes += victim.host_bytes + victim.device_bytes;
+        victim.owner->evictRuntime(victim.runtime);
+      }
+      victim_it = next_it;
+    }
+    stats_.num_runtimes = (int64_t)lru_.size();
+  }
 
-  // Removing aliased outputs, since those are updated by the Fusion. It is not
-  // semantically correct to actually return them as outputs from
-  // fusion.
-  NVF_ERROR(fusion->outputs().size() == outputs.size());
-  size_t new_size = 0;
-  for (size_t out_index = 0; out_index < outputs.size(); out_index++) {
-    Val* out = fusion->outputs()[out_index];
-    if (!fusion->getOutputAlias(out).hide_output) {
-      outputs[new_size] = outputs[out_index];
-      new_size++;
+  //! Stop tracking the runtimes of `owner`, which is being destroyed
+  void forget(FusionExecutorCache* owner) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    for (auto it = lru_.begin(); it != lru_.end();) {
+      auto next_it = std::next(it);
+      if (it->owner == owner) {
+        erase(it);
+      }
+      it = next_it;
     }
+    stats_.num_runtimes = (int64_t)lru_.size();
   }
-  outputs.resize(new_size);
 
-  // NOTE: This should be the last code in the method to capture all host time
-  if (isProfilerEnabled()) {
-    FusionProfiler::stop();
+  RuntimeCacheBudgetStats stats() {
+    std::lock_guard<std::mutex> guard(mutex_);
+    return stats_;
   }
-  if (isProfilerPrintingEnabled()) {
-    debug() << FusionProfiler::profile();
+
+ private:
+  struct Entry {
+    FusionExecutorCache* owner = nullptr;
+    FusionKernelRuntime* runtime = nullptr;
+    int64_t host_bytes = 0;
+    int64_t device_bytes = 0;
+    bool compiled = false;
+  };
+
+  static int64_t budgetBytes() {
+    int64_t budget_mib = 1024;
+    const auto& args =
+        getEnableOptionArguments(EnableOption::RuntimeCacheBudget);
+    if (!args.empty()) {
+      try {
+        budget_mib = std::stoll(args[0]);
+      } catch (const std::exception&) {
+        NVF_CHECK(false, "Invalid runtime cache budget: ", args[0]);
+      }
+    }
+    NVF_CHECK(budget_mib >= 0, "Invalid runtime cache budget: ", budget_mib);
+    return budget_mib << 20;
   }
 
-  return outputs;
+  void erase(std::list<Entry>::iterator it) {
+    stats_.host_bytes -= it->host_bytes;
+    stats_.device_bytes -= it->device_bytes;
+    positions_.erase(it->runtime);
+    lru_.erase(it);
+  }
+
+  std::mutex mutex_;
+  //! Most recently run first
+  std::list<Entry> lru_;
+  std::unordered_map<FusionKernelRuntime*, std::list<Entry>::iterator>
+      positions_;
+  RuntimeCacheBudgetStats stats_;
+};
+
+std::string RuntimeCacheBudgetStats::toString() const {
+  std::stringstream ss;
+  ss << "RuntimeCacheBudgetStats{budget_bytes=" << budget_bytes
+     << ", num_runtimes=" << num_runtimes << ", host_bytes=" << host_bytes
+     << ", device_bytes=" << device_bytes << ", evictions=" << evictions
+     << ", evicted_bytes=" << evicted_bytes << "}";
+  return ss.str();
 }
 
-std::string FusionExecutorCache::getCode(
-    FusionKernelRuntime* kernel_runtime,
-    bool intrinsic_code) const {
-  std::string kernel_code;
-  NVF_CHECK(kernel_runtime != nullptr, "Invalid fusion definition!");
-  NVF_CHECK(kernel_runtime->isCompiled(), "Fusion is not compiled!");
+RuntimeCacheBudgetStats runtimeCacheBudgetStats() {
+  return RuntimeCacheBudget::get().stats();
+}
 
-  bool first_kernel = true;
-  for (const auto& exec : kernel_runtime->executors()) {
-    if (first_kernel) {
+std::unique_ptr<CudaEventTimer> FusionExecutorCache::maybeStartKernelTimer(
+    int8_t device) {
+  if (sampled_timer_ != nullptr) {
+    if (!sampled_timer_->ready()) {
+      return nullptr;
+    }
+    metrics_.sampled_kernel_time_ns +=
+        static_cast<int64_t>(sampled_timer_->time() * 1e6);
+    metrics_.sampled_runs++;
+    sampled_timer_.reset();
+  }
+  const int64_t period = metricsSamplePeriod();
+  if (period == 0 || (metrics_.runs - 1) % period != 0) {
+    return nullptr;
+  }
+  auto timer = std::make_unique<CudaEventTimer>(
+      at::cuda::getCurrentCUDAStream(device));
+  timer->start();
+  return timer;
+}
+
+std::vector<at::Tensor> FusionExecutorCache::runFusionWithInputs(
+    const at::ArrayRef<c10::IValue>& inputs,
+    std::optional<PrimDataType> forced_index_type,
+    std::optional<int8_t> selected_device,
+    const std::vector<at::Tensor>& output_buffers) {
+  FUSER_PERF_SCOPE("FusionExecutorCache::runFusionWithInputs");
+  // NOTE: This should be the first code in the method to capture all host time
+  if (isProfilerEnabled()) {
+    FusionProfiler::start(!isProfilerEnabledWithCupti());
+  }
+
+  KernelArgumentHolder args = prepareInputs(inputs, selected_device);
+  return runPreparedArgs(args, forced_index_type, output_buffers);
+}
+
+std::vector<at::Tensor> FusionExecutorCache::runFusionWithArgs(
+    KernelArgumentHolder args,
+    std::optional<PrimDataType> forced_index_type,
+    const std::vector<at::Tensor>& output_buffers) {
+  FUSER_PERF_SCOPE("FusionExecutorCache::runFusionWithArgs");
+  // NOTE: This should be the first code in the method to capture all host time
+  if (isProfilerEnabled()) {
+    FusionProfiler::start(!isProfilerEnabledWithCupti());
+  }
+
+  prepareArgs(args);
+  return runPreparedArgs(args, forced_index_type, output_buffers);
+}
+
+namespace {
+
+// The inputs recorded by the autograd profiler
+std::vector<c10::IValue> toIValues(const KernelArgumentHolder& args) {
+  std::vector<c10::IValue> ivalues;
+  ivalues.reserve(args.size());
+  for (const auto& arg : args) {
+    if (arg->is<at::Tensor>()) {
+      ivalues.emplace_back(arg->as<at::Tensor>());
+    } else if (arg->is<int64_t>()) {
+      ivalues.emplace_back(arg->as<int64_t>());
+    } else if (arg->is<double>()) {
+      ivalues.emplace_back(arg->as<double>());
+    } else if (arg->is<bool>()) {
+      ivalues.emplace_back(arg->as<bool>());
+    } else if (arg->is<std::complex<double>>()) {
+      ivalues.emplace_back(
+          c10::complex<double>(arg->as<std::complex<double>>()));
+    } else {
+      ivalues.emplace_back();
+    }
+  }
+  return ivalues;
+}
+
+// [ Note -- Output buffers ]
+//
+// runFusionWithInputs can be given a tensor to write each returned output to,
+// e.g., a preallocated workspace of the caller. Each given buffer replaces the
+// allocation of its output by the segment producing it, so the kernel writes
+// the output there directly. Such a buffer must have the dtype, sizes and
+// strides the output would have been allocated with, which is checked when
+// the output is "allocated" by FusionExecutor. Broadcast dimensions are
+// exempt from the stride check.
+//
+// Some outputs are not allocated by a kernel: outputs aliasing an input or
+// another output, outputs evaluated with ATen, and any output of a run that
+// falls back to ATen while compiling. These outputs are copied to their
+// buffers after the run instead, which only requires the sizes to match. A
+// captured CUDA graph writes to the tensors it was captured with, so runs
+// given output buffers are never captured or replayed.
+
+// Returns the buffers indexed like the outputs of `fusion`, including the
+// hidden ones, which are never given a buffer
+std::vector<at::Tensor> fusionOutputBuffers(
+    Fusion* fusion,
+    const std::vector<at::Tensor>& output_buffers,
+    int8_t device_index) {
+  std::vector<at::Tensor> buffers;
+  if (output_buffers.empty()) {
+    return buffers;
+  }
+  buffers.resize(fusion->outputs().size());
+  size_t visible_index = 0;
+  for (auto out_index : c10::irange(fusion->outputs().size())) {
+    if (fusion->getOutputAlias(fusion->outputs().at(out_index)).hide_output) {
+      continue;
+    }
+    if (visible_index < output_buffers.size()) {
+      buffers.at(out_index) = output_buffers.at(visible_index);
+    }
+    visible_index++;
+  }
+  NVF_CHECK(
+      visible_index == output_buffers.size(),
+      "Expected one buffer for each of the ",
+      visible_index,
+      " outputs of the fusion, but got ",
+      output_buffers.size());
+  for (const at::Tensor& buffer : buffers) {
+    NVF_CHECK(
+        !buffer.defined() ||
+            (buffer.is_cuda() && buffer.get_device() == device_index),
+        "Output buffers must be on the device the fusion runs on, cuda:",
+        (int64_t)device_index);
+  }
+  return buffers;
+}
+
+// Copies the outputs that were not written to their buffers. See
+// [ Note -- Output buffers ].
+void copyToOutputBuffers(
+    std::vector<at::Tensor>& outputs,
+    const std::vector<at::Tensor>& buffers) {
+  for (auto i : c10::irange(buffers.size())) {
+    const at::Tensor& buffer = buffers.at(i);
+    if (!buffer.defined() || outputs.at(i).is_same(buffer)) {
+      continue;
+    }
+    NVF_CHECK(
+        outputs.at(i).sizes() == buffer.sizes(),
+        "The buffer of output ",
+        i,
+        " has sizes ",
+        buffer.sizes(),
+        " but the output has sizes ",
+        outputs.at(i).sizes());
+    buffer.copy_(outputs.at(i), /*non_blocking=*/true);
+    outputs.at(i) = buffer;
+  }
+}
+
+} // namespace
+
+// [ Note -- Request batching ]
+//
+// An inference server calling the same small fusion for many concurrent
+// requests, each with a few rows, launches tiny kernels that occupy a fraction
+// of the GPU. With NVFUSER_ENABLE=request_batching(<microseconds>), runs of a
+// FusionExecutorCache are coalesced instead:
+//   - The first run of a batch opens it and waits for the window, 100
+//     microseconds by default. Concurrent runs whose arguments have the same
+//     batch key, i.e. the same device, dtypes, sizes but for the leading
+//     dimension, and scalar values, join the open batch and block.
+//   - The first run then closes the batch, concatenates each tensor input of
+//     the runs along the leading dimension and runs the fusion once, as a
+//     single run with its own input id.
+//   - Each run gets the slices of the outputs made of its rows, as views of
+//     the batched outputs.
+//
+// Runs are not batched with a forced index type, output buffers or the
+// profiler, and fusions are only batched if their rows are independent, see
+// isBatchable. The arguments are never copied back, so fusions aliasing an
+// output to an input are not batched either.
+//
+// Each run may be on its own stream. The batched run waits for an event
+// recorded on the stream of each run when it joined, and each run's stream
+// waits for the batched run, whose outputs are recorded as used by that
+// stream for the caching allocator.
+//
+// Batching trades latency for throughput: every run waits for the window, the
+// concatenation of its inputs and the whole batched run, while the kernels
+// are launched once per batch. With NVFUSER_ENABLE=runtime_metrics,
+// batched_requests / request_batches gives the average batch size, which
+// should be well above one for the window to pay off.
+
+namespace {
+
+int64_t requestBatchingWindowUs() {
+  int64_t window_us = 100;
+  const auto& args = getEnableOptionArguments(EnableOption::RequestBatching);
+  if (!args.empty()) {
+    try {
+      window_us = std::stoll(args[0]);
+    } catch (const std::exception&) {
+      NVF_CHECK(false, "Invalid request batching window: ", args[0]);
+    }
+  }
+  NVF_CHECK(
+      window_us >= 0,
+      "Request batching window must not be negative, but got ",
+      window_us);
+  return window_us;
+}
+
+// The key of the runs `args` can be batched with, or std::nullopt if it can't
+// be batched. Tensors are keyed by all their sizes but the leading one, which
+// must be the same for all of them, and scalars by their value.
+std::optional<std::vector<int64_t>> batchKey(const KernelArgumentHolder& args) {
+  std::vector<int64_t> key;
+  key.push_back(args.getDeviceIndex());
+  std::optional<int64_t> num_rows = std::nullopt;
+  for (const auto& arg : args) {
+    if (arg->is<at::Tensor>()) {
+      const at::Tensor& tensor = arg->as<at::Tensor>();
+      if (!tensor.is_cuda() || tensor.dim() == 0 || tensor.size(0) == 0 ||
+          num_rows.value_or(tensor.size(0)) != tensor.size(0)) {
+        return std::nullopt;
+      }
+      num_rows = tensor.size(0);
+      key.push_back((int64_t)tensor.scalar_type());
+      key.push_back(tensor.dim());
+      key.insert(key.end(), tensor.sizes().begin() + 1, tensor.sizes().end());
+    } else if (arg->is<int64_t>()) {
+      key.push_back(arg->as<int64_t>());
+    } else if (arg->is<double>()) {
+      key.push_back(std::bit_cast<int64_t>(arg->as<double>()));
+    } else if (arg->is<bool>()) {
+      key.push_back(arg->as<bool>());
+    } else {
+      return std::nullopt;
+    }
+  }
+  if (!num_rows.has_value()) {
+    return std::nullopt;
+  }
+  return key;
+}
+
+} // namespace
+
+//! A batch of concurrent runs. See [ Note -- Request batching ]
+struct FusionExecutorCache::RequestBatch {
+  struct Request {
+    KernelArgumentHolder* args = nullptr;
+    //! Recorded on the stream of the run when it joined the batch
+    at::cuda::CUDAEvent inputs_ready;
+    std::vector<at::Tensor> outputs;
+  };
+  //! The first request is the one of the run executing the batch
+  std::vector<Request*> requests;
+  //! Recorded on the stream of the batched run after it
+  at::cuda::CUDAEvent outputs_ready;
+  bool done = false;
+  std::exception_ptr error;
+};
+
+bool FusionExecutorCache::isBatchable() {
+  std::call_once(batchable_flag_, [this]() {
+    Fusion* fusion = fusion_.get();
+    if (ir_utils::hasOpsOfType<RNGOp>(fusion)) {
+      return;
+    }
+    // The leading non-reduction logical axis of each input and output must be
+    // the rows, i.e. exactly mapped to each other
+    std::vector<IterDomain*> leading_ids;
+    for (Val* val : fusion->inputs()) {
+      auto* tv = dynamic_cast<TensorView*>(val);
+      if (tv == nullptr) {
+        continue;
+      }
+      if (tv->hasAllocation()) {
+        return;
+      }
+      leading_ids.push_back(nullptr);
+      for (IterDomain* id : tv->getLogicalDomain()) {
+        if (!id->isReduction()) {
+          leading_ids.back() = id;
+          break;
+        }
+      }
+    }
+    for (Val* val : fusion->outputs()) {
+      auto* tv = dynamic_cast<TensorView*>(val);
+      if (tv == nullptr ||
+          fusion->getOutputAlias(tv).type != AllocationType::New) {
+        return;
+      }
+      const std::vector<IterDomain*> logical =
+          TensorDomain::noReductions(tv->getLogicalDomain());
+      leading_ids.push_back(logical.empty() ? nullptr : logical.front());
+    }
+    if (leading_ids.empty() ||
+        std::any_of(
+            leading_ids.begin(), leading_ids.end(), [&](IterDomain* id) {
+              return id == nullptr || id->isBroadcast() ||
+                  (id != leading_ids.front() &&
+                   !exact_map_->areMapped(id, leading_ids.front()));
+            })) {
+      return;
+    }
+    // The rows must not be reduced, and their number must not be used as a
+    // value, e.g. to compute a mean over them
+    for (TensorView* tv : fusion->allTvs()) {
+      for (IterDomain* id : tv->getLogicalDomain()) {
+        if (id != leading_ids.front() &&
+            !exact_map_->areMapped(id, leading_ids.front())) {
+          continue;
+        }
+        if (id->isReduction() || !id->extent()->uses().empty()) {
+          return;
+        }
+      }
+    }
+    batchable_ = true;
+  });
+  return batchable_;
+}
+
+std::vector<at::Tensor> FusionExecutorCache::runBatched(
+    KernelArgumentHolder& args,
+    const std::vector<int64_t>& batch_key) {
+  FUSER_PERF_SCOPE("FusionExecutorCache::runBatched");
+  const int8_t device = args.getDeviceIndex();
+  const c10::cuda::CUDAStream stream = at::cuda::getCurrentCUDAStream(device);
+
+  RequestBatch::Request request;
+  request.args = &args;
+  request.inputs_ready.record(stream);
+
+  std::shared_ptr<RequestBatch> batch;
+  {
+    std::unique_lock<std::mutex> lock(batches_mutex_);
+    std::shared_ptr<RequestBatch>& open_batch = open_batches_[batch_key];
+    if (open_batch == nullptr) {
+      open_batch = std::make_shared<RequestBatch>();
+    }
+    batch = open_batch;
+    batch->requests.push_back(&request);
+    if (batch->requests.front() != &request) {
+      // Wait for the first run of the batch to execute it
+      batches_cv_.wait(lock, [&batch]() { return batch->done; });
+      if (batch->error) {
+        std::rethrow_exception(batch->error);
+      }
+      batch->outputs_ready.block(stream);
+      for (const at::Tensor& output : request.outputs) {
+        c10::cuda::CUDACachingAllocator::recordStream(
+            output.storage().data_ptr(), stream);
+      }
+      return std::move(request.outputs);
+    }
+  }
+
+  std::this_thread::sleep_for(
+      std::chrono::microseconds(requestBatchingWindowUs()));
+  {
+    std::lock_guard<std::mutex> lock(batches_mutex_);
+    open_batches_.erase(batch_key);
+    if (isOptionEnabled(EnableOption::RuntimeMetrics)) {
+      metrics_.batched_requests += (int64_t)batch->requests.size();
+      metrics_.request_batches++;
+    }
+  }
+
+  try {
+    const std::vector<RequestBatch::Request*>& requests = batch->requests;
+    std::vector<at::Tensor> outputs;
+    if (requests.size() == 1) {
+      outputs = runPreparedArgs(
+          args,
+          /*forced_index_type=*/std::nullopt,
+          /*output_buffers=*/{},
+          /*allow_batching=*/false);
+    } else {
+      c10::cuda::CUDAStreamGuard stream_guard(stream);
+      for (RequestBatch::Request* r : requests) {
+        r->inputs_ready.block(stream);
+      }
+      KernelArgumentHolder batched_args;
+      batched_args.setDeviceIndex(device);
+      for (auto i : c10::irange(args.size())) {
+        if (!args[i]->is<at::Tensor>()) {
+          batched_args.push(*args[i]);
+          continue;
+        }
+        std::vector<at::Tensor> rows;
+        rows.reserve(requests.size());
+        for (RequestBatch::Request* r : requests) {
+          rows.push_back((*r->args)[i]->as<at::Tensor>());
+        }
+        batched_args.push(at::cat(rows, 0));
+      }
+      prepareArgs(batched_args);
+      outputs = runPreparedArgs(
+          batched_args,
+          /*forced_index_type=*/std::nullopt,
+          /*output_buffers=*/{},
+          /*allow_batching=*/false);
+    }
+
+    // Split the outputs by the rows of each run
+    int64_t offset = 0;
+    for (RequestBatch::Request* r : requests) {
+      int64_t num_rows = 0;
+      for (const auto& arg : *r->args) {
+        if (arg->is<at::Tensor>()) {
+          num_rows = arg->as<at::Tensor>().size(0);
+          break;
+        }
+      }
+      r->outputs.reserve(outputs.size());
+      for (const at::Tensor& output : outputs) {
+        r->outputs.push_back(
+            requests.size() == 1 ? output
+                                 : output.narrow(0, offset, num_rows));
+      }
+      offset += num_rows;
+    }
+    batch->outputs_ready.record(stream);
+  } catch (...) {
+    batch->error = std::current_exception();
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(batches_mutex_);
+    batch->done = true;
+  }
+  batches_cv_.notify_all();
+  if (batch->error) {
+    std::rethrow_exception(batch->error);
+  }
+  return std::move(request.outputs);
+}
+
+// [ Note -- Concurrent runs ]
+//
+// A FusionExecutorCache may be run from several threads at once, e.g. by an
+// inference server running each request on its own stream. Runs hitting a
+// compiled runtime through their input id, the hottest path, share
+// runtimes_mutex_ and run in parallel. Every other run, i.e. one creating or
+// compiling a runtime, and the eviction of runtimes and input ids, hold it
+// exclusively. So do all runs while the state they update is not guarded
+// otherwise: with async compilations pending, with the profiler, kernel time
+// measurements, runtime metrics or CUDA graphs.
+//
+// Below the runtime lookup, the per-run state is kept out of shared objects:
+//   - FusionKernelRuntime only holds its mutex_ for its bookkeeping, not
+//     while the executors launch. The arena views and the L2 window of a
+//     launch are given to FusionExecutor::runFusion as LaunchBuffers rather
+//     than stored in the executor.
+//   - FusionExecutor holds its run_mutex_ only to look up or claim the
+//     ExecutorEntry of a launch and to update its kernels, e.g. for tiered
+//     compilation. An entry is initialized, which evaluates the launch from
+//     scratch, outside of the lock, with the cached PrecomputedValues if no
+//     other launch uses them and with its own otherwise. The kernel arguments
+//     of an entry are patched in place by one launch at a time. A concurrent
+//     launch with the same entry lays out its own copy.
+//   - A launch keeps the compiled kernel it launches, which a concurrent
+//     launch may replace, alive until it returns.
+std::vector<at::Tensor> FusionExecutorCache::runPreparedArgs(
+    KernelArgumentHolder& args,
+    std::optional<PrimDataType> forced_index_type,
+    const std::vector<at::Tensor>& output_buffers,
+    bool allow_batching) {
+  // See [ Note -- Request batching ]
+  if (allow_batching && isOptionEnabled(EnableOption::RequestBatching) &&
+      !forced_index_type.has_value() && output_buffers.empty() &&
+      !isProfilerEnabled() && isBatchable()) {
+    if (std::optional<std::vector<int64_t>> batch_key = batchKey(args)) {
+      return runBatched(args, batch_key.value());
+    }
+  }
+
+  // See [ Note -- Concurrent runs ] and [ Note -- Runtime cache budget ]
+  std::shared_lock<std::shared_mutex> shared_run(
+      runtimes_mutex_, std::defer_lock);
+  std::unique_lock<std::shared_mutex> exclusive_run(
+      runtimes_mutex_, std::defer_lock);
+  FusionKernelRuntime* kernel_runtime = nullptr;
+  if (canRunConcurrently()) {
+    shared_run.lock();
+    if (pending_compilations_.empty()) {
+      kernel_runtime = cachedKernelRuntime(args, forced_index_type);
+    }
+    if (kernel_runtime == nullptr || !kernel_runtime->isCompiled()) {
+      kernel_runtime = nullptr;
+      shared_run.unlock();
+    }
+  }
+  if (kernel_runtime == nullptr) {
+    exclusive_run.lock();
+    kernel_runtime = getKernelRuntimeFor(args, forced_index_type);
+  }
+  auto fusion = kernel_runtime->fusionSegments()->completeFusion();
+  const std::vector<at::Tensor> fusion_output_buffers =
+      fusionOutputBuffers(fusion, output_buffers, args.getDeviceIndex());
+
+  if (isProfilerEnabled()) {
+    FusionProfiler::createSegments(kernel_runtime->executors().size());
+  }
+
+  // See [ Note -- Runtime metrics ]
+  const bool collect_metrics = isOptionEnabled(EnableOption::RuntimeMetrics);
+  if (collect_metrics) {
+    metrics_.runs++;
+    metrics_.num_segments = (int64_t)kernel_runtime->executors().size();
+  }
+  if (exclusive_run.owns_lock()) {
+    kernel_runtime->collectMetrics(collect_metrics ? &metrics_ : nullptr);
+  }
+
+  std::optional<std::vector<at::Tensor>> fallback_outputs = std::nullopt;
+  if (isOptionEnabled(EnableOption::AsyncCompile) && !isProfilerEnabled()) {
+    fallback_outputs = runFallbackWhileCompiling(kernel_runtime, args);
+  }
+
+  if (!fallback_outputs.has_value() && !kernel_runtime->isCompiled()) {
+    const auto compile_start = std::chrono::steady_clock::now();
+    kernel_runtime->compileFusionParallel(args);
+    if (collect_metrics) {
+      metrics_.compile_time_ns += nanosecondsSince(compile_start);
+    }
+  }
+
+  most_recent_runtime_ = kernel_runtime;
+
+  // Make sure the forced index type is indeed used
+  if (forced_index_type.has_value()) {
+    NVF_ERROR(
+        kernel_runtime->getIndexType() == forced_index_type.value(),
+        "Enforcing index type of ",
+        forced_index_type.value(),
+        " failed");
+  }
+
+  int seq_id = 0;
+  // Record kernel input and output tensors so profiler can construct
+  // the data flow graph
+  RECORD_FUNCTION("run_fused_kernel", toIValues(args), seq_id);
+  std::vector<at::Tensor> outputs;
+  if (fallback_outputs.has_value()) {
+    outputs = std::move(fallback_outputs.value());
+  } else {
+    std::unique_ptr<CudaEventTimer> timer;
+    if (collect_metrics) {
+      metrics_.kernel_launches += (int64_t)kernel_runtime->executors().size();
+      timer = maybeStartKernelTimer(args.getDeviceIndex());
+    }
+    outputs = kernel_runtime->runWithInputs(args, fusion_output_buffers);
+    if (timer != nullptr) {
+      timer->stop();
+      sampled_timer_ = std::move(timer);
+    }
+    // Kernel time measurement is off by default
+    if (exclusive_run.owns_lock()) {
+      kernel_runtime->disableKernelTimeMeasurement();
+    }
+  }
+  copyToOutputBuffers(outputs, fusion_output_buffers);
+  RECORD_OUTPUTS(outputs);
+
+  // Removing aliased outputs, since those are updated by the Fusion. It is not
+  // semantically correct to actually return them as outputs from
+  // fusion.
+  NVF_ERROR(fusion->outputs().size() == outputs.size());
+  size_t new_size = 0;
+  for (size_t out_index = 0; out_index < outputs.size(); out_index++) {
+    Val* out = fusion->outputs()[out_index];
+    if (!fusion->getOutputAlias(out).hide_output) {
+      outputs[new_size] = outputs[out_index];
+      new_size++;
+    }
+  }
+  outputs.resize(new_size);
+
+  if (isOptionEnabled(EnableOption::RuntimeCacheBudget)) {
+    RuntimeCacheBudget::get().touch(
+        this, kernel_runtime, exclusive_run.owns_lock());
+  }
+
+  // NOTE: This should be the last code in the method to capture all host time
+  if (isProfilerEnabled()) {
+    FusionProfiler::stop();
+  }
+  if (isProfilerEnabledWithCupti()) {
+    kernel_runtime->recordSegmentTimes(FusionProfiler::profile());
+  }
+  if (isProfilerPrintingEnabled()) {
+    debug() << FusionProfiler::profile();
+  }
+  if (isProfilerPrintingRoofline() && isProfilerEnabledWithCupti()) {
+    debug() << FusionProfiler::profile().rooflineReport();
+  }
+  if (isProfilerPrintingEnabled() && isProfilerEnabledWithCupti() &&
+      hasEnableOptionArgument(EnableOption::KernelProfile, "regions")) {
+    debug() << FusionProfiler::profile().regionReport();
+  }
+
+  return outputs;
+}
+
+std::string FusionExecutorCache::getCode(
+    FusionKernelRuntime* kernel_runtime,
+    bool intrinsic_code) const {
+  std::string kernel_code;
+  NVF_CHECK(kernel_runtime != nullptr, "Invalid fusion definition!");
+  NVF_CHECK(kernel_runtime->isCompiled(), "Fusion is not compiled!");
+
+  bool first_kernel = true;
+  for (const auto& exec : kernel_runtime->executors()) {
+    if (first_kernel) {
       first_kernel = false;
     } else {
       kernel_code += "\n";
@@ -596,7 +1940,7 @@ std::string FusionExecutorCache::getCode(
 }
 
 std::string FusionExecutorCache::getMostRecentCode(bool intrinsic_code) const {
-  return getCode(most_recent_runtime_, intrinsic_code);
+  return getCode(getMostRecentKernelRuntime(), intrinsic_code);
 }
 
 std::string FusionExecutorCache::getCodeFor(
@@ -629,7 +1973,7 @@ std::string FusionExecutorCache::getScheduledIr(
 
 std::string FusionExecutorCache::getMostRecentScheduledIr(
     bool tensor_transforms) const {
-  return getScheduledIr(most_recent_runtime_, tensor_transforms);
+  return getScheduledIr(getMostRecentKernelRuntime(), tensor_transforms);
 }
 
 std::string FusionExecutorCache::getScheduledIrFor(
@@ -640,15 +1984,151 @@ std::string FusionExecutorCache::getScheduledIrFor(
   return getScheduledIr(kernel_runtime, tensor_transforms);
 }
 
+// [ Note -- Async compilation ]
+//
+// With NVFUSER_ENABLE=async_compile, a FusionKernelRuntime created for new
+// inputs is compiled on a background thread instead of blocking
+// runFusionWithInputs. Until the compilation finishes, every run of the
+// runtime evaluates a copy of its complete fusion with ExpressionEvaluator,
+// i.e. with ATen ops, which is slower but takes no compilation. The first run
+// after the compilation finishes switches to the compiled kernels.
+//
+// The compilation runs on its own thread rather than on getThreadPool(), so
+// that it does not hold a worker while it waits for its segments. Those are
+// compiled on the pool with TaskPriority::Normal, behind the segments of the
+// runs blocked on their compilation.
+//
+// The fallback is not used, and the run waits for the compilation instead,
+// if the fusion updates one of its inputs in place, or if evaluating it with
+// ATen fails, e.g. for an op without an ATen implementation. Runtimes being
+// compiled are not reused for other input shapes either, since reusing one
+// updates its launch parameters.
+std::optional<std::vector<at::Tensor>> FusionExecutorCache::
+    runFallbackWhileCompiling(
+        FusionKernelRuntime* kernel_runtime,
+        const KernelArgumentHolder& args) {
+  FUSER_PERF_SCOPE("FusionExecutorCache::runFallbackWhileCompiling");
+  auto it = pending_compilations_.find(kernel_runtime);
+  if (it == pending_compilations_.end()) {
+    if (kernel_runtime->isCompiled()) {
+      return std::nullopt;
+    }
+    PendingCompilation pending;
+    Fusion* fusion = kernel_runtime->fusionSegments()->completeFusion();
+    if (std::none_of(
+            fusion->outputs().begin(), fusion->outputs().end(), [&](Val* out) {
+              return fusion->getOutputAlias(out).type ==
+                  AllocationType::ReuseBuffer;
+            })) {
+      pending.fallback = std::make_unique<Fusion>(*fusion);
+    }
+    pending.compiled =
+        std::async(std::launch::async, [kernel_runtime, args]() {
+          const auto compile_start = std::chrono::steady_clock::now();
+          kernel_runtime->compileFusionParallel(args, TaskPriority::Normal);
+          return nanosecondsSince(compile_start);
+        });
+    it = pending_compilations_.emplace(kernel_runtime, std::move(pending))
+             .first;
+  } else if (
+      it->second.compiled.wait_for(std::chrono::seconds(0)) ==
+      std::future_status::ready) {
+    waitForCompilation(kernel_runtime);
+    return std::nullopt;
+  }
+
+  PendingCompilation& pending = it->second;
+  if (pending.fallback != nullptr) {
+    try {
+      FusionGuard fg(pending.fallback.get());
+      ExpressionEvaluator expr_eval =
+          executor_utils::bindInputs(args, pending.fallback.get());
+      std::vector<at::Tensor> outputs;
+      outputs.reserve(pending.fallback->outputs().size());
+      for (Val* out : pending.fallback->outputs()) {
+        outputs.push_back(expr_eval.evaluate(out).as<at::Tensor>());
+      }
+      return outputs;
+    } catch (const std::exception& e) {
+      if (isDebugDumpEnabled(DebugDumpOption::PerfDebugVerbose)) {
+        debug() << "Failed to evaluate fusion " << fusion_id_
+                << " while compiling: " << e.what() << std::endl;
+      }
+      pending.fallback = nullptr;
+    }
+  }
+  waitForCompilation(kernel_runtime);
+  return std::nullopt;
+}
+
+void FusionExecutorCache::waitForCompilation(
+    FusionKernelRuntime* kernel_runtime) {
+  auto it = pending_compilations_.find(kernel_runtime);
+  if (it == pending_compilations_.end()) {
+    return;
+  }
+  std::future<int64_t> compiled = std::move(it->second.compiled);
+  pending_compilations_.erase(it);
+  const int64_t compile_time_ns = compiled.get();
+  if (isOptionEnabled(EnableOption::RuntimeMetrics)) {
+    metrics_.compile_time_ns += compile_time_ns;
+  }
+}
+
+const SegmentationCache* FusionExecutorCache::segmentationCache(
+    int8_t device,
+    const DynamicTransformConcretizationInfo* conc_info) const {
+  auto it = segmentation_caches_.find(std::make_pair(device, conc_info));
+  return it == segmentation_caches_.end() ? nullptr : it->second.get();
+}
+
 void FusionExecutorCache::evictCache(size_t cache_id) {
   auto it = id_to_kernel_runtime_.find(cache_id);
   NVF_ERROR(it != id_to_kernel_runtime_.end());
+  waitForCompilation(it->second);
   it->second->evictCache(cache_id);
   id_to_kernel_runtime_.erase(it);
 }
 
+void FusionExecutorCache::evictRuntime(FusionKernelRuntime* kernel_runtime) {
+  waitForCompilation(kernel_runtime);
+  for (auto it = id_to_kernel_runtime_.begin();
+       it != id_to_kernel_runtime_.end();) {
+    it = it->second == kernel_runtime ? id_to_kernel_runtime_.erase(it)
+                                      : std::next(it);
+  }
+  for (auto it = shape_bucket_runtimes_.begin();
+       it != shape_bucket_runtimes_.end();) {
+    it = it->second.kernel_runtime == kernel_runtime
+        ? shape_bucket_runtimes_.erase(it)
+        : std::next(it);
+  }
+  if (most_recent_runtime_ == kernel_runtime) {
+    most_recent_runtime_ = nullptr;
+  }
+  for (auto& [config, kernel_runtimes] : kernel_runtimes_) {
+    auto it = std::find_if(
+        kernel_runtimes.begin(),
+        kernel_runtimes.end(),
+        [kernel_runtime](const std::unique_ptr<FusionKernelRuntime>& runtime) {
+          return runtime.get() == kernel_runtime;
+        });
+    if (it == kernel_runtimes.end()) {
+      continue;
+    }
+    // Its kernels might still be running
+    c10::cuda::CUDAGuard device_guard((c10::DeviceIndex)config.first);
+    NVFUSER_CUDA_RT_SAFE_CALL(cudaDeviceSynchronize());
+    kernel_runtimes.erase(it);
+    break;
+  }
+  if (isOptionEnabled(EnableOption::RuntimeMetrics)) {
+    metrics_.runtime_evictions++;
+  }
+}
+
 DynamicTransformInitialInfo& FusionExecutorCache::initialInfo() {
-  if (!initial_info_.has_value()) {
+  std::call_once(initial_info_flag_, [this]() {
     initial_info_ = DynamicTransform::getInitialInfo(fusion());
     fusion()->manage(
         "initial_info",
@@ -657,10 +2137,235 @@ DynamicTransformInitialInfo& FusionExecutorCache::initialInfo() {
           return std::any_cast<DynamicTransformInitialInfo>(data).clone(
               ir_cloner);
         });
-  }
+  });
   return initial_info_.value();
 }
 
+namespace {
+
+// [ Note -- Shape buckets ]
+//
+// With NVFUSER_ENABLE=shape_buckets(<size>), the heuristics used to pick or
+// create a FusionKernelRuntime for new inputs are computed for input extents
+// rounded up to a multiple of the bucket size, 64 by default. Runtimes are
+// then reused for all extents of a bucket, since the kernels only depend on
+// the actual extents through their predicates and launch parameters.
+//
+// Vectorization, however, is only valid for extents divisible by the
+// vectorization factor, and a factor chosen for the bucket boundary would not
+// be valid for every extent of the bucket. Extents are therefore rounded up to
+// the largest value of the bucket with the same power-of-two factor, up to
+// 16, as the actual extent. E.g., with a bucket size of 64, extents 1001 and
+// 1003 both map to 1023, and 1002 to 1022. With the bucket size being a
+// multiple of 16, this preserves which vectorization factors divide each
+// extent and the products of extents. Extents of 0 and 1 are kept since they
+// change the semantics of a dimension.
+//
+// Tensors are replaced by views of their data with the rounded sizes and the
+// same memory layout, which keeps the alignment of pointers. These views are
+// only used for their metadata and never accessed. Inputs are not bucketed if
+// a tensor is not dense, or if the fusion is dynamic, since concretization and
+// input scalars may relate extents to each other.
+//
+// Since the heuristics only see the bucketed arguments, they are the same for
+// all the inputs of a bucket with the same memory layout, types and pointer
+// alignments. The runtime picked for the first such inputs is therefore kept
+// with the launch params of its heuristics, keyed by the metadata of the
+// bucketed arguments. Later inputs falling in the bucket, even of unseen
+// shapes, only compute this key and reuse the runtime without running the
+// schedulers or comparing heuristics, so each bucket is a piece of the shape
+// space over which the heuristics are computed once. The launch params are
+// restored since sameAs ignores them and another bucket reusing the runtime
+// may have changed them.
+
+int64_t shapeBucketSize() {
+  int64_t bucket_size = 64;
+  const auto& args = getEnableOptionArguments(EnableOption::ShapeBuckets);
+  if (!args.empty()) {
+    try {
+      bucket_size = std::stoll(args[0]);
+    } catch (const std::exception&) {
+      NVF_CHECK(false, "Invalid shape bucket size: ", args[0]);
+    }
+  }
+  NVF_CHECK(
+      bucket_size > 0 && bucket_size % 16 == 0,
+      "Shape bucket size must be a positive multiple of 16, but got ",
+      bucket_size);
+  return bucket_size;
+}
+
+int64_t bucketExtent(int64_t extent, int64_t bucket_size) {
+  if (extent <= 1) {
+    return extent;
+  }
+  const int64_t bound = (extent + bucket_size - 1) / bucket_size * bucket_size;
+  // Largest power of two dividing the extent, at most 16
+  const int64_t factor = std::min(extent & -extent, (int64_t)16);
+  return factor == 16 ? bound : bound - factor;
+}
+
+// Key of the bucketed arguments `args` in shape_bucket_runtimes_: the
+// metadata the heuristics depend on. Like the input id, it ignores the values
+// of scalars.
+std::vector<int64_t> shapeBucketKey(
+    const KernelArgumentHolder& args,
+    std::optional<PrimDataType> forced_index_type) {
+  std::vector<int64_t> key;
+  key.push_back(args.getDeviceIndex());
+  key.push_back(
+      forced_index_type.has_value() ? (int64_t)forced_index_type.value() : -1);
+  for (const auto& arg : args) {
+    if (!arg->is<at::Tensor>()) {
+      key.push_back(-1);
+      continue;
+    }
+    const at::Tensor& tensor = arg->as<at::Tensor>();
+    key.push_back((int64_t)tensor.scalar_type());
+    key.push_back(tensor.dim());
+    key.insert(key.end(), tensor.sizes().begin(), tensor.sizes().end());
+    key.insert(key.end(), tensor.strides().begin(), tensor.strides().end());
+    key.push_back((int64_t)SchedulerRuntimeInfo::computeAlignmentSize(
+        (size_t)tensor.data_ptr()));
+  }
+  return key;
+}
+
+// Returns std::nullopt if the arguments cannot be bucketed. `bucket` is set to
+// the bucketed extents of all tensor arguments.
+std::optional<KernelArgumentHolder> bucketArgs(
+    const KernelArgumentHolder& args,
+    int64_t bucket_size,
+    std::vector<int64_t>& bucket) {
+  KernelArgumentHolder bucketed_args;
+  bucketed_args.setDeviceIndex(args.getDeviceIndex());
+  if (args.getCacheId().has_value()) {
+    bucketed_args.setCacheId(args.getCacheId().value());
+  }
+  bucket.clear();
+  for (const auto& arg : args) {
+    if (!arg->is<at::Tensor>() || !arg->as<at::Tensor>().is_cuda()) {
+      bucketed_args.push(*arg);
+      continue;
+    }
+    const at::Tensor& tensor = arg->as<at::Tensor>();
+    const int64_t ndims = tensor.dim();
+
+    // Dimensions from outermost to innermost, ignoring broadcast and expanded
+    // ones, whose strides do not matter
+    std::vector<int64_t> order;
+    for (auto i : c10::irange(ndims)) {
+      if (tensor.size(i) > 1 && tensor.stride(i) != 0) {
+        order.push_back(i);
+      }
+    }
+    std::stable_sort(order.begin(), order.end(), [&](int64_t a, int64_t b) {
+      return tensor.stride(a) > tensor.stride(b);
+    });
+
+    std::vector<int64_t> sizes = tensor.sizes().vec();
+    std::vector<int64_t> strides = tensor.strides().vec();
+    int64_t expected_stride = 1;
+    int64_t stride = 1;
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+      if (tensor.stride(*it) != expected_stride) {
+        return std::nullopt;
+      }
+      expected_stride *= tensor.size(*it);
+      sizes.at(*it) = bucketExtent(tensor.size(*it), bucket_size);
+      strides.at(*it) = stride;
+      stride *= sizes.at(*it);
+    }
+    for (auto i : c10::irange(ndims)) {
+      if (tensor.size(i) > 1 && tensor.stride(i) == 0) {
+        sizes.at(i) = bucketExtent(tensor.size(i), bucket_size);
+      }
+    }
+    bucket.insert(bucket.end(), sizes.begin(), sizes.end());
+
+    bucketed_args.push(at::from_blob(
+        tensor.data_ptr(), sizes, strides, [](void*) {}, tensor.options()));
+  }
+  return bucketed_args;
+}
+
+// [ Note -- Contiguity specialization ]
+//
+// Inputs declared with unknown or false contiguity are indexed with the div
+// and mod of each of their dimensions, even when the tensors they are given
+// are contiguous. With NVFUSER_ENABLE=contiguity_specialization, a new
+// FusionKernelRuntime is created from a copy of the fusion whose input
+// dimensions that are contiguous in the arguments are marked contiguous, so
+// that they are collapsed by contiguous indexing, e.g. into a flat 1-D index
+// for fully contiguous inputs. The contiguity flags of the runtime inputs
+// become part of its key: a runtime is only reused for arguments that
+// specialize to the same flags, and arguments that are not contiguous get a
+// runtime with the general indexing. Inputs with an allocation domain keep
+// their declared flags.
+
+// Contiguity of `tensor` for the flags `contiguity` of its logical domain,
+// with the false flags of the dimensions whose stride is the size times the
+// stride of the inner dimensions turned true. Size-1 dimensions flagged
+// contiguous may have any stride.
+std::vector<std::optional<bool>> specializeContiguity(
+    const std::vector<std::optional<bool>>& contiguity,
+    const at::Tensor& tensor) {
+  std::vector<std::optional<bool>> specialized = contiguity;
+  if ((int64_t)contiguity.size() != tensor.dim() || tensor.numel() == 0) {
+    return specialized;
+  }
+  int64_t contiguous_stride = 1;
+  for (int64_t i = tensor.dim() - 1; i >= 0; i--) {
+    std::optional<bool>& flag = specialized.at(i);
+    if (!flag.has_value()) {
+      continue;
+    }
+    if (!*flag && tensor.stride(i) == contiguous_stride) {
+      flag = true;
+    }
+    contiguous_stride =
+        (*flag ? contiguous_stride : tensor.stride(i)) * tensor.size(i);
+  }
+  return specialized;
+}
+
+// Contiguity flags of the tensor inputs of `fusion`, empty for other inputs.
+// If `args` is given, the flags are specialized to its tensors.
+std::vector<std::vector<std::optional<bool>>> inputContiguity(
+    Fusion* fusion,
+    const KernelArgumentHolder* args) {
+  std::vector<std::vector<std::optional<bool>>> contiguity;
+  contiguity.reserve(fusion->inputs().size());
+  for (auto i : c10::irange(fusion->inputs().size())) {
+    auto tv = dynamic_cast<TensorView*>(fusion->inputs().at(i));
+    if (tv == nullptr) {
+      contiguity.emplace_back();
+      continue;
+    }
+    if (args == nullptr || tv->hasAllocation() ||
+        !(*args)[i]->is<at::Tensor>()) {
+      contiguity.push_back(tv->getContiguity());
+      continue;
+    }
+    contiguity.push_back(specializeContiguity(
+        tv->getContiguity(), (*args)[i]->as<at::Tensor>()));
+  }
+  return contiguity;
+}
+
+void setInputContiguity(
+    Fusion* fusion,
+    const std::vector<std::vector<std::optional<bool>>>& contiguity) {
+  for (auto i : c10::irange(fusion->inputs().size())) {
+    if (auto tv = dynamic_cast<TensorView*>(fusion->inputs().at(i));
+        tv != nullptr && tv->getContiguity() != contiguity.at(i)) {
+      tv->setContiguity(contiguity.at(i));
+    }
+  }
+}
+
+} // namespace
+
 // getKernelRuntimeFor inspects the inputs to find a usable FusionKernelRuntime
 // as quickly as possible. To do so we cache at multiple levels:
 //   A. If we have seen these inputs before, we re-use the FusionKernelRuntime
@@ -690,6 +2395,32 @@ DynamicTransformInitialInfo& FusionExecutorCache::initialInfo() {
 // For re-used shapes, path 1 is most relevant. For dynamic shape problems with
 // a large number of unique shapes, path 2 is important. Paths 3 and 4 are slow
 // since they both involve re-segmentation and re-compilation of the Fusion.
+FusionKernelRuntime* FusionExecutorCache::cachedKernelRuntime(
+    const KernelArgumentHolder& args,
+    std::optional<PrimDataType> forced_index_type) const {
+  if (!args.getCacheId().has_value()) {
+    return nullptr;
+  }
+  auto id_it = id_to_kernel_runtime_.find(args.getCacheId().value());
+  if (id_it == id_to_kernel_runtime_.end()) {
+    return nullptr;
+  }
+  // If the forced index type is given, don't use the cached runtime
+  // if its index type does not match with the forced type
+  if (forced_index_type.has_value() &&
+      forced_index_type.value() != id_it->second->getIndexType()) {
+    return nullptr;
+  }
+  return id_it->second;
+}
+
+bool FusionExecutorCache::canRunConcurrently() const {
+  // See [ Note -- Concurrent runs ]
+  return !profiling_ && !measure_kernel_time_ && !isProfilerEnabled() &&
+      !isOptionEnabled(EnableOption::RuntimeMetrics) &&
+      !isOptionEnabled(EnableOption::CudaGraph);
+}
+
 FusionKernelRuntime* FusionExecutorCache::getKernelRuntimeFor(
     const KernelArgumentHolder& args,
     std::optional<PrimDataType> forced_index_type) {
@@ -700,14 +2431,12 @@ FusionKernelRuntime* FusionExecutorCache::getKernelRuntimeFor(
       unique_id_opt.has_value(),
       "KernelArgumentHolder has no cache ID in getKernelRuntimeFor");
   auto unique_id = *unique_id_opt;
-  auto id_it = id_to_kernel_runtime_.find(unique_id);
-  if (id_it != id_to_kernel_runtime_.end()) {
-    // If the forced index type is given, don't use the cached runtime
-    // if its index type does not match with the forced type
-    if (!forced_index_type.has_value() ||
-        forced_index_type.value() == id_it->second->getIndexType()) {
-      return id_it->second;
+  if (FusionKernelRuntime* kernel_runtime =
+          cachedKernelRuntime(args, forced_index_type)) {
+    if (isOptionEnabled(EnableOption::RuntimeMetrics)) {
+      metrics_.input_id_hits++;
     }
+    return kernel_runtime;
   }
 
   // Compute or get cached initial concretization info
@@ -735,6 +2464,49 @@ FusionKernelRuntime* FusionExecutorCache::getKernelRuntimeFor(
     deterministic_conc_info_.emplace_back(config);
   }
 
+  // Arguments used to compute heuristics. See [ Note -- Shape buckets ]
+  std::optional<KernelArgumentHolder> bucketed_args = std::nullopt;
+  std::vector<int64_t> bucket;
+  if (isOptionEnabled(EnableOption::ShapeBuckets) &&
+      !initial_info.isDynamic()) {
+    bucketed_args = bucketArgs(args, shapeBucketSize(), bucket);
+    if (bucketed_args.has_value()) {
+      shape_bucket_runtime_counts_.try_emplace(bucket, 0);
+    }
+  }
+  const KernelArgumentHolder& heuristics_args =
+      bucketed_args.has_value() ? bucketed_args.value() : args;
+
+  // Contiguity of the inputs of the runtime. See
+  // [ Note -- Contiguity specialization ]
+  const std::vector<std::vector<std::optional<bool>>> input_contiguity =
+      inputContiguity(
+          fusion_.get(),
+          isOptionEnabled(EnableOption::ContiguitySpecialization) ? &args
+                                                                  : nullptr);
+
+  // Runtime of a previously seen shape bucket. See [ Note -- Shape buckets ]
+  std::vector<int64_t> shape_bucket_key;
+  if (bucketed_args.has_value() &&
+      !isOptionDisabled(DisableOption::KernelReuse)) {
+    shape_bucket_key = shapeBucketKey(bucketed_args.value(), forced_index_type);
+    auto bucket_it = shape_bucket_runtimes_.find(shape_bucket_key);
+    // See [ Note -- Async compilation ]
+    if (bucket_it != shape_bucket_runtimes_.end() &&
+        !pending_compilations_.count(bucket_it->second.kernel_runtime) &&
+        bucket_it->second.kernel_runtime->inputContiguity() ==
+            input_contiguity) {
+      FusionKernelRuntime* kernel_runtime = bucket_it->second.kernel_runtime;
+      kernel_runtime->updateLaunchParams(bucket_it->second.launch_params);
+      if (isOptionEnabled(EnableOption::RuntimeMetrics)) {
+        metrics_.runtime_reuses++;
+        metrics_.shape_bucket_hits++;
+      }
+      id_to_kernel_runtime_[unique_id] = kernel_runtime;
+      return kernel_runtime;
+    }
+  }
+
   // Check for re-use hit case
   //  a kernel runtime is re-usable if all the compiled
   //  kernels have the same heuristic parameters
@@ -757,9 +2529,18 @@ FusionKernelRuntime* FusionExecutorCache::getKernelRuntimeFor(
     auto reuse_it = std::find_if(
         kernel_runtimes.begin(),
         kernel_runtimes.end(),
-        [&args, &new_heuristics, &forced_index_type](auto& kernel_runtime) {
-          auto maybe_heuristics =
-              kernel_runtime->getMaybeHeuristicsFor(args, forced_index_type);
+        [this,
+         &heuristics_args,
+         &new_heuristics,
+         &forced_index_type,
+         &input_contiguity](auto& kernel_runtime) {
+          // See [ Note -- Async compilation ]
+          if (pending_compilations_.count(kernel_runtime.get()) ||
+              kernel_runtime->inputContiguity() != input_contiguity) {
+            return false;
+          }
+          auto maybe_heuristics = kernel_runtime->getMaybeHeuristicsFor(
+              heuristics_args, forced_index_type);
           if (!maybe_heuristics.has_value()) {
             return false;
           }
@@ -772,6 +2553,13 @@ FusionKernelRuntime* FusionExecutorCache::getKernelRuntimeFor(
       reusing = true;
     }
   }
+  if (isOptionEnabled(EnableOption::RuntimeMetrics)) {
+    if (reusing) {
+      metrics_.runtime_reuses++;
+    } else {
+      metrics_.runtime_misses++;
+    }
+  }
 
   if (!reusing) {
     FUSER_PERF_SCOPE("FusionExecutorCache::getKernelRuntimeFor::!reusing");
@@ -805,32 +2593,171 @@ FusionKernelRuntime* FusionExecutorCache::getKernelRuntimeFor(
         conc_fusion->print();
       }
     }
+    setInputContiguity(conc_fusion.get(), input_contiguity);
+    SegmentationCache* segmentation_cache = nullptr;
+    if (isOptionEnabled(EnableOption::SegmentationCache)) {
+      auto& cache = segmentation_caches_[config];
+      if (cache == nullptr) {
+        cache = std::make_unique<SegmentationCache>();
+      }
+      segmentation_cache = cache.get();
+    }
     FusionGuard fg(conc_fusion.get());
-    kernel_runtimes.emplace_back(std::make_unique<FusionKernelRuntime>(
-        std::move(conc_fusion),
-        args,
-        /*serde_buffer=*/nullptr,
-        forced_index_type,
-        fusion_id_,
-        conc_info_id_map_.at(config),
-        kernel_runtimes.size(),
-        auto_schedule_));
+
+    // See [ Note -- Runtimes shared across devices ]
+    FusionKernelRuntime* peer_runtime = nullptr;
+    if (isOptionEnabled(EnableOption::ShareAcrossDevices)) {
+      peer_runtime = findPeerDeviceRuntime(
+          args.getDeviceIndex(),
+          conc_info,
+          heuristics_args,
+          input_contiguity,
+          forced_index_type);
+    }
+    flatbuffers::FlatBufferBuilder peer_builder;
+    const serde::FusionKernelRuntime* peer_buffer = nullptr;
+    if (peer_runtime != nullptr) {
+      peer_builder.Finish(peer_runtime->serialize(peer_builder));
+      peer_buffer = flatbuffers::GetRoot<serde::FusionKernelRuntime>(
+          peer_builder.GetBufferPointer());
+      // Without its segmentation, the segments would be found again and
+      // might not match the serialized executors
+      if (!peer_buffer->segmented_fusion()->valid()) {
+        peer_buffer = nullptr;
+      }
+    }
+
+    if (peer_buffer != nullptr) {
+      // The ids are those of the peer runtime, which name the kernels of the
+      // serialized binaries
+      kernel_runtimes.emplace_back(std::make_unique<FusionKernelRuntime>(
+          std::move(conc_fusion),
+          heuristics_args,
+          peer_buffer,
+          forced_index_type,
+          fusion_id_,
+          peer_buffer->concrete_id(),
+          peer_buffer->runtime_id(),
+          auto_schedule_));
+      kernel_runtimes.back()->deserialize(
+          peer_buffer, args.getDeviceIndex(), /*in_place=*/false);
+    } else {
+      kernel_runtimes.emplace_back(std::make_unique<FusionKernelRuntime>(
+          std::move(conc_fusion),
+          heuristics_args,
+          /*serde_buffer=*/nullptr,
+          forced_index_type,
+          fusion_id_,
+          conc_info_id_map_.at(config),
+          // Runtimes may have been evicted, see
+          // [ Note -- Runtime cache budget ]
+          kernel_runtimes.empty() ? 0
+                                  : kernel_runtimes.back()->runtimeId() + 1,
+          auto_schedule_,
+          segmentation_cache));
+    }
     kernel_runtime = kernel_runtimes.back().get();
 
     if (profiling_) {
       kernel_runtime->profile(true);
     }
+    if (bucketed_args.has_value()) {
+      shape_bucket_runtime_counts_.at(bucket)++;
+    }
   }
 
+  if (!shape_bucket_key.empty()) {
+    shape_bucket_runtimes_[shape_bucket_key] = {
+        kernel_runtime, kernel_runtime->launchParams()};
+  }
   id_to_kernel_runtime_[unique_id] = kernel_runtime;
   return kernel_runtime;
 }
 
+// [ Note -- Runtimes shared across devices ]
+//
+// kernel_runtimes_ is keyed by the device, so the first inputs of a given
+// shape on each GPU of a node segment, schedule and compile the whole fusion
+// again, even though the result is the same on GPUs of the same model.
+//
+// With NVFUSER_ENABLE=share_across_devices, a runtime missing on a device is
+// built from a compiled runtime of another device that has the same
+// concretization and accepts the inputs with the same heuristics. The peer
+// runtime is serialized to a temporary flatbuffer and deserialized for the
+// new device, as when loading a workspace: the segmentation is rebuilt from
+// the buffer without running the segmenter, and the executors reuse the
+// kernel code and binaries, so only the segments are lowered again and the
+// modules are loaded on the new device. A runtime whose segmentation is not
+// serializable is compiled as usual.
+//
+// Devices are of the same model if they have the same compute capability,
+// number of SMs, shared memory and registers, since heuristics and launch
+// parameters depend on them. The shared runtime keeps the concrete and
+// runtime ids of its peer, which name its kernels, so the ids of a runtime
+// are no longer its position in kernel_runtimes_ and are deserialized from
+// each runtime's table.
+
+namespace {
+
+bool isSameDeviceModel(int8_t lhs, int8_t rhs) {
+  const cudaDeviceProp* lhs_prop = at::cuda::getDeviceProperties(lhs);
+  const cudaDeviceProp* rhs_prop = at::cuda::getDeviceProperties(rhs);
+  return lhs_prop->major == rhs_prop->major &&
+      lhs_prop->minor == rhs_prop->minor &&
+      lhs_prop->multiProcessorCount == rhs_prop->multiProcessorCount &&
+      lhs_prop->sharedMemPerBlockOptin == rhs_prop->sharedMemPerBlockOptin &&
+      lhs_prop->regsPerBlock == rhs_prop->regsPerBlock;
+}
+
+} // namespace
+
+FusionKernelRuntime* FusionExecutorCache::findPeerDeviceRuntime(
+    int8_t device_index,
+    const DynamicTransformConcretizationInfo* conc_info,
+    const KernelArgumentHolder& args,
+    const std::vector<std::vector<std::optional<bool>>>& input_contiguity,
+    std::optional<PrimDataType> forced_index_type) {
+  FUSER_PERF_SCOPE("FusionExecutorCache::findPeerDeviceRuntime");
+  for (auto& [config, device_runtimes] : kernel_runtimes_) {
+    const int8_t peer_device = config.first;
+    if (peer_device == device_index ||
+        !PairPointerEquals()(
+            std::make_pair(peer_device, config.second),
+            std::make_pair(peer_device, conc_info)) ||
+        !isSameDeviceModel(peer_device, device_index)) {
+      continue;
+    }
+    for (auto& peer_runtime : device_runtimes) {
+      // See [ Note -- Async compilation ]
+      if (pending_compilations_.count(peer_runtime.get()) ||
+          !peer_runtime->isCompiled() ||
+          peer_runtime->inputContiguity() != input_contiguity) {
+        continue;
+      }
+      if (peer_runtime->getMaybeHeuristicsFor(args, forced_index_type)
+              .has_value()) {
+        return peer_runtime.get();
+      }
+    }
+  }
+  return nullptr;
+}
+
 flatbuffers::Offset<serde::FusionExecutorCache> FusionExecutorCache::serialize(
     flatbuffers::FlatBufferBuilder& builder) const {
   // See definitions in serde/fusion_cache.fbs for tables
   // FusionExecutorCache and KernelRuntimes
 
+  NVF_ERROR(
+      lazy_serde_buffer_ == nullptr || lazy_serde_done_,
+      "Lazily deserialized FusionExecutorCache must be deserialized before ",
+      "serializing it.");
+
+  // Runtimes compiled in the background are serialized once compiled
+  for (const auto& it : pending_compilations_) {
+    it.second.compiled.wait();
+  }
+
   // For serialization, we require a consistent ordering for the
   // kernel_runtimes_ map.
   std::unordered_map<FusionKernelRuntime*, size_t> kernel_cache_ordering;
@@ -887,12 +2814,33 @@ flatbuffers::Offset<serde::FusionExecutorCache> FusionExecutorCache::serialize(
       &kernel_cache_values);
 }
 
+// [ Note -- Lazy deserialization ]
+//
+// Deserializing a FusionExecutorCache rebuilds every FusionKernelRuntime it
+// held, which means concretizing and copying the fusion, rebuilding the
+// segmentation, lowering every segment, and loading every kernel module. A
+// process typically runs a small fraction of the fusions in a workspace.
+//
+// With NVFUSER_ENABLE=lazy_serde, FusionCache::deserialize maps the workspace
+// file instead of reading it and keeps the mapping alive. It rebuilds the
+// trie and the fusion definitions, but each FusionExecutorCache only keeps a
+// pointer to its table. The table is deserialized by ensureDeserialized,
+// which is first called when the cache looks up an input id, so untouched
+// fusions cost neither host memory nor module loads. Saving the workspace
+// deserializes the untouched caches first. Overwriting the workspace file
+// is safe, since serialize() writes a new file that replaces it. Only the
+// structure of the buffer is verified when it is loaded, so an incompatible
+// table only fails when its cache is first used.
+//
+// The unit of laziness is a FusionExecutorCache rather than one of its
+// runtimes. A new input id searches all runtimes of its concretization for
+// one whose heuristics can be reused, and the id-to-runtime table must be
+// complete before the InputsIdLookup starts evicting ids.
+
 void FusionExecutorCache::deserialize(
     const serde::FusionExecutorCache* buffer,
-    int64_t fusion_id) {
-  // See definitions in serde/fusion_cache.fbs for tables
-  // FusionExecutorCache and KernelRuntimes
-
+    int64_t fusion_id,
+    bool lazy) {
   NVF_ERROR(buffer != nullptr, "serde::FusionExecutorCache is nullptr.");
   NVF_ERROR(
       fusion_id == buffer->fusion_id(),
@@ -900,6 +2848,31 @@ void FusionExecutorCache::deserialize(
 
   fusion_id_ = buffer->fusion_id();
 
+  if (lazy) {
+    lazy_serde_buffer_ = buffer;
+    return;
+  }
+  deserializeRuntimes(buffer, /*in_place=*/false);
+}
+
+void FusionExecutorCache::ensureDeserialized() {
+  // lazy_serde_buffer_ is only set by deserialize, before any use of the cache
+  if (lazy_serde_buffer_ == nullptr) {
+    return;
+  }
+  std::call_once(lazy_serde_flag_, [this]() {
+    FUSER_PERF_SCOPE("FusionExecutorCache::ensureDeserialized");
+    deserializeRuntimes(lazy_serde_buffer_, /*in_place=*/true);
+    lazy_serde_done_ = true;
+  });
+}
+
+void FusionExecutorCache::deserializeRuntimes(
+    const serde::FusionExecutorCache* buffer,
+    bool in_place) {
+  // See definitions in serde/fusion_cache.fbs for tables
+  // FusionExecutorCache and KernelRuntimes
+
   inputs_id_lookup_.deserialize(buffer->inputs_cache());
 
   // For the id_to_kernel_runtime_ cache, we need a flat collection of all
@@ -968,6 +2941,13 @@ void FusionExecutorCache::deserialize(
           ((int64_t)args.getDeviceIndex()),
           ".");
 
+      // The kernels were compiled with the specialized contiguity. See
+      // [ Note -- Contiguity specialization ]
+      if (isOptionEnabled(EnableOption::ContiguitySpecialization)) {
+        setInputContiguity(
+            conc_fusion.get(), inputContiguity(conc_fusion.get(), &args));
+      }
+
       // 2. Construct new FusionKernelRuntime
       device_runtimes.emplace_back(std::make_unique<FusionKernelRuntime>(
           std::move(conc_fusion),
@@ -975,13 +2955,13 @@ void FusionExecutorCache::deserialize(
           fb_fusion_kernel_runtime,
           std::nullopt,
           fusion_id_,
-          fb_device_runtimes->concrete_id(),
-          device_runtimes.size()));
+          fb_fusion_kernel_runtime->concrete_id(),
+          fb_fusion_kernel_runtime->runtime_id()));
 
       // 3. For FusionKernelRuntime, we have a separate deserialize function
       // to create the FusionExecutor objects.
       device_runtimes.back()->deserialize(
-          fb_fusion_kernel_runtime, args.getDeviceIndex());
+          fb_fusion_kernel_runtime, args.getDeviceIndex(), in_place);
 
       all_runtimes.emplace_back(device_runtimes.back().get());
     }
@@ -1003,8 +2983,10 @@ FusionKernelRuntime::FusionKernelRuntime(
     int64_t fusion_id,
     int64_t concrete_id,
     int64_t runtime_id,
-    bool auto_schedule)
+    bool auto_schedule,
+    SegmentationCache* segmentation_cache)
     : args_metadata_{copyMetadataArg(args)},
+      input_contiguity_{inputContiguity(fusion.get(), /*args=*/nullptr)},
       fusion_id_{fusion_id},
       concrete_id_{concrete_id},
       runtime_id_{runtime_id},
@@ -1033,8 +3015,16 @@ FusionKernelRuntime::FusionKernelRuntime(
   if (serde_buffer == nullptr || !serde_buffer->segmented_fusion()->valid()) {
     // Default compilation path applies segmentation before scheduling and
     // compiling the fusion.
-    segmented_fusion_ =
-        SegmentCandidateFinder::segment(std::move(fusion), &args, runtime_info);
+    HostTimer segmentation_timer;
+    segmentation_timer.start();
+    segmented_fusion_ = SegmentCandidateFinder::segment(
+        std::move(fusion), &args, runtime_info, segmentation_cache);
+    segmentation_timer.stop();
+    segmentation_time_ms_ = segmentation_timer.time();
+    if (isDebugDumpEnabled(DebugDumpOption::FusionSegments)) {
+      debug() << "Segmentation took " << segmentation_time_ms_ << " ms"
+              << std::endl;
+    }
   } else {
     // Serialization path that generates segmented fusion from flatbuffers.
     // Convert Welford to two-pass if option is enabled and the original
@@ -1055,13 +3045,19 @@ FusionKernelRuntime::FusionKernelRuntime(
     if (has_welford_ops && has_persistent_heuristic) {
       SegmentCandidateFinder::translateWelfordInFusion(fusion.get(), args);
     }
+    // Split reductions are decided from the same arguments again
+    if (isOptionEnabled(EnableOption::SplitReduction) &&
+        segmented_groups->size() > 1) {
+      SegmentCandidateFinder::splitReductionsInFusion(
+          fusion.get(), runtime_info);
+    }
     segmented_fusion_ = std::make_unique<SegmentedFusion>(std::move(fusion));
     segmented_fusion_->deserialize(serde_buffer->segmented_fusion());
   }
 
   // Pre-compute the executor order so that the run time path
   //  would go directly to kernel launch.
-  prepareRuntimeOrder(segmented_fusion_.get(), runtime_workspace_);
+  prepareRuntimeOrder(segmented_fusion_.get(), runtime_workspace_, &args);
 
   executors_ = std::vector<FusionExecutor>(segmented_fusion_->groups().size());
   if (isDebugDumpEnabled(DebugDumpOption::FusionSegments)) {
@@ -1079,6 +3075,8 @@ FusionKernelRuntime::FusionKernelRuntime(
   heuristics_ = std::move(maybe_heuristics.value());
 }
 
+FusionKernelRuntime::~FusionKernelRuntime() = default;
+
 flatbuffers::Offset<serde::FusionKernelRuntime> FusionKernelRuntime::serialize(
     flatbuffers::FlatBufferBuilder& builder) const {
   // See table definition for FusionKernelRuntime in serde/fusion_cache.fbs
@@ -1107,7 +3105,8 @@ flatbuffers::Offset<serde::FusionKernelRuntime> FusionKernelRuntime::serialize(
 
 void FusionKernelRuntime::deserialize(
     const serde::FusionKernelRuntime* buffer,
-    int8_t device_index) {
+    int8_t device_index,
+    bool in_place) {
   // See table definition in FusionKernelRuntime in serde/fusion_cache.fbs
 
   NVF_ERROR(buffer != nullptr, "serde::FusionKernelRuntime is nullptr.");
@@ -1145,15 +3144,143 @@ void FusionKernelRuntime::deserialize(
         fusion_id_,
         concrete_id_,
         runtime_id_,
-        group_id);
+        group_id,
+        in_place);
   }
 }
 
+namespace {
+
+// FLOPs of the matmul ops of a segment, with 2 FLOPs per multiply-add. See
+// [ Note -- Roofline report ] in fusion_profiler.cpp. Returns 0 if an extent
+// cannot be inferred from the segment inputs.
+int64_t segmentFlops(SegmentedGroup* sg, const KernelArgumentHolder& args) {
+  std::vector<Expr*> matmuls;
+  std::copy_if(
+      sg->exprs().begin(),
+      sg->exprs().end(),
+      std::back_inserter(matmuls),
+      [](Expr* expr) { return expr->isOneOf<MmaOp, MatmulOp, LinearOp>(); });
+  if (matmuls.empty()) {
+    return 0;
+  }
+
+  ExpressionEvaluator expr_eval;
+  for (auto i : c10::irange(sg->inputs().size())) {
+    expr_eval.bind(sg->inputs().at(i), *args[i]);
+  }
+  auto product = [&expr_eval](const std::vector<IterDomain*>& ids) {
+    int64_t n = 1;
+    for (IterDomain* id : ids) {
+      if (id->isBroadcast()) {
+        continue;
+      }
+      PolymorphicValue extent = expr_eval.evaluate(id->extent());
+      if (!extent.hasValue()) {
+        return (int64_t)0;
+      }
+      n *= extent.as<int64_t>();
+    }
+    return n;
+  };
+
+  int64_t flops = 0;
+  for (Expr* expr : matmuls) {
+    auto out = expr->output(0)->as<TensorView>();
+    if (expr->isA<MmaOp>()) {
+      // The logical domain of the output includes the reduction dimension
+      flops += 2 * product(out->getLogicalDomain());
+      continue;
+    }
+    // MatmulOp and LinearOp contract the last dimension of their first input
+    auto in_a = TensorDomain::noReductions(
+        expr->input(0)->as<TensorView>()->getLogicalDomain());
+    flops += 2 *
+        product(TensorDomain::noReductions(out->getLogicalDomain())) *
+        product({in_a.back()});
+  }
+  return flops;
+}
+
+std::vector<int64_t> tensorSizes(const at::Tensor& tensor) {
+  return tensor.sizes().vec();
+}
+
+std::vector<std::vector<int64_t>> tensorSizes(
+    const KernelArgumentHolder& args) {
+  std::vector<std::vector<int64_t>> sizes;
+  for (auto i : c10::irange(args.size())) {
+    if (args[i]->is<at::Tensor>()) {
+      sizes.push_back(tensorSizes(args[i]->as<at::Tensor>()));
+    }
+  }
+  return sizes;
+}
+
+} // namespace
+
+namespace {
+
+// Rough host bytes of a Val or an Expr, with its IterDomains, attributes and
+// the containers referring to it
+constexpr int64_t kBytesPerStatement = 256;
+
+int64_t statementBytes(const Fusion* fusion) {
+  return kBytesPerStatement *
+      (int64_t)(fusion->vals().size() + fusion->unordered_exprs().size());
+}
+
+int64_t binaryBytes(const executor_utils::CompiledKernel& compiled_kernel) {
+  const serde::CudaKernel* buffer = compiled_kernel.serde_buffer;
+  if (buffer != nullptr) {
+    if (buffer->cubin() != nullptr) {
+      return (int64_t)buffer->cubin()->size();
+    }
+    return buffer->ptx() != nullptr ? (int64_t)buffer->ptx()->size() : 0;
+  }
+  const size_t bytes = compiled_kernel.cubin.empty()
+      ? compiled_kernel.ptx.size()
+      : compiled_kernel.cubin.size();
+  return (int64_t)bytes;
+}
+
+} // namespace
+
+int64_t FusionKernelRuntime::hostBytes() const {
+  int64_t bytes = statementBytes(segmented_fusion_->completeFusion());
+  for (const FusionExecutor& executor : executors_) {
+    if (!executor.hasCompiledKernel()) {
+      continue;
+    }
+    const executor_utils::CompiledKernel& compiled_kernel =
+        executor.compiledKernel();
+    bytes += statementBytes(executor.kernel()) +
+        (int64_t)executor.kernelString().size() +
+        (int64_t)(compiled_kernel.cubin.size() + compiled_kernel.ptx.size());
+  }
+  return bytes;
+}
+
+int64_t FusionKernelRuntime::deviceModuleBytes() const {
+  int64_t bytes = 0;
+  std::unordered_set<CUmodule> modules;
+  for (const FusionExecutor& executor : executors_) {
+    if (executor.hasCompiledKernel() &&
+        modules.insert(executor.compiledKernel().module).second) {
+      bytes += binaryBytes(executor.compiledKernel());
+    }
+  }
+  return bytes;
+}
+
 std::vector<at::Tensor> FusionKernelRuntime::runKernelWithInput(
     KernelArgumentHolder& args,
-    SegmentedGroup* sg) {
+    SegmentedGroup* sg,
+    const ArenaPlan* arena_plan,
+    const std::unordered_map<Val*, at::Tensor>& output_buffers,
+    std::optional<FusionExecutor::L2Window> l2_window) {
   FUSER_PERF_SCOPE("FusionKernelRuntime::runKernelWithInput");
-  std::lock_guard<std::mutex> guard(mutex_);
+  std::unique_lock<std::mutex> guard(mutex_);
   // This function will be called once on un-segmented fusion,
   // for segmented fusion, this function will be called on each segment
   // In the case of segmented fusion, segmented group needs to be given so
@@ -1177,13 +3304,91 @@ std::vector<at::Tensor> FusionKernelRuntime::runKernelWithInput(
   if (executor.groupId() < 0) {
     executor.setGroupId(group_id);
   }
-  auto outputs = executor.runFusion(args, launch_params, compile_params);
+  FusionExecutor::LaunchBuffers launch_buffers;
+  launch_buffers.l2_window = l2_window;
+  if (arena_plan != nullptr || !output_buffers.empty()) {
+    auto views = [this](const std::vector<ArenaBuffer>& buffers) {
+      std::vector<at::Tensor> tensors(buffers.size());
+      for (auto i : c10::irange(buffers.size())) {
+        if (buffers.at(i).offset >= 0) {
+          tensors.at(i) = arena_.view(buffers.at(i));
+        }
+      }
+      return tensors;
+    };
+    std::vector<at::Tensor>& outputs = launch_buffers.outputs;
+    if (arena_plan != nullptr) {
+      outputs = views(arena_plan->outputs.at(group_id));
+      launch_buffers.intermediates =
+          views(arena_plan->intermediates.at(group_id));
+    }
+    // See [ Note -- Output buffers ]. The outputs of the complete fusion are
+    // never placed in the arena.
+    for (auto i : c10::irange(sg->outputs().size())) {
+      auto it = output_buffers.find(sg->outputs().at(i));
+      if (it != output_buffers.end()) {
+        outputs.resize(std::max(outputs.size(), i + 1));
+        outputs.at(i) = it->second;
+      }
+    }
+  }
+  if (metrics_ != nullptr) {
+    metrics_->input_bytes += executor.inputBytesProcessed(args);
+  }
+  if (isProfilerEnabled()) {
+    FusionProfiler::segment(group_id).flopsProcessed(segmentFlops(sg, args));
+  }
+  // The executor guards its own state, see [ Note -- Concurrent runs ]
+  guard.unlock();
+  auto outputs = executor.runFusion(
+      args, launch_params, compile_params, {}, std::move(launch_buffers));
+  guard.lock();
+  if (metrics_ != nullptr) {
+    metrics_->output_bytes += executor.outputBytesProcessed(outputs);
+  }
+  // See [ Note -- Segmentation cost model ]
+  if (isProfilerEnabledWithCupti() && getSegmentationCostModel() != nullptr) {
+    auto hash_it = segment_structure_hashes_.find(group_id);
+    if (hash_it == segment_structure_hashes_.end()) {
+      auto fusion = segmented_fusion_->makeFusion(sg).second;
+      hash_it = segment_structure_hashes_
+                    .emplace(group_id, segmentStructureHash(fusion.get()))
+                    .first;
+    }
+    std::vector<std::vector<int64_t>> output_sizes;
+    for (const at::Tensor& output : outputs) {
+      output_sizes.push_back(tensorSizes(output));
+    }
+    segment_cost_keys_[group_id] = segmentCostKey(
+        hash_it->second,
+        scheduler_entry->heuristic(),
+        tensorSizes(args),
+        std::move(output_sizes));
+  }
 
   return outputs;
 }
 
+void FusionKernelRuntime::recordSegmentTimes(const FusionProfile& profile) {
+  SegmentationCostModel* model = getSegmentationCostModel();
+  if (model == nullptr) {
+    return;
+  }
+  std::lock_guard<std::mutex> guard(mutex_);
+  for (const KernelProfile& kernel_profile : profile.kernel_profiles) {
+    auto key_it = segment_cost_keys_.find((int64_t)kernel_profile.segment_id);
+    if (key_it == segment_cost_keys_.end() || kernel_profile.time_ms <= 0.0) {
+      continue;
+    }
+    model->recordTimeUs(key_it->second, kernel_profile.time_ms * 1.0e3);
+  }
+  segment_cost_keys_.clear();
+}
+
 // passing args by value because we will be modify this
-void FusionKernelRuntime::compileFusionParallel(KernelArgumentHolder args) {
+void FusionKernelRuntime::compileFusionParallel(
+    KernelArgumentHolder args,
+    TaskPriority priority) {
   std::lock_guard<std::mutex> guard(mutex_);
 
   NVF_ERROR(
@@ -1205,9 +3410,13 @@ void FusionKernelRuntime::compileFusionParallel(KernelArgumentHolder args) {
     FusionProfiler::startCompile();
   }
 
+  const bool batch_compile =
+      num_groups > 1 && isOptionEnabled(EnableOption::BatchCompile);
+
   std::atomic<bool> detect_exception_in_thread_pool{false};
   std::string thread_pool_error_message;
   std::mutex thread_pool_error_message_mutex;
+  TaskGroup compilations(priority);
   for (int64_t run_order_id = 0; run_order_id < num_groups; ++run_order_id) {
     auto group_to_run = runtime_workspace_.group_run_order.at(run_order_id);
 
@@ -1222,6 +3431,14 @@ void FusionKernelRuntime::compileFusionParallel(KernelArgumentHolder args) {
       group_runtime_inputs.push(*args_manager.checkTensorMap(input));
     }
 
+    if (isOptionEnabled(EnableOption::Autotune)) {
+      autotuneSegment(group_runtime_inputs, group_to_run);
+    }
+
+    if (batch_compile) {
+      executors_.at(group_to_run->groupId()).deferKernelCompilation();
+    }
+
     if (num_groups == 1 || isOptionDisabled(DisableOption::ParallelCompile)) {
       FUSER_PERF_SCOPE("FusionKernelRuntime::compileFusionParallel");
       c10::cuda::CUDAGuard dg(args.getDeviceIndex());
@@ -1229,13 +3446,13 @@ void FusionKernelRuntime::compileFusionParallel(KernelArgumentHolder args) {
       compileKernel(group_runtime_inputs, group_to_run);
     } else {
       // launch compileKernel thread here
-      getThreadPool()->run([this,
-                            args,
-                            group_runtime_inputs,
-                            group_to_run,
-                            &detect_exception_in_thread_pool,
-                            &thread_pool_error_message,
-                            &thread_pool_error_message_mutex]() {
+      compilations.run([this,
+                        args,
+                        group_runtime_inputs,
+                        group_to_run,
+                        &detect_exception_in_thread_pool,
+                        &thread_pool_error_message,
+                        &thread_pool_error_message_mutex]() {
         FUSER_PERF_SCOPE("FusionKernelRuntime::compileFusionParallel");
         try {
           c10::cuda::CUDAGuard dg(args.getDeviceIndex());
@@ -1268,7 +3485,7 @@ void FusionKernelRuntime::compileFusionParallel(KernelArgumentHolder args) {
 
   if (num_groups != 1 && !isOptionDisabled(DisableOption::ParallelCompile)) {
     // Wait until all segments finish compiling
-    getThreadPool()->waitWorkComplete();
+    compilations.wait();
     NVF_ERROR(
         !detect_exception_in_thread_pool.load(),
         "Detected exception while compiling fusion segments in parallel. ",
@@ -1276,11 +3493,90 @@ void FusionKernelRuntime::compileFusionParallel(KernelArgumentHolder args) {
         thread_pool_error_message,
         "\nUse NVFUSER_DISABLE=parallel_compile to simplify error message.");
   }
+  if (batch_compile) {
+    compileDeferredKernels(args.getDeviceIndex());
+  }
   if (isProfilerEnabled()) {
     FusionProfiler::stopCompile();
   }
 }
 
+// [ Note -- Batched compilation ]
+//
+// Each segment kernel is normally compiled as its own NVRTC program, and each
+// program pays for parsing the preamble before the kernel. With
+// NVFUSER_ENABLE=batch_compile, compileFusionParallel still lowers the
+// segments in parallel, but FusionExecutor::compileFusion stops before NVRTC.
+// The deferred kernels are then grouped by the code preceding them, which
+// includes the index type, and by their compile options. Each group is
+// compiled as one program containing all its kernels and loaded as one
+// module, whose functions are resolved by each executor. The module is
+// unloaded along with the last of its kernels.
+//
+// Grouping on the register count derived from the block size, rather than on
+// the block size itself, lets kernels with different block sizes share a
+// program as long as ptxas is given the same options. Batched kernels do not
+// go through the kernel db, which is keyed by the code of a single kernel.
+//
+// This trades the parallelism of compiling segments on the thread pool for a
+// single frontend pass, so it pays off for fusions split into many small
+// segments. An executor recompiling its kernel later, e.g., for a larger
+// block size, compiles it on its own.
+
+void FusionKernelRuntime::compileDeferredKernels(int8_t device_index) {
+  FUSER_PERF_SCOPE("FusionKernelRuntime::compileDeferredKernels");
+  c10::cuda::CUDAGuard dg(device_index);
+
+  // Executors whose kernels can share a program, in group order
+  std::map<std::string, std::vector<FusionExecutor*>> batches;
+  for (auto& executor : executors_) {
+    const auto& pending = executor.pendingCompilation();
+    if (!pending.has_value()) {
+      continue;
+    }
+    const std::optional<size_t> kernel_begin =
+        executor_utils::kernelBegin(pending->structured_code);
+    if (!kernel_begin.has_value()) {
+      // E.g., the code was loaded from NVFUSER_EXTERNAL_SRC
+      executor.finishCompilation();
+      continue;
+    }
+    std::stringstream key;
+    key << pending->compile_params.toString() << "registers = "
+        << executor_utils::getMaxRegCount(
+               pending->block_size, pending->compile_params.maxrregcount)
+               .value_or(-1)
+        << "\n"
+        << std::string_view(pending->structured_code).substr(0, *kernel_begin);
+    batches[key.str()].push_back(&executor);
+  }
+
+  for (auto& [key, executors] : batches) {
+    if (executors.size() == 1) {
+      executors.front()->finishCompilation();
+      continue;
+    }
+    std::vector<std::string> full_src_codes;
+    std::vector<std::string> func_names;
+    std::vector<std::optional<int64_t>> block_sizes;
+    for (auto executor : executors) {
+      const auto& pending = executor->pendingCompilation();
+      full_src_codes.push_back(pending->structured_code);
+      func_names.push_back(executor->kernelName());
+      block_sizes.push_back(pending->block_size);
+    }
+    auto compiled_kernels = executor_utils::getCompiledKernels(
+        full_src_codes,
+        func_names,
+        executors.front()->kernelName(),
+        executors.front()->pendingCompilation()->compile_params,
+        block_sizes);
+    for (auto i : c10::irange(executors.size())) {
+      executors.at(i)->finishCompilation(std::move(compiled_kernels.at(i)));
+    }
+  }
+}
+
 void FusionKernelRuntime::compileKernel(
     const KernelArgumentHolder& args,
     SegmentedGroup* sg) {
@@ -1300,6 +3596,7 @@ void FusionKernelRuntime::compileKernel(
   }
   FusionGuard fg(fusion_to_run.get());
   if (auto_schedule_) {
+    FUSER_PERF_SCOPE("FusionKernelRuntime::compileKernel::schedule");
     scheduler_entry->schedule(fusion_to_run.get());
   }
   NVF_ERROR(
@@ -1317,6 +3614,244 @@ void FusionKernelRuntime::compileKernel(
       group_id);
 }
 
+// [ Note -- Autotuning ]
+//
+// The pointwise, reduction and persistent heuristics are analytic and can be
+// far from the best parameters for unusual shapes. With
+// NVFUSER_ENABLE=autotune, compileFusionParallel searches the parameters of
+// every such segment before compiling its kernel:
+//   - Candidates are derived from the analytic parameters by varying the
+//     unroll and vectorization factors, the persistent batch size of inner
+//     persistent kernels and the grid binding of 2D pointwise schedules. See
+//     autotune::candidateParams.
+//   - All candidates are scheduled and compiled on the thread pool.
+//   - Each one is run once on the segment inputs, with zero-filled tensors
+//     standing in for the intermediates produced by earlier segments. Its
+//     outputs are compared to those of the analytic kernel, then it is timed
+//     over a few launches with CudaEventTimer.
+//   - Candidates failing to compile, launch or match the analytic outputs are
+//     dropped, and the fastest remaining one replaces the parameters of the
+//     scheduler entry.
+//
+// The winner is stored in the TuningDb, keyed by the segment IR, the
+// heuristic, the input sizes, strides and types and the device. When
+// heuristics are computed for a segment, getMaybeHeuristicsFor applies the
+// parameters found in the db, so later runtimes and processes skip the search
+// and a runtime tuned for some inputs is reused for inputs with the same
+// tuned parameters.
+//
+// Segments writing their outputs in place of an input are not tuned since the
+// candidates would run several times on the same inputs. Tuning is skipped
+// as well while profiling, and with tiered compilation whose first kernels
+// are not representative of the final ones.
+
+namespace {
+
+//! Arguments to run the candidates of a segment. Segment inputs produced by
+//! earlier segments are only known by their metadata at compile time, so they
+//! are replaced by zero-filled tensors.
+KernelArgumentHolder tuningArgs(const KernelArgumentHolder& args) {
+  KernelArgumentHolder tuning_args;
+  tuning_args.setDeviceIndex(args.getDeviceIndex());
+  for (auto i : c10::irange(args.size())) {
+    const PolymorphicValue* arg = args[i];
+    if (!arg->is<at::Tensor>() || !arg->as<at::Tensor>().is_meta()) {
+      tuning_args.push(*arg);
+      continue;
+    }
+    const auto& meta_tensor = arg->as<at::Tensor>();
+    // Expanded dimensions have a zero stride, so allocate the extent of the
+    // storage and view it with the strides of the tensor
+    int64_t storage_size = 1;
+    for (auto dim : c10::irange(meta_tensor.dim())) {
+      if (meta_tensor.size(dim) == 0) {
+        storage_size = 0;
+        break;
+      }
+      storage_size += (meta_tensor.size(dim) - 1) * meta_tensor.stride(dim);
+    }
+    auto options = meta_tensor.options().device(
+        c10::DeviceType::CUDA, args.getDeviceIndex());
+    at::Tensor storage = at::zeros({storage_size}, options);
+    tuning_args.push(
+        storage.as_strided(meta_tensor.sizes(), meta_tensor.strides()));
+  }
+  return tuning_args;
+}
+
+//! Whether a candidate computes the outputs of the analytic kernel. Reduction
+//! candidates may accumulate in a different order.
+bool sameOutputs(
+    const std::vector<at::Tensor>& outputs,
+    const std::vector<at::Tensor>& reference) {
+  if (outputs.size() != reference.size()) {
+    return false;
+  }
+  for (auto i : c10::irange(outputs.size())) {
+    const at::Tensor& out = outputs.at(i);
+    const at::Tensor& ref = reference.at(i);
+    if (out.sizes() != ref.sizes()) {
+      return false;
+    }
+    bool same = at::isFloatingType(ref.scalar_type()) ||
+            at::isComplexType(ref.scalar_type())
+        ? at::allclose(out, ref, 1e-2, 1e-3, /*equal_nan=*/true)
+        : at::equal(out, ref);
+    if (!same) {
+      return false;
+    }
+  }
+  return true;
+}
+
+//! Replace the parameters of `scheduler_entry` with those found in the tuning
+//! db for its segment, if any
+void applyTunedParams(
+    SchedulerEntry* scheduler_entry,
+    Fusion* fusion,
+    const KernelArgumentHolder& args) {
+  const ScheduleHeuristic heuristic = scheduler_entry->heuristic();
+  if (!autotune::isTunable(heuristic)) {
+    return;
+  }
+  std::optional<std::string> encoded_params = TuningDb::get().query(
+      autotune::tuningKey(fusion, heuristic, args));
+  if (!encoded_params.has_value()) {
+    return;
+  }
+  if (auto params = autotune::decodeParams(
+          heuristic, *scheduler_entry->params(), encoded_params.value())) {
+    scheduler_entry->setParams(std::move(params));
+  }
+}
+
+} // namespace
+
+void FusionKernelRuntime::autotuneSegment(
+    const KernelArgumentHolder& args,
+    SegmentedGroup* sg) {
+  FUSER_PERF_SCOPE("FusionKernelRuntime::autotuneSegment");
+  constexpr int64_t num_timed_runs = 5;
+
+  auto group_id = sg->groupId();
+  auto scheduler_entry = schedulers().at(group_id).get();
+  const ScheduleHeuristic heuristic = scheduler_entry->heuristic();
+  if (!auto_schedule_ || !autotune::isTunable(heuristic) ||
+      isProfilerEnabled() || isOptionEnabled(EnableOption::TieredCompile)) {
+    return;
+  }
+  Fusion* segment_fusion = sg->getFusion();
+  if (std::any_of(
+          segment_fusion->outputs().begin(),
+          segment_fusion->outputs().end(),
+          [segment_fusion](Val* out) {
+            return segment_fusion->getOutputAlias(out).type !=
+                AllocationType::New;
+          })) {
+    return;
+  }
+
+  TuningDb& tuning_db = TuningDb::get();
+  const uint64_t key = autotune::tuningKey(segment_fusion, heuristic, args);
+  if (tuning_db.query(key).has_value()) {
+    // Already applied by getMaybeHeuristicsFor
+    return;
+  }
+
+  std::vector<std::shared_ptr<HeuristicParams>> candidates =
+      autotune::candidateParams(heuristic, *scheduler_entry->params());
+  KernelArgumentHolder tuning_args = tuningArgs(args);
+
+  // Candidates failing to compile are left null
+  std::vector<std::unique_ptr<FusionExecutor>> candidate_executors(
+      candidates.size());
+  auto compile_candidate = [&](size_t i) {
+    try {
+      c10::cuda::CUDAGuard dg(args.getDeviceIndex());
+      auto fusion_to_run = segmented_fusion_->makeFusion(sg).second;
+      FusionGuard fg(fusion_to_run.get());
+      autotune::scheduleWith(heuristic, fusion_to_run.get(), *candidates.at(i));
+      auto executor = std::make_unique<FusionExecutor>();
+      executor->compileFusion(
+          fusion_to_run.get(),
+          tuning_args,
+          candidates.at(i)->lparams,
+          candidates.at(i)->cparams,
+          heuristic,
+          fusion_id_,
+          concrete_id_,
+          runtime_id_,
+          group_id);
+      candidate_executors.at(i) = std::move(executor);
+    } catch (const std::exception&) {
+    }
+  };
+  if (isOptionDisabled(DisableOption::ParallelCompile)) {
+    for (auto i : c10::irange(candidates.size())) {
+      compile_candidate(i);
+    }
+  } else {
+    // Behind the compiles of the runs blocked on them
+    TaskGroup candidate_compilations(TaskPriority::Background);
+    for (auto i : c10::irange(candidates.size())) {
+      candidate_compilations.run(
+          [&compile_candidate, i]() { compile_candidate(i); });
+    }
+    candidate_compilations.wait();
+  }
+
+  c10::cuda::CUDAGuard dg(args.getDeviceIndex());
+  cudaStream_t stream =
+      c10::cuda::getCurrentCUDAStream((c10::DeviceIndex)args.getDeviceIndex())
+          .stream();
+  std::vector<at::Tensor> reference;
+  std::optional<size_t> best;
+  double best_ms = 0.0;
+  for (auto i : c10::irange(candidates.size())) {
+    FusionExecutor* executor = candidate_executors.at(i).get();
+    if (executor == nullptr || (i > 0 && reference.empty())) {
+      continue;
+    }
+    const LaunchParams& lparams = candidates.at(i)->lparams;
+    const CompileParams& cparams = candidates.at(i)->cparams;
+    try {
+      std::vector<at::Tensor> outputs =
+          executor->runFusion(tuning_args, lparams, cparams);
+      if (i == 0) {
+        reference = outputs;
+      } else if (!sameOutputs(outputs, reference)) {
+        continue;
+      }
+      CudaEventTimer timer(stream);
+      timer.start();
+      for ([[maybe_unused]] auto run : c10::irange(num_timed_runs)) {
+        executor->runFusion(tuning_args, lparams, cparams, outputs);
+      }
+      timer.stop();
+      const double ms = timer.time() / num_timed_runs;
+      if (!best.has_value() || ms < best_ms) {
+        best = i;
+        best_ms = ms;
+      }
+      if (isDebugDumpEnabled(DebugDumpOption::PerfDebugVerbose)) {
+        debug() << "Autotuning segment " << group_id << ", candidate " << i
+                << ": " << ms << " ms"
+                << candidates.at(i)->toString() << std::endl;
+      }
+    } catch (const std::exception&) {
+    }
+  }
+  if (!best.has_value()) {
+    // Not even the analytic kernel could run, leave it to compileKernel to
+    // report the error
+    return;
+  }
+
+  scheduler_entry->setParams(candidates.at(best.value()));
+  tuning_db.write(
+      key, autotune::encodeParams(heuristic, *candidates.at(best.value())));
+}
+
 std::pair<LaunchParams, CompileParams> FusionKernelRuntime::getKernelConfig(
     const KernelArgumentHolder& args,
     SegmentedGroup* sg) {
@@ -1330,17 +3865,322 @@ std::pair<LaunchParams, CompileParams> FusionKernelRuntime::getKernelConfig(
       scheduler_entry->params()->lparams, scheduler_entry->params()->cparams);
 }
 
-std::vector<at::Tensor> FusionKernelRuntime::runWithInputs(
+// [ Note -- CUDA graph mode ]
+//
+// With NVFUSER_ENABLE=cuda_graph, the first run of a FusionKernelRuntime with
+// a given input id captures the kernel launches of all its segments into a
+// CUDA graph. Subsequent runs with the same input id replay that graph with a
+// single cudaGraphLaunch, skipping the host-side work of argument binding,
+// allocation and per-segment launches.
+//
+// Every buffer allocated while capturing, i.e., segment outputs,
+// intermediates and zero-initialized work buffers, is retained by the graph
+// and reused by each replay. As a consequence the fusion outputs returned in
+// this mode are static buffers that are overwritten by the next replay with
+// the same input id.
+//
+// The input id only encodes the shapes and strides of the inputs, so at
+// replay time:
+//   - The data pointers of tensor inputs are patched into the kernel nodes of
+//     the graph. This needs cuGraphExecKernelNodeSetParams on the CUDA 12
+//     kernel node parameters, so the mode is not available with older
+//     toolkits.
+//   - Scalar inputs are baked into the kernel arguments. A different value
+//     causes the graph to be captured again.
+//
+// Graphs are not used when profiling or measuring kernel times, when a
+// segment does not run a compiled kernel (e.g. segments evaluated with ATen),
+// or when a kernel needs a cooperative launch or uses random numbers, whose
+// seed and offset would otherwise be frozen at capture time.
+bool FusionKernelRuntime::canUseCudaGraph(
+    const KernelArgumentHolder& args) const {
+#if (CUDA_VERSION >= 12000)
+  if (!args.getCacheId().has_value() || profiling_ || measure_kernel_time_ ||
+      isProfilerEnabled() || executors_.empty()) {
+    return false;
+  }
+  for (const auto& executor : executors_) {
+    if (!executor.hasCompiledKernel()) {
+      return false;
+    }
+    const auto& summary = executor.kernel()->summary();
+    if (summary.has_cooperative_grid_reduction || summary.has_philox_op) {
+      return false;
+    }
+  }
+  return std::all_of(
+      args.cbegin(),
+      args.cend(),
+      [](const std::shared_ptr<PolymorphicValue>& arg) {
+        return !arg->is<at::Tensor>() || arg->as<at::Tensor>().is_cuda();
+      });
+#else
+  (void)args;
+  return false;
+#endif
+}
+
+std::optional<std::vector<at::Tensor>> FusionKernelRuntime::runWithCudaGraph(
+    const KernelArgumentHolder& args) {
+  FUSER_PERF_SCOPE("FusionKernelRuntime::runWithCudaGraph");
+  const size_t cache_id = args.getCacheId().value();
+  const c10::cuda::CUDAStream stream =
+      c10::cuda::getCurrentCUDAStream((c10::DeviceIndex)args.getDeviceIndex());
+
+  auto replay = [&](CudaGraphEntry& entry) {
+    entry.graph.launch(stream);
+    std::vector<at::Tensor> outputs = entry.outputs;
+    for (auto i : c10::irange(outputs.size())) {
+      if (!entry.output_aliases.at(i).has_value()) {
+        continue;
+      }
+      const auto& [input_index, offset] = entry.output_aliases.at(i).value();
+      const auto& input = args[input_index]->as<at::Tensor>();
+      outputs.at(i) = input.as_strided(
+          outputs.at(i).sizes(),
+          outputs.at(i).strides(),
+          input.storage_offset() + offset);
+    }
+    return outputs;
+  };
+
+  if (auto it = cuda_graphs_.find(cache_id); it != cuda_graphs_.end()) {
+    if (it->second == nullptr) {
+      return std::nullopt;
+    }
+    CudaGraphEntry& entry = *it->second;
+    bool reusable = entry.graph.isValid();
+    std::unordered_map<void*, void*> remap;
+    for (auto i : c10::irange(args.size())) {
+      if (!reusable) {
+        break;
+      }
+      const PolymorphicValue& arg = *args[i];
+      if (!arg.is<at::Tensor>()) {
+        reusable = PolymorphicValue_functions::isSame(
+            arg, entry.input_scalars.at(i));
+        continue;
+      }
+      void* ptr = arg.as<at::Tensor>().data_ptr();
+      if (ptr == entry.input_ptrs.at(i)) {
+        continue;
+      }
+      // Inputs that used to alias each other may no longer do so, in which
+      // case the kernel arguments cannot be told apart.
+      auto [remap_it, inserted] = remap.emplace(entry.input_ptrs.at(i), ptr);
+      reusable = inserted || remap_it->second == ptr;
+    }
+    if (reusable && entry.graph.updateInputPointers(remap)) {
+      for (auto i : c10::irange(args.size())) {
+        if (args[i]->is<at::Tensor>()) {
+          entry.input_ptrs.at(i) = args[i]->as<at::Tensor>().data_ptr();
+        }
+      }
+      return replay(entry);
+    }
+    cuda_graphs_.erase(it);
+  }
+
+  auto entry = std::make_unique<CudaGraphEntry>();
+  std::unordered_set<void*> input_ptrs;
+  for (const auto& arg : args) {
+    if (arg->is<at::Tensor>()) {
+      void* ptr = arg->as<at::Tensor>().data_ptr();
+      entry->input_ptrs.push_back(ptr);
+      entry->input_scalars.emplace_back();
+      input_ptrs.insert(ptr);
+    } else {
+      entry->input_ptrs.push_back(nullptr);
+      entry->input_scalars.push_back(*arg);
+    }
+  }
+
+  // runSegmentsWithInputs appends extents and intermediates to its
+  // arguments. Capture with a copy so that `args` is left untouched if the
+  // segments have to be run eagerly after a failed capture.
+  KernelArgumentHolder capture_args = args;
+  const c10::cuda::CUDAStream capture_stream = c10::cuda::getStreamFromPool(
+      /*isHighPriority=*/false, (c10::DeviceIndex)args.getDeviceIndex());
+  try {
+    c10::cuda::CUDAStreamGuard stream_guard(capture_stream);
+    entry->graph.beginCapture(capture_stream.stream());
+    capturing_graph_ = &entry->graph;
+    const auto& tensor_map = runSegmentsWithInputs(capture_args);
+    capturing_graph_ = nullptr;
+    for (Val* output : segmented_fusion_->outputs()) {
+      entry->outputs.push_back(tensor_map.at(output)->as<at::Tensor>());
+    }
+    entry->graph.endCapture(
+        capture_stream.stream(), executors_, cache_id, input_ptrs);
+  } catch (const std::exception& e) {
+    capturing_graph_ = nullptr;
+    entry->graph.abortCapture(capture_stream.stream());
+    if (isDebugDumpEnabled(DebugDumpOption::CudaGraph)) {
+      debug() << "[cuda graph] Failed to capture input id " << cache_id
+              << ", running eagerly instead: " << e.what() << std::endl;
+    }
+    cuda_graphs_[cache_id] = nullptr;
+    return std::nullopt;
+  }
+
+  for (const auto& output : entry->outputs) {
+    std::optional<std::pair<size_t, int64_t>> alias;
+    for (auto i : c10::irange(args.size())) {
+      if (!args[i]->is<at::Tensor>()) {
+        continue;
+      }
+      const auto& input = args[i]->as<at::Tensor>();
+      if (input.storage().data_ptr().get() ==
+          output.storage().data_ptr().get()) {
+        alias = {i, output.storage_offset() - input.storage_offset()};
+        break;
+      }
+    }
+    entry->output_aliases.push_back(alias);
+  }
+
+  CudaGraphEntry& new_entry = *entry;
+  cuda_graphs_[cache_id] = std::move(entry);
+  return replay(new_entry);
+}
+
+Megakernel* FusionKernelRuntime::getMegakernel() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (megakernel_ != nullptr) {
+    return megakernel_.get();
+  }
+  if (profiling_ || measure_kernel_time_ || isProfilerEnabled()) {
+    return nullptr;
+  }
+  std::vector<const FusionExecutor*> phases;
+  for (SegmentedGroup* group : runtime_workspace_.group_run_order) {
+    phases.push_back(&executors_.at(group->groupId()));
+  }
+  // Segments compiled in the background are not ready yet
+  if (!Megakernel::canRun(phases)) {
+    return nullptr;
+  }
+  megakernel_ = std::make_unique<Megakernel>(std::move(phases));
+  return megakernel_.get();
+}
+
+// [ Note -- Host IR runtime ]
+//
+// With NVFUSER_ENABLE=host_ir_runtime, the segments of a runtime are lowered
+// once, at its first eligible run, to a host IR program: a PostOnStream per
+// segment in group_run_order, posting a HostUnit whose fusion is the segment.
+// The following runs interpret that program with a HostIrExecutor instead of
+// walking the segmented fusion, and the PostOnStreams are run by the
+// executors this runtime compiled for the segments, through
+// HostIrExecutor::setHostUnitRunner. The executor releases each intermediate
+// tensor after its last consumer, like ArgumentManager. With
+// NVFUSER_ENABLE=concurrent_segments, hir::assignStreams posts the segments on
+// up to max_concurrent_segment_streams streams.
+//
+// This is the path along which the runtime can be moved to host IR, e.g., to
+// run host-side ops between the segments. For now it does not support the
+// per-run features implemented in runSegmentsWithInputs, so runs with output
+// buffers, the megakernel, CUDA graph captures, the intermediate arena, L2
+// persistence or the profiler keep the existing path.
+std::vector<at::Tensor> FusionKernelRuntime::runWithHostIr(
     KernelArgumentHolder& args) {
+  FUSER_PERF_SCOPE("FusionKernelRuntime::runWithHostIr");
+  std::lock_guard<std::mutex> guard(host_ir_mutex_);
+  if (host_ir_executor_ == nullptr) {
+    auto hic = std::make_unique<hir::HostIrContainer>();
+    FusionGuard fg(hic.get());
+    IrCloner ir_cloner(hic.get());
+    std::vector<std::pair<hir::HostUnit*, SegmentedGroup*>> host_units;
+    for (SegmentedGroup* group : runtime_workspace_.group_run_order) {
+      auto* host_unit = IrBuilder::create<hir::HostUnit>(
+          segmented_fusion_->makeFusion(group).second);
+      host_units.emplace_back(host_unit, group);
+      hic->pushBackTopLevelExprs(IrBuilder::create<hir::PostOnStream>(
+          host_unit,
+          ir_cloner.clone(group->inputs()),
+          ir_cloner.clone(group->outputs())));
+    }
+    for (Val* input : segmented_fusion_->inputs()) {
+      hic->addInput(ir_cloner.clone(input));
+    }
+    for (Val* output : segmented_fusion_->outputs()) {
+      hic->addOutput(ir_cloner.clone(output));
+    }
+    if (isOptionEnabled(EnableOption::ConcurrentSegments)) {
+      hir::assignStreams(hic.get(), max_concurrent_segment_streams);
+    }
+
+    hir::HostIrExecutorParams params;
+    params.release_dead_values = true;
+    host_ir_executor_ = std::make_unique<hir::HostIrExecutor>(
+        std::move(hic), /*communicator=*/nullptr, params);
+    for (auto [host_unit, group] : host_units) {
+      host_ir_executor_->setHostUnitRunner(
+          host_unit, [this, group = group](KernelArgumentHolder& group_args) {
+            group_args.setDeviceIndex(host_ir_args_->getDeviceIndex());
+            if (auto cache_id = host_ir_args_->getCacheId();
+                cache_id.has_value()) {
+              group_args.setCacheId(cache_id.value());
+            }
+            return runKernelWithInput(group_args, group);
+          });
+    }
+  }
+
+  host_ir_args_ = &args;
+  std::vector<at::Tensor> outputs = host_ir_executor_->runWithArgs(args);
+  host_ir_args_ = nullptr;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    kernel_time_ms_ = 0;
+  }
+  return outputs;
+}
+
+std::vector<at::Tensor> FusionKernelRuntime::runWithInputs(
+    KernelArgumentHolder& args,
+    const std::vector<at::Tensor>& output_buffers) {
   FUSER_PERF_SCOPE("FusionKernelRuntime::runWithInputs");
 
+  // The outputs of a replayed graph are the buffers it was captured with
+  if (output_buffers.empty() && isOptionEnabled(EnableOption::CudaGraph) &&
+      canUseCudaGraph(args)) {
+    if (auto outputs = runWithCudaGraph(args); outputs.has_value()) {
+      return std::move(outputs.value());
+    }
+  }
+
   if (isDebugDumpEnabled(DebugDumpOption::PerfDebugVerbose)) {
     debug() << "=================RUNNING FUSION SEGMENTS================="
             << std::endl;
   }
 
+  // See [ Note -- Host IR runtime ]
+  if (output_buffers.empty() && isOptionEnabled(EnableOption::HostIrRuntime) &&
+      !isOptionEnabled(EnableOption::Megakernel) &&
+      !isOptionEnabled(EnableOption::IntermediateArena) &&
+      !isOptionEnabled(EnableOption::L2Persistence) && !isProfilerEnabled() &&
+      capturing_graph_ == nullptr && LaunchRecorder::active() == nullptr) {
+    return runWithHostIr(args);
+  }
+
   c10::Device device(c10::DeviceType::CUDA, (int8_t)args.getDeviceIndex());
-  const auto& tensor_map = runSegmentsWithInputs(args);
+  // See [ Note -- Megakernel ] in megakernel.cpp
+  Megakernel* megakernel =
+      isOptionEnabled(EnableOption::Megakernel) ? getMegakernel() : nullptr;
+  std::vector<FusionExecutor::RecordedLaunch> launches;
+  std::optional<LaunchRecorder> recorder;
+  if (megakernel != nullptr) {
+    recorder.emplace(&launches);
+  }
+  const auto& tensor_map = runSegmentsWithInputs(args, output_buffers);
+  if (megakernel != nullptr) {
+    recorder.reset();
+    megakernel->launch(
+        launches,
+        c10::cuda::getCurrentCUDAStream(device.index()),
+        args.getDeviceIndex());
+  }
 
   if (isDebugDumpEnabled(DebugDumpOption::PerfDebugVerbose)) {
     debug() << "============= FINISHED RUNNING FUSION SEGMENTS ============"
@@ -1363,7 +4203,9 @@ std::vector<at::Tensor> FusionKernelRuntime::runWithInputs(
 }
 
 std::unordered_map<Val*, const PolymorphicValue*> FusionKernelRuntime::
-    runSegmentsWithInputs(KernelArgumentHolder& args) {
+    runSegmentsWithInputs(
+        KernelArgumentHolder& args,
+        const std::vector<at::Tensor>& output_buffers) {
   FUSER_PERF_SCOPE("FusionKernelRuntime::runSegmentsWithInputs");
   NVF_ERROR(
       args.size() == segmented_fusion_->inputs().size(),
@@ -1372,14 +4214,78 @@ std::unordered_map<Val*, const PolymorphicValue*> FusionKernelRuntime::
       " inputs but expected ",
       segmented_fusion_->inputs().size());
 
+  // See [ Note -- Output buffers ]
+  std::unordered_map<Val*, at::Tensor> output_buffer_map;
+  if (!output_buffers.empty()) {
+    const auto& outputs = segmented_fusion_->outputs();
+    NVF_ERROR(output_buffers.size() == outputs.size());
+    for (auto i : c10::irange(outputs.size())) {
+      if (output_buffers.at(i).defined()) {
+        output_buffer_map.emplace(outputs.at(i), output_buffers.at(i));
+      }
+    }
+  }
+
   ArgumentManager args_manager(
       args, runtime_workspace_, segmented_fusion_->inputs());
 
   // group should share cache id.
   auto group_cache_id = args.getCacheId();
   const int64_t num_groups = (int64_t)runtime_workspace_.group_run_order.size();
-  num_live_args_after_segment_runs_.reserve(num_groups);
-  kernel_time_ms_ = 0;
+  // Published at the end of the run, see [ Note -- Concurrent runs ]
+  std::vector<int64_t> num_live_args_after_segment_runs;
+  num_live_args_after_segment_runs.reserve(num_groups);
+
+  // See [ Note -- Concurrent segments ]
+  const bool run_concurrently = num_groups > 1 &&
+      isOptionEnabled(EnableOption::ConcurrentSegments) &&
+      capturing_graph_ == nullptr && LaunchRecorder::active() == nullptr;
+  const auto device_index = (c10::DeviceIndex)args.getDeviceIndex();
+  std::vector<c10::cuda::CUDAStream> streams;
+  std::vector<at::cuda::CUDAEvent> segment_done;
+  if (run_concurrently) {
+    const auto& group_streams = runtime_workspace_.group_streams;
+    const int64_t num_streams =
+        *std::max_element(group_streams.begin(), group_streams.end()) + 1;
+    streams.push_back(c10::cuda::getCurrentCUDAStream(device_index));
+    at::cuda::CUDAEvent inputs_ready;
+    inputs_ready.record(streams.front());
+    for ([[maybe_unused]] auto i : c10::irange(1, num_streams)) {
+      streams.push_back(c10::cuda::getStreamFromPool(false, device_index));
+      inputs_ready.block(streams.back());
+    }
+    segment_done.resize(num_groups);
+  }
+
+  // See [ Note -- Intermediate arena ]
+  const ArenaPlan* arena_plan = nullptr;
+  bool needs_arena_plan = false;
+  if (isOptionEnabled(EnableOption::IntermediateArena) &&
+      group_cache_id.has_value() && capturing_graph_ == nullptr &&
+      !run_concurrently && LaunchRecorder::active() == nullptr) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto it = arena_plans_.find(group_cache_id.value());
+    if (it == arena_plans_.end()) {
+      needs_arena_plan = true;
+    } else if (
+        it->second.size > 0 &&
+        arena_.acquire(
+            it->second.size,
+            c10::cuda::getCurrentCUDAStream(
+                (c10::DeviceIndex)args.getDeviceIndex()))) {
+      arena_plan = &it->second;
+    }
+  }
+  // Releases the arena even if a segment throws
+  struct ArenaRelease {
+    IntermediateArena* arena;
+    ~ArenaRelease() {
+      if (arena != nullptr) {
+        arena->release();
+      }
+    }
+  } arena_release{arena_plan != nullptr ? &arena_ : nullptr};
+
   for (auto run_order_id : c10::irange(num_groups)) {
     // TODO: index mode should be updated per segmented kernel
     // Prepare input vector
@@ -1396,12 +4302,90 @@ std::unordered_map<Val*, const PolymorphicValue*> FusionKernelRuntime::
     // TODO: currently we are still outputing PyTorch tensors, instead of
     // something abstract. This is quite unsatisfying.
 
+    std::optional<c10::cuda::CUDAStreamGuard> stream_guard;
+    if (run_concurrently) {
+      const int64_t stream_id =
+          runtime_workspace_.group_streams.at(run_order_id);
+      const c10::cuda::CUDAStream& stream = streams.at(stream_id);
+      for (int64_t producer :
+           runtime_workspace_.group_producers.at(run_order_id)) {
+        if (runtime_workspace_.group_streams.at(producer) != stream_id) {
+          segment_done.at(producer).block(stream);
+        }
+      }
+      // Segment outputs may have been allocated on another stream, which could
+      // reuse their memory as soon as they are freed.
+      for (const auto& arg : group_runtime_inputs) {
+        if (arg->is<at::Tensor>()) {
+          c10::cuda::CUDACachingAllocator::recordStream(
+              arg->as<at::Tensor>().storage().data_ptr(), stream);
+        }
+      }
+      stream_guard.emplace(stream);
+    }
+
     // Run graph segment
-    std::vector<at::Tensor> group_runtime_outputs =
-        runKernelWithInput(group_runtime_inputs, group_to_run);
+    std::vector<at::Tensor> group_runtime_outputs = runKernelWithInput(
+        group_runtime_inputs,
+        group_to_run,
+        arena_plan,
+        output_buffer_map,
+        isOptionEnabled(EnableOption::L2Persistence)
+            ? runtime_workspace_.group_l2_windows.at(run_order_id)
+            : std::nullopt);
+    if (run_concurrently) {
+      const int64_t stream_id =
+          runtime_workspace_.group_streams.at(run_order_id);
+      segment_done.at(run_order_id).record(streams.at(stream_id));
+      stream_guard.reset();
+    }
+    if (capturing_graph_ != nullptr) {
+      // group_runtime_inputs now also holds the intermediate buffers of the
+      // segment, all of which the captured kernels keep referring to.
+      for (const auto& arg : group_runtime_inputs) {
+        if (arg->is<at::Tensor>()) {
+          capturing_graph_->retain(arg->as<at::Tensor>());
+        }
+      }
+      for (const auto& output : group_runtime_outputs) {
+        capturing_graph_->retain(output);
+      }
+    }
     args_manager.updateWithSegmentOutputs(
         group_to_run->outputs(), group_runtime_outputs, run_order_id);
-    num_live_args_after_segment_runs_.push_back((int64_t)args.size());
+    num_live_args_after_segment_runs.push_back((int64_t)args.size());
+  }
+
+  if (run_concurrently) {
+    // The caller may use the outputs on its stream as soon as we return
+    std::vector<bool> joined(streams.size(), false);
+    joined.front() = true;
+    for (auto run_order_id = num_groups - 1; run_order_id >= 0;
+         --run_order_id) {
+      const int64_t stream_id =
+          runtime_workspace_.group_streams.at(run_order_id);
+      if (!joined.at(stream_id)) {
+        segment_done.at(run_order_id).block(streams.front());
+        joined.at(stream_id) = true;
+      }
+    }
+    for (Val* output : segmented_fusion_->outputs()) {
+      const PolymorphicValue* tensor = args_manager.checkTensorMap(output);
+      if (tensor->is<at::Tensor>()) {
+        c10::cuda::CUDACachingAllocator::recordStream(
+            tensor->as<at::Tensor>().storage().data_ptr(), streams.front());
+      }
+    }
+  }
+
+  if (needs_arena_plan) {
+    planArena(group_cache_id.value());
+  }
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    num_live_args_after_segment_runs_ =
+        std::move(num_live_args_after_segment_runs);
+    kernel_time_ms_ = 0;
   }
 
   if (isProfilerEnabled()) {
@@ -1428,6 +4412,295 @@ std::unordered_map<Val*, const PolymorphicValue*> FusionKernelRuntime::
   return args_manager.getTensorMap();
 }
 
+// [ Note -- Concurrent segments ]
+//
+// With NVFUSER_ENABLE=concurrent_segments, segments that do not depend on each
+// other are launched on different streams, so that small kernels, e.g. the
+// matmuls of the experts of a MoE layer that each got their own segment, can
+// run at the same time instead of one after the other. This does not merge the
+// kernels. Scheduling several matmuls as one grouped kernel would require the
+// matmul scheduler to handle more than one MmaOp.
+//
+// prepareRuntimeOrder gives each segment the depth of its longest chain of
+// producer segments. The segments at the same depth are independent and are
+// spread over up to max_concurrent_segment_streams streams, the first one
+// being the current stream. A segment stays on the stream of one of its
+// producers at the previous depth when no other segment at its depth took it,
+// so each branch of the segment graph, e.g. the outputs and the statistics of
+// a normalization, keeps a stream of its own and only waits on events where
+// branches join. At run time,
+//   - the other streams wait for the work already queued on the current
+//     stream, e.g. producing the fusion inputs,
+//   - a segment waits for an event recorded after each of its producers that
+//     ran on another stream,
+//   - the tensors a segment reads are recorded on its stream, so that the
+//     caching allocator does not reuse them before the segment is done,
+//   - the current stream waits for the last segment of every other stream,
+//     and the fusion outputs are recorded on it.
+// Kernels on different streams do not share the zeroed memory of
+// contigZeroedTensor, which keeps one buffer per stream.
+//
+// Segments run in the same order as without the option, only the streams
+// differ. The option is ignored while capturing a CUDA graph and disables the
+// intermediate arena, whose plan assumes that segments run one by one.
+
+// [ Note -- L2 persistence of segment handoffs ]
+//
+// The output of a segment is often read right away by the next segment,
+// e.g. the statistics or the normalized tensor of a normalization split over
+// two kernels. Unless it is small, most of its lines are evicted from L2 by
+// the time the next kernel reads them back from DRAM. On Ampere and newer
+// GPUs, with NVFUSER_ENABLE=l2_persistence, one such handoff per segment is
+// instead written to the persisting L2 lines:
+//   - prepareRuntimeOrder picks, for each segment, its first output that is
+//     read by the next segment in the run order and not a fusion output,
+//     whose lines would never be read again by the runtime.
+//   - The segment is launched with an access policy window on the buffer of
+//     that output. Its hits persist in L2 and its misses stream. When the
+//     buffer is larger than the persisting carveout, only a matching fraction
+//     of it persists, so that the window does not thrash the carveout.
+//   - A segment that hands nothing off instead gets a window of normal lines
+//     on the handoff it reads, so that the lines kept for it are released for
+//     the later segments. When it hands off an output too, the persisting
+//     lines of its input are replaced as the carveout fills up.
+//
+// The carveout of the device, cudaLimitPersistingL2CacheSize, is grown to
+// the largest window so far, up to persistingL2CacheMaxSize, and never
+// shrunk. Windows act per launch through cuLaunchKernelEx, rather than as a
+// stream attribute, as the buffers are only known when the segment runs.
+// They are skipped for windows larger than accessPolicyMaxWindowSize, for
+// cooperative and cluster launches and while capturing a CUDA graph, as the
+// carveout cannot be changed then.
+
+// [ Note -- Intermediate arena ]
+//
+// With NVFUSER_ENABLE=intermediate_arena, the global buffers that never leave
+// a FusionKernelRuntime are views of a single slab owned by the runtime
+// instead of being allocated one by one for every run. These are
+//   - the intermediates of each kernel, e.g. grid reduction work buffers, and
+//   - the outputs of a segment that are only read by later segments.
+//
+// The sizes of all these buffers are fixed for a given input id, and are known
+// from the ExecutorEntry of each segment once it has been run with that id. At
+// the end of the first run with an input id, planArena assigns every buffer an
+// offset in the slab. A buffer is live from the segment producing it to the
+// last segment reading it, and buffers that are not live at the same time may
+// share memory. Later runs with the same input id hand the views of the slab
+// to the executors through FusionExecutor::LaunchBuffers.
+//
+// The following buffers are still allocated individually, since they may
+// outlive the run or do not need to be allocated at all:
+//   - Fusion outputs, which are returned to the user.
+//   - Segment outputs read by a segment returning an alias of its inputs, e.g.
+//     a segment evaluated with ATen, as the alias could be a fusion output.
+//   - Outputs aliasing inputs, and zeroed buffers that are reused anyway.
+//   - Buffers of segments whose ExecutorEntry is not cached, since their sizes
+//     may change between runs with the same input id.
+//
+// Only a single run uses the slab at a time. A concurrent run of the same
+// runtime allocates its buffers individually. Reusing the slab is only safe
+// for work ordered after the previous run, so the slab is reallocated when
+// the runtime is run on another stream. The arena is also not used while
+// capturing a CUDA graph, which should retain the buffers it captured.
+void FusionKernelRuntime::planArena(size_t cache_id) {
+  FUSER_PERF_SCOPE("FusionKernelRuntime::planArena");
+  std::lock_guard<std::mutex> guard(mutex_);
+  const auto& run_order = runtime_workspace_.group_run_order;
+  const int64_t num_groups = (int64_t)run_order.size();
+
+  // Run order id of the last segment reading each value, and the values read
+  // by a segment that may return an alias to them
+  std::unordered_map<Val*, int64_t> last_use;
+  std::unordered_set<Val*> aliased;
+  for (auto run_order_id : c10::irange(num_groups)) {
+    SegmentedGroup* group = run_order.at(run_order_id);
+    const FusionExecutor& executor = executors_.at(group->groupId());
+    bool may_alias = executor.getExecutorEntry(cache_id) == nullptr;
+    if (!may_alias) {
+      Fusion* fusion = executor.fusion();
+      may_alias = std::any_of(
+          fusion->outputs().begin(), fusion->outputs().end(), [&](Val* out) {
+            return fusion->getOutputAlias(out).type != AllocationType::New;
+          });
+    }
+    for (Val* input : group->inputs()) {
+      last_use[input] = run_order_id;
+      if (may_alias) {
+        aliased.insert(input);
+      }
+    }
+  }
+
+  const std::vector<Val*>& fusion_outputs = segmented_fusion_->outputs();
+  ArenaPlan plan;
+  plan.outputs.resize(executors_.size());
+  plan.intermediates.resize(executors_.size());
+  std::vector<ArenaBuffer*> buffers;
+  for (auto run_order_id : c10::irange(num_groups)) {
+    SegmentedGroup* group = run_order.at(run_order_id);
+    const FusionExecutor& executor = executors_.at(group->groupId());
+    const FusionExecutor::ExecutorEntry* entry =
+        executor.getExecutorEntry(cache_id);
+    if (entry == nullptr) {
+      continue;
+    }
+    Fusion* fusion = executor.fusion();
+
+    std::vector<ArenaBuffer>& outputs = plan.outputs.at(group->groupId());
+    outputs.resize(entry->outputs.size());
+    NVF_ERROR(entry->outputs.size() == group->outputs().size());
+    for (auto i : c10::irange(outputs.size())) {
+      Val* out = group->outputs().at(i);
+      auto last_use_it = last_use.find(out);
+      if (last_use_it == last_use.end() || aliased.count(out) ||
+          std::find(fusion_outputs.begin(), fusion_outputs.end(), out) !=
+              fusion_outputs.end() ||
+          fusion->getOutputAlias(fusion->outputs().at(i)).type !=
+              AllocationType::New) {
+        continue;
+      }
+      const FusionExecutor::GlobalBufferInfo& info = entry->outputs.at(i);
+      ArenaBuffer& buffer = outputs.at(i);
+      buffer.first_use = run_order_id;
+      buffer.last_use = last_use_it->second;
+      buffer.sizes = info.sizes;
+      buffer.strides = info.strides;
+      buffer.type = info.type;
+      if (buffer.bytes() > 0) {
+        buffers.push_back(&buffer);
+      }
+    }
+
+    std::vector<ArenaBuffer>& intermediates =
+        plan.intermediates.at(group->groupId());
+    intermediates.resize(entry->intermediates.size());
+    for (auto i : c10::irange(intermediates.size())) {
+      const FusionExecutor::GlobalBufferInfo& info =
+          entry->intermediates.at(i);
+      if (info.is_profile_buffer ||
+          (info.zero_init &&
+           (info.resets_to_zero ||
+            isOptionEnabled(EnableOption::ReuseZeroedMemory)))) {
+        continue;
+      }
+      // Intermediates are allocated contiguous and then expanded, see
+      // FusionExecutor::runFusion
+      ArenaBuffer& buffer = intermediates.at(i);
+      buffer.first_use = run_order_id;
+      buffer.last_use = run_order_id;
+      buffer.sizes.resize(info.sizes.size());
+      buffer.strides.resize(info.sizes.size());
+      int64_t stride = 1;
+      for (int64_t j = (int64_t)info.sizes.size() - 1; j >= 0; --j) {
+        buffer.sizes.at(j) = info.strides.at(j) == 0 ? 1 : info.sizes.at(j);
+        buffer.strides.at(j) = stride;
+        stride *= buffer.sizes.at(j);
+      }
+      buffer.type = info.type;
+      if (buffer.bytes() > 0) {
+        buffers.push_back(&buffer);
+      }
+    }
+  }
+
+  plan.size = IntermediateArena::plan(buffers);
+  arena_plans_[cache_id] = std::move(plan);
+}
+
+// [ Note -- Memory plan ]
+//
+// planMemory reports the device memory a FusionKernelRuntime allocates to run
+// its segments with given input sizes, e.g. to admit a batch against a memory
+// budget before running it. A segment output is live from the segment
+// producing it to the last segment reading it, which is when ArgumentManager
+// drops it, and fusion outputs are live until the end of the run. While a
+// segment runs, its global intermediates are live too: grid reduction work
+// buffers, semaphores, including the ones carved out of the zeroed buffer of
+// contigZeroedTensor, and intermediate global tensors. The peak of the live
+// bytes over the run order is the memory needed on top of the fusion inputs.
+//
+// The sizes of the segment outputs are estimated from the extents of their
+// logical domains, with broadcast dimensions not allocated, so no kernel
+// needs to be compiled. The sizes of the global intermediates depend on the
+// launch parameters of the kernels, and are only known once the runtime has
+// been run with the same input id. The exact sizes of the buffers the kernels
+// allocated then replace the estimates.
+//
+// The order of independent segments does not change the results but changes
+// which outputs are live at the same time. With
+// NVFUSER_ENABLE=memory_aware_segment_order, prepareRuntimeOrder picks, among
+// the segments whose inputs are ready, the one adding the fewest live bytes,
+// given the output sizes estimated with the inputs the runtime is created
+// with. This greedy order is kept only if it lowers the peak of the segment
+// outputs. Runs with other sizes reuse the same order. Intermediates are not
+// known yet and are not taken into account.
+MemoryPlan FusionKernelRuntime::planMemory(const KernelArgumentHolder& args) {
+  FUSER_PERF_SCOPE("FusionKernelRuntime::planMemory");
+  std::optional<std::unordered_map<Val*, int64_t>> output_bytes =
+      estimateSegmentOutputBytes(segmented_fusion_.get(), args);
+  NVF_CHECK(
+      output_bytes.has_value(),
+      "Could not evaluate the sizes of the segment outputs");
+
+  std::lock_guard<std::mutex> guard(mutex_);
+  const auto& run_order = runtime_workspace_.group_run_order;
+  const std::optional<size_t> cache_id = args.getCacheId();
+  MemoryPlan plan;
+  plan.has_intermediates = cache_id.has_value();
+  std::vector<int64_t> intermediate_bytes(run_order.size(), 0);
+  for (auto run_order_id : c10::irange(run_order.size())) {
+    SegmentedGroup* group = run_order.at(run_order_id);
+    const FusionExecutor& executor = executors_.at(group->groupId());
+    const FusionExecutor::ExecutorEntry* entry = cache_id.has_value()
+        ? executor.getExecutorEntry(cache_id.value())
+        : nullptr;
+    if (entry == nullptr) {
+      plan.has_intermediates = false;
+      continue;
+    }
+    Fusion* fusion = executor.fusion();
+    NVF_ERROR(entry->outputs.size() == group->outputs().size());
+    for (auto i : c10::irange(entry->outputs.size())) {
+      const FusionExecutor::GlobalBufferInfo& info = entry->outputs.at(i);
+      ArenaBuffer buffer;
+      buffer.sizes = info.sizes;
+      buffer.strides = info.strides;
+      buffer.type = info.type;
+      (*output_bytes)[group->outputs().at(i)] =
+          fusion->getOutputAlias(fusion->outputs().at(i)).type ==
+              AllocationType::New
+          ? buffer.bytes()
+          : 0;
+    }
+    for (const FusionExecutor::GlobalBufferInfo& info : entry->intermediates) {
+      if (info.is_profile_buffer) {
+        continue;
+      }
+      // Intermediates are allocated contiguous and then expanded, see
+      // FusionExecutor::runFusion
+      int64_t numel = 1;
+      for (auto j : c10::irange(info.sizes.size())) {
+        numel *= info.strides.at(j) == 0 ? 1 : info.sizes.at(j);
+      }
+      intermediate_bytes.at(run_order_id) +=
+          numel * (int64_t)c10::elementSize(info.type);
+    }
+  }
+
+  plan.live_bytes = liveBytes(run_order, *output_bytes, intermediate_bytes);
+  if (!plan.live_bytes.empty()) {
+    plan.peak_bytes =
+        *std::max_element(plan.live_bytes.begin(), plan.live_bytes.end());
+  }
+  const std::vector<Val*>& outputs = segmented_fusion_->outputs();
+  for (Val* output : std::unordered_set<Val*>(outputs.begin(), outputs.end())) {
+    if (auto it = output_bytes->find(output); it != output_bytes->end()) {
+      plan.output_bytes += it->second;
+    }
+  }
+  return plan;
+}
+
 const std::vector<FusionKernelRuntime::SchedulerEntryPtr>& FusionKernelRuntime::
     schedulers() const {
   return heuristics_->heuristicsList();
@@ -1445,6 +4718,34 @@ void FusionKernelRuntime::updateHeuristicsLaunchParams(
   }
 }
 
+std::vector<LaunchParams> FusionKernelRuntime::launchParams() const {
+  std::vector<LaunchParams> launch_params;
+  launch_params.reserve(schedulers().size());
+  for (const auto& scheduler_entry : schedulers()) {
+    launch_params.push_back(scheduler_entry->params()->lparams);
+  }
+  return launch_params;
+}
+
+void FusionKernelRuntime::updateLaunchParams(
+    const std::vector<LaunchParams>& launch_params) {
+  NVF_ERROR(launch_params.size() == schedulers().size());
+  for (const auto i : c10::irange(launch_params.size())) {
+    heuristics_->heuristicsList()[i]->updateLaunchConstraint(
+        launch_params[i]);
+  }
+}
+
+std::vector<KernelResourceUsage> FusionKernelRuntime::resourceUsage() {
+  std::vector<KernelResourceUsage> usages;
+  for (auto& executor : executors_) {
+    if (executor.hasCompiledKernel()) {
+      usages.push_back(executor.resourceUsage());
+    }
+  }
+  return usages;
+}
+
 std::optional<FusionKernelRuntime::HeuristicsPtr> FusionKernelRuntime::
     getMaybeHeuristicsFor(
         const KernelArgumentHolder& args,
@@ -1473,6 +4774,7 @@ std::optional<FusionKernelRuntime::HeuristicsPtr> FusionKernelRuntime::
 
     // Get input arguments for SchedulerRuntimeInfo
     KernelArgumentHolder group_runtime_inputs;
+    group_runtime_inputs.setDeviceIndex(args.getDeviceIndex());
     for (auto input : group_to_run->inputs()) {
       group_runtime_inputs.push(*args_manager.checkTensorMap(input));
     }
@@ -1508,6 +4810,12 @@ std::optional<FusionKernelRuntime::HeuristicsPtr> FusionKernelRuntime::
       heuristics->at(group_to_run->groupId()) =
           segmented_fusion_->makeInitialSchedulerEntry(
               group_to_run, fusion_to_run_info);
+      if (isOptionEnabled(EnableOption::Autotune)) {
+        applyTunedParams(
+            heuristics->at(group_to_run->groupId()).get(),
+            fusion_to_run,
+            group_runtime_inputs);
+      }
     } else {
       // Try to get scheduler entry
       auto maybe_scheduler_entry =
@@ -1519,6 +4827,10 @@ std::optional<FusionKernelRuntime::HeuristicsPtr> FusionKernelRuntime::
       // Check if this scheduler entry matches the previous entry for this
       // segmented group. If no match, then return std::nullptr
       auto scheduler_entry = std::move(maybe_scheduler_entry.value());
+      if (isOptionEnabled(EnableOption::Autotune)) {
+        applyTunedParams(
+            scheduler_entry.get(), fusion_to_run, group_runtime_inputs);
+      }
       if (!scheduler_entry->sameAs(
               heuristics_->at(group_to_run->groupId()).get())) {
         return std::nullopt;
@@ -7,20 +7,31 @@
 // clang-format on
 #pragma once
 
+#include <cuda_graph.h>
 #include <dynamic_transform.h>
 #include <evaluator_common.h>
 #include <exceptions.h>
 #include <executor.h>
 #include <fusion.h>
+#include <fusion_profiler.h>
 #include <fusion_segmenter.h>
+#include <intermediate_arena.h>
 #include <logical_domain_map.h>
+#include <megakernel.h>
 #include <scheduler/all_schedulers.h>
 #include <scheduler/registry.h>
 #include <serde/fusion_cache_generated.h>
+#include <thread_pool.h>
 
 #include <c10/util/ArrayRef.h>
 
+#include <atomic>
+#include <condition_variable>
+#include <future>
+#include <map>
+#include <memory>
 #include <mutex>
+#include <shared_mutex>
 #include <type_traits>
 #include <unordered_map>
 
@@ -29,6 +40,11 @@ namespace nvfuser {
 class SegmentedGroup;
 class FusionHeuristics;
 class SchedulerRuntimeInfo;
+class SegmentationCache;
+
+namespace hir {
+class HostIrExecutor;
+} // namespace hir
 
 // Utilities for benchmarking and profiling
 struct ExecutorLog {
@@ -42,6 +58,37 @@ struct RuntimeWorkSpace {
 
   //! Pre-determined order to bind tensor input meta data
   std::vector<Val*> group_extent_binding_order;
+
+  //! For each entry of group_run_order, the entries producing its inputs
+  std::vector<std::vector<int64_t>> group_producers;
+
+  //! For each entry of group_run_order, the stream it is launched on when
+  //! segments run concurrently, 0 being the current stream. See
+  //! [ Note -- Concurrent segments ] in kernel_cache.cpp.
+  std::vector<int64_t> group_streams;
+
+  //! For each entry of group_run_order, the input or output given an L2
+  //! access policy window with NVFUSER_ENABLE=l2_persistence. See
+  //! [ Note -- L2 persistence of segment handoffs ] in kernel_cache.cpp.
+  std::vector<std::optional<FusionExecutor::L2Window>> group_l2_windows;
+};
+
+//! Device memory allocated by a FusionKernelRuntime to run its segments with
+//! some input sizes. Fusion inputs are not counted. See
+//! [ Note -- Memory plan ] in kernel_cache.cpp.
+struct MemoryPlan {
+  //! For each entry of group_run_order, the bytes live while it runs: the
+  //! segment outputs that were produced and are still read by it or later
+  //! segments, its own outputs and its global intermediates
+  std::vector<int64_t> live_bytes;
+  //! Maximum of live_bytes
+  int64_t peak_bytes = 0;
+  //! Bytes of the fusion outputs, which outlive the run
+  int64_t output_bytes = 0;
+  //! Whether the sizes of the global intermediates of all kernels, e.g. grid
+  //! reduction work buffers and semaphores, are known and counted. They are
+  //! once the runtime has been run with the same input id.
+  bool has_intermediates = false;
 };
 //! Simple hasher for pair<T, const U*>. There is no default hasher for pairs,
 //! since there are a lot of options how to combine hashes. In a case where one
@@ -79,8 +126,71 @@ struct PairPointerEquals {
 };
 
 // Perform a topological sort of different groups composiong the Segmented
-// Fusion
-void prepareRuntimeOrder(SegmentedFusion*, RuntimeWorkSpace&);
+// Fusion. If the inputs of the complete fusion are given and
+// NVFUSER_ENABLE=memory_aware_segment_order is set, the independent groups are
+// ordered to lower the peak memory of the segment outputs with these inputs.
+void prepareRuntimeOrder(
+    SegmentedFusion*,
+    RuntimeWorkSpace&,
+    const KernelArgumentHolder* args = nullptr);
+
+//! Lightweight counters of a FusionExecutorCache, maintained when
+//! NVFUSER_ENABLE=runtime_metrics is set. See [ Note -- Runtime metrics ] in
+//! kernel_cache.cpp.
+struct FusionExecutorCacheMetrics {
+  //! Calls of runFusionWithInputs
+  int64_t runs = 0;
+  //! Kernels launched, i.e. segments of the runs not evaluated by the
+  //! async_compile fallback
+  int64_t kernel_launches = 0;
+  //! Runtime lookups finding a runtime by input id, i.e. on the fast path
+  int64_t input_id_hits = 0;
+  //! Runtime lookups reusing an existing runtime for a new input id
+  int64_t runtime_reuses = 0;
+  //! Runtime reuses found by shape bucket, without computing heuristics
+  int64_t shape_bucket_hits = 0;
+  //! Runtime lookups creating a new runtime
+  int64_t runtime_misses = 0;
+  //! Host time spent compiling runtimes
+  int64_t compile_time_ns = 0;
+  //! Number of segments of the runtime of the most recent run
+  int64_t num_segments = 0;
+  //! Bytes of the kernel inputs and outputs, as in
+  //! FusionExecutor::inputBytesProcessed and outputBytesProcessed
+  int64_t input_bytes = 0;
+  int64_t output_bytes = 0;
+  //! Runs whose kernels were timed with CUDA events, and their total time
+  int64_t sampled_runs = 0;
+  int64_t sampled_kernel_time_ns = 0;
+  //! Runtimes evicted for NVFUSER_ENABLE=runtime_cache_budget
+  int64_t runtime_evictions = 0;
+  //! Runs coalesced by NVFUSER_ENABLE=request_batching, and the batched
+  //! runs they were coalesced into
+  int64_t batched_requests = 0;
+  int64_t request_batches = 0;
+
+  NVF_API std::string toString() const;
+};
+
+//! State of the budget of NVFUSER_ENABLE=runtime_cache_budget, shared by all
+//! FusionExecutorCaches. See [ Note -- Runtime cache budget ] in
+//! kernel_cache.cpp.
+struct RuntimeCacheBudgetStats {
+  int64_t budget_bytes = 0;
+  //! Runtimes tracked and their estimated bytes
+  int64_t num_runtimes = 0;
+  int64_t host_bytes = 0;
+  int64_t device_bytes = 0;
+  //! Runtimes evicted so far and their bytes
+  int64_t evictions = 0;
+  int64_t evicted_bytes = 0;
+
+  NVF_API std::string toString() const;
+};
+
+NVF_API RuntimeCacheBudgetStats runtimeCacheBudgetStats();
+
+class RuntimeCacheBudget;
 
 //! FusionKernelRuntime is the unified interface from fusion graphs into
 //!  caching, compilation into kernels, and kernel launches.
@@ -106,7 +216,10 @@ class FusionKernelRuntime {
       int64_t fusion_id = 0,
       int64_t concrete_id = 0,
       int64_t runtime_id = 0,
-      bool auto_schedule = true);
+      bool auto_schedule = true,
+      SegmentationCache* segmentation_cache = nullptr);
+
+  ~FusionKernelRuntime();
 
   //! Type notations within FusionKernelRuntime Context
   using HashType = size_t;
@@ -118,6 +231,8 @@ class FusionKernelRuntime {
     for (auto& fe : executors_) {
       fe.evictCache(input_id);
     }
+    cuda_graphs_.erase(input_id);
+    arena_plans_.erase(input_id);
   }
 
   //! query if we have already attempted compilation
@@ -133,10 +248,13 @@ class FusionKernelRuntime {
   flatbuffers::Offset<serde::FusionKernelRuntime> serialize(
       flatbuffers::FlatBufferBuilder& builder) const;
 
-  //! Deserialize Fusion Kernel Runtime using flatbuffers
+  //! Deserialize Fusion Kernel Runtime using flatbuffers. If in_place, the
+  //! kernel binaries are not copied out of the buffer, which must outlive
+  //! the runtime.
   void deserialize(
       const serde::FusionKernelRuntime* buffer,
-      int8_t device_index);
+      int8_t device_index,
+      bool in_place = false);
 
   //! Note that all heuristics use the same index type.
   PrimDataType getIndexType() const {
@@ -150,12 +268,25 @@ class FusionKernelRuntime {
     return index_type.value();
   }
 
-  //! Unified interface to run the managed kernels with given input
-  NVF_API std::vector<at::Tensor> runWithInputs(KernelArgumentHolder& args);
+  //! Unified interface to run the managed kernels with given input. Defined
+  //! tensors of `output_buffers`, indexed like the outputs of the complete
+  //! fusion, are written by the segments producing those outputs instead of
+  //! newly allocated tensors. See [ Note -- Output buffers ] in
+  //! kernel_cache.cpp.
+  NVF_API std::vector<at::Tensor> runWithInputs(
+      KernelArgumentHolder& args,
+      const std::vector<at::Tensor>& output_buffers = {});
 
   //! Compile a kernel executor for given inputs. Note: The compilation is
-  //! multithreaded. The segments in the fusion are compiled independently.
-  NVF_API void compileFusionParallel(KernelArgumentHolder args);
+  //! multithreaded. The segments in the fusion are compiled independently,
+  //! as tasks of `priority` on getThreadPool().
+  NVF_API void compileFusionParallel(
+      KernelArgumentHolder args,
+      TaskPriority priority = TaskPriority::Latency);
+
+  //! Device memory needed to run the segments with the given inputs, which
+  //! only need to carry metadata. The segments don't need to be compiled.
+  NVF_API MemoryPlan planMemory(const KernelArgumentHolder& args);
 
   const std::vector<int64_t>& getArgsNumAfterSegmentRuns() {
     return num_live_args_after_segment_runs_;
@@ -166,6 +297,12 @@ class FusionKernelRuntime {
     profiling_ = to_profile;
   }
 
+  //! Accumulate the bytes processed by the kernels into `metrics`, or stop
+  //! doing so if nullptr
+  void collectMetrics(FusionExecutorCacheMetrics* metrics) {
+    metrics_ = metrics;
+  }
+
   //! Enable kernel time measurement. Only the device time is
   //! inclued.
   void enableKernelTimeMeasurement() {
@@ -181,6 +318,11 @@ class FusionKernelRuntime {
     return kernel_time_ms_;
   }
 
+  //! Feed the kernel times of the last run in `profile` back to the
+  //! segmentation cost model. See [ Note -- Segmentation cost model ] in
+  //! segmentation_cost_model.cpp.
+  void recordSegmentTimes(const FusionProfile& profile);
+
   //! Internal knob for profiling shape inference
   void disableLaunchParamCache() {
     for (auto& executor : executors_) {
@@ -195,16 +337,37 @@ class FusionKernelRuntime {
     }
   }
 
+  //! Internal knob for profiling kernel argument packing
+  void disableKernelArgPatching() {
+    for (auto& executor : executors_) {
+      executor.disableKernelArgPatching();
+    }
+  }
+
   //! Returns if this runtime is segmented
   bool isSegmented() const {
     return is_segmented_;
   }
 
+  //! Host time in milliseconds spent segmenting the fusion when this runtime
+  //! was created, including proposing a scheduler for the complete fusion
+  double segmentationTimeMs() const {
+    return segmentation_time_ms_;
+  }
+
   //! Returns the fusion segments if applicable
   SegmentedFusion* fusionSegments() const {
     return segmented_fusion_.get();
   }
 
+  //! Contiguity flags of the tensor inputs the kernels were compiled for,
+  //! empty for other inputs. See [ Note -- Contiguity specialization ] in
+  //! kernel_cache.cpp.
+  const std::vector<std::vector<std::optional<bool>>>& inputContiguity()
+      const {
+    return input_contiguity_;
+  }
+
   //! Returns the list of heuristics in this runtime
   FusionHeuristics* schedulerHeuristics() const {
     return heuristics_.get();
@@ -233,30 +396,102 @@ class FusionKernelRuntime {
   //!  for kernel launch for a new input dimension but same heuristics
   void updateHeuristicsLaunchParams(FusionHeuristics* update_heuristics);
 
+  //! Launch params of the heuristics of each segment, in the order of
+  //! schedulers(), to be restored by updateLaunchParams
+  std::vector<LaunchParams> launchParams() const;
+
+  //! Restore the launch params returned by launchParams
+  void updateLaunchParams(const std::vector<LaunchParams>& launch_params);
+
   const std::vector<FusionExecutor>& executors() const {
     return executors_;
   }
 
+  const RuntimeWorkSpace& runtimeWorkSpace() const {
+    return runtime_workspace_;
+  }
+
+  //! The megakernel running the segments, if one has been created. See
+  //! [ Note -- Megakernel ] in megakernel.cpp.
+  const Megakernel* megakernel() const {
+    return megakernel_.get();
+  }
+
+  int64_t runtimeId() const {
+    return runtime_id_;
+  }
+
+  //! Estimated host bytes of the runtime: the IR of its fusion and kernels,
+  //! the kernel code and the host copies of the binaries
+  NVF_API int64_t hostBytes() const;
+
+  //! Bytes of the binaries of the modules loaded for the kernels
+  NVF_API int64_t deviceModuleBytes() const;
+
+  //! Returns the resource usage of the kernel of each segment compiled to a
+  //! kernel, with the launch parameters of its last run. See
+  //! FusionExecutor::resourceUsage.
+  NVF_API std::vector<KernelResourceUsage> resourceUsage();
+
  private:
   //! Runs each fusion segment given arguments. The outputs for a fusion are
   //! added back to the arguments, so they can be used as inputs to successive
   //! segments. Returns a map that links each NvFuser Val to its corresponding
   //! tensor.
   std::unordered_map<Val*, const PolymorphicValue*> runSegmentsWithInputs(
-      KernelArgumentHolder& args);
+      KernelArgumentHolder& args,
+      const std::vector<at::Tensor>& output_buffers = {});
+
+  //! Whether the segments can be captured into a CUDA graph for these
+  //! arguments. See [ Note -- CUDA graph mode ] in kernel_cache.cpp.
+  bool canUseCudaGraph(const KernelArgumentHolder& args) const;
+
+  //! Replay the CUDA graph captured for the cache id of `args`, capturing it
+  //! first if needed. Returns std::nullopt if the segments could not be
+  //! captured, in which case they have to be run eagerly.
+  std::optional<std::vector<at::Tensor>> runWithCudaGraph(
+      const KernelArgumentHolder& args);
+
+  //! Returns the megakernel running the segments, creating it at the first
+  //! call, or nullptr if they cannot run as one
+  Megakernel* getMegakernel();
+
+  //! Run the segments with the host IR program lowered from them, lowering
+  //! it at the first call. See [ Note -- Host IR runtime ] in kernel_cache.cpp.
+  std::vector<at::Tensor> runWithHostIr(KernelArgumentHolder& args);
 
   //! Interface to run a single kernel, either one kernel for single-kernel
   //! fusions, or a kernel for a segmentedGrouup in a segmented fusion. Returns
-  //! the kernel outputs.
+  //! the kernel outputs. If `arena_plan` is given, the buffers it places are
+  //! views of arena_, which must have been acquired by the caller. The
+  //! outputs of `sg` found in `output_buffers` are written to the given
+  //! tensors. `l2_window` is given to the executor of `sg`, see
+  //! RuntimeWorkSpace::group_l2_windows.
   std::vector<at::Tensor> runKernelWithInput(
       KernelArgumentHolder& args,
-      SegmentedGroup* sg);
+      SegmentedGroup* sg,
+      const ArenaPlan* arena_plan = nullptr,
+      const std::unordered_map<Val*, at::Tensor>& output_buffers = {},
+      std::optional<FusionExecutor::L2Window> l2_window = std::nullopt);
+
+  //! Place the buffers of all segments in arena_ once they have been run with
+  //! the given input id. See [ Note -- Intermediate arena ] in
+  //! kernel_cache.cpp.
+  void planArena(size_t cache_id);
 
   //! Interface to compile a single kernel. It is either a single kernel for a
   //! fusion or a kernel for a segmentedGrouup in a segmented fusion. Returns
   //! launch and compile parameters for kernel.
   void compileKernel(const KernelArgumentHolder& args, SegmentedGroup* sg);
 
+  //! Search the scheduler parameters of a segment not found in the tuning db
+  //! and keep the fastest. See [ Note -- Autotuning ] in kernel_cache.cpp.
+  void autotuneSegment(const KernelArgumentHolder& args, SegmentedGroup* sg);
+
+  //! Compile the kernels deferred by compileKernel in batches. See
+  //! [ Note -- Batched compilation ] in kernel_cache.cpp.
+  void compileDeferredKernels(int8_t device_index);
+
   std::pair<LaunchParams, CompileParams> getKernelConfig(
       const KernelArgumentHolder& args,
       SegmentedGroup* sg);
@@ -274,6 +509,10 @@ class FusionKernelRuntime {
   // rather than storing the scheduled fusion directly.
   KernelArgumentHolder args_metadata_;
 
+  //! Contiguity flags of the tensor inputs of the fusion, which may have been
+  //! specialized to args_metadata_
+  std::vector<std::vector<std::optional<bool>>> input_contiguity_;
+
   //! Heuristics object holding scheduler entries for all segments
   HeuristicsPtr heuristics_;
 
@@ -284,6 +523,9 @@ class FusionKernelRuntime {
   //! Multi-Kernel fusion segment when applies
   std::unique_ptr<SegmentedFusion> segmented_fusion_ = nullptr;
 
+  //! See segmentationTimeMs()
+  double segmentation_time_ms_ = 0.0;
+
   //! Pre-allocated runtime workspace to speed up kernel launch preparation.
   RuntimeWorkSpace runtime_workspace_;
 
@@ -295,6 +537,9 @@ class FusionKernelRuntime {
   // States for profiling support
   bool profiling_ = false;
 
+  //! See collectMetrics()
+  FusionExecutorCacheMetrics* metrics_ = nullptr;
+
   //! Flag to indicate kernel timing measurement. Should be disabled
   //! unless benchmarking the kernel timing only as the measurement
   //! itself incurs an overhead.
@@ -303,6 +548,12 @@ class FusionKernelRuntime {
   //! The sum of the last kernel execution times
   float kernel_time_ms_ = 0;
 
+  //! Per group ID, the segmentStructureHash of the group and the
+  //! segmentCostKey of its last run, when the segmentation cost model is
+  //! enabled and the profiler runs with CUPTI
+  std::unordered_map<int64_t, uint64_t> segment_structure_hashes_;
+  std::unordered_map<int64_t, uint64_t> segment_cost_keys_;
+
   std::mutex mutex_;
 
   // ID of fusion in python frontend fusion cache, which maps to a single
@@ -320,6 +571,46 @@ class FusionKernelRuntime {
 
   // Whether to auto schedule the Fusion. If set to false, scheduling is skipped
   const bool auto_schedule_;
+
+  //! State of a CUDA graph captured for one input id
+  struct CudaGraphEntry {
+    CudaGraph graph;
+    //! Data pointers of the tensor inputs the graph currently reads from, or
+    //! nullptr for scalar inputs
+    std::vector<void*> input_ptrs;
+    //! Scalar inputs the graph was captured with. Their values are baked into
+    //! the kernel arguments, so a different value requires a new capture.
+    std::vector<PolymorphicValue> input_scalars;
+    //! Static output buffers written by each replay
+    std::vector<at::Tensor> outputs;
+    //! For each output aliasing an input, the index of that input and the
+    //! storage offset of the output relative to it. Such outputs are
+    //! re-derived from the current input at every replay.
+    std::vector<std::optional<std::pair<size_t, int64_t>>> output_aliases;
+  };
+
+  //! CUDA graphs indexed by input id. A nullptr entry records an input id
+  //! whose capture failed, so that it is not attempted again.
+  std::unordered_map<size_t, std::unique_ptr<CudaGraphEntry>> cuda_graphs_;
+
+  //! Graph currently being captured by runSegmentsWithInputs, if any
+  CudaGraph* capturing_graph_ = nullptr;
+
+  //! Runs the segments as one kernel with EnableOption::Megakernel
+  std::unique_ptr<Megakernel> megakernel_;
+
+  //! Runs the segments with EnableOption::HostIrRuntime. Runs on this path
+  //! hold host_ir_mutex_, and give the segments the cache id and device of
+  //! their arguments through host_ir_args_.
+  std::unique_ptr<hir::HostIrExecutor> host_ir_executor_;
+  std::mutex host_ir_mutex_;
+  const KernelArgumentHolder* host_ir_args_ = nullptr;
+
+  //! Slab shared by the intermediate buffers of all segments
+  IntermediateArena arena_;
+
+  //! Placements of the buffers in arena_ indexed by input id
+  std::unordered_map<size_t, ArenaPlan> arena_plans_;
 };
 
 //! Encoding an input set to unique id, which is used to short-cut cache entry
@@ -330,6 +621,12 @@ class FusionKernelRuntime {
 //! grow gigantic when we have input shapes that does not stabalize to a finite
 //! set.
 //!
+//! Inputs are encoded into a sequence of integers held on the stack. Entries
+//! live in an open-addressing hash table that lookups read without taking
+//! `mutex_`, so that threads hitting the same cache do not serialize. Only
+//! misses lock `mutex_` to insert and evict entries. Evicted entries and
+//! replaced tables are retired and freed once no lookup is in flight.
+//!
 //! \note the uniqueness of the ide generated for a given input set is only
 //!   local to the instance of `InputsIdLookup`.
 //!
@@ -337,8 +634,8 @@ class InputsIdLookup : public NonCopyable {
  public:
   //! constructor where maximum cache size is fixed during init
   // NOLINTNEXTLINE(cppcoreguidelines-pro-type-member-init,cppcoreguidelines-avoid-magic-numbers)
-  explicit InputsIdLookup(size_t max_cache_size = 100)
-      : max_cache_size_(max_cache_size) {}
+  explicit InputsIdLookup(size_t max_cache_size = 100);
+  ~InputsIdLookup();
 
   //! struct to hold return value for lookupId.
   struct IdLookupReturn {
@@ -378,9 +675,30 @@ class InputsIdLookup : public NonCopyable {
       const std::unordered_set<size_t>& scalar_inputs_to_record = {},
       int8_t device = 0);
 
+  //! Same as above for arguments that are already in a KernelArgumentHolder,
+  //! on its device. Both overloads return the same id for the same inputs.
+  NVF_API IdLookupReturn lookupId(
+      const KernelArgumentHolder& args,
+      const std::unordered_set<size_t>& scalar_inputs_to_record = {});
+
   //! debugging API that returns the size of lookup table
   size_t size() const {
-    return encoding_lookup_.size();
+    return num_entries_.load(std::memory_order_relaxed);
+  }
+
+  //! Number of lookups that found an existing id
+  uint64_t hits() const {
+    return num_lookups_.load(std::memory_order_relaxed) - misses();
+  }
+
+  //! Number of lookups that created a new id
+  uint64_t misses() const {
+    return num_misses_.load(std::memory_order_relaxed);
+  }
+
+  //! Number of ids evicted from the cache
+  uint64_t evictions() const {
+    return num_evictions_.load(std::memory_order_relaxed);
   }
 
   //! Serialize InputsIdLookup using flatbuffers
@@ -391,20 +709,53 @@ class InputsIdLookup : public NonCopyable {
   void deserialize(const serde::InputsIdLookup* buffer);
 
  private:
-  // string to store encoded input meta information. Reuse the buffer instead of
-  // stringtream gives few us perf gain.
-  std::string encoding_; // Note: shared state, guarded by mutex_
-
-  // mutex_ used to guard reused encoding_
-  std::mutex mutex_;
-
-  //! entry stored in `encoding_lookup_` to implement LRU
-  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-member-init)
+  //! An input set known by the cache. Only last_used is mutated once the entry
+  //! has been published to the table.
   struct EncodingEntry {
+    uint64_t hash = 0;
     size_t id = 0;
-    std::list<std::string>::iterator lru_iter;
+    std::vector<int64_t> encoding;
+    //! Value of num_lookups_ when the entry was last used, to implement LRU
+    std::atomic<uint64_t> last_used{0};
   };
 
+  //! Open-addressing hash table with linear probing. A null slot ends a probe
+  //! sequence and `tombstone()` marks the slot of an evicted entry.
+  struct Table {
+    explicit Table(size_t capacity)
+        : mask(capacity - 1),
+          slots(std::make_unique<std::atomic<EncodingEntry*>[]>(capacity)) {}
+    size_t mask = 0;
+    std::unique_ptr<std::atomic<EncodingEntry*>[]> slots;
+  };
+
+  static EncodingEntry* tombstone();
+
+  //! Returns the id of an encoded input set, see lookupId
+  IdLookupReturn lookupEncoding(const int64_t* encoding, size_t encoding_size);
+
+  //! Returns the entry of the given encoding in `table`, or nullptr
+  static EncodingEntry* find(
+      const Table* table,
+      uint64_t hash,
+      const int64_t* encoding,
+      size_t encoding_size);
+
+  //! Add an entry to the table, replacing the table if too few empty slots
+  //! are left. Must be called with mutex_ held.
+  void insert(std::unique_ptr<EncodingEntry> entry);
+
+  //! Evict the least recently used entry and return its id. Must be called
+  //! with mutex_ held.
+  size_t evictLeastRecentlyUsed();
+
+  //! Free the retired entries and tables if no lookup is in flight. Must be
+  //! called with mutex_ held.
+  void reclaim();
+
+  //! mutex_ used to guard insertion and eviction of entries
+  std::mutex mutex_;
+
   //! maximum cache size for LRU
   size_t max_cache_size_ = 0;
 
@@ -412,15 +763,29 @@ class InputsIdLookup : public NonCopyable {
   //! conflicts
   size_t current_id_ = 1;
 
-  //! entry in the cache, This is used to implement LRU cache, where entries in
-  //! the list is ordered by their recent usage (freshly used entry is placed at
-  //! the beginning)
-  std::list<std::string> used_entry_;
+  //! Table read by lookups. It is owned by `table_owner_`.
+  std::atomic<Table*> table_{nullptr};
+  std::unique_ptr<Table> table_owner_;
+
+  //! Entries referenced by the table, guarded by mutex_
+  std::unordered_map<EncodingEntry*, std::unique_ptr<EncodingEntry>> entries_;
+
+  //! Number of tombstones in the table, guarded by mutex_
+  size_t num_tombstones_ = 0;
 
-  //! map from `std::string` to a unique id `size_t` (packaged in
-  //! `EncodingEntry`
-  //! ). We store an iterator to `used_entry_` to implement LRU
-  std::unordered_map<std::string, EncodingEntry> encoding_lookup_;
+  //! Entries and tables that in-flight lookups might still be reading,
+  //! guarded by mutex_
+  std::vector<std::unique_ptr<EncodingEntry>> retired_entries_;
+  std::vector<std::unique_ptr<Table>> retired_tables_;
+
+  //! Number of lookups currently reading the table
+  std::atomic<int64_t> num_readers_{0};
+
+  //! Statistics. num_lookups_ also serves as the clock of the LRU policy.
+  std::atomic<size_t> num_entries_{0};
+  std::atomic<uint64_t> num_lookups_{0};
+  std::atomic<uint64_t> num_misses_{0};
+  std::atomic<uint64_t> num_evictions_{0};
 };
 
 //! [ Note -- Post-definition cache implementation ]
@@ -516,6 +881,8 @@ class FusionExecutorCache {
       int64_t fusion_id = 0,
       bool auto_schedule = true);
 
+  NVF_API ~FusionExecutorCache();
+
   //! Execute fusion graph with given inputs, create `FusionExecutor` as needed
   //! Note this function also handles permutation & input update outside of
   //! codegen.
@@ -525,10 +892,25 @@ class FusionExecutorCache {
   //! cases as our analysis of index type may be overly conservative
   //! for intermediate tensors.
   //! WARING: Correctness is not guaranteed.
+  //!
+  //! If `output_buffers` is not empty, it holds one tensor for each of the
+  //! returned outputs, which is then written to that tensor instead of a
+  //! newly allocated one and returned. Undefined tensors are allocated as
+  //! usual. See [ Note -- Output buffers ] in kernel_cache.cpp.
   NVF_API std::vector<at::Tensor> runFusionWithInputs(
       const at::ArrayRef<c10::IValue>& inputs,
       std::optional<PrimDataType> forced_index_type = std::nullopt,
-      std::optional<int8_t> selected_device = std::nullopt);
+      std::optional<int8_t> selected_device = std::nullopt,
+      const std::vector<at::Tensor>& output_buffers = {});
+
+  //! Same as runFusionWithInputs for arguments that are already in a
+  //! KernelArgumentHolder, whose device index must be set. This skips the
+  //! conversion of the inputs from IValue, e.g., for C++ embedders that push
+  //! their tensors with KernelArgumentHolder::pushTensor.
+  NVF_API std::vector<at::Tensor> runFusionWithArgs(
+      KernelArgumentHolder args,
+      std::optional<PrimDataType> forced_index_type = std::nullopt,
+      const std::vector<at::Tensor>& output_buffers = {});
 
   //! Converts inputs from IValue to KernelArgumentHolder, also handles cache
   //! lookup
@@ -536,11 +918,31 @@ class FusionExecutorCache {
       const at::ArrayRef<c10::IValue>& inputs,
       std::optional<int8_t> selected_device = std::nullopt);
 
+  //! Sets the cache id of `args`
+  void prepareArgs(KernelArgumentHolder& args);
+
+  //! Device memory needed to run the fusion with the given inputs, which only
+  //! need to carry metadata. This segments the fusion for these inputs if
+  //! needed, without compiling it. See [ Note -- Memory plan ] in
+  //! kernel_cache.cpp.
+  NVF_API MemoryPlan
+  planMemory(const at::ArrayRef<c10::IValue>& inputs, int8_t device = 0);
+
   //! query if there's a kernel ready to go for given inputs
   NVF_API bool isCompiled(
       const at::ArrayRef<c10::IValue>& inputs,
       int8_t device = 0);
 
+  //! Segment, schedule and compile the fusion ahead of time for each of the
+  //! given input sets, so that later calls to runFusionWithInputs with the
+  //! same shapes find a compiled kernel runtime. Tensor inputs only need to
+  //! carry metadata, e.g. they can be meta tensors. Runtimes are created one
+  //! input set at a time, while their kernels are compiled concurrently. The
+  //! compiled cache can then be saved with FusionCache::serialize.
+  NVF_API void warmup(
+      const std::vector<std::vector<c10::IValue>>& input_sets,
+      int8_t device = 0);
+
   Fusion* fusion() {
     return fusion_.get();
   }
@@ -554,7 +956,17 @@ class FusionExecutorCache {
   }
 
   FusionKernelRuntime* getMostRecentKernelRuntime() const {
-    return most_recent_runtime_;
+    return most_recent_runtime_.load();
+  }
+
+  //! Counters collected with NVFUSER_ENABLE=runtime_metrics
+  const FusionExecutorCacheMetrics& metrics() const {
+    return metrics_;
+  }
+
+  void resetMetrics() {
+    metrics_ = FusionExecutorCacheMetrics();
+    sampled_timer_.reset();
   }
 
   //! Gets the kernel code for the associated runtime
@@ -582,8 +994,9 @@ class FusionExecutorCache {
   //  to capture runtime profiling info. We also need to define
   //  a suitable profiling window / buffer size.
   ExecutorLog getMostRecentExecutorInfo() {
-    NVF_ERROR(most_recent_runtime_ != nullptr);
-    return most_recent_runtime_->getMostRecentExecutorLog();
+    FusionKernelRuntime* kernel_runtime = getMostRecentKernelRuntime();
+    NVF_ERROR(kernel_runtime != nullptr);
+    return kernel_runtime->getMostRecentExecutorLog();
   }
 
   //! Get all cached runtimes
@@ -591,6 +1004,21 @@ class FusionExecutorCache {
     return kernel_runtimes_;
   }
 
+  //! Number of runtimes created for each shape bucket, keyed by the bucketed
+  //! extents of all tensor inputs. Buckets whose inputs only reused existing
+  //! runtimes map to zero. See [ Note -- Shape buckets ] in kernel_cache.cpp.
+  const std::map<std::vector<int64_t>, int64_t>& shapeBucketRuntimeCounts()
+      const {
+    return shape_bucket_runtime_counts_;
+  }
+
+  //! Segmentation cache of the runtimes created for `device` with the given
+  //! concretization, or nullptr if there is none. See
+  //! [ Note -- Segmentation cache ] in fusion_segmenter.cpp.
+  const SegmentationCache* segmentationCache(
+      int8_t device = 0,
+      const DynamicTransformConcretizationInfo* conc_info = nullptr) const;
+
   //! Count concretizations. Note that each might have multiple
   //! FusionKernelRuntimes. If device is given, count only concretizations on
   //! the given device; otherwise count concretizations on all devices.
@@ -646,6 +1074,15 @@ class FusionExecutorCache {
     }
   }
 
+  //! Internal knob for profiling kernel argument packing
+  void disableKernelArgPatching() {
+    for (auto& it : kernel_runtimes_) {
+      for (auto& kernel_runtime : it.second) {
+        kernel_runtime->disableKernelArgPatching();
+      }
+    }
+  }
+
   //! Enable kernel time measurement through FusionKernelRuntime. See
   //! FusionKernelRuntime::enableKernelTimeMeasurement() as well
   void enableKernelTimeMeasurement() {
@@ -668,8 +1105,18 @@ class FusionExecutorCache {
   flatbuffers::Offset<serde::FusionExecutorCache> serialize(
       flatbuffers::FlatBufferBuilder& builder) const;
 
-  //! Deserialize Fusion Executor Cache using flatbuffers
-  void deserialize(const serde::FusionExecutorCache* buffer, int64_t fusion_id);
+  //! Deserialize Fusion Executor Cache using flatbuffers. If lazy, only the
+  //! buffer is kept, which must outlive this cache, and its runtimes are
+  //! deserialized when the cache is first used. See [ Note -- Lazy
+  //! deserialization ] in kernel_cache.cpp.
+  void deserialize(
+      const serde::FusionExecutorCache* buffer,
+      int64_t fusion_id,
+      bool lazy = false);
+
+  //! Finish a lazy deserialization, if any. This is called before looking up
+  //! inputs, and must be called before serializing the cache.
+  NVF_API void ensureDeserialized();
 
   //! Allocate the outputs of the Fusion given inputs
   //! TODO: re-implement
@@ -683,18 +1130,91 @@ class FusionExecutorCache {
   //! entry in `FusionExecutor`
   void evictCache(size_t cache_id);
 
+  //! Destroy `kernel_runtime` and forget the input ids using it. See
+  //! [ Note -- Runtime cache budget ] in kernel_cache.cpp.
+  void evictRuntime(FusionKernelRuntime* kernel_runtime);
+  friend class RuntimeCacheBudget;
+
+  //! The runtime last used with the input id of `args`, if its index type
+  //! matches `forced_index_type`, or nullptr. Must be called with
+  //! runtimes_mutex_ held, shared or not.
+  FusionKernelRuntime* cachedKernelRuntime(
+      const KernelArgumentHolder& args,
+      std::optional<PrimDataType> forced_index_type) const;
+
+  //! Whether runs may share runtimes_mutex_, i.e. whether nothing but the
+  //! runtime lookup and the executors is updated by a run. See
+  //! [ Note -- Concurrent runs ] in kernel_cache.cpp.
+  bool canRunConcurrently() const;
+
   //! The index type of forced_index_type is used to get a kernel
-  //! runtime no matter what sizes inputs have
+  //! runtime no matter what sizes inputs have. Must be called with
+  //! runtimes_mutex_ held exclusively.
   FusionKernelRuntime* getKernelRuntimeFor(
       const KernelArgumentHolder& inputs,
       std::optional<PrimDataType> forced_index_type = std::nullopt);
 
+  //! A compiled runtime of another device of the same model as
+  //! `device_index`, with the concretization `conc_info` and the input
+  //! contiguity `input_contiguity`, whose heuristics can be reused for
+  //! `args`, or nullptr. See [ Note -- Runtimes shared
+  //! across devices ] in kernel_cache.cpp.
+  FusionKernelRuntime* findPeerDeviceRuntime(
+      int8_t device_index,
+      const DynamicTransformConcretizationInfo* conc_info,
+      const KernelArgumentHolder& args,
+      const std::vector<std::vector<std::optional<bool>>>& input_contiguity,
+      std::optional<PrimDataType> forced_index_type);
+
+  //! Runs the fusion once `args` are prepared. The profiler, if enabled, must
+  //! already be started. Unless `allow_batching` is false, the run may be
+  //! coalesced with concurrent ones, see runBatched.
+  std::vector<at::Tensor> runPreparedArgs(
+      KernelArgumentHolder& args,
+      std::optional<PrimDataType> forced_index_type,
+      const std::vector<at::Tensor>& output_buffers,
+      bool allow_batching = true);
+
+  //! Whether the rows of the leading dimension of the inputs and outputs are
+  //! independent, so that runs can be batched along it. Computed once. See
+  //! [ Note -- Request batching ] in kernel_cache.cpp.
+  bool isBatchable();
+
+  //! Runs `args` in a batch with the concurrent runs of the same `batch_key`.
+  //! See [ Note -- Request batching ] in kernel_cache.cpp.
+  std::vector<at::Tensor> runBatched(
+      KernelArgumentHolder& args,
+      const std::vector<int64_t>& batch_key);
+
   //! Get initial concretization info (without inputs). This computes the info
   //! if it has not yet been computed, then caches it for later use. This means
   //! this method should not be called until the definition of the Fusion is
   //! finalized.
   DynamicTransformInitialInfo& initialInfo();
 
+  //! Evaluate the fusion with ATen while the kernels of `kernel_runtime` are
+  //! compiled in the background, starting the compilation if needed. Returns
+  //! std::nullopt once the kernels are compiled, or if the fusion cannot be
+  //! evaluated with ATen, in which case this waits for the compilation. See
+  //! [ Note -- Async compilation ] in kernel_cache.cpp.
+  std::optional<std::vector<at::Tensor>> runFallbackWhileCompiling(
+      FusionKernelRuntime* kernel_runtime,
+      const KernelArgumentHolder& args);
+
+  //! Wait for the background compilation of `kernel_runtime`, if any, and
+  //! rethrow its error
+  void waitForCompilation(FusionKernelRuntime* kernel_runtime);
+
+  //! Collect the kernel time of the previous sampled run if it is available,
+  //! and return a started timer if the current run is to be sampled. See
+  //! [ Note -- Runtime metrics ].
+  std::unique_ptr<CudaEventTimer> maybeStartKernelTimer(int8_t device);
+
+  //! Deserialize the input id lookup table and all runtimes of buffer
+  void deserializeRuntimes(
+      const serde::FusionExecutorCache* buffer,
+      bool in_place);
+
  private:
   //! original un-scheduled `Fusion`. This may contain dynamic transforms and
   //! Symbolic IterDomains.
@@ -748,13 +1268,63 @@ class FusionExecutorCache {
   //! short-cut for cache hit
   std::unordered_map<size_t, FusionKernelRuntime*> id_to_kernel_runtime_;
 
+  //! Table left by a lazy deserialize until ensureDeserialized is called
+  const serde::FusionExecutorCache* lazy_serde_buffer_ = nullptr;
+  std::once_flag lazy_serde_flag_;
+  bool lazy_serde_done_ = false;
+
+  //! Number of runtimes created per shape bucket
+  std::map<std::vector<int64_t>, int64_t> shape_bucket_runtime_counts_;
+
+  //! The runtime picked for each shape bucket, keyed by the metadata of the
+  //! bucketed arguments, and the launch params of its heuristics for them.
+  //! See [ Note -- Shape buckets ] in kernel_cache.cpp.
+  struct ShapeBucketRuntime {
+    FusionKernelRuntime* kernel_runtime = nullptr;
+    std::vector<LaunchParams> launch_params;
+  };
+  std::map<std::vector<int64_t>, ShapeBucketRuntime> shape_bucket_runtimes_;
+
+  //! Segmentations shared by the runtimes of each concretization. See
+  //! [ Note -- Segmentation cache ] in fusion_segmenter.cpp.
+  std::unordered_map<
+      ConcreteInfo,
+      std::unique_ptr<SegmentationCache>,
+      PairPointerHash,
+      PairPointerEquals>
+      segmentation_caches_;
+
   //! Profiling info:
   //! TODO: this can be largely expanded to look at complete
   //!   caching profiles. Currently it just makes it easier to test
-  FusionKernelRuntime* most_recent_runtime_ = nullptr;
+  std::atomic<FusionKernelRuntime*> most_recent_runtime_{nullptr};
+
+  //! Shared by the runs hitting a compiled runtime, and held exclusively by
+  //! the others and to evict runtimes and input ids. See
+  //! [ Note -- Concurrent runs ] and [ Note -- Runtime cache budget ] in
+  //! kernel_cache.cpp.
+  std::shared_mutex runtimes_mutex_;
+
+  //! See metrics()
+  FusionExecutorCacheMetrics metrics_;
+  //! Timer of the most recent sampled run, read once its kernels are done
+  std::unique_ptr<CudaEventTimer> sampled_timer_;
 
   //! Initial concretization info
   std::optional<DynamicTransformInitialInfo> initial_info_ = std::nullopt;
+  std::once_flag initial_info_flag_;
+
+  //! See isBatchable()
+  bool batchable_ = false;
+  std::once_flag batchable_flag_;
+
+  //! Batches of concurrent runs, by the key of their arguments, that are still
+  //! open for runs to join. See [ Note -- Request batching ] in
+  //! kernel_cache.cpp.
+  struct RequestBatch;
+  std::map<std::vector<int64_t>, std::shared_ptr<RequestBatch>> open_batches_;
+  std::mutex batches_mutex_;
+  std::condition_variable batches_cv_;
 
   // ID of fusion in python frontend fusion cache, which maps to a single
   // FusionExecutorCache.
@@ -762,6 +1332,20 @@ class FusionExecutorCache {
 
   // Whether to auto schedule the Fusion. If set to false, scheduling is skipped
   const bool auto_schedule_;
+
+  //! State of a FusionKernelRuntime compiled in the background
+  struct PendingCompilation {
+    //! Returns the compilation time in ns
+    std::future<int64_t> compiled;
+    //! Copy of the complete fusion of the runtime, evaluated with ATen until
+    //! the kernels are compiled. nullptr if it cannot be evaluated that way.
+    std::unique_ptr<Fusion> fallback;
+  };
+
+  //! Runtimes being compiled in the background. Declared last so that the
+  //! compilations are waited for before the runtimes are destroyed.
+  std::unordered_map<FusionKernelRuntime*, PendingCompilation>
+      pending_compilations_;
 };
 
 } // namespace nvfuser
@@ -0,0 +1,449 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+
+#include <instrumentation.h>
+#include <kernel_db/compile_server.h>
+#include <options.h>
+#include <utils.h>
+
+namespace nvfuser {
+
+// [ Note -- Compile server ]
+//
+// Every process of a node, e.g., each rank of a data parallel job, compiles
+// the kernels of a new shape on its own, so the first iteration of 8 ranks
+// runs 8 identical NVRTC compilations competing for the CPUs. KernelDb
+// doesn't help, since every process misses the db before any of them has
+// written the kernel.
+//
+// With EnableOption::CompileServer, getCompiledKernel sends the compilations
+// missing KernelDb to a server listening on a unix domain socket,
+// $TMPDIR/nvfuser_compile_server_<uid>.sock by default. The first process
+// enabling the option hosts the server on background threads and holds an
+// flock on <socket>.lock, so that the other processes connect to it instead.
+// The server
+//  - keys requests by their code, function name, NVRTC options and target,
+//    so identical requests in flight wait for a single compilation, whose
+//    binary is sent to each of them,
+//  - keeps the results of the last kMaxKeptResults compilations for the
+//    processes arriving once a compilation is done, and
+//  - compiles at most max_parallel requests at once, half of the hardware
+//    threads by default, e.g., compile_server(/tmp/nvfuser.sock,8).
+// The compilation work of a node then scales with the number of distinct
+// kernels rather than with the number of processes.
+//
+// The NVRTC options of a request include the target architecture, so
+// processes driving different GPUs share the server. Any failure, e.g., a
+// request that doesn't compile or a hosting process that exited, makes the
+// client compile the kernel itself, which reports compile errors as usual.
+// Once the hosting process exits, the next process to compile a kernel finds
+// the lock free and hosts the server.
+
+namespace {
+
+constexpr uint64_t server_magic = 0x31565253564e4b4eULL; // "NKNVSRV1"
+constexpr int64_t kMaxKeptResults = 64;
+constexpr uint64_t kMaxMessageBytes = 1ULL << 30;
+constexpr uint64_t kMaxOptions = 1024;
+//! Time a connection may take to send its request
+constexpr time_t kRequestTimeoutSeconds = 60;
+
+bool sendAll(int fd, const void* data, size_t size) {
+  const char* ptr = static_cast<const char*>(data);
+  while (size > 0) {
+    const ssize_t sent = send(fd, ptr, size, MSG_NOSIGNAL);
+    if (sent < 0 && errno == EINTR) {
+      continue;
+    }
+    if (sent <= 0) {
+      return false;
+    }
+    ptr += sent;
+    size -= (size_t)sent;
+  }
+  return true;
+}
+
+bool recvAll(int fd, void* data, size_t size) {
+  char* ptr = static_cast<char*>(data);
+  while (size > 0) {
+    const ssize_t received = recv(fd, ptr, size, 0);
+    if (received < 0 && errno == EINTR) {
+      continue;
+    }
+    if (received <= 0) {
+      return false;
+    }
+    ptr += received;
+    size -= (size_t)received;
+  }
+  return true;
+}
+
+bool sendValue(int fd, uint64_t value) {
+  return sendAll(fd, &value, sizeof(value));
+}
+
+bool recvValue(int fd, uint64_t& value) {
+  return recvAll(fd, &value, sizeof(value));
+}
+
+//! Send a std::string or std::vector<char> preceded by its size
+template <typename T>
+bool sendBytes(int fd, const T& bytes) {
+  return sendValue(fd, bytes.size()) &&
+      sendAll(fd, bytes.data(), bytes.size());
+}
+
+template <typename T>
+bool recvBytes(int fd, T& bytes) {
+  uint64_t size = 0;
+  if (!recvValue(fd, size) || size > kMaxMessageBytes) {
+    return false;
+  }
+  bytes.resize(size);
+  return recvAll(fd, bytes.data(), size);
+}
+
+bool sendRequest(int fd, const CompileRequest& request) {
+  if (!sendValue(fd, server_magic) || !sendBytes(fd, request.code) ||
+      !sendBytes(fd, request.func_name) || !sendBytes(fd, request.id) ||
+      !sendValue(fd, request.options.size())) {
+    return false;
+  }
+  for (const std::string& option : request.options) {
+    if (!sendBytes(fd, option)) {
+      return false;
+    }
+  }
+  return sendValue(fd, request.compile_to_sass ? 1 : 0);
+}
+
+bool recvRequest(int fd, CompileRequest& request) {
+  uint64_t magic = 0;
+  uint64_t num_options = 0;
+  uint64_t compile_to_sass = 0;
+  if (!recvValue(fd, magic) || magic != server_magic ||
+      !recvBytes(fd, request.code) || !recvBytes(fd, request.func_name) ||
+      !recvBytes(fd, request.id) || !recvValue(fd, num_options) ||
+      num_options > kMaxOptions) {
+    return false;
+  }
+  request.options.resize(num_options);
+  for (std::string& option : request.options) {
+    if (!recvBytes(fd, option)) {
+      return false;
+    }
+  }
+  if (!recvValue(fd, compile_to_sass)) {
+    return false;
+  }
+  request.compile_to_sass = compile_to_sass != 0;
+  return true;
+}
+
+//! A response is a status, 1 if the request compiled, followed by the
+//! compiled program
+bool sendResponse(int fd, const std::optional<CompileResponse>& response) {
+  if (!sendValue(fd, response.has_value() ? 1 : 0)) {
+    return false;
+  }
+  return !response.has_value() ||
+      (sendBytes(fd, response->kernel_name) &&
+       sendBytes(fd, response->compile_log) && sendBytes(fd, response->ptx) &&
+       sendBytes(fd, response->cubin));
+}
+
+std::optional<CompileResponse> recvResponse(int fd) {
+  uint64_t status = 0;
+  CompileResponse response;
+  if (!recvValue(fd, status) || status != 1 ||
+      !recvBytes(fd, response.kernel_name) ||
+      !recvBytes(fd, response.compile_log) || !recvBytes(fd, response.ptx) ||
+      !recvBytes(fd, response.cubin)) {
+    return std::nullopt;
+  }
+  return response;
+}
+
+//! Everything but the id, which only names the program
+std::string requestKey(const CompileRequest& request) {
+  std::string key = request.compile_to_sass ? "sass" : "ptx";
+  for (const std::string& option : request.options) {
+    key += '\0' + option;
+  }
+  key += '\0' + request.func_name + '\0' + request.code;
+  return key;
+}
+
+std::optional<sockaddr_un> socketAddress(const std::string& socket_path) {
+  sockaddr_un address{};
+  if (socket_path.empty() || socket_path.size() >= sizeof(address.sun_path)) {
+    return std::nullopt;
+  }
+  address.sun_family = AF_UNIX;
+  std::memcpy(address.sun_path, socket_path.c_str(), socket_path.size());
+  return address;
+}
+
+std::string defaultSocketPath() {
+  return (std::filesystem::temp_directory_path() /
+          ("nvfuser_compile_server_" + std::to_string(getuid()) + ".sock"))
+      .string();
+}
+
+} // namespace
+
+CompileServer::CompileServer(
+    std::string socket_path,
+    int64_t max_parallel,
+    CompileFunction compile)
+    : socket_path_(std::move(socket_path)),
+      max_parallel_(std::max(max_parallel, (int64_t)1)),
+      compile_(std::move(compile)),
+      pid_((int64_t)getpid()) {
+  const std::optional<sockaddr_un> address = socketAddress(socket_path_);
+  if (!address.has_value()) {
+    TORCH_WARN("Compile server: invalid socket path: ", socket_path_);
+    return;
+  }
+  const std::string lock_path = socket_path_ + ".lock";
+  lock_fd_ = open(lock_path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+  if (lock_fd_ < 0) {
+    return;
+  }
+  // Another process serves
+  if (flock(lock_fd_, LOCK_EX | LOCK_NB) != 0) {
+    close(lock_fd_);
+    lock_fd_ = -1;
+    return;
+  }
+
+  // The socket of a server whose process exited is left behind
+  unlink(socket_path_.c_str());
+  const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0 ||
+      bind(fd, reinterpret_cast<const sockaddr*>(&address.value()),
+           sizeof(sockaddr_un)) != 0 ||
+      listen(fd, SOMAXCONN) != 0) {
+    TORCH_WARN(
+        "Compile server: unable to listen on ",
+        socket_path_,
+        ": ",
+        std::strerror(errno));
+    if (fd >= 0) {
+      close(fd);
+    }
+    flock(lock_fd_, LOCK_UN);
+    close(lock_fd_);
+    lock_fd_ = -1;
+    return;
+  }
+  listen_fd_ = fd;
+  accept_thread_ = std::thread([this]() { acceptConnections(); });
+}
+
+CompileServer::~CompileServer() {
+  if (!serving()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    stopping_ = true;
+  }
+  // Wakes up accept
+  shutdown(listen_fd_, SHUT_RDWR);
+  accept_thread_.join();
+  close(listen_fd_);
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this]() { return num_connections_ == 0; });
+  }
+  unlink(socket_path_.c_str());
+  flock(lock_fd_, LOCK_UN);
+  close(lock_fd_);
+}
+
+int64_t CompileServer::numCompilations() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return num_compilations_;
+}
+
+void CompileServer::releaseAfterFork() {
+  // Closing the inherited descriptors, unlike unlocking them, leaves the
+  // socket and the lock of the parent alone
+  if (listen_fd_ >= 0) {
+    close(listen_fd_);
+    listen_fd_ = -1;
+  }
+  if (lock_fd_ >= 0) {
+    close(lock_fd_);
+    lock_fd_ = -1;
+  }
+}
+
+void CompileServer::acceptConnections() {
+  while (true) {
+    const int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+    if (fd < 0) {
+      {
+        std::lock_guard<std::mutex> guard(mutex_);
+        if (stopping_) {
+          return;
+        }
+      }
+      // E.g. out of descriptors, which connections release
+      if (errno != EINTR && errno != ECONNABORTED) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      }
+      continue;
+    }
+    timeval timeout{};
+    timeout.tv_sec = kRequestTimeoutSeconds;
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      ++num_connections_;
+    }
+    std::thread([this, fd]() { serveConnection(fd); }).detach();
+  }
+}
+
+void CompileServer::serveConnection(int fd) {
+  CompileRequest request;
+  if (recvRequest(fd, request)) {
+    sendResponse(fd, compile(requestKey(request), request));
+  }
+  close(fd);
+  std::lock_guard<std::mutex> guard(mutex_);
+  --num_connections_;
+  cv_.notify_all();
+}
+
+std::optional<CompileResponse> CompileServer::compile(
+    const std::string& key,
+    const CompileRequest& request) {
+  std::promise<std::optional<CompileResponse>> promise;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto it = results_.find(key);
+    if (it != results_.end()) {
+      Result result = it->second;
+      lock.unlock();
+      return result.get();
+    }
+    // Identical requests wait for this one from now on, including while it
+    // waits for a compilation slot
+    results_.emplace(key, promise.get_future().share());
+    cv_.wait(lock, [this]() { return num_compiling_ < max_parallel_; });
+    ++num_compiling_;
+  }
+
+  std::optional<CompileResponse> response;
+  {
+    FUSER_PERF_SCOPE("CompileServer::compile");
+    try {
+      response = compile_(request);
+    } catch (const std::exception&) {
+      // The clients compile the request themselves and report the error
+    }
+  }
+  promise.set_value(response);
+
+  std::lock_guard<std::mutex> guard(mutex_);
+  --num_compiling_;
+  ++num_compilations_;
+  if (response.has_value()) {
+    compiled_keys_.push_back(key);
+    if ((int64_t)compiled_keys_.size() > kMaxKeptResults) {
+      results_.erase(compiled_keys_.front());
+      compiled_keys_.pop_front();
+    }
+  } else {
+    results_.erase(key);
+  }
+  cv_.notify_all();
+  return response;
+}
+
+std::optional<CompileResponse> CompileServer::request(
+    const std::string& socket_path,
+    const CompileRequest& compile_request) {
+  const std::optional<sockaddr_un> address = socketAddress(socket_path);
+  if (!address.has_value()) {
+    return std::nullopt;
+  }
+  const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    return std::nullopt;
+  }
+  std::optional<CompileResponse> response;
+  if (connect(
+          fd,
+          reinterpret_cast<const sockaddr*>(&address.value()),
+          sizeof(sockaddr_un)) == 0 &&
+      sendRequest(fd, compile_request)) {
+    response = recvResponse(fd);
+  }
+  close(fd);
+  return response;
+}
+
+std::optional<CompileResponse> compileOnServer(
+    const CompileRequest& request,
+    const CompileFunction& compile) {
+  if (!isOptionEnabled(EnableOption::CompileServer)) {
+    return std::nullopt;
+  }
+  const std::vector<std::string>& args =
+      getEnableOptionArguments(EnableOption::CompileServer);
+  const std::string socket_path =
+      args.empty() ? defaultSocketPath() : args.at(0);
+  int64_t max_parallel =
+      std::max((int64_t)std::thread::hardware_concurrency() / 2, (int64_t)1);
+  if (args.size() > 1) {
+    try {
+      max_parallel = std::stoll(args.at(1));
+    } catch (const std::exception&) {
+      TORCH_WARN(
+          "Compile server: invalid number of parallel compilations: ",
+          args.at(1));
+    }
+  }
+
+  {
+    // Host the server unless another process does. It is never destroyed,
+    // its threads end with the process.
+    static std::mutex server_mutex;
+    static CompileServer* server = nullptr;
+    std::lock_guard<std::mutex> guard(server_mutex);
+    if (server != nullptr && server->pid() != (int64_t)getpid()) {
+      server->releaseAfterFork();
+      server = nullptr;
+    }
+    if (server == nullptr || !server->serving()) {
+      delete server;
+      server = new CompileServer(socket_path, max_parallel, compile);
+    }
+  }
+  return CompileServer::request(socket_path, request);
+}
+
+} // namespace nvfuser
@@ -0,0 +1,137 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <visibility.h>
+
+namespace nvfuser {
+
+//! An NVRTC compilation delegated to the compile server
+struct CompileRequest {
+  //! Full source code of the program
+  std::string code;
+  std::string func_name;
+  //! Name of the program, which is not part of the key of the request
+  std::string id;
+  //! NVRTC options, which include the target architecture
+  std::vector<std::string> options;
+  bool compile_to_sass = false;
+};
+
+//! The program compiled for a CompileRequest
+struct CompileResponse {
+  std::string kernel_name;
+  std::string compile_log;
+  std::vector<char> ptx;
+  std::vector<char> cubin;
+};
+
+//! Compiles a request in the process hosting the compile server. Throws if the
+//! request does not compile.
+using CompileFunction = std::function<CompileResponse(const CompileRequest&)>;
+
+//! A compile server shared by the processes of a node through a unix domain
+//! socket. Identical requests in flight are compiled once, and at most
+//! max_parallel requests are compiled at once. See [ Note -- Compile server ]
+//! in compile_server.cpp
+class CompileServer {
+ public:
+  //! Serve on socket_path, unless another process already does, in which case
+  //! serving() is false
+  NVF_API CompileServer(
+      std::string socket_path,
+      int64_t max_parallel,
+      CompileFunction compile);
+  NVF_API ~CompileServer();
+
+  CompileServer(const CompileServer&) = delete;
+  CompileServer& operator=(const CompileServer&) = delete;
+
+  bool serving() const {
+    return listen_fd_ >= 0;
+  }
+
+  //! Process that created the server, whose threads do not survive a fork
+  int64_t pid() const {
+    return pid_;
+  }
+
+  //! Number of requests compiled by this server
+  NVF_API int64_t numCompilations() const;
+
+  //! Close the descriptors a forked child inherited from the server of its
+  //! parent, without stopping it. The threads of the parent are not those of
+  //! the child, so the server is then leaked rather than destroyed.
+  void releaseAfterFork();
+
+  //! Send request to the server listening on socket_path. Returns
+  //! std::nullopt if no server listens there or it could not compile request.
+  NVF_API static std::optional<CompileResponse> request(
+      const std::string& socket_path,
+      const CompileRequest& compile_request);
+
+ private:
+  //! Result of a request, shared by the connections waiting for it. Empty if
+  //! the request did not compile.
+  using Result = std::shared_future<std::optional<CompileResponse>>;
+
+  void acceptConnections();
+
+  void serveConnection(int fd);
+
+  //! Compile the request serialized as key, unless it is in flight or was
+  //! compiled recently
+  std::optional<CompileResponse> compile(
+      const std::string& key,
+      const CompileRequest& request);
+
+ private:
+  const std::string socket_path_;
+  const int64_t max_parallel_;
+  const CompileFunction compile_;
+  const int64_t pid_;
+
+  //! Lock file held while serving, so that a single process serves
+  int lock_fd_ = -1;
+  int listen_fd_ = -1;
+  std::thread accept_thread_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  //! Results of the requests in flight and of the last compiled ones, keyed
+  //! by the serialized request
+  std::unordered_map<std::string, Result> results_;
+  //! Keys of the compiled results, oldest first
+  std::deque<std::string> compiled_keys_;
+  bool stopping_ = false;
+  int64_t num_compiling_ = 0;
+  int64_t num_connections_ = 0;
+  int64_t num_compilations_ = 0;
+};
+
+//! Compile request on the compile server of the node, hosting it in this
+//! process with compile if no process does. Returns std::nullopt if
+//! EnableOption::CompileServer is not set or the server fails, in which case
+//! the caller compiles request itself.
+std::optional<CompileResponse> compileOnServer(
+    const CompileRequest& request,
+    const CompileFunction& compile);
+
+} // namespace nvfuser
@@ -5,37 +5,129 @@
  * SPDX-License-Identifier: BSD-3-Clause
  */
 // clang-format on
-#include <fstream>
+#include <fcntl.h>
+#include <nvrtc.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
 #include <mutex>
-#include <regex>
+#include <sstream>
 
+#include <cuda_utils.h>
 #include <instrumentation.h>
 #include <kernel_db/kernel_db.h>
 #include <kernel_db/utils.h>
 #include <options.h>
 #include <utils.h>
 
+#include <c10/util/irange.h>
+
 namespace nvfuser {
 
 static std::mutex kernel_db_lock;
 
+namespace {
+
+constexpr uint64_t index_magic = 0x31584449564e4b4eULL; // "NKNVIDX1"
+constexpr uint64_t entry_magic = 0x31594e45564e4b4eULL; // "NKNVENY1"
+
+//! Header of the index file
+struct IndexHeader {
+  uint64_t magic = index_magic;
+  uint64_t record_size = sizeof(KernelDbIndexRecord);
+};
+
+//! Header of an entry file. It is followed by the kernel signature, the
+//! compile args, the kernel code and the cubin, in that order.
+struct EntryHeader {
+  uint64_t magic = entry_magic;
+  uint64_t signature_size = 0;
+  uint64_t compile_args_size = 0;
+  uint64_t code_size = 0;
+  uint64_t cubin_size = 0;
+};
+
+int64_t now() {
+  return std::chrono::duration_cast<std::chrono::seconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+void hashBytes(uint64_t& hash, const char* data, size_t size) {
+  // 64-bit FNV-1a. Unlike std::hash, it is stable across processes and
+  // standard library implementations.
+  for (const auto i : c10::irange(size)) {
+    hash ^= static_cast<unsigned char>(data[i]);
+    hash *= 0x100000001b3ULL;
+  }
+}
+
+//! Lock the index file for the lifetime of this object. Locks are advisory and
+//! held per open file description, so they also order the writes of different
+//! processes sharing the db directory.
+class IndexLock {
+ public:
+  IndexLock(int fd, bool exclusive) : fd_(fd) {
+    locked_ = flock(fd_, exclusive ? LOCK_EX : LOCK_SH) == 0;
+  }
+  ~IndexLock() {
+    if (locked_) {
+      flock(fd_, LOCK_UN);
+    }
+  }
+  bool locked() const {
+    return locked_;
+  }
+
+ private:
+  int fd_;
+  bool locked_ = false;
+};
+
+} // namespace
+
 KernelDb::KernelDb(bool _disabled)
     : disabled_(_disabled),
       initialized_(false),
       kernel_map_(),
       kernel_db_path_(),
-      kernel_db_txt_file_() {}
+      kernel_db_index_file_() {}
+
+KernelDb::~KernelDb() {
+  close();
+}
 
 KernelDb& KernelDb::get() {
-  const std::string kernel_db_dir = "nvfuser_kernel_db";
-  const std::string kernel_db_file = "db.csv";
+  std::string kernel_db_dir = "nvfuser_kernel_db";
+  const std::string kernel_db_file = "index.bin";
+  bool use_temp_dir = true;
+  uint64_t max_size = default_max_size;
+
+  // NVFUSER_ENABLE=kernel_db(<max size in MiB>,<directory>)
+  const bool enabled = isOptionEnabled(EnableOption::KernelDb);
+  if (enabled) {
+    const auto& args = getEnableOptionArguments(EnableOption::KernelDb);
+    if (!args.empty()) {
+      try {
+        max_size = std::stoull(args[0]) << 20;
+      } catch (const std::exception&) {
+        TORCH_WARN("Kernel DB: Invalid maximum size: ", args[0]);
+      }
+    }
+    if (args.size() > 1) {
+      kernel_db_dir = args[1];
+      use_temp_dir = false;
+    }
+  }
 
   return get(
-      kernel_db_dir,
-      kernel_db_file,
-      true,
-      !isOptionEnabled(EnableOption::KernelDb),
-      false);
+      kernel_db_dir, kernel_db_file, use_temp_dir, !enabled, false, max_size);
 }
 
 KernelDb& KernelDb::get(
@@ -43,7 +135,8 @@ KernelDb& KernelDb::get(
     const std::string& kernel_db_file,
     bool use_temp_dir,
     bool disabled,
-    bool reset) {
+    bool reset,
+    uint64_t max_size) {
   std::lock_guard<std::mutex> guard(kernel_db_lock);
 
   // The KernelDb is minimally constructed to at least hold the disable and
@@ -51,14 +144,15 @@ KernelDb& KernelDb::get(
   static KernelDb singleton(disabled);
 
   if (reset) {
+    singleton.close();
     singleton.disabled_ = true;
     singleton.initialized_ = false;
-    singleton.kernel_map_.clear();
     singleton.kernel_db_path_.clear();
-    singleton.kernel_db_txt_file_.clear();
+    singleton.kernel_db_index_file_.clear();
   }
 
   singleton.disabled_ = disabled;
+  singleton.max_size_ = max_size;
 
   // Intialize the Db if it isn't already disabled
   if (!singleton.disabled_ && !singleton.initialized_) {
@@ -72,6 +166,7 @@ KernelDb& KernelDb::get(
           e.what());
     }
     if (!success) {
+      singleton.close();
       singleton.disabled_ = true;
     } else {
       singleton.initialized_ = true;
@@ -80,13 +175,22 @@ KernelDb& KernelDb::get(
   return singleton;
 }
 
+void KernelDb::close() {
+  if (index_fd_ >= 0) {
+    ::close(index_fd_);
+    index_fd_ = -1;
+  }
+  kernel_map_.clear();
+  free_slots_.clear();
+  num_slots_ = 0;
+  total_size_ = 0;
+}
+
 bool KernelDb::open(
     const std::string& kernel_db_dir,
     const std::string& kernel_db_file,
     bool use_temp_dir) {
   FUSER_PERF_SCOPE("KernelDb::open");
-  const std::string header(
-      "kernel_signature,compile_args,kernel_code_file,cubin_file");
 
   // The KernelDb directory is queried and created if it doesn't exist
   {
@@ -98,7 +202,7 @@ bool KernelDb::open(
     }
     if (!fs::is_directory(kernel_db_path_)) {
       try {
-        fs::create_directory(kernel_db_path_);
+        fs::create_directories(kernel_db_path_);
       } catch (const std::exception& e) {
         TORCH_WARN(
             "Unable to create nvFuser Kernel DB directory! ",
@@ -109,122 +213,250 @@ bool KernelDb::open(
     }
   }
 
-  // The CSV file that captures the db is read if it exists
-  {
-    FUSER_PERF_SCOPE("KernelDb::open::read_db_txt_file");
-
-    kernel_db_txt_file_ = kernel_db_path_ / kernel_db_file;
-    if (fs::is_regular_file(kernel_db_txt_file_)) {
-      std::ifstream in_file(kernel_db_txt_file_.c_str(), std::ios::in);
-      if (in_file) {
-        bool matched_header = false;
-        bool read_db_file = true;
-        // kernel_signature
-        //  --- Group 1: any word character and dash
-        // compile_args
-        //  --- Group 2: any word character, space, plus, dash and equals
-        // kernel_code_file
-        //  --- Group 3: [any word character, dash and slash].cu
-        // cubin_file
-        //  --- Group 4: [any word character, dash and slash].cubin
-        std::regex db_line_regex(
-            R"(^([\w-]+),([\w \+\-\=]+),([\w\-\/]+\.cu),([\w\-\/]+\.cubin)$)");
-        for (std::string line; std::getline(in_file, line);) {
-          if (!matched_header) {
-            if (line.compare(header) == 0) {
-              matched_header = true;
-            } else {
-              // Header is corrupted or badly formed
-              TORCH_WARN(
-                  "Kernel DB: CSV file header is corrupted or badly formed - Resetting!: ",
-                  line);
-              read_db_file = false;
-              break;
-            }
-          } else {
-            std::smatch db_line_match;
-            if (std::regex_match(line, db_line_match, db_line_regex)) {
-              if (db_line_match.size() == 5) {
-                KernelDbEntry temp{
-                    db_line_match[1],
-                    db_line_match[2],
-                    db_line_match[3],
-                    db_line_match[4]};
-
-                fs::path code_path = kernel_db_path_ / temp.kernel_code_file;
-                std::string code;
-                if (copy_from_text_file(code_path.string(), code)) {
-                  kernel_map_[code] = temp;
-                } else {
-                  TORCH_WARN(
-                      "Kernel DB: Unable to copy cuda file: ",
-                      code_path.string());
-                }
-              }
-            } else {
-              TORCH_WARN("Kernel DB: CSV line Doesn't match: ", line);
-            }
-          }
-        }
-        if (read_db_file) {
-          return true;
-        }
-      }
+  int nvrtc_major = 0;
+  int nvrtc_minor = 0;
+  NVFUSER_NVRTC_SAFE_CALL(nvrtcVersion(&nvrtc_major, &nvrtc_minor));
+  toolkit_version_ =
+      "nvrtc" + std::to_string(nvrtc_major) + "." + std::to_string(nvrtc_minor);
+
+  kernel_db_index_file_ = kernel_db_path_ / kernel_db_file;
+  index_fd_ = ::open(kernel_db_index_file_.c_str(), O_RDWR | O_CREAT, 0644);
+  if (index_fd_ < 0) {
+    TORCH_WARN(
+        "Kernel DB: Unable to open index file: ",
+        kernel_db_index_file_.string());
+    return false;
+  }
+
+  IndexLock lock(index_fd_, /*exclusive=*/true);
+  if (!lock.locked()) {
+    return false;
+  }
+
+  // The index file that captures the db is read if it is well formed
+  IndexHeader header;
+  struct stat index_stat {};
+  if (fstat(index_fd_, &index_stat) != 0) {
+    return false;
+  }
+  if (index_stat.st_size > 0) {
+    IndexHeader file_header;
+    const bool matched_header =
+        pread(index_fd_, &file_header, sizeof(file_header), 0) ==
+            (ssize_t)sizeof(file_header) &&
+        file_header.magic == header.magic &&
+        file_header.record_size == header.record_size;
+    if (matched_header) {
+      FUSER_PERF_SCOPE("KernelDb::open::read_index_file");
+      return readIndex();
     }
+    // Header is corrupted or badly formed
+    TORCH_WARN(
+        "Kernel DB: Index file header is corrupted or badly formed - Resetting!: ",
+        kernel_db_index_file_.string());
   }
 
-  // If reading of the CSV file was successful, the rest of this method
+  // If reading of the index file was successful, the rest of this method
   // is skipped
 
-  // Remove all files from directory if valid db txt file was not found
+  // Remove all entries from directory if a valid index file was not found,
+  // along with the files of the former CSV-based db
   for (const auto& dir_entry : fs::directory_iterator(kernel_db_path_)) {
     const fs::path& path = dir_entry.path();
     if (fs::is_regular_file(path)) {
-      if (path.extension() == ".cubin" || path.extension() == ".cu" ||
+      if (path.extension() == ".kernel" || path.extension() == ".tmp" ||
+          path.extension() == ".cubin" || path.extension() == ".cu" ||
           path.extension() == ".csv") {
         fs::remove(path);
       }
     }
   }
 
-  // Create an empty db csv file
+  // Create an empty index file
   {
-    FUSER_PERF_SCOPE("KernelDb::open::create_db_txt_file");
+    FUSER_PERF_SCOPE("KernelDb::open::create_index_file");
+    if (ftruncate(index_fd_, 0) != 0) {
+      return false;
+    }
+    return pwrite(index_fd_, &header, sizeof(header), 0) ==
+        (ssize_t)sizeof(header);
+  }
+}
+
+uint64_t KernelDb::key(
+    const std::string& kernel_code,
+    const std::string& compile_args) const {
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  // The separators keep the boundaries of the fields part of the hash
+  hashBytes(hash, kernel_code.data(), kernel_code.size() + 1);
+  hashBytes(hash, compile_args.data(), compile_args.size() + 1);
+  hashBytes(hash, toolkit_version_.data(), toolkit_version_.size());
+  // Zero marks a free slot of the index
+  return hash == 0 ? 1 : hash;
+}
 
-    if (copy_to_text_file(kernel_db_txt_file_, header + "\n")) {
-      return true;
+fs::path KernelDb::entryPath(uint64_t key) const {
+  std::stringstream ss;
+  ss << std::hex << std::setw(16) << std::setfill('0') << key << ".kernel";
+  return kernel_db_path_ / ss.str();
+}
+
+bool KernelDb::readIndex() {
+  FUSER_PERF_SCOPE("KernelDb::readIndex");
+  kernel_map_.clear();
+  free_slots_.clear();
+  num_slots_ = 0;
+  total_size_ = 0;
+
+  struct stat index_stat {};
+  if (fstat(index_fd_, &index_stat) != 0 ||
+      index_stat.st_size < (off_t)sizeof(IndexHeader)) {
+    return false;
+  }
+  const auto file_size = (size_t)index_stat.st_size;
+  // A record being appended by another process is ignored
+  num_slots_ =
+      (file_size - sizeof(IndexHeader)) / sizeof(KernelDbIndexRecord);
+  if (num_slots_ == 0) {
+    return true;
+  }
+
+  void* data = mmap(nullptr, file_size, PROT_READ, MAP_SHARED, index_fd_, 0);
+  if (data == MAP_FAILED) {
+    return false;
+  }
+  const auto* records = reinterpret_cast<const KernelDbIndexRecord*>(
+      static_cast<const char*>(data) + sizeof(IndexHeader));
+  for (const auto slot : c10::irange(num_slots_)) {
+    const KernelDbIndexRecord& record = records[slot];
+    if (record.key == 0) {
+      free_slots_.push_back(slot);
+      continue;
+    }
+    kernel_map_[record.key] = KernelDbEntry{slot, record.size};
+    total_size_ += record.size;
+  }
+  munmap(data, file_size);
+  return true;
+}
+
+bool KernelDb::writeRecord(uint64_t slot, const KernelDbIndexRecord& record) {
+  const auto offset =
+      (off_t)(sizeof(IndexHeader) + slot * sizeof(KernelDbIndexRecord));
+  return pwrite(index_fd_, &record, sizeof(record), offset) ==
+      (ssize_t)sizeof(record);
+}
+
+void KernelDb::evict() {
+  if (total_size_ <= max_size_) {
+    return;
+  }
+  FUSER_PERF_SCOPE("KernelDb::evict");
+
+  std::vector<KernelDbIndexRecord> records(num_slots_);
+  const auto bytes = (ssize_t)(num_slots_ * sizeof(KernelDbIndexRecord));
+  if (pread(index_fd_, records.data(), bytes, sizeof(IndexHeader)) != bytes) {
+    return;
+  }
+  records.erase(
+      std::remove_if(
+          records.begin(),
+          records.end(),
+          [](const KernelDbIndexRecord& record) { return record.key == 0; }),
+      records.end());
+  std::stable_sort(
+      records.begin(),
+      records.end(),
+      [](const KernelDbIndexRecord& a, const KernelDbIndexRecord& b) {
+        return a.last_used < b.last_used;
+      });
+
+  for (const auto& record : records) {
+    if (total_size_ <= max_size_) {
+      break;
     }
+    auto it = kernel_map_.find(record.key);
+    if (it == kernel_map_.end() ||
+        !writeRecord(it->second.slot, KernelDbIndexRecord{})) {
+      continue;
+    }
+    std::error_code ec;
+    fs::remove(entryPath(record.key), ec);
+    free_slots_.push_back(it->second.slot);
+    total_size_ -= it->second.size;
+    kernel_map_.erase(it);
   }
-  return false;
 }
 
 bool KernelDb::query(
     const std::string& kernel_code,
     const std::string& compile_args,
     std::string& kernel_signature,
-    std::vector<char>& cubin) const {
+    std::vector<char>& cubin) {
   FUSER_PERF_SCOPE("KernelDb::query");
-  bool status = false;
-  auto db_entry = kernel_map_.find(kernel_code);
-
-  // Kernel Match is found
-  if (db_entry != kernel_map_.end()) {
-    // Make sure the compilation args also match
-    if (db_entry->second.compile_args == compile_args) {
-      // Copy the cubin to a data buffer and record the kernel name for module
-      // loading
-      fs::path cubin_file_path = kernel_db_path_ / db_entry->second.cubin_file;
-      if (copy_from_binary_file(cubin_file_path.string(), cubin)) {
-        kernel_signature = db_entry->second.kernel_signature;
-        status = true;
-      }
+  std::lock_guard<std::mutex> guard(kernel_db_lock);
+  const uint64_t entry_key = key(kernel_code, compile_args);
+  const fs::path entry_path = entryPath(entry_key);
+
+  auto db_entry = kernel_map_.find(entry_key);
+  if (db_entry == kernel_map_.end()) {
+    // The kernel may have been written by another process since the index was
+    // last read
+    if (!fs::is_regular_file(entry_path)) {
+      return false;
+    }
+    IndexLock lock(index_fd_, /*exclusive=*/false);
+    if (!lock.locked() || !readIndex()) {
+      return false;
+    }
+    db_entry = kernel_map_.find(entry_key);
+    if (db_entry == kernel_map_.end()) {
+      return false;
     }
   }
-  return status;
+
+  // The cubin is only loaded from the entry file upon a match
+  std::vector<char> buffer;
+  if (!copy_from_binary_file(entry_path.string(), buffer) ||
+      buffer.size() < sizeof(EntryHeader)) {
+    return false;
+  }
+  EntryHeader header;
+  std::memcpy(&header, buffer.data(), sizeof(header));
+  if (header.magic != entry_magic ||
+      buffer.size() !=
+          sizeof(header) + header.signature_size + header.compile_args_size +
+              header.code_size + header.cubin_size) {
+    return false;
+  }
+  const char* data = buffer.data() + sizeof(header);
+  const char* signature = data;
+  const char* args = signature + header.signature_size;
+  const char* code = args + header.compile_args_size;
+  const char* binary = code + header.code_size;
+
+  // Make sure the kernel code and the compilation args also match
+  if (compile_args.compare(
+          0, std::string::npos, args, header.compile_args_size) != 0 ||
+      kernel_code.compare(0, std::string::npos, code, header.code_size) != 0) {
+    return false;
+  }
+
+  // Copy the cubin to a data buffer and record the kernel name for module
+  // loading
+  kernel_signature.assign(signature, header.signature_size);
+  cubin.assign(binary, binary + header.cubin_size);
+
+  // Refresh the last use of the entry. This races benignly with other
+  // processes refreshing it.
+  writeRecord(
+      db_entry->second.slot,
+      KernelDbIndexRecord{entry_key, db_entry->second.size, now()});
+  return true;
 }
 
-// This method will write a cubin and the kernel code to files as well as add
-// an entry to the db csv file.
+// This method will write the kernel code and the cubin to an entry file as
+// well as add a record to the index file.
 bool KernelDb::write(
     const std::string& kernel_code,
     const std::string& compile_args,
@@ -232,52 +464,70 @@ bool KernelDb::write(
     const std::vector<char>& cubin) {
   FUSER_PERF_SCOPE("KernelDb::write");
   std::lock_guard<std::mutex> guard(kernel_db_lock);
+  const uint64_t entry_key = key(kernel_code, compile_args);
 
   // Short-circuit path if kernel already exist in database.
   // Only return false if it does not already exist in the database and we fail
   // to add kernel to database.
-  if (kernel_map_.count(kernel_code) > 0) {
+  if (kernel_map_.count(entry_key) > 0) {
     return true;
   }
 
-  // If the kernel doesn't already exist in the hash map, add it.
-  // The cubin and kernel code files are given a unique number based on the
-  // size of the hash map.
-  std::string kernel_num =
-      std::to_string(static_cast<unsigned long>(kernel_map_.size()));
-
-  // Kernel Code File path
-  std::string code_file_name("kernel_" + kernel_num + ".cu");
-  fs::path code_file_path = kernel_db_path_ / code_file_name;
-
-  // Cubin File path
-  std::string cubin_file_name("kernel_" + kernel_num + ".cubin");
-  fs::path cubin_file_path = kernel_db_path_ / cubin_file_name;
-
-  // Copy kernel code to file
-  bool status = copy_to_text_file(code_file_path.string(), kernel_code);
-
-  // If the kernel code copy was successful, copy the cubin to file
-  if (status) {
-    status = copy_to_binary_file(cubin_file_path.string(), cubin);
+  EntryHeader header;
+  header.signature_size = kernel_signature.size();
+  header.compile_args_size = compile_args.size();
+  header.code_size = kernel_code.size();
+  header.cubin_size = cubin.size();
+  std::vector<char> buffer;
+  buffer.reserve(
+      sizeof(header) + kernel_signature.size() + compile_args.size() +
+      kernel_code.size() + cubin.size());
+  const auto* header_bytes = reinterpret_cast<const char*>(&header);
+  buffer.insert(buffer.end(), header_bytes, header_bytes + sizeof(header));
+  buffer.insert(buffer.end(), kernel_signature.begin(), kernel_signature.end());
+  buffer.insert(buffer.end(), compile_args.begin(), compile_args.end());
+  buffer.insert(buffer.end(), kernel_code.begin(), kernel_code.end());
+  buffer.insert(buffer.end(), cubin.begin(), cubin.end());
+
+  // The entry is written to a file private to this process and then renamed,
+  // which is atomic, so that readers never see a partially written entry.
+  const fs::path entry_path = entryPath(entry_key);
+  fs::path tmp_path = entry_path;
+  tmp_path += "." + std::to_string(getpid()) + ".tmp";
+  if (!copy_to_binary_file(tmp_path.string(), buffer)) {
+    return false;
+  }
+  std::error_code ec;
+  fs::rename(tmp_path, entry_path, ec);
+  if (ec) {
+    fs::remove(tmp_path, ec);
+    return false;
   }
 
-  // If both files were created successfully, add an entry to the CSV file
-  if (status) {
-    std::string entry(kernel_signature);
-    entry += "," + compile_args + "," + code_file_name + "," + cubin_file_name +
-        "\n";
-    status = append_to_text_file(kernel_db_txt_file_.string(), entry);
+  IndexLock lock(index_fd_, /*exclusive=*/true);
+  if (!lock.locked() || !readIndex()) {
+    return false;
+  }
+  // Another process may have written the same kernel in the meantime
+  if (kernel_map_.count(entry_key) > 0) {
+    return true;
   }
 
-  // If writing both files and adding an entry the CSV file was successful,
-  // finally add an entry to the Kernel DB
-  if (status) {
-    KernelDbEntry tmp{
-        kernel_signature, compile_args, code_file_name, cubin_file_name};
-    kernel_map_[kernel_code] = tmp;
+  uint64_t slot = num_slots_;
+  if (!free_slots_.empty()) {
+    slot = free_slots_.back();
+    free_slots_.pop_back();
   }
-  return status;
+  const KernelDbIndexRecord record{entry_key, buffer.size(), now()};
+  if (!writeRecord(slot, record)) {
+    return false;
+  }
+  num_slots_ = std::max(num_slots_, slot + 1);
+  kernel_map_[entry_key] = KernelDbEntry{slot, record.size};
+  total_size_ += record.size;
+
+  evict();
+  return true;
 }
 
 } // namespace nvfuser
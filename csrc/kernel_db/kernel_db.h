@@ -17,6 +17,8 @@ namespace fs = std::experimental::filesystem;
 #error "C++14 or Higher is required for filesystem library!"
 #endif
 
+#include <cstdint>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
@@ -24,23 +26,38 @@ namespace fs = std::experimental::filesystem;
 
 namespace nvfuser {
 
-//! KernelDbEntry captures information to be printed per fusion in a csv file
-//! that is used to restore a hash map
+//! Fixed-size record of the index file. The index file is a small header
+//! followed by an array of these records, so it can be mmap'ed and updated in
+//! place. A record with a zero key is a free slot left by an evicted entry.
+struct KernelDbIndexRecord {
+  //! Content hash of the kernel code, compile args and toolkit version. It is
+  //! also the name of the entry file holding the kernel.
+  uint64_t key = 0;
+  //! Size in bytes of the entry file
+  uint64_t size = 0;
+  //! Last time the entry was written or queried, in seconds since epoch
+  int64_t last_used = 0;
+};
+
+//! KernelDbEntry is the in-memory view of an index record. The kernel code and
+//! cubin are only read from the entry file when the entry is queried.
 struct KernelDbEntry {
-  //! Cuda kernel function signature that is required to load the Cubin
-  std::string kernel_signature;
-  //! Compilation args supplied to NVRTC -- register usage and compute
-  //! capability can be specific to a kernel instance
-  std::string compile_args;
-  //! Full file path to Cuda Kernel
-  std::string kernel_code_file;
-  //! Full file path to cubin
-  std::string cubin_file;
+  //! Position of the record in the index file
+  uint64_t slot = 0;
+  //! Size in bytes of the entry file
+  uint64_t size = 0;
 };
 
 //! KernelDb class is a singleton structure that is used to open, query, and
-//! write to the the database that is held in a hash map.  The kernel code is
-//! used as string key to the hash map.
+//! write to a content-addressed database of compiled kernels on disk.
+//!
+//! Each kernel is stored in its own entry file named after the hash of its
+//! code, compile args and the NVRTC version. Compile args include the target
+//! architecture. Entry files are written to a temporary file and renamed, so
+//! other processes never observe a partial entry. An index file records the
+//! size and last use of every entry. It is locked by writers so that several
+//! processes can share a db directory. Once the total size exceeds the
+//! configured maximum, the least recently used entries are evicted.
 class KernelDb {
   KernelDb(bool _disabled);
 
@@ -52,9 +69,13 @@ class KernelDb {
       bool use_temp_dir);
 
  public:
+  //! Default maximum total size of the entry files, 4 GiB
+  static constexpr uint64_t default_max_size = 4ULL << 30;
+
   // clang-tidy - deleted member function should be public
   KernelDb(const KernelDb&) = delete;
   KernelDb& operator=(const KernelDb&) = delete;
+  ~KernelDb();
 
   //! Thread-Safe method to get the Meyer's singleton -- Interface
   static KernelDb& get();
@@ -64,7 +85,8 @@ class KernelDb {
       const std::string& kernel_db_file,
       bool use_temp_dir = true,
       bool disabled = false,
-      bool reset = false);
+      bool reset = false,
+      uint64_t max_size = default_max_size);
 
   //! Enable is derived from two booleans
   bool enabled() const {
@@ -75,14 +97,14 @@ class KernelDb {
     return kernel_map_.size();
   }
 
-  //! Query uses the string of the kernel code to lookup whether a cubin already
-  //! exists for the given kernel.  Additionally, the compile args are also
-  //! matched.
+  //! Query uses the hash of the kernel code and compile args to lookup whether
+  //! a cubin already exists for the given kernel. The code and compile args
+  //! stored in the entry are compared as well to guard against collisions.
   NVF_API bool query(
       const std::string& kernel_code,
       const std::string& compile_args,
       std::string& kernel_signature,
-      std::vector<char>& cubin) const;
+      std::vector<char>& cubin);
   //! Write is used to write a new entry to the db upon compilation of a
   //! new fusion
   NVF_API bool write(
@@ -91,19 +113,52 @@ class KernelDb {
       const std::string& kernel_signature,
       const std::vector<char>& cubin);
 
+ private:
+  //! Close the index file and forget all entries
+  void close();
+
+  //! Content hash used as the key of an entry
+  uint64_t key(const std::string& kernel_code, const std::string& compile_args)
+      const;
+
+  //! Full path to the entry file of a key
+  fs::path entryPath(uint64_t key) const;
+
+  //! Re-read the index file, which may have been updated by other processes
+  bool readIndex();
+
+  //! Store a record at the given slot of the index file
+  bool writeRecord(uint64_t slot, const KernelDbIndexRecord& record);
+
+  //! Evict least recently used entries until the total size fits in
+  //! max_size_. Must be called with the index file locked.
+  void evict();
+
  private:
   //! Disablement is specified by the user and can also be set by a
   //! failure to open the db
   bool disabled_ = true;
   //! Db is only initialized after it is successfully open
   bool initialized_ = false;
-  //! Hash Map of kernel_string -> db_entry
-  std::unordered_map<std::string, KernelDbEntry> kernel_map_;
+  //! Hash Map of content hash -> db_entry
+  std::unordered_map<uint64_t, KernelDbEntry> kernel_map_;
+  //! Slots of the index file not holding any entry
+  std::vector<uint64_t> free_slots_;
+  //! Number of slots of the index file
+  uint64_t num_slots_ = 0;
+  //! Sum of the sizes of all entries
+  uint64_t total_size_ = 0;
+  //! Maximum value of total_size_ before entries are evicted
+  uint64_t max_size_ = default_max_size;
+  //! NVRTC version, part of the key since it determines the generated code
+  std::string toolkit_version_;
 
   //! Full path to the db directory
   fs::path kernel_db_path_;
-  //! Full path to csv file used to record and restore the db
-  fs::path kernel_db_txt_file_;
+  //! Full path to the index file
+  fs::path kernel_db_index_file_;
+  //! File descriptor of the index file
+  int index_fd_ = -1;
 };
 
 } // namespace nvfuser
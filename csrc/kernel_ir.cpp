@@ -407,18 +407,21 @@ std::string Asm::toInlineString(int indent_size) const {
 
 NVFUSER_DEFINE_CLONE_AND_CREATE(Asm)
 
-BlockSync::BlockSync(IrBuilderPasskey passkey, bool war_sync) : Expr(passkey) {
+BlockSync::BlockSync(IrBuilderPasskey passkey, bool war_sync, bool warp_sync)
+    : Expr(passkey) {
   NVF_ERROR(passkey.ir_container_ != nullptr);
   NVF_ERROR(
       passkey.ir_container_->isA<kir::Kernel>(),
       "IR type only valid for Kernel container.");
   addDataAttribute(war_sync);
+  addDataAttribute(warp_sync);
 }
 
 std::string BlockSync::toString(int indent_size) const {
   std::stringstream ss;
   indent(ss, indent_size) << "BLOCKSYNC(war_hazard="
-                          << boolLiteral(isWarHazardSync()) << ")\n";
+                          << boolLiteral(isWarHazardSync())
+                          << ", warp=" << boolLiteral(isWarpSync()) << ")\n";
   return ss.str();
 }
 
@@ -813,10 +816,14 @@ std::string GridReduction::toString(int indent_size) const {
                           << ", initial value = " << init()->toString()
                           << ",\n";
   ++indent_size;
-  indent(ss, indent_size) << "reduction buffer = "
-                          << reduction_buffer()->buffer()->toString() << ",\n";
-  indent(ss, indent_size) << "sync buffer = "
-                          << sync_buffer()->buffer()->toString() << ",\n";
+  // Serial and cluster reductions do not use work and sync buffers
+  if (!isSerial() && !isCluster()) {
+    indent(ss, indent_size) << "reduction buffer = "
+                            << reduction_buffer()->buffer()->toString()
+                            << ",\n";
+    indent(ss, indent_size) << "sync buffer = "
+                            << sync_buffer()->buffer()->toString() << ",\n";
+  }
   indent(ss, indent_size) << "read predicate = ";
   if (predicate() != nullptr) {
     ss << predicate()->toString();
@@ -837,6 +844,8 @@ std::string GridReduction::toString(int indent_size) const {
                           << (isAllreduce() ? "true" : "false") << " )\n";
   indent(ss, indent_size) << "serial reduction = "
                           << (isSerial() ? "true" : "false") << " )\n";
+  indent(ss, indent_size) << "cluster reduction = "
+                          << (isCluster() ? "true" : "false") << " )\n";
   if (isSerial()) {
     indent(ss, indent_size)
         << "serial reduction tensor = " << serialReductionTensor()->toString()
@@ -851,6 +860,63 @@ std::string GridReduction::toInlineString(int indent_size) const {
 
 NVFUSER_DEFINE_CLONE_AND_CREATE(GridReduction)
 
+GridScan::GridScan(
+    IrBuilderPasskey passkey,
+    BinaryOpType scan_op_type,
+    Val* init,
+    Val* out,
+    Val* in,
+    int64_t dim,
+    Allocate* aggregate_buffer,
+    Allocate* prefix_buffer,
+    Allocate* flag_buffer,
+    Val* entrance_index,
+    Val* entrances)
+    : ScanOp(passkey, scan_op_type, init, out, in, dim) {
+  NVF_ERROR(passkey.ir_container_ != nullptr);
+  NVF_ERROR(
+      passkey.ir_container_->isA<kir::Kernel>(),
+      "IR type only valid for Kernel container.");
+  NVF_ERROR(
+      attributes().size() == num_scan_op_attr,
+      "The num_scan_op_attr does not match the number of attributes ScanOp has."
+      "If you changed ScanOp, please change num_scan_op_attr accordingly.");
+  addAttribute(aggregate_buffer);
+  addAttribute(prefix_buffer);
+  addAttribute(flag_buffer);
+  addAttribute(entrance_index);
+  addAttribute(entrances);
+}
+
+std::string GridScan::toString(int indent_size) const {
+  std::stringstream ss;
+  indent(ss, indent_size) << out()->toString() << " = scan( "
+                          << in()->toString() << ", op = " << getScanOpType()
+                          << ", initial value = " << init()->toString()
+                          << ",\n";
+  ++indent_size;
+  indent(ss, indent_size) << "aggregate buffer = "
+                          << aggregate_buffer()->buffer()->toString() << ",\n";
+  indent(ss, indent_size) << "prefix buffer = "
+                          << prefix_buffer()->buffer()->toString() << ",\n";
+  indent(ss, indent_size) << "flag buffer = "
+                          << flag_buffer()->buffer()->toString() << ",\n";
+  indent(ss, indent_size) << "read predicate = ";
+  if (predicate() != nullptr) {
+    ss << predicate()->toString();
+  } else {
+    ss << "nullptr";
+  }
+  ss << " )\n";
+  return ss.str();
+}
+
+std::string GridScan::toInlineString(int indent_size) const {
+  NVF_CHECK(false, "Tensor op can not be printed inline");
+}
+
+NVFUSER_DEFINE_CLONE_AND_CREATE(GridScan)
+
 GroupedGridReduction::GroupedGridReduction(
     IrBuilderPasskey passkey,
     std::vector<BinaryOpType> reduction_op_types,
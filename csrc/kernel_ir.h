@@ -52,6 +52,7 @@ class InitMagicZero;
 class UpdateMagicZero;
 class IfThenElse;
 class GridReduction;
+class GridScan;
 class GroupedGridReduction;
 class GridBroadcast;
 class GridWelford;
@@ -384,7 +385,10 @@ class NVF_API BlockSync final : public Expr {
  public:
   using Expr::Expr;
 
-  explicit BlockSync(IrBuilderPasskey passkey, bool war_sync = false);
+  explicit BlockSync(
+      IrBuilderPasskey passkey,
+      bool war_sync = false,
+      bool warp_sync = false);
 
   const char* getOpString() const override {
     return "BlockSync";
@@ -399,6 +403,12 @@ class NVF_API BlockSync final : public Expr {
   bool isWarHazardSync() const {
     return attribute<bool>(0);
   }
+
+  //! The block is a single warp, so __syncwarp is enough. Set by
+  //! elideRedundantSyncs.
+  bool isWarpSync() const {
+    return attribute<bool>(1);
+  }
 };
 
 // Synchronize all blocks in device, implies cooperative group launch is
@@ -772,7 +782,7 @@ class NVF_API IfThenElse final : public Expr {
 //! This node provides FusionExecutor the information it needs to allocate the
 //! reduction and sync buffers.
 class GridReduction final : public ReductionOp {
-  static constexpr int num_reduction_op_attr = 4;
+  static constexpr int num_reduction_op_attr = 5;
 
  public:
   using ReductionOp::ReductionOp;
@@ -836,6 +846,18 @@ class GridReduction final : public ReductionOp {
     return serialReductionTensor() != nullptr;
   }
 
+  //! Reduction across the thread blocks of a cluster through distributed
+  //! shared memory. Like serial reductions, it has no work or sync buffers.
+  bool isCluster() const {
+    return clusterReductionRequested();
+  }
+
+  //! Sum of the partial results of the blocks into the output with global
+  //! atomics. It has no work or sync buffers either.
+  bool isAtomic() const {
+    return atomicGridReductionRequested();
+  }
+
   GridReduction* withThreadPredicate(
       const ParallelTypeBitmap& thread_predicate) {
     auto result = shallowCopy()->as<GridReduction>();
@@ -844,6 +866,61 @@ class GridReduction final : public ReductionOp {
   }
 };
 
+//! Inclusive scan along a domain parallelized by BIDx and TIDx with the
+//! decoupled look-back of runtime/scan.cu. Each tile, i.e., each row of
+//! threads of a block, publishes its aggregate and inclusive prefix in
+//! global work buffers, and flags tells which of them is ready.
+class GridScan final : public ScanOp {
+  static constexpr int num_scan_op_attr = 3;
+
+ public:
+  using ScanOp::ScanOp;
+
+  GridScan(
+      IrBuilderPasskey passkey,
+      BinaryOpType scan_op_type,
+      Val* init,
+      Val* out,
+      Val* in,
+      int64_t dim,
+      Allocate* aggregate_buffer,
+      Allocate* prefix_buffer,
+      Allocate* flag_buffer,
+      Val* entrance_index,
+      Val* entrances);
+
+  NVFUSER_DECLARE_CLONE_AND_CREATE
+
+  const char* getOpString() const override {
+    return "GridScan";
+  }
+
+  std::string toString(int indent_size = 0) const override;
+  std::string toInlineString(int indent_size = 0) const override;
+
+  Allocate* aggregate_buffer() const {
+    return attribute(num_scan_op_attr)->as<Allocate>();
+  }
+
+  Allocate* prefix_buffer() const {
+    return attribute(num_scan_op_attr + 1)->as<Allocate>();
+  }
+
+  Allocate* flag_buffer() const {
+    return attribute(num_scan_op_attr + 2)->as<Allocate>();
+  }
+
+  // Which instance of entering this grid scan is this iteration?
+  Val* entrance_index() const {
+    return attributeVal(num_scan_op_attr + 3);
+  }
+
+  // How many times will this grid scan be entered
+  Val* entrances() const {
+    return attributeVal(num_scan_op_attr + 4);
+  }
+};
+
 class NVF_API GroupedGridReduction final : public GroupedReductionOp {
  public:
   using GroupedReductionOp::GroupedReductionOp;
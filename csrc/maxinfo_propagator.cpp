@@ -5,9 +5,13 @@
  * SPDX-License-Identifier: BSD-3-Clause
  */
 // clang-format on
+#include <fusion.h>
 #include <logical_domain_map.h>
 #include <maxinfo_propagator.h>
 
+#include <any>
+#include <unordered_map>
+
 namespace nvfuser {
 
 bool MaxInfoSpanningTree::Information::operator>(const Information& r) const {
@@ -44,6 +48,10 @@ void MaxInfoSpanningTree::compute_spanning_tree() {
   candidates.back().next_hop.from = nullptr;
   candidates.back().next_hop.to = reference_;
   candidates.back().info_to = reference_info_;
+  // The candidate of each dest tensor, so that a new path to a tensor does
+  // not need to search the whole list of candidates
+  std::unordered_map<TensorView*, std::list<NextHopWithInfo>::iterator>
+      candidate_of{{reference_, candidates.begin()}};
 
   // Insert the given next hop the correct position in `candidates`. If there
   // is an existing next hop that preserves more information, then we will just
@@ -55,18 +63,15 @@ void MaxInfoSpanningTree::compute_spanning_tree() {
       return;
     }
     // Find if there is already a path to the dest tensor
-    auto existing = std::find_if(
-        candidates.begin(), candidates.end(), [&](const NextHopWithInfo& i) {
-          return i.next_hop.to == info.next_hop.to;
-        });
+    auto existing = candidate_of.find(info.next_hop.to);
     // Only insert if there is no existing path to the dest tensor, or the new
     // path preserves more information about the starting tensor.
-    if (existing == candidates.end() || *existing < info) {
-      if (existing != candidates.end()) {
-        candidates.erase(existing);
+    if (existing == candidate_of.end() || *existing->second < info) {
+      if (existing != candidate_of.end()) {
+        candidates.erase(existing->second);
       }
       auto pos = std::upper_bound(candidates.begin(), candidates.end(), info);
-      candidates.insert(pos, info);
+      candidate_of[info.next_hop.to] = candidates.insert(pos, info);
     }
   };
 
@@ -95,6 +100,7 @@ void MaxInfoSpanningTree::compute_spanning_tree() {
     const auto next_hop_info = candidates.back();
     const auto& next_hop = next_hop_info.next_hop;
     candidates.pop_back();
+    candidate_of.erase(next_hop.to);
 
     if (next_hop.from != nullptr) {
       // nullptr used to start from reference
@@ -135,9 +141,89 @@ void MaxInfoSpanningTree::compute_spanning_tree() {
   }
 }
 
+// Note [Spanning tree cache]
+// Schedulers propagate the transforms of the same reference several times,
+// e.g., with transformPropagateToAllFrom after each step of their schedule,
+// and again for each heuristic they try. For large fusions, computing the
+// spanning tree, i.e., mapping the logical domains of each pair of producer
+// and consumer, is then a large part of the compile time, although the tree
+// only depends on the reference and on the tensor graph: loop transforms do
+// not change the root and logical domains that the information is computed
+// on.
+//
+// So the paths of the trees built with the whole reference info and no
+// selector are cached in the fusion, by reference. The cache is invalidated
+// when the tensor graph changes, e.g., by cacheBefore, rFactor or a new op,
+// which is detected by comparing the tensors, their definitions, uses, and
+// root and logical domains with those the paths were computed on. A copy of
+// the fusion starts with an empty cache.
+
+struct MaxInfoSpanningTree::PathCache {
+  // The tensor graph the paths were computed on
+  std::vector<const void*> graph;
+  std::unordered_map<TensorView*, std::vector<NextHop>> paths;
+};
+
+namespace {
+
+const std::string kPathCacheKey = "max_info_spanning_tree_paths";
+
+// The tensors of fusion and the IR nodes that their spanning trees depend on
+std::vector<const void*> tensorGraphOf(Fusion* fusion) {
+  std::vector<const void*> graph;
+  for (TensorView* tv : fusion->allTvs()) {
+    graph.push_back(tv);
+    graph.push_back(tv->definition());
+    for (Expr* use : tv->uses()) {
+      graph.push_back(use);
+    }
+    graph.push_back(nullptr);
+    for (IterDomain* id : tv->getMaybeRootDomain()) {
+      graph.push_back(id);
+    }
+    graph.push_back(nullptr);
+    for (IterDomain* id : tv->getLogicalDomain()) {
+      graph.push_back(id);
+    }
+    graph.push_back(nullptr);
+  }
+  return graph;
+}
+
+} // namespace
+
+void MaxInfoSpanningTree::computeOrReuseSpanningTree() {
+  if (!cacheable_) {
+    compute_spanning_tree();
+    return;
+  }
+  Fusion* fusion = reference_->fusion();
+  if (!fusion->hasManaged(kPathCacheKey)) {
+    fusion->manage(
+        kPathCacheKey,
+        std::make_shared<PathCache>(),
+        [](IrCloner&, std::any) -> std::any {
+          return std::make_shared<PathCache>();
+        });
+  }
+  auto cache = fusion->getManaged<std::shared_ptr<PathCache>>(kPathCacheKey);
+  std::vector<const void*> graph = tensorGraphOf(fusion);
+  if (cache->graph != graph) {
+    cache->graph = std::move(graph);
+    cache->paths.clear();
+  }
+  auto it = cache->paths.find(reference_);
+  if (it != cache->paths.end()) {
+    path_ = it->second;
+    return;
+  }
+  compute_spanning_tree();
+  cache->paths.emplace(reference_, path_);
+}
+
 void MaxInfoSpanningTree::traverse(Propagator* propagator) {
   if (path_.empty()) {
-    compute_spanning_tree();
+    computeOrReuseSpanningTree();
   }
   propagator->setUp();
   for (const auto& next_hop : path_) {
@@ -165,7 +251,7 @@ MaxLogicalDomainInfoSpanningTree::DomainInfo::operator bool() const {
 
 bool MaxLogicalDomainInfoSpanningTree::DomainInfo::operator<(
     const Information& r) const {
-  auto rr = dynamic_cast<const DomainInfo&>(r);
+  const auto& rr = dynamic_cast<const DomainInfo&>(r);
   if (info.size() != rr.info.size()) {
     return info.size() < rr.info.size();
   }
@@ -127,7 +127,11 @@ class MaxInfoSpanningTree {
   std::vector<NextHop> path_;
   Selector* selector_;
 
+  // Paths of the fusion by reference tensor. See Note [Spanning tree cache]
+  struct PathCache;
+
   void compute_spanning_tree();
+  void computeOrReuseSpanningTree();
 
  protected:
   virtual std::shared_ptr<Information> computeInfoC2P(
@@ -146,6 +150,11 @@ class MaxInfoSpanningTree {
   TensorView* reference_;
   std::shared_ptr<Information> reference_info_;
 
+  // Set by subclasses when the path only depends on the reference and the
+  // tensor graph, i.e., the reference info and the selector are the defaults,
+  // so that it can be shared by the trees of the same reference
+  bool cacheable_ = false;
+
  public:
   NVF_API MaxInfoSpanningTree(
       TensorView* reference,
@@ -246,7 +255,9 @@ class NVF_API MaxLogicalDomainInfoSpanningTree : public MaxInfoSpanningTree {
       : MaxLogicalDomainInfoSpanningTree(
             reference,
             getReferenceIDInfo(reference),
-            selector) {}
+            selector) {
+    cacheable_ = selector == nullptr;
+  }
   MaxLogicalDomainInfoSpanningTree(
       TensorView* reference,
       int64_t loop_pos,
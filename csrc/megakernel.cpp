@@ -0,0 +1,312 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#include <megakernel.h>
+
+#include <codegen.h>
+#include <cuda_utils.h>
+#include <driver_api.h>
+#include <instrumentation.h>
+#include <kernel.h>
+#include <kernel_ir.h>
+
+#include <ATen/ATen.h>
+#include <ATen/cuda/CUDAContext.h>
+#include <c10/util/irange.h>
+
+#include <algorithm>
+#include <array>
+#include <sstream>
+#include <variant>
+
+namespace nvfuser {
+
+// [ Note -- Megakernel ]
+//
+// With NVFUSER_ENABLE=megakernel, a FusionKernelRuntime whose segments all
+// run compiled kernels launches them as a single persistent cooperative
+// kernel. Every segment keeps its own schedule, and its kernel becomes a
+// phase of the megakernel:
+//   - codegen::generateCudaPhase emits the kernel as a device function taking
+//     the block index and the grid size in parameters named blockIdx and
+//     gridDim, which shadow the builtins in its body,
+//   - the megakernel takes the parameters of all phases, followed by the
+//     grid of each phase and a zeroed semaphore,
+//   - each block of the persistent grid runs the blocks of a phase strided
+//     by the size of the grid, with a block sync in between since the phases
+//     reuse the shared memory,
+//   - phases are separated by a grid sync, after which the outputs of a
+//     phase are visible to all blocks of the next one.
+// This removes the launch gaps and the tails between the segments, and the
+// intermediates small enough to stay in L2 are read back from there.
+//
+// The segments are run as usual under a LaunchRecorder, which allocates their
+// outputs and intermediates and records their launches, and the recorded
+// arguments are concatenated into those of the megakernel. The recorded
+// launches keep all the buffers they use alive, and the intermediate arena is
+// not used while recording, so that no memory is reused by a later phase.
+// The segments are not spread over streams either.
+//
+// The phases see the blockIdx and gridDim of their own launch, but the
+// runtime functions they call see those of the megakernel. So kernels with
+// grid reductions, broadcasts, welfords or scans, which index their work
+// buffers and semaphores with the builtins, cannot be phases, nor kernels
+// taking TMA descriptors, which must stay grid constants. All phases must
+// have the same index type, which the runtime preamble defines, and the
+// same block size at run time. The megakernel is compiled for each block
+// size it is launched with. When the launches of a run do not fit,
+// e.g. their block sizes differ or no block of the megakernel fits on an SM,
+// the recorded launches are issued one after the other instead.
+
+namespace {
+
+std::string phaseName(const std::string& megakernel_name, size_t phase) {
+  return megakernel_name + "_phase" + std::to_string(phase);
+}
+
+} // namespace
+
+bool Megakernel::canRun(const std::vector<const FusionExecutor*>& executors) {
+  if (executors.size() < 2) {
+    return false;
+  }
+  for (const FusionExecutor* executor : executors) {
+    if (!executor->hasCompiledKernel()) {
+      return false;
+    }
+    const kir::Kernel* kernel = executor->kernel();
+    if (kernel->topLevelExprs().empty() ||
+        kernel->indexType() != executors.front()->kernel()->indexType()) {
+      return false;
+    }
+    const auto& summary = kernel->summary();
+    if (summary.has_grid_reductions || summary.has_grid_broadcasts ||
+        summary.has_grid_welford || summary.has_block_scans ||
+        summary.has_cooperative_grid_reduction ||
+        summary.has_cluster_reductions) {
+      return false;
+    }
+    // Work buffers the executor zero-fills before each launch are the
+    // semaphores of grid communication
+    if (std::any_of(
+            summary.global_allocations.begin(),
+            summary.global_allocations.end(),
+            [](const kir::Allocate* alloc) { return alloc->zeroInit(); })) {
+      return false;
+    }
+    if (std::any_of(
+            kernel->parameters().begin(),
+            kernel->parameters().end(),
+            [](Val* param) {
+              return !param->isA<TensorView>() &&
+                  !std::holds_alternative<PrimDataType>(param->dtype().type);
+            })) {
+      return false;
+    }
+  }
+  return true;
+}
+
+Megakernel::Megakernel(std::vector<const FusionExecutor*> phases)
+    : phases_(std::move(phases)) {
+  FUSER_PERF_SCOPE("Megakernel::Megakernel");
+  NVF_ERROR(canRun(phases_), "The kernels cannot run as a megakernel");
+  name_ = phases_.front()->kernelName() + "_megakernel";
+
+  std::stringstream code;
+  std::vector<std::vector<std::string>> parameter_types;
+  for (auto i : c10::irange(phases_.size())) {
+    code << codegen::generateCudaPhase(
+                phases_.at(i)->kernel(), phaseName(name_, i))
+         << "\n";
+    parameter_types.push_back(
+        codegen::generateParameterTypes(phases_.at(i)->kernel()));
+  }
+
+  code << "__global__ void " << name_ << "(";
+  for (auto i : c10::irange(phases_.size())) {
+    for (auto j : c10::irange(parameter_types.at(i).size())) {
+      code << parameter_types.at(i).at(j) << " p" << i << "_" << j << ", ";
+    }
+  }
+  for (auto i : c10::irange(phases_.size())) {
+    code << "const dim3 grid" << i << ", ";
+  }
+  code << "int64_t* semaphore) {\n";
+  for (auto i : c10::irange(phases_.size())) {
+    const std::string grid = "grid" + std::to_string(i);
+    if (i > 0) {
+      code << "  grid_sync::sync<true, true, true, true, true>("
+           << "*semaphore, gridDim.x);\n";
+    }
+    code << "  for (int64_t block = blockIdx.x; block < (int64_t)" << grid
+         << ".x * " << grid << ".y * " << grid
+         << ".z; block += gridDim.x) {\n";
+    code << "    " << phaseName(name_, i) << "(dim3((unsigned)(block % "
+         << grid << ".x), (unsigned)(block / " << grid << ".x % " << grid
+         << ".y), (unsigned)(block / ((int64_t)" << grid << ".x * " << grid
+         << ".y))), " << grid;
+    for (auto j : c10::irange(parameter_types.at(i).size())) {
+      code << ", p" << i << "_" << j;
+    }
+    code << ");\n";
+    code << "    block_sync::sync<true>();\n";
+    code << "  }\n";
+  }
+  code << "}\n";
+
+  code_ = phases_.front()->getStructuredCode(
+      code.str(), phases_.front()->kernel()->indexType());
+}
+
+CUfunction Megakernel::function(
+    int64_t block_size,
+    int64_t dynamic_smem_size) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  CompiledMegakernel& compiled = compiled_kernels_[block_size];
+  if (compiled.kernel == nullptr) {
+    CompileParams compile_params;
+    compile_params.index_type = phases_.front()->kernel()->indexType();
+    compiled.kernel = executor_utils::getCompiledKernel(
+        std::nullopt, code_, name_, name_, compile_params, block_size);
+  }
+  if (dynamic_smem_size > compiled.available_dynamic_smem_size) {
+    NVFUSER_CUDA_SAFE_CALL(cuFuncSetAttribute(
+        compiled.kernel->function,
+        CU_FUNC_ATTRIBUTE_MAX_DYNAMIC_SHARED_SIZE_BYTES,
+        (int)dynamic_smem_size));
+    compiled.available_dynamic_smem_size = dynamic_smem_size;
+  }
+  return compiled.kernel->function;
+}
+
+int64_t Megakernel::persistentGridSize(
+    const std::vector<FusionExecutor::RecordedLaunch>& launches,
+    CUfunction function,
+    int64_t device_index) const {
+  int64_t num_blocks = 0;
+  int64_t dynamic_smem_size = 0;
+  for (const auto& launch : launches) {
+    const LaunchParams& launch_params = launch.launch_params;
+    num_blocks = std::max(
+        num_blocks,
+        launch_params.gdimx() * launch_params.gdimy() * launch_params.gdimz());
+    dynamic_smem_size = std::max(dynamic_smem_size, launch_params.smem());
+  }
+  const LaunchParams& launch_params = launches.front().launch_params;
+  int blocks_per_sm = 0;
+  NVFUSER_CUDA_SAFE_CALL(cuOccupancyMaxActiveBlocksPerMultiprocessor(
+      &blocks_per_sm,
+      function,
+      (int)launch_params.nThreads(),
+      (size_t)dynamic_smem_size));
+  const int64_t num_sms =
+      at::cuda::getDeviceProperties((c10::DeviceIndex)device_index)
+          ->multiProcessorCount;
+  return std::min(num_blocks, (int64_t)blocks_per_sm * num_sms);
+}
+
+void Megakernel::launch(
+    const std::vector<FusionExecutor::RecordedLaunch>& launches,
+    CUstream stream,
+    int64_t device_index) {
+  FUSER_PERF_SCOPE("Megakernel::launch");
+  auto arg_pointers = [](const FusionExecutor::RecordedLaunch& launch,
+                         std::vector<void*>& arg_ptrs) {
+    for (const auto& arg : launch.args) {
+      arg_ptrs.push_back(const_cast<std::byte*>(arg.data()));
+    }
+  };
+
+  bool fits = launches.size() == phases_.size();
+  int64_t dynamic_smem_size = 0;
+  for (auto i : c10::irange(launches.size())) {
+    if (!fits) {
+      break;
+    }
+    const LaunchParams& launch_params = launches.at(i).launch_params;
+    const LaunchParams& first = launches.front().launch_params;
+    fits = launches.at(i).executor == phases_.at(i) &&
+        launch_params.bdimx() == first.bdimx() &&
+        launch_params.bdimy() == first.bdimy() &&
+        launch_params.bdimz() == first.bdimz();
+    dynamic_smem_size = std::max(dynamic_smem_size, launch_params.smem());
+  }
+  fits = fits &&
+      dynamic_smem_size <=
+          (int64_t)at::cuda::getDeviceProperties((c10::DeviceIndex)device_index)
+              ->sharedMemPerBlockOptin;
+
+  int64_t grid_size = 0;
+  CUfunction megakernel = nullptr;
+  if (fits) {
+    megakernel = function(
+        launches.front().launch_params.nThreads(), dynamic_smem_size);
+    grid_size = persistentGridSize(launches, megakernel, device_index);
+  }
+
+  if (grid_size == 0) {
+    for (const auto& launch : launches) {
+      std::vector<void*> arg_ptrs;
+      arg_pointers(launch, arg_ptrs);
+      const LaunchParams& launch_params = launch.launch_params;
+      NVFUSER_CUDA_SAFE_CALL(cuLaunchKernel(
+          launch.function,
+          launch_params.gdimx(),
+          launch_params.gdimy(),
+          launch_params.gdimz(),
+          launch_params.bdimx(),
+          launch_params.bdimy(),
+          launch_params.bdimz(),
+          launch_params.smem(),
+          stream,
+          arg_ptrs.data(),
+          nullptr));
+    }
+    return;
+  }
+
+  std::vector<void*> arg_ptrs;
+  for (const auto& launch : launches) {
+    arg_pointers(launch, arg_ptrs);
+  }
+  std::vector<std::array<uint32_t, 3>> grids;
+  grids.reserve(launches.size());
+  for (const auto& launch : launches) {
+    const LaunchParams& launch_params = launch.launch_params;
+    grids.push_back(
+        {(uint32_t)launch_params.gdimx(),
+         (uint32_t)launch_params.gdimy(),
+         (uint32_t)launch_params.gdimz()});
+    arg_ptrs.push_back(grids.back().data());
+  }
+  at::Tensor semaphore = at::zeros(
+      {1},
+      at::TensorOptions()
+          .dtype(at::kLong)
+          .device(at::kCUDA, (c10::DeviceIndex)device_index));
+  void* semaphore_ptr = semaphore.data_ptr();
+  arg_ptrs.push_back(&semaphore_ptr);
+
+  const LaunchParams& launch_params = launches.front().launch_params;
+  NVFUSER_CUDA_SAFE_CALL(cuLaunchCooperativeKernel(
+      megakernel,
+      (unsigned int)grid_size,
+      1,
+      1,
+      launch_params.bdimx(),
+      launch_params.bdimy(),
+      launch_params.bdimz(),
+      dynamic_smem_size,
+      stream,
+      arg_ptrs.data()));
+
+  std::lock_guard<std::mutex> guard(mutex_);
+  num_launches_++;
+}
+
+} // namespace nvfuser
@@ -0,0 +1,82 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#pragma once
+
+#include <cuda.h>
+
+#include <exceptions.h>
+#include <executor.h>
+#include <executor_utils.h>
+#include <utils.h>
+#include <visibility.h>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace nvfuser {
+
+//! One persistent cooperative kernel running the kernels of the segments of
+//! a FusionKernelRuntime one after the other. See [ Note -- Megakernel ] in
+//! megakernel.cpp.
+class Megakernel : public NonCopyable {
+ public:
+  //! Whether the kernels of `executors`, in their run order, can be the
+  //! phases of a megakernel
+  static bool canRun(const std::vector<const FusionExecutor*>& executors);
+
+  //! Generates the code of the megakernel. It is compiled at the first
+  //! launch with each block size.
+  explicit Megakernel(std::vector<const FusionExecutor*> phases);
+
+  //! Issues the launches recorded from one run of the phases on `stream`, as
+  //! a single launch of the megakernel when they allow it and one after the
+  //! other otherwise
+  void launch(
+      const std::vector<FusionExecutor::RecordedLaunch>& launches,
+      CUstream stream,
+      int64_t device_index);
+
+  //! Number of times the recorded launches ran as a megakernel
+  int64_t numLaunches() const {
+    std::lock_guard<std::mutex> guard(mutex_);
+    return num_launches_;
+  }
+
+  const std::string& code() const {
+    return code_;
+  }
+
+ private:
+  //! Number of blocks of the persistent grid running `launches`, or 0 if
+  //! they cannot run as the phases of the megakernel
+  int64_t persistentGridSize(
+      const std::vector<FusionExecutor::RecordedLaunch>& launches,
+      CUfunction function,
+      int64_t device_index) const;
+
+  //! The megakernel compiled for blocks of `block_size` threads
+  CUfunction function(int64_t block_size, int64_t dynamic_smem_size);
+
+  std::vector<const FusionExecutor*> phases_;
+  std::string name_;
+  std::string code_;
+
+  mutable std::mutex mutex_;
+  struct CompiledMegakernel {
+    std::unique_ptr<executor_utils::CompiledKernel> kernel;
+    int64_t available_dynamic_smem_size = 0;
+  };
+  std::unordered_map<int64_t, CompiledMegakernel> compiled_kernels_;
+  int64_t num_launches_ = 0;
+};
+
+} // namespace nvfuser
@@ -34,13 +34,16 @@ enum class MatmulDimRole { M = 0, N, K, Batch };
 //!  OUTPUT - fusion outputs that have the matmul as a dependency
 //!  EPILOGUE_INPUT - an input to the fusion that is a producer of an
 //!    OUTPUT, but not of an MMA input
+//!  EPILOGUE_REDUCTION - fusion outputs that have M but no N dimensions, i.e.
+//!    that are computed by reducing the N dimensions in the epilogue
 //!
 //!  Note: bias vector tensors will be assigned to the EPILOGUE_INPUT role.
 enum class MatmulTensorRole {
   OPERAND_A = 0,
   OPERAND_B,
   OUTPUT,
-  EPILOGUE_INPUT
+  EPILOGUE_INPUT,
+  EPILOGUE_REDUCTION
 };
 
 //! The expected number of occurances of core TensorView roles in fusion
@@ -136,6 +139,9 @@ enum class MmaMacro : uint64_t {
 
   MACRO(Ampere, 16, 8, 16),
   MACRO(Ampere, 16, 16, 16),
+  // fp8 operands, on Ada and newer
+  MACRO(Ampere, 16, 8, 32),
+  MACRO(Ampere, 16, 16, 32),
 
   MACRO(Hopper, 64, 8, 16),
   MACRO(Hopper, 64, 16, 16),
@@ -0,0 +1,194 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#include <multi_tensor_apply.h>
+
+#include <instrumentation.h>
+#include <ir/utils.h>
+
+#include <c10/util/irange.h>
+
+#include <algorithm>
+
+namespace nvfuser {
+
+// [ Note -- Multi-tensor apply ]
+//
+// An optimizer step applies the same per-element math to every parameter,
+// which run one at a time makes thousands of tiny kernels. Apex-style fused
+// optimizers instead launch one kernel over a device-side table of (pointer,
+// size) chunks. MultiTensorApply gets the same single launch out of the
+// existing schedulers by running the update once per tensor list on a flat
+// 1D tensor holding all the tensors of the list: the table is implied by the
+// offsets of the tensors in the flat tensor.
+//
+// When the tensors of a list are contiguous and laid out back to back in the
+// same storage, e.g. allocated with MultiTensorApply::allocateFlat, the flat
+// tensor is a view of that storage. The outputs of the update aliased to its
+// inputs then update the tensors in place without any copy. The tensors of
+// other lists are packed into a new flat tensor, and the updated ones are
+// copied back after the kernel.
+//
+// As the update only sees flat tensors, per-tensor reductions, e.g. the trust
+// ratios of LAMB, have to be computed separately and passed in as scalars or
+// tensor lists.
+
+namespace {
+
+int64_t numTensorLists(Fusion* update) {
+  NVF_CHECK(
+      !ir_utils::hasAnyReductionOps(update),
+      "The update of a multi-tensor apply must be pointwise");
+  int64_t num_tensor_lists = 0;
+  for (Val* in : update->inputs()) {
+    auto* tv = dynamic_cast<TensorView*>(in);
+    if (tv == nullptr) {
+      break;
+    }
+    NVF_CHECK(
+        TensorDomain::noReductions(tv->getLogicalDomain()).size() == 1,
+        "Expected a 1D tensor input but found ",
+        tv->toString());
+    num_tensor_lists++;
+  }
+  NVF_CHECK(num_tensor_lists > 0, "The update has no tensor input");
+  for (auto i :
+       c10::irange(num_tensor_lists, (int64_t)update->inputs().size())) {
+    NVF_CHECK(
+        update->inputs().at(i)->isScalar(),
+        "Tensor inputs must come before scalar inputs");
+  }
+  return num_tensor_lists;
+}
+
+std::vector<bool> updatedLists(Fusion* update, int64_t num_tensor_lists) {
+  std::vector<bool> updated(num_tensor_lists, false);
+  for (Val* out : update->outputs()) {
+    const AliasInfo& alias_info = update->getOutputAlias(out);
+    if (alias_info.type != AllocationType::ReuseBuffer) {
+      continue;
+    }
+    auto it = std::find(
+        update->inputs().begin(),
+        update->inputs().end(),
+        alias_info.aliased_io);
+    updated.at(std::distance(update->inputs().begin(), it)) = true;
+  }
+  return updated;
+}
+
+// A 1D view of the storage of `tensors` if they are contiguous and back to
+// back, or an undefined tensor
+at::Tensor flatView(const std::vector<at::Tensor>& tensors) {
+  const at::Tensor& first = tensors.front();
+  int64_t numel = 0;
+  for (const at::Tensor& tensor : tensors) {
+    if (!tensor.is_contiguous() ||
+        tensor.scalar_type() != first.scalar_type() ||
+        !tensor.storage().is_alias_of(first.storage()) ||
+        tensor.storage_offset() != first.storage_offset() + numel) {
+      return at::Tensor();
+    }
+    numel += tensor.numel();
+  }
+  return first.as_strided({numel}, {1}, first.storage_offset());
+}
+
+} // namespace
+
+MultiTensorApply::MultiTensorApply(std::unique_ptr<Fusion> update)
+    : num_tensor_lists_(numTensorLists(update.get())),
+      updated_(updatedLists(update.get(), num_tensor_lists_)),
+      fec_(std::move(update)) {}
+
+std::vector<at::Tensor> MultiTensorApply::run(
+    const std::vector<std::vector<at::Tensor>>& tensor_lists,
+    const std::vector<c10::IValue>& scalars) {
+  FUSER_PERF_SCOPE("MultiTensorApply::run");
+  NVF_CHECK(
+      (int64_t)tensor_lists.size() == num_tensor_lists_,
+      "Expected ",
+      num_tensor_lists_,
+      " tensor lists but got ",
+      tensor_lists.size());
+  const std::vector<at::Tensor>& first_list = tensor_lists.front();
+  NVF_CHECK(!first_list.empty(), "Empty tensor lists");
+  for (const std::vector<at::Tensor>& list : tensor_lists) {
+    NVF_CHECK(
+        list.size() == first_list.size(),
+        "The tensor lists have different lengths");
+    for (auto j : c10::irange(list.size())) {
+      NVF_CHECK(
+          list.at(j).numel() == first_list.at(j).numel(),
+          "Tensor ",
+          j,
+          " of the lists has different numbers of elements");
+    }
+  }
+
+  std::vector<c10::IValue> inputs;
+  inputs.reserve(tensor_lists.size() + scalars.size());
+  std::vector<bool> packed(tensor_lists.size(), false);
+  for (auto i : c10::irange(tensor_lists.size())) {
+    at::Tensor flat = flatView(tensor_lists.at(i));
+    if (!flat.defined()) {
+      std::vector<at::Tensor> flattened;
+      flattened.reserve(tensor_lists.at(i).size());
+      for (const at::Tensor& tensor : tensor_lists.at(i)) {
+        flattened.push_back(tensor.reshape({-1}));
+      }
+      flat = at::cat(flattened);
+      packed.at(i) = true;
+    }
+    inputs.emplace_back(flat);
+  }
+  inputs.insert(inputs.end(), scalars.begin(), scalars.end());
+
+  std::vector<at::Tensor> outputs = fec_.runFusionWithInputs(inputs);
+
+  for (auto i : c10::irange(tensor_lists.size())) {
+    if (!packed.at(i) || !updated_.at(i)) {
+      continue;
+    }
+    const at::Tensor& flat = inputs.at(i).toTensor();
+    int64_t offset = 0;
+    for (const at::Tensor& tensor : tensor_lists.at(i)) {
+      tensor.copy_(flat.narrow(0, offset, tensor.numel()).view_as(tensor));
+      offset += tensor.numel();
+    }
+  }
+  return outputs;
+}
+
+std::vector<at::Tensor> MultiTensorApply::allocateFlat(
+    const std::vector<std::vector<int64_t>>& shapes,
+    const at::TensorOptions& options) {
+  std::vector<int64_t> numels;
+  numels.reserve(shapes.size());
+  int64_t total = 0;
+  for (const std::vector<int64_t>& shape : shapes) {
+    int64_t numel = 1;
+    for (int64_t size : shape) {
+      numel *= size;
+    }
+    numels.push_back(numel);
+    total += numel;
+  }
+  at::Tensor buffer = at::empty({total}, options);
+
+  std::vector<at::Tensor> tensors;
+  tensors.reserve(shapes.size());
+  int64_t offset = 0;
+  for (auto i : c10::irange(shapes.size())) {
+    tensors.push_back(
+        buffer.narrow(0, offset, numels.at(i)).view(shapes.at(i)));
+    offset += numels.at(i);
+  }
+  return tensors;
+}
+
+} // namespace nvfuser
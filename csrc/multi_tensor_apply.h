@@ -0,0 +1,57 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#pragma once
+
+#include <fusion.h>
+#include <kernel_cache.h>
+#include <visibility.h>
+
+#include <ATen/ATen.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace nvfuser {
+
+//! Applies the same per-element update to lists of tensors with one kernel,
+//! e.g. an optimizer step over all parameters, moments and master weights.
+//! See [ Note -- Multi-tensor apply ] in multi_tensor_apply.cpp.
+class MultiTensorApply {
+ public:
+  //! `update` is a pointwise fusion whose first inputs are 1D tensors, one per
+  //! tensor list, followed by scalars, e.g. the learning rate. The tensors
+  //! updated in place are those its outputs are aliased to with
+  //! AllocationType::ReuseBuffer.
+  NVF_API explicit MultiTensorApply(std::unique_ptr<Fusion> update);
+
+  //! Runs the update on the j-th tensors of all lists for every j, which must
+  //! have the same number of elements. Returns the outputs of the update that
+  //! aren't hidden, on the lists flattened.
+  NVF_API std::vector<at::Tensor> run(
+      const std::vector<std::vector<at::Tensor>>& tensor_lists,
+      const std::vector<c10::IValue>& scalars = {});
+
+  //! Allocates tensors of `shapes` as consecutive views of one buffer, so that
+  //! run doesn't need to copy them
+  NVF_API static std::vector<at::Tensor> allocateFlat(
+      const std::vector<std::vector<int64_t>>& shapes,
+      const at::TensorOptions& options);
+
+  FusionExecutorCache& executorCache() {
+    return fec_;
+  }
+
+ private:
+  int64_t num_tensor_lists_ = 0;
+  //! Whether the tensors of each list are updated in place
+  std::vector<bool> updated_;
+  FusionExecutorCache fec_;
+};
+
+} // namespace nvfuser
@@ -49,6 +49,8 @@ struct ScatterOptions {
 
 struct AllgatherOptions {};
 
+struct AllToAllOptions {};
+
 struct GatherOptions {
   int64_t rootRank = 0;
 };
@@ -105,6 +107,15 @@ class Backend : public torch::CustomClassHolder {
     return c10::make_intrusive<Work>();
   }
 
+  c10::intrusive_ptr<Work> alltoall_base(
+      at::Tensor& outputBuffer,
+      at::Tensor& inputBuffer,
+      std::vector<int64_t>& outputSplitSizes,
+      std::vector<int64_t>& inputSplitSizes,
+      const AllToAllOptions& opts = AllToAllOptions()) {
+    return c10::make_intrusive<Work>();
+  }
+
   c10::intrusive_ptr<Work> gather(
       std::vector<std::vector<at::Tensor>>& outputTensors,
       std::vector<at::Tensor>& inputTensors,
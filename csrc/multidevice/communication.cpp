@@ -9,11 +9,16 @@
 #include <ir/iostream.h>
 #include <ir/printer.h>
 #include <multidevice/communication.h>
+#include <options.h>
 #if defined(NVFUSER_DISTRIBUTED) && defined(USE_C10D_NCCL)
 #include <torch/csrc/distributed/c10d/ProcessGroupNCCL.hpp>
 #endif
 #include <utils.h>
 
+#include <algorithm>
+#include <map>
+#include <optional>
+
 namespace nvfuser {
 
 std::ostream& operator<<(std::ostream& os, const CommunicationType& type) {
@@ -42,6 +47,9 @@ std::ostream& operator<<(std::ostream& os, const CommunicationType& type) {
     case CommunicationType::SendRecv:
       os << "SendRecv";
       break;
+    case CommunicationType::AllToAll:
+      os << "AllToAll";
+      break;
     default:
       NVF_ERROR(false, "unrecognized CommunicationType: ", type);
   }
@@ -76,6 +84,18 @@ void assertBuffersHaveSameSize(
   }
 }
 
+// Returns the P2P channel to post a communication through, or nullptr if it
+// should go through the backend. `bytes` is the size of the message each
+// device contributes, which is the same on all devices, so all members of the
+// team make the same decision.
+P2pChannel* getP2pChannel(const Team& team, int64_t bytes) {
+  if (isOptionDisabled(DisableOption::P2pCommunication) ||
+      bytes > P2pChannel::kMaxMessageBytes) {
+    return nullptr;
+  }
+  return Communicator::getInstance().getP2pChannelForTeam(team);
+}
+
 void doLocalCopy(const at::Tensor& dst, const at::Tensor& src) {
   dst.view_as(src).copy_(src, /*non_blocking=*/true);
 }
@@ -109,6 +129,7 @@ bool hasRoot(CommunicationType type) {
     case CommunicationType::Allgather:
     case CommunicationType::Allreduce:
     case CommunicationType::ReduceScatter:
+    case CommunicationType::AllToAll:
       return false;
     default:
       NVF_ERROR(false, "unrecognized CommunicationType: ", type);
@@ -126,6 +147,7 @@ bool isReduction(CommunicationType type) {
     case CommunicationType::Scatter:
     case CommunicationType::Broadcast:
     case CommunicationType::SendRecv:
+    case CommunicationType::AllToAll:
       return false;
     default:
       NVF_ERROR(false, "unrecognized CommunicationType: ", type);
@@ -142,7 +164,8 @@ Communication::Communication(
     Team team,
     DeviceIdxType root,
     RedOpType red_op,
-    int64_t scattered_axis)
+    int64_t scattered_axis,
+    int64_t gathered_axis)
     : Expr(passkey) {
   NVF_ERROR(
       in->getDeviceMesh().size() > 0,
@@ -158,6 +181,7 @@ Communication::Communication(
   addDataAttribute(root);
   addDataAttribute(red_op);
   addDataAttribute(scattered_axis);
+  addDataAttribute(gathered_axis);
 
   validate();
 }
@@ -171,7 +195,9 @@ void Communication::validate() {
       type());
   NVF_ERROR(isReduction(type()) == (reduceOp() != RedOpType::UNUSED))
   NVF_ERROR(
-      (type() == CommunicationType::ReduceScatter) == (scatteredAxis() >= 0));
+      (type() == CommunicationType::ReduceScatter ||
+       type() == CommunicationType::AllToAll) == (scatteredAxis() >= 0));
+  NVF_ERROR((type() == CommunicationType::AllToAll) == (gatheredAxis() >= 0));
 }
 
 NVFUSER_DEFINE_CLONE_AND_CREATE(Communication)
@@ -196,6 +222,10 @@ std::string Communication::toString(const int indent_size) const {
   if (hasRoot(type())) {
     ss << ", root=" << root();
   }
+  if (type() == CommunicationType::AllToAll) {
+    ss << ", scattered_axis=" << scatteredAxis()
+       << ", gathered_axis=" << gatheredAxis();
+  }
   if (!inputs().empty()) {
     ss << ", input=" << in();
   }
@@ -289,6 +319,13 @@ c10::intrusive_ptr<c10d::Work> postAllgather(
   assertBufferCount(splits, communication->team().size());
   assertBuffersHaveSameSize({input_tensor}, splits);
 
+  if (P2pChannel* channel = getP2pChannel(
+          communication->team(),
+          input_tensor.numel() * input_tensor.element_size())) {
+    channel->allgather(input_tensor, output_tensor);
+    return nullptr;
+  }
+
   // allgather primitive in c10d induces extra buffering time to copy out the
   // received tensors into user buffer. It is therefore always preferable to use
   // _allgather_base, which does not perform any extra copy at the cost of
@@ -362,6 +399,74 @@ c10::intrusive_ptr<c10d::Work> postReduce(
   return backend->reduce(tensors, options);
 }
 
+// Note [Hierarchical Allreduce]
+// An Allreduce whose team spans several nodes is decomposed into
+//   1. a ReduceScatter among the team's devices of each node,
+//   2. an Allreduce of the resulting shards among the devices that have the
+//      same position on their node,
+//   3. an Allgather of the reduced shards among the team's devices of each
+//      node,
+// so that each device sends only 1/n of the data over the inter-node network,
+// n being the number of the team's devices per node, instead of the whole
+// buffer through a flat ring. This requires every node to hold the same
+// number of the team's devices and the buffer to be divisible among them, and
+// is only worth it for large buffers, so other Allreduces are posted as is.
+// The three collectives are ordered by waiting for each one on the current
+// stream, which doesn't block the host with NCCL. The sub-teams' backends are
+// cached by the Communicator like any other.
+
+// The sub-teams of a hierarchical Allreduce. See Note [Hierarchical
+// Allreduce]
+struct HierarchicalTeams {
+  // The team's devices on my node
+  Team intra_node;
+  // The team's devices with the same position on their node as me
+  Team inter_node;
+};
+
+std::optional<HierarchicalTeams> getHierarchicalTeams(
+    const Team& team,
+    DeviceIdxType my_device_index,
+    c10d::Backend* backend,
+    const at::Tensor& buffer) {
+#if defined(NVFUSER_DISTRIBUTED) && defined(USE_C10D_NCCL)
+  constexpr int64_t kMinBytes = 1 << 20;
+  if (isOptionDisabled(DisableOption::HierarchicalCommunication) ||
+      backend->getBackendName() != c10d::NCCL_BACKEND_NAME ||
+      !buffer.is_contiguous() ||
+      buffer.numel() * buffer.element_size() < kMinBytes) {
+    return std::nullopt;
+  }
+  Communicator& communicator = Communicator::getInstance();
+  // The team's devices of each node, in the order of the team
+  std::map<int64_t, Team> nodes;
+  for (DeviceIdxType device_index : team) {
+    nodes[communicator.nodeOf(device_index)].push_back(device_index);
+  }
+  const int64_t devices_per_node =
+      static_cast<int64_t>(nodes.begin()->second.size());
+  if (nodes.size() < 2 || devices_per_node < 2 ||
+      buffer.numel() % devices_per_node != 0 ||
+      std::any_of(nodes.begin(), nodes.end(), [&](const auto& node) {
+        return static_cast<int64_t>(node.second.size()) != devices_per_node;
+      })) {
+    return std::nullopt;
+  }
+  HierarchicalTeams teams;
+  teams.intra_node = nodes.at(communicator.nodeOf(my_device_index));
+  const auto position = std::distance(
+      teams.intra_node.begin(),
+      std::find(
+          teams.intra_node.begin(), teams.intra_node.end(), my_device_index));
+  for (const auto& [node, devices] : nodes) {
+    teams.inter_node.push_back(devices.at(position));
+  }
+  return teams;
+#else
+  return std::nullopt;
+#endif
+}
+
 c10::intrusive_ptr<c10d::Work> postAllreduce(
     Communication* communication,
     DeviceIdxType my_device_index,
@@ -371,6 +476,28 @@ c10::intrusive_ptr<c10d::Work> postAllreduce(
   doLocalCopy(output_tensor, input_tensor);
   std::vector<at::Tensor> output_tensors({output_tensor});
 
+  if (std::optional<HierarchicalTeams> teams = getHierarchicalTeams(
+          communication->team(), my_device_index, backend, output_tensor)) {
+    Communicator& communicator = Communicator::getInstance();
+    c10d::Backend* intra_node_backend = communicator.getBackendForTeam(
+        teams->intra_node, CommunicatorBackend::nccl);
+    c10d::Backend* inter_node_backend = communicator.getBackendForTeam(
+        teams->inter_node, CommunicatorBackend::nccl);
+    at::Tensor flat = output_tensor.view({-1});
+    at::Tensor shard = at::empty(
+        {flat.numel() / static_cast<int64_t>(teams->intra_node.size())},
+        flat.options());
+    intra_node_backend
+        ->_reduce_scatter_base(
+            shard, flat, {.reduceOp = communication->reduceOp()})
+        ->wait();
+    std::vector<at::Tensor> shards({shard});
+    inter_node_backend
+        ->allreduce(shards, {.reduceOp = communication->reduceOp()})
+        ->wait();
+    return intra_node_backend->_allgather_base(flat, shard);
+  }
+
   return backend->allreduce(
       output_tensors, {.reduceOp = communication->reduceOp()});
 }
@@ -433,6 +560,14 @@ c10::intrusive_ptr<c10d::Work> postSendRecv(
     return nullptr;
   }
 
+  const at::Tensor& buffer =
+      (my_device_index == sender ? input_tensor : output_tensor);
+  if (P2pChannel* channel =
+          getP2pChannel(team, buffer.numel() * buffer.element_size())) {
+    channel->sendRecv(sender, receiver, input_tensor, output_tensor);
+    return nullptr;
+  }
+
   std::vector<at::Tensor> tensors;
   if (my_device_index == sender) {
     tensors = {input_tensor};
@@ -449,8 +584,110 @@ c10::intrusive_ptr<c10d::Work> postSendRecv(
         /*tag=*/0);
   }
 }
+
+// Whether the chunks of `tensor` along `axis` are contiguous and laid out one
+// after the other, so that they can be sent or received in place
+bool hasOutermostChunks(const at::Tensor& tensor, int64_t axis) {
+  return tensor.is_contiguous() &&
+      std::all_of(
+             tensor.sizes().begin(),
+             tensor.sizes().begin() + axis,
+             [](int64_t size) { return size == 1; });
+}
+
+// Views `tensor` as [<team_size>, ...] with the i-th chunk along `axis` at
+// index i of the new outermost axis
+at::Tensor chunksToFront(const at::Tensor& tensor, int64_t axis, int64_t n) {
+  std::vector<int64_t> sizes = tensor.sizes().vec();
+  NVF_ERROR(
+      sizes.at(axis) % n == 0,
+      "AllToAll expects axis ",
+      axis,
+      " of size ",
+      sizes.at(axis),
+      " to be divisible by the team size ",
+      n);
+  sizes.at(axis) /= n;
+  sizes.insert(sizes.begin() + axis, n);
+  return tensor.view(sizes).movedim(axis, 0);
+}
+
+c10::intrusive_ptr<c10d::Work> postUniformAllToAll(
+    Communication* communication,
+    DeviceIdxType my_device_index,
+    c10d::Backend* backend,
+    at::Tensor input_tensor,
+    at::Tensor output_tensor) {
+  const auto n = static_cast<int64_t>(communication->team().size());
+  if (n == 1) {
+    doLocalCopy(output_tensor, input_tensor);
+    return nullptr;
+  }
+
+  // Packs the chunks to send one after the other, unless the producer
+  // already wrote them that way.
+  const int64_t scattered_axis = communication->scatteredAxis();
+  at::Tensor send_buffer = hasOutermostChunks(input_tensor, scattered_axis)
+      ? input_tensor
+      : chunksToFront(input_tensor, scattered_axis, n).contiguous();
+
+  std::vector<int64_t> no_split_sizes;
+  const int64_t gathered_axis = communication->gatheredAxis();
+  if (hasOutermostChunks(output_tensor, gathered_axis)) {
+    return backend->alltoall_base(
+        output_tensor, send_buffer, no_split_sizes, no_split_sizes);
+  }
+
+  // Unpacks the received chunks once they arrived. With NCCL, waiting only
+  // orders the copy after the exchange on the current stream.
+  at::Tensor recv_buffer =
+      at::empty_like(chunksToFront(output_tensor, gathered_axis, n))
+          .contiguous();
+  backend
+      ->alltoall_base(recv_buffer, send_buffer, no_split_sizes, no_split_sizes)
+      ->wait();
+  chunksToFront(output_tensor, gathered_axis, n).copy_(recv_buffer);
+  return nullptr;
+}
 } // namespace
 
+c10::intrusive_ptr<c10d::Work> postAllToAll(
+    Communication* communication,
+    DeviceIdxType my_device_index,
+    c10d::Backend* backend,
+    at::Tensor input_tensor,
+    at::Tensor output_tensor,
+    std::vector<int64_t> input_split_sizes,
+    std::vector<int64_t> output_split_sizes) {
+  NVF_ERROR(
+      communication->type() == CommunicationType::AllToAll,
+      "Expected an AllToAll, but got ",
+      communication->type());
+  NVF_ERROR(
+      communication->scatteredAxis() == 0 &&
+          communication->gatheredAxis() == 0,
+      "Variable split sizes are only supported along the outermost axis");
+  const Team& team = communication->team();
+  if (std::find(team.begin(), team.end(), my_device_index) == team.end()) {
+    return nullptr;
+  }
+  NVF_ERROR(backend != nullptr);
+  NVF_ERROR(
+      input_split_sizes.size() == team.size() &&
+          output_split_sizes.size() == team.size(),
+      "Expected ",
+      team.size(),
+      " split sizes, but got ",
+      input_split_sizes.size(),
+      " and ",
+      output_split_sizes.size());
+  NVF_ERROR(
+      input_tensor.is_contiguous() && output_tensor.is_contiguous(),
+      "AllToAll with variable split sizes expects contiguous buffers");
+  return backend->alltoall_base(
+      output_tensor, input_tensor, output_split_sizes, input_split_sizes);
+}
+
 c10::intrusive_ptr<c10d::Work> postSingleCommunication(
     Communication* communication,
     DeviceIdxType my_device_index,
@@ -488,6 +725,9 @@ c10::intrusive_ptr<c10d::Work> postSingleCommunication(
     case CommunicationType::SendRecv:
       return postSendRecv(
           communication, my_device_index, backend, input_tensor, output_tensor);
+    case CommunicationType::AllToAll:
+      return postUniformAllToAll(
+          communication, my_device_index, backend, input_tensor, output_tensor);
     default:
       NVF_ERROR(false, "Wrong communication type: ", communication->type());
       return nullptr;
@@ -31,7 +31,8 @@ enum class CommunicationType {
   Allreduce,
   ReduceScatter,
   Broadcast,
-  SendRecv
+  SendRecv,
+  AllToAll
 };
 
 std::ostream& operator<<(std::ostream& os, const CommunicationType& type);
@@ -41,14 +42,15 @@ using RedOpType = c10d::ReduceOp::RedOpType;
 // The class "Communication" represents a MPI-style communication
 // communication operation to be executed on the network. The base class
 // Communication should not be used directly but through its derived classes:
-// Broadcast, Gather, Scatter, Allgather, and SendRecv. Other collectives will
-// be added later.
+// Broadcast, Gather, Scatter, Allgather, SendRecv, and AllToAll. Other
+// collectives will be added later.
 class Communication : public Expr {
  public:
   using Expr::Expr;
   // Only specify `root` for types that have root.
   // Only specify `red_op` for reduction types.
-  // Only specify `scattered_axis` for ReduceScatter.
+  // Only specify `scattered_axis` for ReduceScatter and AllToAll.
+  // Only specify `gathered_axis` for AllToAll.
   Communication(
       IrBuilderPasskey passkey,
       CommunicationType type,
@@ -59,7 +61,8 @@ class Communication : public Expr {
                  // sharding.
       DeviceIdxType root = -1,
       RedOpType red_op = RedOpType::UNUSED,
-      int64_t scattered_axis = -1);
+      int64_t scattered_axis = -1,
+      int64_t gathered_axis = -1);
 
   Communication(const Communication& other) = delete;
   Communication& operator=(const Communication& other) = delete;
@@ -102,6 +105,10 @@ class Communication : public Expr {
     return attribute<int64_t>(4);
   }
 
+  int64_t gatheredAxis() const {
+    return attribute<int64_t>(5);
+  }
+
   // PyTorch's process group expects the root to be specified
   // as an integer between 0 and world_size-1. We choose it to be
   // the device's relative index within the team
@@ -170,6 +177,25 @@ class Communication : public Expr {
 // (*) SendRecv
 // Copies the sender's src buffers to the receiver's dst buffer
 // It is equivalent to a Broadcast with a team of size == 2
+// (*) AllToAll
+// Splits each device's src buffer along scatteredAxis into <team_size>
+// chunks and sends the i-th chunk to the i-th device of the team, which
+// concatenates the chunks it receives along gatheredAxis in the order of the
+// team. It reshards e.g. [DIDx(i0), i1] to [i0, DIDx(i1)], as needed to
+// dispatch tokens to the experts of a MoE layer and to combine them back.
+// Requirements:
+//   - all devices have one src buffer and one dst buffer
+//   - the src buffer's scatteredAxis is divisible by <team_size>
+// The chunks are sent from and received into the buffers in place when
+// scatteredAxis is the src buffer's outermost axis, and gatheredAxis the dst
+// buffer's outermost non-trivial one, e.g. when the producer of the src
+// buffer wrote the tokens grouped by destination. Otherwise, the buffers are
+// packed and unpacked by one copy each.
+//
+// SendRecv and Allgather of small messages among devices of the same node are
+// posted through a P2pChannel instead of `backend`, unless disabled with
+// NVFUSER_DISABLE=p2p_communication. Like local copies, they are then ordered
+// on the current stream and return nullptr.
 c10::intrusive_ptr<c10d::Work> postSingleCommunication(
     Communication* communication,
     DeviceIdxType my_device_index,
@@ -177,4 +203,20 @@ c10::intrusive_ptr<c10d::Work> postSingleCommunication(
     at::Tensor input_tensor,
     at::Tensor output_tensor);
 
+// Posts an AllToAll whose chunks have variable sizes, e.g. the tokens each
+// device dispatches to each expert. The chunks are along the outermost axis,
+// which must be both scatteredAxis and gatheredAxis, and the i-th chunk sent
+// to, resp. received from, the i-th device of the team has
+// input_split_sizes[i], resp. output_split_sizes[i], rows. `output_tensor`
+// must be allocated with the sum of `output_split_sizes` rows by the caller,
+// which usually exchanges the split sizes first with a uniform AllToAll.
+c10::intrusive_ptr<c10d::Work> postAllToAll(
+    Communication* communication,
+    DeviceIdxType my_device_index,
+    c10d::Backend* backend,
+    at::Tensor input_tensor,
+    at::Tensor output_tensor,
+    std::vector<int64_t> input_split_sizes,
+    std::vector<int64_t> output_split_sizes);
+
 } // namespace nvfuser
@@ -7,7 +7,14 @@
 // clang-format on
 #include <multidevice/communicator.h>
 
+#include <cuda_utils.h>
+#include <options.h>
+
+#include <c10/util/irange.h>
+
 #include <netdb.h>
+#include <algorithm>
+#include <limits>
 #include <map>
 
 #ifdef NVFUSER_DISTRIBUTED
@@ -40,6 +47,57 @@ std::ostream& operator<<(std::ostream& out, const CommunicatorBackend& cb) {
   return out;
 }
 
+// Note [Topology-aware device ids]
+// The device indices of a DeviceMesh are taken literally, so a ring or a tree
+// of collectives follows the order of the ranks, and the ranks of a node are
+// numbered by the CUDA ordinal of their GPUs. On nodes where not all the GPUs
+// are directly connected by NVLink, e.g., two NVLink islands linked by PCIe,
+// neighbors in this order may communicate through the host.
+//
+// With EnableOption::TopologyAwareDeviceIds, the Communicator numbers the
+// devices of each node along a chain of their fastest links instead:
+// orderDevicesByLinks chains the GPUs of the node greedily, from GPU 0 to the
+// closest remaining one, and the device of the GPU at position p of the chain
+// of node n gets the index n * local_size + p. Consecutive device indices,
+// hence adjacent members of a mesh, are then as close as possible, and the
+// device indices of a node remain contiguous, so nodeOf and the hierarchical
+// collectives are unaffected. A link's cost is the CUDA P2P performance rank
+// of the two GPUs, penalized when they don't support native atomics, which
+// denotes a PCIe link, and the highest when they can't access each other.
+//
+// Each node computes its own chain, published in the store by its local rank
+// 0, so all the processes agree on the mapping. The GPU of a process remains
+// the one of its local rank; only the device indices, hence the positions in
+// meshes and teams, are changed. Mapping nodes to NICs, i.e., ordering the
+// nodes themselves, is left to the launcher.
+
+std::vector<int64_t> orderDevicesByLinks(
+    int64_t num_devices,
+    const std::function<int64_t(int64_t, int64_t)>& link_cost) {
+  std::vector<int64_t> order;
+  order.reserve(num_devices);
+  std::vector<bool> visited(num_devices, false);
+  int64_t current = 0;
+  for ([[maybe_unused]] auto i : c10::irange(num_devices)) {
+    order.push_back(current);
+    visited.at(current) = true;
+    int64_t next = -1;
+    int64_t next_cost = std::numeric_limits<int64_t>::max();
+    for (auto candidate : c10::irange(num_devices)) {
+      if (visited.at(candidate)) {
+        continue;
+      }
+      const int64_t cost = link_cost(current, candidate);
+      if (next == -1 || cost < next_cost) {
+        next = candidate;
+        next_cost = cost;
+      }
+    }
+    current = next;
+  }
+  return order;
+}
+
 namespace {
 // Parse the environment to retrieve MPI rank, world size, local rank,
 // local world size, and also master address and master port.
@@ -130,6 +188,32 @@ inline std::string getTeamKey(const Team& team, CommunicatorBackend backend) {
       });
 }
 
+// The cost of the link between the local GPUs `a` and `b`. See Note
+// [Topology-aware device ids]
+int64_t getLinkCost(int64_t a, int64_t b) {
+  constexpr int64_t kNoNativeAtomicsPenalty = 1 << 8;
+  constexpr int64_t kNoPeerAccessCost = 1 << 16;
+  int can_access_peer = 0;
+  NVFUSER_CUDA_RT_SAFE_CALL(cudaDeviceCanAccessPeer(
+      &can_access_peer, static_cast<int>(a), static_cast<int>(b)));
+  if (!can_access_peer) {
+    return kNoPeerAccessCost;
+  }
+  int performance_rank = 0;
+  NVFUSER_CUDA_RT_SAFE_CALL(cudaDeviceGetP2PAttribute(
+      &performance_rank,
+      cudaDevP2PAttrPerformanceRank,
+      static_cast<int>(a),
+      static_cast<int>(b)));
+  int native_atomics = 0;
+  NVFUSER_CUDA_RT_SAFE_CALL(cudaDeviceGetP2PAttribute(
+      &native_atomics,
+      cudaDevP2PAttrNativeAtomicSupported,
+      static_cast<int>(a),
+      static_cast<int>(b)));
+  return performance_rank + (native_atomics ? 0 : kNoNativeAtomicsPenalty);
+}
+
 #ifdef NVFUSER_DISTRIBUTED
 // creates and return a process group backend
 c10::intrusive_ptr<c10d::Backend> createBackend(
@@ -199,6 +283,10 @@ Communicator::Communicator(
   }
   store_opts.port = master_port_;
   store_ = c10::make_intrusive<c10d::TCPStore>(master_addr_, store_opts);
+
+  if (isOptionEnabled(EnableOption::TopologyAwareDeviceIds)) {
+    mapDeviceIdsByTopology();
+  }
 #endif
 
 #if defined(USE_C10D_UCC) && defined(NVFUSER_BUILD_WITH_UCC)
@@ -210,6 +298,52 @@ Communicator::Communicator(
 #endif
 }
 
+void Communicator::mapDeviceIdsByTopology() {
+#ifdef NVFUSER_DISTRIBUTED
+  int num_visible_devices = 0;
+  NVFUSER_CUDA_RT_SAFE_CALL(cudaGetDeviceCount(&num_visible_devices));
+  // All the processes must take the same decision, so this only depends on
+  // the launch configuration
+  if (size_ % local_size_ != 0) {
+    TORCH_WARN(
+        "Ignoring EnableOption::TopologyAwareDeviceIds: the nodes don't have ",
+        "the same number of processes");
+    return;
+  }
+  NVF_CHECK(
+      num_visible_devices >= local_size_,
+      "EnableOption::TopologyAwareDeviceIds requires all the GPUs of a node ",
+      "to be visible to its processes, but only ",
+      num_visible_devices,
+      " of ",
+      local_size_,
+      " are");
+
+  const int64_t num_nodes = size_ / local_size_;
+  const std::string key_prefix = "nvfuser_topology_aware_device_ids/";
+  if (local_rank_ == 0) {
+    const std::vector<int64_t> order =
+        orderDevicesByLinks(local_size_, getLinkCost);
+    store_->set(
+        key_prefix + std::to_string(rank_ / local_size_),
+        std::vector<uint8_t>(order.begin(), order.end()));
+  }
+
+  rank_to_device_id_.resize(size_);
+  device_id_to_rank_.resize(size_);
+  for (auto node : c10::irange(num_nodes)) {
+    const std::vector<uint8_t> order =
+        store_->get(key_prefix + std::to_string(node));
+    for (auto position : c10::irange(local_size_)) {
+      const RankType rank = node * local_size_ + order.at(position);
+      const DeviceIdxType device_id = node * local_size_ + position;
+      rank_to_device_id_.at(rank) = device_id;
+      device_id_to_rank_.at(device_id) = rank;
+    }
+  }
+#endif
+}
+
 void Communicator::cleanup() {
   static bool cleaned_up = false;
   if (cleaned_up) {
@@ -220,6 +354,7 @@ void Communicator::cleanup() {
   }
   cleaned_up = true;
 
+  p2p_channels_.clear();
   store_ = nullptr;
 
 #if defined(NVFUSER_DISTRIBUTED) && defined(USE_C10D_NCCL)
@@ -275,6 +410,54 @@ c10d::Backend* Communicator::getBackendForTeam(
   return backends_.at(team_key).get();
 }
 
+P2pChannel* Communicator::getP2pChannelForTeam(const Team& team) {
+  NVF_ERROR(
+      is_available(),
+      "The singleton Communicator isn't available. "
+      "This is likely because Communicator::cleanup has been called "
+      "or the instance wasn't successfully initialized.");
+
+  std::string team_key = std::accumulate(
+      std::begin(team),
+      std::end(team),
+      std::string{"p2p"},
+      [](const std::string& a, const DeviceIdxType& b) {
+        return a + ',' + std::to_string(b);
+      });
+  if (p2p_channels_.find(team_key) == p2p_channels_.end()) {
+    p2p_channels_[team_key] = [&]() -> std::unique_ptr<P2pChannel> {
+#if defined(NVFUSER_DISTRIBUTED) && (CUDA_VERSION >= 12000)
+      if (team.size() < 2 ||
+          std::find(team.begin(), team.end(), deviceId()) == team.end()) {
+        return nullptr;
+      }
+      for (DeviceIdxType device_index : team) {
+        const RankType rank = dIdToRank(device_index);
+        if (nodeOf(device_index) != nodeOf(deviceId())) {
+          return nullptr;
+        }
+        if (rank == rank_) {
+          continue;
+        }
+        int can_access_peer = 0;
+        NVFUSER_CUDA_RT_SAFE_CALL(cudaDeviceCanAccessPeer(
+            &can_access_peer,
+            static_cast<int>(local_rank_),
+            static_cast<int>(rank % local_size_)));
+        if (!can_access_peer) {
+          return nullptr;
+        }
+      }
+      return std::make_unique<P2pChannel>(
+          team, deviceId(), local_rank_, store_.get(), team_key + "/");
+#else
+      return nullptr;
+#endif
+    }();
+  }
+  return p2p_channels_.at(team_key).get();
+}
+
 c10d::Backend* Communicator::getWorld(
     std::optional<CommunicatorBackend> backend) {
   std::vector<RankType> all_ranks(size_);
@@ -13,6 +13,7 @@
 
 #include <exceptions.h>
 #include <multidevice/multidevice.h>
+#include <multidevice/p2p.h>
 #ifdef NVFUSER_DISTRIBUTED
 #include <torch/csrc/distributed/c10d/Backend.hpp>
 #include <torch/csrc/distributed/c10d/TCPStore.hpp>
@@ -22,6 +23,9 @@
 #endif
 #include <visibility.h>
 
+#include <functional>
+#include <vector>
+
 namespace nvfuser {
 
 // This file implements the class Communicator which sets up the inter-process
@@ -48,6 +52,14 @@ constexpr CommunicatorBackend comm_backend_default = CommunicatorBackend::ucc;
 #endif
 constexpr int comm_server_local_rank_default = 0;
 
+// Returns the GPUs 0..num_devices-1 of a node in the order of a chain going
+// through the fastest links: starting from GPU 0, the next GPU is the
+// remaining one with the lowest `link_cost` from the current one, the lowest
+// index breaking ties. See Note [Topology-aware device ids]
+NVF_API std::vector<int64_t> orderDevicesByLinks(
+    int64_t num_devices,
+    const std::function<int64_t(int64_t, int64_t)>& link_cost);
+
 class Communicator {
  public:
   static Communicator& getInstance() {
@@ -109,6 +121,12 @@ class Communicator {
       std::optional<CommunicatorBackend> backend,
       const std::string& prefix = "");
 
+  // returns the P2P channel associated with a team, or nullptr if the team
+  // can't use one, e.g., because it spans several nodes or its devices can't
+  // access each other's memory. Creating a channel is collective over the
+  // team, so this must be called by all its members in the same order.
+  P2pChannel* getP2pChannelForTeam(const Team& team);
+
   // returns the device associated with the current process
   auto device() const {
     return at::Device("cuda:" + std::to_string(local_rank_));
@@ -119,6 +137,13 @@ class Communicator {
     return rankToDiD(rank_);
   }
 
+  // returns the node hosting a device. Ranks are assumed to be assigned to
+  // nodes by contiguous blocks of local_size(), which is how mpirun and
+  // torchrun assign them by default.
+  int64_t nodeOf(DeviceIdxType device_index) const {
+    return dIdToRank(device_index) / local_size_;
+  }
+
   // returns local rank associted with the current process,
   // i.e. the rank within a machine/node as opposed to the rank within the
   // world.
@@ -148,14 +173,20 @@ class Communicator {
 
   // returns the rank corresponding to a device index
   RankType dIdToRank(DeviceIdxType d_id) const {
-    return static_cast<RankType>(d_id);
+    return device_id_to_rank_.empty() ? static_cast<RankType>(d_id)
+                                      : device_id_to_rank_.at(d_id);
   }
 
   // returns the device index corresponding to a rank
   DeviceIdxType rankToDiD(RankType rank) const {
-    return static_cast<DeviceIdxType>(rank);
+    return rank_to_device_id_.empty() ? static_cast<DeviceIdxType>(rank)
+                                      : rank_to_device_id_.at(rank);
   }
 
+  // numbers the devices of each node by the topology of their links. See
+  // Note [Topology-aware device ids]
+  void mapDeviceIdsByTopology();
+
   CommunicatorBackend getBackend(std::optional<CommunicatorBackend> backend) {
     return backend.value_or(default_backend_);
   }
@@ -170,10 +201,17 @@ class Communicator {
   int master_port_;
   bool ucc_available_;
   bool nccl_available_;
+  // the mappings between ranks and device indices. Empty, i.e. the identity,
+  // unless EnableOption::TopologyAwareDeviceIds is set
+  std::vector<DeviceIdxType> rank_to_device_id_;
+  std::vector<RankType> device_id_to_rank_;
   // stores the world's store used for the backend init
   c10::intrusive_ptr<c10d::TCPStore> store_;
   // cache for the created backends. The keys are strings generated from Teams
   std::unordered_map<std::string, c10::intrusive_ptr<c10d::Backend>> backends_;
+  // cache for the created P2P channels. The keys are strings generated from
+  // Teams. A nullptr value means the team can't use a P2P channel.
+  std::unordered_map<std::string, std::unique_ptr<P2pChannel>> p2p_channels_;
 };
 
 } // namespace nvfuser
@@ -10,17 +10,26 @@
 #include <fusion_segmenter.h>
 #include <host_ir/container.h>
 #include <host_ir/host_ir.h>
+#include <host_ir/passes.h>
 #include <ir/builder.h>
 #include <ir/utils.h>
+#include <logical_domain_map.h>
 #include <multidevice/device_mesh.h>
 #include <multidevice/executor.h>
 #include <multidevice/lower_communication.h>
 #include <multidevice/utils.h>
+#include <ops/alias.h>
+#include <ops/utils.h>
 #include <preseg_passes/insert_reshardings.h>
 #include <preseg_passes/make_resharding_contiguous.h>
 #include <preseg_passes/propagate_shardings.h>
 #include <preseg_passes/reorder_sharded_axis.h>
 
+#include <map>
+#include <optional>
+#include <set>
+#include <tuple>
+
 namespace nvfuser {
 
 namespace {
@@ -50,6 +59,1098 @@ std::unique_ptr<Fusion> copyFusionAndChangeOutputs(
   return fusion_copy;
 }
 
+// Note [Overlapping compute and communication]
+// When HostIrExecutorParams::overlap_compute_and_communication is set, a
+// compute segment whose only output is consumed by a ReduceScatter or an
+// Allreduce is decomposed, together with that communication, into chunks along
+// an axis that is neither sharded nor reduced. The host program becomes
+//   for j in range(number_of_chunks):
+//     SetCurrentStream(Stream(j % number_of_streams))
+//     Synchronize(default stream)
+//     in_j = slice(in, j)            for each chunked input of the segment
+//     out_j = PostOnStream(segment, in_j...)
+//     comm_out_j = slice(comm_out, j)
+//     Communication(comm_out_j, out_j); Wait
+//   SetCurrentStream(default stream)
+//   for i in range(number_of_streams):
+//     Synchronize(Stream(i))
+// so the communication of chunk j overlaps with the compute of chunk j + 1.
+// This is the reduce-scatter based pipelining of
+// tests/cpp/test_multidevice_overlap.cpp.
+//
+// The chunked axis is the outermost axis of the communication output that is
+// not sharded, so that each chunk of the preallocated output buffer is
+// contiguous, as c10d requires. It is mapped back through the segment and
+// every expression on the way must carry it as a plain iteration domain: only
+// pointwise, broadcast, squeeze, reduction, set, matmul and linear ops are
+// accepted, the axis may not be reduced or transformed, and a tensor that does
+// not carry it may not depend on one that does. Otherwise, the segment and the
+// communication are lowered as usual.
+//
+// The number of chunks is picked at run time: as many as possible, up to
+// max_chunks and the extent of the chunked axis, while each chunk still sends
+// at least min_chunk_bytes, since smaller collectives are dominated by latency.
+
+// Describes how a compute segment and the communication consuming its output
+// are decomposed into chunks. Axes are positions in the logical domain without
+// reductions.
+struct OverlapCandidate {
+  // Segment consisting of the communication
+  SegmentedGroup* communication_group = nullptr;
+  // Chunked axis of each input of the compute segment, -1 if not chunked
+  std::vector<int64_t> input_axes;
+  // Chunked axis of the output of the compute segment
+  int64_t output_axis = -1;
+  // Chunked axis of the output of the communication
+  int64_t communication_output_axis = -1;
+};
+
+int64_t logicalPosition(TensorView* tv, IterDomain* id) {
+  const auto logical = TensorDomain::noReductions(tv->getLogicalDomain());
+  auto it = std::find(logical.begin(), logical.end(), id);
+  NVF_ERROR(it != logical.end(), id->toString(), " not found in ", tv);
+  return std::distance(logical.begin(), it);
+}
+
+// Returns whether all the logical axes of tv before `axis` have size one
+// locally, i.e., whether slicing tv along `axis` gives contiguous chunks
+bool isOuterAxis(TensorView* tv, int64_t axis) {
+  const auto logical = TensorDomain::noReductions(tv->getLogicalDomain());
+  return std::all_of(
+      logical.begin(), logical.begin() + axis, [](IterDomain* id) {
+        return id->isDeviceDim() || id->isBroadcast();
+      });
+}
+
+// See Note [Overlapping compute and communication]
+std::optional<OverlapCandidate> getOverlapCandidate(
+    SegmentedFusion* staged_fusion,
+    SegmentedGroup* group) {
+  if (group->outputs().size() != 1 ||
+      !group->outputs().at(0)->isA<TensorView>()) {
+    return std::nullopt;
+  }
+  auto* out = group->outputs().at(0)->as<TensorView>();
+  if (out->isFusionOutput() || out->uses().size() != 1) {
+    return std::nullopt;
+  }
+  Expr* resharding = out->uses().at(0);
+  if (!isResharding(resharding) || !resharding->isA<ReductionOp>()) {
+    return std::nullopt;
+  }
+
+  OverlapCandidate candidate;
+  for (SegmentedEdge* edge : group->consumer_edges) {
+    if (edge->to->exprs().size() == 1 &&
+        edge->to->exprs().at(0) == resharding) {
+      candidate.communication_group = edge->to;
+    }
+  }
+  if (candidate.communication_group == nullptr) {
+    return std::nullopt;
+  }
+
+  // Pick the outermost unsharded axis of the communication output
+  auto* comm_out = resharding->output(0)->as<TensorView>();
+  const auto comm_out_logical =
+      TensorDomain::noReductions(comm_out->getLogicalDomain());
+  if (TensorDomain::noReductions(comm_out->getMaybeAllocationDomain()) !=
+      comm_out_logical) {
+    return std::nullopt;
+  }
+  auto comm_out_id_it = std::find_if(
+      comm_out_logical.begin(), comm_out_logical.end(), [](IterDomain* id) {
+        return !id->isDeviceDim() && !id->isBroadcast();
+      });
+  if (comm_out_id_it == comm_out_logical.end()) {
+    return std::nullopt;
+  }
+  candidate.communication_output_axis =
+      std::distance(comm_out_logical.begin(), comm_out_id_it);
+
+  auto comm_c2p =
+      PairwiseLogicalDomainMap(out, comm_out).mapConsumerToProducer();
+  auto out_id_it = comm_c2p.find(*comm_out_id_it);
+  if (out_id_it == comm_c2p.end() || out_id_it->second->isBroadcast() ||
+      out_id_it->second->isDeviceDim()) {
+    return std::nullopt;
+  }
+
+  // Topologically sorted expressions of the segment
+  std::unordered_set<Expr*> group_exprs(
+      group->exprs().begin(), group->exprs().end());
+  std::vector<Expr*> exprs;
+  for (Expr* expr : staged_fusion->completeFusion()->exprs()) {
+    if (group_exprs.count(expr)) {
+      exprs.push_back(expr);
+    }
+  }
+
+  // Map the chunked axis backward from the segment output
+  std::unordered_map<TensorView*, IterDomain*> chunked_ids = {
+      {out, out_id_it->second}};
+  for (auto it = exprs.rbegin(); it != exprs.rend(); it++) {
+    Expr* expr = *it;
+    if (!expr->isOneOf<
+            UnaryOp,
+            BinaryOp,
+            TernaryOp,
+            BroadcastOp,
+            SqueezeOp,
+            ReductionOp,
+            LoadStoreOp,
+            MatmulOp,
+            LinearOp>()) {
+      return std::nullopt;
+    }
+    for (auto* consumer : ir_utils::filterByType<TensorView>(expr->outputs())) {
+      auto consumer_it = chunked_ids.find(consumer);
+      if (consumer_it == chunked_ids.end()) {
+        continue;
+      }
+      IterDomain* consumer_id = consumer_it->second;
+      const auto& root = consumer->getMaybeRootDomain();
+      if (std::find(root.begin(), root.end(), consumer_id) == root.end()) {
+        return std::nullopt;
+      }
+      for (auto* producer :
+           ir_utils::filterByType<TensorView>(expr->inputs())) {
+        auto c2p = PairwiseLogicalDomainMap(producer, consumer)
+                       .mapConsumerToProducer();
+        auto producer_it = c2p.find(consumer_id);
+        if (producer_it == c2p.end() || producer_it->second->isBroadcast()) {
+          continue;
+        }
+        auto [chunked_it, inserted] =
+            chunked_ids.emplace(producer, producer_it->second);
+        if (!inserted && chunked_it->second != producer_it->second) {
+          return std::nullopt;
+        }
+      }
+    }
+  }
+
+  // Check that chunks are independent of each other
+  for (Expr* expr : exprs) {
+    for (auto* producer : ir_utils::filterByType<TensorView>(expr->inputs())) {
+      auto producer_it = chunked_ids.find(producer);
+      if (producer_it == chunked_ids.end()) {
+        continue;
+      }
+      for (auto* consumer :
+           ir_utils::filterByType<TensorView>(expr->outputs())) {
+        auto consumer_it = chunked_ids.find(consumer);
+        if (consumer_it == chunked_ids.end()) {
+          return std::nullopt;
+        }
+        auto p2c = PairwiseLogicalDomainMap(producer, consumer)
+                       .mapProducerToConsumer();
+        auto mapped_it = p2c.find(producer_it->second);
+        if (mapped_it == p2c.end() ||
+            mapped_it->second != consumer_it->second) {
+          return std::nullopt;
+        }
+      }
+    }
+  }
+
+  for (Val* input : group->inputs()) {
+    auto* tv = dynamic_cast<TensorView*>(input);
+    auto chunked_it = tv == nullptr ? chunked_ids.end() : chunked_ids.find(tv);
+    if (chunked_it == chunked_ids.end()) {
+      candidate.input_axes.push_back(-1);
+      continue;
+    }
+    const int64_t axis = logicalPosition(tv, chunked_it->second);
+    if (chunked_it->second->extent()->isConstScalar() ||
+        !isOuterAxis(tv, axis)) {
+      return std::nullopt;
+    }
+    candidate.input_axes.push_back(axis);
+  }
+  if (std::all_of(
+          candidate.input_axes.begin(),
+          candidate.input_axes.end(),
+          [](int64_t axis) { return axis < 0; })) {
+    return std::nullopt;
+  }
+  candidate.output_axis = logicalPosition(out, out_id_it->second);
+  return candidate;
+}
+
+// Slices tv along `axis` between `start` and `stop`
+TensorView* sliceAxis(TensorView* tv, int64_t axis, Val* start, Val* stop) {
+  std::vector<Slice> ranges(
+      TensorDomain::noReductions(tv->getLogicalDomain()).size());
+  ranges.at(axis).start = start;
+  ranges.at(axis).stop = stop;
+  TensorView* sliced = slice(tv, ranges);
+  if (tv->hasDeviceMesh()) {
+    sliced->setDeviceMesh(tv->getDeviceMesh());
+  }
+  return sliced;
+}
+
+// Returns a TensorView like tv whose extent of `axis` is a new symbolic value
+TensorView* newChunkLike(TensorView* tv, int64_t axis) {
+  auto logical = TensorDomain::noReductions(tv->getLogicalDomain());
+  std::vector<IterDomain*> ids;
+  ids.reserve(logical.size());
+  for (auto i : c10::irange((int64_t)logical.size())) {
+    ids.push_back(
+        i == axis ? IterDomainBuilder(logical.at(i))
+                        .extent(IrBuilder::create<Val>(DataType::Index))
+                        .is_rfactor_domain(false)
+                        .build()
+                  : logical.at(i)->cloneWithoutRFactor());
+  }
+  auto* chunk = IrBuilder::create<TensorView>(
+      IrBuilder::create<TensorDomain>(
+          ids, TensorDomain::getContiguityFilledWith(ids, true)),
+      *tv->getDataType());
+  if (tv->hasDeviceMesh()) {
+    chunk->setDeviceMesh(tv->getDeviceMesh());
+  }
+  return chunk;
+}
+
+ForLoop* createHostLoop(Val* index, Val* stop) {
+  auto* zero = FusionGuard::getCurFusion()->zeroVal();
+  return IrBuilder::create<ForLoop>(
+      IterDomainBuilder(zero, stop).build(),
+      index,
+      zero,
+      stop,
+      FusionGuard::getCurFusion()->oneVal(),
+      /*vectorize=*/false,
+      /*vectorize_shift=*/nullptr,
+      /*unroll_required=*/false,
+      CircularBufferLoopStage::NotApplicable);
+}
+
+// See Note [Overlapping compute and communication]
+void pushBackOverlappedExprs(
+    hir::HostIrContainer* hic,
+    const hir::HostIrExecutorParams& params,
+    const OverlapCandidate& candidate,
+    hir::HostUnit* host_unit,
+    const std::vector<Val*>& inputs,
+    TensorView* output,
+    Communication* communication) {
+  NVF_CHECK(
+      params.number_of_streams > 0 && params.max_chunks > 0 &&
+          params.min_chunk_bytes > 0,
+      "Invalid parameters for overlapping compute and communication");
+  auto* comm_out = communication->out();
+  Val* extent = nullptr;
+  for (auto i : c10::irange(inputs.size())) {
+    if (candidate.input_axes.at(i) >= 0) {
+      extent = TensorDomain::noReductions(
+                   inputs.at(i)->as<TensorView>()->getLogicalDomain())
+                   .at(candidate.input_axes.at(i))
+                   ->extent();
+      break;
+    }
+  }
+  NVF_ERROR(extent != nullptr);
+
+  // Number of bytes each device receives
+  Val* bytes = IrBuilder::create<Val>(
+      (int64_t)dataTypeSize(*comm_out->getDataType()), DataType::Index);
+  for (auto id : TensorDomain::noReductions(comm_out->getLogicalDomain())) {
+    if (!id->isDeviceDim() && !id->isBroadcast()) {
+      bytes = IrBuilder::mulExpr(bytes, id->extent());
+    }
+  }
+  Val* number_of_chunks = IrBuilder::maxExpr(
+      hic->oneVal(),
+      IrBuilder::minExpr(
+          IrBuilder::minExpr(
+              extent,
+              IrBuilder::create<Val>(params.max_chunks, DataType::Index)),
+          IrBuilder::divExpr(
+              bytes,
+              IrBuilder::create<Val>(
+                  params.min_chunk_bytes, DataType::Index))));
+  Val* chunk_size = IrBuilder::ceilDivExpr(extent, number_of_chunks);
+  Val* number_of_streams =
+      IrBuilder::create<Val>(params.number_of_streams, DataType::Index);
+
+  auto* j = IrBuilder::create<Val>(DataType::Index);
+  auto* for_loop =
+      createHostLoop(j, IrBuilder::ceilDivExpr(extent, chunk_size));
+  Val* start = IrBuilder::mulExpr(j, chunk_size);
+  Val* stop = IrBuilder::addExpr(start, chunk_size);
+
+  for_loop->body().push_back(IrBuilder::create<hir::SetCurrentStream>(
+      IrBuilder::create<hir::Stream>(
+          IrBuilder::modExpr(j, number_of_streams))));
+  for_loop->body().push_back(
+      IrBuilder::create<hir::Synchronize>(hic->getDefaultStream()));
+
+  std::vector<Val*> chunk_inputs;
+  chunk_inputs.reserve(inputs.size());
+  for (auto i : c10::irange(inputs.size())) {
+    if (candidate.input_axes.at(i) < 0) {
+      chunk_inputs.push_back(inputs.at(i));
+      continue;
+    }
+    TensorView* chunk_input = sliceAxis(
+        inputs.at(i)->as<TensorView>(),
+        candidate.input_axes.at(i),
+        start,
+        stop);
+    for_loop->body().push_back(chunk_input->definition());
+    chunk_inputs.push_back(chunk_input);
+  }
+  TensorView* chunk_output = newChunkLike(output, candidate.output_axis);
+  for_loop->body().push_back(IrBuilder::create<hir::PostOnStream>(
+      host_unit, chunk_inputs, std::vector<Val*>{chunk_output}));
+
+  TensorView* chunk_comm_out = sliceAxis(
+      comm_out, candidate.communication_output_axis, start, stop);
+  for_loop->body().push_back(chunk_comm_out->definition());
+  auto* chunk_communication = IrBuilder::create<Communication>(
+      communication->type(),
+      chunk_comm_out,
+      chunk_output,
+      communication->team(),
+      communication->root(),
+      communication->reduceOp(),
+      communication->scatteredAxis());
+  for_loop->body().push_back(chunk_communication);
+  for_loop->body().push_back(
+      IrBuilder::create<hir::Wait>(chunk_communication));
+  hic->pushBackTopLevelExprs(for_loop);
+
+  // Make the default stream wait for all the chunks
+  hic->pushBackTopLevelExprs(
+      IrBuilder::create<hir::SetCurrentStream>(hic->getDefaultStream()));
+  auto* i = IrBuilder::create<Val>(DataType::Index);
+  auto* sync_loop = createHostLoop(i, number_of_streams);
+  sync_loop->body().push_back(IrBuilder::create<hir::Synchronize>(
+      IrBuilder::create<hir::Stream>(i)));
+  hic->pushBackTopLevelExprs(sync_loop);
+}
+
+// Note [Communication bucketing]
+// When HostIrExecutorParams::communication_bucket_bytes is positive,
+// consecutive Allreduces with the same team, reduction op and data type are
+// coalesced into one Allreduce of a flat buffer, so that resharding many small
+// tensors, e.g., gradients or LayerNorm parameters, issues one NCCL call
+// instead of many:
+//   flat = PostOnStream(pack, in_0, ..., in_n)   // cat of the flattened inputs
+//   Communication(Allreduce, flat, flat); Wait
+//   out_0, ..., out_n = PostOnStream(unpack, flat, extents of out_0...out_n)
+// The pack and unpack fusions are compiled by nvFuser like any other segment.
+// A bucket is closed when the next communication is not compatible, depends
+// on a communication of the bucket, or would make the bucket larger than
+// communication_bucket_bytes, and when a compute segment is posted. Only
+// tensors whose local size is known at lowering time are bucketed.
+class CommunicationBucketer {
+ public:
+  CommunicationBucketer(hir::HostIrContainer* hic, int64_t bucket_bytes)
+      : hic_(hic), bucket_bytes_(bucket_bytes) {}
+
+  // Posts communication, or defers it to coalesce it with the next ones
+  void pushBack(Communication* communication) {
+    std::optional<int64_t> bytes = bucketableBytes(communication);
+    if (!bytes.has_value()) {
+      flush();
+      post(communication);
+      return;
+    }
+    if (!bucket_.empty() &&
+        (!areCompatible(bucket_.front(), communication) ||
+         dependsOnBucket(communication) ||
+         bucket_size_ + bytes.value() > bucket_bytes_)) {
+      flush();
+    }
+    bucket_.push_back(communication);
+    bucket_size_ += bytes.value();
+  }
+
+  // Posts the deferred communications
+  void flush() {
+    if (bucket_.size() == 1) {
+      post(bucket_.front());
+    } else if (bucket_.size() > 1) {
+      postCoalesced();
+    }
+    bucket_.clear();
+    bucket_size_ = 0;
+  }
+
+ private:
+  void post(Communication* communication) {
+    hic_->pushBackTopLevelExprs(communication);
+    hic_->pushBackTopLevelExprs(IrBuilder::create<hir::Wait>(communication));
+  }
+
+  // Returns the local size of the communicated tensor if the communication
+  // can be bucketed
+  std::optional<int64_t> bucketableBytes(Communication* communication) const {
+    if (bucket_bytes_ <= 0 ||
+        communication->type() != CommunicationType::Allreduce ||
+        communication->in()->getDataType() !=
+            communication->out()->getDataType()) {
+      return std::nullopt;
+    }
+    for (TensorView* tv : {communication->in(), communication->out()}) {
+      if (TensorDomain::noReductions(tv->getLogicalDomain()).empty()) {
+        return std::nullopt;
+      }
+    }
+    int64_t bytes =
+        (int64_t)dataTypeSize(*communication->in()->getDataType());
+    for (auto id :
+         TensorDomain::noReductions(communication->in()->getLogicalDomain())) {
+      if (id->isDeviceDim() || id->isBroadcast()) {
+        continue;
+      }
+      if (!id->extent()->isConstInt()) {
+        return std::nullopt;
+      }
+      bytes *= id->extent()->evaluate().as<int64_t>();
+    }
+    if (bytes > bucket_bytes_) {
+      return std::nullopt;
+    }
+    return bytes;
+  }
+
+  static bool areCompatible(Communication* a, Communication* b) {
+    return a->team() == b->team() && a->reduceOp() == b->reduceOp() &&
+        a->in()->getDataType() == b->in()->getDataType();
+  }
+
+  bool dependsOnBucket(Communication* communication) const {
+    return std::any_of(
+        bucket_.begin(), bucket_.end(), [&](Communication* bucketed) {
+          return bucketed->out() == communication->in() ||
+              bucketed->out() == communication->out();
+        });
+  }
+
+  void postCoalesced() {
+    Communication* first = bucket_.front();
+    const DataType dtype = *first->in()->getDataType();
+
+    // Pack the inputs into a flat buffer
+    auto pack = std::make_unique<Fusion>();
+    {
+      FusionGuard fg(pack.get());
+      std::vector<TensorView*> flattened;
+      for (Communication* communication : bucket_) {
+        auto rank = (int64_t)TensorDomain::noReductions(
+                        communication->in()->getLogicalDomain())
+                        .size();
+        TensorView* in = TensorViewBuilder().ndims(rank).dtype(dtype).build();
+        pack->addInput(in);
+        flattened.push_back(flatten(in));
+      }
+      pack->addOutput(cat(flattened, 0));
+    }
+    TensorView* flat = TensorViewBuilder().ndims(1).dtype(dtype).build();
+    flat->setDeviceMesh(first->in()->getDeviceMesh());
+    std::vector<Val*> inputs;
+    for (Communication* communication : bucket_) {
+      inputs.push_back(communication->in());
+    }
+    hic_->pushBackTopLevelExprs(IrBuilder::create<hir::PostOnStream>(
+        IrBuilder::create<hir::HostUnit>(std::move(pack)),
+        inputs,
+        std::vector<Val*>{flat}));
+
+    // Reduce the flat buffer in place
+    auto* communication = IrBuilder::create<Communication>(
+        CommunicationType::Allreduce,
+        flat,
+        flat,
+        first->team(),
+        /*root=*/-1,
+        first->reduceOp());
+    post(communication);
+
+    // Unpack the flat buffer into the outputs. The extents of the outputs are
+    // passed as scalars, using one for the device dimensions, which have size
+    // one locally.
+    auto unpack = std::make_unique<Fusion>();
+    std::vector<Val*> unpack_inputs = {flat};
+    {
+      FusionGuard fg(unpack.get());
+      TensorView* flat_in = TensorViewBuilder().ndims(1).dtype(dtype).build();
+      unpack->addInput(flat_in);
+      Val* offset = unpack->zeroVal(DataType::Index);
+      for (Communication* communication : bucket_) {
+        std::vector<Val*> extents;
+        Val* numel = unpack->oneVal(DataType::Index);
+        for (auto id : TensorDomain::noReductions(
+                 communication->out()->getLogicalDomain())) {
+          Val* extent = IrBuilder::create<Val>(DataType::Index);
+          unpack->addInput(extent);
+          extents.push_back(extent);
+          numel = IrBuilder::mulExpr(numel, extent);
+          unpack_inputs.push_back(
+              id->isDeviceDim() || id->isBroadcast()
+                  ? hic_->oneVal(DataType::Index)
+                  : id->extent());
+        }
+        Val* end = IrBuilder::addExpr(offset, numel);
+        unpack->addOutput(
+            reshape(slice(flat_in, {Slice{offset, end}}), extents));
+        offset = end;
+      }
+    }
+    std::vector<Val*> outputs;
+    for (Communication* communication : bucket_) {
+      outputs.push_back(communication->out());
+    }
+    hic_->pushBackTopLevelExprs(IrBuilder::create<hir::PostOnStream>(
+        IrBuilder::create<hir::HostUnit>(std::move(unpack)),
+        unpack_inputs,
+        outputs));
+  }
+
+  hir::HostIrContainer* hic_;
+  const int64_t bucket_bytes_;
+  std::vector<Communication*> bucket_;
+  int64_t bucket_size_ = 0;
+};
+
+// Note [Fusing Allgather with its consumer]
+// When HostIrExecutorParams::fuse_allgather_with_consumer is set, an Allgather
+// whose output is only read by one compute segment is not posted as a
+// collective when its team can use a P2pChannel. The host program becomes
+//   shard_0, ..., shard_{n-1} = ShareWithPeers(in)
+//   outs = PostOnStream(segment', other inputs..., shard_0, ..., shard_{n-1})
+//   ReleasePeers
+// where segment' is the consumer segment with its gathered input replaced by
+// cat({shard_0, ..., shard_{n-1}}, 0). Each shard aliases the staging buffer
+// of a member of the team, so the kernels of segment' read the remote shards
+// in place through NVLink: the Allgather launch and the gathered tensor's
+// round trip through HBM disappear, and so does its destination buffer. The
+// ShareWithPeers is emitted right before the consumer so that nothing else
+// uses the channel before the ReleasePeers.
+//
+// This only applies when the gathered axis is the outermost, when the local
+// shard size is known at lowering time and fits in a staging buffer, when the
+// gathered tensor is not a global output, and when all the devices of the team
+// run the consumer segment, which must not read another fused Allgather.
+
+// Returns the compute segment with which the Allgather lowered from `group`
+// can be fused, or nullptr. See Note [Fusing Allgather with its consumer]
+SegmentedGroup* getFusableAllgatherConsumer(
+    SegmentedFusion* segmented_fusion,
+    SegmentedGroup* group,
+    const std::vector<Communication*>& communications,
+    Communicator& comm) {
+  if (communications.size() != 1 ||
+      communications.at(0)->type() != CommunicationType::Allgather) {
+    return nullptr;
+  }
+  Expr* e = group->exprs().at(0);
+  auto* in = e->input(0)->as<TensorView>();
+  auto* out = e->output(0)->as<TensorView>();
+  const std::vector<Val*>& global_outputs = segmented_fusion->outputs();
+  if (std::find(global_outputs.begin(), global_outputs.end(), out) !=
+      global_outputs.end()) {
+    return nullptr;
+  }
+
+  std::vector<IterDomain*> logical =
+      TensorDomain::noReductions(in->getLogicalDomain());
+  if (logical.empty() || !logical.front()->isDeviceDim()) {
+    return nullptr;
+  }
+  int64_t bytes = (int64_t)dataTypeSize(*in->getDataType());
+  for (IterDomain* id : logical) {
+    if (id->isDeviceDim() || id->isBroadcast()) {
+      continue;
+    }
+    if (!id->extent()->isConstInt()) {
+      return nullptr;
+    }
+    bytes *= id->extent()->evaluate().as<int64_t>();
+  }
+  if (bytes > P2pChannel::kMaxMessageBytes) {
+    return nullptr;
+  }
+
+  SegmentedGroup* consumer = nullptr;
+  for (SegmentedGroup* other : segmented_fusion->groups()) {
+    const std::vector<Val*>& inputs = other->inputs();
+    if (std::find(inputs.begin(), inputs.end(), out) == inputs.end()) {
+      continue;
+    }
+    if (consumer != nullptr) {
+      return nullptr;
+    }
+    consumer = other;
+  }
+  if (consumer == nullptr ||
+      std::any_of(
+          consumer->exprs().begin(),
+          consumer->exprs().end(),
+          [](Expr* expr) { return isResharding(expr); }) ||
+      std::find(consumer->outputs().begin(), consumer->outputs().end(), out) !=
+          consumer->outputs().end()) {
+    return nullptr;
+  }
+  const Team& team = communications.at(0)->team();
+  const std::set<DeviceIdxType> involved =
+      involvedDevices(consumer->exprs().at(0));
+  if (std::any_of(team.begin(), team.end(), [&](DeviceIdxType device) {
+        return involved.count(device) == 0;
+      })) {
+    return nullptr;
+  }
+  if (comm.getP2pChannelForTeam(team) == nullptr) {
+    return nullptr;
+  }
+  return consumer;
+}
+
+// Replaces the input `gathered` of `segment` by the concatenation along the
+// outermost axis of `num_shards` new inputs, appended to the inputs of the
+// segment. See Note [Fusing Allgather with its consumer]
+void concatenateShards(
+    Fusion* segment,
+    TensorView* gathered,
+    int64_t num_shards) {
+  FusionGuard fg(segment);
+  std::vector<int64_t> shape;
+  for (IterDomain* id :
+       TensorDomain::noReductions(gathered->getLogicalDomain())) {
+    shape.push_back(shape.empty() || !id->isBroadcast() ? -1 : 1);
+  }
+  std::vector<TensorView*> shards;
+  for ([[maybe_unused]] auto i : c10::irange(num_shards)) {
+    TensorView* shard = TensorViewBuilder()
+                            .shape(shape)
+                            .dtype(*gathered->getDataType())
+                            .contiguity(true)
+                            .build();
+    if (gathered->hasDeviceMesh()) {
+      shard->setDeviceMesh(gathered->getDeviceMesh());
+    }
+    shards.push_back(shard);
+  }
+  TensorView* concatenated = cat(shards, 0);
+  ir_utils::replaceValInAllExprInputsAndFusionOutputs(gathered, concatenated);
+  segment->removeInput(gathered);
+  for (TensorView* shard : shards) {
+    segment->addInput(shard);
+  }
+}
+
+// Note [Pipeline schedules]
+// When HostIrExecutorParams::number_of_microbatches is larger than one, the
+// fusion is run one microbatch at a time: every tensor input is sliced along
+// its outermost axis, each segment is posted once per microbatch and the
+// global outputs are concatenated back. This requires the outermost axis of
+// every tensor to be the batch axis, i.e., to be unsharded and mapped from
+// producer to consumer by every expression. Otherwise, the fusion is lowered
+// as usual.
+//
+// The order in which a device posts its (segment, microbatch) tasks is given
+// by a simulation of the whole pipeline, which takes one time step per compute
+// segment and none per communication. At each step, the ready compute tasks
+// are started by decreasing priority as long as their devices are free:
+//  - GPipe prefers the earliest segment, so that with a forward and a
+//    backward pass, all the forwards run before the backwards;
+//  - OneForwardOneBackward prefers the latest segment and, on each device,
+//    bounds the number of microbatches that have started the device's first
+//    compute segment without finishing its last one to (n - 1) / 2 + 1, where
+//    n is the number of compute segments between them. For a pipeline through
+//    P devices and back, this is P - r on device r, the warmup of 1F1B.
+// Each device posts its tasks sorted by simulated start time. This order is
+// a topological order shared by all the devices, so communications are posted
+// in the same order at both ends and the schedule can't deadlock.
+//
+// Communications are posted asynchronously and waited for right before the
+// first task that reads their output, or at the end of the program. Their
+// destination buffers are preallocated as usual and each microbatch writes
+// its slice, so a global output produced by a communication needs no
+// concatenation.
+
+// Returns whether `fusion` can be run one microbatch at a time. See Note
+// [Pipeline schedules]
+bool isMicrobatchable(Fusion* fusion) {
+  auto is_batched = [](TensorView* tv) {
+    std::vector<IterDomain*> logical =
+        TensorDomain::noReductions(tv->getLogicalDomain());
+    return !logical.empty() && !logical.front()->isDeviceDim() &&
+        !logical.front()->isBroadcast();
+  };
+  bool has_tensor_input = false;
+  for (Val* input : fusion->inputs()) {
+    if (auto* tv = dynamic_cast<TensorView*>(input)) {
+      if (!is_batched(tv)) {
+        return false;
+      }
+      has_tensor_input = true;
+    }
+  }
+  if (!has_tensor_input) {
+    return false;
+  }
+  for (Val* output : fusion->outputs()) {
+    if (!output->isA<TensorView>() || output->isFusionInput()) {
+      return false;
+    }
+  }
+  for (Expr* expr : fusion->exprs()) {
+    auto producers = ir_utils::filterByType<TensorView>(expr->inputs());
+    auto consumers = ir_utils::filterByType<TensorView>(expr->outputs());
+    if (!consumers.empty() && producers.empty()) {
+      return false;
+    }
+    for (TensorView* consumer : consumers) {
+      if (!is_batched(consumer)) {
+        return false;
+      }
+      IterDomain* consumer_batch =
+          TensorDomain::noReductions(consumer->getLogicalDomain()).front();
+      for (TensorView* producer : producers) {
+        IterDomain* producer_batch =
+            TensorDomain::noReductions(producer->getLogicalDomain()).front();
+        auto p2c = PairwiseLogicalDomainMap(producer, consumer)
+                       .mapProducerToConsumer();
+        auto it = p2c.find(producer_batch);
+        if (it == p2c.end() || it->second != consumer_batch) {
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+// Returns the (group index, microbatch) tasks of `groups`, given in a
+// topological order, in the order they must be posted. See Note [Pipeline
+// schedules]
+std::vector<std::pair<int64_t, int64_t>> schedulePipeline(
+    const std::vector<SegmentedGroup*>& groups,
+    int64_t number_of_microbatches,
+    hir::PipelineSchedule schedule) {
+  const auto number_of_groups = (int64_t)groups.size();
+  std::unordered_map<SegmentedGroup*, int64_t> group_index;
+  for (auto g : c10::irange(number_of_groups)) {
+    group_index[groups.at(g)] = g;
+  }
+  std::vector<std::vector<int64_t>> producers(number_of_groups);
+  std::vector<bool> is_compute(number_of_groups);
+  std::vector<std::set<DeviceIdxType>> devices(number_of_groups);
+  // The first and last compute groups of each device
+  std::map<DeviceIdxType, std::pair<int64_t, int64_t>> spans;
+  for (auto g : c10::irange(number_of_groups)) {
+    SegmentedGroup* group = groups.at(g);
+    for (SegmentedEdge* edge : group->producer_edges) {
+      producers.at(g).push_back(group_index.at(edge->from));
+    }
+    is_compute.at(g) = std::none_of(
+        group->exprs().begin(), group->exprs().end(), [](Expr* expr) {
+          return isResharding(expr);
+        });
+    devices.at(g) = involvedDevices(group->exprs().at(0));
+    if (is_compute.at(g)) {
+      for (DeviceIdxType device : devices.at(g)) {
+        spans.try_emplace(device, g, g).first->second.second = g;
+      }
+    }
+  }
+  std::map<DeviceIdxType, int64_t> max_in_flight;
+  for (const auto& [device, span] : spans) {
+    int64_t n = 0;
+    for (auto g = span.first; g <= span.second; g++) {
+      n += (is_compute.at(g) && devices.at(g).count(device)) ? 1 : 0;
+    }
+    max_in_flight[device] = (n - 1) / 2 + 1;
+  }
+
+  constexpr int64_t kNotStarted = -1;
+  // Simulated start and finish times, indexed by group and microbatch
+  std::vector<std::vector<int64_t>> start(
+      number_of_groups,
+      std::vector<int64_t>(number_of_microbatches, kNotStarted));
+  std::vector<std::vector<int64_t>> finish = start;
+  auto ready_time = [&](int64_t g, int64_t m) -> std::optional<int64_t> {
+    int64_t time = 0;
+    for (int64_t p : producers.at(g)) {
+      if (finish.at(p).at(m) == kNotStarted) {
+        return std::nullopt;
+      }
+      time = std::max(time, finish.at(p).at(m));
+    }
+    return time;
+  };
+  auto in_flight = [&](DeviceIdxType device, int64_t t) {
+    auto [first, last] = spans.at(device);
+    int64_t n = 0;
+    for (auto m : c10::irange(number_of_microbatches)) {
+      n += (start.at(first).at(m) != kNotStarted &&
+            (finish.at(last).at(m) == kNotStarted ||
+             finish.at(last).at(m) > t))
+          ? 1
+          : 0;
+    }
+    return n;
+  };
+
+  int64_t remaining = number_of_groups * number_of_microbatches;
+  for (int64_t t = 0; remaining > 0; t++) {
+    // Communications take no time, so they start as soon as their inputs are
+    // ready, which may make other communications ready
+    for (bool changed = true; changed;) {
+      changed = false;
+      for (auto g : c10::irange(number_of_groups)) {
+        for (auto m : c10::irange(number_of_microbatches)) {
+          std::optional<int64_t> time = ready_time(g, m);
+          if (is_compute.at(g) || start.at(g).at(m) != kNotStarted ||
+              !time.has_value() || time.value() > t) {
+            continue;
+          }
+          start.at(g).at(m) = finish.at(g).at(m) = time.value();
+          remaining--;
+          changed = true;
+        }
+      }
+    }
+
+    std::vector<std::pair<int64_t, int64_t>> ready;
+    bool is_running = false;
+    for (auto g : c10::irange(number_of_groups)) {
+      for (auto m : c10::irange(number_of_microbatches)) {
+        is_running |= finish.at(g).at(m) > t;
+        std::optional<int64_t> time = ready_time(g, m);
+        if (is_compute.at(g) && start.at(g).at(m) == kNotStarted &&
+            time.has_value() && time.value() <= t) {
+          ready.emplace_back(g, m);
+        }
+      }
+    }
+    std::stable_sort(ready.begin(), ready.end(), [&](auto a, auto b) {
+      if (a.first != b.first) {
+        return schedule == hir::PipelineSchedule::GPipe ? a.first < b.first
+                                                        : a.first > b.first;
+      }
+      return a.second < b.second;
+    });
+    // The cap on microbatches in flight is relaxed when it would stall the
+    // whole pipeline
+    for (bool use_cap :
+         {schedule == hir::PipelineSchedule::OneForwardOneBackward, false}) {
+      std::set<DeviceIdxType> busy;
+      bool has_started = false;
+      for (auto [g, m] : ready) {
+        if (start.at(g).at(m) != kNotStarted) {
+          continue;
+        }
+        const std::set<DeviceIdxType>& group_devices = devices.at(g);
+        if (std::any_of(
+                group_devices.begin(),
+                group_devices.end(),
+                [&](DeviceIdxType device) {
+                  return busy.count(device) ||
+                      (use_cap && spans.at(device).first == g &&
+                       in_flight(device, t) >= max_in_flight.at(device));
+                })) {
+          continue;
+        }
+        start.at(g).at(m) = t;
+        finish.at(g).at(m) = t + 1;
+        remaining--;
+        has_started = true;
+        busy.insert(group_devices.begin(), group_devices.end());
+      }
+      if (has_started || is_running || ready.empty()) {
+        break;
+      }
+    }
+  }
+
+  std::vector<std::pair<int64_t, int64_t>> tasks;
+  tasks.reserve(number_of_groups * number_of_microbatches);
+  for (auto g : c10::irange(number_of_groups)) {
+    for (auto m : c10::irange(number_of_microbatches)) {
+      tasks.emplace_back(g, m);
+    }
+  }
+  std::sort(tasks.begin(), tasks.end(), [&](auto a, auto b) {
+    return std::make_tuple(start.at(a.first).at(a.second), a.first, a.second) <
+        std::make_tuple(start.at(b.first).at(b.second), b.first, b.second);
+  });
+  return tasks;
+}
+
+// Slices the `m`-th out of `number_of_microbatches` microbatches of tv along
+// its outermost axis
+TensorView* sliceMicrobatch(
+    TensorView* tv,
+    int64_t m,
+    int64_t number_of_microbatches) {
+  Val* extent = TensorDomain::noReductions(tv->getLogicalDomain())
+                    .front()
+                    ->getMaybeExpandedExtent();
+  Val* size = IrBuilder::ceilDivExpr(
+      extent, IrBuilder::create<Val>(number_of_microbatches, DataType::Index));
+  Val* start = IrBuilder::minExpr(
+      IrBuilder::mulExpr(size, IrBuilder::create<Val>(m, DataType::Index)),
+      extent);
+  Val* stop = IrBuilder::minExpr(IrBuilder::addExpr(start, size), extent);
+  return sliceAxis(tv, 0, start, stop);
+}
+
+// See Note [Pipeline schedules]
+void pushBackPipelinedExprs(
+    hir::HostIrContainer* hic,
+    SegmentedFusion* segmented_fusion,
+    const std::vector<SegmentedGroup*>& groups,
+    const hir::HostIrExecutorParams& params,
+    DeviceIdxType my_device_index,
+    IrCloner& ir_cloner) {
+  const int64_t number_of_microbatches = params.number_of_microbatches;
+  std::vector<std::pair<int64_t, int64_t>> tasks = schedulePipeline(
+      groups, number_of_microbatches, params.pipeline_schedule);
+
+  // The microbatches of the vals of the complete fusion on this device
+  std::unordered_map<Val*, std::vector<Val*>> microbatches;
+  auto microbatch = [&](Val* val, int64_t m) -> Val*& {
+    std::vector<Val*>& vals = microbatches[val];
+    if (vals.empty()) {
+      vals.resize(number_of_microbatches, nullptr);
+    }
+    return vals.at(m);
+  };
+  // The communications writing each microbatch that were not waited for yet
+  std::unordered_map<Val*, std::vector<Communication*>> pending;
+  std::vector<Communication*> posted;
+  std::unordered_set<Communication*> waited;
+  auto get_input = [&](Val* val, int64_t m) -> Val* {
+    if (!val->isA<TensorView>()) {
+      return ir_cloner.clone(val);
+    }
+    Val*& input = microbatch(val, m);
+    if (input == nullptr) {
+      auto* tv = ir_cloner.clone(val)->as<TensorView>();
+      if (val->isFusionInput()) {
+        input = sliceMicrobatch(tv, m, number_of_microbatches);
+        hic->pushBackTopLevelExprs(input->definition());
+      } else {
+        // Only read as the input of a communication from another device
+        input = newChunkLike(tv, 0);
+      }
+    }
+    if (auto it = pending.find(input); it != pending.end()) {
+      for (Communication* communication : it->second) {
+        hic->pushBackTopLevelExprs(
+            IrBuilder::create<hir::Wait>(communication));
+        waited.insert(communication);
+      }
+      pending.erase(it);
+    }
+    return input;
+  };
+
+  std::unordered_map<int64_t, hir::HostUnit*> host_units;
+  std::unordered_map<int64_t, std::vector<Communication*>> communications;
+  for (auto [g, m] : tasks) {
+    SegmentedGroup* group = groups.at(g);
+    if (!involvedDevices(group->exprs().at(0)).count(my_device_index)) {
+      continue;
+    }
+    const bool is_resharding = std::any_of(
+        group->exprs().begin(), group->exprs().end(), [](Expr* expr) {
+          return isResharding(expr);
+        });
+    if (!is_resharding) {
+      if (!host_units.count(g)) {
+        host_units[g] = IrBuilder::create<hir::HostUnit>(
+            segmented_fusion->makeFusion(group).second);
+      }
+      std::vector<Val*> inputs;
+      for (Val* input : group->inputs()) {
+        inputs.push_back(get_input(input, m));
+      }
+      std::vector<Val*> outputs;
+      for (Val* output : group->outputs()) {
+        NVF_ERROR(output->isA<TensorView>());
+        Val* output_microbatch =
+            newChunkLike(ir_cloner.clone(output)->as<TensorView>(), 0);
+        microbatch(output, m) = output_microbatch;
+        outputs.push_back(output_microbatch);
+      }
+      hic->pushBackTopLevelExprs(IrBuilder::create<hir::PostOnStream>(
+          host_units.at(g), inputs, outputs));
+      continue;
+    }
+
+    NVF_ERROR(
+        group->exprs().size() == 1,
+        "Communication segments must contain only one Expr");
+    Expr* expr = group->exprs().at(0);
+    if (!communications.count(g)) {
+      communications[g] = lowerCommunication(ir_cloner.clone(expr));
+    }
+    auto* in = get_input(expr->input(0), m)->as<TensorView>();
+    Val*& out = microbatch(expr->output(0), m);
+    auto* out_tv = ir_cloner.clone(expr->output(0))->as<TensorView>();
+    if (out_tv->getDeviceMesh().has(my_device_index)) {
+      // A slice of the preallocated destination buffer
+      out = sliceMicrobatch(out_tv, m, number_of_microbatches);
+      hic->pushBackTopLevelExprs(out->definition());
+    } else {
+      out = newChunkLike(out_tv, 0);
+    }
+    for (Communication* communication : communications.at(g)) {
+      auto* microbatch_communication = IrBuilder::create<Communication>(
+          communication->type(),
+          out->as<TensorView>(),
+          in,
+          communication->team(),
+          communication->root(),
+          communication->reduceOp(),
+          communication->scatteredAxis());
+      hic->pushBackTopLevelExprs(microbatch_communication);
+      pending[out].push_back(microbatch_communication);
+      posted.push_back(microbatch_communication);
+    }
+  }
+
+  for (Communication* communication : posted) {
+    if (!waited.count(communication)) {
+      hic->pushBackTopLevelExprs(IrBuilder::create<hir::Wait>(communication));
+    }
+  }
+
+  // Concatenate the microbatches of the global outputs computed on this device
+  for (Val* output : segmented_fusion->outputs()) {
+    if (isResharding(output->definition()) || !microbatches.count(output)) {
+      continue;
+    }
+    auto* tv = output->as<TensorView>();
+    const auto rank =
+        (int64_t)TensorDomain::noReductions(tv->getLogicalDomain()).size();
+    auto concatenate = std::make_unique<Fusion>();
+    {
+      FusionGuard fg(concatenate.get());
+      std::vector<TensorView*> ins;
+      for ([[maybe_unused]] auto m : c10::irange(number_of_microbatches)) {
+        TensorView* in =
+            TensorViewBuilder().ndims(rank).dtype(*tv->getDataType()).build();
+        concatenate->addInput(in);
+        ins.push_back(in);
+      }
+      concatenate->addOutput(cat(ins, 0));
+    }
+    hic->pushBackTopLevelExprs(IrBuilder::create<hir::PostOnStream>(
+        IrBuilder::create<hir::HostUnit>(std::move(concatenate)),
+        microbatches.at(output),
+        std::vector<Val*>{ir_cloner.clone(output)}));
+  }
+}
+
 } // namespace
 
 MultiDeviceExecutor::MultiDeviceExecutor(
@@ -101,10 +1202,44 @@ MultiDeviceExecutor::MultiDeviceExecutor(
     return cloned_vals;
   };
 
+  CommunicationBucketer bucketer(hic.get(), params.communication_bucket_bytes);
+  auto push_back_communications =
+      [&bucketer](const std::vector<Communication*>& communications) {
+        for (Communication* communication : communications) {
+          bucketer.pushBack(communication);
+        }
+      };
+  auto is_involved = [this](SegmentedGroup* group) {
+    return involvedDevices(group->exprs().at(0)).count(comm_.deviceId()) > 0;
+  };
+
+  // See Note [Pipeline schedules]
+  const bool is_pipelined = params.number_of_microbatches > 1 &&
+      isMicrobatchable(staged_fusion->completeFusion());
+  if (is_pipelined) {
+    pushBackPipelinedExprs(
+        hic.get(),
+        staged_fusion.get(),
+        workspace.group_run_order,
+        params,
+        comm_.deviceId(),
+        ir_cloner);
+  }
+
+  // Communication segments already lowered together with their producer. See
+  // Note [Overlapping compute and communication]
+  std::unordered_set<SegmentedGroup*> lowered_groups;
+  // Allgathers fused with their consumer segment, as the Communication and
+  // the gathered input of the consumer. See Note [Fusing Allgather with its
+  // consumer]
+  std::unordered_map<SegmentedGroup*, std::pair<Communication*, Val*>>
+      fused_allgathers;
+  // The outputs of the fused Allgathers, which are never materialized
+  std::unordered_set<Val*> fused_outputs;
   for (auto group : workspace.group_run_order) {
     std::vector<Expr*> host_exprs;
     NVF_ERROR(!group->exprs().empty(), "invalid segmentation");
-    if (involvedDevices(group->exprs().at(0)).count(comm_.deviceId()) == 0) {
+    if (is_pipelined || !is_involved(group) || lowered_groups.count(group)) {
       continue;
     }
     const bool is_resharding = std::any_of(
@@ -112,30 +1247,109 @@ MultiDeviceExecutor::MultiDeviceExecutor(
           return isResharding(expr);
         });
     if (!is_resharding) {
-      auto host_unit = IrBuilder::create<hir::HostUnit>(
-          staged_fusion->makeFusion(group).second);
-      auto post_on_stream = IrBuilder::create<hir::PostOnStream>(
-          host_unit, clone(group->inputs()), clone(group->outputs()));
-      hic->pushBackTopLevelExprs(post_on_stream);
+      bucketer.flush();
+      std::unique_ptr<Fusion> segment = staged_fusion->makeFusion(group).second;
+      std::vector<Val*> inputs = clone(group->inputs());
+      std::vector<Val*> outputs = clone(group->outputs());
+
+      if (auto it = fused_allgathers.find(group);
+          it != fused_allgathers.end()) {
+        auto [communication, gathered] = it->second;
+        const auto position = std::distance(
+            group->inputs().begin(),
+            std::find(
+                group->inputs().begin(), group->inputs().end(), gathered));
+        concatenateShards(
+            segment.get(),
+            segment->inputs().at(position)->as<TensorView>(),
+            (int64_t)communication->team().size());
+        inputs.erase(inputs.begin() + position);
+        std::vector<TensorView*> shards;
+        for ([[maybe_unused]] auto i :
+             c10::irange(communication->team().size())) {
+          shards.push_back(ops::newValLike(
+                               communication->in(),
+                               *communication->in()->getDataType())
+                               ->as<TensorView>());
+        }
+        inputs.insert(inputs.end(), shards.begin(), shards.end());
+        auto* share = IrBuilder::create<hir::ShareWithPeers>(
+            shards, communication->in(), communication->team());
+        hic->pushBackTopLevelExprs(share);
+        hic->pushBackTopLevelExprs(IrBuilder::create<hir::PostOnStream>(
+            IrBuilder::create<hir::HostUnit>(std::move(segment)),
+            inputs,
+            outputs));
+        hic->pushBackTopLevelExprs(
+            IrBuilder::create<hir::ReleasePeers>(share));
+        continue;
+      }
+
+      auto host_unit = IrBuilder::create<hir::HostUnit>(std::move(segment));
+      std::optional<OverlapCandidate> candidate;
+      if (params.overlap_compute_and_communication) {
+        candidate = getOverlapCandidate(staged_fusion.get(), group);
+      }
+      if (!candidate.has_value() ||
+          !is_involved(candidate->communication_group)) {
+        hic->pushBackTopLevelExprs(IrBuilder::create<hir::PostOnStream>(
+            host_unit, inputs, outputs));
+        continue;
+      }
+
+      std::vector<Communication*> communications = lowerCommunication(
+          ir_cloner.clone(candidate->communication_group->exprs().at(0)));
+      lowered_groups.insert(candidate->communication_group);
+      if (communications.size() == 1 &&
+          (communications.at(0)->type() == CommunicationType::ReduceScatter ||
+           communications.at(0)->type() == CommunicationType::Allreduce)) {
+        pushBackOverlappedExprs(
+            hic.get(),
+            params,
+            candidate.value(),
+            host_unit,
+            inputs,
+            outputs.at(0)->as<TensorView>(),
+            communications.at(0));
+      } else {
+        hic->pushBackTopLevelExprs(IrBuilder::create<hir::PostOnStream>(
+            host_unit, inputs, outputs));
+        push_back_communications(communications);
+      }
     } else {
       NVF_ERROR(
           group->exprs().size() == 1,
           "Communication segments must contain only one Expr");
       std::vector<Communication*> communications =
           lowerCommunication(ir_cloner.clone(group->exprs().at(0)));
-      for (Communication* communication : communications) {
-        auto wait = IrBuilder::create<hir::Wait>(communication);
-        hic->pushBackTopLevelExprs(communication);
-        hic->pushBackTopLevelExprs(wait);
+      if (params.fuse_allgather_with_consumer) {
+        SegmentedGroup* consumer = getFusableAllgatherConsumer(
+            staged_fusion.get(), group, communications, comm_);
+        if (consumer != nullptr && !fused_allgathers.count(consumer)) {
+          fused_allgathers[consumer] = {
+              communications.at(0), group->exprs().at(0)->output(0)};
+          fused_outputs.insert(group->exprs().at(0)->output(0));
+          continue;
+        }
       }
+      push_back_communications(communications);
     }
   }
+  bucketer.flush();
   for (auto input : staged_fusion->inputs()) {
     hic->addInput(ir_cloner.clone(input));
   }
   for (auto output : staged_fusion->outputs()) {
     hic->addOutput(ir_cloner.clone(output));
   }
+  hir::deferWaits(hic.get());
+  if (params.offload_activations) {
+    hir::offloadActivations(
+        hic.get(), params.offload_min_distance, params.prefetch_budget_bytes);
+  }
+  if (params.number_of_compute_streams > 0) {
+    hir::assignStreams(hic.get(), params.number_of_compute_streams);
+  }
 
   // Create the HostIrExecutor representing the host program
   host_ir_executor_ =
@@ -153,7 +1367,8 @@ MultiDeviceExecutor::MultiDeviceExecutor(
       NVF_ERROR(val->isA<TensorView>());
       auto tv = val->as<TensorView>();
       NVF_ERROR(tv->hasDeviceMesh());
-      if (tv->getDeviceMesh().has(comm_.deviceId())) {
+      if (tv->getDeviceMesh().has(comm_.deviceId()) &&
+          !fused_outputs.count(val)) {
         vals_to_allocate_.push_back(val);
       }
     }
@@ -183,16 +1398,66 @@ std::vector<at::Tensor> MultiDeviceExecutor::runWithInput(
         inputs.at(input_idx);
   }
 
-  auto allocations =
-      allocOutputSpace(inputs, allocator_fusion_.get(), comm()->device());
-  NVF_ERROR(vals_to_allocate_.size() == allocations.size());
-  for (auto i : c10::irange(allocations.size())) {
-    val_to_IValue[vals_to_allocate_.at(i)] = allocations.at(i);
+  const std::vector<at::Tensor>& buffers = getCommunicationBuffers(inputs);
+  NVF_ERROR(vals_to_allocate_.size() == buffers.size());
+  for (auto i : c10::irange(buffers.size())) {
+    // Global outputs are returned to the caller and must not be overwritten
+    // by the next run
+    val_to_IValue[vals_to_allocate_.at(i)] = vals_to_allocate_.at(i)
+                                                 ->isFusionOutput()
+        ? at::empty_like(buffers.at(i))
+        : buffers.at(i);
   }
 
   return host_ir_executor_->runWithInput(val_to_IValue);
 }
 
+// Note [Persistent communication buffers]
+// The destination buffers of communications only depend on the shapes, strides
+// and data types of the inputs, and on the values of the scalar inputs. They
+// are therefore allocated once for each such signature and reused by the next
+// runs, so that a steady-state run does not allocate them. Buffers that are
+// global outputs are the exception: they are handed to the caller, so they are
+// allocated again at each run like empty_like of the cached buffer.
+//
+// Reusing a buffer is safe because runs are ordered on the default stream: a
+// run only starts writing a buffer after the work of the previous run that
+// reads it has been posted before it on the same stream, or has been
+// synchronized with it. See Note [Overlapping compute and communication].
+//
+// TODO: register the buffers with the backend, e.g., with ncclMemAlloc and
+// ncclCommRegister, to enable zero-copy collectives.
+const std::vector<at::Tensor>& MultiDeviceExecutor::getCommunicationBuffers(
+    const std::vector<c10::IValue>& inputs) {
+  std::vector<int64_t> signature;
+  for (const c10::IValue& input : inputs) {
+    if (input.isTensor()) {
+      const at::Tensor& tensor = input.toTensor();
+      signature.push_back((int64_t)tensor.scalar_type());
+      signature.push_back(tensor.dim());
+      signature.insert(
+          signature.end(), tensor.sizes().begin(), tensor.sizes().end());
+      signature.insert(
+          signature.end(), tensor.strides().begin(), tensor.strides().end());
+    } else if (input.isInt()) {
+      signature.push_back(input.toInt());
+    } else {
+      signature.push_back(-1);
+    }
+  }
+
+  auto it = communication_buffers_.find(signature);
+  if (it == communication_buffers_.end()) {
+    it = communication_buffers_
+             .emplace(
+                 std::move(signature),
+                 allocOutputSpace(
+                     inputs, allocator_fusion_.get(), comm()->device()))
+             .first;
+  }
+  return it->second;
+}
+
 std::string MultiDeviceExecutor::validate() const {
   if (!comm_.is_available()) {
     return "distributed configuration required";
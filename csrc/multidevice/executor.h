@@ -17,6 +17,8 @@
 #include <multidevice/communicator.h>
 #include <multidevice/multidevice.h>
 
+#include <map>
+
 namespace nvfuser {
 
 /*
@@ -50,8 +52,9 @@ namespace nvfuser {
     prepareRuntimeOrder
 
   II. At runtime, through the method runWithInput:
-  - allocateRecvBuffers allocates on each device the necessary buffers to
-    store the data received from network communications
+  - getCommunicationBuffers allocates on each device the necessary buffers to
+    store the data received from network communications. They are allocated
+    once per input signature and reused by the next runs
   - Each (compute or comm) segment is executed separately, in order:
     1) each compute segment is transformed into a fusion, compiled and executed
        on a single device, see postKernel
@@ -64,7 +67,7 @@ namespace nvfuser {
   *) The different steps should be divided into compilation, allocation,
      runtime etc. This will be done along the way when we will have better
      symbolic representation of the multidevice modules
-  *) Allocation of buffers needs to be reimplemented
+  *) Allocation of buffers needs to be handled as Host IRs
   *) Need to work on auto-scheduling, in particular, to combine inter-/intra-
      device scheduling.
 */
@@ -113,6 +116,14 @@ class MultiDeviceExecutor {
   // Cache the tensors that need to be allocated at runtime, which correspond to
   // the destination buffers of interdevice communications.
   std::vector<Val*> vals_to_allocate_;
+  // Returns the buffers of vals_to_allocate_ for the given inputs, allocating
+  // them at the first run with a given input signature. See Note [Persistent
+  // communication buffers]
+  const std::vector<at::Tensor>& getCommunicationBuffers(
+      const std::vector<c10::IValue>& inputs);
+  // Buffers of vals_to_allocate_, keyed by input signature
+  std::map<std::vector<int64_t>, std::vector<at::Tensor>>
+      communication_buffers_;
 };
 
 } // namespace nvfuser
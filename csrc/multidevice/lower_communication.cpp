@@ -214,6 +214,27 @@ void lowerToReduceScatter(
       scattered_axis));
 }
 
+// Adds one AllToAll communication to the vector 'comms'. The input and the
+// output are sharded on different axes of the same mesh, e.g.
+// [DIDx(i0), i1] -> [i0, DIDx(i1)]: each device splits its input along the
+// axis the output is sharded on, and concatenates what it receives along the
+// axis the input is sharded on.
+void lowerToAllToAll(
+    TensorView* input_tv,
+    TensorView* output_tv,
+    std::vector<Communication*>& comms) {
+  const DeviceMesh& mesh = input_tv->getDeviceMesh();
+  comms.push_back(IrBuilder::create<Communication>(
+      CommunicationType::AllToAll,
+      output_tv,
+      input_tv,
+      mesh.vector(),
+      /*root=*/-1,
+      RedOpType::UNUSED,
+      /*scattered_axis=*/getShardedAxis(output_tv),
+      /*gathered_axis=*/getShardedAxis(input_tv)));
+}
+
 } // namespace
 
 /*
@@ -285,6 +306,10 @@ std::vector<Communication*> lowerCommunication(Expr* c) {
       } else {
         lowerToGather(input_tv, output_tv, comms);
       }
+    } else if (
+        is_input_sharded && is_output_sharded && same_mesh &&
+        getShardedAxis(input_tv) != getShardedAxis(output_tv)) {
+      lowerToAllToAll(input_tv, output_tv, comms);
     } else {
       lowerToBroadcastOrSendRecv(input_tv, output_tv, comms);
     }
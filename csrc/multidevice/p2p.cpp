@@ -0,0 +1,313 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#include <multidevice/p2p.h>
+
+#include <ATen/cuda/CUDAContext.h>
+#include <c10/cuda/CUDAGuard.h>
+#include <c10/util/irange.h>
+#include <cuda.h>
+#include <cuda_runtime.h>
+
+#include <cuda_utils.h>
+#include <driver_api.h>
+#include <exceptions.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace nvfuser {
+
+// Note [P2P communication protocol]
+// The staging buffer of the i-th member of the team starts with two arrays of
+// team_size flags, followed by the data:
+//   ready[j]: written by member j when its staging buffer holds the message
+//             with sequence number ready[j] for member i.
+//   ack[j]:   written by member j when it has copied out the message with
+//             sequence number ack[j] from the staging buffer of member i.
+// Every member of the team increments the channel's sequence number for each
+// communication, in the same order, and
+//   - a sender waits until each peer it previously staged a message for has
+//     acknowledged it, copies its input into its own staging buffer and sets
+//     ready[sender] in the buffer of each receiver;
+//   - a receiver waits until ready[sender] in its own buffer reaches the
+//     current sequence number, pulls the data from the sender's buffer with
+//     a peer copy and sets ack[receiver] in the buffer of the sender.
+// The waits and the writes are stream memory operations
+// (cuStreamWaitValue32/cuStreamWriteValue32) enqueued on the current stream,
+// so all of this is ordered with the surrounding kernels without any host
+// synchronization, also when successive communications are posted on
+// different streams. The writes are issued with the default memory barrier,
+// so the data copied before a flag write is visible to whoever observes it.
+// Flags are compared with >=, which is correct as long as the channel carries
+// less than 2^32 messages.
+//
+// P2pChannel::share follows the same protocol, except that the receivers don't
+// pull the data: they wait for the ready flags of all the peers and their
+// kernels read the staging buffers in place. P2pChannel::release then sets the
+// ack flags, once those kernels have been posted.
+
+namespace {
+
+#if (CUDA_VERSION >= 12000)
+void waitValue(void* flag, uint32_t value) {
+  NVFUSER_CUDA_SAFE_CALL(cuStreamWaitValue32(
+      at::cuda::getCurrentCUDAStream(),
+      reinterpret_cast<CUdeviceptr>(flag),
+      value,
+      CU_STREAM_WAIT_VALUE_GEQ));
+}
+
+void writeValue(void* flag, uint32_t value) {
+  NVFUSER_CUDA_SAFE_CALL(cuStreamWriteValue32(
+      at::cuda::getCurrentCUDAStream(),
+      reinterpret_cast<CUdeviceptr>(flag),
+      value,
+      CU_STREAM_WRITE_VALUE_DEFAULT));
+}
+#else
+void waitValue(void*, uint32_t) {
+  NVF_ERROR(false, "P2P communication requires CUDA 12 or newer");
+}
+
+void writeValue(void*, uint32_t) {
+  NVF_ERROR(false, "P2P communication requires CUDA 12 or newer");
+}
+#endif
+
+int64_t flagsBytes(int64_t team_size) {
+  constexpr int64_t kAlignment = 256;
+  const auto bytes = 2 * team_size * static_cast<int64_t>(sizeof(uint32_t));
+  return (bytes + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+void* readyFlag(void* buffer, int64_t sender) {
+  return static_cast<uint32_t*>(buffer) + sender;
+}
+
+void* ackFlag(void* buffer, int64_t team_size, int64_t receiver) {
+  return static_cast<uint32_t*>(buffer) + team_size + receiver;
+}
+
+} // namespace
+
+P2pChannel::P2pChannel(
+    Team team,
+    DeviceIdxType my_device_index,
+    int64_t my_local_rank,
+    c10d::TCPStore* store,
+    const std::string& prefix)
+    : team_(std::move(team)),
+      my_index_(teamIndex(my_device_index)),
+      my_local_rank_(my_local_rank),
+      buffers_(team_.size(), nullptr),
+      last_staged_for_(team_.size(), 0) {
+  c10::cuda::CUDAGuard device_guard(
+      static_cast<c10::DeviceIndex>(my_local_rank_));
+  const int64_t team_size = static_cast<int64_t>(team_.size());
+  const int64_t bytes = flagsBytes(team_size) + kMaxMessageBytes;
+  NVFUSER_CUDA_RT_SAFE_CALL(cudaMalloc(&buffers_[my_index_], bytes));
+  // The flags must be zero before any peer can open the buffer.
+  NVFUSER_CUDA_RT_SAFE_CALL(
+      cudaMemset(buffers_[my_index_], 0, flagsBytes(team_size)));
+  NVFUSER_CUDA_RT_SAFE_CALL(cudaDeviceSynchronize());
+
+#ifdef NVFUSER_DISTRIBUTED
+  cudaIpcMemHandle_t handle;
+  NVFUSER_CUDA_RT_SAFE_CALL(cudaIpcGetMemHandle(&handle, buffers_[my_index_]));
+  const auto* handle_bytes = reinterpret_cast<const uint8_t*>(&handle);
+  store->set(
+      prefix + std::to_string(my_index_),
+      std::vector<uint8_t>(handle_bytes, handle_bytes + sizeof(handle)));
+
+  for (auto i : c10::irange(team_size)) {
+    if (i == my_index_) {
+      continue;
+    }
+    // Blocks until the peer has published its handle.
+    std::vector<uint8_t> peer_handle_bytes =
+        store->get(prefix + std::to_string(i));
+    NVF_ERROR(peer_handle_bytes.size() == sizeof(cudaIpcMemHandle_t));
+    cudaIpcMemHandle_t peer_handle;
+    std::memcpy(&peer_handle, peer_handle_bytes.data(), sizeof(peer_handle));
+    NVFUSER_CUDA_RT_SAFE_CALL(cudaIpcOpenMemHandle(
+        &buffers_[i], peer_handle, cudaIpcMemLazyEnablePeerAccess));
+  }
+#else
+  NVF_ERROR(false, "P2P communication requires a distributed build");
+#endif
+}
+
+P2pChannel::~P2pChannel() {
+  c10::cuda::CUDAGuard device_guard(
+      static_cast<c10::DeviceIndex>(my_local_rank_));
+  // Errors are not thrown from the destructor.
+  cudaDeviceSynchronize();
+  for (auto i : c10::irange(buffers_.size())) {
+    if (buffers_[i] == nullptr) {
+      continue;
+    }
+    if (static_cast<int64_t>(i) == my_index_) {
+      cudaFree(buffers_[i]);
+    } else {
+      cudaIpcCloseMemHandle(buffers_[i]);
+    }
+  }
+}
+
+int64_t P2pChannel::teamIndex(DeviceIdxType device_index) const {
+  auto it = std::find(team_.begin(), team_.end(), device_index);
+  NVF_ERROR(
+      it != team_.end(), "Device ", device_index, " is not in the P2P team");
+  return std::distance(team_.begin(), it);
+}
+
+void P2pChannel::stage(const at::Tensor& input) {
+  const int64_t bytes = input.numel() * input.element_size();
+  NVF_ERROR(
+      bytes <= kMaxMessageBytes,
+      "P2P messages are limited to ",
+      kMaxMessageBytes,
+      " bytes, but ",
+      bytes,
+      " were given");
+  const int64_t team_size = static_cast<int64_t>(team_.size());
+  for (auto peer : c10::irange(team_size)) {
+    if (last_staged_for_[peer] > 0) {
+      waitValue(
+          ackFlag(buffers_[my_index_], team_size, peer),
+          last_staged_for_[peer]);
+    }
+  }
+  void* data = static_cast<char*>(buffers_[my_index_]) + flagsBytes(team_size);
+  at::from_blob(data, input.sizes(), input.options())
+      .copy_(input, /*non_blocking=*/true);
+}
+
+void P2pChannel::signalReady(int64_t peer) {
+  writeValue(readyFlag(buffers_[peer], my_index_), seq_);
+  last_staged_for_[peer] = seq_;
+}
+
+void P2pChannel::pull(int64_t peer, const at::Tensor& output) {
+  const int64_t team_size = static_cast<int64_t>(team_.size());
+  waitValue(readyFlag(buffers_[my_index_], peer), seq_);
+
+  // The peer's buffer belongs to another device, so it can't be wrapped in
+  // an at::Tensor of this device. Copy it with the runtime instead, through a
+  // contiguous temporary if needed.
+  at::Tensor contiguous_output = output.is_contiguous()
+      ? output
+      : at::empty(output.sizes(), output.options());
+  const void* data =
+      static_cast<const char*>(buffers_[peer]) + flagsBytes(team_size);
+  NVFUSER_CUDA_RT_SAFE_CALL(cudaMemcpyAsync(
+      contiguous_output.data_ptr(),
+      data,
+      contiguous_output.numel() * contiguous_output.element_size(),
+      cudaMemcpyDeviceToDevice,
+      at::cuda::getCurrentCUDAStream()));
+
+  writeValue(ackFlag(buffers_[peer], team_size, my_index_), seq_);
+
+  if (!output.is_same(contiguous_output)) {
+    output.copy_(contiguous_output, /*non_blocking=*/true);
+  }
+}
+
+std::vector<at::Tensor> P2pChannel::share(const at::Tensor& input) {
+  c10::cuda::CUDAGuard device_guard(
+      static_cast<c10::DeviceIndex>(my_local_rank_));
+  NVF_ERROR(!is_shared_, "The previous shared message must be released");
+  seq_++;
+  is_shared_ = true;
+  const int64_t team_size = static_cast<int64_t>(team_.size());
+
+  stage(input);
+  for (auto peer : c10::irange(team_size)) {
+    if (peer != my_index_) {
+      signalReady(peer);
+    }
+  }
+
+  std::vector<at::Tensor> shards;
+  shards.reserve(team_size);
+  for (auto member : c10::irange(team_size)) {
+    if (member != my_index_) {
+      waitValue(readyFlag(buffers_[my_index_], member), seq_);
+    }
+    // The buffers of the peers belong to other devices, so the tensors are
+    // explicitly made on this device, which can access them.
+    void* data = static_cast<char*>(buffers_[member]) + flagsBytes(team_size);
+    shards.push_back(at::for_blob(data, input.sizes())
+                         .options(input.options())
+                         .target_device(input.device())
+                         .make_tensor());
+  }
+  return shards;
+}
+
+void P2pChannel::release() {
+  c10::cuda::CUDAGuard device_guard(
+      static_cast<c10::DeviceIndex>(my_local_rank_));
+  NVF_ERROR(is_shared_, "No shared message to release");
+  is_shared_ = false;
+  const int64_t team_size = static_cast<int64_t>(team_.size());
+  for (auto peer : c10::irange(team_size)) {
+    if (peer != my_index_) {
+      writeValue(ackFlag(buffers_[peer], team_size, my_index_), seq_);
+    }
+  }
+}
+
+void P2pChannel::sendRecv(
+    DeviceIdxType sender,
+    DeviceIdxType receiver,
+    const at::Tensor& input,
+    const at::Tensor& output) {
+  c10::cuda::CUDAGuard device_guard(
+      static_cast<c10::DeviceIndex>(my_local_rank_));
+  NVF_ERROR(!is_shared_, "The previous shared message must be released");
+  seq_++;
+  const int64_t sender_index = teamIndex(sender);
+  const int64_t receiver_index = teamIndex(receiver);
+  if (my_index_ == sender_index) {
+    stage(input);
+    signalReady(receiver_index);
+  } else {
+    NVF_ERROR(my_index_ == receiver_index);
+    pull(sender_index, output);
+  }
+}
+
+void P2pChannel::allgather(const at::Tensor& input, const at::Tensor& output) {
+  c10::cuda::CUDAGuard device_guard(
+      static_cast<c10::DeviceIndex>(my_local_rank_));
+  NVF_ERROR(!is_shared_, "The previous shared message must be released");
+  seq_++;
+  const int64_t team_size = static_cast<int64_t>(team_.size());
+  NVF_ERROR(
+      output.dim() > 0 && output.size(0) == team_size,
+      "The output of a P2P allgather must have one slice per team member");
+
+  stage(input);
+  for (auto peer : c10::irange(team_size)) {
+    if (peer != my_index_) {
+      signalReady(peer);
+    }
+  }
+  for (auto peer : c10::irange(team_size)) {
+    at::Tensor slice = output.slice(0, peer, peer + 1);
+    if (peer == my_index_) {
+      slice.view_as(input).copy_(input, /*non_blocking=*/true);
+    } else {
+      pull(peer, slice);
+    }
+  }
+}
+
+} // namespace nvfuser
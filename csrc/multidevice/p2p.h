@@ -0,0 +1,109 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#pragma once
+
+#include <ATen/core/TensorBody.h>
+
+#include <multidevice/multidevice.h>
+#ifdef NVFUSER_DISTRIBUTED
+#include <torch/csrc/distributed/c10d/TCPStore.hpp>
+#else
+#include <multidevice/c10d_mock.h>
+#endif
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace nvfuser {
+
+// This file implements the class P2pChannel, which performs SendRecv and
+// Allgather among processes of the same node by copying through CUDA IPC
+// memory with the copy engines, bypassing the process group backend. It is
+// meant for small messages, whose latency is dominated by the backend's launch
+// and protocol overhead. It can also share a tensor with the peers, so their
+// kernels read it directly from the sender's memory.
+//
+// At construction, which is collective over the team, each process allocates
+// one staging buffer and exchanges its IPC handle through the store. No
+// handle is exchanged afterwards. Each message is copied by the sender into
+// its own staging buffer and pulled by the receiver(s) from there. The
+// synchronization between processes is done with flags living in the staging
+// buffers and is stream-ordered, so posting a message neither blocks the host
+// nor produces a c10d::Work. See Note [P2P communication protocol] in the cpp
+// file.
+class P2pChannel {
+ public:
+  // The maximum number of bytes a process can contribute to a single
+  // communication, i.e., the size of the staging buffers.
+  static constexpr int64_t kMaxMessageBytes = 256 * 1024;
+
+  // `prefix` is prepended to the store keys, so it must be unique to the team.
+  P2pChannel(
+      Team team,
+      DeviceIdxType my_device_index,
+      int64_t my_local_rank,
+      c10d::TCPStore* store,
+      const std::string& prefix);
+
+  P2pChannel(const P2pChannel&) = delete;
+  P2pChannel& operator=(const P2pChannel&) = delete;
+  ~P2pChannel();
+
+  // Same semantics as a SendRecv Communication with a team of size 2. Only
+  // `input` is used on the sender and only `output` on the receiver.
+  void sendRecv(
+      DeviceIdxType sender,
+      DeviceIdxType receiver,
+      const at::Tensor& input,
+      const at::Tensor& output);
+
+  // Same semantics as an Allgather Communication: `output` is the
+  // concatenation along the outermost dimension of the team's inputs.
+  void allgather(const at::Tensor& input, const at::Tensor& output);
+
+  // Makes `input` readable by the other members of the team without copying
+  // it to their memory. Returns, for each member, a tensor of this device
+  // aliasing the staging buffer of that member; kernels posted on the current
+  // stream see the member's input in it, reading it through NVLink. All
+  // members must share inputs of the same size and call `release` once the
+  // work reading the returned tensors has been posted, before posting
+  // anything else on the channel.
+  std::vector<at::Tensor> share(const at::Tensor& input);
+  void release();
+
+ private:
+  int64_t teamIndex(DeviceIdxType device_index) const;
+
+  // Waits until every peer has consumed the previous content of my staging
+  // buffer, and copies `input` into it.
+  void stage(const at::Tensor& input);
+  // Signals `peer` that my staging buffer holds message `seq_`.
+  void signalReady(int64_t peer);
+  // Copies message `seq_` from the staging buffer of `peer` to `output` and
+  // signals that it can be overwritten.
+  void pull(int64_t peer, const at::Tensor& output);
+
+  const Team team_;
+  const int64_t my_index_;
+  const int64_t my_local_rank_;
+  // The staging buffers, indexed by the position in the team. The entry at
+  // `my_index_` is allocated by this process and the others are opened from
+  // IPC handles.
+  std::vector<void*> buffers_;
+  // Sequence number of the last message posted on the channel. Every member
+  // of the team increments it in the same order, so it identifies a message
+  // across processes.
+  uint32_t seq_ = 0;
+  // For each peer, the sequence number of the last message I staged for it.
+  std::vector<uint32_t> last_staged_for_;
+  // Whether the message `seq_` has been shared and not released yet
+  bool is_shared_ = false;
+};
+
+} // namespace nvfuser
@@ -166,6 +166,13 @@ bool haveDifferentShardings(
       continue;
     }
 
+    // A non-expanded broadcast dimension holds a single element, which each
+    // device has whether or not the dimension is sharded, e.g., when
+    // broadcasting replicated statistics to a sharded tensor.
+    if (p_id->isBroadcast() && !p_id->hasExpandedExtent()) {
+      continue;
+    }
+
     auto c_id = i->second;
     if (p_id->getParallelType() != c_id->getParallelType() &&
         (p_id->isDeviceDim() || c_id->isDeviceDim())) {
@@ -195,6 +202,20 @@ bool isResharding(const Expr* expr) {
   return false;
 }
 
+bool isAllToAll(Expr* expr) {
+  if (!expr->isA<LoadStoreOp>() ||
+      expr->as<LoadStoreOp>()->opType() != LoadStoreOpType::Set) {
+    return false;
+  }
+  auto output = expr->outputs().at(0)->as<TensorView>();
+  auto input = expr->inputs().at(0)->as<TensorView>();
+  if (!(input->getDeviceMesh() == output->getDeviceMesh())) {
+    return false;
+  }
+  auto [shard_additions, shard_deletions] = getShardingChanges(expr);
+  return shard_additions.size() == 1 && shard_deletions.size() == 1;
+}
+
 bool isInnerResharding(Expr* expr) {
   NVF_ERROR(
       ir_utils::isTvOp(expr),
@@ -208,6 +229,10 @@ bool isInnerResharding(Expr* expr) {
       "Resharding operations can have only one input");
   auto output = expr->outputs().at(0)->as<TensorView>();
   auto input = expr->inputs().at(0)->as<TensorView>();
+  if (isAllToAll(expr)) {
+    // postSingleCommunication packs the chunks of an AllToAll if needed.
+    return false;
+  }
   auto [shard_additions, shard_deletions] = getShardingChanges(expr);
   NVF_ERROR(
       shard_additions.size() + shard_deletions.size() <= 1,
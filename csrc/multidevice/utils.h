@@ -83,6 +83,11 @@ bool haveDifferentShardings(
     const TensorView* producer,
     const TensorView* consumer);
 
+// Returns whether a resharding expr moves the sharding from one axis to
+// another of the same mesh, e.g. [DIDx(i0), i1] -> [i0, DIDx(i1)], which is
+// lowered to an AllToAll
+bool isAllToAll(Expr* expr);
+
 // Returns whether a resharding expr reshards an inner axis
 bool isInnerResharding(Expr* expr);
 
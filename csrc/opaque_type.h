@@ -14,6 +14,7 @@
 #include <cstring>
 #include <functional>
 #include <ostream>
+#include <vector>
 
 namespace nvfuser {
 
@@ -30,18 +31,32 @@ struct OpaqueToBytes {
 };
 
 class Opaque {
+  // The type-specific parts of an Opaque. There is one instance per type, so
+  // that an Opaque is just a std::any and a pointer. A PolymorphicValue is as
+  // large as its largest member type, so this keeps scalars small too.
+  struct Ops {
+    bool (*equals)(const Opaque&, const Opaque&);
+    std::vector<std::byte> (*to_bytes)(const Opaque&);
+    size_t size;
+  };
+
+  template <typename T>
+  static const Ops* opsOf() {
+    static constexpr Ops ops{
+        [](const Opaque& a, const Opaque& b) {
+          return OpaqueEquals<T>{}(a, b);
+        },
+        [](const Opaque& a) { return OpaqueToBytes<T>{}(a); },
+        sizeof(T)};
+    return &ops;
+  }
+
   std::any value_;
-  std::function<bool(const Opaque&, const Opaque&)> equals_;
-  std::function<std::vector<std::byte>(const Opaque&)> to_bytes_;
-  size_t size_;
+  const Ops* ops_;
 
  public:
   template <typename T>
-  explicit Opaque(T value)
-      : value_(std::move(value)),
-        equals_(OpaqueEquals<T>{}),
-        to_bytes_(OpaqueToBytes<T>{}),
-        size_(sizeof(T)) {}
+  explicit Opaque(T value) : value_(std::move(value)), ops_(opsOf<T>()) {}
 
   bool operator==(const Opaque& other) const {
     if (this == &other) {
@@ -54,7 +69,7 @@ class Opaque {
       // Opaque(1) != Opaque(1.0).
       return false;
     }
-    return equals_(*this, other);
+    return ops_->equals(*this, other);
   }
 
   bool operator!=(const Opaque& other) const {
@@ -76,11 +91,11 @@ class Opaque {
   }
 
   std::vector<std::byte> bytes() const {
-    return to_bytes_(*this);
+    return ops_->to_bytes(*this);
   }
 
   size_t size() const {
-    return size_;
+    return ops_->size;
   }
 };
 
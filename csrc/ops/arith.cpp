@@ -1525,6 +1525,58 @@ TensorView* min(
   return reductionOp(BinaryOpType::Min, axes, init, v1, keep_dim);
 }
 
+TensorView* scan(
+    BinaryOpType scan_op_type,
+    TensorView* v1,
+    int64_t dim,
+    Val* init) {
+  NVF_CHECK(
+      init->isConstScalar(),
+      "Cannot create a scan operation where the initial value is not a const scalar.");
+  const auto ndims =
+      (int64_t)TensorDomain::noReductions(v1->getLogicalDomain()).size();
+  dim = wrapDim(dim, ndims);
+  NVF_CHECK(
+      !TensorDomain::noReductions(v1->getLogicalDomain())
+           .at(dim)
+           ->isBroadcast(),
+      "Cannot scan a broadcast dimension: ",
+      v1->toString());
+  init = maybeCastOp(v1->dtype(), init);
+  TensorView* out = ops::newOutputTV({v1}, v1->dtype());
+  IrBuilder::create<ScanOp>(scan_op_type, init, out, v1, dim);
+  return out;
+}
+
+TensorView* cumsum(TensorView* v1, int64_t dim) {
+  if (isBooleanType(v1->dtype()) || isIntegralType(v1->dtype())) {
+    v1 = optionalCastStrict(DataType::Int, v1)->as<TensorView>();
+  }
+  return scan(
+      BinaryOpType::Add,
+      v1,
+      dim,
+      FusionGuard::getCurFusion()->zeroVal(v1->dtype()));
+}
+
+SortResult sort(TensorView* v1, int64_t dim, bool descending) {
+  const auto ndims =
+      (int64_t)TensorDomain::noReductions(v1->getLogicalDomain()).size();
+  dim = wrapDim(dim, ndims);
+  NVF_CHECK(
+      !isComplexType(v1->dtype()),
+      "Cannot sort a complex tensor: ",
+      v1->toString());
+  TensorView* values = ops::newOutputTV({v1}, v1->dtype());
+  TensorView* indices = ops::newOutputTV({v1}, DataType::Int);
+  IrBuilder::create<SortOp>(values, indices, v1, dim, descending);
+  return {values, indices};
+}
+
+TensorView* argsort(TensorView* v1, int64_t dim, bool descending) {
+  return sort(v1, dim, descending).indices;
+}
+
 TensorView* broadcast(
     TensorView* inp,
     const std::vector<bool>& is_broadcast_dim) {
@@ -2391,10 +2443,20 @@ TensorView* fusedMultiplySum(
   // TODO:
   //  Add tf32 and other mma data types
   //  Add fallback path for non-mma data types.
+  auto is_fp8 = [](TensorView* tv) {
+    return tv->dtype() == DataType::Float8_e4m3fn ||
+        tv->dtype() == DataType::Float8_e5m2;
+  };
   NVF_CHECK(
       tv_a->getDataType().value() == DataType::Half ||
-      tv_a->getDataType().value() == DataType::BFloat16);
-  NVF_CHECK(tv_a->getDataType().value() == tv_b->getDataType().value());
+      tv_a->getDataType().value() == DataType::BFloat16 ||
+      tv_a->getDataType().value() == DataType::Int8 || is_fp8(tv_a));
+  // The fp8 instructions take any pair of e4m3 and e5m2 operands
+  NVF_CHECK(
+      tv_a->getDataType().value() == tv_b->getDataType().value() ||
+      (is_fp8(tv_a) && is_fp8(tv_b)));
+  // int8 operands are accumulated exactly in int32
+  const bool is_int8 = tv_a->getDataType().value() == DataType::Int8;
 
   NVF_CHECK(!axes.empty(), "No reduction axis specified");
 
@@ -2407,10 +2469,12 @@ TensorView* fusedMultiplySum(
   std::vector<unsigned int> uint_axes = ops::canonicalizeAxes(
       axes, (int64_t)tv_a->domain()->noReductions().size());
 
-  TensorView* out = newForMma(tv_a, tv_b, uint_axes);
+  TensorView* out = newForMma(
+      tv_a, tv_b, uint_axes, is_int8 ? DataType::Int32 : DataType::Float);
 
   if (init == nullptr) {
-    init = IrBuilder::create<Val>(0.0, out->dtype());
+    init = is_int8 ? IrBuilder::create<Val>(0L, out->dtype())
+                   : IrBuilder::create<Val>(0.0, out->dtype());
   }
 
   // TODO:
@@ -625,6 +625,35 @@ NVF_API TensorView* min(
     bool keep_dim = false,
     DataType dtype = DataType::Null);
 
+// SCAN OPERATIONS
+// Perform an inclusive scan of v1 along dim with scan_op_type. The scan
+// starts from init, which must be the identity of scan_op_type.
+NVF_API TensorView* scan(
+    BinaryOpType scan_op_type,
+    TensorView* v1,
+    int64_t dim,
+    Val* init);
+
+// Cumulative sum of v1 along dim. Like at::cumsum, integral and boolean
+// inputs are summed as DataType::Int.
+NVF_API TensorView* cumsum(TensorView* v1, int64_t dim);
+
+// SORT OPERATIONS
+struct SortResult {
+  TensorView* values = nullptr;
+  TensorView* indices = nullptr;
+};
+
+// Stable sort of v1 along dim, like at::sort with stable=true. indices are
+// the positions of values along dim in v1, as DataType::Int.
+NVF_API SortResult sort(TensorView* v1, int64_t dim, bool descending = false);
+
+// The indices of sort(v1, dim, descending)
+NVF_API TensorView* argsort(
+    TensorView* v1,
+    int64_t dim,
+    bool descending = false);
+
 // COMPOUND OPERATIONS
 // add_alpha
 NVF_API Val* add_alpha(Val* v1, Val* v2, Val* s);
@@ -716,6 +745,9 @@ TensorView* viewAsScalar(TensorView* inp);
 //! \param axes axes to sum over
 //! \param init sum initial value
 //!
+//! The output is Float, except for Int8 operands, which are summed exactly
+//! into an Int32 output.
+//!
 //! Note & TODO:
 //!   currently only support lowering to a mma op
 //!   through this interface and only support fp16 inputs.
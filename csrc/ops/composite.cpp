@@ -11,6 +11,9 @@
 #include <ops/utils.h>
 #include <transform_view.h>
 
+#include <limits>
+#include <numeric>
+
 namespace nvfuser {
 
 ForwardDropoutResult dropout(TensorView* x, Val* prob) {
@@ -336,6 +339,514 @@ TensorView* view_as_real(TensorView* x) {
   auto tv_vector = bitCastOp(vec_type, x);
   return viewAsScalar(tv_vector);
 }
+
+// Note [Packed int4 tensors]
+// PyTorch has no 4-bit dtype, so quantized weights are stored as 32-bit or
+// 64-bit integers, each holding 8 or 16 int4 values with the first value in
+// the least significant bits. unpack_int4 expands each word into its values
+// along a new innermost dimension and then flattens it into the last
+// dimension, so unpacking is fused into the consumer, e.g., a scale and a
+// matmul, and the packed tensor is the only thing read from global memory.
+// The vectorization analysis sees the packed tensor as an ordinary integer
+// tensor, so its vectorization factor counts packed words, not values.
+TensorView* unpack_int4(TensorView* x, bool is_signed) {
+  NVF_CHECK(x != nullptr, "Input is invalid.");
+  auto dtype = x->getDataType().value();
+  NVF_CHECK(
+      dtype == DataType::Int32 || dtype == DataType::Int,
+      "Operand of unpack_int4 must be Int32 or Int, but got ",
+      dtype);
+  const auto ndims =
+      (int64_t)TensorDomain::noReductions(x->getLogicalDomain()).size();
+  NVF_CHECK(ndims > 0, "Operand of unpack_int4 must not be a scalar tensor");
+
+  const int64_t bits = (int64_t)dataTypeSize(dtype) * 8;
+  auto container = x->container();
+
+  std::vector<bool> x_bcast(ndims + 1, false);
+  x_bcast.back() = true;
+  auto x_b = broadcast(x, x_bcast);
+
+  // Bit offset of each value in a word: [0, 4, ..., bits - 4]
+  auto offsets = iota(
+      IrBuilder::createInContainer<Val>(container, bits / 4, DataType::Index),
+      IrBuilder::createInContainer<Val>(container, 0L, dtype),
+      IrBuilder::createInContainer<Val>(container, 4L, dtype),
+      dtype);
+  std::vector<bool> offsets_bcast(ndims + 1, true);
+  offsets_bcast.back() = false;
+  offsets = broadcast(offsets, offsets_bcast);
+
+  TensorView* unpacked = nullptr;
+  if (is_signed) {
+    // Move each value to the most significant bits, then sign-extend it
+    // with an arithmetic right shift.
+    auto top = IrBuilder::createInContainer<Val>(container, bits - 4, dtype);
+    unpacked =
+        bitwise_right_shift(bitwise_left_shift(x_b, sub(top, offsets)), top);
+  } else {
+    unpacked = bitwise_and(
+        logical_right_shift(x_b, offsets),
+        IrBuilder::createInContainer<Val>(container, 15L, dtype));
+  }
+  return flatten(unpacked, ndims - 1, ndims);
+}
+
+// Note [Arg reductions]
+// argmax, argmin and topk reduce (value, position) pairs, where the larger,
+// or smaller, value wins and ties go to the smallest position. Rather than
+// teaching the reduction schedulers and the block and grid reductions a new
+// tuple reduction, each pair is packed into one DataType::Int key whose max,
+// or min, is the winning pair:
+//   key = (ordered value << 32) | position bits
+// The ordered value is an Int32 whose signed order is the order of the
+// values. Integral values of at most 32 bits are their own ordered value.
+// Floating point values are widened to Float, and the magnitude bits of the
+// negative ones are flipped, so that their bit patterns order like the
+// floats. A NaN is mapped to the largest, or smallest, ordered value, so that
+// it wins like in ATen, and -0.0 to 0.0, so that both tie. The position bits
+// are the position for min and its complement for max, so that the smallest
+// position wins either way.
+//
+// The key is reduced by the regular max or min, so an arg reduction is
+// scheduled and fused, e.g. with the softmax producing the logits, like any
+// other reduction. The winning value and position are unpacked from the
+// reduced key. topk takes k such reductions, each one masking the positions
+// the previous ones picked, which the normalization schedulers keep on chip as
+// they do for the reductions of a layer norm.
+//
+// Double and Int values do not fit in a key with their position. argmax and
+// argmin reduce them in two passes instead: the max or min, then the
+// smallest position holding it or a NaN.
+namespace {
+
+// Whether the values of dtype fit in the key of an arg reduction
+bool isPackableArgReductionType(DataType dtype) {
+  return (isFloatingPointType(dtype) || isIntegralType(dtype) ||
+          dtype == DataType::Bool) &&
+      dataTypeSize(dtype) <= 4;
+}
+
+// The position of each element of x along dim
+TensorView* positionsAlong(TensorView* x, int64_t dim) {
+  const auto logical = TensorDomain::noReductions(x->getLogicalDomain());
+  auto positions = iota(
+      logical.at(dim)->extent(),
+      IrBuilder::create<Val>(0L, DataType::Int),
+      IrBuilder::create<Val>(1L, DataType::Int),
+      DataType::Int);
+  std::vector<bool> is_broadcast(logical.size(), true);
+  is_broadcast.at(dim) = false;
+  return broadcast(positions, is_broadcast);
+}
+
+// The low half of a key, holding the position
+constexpr int64_t kPositionBits = 0xFFFFFFFFL;
+// The bits of a Float but its sign
+constexpr int64_t kMagnitudeBits = 0x7FFFFFFFL;
+
+// See Note [Arg reductions]
+TensorView* packArgKey(TensorView* x, TensorView* positions, bool largest) {
+  const DataType dtype = x->getDataType().value();
+  TensorView* ordered = nullptr;
+  if (isFloatingPointType(dtype)) {
+    auto widened = maybeCastOp(DataType::Float, x);
+    widened = where(
+        eq(widened, IrBuilder::create<Val>(0.0)),
+        IrBuilder::create<Val>(0.0),
+        widened);
+    ordered = castOp(DataType::Int, bitCastOp(DataType::Int32, widened));
+    ordered = where(
+        lt(ordered, IrBuilder::create<Val>(0L, DataType::Int)),
+        bitwise_xor(
+            ordered, IrBuilder::create<Val>(kMagnitudeBits, DataType::Int)),
+        ordered);
+    ordered = where(
+        isnan(x),
+        IrBuilder::create<Val>(
+            largest ? (int64_t)std::numeric_limits<int32_t>::max()
+                    : (int64_t)std::numeric_limits<int32_t>::min(),
+            DataType::Int),
+        ordered);
+  } else {
+    ordered = castOp(DataType::Int, x);
+  }
+  TensorView* position_bits = positions;
+  if (largest) {
+    position_bits =
+        sub(IrBuilder::create<Val>(kPositionBits, DataType::Int), positions);
+  }
+  return bitwise_or(
+      bitwise_left_shift(ordered, IrBuilder::create<Val>(32L, DataType::Int)),
+      position_bits);
+}
+
+TensorView* unpackArgPosition(TensorView* key, bool largest) {
+  auto position_bits =
+      bitwise_and(key, IrBuilder::create<Val>(kPositionBits, DataType::Int));
+  if (largest) {
+    return sub(
+        IrBuilder::create<Val>(kPositionBits, DataType::Int), position_bits);
+  }
+  return position_bits;
+}
+
+TensorView* unpackArgValue(TensorView* key, DataType dtype) {
+  auto ordered =
+      bitwise_right_shift(key, IrBuilder::create<Val>(32L, DataType::Int));
+  if (!isFloatingPointType(dtype)) {
+    return castOp(dtype, ordered);
+  }
+  auto bits = where(
+      lt(ordered, IrBuilder::create<Val>(0L, DataType::Int)),
+      bitwise_xor(
+          ordered, IrBuilder::create<Val>(kMagnitudeBits, DataType::Int)),
+      ordered);
+  auto value = bitCastOp(DataType::Float, castOp(DataType::Int32, bits));
+  return maybeCastOp(dtype, value);
+}
+
+TensorView* argReduction(
+    TensorView* x,
+    int64_t dim,
+    bool keep_dim,
+    bool largest) {
+  NVF_CHECK(x != nullptr, "Input is invalid.");
+  const DataType dtype = x->getDataType().value();
+  NVF_CHECK(
+      isFloatingPointType(dtype) || isIntegralType(dtype) ||
+          dtype == DataType::Bool,
+      "Unsupported dtype of an arg reduction: ",
+      dtype);
+  const auto ndims =
+      (int64_t)TensorDomain::noReductions(x->getLogicalDomain()).size();
+  NVF_CHECK(ndims > 0, "Operand of an arg reduction must not be a scalar");
+  dim = wrapDim(dim, ndims);
+  auto positions = positionsAlong(x, dim);
+
+  if (isPackableArgReductionType(dtype)) {
+    auto key = packArgKey(x, positions, largest);
+    key = largest ? max(key, {dim}, keep_dim) : min(key, {dim}, keep_dim);
+    return unpackArgPosition(key, largest);
+  }
+
+  // See Note [Arg reductions]
+  auto extremum = largest ? max(x, {dim}, /*keep_dim=*/true)
+                          : min(x, {dim}, /*keep_dim=*/true);
+  auto hit = eq(x, extremum);
+  if (isFloatingPointType(dtype)) {
+    hit = logical_or(hit, isnan(x));
+  }
+  auto candidates = where(
+      hit,
+      positions,
+      IrBuilder::create<Val>(
+          std::numeric_limits<int64_t>::max(), DataType::Int));
+  return min(candidates, {dim}, keep_dim);
+}
+
+} // namespace
+
+TensorView* argmax(TensorView* x, int64_t dim, bool keep_dim) {
+  return argReduction(x, dim, keep_dim, /*largest=*/true);
+}
+
+TensorView* argmin(TensorView* x, int64_t dim, bool keep_dim) {
+  return argReduction(x, dim, keep_dim, /*largest=*/false);
+}
+
+TopKResult topk(TensorView* x, int64_t k, int64_t dim, bool largest) {
+  NVF_CHECK(x != nullptr, "Input is invalid.");
+  const DataType dtype = x->getDataType().value();
+  NVF_CHECK(
+      isPackableArgReductionType(dtype),
+      "topk only supports dtypes of at most 32 bits, but got ",
+      dtype);
+  NVF_CHECK(k > 0, "Invalid k of topk: ", k);
+  const auto ndims =
+      (int64_t)TensorDomain::noReductions(x->getLogicalDomain()).size();
+  NVF_CHECK(ndims > 0, "Operand of topk must not be a scalar tensor");
+  dim = wrapDim(dim, ndims);
+
+  // See Note [Arg reductions]
+  auto positions = positionsAlong(x, dim);
+  auto key = packArgKey(x, positions, largest);
+  // Never wins against a key that is not masked
+  auto masked = IrBuilder::create<Val>(
+      largest ? std::numeric_limits<int64_t>::min()
+              : std::numeric_limits<int64_t>::max(),
+      DataType::Int);
+  std::vector<TensorView*> values;
+  std::vector<TensorView*> indices;
+  for (int64_t i : c10::irange(k)) {
+    auto best = largest ? max(key, {dim}, /*keep_dim=*/true)
+                        : min(key, {dim}, /*keep_dim=*/true);
+    values.push_back(unpackArgValue(best, dtype));
+    indices.push_back(unpackArgPosition(best, largest));
+    if (i + 1 < k) {
+      key = where(eq(positions, indices.back()), masked, key);
+    }
+  }
+  return {cat(values, dim), cat(indices, dim)};
+}
+
+// Note [Histograms]
+// A histogram is built as the sum over the elements of their one-hot
+// comparison with the bins, i.e. a [*x, num_bins] comparison reduced over the
+// dimensions of x. The reduction and normalization schedulers then fuse it
+// with the ops producing x, and the integer sum counts without the
+// contention of scattering to global memory: each block counts into shared
+// memory with atomics, see Note [Shared memory atomic block reductions], and
+// adds its counts to the zero-filled output with one global atomic per bin,
+// see Note [Atomic grid reductions], both in scheduler/reduction_utils.cpp.
+// Both are exact for integers in any order. Each element is compared with
+// every bin, so this is meant for histograms of up to a few hundred bins,
+// e.g. the load of the experts of a mixture of experts layer.
+TensorView* histogram(TensorView* x, int64_t num_bins) {
+  NVF_CHECK(x != nullptr, "Input is invalid.");
+  NVF_CHECK(
+      isIntegralType(x->getDataType().value()),
+      "histogram only supports integral dtypes, but got ",
+      x->getDataType().value());
+  NVF_CHECK(num_bins > 0, "Invalid number of bins of histogram: ", num_bins);
+  const auto ndims =
+      (int64_t)TensorDomain::noReductions(x->getLogicalDomain()).size();
+  NVF_CHECK(ndims > 0, "Operand of histogram must not be a scalar tensor");
+
+  std::vector<bool> is_bin_dim(ndims + 1, false);
+  is_bin_dim.back() = true;
+  std::vector<bool> is_element_dim(ndims + 1, true);
+  is_element_dim.back() = false;
+  auto bins = iota(
+      IrBuilder::create<Val>(num_bins, DataType::Index),
+      IrBuilder::create<Val>(0L, DataType::Int),
+      IrBuilder::create<Val>(1L, DataType::Int),
+      DataType::Int);
+  auto hits = castOp(
+      DataType::Int,
+      eq(broadcast(x, is_bin_dim), broadcast(bins, is_element_dim)));
+
+  std::vector<int64_t> element_dims(ndims);
+  std::iota(element_dims.begin(), element_dims.end(), 0);
+  return sum(hits, element_dims);
+}
+
+// Note [Ragged tensors]
+// A batch of variable-length sequences, e.g. of tokens, is usually padded to
+// its longest sequence, and every kernel then spends the padded fraction of
+// its work on padding. A RaggedTensor stores the sequences back to back in
+// values instead, with their start offsets. The ops normalizing or
+// transforming each element independently of its sequence, e.g. layer_norm,
+// rms_norm and softmax over the hidden dimension and all pointwise ops, run
+// on values as is: the schedulers see a dense [total, *] tensor and map
+// their blocks to tokens with no padding computed or stored.
+//
+// The ops needing the sequence structure use ragged_positions, which
+// compares each element with the offsets, i.e. a [total, batch + 1]
+// comparison reduced by a sum for the sequence and by a max for its start.
+// Both are fused into the consumer, and the batch is small next to the
+// hidden size. ragged_to_padded and padded_to_ragged gather between the two
+// layouts for the ops that need a padded tensor, e.g. attention, so that
+// the padding only exists where it is needed.
+namespace {
+
+void checkRagged(const RaggedTensor& ragged) {
+  NVF_CHECK(
+      ragged.values != nullptr && ragged.offsets != nullptr,
+      "Invalid ragged tensor.");
+  NVF_CHECK(
+      !TensorDomain::noReductions(ragged.values->getLogicalDomain()).empty(),
+      "Values of a ragged tensor must not be a scalar tensor");
+  NVF_CHECK(
+      TensorDomain::noReductions(ragged.offsets->getLogicalDomain()).size() ==
+              1 &&
+          ragged.offsets->getDataType() == DataType::Int,
+      "Offsets of a ragged tensor must be a 1D Int tensor, but got ",
+      ragged.offsets->toString());
+}
+
+RaggedPositions raggedPositions(TensorView* offsets, Val* total) {
+  auto elements = iota(
+      total,
+      IrBuilder::create<Val>(0L, DataType::Int),
+      IrBuilder::create<Val>(1L, DataType::Int),
+      DataType::Int);
+  auto starts = broadcast(offsets, {true, false});
+  auto started = le(starts, broadcast(elements, {false, true}));
+  // offsets[0] = 0 starts before every element
+  auto sequence = sub(
+      sum(castOp(DataType::Int, started), {1}),
+      IrBuilder::create<Val>(1L, DataType::Int));
+  auto start = max(
+      where(started, starts, IrBuilder::create<Val>(0L, DataType::Int)), {1});
+  return {sequence, sub(elements, start)};
+}
+
+} // namespace
+
+RaggedPositions ragged_positions(const RaggedTensor& ragged) {
+  checkRagged(ragged);
+  return raggedPositions(
+      ragged.offsets,
+      TensorDomain::noReductions(ragged.values->getLogicalDomain())
+          .at(0)
+          ->extent());
+}
+
+TensorView* ragged_to_padded(
+    const RaggedTensor& ragged,
+    Val* max_length,
+    Val* pad_value) {
+  checkRagged(ragged);
+  NVF_CHECK(max_length != nullptr, "Invalid max_length.");
+  auto fusion = FusionGuard::getCurFusion();
+  const auto rank = (int64_t)TensorDomain::noReductions(
+                        ragged.values->getLogicalDomain())
+                        .size();
+  Val* num_offsets = ragged.offsets->getLogicalDomain().at(0)->extent();
+  Val* batch = SimplifyingIrBuilder::subExpr(num_offsets, fusion->oneVal());
+  auto starts = slice(ragged.offsets, {{fusion->zeroVal(), batch}});
+  auto ends = slice(ragged.offsets, {{fusion->oneVal(), num_offsets}});
+  auto lengths = sub(ends, starts);
+
+  // [batch, max_length]
+  auto steps = broadcast(
+      iota(
+          max_length,
+          IrBuilder::create<Val>(0L, DataType::Int),
+          IrBuilder::create<Val>(1L, DataType::Int),
+          DataType::Int),
+      {true, false});
+  auto valid = lt(steps, broadcast(lengths, {false, true}));
+  auto index = where(
+      valid,
+      add(broadcast(starts, {false, true}), steps),
+      IrBuilder::create<Val>(0L, DataType::Int));
+
+  // [1, total, *] gathered by [batch, max_length, 1...]
+  std::vector<bool> index_broadcast(rank + 1, true);
+  index_broadcast.at(0) = false;
+  index_broadcast.at(1) = false;
+  std::vector<bool> values_broadcast(rank + 1, false);
+  values_broadcast.at(0) = true;
+  auto padded = take_along_axis(
+      broadcast(ragged.values, values_broadcast),
+      broadcast(index, index_broadcast),
+      1);
+  if (pad_value == nullptr) {
+    pad_value = fusion->zeroVal(ragged.values->getDataType().value());
+  }
+  return where(broadcast(valid, index_broadcast), padded, pad_value);
+}
+
+RaggedTensor padded_to_ragged(
+    TensorView* padded,
+    TensorView* offsets,
+    Val* total) {
+  NVF_CHECK(padded != nullptr && total != nullptr, "Input is invalid.");
+  const auto padded_domain =
+      TensorDomain::noReductions(padded->getLogicalDomain());
+  NVF_CHECK(
+      padded_domain.size() >= 2,
+      "A padded tensor must have a batch and a sequence dimension");
+  checkRagged({padded, offsets});
+
+  auto [sequence, position] = raggedPositions(offsets, total);
+  // [total] rows of the [batch * max_length, *] flattened tensor
+  auto index = add(
+      mul(sequence, castOp(DataType::Int, padded_domain.at(1)->extent())),
+      position);
+  std::vector<bool> index_broadcast(padded_domain.size() - 1, true);
+  index_broadcast.at(0) = false;
+  auto values = take_along_axis(
+      flatten(padded, 0, 1), broadcast(index, index_broadcast), 0);
+  return {values, offsets};
+}
+
+// Note [Stream compaction]
+// The number of elements selected by a mask is only known on the device, and
+// reading it on the host to allocate an output of that size would stall the
+// stream. The compaction ops instead return an output of the size of their
+// input, an upper bound, with the selected elements first, and the number
+// selected as a 0-dim tensor on the device, which the following ops, e.g.
+// lt(iota(numel), count), use to mask the valid elements. Nothing is
+// synchronized, so the segments of the fusion run back to back on the stream.
+//
+// Each selected element is moved to the number of selected elements before
+// it, an exclusive cumsum of the mask, and each unselected one after all the
+// selected ones in its order among them. Each element of the output is then
+// written exactly once, a stable partition of the input by the mask, so the
+// scatter has no conflicting writes and its output is deterministic.
+namespace {
+
+CompactResult compact(TensorView* x, TensorView* mask) {
+  NVF_CHECK(
+      x->nDims() == mask->nDims(),
+      "The mask of a compaction must have the shape of its input, but got ",
+      x->toString(),
+      " and ",
+      mask->toString());
+  auto flat_x = x->nDims() > 1 ? flatten(x) : x;
+  auto flat_mask =
+      castOp(DataType::Bool, mask->nDims() > 1 ? flatten(mask) : mask);
+  auto fusion = FusionGuard::getCurFusion();
+  Val* one = IrBuilder::create<Val>(1L, DataType::Int);
+
+  // Inclusive counts of the selected elements
+  auto selected = cumsum(flat_mask, 0);
+  auto count = sum(castOp(DataType::Int, flat_mask), {0});
+  auto element = iota(
+      flat_x->getLogicalDomain().at(0)->extent(),
+      fusion->zeroVal(DataType::Int),
+      one,
+      DataType::Int);
+  // The unselected element i follows the selected ones and the i - selected
+  // unselected ones before it
+  auto index = where(
+      flat_mask,
+      sub(selected, one),
+      add(broadcast(count, {true}), sub(element, selected)));
+  return {scatter(flat_x, 0, index, flat_x), count};
+}
+
+} // namespace
+
+CompactResult masked_select(TensorView* x, TensorView* mask) {
+  NVF_CHECK(x != nullptr && mask != nullptr, "Input is invalid.");
+  NVF_CHECK(x->nDims() > 0, "Input of masked_select must not be a scalar.");
+  return compact(x, mask);
+}
+
+CompactResult nonzero(TensorView* mask) {
+  NVF_CHECK(mask != nullptr, "Input is invalid.");
+  const std::vector<IterDomain*> logical =
+      TensorDomain::noReductions(mask->getLogicalDomain());
+  NVF_CHECK(!logical.empty(), "Input of nonzero must not be a scalar.");
+  auto fusion = FusionGuard::getCurFusion();
+  Val* numel = fusion->oneVal(DataType::Int);
+  for (auto id : logical) {
+    numel = SimplifyingIrBuilder::mulExpr(
+        numel, castOp(DataType::Int, id->extent()));
+  }
+  auto flat_index = iota(
+      numel,
+      fusion->zeroVal(DataType::Int),
+      fusion->oneVal(DataType::Int),
+      DataType::Int);
+  auto [flat_indices, count] =
+      compact(flat_index, mask->nDims() > 1 ? flatten(mask) : mask);
+
+  // Unravel the flat indices, innermost dimension first
+  std::vector<TensorView*> indices(logical.size());
+  TensorView* remaining = flat_indices;
+  for (auto i = (int64_t)logical.size() - 1; i >= 0; --i) {
+    Val* extent = castOp(DataType::Int, logical.at(i)->extent());
+    indices.at(i) = broadcast(mod(remaining, extent), {false, true});
+    remaining = div(remaining, extent);
+  }
+  return {cat(indices, 1), count};
+}
+
 namespace {
 
 //! Create new output for matmul
@@ -71,6 +71,89 @@ TensorView* leaky_relu(TensorView* x, Val* negative_slope);
 
 NVF_API TensorView* view_as_real(TensorView* x);
 
+//! Unpack int4 values stored 8 per Int32 or 16 per Int element, least
+//! significant bits first. The last dimension of the output is 8 or 16
+//! times the last dimension of x and has the same dtype as x. Values are
+//! sign-extended when is_signed is true and zero-extended otherwise. See
+//! Note [Packed int4 tensors].
+NVF_API TensorView* unpack_int4(TensorView* x, bool is_signed = true);
+
+//! Indices, as DataType::Int, of the first maximum or minimum of x along dim.
+//! Like at::argmax and at::argmin, a NaN counts as both the maximum and the
+//! minimum. Fused as a single max or min reduction for the dtypes of at most
+//! 32 bits. See Note [Arg reductions].
+NVF_API TensorView* argmax(TensorView* x, int64_t dim, bool keep_dim = false);
+NVF_API TensorView* argmin(TensorView* x, int64_t dim, bool keep_dim = false);
+
+struct TopKResult {
+  TensorView* values = nullptr;
+  TensorView* indices = nullptr;
+};
+
+//! The k largest, or smallest, elements of x along dim, sorted, and their
+//! indices, like at::topk with sorted=true. dim of the outputs has extent k,
+//! which must not exceed the extent of dim in x. The dtype of x must be of
+//! at most 32 bits. Each element costs one max or min reduction, so this is
+//! meant for a small k. See Note [Arg reductions].
+NVF_API TopKResult
+topk(TensorView* x, int64_t k, int64_t dim, bool largest = true);
+
+//! Counts, as DataType::Int, of each value in [0, num_bins) among the elements
+//! of x, which must be integral. Other values are not counted. Like
+//! at::bincount with minlength=num_bins for values below num_bins. See
+//! Note [Histograms].
+NVF_API TensorView* histogram(TensorView* x, int64_t num_bins);
+
+//! A batch of variable-length sequences stored without padding. values,
+//! [total, *], holds the elements of all sequences back to back, and offsets,
+//! [batch + 1] of DataType::Int, where each sequence starts in values
+//! followed by total. See Note [Ragged tensors].
+struct RaggedTensor {
+  TensorView* values = nullptr;
+  TensorView* offsets = nullptr;
+};
+
+struct RaggedPositions {
+  TensorView* sequence = nullptr;
+  TensorView* position = nullptr;
+};
+
+//! The sequence of each element of ragged.values along its first dimension,
+//! and its position in that sequence, both [total] of DataType::Int
+NVF_API RaggedPositions ragged_positions(const RaggedTensor& ragged);
+
+//! The [batch, max_length, *] tensor holding each sequence of ragged, padded
+//! with pad_value, zero by default. Sequences longer than max_length are
+//! truncated.
+NVF_API TensorView* ragged_to_padded(
+    const RaggedTensor& ragged,
+    Val* max_length,
+    Val* pad_value = nullptr);
+
+//! The sequences of padded, [batch, max_length, *], whose lengths are given
+//! by offsets as in RaggedTensor, with total elements in all
+NVF_API RaggedTensor
+padded_to_ragged(TensorView* padded, TensorView* offsets, Val* total);
+
+//! The output of a stream compaction. values holds the selected elements
+//! first, in order, at an upper bound of the number selected, and count, a
+//! 0-dim DataType::Int tensor, is the number selected. See Note [Stream
+//! compaction].
+struct CompactResult {
+  TensorView* values = nullptr;
+  TensorView* count = nullptr;
+};
+
+//! The elements of x where mask, of the same shape, is true, flattened in
+//! their order, like at::masked_select. values has as many elements as x;
+//! the ones past count are the unselected elements of x.
+NVF_API CompactResult masked_select(TensorView* x, TensorView* mask);
+
+//! The indices of the true elements of mask, like at::nonzero. values is a
+//! [numel, ndims] DataType::Int tensor whose rows past count are the indices
+//! of the false elements.
+NVF_API CompactResult nonzero(TensorView* mask);
+
 // Matmul function which takes in tensors with the shapes
 // A[*, M, K] / A[K] and B[*, K, N] / B[K], but the tensors may have different
 // layouts via strides. This has the same functionality as torch.matmul
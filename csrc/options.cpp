@@ -104,6 +104,7 @@ std::unordered_map<DebugDumpOption, std::vector<std::string>> Options<
       {"ca_map", DebugDumpOption::ComputeAtMap},
       {"cubin", DebugDumpOption::Cubin},
       {"cuda_full", DebugDumpOption::CudaFull},
+      {"cuda_graph", DebugDumpOption::CudaGraph},
       {"cuda_kernel", DebugDumpOption::CudaKernel},
       {"cuda_to_file", DebugDumpOption::CudaToFile},
       {"debug_info", DebugDumpOption::DebugInfo},
@@ -127,6 +128,7 @@ std::unordered_map<DebugDumpOption, std::vector<std::string>> Options<
       {"kernel_ir", DebugDumpOption::KernelIr},
       {"launch_param", DebugDumpOption::LaunchParam},
       {"loop_rotation", DebugDumpOption::LoopRotation},
+      {"lower_pass_times", DebugDumpOption::LowerPassTimes},
       {"lower_verbose", DebugDumpOption::LowerVerbose},
       {"occupancy", DebugDumpOption::Occupancy},
       {"parallel_dimensions", DebugDumpOption::ParallelDimensions},
@@ -152,13 +154,75 @@ template <>
 std::unordered_map<EnableOption, std::vector<std::string>> Options<
     EnableOption>::getOptionsFromEnv() {
   const std::unordered_map<std::string, EnableOption> available_options = {
+      {"async_compile", EnableOption::AsyncCompile},
+      {"atomic_grid_reduction", EnableOption::AtomicGridReduction},
+      {"autotune", EnableOption::Autotune},
+      {"batch_compile", EnableOption::BatchCompile},
+      {"binary_trace", EnableOption::BinaryTrace},
+      {"compile_server", EnableOption::CompileServer},
+      {"compressed_collectives", EnableOption::CompressedCollectives},
+      {"concurrent_segments", EnableOption::ConcurrentSegments},
+      {"contiguity_specialization", EnableOption::ContiguitySpecialization},
+      {"cuda_graph", EnableOption::CudaGraph},
+      {"decompose_sdpa", EnableOption::DecomposeSdpa},
+      {"elide_syncs", EnableOption::ElideSyncs},
+      {"expr_eval_epilogue", EnableOption::ExprEvalEpilogue},
+      {"expr_simplify_budget", EnableOption::ExprSimplifyBudget},
+      {"fast_divmod", EnableOption::FastDivMod},
+      {"fast_math", EnableOption::FastMath},
+      {"fast_rng", EnableOption::FastRng},
       {"fuse_matmul", EnableOption::FuseMatmul},
+      {"group_reductions", EnableOption::GroupReductions},
+      {"horizontal_fusion", EnableOption::HorizontalFusion},
+      {"host_ir_runtime", EnableOption::HostIrRuntime},
+      {"host_memory_trace", EnableOption::HostMemoryTrace},
       {"id_model", EnableOption::IdModel},
+      {"intermediate_arena", EnableOption::IntermediateArena},
+      {"intern_scalars", EnableOption::InternScalars},
       {"kernel_db", EnableOption::KernelDb},
       {"kernel_profile", EnableOption::KernelProfile},
+      {"l2_persistence", EnableOption::L2Persistence},
+      {"lazy_serde", EnableOption::LazySerde},
+      {"lean_preamble", EnableOption::LeanPreamble},
+      {"lower_precision_persistent_buffers",
+       EnableOption::LowerPrecisionPersistentBuffers},
+      {"matmul_epilogue_reduction", EnableOption::MatmulEpilogueReduction},
+      {"megakernel", EnableOption::Megakernel},
+      {"memory_aware_segment_order", EnableOption::MemoryAwareSegmentOrder},
       {"memory_promotion", EnableOption::MemoryPromotion},
+      {"multi_group_transpose", EnableOption::MultiGroupTranspose},
+      {"nvrtc_pch", EnableOption::NvrtcPch},
+      {"outline_runtime", EnableOption::OutlineRuntime},
+      {"packed_arithmetic", EnableOption::PackedArithmetic},
+      {"packed_casts", EnableOption::PackedCasts},
+      {"persistent_matmul", EnableOption::PersistentMatmul},
+      {"pipeline_loads", EnableOption::PipelineLoads},
+      {"pointwise_3d", EnableOption::Pointwise3D},
+      {"portable_serde", EnableOption::PortableSerde},
+      {"predicate_peeling", EnableOption::PredicatePeeling},
+      {"programmatic_launch", EnableOption::ProgrammaticLaunch},
+      {"register_pressure", EnableOption::RegisterPressure},
+      {"request_batching", EnableOption::RequestBatching},
       {"reuse_zeroed_memory", EnableOption::ReuseZeroedMemory},
+      {"runtime_cache_budget", EnableOption::RuntimeCacheBudget},
+      {"runtime_metrics", EnableOption::RuntimeMetrics},
+      {"segment_recomputation", EnableOption::SegmentRecomputation},
+      {"segmentation_cache", EnableOption::SegmentationCache},
+      {"segmentation_cost_model", EnableOption::SegmentationCostModel},
+      {"shape_buckets", EnableOption::ShapeBuckets},
+      {"shape_specialization", EnableOption::ShapeSpecialization},
+      {"share_across_devices", EnableOption::ShareAcrossDevices},
+      {"smem_carveout", EnableOption::SmemCarveout},
+      {"smem_planner", EnableOption::SmemPlanner},
+      {"smem_swizzle", EnableOption::SmemSwizzle},
+      {"split_reduction", EnableOption::SplitReduction},
       {"static_fusion_count", EnableOption::StaticFusionCount},
+      {"sub_warp_reduce", EnableOption::SubWarpReduce},
+      {"tiered_compile", EnableOption::TieredCompile},
+      {"tile_unswitch", EnableOption::TileUnswitch},
+      {"tma_persistent_load", EnableOption::TmaPersistentLoad},
+      {"tma_store", EnableOption::TmaStore},
+      {"topology_aware_device_ids", EnableOption::TopologyAwareDeviceIds},
       {"warn_register_spill", EnableOption::WarnRegisterSpill},
       {"io_to_lower_precision", EnableOption::IoToLowerPrecision},
   };
@@ -175,16 +239,23 @@ std::unordered_map<DisableOption, std::vector<std::string>> Options<
       {"expr_simplify", DisableOption::ExprSimplify},
       {"fallback", DisableOption::Fallback},
       {"fma", DisableOption::Fma},
+      {"fusion_deduplication", DisableOption::FusionDeduplication},
       {"grouped_grid_welford_outer_opt",
        DisableOption::GroupedGridWelfordOuterOpt},
+      {"hierarchical_communication", DisableOption::HierarchicalCommunication},
       {"index_hoist", DisableOption::IndexHoist},
       {"magic_zero", DisableOption::MagicZero},
       {"matmul_expr_eval", DisableOption::MatmulExprEval},
+      {"matmul_heuristic_plugin", DisableOption::MatmulHeuristicPlugin},
       {"nvtx", DisableOption::Nvtx},
+      {"p2p_communication", DisableOption::P2pCommunication},
       {"parallel_compile", DisableOption::ParallelCompile},
       {"parallel_serde", DisableOption::ParallelSerde},
+      {"pointwise_grid_stride", DisableOption::PointwiseGridStride},
       {"predicate_elimination", DisableOption::PredicateElimination},
       {"python_inline_definitions", DisableOption::PythonInlineDefinitions},
+      {"simplify_definition", DisableOption::SimplifyDefinition},
+      {"kernel_deduplication", DisableOption::KernelDeduplication},
       {"kernel_reuse", DisableOption::KernelReuse},
       {"var_name_remapping", DisableOption::VarNameRemapping},
       {"welford_vectorization", DisableOption::WelfordVectorization},
@@ -209,6 +280,7 @@ std::unordered_map<ProfilerOption, std::vector<std::string>> Options<
       {"enable.nocupti", ProfilerOption::EnableNocupti},
       {"print", ProfilerOption::Print},
       {"print.nocupti", ProfilerOption::PrintNocupti},
+      {"print.roofline", ProfilerOption::PrintRoofline},
       {"print.verbose", ProfilerOption::PrintVerbose},
   };
 
@@ -217,40 +289,48 @@ std::unordered_map<ProfilerOption, std::vector<std::string>> Options<
   return options;
 }
 
-namespace {
+// [ Note -- Lazy initialization ]
+//
+// Loading libnvfuser, e.g., on the cold start of an inference server, should
+// do as little work as possible before the first fusion is defined. The
+// one-time state of the library is therefore built on first use rather than
+// by static initializers:
+//  - The active options below are function-local statics, so the NVFUSER_*
+//    environment variables are parsed when an option is first queried;
+//  - The runtime preamble is concatenated once, when the first kernel is
+//    compiled, see executor_utils::kernelPreamble;
+//  - Driver API symbols are resolved on their first call, see driver_api.cpp;
+//  - The compilation thread pool is created by the first asynchronous
+//    compilation, see getThreadPool.
+// The time from loading the library to the first kernel launch is measured by
+// benchmarks/python/test_startup.py.
 
 // These may need to be thread local, or their modifications may need to
 // be protected by mutual exclusion for thread safety. At this
 // moment, the correctness of modifying option values has to be
 // guaranteed by the modifying code.
 
-DebugDumpOptions active_dump_options;
-
-EnableOptions active_enable_options;
-
-DisableOptions active_disable_options;
-
-ProfilerOptions active_profiler_options;
-
-} // namespace
-
 template <>
 Options<DebugDumpOption>& OptionsGuard<DebugDumpOption>::getCurOptions() {
+  static DebugDumpOptions active_dump_options;
   return active_dump_options;
 }
 
 template <>
 Options<EnableOption>& OptionsGuard<EnableOption>::getCurOptions() {
+  static EnableOptions active_enable_options;
   return active_enable_options;
 }
 
 template <>
 Options<DisableOption>& OptionsGuard<DisableOption>::getCurOptions() {
+  static DisableOptions active_disable_options;
   return active_disable_options;
 }
 
 template <>
 Options<ProfilerOption>& OptionsGuard<ProfilerOption>::getCurOptions() {
+  static ProfilerOptions active_profiler_options;
   return active_profiler_options;
 }
 
@@ -310,5 +390,9 @@ bool isProfilerPrintingVerbose() {
   return ProfilerOptionsGuard::getCurOptions().has(
       ProfilerOption::PrintVerbose);
 }
+bool isProfilerPrintingRoofline() {
+  return ProfilerOptionsGuard::getCurOptions().has(
+      ProfilerOption::PrintRoofline);
+}
 
 } // namespace nvfuser
@@ -46,6 +46,7 @@ enum class DebugDumpOption {
   ComputeAtMap, //!< Dump the computeAt map
   CudaKernel, //!< Dump the generated CUDA C++ kernel code
   CudaFull, //!< Dump the complete CUDA C++ code
+  CudaGraph, //!< Dump the log of CUDA graph capture and replay
   CudaToFile, //!< Dump CUDA Strings to File
   DebugInfo, //!< Embed line info and debug info to compiled kernel, and dump
              //!< the full CUDA C++ code
@@ -73,8 +74,10 @@ enum class DebugDumpOption {
   Sass, // Dump disassembled SASS
   Ptx, //! Dump compiled PTX
   BankConflictInfo, //! Dump bank confliction info
-  SyncMap, //! RAW dependency info
+  SyncMap, //! RAW dependency info and elided block syncs
   LowerVerbose, //! Print all passes' transform in GpuLower::lower
+  LowerPassTimes, //! Print the time and the change in IR node count of each
+                  //! step of GpuLower
   ExprSimplification, //! Print all passes' transform in simplifyExpr
   ExprSort, //! Print merging decisions on expression sorting
   ExprSortVerbose, //! Print verbose debug info on expression sorting
@@ -91,13 +94,201 @@ enum class DebugDumpOption {
 //! These can be set through the `NVFUSER_ENABLE` environment variable
 //!
 enum class EnableOption {
+  AsyncCompile, //! Compile the kernels of new FusionKernelRuntimes in the
+                //! background and evaluate the fusion with ATen meanwhile
+  AtomicGridReduction, //! Let the reduction scheduler sum fp32 and fp64
+                       //! outer grid reductions with global atomics. Not
+                       //! deterministic. See Note [Atomic grid reductions]
+  Autotune, //! Search the parameters of pointwise and reduction schedulers of
+            //! new segments and keep the fastest in a tuning db, optionally
+            //! at the given path, e.g. autotune(/cache/tuning_db.txt)
+  BatchCompile, //! Compile the segment kernels of a FusionKernelRuntime that
+                //! share compile options as a single NVRTC program
+  BinaryTrace, //! Buffer NVFUSER_TRACE events per thread and write them in a
+               //! binary format, converted by tools/trace_to_json.py
+  CompileServer, //! Compile the kernels missing KernelDb on a compile server
+                 //! shared by the processes of the node and hosted by the
+                 //! first of them, optionally with the socket path and the
+                 //! number of parallel compilations, e.g.
+                 //! compile_server(/tmp/nvfuser.sock,8). See [ Note --
+                 //! Compile server ] in kernel_db/compile_server.cpp
+  CompressedCollectives, //! Send the data of ReduceScatters and Allgathers
+                         //! in bf16, or in fp8 with per-row scales with
+                         //! compressed_collectives(fp8). See Note
+                         //! [Compressed collectives]
+  ConcurrentSegments, //! Launch segments of a FusionKernelRuntime that do
+                      //! not depend on each other on different streams
+  ContiguitySpecialization, //! Compile new FusionKernelRuntimes with the
+                            //! non-contiguous dimensions of inputs that are
+                            //! contiguous at runtime marked contiguous
+  CudaGraph, //! Capture the kernels of a FusionKernelRuntime into a CUDA
+             //! graph per input id and replay it on cache hits. Outputs are
+             //! static buffers overwritten by the next replay.
+  DecomposeSdpa, //! Rewrite SdpaFwdOps without dropout as matmuls and a
+                 //! softmax fusible with the surrounding ops. See Note
+                 //! [Decomposing SDPA] in preseg_passes/decompose_sdpa.cpp
+  ElideSyncs, //! Remove block syncs that follow another one with no memory
+              //! accesses in between, and use __syncwarp for single-warp
+              //! blocks
+  ExprEvalEpilogue, //! Let ExprEval segments of a matmul or linear include
+                    //! its bias add and ReLU, run by a single cuBLASLt call
+                    //! with a fused epilogue. See Note [Matmul epilogues]
+                    //! in scheduler/expr_eval_sched.cpp
+  ExprSimplifyBudget, //! Bound the number of passes of a single call to
+                      //! simplifyExpr, e.g. expr_simplify_budget(20)
+  FastDivMod, //! Compute 32-bit div and mod by loop-invariant divisors with
+              //! precomputed multipliers
+  FastMath, //! Use approximate intrinsics for float exp, exp2, log, log2,
+            //! tanh, erf, sigmoid and silu. See Note [Fast math] in
+            //! codegen.cpp
+  FastRng, //! Number the random numbers of RNGOps per thread so that each
+           //! Philox call serves consecutive elements of a thread, and use
+           //! 7 Philox rounds. See Note [Fast RNG] in rng.cpp
   FuseMatmul, //! Enable automatic fusion of matmul and linear ops
+  GroupReductions, //! Let the reduction and outer persistent schedulers
+                   //! group sibling grid reductions with the same reduction
+                   //! axes so that they share their synchronizations. See
+                   //! Note [Grouping sibling reductions] in
+                   //! scheduler/reduction_utils.cpp
+  HorizontalFusion, //! Let the segmenter merge independent pointwise
+                    //! segments into one kernel
+  HostIrRuntime, //! Run the segments of a FusionKernelRuntime as a host IR
+                 //! program, see Note -- Host IR runtime in kernel_cache.cpp
+  HostMemoryTrace, //! Record the host heap and peak RSS at the end of every
+                   //! FUSER_PERF_SCOPE, see inst::Trace
   IdModel, //! Enable IdModel
-  KernelDb, //! Enable Kernel Database
-  KernelProfile, //! Enable intra-kernel performance profiling
+  IntermediateArena, //! Carve the intermediate buffers of all segments of a
+                     //! FusionKernelRuntime out of one reused slab
+  InternScalars, //! Share the nodes of structurally identical scalar
+                 //! expressions built during lowering. See Note [Scalar
+                 //! interning] in ir/container.cpp
+  KernelDb, //! Enable Kernel Database. Optionally takes the maximum size of
+            //! the db in MiB and its directory, e.g. kernel_db(4096,/cache)
+  KernelProfile, //! Enable intra-kernel performance profiling. With
+                 //! kernel_profile(regions), time every top-level loop
+                 //! nest, sync and grid reduction
+  L2Persistence, //! Keep the outputs of a segment read by the next segment
+                 //! in the persisting L2 lines of Ampere and newer GPUs.
+                 //! See [ Note -- L2 persistence of segment handoffs ] in
+                 //! kernel_cache.cpp
+  LazySerde, //! Map the serialized FusionCache and deserialize each
+             //! FusionExecutorCache when it is first used
+  LeanPreamble, //! Compile kernels whose threads do not communicate with a
+                //! runtime preamble leaving out reductions, welfords,
+                //! broadcasts, scans, sorts and grid syncs. See [ Note --
+                //! Lean preamble ] in executor_utils.cpp
+  LowerPrecisionPersistentBuffers, //! Store fp32 persistent buffers of
+                                   //! normalizations with only fp16 or bf16
+                                   //! outputs in that type
+  MatmulEpilogueReduction, //! Let the matmul scheduler fuse reductions of N
+                           //! in the epilogue, e.g. row sums of the output
+  Megakernel, //! Run the segments of a FusionKernelRuntime as the phases of
+              //! one persistent cooperative kernel. See [ Note --
+              //! Megakernel ] in megakernel.cpp
+  MemoryAwareSegmentOrder, //! Order independent segments of a
+                           //! FusionKernelRuntime to lower its peak memory
   MemoryPromotion, //! Enable promotion of memory types for non-pointwise ops
+  MultiGroupTranspose, //! Let the transpose scheduler stage every group of
+                       //! tensors with its own inner-most dimension through
+                       //! shared memory tiles, rather than only two. See
+                       //! Note [Multi-group transpose] in
+                       //! scheduler/transpose.cpp
+  NvrtcPch, //! Compile the runtime preamble of kernels into an NVRTC
+            //! precompiled header shared by all kernels. Requires CUDA 12.1
+  OutlineRuntime, //! Call the large block and grid communication functions
+                  //! of the runtime rather than inlining them into kernels
+                  //! with many call sites, 8 by default, e.g.,
+                  //! outline_runtime(4). See [ Note -- Outlined runtime
+                  //! functions ] in executor_utils.cpp
+  PackedArithmetic, //! Compute unrolled fp16 and bf16 pointwise chains with
+                    //! packed half2 and bfloat162 arithmetic. Each op rounds
+                    //! to the low precision type
+  PackedCasts, //! Convert pairs of elements of fp8, fp16 and bf16 casts in
+               //! serial loops with packed cvt instructions
+  PersistentMatmul, //! Let the matmul heuristic pick persistent CTAs and a
+                    //! split-K factor filling whole waves of the SMs
+  PipelineLoads, //! Let the reduction heuristic circular buffer the global
+                 //! loads of long rows, 2 stages by default, e.g.
+                 //! pipeline_loads(3)
+  Pointwise3D, //! Let the pointwise heuristic split the domain at two break
+               //! points, and keep inputs broadcast along the middle
+               //! dimensions in registers. See Note [3D pointwise schedule]
+               //! in scheduler/pointwise.cpp
+  PortableSerde, //! Keep the PTX of kernels compiled to SASS, and load
+                 //! serialized caches on newer GPU architectures by JIT
+                 //! compiling their PTX
+  PredicatePeeling, //! Run the full iterations of serial loops around
+                    //! unswitched scopes in a loop without predicates
+  ProgrammaticLaunch, //! Launch kernels on Hopper with programmatic
+                      //! dependent launch, so that they start while the
+                      //! previous kernel of the stream finishes. See Note
+                      //! [Programmatic dependent launch] in executor.cpp
   StaticFusionCount, //! Enable using single static count in kernel name
+  SubWarpReduce, //! Lower block reductions and welfords over a power-of-two
+                 //! TIDx domain of at most a warp to warp shuffles
+  TieredCompile, //! Compile new kernels with low ptxas optimization first and
+                 //! recompile them fully in the background once launched a
+                 //! number of times, 16 by default, e.g. tiered_compile(4)
+  TileUnswitch, //! Unswitch the outermost serial loop nests of tiles as a
+                //! whole, so that one check selects an unpredicated path
+                //! for all of their iterations
+  TmaPersistentLoad, //! Load the shared memory persistent buffers of inner
+                     //! persistent normalizations from fusion inputs with
+                     //! TMA on Hopper
+  TmaStore, //! Let the pointwise scheduler stage the outputs of vectorized 1D
+            //! schedules in shared memory and store them with TMA on Hopper
+  TopologyAwareDeviceIds, //! Number the devices of each node along a chain
+                          //! of their fastest peer links, so that adjacent
+                          //! devices of a DeviceMesh are linked by NVLink
+  RegisterPressure, //! Raise the register limit of kernels whose estimated
+                    //! register pressure exceeds it to avoid spills
+  RequestBatching, //! Coalesce concurrent runs of a FusionExecutorCache
+                   //! arriving within a window, 100 microseconds by
+                   //! default, into one run over their concatenated rows,
+                   //! e.g. request_batching(500)
   ReuseZeroedMemory, //! Re-use zeroed memory used for grid synchronization
+  RuntimeMetrics, //! Collect lightweight counters per FusionExecutorCache.
+                  //! Kernels of one run every 100 by default are timed, e.g.
+                  //! runtime_metrics(1000), or never with runtime_metrics(0)
+  RuntimeCacheBudget, //! Evict the least recently used FusionKernelRuntimes
+                      //! of all FusionExecutorCaches past a budget of host
+                      //! and module bytes, 1024 MiB by default, e.g.
+                      //! runtime_cache_budget(256)
+  SegmentRecomputation, //! Let consumer segments recompute tensors crossing
+                        //! segment edges that are cheap pointwise functions
+                        //! of fusion inputs
+  SegmentationCache, //! Rebuild the segmentation of new FusionKernelRuntimes
+                     //! from an earlier one whose segments are still
+                     //! accepted by the same schedulers
+  SegmentationCostModel, //! Let the segmenter skip merges predicted to be
+                         //! slower than the separate segments, using kernel
+                         //! times measured by the profiler with
+                         //! segmentation_cost_model(profile)
+  ShapeBuckets, //! Compute heuristics for input extents rounded up to a
+                //! bucket boundary, 64 by default, e.g. shape_buckets(128)
+  ShapeSpecialization, //! Compile a variant of a kernel with the input extents
+                       //! and strides folded to constants once it has been
+                       //! launched a number of times with the same shapes,
+                       //! 16 by default, e.g. shape_specialization(64)
+  ShareAcrossDevices, //! Build a FusionKernelRuntime missing on a device from
+                      //! a compiled one of another device of the same model,
+                      //! reusing its segmentation, heuristics and binaries
+  SmemCarveout, //! Set the preferred shared memory carveout of kernels to
+                //! what their resident blocks use, leaving the rest of the
+                //! unified L1 to the cache. See Note [Shared memory
+                //! carveout] in executor.cpp
+  SmemPlanner, //! Place shared memory buffers of constant sizes with their
+               //! liveness intervals when it uses less memory than the stack
+               //! based allocator
+  SmemSwizzle, //! Let the transpose scheduler XOR swizzle the shared memory
+               //! tiles of vectorized schedules in the layout with the
+               //! fewest estimated bank conflicts. See Note [Shared memory
+               //! tile swizzle] in scheduler/transpose.cpp
+  SplitReduction, //! Replace cross-grid reductions predicted to be slower
+                  //! than a partial and a final reduction segment with the
+                  //! two segments, e.g. split_reduction(64) always splits
+                  //! into 64 partial results. See Note [Split reductions] in
+                  //! fusion_segmenter.cpp
   WarnRegisterSpill, //! Enable warnings of register spill
   IoToLowerPrecision, //! Enable castInputOutputToLowerPrecision. #1889 explains
                       //! why we disabled it by default.
@@ -115,17 +306,33 @@ enum class DisableOption {
   ExprSimplify, //! Disable expression simplifier
   Fallback, //! Disable fallback
   Fma, //! Disable FMA instructions
+  FusionDeduplication, //! Disable running the definitions of the python
+                       //! frontend that build the same fusion with one
+                       //! FusionExecutorCache
   GroupedGridWelfordOuterOpt, //! Disable use of outer-optimized
                               //! grouped grid welford kernel
+  HierarchicalCommunication, //! Disable decomposing inter-node Allreduces
+                             //! into intra- and inter-node collectives
   IndexHoist, //! Disable index hoisting
   MagicZero, //! Disable nvfuser_zero
   MatmulExprEval, //! Disable ATen evaluation for the entire fusion containing
                   //! matmul
+  MatmulHeuristicPlugin, //! Ignore the matmul heuristic plugin loaded with
+                         //! NVFUSER_MATMUL_HEURISTIC_PLUGIN
   Nvtx, //! Disable NVTX instrumentation
+  P2pCommunication, //! Disable the CUDA IPC path for small intra-node
+                    //! SendRecv and Allgather
   ParallelCompile, //! Disable compiling Fusion segments in parallel
-  ParallelSerde, //! Disable deserializing FusionExecutorCache in parallel
+  ParallelSerde, //! Disable (de)serializing FusionExecutorCache in parallel
+  PointwiseGridStride, //! Disable the grid-stride schedule of large 1D
+                       //! pointwise kernels
   PredicateElimination, //! Disable predicate elimination
   PythonInlineDefinitions, //! Disable printing of inline definitions
+  SimplifyDefinition, //! Disable dead-record elimination and constant folding
+                      //! when building the Fusion of a FusionDefinition
+  KernelDeduplication, //! Disable sharing the module of a kernel compiled
+                       //! in this process with executors generating the
+                       //! same code
   KernelReuse, //! Disable re-using cached FusionKernelRuntimes with different
                //! input shapes
   VarNameRemapping, //! Disable variable name remapping
@@ -153,6 +360,8 @@ enum class ProfilerOption {
   PrintVerbose, //! Enables the profiler and prints a complete set of columns
                 //! to the console.  WARNING: The output is will wrap on small
                 //! screens!
+  PrintRoofline, //! Enables the profiler and prints the roofline efficiency of
+                 //! each kernel, see FusionProfile::rooflineReport.
   EndOfOption //! Placeholder for counting the number of elements
 };
 
@@ -283,6 +492,7 @@ bool isProfilerEnabled();
 bool isProfilerEnabledWithCupti();
 bool isProfilerPrintingEnabled();
 bool isProfilerPrintingVerbose();
+bool isProfilerPrintingRoofline();
 
 const std::vector<std::string>& getProfilerOptionArguments(
     ProfilerOption option);
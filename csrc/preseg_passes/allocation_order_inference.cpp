@@ -5,11 +5,13 @@
  * SPDX-License-Identifier: BSD-3-Clause
  */
 // clang-format on
+#include <debug.h>
 #include <id_model/id_model.h>
 #include <ir/all_nodes.h>
 #include <ir/utils.h>
 #include <iter_visitor.h>
 #include <logical_domain_map.h>
+#include <options.h>
 #include <preseg_passes/allocation_order_inference.h>
 
 namespace nvfuser::preseg_passes {
@@ -27,6 +29,25 @@ int64_t countNonTrivialIterDomains(const TensorView* tv) {
       });
 }
 
+// Whether `a` and `b` have the same allocation order, i.e. their allocation
+// domains are permissively mapped position by position.
+bool haveSameAllocationOrder(
+    const DisjointSets<Val*>& val_sets,
+    const TensorView* a,
+    const TensorView* b) {
+  const std::vector<IterDomain*>& a_alloc = a->getMaybeAllocationDomain();
+  const std::vector<IterDomain*>& b_alloc = b->getMaybeAllocationDomain();
+  if (a_alloc.size() != b_alloc.size()) {
+    return false;
+  }
+  for (auto i : c10::irange(a_alloc.size())) {
+    if (!val_sets.permissiveAreMapped(a_alloc[i], b_alloc[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
 // Note [ Allocation Order Mapping ]
 //
 // Map allocation domain from ref to target's logical domain to construct a new
@@ -236,12 +257,19 @@ void mapAllocationDomain(
 //         which case, we would want to propagate the layout of the full-sized
 //         tensor to the output, even though both candidates have the same rank.
 //         Note1: when we have multiple candidates with the same count of
-//         non-trivial iter domains, we require there's no ambiguity by
-//         checking both candidates having the same iter domain mapping.
-//         Otherwise we'll stop the propagation by leaving ref as nullptr.
+//         non-trivial iter domains, they vote for their allocation order:
+//         candidates with the same iter domain mapping on their allocation
+//         domains support the same order, and the order with the most support
+//         wins. Following the majority means the fewest of these inputs are
+//         read against the layout of dst, i.e. transposed, so a fusion mixing
+//         a few permuted inputs into mostly channels-last ones stays
+//         channels-last instead of falling back to the logical order. On a
+//         tie between different orders there's no way to tell which one is
+//         better, so we stop the propagation by leaving ref as nullptr.
 //     2.3 It does not have self mapping;
 //   3. Propagate memory format from selected reference in `srcs` to its
-//   corresponding target in `dsts`.
+//   corresponding target in `dsts`. The choice is reported in the
+//   PreSegmenterLogging dump.
 //
 // propagation rule:
 //   Given a reference TensorView `ref` and a target TensorView `target`, we try
@@ -284,10 +312,9 @@ void inferenceAllocationOrder(
       continue;
     }
 
-    // find a ref among srcs to be propagated to given dst
-    TensorView* ref = nullptr;
-
-    // high water mark for candidate of ref.
+    // find the candidates of ref among srcs: those with the highest
+    // non-trivial iter domain count that dst depends on.
+    std::vector<TensorView*> candidates;
     int64_t non_bc_high_water_mark = 0;
     for (auto* tv : srcs) {
       // skip when non-trivial iter domains count is missing.
@@ -298,34 +325,41 @@ void inferenceAllocationOrder(
       if (!DependencyCheck::isDependencyOf(tv, dst)) {
         continue;
       }
-      // discard srcs with lower iterdomain count than ref.
+      // discard srcs with lower iterdomain count than the candidates.
       if (non_trivial_iter_count[tv] < non_bc_high_water_mark) {
         continue;
       }
-      // new candidate found, update ref and high water mark.
+      // higher iterdomain count found, restart the candidates from tv.
       if (non_trivial_iter_count[tv] > non_bc_high_water_mark) {
-        ref = tv;
+        candidates.clear();
         non_bc_high_water_mark = non_trivial_iter_count[tv];
-        continue;
       }
-      // found multiple candidate with the same iterdomain count
-      if (non_trivial_iter_count[tv] == non_bc_high_water_mark &&
-          ref != nullptr) {
-        // ensure that there's no ambiguity on permutation mapping from multiple
-        // references. we need both ref candidates to have the same mapping on
-        // allocation domain
-        for (auto i : c10::irange(ref->nDims())) {
-          if (!val_sets.permissiveAreMapped(
-                  ref->getMaybeAllocationDomain()[i],
-                  tv->getMaybeAllocationDomain()[i])) {
-            // reset ref to nullptr, while keeping the iterdomain count high
-            // water mark. No propagation will occur unless we found another ref
-            // candidate with a higher iterdomain count.
-            ref = nullptr;
-            break;
-          }
-        }
-        continue;
+      candidates.push_back(tv);
+    }
+
+    // group the candidates by allocation order and count the votes of each
+    // order, see Note1 above.
+    std::vector<std::pair<TensorView*, int64_t>> votes;
+    for (auto* tv : candidates) {
+      auto it = std::find_if(votes.begin(), votes.end(), [&](const auto& v) {
+        return haveSameAllocationOrder(val_sets, v.first, tv);
+      });
+      if (it == votes.end()) {
+        votes.emplace_back(tv, 1);
+      } else {
+        it->second++;
+      }
+    }
+
+    TensorView* ref = nullptr;
+    int64_t max_votes = 0;
+    for (const auto& [tv, count] : votes) {
+      if (count > max_votes) {
+        ref = tv;
+        max_votes = count;
+      } else if (count == max_votes) {
+        // a tie between different allocation orders is ambiguous.
+        ref = nullptr;
       }
     }
 
@@ -333,6 +367,23 @@ void inferenceAllocationOrder(
     if (ref) {
       mapAllocationDomain(id_model, ref, dst);
     }
+
+    if (isDebugDumpEnabled(DebugDumpOption::PreSegmenterLogging)) {
+      debug() << "Allocation order of " << ir_utils::varName(dst) << ": ";
+      if (candidates.empty()) {
+        debug() << "not propagated, no candidate" << std::endl;
+      } else if (ref == nullptr) {
+        debug() << "not propagated, no majority among " << votes.size()
+                << " allocation orders of " << candidates.size()
+                << " candidates" << std::endl;
+      } else {
+        debug() << "propagated from " << ir_utils::varName(ref) << " with "
+                << max_votes << " of " << candidates.size()
+                << " candidate votes, "
+                << ir_utils::toString(dst->getMaybeAllocationDomain())
+                << std::endl;
+      }
+    }
   }
 }
 
@@ -0,0 +1,251 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#include <preseg_passes/compress_collectives.h>
+
+#include <fusion.h>
+#include <ir/all_nodes.h>
+#include <ir/utils.h>
+#include <iter_visitor.h>
+#include <multidevice/utils.h>
+#include <ops/all_ops.h>
+#include <options.h>
+
+#include <algorithm>
+#include <unordered_set>
+#include <vector>
+
+namespace nvfuser::preseg_passes {
+
+// Note [Compressed collectives]
+//
+// Data-parallel gradients are reduced with a ReduceScatter, e.g.
+// [DIDx(i0), i1] -> [r0, DIDx(i1)], optionally followed by an Allgather of
+// the reduced shards, and both move the data at its native dtype. With
+// EnableOption::CompressedCollectives, they move it in a narrower transport
+// dtype instead:
+//   - bf16, the default, which keeps the range of fp32 and needs no scale;
+//   - fp8 (e4m3), with compressed_collectives(fp8). Each row along the
+//     innermost axis is divided by scale = amax(row) / 448 before the cast,
+//     and the scales are sent along with the data.
+// which halves, resp. quarters, the bytes of fp32 data on the wire.
+//
+// A ReduceScatter is rewritten as
+//   quantize -> AllToAll [DIDx(i0), i1] -> [i0, DIDx(i1)] -> dequantize -> sum
+// so that the partial sums are accumulated in fp32 by the consumer after the
+// exchange instead of by the collective in the transport dtype, which would
+// compound the rounding errors with the team size and isn't possible with
+// per-row scales. Each device receives the same number of bytes as with a
+// ReduceScatter. An Allgather is rewritten as quantize -> Allgather ->
+// dequantize. The quantization is a local op on the producer side of the
+// collective and the dequantization one on the consumer side, so the
+// segmenter fuses them with the kernels producing and consuming the
+// collective's tensors, and the ReduceScatter + Allgather decomposition of
+// an Allreduce loses no more than one rounding to the transport dtype per
+// collective.
+//
+// Allreduces are left as is, since their result is not sharded along
+// another axis to exchange the partial sums over. Collectives whose sharded
+// axes include the innermost one are also left as is with fp8, since the
+// scale of a row could not be split or gathered along with the row.
+
+namespace {
+
+// Largest finite value of fp8 e4m3
+constexpr double kFloat8E4m3Max = 448.0;
+
+DataType getTransportType() {
+  const std::vector<std::string>& args =
+      getEnableOptionArguments(EnableOption::CompressedCollectives);
+  if (args.empty() || args.at(0) == "bf16") {
+    return DataType::BFloat16;
+  }
+  NVF_CHECK(
+      args.at(0) == "fp8",
+      "Unknown transport dtype of compressed collectives: ",
+      args.at(0),
+      ". Expected bf16 or fp8.");
+  return DataType::Float8_e4m3fn;
+}
+
+// The data in the transport dtype and its scales, if any
+struct Compressed {
+  TensorView* data = nullptr;
+  TensorView* scale = nullptr;
+
+  std::vector<TensorView*> tvs() const {
+    std::vector<TensorView*> tvs = {data};
+    if (scale != nullptr) {
+      tvs.push_back(scale);
+    }
+    return tvs;
+  }
+};
+
+Compressed quantize(TensorView* tv, DataType transport) {
+  TensorView* in = maybeCastOp(DataType::Float, tv);
+  if (transport != DataType::Float8_e4m3fn) {
+    return {castOp(transport, in), nullptr};
+  }
+  const auto innermost =
+      (int64_t)TensorDomain::noReductions(tv->getLogicalDomain()).size() - 1;
+  TensorView* amax = max(abs(in), {innermost}, /*keep_dim=*/true);
+  TensorView* scale = where(
+      eq(amax, IrBuilder::create<Val>(0.0)),
+      IrBuilder::create<Val>(1.0),
+      div(amax, IrBuilder::create<Val>(kFloat8E4m3Max)));
+  return {castOp(transport, div(in, scale)), scale};
+}
+
+TensorView* dequantize(const Compressed& compressed) {
+  TensorView* out = castOp(DataType::Float, compressed.data);
+  return compressed.scale == nullptr ? out : mul(out, compressed.scale);
+}
+
+// Shards the tensors computed from `from` up to `to` like `ref`
+void shardBetweenLike(
+    const std::vector<TensorView*>& from,
+    const std::vector<TensorView*>& to,
+    TensorView* ref) {
+  std::vector<TensorView*> tvs;
+  for (Val* val : DependencyCheck::getAllValsBetween(
+           {from.begin(), from.end()}, {to.begin(), to.end()})) {
+    auto* tv = dynamic_cast<TensorView*>(val);
+    if (tv != nullptr &&
+        std::find(from.begin(), from.end(), tv) == from.end()) {
+      tvs.push_back(tv);
+    }
+  }
+  shardAllLike(ref, tvs);
+}
+
+// Sets `tv` on `mesh`, sharded along its logical `axis`, or replicated if
+// `axis` is negative
+void shardAlong(TensorView* tv, const DeviceMesh& mesh, int64_t axis) {
+  tv->setDeviceMesh(mesh);
+  for (auto i : c10::irange(tv->nDims())) {
+    tv->axis(i)->parallelize(
+        i == axis ? ParallelType::DIDx : ParallelType::Serial);
+  }
+}
+
+// Position of the DIDx axis in the logical domain of `tv`, reductions
+// included, or -1
+int64_t getDeviceAxis(TensorView* tv) {
+  const std::vector<IterDomain*>& logical = tv->getLogicalDomain();
+  for (auto i : c10::irange(logical.size())) {
+    if (logical.at(i)->getParallelType() == ParallelType::DIDx) {
+      return (int64_t)i;
+    }
+  }
+  return -1;
+}
+
+bool isCompressible(
+    TensorView* in,
+    TensorView* out,
+    DataType transport,
+    const std::vector<int64_t>& sharded_axes) {
+  if (!in->hasDeviceMesh() ||
+      !(in->getDeviceMesh() == out->getDeviceMesh()) ||
+      in->getDeviceMesh().size() < 2) {
+    return false;
+  }
+  const DataType dtype = *in->getDataType();
+  if (!isFloatingPointType(dtype) ||
+      dataTypeSize(dtype) <= dataTypeSize(transport)) {
+    return false;
+  }
+  if (transport == DataType::Float8_e4m3fn) {
+    const auto innermost = (int64_t)in->getLogicalDomain().size() - 1;
+    for (int64_t axis : sharded_axes) {
+      if (axis == innermost) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// [DIDx(i0), i1] -> [r0, DIDx(i1)] is rewritten as
+// [DIDx(i0), i1] -> quantize -> [i0, DIDx(i1)] -> dequantize -> [r0, DIDx(i1)]
+void compressReduceScatter(ReductionOp* reduction, DataType transport) {
+  auto* in = reduction->in()->as<TensorView>();
+  auto* out = reduction->out()->as<TensorView>();
+  const int64_t reduced_axis = getDeviceAxis(in);
+  const int64_t scattered_axis = getDeviceAxis(out);
+  if (reduction->getReductionOpType() != BinaryOpType::Add ||
+      reduced_axis < 0 || scattered_axis < 0 ||
+      !isCompressible(in, out, transport, {reduced_axis, scattered_axis}) ||
+      !out->getLogicalDomain().at(reduced_axis)->isReduction()) {
+    return;
+  }
+  const DeviceMesh& mesh = in->getDeviceMesh();
+
+  Compressed sent = quantize(in, transport);
+  shardBetweenLike({in}, sent.tvs(), in);
+  Compressed received;
+  received.data = set(sent.data);
+  shardAlong(received.data, mesh, scattered_axis);
+  if (sent.scale != nullptr) {
+    received.scale = set(sent.scale);
+    shardAlong(received.scale, mesh, scattered_axis);
+  }
+  TensorView* new_out = maybeCastOp(
+      *out->getDataType(), sum(dequantize(received), {reduced_axis}));
+  shardBetweenLike(received.tvs(), {new_out}, received.data);
+  ir_utils::replaceValInAllExprInputsAndFusionOutputs(out, new_out);
+}
+
+// [DIDx(i0), i1] -> [i0, i1] is rewritten as
+// [DIDx(i0), i1] -> quantize -> [i0, i1] -> dequantize
+void compressAllgather(LoadStoreOp* set_op, DataType transport) {
+  auto* in = set_op->in()->as<TensorView>();
+  auto* out = set_op->out()->as<TensorView>();
+  const int64_t gathered_axis = getDeviceAxis(in);
+  if (set_op->opType() != LoadStoreOpType::Set || gathered_axis < 0 ||
+      getDeviceAxis(out) >= 0 ||
+      !isCompressible(in, out, transport, {gathered_axis})) {
+    return;
+  }
+  const DeviceMesh& mesh = in->getDeviceMesh();
+
+  Compressed sent = quantize(in, transport);
+  shardBetweenLike({in}, sent.tvs(), in);
+  Compressed received;
+  received.data = set(sent.data);
+  shardAlong(received.data, mesh, -1);
+  if (sent.scale != nullptr) {
+    received.scale = set(sent.scale);
+    shardAlong(received.scale, mesh, -1);
+  }
+  TensorView* new_out =
+      maybeCastOp(*out->getDataType(), dequantize(received));
+  shardBetweenLike(received.tvs(), {new_out}, received.data);
+  ir_utils::replaceValInAllExprInputsAndFusionOutputs(out, new_out);
+}
+
+} // namespace
+
+void CompressCollectivesPass::runPass(Fusion* fusion) {
+  if (!isOptionEnabled(EnableOption::CompressedCollectives)) {
+    return;
+  }
+  const DataType transport = getTransportType();
+  for (Expr* expr : fusion->exprs()) {
+    if (!isResharding(expr)) {
+      continue;
+    }
+    if (auto* reduction = dynamic_cast<ReductionOp*>(expr)) {
+      compressReduceScatter(reduction, transport);
+    } else if (auto* set_op = dynamic_cast<LoadStoreOp*>(expr)) {
+      compressAllgather(set_op, transport);
+    }
+  }
+}
+
+} // namespace nvfuser::preseg_passes
@@ -0,0 +1,32 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#pragma once
+
+#include <preseg_passes/optimization_pass.h>
+
+namespace nvfuser::preseg_passes {
+
+//! With EnableOption::CompressedCollectives, sends the data of the
+//! ReduceScatters and Allgathers of floating-point tensors in bf16, or in fp8
+//! with a scale per row with compressed_collectives(fp8). The quantization is
+//! fused with the producer of the collective and the dequantization, and the
+//! accumulation of a ReduceScatter, with its consumer. This can only run
+//! after InsertReshardingsPass and before ReorderShardedAxisPass. See Note
+//! [Compressed collectives] in the cpp file.
+class CompressCollectivesPass
+    : public OptimizationPass<CompressCollectivesPass> {
+  friend class OptimizationPass<CompressCollectivesPass>;
+
+ protected:
+  static void runPass(Fusion* fusion);
+  static std::string name() {
+    return "CompressCollectivesPass";
+  }
+};
+
+} // namespace nvfuser::preseg_passes
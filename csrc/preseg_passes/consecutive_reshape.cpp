@@ -0,0 +1,166 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#include <preseg_passes/consecutive_reshape.h>
+
+#include <ir/utils.h>
+#include <ops/alias.h>
+
+#include <numeric>
+
+namespace nvfuser::preseg_passes {
+
+namespace {
+
+// Returns the new2old permutation applied by expr if it is a permute.
+std::optional<std::vector<int64_t>> getPermutation(Expr* expr) {
+  auto* ldst = dynamic_cast<LoadStoreOp*>(expr);
+  if (ldst == nullptr || ldst->opType() != LoadStoreOpType::Set ||
+      !ldst->in()->isA<TensorView>()) {
+    return std::nullopt;
+  }
+  auto* out = ldst->out()->as<TensorView>();
+  if (!out->hasRoot()) {
+    return std::nullopt;
+  }
+  return ir_utils::computePermutation(
+      out->getRootDomain(), out->getLogicalDomain());
+}
+
+bool isReshapeLike(Expr* expr) {
+  return expr != nullptr &&
+      (expr->isA<ViewOp>() || expr->isA<SqueezeOp>() ||
+       expr->isA<BroadcastOp>());
+}
+
+// Returns the static sizes of tv's logical domain if none of them is one,
+// since size-one dimensions are squeezed or broadcast by reshape.
+std::optional<std::vector<int64_t>> getStaticNonUnitSizes(TensorView* tv) {
+  std::vector<int64_t> sizes;
+  for (IterDomain* id : TensorDomain::noReductions(tv->getLogicalDomain())) {
+    if (id->hasExpandedExtent() || !id->extent()->isConstInt()) {
+      return std::nullopt;
+    }
+    sizes.push_back(id->extent()->evaluate().as<int64_t>());
+    if (sizes.back() == 1) {
+      return std::nullopt;
+    }
+  }
+  return sizes;
+}
+
+// Whether uses of tv can be redirected to another TensorView computing the
+// same values.
+bool isReplaceable(TensorView* tv) {
+  return !tv->hasAllocation() &&
+      tv->fusion()->getOutputAlias(tv).type == AllocationType::New;
+}
+
+// Note [Consecutive reshapes]
+//
+// Traced programs often produce chains of layout ops, e.g.
+//     x -> permute -> permute -> reshape -> squeeze -> reshape -> out
+// Each op of the chain is a potential segment break or gets in the way of
+// vectorization, while the chain is equivalent to much fewer ops. For a chain
+// whose intermediates are only used by the next op of the chain, and are not
+// fusion outputs:
+//   1. a chain of permutes is replaced by a single permute of the first input,
+//   whose new2old permutation composes the ones of the chain.
+//   2. a chain of ViewOp, SqueezeOp and BroadcastOp is replaced by a single
+//   reshape of the first input, when the sizes of the first input and of the
+//   last output are static and none of them is one. That guarantees the new
+//   reshape is a single ViewOp producing the same iter types.
+// When the composed op is an identity, the last output is replaced by the
+// first input, unless it is a fusion output, so that outputs don't become
+// aliases of other tensors.
+//
+// Like ConsecutiveCastPass, exprs are visited backwards and each chain is
+// folded from its last op, so the ops in the middle of a chain are visited
+// once.
+void foldConsecutiveReshapes(Fusion* fusion) {
+  auto exprs = fusion->exprs();
+  std::unordered_set<Expr*> visited;
+  for (auto iter = exprs.rbegin(); iter != exprs.rend(); ++iter) {
+    Expr* expr = *iter;
+    if (visited.count(expr) != 0) {
+      continue;
+    }
+    const bool is_permute = getPermutation(expr).has_value();
+    if (!is_permute && !isReshapeLike(expr)) {
+      continue;
+    }
+    auto is_same_kind = [&](Expr* e) {
+      return is_permute ? getPermutation(e).has_value() : isReshapeLike(e);
+    };
+
+    auto* out = expr->output(0)->as<TensorView>();
+    if (!isReplaceable(out)) {
+      continue;
+    }
+
+    // chain holds the ops from the first one to expr.
+    std::vector<Expr*> chain = {expr};
+    while (true) {
+      auto* producer = chain.back()->input(0)->as<TensorView>();
+      Expr* def = producer->definition();
+      if (def == nullptr || !is_same_kind(def) ||
+          producer->uses().size() > 1 || producer->isFusionOutput() ||
+          producer->hasAllocation()) {
+        break;
+      }
+      visited.insert(def);
+      chain.push_back(def);
+    }
+    std::reverse(chain.begin(), chain.end());
+    auto* in = chain.front()->input(0)->as<TensorView>();
+
+    TensorView* replacement = nullptr;
+    if (is_permute) {
+      std::vector<int64_t> new2old(out->getRootDomain().size());
+      std::iota(new2old.begin(), new2old.end(), 0);
+      for (Expr* e : chain) {
+        std::vector<int64_t> permutation = getPermutation(e).value();
+        std::vector<int64_t> composed;
+        composed.reserve(permutation.size());
+        for (int64_t i : permutation) {
+          composed.push_back(new2old.at(i));
+        }
+        new2old = std::move(composed);
+      }
+      const bool is_identity = std::is_sorted(new2old.begin(), new2old.end());
+      if (is_identity && !out->isFusionOutput()) {
+        replacement = in;
+      } else if (chain.size() > 1) {
+        replacement = permute(in, new2old);
+      }
+    } else {
+      std::optional<std::vector<int64_t>> in_sizes = getStaticNonUnitSizes(in);
+      std::optional<std::vector<int64_t>> out_sizes =
+          getStaticNonUnitSizes(out);
+      if (!in_sizes.has_value() || !out_sizes.has_value()) {
+        continue;
+      }
+      if (*in_sizes == *out_sizes && !out->isFusionOutput()) {
+        replacement = in;
+      } else if (chain.size() > 1) {
+        replacement = reshape(in, *in_sizes, *out_sizes);
+      }
+    }
+
+    if (replacement != nullptr) {
+      ir_utils::replaceValInAllExprInputsAndFusionOutputs(out, replacement);
+    }
+  }
+}
+
+} // namespace
+
+void ConsecutiveReshapePass::runPass(Fusion* fusion) {
+  foldConsecutiveReshapes(fusion);
+}
+
+} // namespace nvfuser::preseg_passes
@@ -0,0 +1,27 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#pragma once
+
+#include <preseg_passes/optimization_pass.h>
+
+namespace nvfuser::preseg_passes {
+
+//! ConsecutiveReshapePass composes chains of permutes, and chains of static
+//! reshapes, squeezes and broadcasts, into a single op, and removes the ones
+//! that turn out to be identities.
+class ConsecutiveReshapePass : public OptimizationPass<ConsecutiveReshapePass> {
+  friend class OptimizationPass<ConsecutiveReshapePass>;
+
+ protected:
+  static void runPass(Fusion* fusion);
+  static std::string name() {
+    return "ConsecutiveReshapePass";
+  }
+};
+
+} // namespace nvfuser::preseg_passes
@@ -0,0 +1,126 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#include <preseg_passes/decompose_sdpa.h>
+
+#include <fusion.h>
+#include <ir/all_nodes.h>
+#include <ir/utils.h>
+#include <ops/all_ops.h>
+#include <options.h>
+
+#include <limits>
+
+namespace nvfuser::preseg_passes {
+
+// Note [Decomposing SDPA]
+//
+// SdpaFwdOp is only accepted by the ExprEval scheduler, which runs it with
+// ATen's flash attention in a segment of its own. The ops producing the
+// query, key and value (e.g. rotary embeddings) and the ones consuming the
+// output (e.g. the output projection) are then separated from the attention
+// by a round trip through global memory.
+//
+// With EnableOption::DecomposeSdpa, an SdpaFwdOp is instead rewritten as
+//   scores = matmul(query, key^T) * scale, masked with -inf above the
+//            diagonal if is_causal, computed in float
+//   log_sumexp = max(scores) + log(sum(exp(scores - max(scores))))
+//   output = matmul(exp(scores - log_sumexp), value)
+// where the reductions are over the keys. The softmax then goes to a
+// normalization segment fused with its producers and consumers, and the
+// matmuls to the matmul scheduler. This materializes the [L, S] attention
+// probabilities, so it only pays off when the sequences are short enough for
+// the saved segment boundaries to dominate. A tiled attention kernel with an
+// online softmax would avoid that, but needs a dedicated scheduler.
+//
+// The decomposition is not applied when it can't reproduce the op: with
+// dropout, whose random numbers are drawn by ATen, when the RNG state outputs
+// are used, e.g. by an SdpaBwdOp, and when the inputs are sharded.
+
+namespace {
+
+bool canDecompose(SdpaFwdOp* sdpa) {
+  if (sdpa->dropout_p() == nullptr || !sdpa->dropout_p()->isZero()) {
+    return false;
+  }
+  if (!sdpa->is_causal()->isConst()) {
+    return false;
+  }
+  for (auto i : {2, 3}) {
+    Val* rng_state = sdpa->output(i);
+    if (!rng_state->uses().empty() || rng_state->isFusionOutput()) {
+      return false;
+    }
+  }
+  for (Val* in : {sdpa->query(), sdpa->key(), sdpa->value()}) {
+    auto logical = TensorDomain::noReductions(
+        in->as<TensorView>()->getLogicalDomain());
+    if (logical.size() != 4) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void decompose(SdpaFwdOp* sdpa) {
+  auto query = sdpa->query()->as<TensorView>();
+  auto key = sdpa->key()->as<TensorView>();
+  auto value = sdpa->value()->as<TensorView>();
+  const auto query_domain =
+      TensorDomain::noReductions(query->getLogicalDomain());
+  const auto key_domain = TensorDomain::noReductions(key->getLogicalDomain());
+
+  // [N, H, L, S]
+  TensorView* scores =
+      castOp(DataType::Float, matmul(query, transpose(key, 2, 3)));
+  Val* scale = sdpa->scale();
+  if (scale == nullptr) {
+    scale = rsqrt(castOp(DataType::Double, query_domain.at(3)->extent()));
+  }
+  scores = mul(scores, scale);
+  if (sdpa->is_causal()->isTrue()) {
+    // Query l attends to the keys s <= l, like torch.tril
+    TensorView* rows = iota(query_domain.at(2)->extent());
+    TensorView* cols = iota(key_domain.at(2)->extent());
+    TensorView* masked = gt(
+        broadcast(cols, {true, false}), broadcast(rows, {false, true}));
+    scores = where(
+        broadcast(masked, {true, true, false, false}),
+        IrBuilder::create<Val>(-std::numeric_limits<double>::infinity()),
+        scores);
+  }
+
+  TensorView* max_scores = max(scores, {3});
+  TensorView* sum_exp = sum(
+      exp(sub(scores, broadcast(max_scores, {false, false, false, true}))),
+      {3});
+  TensorView* log_sumexp = add(max_scores, log(sum_exp));
+  TensorView* probs =
+      exp(sub(scores, broadcast(log_sumexp, {false, false, false, true})));
+  TensorView* output = matmul(castOp(query->dtype(), probs), value);
+
+  ir_utils::replaceValInAllExprInputsAndFusionOutputs(
+      sdpa->attn_out(), output);
+  ir_utils::replaceValInAllExprInputsAndFusionOutputs(
+      sdpa->output(1), log_sumexp);
+}
+
+} // namespace
+
+void DecomposeSdpaPass::runPass(Fusion* fusion) {
+  if (!isOptionEnabled(EnableOption::DecomposeSdpa)) {
+    return;
+  }
+  FusionGuard fg(fusion);
+  for (auto sdpa : ir_utils::getOpsOfType<SdpaFwdOp>(fusion)) {
+    if (canDecompose(sdpa)) {
+      decompose(sdpa);
+    }
+  }
+}
+
+} // namespace nvfuser::preseg_passes
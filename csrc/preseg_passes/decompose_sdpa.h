@@ -0,0 +1,30 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#pragma once
+
+#include <preseg_passes/optimization_pass.h>
+
+namespace nvfuser::preseg_passes {
+
+//! With EnableOption::DecomposeSdpa, replaces SdpaFwdOps by their definition
+//! in terms of MatmulOps and a softmax, so the segmenter can fuse the softmax
+//! with the surrounding ops instead of sending the attention to ATen. Only
+//! SdpaFwdOps without dropout, with a constant is_causal, and whose RNG state
+//! outputs are unused are decomposed. See Note [Decomposing SDPA] in the cpp
+//! file.
+class DecomposeSdpaPass : public OptimizationPass<DecomposeSdpaPass> {
+  friend class OptimizationPass<DecomposeSdpaPass>;
+
+ protected:
+  static void runPass(Fusion* fusion);
+  static std::string name() {
+    return "DecomposeSdpaPass";
+  }
+};
+
+} // namespace nvfuser::preseg_passes
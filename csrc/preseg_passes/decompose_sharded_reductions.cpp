@@ -0,0 +1,219 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#include <preseg_passes/decompose_sharded_reductions.h>
+
+#include <fusion.h>
+#include <ir/all_nodes.h>
+#include <ir/utils.h>
+#include <iter_visitor.h>
+#include <multidevice/utils.h>
+#include <ops/all_ops.h>
+
+#include <c10/util/irange.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace nvfuser::preseg_passes {
+
+// Note [Distributed normalization statistics]
+//
+// With sequence or tensor parallelism, the axes normalized by a LayerNorm or
+// an RMSNorm may be sharded, e.g. x: [i0, DIDx(i1), i2] normalized over
+// {i1, i2}. A reduction of several axes including a sharded one is not
+// lowerable to a communication, and gathering x to reduce it locally would
+// move the whole activation. Instead, each device reduces its shard to one
+// partial result per row, and only these O(rows) partial results are
+// communicated:
+//
+//   ReductionOp  out = reduce(x, {i1, i2})
+//     -> partial = reduce(x, {i2})            [i0, DIDx(i1)]   local
+//        out = reduce(partial, {i1})          [i0]             Allreduce
+//
+//   WelfordOp    (avg, M2, N) = welford(x, {i1, i2})
+//     -> (avg_p, M2_p, N_p) = welford(x, {i2})                 local
+//        N = sum(N_p, {i1})                                    Allreduce
+//        avg = sum(avg_p * N_p, {i1}) / N                      Allreduce
+//        M2 = sum(M2_p + N_p * (avg_p - avg)^2, {i1})          Allreduce
+//
+// The Welford statistics are combined with Chan's pairwise formula around the
+// global mean, so no catastrophic cancellation is introduced by the
+// combination, at the cost of a third Allreduce that depends on the first
+// two. The local reductions are scheduled by the reduction and normalization
+// schedulers like any other, and the normalization itself, which only
+// broadcasts the statistics along the sharded axis, remains local (see
+// haveDifferentShardings).
+//
+// Reductions of a sharded axis only are left as is since they are already
+// lowered to a single collective, as are WelfordOps with an initial value or
+// with partial results as inputs.
+
+namespace {
+
+// Returns the position of the logical axis of `in` that is parallelized on
+// DIDx and reduced in `out`, or -1.
+int64_t getShardedReducedAxis(TensorView* in, TensorView* out) {
+  const std::vector<IterDomain*> in_logical =
+      TensorDomain::noReductions(in->getLogicalDomain());
+  const std::vector<IterDomain*>& out_logical = out->getLogicalDomain();
+  if (in_logical.size() != out_logical.size()) {
+    return -1;
+  }
+  for (auto i : c10::irange(in_logical.size())) {
+    if (in_logical[i]->isDeviceDim() && out_logical[i]->isReduction()) {
+      return static_cast<int64_t>(i);
+    }
+  }
+  return -1;
+}
+
+// Returns the positions of the reduced logical axes of `out` other than
+// `sharded_axis`
+std::vector<int64_t> getLocalReducedAxes(
+    TensorView* out,
+    int64_t sharded_axis) {
+  std::vector<int64_t> axes;
+  const std::vector<IterDomain*>& out_logical = out->getLogicalDomain();
+  for (auto i : c10::irange((int64_t)out_logical.size())) {
+    if (i != sharded_axis && out_logical[i]->isReduction()) {
+      axes.push_back(i);
+    }
+  }
+  return axes;
+}
+
+// Position of `sharded_axis` in the partial results, which drop the local
+// reduced axes
+int64_t getPartialAxis(
+    int64_t sharded_axis,
+    const std::vector<int64_t>& local_axes) {
+  return sharded_axis -
+      std::count_if(local_axes.begin(), local_axes.end(), [&](int64_t axis) {
+           return axis < sharded_axis;
+         });
+}
+
+// Whether the collectives can reduce with `op_type`. See getC10dReduceOpType.
+bool isCommunicationReduceOp(BinaryOpType op_type) {
+  switch (op_type) {
+    case BinaryOpType::Add:
+    case BinaryOpType::Mul:
+    case BinaryOpType::Min:
+    case BinaryOpType::Max:
+    case BinaryOpType::BitwiseAnd:
+    case BinaryOpType::BitwiseOr:
+    case BinaryOpType::BitwiseXor:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Shards the TensorViews created between `in` and `outputs` like `in`. The
+// axes they reduce, including the sharded axis, are not parallelized, so the
+// reductions of the sharded axis are lowered to Allreduces.
+void shardLikeInput(TensorView* in, const std::vector<Val*>& outputs) {
+  std::vector<TensorView*> tvs;
+  for (auto* tv : ir_utils::filterByType<TensorView>(
+           DependencyCheck::getAllValsBetween({in}, outputs))) {
+    if (tv != in) {
+      tvs.push_back(tv);
+    }
+  }
+  shardAllLike(in, tvs);
+  for (TensorView* tv : tvs) {
+    for (IterDomain* id : tv->getLoopDomain()) {
+      if (id->isReduction() && id->isDeviceDim()) {
+        id->parallelize(ParallelType::Serial);
+      }
+    }
+  }
+}
+
+void decomposeReduction(ReductionOp* rop) {
+  auto* in = rop->in()->as<TensorView>();
+  auto* out = rop->out()->as<TensorView>();
+  const int64_t sharded_axis = getShardedReducedAxis(in, out);
+  if (sharded_axis < 0 ||
+      !isCommunicationReduceOp(rop->getReductionOpType())) {
+    return;
+  }
+  const std::vector<int64_t> local_axes =
+      getLocalReducedAxes(out, sharded_axis);
+  if (local_axes.empty()) {
+    return;
+  }
+
+  TensorView* partial =
+      reductionOp(rop->getReductionOpType(), local_axes, rop->init(), in);
+  TensorView* new_out = reductionOp(
+      rop->getReductionOpType(),
+      {getPartialAxis(sharded_axis, local_axes)},
+      rop->init(),
+      partial);
+  shardLikeInput(in, {new_out});
+  ir_utils::replaceValInAllExprInputsAndFusionOutputs(out, new_out);
+}
+
+void decomposeWelford(WelfordOp* wop) {
+  if (wop->hasInit() || !wop->inN()->isOneInt()) {
+    return;
+  }
+  auto* in = wop->inAvg()->as<TensorView>();
+  auto* out_avg = wop->outAvg()->as<TensorView>();
+  const int64_t sharded_axis = getShardedReducedAxis(in, out_avg);
+  if (sharded_axis < 0) {
+    return;
+  }
+  const std::vector<int64_t> local_axes =
+      getLocalReducedAxes(out_avg, sharded_axis);
+  if (local_axes.empty()) {
+    return;
+  }
+  const int64_t axis = getPartialAxis(sharded_axis, local_axes);
+  const DataType dtype = *out_avg->getDataType();
+
+  WelfordResult partial = Welford(in, local_axes);
+  TensorView* partial_n = castOp(dtype, partial.n);
+
+  TensorView* n = sum(partial.n, {axis});
+  TensorView* avg = div(sum(mul(partial.avg, partial_n), {axis}), n);
+
+  std::vector<bool> is_broadcast(
+      TensorDomain::noReductions(partial.avg->getLogicalDomain()).size(),
+      false);
+  is_broadcast.at(axis) = true;
+  TensorView* delta = sub(partial.avg, broadcast(avg, is_broadcast));
+  TensorView* var_sum =
+      sum(add(partial.var_sum, mul(partial_n, mul(delta, delta))), {axis});
+
+  auto* out_n = wop->outN()->as<TensorView>();
+  if (n->getDataType() != out_n->getDataType()) {
+    n = castOp(*out_n->getDataType(), n);
+  }
+
+  shardLikeInput(in, {avg, var_sum, n});
+  ir_utils::replaceValInAllExprInputsAndFusionOutputs(out_avg, avg);
+  ir_utils::replaceValInAllExprInputsAndFusionOutputs(wop->outVar(), var_sum);
+  ir_utils::replaceValInAllExprInputsAndFusionOutputs(out_n, n);
+}
+
+} // namespace
+
+void DecomposeShardedReductionsPass::runPass(Fusion* fusion) {
+  FusionGuard fg(fusion);
+  for (Expr* expr : fusion->exprs()) {
+    if (auto* rop = dynamic_cast<ReductionOp*>(expr)) {
+      decomposeReduction(rop);
+    } else if (auto* wop = dynamic_cast<WelfordOp*>(expr)) {
+      decomposeWelford(wop);
+    }
+  }
+}
+
+} // namespace nvfuser::preseg_passes
@@ -0,0 +1,31 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#pragma once
+
+#include <preseg_passes/optimization_pass.h>
+
+namespace nvfuser::preseg_passes {
+
+//! Splits the ReductionOps and WelfordOps that reduce a DIDx-parallelized
+//! axis along with other axes, e.g., the statistics of a LayerNorm or an
+//! RMSNorm whose hidden dimension is sharded, into a local reduction of the
+//! other axes followed by Allreduces of the per-row partial results. This
+//! must run after PropagateShardingsPass and before InsertReshardingsPass.
+//! See Note [Distributed normalization statistics] in the cpp file.
+class DecomposeShardedReductionsPass
+    : public OptimizationPass<DecomposeShardedReductionsPass> {
+  friend class OptimizationPass<DecomposeShardedReductionsPass>;
+
+ protected:
+  static void runPass(Fusion* fusion);
+  static std::string name() {
+    return "DecomposeShardedReductionsPass";
+  }
+};
+
+} // namespace nvfuser::preseg_passes
@@ -8,6 +8,7 @@
 #include <preseg_passes/insert_reshardings.h>
 
 #include <device_lower/utils.h>
+#include <expr_evaluator.h>
 #include <fusion.h>
 #include <ir/base_nodes.h>
 #include <ir/interface_nodes.h>
@@ -16,16 +17,91 @@
 #include <multidevice/utils.h>
 #include <ops/alias.h>
 
+#include <optional>
+
 namespace nvfuser::preseg_passes {
 namespace {
-// TODO: We can either reshard the inputs of a resharding expression or
-// the outputs. Currently, we reshard the outputs when there is only one
-// input, otherwise we reshard the inputs. This heuristic should be smarter
-// and attempt to minimize communication.
+// Returns the size in bytes of `tv` when all its extents are known at compile
+// time. Non-expanded broadcast dimensions don't count.
+std::optional<int64_t> staticSizeInBytes(TensorView* tv) {
+  ExpressionEvaluator expr_eval;
+  int64_t bytes = dataTypeSize(*tv->getDataType());
+  for (IterDomain* id : TensorDomain::noReductions(tv->getLogicalDomain())) {
+    if (id->isBroadcast() && !id->hasExpandedExtent()) {
+      continue;
+    }
+    PolymorphicValue extent = expr_eval.evaluate(id->getMaybeExpandedExtent());
+    if (!extent.hasValue()) {
+      return std::nullopt;
+    }
+    bytes *= extent.as<int64_t>();
+  }
+  return bytes;
+}
+
+// Returns whether `tv` is certainly no larger than `other`, when their sizes
+// are not known at compile time: its dtype is no larger and each of its
+// extents is also an extent of `other`.
+bool isSymbolicallyNoLargerThan(TensorView* tv, TensorView* other) {
+  if (dataTypeSize(*tv->getDataType()) >
+      dataTypeSize(*other->getDataType())) {
+    return false;
+  }
+  auto extents = [](TensorView* tv) {
+    std::vector<Val*> extents;
+    for (IterDomain* id : TensorDomain::noReductions(tv->getLogicalDomain())) {
+      if (!id->isBroadcast() || id->hasExpandedExtent()) {
+        extents.push_back(id->getMaybeExpandedExtent());
+      }
+    }
+    return extents;
+  };
+  std::vector<Val*> other_extents = extents(other);
+  for (Val* extent : extents(tv)) {
+    auto it = std::find_if(
+        other_extents.begin(), other_extents.end(), [&](Val* other_extent) {
+          return other_extent->sameAs(extent);
+        });
+    if (it == other_extents.end()) {
+      return false;
+    }
+    other_extents.erase(it);
+  }
+  return true;
+}
+
+// Returns whether communicating `tv` is cheaper than communicating `other`.
+// The cost of a resharding is modeled as the number of bytes of the
+// resharded tensor, which are moved whatever the collective.
+bool isCheaperToReshard(TensorView* tv, TensorView* other) {
+  std::optional<int64_t> bytes = staticSizeInBytes(tv);
+  std::optional<int64_t> other_bytes = staticSizeInBytes(other);
+  if (bytes.has_value() && other_bytes.has_value()) {
+    return bytes.value() < other_bytes.value();
+  }
+  return isSymbolicallyNoLargerThan(tv, other) &&
+      !isSymbolicallyNoLargerThan(other, tv);
+}
+
+// We can either reshard the inputs of a resharding expression or its output.
+// We reshard the output of single-input expressions, unless their input is
+// cheaper to reshard, e.g., because the expression is a broadcast or an
+// upcast. This delays reshardings past the size-reducing expressions, e.g.,
+// reductions and downcasts. Expressions with several inputs get their inputs
+// resharded: resharding their output would still require the inputs to be
+// sharded alike.
 // We do no support resharding multi-output expressions. Fusions may contain
 // multi-output expressions if they don't require resharding.
 bool shouldReshardAfter(Expr* expr) {
-  return expr->inputs().size() == 1 && expr->outputs().size() == 1;
+  if (expr->inputs().size() != 1 || expr->outputs().size() != 1) {
+    return false;
+  }
+  auto* input = dynamic_cast<TensorView*>(expr->input(0));
+  auto* output = dynamic_cast<TensorView*>(expr->output(0));
+  if (input == nullptr || output == nullptr) {
+    return true;
+  }
+  return !isCheaperToReshard(input, output);
 }
 
 void insertReshardingsBefore(Fusion* fusion) {
@@ -12,9 +12,9 @@
 #include <string>
 
 namespace nvfuser::preseg_passes {
-// Runs through the fusion and inserts a resharding Set Op after
+// Runs through the fusion and inserts a resharding Set Op before or after
 // any resharding Expr that is not directly lowerable to a series of
-// communications
+// communications, whichever moves fewer bytes
 class InsertReshardingsPass : public OptimizationPass<InsertReshardingsPass> {
   friend class OptimizationPass<InsertReshardingsPass>;
 
@@ -13,7 +13,11 @@
 #include <instrumentation.h>
 #include <preseg_passes/add_axioms.h>
 #include <preseg_passes/allocation_order_inference.h>
+#include <preseg_passes/compress_collectives.h>
 #include <preseg_passes/consecutive_cast.h>
+#include <preseg_passes/consecutive_reshape.h>
+#include <preseg_passes/decompose_sharded_reductions.h>
+#include <preseg_passes/decompose_sdpa.h>
 #include <preseg_passes/exact_mapped_extent_substitution.h>
 #include <preseg_passes/insert_reshardings.h>
 #include <preseg_passes/make_resharding_contiguous.h>
@@ -37,14 +41,20 @@ namespace nvfuser::preseg_passes {
 
   // For resharding across GPUs.
   OptimizationPass<PropagateShardingsPass>::runPass(fusion);
+  OptimizationPass<DecomposeShardedReductionsPass>::runPass(fusion);
   OptimizationPass<InsertReshardingsPass>::runPass(fusion);
+  OptimizationPass<CompressCollectivesPass>::runPass(fusion);
   OptimizationPass<ReorderShardedAxisPass>::runPass(fusion);
   OptimizationPass<MakeReshardingContiguousPass>::runPass(fusion);
 
+  // Expose the ops of attention to the passes below and to the segmenter
+  OptimizationPass<DecomposeSdpaPass>::runPass(fusion);
   // Replace TensorViews with zero extent. Outputs and inputs may still be empty
   OptimizationPass<RemoveEmptyPass>::runPass(fusion);
   // removes consecutive cast operations
   OptimizationPass<ConsecutiveCastPass>::runPass(fusion);
+  // composes chains of permutes and of static reshapes
+  OptimizationPass<ConsecutiveReshapePass>::runPass(fusion);
   OptimizationPass<AddAxiomsPass>::runPass(fusion);
   OptimizationPass<MoveSplitCatPass>::runPass(fusion);
   OptimizationPass<MarkAliasesPreparePass>::runPass(fusion);
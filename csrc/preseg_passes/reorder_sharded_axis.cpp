@@ -40,6 +40,39 @@ void ReorderShardedAxisPass::runPass(Fusion* fusion) {
         expr->toString());
     auto* output = expr->outputs().at(0)->as<TensorView>();
     auto* input = expr->inputs().at(0)->as<TensorView>();
+
+    // For AllToAll operations i.e. the sharding moves from one ID to another
+    // Update input to push the scattered axis to the front and the gathered
+    // axis right after it, so that the producer writes the chunks to send one
+    // after the other and the collective receives them in place -> collective
+    // -> permute both axes back to their location.
+    // Example: [i0 DIDx(i1) i2] -> [i0 i1 DIDx(i2)]
+    // Rewritten to: [i0 DIDx(i1) i2] -> [i2 DIDx(i1) i0] ->
+    //                    [DIDx(i2) i1 i0] -> [i0 i1 DIDx(i2)]
+    if (isAllToAll(expr)) {
+      const int64_t scattered_axis = getShardedAxis(output);
+      const int64_t gathered_axis = getShardedAxis(input);
+      if (scattered_axis + gathered_axis == 1) {
+        // Already {0, 1}
+        continue;
+      }
+      TensorView* input_permute =
+          permute(input, {{scattered_axis, 0}, {gathered_axis, 1}});
+      TensorView* output_permute = set(input_permute);
+      TensorView* new_output =
+          permute(output_permute, {{0, scattered_axis}, {1, gathered_axis}});
+      ir_utils::replaceValInAllExprInputsAndFusionOutputs(output, new_output);
+
+      shardAllLike(input, {input_permute, output_permute, new_output});
+      output_permute->axis(1)->parallelize(ParallelType::Serial);
+      output_permute->axis(0)->parallelize(ParallelType::DIDx);
+      new_output->axis(gathered_axis)->parallelize(ParallelType::Serial);
+      new_output->axis(scattered_axis)->parallelize(ParallelType::DIDx);
+      output_permute->setDeviceMesh(output->getDeviceMesh());
+      new_output->setDeviceMesh(output->getDeviceMesh());
+      continue;
+    }
+
     auto [shard_additions, shard_deletions] = getShardingChanges(expr);
     NVF_ERROR(
         shard_additions.size() + shard_deletions.size() <= 1,
@@ -13,15 +13,19 @@
 #include <options.h>
 #include <python_frontend/fusion_cache.h>
 #include <serde/fusion_record.h>
+#include <thread_pool.h>
 #include <utils.h>
 
+#include <algorithm>
 #include <filesystem>
 namespace fs = std::filesystem;
 
 #ifdef _WIN32
 #include <c10/util/win32-headers.h>
 #else
+#include <fcntl.h>
 #include <pthread.h>
+#include <sys/mman.h>
 #include <unistd.h>
 #endif
 
@@ -95,22 +99,67 @@ BinaryBuffer openFusionCache(std::string filename) {
   return buffer;
 }
 
+// [ Note -- Shared workspace ]
+//
+// With NVFUSER_ENABLE=lazy_serde, the workspace file is mapped read-only
+// with MAP_SHARED instead of being read into a private buffer. Every process
+// of a host loading the same workspace, e.g., the default one in the kernel
+// db directory, then shares the pages of the page cache holding it. Pointing
+// TMPDIR to /dev/shm keeps the workspace in shared memory.
+//
+// Kernels are deserialized in place: their modules are loaded straight from
+// the cubin or ptx in the mapping, which is never copied, so each process
+// only owns its CUmodule handles. Cubins are serialized with a 16-byte
+// alignment for that purpose. The trie and the fusion definitions are still
+// rebuilt by each process, as they are object graphs rather than flat data,
+// while lazy deserialization limits the scheduled fusions and kernels to
+// those the process runs.
+
+// Map the FusionCache file read-only, so that only the pages of the
+// flatbuffer that are accessed get read. Returns the mapping, which is
+// unmapped along with its last reference, and its size.
+std::pair<std::shared_ptr<const uint8_t>, size_t> mapFusionCache(
+    std::string filename) {
+  FUSER_PERF_SCOPE("Flatbuffers::mapFusionCache");
+  auto file_size = fs::file_size(fs::path(filename.c_str()));
+  NVF_CHECK(file_size > 0, "FusionCache buffer is empty.");
+#ifdef _WIN32
+  auto buffer = std::make_shared<BinaryBuffer>(openFusionCache(filename));
+  return {std::shared_ptr<const uint8_t>(buffer, buffer->data()), file_size};
+#else
+  int fd = open(filename.c_str(), O_RDONLY);
+  NVF_CHECK(fd != -1, "Failed to open FusionCache buffer.");
+  void* data = mmap(nullptr, file_size, PROT_READ, MAP_SHARED, fd, 0);
+  // The mapping stays valid after closing its file
+  close(fd);
+  NVF_CHECK(data != MAP_FAILED, "Failed to map FusionCache buffer.");
+  return {
+      std::shared_ptr<const uint8_t>(
+          static_cast<const uint8_t*>(data),
+          [file_size](const uint8_t* ptr) {
+            munmap(const_cast<uint8_t*>(ptr), file_size);
+          }),
+      file_size};
+#endif
+}
+
 // This check function only throws errors if strict flag is enabled.
 const serde::FusionCache* verifyFusionCache(
-    const BinaryBuffer& buffer,
+    const uint8_t* buffer,
+    size_t size,
     std::optional<int64_t> device_id) {
   FUSER_PERF_SCOPE("Flatbuffers::verifyFusionCache");
-  auto fusion_cache_buffer = serde::GetFusionCache(buffer.data());
+  auto fusion_cache_buffer = serde::GetFusionCache(buffer);
 
   // Check flatbuffer integrity
-  flatbuffers::Verifier v(buffer.data(), buffer.size());
+  flatbuffers::Verifier v(buffer, size);
   NVF_CHECK(
       fusion_cache_buffer->Verify(v),
       "Failed to verify the integrity of FusionCache buffer.");
 
   // Check schema version
   NVF_CHECK(
-      serde::FusionCacheBufferHasIdentifier(buffer.data()),
+      serde::FusionCacheBufferHasIdentifier(buffer),
       "Failed to verify the schema version of the FusionCache buffer");
 
   // Check device major and minor versions
@@ -118,10 +167,17 @@ const serde::FusionCache* verifyFusionCache(
       ? at::cuda::getDeviceProperties(
             static_cast<c10::DeviceIndex>(device_id.value()))
       : at::cuda::getCurrentDeviceProperties();
+  // With EnableOption::PortableSerde, the kernels serialized on an older
+  // architecture are JIT compiled from their PTX. See Note [Loading kernels of
+  // other architectures] in executor_utils.cpp
+  const std::pair<int64_t, int64_t> device_version = {
+      device_prop->major, device_prop->minor};
+  const std::pair<int64_t, int64_t> buffer_version = {
+      fusion_cache_buffer->device_major(), fusion_cache_buffer->device_minor()};
   NVF_CHECK(
-      device_prop->major == fusion_cache_buffer->device_major() &&
-          device_prop->minor == fusion_cache_buffer->device_minor(),
-      false,
+      device_version == buffer_version ||
+          (isOptionEnabled(EnableOption::PortableSerde) &&
+           device_version > buffer_version),
       "Expected cuda version ",
       device_prop->major,
       ".",
@@ -369,6 +425,14 @@ void FusionCache::print(std::ostream& os) const {
 
 void FusionCache::stats(std::ostream& os) const {
   os << "Total Fusions: " << fusions_.size() << "\n";
+  const auto num_shared = std::count_if(
+      fusions_.begin(), fusions_.end(), [](const auto& schedules) {
+        return schedules->shared_auto_gen_schedules != nullptr;
+      });
+  if (num_shared > 0) {
+    os << "Fusions Sharing the Executor of an Identical Fusion: " << num_shared
+       << "\n";
+  }
 
   // Does not make sense to print stats if the cache is disabled.
   if (!fusions_.empty()) {
@@ -387,6 +451,25 @@ void FusionCache::stats(std::ostream& os) const {
     os << " Cache Hits: " << total_cache_hits;
     os << " Hit Rate: " << hit_rate << "%\n";
   }
+  os << host_times_.toString();
+}
+
+std::string FusionCacheHostTimes::toString() const {
+  std::stringstream ss;
+  auto average_us = [](int64_t time_ns, int64_t calls) {
+    return calls == 0 ? 0.0 : (double)time_ns / (double)calls / 1e3;
+  };
+  ss << "Host Time per Call (us):\n";
+  ss << "\tfinalize_definition: "
+     << average_us(finalize_definition_time_ns, definitions) << " ("
+     << definitions << " calls)\n";
+  ss << "\tinput_conversion: "
+     << average_us(input_conversion_time_ns, executions) << " (" << executions
+     << " calls)\n";
+  ss << "\texecute: " << average_us(execute_time_ns, executions) << "\n";
+  ss << "\toutput_wrapping: "
+     << average_us(output_wrapping_time_ns, executions) << "\n";
+  return ss.str();
 }
 
 void FusionCache::reset() {
@@ -431,6 +514,53 @@ std::optional<TrieNode*> FusionCache::queryChildren(
   }
 }
 
+// Note [Fingerprint of a fusion definition]
+// Looking up a definition in the trie costs one hash map lookup per record,
+// which adds up for large definitions that are re-defined at every step. So
+// FusionDefinition only computes the fingerprint of its records when they are
+// defined, i.e., their hashes combined in order, and FusionCache keeps its
+// terminal nodes by fingerprint. When the definition finishes, its terminal
+// node is found with a single lookup of the fingerprint, which is then
+// verified by comparing the records with the path from the root to the
+// terminal node, so a collision can't return the wrong fusion. The trie is
+// only walked when the fingerprint is not found, to create the missing nodes.
+size_t FusionCache::extendFingerprint(
+    size_t fingerprint,
+    const RecordFunctor* rec) {
+  NVF_CHECK(rec, "Record is null!");
+  hashCombine(fingerprint, rec->cachedHash());
+  return fingerprint;
+}
+
+std::optional<TrieNode*> FusionCache::queryFingerprint(
+    size_t fingerprint,
+    const std::vector<std::unique_ptr<RecordFunctor>>& records) const {
+  auto it = terminal_nodes_by_fingerprint_.find(fingerprint);
+  if (it == terminal_nodes_by_fingerprint_.end()) {
+    return std::nullopt;
+  }
+  for (TrieNode* terminal : it->second) {
+    // Compare the records backwards, from the parent of the terminal node to
+    // the child of the root.
+    TrieNode* node = terminal->parent;
+    auto rec = records.rbegin();
+    while (rec != records.rend() && node != root_.get() &&
+           *node->record == **rec) {
+      node = node->parent;
+      ++rec;
+    }
+    if (rec != records.rend() || node != root_.get()) {
+      continue;
+    }
+    // Count the visits as if the trie had been walked.
+    for (node = terminal; node != root_.get(); node = node->parent) {
+      ++(node->visits);
+    }
+    return terminal;
+  }
+  return std::nullopt;
+}
+
 FusionSchedules* FusionCache::queryFusionSchedules(size_t fusion_id) const {
   NVF_CHECK(
       fusion_id < fusions_.size(),
@@ -531,7 +661,7 @@ TrieNode* FusionCache::createChild(TrieNode* node, RecordFunctor* rec) {
     NVF_CHECK(child, "Created child of TrieNode should not be null!");
     ++(child->visits);
     if (rec->recordType() == serde::RecordType::End) {
-      terminal_nodes_.push_back(node->children[new_rec].get());
+      addTerminalNode(child);
     }
     if (isDebugDumpEnabled(DebugDumpOption::PythonFrontendDebug)) {
       std::stringstream ss;
@@ -568,11 +698,77 @@ UserSchedule* FusionCache::createUserSchedule(
   return &user_scheds[input_id.id].at(device);
 }
 
+void FusionCache::addTerminalNode(TrieNode* node) {
+  NVF_ERROR(node->isTerminal(), "Expected a terminal node!");
+  terminal_nodes_.push_back(node);
+
+  std::vector<const RecordFunctor*> rev_records;
+  for (TrieNode* n = node->parent; n != root_.get(); n = n->parent) {
+    rev_records.push_back(n->record.get());
+  }
+  size_t fingerprint = 0;
+  for (auto it = rev_records.rbegin(); it != rev_records.rend(); ++it) {
+    fingerprint = extendFingerprint(fingerprint, *it);
+  }
+  terminal_nodes_by_fingerprint_[fingerprint].push_back(node);
+}
+
+// Note [Deduplication of fusions]
+//
+// The trie only matches definitions made of the same records in the same
+// order, so the definitions of the identical layers of a model often reach
+// different terminal nodes, e.g. when their ops are recorded in different
+// orders or when dead records differ, and each of them would concretize,
+// segment, schedule and compile the same fusion in its own
+// FusionExecutorCache. Once the Fusion IR of a new terminal node is built,
+// deduplicateFusion looks for an earlier fusion with the same canonical form,
+// see Note [Canonical form of a fusion] in fusion.cpp, and runs the new fusion
+// with the FusionExecutorCache of that fusion. The inputs and outputs of both
+// fusions are in the same order, so the outputs are returned as if the new
+// fusion had been run. The new fusion keeps its own FusionExecutorCache for
+// its Fusion IR, which FusionDefinition uses to map its states, and for user
+// schedules. The canonical forms are compared in full to guard against hash
+// collisions. DisableOption::FusionDeduplication turns this off.
+void FusionCache::deduplicateFusion(size_t fusion_id) {
+  FUSER_PERF_SCOPE("FusionCache::deduplicateFusion");
+  if (isOptionDisabled(DisableOption::FusionDeduplication)) {
+    return;
+  }
+  FusionSchedules* schedules = queryFusionSchedules(fusion_id);
+  std::string canonical_form = schedules->preschedFusion()->canonicalForm();
+  auto& bucket =
+      fusions_by_canonical_form_[std::hash<std::string>()(canonical_form)];
+  for (const auto& [other_form, other_id] : bucket) {
+    if (other_form == canonical_form) {
+      schedules->shared_auto_gen_schedules =
+          queryFusionSchedules(other_id)->auto_gen_schedules.get();
+      if (isDebugDumpEnabled(DebugDumpOption::PythonFrontendDebug)) {
+        debug() << "\nFusionCache: Fusion " << fusion_id
+                << " runs with the FusionExecutorCache of fusion " << other_id
+                << "\n";
+      }
+      return;
+    }
+  }
+  bucket.emplace_back(std::move(canonical_form), fusion_id);
+}
+
 TrieNode* FusionCache::rootTriePtr() {
   ++(root_.get()->visits);
   return root_.get();
 }
 
+// [ Note -- Chunked serialization ]
+//
+// A FlatBufferBuilder can't be shared by threads, and the FusionExecutorCaches
+// hold most of the serialized cache, i.e., the compiled kernels. Each of them
+// is therefore serialized into its own flatbuffer, a chunk, on the thread
+// pool, and the chunks are nested in the FusionCache table. Each chunk is
+// released as soon as it has been copied. A chunk keeps the alignment of its
+// content, so the cubins of a mapped workspace remain 16-byte aligned, see
+// [ Note -- Shared workspace ]. A nested chunk is read like any other table,
+// so the deserialization, lazy or not, is unchanged otherwise.
+
 void FusionCache::serialize(std::string filename) const {
   FUSER_PERF_SCOPE("FusionCache::serialize");
   flatbuffers::FlatBufferBuilder builder(1024);
@@ -615,22 +811,62 @@ void FusionCache::serialize(std::string filename) const {
   }
 
   // 4. Map the terminal nodes to their BFS positions.
-  // 5. Serialize each FusionExecutorCache for each fusion.
   std::vector<size_t> terminal_node_idx;
   terminal_node_idx.reserve(terminal_nodes_.size());
-
-  using fb_fusion_executor_cache =
-      flatbuffers::Offset<serde::FusionExecutorCache>;
-  std::vector<fb_fusion_executor_cache> fb_auto_gen_schedules;
-  fb_auto_gen_schedules.reserve(terminal_nodes_.size());
-
   for (auto node : terminal_nodes_) {
     terminal_node_idx.push_back(
         map_record_functor_to_trie_node_id.at(node->record.get()));
+  }
+
+  // 5. Serialize each FusionExecutorCache for each fusion into its own
+  // flatbuffer, in parallel, and copy the chunks into the FusionCache. See
+  // [ Note -- Chunked serialization ]
+  std::vector<flatbuffers::FlatBufferBuilder> fec_builders(
+      terminal_nodes_.size());
+  auto serialize_fec = [this, &fec_builders](size_t idx) {
+    auto schedule = queryFusionSchedules(terminal_nodes_.at(idx)->fusion_id);
+    schedule->auto_gen_schedules->ensureDeserialized();
+    flatbuffers::FlatBufferBuilder& fec_builder = fec_builders.at(idx);
+    fec_builder.Finish(schedule->auto_gen_schedules->serialize(fec_builder));
+  };
+
+  if (!isOptionDisabled(DisableOption::ParallelSerde)) {
+    std::atomic<bool> detect_exception_in_thread_pool{false};
+    TaskGroup serializations;
+    for (auto idx : c10::irange(terminal_nodes_.size())) {
+      serializations.run([=, &detect_exception_in_thread_pool]() {
+        FUSER_PERF_SCOPE("FusionCache::serializeFusionParallel");
+        try {
+          serialize_fec(idx);
+        } catch (const std::exception& e) {
+          detect_exception_in_thread_pool.store(true);
+        }
+      });
+    }
+    serializations.wait();
+    NVF_ERROR(
+        !detect_exception_in_thread_pool.load(),
+        "Detected exception while serializing fusions in parallel.\n",
+        "Use NVFUSER_DISABLE=parallel_serde to print exception message.");
+  } else {
+    FUSER_PERF_SCOPE("FusionCache::serializeFusionSerial");
+    for (auto idx : c10::irange(terminal_nodes_.size())) {
+      serialize_fec(idx);
+    }
+  }
 
-    auto schedule = queryFusionSchedules(node->fusion_id);
-    fb_auto_gen_schedules.emplace_back(
-        schedule->auto_gen_schedules->serialize(builder));
+  std::vector<flatbuffers::Offset<serde::FusionExecutorCacheChunk>>
+      fb_auto_gen_schedules;
+  fb_auto_gen_schedules.reserve(terminal_nodes_.size());
+  for (flatbuffers::FlatBufferBuilder& fec_builder : fec_builders) {
+    auto chunk = fec_builder.GetBufferSpan();
+    builder.ForceVectorAlignment(
+        chunk.size(), sizeof(uint8_t), fec_builder.GetBufferMinAlignment());
+    auto fb_chunk = builder.CreateVector(chunk.data(), chunk.size());
+    fb_auto_gen_schedules.push_back(
+        serde::CreateFusionExecutorCacheChunk(builder, fb_chunk));
+    // The chunk has been copied, so release its memory right away
+    fec_builder.Reset();
   }
 
   auto device_prop = at::cuda::getCurrentDeviceProperties();
@@ -671,9 +907,20 @@ void FusionCache::deserialize(std::string filename) {
   NVF_CHECK(
       fusions_.empty(),
       "Deserialization is prohibited if FusionCache is already populated.");
-  const BinaryBuffer& buffer = openFusionCache(filename);
-  const serde::FusionCache* fusion_cache_buffer =
-      verifyFusionCache(buffer, device_id_);
+  // See [ Note -- Lazy deserialization ] in kernel_cache.cpp
+  const bool lazy = isOptionEnabled(EnableOption::LazySerde);
+  BinaryBuffer buffer;
+  const serde::FusionCache* fusion_cache_buffer = nullptr;
+  if (lazy) {
+    auto [mapping, size] = mapFusionCache(filename);
+    serde_buffer_ = std::move(mapping);
+    fusion_cache_buffer =
+        verifyFusionCache(serde_buffer_.get(), size, device_id_);
+  } else {
+    buffer = openFusionCache(filename);
+    fusion_cache_buffer =
+        verifyFusionCache(buffer.data(), buffer.size(), device_id_);
+  }
 
   // See table definition for FusionCache in serde/fusion_cache.fbs
   FUSER_PERF_SCOPE("FusionCache::deserialize");
@@ -741,7 +988,7 @@ void FusionCache::deserialize(std::string filename) {
           "The fusion id for this TrieNode should already be set.")
       Fusion* fusion =
           queryFusionSchedules(fb_trie_node->fusion_id())->preschedFusion();
-      state->buildFusionIr(fusion);
+      state->buildFusionIr(fusion, /*simplify=*/true);
     }
 
     // Table TrieNode => Field: children: [ulong]
@@ -775,19 +1022,32 @@ void FusionCache::deserialize(std::string filename) {
     state_queue.pop_front();
   }
 
+  // In the order of the fusion ids, so that the fusions that were run with
+  // their own FusionExecutorCache, which holds the serialized kernels, are
+  // found first
+  for (auto fusion_id : c10::irange(fusions_.size())) {
+    deduplicateFusion(fusion_id);
+  }
+
   std::atomic<bool> detect_exception_in_thread_pool{false};
+  TaskGroup deserializations;
   // Deserialize terminal_nodes field in the FusionCache table
   for (auto idx : c10::irange(fusions_.size())) {
     auto node_idx = fusion_cache_buffer->terminal_nodes()->Get(idx);
     auto trie_node = bfs_order.at(node_idx);
-    terminal_nodes_.push_back(trie_node);
+    addTerminalNode(trie_node);
 
-    auto fb_fec_node = fusion_cache_buffer->auto_gen_schedules()->Get(idx);
+    auto fb_fec_node = fusion_cache_buffer->auto_gen_schedules()
+                           ->Get(idx)
+                           ->buffer_nested_root();
     auto fusion_schedule = queryFusionSchedules(trie_node->fusion_id);
 
-    if (!isOptionDisabled(DisableOption::ParallelSerde)) {
+    if (lazy) {
+      fusion_schedule->auto_gen_schedules->deserialize(
+          fb_fec_node, (int64_t)trie_node->fusion_id, /*lazy=*/true);
+    } else if (!isOptionDisabled(DisableOption::ParallelSerde)) {
       // Parallelize the deserialization of each FusionExecutorCache.
-      getThreadPool()->run([=, &detect_exception_in_thread_pool]() {
+      deserializations.run([=, &detect_exception_in_thread_pool]() {
         FUSER_PERF_SCOPE("FusionCache::deserializeFusionParallel");
         try {
           fusion_schedule->auto_gen_schedules->deserialize(
@@ -805,9 +1065,9 @@ void FusionCache::deserialize(std::string filename) {
     }
   }
 
-  if (!isOptionDisabled(DisableOption::ParallelSerde)) {
+  if (!lazy && !isOptionDisabled(DisableOption::ParallelSerde)) {
     // Wait until all fusion executor caches are deserialized
-    getThreadPool()->waitWorkComplete();
+    deserializations.wait();
     NVF_ERROR(
         !detect_exception_in_thread_pool.load(),
         "Detected exception while deserializing fusions in parallel.\n",
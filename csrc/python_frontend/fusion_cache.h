@@ -13,8 +13,12 @@
 #include <python_frontend/fusion_record.h>
 #include <scheduler/registry.h>
 
+#include <chrono>
 #include <memory>
 #include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
 
 namespace nvfuser::python_frontend {
 
@@ -71,9 +75,20 @@ struct FusionSchedules {
   FusionSchedules(int64_t fusion_id = 0);
   Fusion* preschedFusion();
 
+  //! Returns the FusionExecutorCache the fusion is run with, which is the
+  //! one of an earlier identical fusion if any
+  FusionExecutorCache* autoGenSchedules() {
+    return shared_auto_gen_schedules != nullptr ? shared_auto_gen_schedules
+                                                : auto_gen_schedules.get();
+  }
+
   //! Schedules Automatically generated by nvFuser for dynamic inputs. (default)
   //! NOTE: The FusionExecutorCache also holds the Unscheduled Fusion IR
   std::unique_ptr<FusionExecutorCache> auto_gen_schedules;
+  //! The auto_gen_schedules of an earlier fusion with the same canonical
+  //! form, which this fusion is run with. See Note [Deduplication of
+  //! fusions] in fusion_cache.cpp.
+  FusionExecutorCache* shared_auto_gen_schedules = nullptr;
   //! Schedules defined by the user for specific input sizes.
   //! They are also generated per device as all devices may not be the same.
   //! Key:   Input Encoding hash of Fusion inputs as is created by the
@@ -127,6 +142,52 @@ struct TrieNode {
   std::mutex trie_node_lock;
 };
 
+//! \struct FusionCacheHostTimes
+//! \brief Host time spent in each layer of the python frontend, summed over
+//! the calls since the FusionCache was created or reset. The timers are two
+//! steady_clock reads per layer, so they are always collected. They isolate
+//! the per-call overhead of the frontend, which dominates small kernels.
+struct FusionCacheHostTimes {
+  //! Calls of FusionDefinition::finalizeDefinition, i.e. lookups of a
+  //! definition in the trie, and their time, which includes building the
+  //! Fusion IR of the definitions not found
+  int64_t definitions = 0;
+  int64_t finalize_definition_time_ns = 0;
+  //! Calls of FusionDefinition._execute and _execute_async from python
+  int64_t executions = 0;
+  //! Conversion of the python inputs to IValues
+  int64_t input_conversion_time_ns = 0;
+  //! FusionDefinition::execute, i.e. the FusionExecutorCache lookup, the
+  //! kernel launches and the allocation of the outputs. Async executions run
+  //! on the thread pool and are not counted.
+  int64_t execute_time_ns = 0;
+  //! Conversion of the output tensors to python objects
+  int64_t output_wrapping_time_ns = 0;
+
+  NVF_API std::string toString() const;
+};
+
+//! Adds the host time from its construction to its destruction to `time_ns`
+class ScopedHostTime {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit ScopedHostTime(int64_t& time_ns)
+      : time_ns_(time_ns), start_(Clock::now()) {}
+  ~ScopedHostTime() {
+    time_ns_ += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    Clock::now() - start_)
+                    .count();
+  }
+
+  ScopedHostTime(const ScopedHostTime&) = delete;
+  ScopedHostTime& operator=(const ScopedHostTime&) = delete;
+
+ private:
+  int64_t& time_ns_;
+  Clock::time_point start_;
+};
+
 //! \class FusionCache
 //! \brief A singleton class used in the nvFuser python interface
 //! to manage the caching of fusions.
@@ -170,8 +231,12 @@ class FusionCache {
   NVF_API std::optional<int64_t> deviceId() const;
   //! print cache contents
   NVF_API void print(std::ostream& os) const;
-  //! print cache stats
+  //! print cache stats, including the host times of the frontend
   NVF_API void stats(std::ostream& os) const;
+  //! Host times of the frontend, see FusionCacheHostTimes
+  NVF_API FusionCacheHostTimes& hostTimes() {
+    return host_times_;
+  }
   //! Reset Cache to an empty state
   NVF_API static void reset();
 
@@ -187,6 +252,18 @@ class FusionCache {
   NVF_API std::optional<TrieNode*> queryChildren(
       TrieNode* node,
       RecordFunctor* rec) const;
+  //! Returns the fingerprint of a definition extended with `rec`. The
+  //! fingerprint of an empty definition is 0. See Note [Fingerprint of a
+  //! fusion definition] in the cpp file.
+  NVF_API static size_t extendFingerprint(
+      size_t fingerprint,
+      const RecordFunctor* rec);
+  //! Thread-Unsafe: Queries the terminal node of the definition made of
+  //! `records`, whose fingerprint is `fingerprint`, without walking the trie
+  //! from the root
+  NVF_API std::optional<TrieNode*> queryFingerprint(
+      size_t fingerprint,
+      const std::vector<std::unique_ptr<RecordFunctor>>& records) const;
   //! Query a Fusion's Schedules based on fusion id or cache id
   FusionSchedules* queryFusionSchedules(size_t fusion_id) const;
   //! Determine if a user schedule exists for given inputs.
@@ -208,6 +285,11 @@ class FusionCache {
   //! Thread-Safe: Creates a child node for the current cache entry and an
   //! optional fusion_id is returned if the new entry is terminal
   NVF_API TrieNode* createChild(TrieNode* node, RecordFunctor* rec);
+  //! Thread-Unsafe: Runs the fusion of `fusion_id`, whose Fusion IR is
+  //! built, with the FusionExecutorCache of an earlier fusion with the same
+  //! canonical form, if any. See Note [Deduplication of fusions] in the cpp
+  //! file.
+  void deduplicateFusion(size_t fusion_id);
   //! Lookup the User Schedule based on Id
   UserSchedule* createUserSchedule(
       FusionSchedules* scheds,
@@ -217,6 +299,10 @@ class FusionCache {
   NVF_API TrieNode* rootTriePtr();
 
  private:
+  //! Adds a new terminal node to terminal_nodes_ and
+  //! terminal_nodes_by_fingerprint_
+  void addTerminalNode(TrieNode* node);
+
   //! The static pointer to the FusionCache
   static FusionCache* singleton_;
   //! Lock for accessing the singleton by multiple threads
@@ -234,6 +320,16 @@ class FusionCache {
   std::vector<std::unique_ptr<FusionSchedules>> fusions_;
   //! A vector of Terminal trie nodes for Stats collection
   std::vector<TrieNode*> terminal_nodes_;
+  //! The terminal trie nodes by the fingerprint of their definition
+  std::unordered_map<size_t, std::vector<TrieNode*>>
+      terminal_nodes_by_fingerprint_;
+  //! The canonical forms and ids of the fusions run with their own
+  //! FusionExecutorCache, by the hash of their canonical form
+  std::unordered_map<size_t, std::vector<std::pair<std::string, size_t>>>
+      fusions_by_canonical_form_;
+  //! Serialized cache kept alive for the FusionExecutorCaches deserialized
+  //! lazily, see EnableOption::LazySerde
+  std::shared_ptr<const uint8_t> serde_buffer_;
 
   //! Items specifically to aid user defined schedules these data members
   //! are for the mechanics of user schedule usage and don't make sense as
@@ -243,6 +339,9 @@ class FusionCache {
   // NOTE: I would prefer this be per FusionSchedules object but the container
   // is not allowed to be copied or moved.
   InputsIdLookup user_def_input_encodings_;
+
+  //! Host times of the frontend since the cache was created or reset
+  FusionCacheHostTimes host_times_;
 };
 
 //! Serialize Fusion Cache to common workspace
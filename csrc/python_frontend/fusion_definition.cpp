@@ -5,6 +5,9 @@
  * SPDX-License-Identifier: BSD-3-Clause
  */
 // clang-format on
+#include <ATen/cuda/CUDAContext.h>
+#include <c10/cuda/CUDAGuard.h>
+
 #include <debug.h>
 #include <executor_kernel_arg.h>
 #include <fusion_profiler.h>
@@ -42,6 +45,8 @@ const char* dtypeToPyString(PrimDataType t) {
       return "DataType.Int";
     case DataType::Int32:
       return "DataType.Int32";
+    case DataType::Int8:
+      return "DataType.Int8";
     case DataType::ComplexFloat:
       return "DataType.ComplexFloat";
     case DataType::ComplexDouble:
@@ -80,7 +85,17 @@ FusionDefinition* FusionDefinition::setupDefinition() {
 
 void FusionDefinition::finalizeDefinition() {
   FUSER_PERF_SCOPE("FusionDefinition::finalizeDefinition");
-  auto child_node = fusionCache()->queryChildren(trie_node_, end_record_.get());
+  FusionCacheHostTimes& host_times = fusionCache()->hostTimes();
+  host_times.definitions++;
+  ScopedHostTime host_time(host_times.finalize_definition_time_ns);
+  // See Note [Fingerprint of a fusion definition] in fusion_cache.cpp
+  auto child_node = fusionCache()->queryFingerprint(fingerprint_, recording_);
+  if (!child_node.has_value()) {
+    for (auto& record : recording_) {
+      walkTrie(record.get());
+    }
+    child_node = fusionCache()->queryChildren(trie_node_, end_record_.get());
+  }
   if (!child_node.has_value()) {
     if (isDebugDumpEnabled(DebugDumpOption::PythonFrontendDebug)) {
       debug() << "\nFusionDefinition: Terminal Node not found.\n";
@@ -93,7 +108,9 @@ void FusionDefinition::finalizeDefinition() {
       print(debug());
     }
 
-    buildFusionIr(preschedFusion());
+    buildFusionIr(preschedFusion(), /*simplify=*/true);
+    // See Note [Deduplication of fusions] in fusion_cache.cpp
+    fusionCache()->deduplicateFusion(id().value());
 
     if (isDebugDumpEnabled(DebugDumpOption::FusionIrOriginal)) {
       printIr();
@@ -283,7 +300,8 @@ std::vector<at::Tensor> FusionDefinition::execute(
     std::optional<int8_t> selected_device,
     bool override_user_schedule,
     bool capture_debug_output,
-    bool profile) const {
+    bool profile,
+    const std::vector<at::Tensor>& output_buffers) const {
   debug_output_ = std::nullopt;
   std::stringstream debug_ss;
   DebugStreamGuard dsg(capture_debug_output ? debug_ss : std::cout);
@@ -293,6 +311,9 @@ std::vector<at::Tensor> FusionDefinition::execute(
   auto scheds = fusionCache()->queryFusionSchedules(id().value());
 
   if (multidevice_executor_) {
+    NVF_CHECK(
+        output_buffers.empty(),
+        "Output buffers are not supported by multidevice execution");
     return multidevice_executor_->runWithInput(inputs.vec());
   }
 
@@ -308,6 +329,9 @@ std::vector<at::Tensor> FusionDefinition::execute(
         "Inputs are not all on the same device or don't match selection!");
     auto user_sched_id = fusionCache()->queryUserScheduleId(scheds, inputs);
     if (user_sched_id.has_value()) {
+      NVF_CHECK(
+          output_buffers.empty(),
+          "Output buffers are not supported by user schedules");
       if (isProfilerEnabledWithCupti()) {
         FusionProfiler::start();
         FusionProfiler::createSegments(1);
@@ -353,6 +377,9 @@ std::vector<at::Tensor> FusionDefinition::execute(
         if (isProfilerPrintingEnabled()) {
           debug() << FusionProfiler::profile();
         }
+        if (isProfilerPrintingRoofline()) {
+          debug() << FusionProfiler::profile().rooflineReport();
+        }
       }
     }
   }
@@ -361,8 +388,8 @@ std::vector<at::Tensor> FusionDefinition::execute(
   // already at this point and we would not want to overwrite generated output
   // through user scheduled kernel.
   if (outputs.empty()) {
-    outputs = scheds->auto_gen_schedules->runFusionWithInputs(
-        inputs, std::nullopt, selected_device);
+    outputs = scheds->autoGenSchedules()->runFusionWithInputs(
+        inputs, std::nullopt, selected_device, output_buffers);
   }
   if (profile) {
     ProfilerOptionsGuard::getCurOptions().unset(ProfilerOption::Enable);
@@ -375,6 +402,86 @@ std::vector<at::Tensor> FusionDefinition::execute(
   return outputs;
 }
 
+// [ Note -- Async execution ]
+//
+// FusionDefinition::execute runs the host work of an execution, i.e. the input
+// id lookup, the argument packing, any segmentation and compilation, the
+// output allocation and the launches, on the calling thread, so a python
+// caller with many independent fusions serializes it. executeAsync instead
+// runs FusionExecutorCache::runFusionWithInputs as a task of the thread pool,
+// see [ Note -- Concurrent runs ] in kernel_cache.cpp, and returns right
+// away. The task runs on the current stream of the caller at the time of the
+// call, so its kernels are ordered after the work the caller enqueued before
+// and the outputs are allocated on that stream. Executions on the same stream
+// are enqueued in the order their tasks run, not in the order of the calls,
+// which is fine since an execution consuming the outputs of another needs
+// its result first anyway.
+//
+// The FusionDefinition and the FusionCache are not thread safe, so the
+// schedules are looked up on the calling thread. Executions with a user
+// schedule or a multidevice executor run on the calling thread as well and
+// return a finished AsyncExecution.
+
+bool AsyncExecution::done() const {
+  return outputs_.wait_for(std::chrono::seconds(0)) ==
+      std::future_status::ready;
+}
+
+std::vector<at::Tensor> AsyncExecution::result() {
+  if (group_ != nullptr) {
+    group_->wait();
+  }
+  return outputs_.get();
+}
+
+AsyncExecution FusionDefinition::executeAsync(
+    const at::ArrayRef<c10::IValue>& inputs,
+    std::optional<int8_t> selected_device,
+    bool override_user_schedule,
+    const std::vector<at::Tensor>& output_buffers) const {
+  NVF_CHECK(id().has_value(), "Valid fusion schedule is not available!");
+  auto scheds = fusionCache()->queryFusionSchedules(id().value());
+  auto device = getCommonDeviceCUDA(inputs, selected_device);
+  NVF_CHECK(
+      inputs.empty() || device > -1,
+      "Inputs are not all on the same device or don't match selection!");
+
+  AsyncExecution execution;
+  if (multidevice_executor_ != nullptr ||
+      (!override_user_schedule &&
+       fusionCache()->queryUserScheduleId(scheds, inputs).has_value())) {
+    std::promise<std::vector<at::Tensor>> outputs;
+    try {
+      outputs.set_value(execute(
+          inputs,
+          selected_device,
+          override_user_schedule,
+          /*capture_debug_output=*/false,
+          /*profile=*/false,
+          output_buffers));
+    } catch (...) {
+      outputs.set_exception(std::current_exception());
+    }
+    execution.outputs_ = outputs.get_future().share();
+    return execution;
+  }
+
+  auto task = std::make_shared<std::packaged_task<std::vector<at::Tensor>()>>(
+      [executor_cache = scheds->autoGenSchedules(),
+       stream = at::cuda::getCurrentCUDAStream(device),
+       inputs = inputs.vec(),
+       selected_device,
+       output_buffers]() {
+        c10::cuda::CUDAStreamGuard stream_guard(stream);
+        return executor_cache->runFusionWithInputs(
+            inputs, std::nullopt, selected_device, output_buffers);
+      });
+  execution.outputs_ = task->get_future().share();
+  execution.group_ = std::make_unique<TaskGroup>(TaskPriority::Normal);
+  execution.group_->run([task]() { (*task)(); });
+  return execution;
+}
+
 std::string FusionDefinition::fusionIr() {
   NVF_CHECK(id().has_value(), "Invalid fusion definition!");
   std::stringstream ss;
@@ -419,11 +526,38 @@ std::string FusionDefinition::lastCudaCode(
       result = user_exec->kernelString();
     }
   } else {
-    result = scheds->auto_gen_schedules->getMostRecentCode(intrinsic_code);
+    result = scheds->autoGenSchedules()->getMostRecentCode(intrinsic_code);
   }
   return result;
 }
 
+void FusionDefinition::warmup(
+    const std::vector<std::vector<c10::IValue>>& input_sets,
+    int8_t device) const {
+  NVF_CHECK(id().has_value(), "Invalid fusion definition!");
+  auto scheds = fusionCache()->queryFusionSchedules(id().value());
+  scheds->autoGenSchedules()->warmup(input_sets, device);
+}
+
+FusionExecutorCacheMetrics FusionDefinition::metrics(bool reset) const {
+  NVF_CHECK(id().has_value(), "Invalid fusion definition!");
+  auto scheds = fusionCache()->queryFusionSchedules(id().value());
+  FusionExecutorCacheMetrics metrics = scheds->autoGenSchedules()->metrics();
+  if (reset) {
+    scheds->autoGenSchedules()->resetMetrics();
+  }
+  return metrics;
+}
+
+std::vector<KernelResourceUsage> FusionDefinition::resourceUsage() const {
+  NVF_CHECK(id().has_value(), "Invalid fusion definition!");
+  auto scheds = fusionCache()->queryFusionSchedules(id().value());
+  FusionKernelRuntime* runtime =
+      scheds->autoGenSchedules()->getMostRecentKernelRuntime();
+  NVF_CHECK(runtime != nullptr, "Fusion has not been executed!");
+  return runtime->resourceUsage();
+}
+
 std::string FusionDefinition::cudaCodeFor(
     const at::ArrayRef<c10::IValue>& inputs,
     bool intrinsic_code,
@@ -449,7 +583,7 @@ std::string FusionDefinition::cudaCodeFor(
       }
     }
   }
-  return scheds->auto_gen_schedules->getCodeFor(inputs, intrinsic_code);
+  return scheds->autoGenSchedules()->getCodeFor(inputs, intrinsic_code);
 }
 
 std::string FusionDefinition::lastScheduledFusionIr(
@@ -466,7 +600,7 @@ std::string FusionDefinition::lastScheduledFusionIr(
     result = ss.str();
   } else {
     result =
-        scheds->auto_gen_schedules->getMostRecentScheduledIr(tensor_transforms);
+        scheds->autoGenSchedules()->getMostRecentScheduledIr(tensor_transforms);
   }
   return result;
 }
@@ -493,7 +627,7 @@ std::string FusionDefinition::scheduledFusionIrFor(
       return ss.str();
     }
   }
-  return scheds->auto_gen_schedules->getScheduledIrFor(
+  return scheds->autoGenSchedules()->getScheduledIrFor(
       inputs, tensor_transforms);
 }
 
@@ -556,8 +690,14 @@ void FusionDefinition::defineRecord(RecordFunctor* record) {
       "operations.  The max_length for FusionDefintion's might need to be ",
       "increased if the definition is created as expected.");
   addRecord(record);
-  auto child_node =
-      fusionCache()->queryChildren(trie_node_, recording_.back().get());
+  // The trie is only walked by finalizeDefinition, if the fingerprint of the
+  // whole definition is not found.
+  fingerprint_ =
+      FusionCache::extendFingerprint(fingerprint_, recording_.back().get());
+}
+
+void FusionDefinition::walkTrie(RecordFunctor* record) {
+  auto child_node = fusionCache()->queryChildren(trie_node_, record);
   // If the Record is found in the cache, the FusionDefinition and the Cache
   // will not share Record given the Record had to be created in order to
   // match it but it also already existed in the cache.
@@ -573,8 +713,7 @@ void FusionDefinition::defineRecord(RecordFunctor* record) {
       debug() << "\nFusionDefinition: Record (hash: 0x" << std::hex
               << record->hash() << ") missed in Fusion Cache.\n";
     }
-    trie_node_ =
-        fusionCache()->createChild(trie_node_, recording_.back().get());
+    trie_node_ = fusionCache()->createChild(trie_node_, record);
   }
 }
 
@@ -7,11 +7,14 @@
 // clang-format on
 #pragma once
 #include <exceptions.h>
+#include <future>
 #include <iostream>
+#include <memory>
 
 #include <kernel_cache.h>
 #include <multidevice/executor.h>
 #include <python_frontend/fusion_state.h>
+#include <thread_pool.h>
 #include <visibility.h>
 
 namespace nvfuser::python_frontend {
@@ -24,6 +27,29 @@ struct RecordFunctor;
 struct UserSchedule;
 struct TrieNode;
 
+//! Handle of an execution started with FusionDefinition::executeAsync,
+//! similar to a std::future of its outputs
+class AsyncExecution {
+ public:
+  //! Whether the host work of the execution is finished, i.e. whether
+  //! result() returns without blocking. Its kernels may still be running on
+  //! the stream of the execution.
+  NVF_API bool done() const;
+
+  //! Waits for the host work of the execution and returns its outputs, or
+  //! rethrows its error. If no worker started the execution yet, it runs on
+  //! the calling thread. As with FusionDefinition::execute, the outputs are
+  //! ready once the kernels enqueued on the stream of the execution finish.
+  NVF_API std::vector<at::Tensor> result();
+
+ private:
+  friend class FusionDefinition;
+
+  //! The task of the execution, or nullptr if it ran on the calling thread
+  std::unique_ptr<TaskGroup> group_;
+  std::shared_future<std::vector<at::Tensor>> outputs_;
+};
+
 //! This is helper function used to print a python formated
 //! Fusion IR DataType when printing a fusion definition.
 
@@ -182,13 +208,38 @@ class NVF_API FusionDefinition : public FusionState {
   NVF_API void finalizeSchedule(const at::ArrayRef<c10::IValue>& inputs);
   //! Prints a python function representing the definition
   NVF_API void print(std::ostream& os) const;
-  //! Executes a fusion if a valid definition or cache lookup occurred prior
+  //! Executes a fusion if a valid definition or cache lookup occurred prior.
+  //! Outputs are written to `output_buffers` if given, see
+  //! FusionExecutorCache::runFusionWithInputs.
   NVF_API std::vector<at::Tensor> execute(
       const at::ArrayRef<c10::IValue>& inputs,
       std::optional<int8_t> device,
       bool override_user_schedule,
       bool capture_debug_output,
-      bool profile) const;
+      bool profile,
+      const std::vector<at::Tensor>& output_buffers = {}) const;
+  //! Same as execute without debug output capture or profiling, but runs the
+  //! input id lookup, the argument packing and any compilation on the
+  //! thread pool, and enqueues the kernels on the current stream of the
+  //! caller. The FusionDefinition must outlive the returned execution. See
+  //! [ Note -- Async execution ] in fusion_definition.cpp.
+  NVF_API AsyncExecution executeAsync(
+      const at::ArrayRef<c10::IValue>& inputs,
+      std::optional<int8_t> device,
+      bool override_user_schedule,
+      const std::vector<at::Tensor>& output_buffers = {}) const;
+  //! Compiles the automatically scheduled fusion ahead of time for each of
+  //! the given input sets. Tensor inputs may be meta tensors. See
+  //! FusionExecutorCache::warmup.
+  NVF_API void warmup(
+      const std::vector<std::vector<c10::IValue>>& input_sets,
+      int8_t device) const;
+  //! Return the counters of the automatically scheduled fusion collected with
+  //! NVFUSER_ENABLE=runtime_metrics, optionally resetting them
+  NVF_API FusionExecutorCacheMetrics metrics(bool reset) const;
+  //! Return the resource usage of the kernels of the most recent run of the
+  //! automatically scheduled fusion, see FusionKernelRuntime::resourceUsage
+  NVF_API std::vector<KernelResourceUsage> resourceUsage() const;
   //! Return debugging output captured through exeuction with
   //! capture_debug_output=true
   std::optional<std::string> getDebugOutput() const {
@@ -253,6 +304,9 @@ class NVF_API FusionDefinition : public FusionState {
  private:
   //! Returns the FusionCache Ptr that holds the cache of Fusions
   FusionCache* fusionCache() const;
+  //! Moves trie_node_ to its child holding `record`, which is created if
+  //! needed
+  void walkTrie(RecordFunctor* record);
   //! Return a prescheduled Fusion object
   Fusion* preschedFusion();
   //! Composite operations can create hidden TensorViews in the CPP fusion
@@ -273,6 +327,9 @@ class NVF_API FusionDefinition : public FusionState {
   FusionCache* fusion_cache_;
   //! Current pointer to node in FusionCache.
   TrieNode* trie_node_;
+  //! Fingerprint of the records defined so far, see
+  //! FusionCache::extendFingerprint
+  size_t fingerprint_ = 0;
 
   // Book keeping data members for user created schedules
 
@@ -21,6 +21,7 @@
 
 #include <algorithm>
 #include <complex>
+#include <optional>
 #include <variant>
 
 namespace nvfuser::python_frontend {
@@ -68,7 +69,8 @@ struct RecordFunctor {
         outputs_(other.outputs_),
         name_(other.name_),
         record_type_(other.record_type_),
-        inline_def_(other.inline_def_) {
+        inline_def_(other.inline_def_),
+        cached_hash_(other.cached_hash_) {
     // Set this Record as the parent of each output
     if (inline_def_) {
       for (auto& out : outputs_) {
@@ -98,6 +100,16 @@ struct RecordFunctor {
         ((output_hash & 0xff) << 48) | ((arg_hash & 0xffff) << 32);
   }
 
+  //! The hash of the record, only computed once. The FusionCache hashes a
+  //! record for every lookup of a child TrieNode and for the fingerprint of
+  //! the definition, and records do not change once they are constructed.
+  size_t cachedHash() const {
+    if (!cached_hash_.has_value()) {
+      cached_hash_ = hash();
+    }
+    return cached_hash_.value();
+  }
+
   //! The base virtual equality operator is defined so all child
   //! classes can utilize the check for the same args and outputs.
   virtual bool operator==(const RecordFunctor& other) const {
@@ -260,6 +272,8 @@ struct RecordFunctor {
   //! Whether this record type returns a tuple of unknown length. This is only
   //! used for TensorSizesRecord.
   bool always_returns_tuple_ = false;
+  //! Result of hash(), see cachedHash()
+  mutable std::optional<size_t> cached_hash_;
 };
 
 //! The OpRecord RecordFunctor is the most widely used child class because
@@ -2963,7 +2977,7 @@ template <>
 struct hash<RecordFunctor*> {
   size_t operator()(const RecordFunctor* p) const {
     NVF_CHECK(p, "The RecordFunctor Pointer for hashing is null!");
-    return p->hash();
+    return p->cachedHash();
   }
 };
 template <>
@@ -6,10 +6,18 @@
  */
 // clang-format on
 #include <instrumentation.h>
+#include <ir/builder.h>
+#include <ir/utils.h>
+#include <options.h>
 #include <python_frontend/fusion_record.h>
 #include <python_frontend/fusion_state.h>
 #include <utils.h>
 
+#include <c10/util/irange.h>
+
+#include <unordered_map>
+#include <unordered_set>
+
 // Require namespace for perf scope instrumentation
 using namespace nvfuser::inst;
 
@@ -88,14 +96,89 @@ std::unique_ptr<FusionState> FusionState::clone() {
   return state;
 }
 
-void FusionState::buildFusionIr(Fusion* fusion) {
+// Note [Simplifying fusion definitions]
+// Traced programs often contain records whose results are unused, or scalar
+// arithmetic on constants, e.g., shape computations. The IR they produce would
+// be processed by every later stage, so the Fusion of a definition is built
+// without them:
+//  - dead-record elimination skips the records whose outputs are not used,
+//    transitively, by a record without outputs, e.g., add_output, or by a
+//    record defining an input;
+//  - constant folding then replaces the scalars computed from constants by
+//    their values.
+// Only the Fusion is simplified. The trie still holds the original records,
+// so cache lookups are unchanged. The states of skipped records are left
+// empty. The prescheduled Fusion is built the same way by finalizeDefinition
+// and by the deserialization of the FusionCache, so that it matches the
+// serialized FusionExecutorCache. Fusions built for user schedules are not
+// simplified, as schedules can refer to any state.
+
+void FusionState::buildFusionIr(Fusion* fusion, bool simplify) {
   FUSER_PERF_SCOPE("FusionContainer::buildFusionIr");
   NVF_CHECK(fusion != nullptr, "Fusion is undefined.");
   resetFusionState(fusion, num_recording_states_);
   auto fusion_guard = FusionGuard(fusion);
-  for (auto& record : recording_) {
-    auto functor = record.get();
-    (*functor)(*this);
+  simplify = simplify && !isOptionDisabled(DisableOption::SimplifyDefinition);
+  std::vector<bool> live =
+      simplify ? liveRecords() : std::vector<bool>(recording_.size(), true);
+  for (auto i : c10::irange(recording_.size())) {
+    if (live.at(i)) {
+      auto functor = recording_.at(i).get();
+      (*functor)(*this);
+    }
+  }
+  if (simplify) {
+    foldConstantScalars();
+  }
+}
+
+std::vector<bool> FusionState::liveRecords() {
+  std::vector<bool> live(recording_.size(), false);
+  std::unordered_set<size_t> live_states;
+  for (int64_t i = (int64_t)recording_.size() - 1; i >= 0; --i) {
+    RecordFunctor* record = recording_.at(i).get();
+    const serde::RecordType type = record->recordType();
+    bool is_live = record->numOutputs() == 0 ||
+        type == serde::RecordType::Tensor ||
+        type == serde::RecordType::Scalar ||
+        type == serde::RecordType::Vector;
+    for (const State& out : record->outputs()) {
+      is_live = is_live || live_states.count(out.index) > 0;
+    }
+    if (!is_live) {
+      continue;
+    }
+    live.at(i) = true;
+    for (const State& arg : record->args()) {
+      if (arg.stype != serde::StateType::None) {
+        live_states.insert(arg.index);
+      }
+    }
+  }
+  return live;
+}
+
+void FusionState::foldConstantScalars() {
+  std::unordered_map<Val*, Val*> replacement_map;
+  // Creating the constants modifies the container, so iterate over a copy
+  for (Val* val : fusion_->deterministic_vals()) {
+    if (val->isScalar() && val->definition() != nullptr &&
+        !val->isFusionOutput() && val->isConstScalar()) {
+      replacement_map.emplace(
+          val, IrBuilder::create<Val>(val->evaluate(), val->dtype()));
+    }
+  }
+  if (replacement_map.empty()) {
+    return;
+  }
+  ir_utils::replaceValue(fusion_, replacement_map);
+  for (std::vector<Val*>& vals : fusion_state_) {
+    for (Val*& val : vals) {
+      auto it = replacement_map.find(val);
+      if (it != replacement_map.end()) {
+        val = it->second;
+      }
+    }
   }
 }
 
@@ -87,8 +87,10 @@ class FusionState {
 
   //! Add a Record
   void addRecord(RecordFunctor* record);
-  //! Builds an nvFuser Fusion IR object
-  void buildFusionIr(Fusion* fusion);
+  //! Builds an nvFuser Fusion IR object. When `simplify` is set, the records
+  //! whose outputs are unused are skipped and the scalars computed from
+  //! constants are folded. See Note [Simplifying fusion definitions]
+  void buildFusionIr(Fusion* fusion, bool simplify = false);
 
   //! Create clone of FusionState
   std::unique_ptr<FusionState> clone();
@@ -96,6 +98,12 @@ class FusionState {
  private:
   //! Change the fusion ptr and reset its state
   void resetFusionState(Fusion* fusion, size_t size);
+  //! Whether each record contributes to the Fusion, i.e., defines an input
+  //! or an output, or computes a value used by such a record
+  std::vector<bool> liveRecords();
+  //! Replaces the scalars of the Fusion computed from constants by their
+  //! values, also in fusion_state_
+  void foldConstantScalars();
 
  protected:
   //! Holds an End Record
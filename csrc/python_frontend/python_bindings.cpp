@@ -223,6 +223,41 @@ Tensor random_dist_op_fn(
   return output;
 }
 
+// Converts the inputs of FusionDefinition._execute
+std::vector<c10::IValue> toInputIValues(const py::iterable& iter) {
+  std::vector<c10::IValue> inputs;
+  for (py::handle obj : iter) {
+    // Allows for a Vector of Sizes to be inputed as a list/tuple
+    if (py::isinstance<py::list>(obj) || py::isinstance<py::tuple>(obj)) {
+      for (py::handle item : obj) {
+        inputs.push_back(torch::jit::toIValue(item, c10::AnyType::get()));
+      }
+    } else {
+      inputs.push_back(torch::jit::toIValue(obj, c10::AnyType::get()));
+    }
+  }
+  return inputs;
+}
+
+std::optional<int8_t> toDeviceIndex(std::optional<int64_t> device) {
+  if (!device.has_value()) {
+    return std::nullopt;
+  }
+  NVF_CHECK(device.value() < 256, "Maximum device index is 255");
+  return (int8_t)device.value();
+}
+
+// A None output buffer is allocated by nvFuser
+std::vector<at::Tensor> toOutputBuffers(
+    const std::vector<std::optional<at::Tensor>>& outputs) {
+  std::vector<at::Tensor> output_buffers;
+  output_buffers.reserve(outputs.size());
+  for (const auto& output : outputs) {
+    output_buffers.push_back(output.value_or(at::Tensor()));
+  }
+  return output_buffers;
+}
+
 struct DimInfo {
   int64_t index;
   int64_t size;
@@ -418,6 +453,7 @@ void initNvFuserPythonBindings(PyObject* module) {
       .value("Half", DataType::Half)
       .value("Int", DataType::Int)
       .value("Int32", DataType::Int32)
+      .value("Int8", DataType::Int8)
       .value("Bool", DataType::Bool)
       .value("BFloat16", DataType::BFloat16)
       .value("Float8_e4m3fn", DataType::Float8_e4m3fn)
@@ -515,11 +551,34 @@ void initNvFuserPythonBindings(PyObject* module) {
             self.print(ss);
             return ss.str();
           })
-      .def("stats", [](FusionCache& self) {
-        std::stringstream ss;
-        self.stats(ss);
-        return ss.str();
-      });
+      .def(
+          "stats",
+          [](FusionCache& self) {
+            std::stringstream ss;
+            self.stats(ss);
+            return ss.str();
+          })
+      .def(
+          "host_times",
+          [](FusionCache& self, bool reset) {
+            const FusionCacheHostTimes host_times = self.hostTimes();
+            if (reset) {
+              self.hostTimes() = FusionCacheHostTimes();
+            }
+            py::dict result;
+            result["definitions"] = host_times.definitions;
+            result["finalize_definition_time_ns"] =
+                host_times.finalize_definition_time_ns;
+            result["executions"] = host_times.executions;
+            result["input_conversion_time_ns"] =
+                host_times.input_conversion_time_ns;
+            result["execute_time_ns"] = host_times.execute_time_ns;
+            result["output_wrapping_time_ns"] =
+                host_times.output_wrapping_time_ns;
+            return result;
+          },
+          py::kw_only(),
+          py::arg("reset") = false);
 
   //! KernelProfiles are encapsulated in FusionProfiles where each KP
   //! is associated with a segment.
@@ -563,6 +622,24 @@ void initNvFuserPythonBindings(PyObject* module) {
       "output_bytes", [](KernelProfile& self) { return self.output_bytes; });
   kernel_prof.def_property_readonly(
       "scheduler", [](KernelProfile& self) { return self.scheduler; });
+  kernel_prof.def_property_readonly(
+      "flops", [](KernelProfile& self) { return self.flops; });
+  kernel_prof.def_property_readonly(
+      "achieved_tflops",
+      [](KernelProfile& self) { return self.achieved_tflops; });
+  kernel_prof.def_property_readonly(
+      "percentage_peak_flops",
+      [](KernelProfile& self) { return self.percentage_peak_flops; });
+  kernel_prof.def_property_readonly(
+      "occupancy", [](KernelProfile& self) { return self.occupancy; });
+  kernel_prof.def_property_readonly("register_spills", [](KernelProfile& self) {
+    return self.register_spills;
+  });
+  kernel_prof.def_property_readonly("bound", [](KernelProfile& self) {
+    std::stringstream ss;
+    ss << self.bound;
+    return ss.str();
+  });
 
   //! A fusion profile is generated for FusionDefinition.
   py::class_<FusionProfile> fusion_prof(nvfuser, "FusionProfile");
@@ -596,6 +673,9 @@ void initNvFuserPythonBindings(PyObject* module) {
   fusion_prof.def_property_readonly("kernel_profiles", [](FusionProfile& self) {
     return self.kernel_profiles;
   });
+  fusion_prof.def("roofline_report", [](FusionProfile& self) {
+    return self.rooflineReport();
+  });
 
   //! These are the FusionDefinition supported object types that are either
   //! defined as inputs or the output of an operation.
@@ -640,6 +720,17 @@ void initNvFuserPythonBindings(PyObject* module) {
   vector_class.def(pybind11::self == pybind11::self);
   vector_class.def(pybind11::self != pybind11::self);
 
+  py::class_<AsyncExecution> async_execution(nvfuser, "AsyncExecution");
+  async_execution
+      .def(
+          "done",
+          &AsyncExecution::done,
+          py::call_guard<py::gil_scoped_release>())
+      .def(
+          "result",
+          &AsyncExecution::result,
+          py::call_guard<py::gil_scoped_release>());
+
   //! The FusionDefinition is a context manager in Python where the user will
   //! define the set the operations and connections between operations for
   //! nvFuser to create.
@@ -710,32 +801,35 @@ void initNvFuserPythonBindings(PyObject* module) {
              std::optional<int64_t> device,
              bool override_user_schedule,
              bool capture_debug_output,
-             bool profile) {
+             bool profile,
+             const std::vector<std::optional<at::Tensor>>& outputs) {
+            FusionCacheHostTimes& host_times =
+                FusionCache::get()->hostTimes();
+            host_times.executions++;
             std::vector<c10::IValue> inputs;
-            for (py::handle obj : iter) {
-              // Allows for a Vector of Sizes to be inputed as a list/tuple
-              if (py::isinstance<py::list>(obj) ||
-                  py::isinstance<py::tuple>(obj)) {
-                for (py::handle item : obj) {
-                  inputs.push_back(
-                      torch::jit::toIValue(item, c10::AnyType::get()));
-                }
-              } else {
-                inputs.push_back(
-                    torch::jit::toIValue(obj, c10::AnyType::get()));
-              }
+            {
+              ScopedHostTime host_time(host_times.input_conversion_time_ns);
+              inputs = toInputIValues(iter);
             }
-            std::optional<int8_t> int8_device = std::nullopt;
-            if (device.has_value()) {
-              NVF_CHECK(device.value() < 256, "Maximum device index is 255");
-              int8_device = (int8_t)device.value();
+            std::vector<at::Tensor> results;
+            {
+              ScopedHostTime host_time(host_times.execute_time_ns);
+              results = self.execute(
+                  inputs,
+                  toDeviceIndex(device),
+                  override_user_schedule,
+                  capture_debug_output,
+                  profile,
+                  toOutputBuffers(outputs));
             }
-            return self.execute(
-                inputs,
-                int8_device,
-                override_user_schedule,
-                capture_debug_output,
-                profile);
+            // Wraps the outputs here rather than on return, so that the
+            // wrapping is timed.
+            ScopedHostTime host_time(host_times.output_wrapping_time_ns);
+            py::list py_results;
+            for (const at::Tensor& result : results) {
+              py_results.append(py::cast(result));
+            }
+            return py_results;
           },
           py::arg("inputs"),
           py::kw_only(),
@@ -743,7 +837,36 @@ void initNvFuserPythonBindings(PyObject* module) {
           py::arg("override_user_schedule") = false,
           py::arg("capture_debug_output") = false,
           py::arg("profile") = false,
+          py::arg("outputs") = std::vector<std::optional<at::Tensor>>(),
           py::return_value_policy::reference)
+      .def(
+          "_execute_async",
+          [](FusionDefinition& self,
+             const py::iterable& iter,
+             std::optional<int64_t> device,
+             bool override_user_schedule,
+             const std::vector<std::optional<at::Tensor>>& outputs) {
+            FusionCacheHostTimes& host_times =
+                FusionCache::get()->hostTimes();
+            host_times.executions++;
+            std::vector<c10::IValue> inputs;
+            {
+              ScopedHostTime host_time(host_times.input_conversion_time_ns);
+              inputs = toInputIValues(iter);
+            }
+            return self.executeAsync(
+                inputs,
+                toDeviceIndex(device),
+                override_user_schedule,
+                toOutputBuffers(outputs));
+          },
+          py::arg("inputs"),
+          py::kw_only(),
+          py::arg("device") = py::none(),
+          py::arg("override_user_schedule") = false,
+          py::arg("outputs") = std::vector<std::optional<at::Tensor>>(),
+          // The execution uses the FusionDefinition until it finishes
+          py::keep_alive<0, 1>())
       .def_static(
           "_profile",
           &FusionProfiler::profile,
@@ -787,6 +910,63 @@ void initNvFuserPythonBindings(PyObject* module) {
           py::arg("intrinsic_code") = false,
           py::arg("override_user_schedule") = false,
           py::return_value_policy::reference)
+      .def(
+          "_warmup",
+          [](FusionDefinition& self,
+             const py::iterable& input_sets,
+             int64_t device) {
+            std::vector<std::vector<c10::IValue>> ivalue_sets;
+            for (py::handle inputs : input_sets) {
+              std::vector<c10::IValue>& ivalues = ivalue_sets.emplace_back();
+              for (py::handle obj : py::cast<py::iterable>(inputs)) {
+                ivalues.push_back(
+                    torch::jit::toIValue(obj, c10::AnyType::get()));
+              }
+            }
+            self.warmup(ivalue_sets, static_cast<int8_t>(device));
+          },
+          py::arg("input_sets"),
+          py::arg("device") = 0)
+      .def(
+          "_metrics",
+          [](FusionDefinition& self, bool reset) {
+            const FusionExecutorCacheMetrics metrics = self.metrics(reset);
+            py::dict result;
+            result["runs"] = metrics.runs;
+            result["kernel_launches"] = metrics.kernel_launches;
+            result["input_id_hits"] = metrics.input_id_hits;
+            result["runtime_reuses"] = metrics.runtime_reuses;
+            result["runtime_misses"] = metrics.runtime_misses;
+            result["compile_time_ns"] = metrics.compile_time_ns;
+            result["num_segments"] = metrics.num_segments;
+            result["input_bytes"] = metrics.input_bytes;
+            result["output_bytes"] = metrics.output_bytes;
+            result["sampled_runs"] = metrics.sampled_runs;
+            result["sampled_kernel_time_ns"] = metrics.sampled_kernel_time_ns;
+            return result;
+          },
+          py::arg("reset") = false)
+      .def(
+          "_resource_usage",
+          [](FusionDefinition& self) {
+            py::list result;
+            for (const KernelResourceUsage& usage : self.resourceUsage()) {
+              py::dict kernel;
+              kernel["kernel_name"] = usage.kernel_name;
+              kernel["registers_per_thread"] = usage.registers_per_thread;
+              kernel["static_smem_bytes"] = usage.static_smem_bytes;
+              kernel["dynamic_smem_bytes"] = usage.dynamic_smem_bytes;
+              kernel["local_memory_bytes"] = usage.local_memory_bytes;
+              kernel["max_threads_per_block"] = usage.max_threads_per_block;
+              kernel["threads_per_block"] = usage.threads_per_block;
+              kernel["max_active_blocks_per_sm"] =
+                  usage.max_active_blocks_per_sm;
+              kernel["active_warps_per_sm"] = usage.active_warps_per_sm;
+              kernel["theoretical_occupancy"] = usage.theoretical_occupancy;
+              result.append(kernel);
+            }
+            return result;
+          })
       .def(
           "_last_scheduled_fusion_ir",
           [](FusionDefinition& self,
@@ -0,0 +1,361 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#include <recompute_planner.h>
+
+#include <disjoint_set.h>
+#include <executor_kernel_arg.h>
+#include <executor_utils.h>
+#include <expr_evaluator.h>
+#include <instrumentation.h>
+#include <ir/cloner.h>
+#include <ir/utils.h>
+#include <iter_visitor.h>
+#include <ops/utils.h>
+
+#include <optional>
+#include <unordered_set>
+
+namespace nvfuser {
+
+// [ Note -- Recomputation planner ]
+//
+// nvFuser sees the forward and the backward fusion of a layer separately, so
+// the intermediates the backward fusion reads are whatever the user decided
+// to save. A joint fusion defines both passes at once: its first inputs and
+// outputs are those of the forward pass, and the rest are the backward
+// inputs, e.g. the gradients of the forward outputs, and the backward
+// outputs. planRecomputation decides which forward intermediates read by the
+// backward exprs are saved, and splitForwardBackward makes a forward fusion
+// outputting them and a backward fusion recomputing the others. The
+// recomputed exprs then end up in the backward kernels reading them, like
+// the edges recomputed by SegmentCandidateFinder::recomputeCheapEdges do
+// within one fusion.
+//
+// The forward inputs and outputs are free to read in the backward fusion, as
+// the caller keeps them anyway. Every other intermediate read by the backward
+// exprs starts out saved. Then, until nothing changes, a saved tensor is
+// recomputed instead when it is cheaper:
+//
+//   bytes(tv) > bytes(leaves not yet saved) + flops / kFlopsPerByte
+//
+// where the leaves are the free, saved or not recomputable tensors the
+// recomputation of tv starts from, and flops those of at most
+// kMaxRecomputedExprs pointwise, broadcast and copy exprs. The leaves not yet
+// saved are saved instead of tv. Reductions, matmuls and random ops are never
+// recomputed, the latter because they would not produce the same values. As
+// every change lowers the saved bytes, the planner terminates. Bytes count
+// the elements of the non-broadcast dimensions, whose extents are evaluated
+// with the given inputs or else assumed to be kUnknownExtent.
+
+namespace {
+
+constexpr int64_t kMaxRecomputedExprs = 16;
+
+//! Ratio of the FLOPs to bytes of memory bandwidth of recent GPUs, so that a
+//! recomputation with fewer FLOPs per byte than that is cheaper than moving
+//! the bytes
+constexpr double kFlopsPerByte = 20.0;
+
+//! FLOPs per element of transcendental functions
+constexpr double kTranscendentalFlops = 8.0;
+
+constexpr int64_t kUnknownExtent = 1024;
+
+bool isRecomputable(Expr* expr) {
+  if (expr->isA<LoadStoreOp>()) {
+    return expr->as<LoadStoreOp>()->opType() == LoadStoreOpType::Set;
+  }
+  return expr->isOneOf<
+      UnaryOp,
+      BinaryOp,
+      TernaryOp,
+      BroadcastOp,
+      SqueezeOp,
+      ExpandOp,
+      ViewOp,
+      FullOp,
+      IotaOp>();
+}
+
+double flopsPerElement(Expr* expr) {
+  if (auto* uop = dynamic_cast<UnaryOp*>(expr)) {
+    switch (uop->getUnaryOpType()) {
+      case UnaryOpType::Cast:
+      case UnaryOpType::Neg:
+      case UnaryOpType::Abs:
+      case UnaryOpType::Relu:
+        return 1.0;
+      default:
+        return kTranscendentalFlops;
+    }
+  }
+  return expr->isOneOf<BinaryOp, TernaryOp>() ? 1.0 : 0.0;
+}
+
+class RecomputationPlanner {
+ public:
+  RecomputationPlanner(
+      Fusion* joint,
+      int64_t num_forward_inputs,
+      int64_t num_forward_outputs,
+      const std::vector<c10::IValue>& inputs)
+      : joint_(joint) {
+    if (!inputs.empty()) {
+      expr_eval_ = executor_utils::bindInputs(
+          KernelArgumentHolder::createKernelArgumentHolder(inputs), joint);
+    }
+    const std::vector<Val*> forward_outputs(
+        joint->outputs().begin(),
+        joint->outputs().begin() + num_forward_outputs);
+    free_.insert(
+        joint->inputs().begin(), joint->inputs().begin() + num_forward_inputs);
+    free_.insert(forward_outputs.begin(), forward_outputs.end());
+    for (Expr* expr : StmtSort::getExprsTo(forward_outputs)) {
+      forward_exprs_.insert(expr);
+    }
+  }
+
+  RecomputationPlan plan(const std::vector<Val*>& backward_outputs) {
+    for (Expr* expr : StmtSort::getExprsTo(backward_outputs)) {
+      if (forward_exprs_.count(expr)) {
+        continue;
+      }
+      for (auto* tv : ir_utils::filterByType<TensorView>(expr->inputs())) {
+        if (forward_exprs_.count(tv->definition()) && !free_.count(tv)) {
+          saved_.pushBack(tv);
+        }
+      }
+    }
+
+    bool changed = true;
+    while (changed) {
+      changed = false;
+      const std::vector<TensorView*> candidates = saved_.vector();
+      for (TensorView* tv : candidates) {
+        if (!saved_.has(tv)) {
+          continue;
+        }
+        std::optional<std::pair<std::vector<TensorView*>, double>> leaves =
+            recomputationLeaves(tv);
+        if (!leaves.has_value()) {
+          continue;
+        }
+        double cost = leaves->second / kFlopsPerByte;
+        for (TensorView* leaf : leaves->first) {
+          if (!free_.count(leaf) && !saved_.has(leaf)) {
+            cost += bytes(leaf);
+          }
+        }
+        if (cost >= bytes(tv)) {
+          continue;
+        }
+        saved_.erase(tv);
+        for (TensorView* leaf : leaves->first) {
+          if (!free_.count(leaf)) {
+            saved_.pushBack(leaf);
+          }
+        }
+        changed = true;
+      }
+    }
+
+    RecomputationPlan plan;
+    plan.saved = saved_.vector();
+    for (TensorView* tv : plan.saved) {
+      plan.saved_bytes += (int64_t)bytes(tv);
+    }
+    std::vector<Val*> available(free_.begin(), free_.end());
+    available.insert(available.end(), plan.saved.begin(), plan.saved.end());
+    for (Val* in : joint_->inputs()) {
+      if (!free_.count(in)) {
+        available.push_back(in);
+      }
+    }
+    for (Expr* expr : StmtSort::getExprsBetween(available, backward_outputs)) {
+      if (!forward_exprs_.count(expr)) {
+        continue;
+      }
+      for (auto* tv : ir_utils::filterByType<TensorView>(expr->outputs())) {
+        plan.recomputed.push_back(tv);
+      }
+    }
+    return plan;
+  }
+
+ private:
+  double bytes(TensorView* tv) {
+    double numel = 1.0;
+    for (IterDomain* id : TensorDomain::noReductions(tv->getLogicalDomain())) {
+      if (id->isBroadcast()) {
+        continue;
+      }
+      const PolymorphicValue& extent = expr_eval_.evaluate(id->extent());
+      numel *= extent.hasValue() ? (double)extent.as<int64_t>()
+                                 : (double)kUnknownExtent;
+    }
+    return numel * (double)dataTypeSize(tv->dtype());
+  }
+
+  //! The tensors the recomputation of `tv` starts from and its FLOPs, or
+  //! nullopt if `tv` isn't recomputable
+  std::optional<std::pair<std::vector<TensorView*>, double>>
+  recomputationLeaves(TensorView* tv) {
+    if (!isRecomputable(tv->definition())) {
+      return std::nullopt;
+    }
+    VectorOfUniqueEntries<TensorView*> leaves;
+    std::unordered_set<Expr*> visited;
+    double flops = 0.0;
+    std::vector<TensorView*> to_visit = {tv};
+    while (!to_visit.empty()) {
+      TensorView* current = to_visit.back();
+      to_visit.pop_back();
+      Expr* def = current->definition();
+      if (current != tv &&
+          (free_.count(current) || saved_.has(current) || def == nullptr ||
+           !isRecomputable(def))) {
+        leaves.pushBack(current);
+        continue;
+      }
+      if (!visited.insert(def).second) {
+        continue;
+      }
+      if ((int64_t)visited.size() > kMaxRecomputedExprs) {
+        return std::nullopt;
+      }
+      for (auto* out : ir_utils::filterByType<TensorView>(def->outputs())) {
+        flops += flopsPerElement(def) * bytes(out) /
+            (double)dataTypeSize(out->dtype());
+      }
+      for (auto* in : ir_utils::filterByType<TensorView>(def->inputs())) {
+        to_visit.push_back(in);
+      }
+    }
+    return std::make_pair(leaves.vector(), flops);
+  }
+
+  Fusion* joint_ = nullptr;
+  ExpressionEvaluator expr_eval_;
+  //! Forward inputs and outputs
+  std::unordered_set<Val*> free_;
+  std::unordered_set<Expr*> forward_exprs_;
+  VectorOfUniqueEntries<TensorView*> saved_;
+};
+
+void checkJointFusion(
+    Fusion* joint,
+    int64_t num_forward_inputs,
+    int64_t num_forward_outputs) {
+  NVF_CHECK(
+      num_forward_inputs >= 0 &&
+          num_forward_inputs <= (int64_t)joint->inputs().size(),
+      "Invalid number of forward inputs: ",
+      num_forward_inputs);
+  NVF_CHECK(
+      num_forward_outputs >= 0 &&
+          num_forward_outputs <= (int64_t)joint->outputs().size(),
+      "Invalid number of forward outputs: ",
+      num_forward_outputs);
+  const std::vector<Val*> backward_inputs(
+      joint->inputs().begin() + num_forward_inputs, joint->inputs().end());
+  const std::vector<Val*> forward_outputs(
+      joint->outputs().begin(), joint->outputs().begin() + num_forward_outputs);
+  for (Val* out : forward_outputs) {
+    NVF_CHECK(
+        !DependencyCheck::isDependencyOf(backward_inputs, {out}) &&
+            std::find(backward_inputs.begin(), backward_inputs.end(), out) ==
+                backward_inputs.end(),
+        "Forward output ",
+        out->toString(),
+        " depends on a backward input");
+  }
+}
+
+} // namespace
+
+RecomputationPlan planRecomputation(
+    Fusion* joint,
+    int64_t num_forward_inputs,
+    int64_t num_forward_outputs,
+    const std::vector<c10::IValue>& inputs) {
+  FUSER_PERF_SCOPE("planRecomputation");
+  checkJointFusion(joint, num_forward_inputs, num_forward_outputs);
+  RecomputationPlanner planner(
+      joint, num_forward_inputs, num_forward_outputs, inputs);
+  return planner.plan(
+      {joint->outputs().begin() + num_forward_outputs, joint->outputs().end()});
+}
+
+ForwardBackwardFusions splitForwardBackward(
+    Fusion* joint,
+    int64_t num_forward_inputs,
+    int64_t num_forward_outputs,
+    const RecomputationPlan& plan) {
+  FUSER_PERF_SCOPE("splitForwardBackward");
+  checkJointFusion(joint, num_forward_inputs, num_forward_outputs);
+  const std::vector<Val*> forward_inputs(
+      joint->inputs().begin(), joint->inputs().begin() + num_forward_inputs);
+  const std::vector<Val*> backward_inputs(
+      joint->inputs().begin() + num_forward_inputs, joint->inputs().end());
+  const std::vector<Val*> forward_outputs(
+      joint->outputs().begin(), joint->outputs().begin() + num_forward_outputs);
+  const std::vector<Val*> backward_outputs(
+      joint->outputs().begin() + num_forward_outputs, joint->outputs().end());
+
+  ForwardBackwardFusions fusions;
+  fusions.forward = std::make_unique<Fusion>();
+  {
+    Fusion* forward = fusions.forward.get();
+    IrCloner ir_cloner = Fusion::copy(joint, forward);
+    FusionGuard fg(forward);
+    for (Val* out : backward_outputs) {
+      forward->removeOutput(ir_cloner.clone(out));
+    }
+    for (Val* in : backward_inputs) {
+      forward->removeInput(ir_cloner.clone(in));
+    }
+    for (TensorView* tv : plan.saved) {
+      forward->addOutput(ir_cloner.clone(tv));
+    }
+  }
+
+  fusions.backward = std::make_unique<Fusion>();
+  {
+    Fusion* backward = fusions.backward.get();
+    IrCloner ir_cloner = Fusion::copy(joint, backward);
+    FusionGuard fg(backward);
+    for (Val* in : backward_inputs) {
+      backward->removeInput(ir_cloner.clone(in));
+    }
+    for (Val* out : forward_outputs) {
+      backward->removeOutput(ir_cloner.clone(out));
+    }
+    // Reads the outputs of the forward fusion from new inputs, keeping a
+    // placeholder for forward outputs that are also forward inputs
+    auto read_forward_output = [&](Val* joint_val) {
+      Val* val = ir_cloner.clone(joint_val);
+      Val* in = ops::newValLike(val, val->dtype());
+      if (!val->isFusionInput()) {
+        ir_utils::replaceValInAllExprInputsAndFusionOutputs(val, in);
+      }
+      backward->addInput(in);
+    };
+    for (Val* out : forward_outputs) {
+      read_forward_output(out);
+    }
+    for (TensorView* tv : plan.saved) {
+      read_forward_output(tv);
+    }
+    for (Val* in : backward_inputs) {
+      backward->addInput(ir_cloner.clone(in));
+    }
+  }
+  return fusions;
+}
+
+} // namespace nvfuser
@@ -0,0 +1,61 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#pragma once
+
+#include <fusion.h>
+#include <ir/interface_nodes.h>
+#include <visibility.h>
+
+#include <ATen/core/ivalue.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace nvfuser {
+
+//! Intermediates of a joint forward and backward fusion that the forward
+//! fusion saves for the backward fusion, and that the backward fusion
+//! recomputes. See [ Note -- Recomputation planner ] in recompute_planner.cpp.
+struct RecomputationPlan {
+  //! Tensors output by the forward fusion and read by the backward fusion
+  std::vector<TensorView*> saved;
+  //! Tensors computed by both the forward and the backward fusion
+  std::vector<TensorView*> recomputed;
+  //! Estimated bytes of the saved tensors
+  int64_t saved_bytes = 0;
+};
+
+//! Plans which intermediates of `joint` to save. The first
+//! `num_forward_inputs` inputs and `num_forward_outputs` outputs of `joint`
+//! are those of the forward pass, which must not depend on the other inputs,
+//! e.g. the gradients of the forward outputs. The sizes of the tensors are
+//! estimated with `inputs`, the inputs of `joint`, when given.
+NVF_API RecomputationPlan planRecomputation(
+    Fusion* joint,
+    int64_t num_forward_inputs,
+    int64_t num_forward_outputs,
+    const std::vector<c10::IValue>& inputs = {});
+
+struct ForwardBackwardFusions {
+  //! Takes the forward inputs and outputs the forward outputs followed by
+  //! RecomputationPlan::saved
+  std::unique_ptr<Fusion> forward;
+  //! Takes the inputs of `forward`, followed by its outputs and the backward
+  //! inputs of the joint fusion, and outputs the backward outputs
+  std::unique_ptr<Fusion> backward;
+};
+
+//! Splits `joint` into a forward and a backward fusion following `plan`
+NVF_API ForwardBackwardFusions splitForwardBackward(
+    Fusion* joint,
+    int64_t num_forward_inputs,
+    int64_t num_forward_outputs,
+    const RecomputationPlan& plan);
+
+} // namespace nvfuser
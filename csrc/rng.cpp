@@ -67,6 +67,30 @@ getRNGSeedAndOffsetFromHost() {
   return std::make_tuple(seed, offset, expr);
 }
 
+// Note [Fast RNG]
+// By default, element i of the logical linear index of an RNGOp output uses
+// component i % 4 (i % 2 for double) of philox(seed, i / 4, offset + id),
+// where offset is computed above and id is the RNG op id. A thread whose
+// consecutive elements are not consecutive in i, e.g., because of an
+// unroll loop outside of TIDx, only uses one component of each call.
+//
+// With NVFUSER_ENABLE=fast_rng, i is replaced by
+//   thread * ceilDiv(n, 4) * 4 + j
+// where thread linearizes the BID and TID loops of the RNGOp, j linearizes
+// its serial loops and n is the trip count of the serial loops. The elements
+// of each thread then start at a fresh Philox call and share each call with
+// their neighbors. Philox4x32-7 is also used instead of Philox4x32-10.
+//
+// The seed and offset are handled as above in both modes, so:
+//  - Results are reproducible for a given seed, offset, fusion, schedule
+//    and launch configuration, including under CUDA graph capture.
+//  - Different RNG ops and different kernels never share Philox counters,
+//    since each RNG op still owns one uint4 along the offset dimension.
+//  - Unlike the default mode, results change when the schedule or the
+//    launch configuration changes, and they are different from the default
+//    mode, so this mode should not be used where results are compared
+//    against other schedules, e.g., across segmentations.
+
 std::vector<PolymorphicValue> kir::GetRNGSeedAndOffsetFromHost::evaluate(
     const ExpressionEvaluator& ee,
     const std::vector<PolymorphicValue>& inputs) const {
@@ -6,14 +6,203 @@
  */
 // clang-format on
 
+#include <expr_evaluator.h>
 #include <ir/utils.h>
+#include <options.h>
 #include <scheduler/debug_utils.h>
 #include <scheduler/expr_eval_sched.h>
 #include <scheduler/registry_utils.h>
 
+#include <ATen/ATen.h>
+
+#include <unordered_set>
+
 namespace nvfuser {
 
-// Check if the fusion has a single MatmulOp/LinearOp node
+// Note [Matmul epilogues]
+//
+// A MatmulOp or LinearOp run by ATen leaves its epilogue, e.g., the bias add
+// and the activation of a linear layer
+//
+//   T2 = linear(T0, T1)
+//   T3 = castOp(DataType::Float, T2)
+//   T5 = add(T3, broadcast(castOp(DataType::Float, T4), {true, false}))
+//   T6 = relu(T5)
+//   T7 = castOp(DataType::BFloat16, T6)
+//
+// to a pointwise segment, which reads the matmul output back from global
+// memory. With NVFUSER_ENABLE=expr_eval_epilogue, the ExprEval scheduler also
+// accepts a matmul followed by casts, an add of a 1D fusion input along the
+// last dimension and a ReLU, in this order. The segment runs them with
+// at::_addmm_activation, which cuBLASLt runs as one GEMM with a bias and ReLU
+// epilogue. As with the bias of LinearOp, the bias must have the dtype of the
+// matmul. The epilogue is computed in that dtype and then cast to the output
+// dtype, so only intermediate casts to float or double are allowed, which
+// would not round the results. GELU is not matched as nvFuser decomposes it
+// into many ops, nor are the fp8 scales, which nvFuser has no ops for.
+
+namespace {
+
+bool isCast(Expr* expr) {
+  return expr->isA<UnaryOp>() &&
+      expr->as<UnaryOp>()->getUnaryOpType() == UnaryOpType::Cast;
+}
+
+bool isWideningCast(Expr* expr) {
+  return isCast(expr) &&
+      (expr->output(0)->dtype() == DataType::Float ||
+       expr->output(0)->dtype() == DataType::Double);
+}
+
+// The 1D fusion input of `dtype` that is cast and broadcast to `operand`
+// along all but the last of its `ndims` dimensions. The exprs on the way are
+// added to `matched`.
+TensorView* matchBias(
+    Val* operand,
+    DataType dtype,
+    size_t ndims,
+    std::unordered_set<Expr*>& matched) {
+  std::vector<Expr*> exprs;
+  BroadcastOp* bcast = nullptr;
+  Val* val = operand;
+  while (Expr* def = val->definition()) {
+    if (def->isA<BroadcastOp>() && bcast == nullptr) {
+      bcast = def->as<BroadcastOp>();
+    } else if (!isWideningCast(def)) {
+      return nullptr;
+    }
+    exprs.push_back(def);
+    val = def->input(0);
+  }
+
+  if (bcast == nullptr || !val->isFusionInput() || !val->isA<TensorView>() ||
+      val->dtype() != dtype) {
+    return nullptr;
+  }
+  const std::vector<bool>& flags = bcast->getBroadcastDimFlags();
+  if (flags.size() != ndims || flags.back() ||
+      std::count(flags.begin(), flags.end(), false) != 1) {
+    return nullptr;
+  }
+
+  matched.insert(exprs.begin(), exprs.end());
+  return val->as<TensorView>();
+}
+
+size_t numDims(Val* val) {
+  return TensorDomain::noReductions(val->as<TensorView>()->getLogicalDomain())
+      .size();
+}
+
+} // namespace
+
+std::optional<MatmulEpilogue> matchMatmulEpilogue(Fusion* fusion) {
+  if (fusion->outputs().size() != 1) {
+    return std::nullopt;
+  }
+
+  const std::vector<Expr*> exprs = fusion->exprs();
+  MatmulEpilogue epilogue;
+  for (Expr* expr : exprs) {
+    if (!expr->isOneOf<MatmulOp, LinearOp>()) {
+      continue;
+    }
+    if (epilogue.matmul != nullptr) {
+      return std::nullopt;
+    }
+    epilogue.matmul = expr;
+  }
+  if (epilogue.matmul == nullptr) {
+    return std::nullopt;
+  }
+  std::unordered_set<Expr*> matched({epilogue.matmul});
+
+  // at::_addmm_activation takes 2D operands, to which the leading dimensions
+  // of the input of a linear are flattened
+  const bool is_linear = epilogue.matmul->isA<LinearOp>();
+  Val* mm_out = epilogue.matmul->output(0);
+  const size_t ndims = numDims(mm_out);
+  if (numDims(epilogue.matmul->input(1)) != 2 ||
+      numDims(epilogue.matmul->input(0)) != (is_linear ? ndims : 2) ||
+      ndims < 2) {
+    return std::nullopt;
+  }
+  const DataType dtype = mm_out->dtype();
+  if (is_linear && epilogue.matmul->as<LinearOp>()->has_bias()) {
+    Val* bias = epilogue.matmul->as<LinearOp>()->bias();
+    if (numDims(bias) != 1 || bias->dtype() != dtype) {
+      return std::nullopt;
+    }
+    epilogue.bias = bias->as<TensorView>();
+  }
+
+  bool has_bias_add = false;
+  Val* val = mm_out;
+  while (!val->isFusionOutput()) {
+    if (val->uses().size() != 1) {
+      return std::nullopt;
+    }
+    Expr* use = val->uses().front();
+    auto bop = dynamic_cast<BinaryOp*>(use);
+    if (bop != nullptr && bop->getBinaryOpType() == BinaryOpType::Add &&
+        epilogue.bias == nullptr && !epilogue.relu) {
+      Val* other = bop->lhs() == val ? bop->rhs() : bop->lhs();
+      epilogue.bias = matchBias(other, dtype, ndims, matched);
+      if (epilogue.bias == nullptr) {
+        return std::nullopt;
+      }
+      has_bias_add = true;
+    } else if (
+        use->isA<UnaryOp>() &&
+        use->as<UnaryOp>()->getUnaryOpType() == UnaryOpType::Relu &&
+        !epilogue.relu) {
+      epilogue.relu = true;
+    } else if (
+        !isWideningCast(use) &&
+        !(isCast(use) && use->output(0)->isFusionOutput())) {
+      return std::nullopt;
+    }
+    matched.insert(use);
+    val = use->output(0);
+  }
+
+  // Nothing to fuse, or other exprs in the fusion
+  if ((!has_bias_add && !epilogue.relu) || matched.size() != exprs.size()) {
+    return std::nullopt;
+  }
+
+  epilogue.output = val->as<TensorView>();
+  return epilogue;
+}
+
+void bindMatmulEpilogue(
+    const MatmulEpilogue& epilogue,
+    ExpressionEvaluator& ee) {
+  const auto a = ee.evaluate(epilogue.matmul->input(0)).as<at::Tensor>();
+  const auto b = ee.evaluate(epilogue.matmul->input(1)).as<at::Tensor>();
+  // The weight of a linear is [N, K]
+  const at::Tensor mat1 = a.reshape({-1, a.size(-1)});
+  const at::Tensor mat2 = epilogue.matmul->isA<LinearOp>() ? b.t() : b;
+
+  at::Tensor out;
+  if (epilogue.bias == nullptr) {
+    out = at::mm(mat1, mat2).relu_();
+  } else {
+    const auto bias = ee.evaluate(epilogue.bias).as<at::Tensor>();
+    out = epilogue.relu ? at::_addmm_activation(bias, mat1, mat2)
+                        : at::addmm(bias, mat1, mat2);
+  }
+
+  std::vector<int64_t> sizes(a.sizes().begin(), a.sizes().end() - 1);
+  sizes.push_back(mat2.size(1));
+  ee.bind(
+      epilogue.output,
+      out.view(sizes).to(data_type_to_aten(epilogue.output->dtype())));
+}
+
+// Check if the fusion has a single
+// MatmulOp/LinearOp/SdpaFwdOp/SdpaBwdOp/ScanOp/SortOp node, or a matmul with
+// its epilogue
 bool ExprEvalScheduler::canScheduleCompileTime(Fusion* fusion) {
   if (scheduler_utils::isResharding(fusion)) {
     scheduler_debug_utils::canScheduleRejectReason(
@@ -22,13 +211,19 @@ bool ExprEvalScheduler::canScheduleCompileTime(Fusion* fusion) {
   }
 
   auto exprs = fusion->exprs();
+  if (exprs.size() > 1 && isOptionEnabled(EnableOption::ExprEvalEpilogue) &&
+      !isOptionDisabled(DisableOption::MatmulExprEval) &&
+      matchMatmulEpilogue(fusion).has_value()) {
+    return true;
+  }
+
   if (exprs.size() != 1) {
     scheduler_debug_utils::canScheduleRejectReason(
         heuristicType(), "Fusion must contain only a single expression.");
     return false;
   }
 
-  if (exprs.front()->isOneOf<SdpaFwdOp, SdpaBwdOp>()) {
+  if (exprs.front()->isOneOf<SdpaFwdOp, SdpaBwdOp, ScanOp, SortOp>()) {
     return true;
   }
 
@@ -44,7 +239,7 @@ bool ExprEvalScheduler::canScheduleCompileTime(Fusion* fusion) {
 
   scheduler_debug_utils::canScheduleRejectReason(
       heuristicType(),
-      "Fusion must contain only a single expression of type MatmulOp/LinearOp/SdpaFwdOp/SdpaBwdOp");
+      "Fusion must contain only a single expression of type MatmulOp/LinearOp/SdpaFwdOp/SdpaBwdOp/ScanOp/SortOp");
   return false;
 }
 
@@ -10,12 +10,38 @@
 #include <scheduler/heuristic.h>
 #include <scheduler/registry.h>
 
+#include <optional>
+
 namespace nvfuser {
 
 class Fusion;
 class SchedulerRuntimeInfo;
 class HeuristicSummary;
 
+//! A MatmulOp or LinearOp followed by a bias add and a ReLU, possibly with
+//! casts in between, that an ExprEval segment runs as a single matmul with a
+//! fused epilogue. See Note [Matmul epilogues] in expr_eval_sched.cpp.
+struct MatmulEpilogue {
+  //! The MatmulOp or LinearOp
+  Expr* matmul = nullptr;
+  //! Fusion input added along the last dimension of the matmul, either the
+  //! bias of the LinearOp or the other operand of the bias add
+  TensorView* bias = nullptr;
+  bool relu = false;
+  //! The only output of the fusion
+  TensorView* output = nullptr;
+};
+
+//! Matches `fusion` with a matmul and its epilogue, if `fusion` has no other
+//! expressions and nothing to fuse with the matmul, returns std::nullopt
+std::optional<MatmulEpilogue> matchMatmulEpilogue(Fusion* fusion);
+
+//! Runs the matmul and its epilogue with ATen, which dispatches to cuBLASLt
+//! with the epilogue configured, and binds the output in `ee`
+void bindMatmulEpilogue(
+    const MatmulEpilogue& epilogue,
+    ExpressionEvaluator& ee);
+
 // ExprEval scheduler represents the case where we allocate outputs directly
 // using EE. No code is generated.
 class ExprEvalScheduler : public SchedulerEntry {
@@ -29,7 +55,8 @@ class ExprEvalScheduler : public SchedulerEntry {
         std::make_shared<HeuristicParams>("", runtime_info.getIndexType());
   }
 
-  // This scheduler only accepts MatmulOp.
+  // This scheduler only accepts a single MatmulOp, LinearOp, SdpaFwdOp,
+  // SdpaBwdOp, ScanOp or SortOp, or a matmul with its epilogue.
   static bool canScheduleCompileTime(Fusion* fusion);
 
   static bool canScheduleRunTime(
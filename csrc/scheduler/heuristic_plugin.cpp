@@ -0,0 +1,388 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+
+#include <ATen/cuda/CUDAContext.h>
+#include <ir/interface_nodes.h>
+#include <ir/utils.h>
+#include <scheduler/heuristic_plugin.h>
+#include <scheduler/pointwise_heuristic.h>
+#include <scheduler/reduction_heuristic.h>
+#include <scheduler/registry.h>
+#include <scheduler/transpose_heuristic.h>
+#include <scheduler/utils.h>
+#include <sys_utils.h>
+#include <utils.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+
+namespace nvfuser {
+
+namespace heuristic_plugin {
+
+namespace {
+
+std::mutex plugin_mutex;
+typedef std::unique_ptr<HeuristicConfig> (*HeuristicConfigFactoryPointer)();
+static class PluginInterface : LibraryLoader {
+ public:
+  PluginInterface() {
+    const char* envvar = getNvFuserEnv("HEURISTIC_PLUGIN");
+    if (envvar != nullptr) {
+      setFilename(envvar);
+    }
+  }
+
+  ~PluginInterface() = default;
+
+  bool available() const {
+    return !filename().empty();
+  }
+
+  std::unique_ptr<HeuristicConfig> getConfig() {
+    NVF_ERROR(available());
+    if (factory_func_ptr_ == nullptr) {
+      std::lock_guard<std::mutex> lock(plugin_mutex);
+      factory_func_ptr_ =
+          (HeuristicConfigFactoryPointer)getSymbol("makeHeuristicConfig");
+    }
+    return (*factory_func_ptr_)();
+  }
+
+ private:
+  HeuristicConfigFactoryPointer factory_func_ptr_ = nullptr;
+} plugin;
+
+std::unique_ptr<HeuristicConfig> defaultConfigFactory() {
+  return plugin.getConfig();
+}
+
+// See config_factory_modified in matmul_heuristic_plugin.cpp
+thread_local HeuristicConfigFactory config_factory = defaultConfigFactory;
+thread_local bool config_factory_modified = false;
+
+HeuristicConfig::Heuristic toPluginHeuristic(ScheduleHeuristic heuristic) {
+  switch (heuristic) {
+    case ScheduleHeuristic::PointWise:
+      return HeuristicConfig::Heuristic::PointWise;
+    case ScheduleHeuristic::Reduction:
+      return HeuristicConfig::Heuristic::Reduction;
+    case ScheduleHeuristic::InnerPersistent:
+      return HeuristicConfig::Heuristic::InnerPersistent;
+    case ScheduleHeuristic::OuterPersistent:
+      return HeuristicConfig::Heuristic::OuterPersistent;
+    case ScheduleHeuristic::InnerOuterPersistent:
+      return HeuristicConfig::Heuristic::InnerOuterPersistent;
+    case ScheduleHeuristic::Transpose:
+      return HeuristicConfig::Heuristic::Transpose;
+    default:
+      NVF_ERROR(false, "Heuristic not supported by the plugin: ", heuristic);
+      return HeuristicConfig::Heuristic::PointWise;
+  }
+}
+
+int64_t numel(
+    SchedulerRuntimeInfo& runtime_info,
+    const std::vector<IterDomain*>& domain) {
+  int64_t result = 1;
+  for (IterDomain* id : domain) {
+    if (id->isBroadcast()) {
+      continue;
+    }
+    auto extent = runtime_info.expressionEvaluator().evaluate(
+        id->getMaybeExpandedExtent());
+    NVF_ERROR(extent.hasValue(), "Could not evaluate ", id->toString());
+    result *= extent.as<int64_t>();
+  }
+  return result;
+}
+
+void fillProblemDescription(
+    HeuristicConfig::ProblemDescription& problem,
+    ScheduleHeuristic heuristic,
+    Fusion* fusion,
+    SchedulerRuntimeInfo& runtime_info) {
+  problem.heuristic = toPluginHeuristic(heuristic);
+
+  // Pick the reference tensor
+  TensorView* reference = nullptr;
+  bool is_reduction = heuristic != ScheduleHeuristic::PointWise &&
+      heuristic != ScheduleHeuristic::Transpose;
+  if (is_reduction) {
+    auto reduction_tvs = scheduler_utils::getReductionTvs(fusion);
+    NVF_ERROR(!reduction_tvs.empty(), "No reduction found for ", heuristic);
+    reference = reduction_tvs.front();
+    auto properties = scheduler_utils::getReductionProperties(
+        fusion, runtime_info, reference);
+    problem.total_reduction_numel = properties.total_reduction_numel;
+    problem.total_iteration_numel = properties.total_iteration_numel;
+    problem.fastest_dim_reduction = properties.fastest_dim_reduction;
+  } else {
+    int64_t max_numel = -1;
+    for (TensorView* tv :
+         ir_utils::filterByType<TensorView>(fusion->outputs())) {
+      const int64_t n = numel(
+          runtime_info, TensorDomain::noReductions(tv->getLogicalDomain()));
+      if (n > max_numel) {
+        max_numel = n;
+        reference = tv;
+      }
+    }
+    NVF_ERROR(reference != nullptr, "No tensor output found for ", heuristic);
+    problem.total_reduction_numel = 1;
+    problem.total_iteration_numel = max_numel;
+    problem.fastest_dim_reduction = false;
+  }
+
+  // Record the sizes of the reference, folding outer dimensions if needed
+  std::vector<IterDomain*> logical = reference->getLogicalDomain();
+  if (!is_reduction) {
+    logical = TensorDomain::noReductions(logical);
+  }
+  const int64_t num_dims = (int64_t)logical.size();
+  const int64_t num_folded =
+      std::max((int64_t)0, num_dims - HeuristicConfig::max_dims);
+  problem.num_dims = (uint8_t)(num_dims - num_folded);
+  problem.sizes.fill(1);
+  problem.reduction_dims = 0;
+  for (auto i : c10::irange(num_dims)) {
+    IterDomain* id = logical.at(i);
+    const int64_t pos = std::max((int64_t)0, i - num_folded);
+    problem.sizes.at(pos) *= numel(runtime_info, {id});
+    if (id->isReduction()) {
+      problem.reduction_dims |= (uint8_t)(1 << pos);
+    }
+  }
+
+  problem.num_tensor_inputs = 0;
+  problem.num_tensor_outputs = 0;
+  int64_t max_dtype_size = 0;
+  int64_t min_dtype_size = std::numeric_limits<int64_t>::max();
+  auto visit = [&](TensorView* tv) {
+    const int64_t size = dataTypeSize(tv->getDataType().value());
+    max_dtype_size = std::max(max_dtype_size, size);
+    min_dtype_size = std::min(min_dtype_size, size);
+  };
+  for (TensorView* tv : ir_utils::filterByType<TensorView>(fusion->inputs())) {
+    problem.num_tensor_inputs++;
+    visit(tv);
+  }
+  for (TensorView* tv : ir_utils::filterByType<TensorView>(fusion->outputs())) {
+    problem.num_tensor_outputs++;
+    visit(tv);
+  }
+  problem.max_dtype_size = (uint8_t)max_dtype_size;
+  problem.min_dtype_size = (uint8_t)(max_dtype_size > 0 ? min_dtype_size : 0);
+
+  const auto* properties = at::cuda::getCurrentDeviceProperties();
+  problem.device_major = (uint8_t)properties->major;
+  problem.device_minor = (uint8_t)properties->minor;
+  problem.sm_count = (uint16_t)properties->multiProcessorCount;
+}
+
+void copyParamsToConfig(
+    HeuristicConfig* config,
+    const HeuristicParams& params) {
+  const LaunchParams& lparams = params.lparams;
+  config->launch.gdimx = lparams.getRawVal(ParallelType::BIDx);
+  config->launch.gdimy = lparams.getRawVal(ParallelType::BIDy);
+  config->launch.gdimz = lparams.getRawVal(ParallelType::BIDz);
+  config->launch.bdimx = lparams.getRawVal(ParallelType::TIDx);
+  config->launch.bdimy = lparams.getRawVal(ParallelType::TIDy);
+  config->launch.bdimz = lparams.getRawVal(ParallelType::TIDz);
+
+  if (auto pparams = dynamic_cast<const PointwiseParams*>(&params)) {
+    auto& pointwise = config->pointwise;
+    pointwise.vectorize = pparams->vectorize;
+    pointwise.break_point = pparams->break_point;
+    pointwise.split_block = pparams->split_block;
+    pointwise.split_grid_y_dim = pparams->split_grid_y_dim;
+    pointwise.flip_grid_binding = pparams->flip_grid_binding;
+    pointwise.unroll_factor = pparams->unroll_factor;
+  } else if (auto rparams = dynamic_cast<const ReductionParams*>(&params)) {
+    auto& reduction = config->reduction;
+    reduction.cross_block_inner_reduction =
+        rparams->cross_block_inner_reduction;
+    reduction.cross_grid_inner_reduction = rparams->cross_grid_inner_reduction;
+    reduction.unroll_factor_inner_reduction =
+        rparams->unroll_factor_inner_reduction;
+    reduction.vectorize_inner_reduction = rparams->vectorize_inner_reduction;
+    reduction.batches_per_block_inner_reduction =
+        rparams->batches_per_block_inner_reduction;
+    reduction.multiple_reds_per_blk = rparams->multiple_reds_per_blk;
+    reduction.unroll_factor_iter_dom = rparams->unroll_factor_iter_dom;
+    reduction.vectorize_iter_dom = rparams->vectorize_iter_dom;
+    reduction.cross_block_outer_reduction =
+        rparams->cross_block_outer_reduction;
+    reduction.cross_grid_outer_reduction = rparams->cross_grid_outer_reduction;
+    reduction.batches_per_block_outer_reduction =
+        rparams->batches_per_block_outer_reduction;
+    reduction.unroll_factor_outer_reduction =
+        rparams->unroll_factor_outer_reduction;
+  } else if (auto tparams = dynamic_cast<const TransposeParams*>(&params)) {
+    auto& transpose = config->transpose;
+    transpose.tile_size1 = tparams->tile_size1;
+    transpose.tile_size2 = tparams->tile_size2;
+    transpose.vectorize_factor1 = tparams->vectorize_factor1;
+    transpose.vectorize_factor2 = tparams->vectorize_factor2;
+  }
+}
+
+void checkPositive(int64_t value, const char* name) {
+  NVF_CHECK(
+      value >= 1,
+      "Invalid ",
+      name,
+      " returned by heuristic plugin: ",
+      value,
+      ". Expected a positive value");
+}
+
+void copyConfigToParams(
+    HeuristicParams& params,
+    const HeuristicConfig* config) {
+  LaunchParams lparams(
+      config->launch.gdimx,
+      config->launch.gdimy,
+      config->launch.gdimz,
+      config->launch.bdimx,
+      config->launch.bdimy,
+      config->launch.bdimz);
+  lparams.setSmem(params.lparams.smem());
+  params.lparams = lparams;
+
+  if (auto pparams = dynamic_cast<PointwiseParams*>(&params)) {
+    const auto& pointwise = config->pointwise;
+    checkPositive(pointwise.unroll_factor, "unroll_factor");
+    NVF_CHECK(
+        pointwise.break_point == 0 ||
+            (pointwise.break_point > 0 &&
+             pointwise.break_point < config->problem.num_dims),
+        "Invalid break_point returned by heuristic plugin: ",
+        pointwise.break_point);
+    pparams->vectorize = pointwise.vectorize;
+    pparams->break_point = pointwise.break_point;
+    // The plugin API has no 3D or grid-stride schedules
+    pparams->break_point2 = 0;
+    pparams->serial_factor = 1;
+    pparams->grid_stride_blocks = 0;
+    pparams->grid_stride_prefetch = false;
+    pparams->split_block = pointwise.split_block;
+    pparams->split_grid_y_dim = pointwise.split_grid_y_dim;
+    pparams->flip_grid_binding = pointwise.flip_grid_binding;
+    pparams->unroll_factor = pointwise.unroll_factor;
+  } else if (auto rparams = dynamic_cast<ReductionParams*>(&params)) {
+    const auto& reduction = config->reduction;
+    checkPositive(
+        reduction.unroll_factor_inner_reduction,
+        "unroll_factor_inner_reduction");
+    checkPositive(
+        reduction.batches_per_block_inner_reduction,
+        "batches_per_block_inner_reduction");
+    checkPositive(reduction.unroll_factor_iter_dom, "unroll_factor_iter_dom");
+    checkPositive(
+        reduction.batches_per_block_outer_reduction,
+        "batches_per_block_outer_reduction");
+    checkPositive(
+        reduction.unroll_factor_outer_reduction,
+        "unroll_factor_outer_reduction");
+    rparams->cross_block_inner_reduction =
+        reduction.cross_block_inner_reduction;
+    rparams->cross_grid_inner_reduction = reduction.cross_grid_inner_reduction;
+    rparams->unroll_factor_inner_reduction =
+        reduction.unroll_factor_inner_reduction;
+    rparams->vectorize_inner_reduction = reduction.vectorize_inner_reduction;
+    rparams->batches_per_block_inner_reduction =
+        reduction.batches_per_block_inner_reduction;
+    rparams->multiple_reds_per_blk = reduction.multiple_reds_per_blk;
+    rparams->unroll_factor_iter_dom = reduction.unroll_factor_iter_dom;
+    rparams->vectorize_iter_dom = reduction.vectorize_iter_dom;
+    rparams->cross_block_outer_reduction =
+        reduction.cross_block_outer_reduction;
+    rparams->cross_grid_outer_reduction = reduction.cross_grid_outer_reduction;
+    rparams->batches_per_block_outer_reduction =
+        reduction.batches_per_block_outer_reduction;
+    rparams->unroll_factor_outer_reduction =
+        reduction.unroll_factor_outer_reduction;
+  } else if (auto tparams = dynamic_cast<TransposeParams*>(&params)) {
+    const auto& transpose = config->transpose;
+    checkPositive(transpose.tile_size1, "tile_size1");
+    checkPositive(transpose.tile_size2, "tile_size2");
+    checkPositive(transpose.vectorize_factor1, "vectorize_factor1");
+    checkPositive(transpose.vectorize_factor2, "vectorize_factor2");
+    tparams->tile_size1 = transpose.tile_size1;
+    tparams->tile_size2 = transpose.tile_size2;
+    tparams->vectorize_factor1 = transpose.vectorize_factor1;
+    tparams->vectorize_factor2 = transpose.vectorize_factor2;
+  }
+}
+
+} // namespace
+
+bool isSupported(ScheduleHeuristic heuristic) {
+  switch (heuristic) {
+    case ScheduleHeuristic::PointWise:
+    case ScheduleHeuristic::Reduction:
+    case ScheduleHeuristic::InnerPersistent:
+    case ScheduleHeuristic::OuterPersistent:
+    case ScheduleHeuristic::InnerOuterPersistent:
+    case ScheduleHeuristic::Transpose:
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool updateParams(
+    ScheduleHeuristic heuristic,
+    Fusion* fusion,
+    SchedulerRuntimeInfo& runtime_info,
+    HeuristicParams& params) {
+  if (!hasPlugin() || !isSupported(heuristic)) {
+    return false;
+  }
+
+  // Use factory function to create an empty config
+  std::unique_ptr<HeuristicConfig> config = config_factory();
+
+  // Set previous heuristic values so they are available to the plugin
+  copyParamsToConfig(config.get(), params);
+  fillProblemDescription(config->problem, heuristic, fusion, runtime_info);
+
+  // Execute the user-provided heuristic
+  config->configure();
+
+  // Load values from config back into params
+  copyConfigToParams(params, config.get());
+
+  return true;
+}
+
+bool hasPlugin() {
+  return config_factory_modified || plugin.available();
+}
+
+HeuristicConfigFactoryGuard::HeuristicConfigFactoryGuard(
+    HeuristicConfigFactory func)
+    : prev_factory_(config_factory),
+      prev_factory_modified_(config_factory_modified) {
+  config_factory = func;
+  config_factory_modified = true;
+}
+
+HeuristicConfigFactoryGuard::~HeuristicConfigFactoryGuard() {
+  config_factory = prev_factory_;
+  config_factory_modified = prev_factory_modified_;
+}
+
+} // namespace heuristic_plugin
+
+} // namespace nvfuser
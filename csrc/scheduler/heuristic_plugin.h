@@ -0,0 +1,66 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#pragma once
+
+#include <fusion.h>
+#include <scheduler/heuristic.h>
+#include <scheduler/heuristic_plugin_api.h>
+#include <scheduler/heuristic_types.h>
+
+#include <functional>
+#include <memory>
+
+namespace nvfuser {
+
+class SchedulerRuntimeInfo;
+
+namespace heuristic_plugin {
+
+//! Returns true if HeuristicConfigFactoryGuard is active indicating an
+//! imitated plugin, or if a shared library plugin has been provided using the
+//! environment variable NVFUSER_HEURISTIC_PLUGIN.
+bool hasPlugin();
+
+//! Whether the plugin is consulted for the parameters of `heuristic`
+bool isSupported(ScheduleHeuristic heuristic);
+
+//! If there is no user-defined plugin (see hasPlugin()) or `heuristic` is not
+//! supported, we return false. Otherwise, we use the plugin to modify the
+//! heuristic parameters computed for `fusion` in place.
+bool updateParams(
+    ScheduleHeuristic heuristic,
+    Fusion* fusion,
+    SchedulerRuntimeInfo& runtime_info,
+    HeuristicParams& params);
+
+//! Defines the type of the "makeHeuristicConfig" symbol
+using HeuristicConfigFactory =
+    std::function<std::unique_ptr<HeuristicConfig>()>;
+
+//! This can be used to imitate a plugin, like
+//! matmul_heuristic_plugin::KernelConfigFactoryGuard:
+//!
+//!   HeuristicConfigFactoryGuard hfg([]() {
+//!     return std::unique_ptr<HeuristicConfig>(new MyHeuristicConfig);
+//!   });
+//!
+//! When hfg passes out of scope, the config factory will be reset to its prior
+//! value.
+class HeuristicConfigFactoryGuard {
+ public:
+  explicit HeuristicConfigFactoryGuard(HeuristicConfigFactory func);
+  ~HeuristicConfigFactoryGuard();
+
+ private:
+  HeuristicConfigFactory prev_factory_;
+  bool prev_factory_modified_;
+};
+
+} // namespace heuristic_plugin
+
+} // namespace nvfuser
@@ -0,0 +1,133 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+
+namespace nvfuser {
+
+namespace heuristic_plugin {
+
+//! This is the counterpart of matmul_heuristic_plugin_api.h for the pointwise,
+//! reduction, persistent and transpose schedulers. In order to plug in your own
+//! heuristic, create a dynamic library defining a subclass of HeuristicConfig,
+//! overriding the `configure` method, and export a
+//! std::unique_ptr<HeuristicConfig> makeHeuristicConfig() function that returns
+//! a unique_ptr to an object of that type.
+//!
+//! For every segment scheduled with one of these schedulers, nvFuser fills
+//! `problem` and the parameters of the heuristic with the values picked by its
+//! own heuristic, then calls `configure`. The plugin may modify the parameters
+//! of `problem.heuristic` and leave everything else untouched.
+//!
+//! If that library is located at /path/to/libfoo.so you can set
+//! NVFUSER_HEURISTIC_PLUGIN=/path/to/libfoo.so to use the plugin.
+
+struct HeuristicConfig {
+  //! Explicit integer mapping for the schedulers handled by the plugin
+  enum class Heuristic {
+    PointWise = 0,
+    Reduction = 1,
+    InnerPersistent = 2,
+    OuterPersistent = 3,
+    InnerOuterPersistent = 4,
+    Transpose = 5,
+  };
+
+  //! Maximum number of dimensions in ProblemDescription::sizes
+  static constexpr int64_t max_dims = 8;
+
+  //! This is the information available to the plugin to determine the kernel
+  //! configuration.
+  struct ProblemDescription {
+    Heuristic heuristic = Heuristic::PointWise;
+    //! Logical sizes of the reference tensor: the first reduction tensor for
+    //! reduction and persistent kernels, and the largest output otherwise.
+    //! Outer dimensions beyond max_dims are folded into sizes[0].
+    uint8_t num_dims = 0;
+    std::array<int64_t, max_dims> sizes = {};
+    //! Bit i is set if dimension i of the reference tensor is reduced
+    uint8_t reduction_dims = 0;
+    //! Number of elements reduced, and of reductions performed
+    int64_t total_reduction_numel = 1;
+    int64_t total_iteration_numel = 1;
+    //! Whether the innermost dimension is reduced
+    bool fastest_dim_reduction = false;
+    uint16_t num_tensor_inputs = 0;
+    uint16_t num_tensor_outputs = 0;
+    //! Size in bytes of the widest and of the narrowest tensor input or output
+    uint8_t max_dtype_size = 0;
+    uint8_t min_dtype_size = 0;
+    //! Compute capability and number of SMs of the device
+    uint8_t device_major = 0;
+    uint8_t device_minor = 0;
+    uint16_t sm_count = 0;
+  } problem;
+
+  //! Launch parameters. -1 leaves a dimension to be inferred from the
+  //! scheduled kernel.
+  struct Launch {
+    int64_t gdimx = -1;
+    int64_t gdimy = -1;
+    int64_t gdimz = -1;
+    int64_t bdimx = -1;
+    int64_t bdimy = -1;
+    int64_t bdimz = -1;
+  } launch;
+
+  //! Subset of PointwiseParams
+  struct Pointwise {
+    bool vectorize = false;
+    int64_t break_point = 0;
+    bool split_block = false;
+    bool split_grid_y_dim = false;
+    bool flip_grid_binding = false;
+    int64_t unroll_factor = 1;
+  } pointwise;
+
+  //! Subset of ReductionParams, used by the reduction and persistent
+  //! schedulers. The parallel types of the dimensions are not exposed, so the
+  //! cross-block and cross-grid flags should only be changed together with
+  //! a block or grid dimension bound by nvFuser's heuristic.
+  struct Reduction {
+    bool cross_block_inner_reduction = false;
+    bool cross_grid_inner_reduction = false;
+    int64_t unroll_factor_inner_reduction = 1;
+    bool vectorize_inner_reduction = false;
+    int64_t batches_per_block_inner_reduction = 1;
+    bool multiple_reds_per_blk = false;
+    int64_t unroll_factor_iter_dom = 1;
+    bool vectorize_iter_dom = false;
+    bool cross_block_outer_reduction = false;
+    bool cross_grid_outer_reduction = false;
+    int64_t batches_per_block_outer_reduction = 1;
+    int64_t unroll_factor_outer_reduction = 1;
+  } reduction;
+
+  //! Subset of TransposeParams
+  struct Transpose {
+    int64_t tile_size1 = 32;
+    int64_t tile_size2 = 32;
+    int64_t vectorize_factor1 = 1;
+    int64_t vectorize_factor2 = 1;
+  } transpose;
+
+ public:
+  // This should be overridden to implement the actual heuristic logic
+  virtual void configure() = 0;
+
+  // This allows us to use a std::unique_ptr<HeuristicConfig> and call derived
+  // classes' destructors on deletion.
+  virtual ~HeuristicConfig() = default;
+};
+
+} // namespace heuristic_plugin
+
+} // namespace nvfuser
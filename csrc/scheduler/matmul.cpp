@@ -9,6 +9,7 @@
 #include <device_lower/analysis/circular_buffer.h>
 #include <inlining.h>
 #include <instrumentation.h>
+#include <iter_visitor.h>
 #include <multidevice/utils.h>
 #include <scheduler/debug_utils.h>
 #include <scheduler/matmul.h>
@@ -143,12 +144,14 @@ AbstractTensor swizzleSharedMemory(TensorView* shared_mem_tv) {
       swizzle_domain[-1]->extent()->evaluate().as<int64_t>();
 
   // Only tested for (1) ldmatrix access with sizeof(T) == 16bit (i.e.
-  // half/bfloat16) and (2) epilogue general access with sizeof(T) == 32bit
-  // (i.e. float)
+  // half/bfloat16) or 8bit (i.e. fp8 and int8) and (2) epilogue general access
+  // with sizeof(T) == 32bit (i.e. float and int32)
   const int64_t data_type_size = dataTypeSize(*shared_mem_tv->getDataType());
-  NVF_ERROR(data_type_size == 2 || data_type_size == 4);
+  NVF_ERROR(
+      data_type_size == 1 || data_type_size == 2 || data_type_size == 4);
 
-  // For main loop, ldmatrix loads a n_rows x n_cols = 8 x 8 matrix each time.
+  // For main loop, ldmatrix loads a n_rows x n_cols = 8 x 8 matrix each time,
+  // or 8 x 16 for 8-bit items, as its rows are 16 bytes.
   // For epilogue, threads in a warp is organized as 8 rows x 4 columns.
   // Each thread vectorized write 2 items, so 8 items per row.
   //--0--1--2--3
@@ -160,9 +163,10 @@ AbstractTensor swizzleSharedMemory(TensorView* shared_mem_tv) {
   //--24-25-26-27
   //--28-29-30-31
   constexpr int64_t n_rows = 8;
-  constexpr int64_t n_cols = 8;
+  const int64_t n_cols = data_type_size == 1 ? 16 : 8;
 
-  // Column size of the tile needs to be multiples of 8 for ldmatrix to work.
+  // Column size of the tile needs to be multiples of n_cols for ldmatrix to
+  // work.
   NVF_ERROR(
       tile_size_x >= n_rows && tile_size_x % n_rows == 0 &&
           tile_size_y >= n_cols && tile_size_y % n_cols == 0,
@@ -731,8 +735,169 @@ void scheduleSplitKSum(
   splitk_sum->axis(-1)->parallelize(ParallelType::Vectorize);
 }
 
+//! Schedules the epilogue of a matmul with reductions of the N dimensions. The
+//!  output tensors with M and N dimensions and the epilogue reductions are all
+//!  given the layout
+//!    [..., Mo, No, m/tidz/tidy, tidz, tidy, n/vect/TIDx, TIDx, vect]
+//!  which, unlike scheduleOutputTensor, does not merge M and N. The
+//!  transformations are propagated back to smem_epilogue and forward from the
+//!  reductions to the outputs computed from them. See
+//!  [ Note -- Matmul epilogue reductions ].
+void scheduleEpilogueReductions(
+    TensorView* mma_result,
+    TensorView* smem_epilogue,
+    const std::vector<TensorView*>& reduction_tvs,
+    const std::vector<TensorView*>& output_tvs,
+    const MatMulTileOptions& gemm_tile,
+    int64_t vectorization_factor,
+    int64_t num_device_and_batch_dims) {
+  constexpr int64_t warp_size = 32l;
+  const int64_t tidy = gemm_tile.cta_tile.n / gemm_tile.warp_tile.n;
+  const int64_t tidz = gemm_tile.cta_tile.m / gemm_tile.warp_tile.m;
+  NVF_ERROR(
+      gemm_tile.cta_tile.n % warp_size == 0 &&
+          gemm_tile.cta_tile.m % (tidy * tidz) == 0,
+      "CTA tile ",
+      toString(gemm_tile.cta_tile),
+      " cannot be distributed over ",
+      warp_size * tidy * tidz,
+      " threads along M and N");
+  // A warp covers whole vectors of a row of the tile
+  int64_t vect = vectorization_factor;
+  while (gemm_tile.cta_tile.n % (vect * warp_size) != 0) {
+    vect /= 2;
+  }
+
+  const auto schedule_tile = [&](TensorView* tv) {
+    // [..., Mo, No, cta_tile_m, cta_tile_n]
+    checkConcreteStaticDim(tv->axis(-2));
+    checkConcreteStaticDim(tv->axis(-1));
+    NVF_ERROR(
+        tv->axis(-2)->extent()->evaluate().as<int64_t>() ==
+                gemm_tile.cta_tile.m &&
+            tv->axis(-1)->extent()->evaluate().as<int64_t>() ==
+                gemm_tile.cta_tile.n,
+        "Expected the CTA tile in the innermost dimensions of ",
+        tv->toString());
+    tv->split(-1, vect);
+    tv->split(-2, warp_size);
+    // [..., Mo, No, m, n/vect/TIDx, TIDx, vect]
+    tv->split(-4, tidy);
+    tv->split(-5, tidz);
+    // [..., Mo, No, m/tidz/tidy, tidz, tidy, n/vect/TIDx, TIDx, vect]
+    tv->axis(-5)->parallelize(ParallelType::TIDz);
+    tv->axis(-4)->parallelize(ParallelType::TIDy);
+    tv->axis(-2)->parallelize(ParallelType::TIDx);
+    scheduler_utils::parallelizeAllLike(
+        mma_result,
+        num_device_and_batch_dims + 2,
+        {tv},
+        {ParallelType::BIDx, ParallelType::BIDy, ParallelType::BIDz});
+  };
+
+  const auto depends_on_reduction = [&reduction_tvs](TensorView* tv) {
+    return std::any_of(
+        reduction_tvs.begin(), reduction_tvs.end(), [tv](TensorView* r) {
+          return DependencyCheck::isDependencyOf(r, tv);
+        });
+  };
+
+  for (TensorView* d : output_tvs) {
+    if (depends_on_reduction(d)) {
+      continue;
+    }
+    schedule_tile(d);
+    d->axis(-1)->parallelize(ParallelType::Vectorize);
+    scheduler_utils::BoundedDirectionalTransformPropagator::backward(
+        d, -1, {smem_epilogue});
+  }
+
+  for (TensorView* r : reduction_tvs) {
+    schedule_tile(r);
+    scheduler_utils::BoundedDirectionalTransformPropagator::backward(
+        r, -1, {smem_epilogue});
+
+    // Each thread first reduces its own elements of a row, then the warp
+    // reduces along TIDx and the CTAs along No
+    //   r_rf [..., iMo, iNo, iS, iTz, iTy, rS, iTx, rS]
+    //   r    [..., iMo, rNo, iS, iTz, iTy, rTx]
+    TensorView* r_rf = r->rFactor({-3, -1});
+    scheduler_utils::parallelizeAllLike(r_rf, -1, {r});
+
+    std::vector<TensorView*> consumers_of_r;
+    std::copy_if(
+        output_tvs.begin(),
+        output_tvs.end(),
+        std::back_inserter(consumers_of_r),
+        [r](TensorView* d) { return DependencyCheck::isDependencyOf(r, d); });
+    scheduler_utils::BoundedDirectionalTransformPropagator::forward(
+        r,
+        -1,
+        consumers_of_r,
+        scheduler_utils::BoundedDirectionalTransformPropagator::Options()
+            .propagateParallelType()
+            .propagateToBoundary());
+  }
+}
+
 } // namespace
 
+// [ Note -- Matmul epilogue reductions ]
+//
+// With NVFUSER_ENABLE=matmul_epilogue_reduction, the epilogue can reduce the N
+// dimensions, e.g. to compute row sums or the statistics of a normalization
+// next to the output itself:
+//
+//   D = gelu(A x B + bias)
+//   S = sum(D, N)
+//   Q = sum(D * D, N)
+//
+// Without it the segmenter puts the reductions in a separate segment, which
+// reads D back from global memory.
+//
+// The MMA results are distributed over the threads of a warp in a layout that
+// mixes M and N, so they are first written to shared memory; the
+// smem_epilogue. The outputs and the reductions then read it back with the
+// layout of scheduleEpilogueReductions, where each thread holds elements of a
+// single row. A row is reduced serially in each thread, then across TIDx, and
+// finally across the CTAs of the N tiles with a grid reduction over No. When
+// the CTA tile covers N there is a single N tile and the grid reduction only
+// has one participant.
+//
+// The grid swizzle, split-K and persistent CTAs would merge No with other
+// dimensions, which a reduction cannot do, so getMatmulHeuristics disables
+// them for such fusions. Results of the reductions can only flow to outputs
+// without N dimensions: broadcasting them back along N, as in a softmax or a
+// layer norm, would need all the N tiles of a row at once. Such fusions are
+// still segmented after the reductions.
+
+// [ Note -- Persistent matmul ]
+//
+// By default each CTA computes one output tile, so when the number of tiles is
+// not a multiple of the number of SMs (or is smaller than it, as for skinny
+// GEMMs with a handful of rows) the last wave leaves most SMs idle. With
+// MatmulParams::num_persistent_ctas, the M and N tile dimensions are merged
+// and split by the number of CTAs:
+//
+//   [..., iMo, iNo, ...] -> [..., iMo*iNo/ctas, ctas, ...]
+//
+// The inner dimension is bound to BIDx and the outer one is a serial loop, so
+// CTA x computes tiles x, x + ctas, x + 2 * ctas, ... The merge follows the CTA
+// rasterization order, so consecutive CTAs share the operand tiles of a row or
+// column.
+//
+// Combined with split-K, the grid becomes ctas x splitk_factor and every K
+// slice of a tile is accumulated with the serial grid reduction. The blocks of
+// a slice visit the tiles in the same order and the last one resets the
+// semaphore of the reduction, so it is reused by the next tile. Choosing both
+// factors lets the units of work, tiles times K slices, fill whole waves. See
+// getMatmulHeuristics for how they are chosen with
+// NVFUSER_ENABLE=persistent_matmul.
+//
+// The operand buffers are reused across iterations of the tile loop, so the
+// shared memory of the prologue cannot be promoted for reuse by the epilogue,
+// as with an outer batch loop.
+
 void scheduleMatmul(Fusion* fusion, const MatmulParams& params) {
   FusionGuard fg(fusion);
 
@@ -838,6 +1003,16 @@ void scheduleMatmul(Fusion* fusion, const MatmulParams& params) {
   // Setup accumulator register.
   auto mma_result = mma->out()->as<TensorView>();
 
+  // See [ Note -- Matmul epilogue reductions ]
+  const std::vector<TensorView*> epilogue_reductions =
+      mma_utils::getEpilogueReductions(fusion, mma_result);
+  NVF_ERROR(
+      epilogue_reductions.empty() ||
+          (params.use_smem_epilogue && params.splitk_factor == 1 &&
+           params.grid_swizzle_factor == 1 && params.num_persistent_ctas == 0),
+      "Epilogue reductions require a shared memory epilogue without split-K, ",
+      "grid swizzle or persistent CTAs");
+
   // TODO:
   //  Significant build out needed here
   //   for more flexibility and data type support.
@@ -962,6 +1137,18 @@ void scheduleMatmul(Fusion* fusion, const MatmulParams& params) {
     }
   }
 
+  // Distribute the tiles over persistent CTAs. See
+  // [ Note -- Persistent matmul ]
+  if (params.num_persistent_ctas > 0) {
+    if (params.cta_order == MatmulParams::TileRasterizationOrder::ColumnMajor) {
+      mma_result->reorder(
+          {{num_device_and_batch_dims, num_device_and_batch_dims + 1}});
+    }
+    mma_result->merge(num_device_and_batch_dims);
+    mma_result->split(num_device_and_batch_dims, params.num_persistent_ctas);
+    // [..., iMo*iNo/ctas, ctas, rKo, iMi, iNi, rKi]
+  }
+
   // [..., iMo, iNo, rKo, iMi, iNi, rKi]
   int num_splitk_dims = 0;
   TensorView* splitk_sum = nullptr;
@@ -1096,7 +1283,7 @@ void scheduleMatmul(Fusion* fusion, const MatmulParams& params) {
   //                              iNw iMino iNino iMin2 iNin2 rKino rKin4 rKin2]
   {
     auto s = mma_utils::MmaSwizzler::scheduleMmaOutputAllocation(
-        mma_result->getLoopDomain());
+        mma_result->getLoopDomain(), 4 / dataTypeSize(acw_smem->dtype()));
     mma_result->setLoopDomain(s.as<IterDomain*>());
     mma_result->setAllocationDomain(s.as<IterDomain*>(), true);
   }
@@ -1172,22 +1359,28 @@ void scheduleMatmul(Fusion* fusion, const MatmulParams& params) {
   } else if (num_local_batch_dims > 0) {
     mma_result->axis(num_device_dims)->parallelize(ParallelType::BIDz);
   }
-  switch (params.cta_order) {
-    case MatmulParams::TileRasterizationOrder::RowMajor:
-      mma_result->axis(num_device_and_batch_dims)
-          ->parallelize(ParallelType::BIDx);
-      mma_result->axis(num_device_and_batch_dims + 1)
-          ->parallelize(ParallelType::BIDy);
-      break;
-    case MatmulParams::TileRasterizationOrder::ColumnMajor:
-      mma_result->axis(num_device_and_batch_dims)
-          ->parallelize(ParallelType::BIDy);
-      mma_result->axis(num_device_and_batch_dims + 1)
-          ->parallelize(ParallelType::BIDx);
-      break;
-    default:
-      NVF_ERROR(
-          false, "Invalid TileRasterizationOrder passed to Matmul scheduler");
+  if (params.num_persistent_ctas > 0) {
+    // The outer tile loop is left serial
+    mma_result->axis(num_device_and_batch_dims + 1)
+        ->parallelize(ParallelType::BIDx);
+  } else {
+    switch (params.cta_order) {
+      case MatmulParams::TileRasterizationOrder::RowMajor:
+        mma_result->axis(num_device_and_batch_dims)
+            ->parallelize(ParallelType::BIDx);
+        mma_result->axis(num_device_and_batch_dims + 1)
+            ->parallelize(ParallelType::BIDy);
+        break;
+      case MatmulParams::TileRasterizationOrder::ColumnMajor:
+        mma_result->axis(num_device_and_batch_dims)
+            ->parallelize(ParallelType::BIDy);
+        mma_result->axis(num_device_and_batch_dims + 1)
+            ->parallelize(ParallelType::BIDx);
+        break;
+      default:
+        NVF_ERROR(
+            false, "Invalid TileRasterizationOrder passed to Matmul scheduler");
+    }
   }
 
   // parallelize Mwo, Nwo by thread
@@ -1216,16 +1409,32 @@ void scheduleMatmul(Fusion* fusion, const MatmulParams& params) {
             .propagateToBoundary());
     smem_epilogue->axis(-1)->parallelize(ParallelType::Vectorize);
 
-    for (auto [dc, d] : cached_outputs) {
-      // Schedule output tensor differently for better global memory access
-      // pattern.
-      scheduleOutputTensor(
-          mma_result, d, gemm_tile, params.supported_vec_size.epilogue);
-      d->axis(-1)->parallelize(ParallelType::Vectorize);
-
-      // Propagate output tensor transformations back to smem_epilogue
-      scheduler_utils::BoundedDirectionalTransformPropagator::backward(
-          d, -1, {smem_epilogue});
+    if (!epilogue_reductions.empty()) {
+      std::vector<TensorView*> output_tvs;
+      output_tvs.reserve(cached_outputs.size());
+      for (auto [dc, d] : cached_outputs) {
+        output_tvs.push_back(d);
+      }
+      scheduleEpilogueReductions(
+          mma_result,
+          smem_epilogue,
+          epilogue_reductions,
+          output_tvs,
+          gemm_tile,
+          params.supported_vec_size.epilogue,
+          num_device_and_batch_dims);
+    } else {
+      for (auto [dc, d] : cached_outputs) {
+        // Schedule output tensor differently for better global memory access
+        // pattern.
+        scheduleOutputTensor(
+            mma_result, d, gemm_tile, params.supported_vec_size.epilogue);
+        d->axis(-1)->parallelize(ParallelType::Vectorize);
+
+        // Propagate output tensor transformations back to smem_epilogue
+        scheduler_utils::BoundedDirectionalTransformPropagator::backward(
+            d, -1, {smem_epilogue});
+      }
     }
   } else {
     for (auto [dc, d] : cached_outputs) {
@@ -1314,10 +1523,11 @@ void scheduleMatmul(Fusion* fusion, const MatmulParams& params) {
   NVF_ERROR(!cached_outputs.empty());
   mma_utils::MmaDataTypes data_types = {
       a->dtype(), b->dtype(), mma_result->dtype()};
-  // NOTE: Batch split-K matmuls cannot currently re-use smem due to outer
-  // batch loop
+  // NOTE: Batch split-K and persistent matmuls cannot currently re-use smem
+  // due to outer batch or tile loop
   bool guaranteed_operand_reuse =
-      num_local_batch_dims == 0 || num_splitk_dims == 0;
+      (num_local_batch_dims == 0 || num_splitk_dims == 0) &&
+      params.num_persistent_ctas == 0;
   int64_t estimated_smem = mma_utils::computeExpectedSharedMemoryUsage(
       params,
       data_types,
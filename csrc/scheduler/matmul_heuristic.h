@@ -181,6 +181,14 @@ class MatmulParams : public HeuristicParams {
   //! axis and perform a grid reduction before the epilogue.
   int splitk_factor = 1;
 
+  //! If positive, launch a persistent kernel with this many CTAs along the
+  //! M and N tiles instead of one CTA per output tile. Each CTA loops over
+  //! the tiles, taking every num_persistent_ctas-th tile. This can be combined
+  //! with splitk_factor, in which case the grid is num_persistent_ctas x
+  //! splitk_factor and each K slice of a tile is reduced by the serial grid
+  //! reduction of split-K.
+  int num_persistent_ctas = 0;
+
   std::string toString() const override {
     std::stringstream ss;
     ss << "\n===== Matmul Parameters ========\n"
@@ -208,6 +216,7 @@ class MatmulParams : public HeuristicParams {
        << "Promote re-use of prologue shared memory: "
        << promote_prologue_smem_reuse << "\n"
        << "Split-K factor: " << splitk_factor << "\n"
+       << "Persistent CTAs: " << num_persistent_ctas << "\n"
        << "====================================\n";
     return ss.str();
   }
@@ -226,7 +235,8 @@ class MatmulParams : public HeuristicParams {
         (nvfuser::hash(tile_sizes) << 3) ^
         (std::hash<size_t>{}(static_cast<size_t>(cta_order)) << 4) ^
         (std::hash<size_t>{}(grid_swizzle_factor) << 5) ^
-        (std::hash<size_t>{}(splitk_factor) << 6);
+        (std::hash<size_t>{}(splitk_factor) << 6) ^
+        (std::hash<size_t>{}(num_persistent_ctas) << 7);
     return attr_hash;
   }
 
@@ -249,7 +259,8 @@ class MatmulParams : public HeuristicParams {
         other_casted->use_smem_epilogue == use_smem_epilogue &&
         other_casted->promote_prologue_smem_reuse ==
         promote_prologue_smem_reuse &&
-        other_casted->splitk_factor == splitk_factor;
+        other_casted->splitk_factor == splitk_factor &&
+        other_casted->num_persistent_ctas == num_persistent_ctas;
   }
 
   std::shared_ptr<HeuristicParams> clone() const override {
@@ -8,6 +8,7 @@
 
 #include <ir/interface_nodes.h>
 #include <mma_type.h>
+#include <options.h>
 #include <scheduler/matmul_heuristic_plugin.h>
 #include <scheduler/mma_utils.h>
 #include <sys_utils.h>
@@ -103,8 +104,8 @@ std::string rolesToPrecisionString(
       a->dtype() == b->dtype(), "Differing A and B dtypes not yet supported");
   TensorView* d = tensor_roles.at(MatmulTensorRole::OUTPUT).front();
   precision[0] = mma_utils::dtypeToChar(a->dtype());
-  // NOTE: this assumes compute type is Float
-  precision[1] = 'S';
+  // NOTE: this assumes compute type is Float, or Int32 for int8 operands
+  precision[1] = a->dtype() == DataType::Int8 ? 'I' : 'S';
   precision[2] = mma_utils::dtypeToChar(d->dtype());
   return precision;
 }
@@ -239,8 +240,12 @@ bool hasPlugin() {
   // actually available.
 
   // To check whether we have set a non-default factory, find the address of
-  // config_factory and compare it to defaultConfigFactory.
-  return config_factory_modified || plugin.available();
+  // config_factory and compare it to defaultConfigFactory. A loaded plugin can
+  // be ignored with NVFUSER_DISABLE=matmul_heuristic_plugin, e.g., to compare
+  // it with the default heuristic in the same process.
+  return config_factory_modified ||
+      (plugin.available() &&
+       !isOptionDisabled(DisableOption::MatmulHeuristicPlugin));
 }
 
 KernelConfigFactoryGuard::KernelConfigFactoryGuard(KernelConfigFactory func)
@@ -21,7 +21,8 @@ namespace matmul_heuristic_plugin {
 
 //! Returns true if KernelConfigFactoryGuard is active indicating an imitated
 //! plugin, or if a shared library plugin has been provided using the
-//! environment variable NVFUSER_MATMUL_HEURISTIC_PLUGIN.
+//! environment variable NVFUSER_MATMUL_HEURISTIC_PLUGIN and is not disabled
+//! with NVFUSER_DISABLE=matmul_heuristic_plugin.
 bool hasPlugin();
 
 //! If there is no user-defined plugin (see hasPlugin()) we return false.
@@ -20,6 +20,7 @@
 #include <ir/interface_nodes.h>
 #include <ir/internal_nodes.h>
 #include <ir/utils.h>
+#include <iter_visitor.h>
 #include <options.h>
 #include <val_graph.h>
 #include <algorithm>
@@ -43,16 +44,32 @@ namespace {
 //! Access to the structure should be done with labels defined in MatmulDimRole.
 using ProblemShape = std::array<int64_t, 4>;
 
+//! Whether `dtype` is one of the fp8 types Ada MMAs take as operands
+bool isFp8MmaOperandType(DataType dtype) {
+  return dtype == DataType::Float8_e4m3fn || dtype == DataType::Float8_e5m2;
+}
+
 //! A helper for deciding the type of MMA op for given fusion and problem shape.
 inline std::optional<MmaMacro> getMmaOp(
     const int dev_version,
-    const ProblemShape& problem) {
+    const ProblemShape& problem,
+    const DataType operand_type = DataType::Half) {
   using MacroType = MmaMacro;
 
   // NOTE: A temp condition
   const ProblemShape::value_type n_extend = problem[(size_t)MatmulDimRole::N];
   const bool use_small_n = ((n_extend % 8) == 0) && ((n_extend % 16) != 0);
 
+  if (isFp8MmaOperandType(operand_type) || operand_type == DataType::Int8) {
+    // The 8-bit mma.sync instructions have a K of 32. The int8 ones need sm80
+    // or newer and the fp8 ones sm89 or newer
+    if (dev_version < (operand_type == DataType::Int8 ? 80 : 89)) {
+      return std::nullopt;
+    }
+    return (use_small_n) ? MacroType::Ampere_16_8_32
+                         : MacroType::Ampere_16_16_32;
+  }
+
   switch (dev_version) {
     case 75:
       return (use_small_n) ? MacroType::Turing_16_8_16
@@ -91,6 +108,64 @@ void limitCircularBufferingSmemOperands(
   params->circular_buffer_options.smem_circular_buffer_stage = (int)stages;
 }
 
+//! Pick the number of persistent CTAs and the split-K factor so that the units
+//! of work, i.e. the output tiles times their K slices, fill whole waves of
+//! the SMs. See [ Note -- Persistent matmul ] in matmul.cpp.
+void setPersistentCtas(
+    std::shared_ptr<MatmulParams> params,
+    const ProblemShape& problem_shape,
+    int64_t num_sms) {
+  // Batched matmuls spread the batches over BIDz, which is also the split-K
+  // dimension
+  if (problem_shape[(size_t)MatmulDimRole::Batch] != 1 ||
+      params->splitk_factor != 1) {
+    return;
+  }
+  const GemmTile& cta_tile = params->tile_sizes.cta_tile;
+  const int64_t num_tiles =
+      ceilDiv(problem_shape[(size_t)MatmulDimRole::M], cta_tile.m) *
+      ceilDiv(problem_shape[(size_t)MatmulDimRole::N], cta_tile.n);
+  const int64_t num_k_tiles =
+      ceilDiv(problem_shape[(size_t)MatmulDimRole::K], cta_tile.k);
+  // Each K slice should still fill the circular buffering pipeline
+  const int64_t min_k_tiles_per_slice = std::max(
+      2, params->circular_buffer_options.smem_circular_buffer_stage);
+  // Relative cost of each additional K slice, whose partial sums go through
+  // global memory
+  constexpr double splitk_overhead = 0.1;
+  constexpr int64_t max_splitk = 16;
+
+  // The cost is the time of the slowest CTA in units of the time to compute
+  // a whole tile
+  int64_t best_splitk = 1;
+  int64_t best_ctas = std::min(num_tiles, num_sms);
+  double best_cost = (double)ceilDiv(num_tiles, best_ctas);
+  for (int64_t splitk = 2; splitk <= max_splitk &&
+       num_k_tiles / splitk >= min_k_tiles_per_slice;
+       ++splitk) {
+    const int64_t ctas = std::min(num_tiles, num_sms / splitk);
+    if (ctas == 0) {
+      break;
+    }
+    const double cost = (double)ceilDiv(num_tiles, ctas) / (double)splitk *
+        (1.0 + splitk_overhead * (double)(splitk - 1));
+    if (cost < best_cost) {
+      best_splitk = splitk;
+      best_ctas = ctas;
+      best_cost = cost;
+    }
+  }
+  // Looping over the tiles only pays off when the K slices change the wave
+  // quantization, otherwise it matches the default grid
+  if (best_splitk == 1) {
+    return;
+  }
+  params->splitk_factor = (int)best_splitk;
+  if (ceilDiv(num_tiles, best_ctas) > 1) {
+    params->num_persistent_ctas = (int)best_ctas;
+  }
+}
+
 //! A wrapper for core heuristics initialization.
 //! We should have already set params->mma_macro before calling this function.
 inline bool initCoreHeuristics(
@@ -206,6 +281,106 @@ ProblemShape getProblemShape(
   return shape;
 }
 
+// Checks that the reductions in the epilogue, if any:
+//   - are enabled with EnableOption::MatmulEpilogueReduction
+//   - are ReductionOps that only reduce N dimensions
+//   - have results that are not combined with N dimensions again
+//   - compute all the outputs with EPILOGUE_REDUCTION role
+// and that all epilogue inputs contribute to an OUTPUT. See
+// [ Note -- Matmul epilogue reductions ] in matmul.cpp.
+std::string getEpilogueReductionsRejectReason(
+    Fusion* fusion,
+    const mma_utils::MatmulPattern& pattern,
+    const mma_utils::TensorRolesMap& tensor_roles,
+    const mma_utils::DimRolesMap& id_roles,
+    const ValGraph& permissive_graph) {
+  const std::vector<TensorView*> reductions =
+      mma_utils::getEpilogueReductions(fusion, pattern.output);
+
+  const auto reduction_outputs_it =
+      tensor_roles.find(MatmulTensorRole::EPILOGUE_REDUCTION);
+  if (reductions.empty()) {
+    if (reduction_outputs_it != tensor_roles.end()) {
+      return "Detected input/output TVs without assigned roles";
+    }
+    return "";
+  }
+
+  if (!isOptionEnabled(EnableOption::MatmulEpilogueReduction)) {
+    return "Reductions in the matmul epilogue are disabled by default. "
+           "Enable them using NVFUSER_ENABLE=matmul_epilogue_reduction";
+  }
+
+  for (Expr* expr : fusion->exprs()) {
+    if (ir_utils::isReductionOp(expr) && !expr->isA<ReductionOp>() &&
+        DependencyCheck::isDependencyOf(pattern.output, expr->output(0))) {
+      return "Only ReductionOp is supported in the matmul epilogue";
+    }
+  }
+
+  const auto hasNDims = [&](TensorView* tv) {
+    for (IterDomain* id : TensorDomain::noReductions(tv->getLogicalDomain())) {
+      if (id->isBroadcast() || id->isDeviceDim()) {
+        continue;
+      }
+      auto it = id_roles.find(permissive_graph.toGroup(id));
+      if (it != id_roles.end() && it->second == MatmulDimRole::N) {
+        return true;
+      }
+    }
+    return false;
+  };
+
+  for (TensorView* tv : reductions) {
+    for (IterDomain* id : tv->getLogicalDomain()) {
+      if (!id->isReduction()) {
+        continue;
+      }
+      auto it = id_roles.find(permissive_graph.toGroup(id));
+      if (it == id_roles.end() || it->second != MatmulDimRole::N) {
+        return "Epilogue reductions can only reduce N dimensions";
+      }
+    }
+    // Combining the result with N dimensions again, as in a softmax or a
+    // layer norm, would require a grid-wide synchronization when N spans
+    // several CTAs
+    for (Val* val : DependencyCheck::getAllDependentVals({tv})) {
+      auto dep_tv = dynamic_cast<TensorView*>(val);
+      if (dep_tv != nullptr && hasNDims(dep_tv)) {
+        return "Results of epilogue reductions cannot be broadcast along N";
+      }
+    }
+  }
+
+  if (reduction_outputs_it != tensor_roles.end()) {
+    for (TensorView* tv : reduction_outputs_it->second) {
+      if (std::none_of(
+              reductions.begin(), reductions.end(), [tv](TensorView* r) {
+                return r == tv || DependencyCheck::isDependencyOf(r, tv);
+              })) {
+        return "Detected input/output TVs without assigned roles";
+      }
+    }
+  }
+
+  // The transforms of epilogue inputs are propagated from an OUTPUT tensor
+  if (auto c_it = tensor_roles.find(MatmulTensorRole::EPILOGUE_INPUT);
+      c_it != tensor_roles.end()) {
+    const std::vector<TensorView*>& d_tvs =
+        tensor_roles.at(MatmulTensorRole::OUTPUT);
+    for (TensorView* c : c_it->second) {
+      if (std::none_of(d_tvs.begin(), d_tvs.end(), [c](TensorView* d) {
+            return DependencyCheck::isDependencyOf(c, d);
+          })) {
+        return "Epilogue inputs used only by epilogue reductions are not "
+               "supported";
+      }
+    }
+  }
+
+  return "";
+}
+
 // Checks that this pattern:
 //   - is a GEMM or batch GEMM
 //   - has at least two inputs i.e. not A @ A.T
@@ -286,6 +461,12 @@ std::string isMatmulFusionDefinitionSupported(
       tvs_with_roles.insert(entry->second.begin(), entry->second.end());
     }
 
+    // Outputs of epilogue reductions are checked below
+    entry = tensor_roles.find(MatmulTensorRole::EPILOGUE_REDUCTION);
+    if (entry != tensor_roles.end()) {
+      tvs_with_roles.insert(entry->second.begin(), entry->second.end());
+    }
+
     const auto in_out_tvs_count =
         fusion_inputs_tvs.size() + fusion_outputs_tvs.size();
     if (in_out_tvs_count != tvs_with_roles.size()) {
@@ -293,6 +474,14 @@ std::string isMatmulFusionDefinitionSupported(
     }
   }
 
+  {
+    auto reduction_status = getEpilogueReductionsRejectReason(
+        fusion, pattern, tensor_roles, id_roles, permissive_graph);
+    if (!reduction_status.empty()) {
+      return reduction_status;
+    }
+  }
+
   // Check that canonical dim order is (B)MNK
   // TODO: Remove this check once we are confident that non-standard orders are
   // properly handled
@@ -716,7 +905,8 @@ std::string getMatmulCompileTimeRejectReason(Fusion* fusion) {
   // 4. Check if fusion represents expressions that are recognized by matmul
   // 5. Check if the input layout for the matmul pattern can be determined
   // scheduler.
-  // 6. Check if the fusion is resharding.
+  // 6. Check if fp8 or int8 operands, if any, are supported
+  // 7. Check if the fusion is resharding.
 
   // #0
   {
@@ -756,8 +946,11 @@ std::string getMatmulCompileTimeRejectReason(Fusion* fusion) {
         }
         for (TensorView* operand : {pattern.A, pattern.B}) {
           if (operand->dtype() != DataType::Half &&
-              operand->dtype() != DataType::BFloat16) {
-            return "Unsupported operand type. Operands must be fp16 or bf16";
+              operand->dtype() != DataType::BFloat16 &&
+              operand->dtype() != DataType::Int8 &&
+              !isFp8MmaOperandType(operand->dtype())) {
+            return "Unsupported operand type. "
+                   "Operands must be fp16, bf16, fp8 or int8";
           }
         }
       }
@@ -800,6 +993,44 @@ std::string getMatmulCompileTimeRejectReason(Fusion* fusion) {
   }
 
   // #6
+  {
+    const mma_utils::MatmulPattern& pattern = patterns.front();
+    const bool a_fp8 = isFp8MmaOperandType(pattern.A->dtype());
+    const bool b_fp8 = isFp8MmaOperandType(pattern.B->dtype());
+    if (a_fp8 != b_fp8) {
+      return "Either both or none of the operands can be fp8";
+    }
+    if (a_fp8) {
+      const auto device_prop = at::cuda::getCurrentDeviceProperties();
+      if (device_prop->major * 10 + device_prop->minor < 89) {
+        return "fp8 operands require compute capability 8.9 or newer";
+      }
+      // ldmatrix can only transpose 16-bit elements
+      for (MatmulDimRole inner_dim : input_layout_opt.getData()) {
+        if (inner_dim != MatmulDimRole::K) {
+          return "fp8 operands must be K-major, i.e. in the TN layout";
+        }
+      }
+    }
+    const bool a_int8 = pattern.A->dtype() == DataType::Int8;
+    const bool b_int8 = pattern.B->dtype() == DataType::Int8;
+    if (a_int8 != b_int8) {
+      return "Either both or none of the operands can be int8";
+    }
+    if (a_int8) {
+      const auto device_prop = at::cuda::getCurrentDeviceProperties();
+      if (device_prop->major * 10 + device_prop->minor < 80) {
+        return "int8 operands require compute capability 8.0 or newer";
+      }
+      for (MatmulDimRole inner_dim : input_layout_opt.getData()) {
+        if (inner_dim != MatmulDimRole::K) {
+          return "int8 operands must be K-major, i.e. in the TN layout";
+        }
+      }
+    }
+  }
+
+  // #7
   if (scheduler_utils::isResharding(fusion)) {
     return "Fusion is resharding.";
   }
@@ -857,8 +1088,10 @@ std::shared_ptr<MatmulParams> getMatmulHeuristics(
   const auto problem_shape = getProblemShape(id_roles, runtime_info);
 
   const auto device_prop = at::cuda::getCurrentDeviceProperties();
-  const auto mma_op =
-      getMmaOp(device_prop->major * 10 + device_prop->minor, problem_shape);
+  const auto mma_op = getMmaOp(
+      device_prop->major * 10 + device_prop->minor,
+      problem_shape,
+      pattern.A->dtype());
   NVF_ERROR(
       mma_op.has_value(), "Failed to determine a MMA op for given problem.");
   params->mma_macro = mma_op.value();
@@ -901,6 +1134,22 @@ std::shared_ptr<MatmulParams> getMatmulHeuristics(
     NVF_ERROR(status, "Initialization of core part of heuristics failed.");
   }
 
+  // Epilogue reductions reduce the N tiles in a grid reduction, which the grid
+  // swizzle, split-K and persistent CTAs would mix with other dimensions. See
+  // [ Note -- Matmul epilogue reductions ] in matmul.cpp
+  const bool has_epilogue_reductions =
+      !mma_utils::getEpilogueReductions(fusion, pattern.output).empty();
+  if (has_epilogue_reductions) {
+    params->grid_swizzle_factor = 1;
+    params->splitk_factor = 1;
+  }
+
+  if (isOptionEnabled(EnableOption::PersistentMatmul) &&
+      !has_epilogue_reductions) {
+    setPersistentCtas(
+        params, problem_shape, device_prop->multiProcessorCount);
+  }
+
   // Ensure that entire pipeline is filled for shared memory operands given
   // problem and heuristics.
   limitCircularBufferingSmemOperands(params, problem_shape);
@@ -908,12 +1157,26 @@ std::shared_ptr<MatmulParams> getMatmulHeuristics(
   // Disable magic zero for matmul kernels
   params->cparams.enable_magic_zero = false;
 
-  // Set whether to use shared memory for epilogue
+  // Set whether to use shared memory for epilogue. Epilogue reductions always
+  // need it, since the reductions cannot use the layout of the MMA results.
   std::tie(params->use_smem_epilogue, params->promote_prologue_smem_reuse) =
       mma_utils::generateSharedMemoryEpilogueHeuristics(
           params->tile_sizes,
           params->circular_buffer_options.smem_circular_buffer_stage,
-          tensor_roles);
+          tensor_roles,
+          /*ignore_occupancy_drop=*/has_epilogue_reductions);
+  NVF_ERROR(
+      params->use_smem_epilogue || !has_epilogue_reductions,
+      "Epilogue reductions require a shared memory epilogue, which does not ",
+      "fit with the CTA tile ",
+      toString(params->tile_sizes.cta_tile));
+  if (params->num_persistent_ctas > 0 &&
+      params->promote_prologue_smem_reuse) {
+    // The operand buffers are live across the tile loop, so they cannot be
+    // reused by the epilogue
+    params->use_smem_epilogue = false;
+    params->promote_prologue_smem_reuse = false;
+  }
 
   if (isDebugDumpEnabled(DebugDumpOption::SchedulerDebug)) {
     debug() << params->toString() << std::endl;
@@ -13,6 +13,8 @@
 #include <expr_evaluator.h>
 #include <id_model/id_model.h>
 #include <ir/printer.h>
+#include <ir/utils.h>
+#include <iter_visitor.h>
 #include <logical_domain_map.h>
 #include <mma_type.h>
 #include <ops/all_ops.h>
@@ -56,16 +58,21 @@ std::tuple<int64_t, int64_t, int64_t> computeSharedMemorySizes(
       ? circular_buffer_options.smem_circular_buffer_stage
       : 1;
 
-  // see scheduleContiguousVectorLoad
-  const int64_t vector_word = 8;
-  const int64_t round_to_factor = warp_dims.m * warp_dims.n * warp_dims.k *
-      properties->warpSize * vector_word;
+  // see scheduleContiguousVectorLoad. The operands are loaded in 16-byte
+  // words, i.e. 8 fp16 or 16 fp8 and int8 items
+  auto round_to_factor = [&](DataType dtype) {
+    const int64_t vector_word = 16 / (int64_t)dataTypeSize(dtype);
+    return warp_dims.m * warp_dims.n * warp_dims.k * properties->warpSize *
+        vector_word;
+  };
   const int64_t mk = gemm_tile.cta_tile.m * gemm_tile.cta_tile.k;
   const int64_t nk = gemm_tile.cta_tile.n * gemm_tile.cta_tile.k;
-  const int64_t smem_a = ceilDiv(mk, round_to_factor) * round_to_factor *
-      ab_factor * dataTypeSize(data_types[0]);
-  const int64_t smem_b = ceilDiv(nk, round_to_factor) * round_to_factor *
-      ab_factor * dataTypeSize(data_types[1]);
+  const int64_t round_a = round_to_factor(data_types[0]);
+  const int64_t round_b = round_to_factor(data_types[1]);
+  const int64_t smem_a = ceilDiv(mk, round_a) * round_a * ab_factor *
+      dataTypeSize(data_types[0]);
+  const int64_t smem_b = ceilDiv(nk, round_b) * round_b * ab_factor *
+      dataTypeSize(data_types[1]);
   const int64_t smem_c =
       gemm_tile.cta_tile.m * gemm_tile.cta_tile.n * dataTypeSize(data_types[2]);
 
@@ -204,8 +211,9 @@ std::pair<bool, bool> generateSharedMemoryEpilogueHeuristics(
   // A and B, but instead of OUTPUT which is the result of the epilogue, we
   // store mma_result which is the _input_ to the epilogue. In cases where the
   // epilogue contains a cast back down to reduced precision, we will still use
-  // Float for the epilogue smem. If we support Double or Complex in the future
-  // then we might need a better way to determine this data type.
+  // Float for the epilogue smem. The Int32 accumulator of int8 operands has the
+  // same size. If we support Double or Complex in the future then we might need
+  // a better way to determine this data type.
   data_types[2] = DataType::Float;
 
   // smem_a and smem_b are guaranteed to be re-used for smem_c as long as:
@@ -918,8 +926,10 @@ void MmaSwizzler::scheduleOperandRead(TensorView* tv, MmaOperand operand) {
   //     A                            B
   //  -2   -1          or          -2   -1
   //[64m, 16k]                    [8n, 16k]
+  // Each 32-bit register holds k' consecutive items of K, i.e. 2 halves, or 4
+  // fp8 items, whose instructions have a K of 32 instead, e.g. [8n, 32k].
   tv->split(-2, 8);
-  tv->split(-1, 2);
+  tv->split(-1, 4 / dataTypeSize(tv->dtype()));
   tv->split(-2, 4);
 
   //          A                               B
@@ -1025,7 +1035,9 @@ void MmaSwizzler::scheduleOperandRead(
   tv->setAllocationDomain(tv->getLoopDomain(), true);
 }
 
-AbstractTensor MmaSwizzler::scheduleMmaOutputAllocation(AbstractTensor t) {
+AbstractTensor MmaSwizzler::scheduleMmaOutputAllocation(
+    AbstractTensor t,
+    int64_t k_per_register) {
   // This function works for all mma ops, regardless of the architecture. The
   // Hopper one is the most general one. For earlier architectures, we will have
   // some dimensions with size 1 after split, this is fine.
@@ -1063,11 +1075,12 @@ AbstractTensor MmaSwizzler::scheduleMmaOutputAllocation(AbstractTensor t) {
   // [WarpGroup128, N3, M2, N2  (,R)]
 
   if (has_reduction) {
-    t.split(-1, 2);
+    t.split(-1, k_per_register);
     t.split(-2, 4);
     m_pos -= 2;
     //       m
     // [WarpGroup128, N3, M2, N2, Ro, R4, R2]
+    // or [..., Ro, R4, R4] for fp8
   }
 
   t.parallelize(m_pos, ParallelType::TIDx);
@@ -1336,6 +1349,10 @@ TensorRolesMapOpt getTensorRoles(
     //  domains
     if (has.m && has.n) {
       storage.push_back(tv);
+    } else if (has.m) {
+      // Outputs without n domains can only come from reducing them in the
+      //  epilogue. This is verified in isMatmulFusionDefinitionSupported.
+      tensor_roles[MatmulTensorRole::EPILOGUE_REDUCTION].push_back(tv);
     }
   }
 
@@ -1357,6 +1374,20 @@ TensorRolesMapOpt getTensorRoles(
   return tensor_roles;
 }
 
+std::vector<TensorView*> getEpilogueReductions(
+    Fusion* fusion,
+    TensorView* mma_output) {
+  std::vector<TensorView*> reductions;
+  for (auto rop : ir_utils::getOpsOfType<ReductionOp>(fusion)) {
+    auto out = rop->out()->as<TensorView>();
+    if (out != mma_output &&
+        DependencyCheck::isDependencyOf(mma_output, out)) {
+      reductions.push_back(out);
+    }
+  }
+  return reductions;
+}
+
 namespace {
 // Check the val (in) is the output of broadcast.
 // Then check the output of the broadcast is 3D (4D for bmm).
@@ -1459,6 +1490,14 @@ char dtypeToChar(const DataType& dtype) {
     return 'S';
   } else if (dtype == DataType::Double) {
     return 'D';
+  } else if (dtype == DataType::Float8_e4m3fn) {
+    return 'Q';
+  } else if (dtype == DataType::Float8_e5m2) {
+    return 'R';
+  } else if (dtype == DataType::Int8) {
+    return 'B';
+  } else if (dtype == DataType::Int32) {
+    return 'I';
   }
   NVF_ERROR(false, "Unsupported dtype for matmul: ", dtype);
   return 0;
@@ -173,7 +173,12 @@ class MmaSwizzler {
   //! Applies the output mma swizzling to the given tv, should be used
   //!  on mma output or tv's involved in epilog fusion, i.e. bias.
   //! The rightmost iterdomains must follow the m,n,k convention before calling.
-  static AbstractTensor scheduleMmaOutputAllocation(AbstractTensor t);
+  //! The reduction, if any, is split like the K of the operands, which have
+  //! \p k_per_register items of K in each 32-bit register, i.e. 2 for halves
+  //! and 4 for fp8.
+  static AbstractTensor scheduleMmaOutputAllocation(
+      AbstractTensor t,
+      int64_t k_per_register = 2);
 
   //! Applies the input mma swizzling to the given tv as its allocation domain,
   //! should be used on mma input or tv's involved in any fusion before mma, but
@@ -352,6 +357,13 @@ TensorRolesMapOpt getTensorRoles(
     const IdModel& id_model,
     const DimRolesMap& dim_roles);
 
+//! Returns the outputs of the ReductionOps downstream of `mma_output`, i.e.
+//!  the reductions of the epilogue. The reduction of the matmul itself is not
+//!  included.
+std::vector<TensorView*> getEpilogueReductions(
+    Fusion* fusion,
+    TensorView* mma_output);
+
 //! Return pair of whether use shared memory epilogue or not and whether to
 //!  reuse shared memory for the prologue at the expense of an additional block
 //!  sync.
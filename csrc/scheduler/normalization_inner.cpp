@@ -78,6 +78,55 @@ std::pair<int64_t, int64_t> getPersistentBufferSize(
       persistent_buffer_size, available_persistent_buffer_size);
 }
 
+// [ Note -- Cluster persistence ]
+//
+// When the persistent buffer of a row does not fit in the registers and
+// shared memory of one block, Hopper can still keep it on chip by splitting
+// each row across the blocks of a thread block cluster. The reduction domain
+// is split by gridDim.x, one cluster spans gridDim.x, and the rows are
+// parallelized on BIDy. Each block keeps its slice of the persistent buffer in
+// registers and the cross-block part of each reduction is done through
+// distributed shared memory with cluster barriers (cluster::clusterReduce in
+// runtime/cluster.cu), so there is no global work buffer, grid sync or
+// cooperative launch. The cluster size is the smallest power of 2 whose slices
+// fit in the registers of a block, up to the non-portable limit of 16.
+//
+// Only 2D inner reductions made of ReductionOps are supported. Welford and
+// grouped reductions still fall back to segmentation.
+
+//! Maximum number of blocks of a cluster, which needs the non-portable cluster
+//! size attribute above 8
+constexpr int64_t max_cluster_size = 16;
+
+//! Number of blocks of the clusters that keep the persistent buffer of a row
+//! on chip, or 1 if cluster persistence can't be used. See
+//! [ Note -- Cluster persistence ].
+int64_t getPersistentClusterSize(
+    const std::vector<TensorView*>& reduction_tvs,
+    const int64_t persistent_buffer_size,
+    const int64_t available_persistent_buffer_size,
+    const bool is_2d_reduction) {
+  if (persistent_buffer_size <= available_persistent_buffer_size ||
+      !is_2d_reduction ||
+      at::cuda::getCurrentDeviceProperties()->major < 9) {
+    return 1;
+  }
+  if (!std::all_of(
+          reduction_tvs.begin(), reduction_tvs.end(), [](TensorView* tv) {
+            return tv->definition()->isA<ReductionOp>();
+          })) {
+    return 1;
+  }
+  for (int64_t cluster_size = 2; cluster_size <= max_cluster_size;
+       cluster_size *= 2) {
+    if (ceilDiv(persistent_buffer_size, cluster_size) <=
+        scheduler_utils::register_file_size) {
+      return cluster_size;
+    }
+  }
+  return 1;
+}
+
 } // namespace
 
 bool InnerPersistentKernelScheduler::canScheduleRunTime(
@@ -115,7 +164,14 @@ bool InnerPersistentKernelScheduler::canScheduleRunTime(
   const int64_t device_multiprocessor_count =
       (int64_t)at::cuda::getCurrentDeviceProperties()->multiProcessorCount;
 
-  if (persistent_buffer_size > available_persistent_buffer_size) {
+  const int64_t cluster_size = getPersistentClusterSize(
+      reduction_tvs,
+      persistent_buffer_size,
+      available_persistent_buffer_size,
+      can_use_smem_persistent);
+
+  if (persistent_buffer_size > available_persistent_buffer_size &&
+      cluster_size == 1) {
     scheduler_debug_utils::canScheduleRejectReason(
         heuristicType(),
         can_use_smem_persistent
@@ -557,6 +613,69 @@ void innerPersistentHeuristic2D(
       LaunchParams::UNINITIALIZED_VAL);
 }
 
+// Each row is reduced by the cluster_size blocks of a cluster. See
+// [ Note -- Cluster persistence ].
+void innerPersistentHeuristicCluster(
+    const PersistentKernelProperties& properties,
+    const int64_t cluster_size,
+    std::shared_ptr<ReductionParams> rparams) {
+  const auto dev_prop = at::cuda::getCurrentDeviceProperties();
+  const int64_t max_threads_per_block = (int64_t)dev_prop->maxThreadsPerBlock;
+  const int64_t threads_per_warp = (int64_t)dev_prop->warpSize;
+  // Same values as the 2D register heuristic
+  const int64_t register_overhead = properties.has_exp_op ? 32l : 16l;
+  const int64_t target_warps_per_sm = 28l;
+
+  // Use the smallest persistent batch that fits in a block, which leaves the
+  // most threads to hide latency
+  const int64_t vectorize_factor = properties.vectorize_factor;
+  const int64_t elements_per_block = ceilDiv(
+      ceilDiv(properties.inner_most_dimension_numel, vectorize_factor),
+      cluster_size);
+  const int64_t persistent_batch =
+      ceilDiv(elements_per_block, max_threads_per_block);
+  const int64_t bdimx = ceilDiv(
+      ceilDiv(elements_per_block, persistent_batch), threads_per_warp) *
+      threads_per_warp;
+
+  const int64_t buffer_size_per_thread =
+      ceilDiv(properties.max_persistent_buffer_size, cluster_size * bdimx);
+  rparams->cparams.maxrregcount = getMaxRegisterCountPerThreadAndOccupancy(
+                                      buffer_size_per_thread,
+                                      bdimx,
+                                      target_warps_per_sm,
+                                      register_overhead)
+                                      .first;
+
+  // Inner reduction domain
+  rparams->cross_block_inner_reduction = true;
+  rparams->block_dim_inner_reduction = ParallelType::TIDx;
+  rparams->pad_inner_reduction_to_warp = true;
+  rparams->batches_per_block_inner_reduction = persistent_batch;
+  rparams->unroll_factor_inner_reduction = vectorize_factor;
+  rparams->vectorize_inner_reduction = vectorize_factor > 1;
+  rparams->cross_grid_inner_reduction = true;
+  rparams->grid_dim_inner_reduction = ParallelType::BIDx;
+  rparams->cross_cluster_inner_reduction = true;
+
+  // Iter domain
+  rparams->multiple_reds_per_blk = false;
+  rparams->grid_dim_iter_dom = ParallelType::BIDy;
+  int64_t gdimy = LaunchParams::UNINITIALIZED_VAL;
+  if (properties.total_iteration_numel > scheduler_utils::y_grid_limit) {
+    rparams->split_grid_dim_iter_dom_outer = true;
+    gdimy = scheduler_utils::y_grid_limit;
+  }
+
+  rparams->lparams = LaunchParams(
+      cluster_size,
+      gdimy,
+      LaunchParams::UNINITIALIZED_VAL,
+      LaunchParams::UNINITIALIZED_VAL,
+      LaunchParams::UNINITIALIZED_VAL,
+      LaunchParams::UNINITIALIZED_VAL);
+}
+
 void innerPersistentHeuristicSharedMemory(
     const PersistentKernelProperties& properties,
     std::shared_ptr<ReductionParams> rparams) {
@@ -1107,13 +1226,36 @@ std::shared_ptr<ReductionParams> getInnerPersistentHeuristics(
   rparams->project_persistent_buffers = prop.project_persistent_buffers;
   rparams->cparams.index_type = prop.index_type;
 
+  auto reduction_tv_entry =
+      HeuristicSummaryEntry<HeuristicCompileTime::ReductionTVs>(
+          data_cache, [&fusion]() {
+            return std::make_unique<std::vector<TensorView*>>(
+                scheduler_utils::getReductionTvs(fusion));
+          });
+  const bool is_2d_reduction =
+      prop.total_reduction_numel == prop.inner_most_dimension_numel;
+  const int64_t cluster_size = getPersistentClusterSize(
+      reduction_tv_entry.get(),
+      prop.max_persistent_buffer_size,
+      normalization_scheduler_utils::
+          getMaxRegOrSharedMemorySizeForPersistentBuffer(
+              runtime_info, prop.persistent_buffers, is_2d_reduction),
+      is_2d_reduction);
+
   // specific heuristics for different cases
-  if (prop.max_persistent_buffer_size > scheduler_utils::register_file_size) {
+  if (cluster_size > 1) {
+    rparams->tag = "Cluster Inner Persistent Heuristic.\n";
+    innerPersistentHeuristicCluster(prop, cluster_size, rparams);
+  } else if (
+      prop.max_persistent_buffer_size > scheduler_utils::register_file_size) {
     rparams->tag = "Shared Memory Inner Persistent Heuristic.\n";
     // all persistent buffers are moved to shared memory
     // TODO: allow only part of the buffers to be moved to shared memory
     rparams->smem_persistent_buffers = prop.persistent_buffers;
     innerPersistentHeuristicSharedMemory(prop, rparams);
+    rparams->tma_load_box_size =
+        normalization_scheduler_utils::getTmaLoadBoxSize(
+            runtime_info, *rparams, prop);
   } else if (prop.total_reduction_numel == prop.inner_most_dimension_numel) {
     rparams->tag = "2D Register Inner Persistent Heuristic.\n";
     innerPersistentHeuristic2D(prop, rparams);
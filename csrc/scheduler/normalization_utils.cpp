@@ -8,6 +8,8 @@
 #include <expr_evaluator.h>
 #include <grouped_reduction.h>
 #include <instrumentation.h>
+#include <ops/arith.h>
+#include <options.h>
 #include <scheduler/cache_policy_refiner.h>
 #include <scheduler/debug_utils.h>
 #include <scheduler/normalization_utils.h>
@@ -1190,7 +1192,8 @@ bool compileTimeCheck(Fusion* fusion, ScheduleHeuristic schedule_heuristic) {
 void movePersistentBufferToSmem(
     Fusion* fusion,
     const ReductionParams& rparams,
-    const std::vector<TensorView*>& cached_inputs) {
+    const std::vector<TensorView*>& cached_inputs,
+    const std::unordered_map<TensorView*, TensorView*>& lowered_buffers) {
   // Transfer the persistent buffer tensors to shared memory. These tensors are
   // housed in smem_persistent_buffers. If a candidate tensor is input, move its
   // associated cached tensors.
@@ -1229,12 +1232,190 @@ void movePersistentBufferToSmem(
       auto input_tv = ir_utils::producerTvsOf(tv).at(0);
       use_smem = isSharedMemoryPersistent(input_tv);
     }
+    // A lower precision copy of a buffer replaces it as persistent buffer.
+    if (auto it = lowered_buffers.find(tv);
+        !use_smem && it != lowered_buffers.end()) {
+      use_smem = isSharedMemoryPersistent(it->second);
+    }
     if (use_smem) {
       tv->setMemoryType(MemoryType::Shared);
     }
   }
 }
 
+// Note [TMA loads of persistent buffers]
+//
+// When the persistent buffers of an inner persistent normalization don't fit
+// in registers, they are kept in shared memory, but each thread still loads
+// its part of a row with vectorized loads that go through registers before
+// being stored to shared memory. On Hopper, the cached inputs of these buffers
+// can instead be filled by the TMA unit, so that the threads only issue the
+// reads of the buffer. With NVFUSER_ENABLE=tma_persistent_load, the loop
+// domain of each such cached input, [BIDx, persistent batch, unswitch, TIDx,
+// vectorize], is replaced by
+//
+//   [BIDx, row / box, box (Bulk)]
+//
+// i.e., each block loads its row with a serial loop of TMA boxes of at most
+// 256 elements, the limit of a box dimension, which is then read by the
+// threads as before. The loads are only used when, for each of these buffers,
+//  - the row is the only reduction dimension and each block reduces one row,
+//    which is what the shared memory heuristic schedules,
+//  - the buffer is a contiguous input allocated in its logical order, with at
+//    most 5 dimensions and no broadcast, reduction or device dimension, and
+//  - the input is 16-byte aligned and its rows are a multiple of the box,
+//    which is a multiple of 16 bytes.
+// Buffers that are not fusion inputs are still written by threads.
+int64_t getTmaLoadBoxSize(
+    SchedulerRuntimeInfo& runtime_info,
+    const ReductionParams& rparams,
+    const PersistentKernelProperties& properties) {
+  if (!isOptionEnabled(EnableOption::TmaPersistentLoad) ||
+      at::cuda::getCurrentDeviceProperties()->major < 9 ||
+      rparams.smem_persistent_buffers.empty() ||
+      properties.total_reduction_numel !=
+          properties.inner_most_dimension_numel ||
+      rparams.multiple_reds_per_blk || rparams.unroll_factor_iter_dom > 1 ||
+      rparams.cross_grid_inner_reduction ||
+      rparams.cross_cluster_inner_reduction) {
+    return 0;
+  }
+  constexpr int64_t max_box_size = 256;
+  constexpr int64_t tma_alignment_bytes = 16;
+  const int64_t row_size = properties.inner_most_dimension_numel;
+  int64_t box_size = max_box_size;
+  while (row_size % box_size != 0) {
+    box_size /= 2;
+  }
+
+  bool has_input_buffer = false;
+  for (auto tv : rparams.smem_persistent_buffers) {
+    if (!tv->isFusionInput()) {
+      continue;
+    }
+    has_input_buffer = true;
+    if (tv->hasAllocation() || tv->nDims() > 5 ||
+        (int64_t)runtime_info.getAlignmentSize(tv) < tma_alignment_bytes) {
+      return 0;
+    }
+    const std::vector<IterDomain*>& logical = tv->getLogicalDomain();
+    const std::vector<std::optional<bool>>& contiguity = tv->getContiguity();
+    for (auto i : c10::irange(logical.size())) {
+      if (logical[i]->isBroadcast() || logical[i]->isReduction() ||
+          logical[i]->isDeviceDim() || !contiguity[i].value_or(false)) {
+        return 0;
+      }
+    }
+    auto inner_extent =
+        runtime_info.expressionEvaluator().evaluate(logical.back()->extent());
+    if (!inner_extent.hasValue() || inner_extent.as<int64_t>() != row_size ||
+        box_size * dataTypeSize(tv->getDataType().value()) %
+                tma_alignment_bytes !=
+            0) {
+      return 0;
+    }
+  }
+  return has_input_buffer ? box_size : 0;
+}
+
+namespace {
+
+// Stores the lower precision persistent buffers in their lower precision
+// type, see Note [Lower precision persistent buffers] in scheduler/utils.cpp.
+// The uses of each buffer after the reductions, i.e., the ones that make it
+// persistent, read it through a cast from a lower precision copy, which then
+// becomes the persistent buffer in place of the original one. Returns the
+// map from the copies to the original buffers.
+std::unordered_map<TensorView*, TensorView*> lowerPersistentBufferPrecision(
+    Fusion* fusion) {
+  std::unordered_map<TensorView*, TensorView*> lowered_buffers;
+  if (!isOptionEnabled(EnableOption::LowerPrecisionPersistentBuffers)) {
+    return lowered_buffers;
+  }
+  const auto persistent_info = scheduler_utils::persistentBuffers(fusion);
+  for (auto buffer_i : c10::irange(persistent_info.persistent_buffers.size())) {
+    TensorView* buffer = persistent_info.persistent_buffers[buffer_i];
+    auto it = persistent_info.lower_precision_buffers.find(buffer);
+    if (it == persistent_info.lower_precision_buffers.end()) {
+      continue;
+    }
+
+    // Same as the uses recomputed by persistent buffer projection: the first
+    // consumers on the paths to the resolution points that don't go through
+    // a reduction.
+    std::vector<Expr*> persistent_uses;
+    for (auto resolution_point :
+         persistent_info.persistent_buffer_resolution_points[buffer_i]) {
+      for (const auto& chain :
+           DependencyCheck::getAllDependencyChains(buffer, resolution_point)) {
+        auto tv_chain = ir_utils::filterByType<TensorView>(chain);
+        if (std::any_of(tv_chain.begin(), tv_chain.end(), [](TensorView* tv) {
+              return tv->hasReduction();
+            })) {
+          continue;
+        }
+        Expr* use = chain.at(1)->definition();
+        if (std::find(persistent_uses.begin(), persistent_uses.end(), use) ==
+            persistent_uses.end()) {
+          persistent_uses.push_back(use);
+        }
+      }
+    }
+    if (persistent_uses.empty()) {
+      continue;
+    }
+
+    TensorView* lowered = castOp(it->second, buffer);
+    TensorView* restored = castOp(DataType::Float, lowered);
+    for (Expr* use : persistent_uses) {
+      ir_utils::replaceValInExprInputs(use, buffer, restored);
+    }
+    lowered_buffers.emplace(lowered, buffer);
+  }
+  return lowered_buffers;
+}
+
+// Replaces the loop domain of a cached input scheduled like the reduction,
+// [BIDx, ..., vectorize], by [BIDx, row / box, box (Bulk)] and loads it with
+// TMA. The row is not inlined into the loops of its consumers as it's
+// persistent, so only the iteration part of the loop domain is kept.
+void scheduleTmaLoadOfPersistentBuffer(TensorView* tv, int64_t box_size) {
+  IterDomain* row_id = tv->getLogicalDomain().back();
+  std::vector<IterDomain*> loop_domain;
+  for (auto id : tv->getLoopDomain()) {
+    if (id == row_id || DependencyCheck::isDependencyOf(row_id, id)) {
+      break;
+    }
+    loop_domain.push_back(id);
+  }
+  NVF_ERROR(
+      std::none_of(
+          tv->getLoopDomain().begin() + (int64_t)loop_domain.size(),
+          tv->getLoopDomain().end(),
+          [row_id](IterDomain* id) {
+            return id != row_id &&
+                !DependencyCheck::isDependencyOf(row_id, id);
+          }),
+      "Expected the row of ",
+      tv->toString(),
+      " to be scheduled innermost");
+  NVF_ERROR(
+      tv->getComputeAtPosition() <= (int64_t)loop_domain.size(),
+      "The row of ",
+      tv->toString(),
+      " must not be inlined to be loaded with TMA");
+  loop_domain.push_back(row_id);
+
+  tv->definition()->as<LoadStoreOp>()->setOpType(
+      LoadStoreOpType::CpAsyncBulkTensorTile);
+  tv->setLoopDomain(loop_domain);
+  tv->split(-1, box_size);
+  tv->axis(-1)->parallelize(ParallelType::Bulk);
+  tv->setAllocationDomain(tv->getLoopDomain(), true);
+}
+
+} // namespace
+
 // common prepare for all persistent schedulers
 void beforeSchedule(
     Fusion* fusion,
@@ -1250,6 +1431,10 @@ void beforeSchedule(
   dummy_outputs = reduction_scheduler_utils::projectPersistentBuffers(
       fusion, rparams.project_persistent_buffers);
 
+  // Store the persistent buffers that are still persistent after projection
+  // in lower precision, if enabled.
+  const auto lowered_buffers = lowerPersistentBufferPrecision(fusion);
+
   // Cache tensors before grabbing any references to reductions as cache_before
   // can invalidate the references since when applied to a reduction tensor view
   // the new tensor view contains the reduction and original doesn't.
@@ -1268,7 +1453,8 @@ void beforeSchedule(
 
   // move persistent buffer marked in [smem_persistent_buffers] from register to
   // smem
-  movePersistentBufferToSmem(fusion, rparams, cached_inputs);
+  movePersistentBufferToSmem(
+      fusion, rparams, cached_inputs, lowered_buffers);
 
   reduction_tvs = scheduler_utils::getReductionTvs(fusion);
 }
@@ -1296,7 +1482,15 @@ TensorView* scheduleReductionGeneral(
 
   if (schedule_heuristic == ScheduleHeuristic::OuterPersistent &&
       rparams.cross_grid_inner_reduction && reduction_tvs.size() > 1) {
-    groupReductions(reduction_tvs, false);
+    if (isOptionEnabled(EnableOption::GroupReductions)) {
+      // Grouped iterations count against the limit of grouped reductions
+      reduction_scheduler_utils::groupSiblingReductions(
+          reduction_tvs,
+          kMaxNumGroupedReductions /
+              std::max(rparams.unroll_factor_iter_dom, (int64_t)1));
+    } else {
+      groupReductions(reduction_tvs, false);
+    }
   }
 
   auto dim_analysis = scheduler_utils::canonicalDimReduction(
@@ -1371,11 +1565,47 @@ void schedulePersistentKernel(
       cached_outputs,
       dummy_outputs);
 
+  // The reductions are rfactored above, so the definitions of reduction_tvs
+  // are the cross-block reductions. See [ Note -- Cluster persistence ] in
+  // normalization_inner.cpp.
+  if (rparams.cross_cluster_inner_reduction) {
+    for (auto tv : reduction_tvs) {
+      NVF_ERROR(
+          tv->definition()->isA<ReductionOp>(),
+          "Cluster reductions only support ReductionOp: ",
+          tv->definition()->toString());
+      tv->definition()->as<ReductionOp>()->requestClusterReduction();
+    }
+  }
+
+  reduction_scheduler_utils::setWelfordMode(fusion, rparams.welford_mode);
+  if (rparams.smem_atomic_block_reduction) {
+    reduction_scheduler_utils::requestSmemAtomicBlockReductions(fusion);
+  }
+
+  // Cached inputs loaded with TMA, see Note [TMA loads of persistent buffers]
+  std::vector<TensorView*> tma_loaded_inputs;
+  if (rparams.tma_load_box_size > 0) {
+    for (auto tv : cached_inputs) {
+      if (tv->getMemoryType() == MemoryType::Shared &&
+          ir_utils::producerTvsOf(tv).at(0)->isFusionInput()) {
+        scheduleTmaLoadOfPersistentBuffer(tv, rparams.tma_load_box_size);
+        tma_loaded_inputs.push_back(tv);
+      }
+    }
+  }
+
   if (rparams.compute_persistent_buffer_with_first_consumer) {
     NVF_ERROR(
         rparams.persistent_kernel,
         "computeWith should be only used with persistent kernels");
     for (const auto persistent_buffer : cached_inputs) {
+      if (std::find(
+              tma_loaded_inputs.begin(),
+              tma_loaded_inputs.end(),
+              persistent_buffer) != tma_loaded_inputs.end()) {
+        continue;
+      }
       persistent_buffer->computeWith(-1, true);
     }
   }
@@ -321,11 +321,22 @@ bool isProjectBufferToInputs(
     const bool check_projected_buffer_size = true);
 
 // move persistent buffer marked in rparams->smem_persistent_buffers from
-// register to smem
+// register to smem. `lowered_buffers` maps the lower precision copies of
+// persistent buffers to the buffers they replace.
 void movePersistentBufferToSmem(
     Fusion* fusion,
     const ReductionParams& rparams,
-    const std::vector<TensorView*>& cached_inputs);
+    const std::vector<TensorView*>& cached_inputs,
+    const std::unordered_map<TensorView*, TensorView*>& lowered_buffers = {});
+
+// Returns the number of elements per TMA box to load the rows of the shared
+// memory persistent buffers that are fusion inputs with on Hopper, or 0 if
+// they are loaded by threads. See Note [TMA loads of persistent buffers] in
+// normalization_utils.cpp.
+int64_t getTmaLoadBoxSize(
+    SchedulerRuntimeInfo& runtime_info,
+    const ReductionParams& rparams,
+    const PersistentKernelProperties& properties);
 
 } // namespace normalization_scheduler_utils
 } // namespace nvfuser
@@ -11,6 +11,7 @@
 #include <inlining.h>
 #include <instrumentation.h>
 #include <multidevice/utils.h>
+#include <options.h>
 #include <scheduler/cache_policy_refiner.h>
 #include <scheduler/debug_utils.h>
 #include <scheduler/mark_aliases.h>
@@ -39,10 +40,23 @@ bool PointWiseScheduler::canScheduleCompileTime(Fusion* fusion) {
     return false;
   }
 
-  // Currently using the same path as the scheduler
-  // to eliminate mismatch between canSchedule and
-  // schedule pointwise.
-  if (!hasReferenceTensorView(fusion)) {
+  // The registry only lets disconnected fusions through for horizontal
+  // fusion. See [ Note -- Horizontal fusion ] in fusion_segmenter.cpp.
+  if (!registry_utils::isConnectedFusionGraph(fusion)) {
+    if (!ir_utils::getViewOps(fusion).empty()) {
+      scheduler_debug_utils::canScheduleRejectReason(
+          heuristicType(), "no support for reshape in horizontal fusions");
+      return false;
+    }
+    if (getHorizontalReferenceTensorViews(fusion).empty()) {
+      scheduler_debug_utils::canScheduleRejectReason(
+          heuristicType(), "cannot find reference tensor for each component");
+      return false;
+    }
+  } else if (!hasReferenceTensorView(fusion)) {
+    // Currently using the same path as the scheduler
+    // to eliminate mismatch between canSchedule and
+    // schedule pointwise.
     scheduler_debug_utils::canScheduleRejectReason(
         heuristicType(), "cannot find reference tensor");
     return false;
@@ -88,6 +102,7 @@ bool PointWiseScheduler::canScheduleRunTime(
       HeuristicSummaryEntry<HeuristicCompileTime::CanScheduleTranspose>(
           data_cache, [fusion]() {
             return std::make_unique<bool>(
+                registry_utils::isConnectedFusionGraph(fusion) &&
                 TransposeScheduler::canScheduleCompileTime(fusion));
           });
   if (can_schedule_transpose_entry.get()) {
@@ -118,6 +133,50 @@ namespace {
 // Unused at the moment, commenting for clang tidy
 constexpr int64_t kThreadX = 128;
 
+// Note [3D pointwise schedule]
+//
+// The 2D schedule (see pointwise.h) only gets reuse of an input broadcast
+// along an entire side of its break point, e.g., in
+//   T3[B, H, S, D] = T0[B, H, S, D] + T1[b, H, b, b] + T2[b, b, S, D]
+// the rotary table T2 is broadcast along [B, H], but the bias T1 along
+// neither side of any break point. With EnableOption::Pointwise3D, the
+// heuristic may instead pick two break points splitting the reference into
+//   [left | middle | right]
+// where the middle is iterated serially by each thread, serial_factor
+// elements at a time:
+//   [BIDx(left * middle / serial), BIDy(right / (TIDx * vect)), serial,
+//    Unswitch, Vectorize/Unroll, TIDx]
+// The cached inputs with no iteration domain in the middle, T2 with break
+// points [B | H | S, D], are inlined outside of the serial loop, so they are
+// loaded once into registers and reused for serial_factor elements of the
+// middle. The break points maximize the bytes per element of such inputs,
+// which have to be mapped to at least one dimension of the reference. The
+// left side can't be empty, so that there's a grid dimension for it, and the
+// 3D schedule isn't used with reshapes, TMA stores or a split block.
+constexpr int64_t kMaxSerialFactor = 8;
+
+// Note [Grid-stride pointwise schedule]
+//
+// The 1D schedule launches one block per tile of TIDx * unroll elements, so a
+// multi-GB pointwise op launches millions of blocks, each of which computes
+// the same base offsets and predicates before moving a single tile, and the
+// last partial wave leaves most of the GPU idle. Once every block would get
+// at least kMinGridStrideTiles tiles, the heuristic instead launches
+// kGridStrideWaves waves of blocks, which walk the tiles in a grid-stride
+// loop:
+//   [BIDx(tiles), Unswitch, Vectorize/Unroll, TIDx]
+//   -> [BIDx{grid_stride_blocks}, Serial(tiles / grid_stride_blocks),
+//       Unswitch, Vectorize/Unroll, TIDx]
+// Consecutive blocks still move consecutive tiles at each iteration, so the
+// accesses stay coalesced, and the block count doesn't depend on the size of
+// the problem, so the kernel is reused across sizes. The loop invariant parts
+// of the indices and predicates are hoisted out of the serial loop by index
+// hoisting. When vectorized, the cached inputs are inlined outside of the
+// unswitch and double buffered along the serial loop, so the loads of the
+// next tile are in flight while the current one is computed.
+constexpr int64_t kGridStrideWaves = 2;
+constexpr int64_t kMinGridStrideTiles = 8;
+
 class DomainMap : public pointwise_utils::DomainMap {
  public:
   using pointwise_utils::DomainMap::DomainMap;
@@ -142,6 +201,59 @@ class DomainMap : public pointwise_utils::DomainMap {
     return result;
   }
 
+  // Finds a reference tensor for each connected component of a disconnected
+  // fusion, the output with the most dimensions that all inputs of its
+  // component map to. Returns an empty vector if a component has none.
+  std::vector<TensorView*> findHorizontalReferenceTensorViews() const {
+    DisjointSets<Val*> component_sets;
+    for (auto expr : fusion_->exprs()) {
+      auto output0 = expr->output(0);
+      for (auto input : ir_utils::filterByType<TensorView>(expr->inputs())) {
+        component_sets.mapEntries(output0, input);
+      }
+      for (auto output : expr->outputs()) {
+        component_sets.mapEntries(output0, output);
+      }
+    }
+
+    auto inputs = ir_utils::filterByType<TensorView>(fusion_->inputs());
+    std::vector<const VectorOfUniqueEntries<Val*>*> components;
+    std::unordered_map<const VectorOfUniqueEntries<Val*>*, TensorView*>
+        references;
+    for (auto output_tv :
+         ir_utils::filterByType<TensorView>(fusion_->outputs())) {
+      if (output_tv->isFusionInput()) {
+        continue;
+      }
+      const auto* component = &component_sets.getDisjointSetOf(output_tv);
+      if (references.emplace(component, nullptr).second) {
+        components.push_back(component);
+      }
+      const bool is_valid = std::all_of(
+          inputs.begin(), inputs.end(), [&](TensorView* input_tv) {
+            return input_tv->uses().empty() || !component->has(input_tv) ||
+                areAllInputIdsMappedTo(input_tv, output_tv);
+          });
+      TensorView*& reference = references.at(component);
+      if (is_valid &&
+          (reference == nullptr ||
+           pointwise_utils::nRootDims(output_tv) >
+               pointwise_utils::nRootDims(reference))) {
+        reference = output_tv;
+      }
+    }
+
+    std::vector<TensorView*> result;
+    for (const auto* component : components) {
+      TensorView* reference = references.at(component);
+      if (reference == nullptr) {
+        return {};
+      }
+      result.push_back(reference);
+    }
+    return result;
+  }
+
  private:
   bool hasMinimumSize(TensorView* tv, int64_t num_axes) const {
     NVF_ERROR(tv != nullptr);
@@ -149,6 +261,174 @@ class DomainMap : public pointwise_utils::DomainMap {
   }
 };
 
+// Horizontal fusions merge small segments that are bound by launch latency,
+// so every component gets the plain 1D schedule without vectorization, which
+// would need a vectorization analysis per component.
+std::shared_ptr<PointwiseParams> getHorizontalPointwiseHeuristics(
+    PrimDataType index_type) {
+  auto params = std::make_shared<PointwiseParams>(
+      "Horizontal pointwise heuristics", index_type);
+  params->lparams.bind(kThreadX, ParallelType::TIDx);
+  if (isDebugDumpEnabled(DebugDumpOption::SchedulerDebug)) {
+    debug() << params->toString() << std::endl;
+  }
+  return params;
+}
+
+// Schedules each connected component of a disconnected fusion like the 1D
+// schedule of schedulePointwise, using its own reference tensor. All
+// components share BIDx and TIDx, and blocks are predicated out of the
+// components they do not cover.
+void scheduleHorizontalPointwise(
+    Fusion* fusion,
+    const std::vector<TensorView*>& cached_inputs,
+    const std::vector<std::pair<TensorView*, TensorView*>>& cached_outputs) {
+  std::vector<TensorView*> reference_tvs =
+      getHorizontalReferenceTensorViews(fusion);
+  NVF_ERROR(
+      !reference_tvs.empty(),
+      "Could not find a reference tensor for each component of the fusion.");
+
+  scheduler_utils::moveNonConcretizedBroadcastInnermost(
+      fusion, {reference_tvs.begin(), reference_tvs.end()});
+
+  constexpr int64_t unswitch_pos = 2;
+  for (TensorView* reference_tv : reference_tvs) {
+    if (pointwise_utils::nRootDims(reference_tv) == 0) {
+      continue;
+    }
+
+    std::unordered_map<int64_t, int64_t> logical_reorder_map =
+        scheduler_utils::maybeLogicalReorderAsAllocationMap(reference_tv);
+    if (!logical_reorder_map.empty()) {
+      reference_tv->reorder(logical_reorder_map);
+    }
+    for (int64_t i = reference_tv->nDims() - 1; i > 0; i--) {
+      reference_tv->merge(i - 1, i);
+    }
+
+    // [BIDx, Unswitch, TIDx]
+    reference_tv->split(0, kThreadX);
+    reference_tv->split(0, 1);
+    reference_tv->axis(0)->parallelize(ParallelType::BIDx);
+    reference_tv->axis(1)->parallelize(ParallelType::Unswitch);
+    reference_tv->axis(2)->parallelize(ParallelType::TIDx);
+
+    TransformPropagator propagator(reference_tv);
+    MaxLogicalDomainInfoSpanningTree spanning_tree(reference_tv);
+    spanning_tree.traverse(&propagator);
+    scheduler_utils::parallelizeAllLike(reference_tv);
+
+    inlineAllAt(reference_tv, unswitch_pos, true);
+  }
+
+  auto all_tvs = fusion->allTvs();
+  std::unordered_set<TensorView*> inner_most_tensors(
+      all_tvs.begin(), all_tvs.end());
+  for (auto cached_input : cached_inputs) {
+    inner_most_tensors.erase(cached_input);
+  }
+  for (auto entry : cached_outputs) {
+    inner_most_tensors.erase(entry.second);
+  }
+  inlineMost(inner_most_tensors);
+}
+
+// Note [TMA pointwise store]
+//
+// The 1D vectorized schedule gives each CTA a contiguous [TIDx, Vectorize]
+// chunk of the flattened outputs, each thread storing its own vector. With
+// PointwiseParams::use_tma_store, the cached outputs are instead written into
+// shared memory, and each chunk is stored by TMA as boxes of at most
+// kTmaStoreBoxSize elements of the flattened output, so that the threads
+// neither issue the global stores nor compute their addresses. The TMA
+// stores are asynchronous, so they overlap with the computation of other
+// CTAs on the same SM.
+//
+// This requires Hopper and, for every output:
+//   - a contiguous allocation domain without broadcast, reduction or device
+//     dimensions, in the order of the logical domain and with all dimensions
+//     of the reference, so that the chunks are contiguous in global memory,
+//   - an inner-most dimension whose bytes are a multiple of 16.
+// Fusions with reshapes are not supported, as the reference is then
+// scheduled after the propagated reshape transforms.
+
+// Largest extent of a TMA box dimension
+constexpr int64_t kTmaStoreBoxSize = 256;
+
+// See Note [TMA pointwise store]
+// Position of a fusion input, or of a fusion output after all the inputs,
+// which identifies the tensor across copies of the fusion.
+int64_t inputOrOutputPosition(Fusion* fusion, TensorView* tv) {
+  const std::vector<Val*>& inputs = fusion->inputs();
+  auto input_it = std::find(inputs.begin(), inputs.end(), tv);
+  if (input_it != inputs.end()) {
+    return std::distance(inputs.begin(), input_it);
+  }
+  const std::vector<Val*>& outputs = fusion->outputs();
+  auto output_it = std::find(outputs.begin(), outputs.end(), tv);
+  NVF_ERROR(output_it != outputs.end(), "Not a fusion input or output: ", tv);
+  return (int64_t)inputs.size() + std::distance(outputs.begin(), output_it);
+}
+
+bool canUseTmaStore(
+    Fusion* fusion,
+    SchedulerRuntimeInfo& runtime_info,
+    const PointwiseParams& params,
+    TensorView* reference) {
+  if (!isOptionEnabled(EnableOption::TmaStore) ||
+      at::cuda::getCurrentDeviceProperties()->major < 9 ||
+      params.break_point != 0 || !params.vectorize ||
+      !ir_utils::getViewOps(fusion).empty()) {
+    return false;
+  }
+  const int64_t chunk = kThreadX * params.unroll_factor;
+  if (chunk % std::min(chunk, kTmaStoreBoxSize) != 0) {
+    return false;
+  }
+  constexpr int64_t tma_alignment_bytes = 16;
+  const int64_t reference_dims = pointwise_utils::nRootDims(reference);
+  for (auto tv : ir_utils::filterByType<TensorView>(fusion->outputs())) {
+    if (tv->isFusionInput() || tv->hasAllocation() ||
+        fusion->getOutputAlias(tv).type != AllocationType::New) {
+      return false;
+    }
+    const std::vector<IterDomain*>& alloc = tv->getMaybeAllocationDomain();
+    if (alloc.empty() || (int64_t)alloc.size() != reference_dims) {
+      return false;
+    }
+    for (auto i : c10::irange(alloc.size())) {
+      if (alloc[i]->isBroadcast() || alloc[i]->isReduction() ||
+          alloc[i]->isDeviceDim() || !tv->getContiguity()[i].value_or(false)) {
+        return false;
+      }
+    }
+    const int64_t dtype_size = dataTypeSize(tv->getDataType().value());
+    auto inner_extent =
+        runtime_info.expressionEvaluator().evaluate(alloc.back()->extent());
+    if (!inner_extent.hasValue() ||
+        inner_extent.as<int64_t>() * dtype_size % tma_alignment_bytes != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Number of blocks of a grid-stride schedule, or 0 if each block should move
+// a single tile. See Note [Grid-stride pointwise schedule]
+int64_t getGridStrideBlocks(const PointwiseParams& params, int64_t n_elems) {
+  if (isOptionDisabled(DisableOption::PointwiseGridStride) ||
+      params.break_point != 0 || params.use_tma_store) {
+    return 0;
+  }
+  const auto device_prop = at::cuda::getCurrentDeviceProperties();
+  const int64_t blocks = kGridStrideWaves *
+      ((int64_t)device_prop->maxThreadsPerMultiProcessor / kThreadX) *
+      (int64_t)device_prop->multiProcessorCount;
+  const int64_t tiles = ceilDiv(n_elems, kThreadX * params.unroll_factor);
+  return tiles >= kMinGridStrideTiles * blocks ? blocks : 0;
+}
+
 } // namespace
 
 std::shared_ptr<PointwiseParams> getPointwiseHeuristics(
@@ -181,10 +461,17 @@ std::shared_ptr<PointwiseParams> getPointwiseHeuristics(
 
   auto largest_out_entry =
       HeuristicSummaryEntry<HeuristicCompileTime::ReferenceTensors>(
-          data_cache, [&domain_map]() {
+          data_cache, [&domain_map, fusion]() {
+            if (!registry_utils::isConnectedFusionGraph(fusion)) {
+              return std::make_unique<std::vector<TensorView*>>(
+                  domain_map.findHorizontalReferenceTensorViews());
+            }
             std::vector<TensorView*> data{domain_map.findReferenceTensorView()};
             return std::make_unique<std::vector<TensorView*>>(std::move(data));
           });
+  if (largest_out_entry.get().size() > 1) {
+    return getHorizontalPointwiseHeuristics(index_type);
+  }
   TensorView* largest_out = largest_out_entry.get()[0];
 
   NVF_ERROR(largest_out != nullptr);
@@ -301,6 +588,11 @@ std::shared_ptr<PointwiseParams> getPointwiseHeuristics(
   // Ideal break point location
   int break_point = 0;
 
+  // Second break point and serial factor of a 3D schedule. See
+  // Note [3D pointwise schedule]
+  int64_t break_point2 = 0;
+  int64_t serial_factor = 1;
+
   // If break_point, mark if BIDy and BIDx should be positionally reversed
   // relative to root domains
   bool flip_grid_binding = false;
@@ -447,17 +739,88 @@ std::shared_ptr<PointwiseParams> getPointwiseHeuristics(
     }
   }
 
+  // See Note [3D pointwise schedule]
+  if (isOptionEnabled(EnableOption::Pointwise3D) &&
+      n_elems * 2 > device_multiprocessor_count * kThreadX &&
+      scheduler_utils::getViewTVs(fusion).empty()) {
+    const auto& input_patterns = broadcast_info.get().input_patterns;
+    // Bytes per element of the reference of the inputs that are loaded once
+    // per serial_factor elements with the best break points
+    int64_t max_hoisted_bytes = 0;
+    for (const auto bp1 : c10::irange(1, (int64_t)ref_root.size())) {
+      for (const auto bp2 : c10::irange(bp1 + 1, (int64_t)ref_root.size())) {
+        int64_t cur_middle_elem_count = 1;
+        for (const auto middle_i : c10::irange(bp1, bp2)) {
+          cur_middle_elem_count *= elem_counts[middle_i];
+        }
+        int64_t cur_right_elem_count = 1;
+        for (const auto right_i : c10::irange(bp2, ref_root.size())) {
+          cur_right_elem_count *= elem_counts[right_i];
+        }
+        // Need a middle dimension to iterate over, at least an unrolled warp
+        // on the right, and at most 65535 blocks along BIDy
+        if (cur_middle_elem_count <= 1 ||
+            ceilDiv(cur_right_elem_count, max_unroll_factor) <=
+                at::cuda::getCurrentDeviceProperties()->warpSize ||
+            ceilDiv(cur_right_elem_count, kThreadX * max_unroll_factor) >
+                65535) {
+          continue;
+        }
+        // Inputs with no iteration domain in the middle that are not scalars
+        int64_t hoisted_bytes = 0;
+        for (const auto& pattern : input_patterns) {
+          const auto& mapped = pattern.mapped_axes;
+          if (std::none_of(
+                  mapped.begin() + bp1,
+                  mapped.begin() + bp2,
+                  [](bool m) { return m; }) &&
+              std::any_of(mapped.begin(), mapped.end(), [](bool m) {
+                return m;
+              })) {
+            hoisted_bytes += pattern.dtype_size;
+          }
+        }
+        if (hoisted_bytes <= max_hoisted_bytes) {
+          continue;
+        }
+        max_hoisted_bytes = hoisted_bytes;
+        break_point = static_cast<int>(bp1);
+        break_point2 = bp2;
+        right_elem_count = cur_right_elem_count;
+        flip_grid_binding = false;
+        bdimx = std::min(
+            ceilDiv(cur_right_elem_count, max_unroll_factor), kThreadX);
+        bdimy = 1;
+        gdim_right = ceilDiv(cur_right_elem_count, bdimx * max_unroll_factor);
+        // Iterate over up to kMaxSerialFactor elements of the middle as long
+        // as there's at least a wave of blocks
+        serial_factor = std::min(cur_middle_elem_count, kMaxSerialFactor);
+        while (serial_factor > 1 &&
+               (n_elems / cur_middle_elem_count / cur_right_elem_count) *
+                       ceilDiv(cur_middle_elem_count, serial_factor) *
+                       gdim_right <
+                   device_multiprocessor_count) {
+          serial_factor /= 2;
+        }
+        gdim_left = (n_elems / cur_middle_elem_count / cur_right_elem_count) *
+            ceilDiv(cur_middle_elem_count, serial_factor);
+      }
+    }
+  }
+
   // Don't try to vectorize if it's not recommended
   params->unroll_factor = 1;
 
+  std::vector<TensorView*> misaligned_tvs;
   const auto vectorize_factor = std::min(
       max_unroll_factor,
       vectorize_helper::getVectorizationFactor(
           runtime_info,
           largest_out,
           data_cache,
-          break_point,
-          logical_reorder_map));
+          break_point2 > 0 ? break_point2 : break_point,
+          logical_reorder_map,
+          &misaligned_tvs));
 
   if (vectorize_factor == 1) {
     params->vectorize = false;
@@ -465,12 +828,24 @@ std::shared_ptr<PointwiseParams> getPointwiseHeuristics(
   } else {
     params->vectorize = true;
     params->unroll_factor = vectorize_factor;
+    for (auto tv : misaligned_tvs) {
+      // The factor may have been lowered below the alignment of the tensor
+      if ((int64_t)runtime_info.getAlignmentSize(tv) <
+          vectorize_factor * dataTypeSize(tv->dtype(), index_type)) {
+        params->misaligned_tensors.push_back(
+            inputOrOutputPosition(fusion, tv));
+      }
+    }
+    std::sort(
+        params->misaligned_tensors.begin(), params->misaligned_tensors.end());
   }
 
   NVF_ERROR(right_elem_count > 0 || break_point == 0);
   NVF_ERROR(!(bdimy > 1 && gdim_right > 1));
 
   params->break_point = break_point;
+  params->break_point2 = break_point2;
+  params->serial_factor = serial_factor;
   params->flip_grid_binding = flip_grid_binding;
   params->split_block = bdimy > 1;
 
@@ -478,11 +853,20 @@ std::shared_ptr<PointwiseParams> getPointwiseHeuristics(
   if (params->split_block) {
     params->lparams.bind(bdimy, ParallelType::TIDy);
   }
-  if ((flip_grid_binding && gdim_right > 65535) ||
-      (!flip_grid_binding && gdim_left > 65535)) {
+  // The 3D schedule binds the left and middle dimensions to BIDx
+  if (break_point2 == 0 &&
+      ((flip_grid_binding && gdim_right > 65535) ||
+       (!flip_grid_binding && gdim_left > 65535))) {
     params->split_grid_y_dim = true;
   }
 
+  params->use_tma_store =
+      canUseTmaStore(fusion, runtime_info, *params, largest_out);
+
+  params->grid_stride_blocks = getGridStrideBlocks(*params, n_elems);
+  params->grid_stride_prefetch =
+      params->grid_stride_blocks > 0 && params->vectorize;
+
   if (isDebugDumpEnabled(DebugDumpOption::SchedulerDebug)) {
     debug() << "\n===== Pointwise Stats ========\n"
             << "num_elems: " << n_elems << "\n"
@@ -530,6 +914,12 @@ bool hasReferenceTensorView(Fusion* fusion) {
   return getReferenceTensorView(fusion) != nullptr;
 }
 
+std::vector<TensorView*> getHorizontalReferenceTensorViews(Fusion* fusion) {
+  FusionGuard fg(fusion);
+  DomainMap domain_map(fusion);
+  return domain_map.findHorizontalReferenceTensorViews();
+}
+
 // TODO: Inline intermediate operations (avoid inlining unrolled/vectorized
 // input/output caches)
 void schedulePointwise(Fusion* fusion, const PointwiseParams& params) {
@@ -576,12 +966,32 @@ void schedulePointwise(Fusion* fusion, const PointwiseParams& params) {
     return;
   }
 
+  // See [ Note -- Horizontal fusion ] in fusion_segmenter.cpp
+  if (!registry_utils::isConnectedFusionGraph(fusion)) {
+    scheduleHorizontalPointwise(fusion, cached_inputs, cached_outputs);
+    scheduler_utils::promoteProducerMemoryTypes(fusion, cached_inputs);
+    markAliases(fusion);
+    return;
+  }
+
   TensorView* reference_tv = getReferenceTensorView(fusion);
 
   NVF_ERROR(
       reference_tv != nullptr,
       "Could not find a fully broadcasted output to reference schedule on.");
 
+  // Store the outputs from shared memory with TMA. See
+  // Note [TMA pointwise store]
+  std::vector<TensorView*> tma_store_tvs;
+  if (params.use_tma_store) {
+    for (auto [cached_output, output] : cached_outputs) {
+      cached_output->setMemoryType(MemoryType::Shared);
+      output->definition()->as<LoadStoreOp>()->setOpType(
+          LoadStoreOpType::CpAsyncBulkTensorTile);
+      tma_store_tvs.push_back(output);
+    }
+  }
+
   scheduler_utils::moveNonConcretizedBroadcastInnermost(fusion, {reference_tv});
 
   int64_t num_device_dims = numDeviceDims(reference_tv);
@@ -590,8 +1000,15 @@ void schedulePointwise(Fusion* fusion, const PointwiseParams& params) {
   // Positions of rhs and lhs after merging all dimensions.
   int64_t rhs_i = -1;
   int64_t lhs_i = -1;
+  // Position of the middle dimension of a 3D schedule after merging, and its
+  // logical domains. See Note [3D pointwise schedule]
+  int64_t mid_i = -1;
+  std::vector<IterDomain*> middle_ids;
 
   if (!ir_utils::getViewOps(fusion).empty()) {
+    NVF_ERROR(
+        params.break_point2 == 0,
+        "3D pointwise schedules are not supported with reshapes");
     ComputeAtMap ca_map(fusion);
     // Propagate reshape transforms through the graph, expecially the reference.
     scheduler_utils::propagateReshapeTransforms(fusion, ca_map);
@@ -679,8 +1096,12 @@ void schedulePointwise(Fusion* fusion, const PointwiseParams& params) {
     }
     reorderDIDToFront(reference_tv);
 
-    // Merge right side of break point
-    for (int64_t i = reference_tv->nDims(); i > device_aware_break_point; i--) {
+    // Merge right side of break point, the second one of a 3D schedule
+    const int64_t device_aware_inner_break_point = params.break_point2 > 0
+        ? params.break_point2 + num_device_dims
+        : device_aware_break_point;
+    for (int64_t i = reference_tv->nDims(); i > device_aware_inner_break_point;
+         i--) {
       auto axis_i = i - 1;
       if (rhs_i == -1) {
         rhs_i = axis_i;
@@ -694,6 +1115,25 @@ void schedulePointwise(Fusion* fusion, const PointwiseParams& params) {
       reference_tv->reorder({{rhs_i, -1}});
     }
 
+    // Merge the middle of a 3D schedule, which is right before the rhs
+    if (params.break_point2 > 0) {
+      middle_ids = {
+          reference_tv->getLoopDomain().begin() + device_aware_break_point,
+          reference_tv->getLoopDomain().begin() +
+              device_aware_inner_break_point};
+      for (int64_t i = device_aware_inner_break_point;
+           i > device_aware_break_point;
+           i--) {
+        auto axis_i = i - 1;
+        if (mid_i == -1) {
+          mid_i = axis_i;
+        } else {
+          reference_tv->merge(axis_i, mid_i);
+          mid_i = axis_i;
+        }
+      }
+    }
+
     // Merge left side of break point
     for (int64_t i = device_aware_break_point; i > num_device_dims; i--) {
       auto axis_i = i - 1;
@@ -708,7 +1148,45 @@ void schedulePointwise(Fusion* fusion, const PointwiseParams& params) {
 
   int64_t unswitch_pos = 0;
   IterDomain* vectorize_id = nullptr;
-  if (params.break_point) {
+  if (params.break_point2) {
+    // 3D parallelization scheme, see Note [3D pointwise schedule]
+    NVF_ERROR(rhs_i >= 0 && mid_i >= 0 && lhs_i >= 0);
+    NVF_ERROR(!params.split_block && !params.use_tma_store);
+
+    // Order as [lhs_i, mid_i, rhs_i, unmerged...]
+    reference_tv->reorder({{lhs_i, 0}, {mid_i, 1}, {-1, 2}});
+
+    if (params.vectorize) {
+      reference_tv->split(2, params.unroll_factor);
+      reference_tv->split(2, NamedScalar::getParallelDim(ParallelType::TIDx));
+      reference_tv->split(2, 1);
+      // [outer, middle, i-remainder, Unswitch, TIDx, Vectorization]
+      reference_tv->axis(3)->parallelize(ParallelType::Unswitch);
+      reference_tv->axis(4)->parallelize(ParallelType::TIDx);
+      // Vectorization are propagated separately
+      vectorize_id = reference_tv->axis(5);
+      // To make consistent with unrolling:
+      reference_tv->reorder({{4, 5}, {5, 4}});
+      // [outer, middle, i-remainder, Unswitch, Vectorization, TIDx]
+    } else {
+      reference_tv->split(2, NamedScalar::getParallelDim(ParallelType::TIDx));
+      reference_tv->split(2, params.unroll_factor);
+      reference_tv->split(2, 1);
+      // [outer, middle, i-remainder, Unswitch, Unroll, TIDx]
+      reference_tv->axis(3)->parallelize(ParallelType::Unswitch);
+      // Unrolled manually as in the 2D schedule
+      reference_tv->axis(5)->parallelize(ParallelType::TIDx);
+    }
+
+    reference_tv->split(1, params.serial_factor);
+    reference_tv->merge(0);
+    // [outer * m-remainder, Serial, i-remainder, Unswitch, ...]
+    reference_tv->reorder({{1, 2}, {2, 1}});
+    // [BIDx | BIDy | Serial | Unswitch, Unroll, TIDx]
+    reference_tv->axis(0)->parallelize(ParallelType::BIDx);
+    reference_tv->axis(1)->parallelize(ParallelType::BIDy);
+    unswitch_pos = 4;
+  } else if (params.break_point) {
     // 2D parallelization scheme
     NVF_ERROR(rhs_i >= 0 && lhs_i >= 0);
 
@@ -829,7 +1307,11 @@ void schedulePointwise(Fusion* fusion, const PointwiseParams& params) {
 
       reference_tv->axis(0)->parallelize(ParallelType::BIDx);
       reference_tv->axis(1)->parallelize(ParallelType::TIDx);
-      reference_tv->axis(2)->parallelize(ParallelType::Unswitch);
+      // TMA is issued by a single thread, which the predicate of an
+      // unswitched loop does not know about
+      if (!params.use_tma_store) {
+        reference_tv->axis(2)->parallelize(ParallelType::Unswitch);
+      }
       // Vectorization are propagated separately
       vectorize_id = reference_tv->axis(3);
 
@@ -856,6 +1338,16 @@ void schedulePointwise(Fusion* fusion, const PointwiseParams& params) {
       reference_tv->axis(3)->parallelize(ParallelType::TIDx);
     }
     unswitch_pos = 2;
+
+    if (params.grid_stride_blocks > 0) {
+      // [BIDx{blocks}, Serial, Unswitch, ...], see
+      // Note [Grid-stride pointwise schedule]
+      reference_tv->split(0, params.grid_stride_blocks);
+      reference_tv->reorder({{0, 1}});
+      reference_tv->axis(0)->parallelize(ParallelType::BIDx);
+      reference_tv->axis(1)->parallelize(ParallelType::Serial);
+      unswitch_pos = 3;
+    }
   }
 
   TransformPropagator propagator(reference_tv);
@@ -870,6 +1362,20 @@ void schedulePointwise(Fusion* fusion, const PointwiseParams& params) {
     std::vector<TensorView*> vectorized_tvs;
     bool should_vectorize_reference_tv = false;
     for (auto tv : inputs_outputs) {
+      // Misaligned tensors are accessed by scalars in the vectorized loop
+      if (std::binary_search(
+              params.misaligned_tensors.begin(),
+              params.misaligned_tensors.end(),
+              inputOrOutputPosition(fusion, tv))) {
+        continue;
+      }
+      // Vectorize the writes of the threads to the shared memory tiles
+      if (std::find(tma_store_tvs.begin(), tma_store_tvs.end(), tv) !=
+          tma_store_tvs.end()) {
+        vectorized_tvs.emplace_back(
+            tv->definition()->input(0)->as<TensorView>());
+        continue;
+      }
       if (tv == reference_tv) {
         should_vectorize_reference_tv = true;
       }
@@ -894,14 +1400,75 @@ void schedulePointwise(Fusion* fusion, const PointwiseParams& params) {
     }
   }
 
+  // [BIDx, Unswitch, Vectorization, TIDx] -> [BIDx, 1, TIDx * Vectorization]
+  // -> [BIDx, 1, TIDx * Vectorization / box, Bulk{box}]. The shared memory
+  // tiles are allocated as [TIDx, Vectorization], which is the layout of the
+  // boxes in shared memory.
+  for (auto tv : tma_store_tvs) {
+    NVF_ERROR(tv->nDims() == 4, "Unexpected TMA store schedule: ", tv);
+    auto smem_tv = tv->definition()->input(0)->as<TensorView>();
+    smem_tv->setAllocationDomain(
+        {smem_tv->axis(0),
+         smem_tv->axis(1),
+         smem_tv->axis(3),
+         smem_tv->axis(2)},
+        true);
+    tv->reorder({{2, 3}, {3, 2}});
+    tv->merge(2);
+    tv->split(
+        2, std::min(kThreadX * params.unroll_factor, kTmaStoreBoxSize));
+    tv->axis(1)->parallelize(ParallelType::Serial);
+    tv->axis(2)->parallelize(ParallelType::Serial);
+    tv->axis(3)->parallelize(ParallelType::Bulk);
+  }
+
+  auto all_tvs = fusion->allTvs();
+
+  // Load the cached inputs with no iteration domain in the middle of a 3D
+  // schedule outside of the serial loop. Inline positions are never lowered,
+  // so this comes first. See Note [3D pointwise schedule]
+  std::unordered_set<TensorView*> hoisted_inputs;
+  if (params.break_point2) {
+    ComputeAtMap ca_map(fusion);
+    for (auto cached_input : cached_inputs) {
+      const auto& logical = cached_input->getLogicalDomain();
+      if (std::none_of(logical.begin(), logical.end(), [&](IterDomain* id) {
+            return !id->isBroadcast() &&
+                std::any_of(middle_ids.begin(),
+                            middle_ids.end(),
+                            [&](IterDomain* middle_id) {
+                              return ca_map.areMapped(
+                                  id, middle_id, IdMappingMode::EXACT);
+                            });
+          })) {
+        hoisted_inputs.insert(cached_input);
+      }
+    }
+    // [BIDx | BIDy | Serial | ...]
+    inlineSelectedAt(hoisted_inputs, reference_tv, 2, true);
+  } else if (params.grid_stride_prefetch) {
+    // Load whole tiles of the cached inputs, which are then double buffered
+    // along the grid-stride loop. See Note [Grid-stride pointwise schedule]
+    hoisted_inputs.insert(cached_inputs.begin(), cached_inputs.end());
+    // [BIDx | Serial | Unswitch | ...]
+    inlineSelectedAt(hoisted_inputs, reference_tv, 2, true);
+  }
+
   // Begin by inlining at the unswitch position for the entire DAG. The cached
   // inputs, and outputs will keep this inline position, but other tensors will
   // get a higher position in later inline propagation. We need this separate
   // step because we were not using ParallelType::Unroll, so we have to do
   // unrolling manually.
-  inlineAllAt(reference_tv, unswitch_pos, true);
-
-  auto all_tvs = fusion->allTvs();
+  if (hoisted_inputs.empty()) {
+    inlineAllAt(reference_tv, unswitch_pos, true);
+  } else {
+    std::unordered_set<TensorView*> unswitched_tvs(
+        all_tvs.begin(), all_tvs.end());
+    for (auto tv : hoisted_inputs) {
+      unswitched_tvs.erase(tv);
+    }
+    inlineSelectedAt(unswitched_tvs, reference_tv, unswitch_pos, true);
+  }
 
   // Inline at the inner most position. The CA position of all tensors except
   // inputs, cached inputs and outputs will be updated.
@@ -918,6 +1485,17 @@ void schedulePointwise(Fusion* fusion, const PointwiseParams& params) {
 
   scheduler_utils::promoteProducerMemoryTypes(fusion, cached_inputs);
 
+  if (params.grid_stride_prefetch) {
+    for (auto cached_input : cached_inputs) {
+      // Inputs used, e.g., as lookup tables can't be inlined up to the
+      // grid-stride loop
+      if (cached_input->getComputeAtPosition() == 2 &&
+          cached_input->getMemoryType() == MemoryType::Local) {
+        cached_input->circularBuffer(2);
+      }
+    }
+  }
+
   // TODO(#1401): We could let segmentation split a partially alias-producing
   // fusion into an alias-only segment and the rest. This way, the rest of the
   // fusion (which has fewer expressions) can potentially find a better
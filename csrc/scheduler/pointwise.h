@@ -182,6 +182,10 @@ bool hasReferenceTensorView(Fusion* fusion);
 // Return reference tensor view.
 TensorView* getReferenceTensorView(Fusion* fusion);
 
+//! Returns a reference tensor view for each connected component of a
+//! disconnected fusion, or an empty vector if a component has none.
+std::vector<TensorView*> getHorizontalReferenceTensorViews(Fusion* fusion);
+
 class PointWiseScheduler : public SchedulerEntry {
  public:
   explicit PointWiseScheduler(
@@ -10,6 +10,7 @@
 #include <scheduler/heuristic.h>
 
 #include <sstream>
+#include <vector>
 
 namespace nvfuser {
 
@@ -28,6 +29,16 @@ class PointwiseParams : public HeuristicParams {
   // dimension, and all the others as an inner dimension.
   int64_t break_point = 0;
 
+  // Second break point of a 3D schedule, or 0 for a 1D or 2D schedule. The
+  // dimensions between break_point and break_point2 are the middle dimension,
+  // which is iterated serially by each thread serial_factor elements at a time.
+  // See Note [3D pointwise schedule]
+  int64_t break_point2 = 0;
+
+  // Number of elements of the middle dimension of a 3D schedule iterated by
+  // each thread
+  int64_t serial_factor = 1;
+
   // Split block across left and right dimension
   bool split_block = false;
 
@@ -43,6 +54,25 @@ class PointwiseParams : public HeuristicParams {
   // Unroll or vectorization factor
   int64_t unroll_factor = 1;
 
+  // Positions, in the fusion inputs followed by the fusion outputs, of the
+  // tensors whose base address or strides are not aligned to the vectorization
+  // factor. They are read or written by scalars while the others stay
+  // vectorized. Sorted.
+  std::vector<int64_t> misaligned_tensors;
+
+  // Stage the outputs in shared memory and store them with TMA. Requires
+  // Hopper and a vectorized 1D schedule. See Note [TMA pointwise store]
+  bool use_tma_store = false;
+
+  // Number of blocks of a 1D schedule walking the tiles of the problem in a
+  // grid-stride loop, or 0 for one tile per block. See
+  // Note [Grid-stride pointwise schedule]
+  int64_t grid_stride_blocks = 0;
+
+  // Load the next tile of the cached inputs of a grid-stride schedule while
+  // computing the current one
+  bool grid_stride_prefetch = false;
+
   using HeuristicParams::HeuristicParams;
 
   // Warning: Does not check launch parameters!
@@ -55,10 +85,16 @@ class PointwiseParams : public HeuristicParams {
     const PointwiseParams& other = *other_casted;
     bool attr_equal = other.cparams == cparams &&
         other.vectorize == vectorize && other.break_point == break_point &&
+        other.break_point2 == break_point2 &&
+        other.serial_factor == serial_factor &&
         other.split_block == split_block &&
         other.split_grid_y_dim == split_grid_y_dim &&
         other.unroll_factor == unroll_factor &&
-        other.flip_grid_binding == flip_grid_binding;
+        other.flip_grid_binding == flip_grid_binding &&
+        other.use_tma_store == use_tma_store &&
+        other.grid_stride_blocks == grid_stride_blocks &&
+        other.grid_stride_prefetch == grid_stride_prefetch &&
+        other.misaligned_tensors == misaligned_tensors;
     return attr_equal;
   }
 
@@ -68,7 +104,12 @@ class PointwiseParams : public HeuristicParams {
        << (tag.empty() ? "" : "Tag: ") << tag << " Pointwise Characteristics:\n"
        << " Gridx: " << lparams.gdimx() << " BlckY: " << lparams.bdimy()
        << " BlckX: " << lparams.bdimx() << "\n";
-    if (break_point) {
+    if (break_point2) {
+      ss << "3D Schedule\n"
+         << "  Bcast break points: " << break_point << ", " << break_point2
+         << "\n"
+         << "  Serial factor: " << serial_factor << "\n";
+    } else if (break_point) {
       ss << "2D Schedule\n"
          << "  Bcast break point: " << break_point << "\n";
       if (split_block) {
@@ -81,6 +122,13 @@ class PointwiseParams : public HeuristicParams {
     if (unroll_factor > 1) {
       if (vectorize) {
         ss << "Vectorize, Factor: " << unroll_factor << "\n";
+        if (!misaligned_tensors.empty()) {
+          ss << "  Misaligned inputs/outputs:";
+          for (auto pos : misaligned_tensors) {
+            ss << " " << pos;
+          }
+          ss << "\n";
+        }
       } else {
         ss << "Unroll, Factor: " << unroll_factor << "\n";
       }
@@ -88,6 +136,15 @@ class PointwiseParams : public HeuristicParams {
     if (flip_grid_binding) {
       ss << "Flip BIDx/BIDy bindings\n";
     }
+    if (use_tma_store) {
+      ss << "TMA store of outputs\n";
+    }
+    if (grid_stride_blocks > 0) {
+      ss << "Grid-stride loop over " << grid_stride_blocks << " blocks\n";
+      if (grid_stride_prefetch) {
+        ss << "  Prefetch next tile\n";
+      }
+    }
     ss << "====================================\n";
     return ss.str();
   }
@@ -99,7 +156,15 @@ class PointwiseParams : public HeuristicParams {
         static_cast<size_t>(split_block) << 5 ^
         static_cast<size_t>(split_grid_y_dim) << 6 ^
         static_cast<size_t>(unroll_factor) << 9 ^
-        static_cast<size_t>(flip_grid_binding) << 10;
+        static_cast<size_t>(flip_grid_binding) << 10 ^
+        static_cast<size_t>(use_tma_store) << 11 ^
+        static_cast<size_t>(break_point2) << 13 ^
+        static_cast<size_t>(serial_factor) << 17 ^
+        static_cast<size_t>(grid_stride_prefetch) << 7 ^
+        static_cast<size_t>(grid_stride_blocks) << 20;
+    for (auto pos : misaligned_tensors) {
+      attr_hash ^= static_cast<size_t>(pos) << 12;
+    }
     return attr_hash;
   }
 
@@ -9,6 +9,7 @@
 #include <debug.h>
 #include <instrumentation.h>
 #include <multidevice/utils.h>
+#include <options.h>
 #include <scheduler/debug_utils.h>
 #include <scheduler/mark_aliases.h>
 #include <scheduler/reduction.h>
@@ -62,6 +63,23 @@ void reduceProductTo(int64_t& z, int64_t& y, int64_t& x, const int64_t max) {
   }
 }
 
+//! Number of stages of pipelined loads, 2 unless given as the argument of
+//! NVFUSER_ENABLE=pipeline_loads
+int64_t loadPipelineStages() {
+  int64_t stages = 2;
+  const auto& args = getEnableOptionArguments(EnableOption::PipelineLoads);
+  if (!args.empty()) {
+    try {
+      stages = std::stoll(args[0]);
+    } catch (const std::exception&) {
+      NVF_CHECK(false, "Invalid number of pipeline_loads stages: ", args[0]);
+    }
+  }
+  NVF_CHECK(
+      stages > 1, "pipeline_loads needs at least 2 stages, but got ", stages);
+  return stages;
+}
+
 std::shared_ptr<ReductionParams> innerReductionHeuristic(
     const int64_t total_reduction_numel,
     const int64_t total_iteration_numel,
@@ -460,6 +478,19 @@ std::shared_ptr<ReductionParams> innerReductionHeuristic(
     }
   }
 
+  // Prefetch the loads of the next iterations of the serial loop over the
+  // row. See [ Note -- Load pipelining ] in scheduler/utils.cpp
+  if (isOptionEnabled(EnableOption::PipelineLoads) &&
+      !rparams->cross_grid_inner_reduction && !rparams->schedule_3D &&
+      iter_unroll_factor == 1 && inner_reduction_unroll_factor > 1) {
+    const int64_t stages = loadPipelineStages();
+    const int64_t serial_iterations = ceilDiv(
+        inner_most_dimension_numel, bdimx * inner_reduction_unroll_factor);
+    if (serial_iterations >= 2 * stages) {
+      rparams->circular_buffer_stages = stages;
+    }
+  }
+
   rparams->lparams = LaunchParams(
       gdimx,
       gdimy,
@@ -1346,6 +1377,23 @@ std::shared_ptr<ReductionParams> getReductionHeuristics(
       max_dtype_size,
       vectorize_factor);
   heuristic->cparams.index_type = runtime_info.getIndexType();
+  // Integer sums are exact in any order, see Note [Shared memory atomic block
+  // reductions] in reduction_utils.cpp
+  heuristic->smem_atomic_block_reduction = std::all_of(
+      reduction_tvs.begin(), reduction_tvs.end(), [](TensorView* tv) {
+        auto rop = dynamic_cast<ReductionOp*>(tv->definition());
+        return rop != nullptr &&
+            rop->getReductionOpType() == BinaryOpType::Add &&
+            (tv->dtype() == DataType::Int32 || tv->dtype() == DataType::Int);
+      });
+  // See Note [Atomic grid reductions] in reduction_utils.cpp. Integer sums
+  // are deterministic with atomics too.
+  heuristic->atomic_grid_reduction =
+      (isOptionEnabled(EnableOption::AtomicGridReduction) ||
+       heuristic->smem_atomic_block_reduction) &&
+      !heuristic->fastest_dim && heuristic->cross_grid_inner_reduction &&
+      !heuristic->persistent_kernel &&
+      reduction_scheduler_utils::canUseAtomicGridReductions(reduction_tvs);
   return heuristic;
 }
 
@@ -1358,8 +1406,10 @@ void scheduleReduction(Fusion* fusion, const ReductionParams& rparams) {
   // Cache inputs if unrolled
   auto cached_inputs = scheduler_utils::cacheInputs(fusion, unroll);
 
-  // Cache and fork outputs
-  auto cached_outputs = scheduler_utils::cacheAndForkOutputs(fusion, unroll);
+  // Cache and fork outputs. Atomic grid reductions write to their fusion
+  // outputs directly
+  auto cached_outputs = scheduler_utils::cacheAndForkOutputs(
+      fusion, unroll && !rparams.atomic_grid_reduction);
 
   // Make sure we don't have global memory set on intermediate tensors from
   // fusion segmentation
@@ -1386,6 +1436,17 @@ void scheduleReduction(Fusion* fusion, const ReductionParams& rparams) {
         scheduler_utils::domainReorderAsLogicalMap(reduction_tv));
   }
 
+  // Grid reductions can be grouped in pairs, see Note [Grouping sibling
+  // reductions] in reduction_utils.cpp
+  if (isOptionEnabled(EnableOption::GroupReductions) && rparams.fastest_dim &&
+      (rparams.cross_grid_inner_reduction ||
+       rparams.cross_grid_outer_reduction) &&
+      !rparams.persistent_kernel && !rparams.cross_cluster_inner_reduction &&
+      !rparams.atomic_grid_reduction && !rparams.smem_atomic_block_reduction &&
+      reduction_tvs.size() > 1) {
+    reduction_scheduler_utils::groupSiblingReductions(reduction_tvs, 2);
+  }
+
   NVF_ERROR(
       !(rparams.schedule_3D && isSharded(reduction_tv)),
       "Multidevice nvFuser does not support 3D reduction schedules");
@@ -1425,6 +1486,7 @@ void scheduleReduction(Fusion* fusion, const ReductionParams& rparams) {
   // see validateAndConvertIterDomainGrouping
   const bool has_welford = ir_utils::hasOpsOfType<WelfordOp>(fusion);
   const bool use_iter_grouped_reduction = !rparams.fastest_dim &&
+      !rparams.atomic_grid_reduction &&
       (has_welford
            ? rparams.cross_grid_inner_reduction && rparams.persistent_kernel
            : rparams.cross_block_inner_reduction);
@@ -1442,8 +1504,19 @@ void scheduleReduction(Fusion* fusion, const ReductionParams& rparams) {
       cached_inputs,
       cached_outputs);
 
+  reduction_scheduler_utils::setWelfordMode(fusion, rparams.welford_mode);
+  if (rparams.smem_atomic_block_reduction) {
+    reduction_scheduler_utils::requestSmemAtomicBlockReductions(fusion);
+  }
+  if (rparams.atomic_grid_reduction) {
+    reduction_scheduler_utils::requestAtomicGridReductions(fusion);
+  }
+
   scheduler_utils::promoteProducerMemoryTypes(fusion, cached_inputs);
 
+  scheduler_utils::circularBufferCachedInputs(
+      cached_inputs, rparams.circular_buffer_stages);
+
   // TODO(#1401): We could let segmentation split a partially alias-producing
   // fusion into an alias-only segment and the rest. This way, the rest of the
   // fusion (which has fewer expressions) can potentially find a better
@@ -8,6 +8,7 @@
 #pragma once
 
 #include <scheduler/heuristic.h>
+#include <type.h>
 
 #include <sstream>
 
@@ -44,6 +45,11 @@ class ReductionParams : public HeuristicParams {
   bool cross_block_inner_reduction = false;
   // Reduce across the grid?
   bool cross_grid_inner_reduction = false;
+  // Reduce across the grid within thread block clusters, through distributed
+  // shared memory instead of a global work buffer and grid syncs. Requires
+  // persistent_kernel and cross_grid_inner_reduction on BIDx. The cluster
+  // spans gridDim.x, so lparams.gdimx() is the cluster size.
+  bool cross_cluster_inner_reduction = false;
   // Unrolling/Vectorization factor for inner reduction dimension
   int64_t unroll_factor_inner_reduction = 1;
   // vectorize instead of unroll
@@ -54,6 +60,9 @@ class ReductionParams : public HeuristicParams {
   bool pad_inner_reduction_to_warp = false;
   // Register persistent buffer size in inner dimension
   int64_t batches_per_block_inner_reduction = 1;
+  // Number of stages the loads of cached inputs are circular buffered with
+  // across the serial loop of a non-persistent inner reduction, 1 to disable
+  int64_t circular_buffer_stages = 1;
 
   // Which block parallel dimension should be used for the inner reduction.
   // !!WARNING!! Convenience method, this be unique based on non-parallel type
@@ -114,6 +123,18 @@ class ReductionParams : public HeuristicParams {
   bool static_bdimx = false;
   bool static_bdimy = false;
 
+  // How serial WelfordOps are computed, see Note [Welford modes] in
+  // scheduler/reduction_utils.cpp
+  WelfordMode welford_mode = WelfordMode::Default;
+
+  // Use shared memory atomics for block reductions that are sums, see Note
+  // [Shared memory atomic block reductions] in scheduler/reduction_utils.cpp
+  bool smem_atomic_block_reduction = false;
+
+  // Sum grid reductions into zero-filled outputs with global atomics, see
+  // Note [Atomic grid reductions] in scheduler/reduction_utils.cpp
+  bool atomic_grid_reduction = false;
+
   bool isUnrolled() const {
     return unroll_factor_inner_reduction > 1 || unroll_factor_iter_dom > 1 ||
         unroll_factor_outer_reduction > 1;
@@ -145,6 +166,12 @@ class ReductionParams : public HeuristicParams {
   // when the shared memory is much larger than the register file.
   std::vector<TensorView*> smem_persistent_buffers;
 
+  // Number of elements of the rows of the shared memory persistent buffers
+  // loaded from fusion inputs per TMA box, 0 to load them with threads. See
+  // Note [TMA loads of persistent buffers] in
+  // scheduler/normalization_utils.cpp
+  int64_t tma_load_box_size = 0;
+
  public:
   using HeuristicParams::HeuristicParams;
 
@@ -163,6 +190,8 @@ class ReductionParams : public HeuristicParams {
         other.schedule_3D == schedule_3D && other.flip_grid == flip_grid &&
         other.cross_block_inner_reduction == cross_block_inner_reduction &&
         other.cross_grid_inner_reduction == cross_grid_inner_reduction &&
+        other.cross_cluster_inner_reduction ==
+            cross_cluster_inner_reduction &&
         other.unroll_factor_inner_reduction == unroll_factor_inner_reduction &&
         other.vectorize_inner_reduction == vectorize_inner_reduction &&
         other.split_grid_dim_inner_reduction ==
@@ -170,6 +199,7 @@ class ReductionParams : public HeuristicParams {
         other.pad_inner_reduction_to_warp == pad_inner_reduction_to_warp &&
         other.batches_per_block_inner_reduction ==
             batches_per_block_inner_reduction &&
+        other.circular_buffer_stages == circular_buffer_stages &&
         other.multiple_reds_per_blk == multiple_reds_per_blk &&
         other.unroll_factor_iter_dom == unroll_factor_iter_dom &&
         other.vectorize_iter_dom == vectorize_iter_dom &&
@@ -189,7 +219,11 @@ class ReductionParams : public HeuristicParams {
         other.pad_outer_reduction_to_warp == pad_outer_reduction_to_warp &&
         other.vectorization_factor_outer == vectorization_factor_outer &&
         other.vectorization_factor_tmp_gmem_write ==
-            vectorization_factor_tmp_gmem_write;
+            vectorization_factor_tmp_gmem_write &&
+        other.welford_mode == welford_mode &&
+        other.smem_atomic_block_reduction == smem_atomic_block_reduction &&
+        other.atomic_grid_reduction == atomic_grid_reduction &&
+        other.tma_load_box_size == tma_load_box_size;
 
     if (other.static_bdimy || static_bdimy) {
       attr_equal = attr_equal && other.lparams.bdimy() == lparams.bdimy();
@@ -263,9 +297,15 @@ class ReductionParams : public HeuristicParams {
       ss << "cross grid - " << grid_dim_inner_reduction << " / ";
       ss << (split_grid_dim_inner_reduction ? "split grid dim / " : "");
     }
+    if (cross_cluster_inner_reduction) {
+      ss << "cross cluster / ";
+    }
     if (batches_per_block_inner_reduction > 1 || persistent_kernel) {
       ss << "persistent batch - " << batches_per_block_inner_reduction << " / ";
     }
+    if (circular_buffer_stages > 1) {
+      ss << "circular buffered loads - " << circular_buffer_stages << " / ";
+    }
     ss << (cross_grid_inner_reduction && split_grid_dim_inner_reduction
                ? "split grid dimension / "
                : "")
@@ -281,6 +321,22 @@ class ReductionParams : public HeuristicParams {
       ss << "\ncomputeWith persistent buffers";
     }
 
+    if (welford_mode != WelfordMode::Default) {
+      ss << "\nWelford mode: " << welford_mode;
+    }
+
+    if (smem_atomic_block_reduction) {
+      ss << "\nsmem atomic block reduction";
+    }
+
+    if (atomic_grid_reduction) {
+      ss << "\natomic grid reduction";
+    }
+
+    if (tma_load_box_size > 0) {
+      ss << "\nTMA loads of persistent buffers - box " << tma_load_box_size;
+    }
+
     ss << "\n" << lparams.toString();
     ss << cparams.toString() << "\n";
     ss << "====================================\n";
@@ -313,7 +369,13 @@ class ReductionParams : public HeuristicParams {
         static_cast<size_t>(batches_per_block_outer_reduction) << (bits - 21) ^
         static_cast<size_t>(unroll_factor_outer_reduction) << (bits - 22) ^
         static_cast<size_t>(compute_persistent_buffer_with_first_consumer)
-            << (bits - 23);
+            << (bits - 23) ^
+        static_cast<size_t>(cross_cluster_inner_reduction) << (bits - 24) ^
+        static_cast<size_t>(welford_mode) << (bits - 26) ^
+        static_cast<size_t>(circular_buffer_stages) << (bits - 28) ^
+        static_cast<size_t>(smem_atomic_block_reduction) << (bits - 29) ^
+        static_cast<size_t>(atomic_grid_reduction) << (bits - 30) ^
+        static_cast<size_t>(tma_load_box_size) << (bits - 40);
     return attr_hash;
   }
 
@@ -8,6 +8,7 @@
 #include <scheduler/reduction_utils.h>
 
 #include <expr_evaluator.h>
+#include <grouped_reduction.h>
 #include <inlining.h>
 #include <ir/cloner.h>
 #include <ir/utils.h>
@@ -190,7 +191,11 @@ TensorView* scheduleReductionTV(
       inner_unroll(inner_reduce_axis, rparams.unroll_factor_inner_reduction);
     }
 
-    inner_unswitch(inner_reduce_axis);
+    // Circular buffered loads need the serial remainder to be the innermost
+    // loop they are computed in, see [ Note -- Load pipelining ]
+    if (rparams.circular_buffer_stages == 1) {
+      inner_unswitch(inner_reduce_axis);
+    }
     if (rparams.cross_grid_inner_reduction) {
       if (rparams.split_grid_dim_inner_reduction) {
         outer_parallel(inner_reduce_axis, rparams.grid_dim_inner_reduction);
@@ -392,16 +397,21 @@ void propagateRFactor(
     non_broadcast_pos_ir++;
   }
 
+  // Grouped reductions are rfactored together, the group of reduction_tv
+  // already is
+  std::unordered_set<Expr*> rfactored_groups;
   for (auto reduction_tv_ : reduction_tvs) {
-    if (reduction_tv_ == reduction_tv ||
-        reduction_tv_->definition()->isA<GroupedReductionOp>()) {
-      // This should come in already rfactored
+    Expr* def = reduction_tv_->definition();
+    if (reduction_tv_ == reduction_tv || def == reduction_tv->definition() ||
+        rfactored_groups.count(def)) {
       continue;
-    } else {
-      ir_utils::rFactorHelper(
-          reduction_tv_,
-          reduction_scheduler_utils::addBackBroadcasts(
-              reduction_tv_, non_broadcast_rfactor_axes_ir));
+    }
+    ir_utils::rFactorHelper(
+        reduction_tv_,
+        reduction_scheduler_utils::addBackBroadcasts(
+            reduction_tv_, non_broadcast_rfactor_axes_ir));
+    if (reduction_tv_->definition()->isA<GroupedReductionOp>()) {
+      rfactored_groups.insert(reduction_tv_->definition());
     }
   }
 }
@@ -890,6 +900,211 @@ std::vector<TensorView*> projectPersistentBuffers(
   return pb_projector.project();
 }
 
+namespace {
+
+// Returns the WelfordOp merging the partial results of a serial
+// single-value wop if it is the only use of all of the outputs of wop.
+WelfordOp* getSoleWelfordConsumer(WelfordOp* wop) {
+  auto out_avg = wop->outAvg()->as<TensorView>();
+  if (out_avg->uses().size() != 1) {
+    return nullptr;
+  }
+  auto consumer = dynamic_cast<WelfordOp*>(out_avg->uses().at(0));
+  if (consumer == nullptr || consumer->inAvg() != wop->outAvg() ||
+      consumer->inVar() != wop->outVar() || consumer->inN() != wop->outN()) {
+    return nullptr;
+  }
+  for (auto out : wop->outputs()) {
+    if (out->isFusionOutput() || out->uses().size() != 1) {
+      return nullptr;
+    }
+  }
+  // ParallelType::Group converts the consumer to a GroupedWelfordOp
+  auto consumer_tv = ir_utils::getTvOutput(consumer);
+  if (std::any_of(
+          consumer_tv->getLoopDomain().begin(),
+          consumer_tv->getLoopDomain().end(),
+          [](IterDomain* id) {
+            return id->getParallelType() == ParallelType::Group;
+          })) {
+    return nullptr;
+  }
+  return consumer;
+}
+
+} // namespace
+
+// Note [Welford modes]
+// welfordCombine divides by the updated count for each value. When the
+// division throughput limits a kernel, e.g., a bf16 layer norm with a large
+// hidden size, WelfordMode::Fast replaces the serial update of a single
+// value by
+//   sum += x; sum_sq += x * x; N += 1;
+// using the avg and var outputs of the serial WelfordOp to hold sum and
+// sum_sq. The merging WelfordOp, which is parallelized on threads or blocks,
+// converts them to avg = sum / N and M2 = sum_sq - sum * avg right before
+// the merge with Chan's formula, so there is one division per thread
+// instead of one per value. The subtraction is prone to cancellation when
+// the variance is small relative to the mean, so this mode is opt-in.
+//
+// WelfordMode::Compensated keeps a Kahan compensation of avg and M2 in
+// registers alongside the serial WelfordOp output, which bounds the
+// rounding error of long serial loops. Merges across threads and blocks are
+// already pairwise, so they are left as is.
+//
+// Both modes are only applied to serial WelfordOps. Fast additionally
+// requires the serial WelfordOp to be a single-value reduction without an
+// initial value whose outputs are only merged by another WelfordOp, i.e.,
+// an rfactor. Other WelfordOps keep the default mode.
+void setWelfordMode(Fusion* fusion, WelfordMode mode) {
+  if (mode == WelfordMode::Default) {
+    return;
+  }
+  for (auto wop : ir_utils::getOpsOfType<WelfordOp>(fusion)) {
+    auto out_domain = ir_utils::getTvOutput(wop)->domain();
+    if (out_domain->hasBlockReduction() || out_domain->hasGridReduction()) {
+      continue;
+    }
+    if (mode == WelfordMode::Compensated) {
+      wop->setMode(mode);
+      continue;
+    }
+    if (!wop->singleValue() || wop->hasInit()) {
+      continue;
+    }
+    if (auto consumer = getSoleWelfordConsumer(wop)) {
+      wop->setMode(WelfordMode::Fast);
+      consumer->setMode(WelfordMode::Fast);
+    }
+  }
+}
+
+// Note [Shared memory atomic block reductions]
+// blockReduce reduces through shared memory with a tree, which takes one block
+// sync per level. With ReductionParams::smem_atomic_block_reduction, the block
+// reductions of sums instead call blockReduceAtomicAdd, where every thread
+// adds its value to one shared memory slot per segment with an atomic, in
+// three block syncs. This pays off when the reduction spans many threads per
+// segment of few columns, e.g., outer reductions along TIDy, and when the
+// data type has native shared memory atomics. Warp reductions already use
+// shuffles and grid reductions keep their own scheme, so they are unchanged.
+//
+// The order of the atomics is unspecified, so integer sums are exact while
+// float sums are not deterministic. The reduction heuristic therefore only
+// selects this for fusions whose reductions are all integer sums, and float
+// sums use it only when the parameters are set explicitly.
+void requestSmemAtomicBlockReductions(Fusion* fusion) {
+  for (auto rop : ir_utils::getOpsOfType<ReductionOp>(fusion)) {
+    if (rop->getReductionOpType() == BinaryOpType::Add) {
+      rop->requestSmemAtomicBlockReduction();
+    }
+  }
+}
+
+// Note [Grouping sibling reductions]
+// Backward normalizations often have a few independent reductions over the
+// same domain, e.g. the gradients of the weight and of the bias. Each
+// ReductionOp scheduled as a grid reduction writes its own work buffer and
+// synchronizes the grid on its own semaphore. A GroupedReductionOp reduces
+// its reductions together instead, with one synchronization and one pass of
+// the last block over the work buffers.
+//
+// With NVFUSER_ENABLE=group_reductions, groupSiblingReductions groups the
+// ReductionOps of an unscheduled fusion that have the same reduction and
+// broadcast logical dimensions, before the reference is scheduled. The other
+// members of the group of the reference then follow its rfactor, and every
+// other group is rfactored once by propagateRFactor. groupReductions rejects
+// groups with data dependencies, and those reductions stay ungrouped.
+//
+// Grid reductions can only be grouped in pairs, see gridReduceGroup, so the
+// reduction scheduler groups pairs of inner grid reductions. Grid allreduces
+// of the outer persistent scheduler can group up to kMaxNumGroupedReductions
+// reductions with their grouped iterations. Block reductions of a group are
+// still emitted one by one, so they are not grouped.
+void groupSiblingReductions(
+    const std::vector<TensorView*>& reduction_tvs,
+    int64_t max_group_size) {
+  if (max_group_size < 2) {
+    return;
+  }
+  // The reduction and broadcast flags of the logical domain of a tensor
+  auto signature = [](TensorView* tv) {
+    std::vector<std::pair<bool, bool>> flags;
+    for (IterDomain* id : tv->getLogicalDomain()) {
+      flags.emplace_back(id->isReduction(), id->isBroadcast());
+    }
+    return flags;
+  };
+
+  std::unordered_set<TensorView*> grouped;
+  for (auto it = reduction_tvs.begin(); it != reduction_tvs.end(); ++it) {
+    TensorView* first = *it;
+    if (grouped.count(first) || !first->definition()->isA<ReductionOp>()) {
+      continue;
+    }
+    std::vector<TensorView*> group = {first};
+    for (auto sibling = std::next(it); sibling != reduction_tvs.end() &&
+         (int64_t)group.size() < max_group_size;
+         ++sibling) {
+      if (!grouped.count(*sibling) &&
+          (*sibling)->definition()->isA<ReductionOp>() &&
+          signature(*sibling) == signature(first)) {
+        group.push_back(*sibling);
+      }
+    }
+    if (group.size() > 1 && groupReductions(group, false)) {
+      grouped.insert(group.begin(), group.end());
+    }
+  }
+}
+
+// Note [Atomic grid reductions]
+// A non-persistent grid reduction writes the partial result of each block to
+// a global work buffer, and the last block of each segment, found with a
+// semaphore, reduces the buffer. Sums of Int32, Int, Float and Double can
+// instead be done in one pass: each block reduces its values with
+// blockReduce, or blockReduceAtomicAdd, and adds the result to the output
+// with atomicAdd, which compiles to red.global.add. There is then no work
+// buffer, semaphore or last block, which helps outer reductions over large
+// dimensions, e.g., weight gradients reduced over the batch.
+//
+// The output must start at zero, so the reduction must write a fusion
+// output directly, which the executor zero-fills before the launch, and the
+// output cannot have other uses in the kernel. The scheduler therefore does
+// not cache such outputs, and reductions are not iteration grouped, so each
+// element is added separately. The order of the atomics is unspecified, so
+// floating-point results are not deterministic and the mode is only used for
+// them with NVFUSER_ENABLE=atomic_grid_reduction. Integer sums are exact in
+// any order and use it by default. With the shared memory atomic block
+// reductions, a histogram, i.e. a sum of one-hot comparisons, then counts
+// into shared memory per block and merges the counts with one global atomic
+// per bin and block. Reductions of reduced precision types are computed in
+// float and cast afterwards, so they do not qualify and packed bf16x2
+// atomics are not used.
+bool canUseAtomicGridReductions(const std::vector<TensorView*>& reduction_tvs) {
+  return !reduction_tvs.empty() &&
+      std::all_of(
+             reduction_tvs.begin(), reduction_tvs.end(), [](TensorView* tv) {
+               auto rop = dynamic_cast<ReductionOp*>(tv->definition());
+               return rop != nullptr &&
+                   rop->getReductionOpType() == BinaryOpType::Add &&
+                   (tv->dtype() == DataType::Int32 ||
+                    tv->dtype() == DataType::Int ||
+                    tv->dtype() == DataType::Float ||
+                    tv->dtype() == DataType::Double) &&
+                   tv->isFusionOutput() && tv->uses().empty();
+             });
+}
+
+void requestAtomicGridReductions(Fusion* fusion) {
+  for (auto rop : ir_utils::getOpsOfType<ReductionOp>(fusion)) {
+    auto out = ir_utils::getTvOutput(rop);
+    if (out->isFusionOutput() && out->domain()->hasGridReduction()) {
+      rop->requestAtomicGridReduction();
+    }
+  }
+}
+
 ReductionType getReductionType(const std::vector<TensorView*>& reduction_tvs) {
   bool is_inner_reduction = false;
   bool is_outer_reduction = false;
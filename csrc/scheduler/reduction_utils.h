@@ -94,6 +94,30 @@ NVF_API std::vector<TensorView*> projectPersistentBuffers(
     Fusion* fusion,
     const bool project_to_inputs);
 
+// Group the sibling ReductionOps of an unscheduled fusion into
+// GroupedReductionOps of up to max_group_size reductions, see Note [Grouping
+// sibling reductions] in reduction_utils.cpp.
+void groupSiblingReductions(
+    const std::vector<TensorView*>& reduction_tvs,
+    int64_t max_group_size);
+
+// Set the mode of the serial WelfordOps of a scheduled fusion, see
+// Note [Welford modes] in reduction_utils.cpp.
+void setWelfordMode(Fusion* fusion, WelfordMode mode);
+
+// Request shared memory atomic block reductions for the sums of a scheduled
+// fusion, see Note [Shared memory atomic block reductions] in
+// reduction_utils.cpp.
+void requestSmemAtomicBlockReductions(Fusion* fusion);
+
+// Whether the reductions of a fusion can be atomic grid reductions, see Note
+// [Atomic grid reductions] in reduction_utils.cpp.
+bool canUseAtomicGridReductions(const std::vector<TensorView*>& reduction_tvs);
+
+// Request atomic grid reductions for the grid reductions of a scheduled
+// fusion that write fusion outputs.
+void requestAtomicGridReductions(Fusion* fusion);
+
 //! Get reduction types based on the given fusion or reduction tvs.
 //! If there are no reduction tvs, return None.
 //! If there are only inner reduction tvs, return Inner.
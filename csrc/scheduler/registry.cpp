@@ -8,8 +8,10 @@
 #include <ATen/cuda/CUDAContext.h>
 #include <executor_utils.h>
 #include <instrumentation.h>
+#include <options.h>
 #include <scheduler/all_schedulers.h>
 #include <scheduler/debug_utils.h>
+#include <scheduler/heuristic_plugin.h>
 #include <scheduler/matmul_utils.h>
 #include <scheduler/registry.h>
 #include <scheduler/registry_utils.h>
@@ -169,13 +171,79 @@ bool SchedulerEntry::sameAs(const SchedulerEntry* other) {
 }
 
 namespace {
+
+//! Compile time checks of checkCanSchedule that do not depend on the
+//! scheduler. They are evaluated lazily and at most once for all the
+//! schedulers probed by proposeHeuristics, since building the IterDomainGraph
+//! of a large fusion is about as expensive as some of the scheduler specific
+//! checks.
+class SchedulerIndependentChecks {
+ public:
+  explicit SchedulerIndependentChecks(Fusion* fusion) : fusion_(fusion) {}
+
+  bool hasSdpaOps() {
+    if (!has_sdpa_ops_.has_value()) {
+      has_sdpa_ops_ = ir_utils::hasOpsOfType<SdpaFwdOp, SdpaBwdOp>(fusion_);
+    }
+    return has_sdpa_ops_.value();
+  }
+
+  bool hasScanOps() {
+    if (!has_scan_ops_.has_value()) {
+      has_scan_ops_ = ir_utils::hasOpsOfType<ScanOp>(fusion_);
+    }
+    return has_scan_ops_.value();
+  }
+
+  bool hasSortOps() {
+    if (!has_sort_ops_.has_value()) {
+      has_sort_ops_ = ir_utils::hasOpsOfType<SortOp>(fusion_);
+    }
+    return has_sort_ops_.value();
+  }
+
+  bool hasMatmulOps() {
+    if (!has_matmul_ops_.has_value()) {
+      has_matmul_ops_ =
+          ir_utils::hasOpsOfType<MatmulOp, LinearOp, MmaOp>(fusion_);
+    }
+    return has_matmul_ops_.value();
+  }
+
+  bool isConnectedFusionGraph() {
+    if (!is_connected_.has_value()) {
+      is_connected_ = registry_utils::isConnectedFusionGraph(fusion_);
+    }
+    return is_connected_.value();
+  }
+
+  bool hasSelfMapping() {
+    if (!has_self_mapping_.has_value()) {
+      has_self_mapping_ =
+          IterDomainGraph(fusion_, /*allow_self_mapping=*/true)
+              .hasSelfMapping();
+    }
+    return has_self_mapping_.value();
+  }
+
+ private:
+  Fusion* fusion_ = nullptr;
+  std::optional<bool> has_sdpa_ops_;
+  std::optional<bool> has_scan_ops_;
+  std::optional<bool> has_sort_ops_;
+  std::optional<bool> has_matmul_ops_;
+  std::optional<bool> is_connected_;
+  std::optional<bool> has_self_mapping_;
+};
+
 //! A Utility for checking both dynamic and static part of
 //!  can schedule
 template <typename SchedulerType>
 bool checkCanSchedule(
     Fusion* fusion,
     SchedulerRuntimeInfo& runtime_info,
-    HeuristicSummary* data_cache = nullptr) {
+    HeuristicSummary* data_cache,
+    SchedulerIndependentChecks& common_checks) {
   FUSER_PERF_SCOPE("SchedulerRuntimeInfo::checkCanSchedule<T>");
   // ExprEval scheduler only requires `canScheduleCompileTime` check and should
   // not use this fn. The following checks build the computeAt map that do not
@@ -189,28 +257,49 @@ bool checkCanSchedule(
   if (data_cache == nullptr) {
     // Fusions with `SdpaFwdOp/SdpaBwdOp` are only accepted in `ExprEval`
     // scheduler, all other schedulers should reject them.
-    if (ir_utils::hasOpsOfType<SdpaFwdOp, SdpaBwdOp>(fusion)) {
+    if (common_checks.hasSdpaOps()) {
       scheduler_debug_utils::canScheduleRejectReason(
           SchedulerType::heuristicType(), "SdpaOps are not supported.");
       return false;
     }
 
+    // None of the automatic schedulers schedules scans yet, so fusions with
+    // `ScanOp` are segmented into `ExprEval` segments
+    if (common_checks.hasScanOps()) {
+      scheduler_debug_utils::canScheduleRejectReason(
+          SchedulerType::heuristicType(), "ScanOps are not supported.");
+      return false;
+    }
+
+    // Same for `SortOp`
+    if (common_checks.hasSortOps()) {
+      scheduler_debug_utils::canScheduleRejectReason(
+          SchedulerType::heuristicType(), "SortOps are not supported.");
+      return false;
+    }
+
     // Fusions with `MatmulOp, LinearOp, MmaOp` can only be accepted by Matmul
     // scheduler.
     if (SchedulerType::heuristicType() != ScheduleHeuristic::Matmul &&
-        ir_utils::hasOpsOfType<MatmulOp, LinearOp, MmaOp>(fusion)) {
+        common_checks.hasMatmulOps()) {
       scheduler_debug_utils::canScheduleRejectReason(
           SchedulerType::heuristicType(), "Matmul ops are not supported.");
       return false;
     }
 
-    if (!registry_utils::isConnectedFusionGraph(fusion)) {
+    // The pointwise scheduler schedules each component of a disconnected
+    // fusion separately. See [ Note -- Horizontal fusion ] in
+    // fusion_segmenter.cpp.
+    const bool allow_disconnected =
+        SchedulerType::heuristicType() == ScheduleHeuristic::PointWise &&
+        isOptionEnabled(EnableOption::HorizontalFusion);
+    if (!allow_disconnected && !common_checks.isConnectedFusionGraph()) {
       scheduler_debug_utils::canScheduleRejectReason(
           SchedulerType::heuristicType(),
           "Connected fusion graph check failed!");
       return false;
     }
-    if (IterDomainGraph(fusion, /*allow_self_mapping=*/true).hasSelfMapping()) {
+    if (common_checks.hasSelfMapping()) {
       scheduler_debug_utils::canScheduleRejectReason(
           SchedulerType::heuristicType(), "Iter domain graph check failed!");
       return false;
@@ -223,38 +312,37 @@ bool checkCanSchedule(
   return SchedulerType::canScheduleRunTime(fusion, runtime_info, data_cache);
 }
 
-} // namespace
-
-// Simple dispatcher interface
-/*static*/ bool SchedulerEntry::canSchedule(
+bool canScheduleWith(
     ScheduleHeuristic sh,
     Fusion* fusion,
     SchedulerRuntimeInfo& runtime_info,
-    HeuristicSummary* data_cache) {
+    HeuristicSummary* data_cache,
+    SchedulerIndependentChecks& common_checks) {
   switch (sh) {
     case ScheduleHeuristic::NoOp:
-      return checkCanSchedule<NoOpScheduler>(fusion, runtime_info, data_cache);
+      return checkCanSchedule<NoOpScheduler>(
+          fusion, runtime_info, data_cache, common_checks);
     case ScheduleHeuristic::PointWise:
       return checkCanSchedule<PointWiseScheduler>(
-          fusion, runtime_info, data_cache);
+          fusion, runtime_info, data_cache, common_checks);
     case ScheduleHeuristic::Reduction:
       return checkCanSchedule<ReductionScheduler>(
-          fusion, runtime_info, data_cache);
+          fusion, runtime_info, data_cache, common_checks);
     case ScheduleHeuristic::InnerPersistent:
       return checkCanSchedule<InnerPersistentKernelScheduler>(
-          fusion, runtime_info, data_cache);
+          fusion, runtime_info, data_cache, common_checks);
     case ScheduleHeuristic::OuterPersistent:
       return checkCanSchedule<OuterPersistentKernelScheduler>(
-          fusion, runtime_info, data_cache);
+          fusion, runtime_info, data_cache, common_checks);
     case ScheduleHeuristic::InnerOuterPersistent:
       return checkCanSchedule<InnerOuterPersistentKernelScheduler>(
-          fusion, runtime_info, data_cache);
+          fusion, runtime_info, data_cache, common_checks);
     case ScheduleHeuristic::Transpose:
       return checkCanSchedule<TransposeScheduler>(
-          fusion, runtime_info, data_cache);
+          fusion, runtime_info, data_cache, common_checks);
     case ScheduleHeuristic::Matmul:
       return checkCanSchedule<MatmulScheduler>(
-          fusion, runtime_info, data_cache);
+          fusion, runtime_info, data_cache, common_checks);
     case ScheduleHeuristic::ExprEval:
       // `ExprEval` only accepts a single op, so we don't need other checks
       // which build a computeAt map. Note: `SdpaOp` does not work with
@@ -269,6 +357,18 @@ bool checkCanSchedule(
   return false;
 }
 
+} // namespace
+
+// Simple dispatcher interface
+/*static*/ bool SchedulerEntry::canSchedule(
+    ScheduleHeuristic sh,
+    Fusion* fusion,
+    SchedulerRuntimeInfo& runtime_info,
+    HeuristicSummary* data_cache) {
+  SchedulerIndependentChecks common_checks(fusion);
+  return canScheduleWith(sh, fusion, runtime_info, data_cache, common_checks);
+}
+
 /*static*/ std::unique_ptr<SchedulerEntry> SchedulerEntry::makeEntry(
     ScheduleHeuristic sh,
     Fusion* fusion,
@@ -317,15 +417,27 @@ bool checkCanSchedule(
       NVF_ERROR(false, "unreachable");
   }
 
+  // Let a heuristic plugin override the parameters, if there is one
+  if (scheduler_entry->params() != nullptr) {
+    heuristic_plugin::updateParams(
+        sh, fusion, runtime_info, *scheduler_entry->params());
+  }
+
   return scheduler_entry;
 }
 
-// Simply loop through the list as baseline strategy
+// Simply loop through the list as baseline strategy. The schedulers are not
+// probed concurrently, as the checks mutate the shared expression evaluator
+// of runtime_info and may add statements to the fusion. Instead, the checks
+// that do not depend on the scheduler are shared by all probes.
 /*static*/ std::optional<ScheduleHeuristic> SchedulerEntry::proposeHeuristics(
     Fusion* fusion,
     SchedulerRuntimeInfo& runtime_info) {
+  FUSER_PERF_SCOPE("SchedulerEntry::proposeHeuristics");
+  SchedulerIndependentChecks common_checks(fusion);
   for (const auto& sh : all_heuristics_in_priority_order) {
-    if (canSchedule(sh, fusion, runtime_info)) {
+    if (canScheduleWith(
+            sh, fusion, runtime_info, /*data_cache=*/nullptr, common_checks)) {
       scheduler_debug_utils::canScheduleMessage("***Accepted*** as: ", sh);
       return sh;
     }
@@ -424,6 +536,15 @@ void HeuristicSummary::validate() const {
       if (heuristic_ == ScheduleHeuristic::PointWise) {
         NVF_ERROR(entry_type_map_.count(EntryType::DOMAIN_MAP));
         NVF_ERROR(entry_type_map_.count(EntryType::REFERENCE_TENSORS));
+        // Horizontal fusions have a reference per component and are neither
+        // vectorized nor transposed
+        auto reference_tvs =
+            entry_type_map_.at(EntryType::REFERENCE_TENSORS)
+                ->as<CompileTimeInfo<HeuristicCompileTime::ReferenceTensors>>()
+                ->get();
+        if (reference_tvs->size() > 1) {
+          break;
+        }
         NVF_ERROR(
             entry_type_map_.count(EntryType::VECTORIZABLE_INPUTS_AND_OUTPUTS));
         NVF_ERROR(
@@ -252,6 +252,12 @@ class SchedulerEntry {
     params_->lparams = launch_params;
   }
 
+  //! Replace the heuristic parameters, e.g., with those picked by the
+  //! autotuner. They must be of the type used by this heuristic.
+  void setParams(std::shared_ptr<HeuristicParams> params) {
+    params_ = std::move(params);
+  }
+
  protected:
   explicit SchedulerEntry(ScheduleHeuristic heuristic)
       : heuristic_(heuristic) {}
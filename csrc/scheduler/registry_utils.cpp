@@ -126,11 +126,17 @@ PrimDataType getTensorIndexType(TensorView* tv, ExpressionEvaluator& ee) {
   // with which we can make more precise analyses. It would require
   // that the scheduling and segmentation should not have any
   // assumption about the index type as it may change.
+  //
+  // Besides the offsets of its elements, the loop nest of the tensor
+  // also iterates over its reduction domains, e.g. of a reduction of
+  // an expanded input, whose linearized indices must fit as well.
   int64_t stride = 1;
+  int64_t loop_stride = 1;
   KernelIndexTypeCompute index_type_helper;
+  KernelIndexTypeCompute loop_index_type_helper;
   for (auto i = tv->getLogicalDomain().size(); i > 0; --i) {
     auto id = tv->getLogicalDomain().at(i - 1);
-    if (id->isReduction() || id->isStride() || id->isBroadcast()) {
+    if (id->isStride() || id->isBroadcast()) {
       continue;
     }
 
@@ -150,11 +156,18 @@ PrimDataType getTensorIndexType(TensorView* tv, ExpressionEvaluator& ee) {
     NVF_ERROR(extent_int >= 0, "Unexpected size of axis: ", extent_int);
 
     if (extent_int > 0) {
-      if (index_type_helper.addDim(extent.as<int64_t>(), stride) ==
+      if (loop_index_type_helper.addDim(extent_int, loop_stride) ==
           PrimDataType::Int) {
         return PrimDataType::Int;
       }
-      stride *= extent.as<int64_t>();
+      loop_stride *= extent_int;
+      if (!id->isReduction()) {
+        if (index_type_helper.addDim(extent_int, stride) ==
+            PrimDataType::Int) {
+          return PrimDataType::Int;
+        }
+        stride *= extent_int;
+      }
     }
   }
 
@@ -539,8 +552,25 @@ PrimDataType getIndexTypeOfKernel(
     const std::vector<TensorView*>& all_tvs,
     const KernelArgumentHolder& inputs,
     ExpressionEvaluator& ee) {
-  if (inputs.getSmallestIndexTypeOfArguments() == PrimDataType::Int) {
-    return PrimDataType::Int;
+  // All tensors requiring 64-bit indexing are only collected for the
+  // index_type dump
+  const bool dump = isDebugDumpEnabled(DebugDumpOption::IndexType);
+  std::vector<TensorView*> int64_tvs;
+
+  NVF_ERROR(fusion->inputs().size() == inputs.size());
+  for (const auto i : c10::irange(inputs.size())) {
+    auto tv = dynamic_cast<TensorView*>(fusion->inputs().at(i));
+    if (tv == nullptr || !inputs[i]->is<at::Tensor>() ||
+        !isInputDataRead(tv)) {
+      continue;
+    }
+    if (getSmallestIndexType(inputs[i]->as<at::Tensor>()) ==
+        PrimDataType::Int) {
+      int64_tvs.push_back(tv);
+      if (!dump) {
+        return PrimDataType::Int;
+      }
+    }
   }
 
   for (auto tv : all_tvs) {
@@ -551,11 +581,21 @@ PrimDataType getIndexTypeOfKernel(
     }
 
     if (getTensorIndexType(tv, ee) == PrimDataType::Int) {
-      return PrimDataType::Int;
+      int64_tvs.push_back(tv);
+      if (!dump) {
+        return PrimDataType::Int;
+      }
     }
   }
 
-  return PrimDataType::Int32;
+  if (int64_tvs.empty()) {
+    return PrimDataType::Int32;
+  }
+  debug() << "64-bit indexing is required by:" << std::endl;
+  for (auto tv : int64_tvs) {
+    debug() << "  " << tv->toString() << std::endl;
+  }
+  return PrimDataType::Int;
 }
 
 bool SchedulerTopologyChecker::hasNonNormalizePostReductionBCast(
@@ -8,15 +8,21 @@
 
 #include <ATen/cuda/CUDAContext.h>
 #include <debug.h>
+#include <abstract_tensor.h>
 #include <inlining.h>
 #include <instrumentation.h>
+#include <mma_type.h>
 #include <scheduler/debug_utils.h>
+#include <scheduler/mma_utils.h>
 #include <scheduler/reduction_utils.h>
 #include <scheduler/registry_utils.h>
 #include <scheduler/transpose.h>
 #include <scheduler/utils.h>
 #include <scheduler/vectorize_helper.h>
 
+#include <array>
+#include <unordered_set>
+
 namespace nvfuser {
 
 TransposeScheduler::TransposeScheduler(
@@ -622,13 +628,17 @@ getReferenceTensors(
   auto reference_tensors_entry =
       HeuristicSummaryEntry<HeuristicCompileTime::ReferenceTensorsForGroups>(
           data_cache, [&domain_map, &grouped_inputs_outputs]() {
-            std::vector<TensorView*> data{
-                domain_map.findReferenceFor(grouped_inputs_outputs[0]),
-                domain_map.findReferenceFor(grouped_inputs_outputs[1])};
+            // The references of the groups after the second one are only
+            // used by multi-group transposes and may be nullptr
+            std::vector<TensorView*> data;
+            data.reserve(grouped_inputs_outputs.size());
+            for (const auto& group : grouped_inputs_outputs) {
+              data.push_back(domain_map.findReferenceFor(group));
+            }
             return std::make_unique<std::vector<TensorView*>>(std::move(data));
           });
   auto& reference_tensors = reference_tensors_entry.get();
-  NVF_ERROR(reference_tensors.size() == 2);
+  NVF_ERROR(reference_tensors.size() >= 2);
   TensorView* reference1 = reference_tensors[0];
   TensorView* reference2 = reference_tensors[1];
   NVF_ERROR(
@@ -675,6 +685,10 @@ getInnerMostDimInfoInReference(
             std::vector<int64_t> data;
             data.reserve(group_references.size());
             for (auto ref_tv : group_references) {
+              if (ref_tv == nullptr) {
+                data.emplace_back(-1);
+                continue;
+              }
               auto inner_most_id = scheduler_utils::innerMostAllocDim(ref_tv);
               auto inner_most_pos_in_global_ref =
                   domain_map.getInnerLeafDim(global_reference, inner_most_id);
@@ -685,8 +699,296 @@ getInnerMostDimInfoInReference(
   return innermost_info_entry;
 }
 
+// Note [TMA transpose]
+//
+// The second group of a transpose is the one whose inner-most dimension is
+// not the inner-most dimension of the tile computed by each thread. Without
+// TMA, each thread loads the inputs of group 2 into a shared memory tile with
+// vectorized loads along tile2, and stores the outputs of group 2 from a
+// shared memory tile the same way, while the computation reads and writes
+// these tiles along tile1. The accesses along tile1 are strided by tile2
+// elements, which is a multiple of the 32 banks of shared memory, so they
+// conflict.
+//
+// On Hopper, with TransposeParams::use_tma, the inputs of group 2 are instead
+// loaded and their outputs stored as [tile1, tile2] boxes by TMA. The shared
+// memory tiles use the TMA swizzle whose size is the bytes of tile2, so that
+// the 8 rows of each 8 x 16 byte core matrix are spread over all banks when
+// the computation accesses them along tile1. The threads no longer compute
+// any address of group 2 tensors in global memory.
+//
+// This requires, for every tensor of group 2:
+//   - a contiguous allocation domain of at most 5 dimensions, without
+//     broadcast or reduction dimensions,
+//   - a 16 byte aligned global address and an inner-most dimension whose
+//     bytes are a multiple of 16, so that all strides are 16 byte aligned,
+//   - tile2 * sizeof(dtype) to be a swizzle size of 32, 64 or 128 bytes, and
+//     tile1 to be a multiple of the 8 rows of a core matrix.
+// Virtual inner-most dimensions (see Note [Supporting small transpose
+// dimensions]) are not supported. Group 1 is scheduled as without TMA, as its
+// tensors are read and written along tile1 both in global memory and in the
+// computation.
+
+// Whether the tiles of `params` can be loaded or stored by TMA with a swizzle
+// for a tensor with elements of `dtype_size` bytes
+bool isTmaTileSupported(const TransposeParams& params, int64_t dtype_size) {
+  const int64_t box_inner_bytes = params.tile_size2 * dtype_size;
+  return params.tile_size1 % 8 == 0 &&
+      (box_inner_bytes == 32 || box_inner_bytes == 64 ||
+       box_inner_bytes == 128);
+}
+
+// See Note [TMA transpose]
+bool canUseTma(
+    Fusion* fusion,
+    SchedulerRuntimeInfo& runtime_info,
+    const std::shared_ptr<TransposeParams>& params,
+    const std::vector<TensorView*>& group2) {
+  if (at::cuda::getCurrentDeviceProperties()->major < 9 ||
+      hasSmallTransposeDimensions(params)) {
+    return false;
+  }
+  constexpr int64_t tma_alignment_bytes = 16;
+  for (TensorView* tv : group2) {
+    if (tv->isFusionInput() == tv->isFusionOutput()) {
+      return false;
+    }
+    if (tv->isFusionOutput() &&
+        fusion->getOutputAlias(tv).type != AllocationType::New) {
+      return false;
+    }
+    const int64_t dtype_size = dataTypeSize(tv->getDataType().value());
+    if (!isTmaTileSupported(*params, dtype_size)) {
+      return false;
+    }
+    const std::vector<IterDomain*>& alloc = tv->getMaybeAllocationDomain();
+    if (alloc.empty() || alloc.size() > 5) {
+      return false;
+    }
+    for (auto i : c10::irange(alloc.size())) {
+      if (alloc[i]->isBroadcast() || alloc[i]->isReduction() ||
+          alloc[i]->isDeviceDim() || !tv->getContiguity()[i].value_or(false)) {
+        return false;
+      }
+    }
+    if (tv->isFusionInput() &&
+        (int64_t)runtime_info.getAlignmentSize(tv) < tma_alignment_bytes) {
+      return false;
+    }
+    auto inner_extent =
+        runtime_info.expressionEvaluator().evaluate(alloc.back()->extent());
+    if (!inner_extent.hasValue() ||
+        inner_extent.as<int64_t>() * dtype_size % tma_alignment_bytes != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Allocation domain of a [..., tile1, tile2] shared memory tile with the
+// swizzle of TensorView::swizzleTMABox, leaving the loop domain untouched
+std::vector<IterDomain*> swizzledTileAllocation(
+    TensorView* tv,
+    MmaInputSmemSwizzle swizzle) {
+  const int64_t dtype_size = dataTypeSize(tv->getDataType().value());
+  AbstractTensor alloc(tv->getLoopDomain());
+  // [..., tile1, tile2] -> [..., tile1/8, 8, tile2]
+  alloc.split(-2, 8);
+  // -> [..., tile1/8, 8 / (128 / swizzle), 128 / swizzle, tile2]
+  alloc.split(-2, 128 / getBytesFromSwizzle(swizzle));
+  // -> [..., tile1/8, 8 / (128 / swizzle), 128 / swizzle, tile2/16B, 16B]
+  alloc.split(-1, core_matrix_width_bytes / dtype_size);
+  alloc.swizzle(SwizzleType::XOR, -4, -2);
+  return alloc.as<IterDomain*>();
+}
+
+// Note [Shared memory tile swizzle]
+//
+// Without TMA, the shared memory tiles of group 2 are accessed in two ways
+// (see Note [TMA transpose]):
+//   - along tile2 by the vectorized loads and stores of group 2, where the
+//     threads of a warp access consecutive vectors of the [tile1, tile2]
+//     tile,
+//   - along tile1 by the computation, where the threads of a warp access
+//     the same column of rows strided by vectorize_factor1.
+// The rows are a multiple of 128 bytes, so the second access hits the same
+// banks in every row. With EnableOption::SmemSwizzle, the allocation domain
+// of each tile is XOR swizzled in units of `unit` elements, a multiple of
+// vectorize_factor2 so that the vectors of group 2 stay contiguous, by the
+// rows divided by a `stride`:
+//   [..., tile1, tile2]
+//   -> [..., tile1/n/stride, n, stride, tile2/unit, unit]  with n = tile2/unit
+//   -> swizzle(XOR, n, tile2/unit)
+// so that n rows `stride` apart place their units of a column on different
+// banks. Units and strides are picked by counting the bank conflicts of the
+// first phase of both accesses the way getBankConflictInfo does on the
+// lowered kernel, and the tile is left as is when no swizzle has fewer
+// conflicts. Padding the rows would have the same effect without the XOR,
+// but it is not expressible by an allocation domain.
+
+struct TileSwizzle {
+  // 0 if the tile is not swizzled
+  int64_t unit = 0;
+  int64_t stride = 1;
+};
+
+// Bank conflict ways of the accesses of a warp to the bytes at `addresses`,
+// see getConflictWays in device_lower/analysis/bank_conflict.cpp
+int64_t conflictWays(const std::vector<int64_t>& addresses) {
+  std::array<std::unordered_set<int64_t>, 32> words_by_bank;
+  for (int64_t address : addresses) {
+    const int64_t word = address / 4;
+    words_by_bank.at(word % 32).insert(word);
+  }
+  int64_t ways = 1;
+  for (const auto& words : words_by_bank) {
+    ways = std::max(ways, (int64_t)words.size());
+  }
+  return ways;
+}
+
+// Sum of the bank conflict ways of the first phase of both accesses to a
+// shared memory tile of elements of `dtype_size` bytes with `swizzle`. See
+// Note [Shared memory tile swizzle]
+int64_t tileConflictWays(
+    const TransposeParams& params,
+    int64_t dtype_size,
+    const TileSwizzle& swizzle) {
+  const int64_t tile1 = params.tile_size1;
+  const int64_t tile2 = params.tile_size2;
+  auto address = [&](int64_t row, int64_t col) {
+    if (swizzle.unit > 0) {
+      const int64_t n = tile2 / swizzle.unit;
+      col = ((col / swizzle.unit) ^ (row / swizzle.stride % n)) *
+              swizzle.unit +
+          col % swizzle.unit;
+    }
+    return (row * tile2 + col) * dtype_size;
+  };
+  const int64_t num_threads = params.getThreadsPerBlock();
+
+  // Group 2, along tile2. Vectors of 16 and 8 bytes are served in phases of
+  // 8 and 16 threads.
+  const int64_t vector_bytes = params.vectorize_factor2 * dtype_size;
+  const int64_t phase_size = std::min(
+      num_threads, vector_bytes == 16 ? 8 : (vector_bytes == 8 ? 16 : 32));
+  std::vector<int64_t> addresses;
+  for (auto tid : c10::irange(phase_size)) {
+    const int64_t element = tid * params.vectorize_factor2;
+    if (element < tile1 * tile2) {
+      addresses.push_back(address(element / tile2, element % tile2));
+    }
+  }
+  int64_t ways = conflictWays(addresses);
+
+  // The computation, along tile1
+  addresses.clear();
+  for (auto tid : c10::irange(std::min(num_threads, (int64_t)32))) {
+    const int64_t element = tid * params.vectorize_factor1;
+    if (element < tile1 * tile2) {
+      addresses.push_back(address(element % tile1, element / tile1));
+    }
+  }
+  return ways + conflictWays(addresses);
+}
+
+// XOR swizzle of a shared memory tile of elements of `dtype_size` bytes with
+// the fewest bank conflicts. See Note [Shared memory tile swizzle]
+TileSwizzle pickTileSwizzle(const TransposeParams& params, int64_t dtype_size) {
+  TileSwizzle best;
+  int64_t best_ways = tileConflictWays(params, dtype_size, best);
+  const int64_t tile2 = params.tile_size2;
+  for (int64_t stride : {(int64_t)1, params.vectorize_factor1}) {
+    for (int64_t unit = tile2 / 2; unit >= params.vectorize_factor2;
+         unit /= 2) {
+      const int64_t n = tile2 / unit;
+      if (unit % params.vectorize_factor2 != 0 || tile2 % unit != 0 ||
+          (n & (n - 1)) != 0 || params.tile_size1 % (n * stride) != 0) {
+        continue;
+      }
+      const TileSwizzle swizzle{unit, stride};
+      const int64_t ways = tileConflictWays(params, dtype_size, swizzle);
+      if (ways < best_ways) {
+        best = swizzle;
+        best_ways = ways;
+      }
+    }
+  }
+  return best;
+}
+
+// Allocation domain of a [..., tile1, tile2] shared memory tile with
+// `swizzle`, leaving the loop domain untouched. See Note [Shared memory tile
+// swizzle]
+std::vector<IterDomain*> xorSwizzledTileAllocation(
+    TensorView* tv,
+    const TileSwizzle& swizzle,
+    int64_t tile_size2) {
+  AbstractTensor alloc(tv->getLoopDomain());
+  // [..., tile1, tile2] -> [..., tile1/stride, stride, tile2]
+  alloc.split(-2, swizzle.stride);
+  // -> [..., tile1/stride/n, n, stride, tile2]
+  alloc.split(-3, tile_size2 / swizzle.unit);
+  // -> [..., tile1/stride/n, n, stride, tile2/unit, unit]
+  alloc.split(-1, swizzle.unit);
+  alloc.swizzle(SwizzleType::XOR, -4, -2);
+  return alloc.as<IterDomain*>();
+}
+
 } // namespace
 
+// Note [Multi-group transpose]
+//
+// The inputs and outputs of a fusion are grouped by their inner-most
+// dimension. By default, only the first two groups are tiled: group 1 is
+// accessed along tile1 by the computation, and group 2 is staged through
+// shared memory tiles that are read and written along tile2. The tensors of
+// any other group are accessed like group 1, i.e., uncoalesced in global
+// memory.
+//
+// With EnableOption::MultiGroupTranspose, a fusion with three to
+// kMaxMultiGroupTransposeGroups groups, e.g., an NCHW input, an NHWC input
+// and an output in a third order, is instead tiled over the inner-most
+// dimension of every group:
+//   [..., I1, ..., I2, ..., I3, ...] -> [BIDx, Unswitch, tile1, tile2, tile3]
+// Every group after the first one is staged through shared memory like group
+// 2, with the tiles merged in an order that puts its own tile inner-most, so
+// that each group is vectorized and coalesced along its own inner-most
+// dimension. To keep the tile of a block at most 32 x 32 elements, each tile
+// is 8 elements for three groups and 4 elements for four or five groups. The
+// fusion is tiled this way only when every group has a reference tensor and
+// an inner-most dimension of at least a tile, and there is no view, as virtual
+// inner-most dimensions (see Note [Supporting small transpose dimensions]),
+// TMA and swizzled tiles are not supported for more than two groups.
+constexpr int64_t kMaxMultiGroupTransposeGroups = 5;
+
+// Returns the tile size of every group of a multi-group transpose, or 0 if
+// the fusion is scheduled with two groups
+int64_t getMultiGroupTileSize(
+    Fusion* fusion,
+    const std::vector<std::vector<TensorView*>>& grouped_inputs_outputs,
+    const std::vector<TensorView*>& reference_tensors,
+    const std::vector<int64_t>& inner_most_positions,
+    const std::vector<int64_t>& shape_in_ref1) {
+  const int64_t num_groups = (int64_t)grouped_inputs_outputs.size();
+  if (num_groups <= 2 || num_groups > kMaxMultiGroupTransposeGroups ||
+      !isOptionEnabled(EnableOption::MultiGroupTranspose) ||
+      !scheduler_utils::getViewTVs(fusion).empty()) {
+    return 0;
+  }
+  const int64_t tile_size = num_groups == 3 ? 8 : 4;
+  std::unordered_set<int64_t> positions;
+  for (auto i : c10::irange(num_groups)) {
+    const int64_t position = inner_most_positions.at(i);
+    if (reference_tensors.at(i) == nullptr || position < 0 ||
+        shape_in_ref1.at(position) < tile_size ||
+        !positions.insert(position).second) {
+      return 0;
+    }
+  }
+  return tile_size;
+}
+
 std::string getTransposeRuntimeRejectReason(
     Fusion* fusion,
     HeuristicSummary* data_cache,
@@ -871,16 +1173,32 @@ std::shared_ptr<TransposeParams> getTransposeHeuristics(
   auto params =
       std::make_shared<TransposeParams>("Transpose heuristics", index_type);
 
-  // Expand inner-most dims to virtual inner-most dims so that the inner-most
-  // dims has at least tile_size elements
-  // See note [Supporting small transpose dimensions]
-  maybeBuildVirtualInnerDims(
-      *params,
-      device_multiprocessor_count,
-      n_elems,
-      shape_in_ref1,
-      inner_most_pos1_in_ref1,
-      inner_most_pos2_in_ref1);
+  // See Note [Multi-group transpose]
+  const int64_t multi_group_tile_size = getMultiGroupTileSize(
+      fusion,
+      grouped_inputs_outputs,
+      reference_tensors,
+      innermost_info,
+      shape_in_ref1);
+  const int64_t num_tiled_groups =
+      multi_group_tile_size > 0 ? (int64_t)grouped_inputs_outputs.size() : 2;
+  if (multi_group_tile_size > 0) {
+    params->tile_size1 = multi_group_tile_size;
+    params->tile_size2 = multi_group_tile_size;
+    params->extra_tile_sizes.assign(
+        num_tiled_groups - 2, multi_group_tile_size);
+  } else {
+    // Expand inner-most dims to virtual inner-most dims so that the
+    // inner-most dims has at least tile_size elements
+    // See note [Supporting small transpose dimensions]
+    maybeBuildVirtualInnerDims(
+        *params,
+        device_multiprocessor_count,
+        n_elems,
+        shape_in_ref1,
+        inner_most_pos1_in_ref1,
+        inner_most_pos2_in_ref1);
+  }
 
   NVF_ERROR(
       !hasSmallTransposeDimensions(params) ||
@@ -927,29 +1245,26 @@ std::shared_ptr<TransposeParams> getTransposeHeuristics(
   scan_max_dtype_size(fusion->inputs());
   scan_max_dtype_size(fusion->outputs());
 
+  int64_t n_tiled_tensors = 0;
+  for (auto i : c10::irange(num_tiled_groups)) {
+    n_tiled_tensors += (int64_t)grouped_inputs_outputs[i].size();
+  }
   auto max_unroll_factor = ceilDiv(
       // Available unrolling based on size of data type
       kSixteen / max_io_dtype_size,
       // Reduce max unrolling factor if we have many inputs/outputs to unroll
       // as it could start consuming a lot of registers.
       std::max(
-          (scheduler_utils::lastPow2(
-               (int64_t)grouped_inputs_outputs[0].size() +
-               (int64_t)grouped_inputs_outputs[1].size()) >>
-           2),
-          (int64_t)1));
+          (scheduler_utils::lastPow2(n_tiled_tensors) >> 2), (int64_t)1));
 
   // Don't unroll at the cost of getting a full wave on the GPU
   auto max_unroll_factor_occupancy = ceilDiv(
-      n_elems,
-      device_multiprocessor_count * (int64_t)params->tile_size1 *
-          (int64_t)params->tile_size2);
+      n_elems, device_multiprocessor_count * params->getTileElements());
   max_unroll_factor = std::min(max_unroll_factor, max_unroll_factor_occupancy);
 
   // Don't unroll at the cost of getting a full warp, useful for the case where
   // tile sizes are small
-  auto max_unroll_factor_block =
-      ceilDiv((int64_t)params->tile_size1 * (int64_t)params->tile_size2, 32l);
+  auto max_unroll_factor_block = ceilDiv(params->getTileElements(), 32l);
   max_unroll_factor = std::min(max_unroll_factor, max_unroll_factor_block);
 
   // Note: [Computing Vectorization Width for Transpose]
@@ -1012,8 +1327,32 @@ std::shared_ptr<TransposeParams> getTransposeHeuristics(
             params->dims_merged_with_2,
             grouped_inputs_outputs[1],
             max_unroll_factor);
+
+    // A vector of a multi-group transpose stays within a row of its tile
+    for (auto i : c10::irange(2, num_tiled_groups)) {
+      params->extra_vectorize_factors.push_back(std::min(
+          multi_group_tile_size,
+          vectorize_helper::getVectorizationFactorTransposeGroup(
+              runtime_info,
+              reference1,
+              innermost_info[i],
+              {},
+              grouped_inputs_outputs[i],
+              max_unroll_factor)));
+    }
+    if (multi_group_tile_size > 0) {
+      params->vectorize_factor1 =
+          std::min(params->vectorize_factor1, multi_group_tile_size);
+      params->vectorize_factor2 =
+          std::min(params->vectorize_factor2, multi_group_tile_size);
+    }
   }
 
+  params->use_tma = multi_group_tile_size == 0 &&
+      canUseTma(fusion, runtime_info, params, grouped_inputs_outputs[1]);
+  params->swizzle_smem_tiles = multi_group_tile_size == 0 &&
+      !params->use_tma && isOptionEnabled(EnableOption::SmemSwizzle);
+
   params->lparams.bind(params->getThreadsPerBlock(), ParallelType::TIDx);
 
   if (isDebugDumpEnabled(DebugDumpOption::SchedulerDebug)) {
@@ -1107,6 +1446,23 @@ void scheduleTranspose(Fusion* fusion, TransposeParams params) {
   auto grouped_inputs_outputs = domain_map.groupInputsOutputsByInnerDim();
   NVF_ERROR(grouped_inputs_outputs.size() >= 2);
 
+  // Groups 1 and 2, and the next ones of a multi-group transpose. See Note
+  // [Multi-group transpose]
+  const int64_t num_tiled_groups =
+      2 + (int64_t)params.extra_tile_sizes.size();
+  NVF_ERROR((int64_t)grouped_inputs_outputs.size() >= num_tiled_groups);
+  std::vector<int64_t> tile_sizes{params.tile_size1, params.tile_size2};
+  tile_sizes.insert(
+      tile_sizes.end(),
+      params.extra_tile_sizes.begin(),
+      params.extra_tile_sizes.end());
+  std::vector<int64_t> vectorize_factors{
+      params.vectorize_factor1, params.vectorize_factor2};
+  vectorize_factors.insert(
+      vectorize_factors.end(),
+      params.extra_vectorize_factors.begin(),
+      params.extra_vectorize_factors.end());
+
   /*
    * We need something similar to `cacheFork` for input tensors in group 2. We
    * need this because we will want to propagate to the entire DAG except group
@@ -1119,35 +1475,88 @@ void scheduleTranspose(Fusion* fusion, TransposeParams params) {
    *  t1  t2
    * if groups = {{t1, t2}, {t0}}, then removing {t0, cache} from the DAG will
    * make it disconnected.
+   *
+   * The groups after group 2 of a multi-group transpose are staged through
+   * shared memory the same way.
    */
-  std::unordered_set<TensorView*> group2_and_cached_inputs(
-      grouped_inputs_outputs[1].begin(), grouped_inputs_outputs[1].end());
-  for (auto tv : grouped_inputs_outputs[1]) {
-    if (tv->isFusionInput()) {
-      auto existing_cache = ir_utils::consumerTvsOf(tv)[0];
-      if (ir_utils::consumerTvsOf(existing_cache).size() > 1) {
-        auto new_cache = tv->cacheAfter();
-        new_cache->setMemoryType(MemoryType::Shared);
-        group2_and_cached_inputs.emplace(new_cache);
-      } else {
-        existing_cache->setMemoryType(MemoryType::Shared);
-        group2_and_cached_inputs.emplace(existing_cache);
+  std::vector<std::unordered_set<TensorView*>> smem_groups;
+  for (auto g : c10::irange(1, num_tiled_groups)) {
+    std::unordered_set<TensorView*> group_and_cached_inputs(
+        grouped_inputs_outputs[g].begin(), grouped_inputs_outputs[g].end());
+    for (auto tv : grouped_inputs_outputs[g]) {
+      if (tv->isFusionInput()) {
+        auto existing_cache = ir_utils::consumerTvsOf(tv)[0];
+        if (ir_utils::consumerTvsOf(existing_cache).size() > 1) {
+          auto new_cache = tv->cacheAfter();
+          new_cache->setMemoryType(MemoryType::Shared);
+          group_and_cached_inputs.emplace(new_cache);
+        } else {
+          existing_cache->setMemoryType(MemoryType::Shared);
+          group_and_cached_inputs.emplace(existing_cache);
+        }
+      }
+    }
+    // set cached outputs of the group to shared memory
+    for (auto pair : cached_outputs) {
+      auto cached_output = pair.first;
+      auto output = pair.second;
+      if (group_and_cached_inputs.count(output) > 0) {
+        cached_output->setMemoryType(MemoryType::Shared);
       }
     }
+    smem_groups.push_back(std::move(group_and_cached_inputs));
   }
-  // set cached outputs of group 2 to shared memory
-  for (auto pair : cached_outputs) {
-    auto cached_output = pair.first;
-    auto output = pair.second;
-    if (group2_and_cached_inputs.count(output) > 0) {
-      cached_output->setMemoryType(MemoryType::Shared);
+  const std::unordered_set<TensorView*>& group2_and_cached_inputs =
+      smem_groups.front();
+  std::unordered_set<TensorView*> all_smem_groups;
+  for (const auto& smem_group : smem_groups) {
+    all_smem_groups.insert(smem_group.begin(), smem_group.end());
+  }
+
+  // Load the cached inputs and store the outputs of group 2 with TMA. See
+  // Note [TMA transpose]
+  std::vector<TensorView*> tma_load_tvs;
+  std::vector<TensorView*> tma_store_tvs;
+  bool use_tma = params.use_tma;
+  if (use_tma) {
+    for (auto tv : group2_and_cached_inputs) {
+      if (!tv->isFusionInput() && !tv->isFusionOutput()) {
+        tma_load_tvs.push_back(tv);
+      }
+    }
+    for (auto pair : cached_outputs) {
+      if (group2_and_cached_inputs.count(pair.second) > 0) {
+        tma_store_tvs.push_back(pair.second);
+      }
+    }
+    // The tile sizes may have been changed after the heuristic picked TMA
+    for (auto tv : tma_load_tvs) {
+      use_tma = use_tma &&
+          isTmaTileSupported(params, dataTypeSize(tv->getDataType().value()));
+    }
+    for (auto tv : tma_store_tvs) {
+      use_tma = use_tma &&
+          isTmaTileSupported(params, dataTypeSize(tv->getDataType().value()));
+    }
+  }
+  if (use_tma) {
+    for (auto tv : tma_load_tvs) {
+      tv->definition()->as<LoadStoreOp>()->setOpType(
+          LoadStoreOpType::CpAsyncBulkTensorTile);
+    }
+    for (auto tv : tma_store_tvs) {
+      tv->definition()->as<LoadStoreOp>()->setOpType(
+          LoadStoreOpType::CpAsyncBulkTensorTile);
     }
   }
 
-  TensorView* reference1 =
-      domain_map.findReferenceFor(grouped_inputs_outputs[0]);
-  TensorView* reference2 =
-      domain_map.findReferenceFor(grouped_inputs_outputs[1]);
+  std::vector<TensorView*> references;
+  for (auto g : c10::irange(num_tiled_groups)) {
+    references.push_back(
+        domain_map.findReferenceFor(grouped_inputs_outputs[g]));
+  }
+  TensorView* reference1 = references.at(0);
+  TensorView* reference2 = references.at(1);
 
   NVF_ERROR(
       reference1 != nullptr,
@@ -1157,6 +1566,13 @@ void scheduleTranspose(Fusion* fusion, TransposeParams params) {
       reference2 != nullptr,
       "Could not find a fully broadcasted tensor to reference schedule on the second group.");
 
+  for (auto g : c10::irange(2, num_tiled_groups)) {
+    NVF_ERROR(
+        references.at(g) != nullptr,
+        "Could not find a fully broadcasted tensor to reference schedule on group ",
+        g + 1);
+  }
+
   auto inner_most_id1 = scheduler_utils::innerMostAllocDim(reference1);
   auto inner_most_id2 = scheduler_utils::innerMostAllocDim(reference2);
 
@@ -1205,16 +1621,28 @@ void scheduleTranspose(Fusion* fusion, TransposeParams params) {
     inner_most_pos2_in_ref1 = *merged2;
   }
 
+  // Multi-group transposes have no virtual inner most dims, so the positions
+  // of the inner most dims of the other groups are those before tiling
+  std::vector<int64_t> inner_most_pos_in_ref1{
+      inner_most_pos1_in_ref1, inner_most_pos2_in_ref1};
+  for (auto g : c10::irange(2, num_tiled_groups)) {
+    const int64_t inner_loop_index = domain_map.getInnerLeafDim(
+        reference1, scheduler_utils::innerMostAllocDim(references.at(g)));
+    NVF_ERROR(inner_loop_index >= 0, "getInnerLeafDim cannot be resolved");
+    inner_most_pos_in_ref1.push_back(inner_loop_index);
+  }
+
   /////////////////////////////
   // Step 2: global schedule //
   /////////////////////////////
 
-  // make tile
+  // make tile. The outer dimension of each split stays in place, so the
+  // positions of the other inner most dims are unchanged.
   // [..., I1, .., I2, ...]
-  reference1->split(inner_most_pos1_in_ref1, params.tile_size1);
-  reference1->reorder({{inner_most_pos1_in_ref1 + 1, -1}});
-  reference1->split(inner_most_pos2_in_ref1, params.tile_size2);
-  reference1->reorder({{inner_most_pos2_in_ref1 + 1, -1}});
+  for (auto g : c10::irange(num_tiled_groups)) {
+    reference1->split(inner_most_pos_in_ref1.at(g), tile_sizes.at(g));
+    reference1->reorder({{inner_most_pos_in_ref1.at(g) + 1, -1}});
+  }
   // [..., I1/tile1, .., I2/tile2, ..., tile1, tile2]
 
   // Merge remaining dimensions ignoring reduction axes (See Issue #2317)
@@ -1222,8 +1650,9 @@ void scheduleTranspose(Fusion* fusion, TransposeParams params) {
   // For example: [i0, r1, i1, r2, i2] after tiling is [i0, r1, i1/tile1, r2,
   // i2/tile2, tile1, tile2] The following code merges all the outer iterdomains
   // as: [i0 * i1/tile1 * i2/tile2, r1, r2, tile1, tile2]
-  int64_t rhs_i = reference1->nDims() - 3;
-  for (int64_t lhs_i = reference1->nDims() - 4; lhs_i >= 0; lhs_i--) {
+  int64_t rhs_i = reference1->nDims() - 1 - num_tiled_groups;
+  for (int64_t lhs_i = reference1->nDims() - 2 - num_tiled_groups; lhs_i >= 0;
+       lhs_i--) {
     if (reference1->axis(lhs_i)->isReduction() ||
         reference1->axis(lhs_i)->isDeviceDim()) {
       continue;
@@ -1240,8 +1669,11 @@ void scheduleTranspose(Fusion* fusion, TransposeParams params) {
   reference1->split(rhs_i, 1);
   // [r.., merged_dim, 1, tile1, tile2]
 
-  // parallelize non-tile dimensions
-  reference1->axis(rhs_i + 1)->parallelize(ParallelType::Unswitch);
+  // parallelize non-tile dimensions. TMA is issued by a single thread, which
+  // the predicate of an unswitched loop does not know about.
+  if (!use_tma) {
+    reference1->axis(rhs_i + 1)->parallelize(ParallelType::Unswitch);
+  }
   reference1->axis(rhs_i)->parallelize(ParallelType::BIDx);
   // [BIDx, Unswitch, tile1, tile2]
 
@@ -1251,6 +1683,53 @@ void scheduleTranspose(Fusion* fusion, TransposeParams params) {
   entire_dag.traverse(&propagator);
   scheduler_utils::parallelizeAllLike(reference1);
 
+  // Swizzle the shared memory tiles of group 2 and make the tiles of TMA
+  // loads and stores bulk. The cached outputs of group 2 are written by the
+  // threads of group 1 below, so only their allocation domain is swizzled.
+  if (use_tma) {
+    for (auto tv : tma_load_tvs) {
+      // [..., tile1, tile2] -> [..., tile1/8, 8/s, s, tile2/16B, 16B]
+      tv->swizzleTMABox(getSwizzleFromBytes(
+          params.tile_size2 * dataTypeSize(tv->getDataType().value())));
+      tv->setAllocationDomain(tv->getLoopDomain(), true);
+      mma_utils::MmaSwizzler::parallelizeAsBulkSkippingFirstIDs(
+          tv, (int64_t)tv->nDims() - 5);
+    }
+    for (auto tv : tma_store_tvs) {
+      auto smem_tv = tv->definition()->input(0)->as<TensorView>();
+      smem_tv->setAllocationDomain(
+          swizzledTileAllocation(
+              smem_tv,
+              getSwizzleFromBytes(
+                  params.tile_size2 *
+                  dataTypeSize(smem_tv->getDataType().value()))),
+          true);
+      mma_utils::MmaSwizzler::parallelizeAsBulkSkippingFirstIDs(
+          tv, (int64_t)tv->nDims() - 2);
+    }
+  } else if (params.swizzle_smem_tiles) {
+    // See Note [Shared memory tile swizzle]
+    std::vector<TensorView*> smem_tiles;
+    for (auto tv : group2_and_cached_inputs) {
+      if (tv->getMemoryType() == MemoryType::Shared) {
+        smem_tiles.push_back(tv);
+      }
+    }
+    for (auto pair : cached_outputs) {
+      if (pair.first->getMemoryType() == MemoryType::Shared) {
+        smem_tiles.push_back(pair.first);
+      }
+    }
+    for (auto tv : smem_tiles) {
+      const TileSwizzle swizzle =
+          pickTileSwizzle(params, dataTypeSize(tv->getDataType().value()));
+      if (swizzle.unit > 0 && tv->nDims() >= 2) {
+        tv->setAllocationDomain(
+            xorSwizzledTileAllocation(tv, swizzle, params.tile_size2), true);
+      }
+    }
+  }
+
   // For a transpose scheduling, all we need is to bind threadIdx.x differently
   // for inputs and outputs. This swap of binding could happen at any tensor on
   // the path from input to output, especially, it does not have to be in the
@@ -1265,83 +1744,101 @@ void scheduleTranspose(Fusion* fusion, TransposeParams params) {
   // transform tile for vectorization/unroll
   // See note [vectorization and unroll of input and output]
 
-  int64_t pos = reference2->nDims() - 2;
-  // [..., tile1, tile2]
-  moveReductionsOut(reference2, 2);
-  reference2->merge(pos);
-  reference2->split(pos, params.vectorize_factor2);
-  reference2->split(pos, params.getThreadsPerBlock());
-  // [..., Unroll, TIDx, Vectorize]
-
-  // Propagate transformations of reference2 to the entire DAG except
-  // group 1. We actually only want to propagate to the fusion outputs, but
-  // inputs and outputs themselves are disconnected, so we have to borrow the
-  // entire DAG and use its spanning tree.
-  {
-    auto all_tvs_except1 = ir_utils::allTvsExcept(
-        fusion,
-        {grouped_inputs_outputs[0].begin(), grouped_inputs_outputs[0].end()});
-    SetSelector selector({all_tvs_except1.begin(), all_tvs_except1.end()});
-    MaxLogicalDomainInfoSpanningTree entire_dag_except1(reference2, &selector);
-    TransformPropagator propagator(reference2);
-    entire_dag_except1.traverse(&propagator);
-  }
-
-  // parallelize group2 and its cached inputs
-  {
-    if (params.vectorize_factor2 > 1) {
-      reference2->axis(-1)->parallelize(ParallelType::Vectorize);
+  // With TMA, group 2 keeps the tiles of the global schedule. The groups after
+  // group 2 of a multi-group transpose are scheduled the same way.
+  for (auto g : c10::irange(1, use_tma ? 1 : num_tiled_groups)) {
+    TensorView* group_reference = references.at(g);
+    const std::unordered_set<TensorView*>& group_and_cached_inputs =
+        smem_groups.at(g - 1);
+    // [..., tile1, tile2]
+    int64_t pos = group_reference->nDims() - num_tiled_groups;
+    // Makes the tile of the group inner most
+    group_reference->reorder({{pos + g, -1}});
+    moveReductionsOut(group_reference, (int)num_tiled_groups);
+    for ([[maybe_unused]] auto i : c10::irange(num_tiled_groups - 1)) {
+      group_reference->merge(pos);
+    }
+    group_reference->split(pos, vectorize_factors.at(g));
+    group_reference->split(pos, params.getThreadsPerBlock());
+    // [..., Unroll, TIDx, Vectorize]
+
+    // Propagate transformations of group_reference to the entire DAG except
+    // group 1. We actually only want to propagate to the fusion outputs, but
+    // inputs and outputs themselves are disconnected, so we have to borrow the
+    // entire DAG and use its spanning tree. The other groups staged through
+    // shared memory are excluded as well.
+    {
+      std::unordered_set<TensorView*> other_groups(
+          grouped_inputs_outputs[0].begin(), grouped_inputs_outputs[0].end());
+      for (const auto& smem_group : smem_groups) {
+        if (&smem_group != &group_and_cached_inputs) {
+          other_groups.insert(smem_group.begin(), smem_group.end());
+        }
+      }
+      auto all_tvs_except1 = ir_utils::allTvsExcept(fusion, other_groups);
+      SetSelector selector({all_tvs_except1.begin(), all_tvs_except1.end()});
+      MaxLogicalDomainInfoSpanningTree entire_dag_except1(
+          group_reference, &selector);
+      TransformPropagator propagator(group_reference);
+      entire_dag_except1.traverse(&propagator);
     }
-    reference2->axis(-2)->parallelize(ParallelType::TIDx);
-    reference2->axis(-3)->parallelize(ParallelType::Unroll);
 
-    ComputeAtMap ca_map(fusion);
+    // parallelize the group and its cached inputs
+    {
+      if (vectorize_factors.at(g) > 1) {
+        group_reference->axis(-1)->parallelize(ParallelType::Vectorize);
+      }
+      group_reference->axis(-2)->parallelize(ParallelType::TIDx);
+      group_reference->axis(-3)->parallelize(ParallelType::Unroll);
 
-    scheduler_utils::parallelizeAllLike(
-        reference2,
-        {group2_and_cached_inputs.begin(), group2_and_cached_inputs.end()},
-        {ParallelType::TIDx});
+      ComputeAtMap ca_map(fusion);
 
-    // Only vectorize the axes that exactly maps to the vectorized axes
-    //  on reference as support for permissively mapped axes are not
-    //  yet clearly defined.
-    std::vector<TensorView*> vectorized_group2_cached_inputs;
-    for (auto gin : group2_and_cached_inputs) {
-      if (std::any_of(
-              gin->getLoopDomain().begin(),
-              gin->getLoopDomain().end(),
-              [&ca_map, reference2](IterDomain* id) {
-                return ca_map.areMapped(
-                    id, reference2->axis(-1), IdMappingMode::EXACT);
-              })) {
-        vectorized_group2_cached_inputs.push_back(gin);
-      }
-    }
-    if (!vectorized_group2_cached_inputs.empty()) {
       scheduler_utils::parallelizeAllLike(
-          reference2,
-          vectorized_group2_cached_inputs,
-          {ParallelType::Vectorize});
-    }
+          group_reference,
+          {group_and_cached_inputs.begin(), group_and_cached_inputs.end()},
+          {ParallelType::TIDx});
+
+      // Only vectorize the axes that exactly maps to the vectorized axes
+      //  on reference as support for permissively mapped axes are not
+      //  yet clearly defined.
+      std::vector<TensorView*> vectorized_group_cached_inputs;
+      for (auto gin : group_and_cached_inputs) {
+        if (std::any_of(
+                gin->getLoopDomain().begin(),
+                gin->getLoopDomain().end(),
+                [&ca_map, group_reference](IterDomain* id) {
+                  return ca_map.areMapped(
+                      id, group_reference->axis(-1), IdMappingMode::EXACT);
+                })) {
+          vectorized_group_cached_inputs.push_back(gin);
+        }
+      }
+      if (!vectorized_group_cached_inputs.empty()) {
+        scheduler_utils::parallelizeAllLike(
+            group_reference,
+            vectorized_group_cached_inputs,
+            {ParallelType::Vectorize});
+      }
 
-    // Only unroll the axes that exactly maps to the unrolled axes
-    //  on reference as support for permissively mapped axes are not
-    //  yet clearly defined.
-    std::vector<TensorView*> unrolled_group2_cached_inputs;
-    for (auto gin : group2_and_cached_inputs) {
-      if (std::any_of(
-              gin->getLoopDomain().begin(),
-              gin->getLoopDomain().end(),
-              [&ca_map, reference2](IterDomain* id) {
-                return ca_map.areMapped(
-                    id, reference2->axis(-3), IdMappingMode::EXACT);
-              })) {
-        unrolled_group2_cached_inputs.push_back(gin);
+      // Only unroll the axes that exactly maps to the unrolled axes
+      //  on reference as support for permissively mapped axes are not
+      //  yet clearly defined.
+      std::vector<TensorView*> unrolled_group_cached_inputs;
+      for (auto gin : group_and_cached_inputs) {
+        if (std::any_of(
+                gin->getLoopDomain().begin(),
+                gin->getLoopDomain().end(),
+                [&ca_map, group_reference](IterDomain* id) {
+                  return ca_map.areMapped(
+                      id, group_reference->axis(-3), IdMappingMode::EXACT);
+                })) {
+          unrolled_group_cached_inputs.push_back(gin);
+        }
+      }
+      if (!unrolled_group_cached_inputs.empty()) {
+        scheduler_utils::parallelizeAllLike(
+            group_reference, unrolled_group_cached_inputs, {ParallelType::Unroll});
       }
-    }
-    if (!unrolled_group2_cached_inputs.empty()) {
-      scheduler_utils::parallelizeAllLike(
-          reference2, unrolled_group2_cached_inputs, {ParallelType::Unroll});
     }
   }
 
@@ -1350,11 +1847,13 @@ void scheduleTranspose(Fusion* fusion, TransposeParams params) {
   //////////////////////////////
 
   // schedule group 1
-  reference1->reorder({{-2, -1}});
+  int64_t pos = reference1->nDims() - num_tiled_groups;
+  reference1->reorder({{pos, -1}});
   // [..., tile2, tile1]
-  pos = reference1->nDims() - 2;
-  moveReductionsOut(reference1, 2);
-  reference1->merge(pos);
+  moveReductionsOut(reference1, (int)num_tiled_groups);
+  for ([[maybe_unused]] auto i : c10::irange(num_tiled_groups - 1)) {
+    reference1->merge(pos);
+  }
   reference1->split(pos, params.vectorize_factor1);
   reference1->split(pos, params.getThreadsPerBlock());
   if (params.vectorize_factor1 > 1) {
@@ -1365,10 +1864,10 @@ void scheduleTranspose(Fusion* fusion, TransposeParams params) {
   // [..., Unroll, TIDx, Vectorize]
 
   // Propagate transformations, parallelization of the reference1 to the entire
-  // DAG except group 2 and its corresponding cached outputs.
+  // DAG except group 2 and its corresponding cached outputs, and the next
+  // groups of a multi-group transpose.
   {
-    auto all_tvs_except2 =
-        ir_utils::allTvsExcept(fusion, group2_and_cached_inputs);
+    auto all_tvs_except2 = ir_utils::allTvsExcept(fusion, all_smem_groups);
     SetSelector selector({all_tvs_except2.begin(), all_tvs_except2.end()});
     MaxLogicalDomainInfoSpanningTree entire_dag_except_outputs(
         reference1, &selector);
@@ -1439,7 +1938,7 @@ void scheduleTranspose(Fusion* fusion, TransposeParams params) {
 
   // cleanup parallelization from reference1 and reference2 if they are fusion
   // inputs
-  for (auto tv : {reference1, reference2}) {
+  for (auto tv : references) {
     if (tv->isFusionInput()) {
       for (auto id : tv->getLoopDomain()) {
         id->parallelize(ParallelType::Serial);
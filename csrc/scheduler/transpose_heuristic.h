@@ -8,6 +8,7 @@
 #pragma once
 
 #include <c10/util/hash.h>
+#include <c10/util/irange.h>
 #include <scheduler/heuristic.h>
 #include <utils.h>
 
@@ -50,6 +51,21 @@ class TransposeParams : public HeuristicParams {
   // Tile size for the inner most dim of tensors in the second group
   int64_t tile_size2 = getDefaultTileSize();
 
+  // Load the inputs and store the outputs of the second group with TMA
+  // through swizzled shared memory tiles instead of vectorized loads and
+  // stores of each thread. Requires Hopper. See Note [TMA transpose]
+  bool use_tma = false;
+
+  // XOR swizzle the shared memory tiles of group 2 when it is not loaded and
+  // stored with TMA. See Note [Shared memory tile swizzle]
+  bool swizzle_smem_tiles = false;
+
+  // Tile sizes and vectorization factors of the groups after the second one,
+  // which are staged through shared memory like group 2. Empty unless
+  // scheduling more than two groups. See Note [Multi-group transpose]
+  std::vector<int64_t> extra_tile_sizes = {};
+  std::vector<int64_t> extra_vectorize_factors = {};
+
   using HeuristicParams::HeuristicParams;
 
   // Warning: Does not check launch parameters!
@@ -66,7 +82,11 @@ class TransposeParams : public HeuristicParams {
         other.dims_merged_with_2 == dims_merged_with_2 &&
         other.vectorize_factor1 == vectorize_factor1 &&
         other.vectorize_factor2 == vectorize_factor2 &&
-        other.tile_size1 == tile_size1 && other.tile_size2 == tile_size2;
+        other.tile_size1 == tile_size1 && other.tile_size2 == tile_size2 &&
+        other.use_tma == use_tma &&
+        other.swizzle_smem_tiles == swizzle_smem_tiles &&
+        other.extra_tile_sizes == extra_tile_sizes &&
+        other.extra_vectorize_factors == extra_vectorize_factors;
     return attr_equal;
   }
 
@@ -77,10 +97,20 @@ class TransposeParams : public HeuristicParams {
        << " BlckX: " << lparams.bdimx() << "\n";
     ss << " input tile size: " << tile_size1 << "\n";
     ss << " output tile size: " << tile_size2 << "\n";
-    int64_t elements_per_tile = tile_size1 * tile_size2;
+    for (auto i : c10::irange(extra_tile_sizes.size())) {
+      ss << " group " << i + 3 << " tile size: " << extra_tile_sizes.at(i)
+         << ", vectorize factor: " << extra_vectorize_factors.at(i) << "\n";
+    }
+    int64_t elements_per_tile = getTileElements();
     ss << " elements per tile: " << elements_per_tile << "\n";
     int64_t elements_per_thread = elements_per_tile / lparams.bdimx();
     ss << " elements per thread: " << elements_per_thread << "\n";
+    if (use_tma) {
+      ss << "TMA load and store of group 2\n";
+    }
+    if (swizzle_smem_tiles) {
+      ss << "Swizzle shared memory tiles\n";
+    }
     if (vectorize_factor1 > 1) {
       ss << "Vectorize group 1, Factor: " << vectorize_factor1 << "\n";
     }
@@ -147,17 +177,36 @@ class TransposeParams : public HeuristicParams {
         vectorize_factor1,
         vectorize_factor2,
         tile_size1,
-        tile_size2);
+        tile_size2,
+        use_tma,
+        swizzle_smem_tiles,
+        extra_tile_sizes,
+        extra_vectorize_factors);
   }
 
   std::shared_ptr<HeuristicParams> clone() const override {
     return std::make_shared<TransposeParams>(*this);
   }
 
+  // Number of elements in the tile of a block, over the inner-most
+  // dimensions of all groups
+  int64_t getTileElements() const {
+    int64_t elements = tile_size1 * tile_size2;
+    for (int64_t tile_size : extra_tile_sizes) {
+      elements *= tile_size;
+    }
+    return elements;
+  }
+
   int64_t getThreadsPerBlock() const {
-    int64_t tile_vectors1 = ceilDiv(tile_size1 * tile_size2, vectorize_factor1);
-    int64_t tile_vectors2 = ceilDiv(tile_size1 * tile_size2, vectorize_factor2);
-    int64_t tile_vectors = std::min(tile_vectors1, tile_vectors2);
+    const int64_t tile_elements = getTileElements();
+    int64_t tile_vectors = std::min(
+        ceilDiv(tile_elements, vectorize_factor1),
+        ceilDiv(tile_elements, vectorize_factor2));
+    for (int64_t vectorize_factor : extra_vectorize_factors) {
+      tile_vectors =
+          std::min(tile_vectors, ceilDiv(tile_elements, vectorize_factor));
+    }
     return std::min(getMaxThreadsPerBlock(), tile_vectors);
   }
 };
@@ -0,0 +1,464 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include <ATen/cuda/CUDAContext.h>
+
+#include <instrumentation.h>
+#include <options.h>
+#include <scheduler/normalization_inner.h>
+#include <scheduler/normalization_outer.h>
+#include <scheduler/pointwise.h>
+#include <scheduler/pointwise_heuristic.h>
+#include <scheduler/reduction.h>
+#include <scheduler/reduction_heuristic.h>
+#include <scheduler/tuning_db.h>
+
+#include <c10/util/irange.h>
+
+namespace nvfuser {
+
+namespace {
+
+//! Upper bound of the number of candidates searched per segment
+constexpr size_t max_candidates = 16;
+
+std::filesystem::path tuningDbPath() {
+  // NVFUSER_ENABLE=autotune(<path>)
+  const auto& args = getEnableOptionArguments(EnableOption::Autotune);
+  if (!args.empty() && !args[0].empty()) {
+    return std::filesystem::path(args[0]);
+  }
+  return std::filesystem::temp_directory_path() / "nvfuser_tuning_db.txt";
+}
+
+void hashBytes(uint64_t& hash, const void* data, size_t size) {
+  // 64-bit FNV-1a, stable across processes like the key of the kernel db
+  const auto bytes = static_cast<const unsigned char*>(data);
+  for (const auto i : c10::irange(size)) {
+    hash ^= bytes[i];
+    hash *= 0x100000001b3ULL;
+  }
+}
+
+void hashString(uint64_t& hash, const std::string& str) {
+  // The terminator keeps the boundaries of the fields part of the hash
+  hashBytes(hash, str.c_str(), str.size() + 1);
+}
+
+void hashInt(uint64_t& hash, int64_t value) {
+  hashBytes(hash, &value, sizeof(value));
+}
+
+//! Fields of a parameter class varied by the autotuner
+template <typename Params>
+struct TunableFields {
+  std::vector<std::pair<std::string, bool Params::*>> flags;
+  std::vector<std::pair<std::string, int64_t Params::*>> factors;
+  //! Whether the raw TIDx extent of the launch params is varied too
+  bool bdimx = false;
+};
+
+const TunableFields<PointwiseParams>& pointwiseFields() {
+  static const TunableFields<PointwiseParams> fields{
+      {{"vectorize", &PointwiseParams::vectorize},
+       {"flip_grid_binding", &PointwiseParams::flip_grid_binding}},
+      {{"unroll_factor", &PointwiseParams::unroll_factor}}};
+  return fields;
+}
+
+const TunableFields<ReductionParams>& reductionFields() {
+  static const TunableFields<ReductionParams> fields{
+      {{"vectorize_inner_reduction",
+        &ReductionParams::vectorize_inner_reduction},
+       {"vectorize_iter_dom", &ReductionParams::vectorize_iter_dom}},
+      {{"unroll_factor_inner_reduction",
+        &ReductionParams::unroll_factor_inner_reduction},
+       {"unroll_factor_iter_dom", &ReductionParams::unroll_factor_iter_dom},
+       {"batches_per_block_inner_reduction",
+        &ReductionParams::batches_per_block_inner_reduction}},
+      true};
+  return fields;
+}
+
+LaunchParams withBdimx(const LaunchParams& lparams, int64_t bdimx) {
+  LaunchParams result(
+      lparams.getRawVal(ParallelType::BIDx),
+      lparams.getRawVal(ParallelType::BIDy),
+      lparams.getRawVal(ParallelType::BIDz),
+      bdimx,
+      lparams.getRawVal(ParallelType::TIDy),
+      lparams.getRawVal(ParallelType::TIDz));
+  result.setSmem(lparams.smem());
+  return result;
+}
+
+template <typename Params>
+std::string encodeFields(
+    const Params& params,
+    const TunableFields<Params>& fields) {
+  std::stringstream ss;
+  for (const auto& [name, member] : fields.flags) {
+    ss << name << "=" << (params.*member ? 1 : 0) << ",";
+  }
+  for (const auto& [name, member] : fields.factors) {
+    ss << name << "=" << params.*member << ",";
+  }
+  if (fields.bdimx) {
+    ss << "bdimx=" << params.lparams.getRawVal(ParallelType::TIDx) << ",";
+  }
+  std::string encoded = ss.str();
+  encoded.pop_back();
+  return encoded;
+}
+
+template <typename Params>
+std::shared_ptr<HeuristicParams> decodeFields(
+    const Params& params,
+    const TunableFields<Params>& fields,
+    const std::string& encoded_params) {
+  std::unordered_map<std::string, int64_t> values;
+  std::stringstream ss(encoded_params);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    const auto pos = item.find('=');
+    if (pos == std::string::npos) {
+      return nullptr;
+    }
+    try {
+      values[item.substr(0, pos)] = std::stoll(item.substr(pos + 1));
+    } catch (const std::exception&) {
+      return nullptr;
+    }
+  }
+
+  auto result = std::make_shared<Params>(params);
+  for (const auto& [name, member] : fields.flags) {
+    auto it = values.find(name);
+    if (it == values.end()) {
+      return nullptr;
+    }
+    (*result).*member = it->second != 0;
+  }
+  for (const auto& [name, member] : fields.factors) {
+    auto it = values.find(name);
+    if (it == values.end() || it->second < 1) {
+      return nullptr;
+    }
+    (*result).*member = it->second;
+  }
+  if (fields.bdimx) {
+    auto it = values.find("bdimx");
+    if (it == values.end()) {
+      return nullptr;
+    }
+    result->lparams = withBdimx(result->lparams, it->second);
+  }
+  return result;
+}
+
+//! Factors to try for an unroll or vectorization factor. A vectorization
+//! factor can only be lowered since the analytic one is the largest allowed
+//! by the alignment of the inputs.
+std::vector<int64_t> factorsFor(int64_t factor, bool vectorize, int64_t max) {
+  std::vector<int64_t> factors;
+  if (vectorize) {
+    for (int64_t f = factor; f >= 1; f /= 2) {
+      factors.push_back(f);
+    }
+  } else {
+    factors.push_back(factor);
+    for (int64_t f = 1; f <= max; f *= 2) {
+      if (f != factor) {
+        factors.push_back(f);
+      }
+    }
+  }
+  return factors;
+}
+
+void addCandidate(
+    std::vector<std::shared_ptr<HeuristicParams>>& candidates,
+    std::shared_ptr<HeuristicParams> params) {
+  if (candidates.size() >= max_candidates) {
+    return;
+  }
+  // sameAs does not compare the launch params of pointwise parameters
+  bool seen = std::any_of(
+      candidates.begin(), candidates.end(), [&params](const auto& candidate) {
+        return candidate->sameAs(params) &&
+            candidate->lparams == params->lparams;
+      });
+  if (!seen) {
+    candidates.push_back(std::move(params));
+  }
+}
+
+void pointwiseCandidates(
+    std::vector<std::shared_ptr<HeuristicParams>>& candidates,
+    const PointwiseParams& params) {
+  std::vector<bool> flips{params.flip_grid_binding};
+  if (params.break_point > 0) {
+    // Both bindings of a 2D schedule are valid
+    flips.push_back(!params.flip_grid_binding);
+  }
+  for (int64_t factor :
+       factorsFor(params.unroll_factor, params.vectorize, 8)) {
+    for (bool flip : flips) {
+      auto candidate = std::make_shared<PointwiseParams>(params);
+      candidate->unroll_factor = factor;
+      candidate->vectorize = params.vectorize && factor > 1;
+      candidate->flip_grid_binding = flip;
+      addCandidate(candidates, std::move(candidate));
+    }
+  }
+}
+
+void reductionCandidates(
+    std::vector<std::shared_ptr<HeuristicParams>>& candidates,
+    ScheduleHeuristic heuristic,
+    const ReductionParams& params) {
+  if (heuristic == ScheduleHeuristic::InnerPersistent) {
+    // The persistent buffer is split into batches, so the unroll factors are
+    // bound by the buffer size. Vary the number of batches instead and let the
+    // block size be inferred from it.
+    if (params.static_bdimx) {
+      return;
+    }
+    const int64_t batches = params.batches_per_block_inner_reduction;
+    for (int64_t b : {batches / 2, batches * 2}) {
+      if (b < 1) {
+        continue;
+      }
+      auto candidate = std::make_shared<ReductionParams>(params);
+      candidate->batches_per_block_inner_reduction = b;
+      candidate->lparams =
+          withBdimx(params.lparams, LaunchParams::UNINITIALIZED_VAL);
+      addCandidate(candidates, std::move(candidate));
+    }
+    return;
+  }
+
+  std::vector<int64_t> inner_factors{params.unroll_factor_inner_reduction};
+  if (heuristic == ScheduleHeuristic::Reduction) {
+    inner_factors = factorsFor(
+        params.unroll_factor_inner_reduction,
+        params.vectorize_inner_reduction,
+        8);
+  }
+  for (int64_t inner_factor : inner_factors) {
+    for (int64_t iter_factor : factorsFor(
+             params.unroll_factor_iter_dom, params.vectorize_iter_dom, 4)) {
+      auto candidate = std::make_shared<ReductionParams>(params);
+      candidate->unroll_factor_inner_reduction = inner_factor;
+      candidate->vectorize_inner_reduction =
+          params.vectorize_inner_reduction && inner_factor > 1;
+      candidate->unroll_factor_iter_dom = iter_factor;
+      candidate->vectorize_iter_dom =
+          params.vectorize_iter_dom && iter_factor > 1;
+      addCandidate(candidates, std::move(candidate));
+    }
+  }
+}
+
+} // namespace
+
+TuningDb& TuningDb::get() {
+  static TuningDb singleton;
+  const std::filesystem::path path = tuningDbPath();
+  std::lock_guard<std::mutex> guard(singleton.mutex_);
+  if (path != singleton.path_) {
+    singleton.open(path);
+  }
+  return singleton;
+}
+
+void TuningDb::open(const std::filesystem::path& path) {
+  FUSER_PERF_SCOPE("TuningDb::open");
+  path_ = path;
+  entries_.clear();
+  std::ifstream file(path_);
+  std::string line;
+  while (std::getline(file, line)) {
+    std::stringstream ss(line);
+    uint64_t key = 0;
+    std::string encoded_params;
+    if (ss >> std::hex >> key >> encoded_params) {
+      entries_[key] = encoded_params;
+    }
+  }
+}
+
+std::optional<std::string> TuningDb::query(uint64_t key) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+void TuningDb::write(uint64_t key, const std::string& encoded_params) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  entries_[key] = encoded_params;
+
+  std::stringstream ss;
+  ss << std::hex << std::setw(16) << std::setfill('0') << key << " "
+     << encoded_params << "\n";
+  const std::string line = ss.str();
+  // A single appending write per entry keeps the lines of concurrent writers
+  // from interleaving
+  int fd = ::open(path_.c_str(), O_WRONLY | O_APPEND | O_CREAT, 0644);
+  if (fd < 0) {
+    TORCH_WARN("Tuning DB: Failed to open ", path_.string());
+    return;
+  }
+  if (::write(fd, line.data(), line.size()) != (ssize_t)line.size()) {
+    TORCH_WARN("Tuning DB: Failed to write ", path_.string());
+  }
+  ::close(fd);
+}
+
+size_t TuningDb::size() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return entries_.size();
+}
+
+namespace autotune {
+
+bool isTunable(ScheduleHeuristic heuristic) {
+  switch (heuristic) {
+    case ScheduleHeuristic::PointWise:
+    case ScheduleHeuristic::Reduction:
+    case ScheduleHeuristic::InnerPersistent:
+    case ScheduleHeuristic::OuterPersistent:
+      return true;
+    default:
+      return false;
+  }
+}
+
+uint64_t tuningKey(
+    Fusion* fusion,
+    ScheduleHeuristic heuristic,
+    const KernelArgumentHolder& args) {
+  FUSER_PERF_SCOPE("autotune::tuningKey");
+  uint64_t hash = 0xcbf29ce484222325ULL;
+
+  std::stringstream ir;
+  fusion->print(ir, /*include_tensor_transforms=*/false);
+  hashString(hash, ir.str());
+  hashString(hash, toString(heuristic));
+
+  for (const auto i : c10::irange(args.size())) {
+    const PolymorphicValue* arg = args[i];
+    if (arg->is<at::Tensor>()) {
+      const auto& tensor = arg->as<at::Tensor>();
+      hashString(hash, c10::toString(tensor.scalar_type()));
+      for (int64_t size : tensor.sizes()) {
+        hashInt(hash, size);
+      }
+      for (int64_t stride : tensor.strides()) {
+        hashInt(hash, stride);
+      }
+    } else if (arg->is<int64_t>()) {
+      hashInt(hash, arg->as<int64_t>());
+    } else if (arg->is<bool>()) {
+      hashInt(hash, arg->as<bool>());
+    } else if (arg->is<double>()) {
+      double value = arg->as<double>();
+      hashBytes(hash, &value, sizeof(value));
+    }
+    // Separates the arguments
+    hashInt(hash, -1);
+  }
+
+  const auto prop = at::cuda::getDeviceProperties(args.getDeviceIndex());
+  hashString(hash, prop->name);
+  hashInt(hash, prop->major);
+  hashInt(hash, prop->minor);
+  return hash;
+}
+
+std::vector<std::shared_ptr<HeuristicParams>> candidateParams(
+    ScheduleHeuristic heuristic,
+    const HeuristicParams& params) {
+  std::vector<std::shared_ptr<HeuristicParams>> candidates{params.clone()};
+  if (heuristic == ScheduleHeuristic::PointWise) {
+    pointwiseCandidates(
+        candidates, dynamic_cast<const PointwiseParams&>(params));
+  } else {
+    NVF_ERROR(isTunable(heuristic), "Cannot tune ", heuristic);
+    reductionCandidates(
+        candidates, heuristic, dynamic_cast<const ReductionParams&>(params));
+  }
+  return candidates;
+}
+
+std::string encodeParams(
+    ScheduleHeuristic heuristic,
+    const HeuristicParams& params) {
+  if (heuristic == ScheduleHeuristic::PointWise) {
+    return encodeFields(
+        dynamic_cast<const PointwiseParams&>(params), pointwiseFields());
+  }
+  NVF_ERROR(isTunable(heuristic), "Cannot tune ", heuristic);
+  return encodeFields(
+      dynamic_cast<const ReductionParams&>(params), reductionFields());
+}
+
+std::shared_ptr<HeuristicParams> decodeParams(
+    ScheduleHeuristic heuristic,
+    const HeuristicParams& params,
+    const std::string& encoded_params) {
+  if (heuristic == ScheduleHeuristic::PointWise) {
+    return decodeFields(
+        dynamic_cast<const PointwiseParams&>(params),
+        pointwiseFields(),
+        encoded_params);
+  }
+  NVF_ERROR(isTunable(heuristic), "Cannot tune ", heuristic);
+  return decodeFields(
+      dynamic_cast<const ReductionParams&>(params),
+      reductionFields(),
+      encoded_params);
+}
+
+void scheduleWith(
+    ScheduleHeuristic heuristic,
+    Fusion* fusion,
+    const HeuristicParams& params) {
+  switch (heuristic) {
+    case ScheduleHeuristic::PointWise:
+      schedulePointwise(fusion, dynamic_cast<const PointwiseParams&>(params));
+      break;
+    case ScheduleHeuristic::Reduction:
+      scheduleReduction(fusion, dynamic_cast<const ReductionParams&>(params));
+      break;
+    case ScheduleHeuristic::InnerPersistent:
+      scheduleInnerPersistentKernel(
+          fusion, dynamic_cast<const ReductionParams&>(params));
+      break;
+    case ScheduleHeuristic::OuterPersistent:
+      scheduleOuterPersistentKernel(
+          fusion, dynamic_cast<const ReductionParams&>(params));
+      break;
+    default:
+      NVF_ERROR(false, "Cannot tune ", heuristic);
+  }
+}
+
+} // namespace autotune
+
+} // namespace nvfuser
@@ -0,0 +1,105 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#pragma once
+
+#include <executor_kernel_arg.h>
+#include <fusion.h>
+#include <scheduler/heuristic.h>
+#include <scheduler/heuristic_types.h>
+#include <visibility.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace nvfuser {
+
+//! TuningDb is a singleton mapping tuning keys to the scheduler parameters
+//! picked by the autotuner. See [ Note -- Autotuning ] in kernel_cache.cpp.
+//!
+//! The db is a text file with one entry per line, a key in hexadecimal
+//! followed by the encoded parameters. Entries are appended, so several
+//! processes can share a file, and a later line for a key replaces the earlier
+//! ones when the file is read.
+class TuningDb {
+  TuningDb() = default;
+
+ public:
+  TuningDb(const TuningDb&) = delete;
+  TuningDb& operator=(const TuningDb&) = delete;
+
+  //! Thread-safe method to get the singleton. The file is given by
+  //! NVFUSER_ENABLE=autotune(<path>) and defaults to nvfuser_tuning_db.txt in
+  //! the temporary directory. It is read again whenever the path changes.
+  NVF_API static TuningDb& get();
+
+  //! Encoded parameters stored for `key`, if any
+  NVF_API std::optional<std::string> query(uint64_t key);
+
+  //! Store the encoded parameters of `key`, both in memory and in the file
+  NVF_API void write(uint64_t key, const std::string& encoded_params);
+
+  //! Number of keys in the db
+  NVF_API size_t size();
+
+ private:
+  //! Forget all entries and read those of the file at `path`
+  void open(const std::filesystem::path& path);
+
+ private:
+  std::mutex mutex_;
+  std::filesystem::path path_;
+  std::unordered_map<uint64_t, std::string> entries_;
+};
+
+namespace autotune {
+
+//! Whether the autotuner knows how to vary the parameters of a heuristic
+bool isTunable(ScheduleHeuristic heuristic);
+
+//! Key of a segment in the tuning db. It hashes the segment IR, the heuristic,
+//! the sizes, strides and types of the tensor inputs, the values of the scalar
+//! inputs and the device, so it is stable across processes.
+uint64_t tuningKey(
+    Fusion* fusion,
+    ScheduleHeuristic heuristic,
+    const KernelArgumentHolder& args);
+
+//! Candidate parameters derived from the analytic `params` by varying the
+//! unroll and vectorization factors, the persistent batch size and the grid
+//! binding. The first candidate is a copy of `params`.
+std::vector<std::shared_ptr<HeuristicParams>> candidateParams(
+    ScheduleHeuristic heuristic,
+    const HeuristicParams& params);
+
+//! Encode the fields of `params` the autotuner varies
+std::string encodeParams(
+    ScheduleHeuristic heuristic,
+    const HeuristicParams& params);
+
+//! Copy of the analytic `params` with the fields encoded by encodeParams.
+//! Returns nullptr if `encoded_params` cannot be decoded.
+std::shared_ptr<HeuristicParams> decodeParams(
+    ScheduleHeuristic heuristic,
+    const HeuristicParams& params,
+    const std::string& encoded_params);
+
+//! Schedule `fusion` with the candidate `params` of `heuristic`
+void scheduleWith(
+    ScheduleHeuristic heuristic,
+    Fusion* fusion,
+    const HeuristicParams& params);
+
+} // namespace autotune
+
+} // namespace nvfuser
@@ -17,6 +17,7 @@
 #include <logical_domain_map.h>
 #include <multidevice/utils.h>
 #include <ops/all_ops.h>
+#include <options.h>
 #include <scheduler/mma_utils.h>
 #include <transform_iter.h>
 #include <transform_replay.h>
@@ -557,6 +558,70 @@ std::pair<bool, std::vector<TensorView*>> canProjectToInputsWithoutReduction(
   return std::make_pair(true, target_broadcast_tvs);
 }
 
+namespace {
+
+// Note [Lower precision persistent buffers]
+//
+// The persistent buffers of normalizations are often computed in fp32 from
+// fp16 or bf16 inputs, and their results are cast back to that type before
+// being written out. When such a buffer can't be projected to the inputs, it
+// takes twice the registers or shared memory of the inputs, which limits the
+// sizes normalizations can stay persistent for, and their occupancy.
+//
+// With EnableOption::LowerPrecisionPersistentBuffers, a buffer is stored in
+// the lower precision type when:
+//   1. it is an fp32 intermediate tensor;
+//   2. it is not projectable to the inputs, otherwise the lower precision
+//   inputs can be kept instead without losing precision;
+//   3. all the fusion outputs depending on it are of the same lower precision
+//   type, which is the type it is stored in.
+// The reductions and the other computations before the resolution points
+// still read the buffer in fp32. Only the values read again after the
+// reductions are rounded, so the rounding error is at most the one of the
+// outputs. This is still a numerical change, hence opt-in.
+//
+// The buffer sizes used by the heuristics are computed with the lower
+// precision type, and normalization_scheduler_utils::beforeSchedule inserts
+// the casts realizing it.
+std::unordered_map<TensorView*, DataType> getLowerPrecisionBuffers(
+    Fusion* fusion,
+    const PersistentBufferInfo& persistent_buffer_info) {
+  std::unordered_map<TensorView*, DataType> lower_precision_buffers;
+  for (TensorView* buffer : persistent_buffer_info.persistent_buffers) {
+    if (buffer->getDataType() != DataType::Float || buffer->isFusionInput() ||
+        buffer->isFusionOutput()) {
+      continue;
+    }
+    if (std::find(
+            persistent_buffer_info.projectable_persistent_buffers.begin(),
+            persistent_buffer_info.projectable_persistent_buffers.end(),
+            buffer) !=
+        persistent_buffer_info.projectable_persistent_buffers.end()) {
+      continue;
+    }
+    std::optional<DataType> storage_type;
+    bool is_safe = true;
+    for (Val* output : DependencyCheck::getAllOutputsOf({buffer})) {
+      if (!output->isFusionOutput() || !output->isA<TensorView>()) {
+        continue;
+      }
+      const DataType dtype = output->getDataType().value();
+      if ((dtype != DataType::Half && dtype != DataType::BFloat16) ||
+          (storage_type.has_value() && *storage_type != dtype)) {
+        is_safe = false;
+        break;
+      }
+      storage_type = dtype;
+    }
+    if (is_safe && storage_type.has_value()) {
+      lower_precision_buffers.emplace(buffer, *storage_type);
+    }
+  }
+  return lower_precision_buffers;
+}
+
+} // namespace
+
 PersistentBufferInfo persistentBuffers(Fusion* fusion) {
   FusionGuard fg(fusion);
   PersistentBufferInfo persistent_buffer_info;
@@ -639,6 +704,11 @@ PersistentBufferInfo persistentBuffers(Fusion* fusion) {
     }
   }
 
+  if (isOptionEnabled(EnableOption::LowerPrecisionPersistentBuffers)) {
+    persistent_buffer_info.lower_precision_buffers =
+        getLowerPrecisionBuffers(fusion, persistent_buffer_info);
+  }
+
   // Projection analysis below
   if (persistent_buffer_info.projectable_persistent_buffers.empty()) {
     return persistent_buffer_info;
@@ -941,10 +1011,19 @@ int64_t getPersistentBufferSizeOfTensor(
     }
   }
 
-  buffer_bytes = buffer_bytes == -1 ? 0
-                                    : buffer_bytes *
-          (int64_t)dataTypeSize(buffer->getDataType().value(),
-                                runtime_info.getIndexType());
+  // Lower precision buffers are stored in that type, see Note [Lower precision
+  // persistent buffers]
+  DataType dtype = buffer->getDataType().value();
+  if (auto it = persistent_buffer_info.lower_precision_buffers.find(
+          const_cast<TensorView*>(buffer));
+      it != persistent_buffer_info.lower_precision_buffers.end()) {
+    dtype = it->second;
+  }
+
+  buffer_bytes = buffer_bytes == -1
+      ? 0
+      : buffer_bytes *
+          (int64_t)dataTypeSize(dtype, runtime_info.getIndexType());
   return buffer_bytes;
 }
 
@@ -1087,16 +1166,55 @@ std::pair<bool, bool> canonicalDimReduction(
   }
 }
 
+namespace {
+
+// Tensors with a reduction loop domain and the mutation epoch of the fusion
+// they were found at. Segmentation, each scheduler's canSchedule and
+// heuristics, and the schedulers themselves all look for the reductions of
+// the same fusion, so the scan over allTvs is done once per version of the
+// IR. Whether a reduction is resharding depends on device meshes and
+// parallelization, which are set in place, so that is checked on each call.
+struct ReductionTvsCache {
+  int64_t epoch = -1;
+  std::vector<TensorView*> tvs;
+};
+
+const std::string kReductionTvsCacheKey = "scheduler_utils_reduction_tvs";
+
+const std::vector<TensorView*>& tvsWithReductionLoop(Fusion* fusion) {
+  if (!fusion->hasManaged(kReductionTvsCacheKey)) {
+    // A copy of the fusion has another epoch, so it starts with an empty cache
+    fusion->manage(
+        kReductionTvsCacheKey,
+        std::make_shared<ReductionTvsCache>(),
+        [](IrCloner&, std::any) -> std::any {
+          return std::make_shared<ReductionTvsCache>();
+        });
+  }
+  auto cache = fusion->getManaged<std::shared_ptr<ReductionTvsCache>>(
+      kReductionTvsCacheKey);
+  if (cache->epoch != fusion->mutationEpoch()) {
+    cache->tvs.clear();
+    for (auto tv : fusion->allTvs()) {
+      if (!tv->isFusionInput() &&
+          std::any_of(
+              tv->getLoopDomain().begin(),
+              tv->getLoopDomain().end(),
+              [](IterDomain* id) { return id->isReduction(); })) {
+        cache->tvs.push_back(tv);
+      }
+    }
+    cache->epoch = fusion->mutationEpoch();
+  }
+  return cache->tvs;
+}
+
+} // namespace
+
 std::vector<TensorView*> getReductionTvs(Fusion* fusion) {
-  auto all_tvs = fusion->allTvs();
   std::vector<TensorView*> reduction_tvs;
-  for (auto tv : all_tvs) {
-    if (!tv->isFusionInput() &&
-        std::any_of(
-            tv->getLoopDomain().begin(),
-            tv->getLoopDomain().end(),
-            [](IterDomain* id) { return id->isReduction(); }) &&
-        !isResharding(tv->definition())) {
+  for (auto tv : tvsWithReductionLoop(fusion)) {
+    if (!isResharding(tv->definition())) {
       reduction_tvs.emplace_back(tv);
     }
   }
@@ -1501,6 +1619,28 @@ bool hasInnerDim(
   return true;
 }
 
+namespace {
+
+// Whether the lookup tensor of index_selects can be read with vectorized
+// loads by them, i.e., when it's only gathered along an outer dimension like
+// the table of an embedding lookup. The consumers of such a tensor are then
+// vectorized instead of a cache of it, which index_select can't read from.
+bool isVectorizableLookupTv(TensorView* tv) {
+  for (Expr* use : tv->uses()) {
+    auto index_select = dynamic_cast<IndexSelectOp*>(use);
+    if (index_select == nullptr || index_select->lookupTv() != tv) {
+      return false;
+    }
+    auto alloc = TensorDomain::noReductions(tv->getMaybeAllocationDomain());
+    if (alloc.empty() || alloc.back() == index_select->getIndexedID()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
 std::vector<TensorView*> getInputsOutputsWithInnerDim(
     TensorView* reference_tv,
     bool inner_only,
@@ -1542,9 +1682,10 @@ std::vector<TensorView*> getInputsOutputsWithInnerDim(
   for (auto input_tv :
        ir_utils::filterByType<TensorView>(reference_tv->fusion()->inputs())) {
     // for index_select(lookup_tv, dim, index_tv) op
-    // ignore it's lookup_tv.
+    // ignore it's lookup_tv, unless the index_select can load vectors of it.
     if (ir_utils::isTorchGatherLookupTv(input_tv) ||
-        ir_utils::isIndexSelectLookupTv(input_tv)) {
+        (ir_utils::isIndexSelectLookupTv(input_tv) &&
+         !(vectorize_pass && isVectorizableLookupTv(input_tv)))) {
       continue;
     }
 
@@ -1665,6 +1806,7 @@ BroadcastMultipleInformation getBroadcastMultiples(
   }
 
   std::vector<BroadcastMultiple> multiples(ref_root_domain.size());
+  std::vector<InputBroadcastPattern> input_patterns;
 
   auto disjoint_logical_sets = disjointLogicalSets(fusion);
   auto disjoint_set_information = scheduler_utils::getDisjointLogicalSetsOf(
@@ -1675,9 +1817,11 @@ BroadcastMultipleInformation getBroadcastMultiples(
 
   // All input or output tensor views
   std::vector<TensorView*> in_out_tvs;
+  size_t num_input_tvs = 0;
   {
     auto inp_tvs = ir_utils::filterByType<TensorView>(fusion->inputs());
     in_out_tvs.insert(in_out_tvs.end(), inp_tvs.begin(), inp_tvs.end());
+    num_input_tvs = in_out_tvs.size();
     auto out_tvs = ir_utils::filterByType<TensorView>(fusion->outputs());
     in_out_tvs.insert(in_out_tvs.end(), out_tvs.begin(), out_tvs.end());
   }
@@ -1687,7 +1831,8 @@ BroadcastMultipleInformation getBroadcastMultiples(
   auto ca_map = ComputeAtMap(fusion);
 
   // Map all inputs and output domains to reference tv domains
-  for (auto in_out_tv : in_out_tvs) {
+  for (const auto in_out_i : c10::irange(in_out_tvs.size())) {
+    auto in_out_tv = in_out_tvs[in_out_i];
     std::vector<bool> mapped_axes(ref_root_domain.size(), false);
 
     auto in_out_tv_domain =
@@ -1745,6 +1890,12 @@ BroadcastMultipleInformation getBroadcastMultiples(
       mapped_axes[ref_i] = true;
     }
 
+    if (in_out_i < num_input_tvs) {
+      input_patterns.push_back(
+          {(int64_t)dataTypeSize(in_out_tv->getDataType().value(), index_type),
+           mapped_axes});
+    }
+
     // For each break point position if there an lhs or rhs multiple based on
     // this tensor add it to the global multiplier. The only time we consider
     // we can benefit from broadcast is if the entire left or right side the
@@ -1774,6 +1925,7 @@ BroadcastMultipleInformation getBroadcastMultiples(
   BroadcastMultipleInformation bcast_info;
   bcast_info.view_disjoint_set_ids = ref_disjoint_set_ids;
   bcast_info.broadcast_multiples = multiples;
+  bcast_info.input_patterns = input_patterns;
   return bcast_info;
 }
 
@@ -2007,7 +2159,7 @@ void BoundedDirectionalTransformPropagator::bothWays(
 DisjointSets<IterDomain*> disjointLogicalSets(Fusion* fusion) {
   // Start from the exact iter domain graph of the fusion
   IterDomainGraph id_graph(fusion);
-  auto disjoint_logical_ids = id_graph.exactNodes();
+  UnionFind<IterDomain*> disjoint_logical_ids(id_graph.exactNodes());
 
   // If iter domains are involved in any transformation from root domains to
   // logical domains they should be considered "contaminated".
@@ -2031,7 +2183,7 @@ DisjointSets<IterDomain*> disjointLogicalSets(Fusion* fusion) {
       }
     }
   }
-  return disjoint_logical_ids;
+  return disjoint_logical_ids.toDisjointSets();
 }
 
 bool breakIsDisjoint(std::vector<int64_t> group_ids, int64_t pos) {
@@ -2497,6 +2649,76 @@ void promoteProducerMemoryTypes(
   }
 }
 
+// [ Note -- Load pipelining ]
+//
+// The global loads of a cached input inlined into a serial loop, e.g. the
+// loop over the remainder of a long row in a non-persistent inner reduction,
+// are issued right before their values are used, so each iteration waits for
+// the latency of its loads. Circular buffering the cached input makes the
+// lowering issue the loads of the next stages while the current one is
+// computed, at the cost of the registers of the extra stages.
+//
+// The lowering picks the innermost loop outside of the computeAt position
+// that is neither parallelized nor a broadcast, and outside of any unrolled
+// loop. Cached inputs are only circular buffered when that loop is serial
+// and iterates over the problem, i.e. has no constant extent, so unswitched,
+// unrolled or vectorized loops are never circular buffered. The heuristics
+// must also ensure the loop has at least as many iterations as stages, as
+// that is checked at launch time.
+
+namespace {
+
+//! The loop the lowering would circular buffer `tv` across, see
+//! getCircularBufferAxisPosition in device_lower/analysis/circular_buffer.cpp.
+//! nullptr if the cached input cannot be pipelined.
+IterDomain* getPipelinedLoop(TensorView* tv) {
+  if (tv->getMemoryType() != MemoryType::Local || tv->isCircularBuffered() ||
+      tv->hasComputeWith() || tv->uses().empty() ||
+      tv->getComputeAtPosition() == 0) {
+    return nullptr;
+  }
+  auto def = dynamic_cast<LoadStoreOp*>(tv->definition());
+  if (def == nullptr || !def->in()->isA<TensorView>() ||
+      def->in()->as<TensorView>()->getMemoryType() != MemoryType::Global) {
+    return nullptr;
+  }
+
+  int64_t pos = tv->getComputeAtPosition();
+  for (int64_t i : c10::irange(pos)) {
+    if (tv->axis(i)->getParallelType() == ParallelType::Unroll) {
+      pos = i;
+      break;
+    }
+  }
+  for (int64_t i = pos - 1; i >= 0; --i) {
+    IterDomain* id = tv->axis(i);
+    if (isParallelTypeThread(id->getParallelType()) || id->isBroadcast()) {
+      continue;
+    }
+    if (id->getParallelType() != ParallelType::Serial ||
+        id->extent()->isConstScalar()) {
+      return nullptr;
+    }
+    return id;
+  }
+  return nullptr;
+}
+
+} // namespace
+
+void circularBufferCachedInputs(
+    const std::vector<TensorView*>& cached_inputs,
+    int64_t number_of_stages) {
+  if (number_of_stages <= 1) {
+    return;
+  }
+  for (TensorView* tv : cached_inputs) {
+    if (getPipelinedLoop(tv) != nullptr) {
+      tv->circularBuffer(number_of_stages);
+    }
+  }
+}
+
 std::unordered_set<TensorView*> getAllTvsFrom(
     const std::vector<TensorView*>& from_tvs,
     const std::unordered_set<TensorView*>& cutoff_tv_set) {
@@ -201,6 +201,12 @@ struct PersistentBufferInfo {
   bool has_view_ops = false;
   bool projection_with_exp_op = false;
   bool projection_with_rng_op = false;
+
+  // Persistent buffers that are stored in lower precision, and the type they
+  // are stored in. Only populated when
+  // EnableOption::LowerPrecisionPersistentBuffers is set. See Note [Lower
+  // precision persistent buffers] in the cpp file.
+  std::unordered_map<TensorView*, DataType> lower_precision_buffers;
 };
 
 // Buffers whos roots can't map to all producer roots based on compute at. These
@@ -424,9 +430,20 @@ struct BroadcastMultiple {
   int64_t lhs_multiple = 0;
 };
 
+// Dimensions of the reference tensor that an input of the fusion has a
+// non-broadcast dimension mapped to
+struct InputBroadcastPattern {
+  int64_t dtype_size = 0;
+  std::vector<bool> mapped_axes;
+};
+
 struct BroadcastMultipleInformation {
   std::vector<int64_t> view_disjoint_set_ids;
   std::vector<BroadcastMultiple> broadcast_multiples;
+  // One entry per fusion input, used by the 3D pointwise schedule, which
+  // reuses inputs across a range of dimensions rather than only across one
+  // side of a break point
+  std::vector<InputBroadcastPattern> input_patterns;
 };
 
 // Returns a vector of size reference_tv->getLogicalDomain().size() which
@@ -441,7 +458,8 @@ struct BroadcastMultipleInformation {
 // multiple is the full multiple size if any domain in the group maps to a
 // non-broadcast dimension in the given input/output. Otherwise if all
 // dimensions are broadcast that input/output will not contribute to the
-// multiple.
+// multiple. The dimensions each input maps to are also returned in
+// input_patterns.
 //
 // logical_reorder_map is provided to assume reference_tv will be reordered per
 // the map
@@ -654,6 +672,15 @@ NVF_API void promoteProducerMemoryTypes(
     Fusion* fusion,
     const std::vector<TensorView*>& input_caches);
 
+//! Circular buffer the Local caches of global inputs whose loads are inlined
+//! in a serial loop over the problem with `number_of_stages` stages, so that
+//! the loads of the next iterations are issued while the current one is
+//! computed. Other cached inputs are left as is. See
+//! [ Note -- Load pipelining ] in scheduler/utils.cpp.
+NVF_API void circularBufferCachedInputs(
+    const std::vector<TensorView*>& cached_inputs,
+    int64_t number_of_stages);
+
 //! Get all tensors that are connected to from_tvs without going through
 //! any tvs in the cutoff_tv_set.
 NVF_API std::unordered_set<TensorView*> getAllTvsFrom(
@@ -802,7 +802,8 @@ int64_t getVectorizationFactor(
     TensorView* reference_tv,
     HeuristicSummary* data_cache,
     int64_t break_point,
-    const std::unordered_map<int64_t, int64_t>& logical_reorder_map) {
+    const std::unordered_map<int64_t, int64_t>& logical_reorder_map,
+    std::vector<TensorView*>* misaligned_tvs) {
   FUSER_PERF_SCOPE("vectorize_helper::getVectorizationFactor");
 
   auto vectorizable_inputs_outputs_entry =
@@ -836,6 +837,11 @@ int64_t getVectorizationFactor(
   int64_t max_vec_size = SchedulerRuntimeInfo::max_alignment_size_in_byte;
   const auto& tv_to_inner_size_map = vectorize_maps_entry.get().at(break_point);
 
+  // Factors allowed by the base address and strides of each tensor, applied
+  // after the other limits so that misaligned tensors can be left out.
+  std::vector<std::pair<TensorView*, int64_t>> alignment_factors;
+  alignment_factors.reserve(vectorizable_inputs_outputs.size());
+
   for (auto inp_or_out : vectorizable_inputs_outputs) {
     // factor <= max_factor / dtype_size
     const auto dtype_size =
@@ -847,7 +853,7 @@ int64_t getVectorizationFactor(
     // factor <= alignment / dtype_size
     int64_t alignment_size = (int64_t)runtime_info.getAlignmentSize(inp_or_out);
     NVF_ERROR(alignment_size % dtype_size == 0);
-    max_vec_size = std::min(max_vec_size, alignment_size / dtype_size);
+    alignment_factors.emplace_back(inp_or_out, alignment_size / dtype_size);
 
     // factor <= projected_extent
     auto inner_size_it = tv_to_inner_size_map.find(inp_or_out);
@@ -872,7 +878,25 @@ int64_t getVectorizationFactor(
         max_vec_size);
   }
 
-  return max_vec_size;
+  std::vector<TensorView*> misaligned;
+  int64_t min_alignment_factor = max_vec_size;
+  for (const auto& [tv, alignment_factor] : alignment_factors) {
+    if (alignment_factor < max_vec_size) {
+      misaligned.push_back(tv);
+    }
+    min_alignment_factor = std::min(min_alignment_factor, alignment_factor);
+  }
+
+  // Leaving a minority of misaligned tensors, e.g. a sliced input, to scalar
+  // accesses keeps the others vectorized by the full factor. Otherwise, the
+  // factor of all tensors is limited by the worst alignment.
+  if (misaligned_tvs != nullptr &&
+      2 * misaligned.size() < alignment_factors.size()) {
+    misaligned_tvs->insert(
+        misaligned_tvs->end(), misaligned.begin(), misaligned.end());
+    return max_vec_size;
+  }
+  return min_alignment_factor;
 }
 
 int64_t getVectorizationFactorTransposeGroup(
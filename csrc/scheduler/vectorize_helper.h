@@ -312,12 +312,18 @@ class NVF_API ContiguousInnerDimensionsMapper
 
 // logical_reorder_map is provided to assume reference_tv will be reordered per
 // the map, hence changing the order of IterDomain in the reference
+//
+// When misaligned_tvs is given, the inputs and outputs whose base address or
+// strides are not aligned to the factor are appended to it instead of
+// limiting the factor, as long as they are fewer than half of the vectorized
+// tensors. The caller must then not vectorize them.
 int64_t getVectorizationFactor(
     SchedulerRuntimeInfo& runtime_info,
     TensorView* reference_tv,
     HeuristicSummary* data_cache,
     int64_t break_point,
-    const std::unordered_map<int64_t, int64_t>& logical_reorder = {});
+    const std::unordered_map<int64_t, int64_t>& logical_reorder = {},
+    std::vector<TensorView*>* misaligned_tvs = nullptr);
 
 int64_t getVectorizationFactorTransposeGroup(
     SchedulerRuntimeInfo& runtime_info,
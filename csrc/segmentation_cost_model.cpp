@@ -0,0 +1,387 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#include <segmentation_cost_model.h>
+
+#include <fusion_profiler.h>
+#include <instrumentation.h>
+#include <ir/utils.h>
+#include <options.h>
+#include <scheduler/reduction_heuristic.h>
+#include <scheduler/registry.h>
+#include <scheduler/utils.h>
+
+#include <ATen/cuda/CUDAContext.h>
+
+#include <algorithm>
+#include <string>
+
+namespace nvfuser {
+
+// [ Note -- Segmentation cost model ]
+//
+// The segmenter merges two groups whenever a scheduler accepts the merged
+// group. With NVFUSER_ENABLE=segmentation_cost_model, it also asks a
+// SegmentationCostModel for the time of the merged group and of the two
+// groups, and keeps the groups separate if the merged group is predicted to
+// be slower. Merges are only refused when both groups can be scheduled on
+// their own, so the segmentation succeeds whenever it would without a model.
+//
+// AnalyticCostModel assumes kernels are bound by memory bandwidth:
+//
+//   time = launch_overhead + bytes / (peak_bandwidth * efficiency)
+//
+// where bytes are those of the tensor inputs and outputs of the segment. The
+// efficiency of persistent kernels drops with the number of rows whose
+// persistent buffer fits in the register file of an SM, as fewer resident
+// rows leave fewer loads in flight. A merge that only removes an intermediate
+// always looks profitable, so in practice the model refuses merging into
+// persistent kernels with very large buffers.
+//
+// With segmentation_cost_model(profile), ProfileGuidedCostModel is used
+// instead. When the profiler runs with CUPTI, e.g. NVFUSER_PROF=enable, the
+// kernel time of every segment is recorded under a key made of the operations
+// of the segment, its heuristic and the sizes of its inputs and outputs. Later
+// segmentations use the recorded time of a candidate with the same key
+// instead of the analytic estimate. The recorded times are kept for the life
+// of the process and shared by all FusionExecutorCaches.
+//
+// splitReductionPartials uses the same bandwidth model to compare a
+// cross-grid reduction with a partial and a final reduction kernel. The grid
+// reduction additionally writes and reads its workspace, zero fills its
+// semaphores, and leaves the last block of each output to reduce all partial
+// results on one SM. The split pays a second launch and the round trip of its
+// partial results through global memory.
+
+namespace {
+
+//! Overhead of a kernel launch, in microseconds
+constexpr double launch_overhead_us = 4.0;
+
+//! Fraction of the peak bandwidth reached by a well-occupied kernel
+constexpr double bandwidth_efficiency = 0.8;
+
+//! Number of rows per SM persistent kernels need to hide latency. Empirical.
+constexpr int64_t rows_for_full_bandwidth = 8;
+
+//! Fewest elements reduced into each partial result of a split reduction
+constexpr int64_t min_split_reduction_numel = 1024;
+
+//! Number of outputs per SM the partial reduction of a split reduction needs
+//! to fill the device without a grid reduction. Empirical.
+constexpr int64_t split_reduction_rows_per_sm = 8;
+
+void hashBytes(uint64_t& hash, const void* data, size_t size) {
+  const auto* bytes = static_cast<const unsigned char*>(data);
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= bytes[i];
+    hash *= 0x100000001b3ULL;
+  }
+}
+
+void hashInt(uint64_t& hash, int64_t value) {
+  hashBytes(hash, &value, sizeof(value));
+}
+
+void hashString(uint64_t& hash, const std::string& str) {
+  hashBytes(hash, str.data(), str.size());
+  hashInt(hash, -1);
+}
+
+const DeviceDescriptor& currentDevice() {
+  static std::mutex mutex;
+  static std::unordered_map<int, DeviceDescriptor> descriptors;
+  const int device = at::cuda::current_device();
+  std::lock_guard<std::mutex> guard(mutex);
+  auto it = descriptors.find(device);
+  if (it == descriptors.end()) {
+    it = descriptors.emplace(device, DeviceDescriptor()).first;
+    DeviceDescriptor::generate(it->second, device);
+  }
+  return it->second;
+}
+
+//! Logical sizes of `tv` without reduction dimensions. Expanded broadcasts are
+//! counted with their expanded extent, unknown extents as 0.
+std::vector<int64_t> tensorSizes(
+    TensorView* tv,
+    SchedulerRuntimeInfo& runtime_info) {
+  std::vector<int64_t> sizes;
+  for (IterDomain* id : TensorDomain::noReductions(tv->getLogicalDomain())) {
+    auto extent = runtime_info.expressionEvaluator().evaluate(
+        id->getMaybeExpandedExtent());
+    sizes.push_back(extent.hasValue() ? extent.as<int64_t>() : 0);
+  }
+  return sizes;
+}
+
+std::vector<std::vector<int64_t>> tensorSizes(
+    const std::vector<Val*>& vals,
+    SchedulerRuntimeInfo& runtime_info) {
+  std::vector<std::vector<int64_t>> sizes;
+  for (TensorView* tv : ir_utils::filterByType<TensorView>(vals)) {
+    sizes.push_back(tensorSizes(tv, runtime_info));
+  }
+  return sizes;
+}
+
+//! Bytes read or written for `tv`. Expanded broadcasts are only read once.
+int64_t tensorBytes(TensorView* tv, SchedulerRuntimeInfo& runtime_info) {
+  int64_t numel = 1;
+  for (IterDomain* id : TensorDomain::noReductions(tv->getLogicalDomain())) {
+    if (id->isBroadcast()) {
+      continue;
+    }
+    auto extent = runtime_info.expressionEvaluator().evaluate(id->extent());
+    if (!extent.hasValue()) {
+      return 0;
+    }
+    numel *= extent.as<int64_t>();
+  }
+  return numel * dataTypeSize(tv->getDataType().value());
+}
+
+//! Fraction of the bandwidth of a well-occupied kernel reached by a persistent
+//! kernel, given the size of its persistent buffer
+double persistentEfficiency(
+    Fusion* segment,
+    SchedulerRuntimeInfo& runtime_info) {
+  auto buffers = scheduler_utils::persistentBuffers(segment);
+  if (buffers.persistent_buffers.empty()) {
+    return 1.0;
+  }
+  auto sizes =
+      scheduler_utils::persistentBufferSize(segment, runtime_info, buffers);
+  int64_t buffer_bytes = sizes.persistent_buffer_size;
+  if (sizes.projected_persistent_buffer_size > 0) {
+    buffer_bytes =
+        std::min(buffer_bytes, sizes.projected_persistent_buffer_size);
+  }
+  if (buffer_bytes <= 0) {
+    return 1.0;
+  }
+  const double resident_rows =
+      (double)scheduler_utils::register_file_size / (double)buffer_bytes;
+  return std::clamp(
+      resident_rows / (double)rows_for_full_bandwidth,
+      1.0 / (double)rows_for_full_bandwidth,
+      1.0);
+}
+
+bool isPersistent(ScheduleHeuristic heuristic) {
+  return heuristic == ScheduleHeuristic::InnerPersistent ||
+      heuristic == ScheduleHeuristic::OuterPersistent ||
+      heuristic == ScheduleHeuristic::InnerOuterPersistent;
+}
+
+thread_local SegmentationCostModel* guarded_model = nullptr;
+thread_local bool guarded_model_set = false;
+
+} // namespace
+
+double AnalyticCostModel::predictTimeUs(
+    Fusion* segment,
+    ScheduleHeuristic heuristic,
+    SchedulerRuntimeInfo& runtime_info) {
+  FUSER_PERF_SCOPE("AnalyticCostModel::predictTimeUs");
+  int64_t bytes = 0;
+  for (TensorView* tv :
+       ir_utils::filterByType<TensorView>(segment->inputs())) {
+    bytes += tensorBytes(tv, runtime_info);
+  }
+  for (TensorView* tv :
+       ir_utils::filterByType<TensorView>(segment->outputs())) {
+    bytes += tensorBytes(tv, runtime_info);
+  }
+
+  double efficiency = bandwidth_efficiency;
+  if (isPersistent(heuristic)) {
+    efficiency *= persistentEfficiency(segment, runtime_info);
+  }
+  // GB/s is 1e3 bytes per microsecond
+  const double bytes_per_us =
+      currentDevice().peak_bandwidth_gbs * 1.0e3 * efficiency;
+  if (bytes_per_us <= 0.0) {
+    return launch_overhead_us;
+  }
+  return launch_overhead_us + (double)bytes / bytes_per_us;
+}
+
+double ProfileGuidedCostModel::predictTimeUs(
+    Fusion* segment,
+    ScheduleHeuristic heuristic,
+    SchedulerRuntimeInfo& runtime_info) {
+  const uint64_t key = segmentCostKey(
+      segmentStructureHash(segment),
+      heuristic,
+      tensorSizes(segment->inputs(), runtime_info),
+      tensorSizes(segment->outputs(), runtime_info));
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto it = times_us_.find(key);
+    if (it != times_us_.end()) {
+      return it->second;
+    }
+  }
+  return AnalyticCostModel::predictTimeUs(segment, heuristic, runtime_info);
+}
+
+void ProfileGuidedCostModel::recordTimeUs(uint64_t key, double time_us) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  times_us_[key] = time_us;
+}
+
+size_t ProfileGuidedCostModel::size() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return times_us_.size();
+}
+
+uint64_t segmentStructureHash(Fusion* segment) {
+  std::vector<std::string> ops;
+  for (Expr* expr : segment->exprs()) {
+    const bool is_scalar_op = std::none_of(
+        expr->outputs().begin(), expr->outputs().end(), [](Val* out) {
+          return out->isA<TensorView>();
+        });
+    if (is_scalar_op || expr->isA<UnaryOp>() || expr->isA<LoadStoreOp>()) {
+      continue;
+    }
+    std::string op = expr->getOpString();
+    for (Val* out : expr->outputs()) {
+      op += "," + out->dtype().toString();
+    }
+    ops.push_back(std::move(op));
+  }
+  // The order of the exprs depends on the order of the segment outputs
+  std::sort(ops.begin(), ops.end());
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (const auto& op : ops) {
+    hashString(hash, op);
+  }
+  return hash;
+}
+
+uint64_t segmentCostKey(
+    uint64_t structure_hash,
+    ScheduleHeuristic heuristic,
+    std::vector<std::vector<int64_t>> input_sizes,
+    std::vector<std::vector<int64_t>> output_sizes) {
+  uint64_t hash = structure_hash;
+  hashString(hash, toString(heuristic));
+  // Forwarded inputs reorder the inputs of a segment
+  for (auto* sizes : {&input_sizes, &output_sizes}) {
+    std::sort(sizes->begin(), sizes->end());
+    for (const auto& tensor_sizes : *sizes) {
+      for (int64_t size : tensor_sizes) {
+        hashInt(hash, size);
+      }
+      hashInt(hash, -1);
+    }
+    hashInt(hash, -2);
+  }
+  return hash;
+}
+
+int64_t splitReductionPartials(
+    const ReductionParams& rparams,
+    int64_t iteration_numel,
+    int64_t reduction_numel,
+    int64_t input_bytes,
+    int64_t partial_dtype_size) {
+  FUSER_PERF_SCOPE("splitReductionPartials");
+  if (!rparams.cross_grid_inner_reduction &&
+      !rparams.cross_grid_outer_reduction) {
+    return 1;
+  }
+  const DeviceDescriptor& device = currentDevice();
+  const double bytes_per_us =
+      device.peak_bandwidth_gbs * 1.0e3 * bandwidth_efficiency;
+  if (bytes_per_us <= 0.0 || device.sm_count <= 0 || iteration_numel <= 0) {
+    return 1;
+  }
+
+  // Enough partial results for the partial reduction to fill the device
+  // without a grid reduction, each reducing enough elements to amortize its
+  // round trip through global memory
+  if (reduction_numel < 2 * min_split_reduction_numel) {
+    return 1;
+  }
+  const int64_t max_partials =
+      scheduler_utils::lastPow2(reduction_numel / min_split_reduction_numel);
+  const int64_t partials = std::clamp(
+      scheduler_utils::roundUpPow2(ceilDiv(
+          device.sm_count * split_reduction_rows_per_sm, iteration_numel)),
+      (int64_t)2,
+      max_partials);
+
+  int64_t grid_partials = 1;
+  for (ParallelType pt :
+       {rparams.grid_dim_inner_reduction, rparams.grid_dim_outer_reduction}) {
+    if (pt != ParallelType::Serial) {
+      grid_partials *= rparams.lparams.getDim(pt);
+    }
+  }
+  grid_partials = std::max(grid_partials, (int64_t)2);
+  const double grid_workspace_bytes =
+      (double)(iteration_numel * grid_partials * partial_dtype_size);
+
+  double grid_us = launch_overhead_us + (double)input_bytes / bytes_per_us;
+  if (rparams.atomic_grid_reduction) {
+    // Every block adds its partial results to the zero-filled outputs
+    grid_us += launch_overhead_us + grid_workspace_bytes / bytes_per_us;
+  } else {
+    // The partial results are written and read back, and the last block of
+    // each output reduces them alone at the bandwidth of one SM
+    int64_t outputs_per_block =
+        std::max(rparams.unroll_factor_iter_dom, (int64_t)1);
+    if (rparams.block_dim_iter_dom != ParallelType::Serial) {
+      outputs_per_block *= rparams.lparams.getDim(rparams.block_dim_iter_dom);
+    }
+    grid_us += 2.0 * grid_workspace_bytes / bytes_per_us +
+        (double)(grid_partials * outputs_per_block * partial_dtype_size) /
+            (bytes_per_us / (double)device.sm_count);
+    if (!isOptionEnabled(EnableOption::ReuseZeroedMemory)) {
+      // The semaphores are zero filled before every launch
+      grid_us += launch_overhead_us;
+    }
+  }
+
+  const double split_us = 2.0 * launch_overhead_us +
+      ((double)input_bytes +
+       2.0 * (double)(iteration_numel * partials * partial_dtype_size)) /
+          bytes_per_us;
+  return split_us < grid_us ? partials : 1;
+}
+
+SegmentationCostModel* getSegmentationCostModel() {
+  if (guarded_model_set) {
+    return guarded_model;
+  }
+  if (!isOptionEnabled(EnableOption::SegmentationCostModel)) {
+    return nullptr;
+  }
+  if (hasEnableOptionArgument(EnableOption::SegmentationCostModel, "profile")) {
+    static ProfileGuidedCostModel profile_guided_model;
+    return &profile_guided_model;
+  }
+  static AnalyticCostModel analytic_model;
+  return &analytic_model;
+}
+
+SegmentationCostModelGuard::SegmentationCostModelGuard(
+    SegmentationCostModel* model)
+    : prev_model_(guarded_model), prev_model_set_(guarded_model_set) {
+  guarded_model = model;
+  guarded_model_set = true;
+}
+
+SegmentationCostModelGuard::~SegmentationCostModelGuard() {
+  guarded_model = prev_model_;
+  guarded_model_set = prev_model_set_;
+}
+
+} // namespace nvfuser
@@ -0,0 +1,118 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#pragma once
+
+#include <fusion.h>
+#include <scheduler/heuristic_types.h>
+#include <visibility.h>
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace nvfuser {
+
+class ReductionParams;
+class SchedulerRuntimeInfo;
+
+//! Predicts the kernel time of segments, so that the segmenter can skip merges
+//! that are schedulable but slower than running the groups separately. See
+//! [ Note -- Segmentation cost model ] in segmentation_cost_model.cpp.
+class SegmentationCostModel {
+ public:
+  virtual ~SegmentationCostModel() = default;
+
+  //! Predicted kernel time in microseconds of `segment` scheduled with
+  //! `heuristic`. `segment` is the complete fusion restricted to a segment by
+  //! the segmenter, whose extents can be evaluated with `runtime_info`.
+  virtual double predictTimeUs(
+      Fusion* segment,
+      ScheduleHeuristic heuristic,
+      SchedulerRuntimeInfo& runtime_info) = 0;
+
+  //! Measured kernel time of the segment with the given segmentCostKey. The
+  //! default ignores it.
+  virtual void recordTimeUs(uint64_t key, double time_us) {}
+};
+
+//! Estimates the time of a segment from the bytes of its inputs and outputs,
+//! the bandwidth of the device, and for persistent kernels the number of rows
+//! whose persistent buffers fit on an SM.
+class NVF_API AnalyticCostModel : public SegmentationCostModel {
+ public:
+  double predictTimeUs(
+      Fusion* segment,
+      ScheduleHeuristic heuristic,
+      SchedulerRuntimeInfo& runtime_info) override;
+};
+
+//! Uses the kernel times fed back from FusionProfiler for segments that have
+//! been run before, and the analytic estimate for the other segments.
+class NVF_API ProfileGuidedCostModel : public AnalyticCostModel {
+ public:
+  double predictTimeUs(
+      Fusion* segment,
+      ScheduleHeuristic heuristic,
+      SchedulerRuntimeInfo& runtime_info) override;
+
+  void recordTimeUs(uint64_t key, double time_us) override;
+
+  //! Number of segments with a measured time
+  size_t size();
+
+ private:
+  std::mutex mutex_;
+  std::unordered_map<uint64_t, double> times_us_;
+};
+
+//! Hash of the operations of `segment`, ignoring unary ops and copies, so that
+//! it is the same for a candidate segment and the final segment, which also
+//! includes the forwarded unary ops of its inputs and the casts inserted by
+//! the segmenter.
+uint64_t segmentStructureHash(Fusion* segment);
+
+//! Key of a segment in ProfileGuidedCostModel. `input_sizes` and
+//! `output_sizes` are the logical sizes of its tensor inputs and outputs,
+//! without reduction dimensions.
+uint64_t segmentCostKey(
+    uint64_t structure_hash,
+    ScheduleHeuristic heuristic,
+    std::vector<std::vector<int64_t>> input_sizes,
+    std::vector<std::vector<int64_t>> output_sizes);
+
+//! Number of partial results per output with which a partial and a final
+//! reduction kernel are predicted to be faster than the cross-grid reduction
+//! `rparams`, or 1 if they are not. The reduction reads `input_bytes` and
+//! reduces `reduction_numel` elements for each of `iteration_numel` outputs
+//! into partial results of `partial_dtype_size` bytes.
+NVF_API int64_t splitReductionPartials(
+    const ReductionParams& rparams,
+    int64_t iteration_numel,
+    int64_t reduction_numel,
+    int64_t input_bytes,
+    int64_t partial_dtype_size);
+
+//! The cost model consulted by the segmenter, nullptr unless enabled with
+//! NVFUSER_ENABLE=segmentation_cost_model, or
+//! segmentation_cost_model(profile) for the profile-guided model, or set with
+//! SegmentationCostModelGuard.
+NVF_API SegmentationCostModel* getSegmentationCostModel();
+
+//! Replaces the cost model of the current thread while in scope
+class NVF_API SegmentationCostModelGuard {
+ public:
+  explicit SegmentationCostModelGuard(SegmentationCostModel* model);
+  ~SegmentationCostModelGuard();
+
+ private:
+  SegmentationCostModel* prev_model_;
+  bool prev_model_set_;
+};
+
+} // namespace nvfuser
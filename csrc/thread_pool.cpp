@@ -0,0 +1,251 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#include <thread_pool.h>
+
+#include <atomic>
+#include <utility>
+
+namespace nvfuser {
+
+// [ Note -- Thread pool ]
+//
+// c10::ThreadPool, which nvFuser used before, has a single FIFO queue and a
+// single waitWorkComplete() that returns once the whole pool is idle. That
+// does not work when several fusions compile concurrently: each caller waits
+// for the tasks of all the others, a task waiting for the pool from a worker
+// deadlocks, and warmup or autotuning compiles delay the compiles a run is
+// blocked on.
+//
+// Here, tasks are waited for through a TaskGroup, which counts its own tasks
+// only. TaskGroup::wait first runs the tasks of the group that no worker
+// started yet on the calling thread, so waiting from a worker, e.g. a
+// segment compile that compiles its autotuning candidates in parallel, makes
+// progress even when every worker is waiting. A task is claimed by an atomic
+// flag by whichever of its group or a worker runs it first; the other one
+// drops it.
+//
+// Tasks submitted from outside of the pool are queued per TaskPriority.
+// Tasks submitted by a worker, i.e. nested parallelism, go to the deque of
+// that worker, which runs them back to front while they are hot, and the idle
+// workers steal them front to back. A worker looks for work in that order:
+//   1. Latency tasks
+//   2. its own deque
+//   3. Normal, then Background tasks
+//   4. the deques of the other workers
+//
+// The pool has NVFUSER_NUM_THREADS workers, 8 by default, and can be resized
+// with ThreadPool::resize between compiles.
+
+struct ThreadPool::Task {
+  std::function<void()> fn;
+  TaskPriority priority = TaskPriority::Normal;
+  std::atomic<bool> claimed{false};
+
+  // Runs the task unless it was already claimed
+  void tryRun() {
+    if (!claimed.exchange(true)) {
+      fn();
+    }
+  }
+};
+
+namespace {
+
+// The worker running on this thread, if any
+thread_local ThreadPool* current_pool = nullptr;
+thread_local int64_t current_worker = -1;
+
+} // namespace
+
+ThreadPool::ThreadPool(int64_t num_threads) : queues_(3) {
+  startWorkers(num_threads);
+}
+
+ThreadPool::~ThreadPool() {
+  stopWorkers();
+}
+
+void ThreadPool::resize(int64_t num_threads) {
+  NVF_CHECK(
+      current_pool != this,
+      "The thread pool cannot be resized from one of its tasks");
+  stopWorkers();
+  startWorkers(num_threads);
+}
+
+void ThreadPool::startWorkers(int64_t num_threads) {
+  NVF_CHECK(num_threads > 0, "Invalid number of threads: ", num_threads);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = false;
+    local_queues_.resize(num_threads);
+  }
+  workers_.reserve(num_threads);
+  for (int64_t worker : c10::irange(num_threads)) {
+    workers_.emplace_back([this, worker]() { work(worker); });
+  }
+}
+
+void ThreadPool::stopWorkers() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  work_cv_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+  workers_.clear();
+
+  // Keep the tasks the workers did not start for the next workers
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& local_queue : local_queues_) {
+    for (auto& task : local_queue) {
+      queues_.at((size_t)task->priority).push_back(std::move(task));
+    }
+  }
+  local_queues_.clear();
+}
+
+void ThreadPool::submit(std::shared_ptr<Task> task) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (current_pool == this &&
+        current_worker < (int64_t)local_queues_.size()) {
+      local_queues_.at(current_worker).push_back(std::move(task));
+    } else {
+      queues_.at((size_t)task->priority).push_back(std::move(task));
+    }
+  }
+  work_cv_.notify_one();
+}
+
+std::shared_ptr<ThreadPool::Task> ThreadPool::pop(int64_t worker) {
+  // Takes the first unclaimed task from one end of `queue`, dropping the
+  // claimed ones on the way
+  auto take = [](std::deque<std::shared_ptr<Task>>& queue,
+                 bool back) -> std::shared_ptr<Task> {
+    while (!queue.empty()) {
+      std::shared_ptr<Task> task;
+      if (back) {
+        task = std::move(queue.back());
+        queue.pop_back();
+      } else {
+        task = std::move(queue.front());
+        queue.pop_front();
+      }
+      if (!task->claimed.load()) {
+        return task;
+      }
+    }
+    return nullptr;
+  };
+
+  if (auto task = take(queues_.at((size_t)TaskPriority::Latency), false)) {
+    return task;
+  }
+  if (auto task = take(local_queues_.at(worker), true)) {
+    return task;
+  }
+  for (auto priority : {TaskPriority::Normal, TaskPriority::Background}) {
+    if (auto task = take(queues_.at((size_t)priority), false)) {
+      return task;
+    }
+  }
+  const auto num_workers = (int64_t)local_queues_.size();
+  for (int64_t i : c10::irange(1, num_workers)) {
+    auto& victim = local_queues_.at((worker + i) % num_workers);
+    if (auto task = take(victim, false)) {
+      return task;
+    }
+  }
+  return nullptr;
+}
+
+void ThreadPool::work(int64_t worker) {
+  current_pool = this;
+  current_worker = worker;
+  while (true) {
+    std::shared_ptr<Task> task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      work_cv_.wait(
+          lock, [&]() { return stop_ || (task = pop(worker)) != nullptr; });
+      if (task == nullptr) {
+        break;
+      }
+    }
+    task->tryRun();
+  }
+  current_pool = nullptr;
+  current_worker = -1;
+}
+
+struct TaskGroup::State {
+  std::mutex mutex;
+  std::condition_variable done_cv;
+  int64_t num_unfinished = 0;
+  std::exception_ptr error;
+};
+
+TaskGroup::TaskGroup(TaskPriority priority, ThreadPool* pool)
+    : pool_(pool == nullptr ? getThreadPool() : pool),
+      priority_(priority),
+      state_(std::make_shared<State>()) {}
+
+TaskGroup::~TaskGroup() {
+  try {
+    wait();
+  } catch (...) {
+  }
+}
+
+void TaskGroup::run(std::function<void()> fn) {
+  {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    state_->num_unfinished++;
+  }
+  auto task = std::make_shared<ThreadPool::Task>();
+  task->priority = priority_;
+  task->fn = [state = state_, fn = std::move(fn)]() {
+    try {
+      fn();
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(state->mutex);
+      if (state->error == nullptr) {
+        state->error = std::current_exception();
+      }
+    }
+    std::lock_guard<std::mutex> lock(state->mutex);
+    if (--state->num_unfinished == 0) {
+      state->done_cv.notify_all();
+    }
+  };
+  tasks_.push_back(task);
+  pool_->submit(std::move(task));
+}
+
+void TaskGroup::wait() {
+  for (auto& task : tasks_) {
+    task->tryRun();
+  }
+  tasks_.clear();
+
+  std::unique_lock<std::mutex> lock(state_->mutex);
+  state_->done_cv.wait(lock, [&]() { return state_->num_unfinished == 0; });
+  if (state_->error != nullptr) {
+    std::rethrow_exception(std::exchange(state_->error, nullptr));
+  }
+}
+
+ThreadPool* getThreadPool() {
+  static ThreadPool pool(getNumThreads());
+  return &pool;
+}
+
+} // namespace nvfuser
@@ -0,0 +1,110 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#pragma once
+
+#include <exceptions.h>
+#include <utils.h>
+#include <visibility.h>
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace nvfuser {
+
+//! Priority of the tasks of a TaskGroup. Pending tasks of a higher priority
+//! are started first.
+enum class TaskPriority {
+  //! Work nobody waits for yet, e.g. warmup and autotuning
+  Background,
+  Normal,
+  //! Work a run is blocked on, e.g. compiling the kernels of new inputs
+  Latency
+};
+
+//! Work-stealing thread pool shared by parallel compilation and (de)
+//! serialization. Tasks are submitted and waited for through a TaskGroup, so
+//! that each caller only waits for its own tasks. See
+//! [ Note -- Thread pool ] in thread_pool.cpp.
+class ThreadPool : public NonCopyable {
+ public:
+  NVF_API explicit ThreadPool(int64_t num_threads);
+  NVF_API ~ThreadPool();
+
+  int64_t size() const {
+    return (int64_t)workers_.size();
+  }
+
+  //! Replace the workers by `num_threads` new ones once they finish their
+  //! current tasks. Pending tasks are kept.
+  NVF_API void resize(int64_t num_threads);
+
+ private:
+  friend class TaskGroup;
+  struct Task;
+
+  //! Queue `task` on the deque of the calling worker, or on the queue of its
+  //! priority if the caller is not a worker of this pool
+  void submit(std::shared_ptr<Task> task);
+
+  //! The next task for `worker` not claimed by a TaskGroup::wait, or nullptr.
+  //! Must be called with mutex_ held.
+  std::shared_ptr<Task> pop(int64_t worker);
+
+  void work(int64_t worker);
+  void startWorkers(int64_t num_threads);
+  void stopWorkers();
+
+  std::mutex mutex_;
+  std::condition_variable work_cv_;
+  bool stop_ = false;
+  //! Tasks submitted from outside of the pool, per TaskPriority
+  std::vector<std::deque<std::shared_ptr<Task>>> queues_;
+  //! Tasks submitted by each worker, run back to front by their worker and
+  //! stolen front to back by the others
+  std::vector<std::deque<std::shared_ptr<Task>>> local_queues_;
+  std::vector<std::thread> workers_;
+};
+
+//! Tasks submitted to a ThreadPool that are waited for together
+class TaskGroup : public NonCopyable {
+ public:
+  //! Tasks are run on `pool`, getThreadPool() by default
+  NVF_API explicit TaskGroup(
+      TaskPriority priority = TaskPriority::Normal,
+      ThreadPool* pool = nullptr);
+
+  //! Waits for the tasks of the group, ignoring their errors
+  NVF_API ~TaskGroup();
+
+  NVF_API void run(std::function<void()> fn);
+
+  //! Wait for the tasks of this group only. The tasks that did not start yet
+  //! are run on the calling thread, which may be a worker of the pool. The
+  //! first exception thrown by a task is rethrown.
+  NVF_API void wait();
+
+ private:
+  struct State;
+
+  ThreadPool* pool_ = nullptr;
+  TaskPriority priority_ = TaskPriority::Normal;
+  std::shared_ptr<State> state_;
+  //! Tasks submitted since the last wait
+  std::vector<std::shared_ptr<ThreadPool::Task>> tasks_;
+};
+
+//! The pool of NVFUSER_NUM_THREADS workers, 8 by default
+NVF_API ThreadPool* getThreadPool();
+
+} // namespace nvfuser
@@ -16,6 +16,9 @@
 #include <utils.h>
 
 #include <cstdint>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
 
 #include <driver_api.h>
 
@@ -104,6 +107,76 @@ inline CUtensorMapFloatOOBfill getCUtensorMapFloatOOBfill(
 
 using TensorMap = CUtensorMap;
 
+// Note [Caching tensor maps]
+//
+// kir::EncodeTensorMapTiled is evaluated at every launch, since the global
+// address of its tensor depends on the inputs of the kernel. Validating and
+// encoding a tensor map shows up in the host time of TMA kernels launched at
+// high rates, while the layout of the tensor, i.e., everything but its
+// address, rarely changes from one launch to the next. The encoded tensor maps
+// are therefore cached by their layout. A hit for another address is patched
+// with cuTensorMapReplaceAddress instead of being validated and encoded again.
+// The alignment of the new address is still checked. The cache is bounded by
+// dropping all its entries when it is full.
+struct TensorMapKeyHash {
+  size_t operator()(const std::vector<uint64_t>& key) const {
+    size_t hash = 0;
+    for (uint64_t value : key) {
+      hashCombine(hash, std::hash<uint64_t>()(value));
+    }
+    return hash;
+  }
+};
+
+struct CachedTensorMap {
+  void* global_address;
+  TensorMap tensor_map;
+};
+
+class TensorMapCache {
+ public:
+  static TensorMapCache& get() {
+    static TensorMapCache cache;
+    return cache;
+  }
+
+  std::optional<TensorMap> find(
+      const std::vector<uint64_t>& key,
+      void* global_address) {
+    CachedTensorMap cached;
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      auto it = maps_.find(key);
+      if (it == maps_.end()) {
+        return std::nullopt;
+      }
+      cached = it->second;
+    }
+    if (cached.global_address != global_address) {
+      NVFUSER_CUDA_SAFE_CALL(
+          cuTensorMapReplaceAddress(&cached.tensor_map, global_address));
+    }
+    return cached.tensor_map;
+  }
+
+  void insert(
+      std::vector<uint64_t> key,
+      void* global_address,
+      const TensorMap& tensor_map) {
+    constexpr size_t max_entries = 4096;
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (maps_.size() >= max_entries) {
+      maps_.clear();
+    }
+    maps_[std::move(key)] = {global_address, tensor_map};
+  }
+
+ private:
+  std::mutex mutex_;
+  std::unordered_map<std::vector<uint64_t>, CachedTensorMap, TensorMapKeyHash>
+      maps_;
+};
+
 #else
 
 // Placeholder for CUDA 11 to make build pass
@@ -290,6 +363,24 @@ std::vector<PolymorphicValue> kir::EncodeTensorMapTiled::evaluate(
         interleave);
   }
 
+  // See Note [Caching tensor maps]
+  std::vector<uint64_t> cache_key{
+      (uint64_t)data_type,
+      (uint64_t)tensor_rank,
+      (uint64_t)interleave,
+      (uint64_t)swizzle,
+      (uint64_t)l2_promotion,
+      (uint64_t)oob_fill};
+  cache_key.insert(cache_key.end(), global_dim.begin(), global_dim.end());
+  cache_key.insert(
+      cache_key.end(), global_strides.begin(), global_strides.end());
+  cache_key.insert(cache_key.end(), box_dim.begin(), box_dim.end());
+  cache_key.insert(
+      cache_key.end(), element_strides.begin(), element_strides.end());
+  if (auto cached = TensorMapCache::get().find(cache_key, global_address)) {
+    return {Opaque{cached.value()}};
+  }
+
   for (auto global_dim_val : global_dim) {
     constexpr cuuint64_t max_size = (cuuint64_t)1 << 32;
     NVF_ERROR(
@@ -441,6 +532,8 @@ std::vector<PolymorphicValue> kir::EncodeTensorMapTiled::evaluate(
       swizzle,
       l2_promotion,
       oob_fill));
+  TensorMapCache::get().insert(
+      std::move(cache_key), global_address, tensor_map);
 
   return {Opaque{tensor_map}};
 #else
@@ -133,6 +133,13 @@ bool isInclusiveType(const DataType& base_type, const DataType& wider_type) {
       base_type == DataType::Int32) {
     return true;
   }
+  if ((wider_type == DataType::Int || wider_type == DataType::Int32 ||
+       wider_type == DataType::Double || wider_type == DataType::Float ||
+       wider_type == DataType::Half || wider_type == DataType::BFloat16 ||
+       isComplexType(wider_type)) &&
+      base_type == DataType::Int8) {
+    return true;
+  }
   if (wider_type == DataType::ComplexDouble &&
       base_type == DataType::ComplexFloat) {
     return true;
@@ -236,6 +243,8 @@ static std::string data_type2string(DataType t) {
               return "nvfuser_index_t";
             case DataType::Int32:
               return "int";
+            case DataType::Int8:
+              return "int8_t";
             case DataType::UInt:
               return "uint64_t";
             case DataType::UInt32:
@@ -862,6 +871,7 @@ static const char* supported_casts2string(std::pair<DataType, DataType> t) {
     case supported_switch_pair(DataType::Index, DataType::Float):
     case supported_switch_pair(DataType::Int, DataType::Float):
     case supported_switch_pair(DataType::Int32, DataType::Float):
+    case supported_switch_pair(DataType::Int8, DataType::Float):
     case supported_switch_pair(DataType::UInt, DataType::Float):
     case supported_switch_pair(DataType::UInt32, DataType::Float):
     case supported_switch_pair(DataType::Double, DataType::Float):
@@ -872,6 +882,7 @@ static const char* supported_casts2string(std::pair<DataType, DataType> t) {
       return "(float)std::real";
     case supported_switch_pair(DataType::Index, DataType::Int):
     case supported_switch_pair(DataType::Int32, DataType::Int):
+    case supported_switch_pair(DataType::Int8, DataType::Int):
     case supported_switch_pair(DataType::UInt, DataType::Int):
     case supported_switch_pair(DataType::UInt32, DataType::Int):
     case supported_switch_pair(DataType::Float, DataType::Int):
@@ -888,10 +899,18 @@ static const char* supported_casts2string(std::pair<DataType, DataType> t) {
     case supported_switch_pair(DataType::Float, DataType::Int32):
     case supported_switch_pair(DataType::Double, DataType::Int32):
     case supported_switch_pair(DataType::Bool, DataType::Int32):
+    case supported_switch_pair(DataType::Int8, DataType::Int32):
       return "(int32_t)";
     case supported_switch_pair(DataType::ComplexFloat, DataType::Int32):
     case supported_switch_pair(DataType::ComplexDouble, DataType::Int32):
       return "(int32_t)std::real";
+    case supported_switch_pair(DataType::Index, DataType::Int8):
+    case supported_switch_pair(DataType::Int, DataType::Int8):
+    case supported_switch_pair(DataType::Int32, DataType::Int8):
+    case supported_switch_pair(DataType::Float, DataType::Int8):
+    case supported_switch_pair(DataType::Double, DataType::Int8):
+    case supported_switch_pair(DataType::Bool, DataType::Int8):
+      return "(int8_t)";
     case supported_switch_pair(DataType::Index, DataType::UInt):
     case supported_switch_pair(DataType::Int, DataType::UInt):
     case supported_switch_pair(DataType::Int32, DataType::UInt):
@@ -916,6 +935,7 @@ static const char* supported_casts2string(std::pair<DataType, DataType> t) {
       return "(uint32_t)std::real";
     case supported_switch_pair(DataType::Int, DataType::Index):
     case supported_switch_pair(DataType::Int32, DataType::Index):
+    case supported_switch_pair(DataType::Int8, DataType::Index):
     case supported_switch_pair(DataType::UInt, DataType::Index):
     case supported_switch_pair(DataType::UInt32, DataType::Index):
     case supported_switch_pair(DataType::Float, DataType::Index):
@@ -928,6 +948,7 @@ static const char* supported_casts2string(std::pair<DataType, DataType> t) {
     case supported_switch_pair(DataType::Index, DataType::Double):
     case supported_switch_pair(DataType::Int, DataType::Double):
     case supported_switch_pair(DataType::Int32, DataType::Double):
+    case supported_switch_pair(DataType::Int8, DataType::Double):
     case supported_switch_pair(DataType::UInt, DataType::Double):
     case supported_switch_pair(DataType::UInt32, DataType::Double):
     case supported_switch_pair(DataType::Float, DataType::Double):
@@ -941,6 +962,7 @@ static const char* supported_casts2string(std::pair<DataType, DataType> t) {
     case supported_switch_pair(DataType::Index, DataType::Bool):
     case supported_switch_pair(DataType::Int, DataType::Bool):
     case supported_switch_pair(DataType::Int32, DataType::Bool):
+    case supported_switch_pair(DataType::Int8, DataType::Bool):
     case supported_switch_pair(DataType::UInt, DataType::Bool):
     case supported_switch_pair(DataType::UInt32, DataType::Bool):
       return "(bool)";
@@ -950,6 +972,7 @@ static const char* supported_casts2string(std::pair<DataType, DataType> t) {
     case supported_switch_pair(DataType::Index, DataType::ComplexDouble):
     case supported_switch_pair(DataType::Int, DataType::ComplexDouble):
     case supported_switch_pair(DataType::Int32, DataType::ComplexDouble):
+    case supported_switch_pair(DataType::Int8, DataType::ComplexDouble):
     case supported_switch_pair(DataType::UInt, DataType::ComplexDouble):
     case supported_switch_pair(DataType::UInt32, DataType::ComplexDouble):
     case supported_switch_pair(DataType::Double, DataType::ComplexDouble):
@@ -960,6 +983,7 @@ static const char* supported_casts2string(std::pair<DataType, DataType> t) {
     case supported_switch_pair(DataType::Index, DataType::ComplexFloat):
     case supported_switch_pair(DataType::Int, DataType::ComplexFloat):
     case supported_switch_pair(DataType::Int32, DataType::ComplexFloat):
+    case supported_switch_pair(DataType::Int8, DataType::ComplexFloat):
     case supported_switch_pair(DataType::UInt, DataType::ComplexFloat):
     case supported_switch_pair(DataType::UInt32, DataType::ComplexFloat):
     case supported_switch_pair(DataType::Double, DataType::ComplexFloat):
@@ -974,6 +998,7 @@ static const char* supported_casts2string(std::pair<DataType, DataType> t) {
       return "__double2half";
     case supported_switch_pair(DataType::Int, DataType::Half):
     case supported_switch_pair(DataType::Int32, DataType::Half):
+    case supported_switch_pair(DataType::Int8, DataType::Half):
     case supported_switch_pair(DataType::UInt, DataType::Half):
     case supported_switch_pair(DataType::UInt32, DataType::Half):
     case supported_switch_pair(DataType::Index, DataType::Half):
@@ -1013,6 +1038,7 @@ static const char* supported_casts2string(std::pair<DataType, DataType> t) {
       return "__half2bfloat";
     case supported_switch_pair(DataType::Int, DataType::BFloat16):
     case supported_switch_pair(DataType::Int32, DataType::BFloat16):
+    case supported_switch_pair(DataType::Int8, DataType::BFloat16):
     case supported_switch_pair(DataType::UInt, DataType::BFloat16):
     case supported_switch_pair(DataType::UInt32, DataType::BFloat16):
     case supported_switch_pair(DataType::Index, DataType::BFloat16):
@@ -1105,6 +1131,8 @@ DataType aten_to_data_type(const at::ScalarType& scalar_type) {
       return DataType::Int;
     case at::ScalarType::Int:
       return DataType::Int32;
+    case at::ScalarType::Char:
+      return DataType::Int8;
     case at::ScalarType::ComplexFloat:
       return DataType::ComplexFloat;
     case at::ScalarType::ComplexDouble:
@@ -1141,6 +1169,8 @@ at::ScalarType data_type_to_aten(const DataType& data_type) {
           "There's also this information in FusionExecutorCache and the Registry system.");
     case DataType::Int32:
       return at::ScalarType::Int;
+    case DataType::Int8:
+      return at::ScalarType::Char;
     case DataType::ComplexFloat:
       return at::ScalarType::ComplexFloat;
     case DataType::ComplexDouble:
@@ -1261,6 +1291,24 @@ std::ostream& operator<<(std::ostream& os, const SwizzleMode& swizzle) {
   return os;
 }
 
+std::ostream& operator<<(std::ostream& os, const WelfordMode& mode) {
+  switch (mode) {
+    case WelfordMode::Default:
+      os << "Default";
+      break;
+    case WelfordMode::Fast:
+      os << "Fast";
+      break;
+    case WelfordMode::Compensated:
+      os << "Compensated";
+      break;
+    default:
+      NVF_ERROR(false, "undefined welford mode");
+      break;
+  }
+  return os;
+}
+
 std::ostream& operator<<(std::ostream& os, const KernelIndexMode& index_mode) {
   switch (index_mode) {
     case KernelIndexMode::INT32:
@@ -1366,6 +1414,7 @@ std::string typePrefix(const DataType data_type) {
     case DataType::Index:
     case DataType::Int:
     case DataType::Int32:
+    case DataType::Int8:
     case DataType::UInt:
     case DataType::UInt32:
     case DataType::SMemAddress:
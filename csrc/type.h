@@ -72,6 +72,7 @@ enum class PrimDataType {
   // Integral types
   Int,
   Int32,
+  Int8,
   UInt,
   UInt32,
   Index,
@@ -179,6 +180,7 @@ struct DataType {
   static constexpr PrimDataType Int = PrimDataType::Int;
   static constexpr PrimDataType Index = PrimDataType::Index;
   static constexpr PrimDataType Int32 = PrimDataType::Int32;
+  static constexpr PrimDataType Int8 = PrimDataType::Int8;
   static constexpr PrimDataType UInt = PrimDataType::UInt;
   static constexpr PrimDataType UInt32 = PrimDataType::UInt32;
   static constexpr PrimDataType Bool = PrimDataType::Bool;
@@ -262,6 +264,7 @@ inline bool isIntegralType(DataType dtype) {
             case DataType::Index:
             case DataType::Int:
             case DataType::Int32:
+            case DataType::Int8:
             case DataType::UInt:
             case DataType::UInt32:
               return true;
@@ -391,6 +394,10 @@ DEFINE_DATATYPE_TO_ATEN_AND_NATIVE_TYPE(
     DataType::Int32,
     at::ScalarType::Int,
     int);
+DEFINE_DATATYPE_TO_ATEN_AND_NATIVE_TYPE(
+    DataType::Int8,
+    at::ScalarType::Char,
+    int8_t);
 DEFINE_DATATYPE_TO_NATIVE_TYPE(DataType::UInt, uint64_t);
 DEFINE_DATATYPE_TO_NATIVE_TYPE(DataType::UInt32, uint32_t);
 DEFINE_DATATYPE_TO_ATEN_AND_NATIVE_TYPE(
@@ -773,6 +780,13 @@ enum class Swizzle2DType { NoSwizzle = 0, ZShape, XOR, CyclicShift };
 //! Modes of swizzle, see [Note on swizzle mode].
 enum class SwizzleMode { NoSwizzle = 0, Data, Loop };
 
+//! How the serial part of a WelfordOp is computed, see Note [Welford modes]
+//! in scheduler/reduction_utils.cpp.
+//!  Default: welfordCombine, one division per update.
+//!  Fast: accumulate sum and sum of squares, no division per update.
+//!  Compensated: welfordCombine with Kahan-compensated avg and var.
+enum class WelfordMode { Default, Fast, Compensated };
+
 // Returns if function needs an f suffix on the operator when operating on a
 // float value i.e. sin->sinf
 bool needFloatSuffix(UnaryOpType t);
@@ -792,6 +806,7 @@ ValType promoteType(const ValType& t1, const ValType& t2);
   HANDLE_TYPE_PROMOTION(Type1, double);              \
   HANDLE_TYPE_PROMOTION(Type1, int64_t);             \
   HANDLE_TYPE_PROMOTION(Type1, int);                 \
+  HANDLE_TYPE_PROMOTION(Type1, int8_t);              \
   HANDLE_TYPE_PROMOTION(Type1, bool);                \
   HANDLE_TYPE_PROMOTION(Type1, std::complex<float>); \
   HANDLE_TYPE_PROMOTION(Type1, std::complex<double>)
@@ -832,6 +847,7 @@ inline DataType promoteType(const DataType& t1, const DataType& t2) {
   HANDLE_TYPE_PROMOTION1(double);
   HANDLE_TYPE_PROMOTION1(int64_t);
   HANDLE_TYPE_PROMOTION1(int);
+  HANDLE_TYPE_PROMOTION1(int8_t);
   HANDLE_TYPE_PROMOTION1(bool);
   HANDLE_TYPE_PROMOTION1(std::complex<float>);
   HANDLE_TYPE_PROMOTION1(std::complex<double>);
@@ -906,6 +922,7 @@ std::ostream& operator<<(std::ostream&, const SwizzleType&);
 std::ostream& operator<<(std::ostream&, const Swizzle2DType&);
 std::ostream& operator<<(std::ostream&, const SwizzleMode&);
 std::ostream& operator<<(std::ostream&, const KernelIndexMode&);
+NVF_API std::ostream& operator<<(std::ostream&, const WelfordMode&);
 NVF_API std::ostream& operator<<(std::ostream&, const CacheOp&);
 std::ostream& operator<<(std::ostream& os, const std::optional<bool>&);
 
@@ -962,6 +979,8 @@ constexpr inline size_t primDataTypeSize(PrimDataType type) {
       return sizeof(int64_t);
     case DataType::Int32:
       return sizeof(int32_t);
+    case DataType::Int8:
+      return sizeof(int8_t);
     case DataType::UInt:
       return sizeof(uint64_t);
     case DataType::UInt32:
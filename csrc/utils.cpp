@@ -30,13 +30,6 @@ int getNumThreads() {
   return std::max(std::min(num_threads_value, max_num_threads), 1);
 }
 
-// TODO: clean this up with some knobs
-c10::ThreadPool* getThreadPool() {
-  static auto num_threads = getNumThreads();
-  static c10::ThreadPool pool(num_threads);
-  return &pool;
-}
-
 C10_DIAGNOSTIC_PUSH_AND_IGNORED_IF_DEFINED("-Wunused-function")
 void debugPrint(const c10::TensorTypePtr& type) {
   std::stringstream sizes_s;
@@ -18,7 +18,6 @@
 #include <tma.h>
 #include <type.h>
 
-#include <c10/core/thread_pool.h>
 #include <deque>
 #include <memory>
 #include <optional>
@@ -50,7 +49,6 @@
 namespace nvfuser {
 
 int getNumThreads();
-c10::ThreadPool* getThreadPool();
 
 void debugPrint(const c10::TensorTypePtr& type);
 
@@ -0,0 +1,59 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#include <heuristic_plugin_api.h>
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+
+using namespace nvfuser::heuristic_plugin;
+
+// This example heuristic prints the problem description, then lowers the
+// unroll factors picked by nvFuser for small problems and keeps everything
+// else as is.
+struct MyHeuristicConfig : HeuristicConfig {
+  void configure() final {
+    std::cout << "Using example heuristic for problem: ";
+    std::cout << "heuristic=" << (int)problem.heuristic << " ";
+    std::cout << "sizes=[";
+    for (int64_t i = 0; i < problem.num_dims; ++i) {
+      std::cout << (i > 0 ? ", " : "") << problem.sizes[i];
+    }
+    std::cout << "] ";
+    std::cout << "reduction_dims=" << (int)problem.reduction_dims << " ";
+    std::cout << "max_dtype_size=" << (int)problem.max_dtype_size << " ";
+    std::cout << "sm=" << (int)problem.device_major << (int)problem.device_minor
+              << std::endl;
+
+    const bool small =
+        problem.total_iteration_numel * problem.total_reduction_numel <
+        (1 << 16);
+    switch (problem.heuristic) {
+      case Heuristic::PointWise:
+        if (small && !pointwise.vectorize) {
+          pointwise.unroll_factor = 1;
+        }
+        break;
+      case Heuristic::Reduction:
+        if (small && !reduction.vectorize_iter_dom) {
+          reduction.unroll_factor_iter_dom = 1;
+        }
+        break;
+      default:
+        break;
+    }
+  };
+
+  ~MyHeuristicConfig() {
+    std::cout << "~MyHeuristicConfig" << std::endl;
+  }
+};
+
+extern "C" std::unique_ptr<HeuristicConfig> makeHeuristicConfig() {
+  return std::unique_ptr<HeuristicConfig>(new MyHeuristicConfig);
+}
@@ -0,0 +1 @@
+../../csrc/scheduler/heuristic_plugin_api.h
\ No newline at end of file
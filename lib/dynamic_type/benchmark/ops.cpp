@@ -0,0 +1,122 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+
+#include <benchmark/benchmark.h>
+
+#include <dynamic_type/dynamic_type.h>
+
+#include <array>
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+using namespace dynamic_type;
+
+// Measures the cost of constructing, copying and dispatching binary operators
+// on dynamic types holding integers. A dynamic type is as large as its largest
+// member type, so `Scalars` and `ScalarsAndLarge` only differ in size, which
+// is reported by the "size" counter. `Scalars` has the layout of nvFuser's
+// PolymorphicValue, whose largest member types are as large as std::vector.
+
+struct Large {
+  std::array<std::byte, 88> bytes;
+};
+
+using Scalars = DynamicType<
+    Containers<std::vector>,
+    int64_t,
+    double,
+    bool,
+    std::complex<double>,
+    float*>;
+
+using ScalarsAndLarge = DynamicType<
+    Containers<std::vector>,
+    int64_t,
+    double,
+    bool,
+    std::complex<double>,
+    float*,
+    Large>;
+
+constexpr int64_t kNumValues = 100000;
+
+template <typename DT>
+void BenchmarkConstruct(benchmark::State& state) {
+  for (auto _ : state) {
+    std::vector<DT> values;
+    values.reserve(kNumValues);
+    for (int64_t i = 0; i < kNumValues; ++i) {
+      values.emplace_back(i);
+    }
+    benchmark::DoNotOptimize(values.data());
+  }
+  state.counters["size"] = sizeof(DT);
+}
+
+template <typename DT>
+void BenchmarkCopy(benchmark::State& state) {
+  std::vector<DT> values;
+  values.reserve(kNumValues);
+  for (int64_t i = 0; i < kNumValues; ++i) {
+    values.emplace_back(i);
+  }
+  for (auto _ : state) {
+    std::vector<DT> values_copy(values);
+    benchmark::DoNotOptimize(values_copy.data());
+  }
+  state.counters["size"] = sizeof(DT);
+}
+
+template <typename DT>
+void BenchmarkDispatch(benchmark::State& state) {
+  std::vector<DT> values;
+  values.reserve(kNumValues);
+  for (int64_t i = 0; i < kNumValues; ++i) {
+    values.emplace_back(i);
+  }
+  for (auto _ : state) {
+    DT sum = int64_t(0);
+    for (const auto& value : values) {
+      sum = sum + value * value;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.counters["size"] = sizeof(DT);
+}
+
+static void Construct_Scalars(benchmark::State& state) {
+  BenchmarkConstruct<Scalars>(state);
+}
+
+static void Construct_ScalarsAndLarge(benchmark::State& state) {
+  BenchmarkConstruct<ScalarsAndLarge>(state);
+}
+
+static void Copy_Scalars(benchmark::State& state) {
+  BenchmarkCopy<Scalars>(state);
+}
+
+static void Copy_ScalarsAndLarge(benchmark::State& state) {
+  BenchmarkCopy<ScalarsAndLarge>(state);
+}
+
+static void Dispatch_Scalars(benchmark::State& state) {
+  BenchmarkDispatch<Scalars>(state);
+}
+
+static void Dispatch_ScalarsAndLarge(benchmark::State& state) {
+  BenchmarkDispatch<ScalarsAndLarge>(state);
+}
+
+BENCHMARK(Construct_Scalars)->Unit(benchmark::kMicrosecond);
+BENCHMARK(Construct_ScalarsAndLarge)->Unit(benchmark::kMicrosecond);
+BENCHMARK(Copy_Scalars)->Unit(benchmark::kMicrosecond);
+BENCHMARK(Copy_ScalarsAndLarge)->Unit(benchmark::kMicrosecond);
+BENCHMARK(Dispatch_Scalars)->Unit(benchmark::kMicrosecond);
+BENCHMARK(Dispatch_ScalarsAndLarge)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,43 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#include "dynamic_type/dynamic_type.h"
+
+#include <complex>
+#include <vector>
+
+using namespace dynamic_type;
+
+// A dynamic type with the member types of nvFuser's PolymorphicValue that
+// don't depend on nvFuser or PyTorch
+using DT = DynamicType<
+    Containers<std::vector>,
+    std::complex<double>,
+    double,
+    int64_t,
+    bool,
+    int*,
+    float*>;
+
+#if USE_OPERATORS
+DT f(const DT& a, const DT& b) {
+  DT c = a + b;
+  DT d = c * a - b;
+  if (d == a || d < b) {
+    return -d;
+  }
+  return !c;
+}
+#else
+DT f(const DT& a, const DT& b) {
+  return a;
+}
+#endif
+
+int main() {
+  f(DT(1L), DT(2.0));
+}
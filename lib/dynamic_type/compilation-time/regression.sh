@@ -0,0 +1,33 @@
+#!/bin/bash
+
+# SPDX-FileCopyrightText: Copyright (c) 2024-present NVIDIA CORPORATION & AFFILIATES.
+# All rights reserved.
+# SPDX-License-Identifier: BSD-3-Clause
+
+# Measures how long it takes to compile the few operators of operators.cpp on
+# a dynamic type shaped like PolymorphicValue, on top of including the header,
+# and fails if it takes longer than MAX_SECONDS (default: 10).
+#
+# Usage: ./regression.sh [compiler]
+
+CXX=${1:-g++}
+MAX_SECONDS=${MAX_SECONDS:-10}
+
+compile_time() {
+    local start end
+    start=$(date +%s%N)
+    $CXX operators.cpp -DUSE_OPERATORS=$1 -I../src/ -std=c++20 -O3 -o operators.exe || exit 1
+    end=$(date +%s%N)
+    echo $(((end - start) / 1000000))
+}
+
+without=$(compile_time 0)
+with=$(compile_time 1)
+rm -f operators.exe
+overhead=$((with - without))
+echo "Including dynamic_type.h: ${without} ms"
+echo "Compiling the operators: ${overhead} ms"
+if [ $overhead -gt $((MAX_SECONDS * 1000)) ]; then
+    echo "Compiling the operators takes longer than ${MAX_SECONDS} s"
+    exit 1
+fi
@@ -373,31 +373,26 @@ struct Void {};
 //  0.2
 
 template <typename... Ts>
-struct ForAllTypes;
-
-template <typename T, typename... Ts>
-struct ForAllTypes<T, Ts...> {
+struct ForAllTypes {
   template <typename Fun>
   constexpr auto operator()(Fun f) const {
-    using RetT = decltype(f(std::type_identity<T>{}));
-    if constexpr (std::is_void_v<RetT>) {
+    // The elements of a braced initializer list are evaluated in order, so f
+    // is called on Ts from left to right.
+    return std::tuple<decltype(call<Ts>(f))...>{call<Ts>(f)...};
+  }
+
+ private:
+  template <typename T, typename Fun>
+  static constexpr auto call(Fun& f) {
+    if constexpr (std::is_void_v<decltype(f(std::type_identity<T>{}))>) {
       f(std::type_identity<T>{});
-      return std::tuple_cat(std::tuple<Void>{}, ForAllTypes<Ts...>{}(f));
+      return Void{};
     } else {
-      return std::tuple_cat(
-          std::make_tuple(f(std::type_identity<T>{})), ForAllTypes<Ts...>{}(f));
+      return f(std::type_identity<T>{});
     }
   }
 };
 
-template <>
-struct ForAllTypes<> {
-  template <typename Fun>
-  constexpr auto operator()(Fun f) const {
-    return std::tuple<>{};
-  }
-};
-
 } // namespace dynamic_type
 
 namespace dynamic_type {
@@ -453,28 +448,29 @@ namespace dynamic_type {
 // Remove all the voids from a tuple. For example:
 // (Void, T1, Void, T2, Void, T3, ...) -> (T1, T2, T3, ...)
 
-template <typename... Ts>
-constexpr auto remove_void_from_tuple([[maybe_unused]] std::tuple<Ts...> t) {
-  if constexpr (sizeof...(Ts) == 0) {
+namespace remove_void_from_tuple_impl {
+
+template <typename T>
+constexpr auto tuple_or_empty(T item) {
+  if constexpr (std::is_same_v<T, Void>) {
     return std::tuple<>{};
   } else {
-    auto [head, others] = std::apply(
-        [](auto head, auto... tail) {
-          return std::make_tuple(
-              std::make_tuple(head), std::make_tuple(tail...));
-        },
-        t);
-    auto proccessed_others = remove_void_from_tuple(others);
-    if constexpr (std::is_same_v<
-                      std::tuple_element_t<0, decltype(head)>,
-                      Void>) {
-      return proccessed_others;
-    } else {
-      return std::tuple_cat(head, proccessed_others);
-    }
+    return std::tuple<T>{std::move(item)};
   }
 }
 
+} // namespace remove_void_from_tuple_impl
+
+template <typename... Ts>
+constexpr auto remove_void_from_tuple([[maybe_unused]] std::tuple<Ts...> t) {
+  return std::apply(
+      [](auto... items) constexpr {
+        return std::tuple_cat(
+            remove_void_from_tuple_impl::tuple_or_empty(std::move(items))...);
+      },
+      std::move(t));
+}
+
 // For example:
 static_assert(
     remove_void_from_tuple(
@@ -485,34 +481,11 @@ static_assert(
 
 namespace dynamic_type {
 
-namespace belongs_to_impl {
-
-// Given a tuple of Ts, return a tuple with the same size as Ts. The tuple
-// contains either true or void. (true if T is the same as the corresponding
-// type in Ts, void otherwise). For example, if T = int, Ts is (int, float,
-// bool), then the return type is (true, void, void).
-template <typename T, typename... Ts>
-auto get_match_tuple() {
-  auto true_or_void = [](auto x) {
-    using U = typename decltype(x)::type;
-    if constexpr (std::is_same_v<T, U>) {
-      return true;
-    } else {
-      return;
-    }
-  };
-  return ForAllTypes<Ts...>{}(true_or_void);
-}
-
-} // namespace belongs_to_impl
-
 // Check if T belongs to the given type list Ts. For example
 // belongs_to<int, int, float, bool> is true, but
 // belongs_to<int, float, bool> is false.
 template <typename T, typename... Ts>
-constexpr bool belongs_to =
-    (std::tuple_size_v<decltype(remove_void_from_tuple(
-         belongs_to_impl::get_match_tuple<T, Ts...>()))> > 0);
+constexpr bool belongs_to = (std::is_same_v<T, Ts> || ...);
 
 // For example:
 
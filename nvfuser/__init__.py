@@ -144,6 +144,7 @@ class FusionDefinition(_C._FusionDefinition):
         override_user_schedule=False,
         capture_debug_output=False,
         profile=False,
+        outputs=None,
     ):
         """
         Executes an nvFuser set of kernels for a given Fusion
@@ -182,12 +183,76 @@ class FusionDefinition(_C._FusionDefinition):
                 debugging information as a string. If True, the string can be
                 retrieved after execution using :meth:`get_debug_output`. If False,
                 then that method will return None when called.
+            outputs (Optional[List[Optional[Tensor]]]): Tensors to write the
+                outputs of the Fusion to, one for each output. They must have
+                the dtype, shape and strides nvFuser would have allocated the
+                outputs with, and be on the device the Fusion runs on. A None
+                entry is allocated as usual. The returned list holds the given
+                tensors. (default: None)
 
         Returns:
             List[Tensor]
         """
         self.profiled = profile
+        device = self._prepare_execution(inputs, device)
 
+        result = None
+        try:
+            result = self._execute(
+                inputs,
+                device=device,
+                override_user_schedule=override_user_schedule,
+                capture_debug_output=capture_debug_output,
+                profile=profile,
+                outputs=[] if outputs is None else outputs,
+            )
+        except Exception as err:
+            logger.exception(self.getReproErrorString("executing", inputs))
+            raise
+
+        return result
+
+    def execute_async(
+        self,
+        inputs,
+        *,
+        device=None,
+        override_user_schedule=False,
+        outputs=None,
+    ):
+        """
+        Starts executing the Fusion and returns without waiting for it
+
+        The input id lookup, the argument packing and any compilation run on
+        nvFuser's thread pool, and the kernels are enqueued on the current
+        CUDA stream at the time of the call, so that the host work of
+        independent fusions overlaps with each other and with the GPU. Until
+        the execution finishes, the FusionDefinition and the inputs must not
+        be modified. Executions with a user defined schedule run before
+        returning. The arguments are the same as those of :meth:`execute`.
+
+        Returns:
+            AsyncExecution: whose `result()` waits for the host work and
+            returns the List[Tensor] :meth:`execute` would have, and whose
+            `done()` tells whether `result()` would return right away
+        """
+        device = self._prepare_execution(inputs, device)
+        try:
+            return self._execute_async(
+                inputs,
+                device=device,
+                override_user_schedule=override_user_schedule,
+                outputs=[] if outputs is None else outputs,
+            )
+        except Exception as err:
+            logger.exception(self.getReproErrorString("executing", inputs))
+            raise
+
+    def _prepare_execution(self, inputs, device):
+        """
+        Builds the definition and the user schedule of a child class if needed
+        and returns the index of `device`
+        """
         if device is not None:
             if not isinstance(device, torch.device):
                 device = torch.device(device)
@@ -215,21 +280,77 @@ class FusionDefinition(_C._FusionDefinition):
             self._setup_schedule(inputs)
             self.schedule()
             self._finalize_schedule(inputs)
+        return device
 
-        result = None
-        try:
-            result = self._execute(
-                inputs,
-                device=device,
-                override_user_schedule=override_user_schedule,
-                capture_debug_output=capture_debug_output,
-                profile=profile,
-            )
-        except Exception as err:
-            logger.exception(self.getReproErrorString("executing", inputs))
-            raise
+    def warmup(self, input_sets, *, device=None):
+        """
+        Compiles the Fusion ahead of time for a declared set of input shapes
 
-        return result
+        Segmentation, scheduling and kernel compilation happen as they would
+        on the first execution of each input set, with the kernels of
+        different input sets compiled in parallel. Tensors only need to
+        describe the inputs, so meta tensors, e.g.
+        `torch.empty(shape, device="meta")`, can be used in place of real
+        CUDA tensors. The compiled kernels can then be saved with
+        `nvfuser.serialize()`.
+
+        Args:
+            input_sets (List[List[Union[Tensor, Scalar]]]): Lists of inputs
+                to the fusion, one per shape to compile for.
+
+        Kwargs:
+            device (Optional[Union[int, str, torch.device]]): The CUDA device
+                to compile for (default: 0)
+        """
+        if device is None:
+            device = 0
+        elif not isinstance(device, int):
+            if not isinstance(device, torch.device):
+                device = torch.device(device)
+            assert (
+                device.type == "cuda"
+            ), "If device argument is passed it must be a CUDA device"
+            device = device.index
+
+        # if definition is not defined by a context manager, try a child class
+        if self.id() is None:
+            self._setup_definition()
+            self.definition()
+            self._finalize_definition()
+
+        self._warmup(input_sets, device=device)
+
+    def metrics(self, *, reset=False):
+        """
+        Returns the runtime counters of the fusion as a dict
+
+        The counters are only collected with NVFUSER_ENABLE=runtime_metrics.
+        They include the number of runs and kernel launches, the hits and
+        misses of each cache level, the compilation time, the bytes read and
+        written by the kernels, and the kernel time of sampled runs. They are
+        cheap enough to stay enabled, e.g. to be exported to a monitoring
+        system, and do not require CUPTI.
+
+        Kwargs:
+            reset (Bool): Reset the counters after reading them (default: False)
+        """
+        return self._metrics(reset=reset)
+
+    def resource_usage(self):
+        """
+        Returns the resources used by the kernels of the last execution
+
+        There is one dict per kernel, i.e. per segment not evaluated on the
+        host, with the registers per thread, the static and dynamic shared
+        memory, the local memory per thread (register spills and local
+        arrays), the block size of the launch, the maximum number of active
+        blocks per SM for that launch and the theoretical occupancy, i.e. the
+        fraction of the warps of an SM that can be active, in [0, 1].
+
+        Returns:
+            List[Dict]
+        """
+        return self._resource_usage()
 
     def debug_output(self):
         """
@@ -88,6 +88,20 @@ __device__ __inline__ __bfloat __float2bfloat(const float f) {
   return val;
 }
 
+// Converts two floats with one instruction. See [ Note -- Packed casts ] in
+// csrc/device_lower/pass/packed_cast.cpp
+__device__ __inline__ void __float2bfloatx2(
+    const float f0,
+    const float f1,
+    __bfloat& out0,
+    __bfloat& out1) {
+  asm("{.reg .b32 buf0;\n\t"
+      "cvt.rn.bf16x2.f32 buf0, %3, %2;\n\t"
+      "mov.b32 {%0, %1}, buf0;}\n"
+      : "=h"(__NVFUSER_BFLOAT_TO_US(out0)), "=h"(__NVFUSER_BFLOAT_TO_US(out1))
+      : "f"(f0), "f"(f1));
+}
+
 __device__ __inline__ __bfloat __double2bfloat(const double d) {
 #if __CUDA_ARCH__ >= 900
   __bfloat val;
@@ -302,3 +316,103 @@ __device__ __inline__ bool __heq(const __bfloat a, const __bfloat b) {
 #endif
   return (val != 0U) ? true : false;
 }
+
+// Pairs of bfloat values computed with packed bf16x2 instructions on sm80+,
+// and in float otherwise. See [ Note -- Packed arithmetic ] in
+// csrc/device_lower/pass/packed_arithmetic.cpp
+struct __align__(4) __bfloatx2 {
+  __bfloat x;
+  __bfloat y;
+};
+
+#define __NVFUSER_BFLOATX2_TO_UI(var) \
+  *(reinterpret_cast<unsigned int*>(&(var)))
+#define __NVFUSER_BFLOATX2_TO_CUI(var) \
+  *(reinterpret_cast<const unsigned int*>(&(var)))
+
+__device__ __inline__ __bfloatx2 __packx2(const __bfloat x, const __bfloat y) {
+  __bfloatx2 val;
+  val.x = x;
+  val.y = y;
+  return val;
+}
+
+__device__ __inline__ void __unpackx2(
+    const __bfloatx2 h,
+    __bfloat& out0,
+    __bfloat& out1) {
+  out0 = h.x;
+  out1 = h.y;
+}
+
+__device__ __inline__ __bfloatx2 __bfloatx2_broadcast(const float f) {
+  const __bfloat h = __float2bfloat(f);
+  return __packx2(h, h);
+}
+
+// Computes a * b + c. Adds and subs multiply by one, and muls add -0 so that
+// the sign of zero products is kept.
+__device__ __inline__ __bfloatx2
+__fmax2(const __bfloatx2 a, const __bfloatx2 b, const __bfloatx2 c) {
+#if __CUDA_ARCH__ >= 800
+  __bfloatx2 val;
+  asm("{ fma.rn.bf16x2 %0, %1, %2, %3;}\n"
+      : "=r"(__NVFUSER_BFLOATX2_TO_UI(val))
+      : "r"(__NVFUSER_BFLOATX2_TO_CUI(a)),
+        "r"(__NVFUSER_BFLOATX2_TO_CUI(b)),
+        "r"(__NVFUSER_BFLOATX2_TO_CUI(c)));
+  return val;
+#else
+  return __packx2(
+      __float2bfloat(
+          __bfloat2float(a.x) * __bfloat2float(b.x) + __bfloat2float(c.x)),
+      __float2bfloat(
+          __bfloat2float(a.y) * __bfloat2float(b.y) + __bfloat2float(c.y)));
+#endif
+}
+
+__device__ __inline__ __bfloatx2 __bfloatx2_from_bits(unsigned int bits) {
+  __bfloatx2 val;
+  __NVFUSER_BFLOATX2_TO_UI(val) = bits;
+  return val;
+}
+
+__device__ __inline__ __bfloatx2
+__addx2(const __bfloatx2 a, const __bfloatx2 b) {
+  // 1.0 in both halves
+  return __fmax2(a, __bfloatx2_from_bits(0x3F803F80U), b);
+}
+
+__device__ __inline__ __bfloatx2
+__subx2(const __bfloatx2 a, const __bfloatx2 b) {
+  // -1.0 in both halves
+  return __fmax2(b, __bfloatx2_from_bits(0xBF80BF80U), a);
+}
+
+__device__ __inline__ __bfloatx2
+__mulx2(const __bfloatx2 a, const __bfloatx2 b) {
+  // -0.0 in both halves
+  return __fmax2(a, b, __bfloatx2_from_bits(0x80008000U));
+}
+
+__device__ __inline__ __bfloatx2 __negx2(const __bfloatx2 a) {
+  // Flips the sign bits, which is exact
+  return __bfloatx2_from_bits(__NVFUSER_BFLOATX2_TO_CUI(a) ^ 0x80008000U);
+}
+
+__device__ __inline__ __bfloatx2 __relux2(const __bfloatx2 a) {
+#if __CUDA_ARCH__ >= 800
+  __bfloatx2 val;
+  asm("{.reg .b32 zero;\n\t"
+      "mov.b32 zero, 0;\n\t"
+      "max.NaN.bf16x2 %0, %1, zero;}\n"
+      : "=r"(__NVFUSER_BFLOATX2_TO_UI(val))
+      : "r"(__NVFUSER_BFLOATX2_TO_CUI(a)));
+  return val;
+#else
+  const float x = __bfloat2float(a.x);
+  const float y = __bfloat2float(a.y);
+  return __packx2(
+      __float2bfloat(x <= 0 ? 0 : x), __float2bfloat(y <= 0 ? 0 : y));
+#endif
+}
@@ -22,7 +22,7 @@ template <
     bool Aligned,
     typename T,
     typename Func>
-__device__ void blockReduce(
+__device__ NVFUSER_OUTLINABLE void blockReduce(
     T& out,
     const T& inp_val,
     Func reduction_op,
@@ -185,6 +185,89 @@ __device__ void blockReduce(
       init_val);
 }
 
+// Atomic additions to shared or global memory, including for int64_t, which
+// atomicAdd does not take
+__device__ inline void atomicAddTo(int* address, int val) {
+  atomicAdd(address, val);
+}
+
+__device__ inline void atomicAddTo(int64_t* address, int64_t val) {
+  // Two's complement addition is the same for signed and unsigned integers
+  atomicAdd(
+      reinterpret_cast<unsigned long long int*>(address),
+      static_cast<unsigned long long int>(val));
+}
+
+__device__ inline void atomicAddTo(float* address, float val) {
+  atomicAdd(address, val);
+}
+
+__device__ inline void atomicAddTo(double* address, double val) {
+  atomicAdd(address, val);
+}
+
+// Sum of the same segments as blockReduce, where each thread adds its value
+// to the shared memory slot of its segment with an atomic. It takes three
+// block syncs whatever the block size, whereas the tree reduction takes one
+// per level, but the atomics of a segment are serialized. The order of the
+// additions is unspecified, so float results are not deterministic. Only one
+// slot per segment is used, so shared_mem may be as small as the number of
+// segments.
+template <
+    bool X_REDUCE,
+    bool Y_REDUCE,
+    bool Z_REDUCE,
+    bool Aligned,
+    typename T>
+__device__ void blockReduceAtomicAdd(
+    T& out,
+    const T& inp_val,
+    T* shared_mem,
+    bool read_pred,
+    bool write_pred,
+    T init_val) {
+  // If this thread will output a final result
+  bool should_write =
+      index_utils::maskedIsZero<X_REDUCE, Y_REDUCE, Z_REDUCE>(threadIdx);
+
+  // Index of the reduction segment
+  unsigned int reduction_idx =
+      index_utils::maskedOffset<!X_REDUCE, !Y_REDUCE, !Z_REDUCE>(
+          threadIdx, blockDim);
+
+  if (should_write) {
+    shared_mem[reduction_idx] = init_val;
+  }
+  block_sync::sync<Aligned>();
+
+  if (read_pred) {
+    atomicAddTo(shared_mem + reduction_idx, inp_val);
+  }
+  block_sync::sync<Aligned>();
+
+  if (should_write && write_pred) {
+    out += shared_mem[reduction_idx];
+  }
+  block_sync::sync<Aligned>();
+}
+
+// Use the same pred for both reads and writes
+template <
+    bool X_REDUCE,
+    bool Y_REDUCE,
+    bool Z_REDUCE,
+    bool Aligned,
+    typename T>
+__device__ void blockReduceAtomicAdd(
+    T& out,
+    const T& inp_val,
+    T* shared_mem,
+    bool read_write_pred,
+    T init_val) {
+  blockReduceAtomicAdd<X_REDUCE, Y_REDUCE, Z_REDUCE, Aligned, T>(
+      out, inp_val, shared_mem, read_write_pred, read_write_pred, init_val);
+}
+
 // Each thread in the iteration dimension processes N elements
 // Typical usage is in outer reduction where the iteration dimension
 // is parallelized by vectorized loads, bidmx. The reduction dimension
@@ -196,7 +279,7 @@ template <
     int N, // Number of elements per input array
     typename T,
     typename Func>
-__device__ void blockIterGroupedYdimReduce(
+__device__ NVFUSER_OUTLINABLE void blockIterGroupedYdimReduce(
     T out[N],
     const T inp_val[N],
     Func reduction_op,
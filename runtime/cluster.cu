@@ -0,0 +1,130 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+
+// Reference:
+// https://docs.nvidia.com/cuda/cuda-c-programming-guide/index.html#distributed-shared-memory
+// https://docs.nvidia.com/cuda/parallel-thread-execution/index.html#parallel-synchronization-and-communication-instructions-barrier-cluster
+
+#if (defined(__CUDA_ARCH__) && (__CUDA_ARCH__ >= 900))
+
+namespace cluster {
+
+// Rank of this thread block in its cluster
+__device__ inline uint32_t blockRank() {
+  uint32_t rank;
+  asm volatile("mov.u32 %0, %%cluster_ctarank;\n" : "=r"(rank) :);
+  return rank;
+}
+
+// Number of thread blocks in the cluster of this thread block
+__device__ inline uint32_t numBlocks() {
+  uint32_t size;
+  asm volatile("mov.u32 %0, %%cluster_nctarank;\n" : "=r"(size) :);
+  return size;
+}
+
+// Synchronize all threads of all thread blocks of the cluster. Shared memory
+// writes before the sync are visible to all blocks of the cluster after it.
+template <bool Aligned>
+__device__ inline void sync() {
+  if constexpr (Aligned) {
+    asm volatile("barrier.cluster.arrive.release.aligned;\n" : : : "memory");
+    asm volatile("barrier.cluster.wait.acquire.aligned;\n" : : : "memory");
+  } else {
+    asm volatile("barrier.cluster.arrive.release;\n" : : : "memory");
+    asm volatile("barrier.cluster.wait.acquire;\n" : : : "memory");
+  }
+}
+
+// Generic address of the shared memory at ptr in the thread block of the
+// cluster with the given rank
+template <typename T>
+__device__ inline T* mapSharedRank(T* ptr, uint32_t rank) {
+  uint64_t mapped;
+  asm volatile("mapa.u64 %0, %1, %2;\n"
+               : "=l"(mapped)
+               : "l"(reinterpret_cast<uint64_t>(ptr)), "r"(rank));
+  return reinterpret_cast<T*>(mapped);
+}
+
+// Reduction across the thread blocks of a cluster through distributed shared
+// memory. It replaces gridReduce when the blocks of each reduction segment
+// form a cluster, so no global work buffer or grid sync is needed. The
+// template parameters have the same meaning as for gridReduce, but only
+// X_BLOCK can be reduced and the cluster must span gridDim.x.
+//
+// Every block first reduces its own values with blockReduce and leaves the
+// result in its shared memory. After a cluster sync, every thread reads the
+// results of all blocks of the cluster in rank order, so all blocks hold the
+// same result, which makes this an allreduce as well. A second cluster sync
+// keeps the shared memory of each block alive until the other blocks are done
+// reading it.
+template <
+    bool X_BLOCK,
+    bool Y_BLOCK,
+    bool Z_BLOCK,
+    bool X_THREAD,
+    bool Y_THREAD,
+    bool Z_THREAD,
+    bool Aligned,
+    typename T,
+    typename Func>
+__device__ void clusterReduce(
+    T& out,
+    const T& inp_val,
+    Func reduction_op,
+    T* shared_buf,
+    bool read_pred,
+    bool write_pred,
+    T init_val) {
+  static_assert(
+      X_BLOCK && !Y_BLOCK && !Z_BLOCK,
+      "Cluster reductions are only supported across blockIdx.x");
+
+  T block_reduction_val = init_val;
+  if (X_THREAD || Y_THREAD || Z_THREAD) {
+    blockReduce<X_THREAD, Y_THREAD, Z_THREAD, Aligned>(
+        block_reduction_val,
+        inp_val,
+        reduction_op,
+        shared_buf,
+        read_pred,
+        true,
+        init_val);
+  } else if (read_pred) {
+    block_reduction_val = inp_val;
+  }
+
+  // Index of the reduction segment of this thread in the block
+  const auto thread_offset =
+      index_utils::maskedOffset<!X_THREAD, !Y_THREAD, !Z_THREAD>(
+          threadIdx, blockDim);
+
+  // blockReduce ends with a block sync, so shared_buf can be reused
+  if (index_utils::maskedIsZero<X_THREAD, Y_THREAD, Z_THREAD>(threadIdx)) {
+    shared_buf[thread_offset] = block_reduction_val;
+  }
+
+  sync<Aligned>();
+
+  T result = init_val;
+  const uint32_t cluster_size = numBlocks();
+  for (uint32_t rank = 0; rank < cluster_size; ++rank) {
+    reduction_op(result, mapSharedRank(shared_buf, rank)[thread_offset]);
+  }
+
+  sync<Aligned>();
+
+  if (write_pred) {
+    reduction_op(out, result);
+  }
+}
+
+} // namespace cluster
+
+#endif // Arch 90
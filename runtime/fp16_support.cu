@@ -88,6 +88,25 @@ __device__ __inline__ __half __float2half(const float f) {
   return val;
 }
 
+// Converts two floats with one instruction on sm80+. See
+// [ Note -- Packed casts ] in csrc/device_lower/pass/packed_cast.cpp
+__device__ __inline__ void __float2halfx2(
+    const float f0,
+    const float f1,
+    __half& out0,
+    __half& out1) {
+#if __CUDA_ARCH__ >= 800
+  asm("{.reg .b32 buf0;\n\t"
+      "cvt.rn.f16x2.f32 buf0, %3, %2;\n\t"
+      "mov.b32 {%0, %1}, buf0;}\n"
+      : "=h"(__NVFUSER_HALF_TO_US(out0)), "=h"(__NVFUSER_HALF_TO_US(out1))
+      : "f"(f0), "f"(f1));
+#else
+  out0 = __float2half(f0);
+  out1 = __float2half(f1);
+#endif
+}
+
 __device__ __inline__ __half __double2half(const double d) {
   __half val;
   asm("{  cvt.rn.f16.f64 %0, %1;}\n"
@@ -220,3 +239,85 @@ __device__ __inline__ bool __heq(const __half a, const __half b) {
       : "h"(__NVFUSER_HALF_TO_CUS(a)), "h"(__NVFUSER_HALF_TO_CUS(b)));
   return (val != 0U) ? true : false;
 }
+
+// Pairs of half values computed with packed f16x2 instructions. See
+// [ Note -- Packed arithmetic ] in
+// csrc/device_lower/pass/packed_arithmetic.cpp
+struct __align__(4) __halfx2 {
+  __half x;
+  __half y;
+};
+
+#define __NVFUSER_HALFX2_TO_UI(var) *(reinterpret_cast<unsigned int*>(&(var)))
+#define __NVFUSER_HALFX2_TO_CUI(var) \
+  *(reinterpret_cast<const unsigned int*>(&(var)))
+
+__device__ __inline__ __halfx2 __packx2(const __half x, const __half y) {
+  __halfx2 val;
+  val.x = x;
+  val.y = y;
+  return val;
+}
+
+__device__ __inline__ void __unpackx2(
+    const __halfx2 h,
+    __half& out0,
+    __half& out1) {
+  out0 = h.x;
+  out1 = h.y;
+}
+
+__device__ __inline__ __halfx2 __halfx2_broadcast(const float f) {
+  const __half h = __float2half(f);
+  return __packx2(h, h);
+}
+
+// No rounding modifier, so that ptxas may contract a product followed by a
+// sum into one fma.rn.f16x2
+__device__ __inline__ __halfx2 __addx2(const __halfx2 a, const __halfx2 b) {
+  __halfx2 val;
+  asm("{ add.f16x2 %0, %1, %2;}\n"
+      : "=r"(__NVFUSER_HALFX2_TO_UI(val))
+      : "r"(__NVFUSER_HALFX2_TO_CUI(a)), "r"(__NVFUSER_HALFX2_TO_CUI(b)));
+  return val;
+}
+
+__device__ __inline__ __halfx2 __subx2(const __halfx2 a, const __halfx2 b) {
+  __halfx2 val;
+  asm("{ sub.f16x2 %0, %1, %2;}\n"
+      : "=r"(__NVFUSER_HALFX2_TO_UI(val))
+      : "r"(__NVFUSER_HALFX2_TO_CUI(a)), "r"(__NVFUSER_HALFX2_TO_CUI(b)));
+  return val;
+}
+
+__device__ __inline__ __halfx2 __mulx2(const __halfx2 a, const __halfx2 b) {
+  __halfx2 val;
+  asm("{ mul.f16x2 %0, %1, %2;}\n"
+      : "=r"(__NVFUSER_HALFX2_TO_UI(val))
+      : "r"(__NVFUSER_HALFX2_TO_CUI(a)), "r"(__NVFUSER_HALFX2_TO_CUI(b)));
+  return val;
+}
+
+__device__ __inline__ __halfx2 __negx2(const __halfx2 a) {
+  __halfx2 val;
+  asm("{ neg.f16x2 %0, %1;}\n"
+      : "=r"(__NVFUSER_HALFX2_TO_UI(val))
+      : "r"(__NVFUSER_HALFX2_TO_CUI(a)));
+  return val;
+}
+
+__device__ __inline__ __halfx2 __relux2(const __halfx2 a) {
+#if __CUDA_ARCH__ >= 800
+  __halfx2 val;
+  asm("{.reg .b32 zero;\n\t"
+      "mov.b32 zero, 0;\n\t"
+      "max.NaN.f16x2 %0, %1, zero;}\n"
+      : "=r"(__NVFUSER_HALFX2_TO_UI(val))
+      : "r"(__NVFUSER_HALFX2_TO_CUI(a)));
+  return val;
+#else
+  const float x = __half2float(a.x);
+  const float y = __half2float(a.y);
+  return __packx2(__float2half(x <= 0 ? 0 : x), __float2half(y <= 0 ? 0 : y));
+#endif
+}
@@ -383,3 +383,141 @@ __device__ __inline__ __bfloat __e5m22bfloat(const __e5m2 h) {
 
   return val;
 }
+
+// Conversions of two elements with one instruction. See
+// [ Note -- Packed casts ] in csrc/device_lower/pass/packed_cast.cpp. The
+// first element is in the lower half of the packed operands of cvt.
+
+template <typename T>
+__device__ __inline__ unsigned short __fp8x2_to_us(const T lo, const T hi) {
+  return (unsigned short)lo.raw() | ((unsigned short)hi.raw() << 8);
+}
+
+template <typename T>
+__device__ __inline__ void __us_to_fp8x2(
+    const unsigned short buffer,
+    T& lo,
+    T& hi) {
+  const uint8_t lo_raw = buffer & 0xff;
+  const uint8_t hi_raw = buffer >> 8;
+  memcpy(&lo, &lo_raw, sizeof(uint8_t));
+  memcpy(&hi, &hi_raw, sizeof(uint8_t));
+}
+
+__device__ __inline__ void __float2e4m3x2(
+    const float f0,
+    const float f1,
+    __e4m3& out0,
+    __e4m3& out1) {
+  unsigned short _tmp_buffer;
+  asm("{cvt.rn.satfinite.e4m3x2.f32 %0, %1, %2;}"
+      : "=h"(_tmp_buffer)
+      : "f"(f1), "f"(f0));
+  __us_to_fp8x2(_tmp_buffer, out0, out1);
+}
+
+__device__ __inline__ void __half2e4m3x2(
+    const __half h0,
+    const __half h1,
+    __e4m3& out0,
+    __e4m3& out1) {
+  unsigned short _tmp_buffer;
+  asm("{\n\t"
+      ".reg .b32 buf0;\n\t"
+      "mov.b32 buf0, {%1, %2};\n\t"
+      "cvt.rn.satfinite.e4m3x2.f16x2 %0, buf0;\n\t"
+      "}"
+      : "=h"(_tmp_buffer)
+      : "h"(__NVFUSER_HALF_TO_CUS(h0)), "h"(__NVFUSER_HALF_TO_CUS(h1)));
+  __us_to_fp8x2(_tmp_buffer, out0, out1);
+}
+
+__device__ __inline__ void __e4m32floatx2(
+    const __e4m3 h0,
+    const __e4m3 h1,
+    float& out0,
+    float& out1) {
+  asm("{\n\t"
+      ".reg .b32 buf0;\n\t"
+      ".reg .b16 buf1, buf2;\n\t"
+      "cvt.rn.f16x2.e4m3x2 buf0, %2;\n\t"
+      "mov.b32 {buf1, buf2}, buf0;\n\t"
+      "cvt.f32.f16 %0, buf1;\n\t"
+      "cvt.f32.f16 %1, buf2;\n\t"
+      "}"
+      : "=f"(out0), "=f"(out1)
+      : "h"(__fp8x2_to_us(h0, h1)));
+}
+
+__device__ __inline__ void __e4m32halfx2(
+    const __e4m3 h0,
+    const __e4m3 h1,
+    __half& out0,
+    __half& out1) {
+  asm("{\n\t"
+      ".reg .b32 buf0;\n\t"
+      "cvt.rn.f16x2.e4m3x2 buf0, %2;\n\t"
+      "mov.b32 {%0, %1}, buf0;\n\t"
+      "}"
+      : "=h"(__NVFUSER_HALF_TO_US(out0)), "=h"(__NVFUSER_HALF_TO_US(out1))
+      : "h"(__fp8x2_to_us(h0, h1)));
+}
+
+__device__ __inline__ void __float2e5m2x2(
+    const float f0,
+    const float f1,
+    __e5m2& out0,
+    __e5m2& out1) {
+  unsigned short _tmp_buffer;
+  asm("{cvt.rn.satfinite.e5m2x2.f32 %0, %1, %2;}"
+      : "=h"(_tmp_buffer)
+      : "f"(f1), "f"(f0));
+  __us_to_fp8x2(_tmp_buffer, out0, out1);
+}
+
+__device__ __inline__ void __half2e5m2x2(
+    const __half h0,
+    const __half h1,
+    __e5m2& out0,
+    __e5m2& out1) {
+  unsigned short _tmp_buffer;
+  asm("{\n\t"
+      ".reg .b32 buf0;\n\t"
+      "mov.b32 buf0, {%1, %2};\n\t"
+      "cvt.rn.satfinite.e5m2x2.f16x2 %0, buf0;\n\t"
+      "}"
+      : "=h"(_tmp_buffer)
+      : "h"(__NVFUSER_HALF_TO_CUS(h0)), "h"(__NVFUSER_HALF_TO_CUS(h1)));
+  __us_to_fp8x2(_tmp_buffer, out0, out1);
+}
+
+__device__ __inline__ void __e5m22floatx2(
+    const __e5m2 h0,
+    const __e5m2 h1,
+    float& out0,
+    float& out1) {
+  asm("{\n\t"
+      ".reg .b32 buf0;\n\t"
+      ".reg .b16 buf1, buf2;\n\t"
+      "cvt.rn.f16x2.e5m2x2 buf0, %2;\n\t"
+      "mov.b32 {buf1, buf2}, buf0;\n\t"
+      "cvt.f32.f16 %0, buf1;\n\t"
+      "cvt.f32.f16 %1, buf2;\n\t"
+      "}"
+      : "=f"(out0), "=f"(out1)
+      : "h"(__fp8x2_to_us(h0, h1)));
+}
+
+__device__ __inline__ void __e5m22halfx2(
+    const __e5m2 h0,
+    const __e5m2 h1,
+    __half& out0,
+    __half& out1) {
+  asm("{\n\t"
+      ".reg .b32 buf0;\n\t"
+      "cvt.rn.f16x2.e5m2x2 buf0, %2;\n\t"
+      "mov.b32 {%0, %1}, buf0;\n\t"
+      "}"
+      : "=h"(__NVFUSER_HALF_TO_US(out0)), "=h"(__NVFUSER_HALF_TO_US(out1))
+      : "h"(__fp8x2_to_us(h0, h1)));
+}
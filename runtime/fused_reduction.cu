@@ -467,7 +467,7 @@ class ParallelReduce {
   // all values of a tuple together, so this is the only entry point
   // for Welford for now.
   template <bool Aligned, typename Func, typename... Types>
-  __device__ __inline__ void reduce(
+  __device__ NVFUSER_OUTLINABLE void reduce(
       RefTuple<Types...> out,
       const ConstRefTuple<Types...>& inp,
       VolatilePtrTuple<Types...> global_work_buffer,
@@ -508,7 +508,7 @@ class ParallelReduce {
       typename... DataTypes,
       typename... Funcs,
       typename... BoolTypes>
-  __device__ __inline__ void reduceGroup(
+  __device__ NVFUSER_OUTLINABLE void reduceGroup(
       RefTuple<DataTypes...> out,
       const ConstRefTuple<DataTypes...>& inp,
       VolatilePtrTuple<DataTypes...> global_work_buffer,
@@ -730,7 +730,7 @@ template <
     bool PERSISTENT_REDUCTION,
     bool BROADCAST>
 template <bool Aligned, typename Func, typename... Types>
-__device__ __inline__ void ParallelReduce<
+__device__ NVFUSER_OUTLINABLE void ParallelReduce<
     X_BLOCK,
     Y_BLOCK,
     Z_BLOCK,
@@ -1209,7 +1209,7 @@ template <
     typename... DataTypes,
     typename... Funcs,
     typename... BoolTypes>
-__device__ __inline__ void ParallelReduce<
+__device__ NVFUSER_OUTLINABLE void ParallelReduce<
     X_BLOCK,
     Y_BLOCK,
     Z_BLOCK,
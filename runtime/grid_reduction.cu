@@ -192,7 +192,7 @@ template <
     bool Aligned,
     typename T,
     typename Func>
-__device__ void gridReduce(
+__device__ NVFUSER_OUTLINABLE void gridReduce(
     T& out,
     const T& inp_val,
     Func reduction_op,
@@ -422,7 +422,7 @@ template <
     typename Func1,
     typename T2,
     typename Func2>
-__device__ void gridReduceGroup(
+__device__ NVFUSER_OUTLINABLE void gridReduceGroup(
     T1& out1,
     const T1& inp_val1,
     T1 init_val1,
@@ -559,7 +559,7 @@ template <
     typename Func1,
     typename T2,
     typename Func2>
-__device__ void gridReduceGroup(
+__device__ NVFUSER_OUTLINABLE void gridReduceGroup(
     T1& out1,
     const T1& inp_val1,
     T1 init_val1,
@@ -841,7 +841,7 @@ template <
     int vec_size,
     typename T,
     typename Func>
-__device__ void iterGroupedGridReduce(
+__device__ NVFUSER_OUTLINABLE void iterGroupedGridReduce(
     T* out,
     const T* inp_val,
     Func reduction_op,
@@ -991,4 +991,50 @@ __device__ void iterGroupedGridReduce(
         sync_flags[idx_in_grid_segment], grid_reduction_segment_size);
   }
 }
+
+// Grid sum where each block reduces its values with blockReduce, or with
+// blockReduceAtomicAdd when SmemAtomic is true, and the threads holding the
+// block results add them to out with a global atomic. out must be
+// zero-filled before the launch, and every block of a segment adds to the
+// same element, so no work buffer, grid sync or last block is needed. The
+// order of the additions is unspecified, so floating-point results are not
+// deterministic. [X,Y,Z]_THREAD are the reduced thread dimensions, as for
+// blockReduce.
+template <
+    bool X_THREAD,
+    bool Y_THREAD,
+    bool Z_THREAD,
+    bool Aligned,
+    bool SmemAtomic,
+    typename T>
+__device__ void gridReduceAtomicAdd(
+    T& out,
+    const T& inp_val,
+    T* shared_buf,
+    bool read_pred,
+    bool write_pred,
+    T init_val) {
+  T block_result = init_val;
+  if ((X_THREAD || Y_THREAD || Z_THREAD) && SmemAtomic) {
+    blockReduceAtomicAdd<X_THREAD, Y_THREAD, Z_THREAD, Aligned>(
+        block_result, inp_val, shared_buf, read_pred, true, init_val);
+  } else if (X_THREAD || Y_THREAD || Z_THREAD) {
+    blockReduce<X_THREAD, Y_THREAD, Z_THREAD, Aligned>(
+        block_result,
+        inp_val,
+        [](T& a, T b) { a += b; },
+        shared_buf,
+        read_pred,
+        true,
+        init_val);
+  } else if (read_pred) {
+    block_result = inp_val;
+  }
+
+  if (write_pred &&
+      index_utils::maskedIsZero<X_THREAD, Y_THREAD, Z_THREAD>(threadIdx)) {
+    // The result is unused, so this compiles to red.global.add
+    atomicAddTo(&out, block_result);
+  }
+}
 } // namespace reduction
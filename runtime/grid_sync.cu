@@ -15,6 +15,39 @@ __device__ T globalAsVolatile(volatile T& global_val) {
   return global_val;
 }
 
+// When the kernel is launched with clusters spanning gridDim.x, the blocks of
+// a segment synchronized only along X form a cluster, so the sync can use the
+// hardware cluster barrier instead of spinning on a global semaphore. The
+// barrier orders global memory accesses as well, at cluster scope, which
+// covers all the blocks taking part in the sync. cluster.cu comes after this
+// file in the runtime, so the PTX is repeated here.
+template <bool X_BLOCK, bool Y_BLOCK, bool Z_BLOCK, bool Aligned>
+__device__ bool clusterSync() {
+#if (defined(__CUDA_ARCH__) && (__CUDA_ARCH__ >= 900))
+  if constexpr (X_BLOCK && !Y_BLOCK && !Z_BLOCK) {
+    uint32_t cluster_size;
+    asm volatile("mov.u32 %0, %%cluster_nctarank;\n" : "=r"(cluster_size) :);
+    if (cluster_size == gridDim.x) {
+      if constexpr (Aligned) {
+        asm volatile("barrier.cluster.arrive.release.aligned;\n"
+                     :
+                     :
+                     : "memory");
+        asm volatile("barrier.cluster.wait.acquire.aligned;\n"
+                     :
+                     :
+                     : "memory");
+      } else {
+        asm volatile("barrier.cluster.arrive.release;\n" : : : "memory");
+        asm volatile("barrier.cluster.wait.acquire;\n" : : : "memory");
+      }
+      return true;
+    }
+  }
+#endif
+  return false;
+}
+
 // A grid synchronization that can be called multiple times in a kernel assuming
 // all the blocks fit on device at once. The semaphore is an integer semaphore
 // assumed to be initialized to 0 before launching the kernel. The persistent
@@ -34,6 +67,10 @@ __device__ void sync(
     int64_t& semaphore,
     const uint64_t& segment_size,
     const bool last_block) {
+  if (clusterSync<X_BLOCK, Y_BLOCK, Z_BLOCK, Aligned>()) {
+    return;
+  }
+
   // Finish all global memory transactions before synchronizing
   __threadfence();
 
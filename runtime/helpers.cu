@@ -22,6 +22,13 @@
 #include <assert.h>
 #endif // __NVCC__
 
+// Large block and grid communication functions are inlined into each call
+// site unless the kernel defines NVFUSER_OUTLINABLE as __noinline__. See
+// [ Note -- Outlined runtime functions ] in executor_utils.cpp
+#ifndef NVFUSER_OUTLINABLE
+#define NVFUSER_OUTLINABLE __inline__
+#endif
+
 __device__ constexpr int ceilDiv(int a, int b) {
   return (a + b - 1) / b;
 }
@@ -50,6 +57,17 @@ __device__ constexpr double ceilDiv(int64_t a, double b) {
   return std::ceil(a / b);
 }
 
+// Division and remainder of a non-negative a by b > 0 with the multiplier
+// magic = UINT64_MAX / b + 1, which wraps to 0 for b == 1. Exact for all 32-bit
+// a and b, see Lemire et al., "Faster Remainder by Direct Computation".
+__device__ inline int fastDiv(int a, uint64_t magic) {
+  return magic == 0 ? a : (int)__umul64hi(magic, (uint32_t)a);
+}
+
+__device__ inline int fastMod(int a, int b, uint64_t magic) {
+  return (int)__umul64hi(magic * (uint32_t)a, (uint32_t)b);
+}
+
 // Monotonic and precise lerp is described here:
 // https://math.stackexchange.com/a/1798323
 __device__ double lerp(double start, double end, double weight) {
@@ -222,6 +240,59 @@ __device__ float silu(float x) {
   return x * sigmoid(x);
 }
 
+// Approximate float functions, see Note [Fast math] in codegen.cpp
+__device__ float fast_exp2(float x) {
+  float y;
+  asm("ex2.approx.ftz.f32 %0, %1;\n" : "=f"(y) : "f"(x));
+  return y;
+}
+
+__device__ float fast_exp(float x) {
+  // log2(e)
+  return fast_exp2(x * 1.4426950408889634f);
+}
+
+__device__ float fast_log2(float x) {
+  float y;
+  asm("lg2.approx.ftz.f32 %0, %1;\n" : "=f"(y) : "f"(x));
+  return y;
+}
+
+__device__ float fast_log(float x) {
+  // ln(2)
+  return fast_log2(x) * 0.6931471805599453f;
+}
+
+__device__ float fast_tanh(float x) {
+#if __CUDA_ARCH__ >= 750
+  float y;
+  asm("tanh.approx.f32 %0, %1;\n" : "=f"(y) : "f"(x));
+  return y;
+#else
+  return 1.0f - __fdividef(2.0f, fast_exp(2.0f * x) + 1.0f);
+#endif
+}
+
+__device__ float fast_erf(float x) {
+  const float ax = fabsf(x);
+  const float t = __fdividef(1.0f, fmaf(0.3275911f, ax, 1.0f));
+  float p = 1.061405429f;
+  p = fmaf(p, t, -1.453152027f);
+  p = fmaf(p, t, 1.421413741f);
+  p = fmaf(p, t, -0.284496736f);
+  p = fmaf(p, t, 0.254829592f);
+  const float y = 1.0f - p * t * fast_exp(-ax * ax);
+  return copysignf(y, x);
+}
+
+__device__ float fast_sigmoid(float x) {
+  return __fdividef(1.0f, 1.0f + fast_exp(-x));
+}
+
+__device__ float fast_silu(float x) {
+  return x * fast_sigmoid(x);
+}
+
 __device__ double threshold(double x, double t, double v) {
   return x <= t ? v : x;
 }
@@ -496,6 +567,35 @@ __device__ inline int64_t readCycleCounter() {
   return clock64();
 }
 
+// Region profiling of NVFUSER_ENABLE=kernel_profile(regions). The first lane
+// of each warp samples the cycle counter around a region and accumulates the
+// elapsed cycles and the number of hits in the profile buffer.
+namespace kernel_profile {
+
+__device__ inline bool isRegionSampler() {
+  const unsigned int tid = threadIdx.x +
+      blockDim.x * (threadIdx.y + blockDim.y * threadIdx.z);
+  return tid % 32 == 0;
+}
+
+__device__ inline int64_t startRegion() {
+  return isRegionSampler() ? clock64() : 0;
+}
+
+__device__ inline void endRegion(
+    int64_t& cycles,
+    int64_t& count,
+    int64_t start) {
+  if (isRegionSampler()) {
+    atomicAdd(
+        reinterpret_cast<unsigned long long*>(&cycles),
+        static_cast<unsigned long long>(clock64() - start));
+    atomicAdd(reinterpret_cast<unsigned long long*>(&count), 1ULL);
+  }
+}
+
+} // namespace kernel_profile
+
 __device__ float print_impl(const char* name, float value) {
   printf(
       "%s = %f @ threadIdx=(%d,%d,%d), blockIdx=(%d,%d,%d)\n",
@@ -24,7 +24,8 @@ __device__ uint4 single_round(uint4 ctr, uint2 key) {
   return ret;
 }
 
-__device__ uint4 philox(
+template <int ROUNDS>
+__device__ uint4 philoxRounds(
     unsigned long long seed,
     unsigned long long subsequence,
     unsigned long long offset) {
@@ -42,7 +43,8 @@ __device__ uint4 philox(
   uint4 output = {};
   uint2 key_ = key;
   uint4 counter_ = counter;
-  for (int i = 0; i < 9; i++) {
+#pragma unroll
+  for (int i = 0; i < ROUNDS - 1; i++) {
     counter_ = single_round(counter_, key_);
     key_.x += (kPhilox10A);
     key_.y += (kPhilox10B);
@@ -51,6 +53,23 @@ __device__ uint4 philox(
   return output;
 }
 
+// Philox4x32-10, the generator of PyTorch
+__device__ uint4 philox(
+    unsigned long long seed,
+    unsigned long long subsequence,
+    unsigned long long offset) {
+  return philoxRounds<10>(seed, subsequence, offset);
+}
+
+// Philox4x32-7, the fewest rounds for which Random123 reports that Philox
+// passes TestU01 BigCrush. Used with NVFUSER_ENABLE=fast_rng.
+__device__ uint4 fast_philox(
+    unsigned long long seed,
+    unsigned long long subsequence,
+    unsigned long long offset) {
+  return philoxRounds<7>(seed, subsequence, offset);
+}
+
 // This is a uniform double in the range (0, 1]
 __device__ double raw_uniform_double(unsigned int x, unsigned int y) {
   constexpr double scale = 1.0 / (double)(1ll << 53);
@@ -0,0 +1,243 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+namespace scan {
+
+// Inclusive scan of per-thread values along threadIdx.x. Each (threadIdx.y,
+// threadIdx.z) pair forms an independent row that is scanned separately.
+//
+// Function parameters:
+// - out: Per-thread output location, written when write_pred is true
+// - inp_val: Per-thread input value, read when read_pred is true
+// - scan_op: Scalar binary function, scan_op(a, b) computes a = a op b
+// - shared_mem: Shared memory buffer of at least blockDim.x * blockDim.y *
+//   blockDim.z elements
+// - init_val: Identity of scan_op, used for threads with read_pred false
+//
+// All threads of the block must call this function.
+template <bool Aligned, typename T, typename Func>
+__device__ T blockInclusiveScan(
+    T& out,
+    const T& inp_val,
+    Func scan_op,
+    T* shared_mem,
+    bool read_pred,
+    bool write_pred,
+    T init_val) {
+  const unsigned int row_offset =
+      (threadIdx.z * blockDim.y + threadIdx.y) * blockDim.x;
+  const unsigned int smem_offset = row_offset + threadIdx.x;
+
+  T val = read_pred ? inp_val : init_val;
+  shared_mem[smem_offset] = val;
+  block_sync::sync<Aligned>();
+
+  // Hillis-Steele scan. The preceding value is always the left operand so
+  // that scan_op does not need to be commutative.
+  for (unsigned int offset = 1; offset < blockDim.x; offset *= 2) {
+    T prev = init_val;
+    if (threadIdx.x >= offset) {
+      prev = shared_mem[smem_offset - offset];
+    }
+    block_sync::sync<Aligned>();
+    if (threadIdx.x >= offset) {
+      scan_op(prev, val);
+      val = prev;
+      shared_mem[smem_offset] = val;
+    }
+    block_sync::sync<Aligned>();
+  }
+
+  if (write_pred) {
+    out = val;
+  }
+  return val;
+}
+
+// Flags of a tile in the decoupled look-back. A tile is one row of threads of
+// one block, and the tiles of a chain are the blocks along blockIdx.x.
+constexpr int64_t kNotReady = 0;
+constexpr int64_t kAggregateReady = 1;
+constexpr int64_t kPrefixReady = 2;
+
+// Decoupled look-back (Merrill and Garland, "Single-pass Parallel Prefix Scan
+// with Decoupled Look-back"). Called by a single thread of each tile with
+// the aggregate of the tile, returns the combined aggregate of all preceding
+// tiles of the chain.
+//
+// The tile first publishes its aggregate, then walks backwards accumulating
+// the aggregates of its predecessors until it finds one that has published
+// its inclusive prefix, and finally publishes its own inclusive prefix. No
+// tile waits for more than its predecessors, so there is no grid barrier,
+// but predecessors must make progress, which requires the grid to be
+// co-resident.
+//
+// aggregates, prefixes and flags have one entry per tile and flags must be
+// zero initialized.
+template <typename T, typename Func>
+__device__ T lookBack(
+    const T& aggregate,
+    Func scan_op,
+    volatile T* aggregates,
+    volatile T* prefixes,
+    volatile int64_t* flags,
+    const nvfuser_index_t chain_offset,
+    T init_val) {
+  const nvfuser_index_t tile = chain_offset + blockIdx.x;
+  T exclusive = init_val;
+
+  if (blockIdx.x == 0) {
+    prefixes[tile] = aggregate;
+    __threadfence();
+    flags[tile] = kPrefixReady;
+    return exclusive;
+  }
+
+  aggregates[tile] = aggregate;
+  __threadfence();
+  flags[tile] = kAggregateReady;
+
+  nvfuser_index_t predecessor = tile - 1;
+  while (true) {
+    int64_t flag = flags[predecessor];
+    if (flag == kNotReady) {
+      continue;
+    }
+    __threadfence();
+    T tmp = flag == kPrefixReady ? prefixes[predecessor]
+                                 : aggregates[predecessor];
+    scan_op(tmp, exclusive);
+    exclusive = tmp;
+    if (flag == kPrefixReady) {
+      break;
+    }
+    --predecessor;
+  }
+
+  T inclusive = exclusive;
+  scan_op(inclusive, aggregate);
+  prefixes[tile] = inclusive;
+  __threadfence();
+  flags[tile] = kPrefixReady;
+  return exclusive;
+}
+
+// Offset of the first tile of the chain of the calling thread. Chains are
+// formed by the threads with the same (blockIdx.y, blockIdx.z, threadIdx.y,
+// threadIdx.z) in one entrance.
+__device__ nvfuser_index_t lookBackChainOffset(
+    const nvfuser_index_t entrance_ind) {
+  const nvfuser_index_t chains_per_entrance =
+      (nvfuser_index_t)gridDim.y * gridDim.z * blockDim.y * blockDim.z;
+  const nvfuser_index_t chain =
+      (((nvfuser_index_t)blockIdx.z * gridDim.y + blockIdx.y) * blockDim.z +
+       threadIdx.z) *
+          blockDim.y +
+      threadIdx.y;
+  return (entrance_ind * chains_per_entrance + chain) * gridDim.x;
+}
+
+// Single-pass inclusive scan of per-thread values along threadIdx.x and
+// blockIdx.x, i.e., over the linear index blockIdx.x * blockDim.x +
+// threadIdx.x. Rows of (threadIdx.y, threadIdx.z) and (blockIdx.y,
+// blockIdx.z) are scanned independently.
+//
+// aggregates, prefixes and flags need n_entrances * gridDim.x * gridDim.y *
+// gridDim.z * blockDim.y * blockDim.z entries, and flags must be zero
+// initialized. entrance_ind is the count of times the function has been
+// called by the thread so far in the kernel. See lookBack for the forward
+// progress requirement.
+//
+// All threads of the grid must call this function.
+template <bool Aligned, typename T, typename Func>
+__device__ void gridInclusiveScan(
+    T& out,
+    const T& inp_val,
+    Func scan_op,
+    volatile T* aggregates,
+    volatile T* prefixes,
+    volatile int64_t* flags,
+    T* shared_mem,
+    bool read_pred,
+    bool write_pred,
+    T init_val,
+    const nvfuser_index_t entrance_ind,
+    const nvfuser_index_t n_entrances) {
+  T block_val = init_val;
+  block_val = blockInclusiveScan<Aligned>(
+      block_val, inp_val, scan_op, shared_mem, read_pred, false, init_val);
+
+  const unsigned int row_offset =
+      (threadIdx.z * blockDim.y + threadIdx.y) * blockDim.x;
+
+  // The last thread of each row holds the aggregate of the row
+  if (threadIdx.x == blockDim.x - 1) {
+    shared_mem[row_offset] = lookBack(
+        block_val,
+        scan_op,
+        aggregates,
+        prefixes,
+        flags,
+        lookBackChainOffset(entrance_ind),
+        init_val);
+  }
+  block_sync::sync<Aligned>();
+
+  T result = shared_mem[row_offset];
+  scan_op(result, block_val);
+  if (write_pred) {
+    out = result;
+  }
+  block_sync::sync<Aligned>();
+}
+
+// Reduction of per-thread values along threadIdx.x and blockIdx.x built on
+// the look-back of gridInclusiveScan. The blocks are combined in the order
+// of blockIdx.x, so the result is deterministic, and no block waits for the
+// blocks after it. Only threadIdx.x == 0 of the last block along blockIdx.x
+// gets the result. Parameters are the same as gridInclusiveScan.
+template <bool Aligned, typename T, typename Func>
+__device__ void gridReduceLookBack(
+    T& out,
+    const T& inp_val,
+    Func reduction_op,
+    volatile T* aggregates,
+    volatile T* prefixes,
+    volatile int64_t* flags,
+    T* shared_mem,
+    bool read_pred,
+    bool write_pred,
+    T init_val,
+    const nvfuser_index_t entrance_ind,
+    const nvfuser_index_t n_entrances) {
+  T block_val = init_val;
+  blockReduce<true, false, false, Aligned>(
+      block_val,
+      inp_val,
+      reduction_op,
+      shared_mem,
+      read_pred,
+      true,
+      init_val);
+
+  if (threadIdx.x == 0) {
+    T result = lookBack(
+        block_val,
+        reduction_op,
+        aggregates,
+        prefixes,
+        flags,
+        lookBackChainOffset(entrance_ind),
+        init_val);
+    if (blockIdx.x == gridDim.x - 1 && write_pred) {
+      reduction_op(result, block_val);
+      out = result;
+    }
+  }
+}
+
+} // namespace scan
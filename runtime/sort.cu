@@ -0,0 +1,149 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+namespace sort {
+
+// Values the items are compared as. Reduced precision floats are compared as
+// float.
+template <typename T>
+__device__ __inline__ T sortKey(const T& x) {
+  return x;
+}
+
+__device__ __inline__ float sortKey(const __half& x) {
+  return __half2float(x);
+}
+
+__device__ __inline__ float sortKey(const __bfloat& x) {
+  return __bfloat2float(x);
+}
+
+__device__ __inline__ float sortKey(const __e4m3& x) {
+  return __e4m32float(x);
+}
+
+__device__ __inline__ float sortKey(const __e5m2& x) {
+  return __e5m22float(x);
+}
+
+// Whether item (a, a_index) goes before item (b, b_index). Like at::sort,
+// NaNs are larger than any other value, and ties are broken by position, so
+// the sort is stable. A negative index marks an item that was not read,
+// which goes after all the others.
+template <bool Descending, typename T>
+__device__ __inline__ bool goesBefore(
+    const T& a,
+    int64_t a_index,
+    const T& b,
+    int64_t b_index) {
+  if (a_index < 0 || b_index < 0) {
+    return b_index < 0 && a_index >= 0;
+  }
+  const auto a_key = sortKey(a);
+  const auto b_key = sortKey(b);
+  // NOLINTNEXTLINE(misc-redundant-expression)
+  const bool a_nan = a_key != a_key;
+  // NOLINTNEXTLINE(misc-redundant-expression)
+  const bool b_nan = b_key != b_key;
+  if (a_nan != b_nan) {
+    return Descending ? a_nan : b_nan;
+  }
+  if (!a_nan && a_key != b_key) {
+    return Descending ? a_key > b_key : a_key < b_key;
+  }
+  return a_index < b_index;
+}
+
+// Stable sort of per-thread values along threadIdx.x. Each (threadIdx.y,
+// threadIdx.z) pair forms an independent row that is sorted separately.
+// out_index is the position along threadIdx.x of the item written to
+// out_value.
+//
+// Function parameters:
+// - out_value, out_index: Per-thread output locations, written when
+//   write_pred is true
+// - inp_val: Per-thread input value, read when read_pred is true. Threads
+//   with read_pred false do not contribute an item, and their output is
+//   undefined. This is meant for the threads past the end of a row.
+// - shared_mem: Shared memory buffer of at least blockDim.x * blockDim.y *
+//   blockDim.z * (8 + sizeof(T)) bytes, 8-byte aligned
+//
+// The rows are sorted in shared memory by a bitonic sorting network over the
+// next power of two of blockDim.x, with the missing items treated as larger
+// than any other. Each merge stage starts with a flip, i.e. comparing item i
+// of a group with the mirrored item of the other half, instead of sorting
+// every other group in descending order. Then every comparison moves the
+// larger item to the larger position, and the missing items, being the
+// largest, never have to be compared.
+//
+// All threads of the block must call this function.
+template <bool Aligned, bool Descending, typename T>
+__device__ void blockSort(
+    T& out_value,
+    int64_t& out_index,
+    const T& inp_val,
+    void* shared_mem,
+    bool read_pred,
+    bool write_pred) {
+  const unsigned int block_size = blockDim.x * blockDim.y * blockDim.z;
+  const unsigned int row_offset =
+      (threadIdx.z * blockDim.y + threadIdx.y) * blockDim.x;
+  const unsigned int n = blockDim.x;
+
+  int64_t* indices = static_cast<int64_t*>(shared_mem) + row_offset;
+  T* values =
+      reinterpret_cast<T*>(static_cast<int64_t*>(shared_mem) + block_size) +
+      row_offset;
+
+  values[threadIdx.x] = read_pred ? inp_val : T{};
+  indices[threadIdx.x] = read_pred ? (int64_t)threadIdx.x : -1;
+  block_sync::sync<Aligned>();
+
+  unsigned int padded_n = 1;
+  while (padded_n < n) {
+    padded_n *= 2;
+  }
+
+  // padded_n / 2 < n, so each thread compares at most one pair per step
+  const unsigned int pair = threadIdx.x;
+  for (unsigned int group = 2; group <= padded_n; group *= 2) {
+    for (unsigned int stride = group / 2; stride > 0; stride /= 2) {
+      if (pair < padded_n / 2) {
+        unsigned int lo = 0;
+        unsigned int hi = 0;
+        if (stride == group / 2) {
+          // Flip
+          const unsigned int group_start = pair / stride * group;
+          lo = group_start + pair % stride;
+          hi = group_start + group - 1 - pair % stride;
+        } else {
+          lo = pair / stride * stride * 2 + pair % stride;
+          hi = lo + stride;
+        }
+        if (hi < n &&
+            goesBefore<Descending>(
+                values[hi], indices[hi], values[lo], indices[lo])) {
+          const T value = values[lo];
+          values[lo] = values[hi];
+          values[hi] = value;
+          const int64_t index = indices[lo];
+          indices[lo] = indices[hi];
+          indices[hi] = index;
+        }
+      }
+      block_sync::sync<Aligned>();
+    }
+  }
+
+  if (write_pred) {
+    out_value = values[threadIdx.x];
+    out_index = indices[threadIdx.x];
+  }
+  block_sync::sync<Aligned>();
+}
+
+} // namespace sort
@@ -8,16 +8,21 @@
 namespace warp {
 
 template <typename T>
-__device__ __forceinline__ T shfl_xor(T var, int laneMask, int width = 32) {
-  return __shfl_xor_sync(0xffffffff, var, laneMask, width);
+__device__ __forceinline__ T shfl_xor(
+    T var,
+    int laneMask,
+    int width = 32,
+    unsigned int mask = 0xffffffff) {
+  return __shfl_xor_sync(mask, var, laneMask, width);
 }
 template <typename T>
 __device__ __forceinline__ std::complex<T> shfl_xor(
     std::complex<T> var,
     int laneMask,
-    int width = 32) {
-  T real = __shfl_xor_sync(0xffffffff, var.real(), laneMask, width);
-  T imag = __shfl_xor_sync(0xffffffff, var.imag(), laneMask, width);
+    int width = 32,
+    unsigned int mask = 0xffffffff) {
+  T real = __shfl_xor_sync(mask, var.real(), laneMask, width);
+  T imag = __shfl_xor_sync(mask, var.imag(), laneMask, width);
   return std::complex<T>(real, imag);
 }
 
@@ -88,4 +93,91 @@ __device__ void warpReduceTIDX(
   }
 }
 
+// Reductions of segments of LANES consecutive threads, where LANES is a power
+// of two of at most a warp and blockDim.x == LANES, so that each segment is
+// aligned within a warp and needs neither shared memory nor block syncs.
+// Every thread of a segment gets the result.
+
+// Mask of the lanes of the segment of this thread
+template <int LANES>
+__device__ __forceinline__ unsigned int subWarpMask() {
+  static_assert(
+      LANES > 0 && LANES <= 32 && (LANES & (LANES - 1)) == 0,
+      "Invalid number of lanes");
+  if (LANES == 32) {
+    return 0xffffffff;
+  }
+  unsigned int lane_idx =
+      (threadIdx.x + blockDim.x * (threadIdx.y + blockDim.y * threadIdx.z)) %
+      32;
+  return ((1u << LANES) - 1) << (lane_idx & ~(LANES - 1));
+}
+
+template <int LANES, typename T, typename Func>
+__device__ void subWarpReduceTIDX(
+    T& out,
+    const T& inp_val,
+    Func reduction_op,
+    bool read_write_pred,
+    T init_val) {
+  const unsigned int mask = subWarpMask<LANES>();
+  T reduce_val = read_write_pred ? inp_val : init_val;
+  for (int i = LANES / 2; i >= 1; i /= 2) {
+    reduction_op(reduce_val, shfl_xor(reduce_val, i, LANES, mask));
+  }
+  reduction_op(out, reduce_val);
+}
+
+enum class ReduxOp { Add, Min, Max };
+
+// Same as subWarpReduceTIDX for int sums, mins and maxes, which are a single
+// redux.sync instruction on sm80 and newer
+template <int LANES, ReduxOp OP, typename Func>
+__device__ void subWarpReduxTIDX(
+    int& out,
+    const int& inp_val,
+    Func reduction_op,
+    bool read_write_pred,
+    int init_val) {
+#if (defined(__CUDA_ARCH__) && (__CUDA_ARCH__ >= 800))
+  const unsigned int mask = subWarpMask<LANES>();
+  int reduce_val = read_write_pred ? inp_val : init_val;
+  if constexpr (OP == ReduxOp::Add) {
+    reduce_val = __reduce_add_sync(mask, reduce_val);
+  } else if constexpr (OP == ReduxOp::Min) {
+    reduce_val = __reduce_min_sync(mask, reduce_val);
+  } else {
+    reduce_val = __reduce_max_sync(mask, reduce_val);
+  }
+  reduction_op(out, reduce_val);
+#else
+  subWarpReduceTIDX<LANES>(
+      out, inp_val, reduction_op, read_write_pred, init_val);
+#endif
+}
+
+template <int LANES, typename T, typename TN>
+__device__ void subWarpWelfordTIDX(
+    T& out_avg,
+    T& out_M2,
+    TN& out_N,
+    const T& in_avg,
+    const T& in_M2,
+    const TN& in_N,
+    bool read_pred,
+    T init_val) {
+  const unsigned int mask = subWarpMask<LANES>();
+  T reduce_avg = read_pred ? in_avg : init_val;
+  T reduce_M2 = read_pred ? in_M2 : init_val;
+  TN reduce_N = read_pred ? in_N : (TN)0;
+  for (int i = LANES / 2; i >= 1; i /= 2) {
+    T other_avg = shfl_xor(reduce_avg, i, LANES, mask);
+    T other_M2 = shfl_xor(reduce_M2, i, LANES, mask);
+    TN other_N = shfl_xor(reduce_N, i, LANES, mask);
+    welfordCombine(
+        reduce_avg, reduce_M2, reduce_N, other_avg, other_M2, other_N);
+  }
+  welfordCombine(out_avg, out_M2, out_N, reduce_avg, reduce_M2, reduce_N);
+}
+
 } // namespace warp
@@ -67,6 +67,70 @@ __inline__ __device__ void welfordCombine(
   a_N = ab_N;
 }
 
+// Same as welfordCombine, but the sums into a_avg and a_M2 are
+// Kahan-compensated. c_avg and c_M2 hold the compensations, which are reset
+// whenever a_N is zero, so they do not need to be reinitialized together with
+// a_avg, a_M2 and a_N.
+template <typename T, typename TN>
+__inline__ __device__ void welfordCombineCompensated(
+    T& a_avg,
+    T& a_M2,
+    TN& a_N,
+    T& c_avg,
+    T& c_M2,
+    const T b_avg,
+    const T b_M2,
+    TN b_N) {
+  if (b_N == 0) {
+    return;
+  }
+  if (a_N == 0) {
+    c_avg = 0;
+    c_M2 = 0;
+  }
+  TN ab_N = a_N + b_N;
+  T b_N_div_ab_N = ((T)(nvfuser_index_t)(b_N)) / ((T)(nvfuser_index_t)(ab_N));
+  // The running average is a_avg - c_avg
+  T delta = b_avg - a_avg + c_avg;
+  T y = delta * b_N_div_ab_N - c_avg;
+  T t = a_avg + y;
+  c_avg = (t - a_avg) - y;
+  a_avg = t;
+  y = b_M2 + delta * delta * ((T)(nvfuser_index_t)(a_N)) * b_N_div_ab_N -
+      c_M2;
+  t = a_M2 + y;
+  c_M2 = (t - a_M2) - y;
+  a_M2 = t;
+  a_N = ab_N;
+}
+
+// Adds a single value to the sum and the sum of squares held in sum and
+// sum_sq. Used by serial WelfordOps in the Fast mode, whose results are
+// converted by welfordSumsToMoments before they are merged.
+template <typename T, typename TN>
+__inline__ __device__ void welfordAccumulateSums(
+    T& sum,
+    T& sum_sq,
+    TN& N,
+    const T b) {
+  sum += b;
+  sum_sq += b * b;
+  N += 1;
+}
+
+// Converts the sum and the sum of squares of N values to their average and
+// M2 in place
+template <typename T, typename TN>
+__inline__ __device__ void welfordSumsToMoments(T& sum, T& sum_sq, TN N) {
+  if (N == 0) {
+    return;
+  }
+  T avg = sum / ((T)(nvfuser_index_t)(N));
+  T M2 = sum_sq - sum * avg;
+  sum = avg;
+  sum_sq = M2 > (T)0 ? M2 : (T)0;
+}
+
 template <typename T, bool OutputGmem>
 __inline__ __device__ void welfordVectorized(
     T& a_avg,
@@ -115,7 +179,7 @@ template <
     bool Aligned,
     typename T,
     typename TN>
-__inline__ __device__ void blockWelford(
+NVFUSER_OUTLINABLE __device__ void blockWelford(
     T& out_avg,
     T& out_M2,
     TN& out_N,
@@ -353,7 +417,7 @@ template <
     bool Aligned,
     typename T,
     typename TN>
-__device__ void gridWelford(
+__device__ NVFUSER_OUTLINABLE void gridWelford(
     T& out_avg,
     T& out_M2,
     TN& out_N,
@@ -0,0 +1,89 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#include <gmock/gmock-matchers.h>
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <thread>
+
+#include <kernel_db/compile_server.h>
+#include <tests/cpp/utils.h>
+#include <tests/cpp/validator.h>
+
+// RUN CMD: bin/test_jit --gtest_filter="NVFuserTest*CompileServer*"
+namespace nvfuser {
+
+// See [ Note -- Compile server ]
+TEST_F(NVFuserTest, CompileServer_Deduplication) {
+  const std::string socket_path =
+      (std::filesystem::temp_directory_path() /
+       ("nvfuser_compile_server_test_" + std::to_string(getpid()) + ".sock"))
+          .string();
+
+  std::atomic<int64_t> num_compiled = 0;
+  CompileFunction compile = [&](const CompileRequest& request) {
+    ++num_compiled;
+    // Keep the first request in flight while the others arrive
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    NVF_CHECK(request.code != "invalid", "Compile error");
+    CompileResponse response;
+    response.kernel_name = request.func_name + "_" + request.id;
+    response.cubin.assign(request.code.begin(), request.code.end());
+    return response;
+  };
+  CompileServer server(socket_path, 2, compile);
+  ASSERT_TRUE(server.serving());
+  // A single process serves
+  EXPECT_FALSE(CompileServer(socket_path, 2, compile).serving());
+
+  // Identical requests of different programs are compiled once
+  constexpr int64_t num_clients = 8;
+  std::vector<std::optional<CompileResponse>> responses(num_clients);
+  std::vector<std::thread> clients;
+  for (int64_t i = 0; i < num_clients; ++i) {
+    clients.emplace_back([&, i]() {
+      CompileRequest request;
+      request.code = "kernel";
+      request.func_name = "nvfuser_pointwise";
+      request.id = std::to_string(i);
+      request.options = {"--gpu-architecture=sm_80"};
+      request.compile_to_sass = true;
+      responses.at(i) = CompileServer::request(socket_path, request);
+    });
+  }
+  for (auto& client : clients) {
+    client.join();
+  }
+  EXPECT_EQ(num_compiled, 1);
+  EXPECT_EQ(server.numCompilations(), 1);
+  for (const auto& response : responses) {
+    ASSERT_TRUE(response.has_value());
+    EXPECT_EQ(response->kernel_name, responses.front()->kernel_name);
+    EXPECT_EQ(
+        std::string(response->cubin.begin(), response->cubin.end()), "kernel");
+  }
+
+  // Other options are another kernel
+  CompileRequest request;
+  request.code = "kernel";
+  request.func_name = "nvfuser_pointwise";
+  request.options = {"--gpu-architecture=sm_90"};
+  request.compile_to_sass = true;
+  EXPECT_TRUE(CompileServer::request(socket_path, request).has_value());
+  EXPECT_EQ(num_compiled, 2);
+
+  // Failures are left to the client
+  request.code = "invalid";
+  EXPECT_FALSE(CompileServer::request(socket_path, request).has_value());
+}
+
+} // namespace nvfuser
@@ -29,7 +29,7 @@ TEST_F(NVFuserTest, KernelDb_Write_CUDA) {
   ASSERT_TRUE(fs::is_regular_file(test_data_kernel));
 
   const std::string kernel_db_dir("nvfuser_kernel_db_write_test");
-  const std::string kernel_db_file("db.csv");
+  const std::string kernel_db_file("index.bin");
   fs::path test_db_path = fs::temp_directory_path() / kernel_db_dir;
   if (fs::is_directory(test_db_path)) {
     fs::remove_all(test_db_path);
@@ -68,6 +68,33 @@ TEST_F(NVFuserTest, KernelDb_Write_CUDA) {
     FAIL() << "Unexpected failure while writing existing db entry!" << e.what();
   }
 
+  // Test that the least recently used entry is evicted once the db is full
+  try {
+    auto& small_kernel_db = KernelDb::get(
+        kernel_db_dir,
+        kernel_db_file,
+        true,
+        false,
+        true,
+        /*max_size=*/cubin.size() + code.size() + 4096);
+    ASSERT_TRUE(small_kernel_db.enabled());
+    ASSERT_TRUE(small_kernel_db.size() == 1);
+    const std::string other_code = code + "\n// other kernel\n";
+    ASSERT_TRUE(small_kernel_db.write(
+        other_code, compile_args, kernel_signature, cubin));
+    ASSERT_TRUE(small_kernel_db.size() == 1);
+
+    std::string dummy_name;
+    std::vector<char> dummy_cubin(0);
+    ASSERT_FALSE(
+        small_kernel_db.query(code, compile_args, dummy_name, dummy_cubin));
+    ASSERT_TRUE(small_kernel_db.query(
+        other_code, compile_args, dummy_name, dummy_cubin));
+    SUCCEED();
+  } catch (const std::exception& e) {
+    FAIL() << "Unexpected failure while evicting db entry!" << e.what();
+  }
+
   // Cleanup DB Directory
   if (fs::is_directory(test_db_path)) {
     fs::remove_all(test_db_path);
@@ -0,0 +1,153 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#include <tests/cpp/multidevice_transformer.h>
+
+#include <ir/builder.h>
+#include <multidevice/utils.h>
+#include <ops/all_ops.h>
+
+namespace nvfuser {
+
+std::vector<TensorView*> mlp(
+    TensorView* x,
+    TensorView* w0,
+    TensorView* b0,
+    TensorView* w1,
+    TensorView* b1,
+    const DeviceMesh& mesh,
+    DataType dtype) {
+  // Linear #1
+  TensorView* matmul1 = matmul(x, w0);
+  TensorView* b0_bcast = broadcast(b0, {false, true, false});
+  TensorView* linear1 = add(matmul1, b0_bcast);
+  // GeLU
+  TensorView* gelu = tanh_gelu(linear1);
+  gelu = castOp(dtype, gelu);
+  // Linear #2
+  TensorView* local_matmul2 = matmul(gelu, w1);
+  TensorView* matmul2 = sum(local_matmul2, {0}); // Allreduce
+  TensorView* bcast_bias = broadcast(b1, {true, false});
+  TensorView* linear2 = add(matmul2, bcast_bias);
+  // Dropout
+  Val* prob = IrBuilder::create<Val>(1.0 - kDropoutProb);
+  Val* scale = IrBuilder::create<Val>(1.0 / (1.0 - kDropoutProb));
+  auto dropout_result = dropout(linear2, prob, scale).output;
+
+  // Manual sharding annotations
+  for (auto tv : {x, b1, matmul2, linear2, dropout_result}) {
+    tv->setDeviceMesh(mesh);
+  }
+  for (auto tv : {w0, b0, w1, linear1, gelu}) {
+    tv->setDeviceMesh(mesh);
+    tv->axis(0)->parallelize(ParallelType::DIDx);
+  }
+
+  return {linear1, gelu, linear2, dropout_result};
+}
+
+std::vector<TensorView*> mha(
+    TensorView* x,
+    TensorView* w0,
+    TensorView* b0,
+    TensorView* w1,
+    TensorView* b1,
+    const DeviceMesh& mesh,
+    DataType dtype) {
+  // Linear 1
+  TensorView* mm = matmul(x, w0);
+  TensorView* proj_bias_bcast = broadcast(b0, {false, true, false});
+  TensorView* qkv1 = add(mm, proj_bias_bcast);
+  // Forming the q,k,v vectors:
+  auto D = w0->axis(0)->extent()->value().as<int64_t>();
+  TensorView* qkv = reshape(qkv1, {D, B * S, 3 * E / D}, {D, B, S, 3 * E / D});
+  std::vector<TensorView*> qkv_reshaped = {};
+  for (auto i : c10::irange(3)) {
+    TensorView* tv_slice =
+        slice(qkv, {0, 0, 0, E / D * i}, {D, B, S, E / D * (i + 1)});
+    TensorView* tv_reshape =
+        reshape(tv_slice, {D, B, S, E / D}, {D, B, S, H / D, E / H});
+    TensorView* tv_trans = transpose(tv_reshape, 2, 3);
+    TensorView* tv_cast = castOp(dtype, tv_trans);
+    qkv_reshaped.push_back(tv_cast);
+    // Explicitly shard qkv before calling SDPA node
+    for (auto tv : {tv_slice, tv_reshape, tv_trans, tv_cast}) {
+      tv->setDeviceMesh(mesh);
+      tv->axis(0)->parallelize(ParallelType::DIDx);
+    }
+  }
+  // SDPA
+  SdpfaFwdResult sdpa = sdpfa_fwd(
+      qkv_reshaped[0],
+      qkv_reshaped[1],
+      qkv_reshaped[2],
+      IrBuilder::create<Val>(kSdpaProb),
+      IrBuilder::create<Val>(true),
+      IrBuilder::create<Val>(kSdpaScale));
+  TensorView* sdpa_output = sdpa.output;
+  // Linear projection
+  TensorView* sdpa_transpose = transpose(sdpa_output, 2, 3);
+  TensorView* sdpa_reshape =
+      reshape(sdpa_transpose, {D, B, S, H / D, E / H}, {D, B * S, E / D});
+  TensorView* mm2 = matmul(sdpa_reshape, w1);
+  TensorView* mm2_ar = sum(mm2, {0}); // allreduce
+  TensorView* b1_bcast = broadcast(b1, {true, false});
+  TensorView* linear2 = add(mm2_ar, b1_bcast);
+  // Dropout
+  Val* prob = IrBuilder::create<Val>(1.0 - kDropoutProb);
+  Val* scale = IrBuilder::create<Val>(1.0 / (1.0 - kDropoutProb));
+  auto dropout_result = dropout(linear2, prob, scale).output;
+
+  for (auto tv : {x, b1, mm2_ar, linear2, dropout_result}) {
+    tv->setDeviceMesh(mesh);
+  }
+  for (auto tv : {w0, b0, w1, mm2, qkv, sdpa_output}) {
+    tv->setDeviceMesh(mesh);
+    tv->axis(0)->parallelize(ParallelType::DIDx);
+  }
+  return {qkv, sdpa_output, linear2, dropout_result};
+}
+
+std::vector<TensorView*> transformerForward(
+    TensorView* x,
+    TensorView* mha_w0,
+    TensorView* mha_b0,
+    TensorView* mha_w1,
+    TensorView* mha_b1,
+    TensorView* mlp_w0,
+    TensorView* mlp_b0,
+    TensorView* mlp_w1,
+    TensorView* mlp_b1,
+    const DeviceMesh& mesh,
+    DataType dtype) {
+  constexpr float kEps = 1e-5;
+  auto eps = IrBuilder::create<Val>(kEps);
+  std::vector<int64_t> norm_shape{E};
+
+  auto ln_1 =
+      layer_norm(x, norm_shape, /*weight=*/nullptr, /*bias=*/nullptr, eps);
+  auto mha_in = castOp(dtype, ln_1.output);
+  auto mha_out = mha(mha_in, mha_w0, mha_b0, mha_w1, mha_b1, mesh, dtype)[3];
+  auto resid_1 = add(x, mha_out);
+  auto ln_2 = layer_norm(
+      resid_1, norm_shape, /*weight=*/nullptr, /*bias=*/nullptr, eps);
+  auto mlp_in = castOp(dtype, ln_2.output);
+  auto mlp_out = mlp(mlp_in, mlp_w0, mlp_b0, mlp_w1, mlp_b1, mesh, dtype)[3];
+  auto resid_2 = add(mha_out, mlp_out);
+
+  for (auto tv : {x, ln_1.output, ln_2.output, resid_2}) {
+    tv->setDeviceMesh(mesh);
+  }
+
+  shardBetween({mha_in->definition()}, {mha_out->definition()}, mha_w0);
+  shardBetween({mlp_in->definition()}, {mlp_out->definition()}, mlp_w0);
+  shardBetween({x}, {mha_in}, x);
+
+  return {ln_1.output, mha_out, ln_2.output, mlp_out, resid_2};
+}
+
+} // namespace nvfuser
@@ -0,0 +1,73 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#pragma once
+
+#include <ir/interface_nodes.h>
+#include <multidevice/device_mesh.h>
+#include <type.h>
+
+#include <vector>
+
+// The tensor parallel transformer layer of test_multidevice_transformer.cpp,
+// shared with the multidevice benchmarks.
+
+namespace nvfuser {
+
+constexpr int64_t B = 2, E = 768, H = 12, S = 128;
+// Note parameters scaled by kParamScale following weight initialization
+// recommendations:
+// https://huggingface.co/docs/transformers/en/model_doc/gpt2#transformers.GPT2Config.initializer_range
+// Note: Sdpa probability is set to 0. Since the dropout mask is sharded it
+// throws off the seed offset between the sharded nvFuser program and the
+// unsharded reference.
+constexpr double kDropoutProb = 0.1, kParamScale = 0.02, kSdpaProb = 0.0,
+                 kSdpaScale = 1e-3;
+
+// Sharded MLP block. The weights and biases of the first linear layer are
+// sharded column-wise and the weights of the second one row-wise, so that the
+// block needs one allreduce. Returns the outputs of the first linear layer,
+// the GeLU, the second linear layer and the dropout.
+std::vector<TensorView*> mlp(
+    TensorView* x,
+    TensorView* w0,
+    TensorView* b0,
+    TensorView* w1,
+    TensorView* b1,
+    const DeviceMesh& mesh,
+    DataType dtype);
+
+// Sharded multi-headed attention block, with the heads sharded across
+// devices, so that the block needs one allreduce. Returns the qkv projection,
+// the SDPA output, the output projection and the dropout.
+std::vector<TensorView*> mha(
+    TensorView* x,
+    TensorView* w0,
+    TensorView* b0,
+    TensorView* w1,
+    TensorView* b1,
+    const DeviceMesh& mesh,
+    DataType dtype);
+
+// Forward of a whole transformer layer: layer norm, MHA, residual, layer norm,
+// MLP and residual. x is [B * S, E] and unsharded, the weights and biases are
+// sharded as in mha and mlp. Returns the output of the first layer norm, of
+// MHA, of the second layer norm, of MLP and of the layer.
+std::vector<TensorView*> transformerForward(
+    TensorView* x,
+    TensorView* mha_w0,
+    TensorView* mha_b0,
+    TensorView* mha_w1,
+    TensorView* mha_b1,
+    TensorView* mlp_w0,
+    TensorView* mlp_b0,
+    TensorView* mlp_w1,
+    TensorView* mlp_b1,
+    const DeviceMesh& mesh,
+    DataType dtype);
+
+} // namespace nvfuser
@@ -181,6 +181,37 @@ TEST_F(NVFuserTest, PyFusionCache_CUDA) {
       FAIL() << "An unexpected assert on cache lookup!" << e.what();
     }
   }
+
+  // Verify the lookup of a complete fusion by the fingerprint of its records.
+  {
+    std::vector<std::unique_ptr<RecordFunctor>> records;
+    records.emplace_back(new TensorRecord(
+        {State(0, serde::StateType::Tensor)}, {3}, {true}, DataType::Float));
+    size_t fingerprint =
+        FusionCache::extendFingerprint(0, records.back().get());
+
+    auto terminal = fc->queryFingerprint(fingerprint, records);
+    ASSERT_TRUE(terminal.has_value());
+    EXPECT_TRUE(terminal.value()->isTerminal());
+    EXPECT_EQ(terminal.value()->fusion_id, 0);
+
+    // The records are verified, so a fingerprint collision is a miss.
+    std::vector<std::unique_ptr<RecordFunctor>> other_records;
+    other_records.emplace_back(new ScalarRecord(
+        {State(0, serde::StateType::Scalar)},
+        std::monostate{},
+        DataType::Float));
+    EXPECT_FALSE(fc->queryFingerprint(fingerprint, other_records).has_value());
+
+    // A node was created for this record but the fusion was not completed.
+    records.emplace_back(new ScalarRecord(
+        {State(1, serde::StateType::Scalar)},
+        std::monostate{},
+        DataType::Float));
+    fingerprint =
+        FusionCache::extendFingerprint(fingerprint, records.back().get());
+    EXPECT_FALSE(fc->queryFingerprint(fingerprint, records).has_value());
+  }
 }
 
 } // namespace nvfuser
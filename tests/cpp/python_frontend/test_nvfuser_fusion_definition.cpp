@@ -173,4 +173,60 @@ TEST_F(NVFuserTest, FusionDefinition_CUDA) {
   }
 }
 
+
+// Records with unused outputs are not built into the Fusion, and scalars
+// computed from constants are folded
+TEST_F(NVFuserTest, FusionDefinitionSimplification_CUDA) {
+  FusionDefinition fd(std::nullopt, 10);
+  fd.setupDefinition();
+
+  auto t0 = fd.defineTensor(2);
+  fd.defineRecord(new TensorRecord(
+      {fd.recordingState(t0())}, {-1, -1}, {true, true}, DataType::Float));
+  auto s1 = fd.defineScalar();
+  fd.defineRecord(
+      new ScalarRecord({fd.recordingState(s1())}, 2.0, DataType::Double));
+  auto s2 = fd.defineScalar();
+  fd.defineRecord(
+      new ScalarRecord({fd.recordingState(s2())}, 3.0, DataType::Double));
+  auto s3 = fd.defineScalar();
+  fd.defineRecord(new OpRecord<Val*, Val*, Val*>(
+      {fd.recordingState(s1()), fd.recordingState(s2())},
+      {fd.recordingState(s3())},
+      "ops.mul",
+      serde::RecordType::Binary_VAL,
+      static_cast<Val* (*)(Val*, Val*)>(mul)));
+  auto t4 = fd.defineTensor(2);
+  fd.defineRecord(new OpRecord<TensorView*, TensorView*, Val*>(
+      {fd.recordingState(t0()), fd.recordingState(s3())},
+      {fd.recordingState(t4())},
+      "ops.mul",
+      serde::RecordType::Binary_TV_VAL,
+      static_cast<TensorView* (*)(TensorView*, Val*)>(mul)));
+  // Unused
+  auto t5 = fd.defineTensor(2);
+  fd.defineRecord(new OpRecord<TensorView*, TensorView*>(
+      {fd.recordingState(t0())},
+      {fd.recordingState(t5())},
+      "ops.neg",
+      serde::RecordType::Unary_TV,
+      static_cast<TensorView* (*)(TensorView*)>(neg)));
+  fd.defineRecord(new OutputRecord<TensorView>(
+      {fd.recordingState(t4())}, serde::RecordType::OutputTv));
+  fd.finalizeDefinition();
+
+  Fusion* fusion = fd.preschedFusion();
+  for (Expr* expr : fusion->unordered_exprs()) {
+    EXPECT_FALSE(
+        expr->isA<UnaryOp>() &&
+        expr->as<UnaryOp>()->getUnaryOpType() == UnaryOpType::Neg)
+        << expr->toString();
+  }
+  std::vector<Expr*> exprs = fusion->exprs();
+  ASSERT_EQ(exprs.size(), 1);
+  Val* factor = exprs.front()->input(1);
+  ASSERT_TRUE(factor->isConstScalar());
+  EXPECT_DOUBLE_EQ(factor->value().as<double>(), 6.0);
+}
+
 } // namespace nvfuser
@@ -15,6 +15,7 @@
 #include <fusion.h>
 #include <fusion_profiler.h>
 #include <ir/utils.h>
+#include <multi_tensor_apply.h>
 #include <ops/alias.h>
 #include <ops/arith.h>
 #include <sys_utils.h>
@@ -249,6 +250,32 @@ TEST_F(AliasTest, SliceRightOfBroadcast) {
       __FILE__);
 }
 
+TEST_F(AliasTest, NegativePad) {
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+
+  TensorView* in = makeContigConcreteTensor({4, 6, 7});
+  fusion->addInput(in);
+  // Removes one element from the left and two from the right of the innermost
+  // dimension, which is a slice.
+  TensorView* out =
+      pad(in, {IrBuilder::create<Val>(-1L), IrBuilder::create<Val>(-2L)});
+  fusion->addOutput(out);
+
+  FusionExecutorCache fec(std::move(fusion));
+  at::Tensor in_tensor = at::randn({4, 6, 7}).cuda();
+  at::Tensor out_tensor = fec.runFusionWithInputs({in_tensor})[0];
+  EXPECT_EQ(out_tensor.data_ptr<float>(), in_tensor.data_ptr<float>() + 1);
+  EXPECT_THAT(out_tensor.strides(), ElementsAre(42, 7, 1));
+
+  testValidate(
+      fec.fusion(),
+      {in_tensor.slice(/*dim=*/2, /*start=*/1, /*end=*/5)},
+      {in_tensor},
+      __LINE__,
+      __FILE__);
+}
+
 TEST_F(AliasTest, SliceViewPermute) {
   auto fusion = std::make_unique<Fusion>();
   FusionGuard fg(fusion.get());
@@ -977,6 +1004,98 @@ TEST_F(AliasTest, ReuseBuffer_FusionExecutor) {
   EXPECT_TRUE(tensor.allclose(expected_tensor));
 }
 
+// An Adam step with bf16 parameters and fp32 master weights, updating every
+// tensor of the lists in place with one kernel
+TEST_F(AliasTest, MultiTensorApply_Adam) {
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+  TensorView* param = makeContigTensor(1, DataType::BFloat16);
+  TensorView* master = makeContigTensor(1);
+  TensorView* grad = makeContigTensor(1);
+  TensorView* exp_avg = makeContigTensor(1);
+  TensorView* exp_avg_sq = makeContigTensor(1);
+  for (TensorView* tv : {param, master, grad, exp_avg, exp_avg_sq}) {
+    fusion->addInput(tv);
+  }
+  Val* lr = IrBuilder::create<Val>(DataType::Double);
+  fusion->addInput(lr);
+  constexpr double kBeta1 = 0.9;
+  constexpr double kBeta2 = 0.999;
+  constexpr double kEps = 1e-8;
+
+  auto lerp_to = [](TensorView* x, TensorView* target, double beta) {
+    return add(
+        mul(x, IrBuilder::create<Val>(beta)),
+        mul(target, IrBuilder::create<Val>(1.0 - beta)));
+  };
+  TensorView* new_exp_avg = lerp_to(exp_avg, grad, kBeta1);
+  TensorView* new_exp_avg_sq = lerp_to(exp_avg_sq, mul(grad, grad), kBeta2);
+  TensorView* new_master = sub(
+      master,
+      mul(div(new_exp_avg,
+              add(sqrt(new_exp_avg_sq), IrBuilder::create<Val>(kEps))),
+          lr));
+  TensorView* new_param = castOp(DataType::BFloat16, new_master);
+  for (auto [out, in] :
+       {std::make_pair(new_param, param),
+        std::make_pair(new_master, master),
+        std::make_pair(new_exp_avg, exp_avg),
+        std::make_pair(new_exp_avg_sq, exp_avg_sq)}) {
+    fusion->addOutput(out);
+    fusion->aliasOutputToInput(out, in, AllocationType::ReuseBuffer);
+  }
+
+  const std::vector<std::vector<int64_t>> shapes = {
+      {1000, 33}, {7}, {256, 256}, {1}, {3, 5, 129}};
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  std::vector<at::Tensor> masters =
+      MultiTensorApply::allocateFlat(shapes, options);
+  std::vector<at::Tensor> params =
+      MultiTensorApply::allocateFlat(shapes, options.dtype(at::kBFloat16));
+  std::vector<at::Tensor> exp_avgs =
+      MultiTensorApply::allocateFlat(shapes, options);
+  // Not back to back in memory, so they are packed and copied back
+  std::vector<at::Tensor> exp_avg_sqs;
+  std::vector<at::Tensor> grads;
+  for (auto i : c10::irange(shapes.size())) {
+    masters.at(i).normal_();
+    params.at(i).copy_(masters.at(i));
+    exp_avgs.at(i).normal_();
+    exp_avg_sqs.push_back(at::rand(shapes.at(i), options));
+    grads.push_back(at::randn(shapes.at(i), options));
+  }
+
+  std::vector<at::Tensor> expected_masters;
+  std::vector<at::Tensor> expected_exp_avgs;
+  std::vector<at::Tensor> expected_exp_avg_sqs;
+  constexpr double kLr = 1e-3;
+  for (auto i : c10::irange(shapes.size())) {
+    const at::Tensor& g = grads.at(i);
+    expected_exp_avgs.push_back(exp_avgs.at(i) * kBeta1 + g * (1.0 - kBeta1));
+    expected_exp_avg_sqs.push_back(
+        exp_avg_sqs.at(i) * kBeta2 + g * g * (1.0 - kBeta2));
+    expected_masters.push_back(
+        masters.at(i) -
+        expected_exp_avgs.back() / (expected_exp_avg_sqs.back().sqrt() + kEps) *
+            kLr);
+  }
+
+  MultiTensorApply adam(std::move(fusion));
+  adam.run({params, masters, grads, exp_avgs, exp_avg_sqs}, {kLr});
+
+  FusionKernelRuntime* runtime =
+      adam.executorCache().getMostRecentKernelRuntime();
+  EXPECT_FALSE(runtime->isSegmented());
+  for (auto i : c10::irange(shapes.size())) {
+    EXPECT_TRUE(at::allclose(masters.at(i), expected_masters.at(i)));
+    EXPECT_TRUE(at::allclose(exp_avgs.at(i), expected_exp_avgs.at(i)));
+    EXPECT_TRUE(at::allclose(exp_avg_sqs.at(i), expected_exp_avg_sqs.at(i)));
+    EXPECT_TRUE(at::allclose(
+        params.at(i).to(at::kFloat),
+        expected_masters.at(i).to(at::kBFloat16).to(at::kFloat)));
+  }
+}
+
 TEST_F(AliasTest, ReuseBuffer_AliasAcrossSegments) {
   auto fusion = std::make_unique<Fusion>();
   FusionGuard fg(fusion.get());
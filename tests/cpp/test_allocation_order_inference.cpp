@@ -297,6 +297,38 @@ TEST_F(AllocationOrderInferenceTest, ReductionOpPropagation) {
   EXPECT_THAT(getAllocationDomainPermutation(tv5), ElementsAre(0, 3, 2, 1));
 }
 
+TEST_F(AllocationOrderInferenceTest, MajorityVotePropagation) {
+  auto fusion_ptr = std::make_unique<Fusion>();
+  Fusion& fusion = *fusion_ptr.get();
+  FusionGuard fg(&fusion);
+
+  // Two channels-last inputs and a channels-first one, all full-sized.
+  auto tv0 = makeSymbolicTensor({-1, -1, -1, -1});
+  fusion.addInput(tv0);
+  auto tv1 = makeSymbolicTensor({-1, -1, -1, -1});
+  fusion.addInput(tv1);
+  auto tv2 = makeSymbolicTensor({-1, -1, -1, -1});
+  fusion.addInput(tv2);
+  auto tv3 = add(tv0, tv1);
+  auto tv4 = add(tv3, tv2);
+  fusion.addOutput(tv4);
+  // tv5 only depends on one input of each layout, which is ambiguous.
+  auto tv5 = add(tv1, tv2);
+  fusion.addOutput(tv5);
+
+  std::vector<IterDomain*> tv0_nhwc = {
+      tv0->axis(0), tv0->axis(2), tv0->axis(3), tv0->axis(1)};
+  tv0->setAllocationDomain(tv0_nhwc, true);
+  std::vector<IterDomain*> tv1_nhwc = {
+      tv1->axis(0), tv1->axis(2), tv1->axis(3), tv1->axis(1)};
+  tv1->setAllocationDomain(tv1_nhwc, true);
+
+  preseg_passes::inferenceAllocationOrder(
+      &fusion, {tv0, tv1, tv2}, {tv4, tv5});
+  EXPECT_THAT(getAllocationDomainPermutation(tv4), ElementsAre(0, 2, 3, 1));
+  EXPECT_FALSE(tv5->hasAllocation());
+}
+
 TEST_F(AllocationOrderInferenceTest, EnableInRuntime) {
   auto fusion = std::make_unique<Fusion>();
   FusionGuard fg(fusion.get());
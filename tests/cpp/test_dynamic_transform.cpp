@@ -1466,4 +1466,69 @@ TEST_F(NVFuserTest, DynamicSqueezeTrivialWelford) {
   testValidate(fusion, outputs, inputs, __LINE__, __FILE__);
 }
 
+// Test that where ops with predicates computed from input extents are replaced
+// by the selected branch at concretization
+TEST_F(NVFuserTest, DynamicWherePredicate) {
+  std::unique_ptr<Fusion> fusion_ptr = std::make_unique<Fusion>();
+  Fusion* fusion = fusion_ptr.get();
+  FusionGuard fg(fusion);
+
+  auto tv0 = makeSymbolicTensor(2);
+  fusion->addInput(tv0);
+
+  auto tv1 = sin(tv0);
+  auto tv2 = cos(tv0);
+  auto pred = gt(tv0->axis(0)->extent(), IrBuilder::create<Val>(4L));
+  auto tv3 = where(pred, tv1, tv2);
+  fusion->addOutput(tv3);
+
+  auto initial_info = DynamicTransform::getInitialInfo(fusion);
+  EXPECT_EQ(initial_info.getDynamicWhereOutputs().size(), 1);
+
+  auto has_unary_op = [](Fusion* f, UnaryOpType op_type) {
+    auto exprs = f->exprs();
+    return std::any_of(exprs.begin(), exprs.end(), [&](Expr* expr) {
+      auto uop = dynamic_cast<UnaryOp*>(expr);
+      return uop != nullptr && uop->getUnaryOpType() == op_type;
+    });
+  };
+
+  for (int64_t extent : {8L, 2L}) {
+    Fusion concretized_fusion(*fusion);
+    FusionGuard concretized_fg(&concretized_fusion);
+    auto concretized_tv0 = concretized_fusion.inputs().at(0)->as<TensorView>();
+
+    ExpressionEvaluator expr_eval;
+    expr_eval.bind(concretized_tv0->axis(0)->extent(), extent);
+    expr_eval.bind(concretized_tv0->axis(1)->extent(), 3L);
+
+    auto concretized_initial_info =
+        DynamicTransform::getInitialInfo(&concretized_fusion);
+    auto info = DynamicTransformConcretizationInfo(
+        &concretized_initial_info, &expr_eval);
+    EXPECT_THAT(
+        info.getWherePredicateValues(),
+        ::testing::ElementsAre(extent > 4));
+
+    DynamicTransform::concretizeFusion(&concretized_fusion, &info);
+    EXPECT_EQ(
+        has_unary_op(&concretized_fusion, UnaryOpType::Sin), extent > 4);
+    EXPECT_EQ(
+        has_unary_op(&concretized_fusion, UnaryOpType::Cos), extent <= 4);
+  }
+
+  FusionExecutorCache executor_cache(std::move(fusion_ptr));
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  for (int64_t extent : {8L, 6L, 2L}) {
+    at::Tensor t0 = at::randn({extent, 3}, options);
+    std::vector<c10::IValue> inputs = {t0};
+    auto cg_outputs = executor_cache.runFusionWithInputs(inputs);
+    testValidate(
+        executor_cache.fusion(), cg_outputs, inputs, __LINE__, __FILE__);
+  }
+  // Both inputs with extents larger than 4 use the same concretization
+  EXPECT_EQ(executor_cache.countConcretizations(), 2);
+}
+
 } // namespace nvfuser
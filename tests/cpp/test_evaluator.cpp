@@ -814,4 +814,37 @@ TEST_F(ExprEvalTest, TensorMetadataPrecomputedValues) {
   checkIntValue(evaluator, logical_size_1, 4);
 }
 
+// Binding and evaluating with slots behaves like with maps, including for
+// Vals created after the slots were assigned, and clear() forgets everything
+TEST_F(ExprEvalTest, Slots) {
+  Fusion fusion;
+  FusionGuard fg(&fusion);
+
+  auto* a = IrBuilder::create<Val>(DataType::Int);
+  auto* b = IrBuilder::create<Val>(DataType::Int);
+  auto* c = add(a, b);
+
+  ExpressionEvaluator evaluator;
+  evaluator.assignSlots(&fusion);
+  auto* d = mul(c, a);
+
+  for (int64_t run : c10::irange(3)) {
+    EXPECT_FALSE(evaluator.isKnown(a));
+    EXPECT_FALSE(evaluator.evaluate(d).hasValue());
+    evaluator.bind(a, run);
+    evaluator.bind(b, 7L);
+    checkIntValue(evaluator, c, run + 7);
+    checkIntValue(evaluator, d, (run + 7) * run);
+    EXPECT_TRUE(evaluator.isKnown(c));
+    EXPECT_TRUE(evaluator.isKnown(d));
+
+    evaluator.invalidate(c);
+    EXPECT_FALSE(evaluator.isKnown(c));
+    evaluator.bind(c, 1L);
+    evaluator.invalidate(d);
+    checkIntValue(evaluator, d, run);
+    evaluator.clear();
+  }
+}
+
 } // namespace nvfuser
@@ -1201,4 +1201,33 @@ TEST_F(ExprSimplifierTest, OrderTransitivity) {
 #undef EXPECT_VALUE_TRUE
 }
 
+TEST_F(ExprSimplifierTest, Memoization) {
+  ExprSimplifierCache cache;
+  auto simplify = [](Val* assumption) {
+    return simplifyExpr("( ( 8 * i0 ) + i1 ) % 128"_, {}, {assumption});
+  };
+
+  Val* first = simplify("0 <= i0 && i0 < 32 && 0 <= i1 && i1 < 8"_);
+  EXPECT_TRUE(first->sameAs("( i0 % 16 ) * 8 + i1"_));
+  // Structurally identical expression and assumptions
+  EXPECT_EQ(simplify("0 <= i0 && i0 < 32 && 0 <= i1 && i1 < 8"_), first);
+  EXPECT_EQ(cache.hits(), 1);
+
+  // Different assumptions
+  EXPECT_NE(simplify("0 <= i0 && 0 <= i1"_), first);
+  EXPECT_EQ(cache.hits(), 1);
+  EXPECT_EQ(cache.misses(), 2);
+}
+
+TEST_F(ExprSimplifierTest, PassBudget) {
+  EnableOptionsGuard opt_guard;
+  EnableOptionsGuard::getCurOptions().set(
+      EnableOption::ExprSimplifyBudget, {"0"});
+  EXPECT_FALSE(simplifyExpr("i - i"_)->isZeroInt());
+
+  EnableOptionsGuard::getCurOptions().set(
+      EnableOption::ExprSimplifyBudget, {"100"});
+  EXPECT_TRUE(simplifyExpr("i - i"_)->isZeroInt());
+}
+
 } // namespace nvfuser
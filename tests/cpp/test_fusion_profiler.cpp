@@ -231,4 +231,77 @@ TEST_F(FusionProfilerTest, FusionProfilerErrorChecks) {
   }
 }
 
+// A pointwise kernel has no matmul FLOPs and is reported as memory-bound,
+// along with its occupancy and register spills.
+TEST_F(FusionProfilerTest, Roofline) {
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+  ProfilerOptionsGuard::getCurOptions().unset(ProfilerOption::EnableNocupti);
+  ProfilerOptionsGuard::getCurOptions().set(ProfilerOption::Enable);
+
+  auto shape = std::vector<int64_t>({1024, 1024});
+  auto tv0 = makeConcreteTensor(shape);
+  fusion->addInput(tv0);
+  auto tv1 = sin(tv0);
+  fusion->addOutput(tv1);
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  auto t0 = at::randn(shape, options);
+
+  FusionExecutorCache executor_cache(std::move(fusion));
+  executor_cache.runFusionWithInputs({t0});
+
+  const FusionProfile& fprof = FusionProfiler::profile();
+  ASSERT_EQ(fprof.kernel_profiles.size(), 1);
+  const KernelProfile& kprof = fprof.kernel_profiles.at(0);
+  EXPECT_EQ(kprof.flops, 0);
+  EXPECT_EQ(kprof.achieved_tflops, 0.0);
+  EXPECT_EQ(kprof.bound, KernelBound::Memory);
+  EXPECT_GT(kprof.occupancy, 0.0);
+  EXPECT_LE(kprof.occupancy, 100.0);
+  EXPECT_EQ(kprof.register_spills, 0);
+  EXPECT_THAT(fprof.rooflineReport(), ::testing::HasSubstr("memory"));
+}
+
+// With kernel_profile(regions), the loop nests and syncs of a reduction
+// kernel are timed, and the shares of the regions add up to the whole
+// kernel.
+TEST_F(FusionProfilerTest, KernelRegions) {
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+  ProfilerOptionsGuard::getCurOptions().unset(ProfilerOption::EnableNocupti);
+  ProfilerOptionsGuard::getCurOptions().set(ProfilerOption::Enable);
+  EnableOptionsGuard opt_guard;
+  EnableOptionsGuard::getCurOptions().set(
+      EnableOption::KernelProfile, {"regions"});
+
+  auto shape = std::vector<int64_t>({1024, 1024});
+  auto tv0 = makeConcreteTensor(shape);
+  fusion->addInput(tv0);
+  auto tv1 = sum(sin(tv0), {1});
+  fusion->addOutput(tv1);
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  auto t0 = at::randn(shape, options);
+
+  FusionExecutorCache executor_cache(std::move(fusion));
+  auto outputs = executor_cache.runFusionWithInputs({t0});
+  testValidate(executor_cache.fusion(), outputs, {t0}, __LINE__, __FILE__);
+
+  const FusionProfile& fprof = FusionProfiler::profile();
+  ASSERT_EQ(fprof.kernel_profiles.size(), 1);
+  const KernelProfile& kprof = fprof.kernel_profiles.at(0);
+  ASSERT_FALSE(kprof.regions.empty());
+
+  double total_percentage = 0.0;
+  int64_t total_hits = 0;
+  for (const KernelRegionProfile& region : kprof.regions) {
+    total_percentage += region.percentage;
+    total_hits += region.hits;
+  }
+  EXPECT_GT(total_hits, 0);
+  EXPECT_NEAR(total_percentage, 100.0, 1.0);
+  EXPECT_THAT(fprof.regionReport(), ::testing::HasSubstr("Breakdown"));
+}
+
 } // namespace nvfuser
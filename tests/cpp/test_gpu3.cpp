@@ -12,6 +12,7 @@
 #include <abstract_tensor.h>
 #include <codegen.h>
 #include <debug.h>
+#include <device_lower/analysis/register_pressure.h>
 #include <device_lower/lower2device.h>
 #include <device_lower/pass/magic_zero.h>
 #include <device_lower/pass/replace_size.h>
@@ -21,6 +22,7 @@
 #include <expr_evaluator.h>
 #include <fusion.h>
 #include <fusion_segmenter.h>
+#include <global_allocator.h>
 #include <grouped_reduction.h>
 #include <id_model/id_model.h>
 #include <inlining.h>
@@ -3173,6 +3175,97 @@ to: 2
   NVF_CHECK(printer2.ss.str() == expect);
 }
 
+// The paths of the trees of a reference are reused until the tensor graph
+// changes. See Note [Spanning tree cache]
+TEST_F(NVFuserTest, FusionMaxLogicalDomainInfoSpanningTreeCache_CUDA) {
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+
+  auto tv0 = makeSymbolicTensor(2);
+  fusion->addInput(tv0);
+  auto tv1 = sum(tv0, {1});
+  auto tv2 = neg(tv1);
+  fusion->addOutput(tv2);
+
+  struct Printer : public MaxInfoSpanningTree::Propagator {
+    std::stringstream ss;
+    void propagateC2P(TensorView* from, TensorView* to) override {
+      ss << "C2P " << from->name() << " " << to->name() << std::endl;
+    }
+    void propagateP2C(TensorView* from, TensorView* to) override {
+      ss << "P2C " << from->name() << " " << to->name() << std::endl;
+    }
+    void propagateSibling(TensorView* from, TensorView* to) override {
+      ss << "Sibling " << from->name() << " " << to->name() << std::endl;
+    }
+  };
+  auto print_path = [](TensorView* reference,
+                       MaxInfoSpanningTree::Selector* selector = nullptr) {
+    Printer printer;
+    MaxLogicalDomainInfoSpanningTree(reference, selector).traverse(&printer);
+    return printer.ss.str();
+  };
+
+  const std::string path = print_path(tv1);
+  EXPECT_EQ(path, "C2P 1 0\nP2C 1 2\n");
+
+  // Loop transforms do not change the tree
+  tv2->split(0, 4);
+  TransformPropagatorWithCheck propagator(tv2);
+  MaxLogicalDomainInfoSpanningTree(tv2).traverse(&propagator);
+  EXPECT_EQ(print_path(tv1), path);
+
+  // A new tensor is added to the tree
+  auto tv3 = tv0->cacheAfter();
+  EXPECT_EQ(
+      print_path(tv1),
+      "C2P 1 " + std::to_string(tv3->name()) + "\nC2P " +
+          std::to_string(tv3->name()) + " 0\nP2C 1 2\n");
+
+  // The trees built with a selector are not cached
+  SetSelector selector({tv1, tv2});
+  EXPECT_EQ(print_path(tv1, &selector), "P2C 1 2\n");
+}
+
+TEST_F(NVFuserTest, FusionCachedExprsAndReductionTvs_CUDA) {
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+
+  auto tv0 = makeSymbolicTensor(2);
+  fusion->addInput(tv0);
+  auto tv1 = sum(tv0, {1});
+  fusion->addOutput(tv1);
+
+  // Nothing changed, so the same order is returned
+  const int64_t epoch = fusion->mutationEpoch();
+  const std::vector<Expr*> exprs = fusion->exprs();
+  EXPECT_EQ(fusion->exprs(), exprs);
+  EXPECT_EQ(
+      scheduler_utils::getReductionTvs(fusion.get()),
+      std::vector<TensorView*>{tv1});
+  EXPECT_EQ(fusion->mutationEpoch(), epoch);
+
+  // A new op invalidates the cached order
+  auto tv2 = sum(tv1, {0});
+  fusion->addOutput(tv2);
+  EXPECT_NE(fusion->mutationEpoch(), epoch);
+  EXPECT_EQ(fusion->exprs(), StmtSort::getExprs(fusion.get()));
+  EXPECT_EQ(fusion->exprs().size(), exprs.size() + 1);
+  EXPECT_EQ(
+      scheduler_utils::getReductionTvs(fusion.get()),
+      (std::vector<TensorView*>{tv1, tv2}));
+
+  // So does a transform that adds a reduction tensor
+  tv1->split(1, 4);
+  auto tv3 = tv1->rFactor({1});
+  auto reduction_tvs = scheduler_utils::getReductionTvs(fusion.get());
+  EXPECT_EQ(reduction_tvs.size(), 3);
+  EXPECT_NE(
+      std::find(reduction_tvs.begin(), reduction_tvs.end(), tv3),
+      reduction_tvs.end());
+  EXPECT_EQ(fusion->exprs(), StmtSort::getExprs(fusion.get()));
+}
+
 TEST_F(NVFuserTest, FusionTransformPropagatorNoOverwrite_CUDA) {
   auto fusion = std::make_unique<Fusion>();
   FusionGuard fg(fusion.get());
@@ -8815,6 +8908,1303 @@ TEST_F(NVFuserTest, ReplaceSymbolicSizes) {
   EXPECT_EQ(tv5->axis(0)->extent()->toInlineString(), "5");
 }
 
+// GpuLower profiles every analysis step and pass, in order
+TEST_F(NVFuserTest, LoweringPassProfiles) {
+  Fusion fusion;
+  FusionGuard fg(&fusion);
+
+  auto tv0 = makeSymbolicTensor(2);
+  fusion.addInput(tv0);
+  auto tv1 = sum(sin(tv0), {1});
+  fusion.addOutput(tv1);
+
+  tv1->split(1, 128);
+  tv1->axis(-1)->parallelize(ParallelType::TIDx);
+  tv1->axis(0)->parallelize(ParallelType::BIDx);
+
+  GpuLower gpulw(&fusion);
+  const size_t num_analysis_steps = gpulw.passProfiles().size();
+  EXPECT_GT(num_analysis_steps, 0);
+  gpulw.run();
+
+  const auto& profiles = gpulw.passProfiles();
+  ASSERT_EQ(profiles.size(), num_analysis_steps + gpulw.passes().size() + 2);
+  EXPECT_EQ(profiles.front().name, "initialize lowering");
+  EXPECT_EQ(profiles.back().name, "finalize");
+  for (const auto& profile : profiles) {
+    EXPECT_GE(profile.time_ms, 0.0) << profile.name;
+  }
+  // Copying the fusion into the kernel creates its nodes
+  EXPECT_GT(profiles.front().node_delta, 0);
+  for (size_t i : c10::irange(gpulw.passes().size())) {
+    EXPECT_EQ(
+        profiles.at(num_analysis_steps + 1 + i).name,
+        gpulw.passes().at(i).first);
+  }
+}
+
+// Back-to-back block syncs are removed and the remaining sync of a
+// single-warp block is a warp sync
+TEST_F(NVFuserTest, ElideRedundantSyncs) {
+  EnableOptionsGuard opt_guard;
+  EnableOptionsGuard::getCurOptions().set(EnableOption::ElideSyncs);
+
+  Fusion fusion;
+  FusionGuard fg(&fusion);
+
+  auto tv0 = makeContigConcreteTensor({32});
+  fusion.addInput(tv0);
+  auto tv1 = set(tv0);
+  auto tv2 = sum(tv1, {0});
+  fusion.addOutput(tv2);
+
+  // Each thread reads all values of tv1 written by the other threads
+  tv1->setMemoryType(MemoryType::Shared);
+  tv1->axis(0)->parallelize(ParallelType::TIDx);
+
+  // Duplicates every block sync to emulate syncs inserted for separate
+  // hazards
+  class SyncDuplicator : public kir::ExprMutator {
+   public:
+    static std::vector<Expr*> run(const std::vector<Expr*>& exprs) {
+      SyncDuplicator duplicator;
+      return duplicator.traverseAndInsert(exprs);
+    }
+
+   private:
+    using kir::ExprMutator::handle;
+
+    void handle(kir::BlockSync* sync) final {
+      registerInsertAfter(sync, IrBuilder::create<kir::BlockSync>());
+    }
+  };
+
+  auto count = [](const std::string& code, const std::string& str) {
+    int64_t n = 0;
+    for (auto pos = code.find(str); pos != std::string::npos;
+         pos = code.find(str, pos + str.size())) {
+      ++n;
+    }
+    return n;
+  };
+
+  GpuLower gpulw(&fusion);
+  auto it = std::find_if(
+      gpulw.passes().begin(), gpulw.passes().end(), [](const auto& pass) {
+        return pass.first == "elideRedundantSyncs";
+      });
+  ASSERT_NE(it, gpulw.passes().end());
+  gpulw.passes().insert(it, {"duplicateSyncs", SyncDuplicator::run});
+  gpulw.run();
+
+  const std::string code = codegen::generateCudaKernel(gpulw.kernel());
+  EXPECT_EQ(count(code, "__syncthreads();"), 0) << code;
+  EXPECT_EQ(count(code, "__syncwarp();"), 1) << code;
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor t0 = at::randn({32}, options);
+
+  FusionExecutor fe;
+  fe.compileFusion(&fusion, {t0});
+  EXPECT_EQ(count(fe.kernelString(), "__syncwarp();"), 1);
+  auto cg_outputs = fe.runFusion({t0});
+
+  testValidate(&fusion, cg_outputs, {t0}, __LINE__, __FILE__);
+}
+
+// The register estimate counts the Local buffers live in each loop
+TEST_F(NVFuserTest, RegisterPressureEstimate) {
+  auto estimate = [](int64_t factor) {
+    Fusion fusion;
+    FusionGuard fg(&fusion);
+
+    auto tv0 = makeSymbolicTensor(2);
+    fusion.addInput(tv0);
+    auto tv1 = set(tv0);
+    auto tv2 = add(tv1, IrBuilder::create<Val>(1.0));
+    fusion.addOutput(tv2);
+
+    tv2->split(1, factor);
+    TransformPropagatorWithCheck propagator(tv2);
+    MaxLogicalDomainInfoSpanningTree(tv2).traverse(&propagator);
+    tv2->axis(0)->parallelize(ParallelType::BIDx);
+    tv2->axis(1)->parallelize(ParallelType::TIDx);
+    scheduler_utils::parallelizeAllLike(tv2);
+    tv1->computeAt(tv2, 2);
+
+    GpuLower gpulw(&fusion);
+    gpulw.run();
+    const kir::Kernel* kernel = gpulw.kernel();
+    const int64_t registers = kernel->summary().estimated_registers_per_thread;
+    EXPECT_EQ(registers, estimateRegistersPerThread(kernel));
+    const auto loop_registers = getRegisterPressureInfo(kernel);
+    EXPECT_FALSE(loop_registers.empty());
+    for (const auto& [loop, loop_live] : loop_registers) {
+      EXPECT_LE(loop_live, registers) << loop->toString();
+    }
+    return registers;
+  };
+
+  const int64_t registers_8 = estimate(8);
+  const int64_t registers_32 = estimate(32);
+  // tv1 holds factor floats per thread
+  EXPECT_GE(registers_8, scheduler_utils::register_overhead + 8);
+  EXPECT_GE(registers_32 - registers_8, 24);
+}
+
+// The loads of long rows of an inner reduction are circular buffered across
+// the serial loop over the row
+TEST_F(NVFuserTest, ReductionLoadPipelining) {
+  EnableOptionsGuard opt_guard;
+  EnableOptionsGuard::getCurOptions().set(EnableOption::PipelineLoads);
+
+  Fusion fusion;
+  FusionGuard fg(&fusion);
+
+  auto tv0 = makeContigTensor(2);
+  fusion.addInput(tv0);
+  auto tv1 = sum(tv0, {1});
+  fusion.addOutput(tv1);
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor t0 = at::randn({4096, 8192}, options);
+
+  auto rparams = getReductionHeuristics(&fusion, {t0});
+  ASSERT_NE(rparams, nullptr);
+  if (rparams->circular_buffer_stages == 1) {
+    GTEST_SKIP() << "Loads are not pipelined on this device: "
+                 << rparams->toString();
+  }
+  EXPECT_EQ(rparams->circular_buffer_stages, 2);
+  scheduleReduction(&fusion, *rparams);
+
+  const auto all_tvs = fusion.allTvs();
+  EXPECT_TRUE(std::any_of(all_tvs.begin(), all_tvs.end(), [](TensorView* tv) {
+    return tv->isCircularBuffered() && tv->circularBufferDepth() == 2;
+  }));
+
+  FusionExecutor fe;
+  fe.compileFusion(&fusion, {t0}, rparams->lparams);
+  auto cg_outputs = fe.runFusion({t0}, rparams->lparams);
+
+  testValidate(&fusion, cg_outputs, {t0}, __LINE__, __FILE__);
+}
+
+// The index of a broadcast tensor in a merged loop is a mod by an extent,
+// which is computed with a precomputed multiplier
+TEST_F(NVFuserTest, FastDivMod) {
+  EnableOptionsGuard opt_guard;
+  EnableOptionsGuard::getCurOptions().set(EnableOption::FastDivMod);
+
+  Fusion fusion;
+  FusionGuard fg(&fusion);
+
+  auto tv0 = makeSymbolicTensor(2);
+  fusion.addInput(tv0);
+  auto tv1 = makeSymbolicTensor(1);
+  fusion.addInput(tv1);
+  auto tv2 = add(tv0, broadcast(tv1, {true, false}));
+  fusion.addOutput(tv2);
+
+  tv2->merge(0);
+  tv2->split(0, 128);
+  TransformPropagatorWithCheck propagator(tv2);
+  MaxLogicalDomainInfoSpanningTree(tv2).traverse(&propagator);
+  tv2->axis(0)->parallelize(ParallelType::BIDx);
+  tv2->axis(1)->parallelize(ParallelType::TIDx);
+  scheduler_utils::parallelizeAllLike(tv2);
+  inlineMost();
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor t0 = at::randn({129, 77}, options);
+  at::Tensor t1 = at::randn({77}, options);
+
+  FusionExecutor fe;
+  fe.compileFusion(&fusion, {t0, t1});
+  EXPECT_NE(fe.kernelString().find("fastMod("), std::string::npos)
+      << fe.kernelString();
+  auto cg_outputs = fe.runFusion({t0, t1});
+  testValidate(&fusion, cg_outputs, {t0, t1}, __LINE__, __FILE__);
+
+  // The multiplier of 1 wraps to 0
+  at::Tensor t2 = at::randn({5, 1}, options);
+  at::Tensor t3 = at::randn({1}, options);
+  cg_outputs = fe.runFusion({t2, t3});
+  testValidate(&fusion, cg_outputs, {t2, t3}, __LINE__, __FILE__);
+}
+
+// The offsets of an expanded input fit in 32 bits, but the reduction over it
+// iterates over more elements than 32-bit indices can hold
+TEST_F(NVFuserTest, IndexTypeOfReductionOfExpandedInput) {
+  Fusion fusion;
+  FusionGuard fg(&fusion);
+
+  auto tv0 = TensorViewBuilder()
+                 .ndims(2)
+                 .shape({-1, -1})
+                 .contiguity({true, std::nullopt})
+                 .expanded({false, true})
+                 .build();
+  fusion.addInput(tv0);
+  auto tv1 = sum(tv0, {1});
+  fusion.addOutput(tv1);
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor t0 = at::randn({2, 1}, options);
+  std::vector<c10::IValue> small_inputs = {t0.expand({2, 1L << 20})};
+  std::vector<c10::IValue> large_inputs = {t0.expand({2, 1L << 31})};
+
+  EXPECT_EQ(
+      SchedulerRuntimeInfo(&fusion, small_inputs).getIndexType(),
+      PrimDataType::Int32);
+  EXPECT_EQ(
+      KernelArgumentHolder::createKernelArgumentHolder(large_inputs)
+          .getSmallestIndexTypeOfArguments(),
+      PrimDataType::Int32);
+  EXPECT_EQ(
+      SchedulerRuntimeInfo(&fusion, large_inputs).getIndexType(),
+      PrimDataType::Int);
+}
+
+// Reductions over TIDx of 16 threads are shuffles within half warps
+TEST_F(NVFuserTest, SubWarpReduction) {
+  EnableOptionsGuard opt_guard;
+  EnableOptionsGuard::getCurOptions().set(EnableOption::SubWarpReduce);
+
+  // [I0/4, 4, I1/16, 16] with the outer reduction rfactored
+  auto schedule = [](TensorView* ref, const std::vector<TensorView*>& outs) {
+    ref->split(1, 16);
+    ref->split(0, 4);
+    auto rf = outs.empty() ? ref->rFactor({2}) : ref->rFactor({2}, outs).at(0);
+    for (auto tv : {rf, ref}) {
+      tv->axis(0)->parallelize(ParallelType::BIDx);
+      tv->axis(1)->parallelize(ParallelType::TIDy);
+      tv->axis(-1)->parallelize(ParallelType::TIDx);
+    }
+    inlineMost();
+  };
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor t0 = at::randn({37, 80}, options);
+  at::Tensor t1 = at::randint(-1000, 1000, {37, 80}, options.dtype(at::kInt));
+
+  {
+    Fusion fusion;
+    FusionGuard fg(&fusion);
+    auto tv0 = makeSymbolicTensor(2);
+    fusion.addInput(tv0);
+    auto tv1 = sum(tv0, {1});
+    fusion.addOutput(tv1);
+    schedule(tv1, {});
+
+    FusionExecutor fe;
+    fe.compileFusion(&fusion, {t0});
+    EXPECT_NE(
+        fe.kernelString().find("warp::subWarpReduceTIDX<16>"),
+        std::string::npos)
+        << fe.kernelString();
+    EXPECT_EQ(fe.kernelString().find("blockReduce"), std::string::npos)
+        << fe.kernelString();
+    auto cg_outputs = fe.runFusion({t0});
+    testValidate(&fusion, cg_outputs, {t0}, __LINE__, __FILE__);
+  }
+
+  {
+    Fusion fusion;
+    FusionGuard fg(&fusion);
+    auto tv0 = makeSymbolicTensor(2, DataType::Int32);
+    fusion.addInput(tv0);
+    auto tv1 = max(tv0, {1});
+    fusion.addOutput(tv1);
+    schedule(tv1, {});
+
+    FusionExecutor fe;
+    fe.compileFusion(&fusion, {t1});
+    EXPECT_NE(
+        fe.kernelString().find(
+            "warp::subWarpReduxTIDX<16, warp::ReduxOp::Max>"),
+        std::string::npos)
+        << fe.kernelString();
+    auto cg_outputs = fe.runFusion({t1});
+    testValidate(&fusion, cg_outputs, {t1}, __LINE__, __FILE__);
+  }
+
+  {
+    Fusion fusion;
+    FusionGuard fg(&fusion);
+    auto tv0 = makeSymbolicTensor(2);
+    fusion.addInput(tv0);
+    auto tvs = Welford(tv0, {1});
+    fusion.addOutput(tvs.avg);
+    fusion.addOutput(tvs.var_sum);
+    schedule(tvs.avg, {tvs.avg, tvs.var_sum, tvs.n});
+
+    FusionExecutor fe;
+    fe.compileFusion(&fusion, {t0});
+    EXPECT_NE(
+        fe.kernelString().find("warp::subWarpWelfordTIDX<16>"),
+        std::string::npos)
+        << fe.kernelString();
+    EXPECT_EQ(fe.kernelString().find("blockWelford"), std::string::npos)
+        << fe.kernelString();
+    auto cg_outputs = fe.runFusion({t0});
+    testValidate(
+        &fusion,
+        cg_outputs,
+        {t0},
+        {t0.mean({1}), t0.var({1}, false) * t0.size(1)},
+        __LINE__,
+        __FILE__);
+  }
+}
+
+// The full iterations of the serial reduction loop run without predicates
+TEST_F(NVFuserTest, PredicatePeeling) {
+  EnableOptionsGuard opt_guard;
+  EnableOptionsGuard::getCurOptions().set(EnableOption::PredicatePeeling);
+
+  Fusion fusion;
+  FusionGuard fg(&fusion);
+
+  auto tv0 = makeSymbolicTensor(2);
+  fusion.addInput(tv0);
+  auto tv1 = sum(tv0, {1});
+  fusion.addOutput(tv1);
+  tv0->cacheAfter();
+
+  // [I0, I1/128, 1, 32, 4]
+  tv1->split(1, 4);
+  tv1->split(1, 32);
+  tv1->split(1, 1);
+  auto rf = tv1->rFactor({1, 2, 4});
+  TransformPropagatorWithCheck propagator(rf);
+  MaxLogicalDomainInfoSpanningTree(rf).traverse(&propagator);
+  rf->axis(0)->parallelize(ParallelType::BIDx);
+  rf->axis(2)->parallelize(ParallelType::Unswitch);
+  rf->axis(3)->parallelize(ParallelType::TIDx);
+  rf->axis(4)->parallelize(ParallelType::Unroll);
+  scheduler_utils::parallelizeAllLike(rf);
+  inlineMost();
+
+  GpuLower gpulw(&fusion);
+  auto flattened_exprs =
+      ir_utils::flattenScopedExprs(gpulw.run()->topLevelExprs());
+  std::unordered_map<Val*, int64_t> num_loops;
+  for (auto fl : ir_utils::filterByType<ForLoop>(flattened_exprs)) {
+    ++num_loops[fl->index()];
+  }
+  EXPECT_TRUE(std::any_of(
+      num_loops.begin(), num_loops.end(), [](const auto& entry) {
+        return entry.second == 2;
+      }))
+      << "The serial loop is not peeled";
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  FusionExecutor fe;
+  // Divisible, non-divisible and shorter than one iteration
+  for (int64_t size : {1024, 1000, 100}) {
+    at::Tensor t0 = at::randn({7, size}, options);
+    if (!fe.isCompiled()) {
+      fe.compileFusion(&fusion, {t0});
+    }
+    auto cg_outputs = fe.runFusion({t0});
+    testValidate(&fusion, cg_outputs, {t0}, __LINE__, __FILE__);
+  }
+}
+
+// The serial reduction loop is unswitched as a whole, so its full tiles
+// check the non-divisible splits of the unrolled elements only once
+TEST_F(NVFuserTest, TileUnswitch) {
+  EnableOptionsGuard opt_guard;
+  EnableOptionsGuard::getCurOptions().set(EnableOption::TileUnswitch);
+
+  Fusion fusion;
+  FusionGuard fg(&fusion);
+
+  auto tv0 = makeSymbolicTensor(2);
+  fusion.addInput(tv0);
+  auto tv1 = sum(tv0, {1});
+  fusion.addOutput(tv1);
+  tv0->cacheAfter();
+
+  // [I0, I1/128, 1, 32, 4]
+  tv1->split(1, 4);
+  tv1->split(1, 32);
+  tv1->split(1, 1);
+  auto rf = tv1->rFactor({1, 2, 4});
+  TransformPropagatorWithCheck propagator(rf);
+  MaxLogicalDomainInfoSpanningTree(rf).traverse(&propagator);
+  rf->axis(0)->parallelize(ParallelType::BIDx);
+  rf->axis(2)->parallelize(ParallelType::Unswitch);
+  rf->axis(3)->parallelize(ParallelType::TIDx);
+  rf->axis(4)->parallelize(ParallelType::Unroll);
+  scheduler_utils::parallelizeAllLike(rf);
+  inlineMost();
+
+  GpuLower gpulw(&fusion);
+  auto flattened_exprs =
+      ir_utils::flattenScopedExprs(gpulw.run()->topLevelExprs());
+  // Both the unpredicated and the predicated paths have the serial loop
+  auto num_serial_loops = std::count_if(
+      flattened_exprs.begin(), flattened_exprs.end(), [&](Expr* expr) {
+        auto fl = dynamic_cast<ForLoop*>(expr);
+        return fl != nullptr &&
+            gpulw.caMap()->areMapped(
+                fl->iter_domain(), rf->axis(1), IdMappingMode::LOOP);
+      });
+  EXPECT_EQ(num_serial_loops, 2) << "The serial loop is not unswitched";
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  FusionExecutor fe;
+  // Divisible, non-divisible and shorter than one iteration
+  for (int64_t size : {1024, 1000, 100}) {
+    at::Tensor t0 = at::randn({7, size}, options);
+    if (!fe.isCompiled()) {
+      fe.compileFusion(&fusion, {t0});
+    }
+    auto cg_outputs = fe.runFusion({t0});
+    testValidate(&fusion, cg_outputs, {t0}, __LINE__, __FILE__);
+  }
+}
+
+// Segment fusions should only contain the tensor exprs of their segments
+TEST_F(NVFuserTest, SegmentFusionSubgraphCopy) {
+  auto is_tensor_expr = [](Expr* expr) {
+    return !ir_utils::filterByType<TensorView>(expr->outputs()).empty();
+  };
+
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+
+  auto tv0 = makeSymbolicTensor(2);
+  fusion->addInput(tv0);
+  auto tv1 = sin(tv0);
+  auto tv2 = reshape(tv1, {IrBuilder::create<Val>(-1L)});
+  auto tv3 = segment_set(tv2);
+  auto tv4 = cos(tv3);
+  auto tv5 = add(tv4, tv4);
+  fusion->addOutput(tv5);
+
+  FusionExecutorCache executor_cache(std::move(fusion));
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor t0 = at::randn({8, 16}, options);
+  auto cg_outputs = executor_cache.runFusionWithInputs({t0});
+
+  FusionKernelRuntime* runtime = executor_cache.getMostRecentKernelRuntime();
+  ASSERT_TRUE(runtime->isSegmented());
+  for (SegmentedGroup* group : runtime->fusionSegments()->groups()) {
+    const int64_t num_segment_tensor_exprs = std::count_if(
+        group->exprs().begin(), group->exprs().end(), is_tensor_expr);
+    int64_t num_copied_tensor_exprs = 0;
+    for (Expr* expr : group->getFusion()->unordered_exprs()) {
+      if (is_tensor_expr(expr)) {
+        ++num_copied_tensor_exprs;
+      }
+    }
+    EXPECT_EQ(num_copied_tensor_exprs, num_segment_tensor_exprs);
+    for (Val* inp : group->getFusion()->inputs()) {
+      EXPECT_EQ(inp->definition(), nullptr);
+    }
+  }
+
+  testValidate(executor_cache.fusion(), cg_outputs, {t0}, __LINE__, __FILE__);
+}
+
+TEST_F(NVFuserTest, PackedCasts) {
+  EnableOptionsGuard opt_guard;
+  EnableOptionsGuard::getCurOptions().set(EnableOption::PackedCasts);
+
+  auto test = [](DataType dtype, const std::string& packed_cast) {
+    Fusion fusion;
+    FusionGuard fg(&fusion);
+    auto tv0 = makeContigTensor(2);
+    fusion.addInput(tv0);
+    auto tv1 = castOp(dtype, tv0);
+    auto tv2 = castOp(DataType::Float, tv1);
+    fusion.addOutput(tv2);
+    auto tv3 = tv2->cacheBefore();
+
+    // [I0, I1/4/TIDx, 1(Unswitch), 4]
+    tv2->split(1, 4);
+    tv2->split(1, 1);
+    tv2->axis(0)->parallelize(ParallelType::BIDx);
+    tv2->axis(1)->parallelize(ParallelType::TIDx);
+    tv2->axis(2)->parallelize(ParallelType::Unswitch);
+    TransformPropagatorWithCheck propagator(tv2);
+    MaxLogicalDomainInfoSpanningTree(tv2).traverse(&propagator);
+    scheduler_utils::parallelizeAllLike(tv2);
+    tv1->inlineAt(3);
+    tv3->inlineAt(3);
+
+    auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+    at::Tensor t0 = at::randn({13, 100}, options);
+    FusionExecutor fe;
+    fe.compileFusion(&fusion, {t0});
+    EXPECT_NE(fe.kernelString().find(packed_cast), std::string::npos)
+        << fe.kernelString();
+    auto cg_outputs = fe.runFusion({t0});
+    auto ref = t0.to(data_type_to_aten(dtype)).to(at::kFloat);
+    EXPECT_TRUE(cg_outputs[0].equal(ref));
+  };
+
+  test(DataType::Half, "__float2halfx2(");
+  test(DataType::BFloat16, "__float2bfloatx2(");
+  if (deviceMajorMinorCheck(9)) {
+    test(DataType::Float8_e4m3fn, "__e4m32floatx2(");
+    test(DataType::Float8_e5m2, "__float2e5m2x2(");
+  }
+}
+
+// Scale-bias-relu computed with half2 and bfloat162 arithmetic
+TEST_F(NVFuserTest, PackedArithmetic) {
+  EnableOptionsGuard opt_guard;
+  EnableOptionsGuard::getCurOptions().set(EnableOption::PackedArithmetic);
+
+  auto test = [](DataType dtype) {
+    Fusion fusion;
+    FusionGuard fg(&fusion);
+    auto tv0 = makeContigTensor(2, dtype);
+    fusion.addInput(tv0);
+    auto tv1 = castOp(DataType::Float, tv0);
+    // The scale and bias are exact, so only the add rounds as in float
+    auto tv2 = mul(tv1, IrBuilder::create<Val>(0.5));
+    auto tv3 = add(tv2, IrBuilder::create<Val>(0.25));
+    auto tv4 = relu(tv3);
+    auto tv5 = castOp(dtype, tv4);
+    fusion.addOutput(tv5);
+
+    // [I0, I1/4/TIDx, 1(Unswitch), 4]
+    tv5->split(1, 4);
+    tv5->split(1, 1);
+    tv5->axis(0)->parallelize(ParallelType::BIDx);
+    tv5->axis(1)->parallelize(ParallelType::TIDx);
+    tv5->axis(2)->parallelize(ParallelType::Unswitch);
+    TransformPropagatorWithCheck propagator(tv5);
+    MaxLogicalDomainInfoSpanningTree(tv5).traverse(&propagator);
+    scheduler_utils::parallelizeAllLike(tv5);
+    inlineMost();
+
+    auto options = at::TensorOptions()
+                       .dtype(data_type_to_aten(dtype))
+                       .device(at::kCUDA, 0);
+    at::Tensor t0 = at::randn({13, 100}, options);
+    FusionExecutor fe;
+    fe.compileFusion(&fusion, {t0});
+    EXPECT_NE(fe.kernelString().find("__mulx2("), std::string::npos)
+        << fe.kernelString();
+    EXPECT_NE(fe.kernelString().find("__relux2("), std::string::npos)
+        << fe.kernelString();
+    auto cg_outputs = fe.runFusion({t0});
+    testValidate(&fusion, cg_outputs, {t0}, __LINE__, __FILE__);
+  };
+
+  test(DataType::Half);
+  if (deviceMajorMinorCheck(8)) {
+    test(DataType::BFloat16);
+  }
+}
+
+// Serial, block and decoupled look-back grid scans
+TEST_F(NVFuserTest, Cumsum) {
+  auto test = [](const std::vector<int64_t>& shape,
+                 const std::function<void(TensorView*)>& schedule,
+                 const std::string& scan_call) {
+    Fusion fusion;
+    FusionGuard fg(&fusion);
+    auto tv0 = makeContigTensor(2);
+    fusion.addInput(tv0);
+    auto tv1 = cumsum(tv0, 1);
+    fusion.addOutput(tv1);
+    schedule(tv1);
+
+    auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+    at::Tensor t0 = at::randn(shape, options);
+    FusionExecutor fe;
+    fe.compileFusion(&fusion, {t0});
+    if (!scan_call.empty()) {
+      EXPECT_NE(fe.kernelString().find(scan_call), std::string::npos)
+          << fe.kernelString();
+    }
+    auto cg_outputs = fe.runFusion({t0});
+    testValidate(&fusion, cg_outputs, {t0}, __LINE__, __FILE__);
+  };
+
+  test(
+      {13, 100},
+      [](TensorView* tv) { tv->axis(0)->parallelize(ParallelType::BIDx); },
+      "");
+  test(
+      {13, 100},
+      [](TensorView* tv) {
+        tv->axis(0)->parallelize(ParallelType::BIDx);
+        tv->axis(1)->parallelize(ParallelType::TIDx);
+      },
+      "scan::blockInclusiveScan<");
+  test(
+      {5, 1000},
+      [](TensorView* tv) {
+        tv->split(1, 128);
+        tv->axis(0)->parallelize(ParallelType::BIDy);
+        tv->axis(1)->parallelize(ParallelType::BIDx);
+        tv->axis(2)->parallelize(ParallelType::TIDx);
+      },
+      "scan::gridInclusiveScan<");
+}
+
+// Without scheduler support, scans are evaluated by ExprEval segments
+TEST_F(NVFuserTest, CumsumSegmented) {
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+  auto tv0 = makeContigTensor(2);
+  fusion->addInput(tv0);
+  auto tv1 = exp(tv0);
+  auto tv2 = cumsum(tv1, -1);
+  auto tv3 = add(tv2, IrBuilder::create<Val>(1.0));
+  fusion->addOutput(tv3);
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor t0 = at::randn({32, 64}, options);
+  FusionExecutorCache fec(std::move(fusion));
+  auto cg_outputs = fec.runFusionWithInputs({t0});
+  EXPECT_TRUE(fec.getMostRecentKernelRuntime()->isSegmented());
+  testValidate(fec.fusion(), cg_outputs, {t0}, __LINE__, __FILE__);
+}
+
+// Block sort of rows fused with the pointwise ops around it. The inputs have
+// ties to check that the sort is stable.
+TEST_F(NVFuserTest, BlockSort) {
+  for (bool descending : {false, true}) {
+    Fusion fusion;
+    FusionGuard fg(&fusion);
+    auto tv0 = makeContigTensor(2);
+    fusion.addInput(tv0);
+    auto tv1 = neg(tv0);
+    auto [tv2, tv3] = sort(tv1, 1, descending);
+    auto tv4 = add(tv2, IrBuilder::create<Val>(1.0));
+    fusion.addOutput(tv4);
+    fusion.addOutput(tv3);
+
+    for (auto tv : {tv1, tv2, tv3, tv4}) {
+      tv->axis(0)->parallelize(ParallelType::BIDx);
+      tv->axis(1)->parallelize(ParallelType::TIDx);
+    }
+    inlineMost();
+
+    auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+    at::Tensor t0 = at::randint(-20, 20, {13, 100}, options);
+    FusionExecutor fe;
+    fe.compileFusion(&fusion, {t0});
+    EXPECT_NE(fe.kernelString().find("sort::blockSort<"), std::string::npos)
+        << fe.kernelString();
+    auto cg_outputs = fe.runFusion({t0});
+
+    auto [values, indices] = at::sort(t0.neg(), true, 1, descending);
+    EXPECT_TRUE(cg_outputs[0].equal(values.add(1.0)));
+    EXPECT_TRUE(cg_outputs[1].equal(indices));
+  }
+}
+
+// Without scheduler support, sorts are evaluated by ExprEval segments
+TEST_F(NVFuserTest, ArgsortSegmented) {
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+  auto tv0 = makeContigTensor(2);
+  fusion->addInput(tv0);
+  auto tv1 = exp(tv0);
+  auto tv2 = argsort(tv1, -1, /*descending=*/true);
+  fusion->addOutput(tv2);
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor t0 = at::randn({32, 5000}, options);
+  FusionExecutorCache fec(std::move(fusion));
+  auto cg_outputs = fec.runFusionWithInputs({t0});
+  EXPECT_TRUE(fec.getMostRecentKernelRuntime()->isSegmented());
+  EXPECT_TRUE(cg_outputs[0].equal(std::get<1>(at::sort(t0, true, -1, true))));
+}
+
+// Fast and Compensated Welford modes of the reduction scheduler
+TEST_F(NVFuserTest, WelfordModes) {
+  auto test = [](WelfordMode mode, const std::string& serial_call) {
+    Fusion fusion;
+    FusionGuard fg(&fusion);
+    auto tv0 = makeContigTensor(2);
+    fusion.addInput(tv0);
+    auto tvs = Welford(tv0, {1});
+    fusion.addOutput(tvs.avg);
+    fusion.addOutput(tvs.var_sum);
+
+    auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+    at::Tensor t0 = at::randn({64, 8192}, options);
+
+    auto rparams = getReductionHeuristics(&fusion, {t0});
+    NVF_CHECK(rparams, "Reduction schedule was not generated!");
+    rparams->welford_mode = mode;
+    scheduleReduction(&fusion, *rparams);
+
+    FusionExecutor fe;
+    fe.compileFusion(&fusion, {t0}, rparams->lparams);
+    EXPECT_NE(fe.kernelString().find(serial_call), std::string::npos)
+        << fe.kernelString();
+    auto cg_outputs = fe.runFusion({t0}, rparams->lparams);
+
+    auto t0_double = t0.to(at::kDouble);
+    auto ref_avg = t0_double.mean({1});
+    auto ref_var_sum = t0_double.var({1}, false) * t0.size(1);
+    testValidate(
+        &fusion,
+        cg_outputs,
+        {t0},
+        {ref_avg, ref_var_sum},
+        __LINE__,
+        __FILE__,
+        "",
+        rparams->lparams);
+  };
+
+  test(WelfordMode::Fast, "welfordAccumulateSums(");
+  test(WelfordMode::Compensated, "welfordCombineCompensated (");
+}
+
+// See Note [Shared memory atomic block reductions]
+TEST_F(NVFuserTest, SmemAtomicBlockReduction) {
+  // The heuristic selects atomics only when all reductions are integer sums
+  {
+    Fusion fusion;
+    FusionGuard fg(&fusion);
+    auto tv0 = makeContigTensor(2, DataType::Int32);
+    fusion.addInput(tv0);
+    fusion.addOutput(sum(tv0, {0}));
+
+    auto options = at::TensorOptions().dtype(at::kInt).device(at::kCUDA, 0);
+    at::Tensor t0 = at::randint(-100, 100, {8192, 128}, options);
+    auto rparams = getReductionHeuristics(&fusion, {t0});
+    NVF_CHECK(rparams, "Reduction schedule was not generated!");
+    EXPECT_TRUE(rparams->smem_atomic_block_reduction);
+  }
+
+  auto test = [](DataType dtype, at::Tensor t0) {
+    Fusion fusion;
+    FusionGuard fg(&fusion);
+    auto tv0 = makeContigTensor(2, dtype);
+    fusion.addInput(tv0);
+    // Keep Int32 sums in Int32, so there is no cast to schedule
+    auto tv1 = sum(tv0, {0}, /*keep_dim=*/false, dtype);
+    fusion.addOutput(tv1);
+
+    // Outer block reduction along TIDy
+    tv1->axis(0)->parallelize(ParallelType::TIDy);
+    tv1->axis(1)->parallelize(ParallelType::TIDx);
+    tv1->definition()->as<ReductionOp>()->requestSmemAtomicBlockReduction();
+
+    FusionExecutor fe;
+    fe.compileFusion(&fusion, {t0});
+    EXPECT_NE(
+        fe.kernelString().find("blockReduceAtomicAdd<"), std::string::npos)
+        << fe.kernelString();
+    auto cg_outputs = fe.runFusion({t0});
+
+    testValidate(&fusion, cg_outputs, {t0}, __LINE__, __FILE__);
+  };
+
+  auto options = at::TensorOptions().device(at::kCUDA, 0);
+  test(
+      DataType::Int32,
+      at::randint(-100, 100, {64, 16}, options.dtype(at::kInt)));
+  test(
+      DataType::Int,
+      at::randint(-100, 100, {64, 16}, options.dtype(at::kLong)));
+  test(DataType::Float, at::randn({64, 16}, options.dtype(at::kFloat)));
+}
+
+// See Note [Atomic grid reductions]
+TEST_F(NVFuserTest, AtomicGridReduction) {
+  Fusion fusion;
+  FusionGuard fg(&fusion);
+  auto tv0 = makeContigTensor(2);
+  fusion.addInput(tv0);
+  auto tv1 = sum(tv0, {0});
+  fusion.addOutput(tv1);
+
+  // [BIDx, TIDy, TIDx]
+  tv1->split(0, 32);
+  tv1->axis(0)->parallelize(ParallelType::BIDx);
+  tv1->axis(1)->parallelize(ParallelType::TIDy);
+  tv1->axis(2)->parallelize(ParallelType::TIDx);
+  tv1->definition()->as<ReductionOp>()->requestAtomicGridReduction();
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor t0 = at::randn({1000, 32}, options);
+
+  FusionExecutor fe;
+  fe.compileFusion(&fusion, {t0});
+  EXPECT_NE(
+      fe.kernelString().find("reduction::gridReduceAtomicAdd<"),
+      std::string::npos)
+      << fe.kernelString();
+
+  // The output is zero-filled again for every launch
+  for (int64_t run = 0; run < 2; run++) {
+    auto cg_outputs = fe.runFusion({t0});
+    testValidate(&fusion, cg_outputs, {t0}, __LINE__, __FILE__);
+  }
+}
+
+TEST_F(NVFuserTest, AtomicGridReductionHeuristic) {
+  EnableOptionsGuard opt_guard;
+  EnableOptionsGuard::getCurOptions().set(EnableOption::AtomicGridReduction);
+
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+  auto tv0 = makeContigTensor(2);
+  fusion->addInput(tv0);
+  fusion->addOutput(sum(tv0, {0}));
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor t0 = at::randn({131072, 64}, options);
+
+  FusionExecutorCache fec(std::move(fusion));
+  auto cg_outputs = fec.runFusionWithInputs({t0});
+
+  const auto& rparams = fec.getMostRecentKernelRuntime()
+                            ->schedulerHeuristics()
+                            ->heuristicsList()
+                            .at(0)
+                            ->reductionParams();
+  EXPECT_EQ(
+      rparams.atomic_grid_reduction,
+      rparams.cross_grid_inner_reduction && !rparams.persistent_kernel);
+  testValidate(fec.fusion(), cg_outputs, {t0}, __LINE__, __FILE__);
+}
+
+// See Note [Histograms]
+TEST_F(NVFuserTest, Histogram) {
+  constexpr int64_t num_experts = 64;
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+  // The experts picked for each token, with a producer to fuse
+  auto tv0 = makeContigTensor(2, DataType::Int32);
+  fusion->addInput(tv0);
+  auto tv1 = histogram(castOp(DataType::Int, tv0), num_experts);
+  fusion->addOutput(tv1);
+
+  auto options = at::TensorOptions().dtype(at::kInt).device(at::kCUDA, 0);
+  at::Tensor t0 = at::randint(0, num_experts, {65536, 2}, options);
+
+  FusionExecutorCache fec(std::move(fusion));
+  auto cg_outputs = fec.runFusionWithInputs({t0});
+
+  const FusionKernelRuntime* runtime = fec.getMostRecentKernelRuntime();
+  EXPECT_FALSE(runtime->isSegmented());
+  const auto& heuristic =
+      runtime->schedulerHeuristics()->heuristicsList().at(0);
+  ASSERT_EQ(heuristic->heuristic(), ScheduleHeuristic::Reduction);
+  // Integer sums use the atomic reductions without being enabled
+  const auto& rparams = heuristic->reductionParams();
+  EXPECT_TRUE(rparams.smem_atomic_block_reduction);
+  EXPECT_EQ(
+      rparams.atomic_grid_reduction,
+      rparams.cross_grid_inner_reduction && !rparams.persistent_kernel);
+
+  EXPECT_TRUE(cg_outputs[0].equal(
+      at::bincount(t0.flatten(), {}, num_experts).to(at::kLong)));
+}
+
+// Dequantize int4 weights packed 8 per int32 in a single kernel
+TEST_F(NVFuserTest, UnpackInt4Dequantize) {
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+  auto tv0 = makeContigTensor(2, DataType::Int32);
+  auto tv1 = makeContigTensor(1);
+  fusion->addInput(tv0);
+  fusion->addInput(tv1);
+  auto tv2 = castOp(DataType::Float, unpack_int4(tv0));
+  auto tv3 = mul(tv2, broadcast(tv1, {false, true}));
+  auto tv4 = castOp(DataType::Float, unpack_int4(tv0, /*is_signed=*/false));
+  fusion->addOutput(tv3);
+  fusion->addOutput(tv4);
+
+  auto int_options = at::TensorOptions().dtype(at::kInt).device(at::kCUDA, 0);
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor t0 = at::randint(
+      std::numeric_limits<int32_t>::min(),
+      std::numeric_limits<int32_t>::max(),
+      {128, 64},
+      int_options);
+  at::Tensor t1 = at::randn({128}, options);
+
+  FusionExecutorCache fec(std::move(fusion));
+  auto cg_outputs = fec.runFusionWithInputs({t0, t1});
+  EXPECT_FALSE(fec.getMostRecentKernelRuntime()->isSegmented());
+
+  at::Tensor offsets = at::arange(0, 32, 4, int_options);
+  at::Tensor words = t0.unsqueeze(-1);
+  at::Tensor signed_ref =
+      at::__rshift__(at::__lshift__(words, 28 - offsets), 28).flatten(1);
+  at::Tensor unsigned_ref =
+      at::bitwise_and(at::__rshift__(words, offsets), 15).flatten(1);
+  EXPECT_TRUE(
+      cg_outputs[0].equal(signed_ref.to(at::kFloat) * t1.unsqueeze(-1)));
+  EXPECT_TRUE(cg_outputs[1].equal(unsigned_ref.to(at::kFloat)));
+}
+
+// Arg reductions of a softmax and of its input, with ties and NaNs, against
+// ATen. The Double input takes the two-pass path.
+TEST_F(NVFuserTest, ArgMaxArgMin) {
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+  auto tv0 = makeContigTensor(2, DataType::BFloat16);
+  auto tv1 = makeContigTensor(2, DataType::Double);
+  fusion->addInput(tv0);
+  fusion->addInput(tv1);
+  auto tv2 = softmax(castOp(DataType::Float, tv0), 1);
+  fusion->addOutput(argmax(tv2, 1));
+  fusion->addOutput(argmin(tv2, -1, /*keep_dim=*/true));
+  fusion->addOutput(argmax(tv0, 1));
+  fusion->addOutput(argmax(tv1, 1));
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  // Few distinct values, so that rows have ties
+  at::Tensor t0 = at::randint(-4, 4, {64, 1000}, options).to(at::kBFloat16);
+  t0.index_put_({3, 17}, std::numeric_limits<float>::quiet_NaN());
+  t0.index_put_({5, 0}, -0.0);
+  at::Tensor t1 = at::randint(-4, 4, {64, 1000}, options).to(at::kDouble);
+  t1.index_put_({7, 999}, std::numeric_limits<double>::quiet_NaN());
+
+  FusionExecutorCache fec(std::move(fusion));
+  auto cg_outputs = fec.runFusionWithInputs({t0, t1});
+
+  at::Tensor t2 = at::softmax(t0.to(at::kFloat), 1);
+  EXPECT_TRUE(cg_outputs[0].equal(at::argmax(t2, 1)));
+  EXPECT_TRUE(cg_outputs[1].equal(at::argmin(t2, -1, /*keepdim=*/true)));
+  EXPECT_TRUE(cg_outputs[2].equal(at::argmax(t0, 1)));
+  EXPECT_TRUE(cg_outputs[3].equal(at::argmax(t1, 1)));
+}
+
+TEST_F(NVFuserTest, TopK) {
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+  auto tv0 = makeContigTensor(2);
+  fusion->addInput(tv0);
+  auto largest = topk(tv0, 4, 1);
+  auto smallest = topk(tv0, 3, 1, /*largest=*/false);
+  fusion->addOutput(largest.values);
+  fusion->addOutput(largest.indices);
+  fusion->addOutput(smallest.values);
+  fusion->addOutput(smallest.indices);
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor t0 = at::randn({32, 2048}, options);
+
+  FusionExecutorCache fec(std::move(fusion));
+  auto cg_outputs = fec.runFusionWithInputs({t0});
+
+  auto [largest_values, largest_indices] = at::topk(t0, 4, 1);
+  auto [smallest_values, smallest_indices] =
+      at::topk(t0, 3, 1, /*largest=*/false);
+  EXPECT_TRUE(cg_outputs[0].equal(largest_values));
+  EXPECT_TRUE(cg_outputs[1].equal(largest_indices));
+  EXPECT_TRUE(cg_outputs[2].equal(smallest_values));
+  EXPECT_TRUE(cg_outputs[3].equal(smallest_indices));
+}
+
+// A layer norm of the tokens of a ragged batch, then the positions of the
+// tokens and the round trip through the padded layout
+TEST_F(NVFuserTest, RaggedTensor) {
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+  auto tv0 = makeContigTensor(2);
+  auto tv1 = makeContigTensor(1, DataType::Int);
+  auto max_length = IrBuilder::create<Val>(DataType::Int);
+  fusion->addInput(tv0);
+  fusion->addInput(tv1);
+  fusion->addInput(max_length);
+  RaggedTensor ragged{tv0, tv1};
+  auto tv2 = layer_norm(tv0, 1, nullptr, nullptr, IrBuilder::create<Val>(1e-5))
+                 .output;
+  auto positions = ragged_positions(ragged);
+  auto tv3 = ragged_to_padded({tv2, tv1}, max_length);
+  auto round_trip = padded_to_ragged(
+      tv3, tv1, tv0->getLogicalDomain().at(0)->extent());
+  fusion->addOutput(tv2);
+  fusion->addOutput(positions.sequence);
+  fusion->addOutput(positions.position);
+  fusion->addOutput(tv3);
+  fusion->addOutput(round_trip.values);
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  // Sequences of 3, 0, 7 and 1 tokens
+  const std::vector<int64_t> lengths = {3, 0, 7, 1};
+  at::Tensor t0 = at::randn({11, 256}, options);
+  at::Tensor t1 = at::tensor({0L, 3L, 3L, 10L, 11L}, options.dtype(at::kLong));
+
+  FusionExecutorCache fec(std::move(fusion));
+  auto cg_outputs = fec.runFusionWithInputs({t0, t1, 7L});
+
+  at::Tensor t2 = at::layer_norm(t0, {256});
+  EXPECT_TRUE(at::allclose(cg_outputs[0], t2, 1e-4, 1e-4));
+  at::Tensor padded = at::zeros({4, 7, 256}, options);
+  std::vector<int64_t> sequence_ref;
+  std::vector<int64_t> position_ref;
+  int64_t start = 0;
+  for (auto i : c10::irange(lengths.size())) {
+    for (auto j : c10::irange(lengths.at(i))) {
+      sequence_ref.push_back((int64_t)i);
+      position_ref.push_back((int64_t)j);
+    }
+    padded.select(0, (int64_t)i)
+        .narrow(0, 0, lengths.at(i))
+        .copy_(t2.narrow(0, start, lengths.at(i)));
+    start += lengths.at(i);
+  }
+  EXPECT_TRUE(cg_outputs[1].cpu().equal(
+      at::tensor(sequence_ref, at::dtype(at::kLong))));
+  EXPECT_TRUE(cg_outputs[2].cpu().equal(
+      at::tensor(position_ref, at::dtype(at::kLong))));
+  EXPECT_TRUE(at::allclose(cg_outputs[3], padded, 1e-4, 1e-4));
+  EXPECT_TRUE(at::allclose(cg_outputs[4], t2, 1e-4, 1e-4));
+}
+
+// Compactions leave the selected elements first and their number on the
+// device, so the fusion is run without reading it back
+TEST_F(NVFuserTest, StreamCompaction) {
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+  auto tv0 = makeContigTensor(2);
+  auto tv1 = makeContigTensor(2, DataType::Bool);
+  fusion->addInput(tv0);
+  fusion->addInput(tv1);
+  auto selected = masked_select(tv0, tv1);
+  auto indices = nonzero(tv1);
+  fusion->addOutput(selected.values);
+  fusion->addOutput(selected.count);
+  fusion->addOutput(indices.values);
+  fusion->addOutput(indices.count);
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor t0 = at::randn({37, 129}, options);
+  at::Tensor t1 = at::randn({37, 129}, options) > 0.5;
+
+  FusionExecutorCache fec(std::move(fusion));
+  auto cg_outputs = fec.runFusionWithInputs({t0, t1});
+
+  const int64_t count = t1.sum().item<int64_t>();
+  EXPECT_EQ(cg_outputs[0].numel(), t0.numel());
+  EXPECT_EQ(cg_outputs[1].item<int64_t>(), count);
+  EXPECT_TRUE(
+      cg_outputs[0].narrow(0, 0, count).equal(at::masked_select(t0, t1)));
+  EXPECT_TRUE(cg_outputs[0]
+                  .narrow(0, count, t0.numel() - count)
+                  .equal(at::masked_select(t0, t1.logical_not())));
+  EXPECT_EQ(cg_outputs[3].item<int64_t>(), count);
+  EXPECT_TRUE(cg_outputs[2].narrow(0, 0, count).equal(at::nonzero(t1)));
+}
+
+// Launches without a cache id reuse the entry of a previous launch only when
+// the shapes and the scalar arguments match
+TEST_F(NVFuserTest, ShapeKeyedExecutorEntries) {
+  Fusion fusion;
+  FusionGuard fg(&fusion);
+  auto tv0 = makeSymbolicTensor(2);
+  auto s = IrBuilder::create<Val>(DataType::Double);
+  fusion.addInput(tv0);
+  fusion.addInput(s);
+  auto tv1 = add(tv0, s);
+  fusion.addOutput(tv1);
+  tv1->axis(0)->parallelize(ParallelType::BIDx);
+  tv1->axis(1)->parallelize(ParallelType::TIDx);
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor small = at::randn({4, 32}, options);
+  at::Tensor large = at::randn({8, 64}, options);
+  at::Tensor transposed = at::randn({32, 4}, options).t();
+
+  FusionExecutor fe;
+  fe.compileFusion(&fusion, {small, 1.0});
+  for (const auto& [t0, value] :
+       std::vector<std::pair<at::Tensor, double>>{
+           {small, 1.0},
+           {large, 1.0},
+           {small, 2.0},
+           {transposed, 2.0},
+           {small, 1.0}}) {
+    auto cg_outputs = fe.runFusion({t0, value});
+    EXPECT_EQ(cg_outputs[0].sizes(), t0.sizes());
+    EXPECT_TRUE(at::allclose(cg_outputs[0], t0 + value));
+  }
+}
+
+TEST_F(NVFuserTest, ScalarInterning) {
+  Fusion fusion;
+  FusionGuard fg(&fusion);
+  fusion.setScalarInterning(true);
+
+  Val* i0 = IrBuilder::create<Val>(DataType::Index);
+  // Builds i0 * 4 +/- threadIdx.x with new constants and named scalars
+  auto index = [&](bool add) {
+    Val* tidx = NamedScalar::getParallelIndex(ParallelType::TIDx);
+    Val* four = IrBuilder::create<Val>(4L, DataType::Index);
+    Val* mul = IrBuilder::mulExpr(i0, four);
+    return add ? IrBuilder::addExpr(mul, tidx) : IrBuilder::subExpr(mul, tidx);
+  };
+  Val* first = index(true);
+  EXPECT_EQ(index(true), first);
+  Val* sub = index(false);
+  EXPECT_NE(sub, first);
+  EXPECT_EQ(sub->definition()->input(0), first->definition()->input(0));
+
+  // Removed Vals are not reused
+  fusion.removeVal(first);
+  Val* second = index(true);
+  EXPECT_TRUE(fusion.inContainer(second));
+  EXPECT_EQ(index(true), second);
+
+  fusion.setScalarInterning(false);
+  EXPECT_NE(index(true), second);
+}
+
+TEST_F(NVFuserTest, UnionFind) {
+  DisjointSets<int> initial;
+  initial.mapEntries(0, 1);
+  initial.initializeSet(2);
+  initial.mapEntries(3, 4);
+
+  // Merge the same pairs with both containers
+  DisjointSets<int> expected = initial;
+  UnionFind<int> union_find(initial);
+  const std::vector<std::pair<int, int>> pairs{
+      {5, 6}, {1, 6}, {7, 7}, {4, 8}, {8, 3}, {9, 5}};
+  for (const auto& [a, b] : pairs) {
+    expected.mapEntries(a, b);
+    union_find.mapEntries(a, b);
+  }
+  EXPECT_TRUE(union_find.permissiveAreMapped(0, 9));
+  EXPECT_FALSE(union_find.permissiveAreMapped(0, 2));
+  EXPECT_FALSE(union_find.permissiveAreMapped(0, 10));
+
+  DisjointSets<int> sets = union_find.toDisjointSets();
+  EXPECT_EQ(sets.size(), expected.size());
+  for (auto i : c10::irange(10)) {
+    for (auto j : c10::irange(10)) {
+      EXPECT_EQ(
+          sets.permissiveAreMapped(i, j), expected.permissiveAreMapped(i, j));
+    }
+  }
+  // Sets are ordered by their first element
+  EXPECT_EQ(
+      sets.disjointSets().front()->vector(),
+      std::vector<int>({0, 1, 5, 6, 9}));
+  EXPECT_EQ(sets.disjointSets().at(1)->vector(), std::vector<int>({2}));
+}
+
+TEST_F(NVFuserTest, RunFusionWithArgs) {
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+  auto tv0 = makeContigTensor(2);
+  auto s1 = IrBuilder::create<Val>(DataType::Double);
+  fusion->addInput(tv0);
+  fusion->addInput(s1);
+  fusion->addOutput(mul(tv0, s1));
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor t0 = at::randn({128, 64}, options);
+
+  FusionExecutorCache fec(std::move(fusion));
+  auto cg_outputs = fec.runFusionWithInputs({t0, 2.0});
+  FusionKernelRuntime* runtime = fec.getMostRecentKernelRuntime();
+
+  KernelArgumentHolder args;
+  args.setDeviceIndex(0);
+  args.pushTensor(
+      t0.data_ptr(), t0.sizes().vec(), t0.strides().vec(), t0.scalar_type());
+  args.push(PolymorphicValue(3.0));
+  auto arg_outputs = fec.runFusionWithArgs(args);
+
+  // Both entry points encode the inputs the same way
+  EXPECT_EQ(fec.getMostRecentKernelRuntime(), runtime);
+  EXPECT_EQ(fec.countRuntimes(), 1);
+  testValidate(fec.fusion(), cg_outputs, {t0, 2.0}, __LINE__, __FILE__);
+  testValidate(fec.fusion(), arg_outputs, {t0, 3.0}, __LINE__, __FILE__);
+}
+
+TEST_F(NVFuserTest, OutputBuffers) {
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+  auto tv0 = makeContigTensor(2);
+  fusion->addInput(tv0);
+  auto tv1 = add(tv0, IrBuilder::create<Val>(1.0));
+  fusion->addOutput(tv1);
+  fusion->addOutput(sum(tv1, {1}));
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor t0 = at::randn({128, 64}, options);
+  at::Tensor buffer = at::empty({128, 64}, options);
+
+  FusionExecutorCache fec(std::move(fusion));
+  // The second output is allocated by nvFuser
+  auto cg_outputs = fec.runFusionWithInputs(
+      {t0}, std::nullopt, std::nullopt, {buffer, at::Tensor()});
+  EXPECT_TRUE(cg_outputs.at(0).is_same(buffer));
+  testValidate(fec.fusion(), cg_outputs, {t0}, __LINE__, __FILE__);
+
+  // The buffer of an output must have the strides it would be allocated with
+  at::Tensor transposed_buffer = at::empty({64, 128}, options).t();
+  EXPECT_THAT(
+      [&]() {
+        fec.runFusionWithInputs(
+            {t0},
+            std::nullopt,
+            std::nullopt,
+            {transposed_buffer, at::Tensor()});
+      },
+      ::testing::ThrowsMessage<nvfuser::nvfError>(
+          ::testing::HasSubstr("has strides")));
+}
+
+// Kernels keep their PTX with EnableOption::PortableSerde, so that a serialized
+// cache can be loaded on newer architectures
+TEST_F(NVFuserTest, PortableSerdeKeepsPtx) {
+  EnableOptionsGuard opt_guard;
+  EnableOptionsGuard::getCurOptions().set(EnableOption::PortableSerde);
+
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+  auto tv0 = makeSymbolicTensor(1);
+  fusion->addInput(tv0);
+  auto tv1 = add(tv0, IrBuilder::create<Val>(1.0));
+  fusion->addOutput(tv1);
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor t0 = at::randn({1024}, options);
+
+  FusionExecutor fe;
+  fe.compileFusion(fusion.get(), {t0});
+  EXPECT_FALSE(fe.compiledKernel().ptx.empty());
+
+  auto cg_outputs = fe.runFusion({t0});
+  testValidate(fusion.get(), cg_outputs, {t0}, __LINE__, __FILE__);
+}
+
+// Workspaces of zeroedWorkspace are zeroed again on their stream when
+// released, and reused by the next request of the same size class
+TEST_F(NVFuserTest, ZeroedWorkspacePool) {
+  const c10::Device device(at::kCUDA, 0);
+  at::Tensor workspace = zeroedWorkspace({100}, at::kFloat, device);
+  EXPECT_EQ(at::count_nonzero(workspace).item<int64_t>(), 0);
+  void* data = workspace.data_ptr();
+  workspace.fill_(1.0f);
+  releaseZeroedMemory();
+
+  at::Tensor reused = zeroedWorkspace({10, 10}, at::kInt, device);
+  EXPECT_EQ(reused.data_ptr(), data);
+  EXPECT_EQ(at::count_nonzero(reused).item<int64_t>(), 0);
+
+  // Held workspaces are not handed out again before they are released
+  at::Tensor other = zeroedWorkspace({10}, at::kFloat, device);
+  EXPECT_NE(other.data_ptr(), data);
+  releaseZeroedMemory();
+}
+
 // Test file size should be up to 10K LoC. Create a new file for more tests.
 
 } // namespace nvfuser
@@ -2557,6 +2557,56 @@ TEST_F(NVFuserTest, FusionCrossEntropyGatherPattern_CUDA) {
   testValidate(&fusion, cg_outputs, inputs, {ref}, __LINE__, __FILE__);
 }
 
+// Grid allreduce along BIDx only, so on Hopper the kernel is launched with
+// clusters spanning gridDim.x and its grid syncs use cluster barriers. The
+// grid is larger than what can be resident at once, which a cooperative
+// launch would reject.
+TEST_F(NVFuserTest, FusionGridAllreduceClusterSync_CUDA) {
+  NVFUSER_TEST_CUDA_ARCH_GUARD(9, 0);
+
+  const int nx = 99;
+  const int ny = 10000;
+  const int tidx = 32;
+
+  Fusion fusion;
+  FusionGuard fg(&fusion);
+
+  auto tv0 = makeSymbolicTensor(2);
+  fusion.addInput(tv0);
+
+  auto tv1 = sum(tv0, {1});
+  auto tv2 = broadcast(tv1, {false, true});
+  auto tv3 = add(tv0, tv2);
+
+  fusion.addOutput(tv3);
+
+  tv3->split(1, tidx);
+  TransformPropagator propagator(tv3);
+  MaxLogicalDomainInfoSpanningTree(tv3).traverse(&propagator);
+
+  tv3->axis(0)->parallelize(ParallelType::BIDy);
+  tv3->axis(1)->parallelize(ParallelType::BIDx);
+  tv3->axis(2)->parallelize(ParallelType::TIDx);
+  scheduler_utils::parallelizeAllLike(tv3);
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  auto t0 = at::randn({ny, nx}, options);
+
+  FusionExecutor fe;
+  fe.compileFusion(&fusion, {t0});
+
+  ParallelTypeBitmap bidx;
+  bidx.set(ParallelType::BIDx);
+  EXPECT_TRUE(fe.kernel()->summary().has_cooperative_grid_reduction);
+  EXPECT_EQ(fe.kernel()->summary().cooperative_sync_dims, bidx);
+
+  auto cg_outputs = fe.runFusion({t0});
+
+  auto ref = t0 + sum(t0, {1}).unsqueeze(1);
+
+  testValidate(&fusion, cg_outputs, {t0}, {ref}, __LINE__, __FILE__);
+}
+
 TEST_F(NVFuserTest, FusionTensorRankLimit) {
   auto fusion = std::make_unique<Fusion>();
   FusionGuard fg(fusion.get());
@@ -2582,4 +2632,43 @@ TEST_F(NVFuserTest, FusionTensorRankLimit) {
       executor_cache.fusion(), cg_outputs, aten_inputs, __LINE__, __FILE__);
 }
 
+// With EnableOption::GroupReductions, the reduction scheduler groups pairs of
+// sibling grid reductions
+TEST_F(NVFuserTest, FusionGroupSiblingGridReductions_CUDA) {
+  Fusion fusion;
+  FusionGuard fg(&fusion);
+
+  auto tv0 = makeSymbolicTensor(2);
+  fusion.addInput(tv0);
+  auto tv1 = sum(tv0, {1});
+  auto tv2 = sum(mul(tv0, tv0), {1});
+  auto tv3 = max(tv0, {1});
+  fusion.addOutput(tv1);
+  fusion.addOutput(tv2);
+  fusion.addOutput(tv3);
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor t0 = at::randn({4, 1 << 20}, options);
+
+  EnableOptionsGuard opt_guard;
+  EnableOptionsGuard::getCurOptions().set(EnableOption::GroupReductions);
+
+  auto rparams = getReductionHeuristics(&fusion, {t0});
+  ASSERT_TRUE(rparams->cross_grid_inner_reduction);
+  scheduleReduction(&fusion, *rparams);
+
+  // One pair is grouped, the third reduction stays a ReductionOp
+  auto grouped_ops = ir_utils::getOpsOfType<GroupedReductionOp>(&fusion);
+  EXPECT_FALSE(grouped_ops.empty());
+  for (auto grouped_op : grouped_ops) {
+    EXPECT_EQ(grouped_op->numHorizontallyGroupedExprs(), 2);
+  }
+
+  FusionExecutor fe;
+  fe.compileFusion(&fusion, {t0}, rparams->lparams);
+  auto cg_outputs = fe.runFusion({t0}, rparams->lparams);
+
+  testValidate(&fusion, cg_outputs, {t0}, __LINE__, __FILE__);
+}
+
 } // namespace nvfuser
@@ -9,6 +9,7 @@
 #include <gmock/gmock-matchers.h>
 #include <gtest/gtest.h>
 
+#include <device_lower/analysis/bank_conflict.h>
 #include <executor.h>
 #include <inlining.h>
 #include <kernel_cache.h>
@@ -1387,4 +1388,106 @@ TEST_F(TransposeTest, ReductionIterDomainOnInputsIssue1659) {
   testValidate(fusion_ptr, cg_outputs, {t0, t1}, __LINE__, __FILE__);
 }
 
+// NCHW to NHWC on Hopper, where both groups meet the alignment of TMA.
+// See Note [TMA transpose]
+TEST_F(TransposeTest, TmaNchwToNhwc) {
+  if (cudaArchGuardShouldSkip(9, 0)) {
+    GTEST_SKIP() << "skipping tests on pre-Hopper GPUs";
+  }
+  for (auto dtype : {DataType::Float, DataType::Half}) {
+    auto fusion = std::make_unique<Fusion>();
+    FusionGuard fg(fusion.get());
+
+    auto tv0 = makeContigTensor(3, dtype);
+    fusion->addInput(tv0);
+    auto tv1 = transpose(tv0, 1, 2);
+    fusion->addOutput(tv1);
+
+    auto options = at::TensorOptions()
+                       .dtype(data_type_to_aten(dtype))
+                       .device(at::kCUDA, 0);
+    // [N, C, H * W] with a partial last tile along C
+    at::Tensor t0 = at::randn({8, 200, 56 * 56}, options);
+
+    FusionExecutorCache executor_cache(std::move(fusion));
+    auto cg_outputs = executor_cache.runFusionWithInputs({t0});
+
+    auto runtime = executor_cache.getMostRecentKernelRuntime();
+    const auto& heuristics =
+        runtime->schedulerHeuristics()->heuristicsList().at(0);
+    ASSERT_EQ(heuristics->heuristic(), ScheduleHeuristic::Transpose);
+    EXPECT_TRUE(heuristics->transposeParams().use_tma);
+    EXPECT_TRUE(t0.transpose(1, 2).equal(cg_outputs.at(0)));
+  }
+}
+
+// See Note [Shared memory tile swizzle]
+TEST_F(TransposeTest, SwizzleSmemTiles) {
+  EnableOptionsGuard opt_guard;
+  EnableOptionsGuard::getCurOptions().set(EnableOption::SmemSwizzle);
+
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+
+  auto tv0 = makeContigTensor(2);
+  fusion->addInput(tv0);
+  auto tv1 = transpose(tv0, 0, 1);
+  fusion->addOutput(tv1);
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor t0 = at::randn({1024, 2048}, options);
+
+  FusionExecutorCache executor_cache(std::move(fusion));
+  auto cg_outputs = executor_cache.runFusionWithInputs({t0});
+
+  auto runtime = executor_cache.getMostRecentKernelRuntime();
+  const auto& heuristics =
+      runtime->schedulerHeuristics()->heuristicsList().at(0);
+  ASSERT_EQ(heuristics->heuristic(), ScheduleHeuristic::Transpose);
+  if (!heuristics->transposeParams().use_tma) {
+    EXPECT_TRUE(heuristics->transposeParams().swizzle_smem_tiles);
+    EXPECT_TRUE(getBankConflictInfo(runtime->executors().at(0).kernel())
+                    .empty());
+  }
+  EXPECT_TRUE(t0.t().equal(cg_outputs.at(0)));
+}
+
+// See Note [Multi-group transpose]
+TEST_F(TransposeTest, MultiGroupTranspose) {
+  EnableOptionsGuard opt_guard;
+  EnableOptionsGuard::getCurOptions().set(EnableOption::MultiGroupTranspose);
+
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+
+  // Three groups with the inner-most dimensions z, y and x
+  auto tv0 = makeContigTensor(3);
+  fusion->addInput(tv0);
+  auto tv1 = makeContigTensor(3);
+  fusion->addInput(tv1);
+  auto tv2 = transpose(tv1, 1, 2);
+  auto tv3 = add(tv0, tv2);
+  auto tv4 = permute(tv3, {2, 1, 0});
+  fusion->addOutput(tv4);
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor t0 = at::randn({64, 128, 256}, options);
+  at::Tensor t1 = at::randn({64, 256, 128}, options);
+
+  FusionExecutorCache executor_cache(std::move(fusion));
+  auto cg_outputs = executor_cache.runFusionWithInputs({t0, t1});
+
+  auto runtime = executor_cache.getMostRecentKernelRuntime();
+  const auto& heuristics =
+      runtime->schedulerHeuristics()->heuristicsList().at(0);
+  ASSERT_EQ(heuristics->heuristic(), ScheduleHeuristic::Transpose);
+  const auto& tparams = heuristics->transposeParams();
+  EXPECT_EQ(tparams.tile_size1, 8);
+  EXPECT_EQ(tparams.tile_size2, 8);
+  EXPECT_EQ(tparams.extra_tile_sizes, std::vector<int64_t>{8});
+
+  auto ref = (t0 + t1.transpose(1, 2)).permute({2, 1, 0});
+  EXPECT_TRUE(ref.equal(cg_outputs.at(0)));
+}
+
 } // namespace nvfuser
@@ -12,6 +12,8 @@
 #include <fusion_segmenter.h>
 #include <host_ir/container.h>
 #include <host_ir/executor.h>
+#include <host_ir/passes.h>
+#include <host_ir/recurrence.h>
 #include <ir/all_nodes.h>
 #include <ir/builder.h>
 #include <multidevice/lower_communication.h>
@@ -458,6 +460,66 @@ TEST_P(HostIrTest, ForLoops) {
   EXPECT_TRUE(expected_result.equal(buffer_at));
 }
 
+// Runs a recurrent cell computing, at each step t of a sequence,
+//   h = tanh(x[t] + h * w)
+//   y[t] = h
+// where h is the state carried across steps and w is a weight.
+TEST_P(HostIrTest, RecurrentCell) {
+  constexpr int64_t kSequenceLength = 5;
+  constexpr int64_t kHiddenSize = 32;
+
+  auto cell = std::make_unique<Fusion>();
+  {
+    FusionGuard fg(cell.get());
+    TensorView* x = makeContigTensor(1);
+    TensorView* y_buffer = makeContigTensor(1);
+    TensorView* h = makeContigTensor(1);
+    TensorView* w = makeContigTensor(1);
+    TensorView* next_h = tanh(add(x, mul(h, w)));
+    TensorView* y = set(next_h);
+    cell->addInput(x);
+    cell->addInput(y_buffer);
+    cell->addInput(h);
+    cell->addInput(w);
+    cell->addOutput(next_h);
+    cell->addOutput(y);
+    cell->aliasOutputToInput(next_h, h, AllocationType::ReuseBuffer);
+    cell->aliasOutputToInput(y, y_buffer, AllocationType::ReuseBuffer);
+  }
+
+  std::unique_ptr<HostIrContainer> hic =
+      makeRecurrentProgram(std::move(cell), /*sequence_inputs=*/{0, 1});
+  std::vector<Val*> inputs = hic->inputs();
+
+  HostIrExecutorParams params;
+  auto [use_fusion_executor_cache] = GetParam();
+  params.use_fusion_executor_cache = use_fusion_executor_cache;
+  HostIrExecutor hie(std::move(hic), /*communicator=*/nullptr, params);
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor x = at::randn({kSequenceLength, kHiddenSize}, options);
+  at::Tensor y = at::zeros({kSequenceLength, kHiddenSize}, options);
+  at::Tensor h = at::randn({kHiddenSize}, options);
+  at::Tensor w = at::randn({kHiddenSize}, options);
+
+  at::Tensor expected_h = h.clone();
+  std::vector<at::Tensor> expected_y;
+  for (auto t : c10::irange(kSequenceLength)) {
+    expected_h = at::tanh(x[t] + expected_h * w);
+    expected_y.push_back(expected_h);
+  }
+
+  std::vector<at::Tensor> outputs = hie.runWithInput(
+      {{inputs.at(0), x},
+       {inputs.at(1), y},
+       {inputs.at(2), h},
+       {inputs.at(3), w}});
+
+  EXPECT_TRUE(at::allclose(h, expected_h));
+  EXPECT_TRUE(at::allclose(y, at::stack(expected_y)));
+  EXPECT_TRUE(at::allclose(outputs.at(0), expected_h));
+}
+
 INSTANTIATE_TEST_SUITE_P(
     ,
     HostIrTest,
@@ -853,6 +915,144 @@ INSTANTIATE_TEST_SUITE_P(
       return ss.str();
     });
 
+using HostIrPassesTest = NVFuserTest;
+
+namespace {
+
+// Returns a PostOnStream computing out = -in
+PostOnStream* makeNegation(TensorView* in, TensorView* out) {
+  auto fusion = std::make_unique<Fusion>();
+  {
+    FusionGuard fg(fusion.get());
+    TensorView* tv = makeSymbolicTensor(1);
+    fusion->addInput(tv);
+    fusion->addOutput(neg(tv));
+  }
+  return IrBuilder::create<PostOnStream>(
+      IrBuilder::create<HostUnit>(std::move(fusion)),
+      std::vector<Val*>{in},
+      std::vector<Val*>{out});
+}
+
+} // namespace
+
+TEST_F(HostIrPassesTest, DeferWaits) {
+  auto hic = std::make_unique<HostIrContainer>();
+  FusionGuard fg(hic.get());
+  TensorView* tv0 = makeSymbolicTensor(1);
+  TensorView* tv1 = makeSymbolicTensor(1);
+  TensorView* tv2 = makeSymbolicTensor(1);
+  TensorView* tv3 = makeSymbolicTensor(1);
+  auto* communication = IrBuilder::create<Communication>(
+      CommunicationType::Allgather, tv1, tv0, Team({0}));
+  auto* wait = IrBuilder::create<Wait>(communication);
+  PostOnStream* independent = makeNegation(tv0, tv2);
+  PostOnStream* consumer = makeNegation(tv1, tv3);
+  for (Expr* expr :
+       std::vector<Expr*>{communication, wait, independent, consumer}) {
+    hic->pushBackTopLevelExprs(expr);
+  }
+
+  deferWaits(hic.get());
+
+  EXPECT_EQ(
+      hic->topLevelExprs(),
+      (std::vector<Expr*>{communication, independent, wait, consumer}));
+}
+
+TEST_F(HostIrPassesTest, AssignStreams) {
+  auto hic = std::make_unique<HostIrContainer>();
+  FusionGuard fg(hic.get());
+  TensorView* tv0 = makeSymbolicTensor(1);
+  TensorView* tv1 = makeSymbolicTensor(1);
+  TensorView* tv2 = makeSymbolicTensor(1);
+  TensorView* tv3 = makeSymbolicTensor(1);
+  hic->pushBackTopLevelExprs(makeNegation(tv0, tv1));
+  hic->pushBackTopLevelExprs(makeNegation(tv0, tv2));
+  hic->pushBackTopLevelExprs(makeNegation(tv2, tv3));
+  hic->addInput(tv0);
+  hic->addOutput(tv2);
+  hic->addOutput(tv3);
+
+  assignStreams(hic.get(), /*number_of_streams=*/2);
+
+  // The first two are posted on different streams, and the third one on the
+  // first stream after waiting for the second one.
+  std::vector<Stream*> streams;
+  int64_t number_of_synchronizations = 0;
+  for (Expr* expr : hic->topLevelExprs()) {
+    if (auto* set_stream = dynamic_cast<SetCurrentStream*>(expr)) {
+      streams.push_back(set_stream->stream());
+    }
+    number_of_synchronizations += expr->isA<Synchronize>() ? 1 : 0;
+  }
+  ASSERT_EQ(streams.size(), 4);
+  EXPECT_NE(streams.at(0), streams.at(1));
+  EXPECT_EQ(streams.at(2), streams.at(0));
+  EXPECT_EQ(streams.at(3), hic->getDefaultStream());
+  // One per PostOnStream to wait for the default stream, one for the
+  // dependency, and one per stream at the end.
+  EXPECT_EQ(number_of_synchronizations, 3 + 1 + 2);
+
+  HostIrExecutor hie(std::move(hic));
+  at::Tensor t0 = at::randn({8}, at::TensorOptions().device(at::kCUDA, 0));
+  std::vector<at::Tensor> outputs = hie.runWithInput({{tv0, t0}});
+  EXPECT_TRUE(outputs.at(0).equal(-t0));
+  EXPECT_TRUE(outputs.at(1).equal(t0));
+}
+
+TEST_F(HostIrPassesTest, OffloadActivations) {
+  auto hic = std::make_unique<HostIrContainer>();
+  FusionGuard fg(hic.get());
+  TensorView* tv0 = makeSymbolicTensor(1);
+  TensorView* tv1 = makeSymbolicTensor(1);
+  TensorView* tv2 = makeSymbolicTensor(1);
+  TensorView* tv3 = makeSymbolicTensor(1);
+  TensorView* tv4 = makeSymbolicTensor(1);
+  hic->pushBackTopLevelExprs(makeNegation(tv0, tv1));
+  hic->pushBackTopLevelExprs(makeNegation(tv0, tv2));
+  hic->pushBackTopLevelExprs(makeNegation(tv2, tv3));
+  hic->pushBackTopLevelExprs(makeNegation(tv1, tv4));
+  hic->addInput(tv0);
+  hic->addOutput(tv3);
+  hic->addOutput(tv4);
+
+  offloadActivations(
+      hic.get(), /*min_distance=*/2, /*prefetch_budget_bytes=*/1 << 20);
+
+  // tv1 is offloaded after its producer, and prefetched before the
+  // PostOnStream preceding its consumer since its size isn't known.
+  std::vector<Expr*> posts;
+  OffloadToHost* offload = nullptr;
+  PrefetchToDevice* prefetch = nullptr;
+  int64_t posts_before_prefetch = -1;
+  for (Expr* expr : hic->topLevelExprs()) {
+    if (expr->isA<PostOnStream>()) {
+      posts.push_back(expr);
+    } else if (expr->isA<OffloadToHost>()) {
+      EXPECT_EQ(offload, nullptr);
+      offload = expr->as<OffloadToHost>();
+    } else if (expr->isA<PrefetchToDevice>()) {
+      EXPECT_EQ(prefetch, nullptr);
+      prefetch = expr->as<PrefetchToDevice>();
+      posts_before_prefetch = (int64_t)posts.size();
+    }
+  }
+  ASSERT_NE(offload, nullptr);
+  ASSERT_NE(prefetch, nullptr);
+  EXPECT_EQ(offload->in(), tv1);
+  EXPECT_EQ(prefetch->in(), offload->out());
+  EXPECT_EQ(posts_before_prefetch, 2);
+  ASSERT_EQ(posts.size(), 4);
+  EXPECT_EQ(posts.back()->input(0), prefetch->out());
+
+  HostIrExecutor hie(std::move(hic));
+  at::Tensor t0 = at::randn({8}, at::TensorOptions().device(at::kCUDA, 0));
+  std::vector<at::Tensor> outputs = hie.runWithInput({{tv0, t0}});
+  EXPECT_TRUE(outputs.at(0).equal(t0));
+  EXPECT_TRUE(outputs.at(1).equal(t0));
+}
+
 } // namespace hir
 
 } // namespace nvfuser
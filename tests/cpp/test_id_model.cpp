@@ -2614,4 +2614,50 @@ TEST_F(IdModelTest, ParallelTypePropagation) {
       << "Parallel type propagation failed";
 }
 
+TEST_F(IdModelTest, UpdateAfterTransforms) {
+  Fusion fusion;
+  FusionGuard fg(&fusion);
+
+  auto tv0 = makeSymbolicTensor(2);
+  fusion.addInput(tv0);
+  auto tv1 = set(tv0);
+  auto tv2 = set(tv1);
+  fusion.addOutput(tv2);
+
+  IdModel id_model(&fusion);
+
+  for (auto tv : {tv1, tv2}) {
+    tv->merge(0);
+    tv->split(0, 4);
+    tv->split(0, 1);
+  }
+  tv1->inlineAt(-1);
+  id_model.updateAfterTransforms();
+
+  IdModel rebuilt(&fusion);
+  for (auto mode :
+       {IdMappingMode::EXACT,
+        IdMappingMode::ALMOSTEXACT,
+        IdMappingMode::PERMISSIVE,
+        IdMappingMode::LOOP}) {
+    const ValGraph& graph = id_model.idGraph(mode);
+    const ValGraph& rebuilt_graph = rebuilt.idGraph(mode);
+    for (auto i : c10::irange(tv2->nDims())) {
+      EXPECT_EQ(
+          graph.disjointValSets().strictAreMapped(tv1->axis(i), tv2->axis(i)),
+          rebuilt_graph.disjointValSets().strictAreMapped(
+              tv1->axis(i), tv2->axis(i)))
+          << "Mismatched mapping of axis " << i << " in " << mode;
+    }
+  }
+  // The split by one is trivial
+  Val* split_by_one_input = tv2->axis(0)->definition()->input(0);
+  EXPECT_TRUE(id_model.idGraph(IdMappingMode::ALMOSTEXACT)
+                  .disjointValSets()
+                  .strictAreMapped(tv2->axis(0), split_by_one_input));
+  EXPECT_TRUE(id_model.idGraph(IdMappingMode::EXACT)
+                  .disjointValSets()
+                  .strictAreMapped(tv1->axis(2), tv2->axis(2)));
+}
+
 } // namespace nvfuser
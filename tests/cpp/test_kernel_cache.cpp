@@ -0,0 +1,1305 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+#include <gmock/gmock-matchers.h>
+#include <gtest/gtest.h>
+
+#include <ATen/cuda/CUDAContext.h>
+
+#include <c10/cuda/CUDAStream.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <unordered_set>
+
+#include <fusion.h>
+#include <executor_utils.h>
+#include <kernel_cache.h>
+#include <ops/all_ops.h>
+#include <options.h>
+#include <scheduler/tuning_db.h>
+#include <tests/cpp/utils.h>
+#include <tests/cpp/validator.h>
+
+namespace nvfuser {
+
+using KernelCacheTest = NVFuserTest;
+
+// Replay a captured CUDA graph with new input buffers and recapture it when a
+// scalar input changes. Outputs are static buffers in this mode, so each
+// result is validated before the next run.
+TEST_F(KernelCacheTest, CudaGraphReplay) {
+  EnableOptionsGuard opt_guard;
+  EnableOptionsGuard::getCurOptions().set(EnableOption::CudaGraph);
+
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+
+  auto tv0 = makeContigTensor(2);
+  auto tv1 = makeContigTensor(1);
+  auto s2 = IrBuilder::create<Val>(DataType::Double);
+  fusion->addInput(tv0);
+  fusion->addInput(tv1);
+  fusion->addInput(s2);
+
+  auto tv3 = add(tv0, broadcast(tv1, {true, false}));
+  auto tv4 = mul(tv3, s2);
+  auto tv5 = sum(tv4, {1});
+  fusion->addOutput(tv4);
+  fusion->addOutput(tv5);
+
+  FusionExecutorCache executor_cache(std::move(fusion));
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  auto run = [&](double scalar) {
+    at::Tensor t0 = at::randn({129, 1031}, options);
+    at::Tensor t1 = at::randn({1031}, options);
+    std::vector<c10::IValue> aten_inputs({t0, t1, scalar});
+    auto cg_outputs = executor_cache.runFusionWithInputs(aten_inputs);
+    testValidate(
+        executor_cache.fusion(), cg_outputs, aten_inputs, __LINE__, __FILE__);
+  };
+
+  run(2.0);
+  run(2.0);
+  run(3.0);
+  run(3.0);
+}
+
+// Run two pointwise segments as the phases of one megakernel. The second
+// segment reads the output of the first one right after the grid sync.
+TEST_F(KernelCacheTest, Megakernel) {
+  EnableOptionsGuard opt_guard;
+  EnableOptionsGuard::getCurOptions().set(EnableOption::Megakernel);
+
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+
+  auto tv0 = makeContigTensor(2);
+  fusion->addInput(tv0);
+  auto tv1 = sin(tv0);
+  auto tv2 = segment_set(tv1);
+  auto tv3 = cos(tv2);
+  auto tv4 = add(tv3, tv0);
+  fusion->addOutput(tv4);
+
+  FusionExecutorCache executor_cache(std::move(fusion));
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  for ([[maybe_unused]] auto i : c10::irange(2)) {
+    at::Tensor t0 = at::randn({1024, 1031}, options);
+    auto cg_outputs = executor_cache.runFusionWithInputs({t0});
+    testValidate(executor_cache.fusion(), cg_outputs, {t0}, __LINE__, __FILE__);
+  }
+
+  FusionKernelRuntime* runtime = executor_cache.getMostRecentKernelRuntime();
+  EXPECT_EQ(runtime->fusionSegments()->groups().size(), 2);
+  ASSERT_NE(runtime->megakernel(), nullptr);
+  EXPECT_EQ(runtime->megakernel()->numLaunches(), 2);
+}
+
+// Segment outputs only read by later segments are views of the arena of the
+// runtime. The arena is planned during the first run with each input id and
+// reused by the following runs.
+TEST_F(KernelCacheTest, IntermediateArena) {
+  EnableOptionsGuard opt_guard;
+  EnableOptionsGuard::getCurOptions().set(EnableOption::IntermediateArena);
+
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+
+  auto tv0 = makeContigTensor(3);
+  fusion->addInput(tv0);
+  auto tv1 = add(tv0, IrBuilder::create<Val>(1.0));
+  auto tv2 = sum(tv1, {2});
+  auto tv3 = softmax(tv2, 1);
+  fusion->addOutput(tv3);
+
+  FusionExecutorCache executor_cache(std::move(fusion));
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  auto run = [&](const std::vector<int64_t>& shape) {
+    std::vector<c10::IValue> aten_inputs({at::randn(shape, options)});
+    auto cg_outputs = executor_cache.runFusionWithInputs(aten_inputs);
+    EXPECT_TRUE(executor_cache.getMostRecentKernelRuntime()->isSegmented());
+    testValidate(
+        executor_cache.fusion(), cg_outputs, aten_inputs, __LINE__, __FILE__);
+  };
+
+  for ([[maybe_unused]] auto i : c10::irange(3)) {
+    run({32, 64, 8});
+  }
+  run({16, 128, 8});
+  run({32, 64, 8});
+}
+
+// Independent expert matmuls with a different number of tokens each run on
+// different streams, followed by reductions reading their results on the
+// stream of their producer or another.
+TEST_F(KernelCacheTest, ConcurrentSegments) {
+  EnableOptionsGuard opt_guard;
+  EnableOptionsGuard::getCurOptions().set(EnableOption::ConcurrentSegments);
+
+  constexpr int64_t num_experts = 4;
+  constexpr int64_t hidden = 256;
+  constexpr int64_t ffn = 512;
+  const std::vector<int64_t> tokens = {64, 200, 8, 128};
+
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+
+  for ([[maybe_unused]] auto e : c10::irange(num_experts)) {
+    auto x = makeContigTensor(2, DataType::Half);
+    auto w = makeContigTensor(2, DataType::Half);
+    fusion->addInput(x);
+    fusion->addInput(w);
+    auto y = matmul(x, w);
+    fusion->addOutput(y);
+    fusion->addOutput(sum(castOp(DataType::Float, y), {0}));
+  }
+
+  FusionExecutorCache executor_cache(std::move(fusion));
+
+  auto options = at::TensorOptions().dtype(at::kHalf).device(at::kCUDA, 0);
+  std::vector<c10::IValue> aten_inputs;
+  std::vector<at::Tensor> expected;
+  for (auto e : c10::irange(num_experts)) {
+    at::Tensor x = at::randn({tokens.at(e), hidden}, options);
+    at::Tensor w = at::randn({hidden, ffn}, options);
+    aten_inputs.push_back(x);
+    aten_inputs.push_back(w);
+    at::Tensor y = at::matmul(x, w);
+    expected.push_back(y);
+    expected.push_back(y.to(at::kFloat).sum({0}));
+  }
+
+  for ([[maybe_unused]] auto run : c10::irange(2)) {
+    auto cg_outputs = executor_cache.runFusionWithInputs(aten_inputs);
+    EXPECT_TRUE(executor_cache.getMostRecentKernelRuntime()->isSegmented());
+    ASSERT_EQ(cg_outputs.size(), expected.size());
+    for (auto i : c10::irange(expected.size())) {
+      EXPECT_TRUE(at::allclose(
+          cg_outputs.at(i).to(at::kFloat),
+          expected.at(i).to(at::kFloat),
+          1e-2,
+          1e-1))
+          << "Mismatch in output " << i;
+    }
+  }
+}
+
+// Runs with new input shapes are evaluated with ATen while their kernels are
+// compiled in the background, and use the kernels once compiled.
+TEST_F(KernelCacheTest, AsyncCompile) {
+  EnableOptionsGuard opt_guard;
+  EnableOptionsGuard::getCurOptions().set(EnableOption::AsyncCompile);
+
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+
+  auto tv0 = makeSymbolicTensor(2);
+  auto tv1 = makeSymbolicTensor(1);
+  fusion->addInput(tv0);
+  fusion->addInput(tv1);
+  auto tv2 = add(tv0, broadcast(tv1, {true, false}));
+  auto tv3 = sum(exp(tv2), {1});
+  fusion->addOutput(tv2);
+  fusion->addOutput(tv3);
+
+  FusionExecutorCache executor_cache(std::move(fusion));
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  auto run = [&](int64_t m, int64_t n) {
+    std::vector<c10::IValue> aten_inputs(
+        {at::randn({m, n}, options), at::randn({n}, options)});
+    auto cg_outputs = executor_cache.runFusionWithInputs(aten_inputs);
+    testValidate(
+        executor_cache.fusion(), cg_outputs, aten_inputs, __LINE__, __FILE__);
+  };
+
+  run(128, 1024);
+  run(128, 1024);
+  // Waits for the background compilation
+  EXPECT_TRUE(executor_cache.getMostRecentKernelRuntime()->isCompiled());
+  run(128, 1024);
+  run(17, 3);
+  run(17, 3);
+}
+
+// Inner dimensions of the same bucket and power-of-two factor share a single
+// runtime.
+TEST_F(KernelCacheTest, ShapeBuckets) {
+  EnableOptionsGuard opt_guard;
+  EnableOptionsGuard::getCurOptions().set(EnableOption::ShapeBuckets, {"64"});
+
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+
+  auto tv0 = makeContigTensor(2);
+  fusion->addInput(tv0);
+  auto tv1 = softmax(tv0, 1);
+  fusion->addOutput(tv1);
+
+  FusionExecutorCache executor_cache(std::move(fusion));
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  for (int64_t n : {1001, 1003, 985, 1002, 1019, 1022}) {
+    std::vector<c10::IValue> aten_inputs({at::randn({8, n}, options)});
+    auto cg_outputs = executor_cache.runFusionWithInputs(aten_inputs);
+    testValidate(
+        executor_cache.fusion(), cg_outputs, aten_inputs, __LINE__, __FILE__);
+  }
+
+  const auto& counts = executor_cache.shapeBucketRuntimeCounts();
+  ASSERT_EQ(counts.size(), 2u);
+  EXPECT_EQ(counts.at({56, 1023}), 1);
+  EXPECT_LE(counts.at({56, 1022}), 1);
+  int64_t num_runtimes = 0;
+  for (const auto& [config, runtimes] : executor_cache.getKernelRuntimes()) {
+    num_runtimes += (int64_t)runtimes.size();
+  }
+  EXPECT_LE(num_runtimes, 2);
+}
+
+// Unseen shapes of a seen bucket reuse its runtime without computing
+// heuristics.
+TEST_F(KernelCacheTest, ShapeBucketHits) {
+  EnableOptionsGuard opt_guard;
+  EnableOptionsGuard::getCurOptions().set(EnableOption::ShapeBuckets, {"64"});
+  EnableOptionsGuard::getCurOptions().set(EnableOption::RuntimeMetrics);
+
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+
+  auto tv0 = makeContigTensor(2);
+  fusion->addInput(tv0);
+  auto tv1 = add(tv0, IrBuilder::create<Val>(1.0));
+  fusion->addOutput(tv1);
+
+  FusionExecutorCache executor_cache(std::move(fusion));
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  for (int64_t n : {1001, 1003, 985, 1001}) {
+    std::vector<c10::IValue> aten_inputs({at::randn({8, n}, options)});
+    auto cg_outputs = executor_cache.runFusionWithInputs(aten_inputs);
+    testValidate(
+        executor_cache.fusion(), cg_outputs, aten_inputs, __LINE__, __FILE__);
+  }
+
+  const FusionExecutorCacheMetrics& metrics = executor_cache.metrics();
+  EXPECT_EQ(metrics.runtime_misses, 1);
+  EXPECT_EQ(metrics.shape_bucket_hits, 2);
+  EXPECT_EQ(metrics.input_id_hits, 1);
+}
+
+// Warming up with meta tensors compiles a runtime for each declared shape, so
+// that running with real inputs of those shapes creates no new runtime.
+TEST_F(KernelCacheTest, Warmup) {
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+
+  auto tv0 = makeContigTensor(2);
+  fusion->addInput(tv0);
+  auto tv1 = sum(tv0, {1});
+  fusion->addOutput(tv1);
+
+  FusionExecutorCache executor_cache(std::move(fusion));
+
+  const std::vector<std::vector<int64_t>> shapes = {
+      {4, 128}, {1024, 8}, {16, 65536}};
+  auto meta_options = at::TensorOptions().dtype(at::kFloat).device(at::kMeta);
+  std::vector<std::vector<c10::IValue>> input_sets;
+  for (const auto& shape : shapes) {
+    input_sets.push_back({at::empty(shape, meta_options)});
+  }
+  executor_cache.warmup(input_sets);
+
+  auto num_runtimes = [&]() {
+    size_t num = 0;
+    for (const auto& [config, runtimes] : executor_cache.getKernelRuntimes()) {
+      for (const auto& runtime : runtimes) {
+        EXPECT_TRUE(runtime->isCompiled());
+      }
+      num += runtimes.size();
+    }
+    return num;
+  };
+  const size_t num_warmed_up = num_runtimes();
+  EXPECT_GE(num_warmed_up, 1u);
+  EXPECT_LE(num_warmed_up, shapes.size());
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  for (const auto& shape : shapes) {
+    std::vector<c10::IValue> aten_inputs({at::randn(shape, options)});
+    auto cg_outputs = executor_cache.runFusionWithInputs(aten_inputs);
+    testValidate(
+        executor_cache.fusion(), cg_outputs, aten_inputs, __LINE__, __FILE__);
+  }
+  EXPECT_EQ(num_runtimes(), num_warmed_up);
+}
+
+// Runtimes created for new input shapes rebuild the segmentation found for
+// the first one instead of searching again.
+TEST_F(KernelCacheTest, SegmentationCache) {
+  EnableOptionsGuard enable_guard;
+  EnableOptionsGuard::getCurOptions().set(EnableOption::SegmentationCache);
+  // Create a runtime for every input shape
+  DisableOptionsGuard disable_guard;
+  DisableOptionsGuard::getCurOptions().set(DisableOption::KernelReuse);
+
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+
+  auto tv0 = makeContigTensor(3);
+  fusion->addInput(tv0);
+  auto tv1 = sum(tv0, {2});
+  auto tv2 = softmax(tv1, 1);
+  fusion->addOutput(tv2);
+
+  FusionExecutorCache executor_cache(std::move(fusion));
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  const std::vector<std::vector<int64_t>> shapes = {
+      {32, 64, 8}, {16, 128, 8}, {48, 96, 8}};
+  for (const auto& shape : shapes) {
+    std::vector<c10::IValue> aten_inputs({at::randn(shape, options)});
+    auto cg_outputs = executor_cache.runFusionWithInputs(aten_inputs);
+    EXPECT_TRUE(executor_cache.getMostRecentKernelRuntime()->isSegmented());
+    EXPECT_GT(
+        executor_cache.getMostRecentKernelRuntime()->segmentationTimeMs(), 0);
+    testValidate(
+        executor_cache.fusion(), cg_outputs, aten_inputs, __LINE__, __FILE__);
+  }
+
+  const SegmentationCache* segmentation_cache =
+      executor_cache.segmentationCache();
+  ASSERT_NE(segmentation_cache, nullptr);
+  EXPECT_EQ(segmentation_cache->size(), 1u);
+  EXPECT_EQ(segmentation_cache->misses(), 1);
+  EXPECT_EQ(segmentation_cache->hits(), (int64_t)shapes.size() - 1);
+}
+
+// Kernels compiled with the precompiled preamble, including kernels of both
+// index types, which must not share a precompiled header.
+TEST_F(KernelCacheTest, PrecompiledPreamble) {
+  EnableOptionsGuard opt_guard;
+  EnableOptionsGuard::getCurOptions().set(EnableOption::NvrtcPch);
+
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+
+  auto tv0 = makeContigTensor(2);
+  fusion->addInput(tv0);
+  auto tv1 = sum(exp(tv0), {1});
+  fusion->addOutput(tv1);
+
+  FusionExecutorCache executor_cache(std::move(fusion));
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  for (auto index_type : {PrimDataType::Int32, PrimDataType::Int}) {
+    for (int64_t n : {128, 1024}) {
+      std::vector<c10::IValue> aten_inputs({at::randn({64, n}, options)});
+      auto cg_outputs =
+          executor_cache.runFusionWithInputs(aten_inputs, index_type);
+      testValidate(
+          executor_cache.fusion(),
+          cg_outputs,
+          aten_inputs,
+          __LINE__,
+          __FILE__);
+    }
+  }
+}
+
+// The pointwise segment is compiled with the lean preamble, and the
+// reduction segment with the full one.
+TEST_F(KernelCacheTest, LeanPreamble) {
+  EnableOptionsGuard opt_guard;
+  EnableOptionsGuard::getCurOptions().set(EnableOption::LeanPreamble);
+
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+
+  auto tv0 = makeContigTensor(2);
+  fusion->addInput(tv0);
+  auto tv1 = exp(tv0);
+  auto tv2 = segment_set(tv1);
+  auto tv3 = sum(tv2, {1});
+  fusion->addOutput(tv3);
+
+  FusionExecutorCache executor_cache(std::move(fusion));
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor t0 = at::randn({64, 1024}, options);
+  auto cg_outputs = executor_cache.runFusionWithInputs({t0});
+  testValidate(executor_cache.fusion(), cg_outputs, {t0}, __LINE__, __FILE__);
+
+  FusionKernelRuntime* runtime = executor_cache.getMostRecentKernelRuntime();
+  std::vector<bool> lean;
+  for (const auto& executor : runtime->executors()) {
+    lean.push_back(
+        executor.getStructuredCode().find("namespace grid_sync") ==
+        std::string::npos);
+  }
+  EXPECT_THAT(lean, testing::UnorderedElementsAre(true, false));
+}
+
+// See [ Note -- Outlined runtime functions ] in executor_utils.cpp
+TEST_F(KernelCacheTest, OutlineRuntime) {
+  EnableOptionsGuard opt_guard;
+  EnableOptionsGuard::getCurOptions().set(EnableOption::OutlineRuntime, {"2"});
+
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+
+  auto tv0 = makeContigTensor(2);
+  fusion->addInput(tv0);
+  fusion->addOutput(sum(tv0, {1}));
+  fusion->addOutput(max(tv0, {1}));
+
+  FusionExecutorCache executor_cache(std::move(fusion));
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor t0 = at::randn({64, 1024}, options);
+  auto cg_outputs = executor_cache.runFusionWithInputs({t0});
+  testValidate(executor_cache.fusion(), cg_outputs, {t0}, __LINE__, __FILE__);
+
+  FusionKernelRuntime* runtime = executor_cache.getMostRecentKernelRuntime();
+  ASSERT_EQ(runtime->executors().size(), 1);
+  const FusionExecutor& executor = runtime->executors().at(0);
+  EXPECT_GE(executor_utils::countOutlinableCalls(executor.kernelString()), 2);
+  EXPECT_NE(
+      executor.getStructuredCode().find(
+          "#define NVFUSER_OUTLINABLE __noinline__"),
+      std::string::npos);
+}
+
+// A kernel compiled in the fast tier is replaced by its optimized version
+// after it has been launched enough times, and results are unchanged.
+TEST_F(KernelCacheTest, TieredCompile) {
+  EnableOptionsGuard opt_guard;
+  EnableOptionsGuard::getCurOptions().set(EnableOption::TieredCompile, {"2"});
+
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+
+  auto tv0 = makeContigTensor(2);
+  fusion->addInput(tv0);
+  auto tv1 = sum(exp(tv0), {1});
+  fusion->addOutput(tv1);
+
+  FusionExecutorCache executor_cache(std::move(fusion));
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  std::vector<c10::IValue> aten_inputs({at::randn({64, 1024}, options)});
+
+  auto cg_outputs = executor_cache.runFusionWithInputs(aten_inputs);
+  const FusionExecutor& fe =
+      executor_cache.getMostRecentKernelRuntime()->executors().at(0);
+  EXPECT_TRUE(fe.isFastCompiled());
+
+  // The optimized kernel is compiled in the background, so keep launching
+  // until it is swapped in
+  for (int64_t i = 0; i < 10000 && fe.isFastCompiled(); i++) {
+    cg_outputs = executor_cache.runFusionWithInputs(aten_inputs);
+    if (i > 2) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+  EXPECT_FALSE(fe.isFastCompiled());
+
+  cg_outputs = executor_cache.runFusionWithInputs(aten_inputs);
+  testValidate(
+      executor_cache.fusion(), cg_outputs, aten_inputs, __LINE__, __FILE__);
+}
+
+// A kernel launched repeatedly with the same input shapes gets a variant
+// specialized on them, which is only used for launches with those shapes.
+TEST_F(KernelCacheTest, ShapeSpecialization) {
+  EnableOptionsGuard opt_guard;
+  EnableOptionsGuard::getCurOptions().set(
+      EnableOption::ShapeSpecialization, {"2"});
+
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+
+  auto tv0 = makeSymbolicTensor(2);
+  fusion->addInput(tv0);
+  auto tv1 = add(sin(tv0), IrBuilder::create<Val>(1.0));
+  fusion->addOutput(tv1);
+
+  FusionExecutorCache executor_cache(std::move(fusion));
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  std::vector<c10::IValue> aten_inputs({at::randn({96, 1000}, options)});
+
+  auto cg_outputs = executor_cache.runFusionWithInputs(aten_inputs);
+  const FusionExecutor& fe =
+      executor_cache.getMostRecentKernelRuntime()->executors().at(0);
+  EXPECT_EQ(fe.shapeSpecializedKernel(), nullptr);
+
+  // The variant is compiled in the background, so keep launching until it
+  // is used
+  for (int64_t i = 0; i < 10000 && fe.shapeSpecializedKernel() == nullptr;
+       i++) {
+    cg_outputs = executor_cache.runFusionWithInputs(aten_inputs);
+    if (i > 2) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+  ASSERT_NE(fe.shapeSpecializedKernel(), nullptr);
+  EXPECT_NE(
+      fe.shapeSpecializedKernel()->function, fe.compiledKernel().function);
+
+  cg_outputs = executor_cache.runFusionWithInputs(aten_inputs);
+  testValidate(
+      executor_cache.fusion(), cg_outputs, aten_inputs, __LINE__, __FILE__);
+
+  // Other shapes fall back to the generic kernel
+  std::vector<c10::IValue> other_inputs({at::randn({80, 1000}, options)});
+  cg_outputs = executor_cache.runFusionWithInputs(other_inputs);
+  testValidate(
+      executor_cache.fusion(), cg_outputs, other_inputs, __LINE__, __FILE__);
+}
+
+// Segment kernels compiled with the same options are loaded from a single
+// module.
+TEST_F(KernelCacheTest, BatchCompile) {
+  EnableOptionsGuard opt_guard;
+  EnableOptionsGuard::getCurOptions().set(EnableOption::BatchCompile);
+
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+
+  auto tv0 = makeContigTensor(2);
+  fusion->addInput(tv0);
+  auto tv1 = segment_set(exp(tv0));
+  auto tv2 = segment_set(sin(tv1));
+  auto tv3 = cos(tv2);
+  fusion->addOutput(tv3);
+
+  FusionExecutorCache executor_cache(std::move(fusion));
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  std::vector<c10::IValue> aten_inputs({at::randn({128, 1024}, options)});
+  auto cg_outputs = executor_cache.runFusionWithInputs(aten_inputs);
+  testValidate(
+      executor_cache.fusion(), cg_outputs, aten_inputs, __LINE__, __FILE__);
+
+  FusionKernelRuntime* runtime = executor_cache.getMostRecentKernelRuntime();
+  EXPECT_TRUE(runtime->isSegmented());
+  int64_t num_kernels = 0;
+  std::unordered_set<CUmodule> modules;
+  for (const auto& executor : runtime->executors()) {
+    if (executor.hasCompiledKernel()) {
+      num_kernels++;
+      modules.insert(executor.compiledKernel().module);
+    }
+  }
+  EXPECT_GT(num_kernels, 1);
+  EXPECT_LT((int64_t)modules.size(), num_kernels);
+}
+
+// Identical fusions of different FusionExecutorCaches share the module of
+// their kernel.
+TEST_F(KernelCacheTest, KernelDeduplication) {
+  auto make_fusion = []() {
+    auto fusion = std::make_unique<Fusion>();
+    FusionGuard fg(fusion.get());
+    auto tv0 = makeContigTensor(2);
+    fusion->addInput(tv0);
+    auto tv1 = sum(exp(tv0), {1});
+    fusion->addOutput(tv1);
+    return fusion;
+  };
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  std::vector<c10::IValue> aten_inputs({at::randn({128, 1024}, options)});
+  auto module_of = [&aten_inputs](FusionExecutorCache& executor_cache) {
+    auto cg_outputs = executor_cache.runFusionWithInputs(aten_inputs);
+    testValidate(
+        executor_cache.fusion(), cg_outputs, aten_inputs, __LINE__, __FILE__);
+    return executor_cache.getMostRecentKernelRuntime()
+        ->executors()
+        .at(0)
+        .compiledKernel()
+        .module;
+  };
+
+  FusionExecutorCache first_cache(make_fusion());
+  FusionExecutorCache second_cache(make_fusion());
+  EXPECT_EQ(module_of(first_cache), module_of(second_cache));
+
+  DisableOptionsGuard opt_guard;
+  DisableOptionsGuard::getCurOptions().set(DisableOption::KernelDeduplication);
+  FusionExecutorCache third_cache(make_fusion());
+  EXPECT_NE(module_of(first_cache), module_of(third_cache));
+}
+
+// With a budget of 0 MiB, running a FusionExecutorCache evicts the runtimes
+// of the others, which are created again when they run.
+TEST_F(KernelCacheTest, RuntimeCacheBudget) {
+  EnableOptionsGuard opt_guard;
+  EnableOptionsGuard::getCurOptions().set(
+      EnableOption::RuntimeCacheBudget, {"0"});
+  EnableOptionsGuard::getCurOptions().set(EnableOption::RuntimeMetrics);
+
+  auto make_fusion = []() {
+    auto fusion = std::make_unique<Fusion>();
+    FusionGuard fg(fusion.get());
+    auto tv0 = makeContigTensor(2);
+    fusion->addInput(tv0);
+    fusion->addOutput(sum(exp(tv0), {1}));
+    return fusion;
+  };
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  std::vector<c10::IValue> aten_inputs({at::randn({128, 1024}, options)});
+  auto run = [&aten_inputs](FusionExecutorCache& executor_cache) {
+    auto cg_outputs = executor_cache.runFusionWithInputs(aten_inputs);
+    testValidate(
+        executor_cache.fusion(), cg_outputs, aten_inputs, __LINE__, __FILE__);
+  };
+
+  FusionExecutorCache first_cache(make_fusion());
+  FusionExecutorCache second_cache(make_fusion());
+  const int64_t evictions = runtimeCacheBudgetStats().evictions;
+
+  run(first_cache);
+  EXPECT_EQ(first_cache.countRuntimes(), 1);
+  run(second_cache);
+  EXPECT_EQ(first_cache.countRuntimes(), 0);
+  EXPECT_EQ(second_cache.countRuntimes(), 1);
+  EXPECT_EQ(first_cache.metrics().runtime_evictions, 1);
+
+  run(first_cache);
+  EXPECT_EQ(first_cache.countRuntimes(), 1);
+  EXPECT_EQ(second_cache.countRuntimes(), 0);
+  EXPECT_EQ(first_cache.metrics().runtime_misses, 2);
+
+  const RuntimeCacheBudgetStats stats = runtimeCacheBudgetStats();
+  EXPECT_EQ(stats.evictions - evictions, 2);
+  EXPECT_EQ(stats.budget_bytes, 0);
+  EXPECT_GT(stats.host_bytes + stats.device_bytes, 0);
+}
+
+// A lazily deserialized cache rebuilds its runtimes when it is first used,
+// and reuses them instead of creating new ones. Their kernels are loaded in
+// place from the buffer.
+TEST_F(KernelCacheTest, LazyDeserialization) {
+  auto make_fusion = []() {
+    auto fusion = std::make_unique<Fusion>();
+    FusionGuard fg(fusion.get());
+    auto tv0 = makeContigTensor(2);
+    fusion->addInput(tv0);
+    auto tv1 = sum(exp(tv0), {1});
+    fusion->addOutput(tv1);
+    return fusion;
+  };
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  std::vector<c10::IValue> aten_inputs({at::randn({64, 1024}, options)});
+
+  flatbuffers::FlatBufferBuilder builder(1024);
+  {
+    FusionExecutorCache executor_cache(make_fusion());
+    executor_cache.runFusionWithInputs(aten_inputs);
+    builder.Finish(executor_cache.serialize(builder));
+  }
+
+  FusionExecutorCache executor_cache(make_fusion());
+  executor_cache.deserialize(
+      flatbuffers::GetRoot<serde::FusionExecutorCache>(
+          builder.GetBufferPointer()),
+      /*fusion_id=*/0,
+      /*lazy=*/true);
+  EXPECT_EQ(executor_cache.countRuntimes(), 0);
+
+  auto cg_outputs = executor_cache.runFusionWithInputs(aten_inputs);
+  EXPECT_EQ(executor_cache.countRuntimes(), 1);
+  testValidate(
+      executor_cache.fusion(), cg_outputs, aten_inputs, __LINE__, __FILE__);
+
+  // The kernel binary is read in place from the buffer
+  const executor_utils::CompiledKernel& compiled_kernel =
+      executor_cache.getMostRecentKernelRuntime()
+          ->executors()
+          .at(0)
+          .compiledKernel();
+  EXPECT_NE(compiled_kernel.serde_buffer, nullptr);
+  EXPECT_TRUE(compiled_kernel.cubin.empty());
+  EXPECT_TRUE(compiled_kernel.ptx.empty());
+}
+
+// Concurrent lookups of the same input sets agree on their ids, and the
+// statistics account for every lookup.
+TEST_F(KernelCacheTest, InputsIdLookupConcurrent) {
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  std::vector<at::Tensor> tensors;
+  for (auto i : c10::irange(8)) {
+    tensors.push_back(at::randn({i + 1, 8}, options));
+  }
+
+  InputsIdLookup inputs_id_lookup(4);
+  constexpr int64_t num_threads = 8;
+  constexpr int64_t num_lookups = 1000;
+  std::vector<std::vector<size_t>> ids(num_threads);
+  std::vector<std::thread> threads;
+  for (auto thread_id : c10::irange(num_threads)) {
+    threads.emplace_back([&, thread_id]() {
+      // Only look up two input sets, so that none of them is evicted
+      for (auto i : c10::irange(num_lookups)) {
+        const auto& t = tensors.at((thread_id + i) % 2);
+        ids.at(thread_id).push_back(inputs_id_lookup.lookupId({t}).id);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(inputs_id_lookup.size(), 2u);
+  EXPECT_EQ(inputs_id_lookup.misses(), 2u);
+  EXPECT_EQ(inputs_id_lookup.hits(), (uint64_t)(num_threads * num_lookups - 2));
+  EXPECT_EQ(inputs_id_lookup.evictions(), 0u);
+  for (auto thread_id : c10::irange(num_threads)) {
+    for (auto i : c10::irange(num_lookups)) {
+      EXPECT_EQ(
+          ids.at(thread_id).at(i),
+          ids.at((thread_id + 1) % num_threads).at((i + 1) % num_lookups));
+    }
+  }
+
+  // Cycling through more input sets than the cache holds evicts them
+  for (const auto& t : tensors) {
+    inputs_id_lookup.lookupId({t});
+  }
+  EXPECT_EQ(inputs_id_lookup.size(), 4u);
+  EXPECT_EQ(inputs_id_lookup.evictions(), tensors.size() - 4);
+}
+
+// Runtime metrics count the runs, cache hits and launches of a cache, and
+// sample the kernel time of runs once their events have completed.
+TEST_F(KernelCacheTest, RuntimeMetrics) {
+  EnableOptionsGuard opt_guard;
+  EnableOptionsGuard::getCurOptions().set(EnableOption::RuntimeMetrics, {"1"});
+
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+
+  auto tv0 = makeContigTensor(2);
+  fusion->addInput(tv0);
+  auto tv1 = segment_set(exp(tv0));
+  auto tv2 = sin(tv1);
+  fusion->addOutput(tv2);
+
+  FusionExecutorCache executor_cache(std::move(fusion));
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  std::vector<c10::IValue> aten_inputs({at::randn({128, 1024}, options)});
+  std::vector<at::Tensor> cg_outputs;
+  for ([[maybe_unused]] auto i : c10::irange(3)) {
+    cg_outputs = executor_cache.runFusionWithInputs(aten_inputs);
+    // Complete the sampled run so that the next one reads its time
+    cudaDeviceSynchronize();
+  }
+  testValidate(
+      executor_cache.fusion(), cg_outputs, aten_inputs, __LINE__, __FILE__);
+
+  const FusionExecutorCacheMetrics& metrics = executor_cache.metrics();
+  EXPECT_EQ(metrics.runs, 3);
+  EXPECT_EQ(metrics.input_id_hits, 2);
+  EXPECT_EQ(metrics.runtime_reuses, 0);
+  EXPECT_EQ(metrics.runtime_misses, 1);
+  EXPECT_EQ(metrics.num_segments, 2);
+  EXPECT_EQ(metrics.kernel_launches, 6);
+  EXPECT_GT(metrics.compile_time_ns, 0);
+  // Each run reads the input and the intermediate, and writes both
+  const int64_t tensor_bytes = 128 * 1024 * 4;
+  EXPECT_EQ(metrics.input_bytes, 3 * 2 * tensor_bytes);
+  EXPECT_EQ(metrics.output_bytes, 3 * 2 * tensor_bytes);
+  EXPECT_EQ(metrics.sampled_runs, 2);
+  EXPECT_GT(metrics.sampled_kernel_time_ns, 0);
+
+  executor_cache.resetMetrics();
+  EXPECT_EQ(executor_cache.metrics().runs, 0);
+}
+
+// The first runtime searches the parameters of its segment and records the
+// fastest in the tuning db. A second FusionExecutorCache finds them in the db
+// and schedules the segment with them without searching again.
+TEST_F(KernelCacheTest, Autotune) {
+  const std::filesystem::path db_path =
+      std::filesystem::temp_directory_path() / "nvfuser_test_tuning_db.txt";
+  std::filesystem::remove(db_path);
+  EnableOptionsGuard opt_guard;
+  EnableOptionsGuard::getCurOptions().set(
+      EnableOption::Autotune, {db_path.string()});
+
+  auto make_fusion = []() {
+    auto fusion = std::make_unique<Fusion>();
+    FusionGuard fg(fusion.get());
+    auto tv0 = makeContigTensor(2);
+    auto tv1 = makeContigTensor(1);
+    fusion->addInput(tv0);
+    fusion->addInput(tv1);
+    auto tv2 = add(tv0, broadcast(tv1, {true, false}));
+    fusion->addOutput(sin(tv2));
+    return fusion;
+  };
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  std::vector<c10::IValue> aten_inputs(
+      {at::randn({333, 1000}, options), at::randn({1000}, options)});
+
+  auto run = [&]() {
+    FusionExecutorCache executor_cache(make_fusion());
+    auto cg_outputs = executor_cache.runFusionWithInputs(aten_inputs);
+    testValidate(
+        executor_cache.fusion(), cg_outputs, aten_inputs, __LINE__, __FILE__);
+    FusionKernelRuntime* runtime = executor_cache.getMostRecentKernelRuntime();
+    EXPECT_EQ(runtime->schedulers().size(), 1);
+    const auto& scheduler_entry = runtime->schedulers().front();
+    EXPECT_EQ(scheduler_entry->heuristic(), ScheduleHeuristic::PointWise);
+    return autotune::encodeParams(
+        scheduler_entry->heuristic(), *scheduler_entry->params());
+  };
+
+  const std::string tuned_params = run();
+  EXPECT_EQ(TuningDb::get().size(), 1);
+
+  std::ifstream db_file(db_path);
+  std::string key;
+  std::string stored_params;
+  db_file >> key >> stored_params;
+  EXPECT_EQ(stored_params, tuned_params);
+
+  EXPECT_EQ(run(), tuned_params);
+  EXPECT_EQ(TuningDb::get().size(), 1);
+  std::filesystem::remove(db_path);
+}
+
+// The memory plan is estimated from the input sizes before the fusion is
+// compiled, and includes the kernel intermediates once it has been run with
+// the same input id.
+TEST_F(KernelCacheTest, MemoryPlan) {
+  EnableOptionsGuard opt_guard;
+  EnableOptionsGuard::getCurOptions().set(
+      EnableOption::MemoryAwareSegmentOrder);
+
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+
+  auto tv0 = makeContigTensor(3);
+  fusion->addInput(tv0);
+  auto tv1 = add(tv0, IrBuilder::create<Val>(1.0));
+  auto tv2 = sum(tv1, {2});
+  auto tv3 = softmax(tv2, 1);
+  fusion->addOutput(tv3);
+  fusion->addOutput(sum(tv1, {0, 1, 2}));
+
+  FusionExecutorCache executor_cache(std::move(fusion));
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  std::vector<c10::IValue> aten_inputs({at::randn({32, 64, 8}, options)});
+
+  MemoryPlan estimate = executor_cache.planMemory(aten_inputs);
+  EXPECT_FALSE(estimate.has_intermediates);
+  EXPECT_EQ(estimate.output_bytes, (32 * 64 + 1) * 4);
+  EXPECT_GE(estimate.peak_bytes, estimate.output_bytes);
+
+  auto cg_outputs = executor_cache.runFusionWithInputs(aten_inputs);
+  testValidate(
+      executor_cache.fusion(), cg_outputs, aten_inputs, __LINE__, __FILE__);
+
+  FusionKernelRuntime* runtime = executor_cache.getMostRecentKernelRuntime();
+  MemoryPlan plan = executor_cache.planMemory(aten_inputs);
+  EXPECT_TRUE(plan.has_intermediates);
+  EXPECT_EQ(plan.live_bytes.size(), runtime->executors().size());
+  EXPECT_EQ(plan.output_bytes, estimate.output_bytes);
+  EXPECT_GE(plan.peak_bytes, estimate.peak_bytes);
+}
+
+// A runtime missing on the second device is built from the compiled runtime
+// of the first one, with the same kernels, when both are of the same model.
+TEST_F(KernelCacheTest, ShareAcrossDevices) {
+  if (at::cuda::getNumGPUs() < 2) {
+    GTEST_SKIP() << "Requires at least 2 GPUs";
+  }
+  const cudaDeviceProp* prop0 = at::cuda::getDeviceProperties(0);
+  const cudaDeviceProp* prop1 = at::cuda::getDeviceProperties(1);
+  if (prop0->major != prop1->major || prop0->minor != prop1->minor ||
+      prop0->multiProcessorCount != prop1->multiProcessorCount) {
+    GTEST_SKIP() << "Requires 2 GPUs of the same model";
+  }
+
+  EnableOptionsGuard opt_guard;
+  EnableOptionsGuard::getCurOptions().set(EnableOption::ShareAcrossDevices);
+
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+
+  auto tv0 = makeSymbolicTensor(2);
+  fusion->addInput(tv0);
+  auto tv1 = sum(tv0, {1});
+  auto tv2 = add(tv0, broadcast(tv1, {false, true}));
+  fusion->addOutput(tv2);
+
+  FusionExecutorCache executor_cache(std::move(fusion));
+
+  std::vector<std::string> kernel_names;
+  for (auto device : {0, 1}) {
+    auto options =
+        at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, device);
+    std::vector<c10::IValue> aten_inputs({at::randn({128, 1024}, options)});
+    auto cg_outputs = executor_cache.runFusionWithInputs(aten_inputs);
+    EXPECT_EQ(cg_outputs.at(0).get_device(), device);
+    testValidate(
+        executor_cache.fusion(), cg_outputs, aten_inputs, __LINE__, __FILE__);
+
+    FusionKernelRuntime* runtime = executor_cache.getMostRecentKernelRuntime();
+    std::string names;
+    for (const auto& executor : runtime->executors()) {
+      names += executor.kernelName() + ";";
+    }
+    kernel_names.push_back(names);
+  }
+
+  EXPECT_EQ(executor_cache.getKernelRuntimes().size(), 2);
+  EXPECT_EQ(kernel_names.at(0), kernel_names.at(1));
+}
+
+// The resource usage of each kernel is consistent with its launch parameters
+// and allows at least one block per SM.
+// Contiguous and transposed arguments of an input declared non-contiguous
+// run on different runtimes. The contiguous one is compiled with the input
+// marked contiguous.
+TEST_F(KernelCacheTest, ContiguitySpecialization) {
+  EnableOptionsGuard opt_guard;
+  EnableOptionsGuard::getCurOptions().set(
+      EnableOption::ContiguitySpecialization);
+
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+
+  auto tv0 = makeSymbolicTensor(2);
+  fusion->addInput(tv0);
+  auto tv1 = add(tv0, IrBuilder::create<Val>(1.0));
+  fusion->addOutput(tv1);
+
+  FusionExecutorCache executor_cache(std::move(fusion));
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor contiguous = at::randn({128, 1024}, options);
+  at::Tensor transposed = at::randn({1024, 128}, options).t();
+
+  auto cg_outputs = executor_cache.runFusionWithInputs({contiguous});
+  testValidate(
+      executor_cache.fusion(), cg_outputs, {contiguous}, __LINE__, __FILE__);
+  FusionKernelRuntime* contiguous_runtime =
+      executor_cache.getMostRecentKernelRuntime();
+  EXPECT_EQ(
+      contiguous_runtime->inputContiguity().at(0),
+      (std::vector<std::optional<bool>>{true, true}));
+
+  cg_outputs = executor_cache.runFusionWithInputs({transposed});
+  testValidate(
+      executor_cache.fusion(), cg_outputs, {transposed}, __LINE__, __FILE__);
+  FusionKernelRuntime* transposed_runtime =
+      executor_cache.getMostRecentKernelRuntime();
+  EXPECT_NE(transposed_runtime, contiguous_runtime);
+  EXPECT_EQ(
+      transposed_runtime->inputContiguity().at(0),
+      (std::vector<std::optional<bool>>{false, false}));
+
+  // Another contiguous shape reuses the specialized runtime
+  at::Tensor other = at::randn({256, 1024}, options);
+  cg_outputs = executor_cache.runFusionWithInputs({other});
+  testValidate(
+      executor_cache.fusion(), cg_outputs, {other}, __LINE__, __FILE__);
+  EXPECT_EQ(executor_cache.getMostRecentKernelRuntime(), contiguous_runtime);
+}
+
+// Each segment kernel waits for the previous grid before its first memory
+// access, and the chained segments compute the same results.
+TEST_F(KernelCacheTest, ProgrammaticLaunch) {
+  EnableOptionsGuard opt_guard;
+  EnableOptionsGuard::getCurOptions().set(EnableOption::ProgrammaticLaunch);
+
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+
+  auto tv0 = makeContigTensor(2);
+  fusion->addInput(tv0);
+  auto tv1 = segment_set(exp(tv0));
+  auto tv2 = segment_set(sin(tv1));
+  auto tv3 = cos(tv2);
+  fusion->addOutput(tv3);
+
+  FusionExecutorCache executor_cache(std::move(fusion));
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  std::vector<c10::IValue> aten_inputs({at::randn({128, 1024}, options)});
+  auto cg_outputs = executor_cache.runFusionWithInputs(aten_inputs);
+  testValidate(
+      executor_cache.fusion(), cg_outputs, aten_inputs, __LINE__, __FILE__);
+
+  FusionKernelRuntime* runtime = executor_cache.getMostRecentKernelRuntime();
+  EXPECT_EQ(runtime->executors().size(), 3);
+  for (const auto& executor : runtime->executors()) {
+    EXPECT_TRUE(executor.kernel()->summary().programmatic_launch);
+    EXPECT_THAT(
+        executor.kernelString(),
+        ::testing::HasSubstr("griddepcontrol.wait"));
+  }
+}
+
+TEST_F(KernelCacheTest, L2Persistence) {
+  EnableOptionsGuard opt_guard;
+  EnableOptionsGuard::getCurOptions().set(EnableOption::L2Persistence);
+
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+
+  auto tv0 = makeContigTensor(2);
+  fusion->addInput(tv0);
+  auto tv1 = segment_set(exp(tv0));
+  auto tv2 = segment_set(sin(tv1));
+  auto tv3 = cos(tv2);
+  fusion->addOutput(tv1);
+  fusion->addOutput(tv3);
+
+  FusionExecutorCache executor_cache(std::move(fusion));
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  std::vector<c10::IValue> aten_inputs({at::randn({128, 1024}, options)});
+  auto cg_outputs = executor_cache.runFusionWithInputs(aten_inputs);
+  testValidate(
+      executor_cache.fusion(), cg_outputs, aten_inputs, __LINE__, __FILE__);
+
+  // tv1 is a fusion output, so only tv2 is kept in L2, then released by the
+  // last segment.
+  FusionKernelRuntime* runtime = executor_cache.getMostRecentKernelRuntime();
+  const RuntimeWorkSpace& workspace = runtime->runtimeWorkSpace();
+  ASSERT_EQ(workspace.group_l2_windows.size(), 3);
+  EXPECT_FALSE(workspace.group_l2_windows.at(0).has_value());
+  ASSERT_TRUE(workspace.group_l2_windows.at(1).has_value());
+  EXPECT_TRUE(workspace.group_l2_windows.at(1)->is_output);
+  EXPECT_EQ(
+      workspace.group_run_order.at(1)->outputs().at(
+          workspace.group_l2_windows.at(1)->index)
+          ->name(),
+      tv2->name());
+  ASSERT_TRUE(workspace.group_l2_windows.at(2).has_value());
+  EXPECT_FALSE(workspace.group_l2_windows.at(2)->is_output);
+  EXPECT_EQ(
+      workspace.group_run_order.at(2)->inputs().at(
+          workspace.group_l2_windows.at(2)->index)
+          ->name(),
+      tv2->name());
+}
+
+TEST_F(KernelCacheTest, SmemCarveout) {
+  EnableOptionsGuard opt_guard;
+  EnableOptionsGuard::getCurOptions().set(EnableOption::SmemCarveout);
+
+  auto preferred_carveout = [](const FusionExecutor& executor) {
+    int carveout = -1;
+    NVFUSER_CUDA_SAFE_CALL(cuFuncGetAttribute(
+        &carveout,
+        CU_FUNC_ATTRIBUTE_PREFERRED_SHARED_MEMORY_CARVEOUT,
+        executor.compiledKernel().function));
+    return carveout;
+  };
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  std::vector<c10::IValue> aten_inputs({at::randn({128, 1024}, options)});
+
+  // A pointwise kernel without shared memory prefers the maximum L1
+  {
+    auto fusion = std::make_unique<Fusion>();
+    FusionGuard fg(fusion.get());
+    auto tv0 = makeContigTensor(2);
+    fusion->addInput(tv0);
+    fusion->addOutput(exp(tv0));
+
+    FusionExecutorCache executor_cache(std::move(fusion));
+    auto cg_outputs = executor_cache.runFusionWithInputs(aten_inputs);
+    testValidate(
+        executor_cache.fusion(), cg_outputs, aten_inputs, __LINE__, __FILE__);
+    const FusionExecutor& executor =
+        executor_cache.getMostRecentKernelRuntime()->executors().at(0);
+    EXPECT_EQ(preferred_carveout(executor), 0);
+  }
+
+  // A block reduction keeps its shared memory
+  {
+    auto fusion = std::make_unique<Fusion>();
+    FusionGuard fg(fusion.get());
+    auto tv0 = makeContigTensor(2);
+    fusion->addInput(tv0);
+    fusion->addOutput(sum(tv0, {1}));
+
+    FusionExecutorCache executor_cache(std::move(fusion));
+    auto cg_outputs = executor_cache.runFusionWithInputs(aten_inputs);
+    testValidate(
+        executor_cache.fusion(), cg_outputs, aten_inputs, __LINE__, __FILE__);
+    const FusionExecutor& executor =
+        executor_cache.getMostRecentKernelRuntime()->executors().at(0);
+    const KernelResourceUsage usage =
+        executor_cache.getMostRecentKernelRuntime()->resourceUsage().at(0);
+    if (usage.static_smem_bytes + usage.dynamic_smem_bytes > 0) {
+      EXPECT_GT(preferred_carveout(executor), 0);
+    }
+  }
+}
+
+TEST_F(KernelCacheTest, ResourceUsage) {
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+
+  auto tv0 = makeSymbolicTensor(2);
+  fusion->addInput(tv0);
+  auto tv1 = sum(tv0, {1});
+  auto tv2 = add(tv0, broadcast(tv1, {false, true}));
+  fusion->addOutput(tv2);
+
+  FusionExecutorCache executor_cache(std::move(fusion));
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  std::vector<c10::IValue> aten_inputs({at::randn({128, 1024}, options)});
+  executor_cache.runFusionWithInputs(aten_inputs);
+
+  FusionKernelRuntime* runtime = executor_cache.getMostRecentKernelRuntime();
+  const std::vector<KernelResourceUsage> usages = runtime->resourceUsage();
+  ASSERT_EQ(usages.size(), runtime->executors().size());
+  for (auto i : c10::irange(usages.size())) {
+    const KernelResourceUsage& usage = usages.at(i);
+    const LaunchParams lparams = runtime->executors().at(i).lastLaunchParams();
+    EXPECT_EQ(usage.kernel_name, runtime->executors().at(i).kernelName());
+    EXPECT_GT(usage.registers_per_thread, 0);
+    EXPECT_EQ(usage.dynamic_smem_bytes, lparams.smem());
+    EXPECT_EQ(usage.threads_per_block, lparams.nThreads());
+    EXPECT_LE(usage.threads_per_block, usage.max_threads_per_block);
+    EXPECT_GE(usage.max_active_blocks_per_sm, 1);
+    EXPECT_GT(usage.theoretical_occupancy, 0.0);
+    EXPECT_LE(usage.theoretical_occupancy, 1.0);
+  }
+}
+
+// Several threads run one FusionExecutorCache at once, each on its own
+// stream and with inputs of two shapes, so that they share both the cached
+// runtimes and the executor entries of their shapes.
+TEST_F(KernelCacheTest, ConcurrentRuns) {
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+
+  auto tv0 = makeSymbolicTensor(2);
+  fusion->addInput(tv0);
+  auto tv1 = sum(tv0, {1});
+  auto tv2 = add(tv0, broadcast(tv1, {false, true}));
+  fusion->addOutput(tv2);
+
+  FusionExecutorCache executor_cache(std::move(fusion));
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  const std::vector<std::vector<int64_t>> shapes = {{128, 1024}, {64, 333}};
+  // Compile both shapes first so that the threads only hit the cache
+  for (const auto& shape : shapes) {
+    executor_cache.runFusionWithInputs({at::randn(shape, options)});
+  }
+
+  constexpr int64_t kNumThreads = 4;
+  constexpr int64_t kNumRuns = 16;
+  std::vector<std::thread> threads;
+  std::vector<int64_t> num_mismatches(kNumThreads, 0);
+  for (int64_t thread : c10::irange(kNumThreads)) {
+    threads.emplace_back([&, thread]() {
+      c10::cuda::setCurrentCUDAStream(c10::cuda::getStreamFromPool());
+      for (int64_t run : c10::irange(kNumRuns)) {
+        at::Tensor t0 = at::randn(shapes.at((thread + run) % 2), options);
+        auto cg_outputs = executor_cache.runFusionWithInputs({t0});
+        at::Tensor expected = t0 + t0.sum({1}, true);
+        if (!at::allclose(cg_outputs.at(0), expected, 1e-4, 1e-4)) {
+          num_mismatches.at(thread)++;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_THAT(num_mismatches, testing::Each(0));
+}
+
+// Concurrent runs with different numbers of rows are coalesced into batches,
+// and each gets the outputs of its own rows.
+TEST_F(KernelCacheTest, RequestBatching) {
+  EnableOptionsGuard opt_guard;
+  EnableOptionsGuard::getCurOptions().set(
+      EnableOption::RequestBatching, {"20000"});
+  EnableOptionsGuard::getCurOptions().set(EnableOption::RuntimeMetrics);
+
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+
+  auto tv0 = makeContigTensor(2);
+  fusion->addInput(tv0);
+  auto tv1 = sum(tv0, {1});
+  auto tv2 = add(tv0, broadcast(tv1, {false, true}));
+  fusion->addOutput(tv2);
+
+  FusionExecutorCache executor_cache(std::move(fusion));
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+
+  constexpr int64_t kNumThreads = 4;
+  std::vector<std::thread> threads;
+  std::vector<int64_t> num_mismatches(kNumThreads, 0);
+  for (int64_t thread : c10::irange(kNumThreads)) {
+    threads.emplace_back([&, thread]() {
+      c10::cuda::setCurrentCUDAStream(c10::cuda::getStreamFromPool());
+      at::Tensor t0 = at::randn({thread + 1, 256}, options);
+      auto cg_outputs = executor_cache.runFusionWithInputs({t0});
+      at::Tensor expected = t0 + t0.sum({1}, true);
+      if (cg_outputs.at(0).sizes() != expected.sizes() ||
+          !at::allclose(cg_outputs.at(0), expected, 1e-4, 1e-4)) {
+        num_mismatches.at(thread)++;
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_THAT(num_mismatches, testing::Each(0));
+
+  const FusionExecutorCacheMetrics& metrics = executor_cache.metrics();
+  EXPECT_EQ(metrics.batched_requests, kNumThreads);
+  EXPECT_GE(metrics.request_batches, 1);
+  EXPECT_LE(metrics.request_batches, kNumThreads);
+}
+
+// Fusions reducing their rows are not batched.
+TEST_F(KernelCacheTest, RequestBatchingReducedRows) {
+  EnableOptionsGuard opt_guard;
+  EnableOptionsGuard::getCurOptions().set(EnableOption::RequestBatching);
+  EnableOptionsGuard::getCurOptions().set(EnableOption::RuntimeMetrics);
+
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+
+  auto tv0 = makeContigTensor(2);
+  fusion->addInput(tv0);
+  auto tv1 = sum(tv0, {0});
+  fusion->addOutput(tv1);
+
+  FusionExecutorCache executor_cache(std::move(fusion));
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor t0 = at::randn({8, 256}, options);
+  auto cg_outputs = executor_cache.runFusionWithInputs({t0});
+  testValidate(executor_cache.fusion(), cg_outputs, {t0}, __LINE__, __FILE__);
+
+  EXPECT_EQ(executor_cache.metrics().batched_requests, 0);
+}
+
+} // namespace nvfuser
@@ -2851,6 +2851,67 @@ TEST_P(MatmulTestWithLayout, FusionAmpereMatmulSplitK_CUDA) {
   }
 }
 
+// Test persistent CTAs looping over the output tiles, with and without
+// split-K. See [ Note -- Persistent matmul ]
+TEST_P(MatmulTestWithLayout, FusionAmpereMatmulPersistent_CUDA) {
+  // requires Ampere or higher GPU
+  if (!deviceMajorMinorCheck(8)) {
+    GTEST_SKIP() << "skipping tests on pre-AMPERE GPUs";
+  }
+
+  // 4 x 2 tiles, not a multiple of the number of CTAs
+  int M = 504, N = 136, K = 2048;
+
+  for (int splitk_factor : {1, 2}) {
+    Fusion fusion;
+    FusionGuard fg(&fusion);
+    auto shapes = matmulAtInputShape3DTuring(-1, -1, -1, layout);
+
+    auto tv0 = makeContigConcreteTensor(shapes.first, DataType::Half);
+    auto tv1 = makeContigConcreteTensor(shapes.second, DataType::Half);
+
+    fusion.addInput(tv0);
+    fusion.addInput(tv1);
+
+    tv0 = canonicalizeInputToBMNK(tv0, layout, MmaOperand::A);
+    tv1 = canonicalizeInputToBMNK(tv1, layout, MmaOperand::B);
+    auto tv2 = fusedMultiplySum(tv0, tv1, {-1});
+
+    fusion.addOutput(tv2);
+
+    MatMulTileOptions gemm_tile;
+    gemm_tile.cta_tile = GemmTile(128, 128, 32);
+    gemm_tile.warp_tile = GemmTile(64, 64, 32);
+    gemm_tile.instruction_tile = GemmTile(16, 8, 16);
+
+    MatmulParams params;
+    params.supported_vec_size = {8, 8, 4};
+    params.mma_macro = MmaMacro::Ampere_16_8_16;
+    params.tile_sizes = gemm_tile;
+    params.async_gmem_load_operands = true;
+    params.circular_buffer_options.circular_buffer_smem_write = true;
+    params.circular_buffer_options.circular_buffer_smem_read = true;
+    params.circular_buffer_options.smem_circular_buffer_stage = 3;
+    params.splitk_factor = splitk_factor;
+    params.num_persistent_ctas = 3;
+
+    scheduleMatmul(&fusion, params);
+
+    auto inputs = matmulAtInput3DTuring(M, N, K, layout);
+
+    FusionExecutor fe;
+    NVFUSER_TEST_CUDA_ARCH_COMPILE_CHECK(
+        7, 5, fe.compileFusion(&fusion, {inputs.first, inputs.second}));
+    auto cg_outputs = fe.runFusion({inputs.first, inputs.second});
+    EXPECT_EQ(fe.lastLaunchParams().gdimx(), 3);
+    EXPECT_EQ(fe.lastLaunchParams().gdimz(), splitk_factor);
+    auto tref = atMatmul(
+        inputs.first.to(at::kFloat), inputs.second.to(at::kFloat), layout);
+
+    NVF_CHECK(cg_outputs[0].allclose(tref, 1e-6 * K, 1e-6 * K));
+  }
+}
+
 // Test splitk with bias epilogue
 TEST_P(MatmulTestWithLayout, FusionAmpereMatmulSplitKBias_CUDA) {
   // requires Ampere or higher GPU
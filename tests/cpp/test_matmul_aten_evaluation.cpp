@@ -295,6 +295,47 @@ TEST_P(LinearNodeParametrizedTest, LinearNodeSymbolic) {
   EXPECT_TRUE(at::allclose(out[0], out_ref));
 }
 
+// The bias add and ReLU after a linear run in its ExprEval segment
+TEST_F(NVFuserTest, LinearBiasReluEpilogue) {
+  EnableOptionsGuard opt_guard;
+  EnableOptionsGuard::getCurOptions().set(EnableOption::ExprEvalEpilogue);
+  preseg_passes::OptimizationPassGuard<preseg_passes::AllocationDomainPass>
+      optimization_guard(false);
+
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+
+  auto tv0 = makeSymbolicTensor(3, DataType::BFloat16);
+  auto tv1 = makeSymbolicTensor(2, DataType::BFloat16);
+  auto tv2 = makeSymbolicTensor(1, DataType::BFloat16);
+  fusion->addInput(tv0);
+  fusion->addInput(tv1);
+  fusion->addInput(tv2);
+  auto tv3 = linear(tv0, tv1);
+  auto tv4 = castOp(DataType::Float, tv3);
+  auto tv5 = castOp(DataType::Float, tv2);
+  auto tv6 = add(tv4, broadcast(tv5, {true, true, false}));
+  auto tv7 = relu(tv6);
+  auto tv8 = castOp(DataType::BFloat16, tv7);
+  fusion->addOutput(tv8);
+
+  auto options = at::TensorOptions().dtype(at::kBFloat16).device(at::kCUDA, 0);
+  at::Tensor t0 = at::randn({4, 128, 64}, options);
+  at::Tensor t1 = at::randn({256, 64}, options);
+  at::Tensor t2 = at::randn({256}, options);
+
+  FusionExecutorCache fec(std::move(fusion));
+  auto out = fec.runFusionWithInputs({t0, t1, t2});
+
+  const std::vector<FusionExecutor>& executors =
+      fec.getMostRecentKernelRuntime()->executors();
+  EXPECT_EQ(executors.size(), 1);
+  EXPECT_FALSE(executors.front().hasCompiledKernel());
+
+  at::Tensor out_ref = at::relu(at::linear(t0, t1, t2));
+  EXPECT_TRUE(at::allclose(out[0], out_ref, 1e-2, 1e-2));
+}
+
 constexpr int64_t b = 128, m = 64, k = 32, n = 16;
 
 // Parametrize a_shape and b_shape
@@ -1654,6 +1654,217 @@ TEST_F(MatmulSchedulerTest, EpilogueAlphaBetaBias) {
   NVF_CHECK(outputs[0].allclose(t8, 0.01, 0.01));
 }
 
+// Matmul test with reductions of N in the epilogue:
+//   D = gelu((A x B) + bias)
+//   S = sum(D, N)
+//   Q = sum(D * D, N)
+// The reductions must be fused with the matmul, both when N fits in a single
+// CTA tile and when it spans several.
+TEST_F(MatmulSchedulerTest, EpilogueRowReductions) {
+  NVFUSER_TEST_CUDA_ARCH_RANGE_GUARD(8, 0, 9, 0);
+  const auto layout = MmaLayout::TT;
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+
+  // A - tv0, B - tv1, bias - tv2
+  auto tv0 = makeContigTensor(2, DataType::Half);
+  auto tv1 = makeContigTensor(2, DataType::Half);
+  auto tv2 = makeContigTensor(1, DataType::Half);
+  fusion->addInput(tv0);
+  fusion->addInput(tv1);
+  fusion->addInput(tv2);
+
+  tv0 = canonicalizeInputToBMNK(tv0, layout, MmaOperand::A);
+  tv1 = canonicalizeInputToBMNK(tv1, layout, MmaOperand::B);
+  auto tv3 = fusedMultiplySum(tv0, tv1, {-1});
+  auto tv4 = broadcast(castOp(DataType::Float, tv2), {true, false});
+  auto tv5 = gelu(add(tv3, tv4));
+  auto tv6 = castOp(DataType::Half, tv5);
+  auto tv7 = sum(tv5, {-1});
+  auto tv8 = sum(mul(tv5, tv5), {-1});
+
+  fusion->addOutput(tv6);
+  fusion->addOutput(tv7);
+  fusion->addOutput(tv8);
+
+  FusionExecutorCache executor_cache(std::move(fusion));
+
+  EnableOptionsGuard eog;
+  EnableOptionsGuard::getCurOptions().set(
+      EnableOption::MatmulEpilogueReduction);
+
+  const int M = 504, K = 248;
+  for (int N : {96, 392}) {
+    at::manual_seed(0);
+    auto t0 = matmulAtInput2D(layout, TensorMatmulPos::A, at::kHalf, M, N, K);
+    auto t1 = matmulAtInput2D(layout, TensorMatmulPos::B, at::kHalf, M, N, K);
+    auto t2 = at::randn({N}, t0.options());
+    auto t3 = atMatmul(t0.to(at::kFloat), t1.to(at::kFloat), layout);
+    auto t5 = at::gelu(at::add(t3, t2.to(at::kFloat)));
+    auto t6 = t5.to(at::kHalf);
+    auto t7 = t5.sum({-1});
+    auto t8 = t5.mul(t5).sum({-1});
+
+    auto outputs = executor_cache.runFusionWithInputs({t0, t1, t2});
+
+    const FusionKernelRuntime* runtime =
+        executor_cache.getMostRecentKernelRuntime();
+    ASSERT_NE(runtime, nullptr);
+    EXPECT_FALSE(runtime->isSegmented());
+    EXPECT_TRUE(isSchedulerInUse(runtime, ScheduleHeuristic::Matmul));
+
+    testValidate(
+        executor_cache.fusion(),
+        outputs,
+        {t0, t1, t2},
+        {t6, t7, t8},
+        __LINE__,
+        __FILE__);
+  }
+}
+
+// Scaled fp8 matmul test that also computes the amax of the output, as in
+// delayed scaling:
+//   D = scale_a * scale_b * (A x B)
+//   amax = max(abs(D))
+// The amax of the rows is fused with the matmul, and only the final max over
+// M is left to another kernel.
+TEST_F(MatmulSchedulerTest, ScaledFp8WithAmax) {
+  NVFUSER_TEST_CUDA_ARCH_RANGE_GUARD(8, 9, 9, 0);
+  const auto layout = MmaLayout::TN;
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+
+  auto tv0 = makeContigTensor(2, DataType::Float8_e4m3fn);
+  auto tv1 = makeContigTensor(2, DataType::Float8_e5m2);
+  auto scale_a = IrBuilder::create<Val>(DataType::Double);
+  auto scale_b = IrBuilder::create<Val>(DataType::Double);
+  fusion->addInput(tv0);
+  fusion->addInput(tv1);
+  fusion->addInput(scale_a);
+  fusion->addInput(scale_b);
+
+  tv0 = canonicalizeInputToBMNK(tv0, layout, MmaOperand::A);
+  tv1 = canonicalizeInputToBMNK(tv1, layout, MmaOperand::B);
+  auto tv2 = fusedMultiplySum(tv0, tv1, {-1});
+  auto tv3 = mul(tv2, mul(scale_a, scale_b));
+  auto tv4 = castOp(DataType::BFloat16, tv3);
+  auto tv5 = max(max(abs(tv3), {-1}), {0});
+
+  fusion->addOutput(tv4);
+  fusion->addOutput(tv5);
+
+  FusionExecutorCache executor_cache(std::move(fusion));
+
+  EnableOptionsGuard eog;
+  EnableOptionsGuard::getCurOptions().set(
+      EnableOption::MatmulEpilogueReduction);
+
+  const int M = 504, N = 136, K = 248;
+  at::manual_seed(0);
+  auto t0 = matmulAtInput2D(layout, TensorMatmulPos::A, at::kHalf, M, N, K)
+                .to(at::kFloat8_e4m3fn);
+  auto t1 = matmulAtInput2D(layout, TensorMatmulPos::B, at::kHalf, M, N, K)
+                .to(at::kFloat8_e5m2);
+  const double t_scale_a = 0.5, t_scale_b = 2.0;
+  auto t3 = atMatmul(t0.to(at::kFloat), t1.to(at::kFloat), layout)
+                .mul(t_scale_a * t_scale_b);
+  auto t4 = t3.to(at::kBFloat16);
+  auto t5 = t3.abs().max();
+
+  auto outputs =
+      executor_cache.runFusionWithInputs({t0, t1, t_scale_a, t_scale_b});
+
+  const FusionKernelRuntime* runtime =
+      executor_cache.getMostRecentKernelRuntime();
+  ASSERT_NE(runtime, nullptr);
+  EXPECT_TRUE(isSchedulerInUse(runtime, ScheduleHeuristic::Matmul));
+  EXPECT_LE(runtime->fusionSegments()->groups().size(), 2);
+
+  testValidate(
+      executor_cache.fusion(),
+      outputs,
+      {t0, t1, t_scale_a, t_scale_b},
+      {t4, t5},
+      __LINE__,
+      __FILE__);
+}
+
+// int8 matmul test with a requantization epilogue, as in int8 inference:
+//   D = relu(scale * (A x B) + bias)
+//   Q = int8(clamp(round(D), -128, 127))
+// where scale and bias are per output channel, i.e. along N. The product is
+// accumulated exactly in int32 and both D, in bf16, and Q are outputs.
+TEST_F(MatmulSchedulerTest, Int8WithRequantization) {
+  NVFUSER_TEST_CUDA_ARCH_RANGE_GUARD(8, 0, 9, 0);
+  const auto layout = MmaLayout::TN;
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+
+  auto tv0 = makeContigTensor(2, DataType::Int8);
+  auto tv1 = makeContigTensor(2, DataType::Int8);
+  auto scale = makeContigTensor(1, DataType::Float);
+  auto bias = makeContigTensor(1, DataType::Float);
+  fusion->addInput(tv0);
+  fusion->addInput(tv1);
+  fusion->addInput(scale);
+  fusion->addInput(bias);
+
+  tv0 = canonicalizeInputToBMNK(tv0, layout, MmaOperand::A);
+  tv1 = canonicalizeInputToBMNK(tv1, layout, MmaOperand::B);
+  auto tv2 = fusedMultiplySum(tv0, tv1, {-1});
+  ASSERT_EQ(tv2->dtype(), DataType::Int32);
+  auto tv3 = mul(castOp(DataType::Float, tv2), broadcast(scale, {true, false}));
+  auto tv4 = relu(add(tv3, broadcast(bias, {true, false})));
+  auto tv5 = castOp(DataType::BFloat16, tv4);
+  auto tv6 = castOp(
+      DataType::Int8,
+      clamp(
+          round(tv4),
+          IrBuilder::create<Val>(-128.0),
+          IrBuilder::create<Val>(127.0)));
+
+  fusion->addOutput(tv5);
+  fusion->addOutput(tv6);
+
+  FusionExecutorCache executor_cache(std::move(fusion));
+
+  const int M = 504, N = 136, K = 248;
+  at::manual_seed(0);
+  auto t0 = matmulAtInput2D(layout, TensorMatmulPos::A, at::kFloat, M, N, K)
+                .mul(8)
+                .round()
+                .to(at::kChar);
+  auto t1 = matmulAtInput2D(layout, TensorMatmulPos::B, at::kFloat, M, N, K)
+                .mul(8)
+                .round()
+                .to(at::kChar);
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  auto t_scale = at::rand({N}, options).mul(0.05).add(0.01);
+  auto t_bias = at::randn({N}, options).mul(4);
+  // The int8 products and their sums up to K are exact in float
+  auto t3 = atMatmul(t0.to(at::kFloat), t1.to(at::kFloat), layout).mul(t_scale);
+  auto t4 = at::relu(t3.add(t_bias));
+  auto t5 = t4.to(at::kBFloat16);
+  auto t6 = t4.round().clamp(-128, 127).to(at::kChar);
+
+  auto outputs =
+      executor_cache.runFusionWithInputs({t0, t1, t_scale, t_bias});
+
+  const FusionKernelRuntime* runtime =
+      executor_cache.getMostRecentKernelRuntime();
+  ASSERT_NE(runtime, nullptr);
+  EXPECT_FALSE(runtime->isSegmented());
+  EXPECT_TRUE(isSchedulerInUse(runtime, ScheduleHeuristic::Matmul));
+
+  EXPECT_TRUE(outputs[0].to(at::kFloat).allclose(
+      t5.to(at::kFloat), 0.01, 0.01));
+  // Ties may round differently and the scale and bias may be contracted to an
+  // fma, so the quantized values can be off by one
+  EXPECT_LE(
+      (outputs[1].to(at::kInt) - t6.to(at::kInt)).abs().max().item<int>(), 1);
+}
+
 // Strided batch gemm test taht uses matmul scheduler, for Ampere:
 //   D = (A x B)
 TEST_P(MatmulSchedulerTestWithLayout, StridedBatch) {
@@ -11,6 +11,7 @@
 #include <ir/builder.h>
 #include <multidevice/communication.h>
 #include <multidevice/communicator.h>
+#include <options.h>
 #include <tests/cpp/multidevice.h>
 
 #include <ops/arith.h>
@@ -41,6 +42,8 @@ class CommunicationTest
   const DeviceMesh full_mesh_;
   const Team all_ranks_;
   c10d::Backend* backend_ = nullptr;
+  // Makes sure communications go through the backend under test.
+  DisableOptionsGuard option_guard_;
 };
 
 CommunicationTest::CommunicationTest()
@@ -49,6 +52,7 @@ CommunicationTest::CommunicationTest()
 
 void CommunicationTest::SetUp() {
   MultiDeviceTest::SetUp();
+  DisableOptionsGuard::getCurOptions().set(DisableOption::P2pCommunication);
 
   const CommunicatorBackend backend_type = GetParam();
   if (!communicator_->isBackendAvailable(backend_type)) {
@@ -358,6 +362,49 @@ TEST_P(CommunicationTest, Allreduce) {
   }
 }
 
+TEST_P(CommunicationTest, HierarchicalAllreduce) {
+  if (communicator_->size() <= communicator_->local_size()) {
+    GTEST_SKIP() << "Requires several nodes";
+  }
+  hir::HostIrContainer container;
+  FusionGuard fg(&container);
+  auto* in = makeContigTensor(2);
+  in->setDeviceMesh(full_mesh_);
+  auto* out = newForReduction(in, {0});
+  auto communication = IrBuilder::create<Communication>(
+      CommunicationType::Allreduce,
+      out,
+      in,
+      all_ranks_,
+      /*root=*/-1,
+      kReductionOp);
+
+  // Large enough to be decomposed into intra- and inter-node collectives. See
+  // Note [Hierarchical Allreduce]
+  const int64_t tensor_size = communicator_->local_size() * (1 << 18);
+  // Values are kept small so the sums are exact.
+  at::Tensor values =
+      at::arange(tensor_size, tensor_options).remainder(kTensorSize);
+  at::Tensor input_tensor = at::empty({1, tensor_size}, tensor_options);
+  at::Tensor output_tensor = at::empty({tensor_size}, tensor_options);
+  for (auto repetition : c10::irange(kNumRepetitions)) {
+    input_tensor.copy_(
+        values.unsqueeze(0) + (communicator_->deviceId() + 1) * repetition);
+
+    auto work = postSingleCommunication(
+        communication,
+        communicator_->deviceId(),
+        backend_,
+        input_tensor,
+        output_tensor);
+    work->wait();
+
+    const int s = communicator_->size();
+    auto ref = values * s + s * (s + 1) / 2 * repetition;
+    validate(output_tensor, ref);
+  }
+}
+
 TEST_P(CommunicationTest, ReduceScatter) {
   hir::HostIrContainer container;
   FusionGuard fg(&container);
@@ -403,6 +450,200 @@ TEST_P(CommunicationTest, ReduceScatter) {
   }
 }
 
+TEST_P(CommunicationTest, AllToAll) {
+  hir::HostIrContainer container;
+  FusionGuard fg(&container);
+  auto* in = makeContigTensor(3);
+  in->setDeviceMesh(full_mesh_);
+  auto* out = ops::newValLike(in, in->dtype())->as<TensorView>();
+  auto communication = IrBuilder::create<Communication>(
+      CommunicationType::AllToAll,
+      out,
+      in,
+      all_ranks_,
+      /*root=*/-1,
+      RedOpType::UNUSED,
+      /*scattered_axis=*/1,
+      /*gathered_axis=*/0);
+
+  const int num_devices = communicator_->size();
+  const int device_id = communicator_->deviceId();
+  at::Tensor input_tensor =
+      at::empty({1, num_devices, kTensorSize}, tensor_options);
+  at::Tensor output_tensor =
+      at::empty({num_devices, 1, kTensorSize}, tensor_options);
+  for (auto repetition : c10::irange(kNumRepetitions)) {
+    at::Tensor unsharded_tensor =
+        at::arange(num_devices * num_devices * kTensorSize, tensor_options)
+            .view({num_devices, num_devices, kTensorSize}) +
+        repetition;
+    input_tensor.copy_(unsharded_tensor.slice(0, device_id, device_id + 1));
+
+    auto work = postSingleCommunication(
+        communication,
+        communicator_->deviceId(),
+        backend_,
+        input_tensor,
+        output_tensor);
+    work->wait();
+
+    validate(
+        output_tensor, unsharded_tensor.slice(1, device_id, device_id + 1));
+  }
+}
+
+TEST_P(CommunicationTest, AllToAllVariableSplitSizes) {
+  hir::HostIrContainer container;
+  FusionGuard fg(&container);
+  auto* in = makeContigTensor(2);
+  in->setDeviceMesh(full_mesh_);
+  auto* out = ops::newValLike(in, in->dtype())->as<TensorView>();
+  auto communication = IrBuilder::create<Communication>(
+      CommunicationType::AllToAll,
+      out,
+      in,
+      all_ranks_,
+      /*root=*/-1,
+      RedOpType::UNUSED,
+      /*scattered_axis=*/0,
+      /*gathered_axis=*/0);
+
+  // Device i sends i+1 rows to each device. The rows device i sends to
+  // device j hold i*num_devices+j.
+  const int num_devices = communicator_->size();
+  const int device_id = communicator_->deviceId();
+  std::vector<int64_t> input_split_sizes(num_devices, device_id + 1);
+  std::vector<int64_t> output_split_sizes;
+  for (auto i : c10::irange(num_devices)) {
+    output_split_sizes.push_back(i + 1);
+  }
+  auto long_options = tensor_options.dtype(at::kLong);
+  at::Tensor input_tensor =
+      (at::arange(num_devices, tensor_options)
+           .repeat_interleave(device_id + 1) +
+       device_id * num_devices)
+          .unsqueeze(1)
+          .expand({-1, kTensorSize})
+          .contiguous();
+  at::Tensor output_tensor = at::empty(
+      {num_devices * (num_devices + 1) / 2, kTensorSize}, tensor_options);
+
+  auto work = postAllToAll(
+      communication,
+      communicator_->deviceId(),
+      backend_,
+      input_tensor,
+      output_tensor,
+      input_split_sizes,
+      output_split_sizes);
+  work->wait();
+
+  at::Tensor ref = at::repeat_interleave(
+                       at::arange(num_devices, tensor_options),
+                       at::arange(1, num_devices + 1, long_options)) *
+          num_devices +
+      device_id;
+  validate(output_tensor, ref.unsqueeze(1).expand({-1, kTensorSize}));
+}
+
+using P2pCommunicationTest = MultiDeviceTest;
+
+TEST_F(P2pCommunicationTest, SendRecv) {
+  if (communicator_->size() < 2 || torch::cuda::device_count() < 2) {
+    GTEST_SKIP() << "This test needs at least 2 GPUs and 2 ranks.";
+  }
+
+  constexpr DeviceIdxType sender = 1;
+  constexpr DeviceIdxType receiver = 0;
+  constexpr int64_t kTensorSize = 1024;
+  constexpr int64_t kNumRepetitions = 8;
+
+  const DeviceIdxType rank = communicator_->deviceId();
+  if (rank != sender && rank != receiver) {
+    return;
+  }
+
+  const Team team({sender, receiver});
+  if (communicator_->getP2pChannelForTeam(team) == nullptr) {
+    GTEST_SKIP() << "The devices can't use a P2P channel.";
+  }
+
+  hir::HostIrContainer container;
+  FusionGuard fg(&container);
+  auto* in = makeContigTensor(1);
+  auto* out = ops::newValLike(in, in->dtype())->as<TensorView>();
+  auto* communication = IrBuilder::create<Communication>(
+      CommunicationType::SendRecv, out, in, team, sender);
+
+  at::Tensor input_tensor;
+  at::Tensor output_tensor;
+  if (rank == sender) {
+    input_tensor = at::empty({kTensorSize}, tensor_options);
+  } else {
+    output_tensor = at::empty({kTensorSize}, tensor_options);
+  }
+
+  c10d::Backend* backend = communicator_->getBackendForTeam(team, std::nullopt);
+  for (auto repetition : c10::irange(kNumRepetitions)) {
+    if (rank == sender) {
+      input_tensor.copy_(at::arange(kTensorSize, tensor_options) + repetition);
+    }
+
+    // Small SendRecvs among devices of the same node are ordered on the
+    // stream and don't return a Work.
+    auto work = postSingleCommunication(
+        communication, rank, backend, input_tensor, output_tensor);
+    EXPECT_EQ(work, nullptr);
+
+    if (rank == receiver) {
+      auto ref = at::arange(kTensorSize, tensor_options) + repetition;
+      EXPECT_TRUE(output_tensor.equal(ref));
+    }
+  }
+}
+
+TEST_F(P2pCommunicationTest, Allgather) {
+  constexpr int64_t kTensorSize = 1024;
+  constexpr int64_t kNumRepetitions = 8;
+
+  const auto mesh = DeviceMesh::createForNumDevices(communicator_->size());
+  const Team team = mesh.vector();
+  if (communicator_->getP2pChannelForTeam(team) == nullptr) {
+    GTEST_SKIP() << "The devices can't use a P2P channel.";
+  }
+
+  hir::HostIrContainer container;
+  FusionGuard fg(&container);
+  auto* in = makeContigTensor(2);
+  in->setDeviceMesh(mesh);
+  auto* out = ops::newValLike(in, in->dtype())->as<TensorView>();
+  auto* communication = IrBuilder::create<Communication>(
+      CommunicationType::Allgather, out, in, team);
+
+  at::Tensor input_tensor = at::empty({1, kTensorSize}, tensor_options);
+  at::Tensor output_tensor =
+      at::empty({communicator_->size(), kTensorSize}, tensor_options);
+  c10d::Backend* backend = communicator_->getBackendForTeam(team, std::nullopt);
+  for (auto repetition : c10::irange(kNumRepetitions)) {
+    input_tensor.copy_(
+        at::arange(kTensorSize, tensor_options).unsqueeze(0) +
+        (communicator_->deviceId() + 1) * repetition);
+
+    auto work = postSingleCommunication(
+        communication,
+        communicator_->deviceId(),
+        backend,
+        input_tensor,
+        output_tensor);
+    EXPECT_EQ(work, nullptr);
+
+    at::Tensor ref = at::arange(kTensorSize, tensor_options).unsqueeze(0) +
+        at::arange(1, communicator_->size() + 1, tensor_options).unsqueeze(1) *
+            repetition;
+    EXPECT_TRUE(output_tensor.equal(ref));
+  }
+}
+
 INSTANTIATE_TEST_SUITE_P(
     ,
     CommunicationTest,
@@ -5,7 +5,9 @@
  * SPDX-License-Identifier: BSD-3-Clause
  */
 // clang-format on
+#include <algorithm>
 #include <chrono>
+#include <utility>
 
 #include <gtest/gtest.h>
 
@@ -51,4 +53,31 @@ INSTANTIATE_TEST_SUITE_P(
     testing::Values(CommunicatorBackend::nccl, CommunicatorBackend::ucc),
     testing::PrintToStringParamName());
 
+// Two NVLink islands, {0, 2, 4, 6} and {1, 3, 5, 7}, connected by PCIe. The
+// chain goes through an island before crossing to the other.
+TEST(OrderDevicesByLinksTest, TwoIslands) {
+  auto link_cost = [](int64_t a, int64_t b) -> int64_t {
+    return a % 2 == b % 2 ? 0 : 256;
+  };
+  EXPECT_EQ(
+      orderDevicesByLinks(8, link_cost),
+      std::vector<int64_t>({0, 2, 4, 6, 1, 3, 5, 7}));
+}
+
+// Lower costs are preferred over lower indices.
+TEST(OrderDevicesByLinksTest, Chain) {
+  // The links 3-1-0-2 are fast.
+  auto link_cost = [](int64_t a, int64_t b) -> int64_t {
+    const std::pair<int64_t, int64_t> link = std::minmax(a, b);
+    if (link == std::make_pair<int64_t, int64_t>(0, 2) ||
+        link == std::make_pair<int64_t, int64_t>(0, 1) ||
+        link == std::make_pair<int64_t, int64_t>(1, 3)) {
+      return 1;
+    }
+    return 2;
+  };
+  EXPECT_EQ(
+      orderDevicesByLinks(4, link_cost), std::vector<int64_t>({0, 1, 3, 2}));
+}
+
 } // namespace nvfuser
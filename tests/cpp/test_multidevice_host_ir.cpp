@@ -8,6 +8,7 @@
 #include <fusion.h>
 #include <host_ir/container.h>
 #include <host_ir/executor.h>
+#include <host_ir/ring_attention.h>
 #include <ir/all_nodes.h>
 #include <ops/all_ops.h>
 #include <tests/cpp/multidevice.h>
@@ -240,6 +241,219 @@ INSTANTIATE_TEST_SUITE_P(
       return s;
     });
 
+using MultiDeviceExecutorTest = MultiDeviceTest;
+
+// See Note [Communication bucketing]
+TEST_F(MultiDeviceExecutorTest, CommunicationBucketing) {
+  const int64_t num_devices = communicator_->size();
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+  auto mesh = DeviceMesh::createForNumDevices(num_devices);
+
+  const std::vector<std::vector<int64_t>> sizes = {
+      {num_devices, 4}, {num_devices, 8}, {num_devices, 2, 3}};
+  for (const auto& size : sizes) {
+    TensorView* in = makeContigConcreteTensor(size);
+    TensorView* out = sum(in, {0});
+    fusion->addInput(in);
+    fusion->addOutput(out);
+    in->setDeviceMesh(mesh);
+    out->setDeviceMesh(mesh);
+    in->axis(0)->parallelize(ParallelType::DIDx);
+  }
+
+  HostIrExecutorParams params;
+  params.communication_bucket_bytes = 1 << 20;
+  MultiDeviceExecutor executor(std::move(fusion), *communicator_, params);
+
+  std::stringstream host_program;
+  executor.print(host_program);
+  const std::string program = host_program.str();
+  const std::string allreduce = "type=Allreduce";
+  auto first = program.find(allreduce);
+  EXPECT_NE(first, std::string::npos) << program;
+  EXPECT_EQ(program.find(allreduce, first + 1), std::string::npos) << program;
+
+  auto options = at::TensorOptions().device(communicator_->device());
+  std::vector<at::Tensor> unsharded_inputs;
+  std::vector<c10::IValue> inputs;
+  for (const auto& size : sizes) {
+    at::Tensor unsharded_input = at::randn(size, options);
+    unsharded_inputs.push_back(unsharded_input);
+    inputs.push_back(shardTensor(unsharded_input, 0, mesh));
+  }
+  std::vector<at::Tensor> outputs = executor.runWithInput(inputs);
+  ASSERT_EQ(outputs.size(), sizes.size());
+  for (auto i : c10::irange(sizes.size())) {
+    EXPECT_TRUE(at::allclose(outputs.at(i), unsharded_inputs.at(i).sum(0)));
+  }
+}
+
+// See Note [Persistent communication buffers]
+TEST_F(MultiDeviceExecutorTest, PersistentCommunicationBuffers) {
+  const int64_t num_devices = communicator_->size();
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+  auto mesh = DeviceMesh::createForNumDevices(num_devices);
+
+  TensorView* in = makeContigTensor(2);
+  TensorView* allreduced = sum(in, {0});
+  TensorView* out = add(allreduced, allreduced);
+  fusion->addInput(in);
+  fusion->addOutput(out);
+  for (auto* tv : {in, allreduced, out}) {
+    tv->setDeviceMesh(mesh);
+  }
+  in->axis(0)->parallelize(ParallelType::DIDx);
+
+  MultiDeviceExecutor executor(std::move(fusion), *communicator_);
+  auto options = at::TensorOptions().device(communicator_->device());
+  std::vector<at::Tensor> previous_outputs;
+  for ([[maybe_unused]] auto i : c10::irange(3)) {
+    at::Tensor unsharded_input = at::randn({num_devices, 16}, options);
+    std::vector<at::Tensor> outputs =
+        executor.runWithInput({shardTensor(unsharded_input, 0, mesh)});
+    EXPECT_TRUE(at::allclose(outputs.at(0), unsharded_input.sum(0) * 2));
+    for (const at::Tensor& previous_output : previous_outputs) {
+      EXPECT_FALSE(previous_output.is_same(outputs.at(0)));
+    }
+    previous_outputs.push_back(outputs.at(0));
+  }
+}
+
+// See Note [Fusing Allgather with its consumer]
+TEST_F(MultiDeviceExecutorTest, FuseAllgatherWithConsumer) {
+  const int64_t num_devices = communicator_->size();
+  auto mesh = DeviceMesh::createForNumDevices(num_devices);
+  if (communicator_->getP2pChannelForTeam(mesh.vector()) == nullptr) {
+    GTEST_SKIP() << "The devices can't use a P2P channel.";
+  }
+
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+  TensorView* in = makeContigConcreteTensor({num_devices, 4});
+  TensorView* gathered = set(in);
+  TensorView* out = add(gathered, gathered);
+  fusion->addInput(in);
+  fusion->addOutput(out);
+  for (auto* tv : {in, gathered, out}) {
+    tv->setDeviceMesh(mesh);
+  }
+  in->axis(0)->parallelize(ParallelType::DIDx);
+
+  HostIrExecutorParams params;
+  params.fuse_allgather_with_consumer = true;
+  MultiDeviceExecutor executor(std::move(fusion), *communicator_, params);
+
+  std::stringstream host_program;
+  executor.print(host_program);
+  EXPECT_EQ(host_program.str().find("Allgather"), std::string::npos)
+      << host_program.str();
+  EXPECT_NE(host_program.str().find("ShareWithPeers"), std::string::npos)
+      << host_program.str();
+
+  auto options = at::TensorOptions().device(communicator_->device());
+  for ([[maybe_unused]] auto i : c10::irange(3)) {
+    at::Tensor unsharded_input = at::randn({num_devices, 4}, options);
+    std::vector<at::Tensor> outputs =
+        executor.runWithInput({shardTensor(unsharded_input, 0, mesh)});
+    EXPECT_TRUE(at::allclose(outputs.at(0), unsharded_input * 2));
+  }
+}
+
+// See Note [Capturing host programs in CUDA graphs]
+TEST_F(MultiDeviceExecutorTest, CudaGraph) {
+  if (!communicator_->isBackendAvailable(CommunicatorBackend::nccl)) {
+    GTEST_SKIP() << "Requires NCCL";
+  }
+  const int64_t num_devices = communicator_->size();
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+  auto mesh = DeviceMesh::createForNumDevices(num_devices);
+
+  TensorView* in = makeContigTensor(2);
+  TensorView* allreduced = sum(in, {0});
+  TensorView* out = add(allreduced, allreduced);
+  fusion->addInput(in);
+  fusion->addOutput(out);
+  for (auto* tv : {in, allreduced, out}) {
+    tv->setDeviceMesh(mesh);
+  }
+  in->axis(0)->parallelize(ParallelType::DIDx);
+
+  HostIrExecutorParams params;
+  params.use_cuda_graphs = true;
+  MultiDeviceExecutor executor(std::move(fusion), *communicator_, params);
+  auto options = at::TensorOptions().device(communicator_->device());
+  std::vector<at::Tensor> previous_outputs;
+  // Warm up, capture, and replay twice
+  for ([[maybe_unused]] auto i : c10::irange(4)) {
+    at::Tensor unsharded_input = at::randn({num_devices, 16}, options);
+    std::vector<at::Tensor> outputs =
+        executor.runWithInput({shardTensor(unsharded_input, 0, mesh)});
+    EXPECT_TRUE(at::allclose(outputs.at(0), unsharded_input.sum(0) * 2));
+    previous_outputs.push_back(outputs.at(0));
+  }
+  // The returned outputs are not overwritten by the next replays.
+  EXPECT_FALSE(previous_outputs.at(2).equal(previous_outputs.at(3)));
+}
+
+class RingAttentionTest : public MultiDeviceTest,
+                          public testing::WithParamInterface<bool> {};
+
+TEST_P(RingAttentionTest, MatchesUnshardedAttention) {
+  NVFUSER_TEST_CUDA_ARCH_GUARD(8, 0);
+  const bool is_causal = GetParam();
+  const int64_t num_devices = communicator_->size();
+  const DeviceIdxType my_device_index = communicator_->deviceId();
+  auto mesh = DeviceMesh::createForNumDevices(num_devices);
+  constexpr int64_t n = 2, h = 4, l = 128, e = 64;
+
+  HostIrExecutorParams params;
+  params.use_fusion_executor_cache = true;
+  params.release_dead_values = true;
+  HostIrExecutor hie(
+      makeRingAttentionProgram(
+          mesh, my_device_index, DataType::BFloat16, is_causal),
+      communicator_,
+      params);
+
+  auto options =
+      at::TensorOptions().dtype(at::kBFloat16).device(communicator_->device());
+  // The same on all the devices
+  at::manual_seed(0);
+  at::Tensor q = at::randn({n, h, l * num_devices, e}, options);
+  at::Tensor k = at::randn({n, h, l * num_devices, e}, options);
+  at::Tensor v = at::randn({n, h, l * num_devices, e}, options);
+  auto shard = [&](const at::Tensor& t) {
+    return t.slice(2, my_device_index * l, (my_device_index + 1) * l)
+        .contiguous();
+  };
+
+  const std::vector<Val*>& inputs = hie.inputs();
+  std::vector<at::Tensor> outputs = hie.runWithInput(
+      {{inputs.at(0), shard(q)},
+       {inputs.at(1), shard(k)},
+       {inputs.at(2), shard(v)}});
+
+  auto [expected_out, expected_lse, cum_seq_q, cum_seq_k, query_seq_len,
+        key_seq_len, philox_seed, philox_offset, debug_attn_mask] =
+      at::_scaled_dot_product_flash_attention(
+          q, k, v, /*dropout_p=*/0.0, is_causal);
+  EXPECT_TRUE(at::allclose(
+      outputs.at(0), shard(expected_out), /*rtol=*/1e-2, /*atol=*/1e-2));
+  EXPECT_TRUE(at::allclose(
+      outputs.at(1), shard(expected_lse), /*rtol=*/1e-3, /*atol=*/1e-3));
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    ,
+    RingAttentionTest,
+    testing::Bool(),
+    [](const testing::TestParamInfo<bool>& info) -> std::string {
+      return info.param ? "causal" : "noncausal";
+    });
+
 } // namespace hir
 
 } // namespace nvfuser
@@ -11,6 +11,7 @@
 
 #include <kernel_cache.h>
 #include <ops/all_ops.h>
+#include <options.h>
 #include <tests/cpp/multidevice.h>
 #include <tests/cpp/validator.h>
 
@@ -346,6 +347,32 @@ TEST_F(LowerCollectiveTest, ReduceScatter) {
   EXPECT_TRUE(at::allclose(out_tensor, shardTensor(unsharded_out_tensor, out)));
 }
 
+TEST_F(LowerCollectiveTest, AllToAll) {
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+
+  const auto num_devices = communicator_->size();
+  TensorView* in = makeContigTensor(3);
+  TensorView* out = set(in);
+  fusion->addInput(in);
+  fusion->addOutput(out);
+
+  auto mesh = DeviceMesh::createForNumDevices(num_devices);
+  in->setDeviceMesh(mesh);
+  out->setDeviceMesh(mesh);
+  in->axis(0)->parallelize(ParallelType::DIDx);
+  out->axis(2)->parallelize(ParallelType::DIDx);
+
+  at::Tensor unsharded_tensor =
+      at::randn({num_devices, kTensorSize, num_devices}, tensor_options);
+  at::Tensor in_tensor = shardTensor(unsharded_tensor, in);
+
+  FusionExecutorCache fec(std::move(fusion));
+  at::Tensor out_tensor = fec.runFusionWithInputs({in_tensor})[0];
+
+  EXPECT_TRUE(at::equal(out_tensor, shardTensor(unsharded_tensor, out)));
+}
+
 TEST_F(LowerCollectiveTest, ReduceScatter_Allgather) {
   // Allreduce = ReduceScatter + Allgather
   auto fusion = std::make_unique<Fusion>();
@@ -377,4 +404,47 @@ TEST_F(LowerCollectiveTest, ReduceScatter_Allgather) {
   EXPECT_TRUE(at::allclose(out_tensor, unsharded_in_tensor.sum(0)));
 }
 
+TEST_F(LowerCollectiveTest, CompressedReduceScatter_Allgather) {
+  const auto num_devices = communicator_->size();
+  // Integers are exact in bf16, and fp8 rounds each of the summands by up to
+  // 1/16 of its magnitude, i.e. 1/2 here, and the sum by 1/16 of it.
+  at::Tensor unsharded_in_tensor = at::randint(
+      -8, 8, {num_devices, num_devices, kTensorSize}, tensor_options);
+  at::Tensor expected = unsharded_in_tensor.sum(0);
+
+  for (const std::string transport : {"bf16", "fp8"}) {
+    EnableOptionsGuard opt_guard;
+    EnableOptionsGuard::getCurOptions().set(
+        EnableOption::CompressedCollectives, {transport});
+
+    auto fusion = std::make_unique<Fusion>();
+    FusionGuard fg(fusion.get());
+    auto mesh = DeviceMesh::createForNumDevices(num_devices);
+
+    TensorView* in = makeContigTensor(3);
+    in->setDeviceMesh(mesh);
+    in->axis(0)->parallelize(ParallelType::DIDx);
+
+    TensorView* out = sum(in, {0});
+    out->axis(1)->parallelize(ParallelType::DIDx);
+
+    out = set(out);
+    out->axis(0)->parallelize(ParallelType::Serial);
+
+    fusion->addInput(in);
+    fusion->addOutput(out);
+
+    at::Tensor in_tensor = shardTensor(unsharded_in_tensor, in);
+    FusionExecutorCache fec(std::move(fusion));
+    at::Tensor out_tensor = fec.runFusionWithInputs({in_tensor})[0];
+
+    if (transport == "bf16") {
+      EXPECT_TRUE(at::equal(out_tensor, expected));
+    } else {
+      const double tolerance = 0.5 * num_devices + 8.0 * num_devices / 16;
+      EXPECT_TRUE(at::allclose(out_tensor, expected, 0.0, tolerance));
+    }
+  }
+}
+
 } // namespace nvfuser
@@ -9,6 +9,7 @@
 #include <c10/cuda/CUDAStream.h>
 #include <c10/util/ArrayRef.h>
 #include <fusion.h>
+#include <gmock/gmock-matchers.h>
 #include <host_ir/container.h>
 #include <host_ir/executor.h>
 #include <host_ir/host_ir.h>
@@ -335,4 +336,61 @@ TEST_F(OverlapTest, ReduceScatterBasedPipeliningHostIrImplementation) {
   validate();
 }
 
+// Same program as above, but defined as a Fusion and decomposed automatically
+// by MultiDeviceExecutor. See Note [Overlapping compute and communication]
+TEST_F(OverlapTest, ReduceScatterBasedPipeliningAutomaticDecomposition) {
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+  DeviceMesh mesh(all_devices_);
+
+  TensorView* a = makeContigTensor(5); // [S, DIDx(Dk), Dm, M/(S*D), K/D]
+  TensorView* b = makeContigTensor(3); // [DIDx(Dk), K/D, N]
+  fusion->addInput(a);
+  fusion->addInput(b);
+  TensorView* a_b = broadcast(a, {false, false, false, false, false, true});
+  TensorView* b_b = broadcast(b, {true, false, true, true, false, false});
+  TensorView* ab = mul(a_b, b_b); // [S, DIDx(Dk), Dm, M/(S*D), K/D, N]
+  TensorView* c0 = sum(ab, {4}); // [S, DIDx(Dk), Dm, M/(S*D), r, N]
+  TensorView* c = sum(c0, {1}); // [S, r, DIDx(Dm), M/(S*D), N]
+  fusion->addOutput(c);
+
+  for (auto* tv : {a, b, a_b, b_b, ab, c0, c}) {
+    tv->setDeviceMesh(mesh);
+  }
+  for (auto* tv : {a, a_b, b_b, ab, c0}) {
+    tv->axis(1)->parallelize(ParallelType::DIDx);
+  }
+  b->axis(0)->parallelize(ParallelType::DIDx);
+  c->axis(2)->parallelize(ParallelType::DIDx);
+
+  hir::HostIrExecutorParams executor_params;
+  executor_params.use_fusion_executor_cache = true;
+  executor_params.overlap_compute_and_communication = true;
+  executor_params.number_of_streams = params.number_of_streams;
+  executor_params.max_chunks = params.S;
+  executor_params.min_chunk_bytes = 1;
+  MultiDeviceExecutor runtime(
+      std::move(fusion), *communicator_, executor_params);
+
+  std::stringstream host_program;
+  runtime.print(host_program);
+  EXPECT_THAT(host_program.str(), testing::HasSubstr("Synchronize"));
+
+  for ([[maybe_unused]] const auto& _ :
+       c10::irange(params.number_of_iterations)) {
+    initializeIO();
+    std::vector<c10::IValue> inputs = {
+        ta_.view(
+            {params.S,
+             1,
+             num_devices_,
+             params.M / (params.S * num_devices_),
+             params.K / num_devices_}),
+        tb_.unsqueeze(0)};
+    auto outputs = runtime.runWithInput(inputs);
+    tc_.copy_(outputs.at(0).squeeze(1));
+  }
+  validate();
+}
+
 } // namespace nvfuser
@@ -587,4 +587,52 @@ INSTANTIATE_TEST_SUITE_P(
         SchedulingMode::Automatic),
     testing::PrintToStringParamName());
 
+class PipelineTestMicrobatches
+    : public PipelineTest,
+      public ::testing::WithParamInterface<hir::PipelineSchedule> {};
+
+// Forward through device 0 then device 1, and back to device 0, run one
+// microbatch at a time
+TEST_P(PipelineTestMicrobatches, ForwardAndBack) {
+  if (communicator_->size() < 2) {
+    GTEST_SKIP() << "Requires at least 2 devices";
+  }
+  constexpr int64_t kNumberOfMicrobatches = 4;
+  const DeviceMesh mesh0({0});
+  const DeviceMesh mesh1({1});
+
+  FusionGuard fg(fusion.get());
+  TensorView* tv0 = makeContigTensor(2);
+  TensorView* tv1 = add(tv0, tv0);
+  TensorView* tv2 = set(tv1);
+  TensorView* tv3 = mul(tv2, tv2);
+  TensorView* tv4 = set(tv3);
+  TensorView* tv5 = add(tv4, tv1);
+  fusion->addInput(tv0);
+  fusion->addOutput(tv5);
+
+  for (auto* tv : {tv0, tv1, tv4, tv5}) {
+    tv->setDeviceMesh(mesh0);
+  }
+  for (auto* tv : {tv2, tv3}) {
+    tv->setDeviceMesh(mesh1);
+  }
+
+  // The batch size is not a multiple of the number of microbatches on
+  // purpose, so the last microbatch is smaller.
+  unsharded_inputs = {at::randn({10, 7}, tensor_options)};
+  host_ir_executor_params.number_of_microbatches = kNumberOfMicrobatches;
+  host_ir_executor_params.pipeline_schedule = GetParam();
+
+  executeAndValidate();
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    ,
+    PipelineTestMicrobatches,
+    testing::Values(
+        hir::PipelineSchedule::GPipe,
+        hir::PipelineSchedule::OneForwardOneBackward),
+    testing::PrintToStringParamName());
+
 } // namespace nvfuser
@@ -191,6 +191,86 @@ TEST_F(MultiDeviceTest, LayerNorm) {
       __FILE__);
 }
 
+// The normalized axes of the LayerNorm are sharded. Only the per-row
+// statistics are communicated. See Note [Distributed normalization
+// statistics].
+TEST_F(MultiDeviceTest, LayerNorm_ShardedNormalizedAxis) {
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+  const auto num_devices = communicator_->size();
+  auto mesh = DeviceMesh::createForNumDevices(num_devices);
+
+  std::vector<int64_t> input_shape = {32, num_devices, 256};
+  std::vector<int64_t> norm_shape = {num_devices, 256};
+  TensorView* x = makeContigConcreteTensor(input_shape);
+  fusion->addInput(x);
+
+  constexpr double kEps = 1e-5;
+  Val* eps_ptr = IrBuilder::create<Val>(kEps);
+  auto result = layer_norm(x, norm_shape, nullptr, nullptr, eps_ptr);
+  fusion->addOutput(result.output);
+  fusion->addOutput(result.mean);
+  fusion->addOutput(result.invstd);
+
+  x->setDeviceMesh(mesh);
+  x->axis(1)->parallelize(ParallelType::DIDx);
+
+  auto unsharded_x = at::randn(input_shape, tensor_options) + 10.0;
+  auto aten_outputs = at::native_layer_norm(
+      unsharded_x, norm_shape, c10::nullopt, c10::nullopt, kEps);
+  std::vector<c10::IValue> inputs = {shardTensor(unsharded_x, x)};
+
+  FusionExecutorCache fec(std::move(fusion));
+  auto outputs = fec.runFusionWithInputs(inputs);
+
+  testValidate(
+      fec.fusion(),
+      outputs,
+      inputs,
+      {shardTensor(std::get<0>(aten_outputs), result.output),
+       std::get<1>(aten_outputs),
+       std::get<2>(aten_outputs)},
+      __LINE__,
+      __FILE__);
+}
+
+TEST_F(MultiDeviceTest, RMSNorm_ShardedNormalizedAxis) {
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+  const auto num_devices = communicator_->size();
+  auto mesh = DeviceMesh::createForNumDevices(num_devices);
+
+  std::vector<int64_t> input_shape = {32, num_devices, 256};
+  std::vector<int64_t> norm_shape = {num_devices, 256};
+  TensorView* x = makeContigConcreteTensor(input_shape);
+  fusion->addInput(x);
+
+  constexpr double kEps = 1e-5;
+  Val* eps_ptr = IrBuilder::create<Val>(kEps);
+  auto result = rms_norm(x, norm_shape, nullptr, eps_ptr);
+  fusion->addOutput(result.output);
+  fusion->addOutput(result.invstd);
+
+  x->setDeviceMesh(mesh);
+  x->axis(1)->parallelize(ParallelType::DIDx);
+
+  auto unsharded_x = at::randn(input_shape, tensor_options);
+  auto invstd = at::rsqrt(
+      unsharded_x.pow(2).mean({1, 2}, /*keepdim=*/true) + kEps);
+  std::vector<c10::IValue> inputs = {shardTensor(unsharded_x, x)};
+
+  FusionExecutorCache fec(std::move(fusion));
+  auto outputs = fec.runFusionWithInputs(inputs);
+
+  testValidate(
+      fec.fusion(),
+      outputs,
+      inputs,
+      {shardTensor(unsharded_x * invstd, result.output), invstd},
+      __LINE__,
+      __FILE__);
+}
+
 TEST_F(MultiDeviceTest, Issue2758) {
   auto fusion = std::make_unique<Fusion>();
   FusionGuard fg(fusion.get());
@@ -1326,4 +1326,149 @@ TEST_F(PersistentBufferTest, SmemPersistent2DReduction) {
   auto t1 = t0 / t0.sum({1, 2, 3}, true);
   testValidate(fusion.get(), cg_outputs, aten_inputs, {t1}, __LINE__, __FILE__);
 }
+
+// The rows of the shared memory persistent input are loaded with TMA boxes of
+// 256 elements on Hopper.
+TEST_F(PersistentBufferTest, TmaLoadSmemPersistent2DReduction) {
+  NVFUSER_TEST_CUDA_ARCH_GUARD(9, 0);
+  EnableOptionsGuard opt_guard;
+  EnableOptionsGuard::getCurOptions().set(EnableOption::TmaPersistentLoad);
+
+  // A multiple of 256 elements larger than the register file
+  const int64_t max_element_for_reg_persistent =
+      scheduler_utils::register_file_size / scheduler_utils::bytes_per_register;
+  const int64_t hidden_size = max_element_for_reg_persistent + 1024;
+  DataType input_dtype = DataType::Float;
+  const std::vector<int64_t> input_shape = {132, hidden_size};
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+  auto tv0 = makeContigTensor(input_shape.size(), input_dtype);
+  fusion->addInput(tv0);
+  auto tv1 = sum(tv0, {1});
+  auto tv2 = broadcast(tv1, {false, true});
+  auto tv3 = div(tv0, tv2);
+  fusion->addOutput(tv3);
+
+  int64_t smem_overhead = scheduler_utils::getSharedMemoryOverheadPerBlock(
+      fusion.get(), scheduler_utils::getReductionTvs(fusion.get()));
+  REQUIRE_DEVICE_SMEM_SIZE(
+      smem_overhead + hidden_size * dataTypeSize(input_dtype), 0);
+
+  auto options = at::TensorOptions()
+                     .dtype(data_type_to_aten(input_dtype))
+                     .device(at::kCUDA, 0);
+  auto t0 = at::randn(input_shape, options);
+  std::vector<c10::IValue> aten_inputs = {t0};
+  SchedulerRuntimeInfo runtime_info(fusion.get(), aten_inputs);
+  ASSERT_TRUE(SchedulerEntry::canSchedule(
+      ScheduleHeuristic::InnerPersistent, fusion.get(), runtime_info));
+  auto scheduler = SchedulerEntry::makeEntry(
+      ScheduleHeuristic::InnerPersistent, fusion.get(), runtime_info);
+  EXPECT_FALSE(scheduler->reductionParams().smem_persistent_buffers.empty());
+  EXPECT_EQ(scheduler->reductionParams().tma_load_box_size, 256);
+  scheduler->schedule(fusion.get());
+
+  FusionExecutor fe;
+  fe.compileFusion(fusion.get(), aten_inputs);
+  auto cg_outputs =
+      fe.runFusion(aten_inputs, scheduler->reductionParams().lparams);
+  auto t1 = t0 / t0.sum({1}, true);
+  testValidate(fusion.get(), cg_outputs, aten_inputs, {t1}, __LINE__, __FILE__);
+}
+
+// The persistent buffer of each row is larger than the registers and shared
+// memory of a block, so on Hopper it is split across a thread block cluster.
+TEST_F(PersistentBufferTest, ClusterPersistentSoftmax) {
+  NVFUSER_TEST_CUDA_ARCH_GUARD(9, 0);
+
+  DataType input_dtype = DataType::Float;
+  const std::vector<int64_t> input_shape = {256, 128 * 1024};
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+  auto tv0 = makeContigTensor(input_shape.size(), input_dtype);
+  fusion->addInput(tv0);
+  auto tv1 = softmax(tv0, 1);
+  fusion->addOutput(tv1);
+
+  auto options = at::TensorOptions()
+                     .dtype(data_type_to_aten(input_dtype))
+                     .device(at::kCUDA, 0);
+  auto t0 = at::randn(input_shape, options);
+  std::vector<c10::IValue> aten_inputs = {t0};
+  SchedulerRuntimeInfo runtime_info(fusion.get(), aten_inputs);
+  ASSERT_TRUE(SchedulerEntry::canSchedule(
+      ScheduleHeuristic::InnerPersistent, fusion.get(), runtime_info));
+  auto scheduler = SchedulerEntry::makeEntry(
+      ScheduleHeuristic::InnerPersistent, fusion.get(), runtime_info);
+  const auto& rparams = scheduler->reductionParams();
+  EXPECT_TRUE(rparams.cross_cluster_inner_reduction);
+  EXPECT_GT(rparams.lparams.gdimx(), 1);
+  EXPECT_TRUE(rparams.smem_persistent_buffers.empty());
+  scheduler->schedule(fusion.get());
+
+  FusionExecutor fe;
+  fe.compileFusion(fusion.get(), aten_inputs, rparams.lparams);
+  EXPECT_TRUE(fe.kernel()->summary().has_cluster_reductions);
+  EXPECT_FALSE(fe.kernel()->summary().has_cooperative_grid_reduction);
+  auto cg_outputs = fe.runFusion(aten_inputs, rparams.lparams);
+  auto t1 = at::_softmax(t0.to(at::kDouble), 1, false);
+  testValidate(
+      fusion.get(),
+      cg_outputs,
+      aten_inputs,
+      {t1},
+      __LINE__,
+      __FILE__,
+      "",
+      rparams.lparams);
+}
+
+TEST_F(PersistentBufferTest, LowerPrecisionPersistentBuffers) {
+  EnableOptionsGuard opt_guard;
+  EnableOptionsGuard::getCurOptions().set(
+      EnableOption::LowerPrecisionPersistentBuffers);
+
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+  // A layer norm without weight, bias and epsilon
+  const int64_t hidden_size = 4096;
+  auto tv0 = makeContigConcreteTensor({128, hidden_size}, DataType::Half);
+  fusion->addInput(tv0);
+  auto tv1 = castOp(DataType::Float, tv0);
+  auto tv2 = div(sum(tv1, {1}), IrBuilder::create<Val>((double)hidden_size));
+  auto tv3 = broadcast(tv2, {false, true});
+  auto tv4 = sub(tv1, tv3);
+  auto tv5 = mul(tv4, tv4);
+  auto tv6 = div(sum(tv5, {1}), IrBuilder::create<Val>((double)hidden_size));
+  auto tv7 = broadcast(rsqrt(tv6), {false, true});
+  auto tv8 = mul(tv4, tv7);
+  auto tv9 = castOp(DataType::Half, tv8);
+  fusion->addOutput(tv9);
+
+  // tv1 is projectable to the input, but tv4 depends on a reduction.
+  auto persistent_info = scheduler_utils::persistentBuffers(fusion.get());
+  EXPECT_THAT(
+      persistent_info.persistent_buffers,
+      testing::UnorderedElementsAre(tv1, tv4));
+  EXPECT_THAT(
+      persistent_info.lower_precision_buffers,
+      testing::UnorderedElementsAre(testing::Pair(tv4, DataType::Half)));
+
+  auto options = at::TensorOptions().dtype(at::kHalf).device(at::kCUDA, 0);
+  auto t0 = at::randn({128, hidden_size}, options);
+  FusionExecutorCache executor_cache(std::move(fusion));
+  auto cg_outputs = executor_cache.runFusionWithInputs({t0});
+  EXPECT_THAT(
+      executor_cache.getMostRecentKernelRuntime()->fusionSegments()->groups(),
+      testing::UnorderedElementsAre(
+          HeuristicIs(ScheduleHeuristic::InnerPersistent)));
+
+  // The buffer is rounded to half, so compare with a tolerance accounting
+  // for one more rounding than the output.
+  auto t1 = t0.to(at::kFloat);
+  auto t4 = t1 - t1.mean({1}, true);
+  auto t8 = t4 * (t4 * t4).mean({1}, true).rsqrt();
+  EXPECT_TRUE(at::allclose(
+      cg_outputs[0].to(at::kFloat), t8, /*rtol=*/1e-2, /*atol=*/1e-2));
+}
 } // namespace nvfuser
@@ -12,8 +12,10 @@
 #include <ir/interface_nodes.h>
 #include <kernel_cache.h>
 #include <ops/all_ops.h>
+#include <options.h>
 #include <preseg_passes/mark_aliases_prepare.h>
 #include <preseg_passes/optimization_pass.h>
+#include <scheduler/heuristic_plugin.h>
 #include <tests/cpp/utils.h>
 #include <tests/cpp/validator.h>
 
@@ -201,6 +203,47 @@ TEST_F(PointwiseTest, VectorizeStrideMisalignedBase) {
   }
 }
 
+// A minority of misaligned inputs are read by scalars, without limiting the
+// vectorization of the other inputs and outputs.
+TEST_F(PointwiseTest, VectorizeMisalignedInputPerTensor) {
+  auto fusion_ptr = std::make_unique<Fusion>();
+  auto fusion = fusion_ptr.get();
+  FusionGuard fg(fusion);
+
+  TensorView* tv0 = makeContigTensor(2);
+  TensorView* tv1 = makeContigTensor(2);
+  TensorView* tv2 = makeContigTensor(2);
+  fusion->addInput(tv0);
+  fusion->addInput(tv1);
+  fusion->addInput(tv2);
+  auto tv3 = add(add(tv0, tv1), tv2);
+  fusion->addOutput(tv3);
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor t0 = at::randn({1024, 128}, options);
+  at::Tensor t1 = at::randn({1024, 128}, options);
+  // Misaligned by one element
+  at::Tensor t2 = at::randn({1024 * 128 + 1}, options)
+                      .narrow(0, 1, 1024 * 128)
+                      .view({1024, 128});
+  std::vector<c10::IValue> aten_inputs = {t0, t1, t2};
+
+  auto params = getPointwiseHeuristics(fusion, aten_inputs);
+  auto lparams = schedulePointwise(fusion, aten_inputs);
+  FusionExecutor fe;
+  fe.compileFusion(fusion, aten_inputs, lparams);
+  auto cg_outputs = fe.runFusion(aten_inputs, lparams);
+
+  EXPECT_TRUE(params->vectorize);
+  EXPECT_EQ(params->unroll_factor, 4);
+  EXPECT_EQ(params->misaligned_tensors, std::vector<int64_t>{2});
+  EXPECT_TRUE(hasVectorizationCache(tv0));
+  EXPECT_TRUE(hasVectorizationCache(tv1));
+  EXPECT_FALSE(hasVectorizationCache(tv2));
+
+  testValidate(fusion, cg_outputs, aten_inputs, __LINE__, __FILE__);
+}
+
 TEST_F(PointwiseTest, VectorizeStrideContiguitySelfOverlapping) {
   auto fusion_ptr = std::make_unique<Fusion>();
   auto fusion = fusion_ptr.get();
@@ -662,4 +705,226 @@ TEST_F(PointwiseTest, VectorizeWithExpandedBroadcast) {
   EXPECT_GT(getVecSizeForPointwise(fec), 1);
 }
 
+// A heuristic plugin sees the problem and the parameters of nvFuser's
+// heuristic and can override them.
+TEST_F(PointwiseTest, HeuristicPlugin) {
+  struct NoVectorizeConfig : heuristic_plugin::HeuristicConfig {
+    void configure() final {
+      EXPECT_EQ(problem.heuristic, Heuristic::PointWise);
+      EXPECT_EQ(problem.num_dims, 2);
+      EXPECT_EQ(problem.sizes[0], 1024);
+      EXPECT_EQ(problem.sizes[1], 128);
+      EXPECT_EQ(problem.num_tensor_inputs, 2);
+      EXPECT_EQ(problem.num_tensor_outputs, 1);
+      EXPECT_EQ(problem.max_dtype_size, 4);
+      EXPECT_GT(pointwise.unroll_factor, 1);
+      pointwise.vectorize = false;
+      pointwise.unroll_factor = 2;
+    }
+  };
+  heuristic_plugin::HeuristicConfigFactoryGuard factory_guard([]() {
+    return std::unique_ptr<heuristic_plugin::HeuristicConfig>(
+        new NoVectorizeConfig);
+  });
+  EXPECT_TRUE(heuristic_plugin::hasPlugin());
+
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+  auto tv0 = makeContigTensor(2);
+  auto tv1 = makeContigTensor(1);
+  fusion->addInput(tv0);
+  fusion->addInput(tv1);
+  auto tv2 = add(tv0, broadcast(tv1, {true, false}));
+  fusion->addOutput(tv2);
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor t0 = at::randn({1024, 128}, options);
+  at::Tensor t1 = at::randn({128}, options);
+
+  FusionExecutorCache fec(std::move(fusion));
+  auto cg_outputs = fec.runFusionWithInputs({t0, t1});
+
+  const PointwiseParams& params = fec.getMostRecentKernelRuntime()
+                                      ->schedulerHeuristics()
+                                      ->heuristicsList()
+                                      .at(0)
+                                      ->pointwiseParams();
+  EXPECT_FALSE(params.vectorize);
+  EXPECT_EQ(params.unroll_factor, 2);
+  testValidate(fec.fusion(), cg_outputs, {t0, t1}, __LINE__, __FILE__);
+}
+
+// See Note [TMA pointwise store]
+TEST_F(PointwiseTest, TmaStore) {
+  if (cudaArchGuardShouldSkip(9, 0)) {
+    GTEST_SKIP() << "skipping tests on pre-Hopper GPUs";
+  }
+  EnableOptionsGuard opt_guard;
+  EnableOptionsGuard::getCurOptions().set(EnableOption::TmaStore);
+
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+  auto tv0 = makeContigTensor(2);
+  auto tv1 = makeContigTensor(2);
+  fusion->addInput(tv0);
+  fusion->addInput(tv1);
+  auto tv2 = add(tv0, tv1);
+  auto tv3 = mul(tv2, tv0);
+  fusion->addOutput(tv2);
+  fusion->addOutput(tv3);
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  // The last chunk of each output is partial
+  at::Tensor t0 = at::randn({1000, 1028}, options);
+  at::Tensor t1 = at::randn({1000, 1028}, options);
+
+  FusionExecutorCache fec(std::move(fusion));
+  auto cg_outputs = fec.runFusionWithInputs({t0, t1});
+
+  const PointwiseParams& params = fec.getMostRecentKernelRuntime()
+                                      ->schedulerHeuristics()
+                                      ->heuristicsList()
+                                      .at(0)
+                                      ->pointwiseParams();
+  EXPECT_TRUE(params.use_tma_store);
+  testValidate(fec.fusion(), cg_outputs, {t0, t1}, __LINE__, __FILE__);
+}
+
+// See Note [Fast math]
+TEST_F(PointwiseTest, FastMath) {
+  EnableOptionsGuard opt_guard;
+  EnableOptionsGuard::getCurOptions().set(EnableOption::FastMath);
+
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+  auto tv0 = makeContigTensor(1);
+  fusion->addInput(tv0);
+  fusion->addOutput(exp(tv0));
+  fusion->addOutput(log(abs(tv0)));
+  fusion->addOutput(tanh(tv0));
+  fusion->addOutput(erf(tv0));
+  fusion->addOutput(sigmoid(tv0));
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor t0 = at::randn({1 << 20}, options) * 4;
+
+  FusionExecutorCache fec(std::move(fusion));
+  auto cg_outputs = fec.runFusionWithInputs({t0});
+
+  const std::string& code =
+      fec.getMostRecentKernelRuntime()->executors().at(0).kernelString();
+  for (const auto* name :
+       {"fast_exp(", "fast_log(", "fast_tanh(", "fast_erf(", "fast_sigmoid("}) {
+    EXPECT_NE(code.find(name), std::string::npos) << name;
+  }
+
+  // Bounds of Note [Fast math] with some slack. allclose(out, ref, rtol, atol)
+  // checks |out - ref| <= atol + rtol * |ref|.
+  EXPECT_TRUE(at::allclose(cg_outputs[0], t0.exp(), 4e-6, 0));
+  EXPECT_TRUE(at::allclose(cg_outputs[1], t0.abs().log(), 1e-6, 1e-6));
+  EXPECT_TRUE(at::allclose(cg_outputs[2], t0.tanh(), 1e-3, 0));
+  EXPECT_TRUE(at::allclose(cg_outputs[3], t0.erf(), 0, 1e-6));
+  EXPECT_TRUE(at::allclose(cg_outputs[4], t0.sigmoid(), 4e-6, 0));
+}
+
+TEST_F(PointwiseTest, VectorizeIndexSelectLookup) {
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+
+  // An embedding lookup: rows of the table are gathered along the outer
+  // dimension, so the index_select can load vectors of them
+  TensorView* tv0 = makeContigTensor(2);
+  TensorView* tv1 = makeContigTensor(1, DataType::Int);
+  fusion->addInput(tv0);
+  fusion->addInput(tv1);
+  auto tv2 = index_select(tv0, 0, tv1);
+  fusion->addOutput(mul(tv2, IrBuilder::create<Val>(2.0)));
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor t0 = at::randn({1024, 128}, options);
+  at::Tensor t1 = at::randint(1024, {1000}, options.dtype(at::kLong));
+
+  FusionExecutorCache fec(std::move(fusion));
+  auto cg_outputs = fec.runFusionWithInputs({t0, t1});
+
+  EXPECT_EQ(getVecSizeForPointwise(fec), 4);
+  const std::string& code =
+      fec.getMostRecentKernelRuntime()->executors().at(0).kernelString();
+  EXPECT_NE(
+      code.find("loadGlobalToLocal<float, /*vec_size=*/4"), std::string::npos);
+
+  testValidate(fec.fusion(), cg_outputs, {t0, t1}, __LINE__, __FILE__);
+}
+
+// See Note [3D pointwise schedule]
+TEST_F(PointwiseTest, ThreeDSchedule) {
+  EnableOptionsGuard opt_guard;
+  EnableOptionsGuard::getCurOptions().set(EnableOption::Pointwise3D);
+
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+  // [B, H, S, D] + bias[H] + rotary[S, D]
+  auto tv0 = makeContigTensor(4);
+  auto tv1 = makeContigTensor(1);
+  auto tv2 = makeContigTensor(2);
+  fusion->addInput(tv0);
+  fusion->addInput(tv1);
+  fusion->addInput(tv2);
+  auto tv3 = broadcast(tv1, {true, false, true, true});
+  auto tv4 = broadcast(tv2, {true, true, false, false});
+  auto tv5 = add(add(tv0, tv3), tv4);
+  fusion->addOutput(tv5);
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor t0 = at::randn({8, 16, 128, 128}, options);
+  at::Tensor t1 = at::randn({16}, options);
+  at::Tensor t2 = at::randn({128, 128}, options);
+
+  FusionExecutorCache fec(std::move(fusion));
+  auto cg_outputs = fec.runFusionWithInputs({t0, t1, t2});
+
+  const PointwiseParams& params = fec.getMostRecentKernelRuntime()
+                                      ->schedulerHeuristics()
+                                      ->heuristicsList()
+                                      .at(0)
+                                      ->pointwiseParams();
+  EXPECT_GT(params.break_point2, params.break_point);
+  EXPECT_GT(params.break_point, 0);
+  EXPECT_GT(params.serial_factor, 1);
+  testValidate(fec.fusion(), cg_outputs, {t0, t1, t2}, __LINE__, __FILE__);
+}
+
+// See Note [Grid-stride pointwise schedule]
+TEST_F(PointwiseTest, GridStrideSchedule) {
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+  auto tv0 = makeContigTensor(2);
+  auto tv1 = makeContigTensor(2);
+  fusion->addInput(tv0);
+  fusion->addInput(tv1);
+  auto tv2 = relu(add(mul(tv0, IrBuilder::create<Val>(2.0)), tv1));
+  fusion->addOutput(tv2);
+
+  // Just over kMinGridStrideTiles tiles per block, and not a multiple of the
+  // number of blocks, so the blocks walk different numbers of tiles
+  const auto device_prop = at::cuda::getCurrentDeviceProperties();
+  const int64_t rows = (int64_t)device_prop->multiProcessorCount * 256 + 1;
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor t0 = at::randn({rows, 512}, options);
+  at::Tensor t1 = at::randn({rows, 512}, options);
+
+  FusionExecutorCache fec(std::move(fusion));
+  auto cg_outputs = fec.runFusionWithInputs({t0, t1});
+
+  const PointwiseParams& params = fec.getMostRecentKernelRuntime()
+                                      ->schedulerHeuristics()
+                                      ->heuristicsList()
+                                      .at(0)
+                                      ->pointwiseParams();
+  EXPECT_EQ(params.break_point, 0);
+  EXPECT_GT(params.grid_stride_blocks, 0);
+  EXPECT_TRUE(params.grid_stride_prefetch);
+  testValidate(fec.fusion(), cg_outputs, {t0, t1}, __LINE__, __FILE__);
+}
+
 } // namespace nvfuser
@@ -12,6 +12,7 @@
 #include <ir/all_nodes.h>
 #include <ir/utils.h>
 #include <ops/all_ops.h>
+#include <preseg_passes/consecutive_reshape.h>
 #include <preseg_passes/optimization_pass.h>
 #include <preseg_passes/pre_segmenter.h>
 #include <tests/cpp/utils.h>
@@ -674,4 +675,54 @@ TEST_F(PresegTest, ExtentSubstitution) {
   testValidate(
       executor_cache.fusion(), cg_outputs, {t0, t1}, __LINE__, __FILE__);
 }
+
+TEST_F(PresegTest, ConsecutiveReshapes) {
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+  auto tv0 = makeContigConcreteTensor({2, 3, 4});
+  fusion->addInput(tv0);
+  // A chain of permutes composed into {2, 1, 0}
+  auto tv1 = permute(tv0, {1, 0, 2});
+  auto tv2 = permute(tv1, {2, 1, 0});
+  auto tv3 = permute(tv2, {0, 2, 1});
+  fusion->addOutput(tv3);
+  // A chain of reshapes going back to the input shape, i.e. an identity
+  auto tv4 = reshape(tv0, {2, 3, 4}, {6, 4});
+  auto tv5 = reshape(tv4, {6, 4}, {6, 1, 4});
+  auto tv6 = reshape(tv5, {6, 1, 4}, {2, 3, 4});
+  auto tv7 = add(tv6, tv0);
+  fusion->addOutput(tv7);
+  // A chain of reshapes composed into a single ViewOp
+  auto tv8 = reshape(tv0, {2, 3, 4}, {6, 4});
+  auto tv9 = reshape(tv8, {6, 4}, {24});
+  fusion->addOutput(tv9);
+
+  Fusion fusion_copy = *fusion;
+  OptimizationPass<ConsecutiveReshapePass>::runPass(fusion.get());
+
+  auto count_ops = [&](auto is_op) {
+    auto exprs = fusion->exprs();
+    return std::count_if(exprs.begin(), exprs.end(), is_op);
+  };
+  EXPECT_EQ(count_ops([](Expr* e) { return e->isA<LoadStoreOp>(); }), 1);
+  EXPECT_EQ(count_ops([](Expr* e) { return e->isA<ViewOp>(); }), 1);
+  EXPECT_EQ(
+      count_ops([](Expr* e) {
+        return e->isA<SqueezeOp>() || e->isA<BroadcastOp>();
+      }),
+      0);
+  auto* permuted = fusion->outputs().at(0)->as<TensorView>();
+  EXPECT_EQ(
+      ir_utils::computePermutation(
+          permuted->getRootDomain(), permuted->getLogicalDomain()),
+      std::vector<int64_t>({2, 1, 0}));
+  EXPECT_EQ(fusion->outputs().at(1)->definition()->input(0), tv0);
+  EXPECT_EQ(fusion->outputs().at(1)->definition()->input(1), tv0);
+
+  auto options = at::TensorOptions().device(at::kCUDA, 0);
+  auto t0 = at::randn({2, 3, 4}, options);
+  FusionExecutorCache executor_cache(std::move(fusion));
+  auto cg_outputs = executor_cache.runFusionWithInputs({t0});
+  testValidate(&fusion_copy, cg_outputs, {t0}, __LINE__, __FILE__);
+}
 } // namespace nvfuser::preseg_passes
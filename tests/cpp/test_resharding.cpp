@@ -352,6 +352,37 @@ TEST_F(ReshardingTest, InsertResharding_After) {
   EXPECT_THAT(getTvsWithDifferentSharding(a, tvs), ::testing::IsEmpty());
 }
 
+TEST_F(ReshardingTest, InsertResharding_BeforeUpcast) {
+  Fusion fusion;
+  FusionGuard fg(&fusion);
+
+  TensorView* a = makeContigConcreteTensor({4, 8}, DataType::Half);
+  TensorView* b = castOp(DataType::Float, a);
+  fusion.addInput(a);
+  fusion.addOutput(b);
+
+  DeviceMesh mesh0({0, 1});
+  DeviceMesh mesh1({2});
+  a->setDeviceMesh(mesh0);
+  b->setDeviceMesh(mesh1);
+
+  a->axis(0)->parallelize(ParallelType::DIDx);
+
+  preseg_passes::OptimizationPass<
+      preseg_passes::InsertReshardingsPass>::runPass(&fusion);
+
+  // Resharding the half-precision input moves half as many bytes as
+  // resharding the output.
+  b = fusion.outputs()[0]->as<TensorView>();
+  Expr* cast = b->definition();
+  EXPECT_TRUE(cast->isA<UnaryOp>());
+  EXPECT_FALSE(isResharding(cast));
+  Expr* resharding = cast->input(0)->definition();
+  ASSERT_NE(resharding, nullptr);
+  EXPECT_TRUE(resharding->isA<LoadStoreOp>());
+  EXPECT_EQ(resharding->input(0), a);
+}
+
 TEST_F(ReshardingTest, InsertShardedAxisReordering) {
   Fusion fusion;
   FusionGuard fg(&fusion);
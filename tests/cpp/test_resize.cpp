@@ -3677,4 +3677,30 @@ TEST_F(ResizeTest, Chunk_Uneven) {
   EXPECT_EQ(out_tensors.back().numel(), 1);
 }
 
+// The pads of the inputs of a cat are not lowered when they are inlined into
+// the CatOp. See Note [Pads of CatOp inputs].
+TEST_F(ResizeTest, CatWithoutPadPredicates) {
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+
+  TensorView* tv0 = makeContigTensor(2);
+  TensorView* tv1 = makeContigTensor(2);
+  fusion->addInput(tv0);
+  fusion->addInput(tv1);
+  fusion->addOutput(cat({tv0, tv1}, 1));
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor t0 = at::randn({1024, 64}, options);
+  at::Tensor t1 = at::randn({1024, 32}, options);
+
+  FusionExecutorCache fec(std::move(fusion));
+  auto cg_outputs = fec.runFusionWithInputs({t0, t1});
+  testValidate(fec.fusion(), cg_outputs, {t0, t1}, __LINE__, __FILE__);
+
+  // The pads would be lowered to where ops, printed with ?:
+  const std::string& code =
+      fec.getMostRecentKernelRuntime()->executors().at(0).kernelString();
+  EXPECT_EQ(code.find(" ? "), std::string::npos) << code;
+}
+
 } // namespace nvfuser
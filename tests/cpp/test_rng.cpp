@@ -10,9 +10,11 @@
 #include <gtest/gtest.h>
 
 #include <fusion.h>
+#include <inlining.h>
 #include <ir/all_nodes.h>
 #include <kernel_cache.h>
 #include <ops/all_ops.h>
+#include <options.h>
 #include <scheduler/all_schedulers.h>
 #include <tests/cpp/rng_helper.h>
 #include <tests/cpp/utils.h>
@@ -547,4 +549,53 @@ TEST_F(RNGTest, DifferentOffsets) {
   }
 }
 
+// Elements of each thread are numbered consecutively with
+// NVFUSER_ENABLE=fast_rng even when they are strided in the tensor
+TEST_F(RNGTest, FastRng) {
+  EnableOptionsGuard opt_guard;
+  EnableOptionsGuard::getCurOptions().set(EnableOption::FastRng);
+
+  int64_t size = 4096;
+  std::unique_ptr<Fusion> fusion_ptr = std::make_unique<Fusion>();
+  auto fusion = fusion_ptr.get();
+  FusionGuard fg(fusion);
+
+  TensorView* tv0 = makeSymbolicTensor(1);
+  fusion->addInput(tv0);
+  auto tv1 = rand_like(tv0);
+  auto tv2 = rand_like(tv0);
+  auto tv3 = add(tv1, tv2);
+  fusion->addOutput(tv1);
+  fusion->addOutput(tv3);
+
+  // [I/128, 128(TIDx)]
+  tv3->split(0, 128);
+  tv3->axis(1)->parallelize(ParallelType::TIDx);
+  TransformPropagatorWithCheck propagator(tv3);
+  MaxLogicalDomainInfoSpanningTree(tv3).traverse(&propagator);
+  scheduler_utils::parallelizeAllLike(tv3);
+  inlineMost();
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor t0 = at::zeros({size}, options);
+
+  FusionExecutor fe;
+  fe.compileFusion(fusion, {t0});
+  EXPECT_NE(fe.kernelString().find("fast_philox("), std::string::npos)
+      << fe.kernelString();
+
+  at::manual_seed(0);
+  auto cg_outputs = fe.runFusion({t0});
+  at::manual_seed(0);
+  auto cg_outputs2 = fe.runFusion({t0});
+
+  auto out = cg_outputs[0];
+  EXPECT_TRUE(out.equal(cg_outputs2[0]));
+  EXPECT_TRUE(cg_outputs[1].equal(cg_outputs2[1]));
+  EXPECT_TRUE(out.gt(0.0f).all().item<bool>());
+  EXPECT_TRUE(out.le(1.0f).all().item<bool>());
+  EXPECT_EQ(std::get<0>(at::_unique(out)).numel(), size);
+  EXPECT_NEAR(out.mean().item<double>(), 0.5, 0.05);
+}
+
 } // namespace nvfuser
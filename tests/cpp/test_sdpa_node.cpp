@@ -1022,4 +1022,62 @@ TEST_F(SDPATest, ComputeAt) {
   validateSdpaFwdOutputs(nvf_out, aten_out);
 }
 
+TEST_F(SDPATest, DecomposedCausalAttn) {
+  NVFUSER_TEST_CUDA_ARCH_GUARD(8, 0);
+  EnableOptionsGuard opt_guard;
+  EnableOptionsGuard::getCurOptions().set(EnableOption::DecomposeSdpa);
+
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+  std::vector<int64_t> q_shape({n, h, l, e});
+  std::vector<int64_t> kv_shape({n, h, s, e});
+
+  auto tvq = makeConcreteTensor(q_shape, DataType::Half);
+  auto tvk = makeConcreteTensor(kv_shape, DataType::Half);
+  auto tvv = makeConcreteTensor(kv_shape, DataType::Half);
+
+  fusion->addInput(tvq);
+  fusion->addInput(tvk);
+  fusion->addInput(tvv);
+
+  // A prologue that can be fused with the softmax once decomposed
+  auto tvq_scaled = castOp(
+      DataType::Half,
+      mul(castOp(DataType::Float, tvq), IrBuilder::create<Val>(2.0)));
+  auto output = sdpfa_fwd(
+      tvq_scaled,
+      tvk,
+      tvv,
+      /*dropout_p=*/IrBuilder::create<Val>(0.0),
+      /*is_causal=*/IrBuilder::create<Val>(true),
+      /*scale=*/nullptr);
+  fusion->addOutput(output.output);
+  fusion->addOutput(output.log_sumexp);
+
+  auto options = at::TensorOptions().dtype(at::kHalf).device(at::kCUDA, 0);
+  at::Tensor q = at::randn(q_shape, options);
+  at::Tensor k = at::randn(kv_shape, options);
+  at::Tensor v = at::randn(kv_shape, options);
+
+  double scale = 1.0 / std::sqrt(e);
+  auto aten_out = at::_scaled_dot_product_flash_attention(
+      q * 2.0,
+      k,
+      v,
+      /*dropout_p=*/0.0,
+      /*is_causal=*/true,
+      /*return_debug_mask=*/false,
+      scale);
+
+  FusionExecutorCache fec(std::move(fusion));
+  auto nvf_out = fec.runFusionWithInputs({q, k, v});
+
+  FusionKernelRuntime* runtime = fec.getMostRecentKernelRuntime();
+  EXPECT_FALSE(ir_utils::hasOpsOfType<SdpaFwdOp>(
+      runtime->fusionSegments()->completeFusion()));
+  // The decomposition materializes the probabilities in half precision
+  EXPECT_TRUE(at::allclose(nvf_out[0], std::get<0>(aten_out), 1e-2, 1e-2));
+  EXPECT_TRUE(at::allclose(nvf_out[1], std::get<1>(aten_out), 1e-3, 1e-3));
+}
+
 } // namespace nvfuser
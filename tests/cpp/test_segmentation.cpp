@@ -12,6 +12,9 @@
 #include <ops/all_ops.h>
 #include <preseg_passes/mark_aliases_prepare.h>
 #include <preseg_passes/optimization_pass.h>
+#include <recompute_planner.h>
+#include <scheduler/registry.h>
+#include <segmentation_cost_model.h>
 #include <tests/cpp/utils.h>
 #include <tests/cpp/validator.h>
 
@@ -729,4 +732,341 @@ TEST_F(SegmentationTest, ForwardInputsToSegmenterSetIssue2658) {
   testValidate(fec.fusion(), out_tensors, {in_tensor}, __LINE__, __FILE__);
 }
 
+namespace {
+
+// Predicts the squared number of exprs of a segment, so that a merged group
+// is always slower than its two groups
+class NeverMergeCostModel : public SegmentationCostModel {
+ public:
+  double predictTimeUs(
+      Fusion* segment,
+      ScheduleHeuristic heuristic,
+      SchedulerRuntimeInfo& runtime_info) override {
+    const auto num_exprs = (double)segment->exprs().size();
+    return num_exprs * num_exprs;
+  }
+};
+
+} // namespace
+
+TEST_F(SegmentationTest, CostModelRejectsMerge) {
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+
+  TensorView* in = makeContigTensor(2);
+  TensorView* bias = makeContigTensor(1);
+  fusion->addInput(in);
+  fusion->addInput(bias);
+  TensorView* out = sum(in, {1});
+  out = add(out, bias);
+  out = sum(out, {0});
+  fusion->addOutput(out);
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor in_tensor = at::randn({128, 256}, options);
+  at::Tensor bias_tensor = at::randn({128}, options);
+
+  NeverMergeCostModel model;
+  SegmentationCostModelGuard guard(&model);
+  FusionExecutorCache fec(std::move(fusion));
+  std::vector<at::Tensor> out_tensors =
+      fec.runFusionWithInputs({in_tensor, bias_tensor});
+  testValidate(
+      fec.fusion(),
+      out_tensors,
+      {in_tensor, bias_tensor},
+      __LINE__,
+      __FILE__);
+
+  // Without the cost model, the add is fused into one of the two reductions
+  FusionKernelRuntime* runtime = fec.getMostRecentKernelRuntime();
+  EXPECT_EQ(runtime->fusionSegments()->groups().size(), 3);
+}
+
+TEST_F(SegmentationTest, ProfileGuidedCostModel) {
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+
+  TensorView* in = makeContigTensor(2);
+  fusion->addInput(in);
+  TensorView* out = sum(in, {1});
+  fusion->addOutput(out);
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor in_tensor = at::randn({128, 256}, options);
+  SchedulerRuntimeInfo runtime_info(fusion.get(), {in_tensor});
+
+  ProfileGuidedCostModel model;
+  const double analytic_time_us = model.predictTimeUs(
+      fusion.get(), ScheduleHeuristic::Reduction, runtime_info);
+  EXPECT_GT(analytic_time_us, 0.0);
+
+  model.recordTimeUs(
+      segmentCostKey(
+          segmentStructureHash(fusion.get()),
+          ScheduleHeuristic::Reduction,
+          {{128, 256}},
+          {{128}}),
+      1234.0);
+  EXPECT_EQ(model.size(), 1);
+  EXPECT_EQ(
+      model.predictTimeUs(
+          fusion.get(), ScheduleHeuristic::Reduction, runtime_info),
+      1234.0);
+  // The measured time is only used for the same heuristic
+  EXPECT_EQ(
+      model.predictTimeUs(
+          fusion.get(), ScheduleHeuristic::InnerPersistent, runtime_info),
+      AnalyticCostModel().predictTimeUs(
+          fusion.get(), ScheduleHeuristic::InnerPersistent, runtime_info));
+}
+
+TEST_F(SegmentationTest, HorizontalFusionOfIndependentPointwise) {
+  EnableOptionsGuard opt_guard;
+  EnableOptionsGuard::getCurOptions().set(EnableOption::HorizontalFusion);
+
+  auto fusion_ptr = std::make_unique<Fusion>();
+  Fusion& fusion = *fusion_ptr.get();
+  FusionGuard fg(&fusion);
+
+  TensorView* in_0 = makeSymbolicTensor(2);
+  TensorView* in_1 = makeSymbolicTensor(1);
+  fusion.addInput(in_0);
+  fusion.addInput(in_1);
+  TensorView* out_0 = add(in_0, IrBuilder::create<Val>(1.f));
+  TensorView* out_1 = mul(in_1, IrBuilder::create<Val>(2.f));
+  fusion.addOutput(out_0);
+  fusion.addOutput(out_1);
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor at_in_0 = at::randn({10, 20}, options);
+  at::Tensor at_in_1 = at::randn({1000}, options);
+  std::vector<c10::IValue> aten_inputs = {at_in_0, at_in_1};
+
+  FusionExecutorCache fec(std::move(fusion_ptr));
+  auto outputs = fec.runFusionWithInputs(aten_inputs);
+
+  FusionKernelRuntime* runtime = fec.getMostRecentKernelRuntime();
+  EXPECT_FALSE(runtime->isSegmented());
+  EXPECT_EQ(
+      runtime->schedulerHeuristics()->heuristicsList().at(0)->heuristic(),
+      ScheduleHeuristic::PointWise);
+
+  testValidate(fec.fusion(), outputs, aten_inputs, __LINE__, __FILE__);
+}
+
+TEST_F(SegmentationTest, HorizontalMergeOfPointwiseSegments) {
+  auto fusion_ptr = std::make_unique<Fusion>();
+  Fusion& fusion = *fusion_ptr.get();
+  FusionGuard fg(&fusion);
+
+  TensorView* in_0 = makeSymbolicTensor(2);
+  TensorView* in_1 = makeSymbolicTensor(1);
+  TensorView* in_2 = makeSymbolicTensor(2);
+  fusion.addInput(in_0);
+  fusion.addInput(in_1);
+  fusion.addInput(in_2);
+  fusion.addOutput(sum(in_0, {1}));
+  fusion.addOutput(add(in_1, IrBuilder::create<Val>(1.f)));
+  fusion.addOutput(mul(in_2, in_2));
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  std::vector<c10::IValue> aten_inputs = {
+      at::randn({128, 64}, options),
+      at::randn({1000}, options),
+      at::randn({7, 33}, options)};
+
+  {
+    FusionExecutorCache fec(std::make_unique<Fusion>(fusion));
+    fec.runFusionWithInputs(aten_inputs);
+    EXPECT_THAT(
+        fec.getMostRecentKernelRuntime()->fusionSegments()->groups(),
+        SizeIs(3));
+  }
+
+  EnableOptionsGuard opt_guard;
+  EnableOptionsGuard::getCurOptions().set(EnableOption::HorizontalFusion);
+  FusionExecutorCache fec(std::move(fusion_ptr));
+  auto outputs = fec.runFusionWithInputs(aten_inputs);
+
+  // The reduction stays alone, and both pointwise segments are merged
+  FusionKernelRuntime* runtime = fec.getMostRecentKernelRuntime();
+  EXPECT_THAT(runtime->fusionSegments()->groups(), SizeIs(2));
+
+  testValidate(fec.fusion(), outputs, aten_inputs, __LINE__, __FILE__);
+}
+
+
+// With EnableOption::SegmentRecomputation, a segment reading a cheap pointwise
+// function of a fusion input recomputes it instead
+TEST_F(SegmentationTest, RecomputeCheapEdges) {
+  auto fusion_ptr = std::make_unique<Fusion>();
+  Fusion& fusion = *fusion_ptr.get();
+  FusionGuard fg(&fusion);
+
+  TensorView* in = makeSymbolicTensor(2);
+  fusion.addInput(in);
+  TensorView* scaled = mul(in, IrBuilder::create<Val>(2.f));
+  fusion.addOutput(sum(scaled, {0}));
+  fusion.addOutput(sum(scaled, {1}));
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  std::vector<c10::IValue> aten_inputs = {at::randn({128, 64}, options)};
+
+  // The number of segment inputs that are not fusion inputs
+  auto num_intermediate_inputs = [](FusionKernelRuntime* runtime) {
+    int64_t num = 0;
+    for (SegmentedGroup* group : runtime->fusionSegments()->groups()) {
+      num += std::count_if(
+          group->inputs().begin(), group->inputs().end(), [](Val* v) {
+            return v->isA<TensorView>() && !v->isFusionInput();
+          });
+    }
+    return num;
+  };
+
+  int64_t num_without_recomputation = 0;
+  {
+    FusionExecutorCache fec(std::make_unique<Fusion>(fusion));
+    fec.runFusionWithInputs(aten_inputs);
+    num_without_recomputation =
+        num_intermediate_inputs(fec.getMostRecentKernelRuntime());
+  }
+  ASSERT_GT(num_without_recomputation, 0);
+
+  EnableOptionsGuard opt_guard;
+  EnableOptionsGuard::getCurOptions().set(EnableOption::SegmentRecomputation);
+  FusionExecutorCache fec(std::move(fusion_ptr));
+  auto outputs = fec.runFusionWithInputs(aten_inputs);
+
+  EXPECT_LT(
+      num_intermediate_inputs(fec.getMostRecentKernelRuntime()),
+      num_without_recomputation);
+
+  testValidate(fec.fusion(), outputs, aten_inputs, __LINE__, __FILE__);
+}
+
+// The backward fusion of y = tanh(x) * sum(x, 1) recomputes the cheap tanh
+// and reads the saved sum
+TEST_F(SegmentationTest, PlanRecomputation) {
+  Fusion joint;
+  FusionGuard fg(&joint);
+
+  TensorView* x = makeSymbolicTensor(2);
+  TensorView* grad = makeSymbolicTensor(2);
+  joint.addInput(x);
+  joint.addInput(grad);
+  TensorView* t = tanh(x);
+  TensorView* s = broadcast(sum(x, {1}), {false, true});
+  TensorView* y = mul(t, s);
+  // dx without the gradient flowing through the sum
+  TensorView* dx =
+      mul(mul(grad, sub(IrBuilder::create<Val>(1.0), mul(t, t))), s);
+  joint.addOutput(y);
+  joint.addOutput(dx);
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor x_tensor = at::randn({128, 1024}, options);
+  at::Tensor grad_tensor = at::randn({128, 1024}, options);
+
+  RecomputationPlan plan = planRecomputation(
+      &joint,
+      /*num_forward_inputs=*/1,
+      /*num_forward_outputs=*/1,
+      {x_tensor, grad_tensor});
+  EXPECT_THAT(plan.saved, testing::ElementsAre(s));
+  EXPECT_THAT(plan.recomputed, testing::ElementsAre(t));
+  EXPECT_EQ(plan.saved_bytes, 128 * 4);
+
+  ForwardBackwardFusions fusions = splitForwardBackward(
+      &joint, /*num_forward_inputs=*/1, /*num_forward_outputs=*/1, plan);
+  FusionExecutorCache forward_fec(std::move(fusions.forward));
+  std::vector<at::Tensor> forward_outputs =
+      forward_fec.runFusionWithInputs({x_tensor});
+  ASSERT_EQ(forward_outputs.size(), 2);
+
+  FusionExecutorCache backward_fec(std::move(fusions.backward));
+  std::vector<at::Tensor> backward_outputs = backward_fec.runFusionWithInputs(
+      {x_tensor, forward_outputs[0], forward_outputs[1], grad_tensor});
+
+  at::Tensor t_ref = x_tensor.tanh();
+  at::Tensor s_ref = x_tensor.sum({1}, /*keepdim=*/true);
+  EXPECT_TRUE(at::allclose(forward_outputs[0], t_ref * s_ref));
+  EXPECT_TRUE(at::allclose(
+      backward_outputs[0],
+      grad_tensor * (1.0 - t_ref * t_ref) * s_ref,
+      /*rtol=*/1e-4,
+      /*atol=*/1e-4));
+}
+
+// split_reduction(N) replaces each reduction by a partial and a final
+// reduction segment. The extents aren't multiples of N.
+TEST_F(SegmentationTest, SplitReduction) {
+  auto fusion_ptr = std::make_unique<Fusion>();
+  Fusion& fusion = *fusion_ptr.get();
+  FusionGuard fg(&fusion);
+
+  TensorView* in = makeSymbolicTensor(2);
+  fusion.addInput(in);
+  TensorView* out = sum(in, {1});
+  fusion.addOutput(out);
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  std::vector<c10::IValue> aten_inputs = {at::randn({4, 100003}, options)};
+
+  EnableOptionsGuard opt_guard;
+  EnableOptionsGuard::getCurOptions().set(
+      EnableOption::SplitReduction, {"8"});
+  FusionExecutorCache fec(std::move(fusion_ptr));
+  auto outputs = fec.runFusionWithInputs(aten_inputs);
+
+  FusionKernelRuntime* runtime = fec.getMostRecentKernelRuntime();
+  ASSERT_TRUE(runtime->isSegmented());
+  const auto& groups = runtime->fusionSegments()->groups();
+  EXPECT_EQ(groups.size(), 2);
+  for (SegmentedGroup* group : groups) {
+    EXPECT_EQ(group->heuristic(), ScheduleHeuristic::Reduction);
+  }
+  testValidate(fec.fusion(), outputs, aten_inputs, __LINE__, __FILE__);
+
+  aten_inputs = {at::randn({4, 77777}, options)};
+  outputs = fec.runFusionWithInputs(aten_inputs);
+  testValidate(fec.fusion(), outputs, aten_inputs, __LINE__, __FILE__);
+}
+
+
+TEST_F(SegmentationTest, HostIrRuntime) {
+  auto fusion_ptr = std::make_unique<Fusion>();
+  Fusion& fusion = *fusion_ptr.get();
+  FusionGuard fg(&fusion);
+
+  TensorView* in = makeSymbolicTensor(2);
+  fusion.addInput(in);
+  TensorView* tv1 = exp(in);
+  TensorView* tv2 = segment_set(tv1);
+  TensorView* tv3 = sum(tv2, {1});
+  TensorView* tv4 = add(tv3, IrBuilder::create<Val>(1.0));
+  TensorView* tv5 = segment_set(tv4);
+  TensorView* out = mul(tv5, tv5);
+  fusion.addOutput(tv1);
+  fusion.addOutput(out);
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  std::vector<c10::IValue> aten_inputs = {at::randn({128, 1024}, options)};
+
+  EnableOptionsGuard opt_guard;
+  EnableOptionsGuard::getCurOptions().set(EnableOption::HostIrRuntime);
+  FusionExecutorCache fec(std::move(fusion_ptr));
+  // The first run compiles the segments and the next ones reuse the program
+  for ([[maybe_unused]] auto i : c10::irange(2)) {
+    auto outputs = fec.runFusionWithInputs(aten_inputs);
+    EXPECT_TRUE(fec.getMostRecentKernelRuntime()->isSegmented());
+    testValidate(fec.fusion(), outputs, aten_inputs, __LINE__, __FILE__);
+  }
+
+  aten_inputs = {at::randn({64, 333}, options)};
+  auto outputs = fec.runFusionWithInputs(aten_inputs);
+  testValidate(fec.fusion(), outputs, aten_inputs, __LINE__, __FILE__);
+}
+
 } // namespace nvfuser
@@ -16,6 +16,7 @@
 #include <ir/utils.h>
 #include <kernel_cache.h>
 #include <ops/all_ops.h>
+#include <options.h>
 #include <scheduler/utils.h>
 #include <tests/cpp/utils.h>
 #include <tests/cpp/validator.h>
@@ -687,4 +688,73 @@ TEST_F(SmemReuseTest, ExpandInterferes) {
   testExpand(false);
 }
 
+// The stack allocator places a buffer on top of the highest live one. Here
+// the long-lived buffer B is pushed above A, which keeps D from reusing A
+// after A is released:
+//
+//   A: a ------- c *
+//   E:   ---- *
+//   B:        b ---------------- e
+//   D:                 d ---- *
+//
+// where * indicates an expression that synchronizes each thread block. The
+// interval planner places D at the address of A.
+TEST_F(SmemReuseTest, IntervalPlanner) {
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+
+  const int64_t N = 64, M = 8;
+  auto full_of = [&](int64_t size) {
+    return full(
+        {IrBuilder::create<Val>(size)}, fusion->oneVal(), DataType::Float);
+  };
+
+  auto tva = full_of(N); // pos = a. A = tva
+  tva->setMemoryType(MemoryType::Shared);
+  auto tv1 = sum(tva, {0});
+  auto tve = add(full_of(M), broadcast(tv1, {true})); // E = tve
+  tve->setMemoryType(MemoryType::Shared);
+  auto tv3 = sum(tve, {0}); // first sync
+  auto tvb = add(full_of(M), broadcast(tv3, {true})); // pos = b. B = tvb
+  tvb->setMemoryType(MemoryType::Shared);
+  auto tv5 = sum(tvb, {0});
+  auto tv6 = add(tva, broadcast(tv5, {true})); // pos = c. Last read of A
+  auto tv7 = sum(tv6, {0}); // second sync
+  auto tvd = add(full_of(N), broadcast(tv7, {true})); // pos = d. D = tvd
+  tvd->setMemoryType(MemoryType::Shared);
+  auto tv9 = sum(tvd, {0}); // third sync
+  auto tv10 = add(tvb, broadcast(tv9, {true})); // pos = e. Last read of B
+  fusion->addOutput(tv10);
+
+  for (auto tv : {tv3, tv7, tv9}) {
+    tv->axis(0)->parallelize(ParallelType::TIDx);
+  }
+
+  auto smem_usage = [&]() {
+    GpuLower gpulw(fusion.get());
+    ExpressionEvaluator ee;
+    int64_t usage = 0;
+    for (auto alloc : gpulw.run()->summary().dynamic_smem_allocations) {
+      EXPECT_NE(alloc->address(), nullptr);
+      auto addr = ee.evaluate(alloc->address()).as<int64_t>();
+      auto size = ee.evaluate(alloc->size()).as<int64_t>() *
+          dataTypeSize(alloc->buffer()->dtype());
+      usage = std::max(usage, addr + size);
+    }
+    return usage;
+  };
+
+  const int64_t stack_usage = smem_usage();
+  EXPECT_EQ(stack_usage, alignInt(N * 4) + alignInt(M * 4) + N * 4);
+
+  EnableOptionsGuard opt_guard;
+  EnableOptionsGuard::getCurOptions().set(EnableOption::SmemPlanner);
+  EXPECT_EQ(smem_usage(), N * 4 + M * 4);
+
+  FusionExecutor fe;
+  fe.compileFusion(fusion.get());
+  auto cg_outputs = fe.runFusion({});
+  testValidate(fusion.get(), cg_outputs, {}, __LINE__, __FILE__);
+}
+
 } // namespace nvfuser
@@ -0,0 +1,151 @@
+// clang-format off
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024-present NVIDIA CORPORATION & AFFILIATES.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+// clang-format on
+
+#include <gmock/gmock-matchers.h>
+#include <gtest/gtest.h>
+
+#include <thread_pool.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace nvfuser {
+
+using testing::ElementsAre;
+
+TEST(ThreadPoolTest, WaitsForItsGroupOnly) {
+  ThreadPool pool(2);
+  std::promise<void> release;
+  std::shared_future<void> released = release.get_future().share();
+  TaskGroup blocked(TaskPriority::Normal, &pool);
+  blocked.run([released]() { released.wait(); });
+
+  std::atomic<int64_t> num_done{0};
+  TaskGroup group(TaskPriority::Normal, &pool);
+  for (int64_t i = 0; i < 8; i++) {
+    group.run([&num_done]() { num_done++; });
+  }
+  group.wait();
+  EXPECT_EQ(num_done.load(), 8);
+
+  release.set_value();
+  blocked.wait();
+}
+
+TEST(ThreadPoolTest, RethrowsError) {
+  ThreadPool pool(2);
+  std::atomic<int64_t> num_done{0};
+  TaskGroup group(TaskPriority::Normal, &pool);
+  group.run([]() { throw std::runtime_error("task failed"); });
+  for (int64_t i = 0; i < 4; i++) {
+    group.run([&num_done]() { num_done++; });
+  }
+  EXPECT_THROW(group.wait(), std::runtime_error);
+  // The other tasks of the group still ran
+  EXPECT_EQ(num_done.load(), 4);
+
+  // The error is only reported once
+  group.run([&num_done]() { num_done++; });
+  EXPECT_NO_THROW(group.wait());
+  EXPECT_EQ(num_done.load(), 5);
+}
+
+TEST(ThreadPoolTest, NestedWait) {
+  // Every worker waits for a nested group, which only finishes because the
+  // waiting tasks run the nested tasks themselves
+  ThreadPool pool(1);
+  std::atomic<int64_t> num_done{0};
+  TaskGroup outer(TaskPriority::Normal, &pool);
+  for (int64_t i = 0; i < 4; i++) {
+    outer.run([&pool, &num_done]() {
+      TaskGroup inner(TaskPriority::Normal, &pool);
+      for (int64_t j = 0; j < 4; j++) {
+        inner.run([&num_done]() { num_done++; });
+      }
+      inner.wait();
+    });
+  }
+  outer.wait();
+  EXPECT_EQ(num_done.load(), 16);
+}
+
+TEST(ThreadPoolTest, Priority) {
+  ThreadPool pool(1);
+  std::promise<void> release;
+  std::shared_future<void> released = release.get_future().share();
+  TaskGroup blocked(TaskPriority::Normal, &pool);
+  blocked.run([released]() { released.wait(); });
+
+  std::mutex mutex;
+  std::vector<TaskPriority> order;
+  auto record = [&](TaskPriority priority) {
+    std::lock_guard<std::mutex> lock(mutex);
+    order.push_back(priority);
+  };
+  TaskGroup background(TaskPriority::Background, &pool);
+  TaskGroup normal(TaskPriority::Normal, &pool);
+  TaskGroup latency(TaskPriority::Latency, &pool);
+  background.run([&]() { record(TaskPriority::Background); });
+  normal.run([&]() { record(TaskPriority::Normal); });
+  latency.run([&]() { record(TaskPriority::Latency); });
+
+  // Let the worker pick the tasks instead of running them in wait()
+  release.set_value();
+  while (true) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (order.size() == 3) {
+        break;
+      }
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_THAT(
+      order,
+      ElementsAre(
+          TaskPriority::Latency,
+          TaskPriority::Normal,
+          TaskPriority::Background));
+  blocked.wait();
+}
+
+TEST(ThreadPoolTest, Resize) {
+  ThreadPool pool(2);
+  EXPECT_EQ(pool.size(), 2);
+
+  std::atomic<int64_t> num_done{0};
+  TaskGroup group(TaskPriority::Normal, &pool);
+  for (int64_t i = 0; i < 8; i++) {
+    group.run([&num_done]() { num_done++; });
+  }
+  pool.resize(4);
+  EXPECT_EQ(pool.size(), 4);
+  group.wait();
+  EXPECT_EQ(num_done.load(), 8);
+
+  // Blocks on the future rather than wait(), so that a worker runs the task
+  std::promise<bool> threw;
+  group.run([&]() {
+    try {
+      pool.resize(1);
+      threw.set_value(false);
+    } catch (const nvfError&) {
+      threw.set_value(true);
+    }
+  });
+  EXPECT_TRUE(threw.get_future().get());
+  group.wait();
+  EXPECT_EQ(pool.size(), 4);
+}
+
+} // namespace nvfuser
@@ -1693,6 +1693,75 @@ class TestNvFuserFrontend(NVFuserTest):
         fc = FusionCache.get()
         fc.reset()
 
+    def test_host_times(self):
+        inputs = [torch.randn(4, device="cuda")]
+
+        def fusion_func(fd: FusionDefinition):
+            t0 = fd.from_pytorch(inputs[0])
+            t1 = fd.ops.sub(fd.ops.reciprocal(t0), fd.define_scalar(3.0))
+            fd.add_output(t1)
+
+        FusionCache.get().host_times(reset=True)
+        nvf_out, _ = self.exec_nvfuser(fusion_func, inputs)
+        self.assertEqual(1.0 / inputs[0] - 3.0, nvf_out[0])
+
+        host_times = FusionCache.get().host_times(reset=True)
+        self.assertGreater(host_times["definitions"], 0)
+        self.assertGreater(host_times["executions"], 0)
+        for layer in ["input_conversion", "execute", "output_wrapping"]:
+            self.assertGreater(host_times[f"{layer}_time_ns"], 0)
+        self.assertIn("Host Time per Call", FusionCache.get().stats())
+
+        host_times = FusionCache.get().host_times()
+        self.assertEqual(host_times["executions"], 0)
+
+    def test_fusion_deduplication(self):
+        inputs = [torch.randn(8, 32, device="cuda")]
+
+        # The ops are recorded in different orders, so the definitions reach
+        # different terminal nodes of the trie but build the same fusion
+        def fusion_func_1(fd: FusionDefinition):
+            t0 = fd.from_pytorch(inputs[0])
+            t1 = fd.ops.relu(t0)
+            t2 = fd.ops.neg(t0)
+            fd.add_output(fd.ops.add(t1, t2))
+
+        def fusion_func_2(fd: FusionDefinition):
+            t0 = fd.from_pytorch(inputs[0])
+            t2 = fd.ops.neg(t0)
+            t1 = fd.ops.relu(t0)
+            fd.add_output(fd.ops.add(t1, t2))
+
+        FusionCache.reset()
+        nvf_out_1, fd_1 = self.exec_nvfuser(fusion_func_1, inputs)
+        nvf_out_2, fd_2 = self.exec_nvfuser(fusion_func_2, inputs)
+        self.assertNotEqual(fd_1.id(), fd_2.id())
+        expected = torch.relu(inputs[0]) - inputs[0]
+        self.assertEqual(expected, nvf_out_1[0])
+        self.assertEqual(expected, nvf_out_2[0])
+        self.assertRegex(
+            FusionCache.get().stats(),
+            "Fusions Sharing the Executor of an Identical Fusion: [1-9]",
+        )
+
+    def test_resource_usage(self):
+        inputs = [torch.randn(128, 1024, device="cuda")]
+
+        def fusion_func(fd: FusionDefinition):
+            t0 = fd.from_pytorch(inputs[0])
+            t1 = fd.ops.sum(t0, dims=[1], keepdim=True)
+            t2 = fd.ops.sub(t0, t1)
+            fd.add_output(t2)
+
+        _, fd = self.exec_nvfuser(fusion_func, inputs)
+        kernels = fd.resource_usage()
+        self.assertGreater(len(kernels), 0)
+        for kernel in kernels:
+            self.assertGreater(kernel["registers_per_thread"], 0)
+            self.assertGreaterEqual(kernel["max_active_blocks_per_sm"], 1)
+            self.assertGreater(kernel["theoretical_occupancy"], 0.0)
+            self.assertLessEqual(kernel["theoretical_occupancy"], 1.0)
+
     def test_pad(self):
         inputs = [
             torch.testing.make_tensor((1, 2, 3), dtype=torch.float32, device="cuda"),
@@ -4222,6 +4291,25 @@ class TestNvFuserFrontend(NVFuserTest):
         for i in range(num_out):
             self.assertEqual(nvf_out[i].data_ptr(), inputs[0].data_ptr())
 
+    def test_execute_async(self):
+        inputs = [torch.randn((4, 8), dtype=torch.float32, device="cuda:0")]
+
+        with FusionDefinition() as fd:
+            T0 = fd.from_pytorch(inputs[0])
+            T1 = fd.ops.sum(T0, dims=[1], keepdim=True)
+            T2 = fd.ops.add(T0, T1)
+            fd.add_output(T2)
+
+        torch_ref = inputs[0] + inputs[0].sum(dim=1, keepdim=True)
+        stream = torch.cuda.Stream()
+        with torch.cuda.stream(stream):
+            executions = [fd.execute_async(inputs) for _ in range(4)]
+            results = [execution.result() for execution in executions]
+        stream.synchronize()
+        for execution, nvf_out in zip(executions, results):
+            self.assertTrue(execution.done())
+            self.assertEqual(nvf_out[0], torch_ref)
+
     # Test that we properly raise an error when passing inputs with the wrong types
     def test_mismatched_input_types(self):
         scalar_inp = 2.0
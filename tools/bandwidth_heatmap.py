@@ -0,0 +1,120 @@
+# SPDX-FileCopyrightText: Copyright (c) 2024-present NVIDIA CORPORATION & AFFILIATES.
+# All rights reserved.
+# SPDX-License-Identifier: BSD-3-Clause
+#
+# "bandwidth_heatmap.py -h" for help.
+#
+# Prints the results of the NvFuserScheduler_BandwidthSweep benchmarks of
+# benchmarks/cpp/bandwidth_sweep.cpp as one heatmap per dtype and layout,
+# with a row per inner size and a column per vectorization width, holding
+# the fraction of the peak bandwidth of the GPU reached by the kernel. The
+# "heur" column is the width picked by the heuristics. Skipped combinations
+# are left blank. With --png, the heatmaps are also plotted with matplotlib.
+
+import argparse
+from collections import defaultdict
+import json
+import re
+
+
+BENCHMARK_NAME = "NvFuserScheduler_BandwidthSweep"
+
+# Seconds per time unit of the benchmark JSON.
+TIME_UNITS = {"ns": 1e-9, "us": 1e-6, "ms": 1e-3, "s": 1.0}
+
+NAME_PATTERN = re.compile(
+    BENCHMARK_NAME + r"/(?P<case>\w+)/vec_bytes:(?P<vec_bytes>\d+)"
+    r"/inner:(?P<inner>\d+)"
+)
+
+
+def load_sweep(path: str) -> dict:
+    """
+    Returns the peak fractions keyed by case, e.g. fp32_contiguous, then by
+    (inner size, vectorization width in bytes).
+    """
+    with open(path) as f:
+        data = json.load(f)
+    sweep = defaultdict(dict)
+    for benchmark in data["benchmarks"]:
+        match = NAME_PATTERN.match(benchmark["name"])
+        if match is None:
+            continue
+        if benchmark.get("run_type", "iteration") != "iteration":
+            continue
+        if benchmark.get("error_occurred", False):
+            continue
+        seconds = benchmark["real_time"] * TIME_UNITS[benchmark["time_unit"]]
+        bandwidth_gbs = benchmark["io_bytes"] / seconds / 1e9
+        key = (int(match.group("inner")), int(match.group("vec_bytes")))
+        sweep[match.group("case")][key] = bandwidth_gbs / benchmark["peak_gbs"]
+    return sweep
+
+
+def column_name(vec_bytes: int) -> str:
+    return "heur" if vec_bytes == 0 else f"{vec_bytes}B"
+
+
+def print_heatmap(case: str, results: dict) -> None:
+    sizes = sorted({inner for inner, _ in results})
+    widths = sorted({vec_bytes for _, vec_bytes in results})
+    print(case)
+    print("inner".rjust(8) + "".join(column_name(w).rjust(7) for w in widths))
+    for inner in sizes:
+        row = str(inner).rjust(8)
+        for vec_bytes in widths:
+            fraction = results.get((inner, vec_bytes))
+            row += ("" if fraction is None else f"{fraction:.0%}").rjust(7)
+        print(row)
+    print()
+
+
+def plot_heatmaps(sweep: dict, path: str) -> None:
+    import matplotlib.pyplot as plt
+    import numpy as np
+
+    cases = sorted(sweep)
+    fig, axes = plt.subplots(
+        len(cases), 1, figsize=(6, 3 * len(cases)), squeeze=False
+    )
+    for ax, case in zip(axes[:, 0], cases):
+        results = sweep[case]
+        sizes = sorted({inner for inner, _ in results})
+        widths = sorted({vec_bytes for _, vec_bytes in results})
+        grid = np.full((len(sizes), len(widths)), np.nan)
+        for (inner, vec_bytes), fraction in results.items():
+            grid[sizes.index(inner), widths.index(vec_bytes)] = fraction
+        image = ax.imshow(grid, vmin=0.0, vmax=1.0, cmap="viridis")
+        ax.set_title(case)
+        ax.set_xticks(range(len(widths)), [column_name(w) for w in widths])
+        ax.set_yticks(range(len(sizes)), [str(s) for s in sizes])
+        ax.set_xlabel("vectorization width")
+        ax.set_ylabel("inner size")
+        fig.colorbar(image, ax=ax, label="fraction of peak bandwidth")
+    fig.tight_layout()
+    fig.savefig(path)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Prints heatmaps of the bandwidth sweep benchmarks."
+    )
+    parser.add_argument("results", help="JSON output of nvfuser_bench.")
+    parser.add_argument(
+        "--png",
+        help="Also plot the heatmaps to this file. Requires matplotlib.",
+    )
+    args = parser.parse_args()
+
+    sweep = load_sweep(args.results)
+    if not sweep:
+        print(f"No {BENCHMARK_NAME} results in {args.results}.")
+        return
+    for case in sorted(sweep):
+        print_heatmap(case, sweep[case])
+    if args.png:
+        plot_heatmaps(sweep, args.png)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,342 @@
+# SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+# All rights reserved.
+# SPDX-License-Identifier: BSD-3-Clause
+#
+# "benchmark_regression.py -h" for help.
+#
+# Unlike compare_benchmark.py, which benchmarks two commits back to back, this
+# compares the benchmark results of one build against a stored baseline of the
+# same GPU, so that it can run on every change. Each benchmark is run several
+# times and a change is only reported when it is larger than both the given
+# threshold and the run-to-run noise measured for that benchmark. Changes of
+# the heuristics, recorded by nvfuser_bench in the label of each benchmark,
+# are reported separately from changes of the kernel time, since a heuristic
+# change is often the explanation of a time change.
+#
+# Options go before the command, since the arguments after the baseline folder
+# are passed to nvfuser_bench, e.g.
+#   python tools/benchmark_regression.py --repetitions=10 check baselines \
+#     --benchmark_filter=NvFuserScheduler
+
+import argparse
+from dataclasses import dataclass
+import json
+import os
+import statistics
+import subprocess
+import sys
+
+
+# Seconds per time unit of the benchmark JSON.
+TIME_UNITS = {"ns": 1e-9, "us": 1e-6, "ms": 1e-3, "s": 1.0}
+
+
+@dataclass
+class Measurement:
+    name: str
+    # Median over the repetitions, in us.
+    time_us: float
+    # Coefficient of variation of the time over the repetitions.
+    noise: float
+    # Median over the repetitions, in GB/s. 0 if unknown.
+    bandwidth_gbs: float
+    # Heuristics and launch parameters. Empty for benchmarks without a label.
+    heuristics: str
+
+    def to_json(self) -> dict:
+        return {
+            "time_us": self.time_us,
+            "noise": self.noise,
+            "bandwidth_gbs": self.bandwidth_gbs,
+            "heuristics": self.heuristics,
+        }
+
+    @staticmethod
+    def from_json(name: str, data: dict) -> "Measurement":
+        return Measurement(
+            name=name,
+            time_us=data["time_us"],
+            noise=data["noise"],
+            bandwidth_gbs=data["bandwidth_gbs"],
+            heuristics=data["heuristics"],
+        )
+
+
+def sanitize_benchmark_args(args: list[str]) -> list[str]:
+    # Skip the leading "--", as in compare_benchmark.py.
+    if args and args[0] == "--":
+        args = args[1:]
+
+    for arg in args:
+        for forbidden_option in (
+            "--benchmark_out",
+            "--benchmark_out_format",
+            "--benchmark_format",
+            "--benchmark_repetitions",
+        ):
+            if arg == forbidden_option or arg.startswith(forbidden_option + "="):
+                raise ValueError(
+                    f"{forbidden_option} should be specified by run_benchmark not the user."
+                )
+
+    return args
+
+
+def run_benchmark(benchmark_args: list[str], repetitions: int, out: str) -> None:
+    benchmark_command = " ".join(
+        ["bin/nvfuser_bench"]
+        + benchmark_args
+        + [
+            f"--benchmark_repetitions={repetitions}",
+            f"--benchmark_out={out}",
+            "--benchmark_format=json",
+        ]
+    )
+    print("Running benchmark command: " + benchmark_command)
+    subprocess.check_call(benchmark_command, shell=True)
+
+
+def bandwidth_gbs(row: dict) -> float:
+    # Prefer the bandwidth that the kernels achieved, as measured by the
+    # profiler, over the one derived from the bytes of the fusion inputs and
+    # outputs.
+    if "effective_bandwidth_gbs" in row:
+        return row["effective_bandwidth_gbs"]
+    if "bytes_per_second" in row:
+        return row["bytes_per_second"] / 1e9
+    return 0.0
+
+
+# Reads the output of nvfuser_bench. Returns the name of the GPU and the
+# measurements of each benchmark.
+def load_results(benchmark_out: str) -> tuple[str, dict[str, Measurement]]:
+    with open(benchmark_out) as f:
+        data = json.load(f)
+
+    rows: dict[str, list[dict]] = {}
+    for row in data["benchmarks"]:
+        # Skip the mean, median and stddev that are reported along with the
+        # repetitions. They are recomputed below.
+        if row["run_type"] != "iteration" or "error_occurred" in row:
+            continue
+        rows.setdefault(row["run_name"], []).append(row)
+
+    measurements: dict[str, Measurement] = {}
+    for name, repetitions in rows.items():
+        times = [
+            row["real_time"] * TIME_UNITS[row["time_unit"]] * 1e6
+            for row in repetitions
+        ]
+        mean = statistics.mean(times)
+        noise = statistics.stdev(times) / mean if len(times) > 1 and mean else 0.0
+        measurements[name] = Measurement(
+            name=name,
+            time_us=statistics.median(times),
+            noise=noise,
+            bandwidth_gbs=statistics.median(bandwidth_gbs(row) for row in repetitions),
+            heuristics=repetitions[0].get("label", ""),
+        )
+
+    return data["context"].get("gpu_name", "unknown"), measurements
+
+
+def baseline_path(baseline_dir: str, gpu_name: str) -> str:
+    return os.path.join(baseline_dir, gpu_name.replace(" ", "_") + ".json")
+
+
+def save_baseline(
+    baseline_dir: str, gpu_name: str, measurements: dict[str, Measurement]
+) -> None:
+    os.makedirs(baseline_dir, exist_ok=True)
+    path = baseline_path(baseline_dir, gpu_name)
+    with open(path, "w") as f:
+        json.dump(
+            {
+                "gpu_name": gpu_name,
+                "benchmarks": {
+                    name: measurement.to_json()
+                    for name, measurement in sorted(measurements.items())
+                },
+            },
+            f,
+            indent=2,
+        )
+    print(f"Saved the baseline of {len(measurements)} benchmarks to {path}.")
+
+
+def load_baseline(baseline_dir: str, gpu_name: str) -> dict[str, Measurement]:
+    path = baseline_path(baseline_dir, gpu_name)
+    if not os.path.exists(path):
+        raise FileNotFoundError(
+            f"No baseline for {gpu_name} in {baseline_dir}. Create it with the update command."
+        )
+    with open(path) as f:
+        data = json.load(f)
+    return {
+        name: Measurement.from_json(name, measurement)
+        for name, measurement in data["benchmarks"].items()
+    }
+
+
+@dataclass
+class Comparison:
+    baseline: Measurement
+    contender: Measurement
+    # The relative change of time below which a change is considered noise.
+    tolerance: float
+
+    @property
+    def change(self) -> float:
+        # contender time divided by baseline time. Smaller is better.
+        return self.contender.time_us / self.baseline.time_us
+
+    @property
+    def is_regression(self) -> bool:
+        return self.change > 1 + self.tolerance
+
+    @property
+    def is_improvement(self) -> bool:
+        return self.change < 1 - self.tolerance
+
+    @property
+    def heuristics_changed(self) -> bool:
+        return self.baseline.heuristics != self.contender.heuristics
+
+    def __str__(self):
+        return (
+            f"Benchmark {self.contender.name} changed from "
+            f"{self.baseline.time_us:.2f}us ({self.baseline.bandwidth_gbs:.1f}GB/s) to "
+            f"{self.contender.time_us:.2f}us ({self.contender.bandwidth_gbs:.1f}GB/s) "
+            f"({self.change:.2f}x, tolerance {self.tolerance:.1%})"
+        )
+
+
+# The tolerance of a benchmark is the largest of `threshold` and `noise_factor`
+# times the noise of the baseline or of the contender, so that noisy
+# benchmarks, e.g. very short kernels, need a larger change to be reported.
+def compare(
+    baseline: dict[str, Measurement],
+    contender: dict[str, Measurement],
+    threshold: float,
+    noise_factor: float,
+) -> list[Comparison]:
+    comparisons: list[Comparison] = []
+    for name, measurement in contender.items():
+        if name not in baseline or baseline[name].time_us == 0:
+            continue
+        tolerance = max(
+            threshold,
+            noise_factor * baseline[name].noise,
+            noise_factor * measurement.noise,
+        )
+        comparisons.append(Comparison(baseline[name], measurement, tolerance))
+    return comparisons
+
+
+# Prints the comparisons. Returns whether there is any performance regression.
+def summarize(
+    comparisons: list[Comparison],
+    baseline: dict[str, Measurement],
+    contender: dict[str, Measurement],
+) -> bool:
+    comparisons = sorted(comparisons, key=lambda x: x.change)
+    regressions = [c for c in comparisons if c.is_regression]
+    improvements = [c for c in comparisons if c.is_improvement]
+    heuristic_changes = [c for c in comparisons if c.heuristics_changed]
+
+    print(f"Compared {len(comparisons)} benchmarks.")
+    print()
+    print(f"{len(regressions)} regressions:")
+    for comparison in reversed(regressions):
+        print(f"  {comparison}")
+    print()
+    print(f"{len(improvements)} improvements:")
+    for comparison in improvements:
+        print(f"  {comparison}")
+    print()
+    print(f"{len(heuristic_changes)} heuristic changes:")
+    for comparison in heuristic_changes:
+        print(f"  Benchmark {comparison.contender.name} ({comparison.change:.2f}x)")
+        print(f"    from: {comparison.baseline.heuristics}")
+        print(f"    to:   {comparison.contender.heuristics}")
+
+    added = sorted(contender.keys() - baseline.keys())
+    removed = sorted(baseline.keys() - contender.keys())
+    if added or removed:
+        print()
+        print(f"{len(added)} benchmarks not in the baseline:")
+        for name in added:
+            print(f"  {name}")
+        print(f"{len(removed)} benchmarks of the baseline not run:")
+        for name in removed:
+            print(f"  {name}")
+
+    return len(regressions) > 0
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(
+        description="Checks nvfuser_bench results against a stored per-GPU baseline."
+    )
+    parser.add_argument(
+        "command",
+        choices=["check", "update"],
+        help="check compares the results to the baseline, update replaces the baseline with the results",
+    )
+    parser.add_argument(
+        "baseline_dir",
+        type=str,
+        help="The folder containing a baseline .json file per GPU",
+    )
+    parser.add_argument(
+        "--results",
+        type=str,
+        help="An existing nvfuser_bench .json output to use instead of running nvfuser_bench",
+    )
+    parser.add_argument(
+        "--out",
+        type=str,
+        default="benchmark_results.json",
+        help="Where to store the nvfuser_bench output when running it",
+    )
+    parser.add_argument(
+        "--repetitions",
+        type=int,
+        default=5,
+        help="Number of runs of each benchmark, used to measure its noise",
+    )
+    parser.add_argument(
+        "--threshold",
+        type=float,
+        default=0.05,
+        help="Smallest relative change of time that is reported",
+    )
+    parser.add_argument(
+        "--noise_factor",
+        type=float,
+        default=3.0,
+        help="Changes smaller than this many times the coefficient of variation of a benchmark are considered noise",
+    )
+    parser.add_argument(
+        "benchmark_args",
+        type=str,
+        nargs=argparse.REMAINDER,
+        help="Arguments passed to nvfuser_bench, e.g., --benchmark_filter=NvFuserScheduler",
+    )
+    args = parser.parse_args()
+
+    benchmark_out = args.results
+    if benchmark_out is None:
+        benchmark_args = sanitize_benchmark_args(args.benchmark_args)
+        run_benchmark(benchmark_args, args.repetitions, args.out)
+        benchmark_out = args.out
+
+    gpu_name, measurements = load_results(benchmark_out)
+    if args.command == "update":
+        save_baseline(args.baseline_dir, gpu_name, measurements)
+        sys.exit(0)
+
+    baseline = load_baseline(args.baseline_dir, gpu_name)
+    comparisons = compare(baseline, measurements, args.threshold, args.noise_factor)
+    has_regressions = summarize(comparisons, baseline, measurements)
+    sys.exit(1 if has_regressions else 0)
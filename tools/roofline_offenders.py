@@ -0,0 +1,111 @@
+# SPDX-FileCopyrightText: Copyright (c) 2024-present NVIDIA CORPORATION & AFFILIATES.
+# All rights reserved.
+# SPDX-License-Identifier: BSD-3-Clause
+#
+# "roofline_offenders.py -h" for help.
+#
+# Ranks the random fusions of benchmarks/cpp/random_fusions.cpp by the
+# fraction of the roofline they reach, i.e. the time to read their inputs and
+# write their outputs at the peak bandwidth of the GPU divided by their kernel
+# time, and prints the worst ones with their heuristics, their number of
+# segments and the command that reproduces them, e.g.
+#   bin/nvfuser_bench --benchmark_filter=NvFuserScheduler_RandomFusion \
+#     --benchmark_out=random.json
+#   python tools/roofline_offenders.py random.json --top=20
+
+import argparse
+from dataclasses import dataclass
+import json
+
+
+BENCHMARK_NAME = "NvFuserScheduler_RandomFusion"
+
+# Seconds per time unit of the benchmark JSON.
+TIME_UNITS = {"ns": 1e-9, "us": 1e-6, "ms": 1e-3, "s": 1.0}
+
+
+@dataclass
+class RandomFusion:
+    name: str
+    time_us: float
+    roofline_us: float
+    segments: int
+    # Heuristics and launch parameters of each segment.
+    heuristics: str
+
+    @property
+    def roofline_fraction(self) -> float:
+        return self.roofline_us / self.time_us if self.time_us > 0 else 0.0
+
+    def repro(self) -> str:
+        return (
+            "NVFUSER_DUMP=fusion_ir_original bin/nvfuser_bench "
+            f"--benchmark_filter='{self.name}$'"
+        )
+
+
+def load_random_fusions(path: str) -> list[RandomFusion]:
+    with open(path) as f:
+        data = json.load(f)
+    fusions = []
+    for benchmark in data["benchmarks"]:
+        if not benchmark["name"].startswith(BENCHMARK_NAME):
+            continue
+        if benchmark.get("run_type", "iteration") != "iteration":
+            continue
+        if benchmark.get("error_occurred", False):
+            continue
+        fusions.append(
+            RandomFusion(
+                name=benchmark["name"],
+                time_us=benchmark["real_time"]
+                * TIME_UNITS[benchmark.get("time_unit", "ns")]
+                * 1e6,
+                roofline_us=benchmark["roofline_us"],
+                segments=int(benchmark["segments"]),
+                heuristics=benchmark.get("label", ""),
+            )
+        )
+    return fusions
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Prints the random fusions furthest from the roofline."
+    )
+    parser.add_argument("results", help="JSON output of nvfuser_bench.")
+    parser.add_argument(
+        "--top",
+        type=int,
+        default=10,
+        help="Number of fusions to print.",
+    )
+    args = parser.parse_args()
+
+    fusions = load_random_fusions(args.results)
+    if not fusions:
+        print(f"No {BENCHMARK_NAME} results in {args.results}.")
+        return
+
+    fusions.sort(key=lambda fusion: fusion.roofline_fraction)
+    fractions = [fusion.roofline_fraction for fusion in fusions]
+    print(
+        f"{len(fusions)} fusions, roofline fraction: "
+        f"min {min(fractions):.1%}, "
+        f"median {sorted(fractions)[len(fractions) // 2]:.1%}, "
+        f"max {max(fractions):.1%}"
+    )
+    for fusion in fusions[: args.top]:
+        print()
+        print(
+            f"{fusion.name}: {fusion.roofline_fraction:.1%} of the roofline "
+            f"({fusion.time_us:.1f} us vs {fusion.roofline_us:.1f} us), "
+            f"{fusion.segments} segment(s)"
+        )
+        if fusion.heuristics:
+            print(f"  heuristics: {fusion.heuristics}")
+        print(f"  repro: {fusion.repro()}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,63 @@
+# SPDX-FileCopyrightText: Copyright (c) 2023-present NVIDIA CORPORATION & AFFILIATES.
+# All rights reserved.
+# SPDX-License-Identifier: BSD-3-Clause
+#
+# Converts a trace written with NVFUSER_ENABLE=binary_trace to the Chrome
+# Tracing JSON format, which chrome://tracing and Perfetto can open.
+#
+# "trace_to_json.py -h" for help.
+
+import argparse
+import json
+import struct
+
+HEADER = struct.Struct("<8sII")
+RECORD = struct.Struct("<c3xIIIq")
+MAGIC = b"NVFTRACE"
+
+
+def read_events(data: bytes):
+    magic, version, pid = HEADER.unpack_from(data, 0)
+    assert magic == MAGIC, "Not an nvFuser binary trace"
+    assert version == 1, f"Unsupported binary trace version {version}"
+
+    names = {}
+    events = []
+    offset = HEADER.size
+    while offset + RECORD.size <= len(data):
+        ph, name_id, tid, size, ts_ns = RECORD.unpack_from(data, offset)
+        offset += RECORD.size
+        ph = ph.decode()
+        if ph == "N":
+            names[name_id] = data[offset : offset + size].decode()
+            offset += (size + 7) // 8 * 8
+            continue
+        event = {"pid": pid, "tid": tid, "ts": ts_ns / 1000.0}
+        if ph == "D":
+            event.update(
+                {"name": "TRACE_DROPPED", "ph": "i", "args": {"events": size}}
+            )
+        else:
+            event.update({"name": names[name_id], "ph": ph})
+        events.append(event)
+    # Events of different threads are flushed buffer by buffer
+    events.sort(key=lambda event: event["ts"])
+    return events
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Convert an nvFuser binary trace to Chrome Tracing JSON"
+    )
+    parser.add_argument("input", help="binary trace file")
+    parser.add_argument("output", help="JSON file to write")
+    args = parser.parse_args()
+
+    with open(args.input, "rb") as f:
+        events = read_events(f.read())
+    with open(args.output, "w") as f:
+        json.dump({"traceEvents": events, "displayTimeUnit": "ms"}, f)
+
+
+if __name__ == "__main__":
+    main()